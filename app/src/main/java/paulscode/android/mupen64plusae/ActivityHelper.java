@@ -102,10 +102,13 @@ public class ActivityHelper
         public static final String CHEAT_ARGS           = NAMESPACE + "CHEAT_ARGS";
         public static final String SAVE_TO_LOAD         = NAMESPACE + "SAVE_TO_LOAD";
         public static final String CORE_LIB             = NAMESPACE + "CORE_LIB";
+        public static final String AUDIO_PLUGIN_LIB     = NAMESPACE + "AUDIO_PLUGIN_LIB";
         public static final String HIGH_PRIORITY_THREAD = NAMESPACE + "HIGH_PRIORITY_THREAD";
         public static final String PAK_TYPE_ARRAY       = NAMESPACE + "PAK_TYPE_ARRAY";
         public static final String IS_PLUGGED_ARRAY     = NAMESPACE + "IS_PLUGGED_ARRAY";
         public static final String IS_FPS_LIMIT_ENABLED = NAMESPACE + "IS_FPS_LIMIT_ENABLED";
+        public static final String FRAME_PACING         = NAMESPACE + "FRAME_PACING";
+        public static final String PERF_PROFILES_DIR    = NAMESPACE + "PERF_PROFILES_DIR";
         public static final String CORE_USER_DATA_DIR   = NAMESPACE + "CORE_USER_DATA_DIR";
         public static final String CORE_USER_CACHE_DIR  = NAMESPACE + "CORE_USER_CACHE_DIR";
         public static final String CORE_USER_CONFIG_DIR = NAMESPACE + "CORE_USER_CONFIG_DIR";
@@ -421,8 +424,9 @@ public class ActivityHelper
     public static void startCoreService(Context context, ServiceConnection serviceConnection, String romGoodName,
         String romPath, String romMd5, String romCrc, String romHeaderName, byte romCountryCode, String romArtPath,
         String romLegacySave, String cheatOptions, boolean isRestarting, String saveToLoad, String coreLib,
-        boolean useHighPriorityThread, ArrayList<Integer> pakTypes, boolean[] isPlugged, boolean isFrameLimiterEnabled,
-        String coreUserDataDir, String coreUserCacheDir, String coreUserConfigDir, String userSaveDir, String libsDir)
+        String audioPluginLib, boolean useHighPriorityThread, ArrayList<Integer> pakTypes, boolean[] isPlugged, boolean isFrameLimiterEnabled,
+        int framePacing, String performanceProfilesDir, String coreUserDataDir, String coreUserCacheDir, String coreUserConfigDir, String userSaveDir,
+        String libsDir)
     {
         Intent intent = new Intent(context, CoreService.class);
         intent.putExtra(Keys.ROM_GOOD_NAME, romGoodName);
@@ -431,10 +435,13 @@ public class ActivityHelper
         intent.putExtra(Keys.DO_RESTART, isRestarting);
         intent.putExtra(Keys.SAVE_TO_LOAD, saveToLoad);
         intent.putExtra(Keys.CORE_LIB, coreLib);
+        intent.putExtra(Keys.AUDIO_PLUGIN_LIB, audioPluginLib);
         intent.putExtra(Keys.HIGH_PRIORITY_THREAD, useHighPriorityThread);
         intent.putIntegerArrayListExtra(Keys.PAK_TYPE_ARRAY, pakTypes);
         intent.putExtra(Keys.IS_PLUGGED_ARRAY, isPlugged);
         intent.putExtra(Keys.IS_FPS_LIMIT_ENABLED, isFrameLimiterEnabled);
+        intent.putExtra(Keys.FRAME_PACING, framePacing);
+        intent.putExtra(Keys.PERF_PROFILES_DIR, performanceProfilesDir);
         intent.putExtra(Keys.CORE_USER_DATA_DIR, coreUserDataDir);
         intent.putExtra(Keys.CORE_USER_CACHE_DIR, coreUserCacheDir);
         intent.putExtra(Keys.CORE_USER_CONFIG_DIR, coreUserConfigDir);
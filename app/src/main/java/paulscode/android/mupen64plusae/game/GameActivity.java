@@ -30,8 +30,10 @@ import android.content.res.Configuration;
 import android.graphics.drawable.BitmapDrawable;
 import android.hardware.SensorManager;
 import android.media.AudioManager;
+import android.os.Build;
 import android.os.Bundle;
 import android.os.Handler;
+import android.os.PowerManager;
 import android.os.Vibrator;
 import android.support.annotation.NonNull;
 import android.support.v4.app.FragmentManager;
@@ -309,6 +311,13 @@ public class GameActivity extends AppCompatActivity implements PromptConfirmList
         // Keep screen from going to sleep
         window.setFlags( LayoutParams.FLAG_KEEP_SCREEN_ON, LayoutParams.FLAG_KEEP_SCREEN_ON );
 
+        // Run at clocks the device can hold without thermal throttling
+        if (mGlobalPrefs.isSustainedPerformanceModeEnabled && Build.VERSION.SDK_INT >= Build.VERSION_CODES.N) {
+            final PowerManager powerManager = (PowerManager) getSystemService(Context.POWER_SERVICE);
+            if (powerManager != null && powerManager.isSustainedPerformanceModeSupported())
+                window.setSustainedPerformanceMode(true);
+        }
+
         // Set the screen orientation
         if (mGlobalPrefs.displayOrientation != -1) {
             setRequestedOrientation( mGlobalPrefs.displayOrientation );
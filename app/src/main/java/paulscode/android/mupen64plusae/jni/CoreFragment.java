@@ -355,9 +355,10 @@ public class CoreFragment extends Fragment implements CoreServiceListener
         // Start the core
         ActivityHelper.startCoreService(activity.getApplicationContext(), mServiceConnection, mRomGoodName, mRomPath,
                 mRomMd5, mRomCrc, mRomHeaderName, mRomCountryCode, mRomArtPath, mRomLegacySave,
-                mCheatArgs, mIsRestarting, mSaveToLoad, mAppData.coreLib, mGlobalPrefs.useHighPriorityThread, pakTypes,
-                mGamePrefs.isPlugged, mGlobalPrefs.isFramelimiterEnabled, mGlobalPrefs.coreUserDataDir,
-                mGlobalPrefs.coreUserCacheDir, mGamePrefs.getCoreUserConfigDir(), mGamePrefs.getUserSaveDir(), mAppData.libsDir);
+                mCheatArgs, mIsRestarting, mSaveToLoad, mAppData.coreLib, mGlobalPrefs.audioPlugin.path, mGlobalPrefs.useHighPriorityThread, pakTypes,
+                mGamePrefs.isPlugged, mGlobalPrefs.isFramelimiterEnabled, mGlobalPrefs.displayFramePacing,
+                mGlobalPrefs.isPerformanceProfileEnabled ? mGlobalPrefs.performanceProfilesDir : null,
+                mGlobalPrefs.coreUserDataDir, mGlobalPrefs.coreUserCacheDir, mGamePrefs.getCoreUserConfigDir(), mGamePrefs.getUserSaveDir(), mAppData.libsDir);
     }
 
     private void actuallyStopCore()
@@ -883,6 +884,27 @@ public class CoreFragment extends Fragment implements CoreServiceListener
         }
     }
 
+    /**
+     * Fills stats with the output timing statistics of the audio plugin, see the
+     * NativeExports.AUDIO_STAT_* constants for the layout
+     *
+     * @return The number of values filled, 0 if the audio plugin doesn't provide them
+     */
+    public int getAudioStats(int[] stats)
+    {
+        return mCoreService != null ? mCoreService.getAudioStats(stats) : 0;
+    }
+
+    /**
+     * Fills history with the recent audio output queue depths in milliseconds, oldest first
+     *
+     * @return The number of values filled, 0 if the audio plugin doesn't provide them
+     */
+    public int getAudioQueueHistory(int[] history)
+    {
+        return mCoreService != null ? mCoreService.getAudioQueueHistory(history) : 0;
+    }
+
     public int getCurrentSpeed()
     {
         Log.i("CoreFragment", "getCurrentSpeed");
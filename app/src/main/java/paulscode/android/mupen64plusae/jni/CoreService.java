@@ -49,9 +49,11 @@ import org.mupen64plusae.v3.alpha.R;
 import java.io.File;
 import java.io.IOException;
 import java.util.ArrayList;
+import java.util.Locale;
 
 import paulscode.android.mupen64plusae.ActivityHelper;
 import paulscode.android.mupen64plusae.game.GameActivity;
+import paulscode.android.mupen64plusae.util.CountryCode;
 
 import static paulscode.android.mupen64plusae.jni.NativeExports.emuGetFramelimiter;
 import static paulscode.android.mupen64plusae.jni.NativeImports.removeOnStateCallbackListener;
@@ -95,10 +97,13 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
     private boolean mIsRestarting = false;
     private String mSaveToLoad = null;
     private String mCoreLib = null;
+    private String mAudioPluginLib = null;
     private boolean mUseHighPriorityThread = false;
     private ArrayList<Integer> mPakType = null;
     private ArrayList<Boolean> mIsPlugged = null;
     private boolean mIsFrameLimiterEnabled = true;
+    private int mFramePacing = 0;
+    private String mPerformanceProfilesDir = null;
     private String mCoreUserDataDir = null;
     private String mCoreUserCacheDir = null;
     private String mCoreUserConfigDir = null;
@@ -127,6 +132,16 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
     private long mLastFpsChangedTime;
     private Handler mFpsCangedHandler = new Handler();
 
+    /**
+     * Audio statistics are logged every AUDIO_STATS_LOG_PERIOD seconds, or right away when the
+     * output ran dry since the last sample.
+     */
+    private static final int AUDIO_STATS_LOG_PERIOD = 10;
+    private final int[] mAudioStats = new int[NativeExports.AUDIO_STAT_COUNT];
+    private long mLastAudioStatsTime = 0;
+    private long mLastAudioStatsLogTime = 0;
+    private int mLastAudioUnderruns = 0;
+
     final static int ONGOING_NOTIFICATION_ID = 1;
 
     // Our handler for received Intents. This will be called whenever an Intent
@@ -341,6 +356,60 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
         NativeImports.addOnFpsChangedListener( fpsListener, fpsRecalcPeriod );
     }
 
+    int getAudioStats(int[] stats)
+    {
+        return mAudioPluginLib != null ? NativeExports.audioGetStats( mAudioPluginLib, stats ) : 0;
+    }
+
+    int getAudioQueueHistory(int[] history)
+    {
+        return mAudioPluginLib != null ? NativeExports.audioGetQueueHistory( mAudioPluginLib, history ) : 0;
+    }
+
+    private void logAudioStats()
+    {
+        long seconds = System.currentTimeMillis() / 1000L;
+
+        if(seconds == mLastAudioStatsTime || getAudioStats(mAudioStats) != NativeExports.AUDIO_STAT_COUNT)
+        {
+            return;
+        }
+
+        mLastAudioStatsTime = seconds;
+
+        int underruns = mAudioStats[NativeExports.AUDIO_STAT_UNDERRUNS];
+        if(underruns < mLastAudioUnderruns)
+        {
+            // The plugin restarted its output
+            mLastAudioUnderruns = 0;
+        }
+
+        if(underruns != mLastAudioUnderruns || seconds - mLastAudioStatsLogTime >= AUDIO_STATS_LOG_PERIOD)
+        {
+            String message = String.format(Locale.US,
+                    "%s %d Hz: underruns=%d queue=%d ms (%d-%d ms) latency=%d ms ratio=%.4f",
+                    mAudioStats[NativeExports.AUDIO_STAT_AAUDIO] != 0 ? "AAudio" : "OpenSL ES",
+                    mAudioStats[NativeExports.AUDIO_STAT_SAMPLE_RATE], underruns,
+                    mAudioStats[NativeExports.AUDIO_STAT_QUEUE_MS],
+                    mAudioStats[NativeExports.AUDIO_STAT_QUEUE_MIN_MS],
+                    mAudioStats[NativeExports.AUDIO_STAT_QUEUE_MAX_MS],
+                    mAudioStats[NativeExports.AUDIO_STAT_LATENCY_MS],
+                    mAudioStats[NativeExports.AUDIO_STAT_RATIO_PPM] / 1000000.0f);
+
+            if(underruns != mLastAudioUnderruns)
+            {
+                Log.w("CoreService", message);
+            }
+            else
+            {
+                Log.i("CoreService", message);
+            }
+
+            mLastAudioUnderruns = underruns;
+            mLastAudioStatsLogTime = seconds;
+        }
+    }
+
     void setControllerState( int controllerNum, boolean[] buttons, int axisX, int axisY )
     {
         NativeInput.setState( controllerNum, buttons, axisX, axisY );
@@ -434,6 +503,12 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
                 arglist.add( "--cheats" );
                 arglist.add( mCheatOptions );
             }
+            if( mPerformanceProfilesDir != null && ( new File( mPerformanceProfilesDir ).isDirectory() ||
+                new File( mPerformanceProfilesDir ).mkdirs() ) )
+            {
+                arglist.add( "--autotune" );
+                arglist.add( mPerformanceProfilesDir );
+            }
             arglist.add( mRomPath );
 
             Log.i("CoreService", "emuStar args:");
@@ -442,9 +517,17 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
                 Log.i("CoreService", arg);
             }
 
+            NativeExports.setFramePacing( mFramePacing );
+
+            // Report frame work to the performance hint manager against the VI period of the game
+            NativeExports.setPerformanceHint( CountryCode.getCountryCode( mRomCountryCode ).isPal() ? 20000000L : 16666667L );
+
             //This call blocks until emulation is stopped
             final int result = NativeExports.emuStart( mCoreUserDataDir, mCoreUserCacheDir, arglist.toArray() );
 
+            NativeExports.setPerformanceHint( 0 );
+            NativeExports.setFramePacing( 0 );
+
             if(mListener != null)
             {
                 if(result != 0)
@@ -584,6 +667,7 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
             mIsRestarting = extras.getBoolean( ActivityHelper.Keys.DO_RESTART, false );
             mSaveToLoad = extras.getString( ActivityHelper.Keys.SAVE_TO_LOAD );
             mCoreLib = extras.getString( ActivityHelper.Keys.CORE_LIB );
+            mAudioPluginLib = extras.getString( ActivityHelper.Keys.AUDIO_PLUGIN_LIB );
             mUseHighPriorityThread = extras.getBoolean( ActivityHelper.Keys.HIGH_PRIORITY_THREAD, false );
 
             mPakType = extras.getIntegerArrayList(ActivityHelper.Keys.PAK_TYPE_ARRAY);
@@ -601,6 +685,8 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
             }
 
             mIsFrameLimiterEnabled = extras.getBoolean( ActivityHelper.Keys.IS_FPS_LIMIT_ENABLED, true );
+            mFramePacing = extras.getInt( ActivityHelper.Keys.FRAME_PACING, 0 );
+            mPerformanceProfilesDir = extras.getString( ActivityHelper.Keys.PERF_PROFILES_DIR );
             mCoreUserDataDir = extras.getString( ActivityHelper.Keys.CORE_USER_DATA_DIR );
             mCoreUserCacheDir = extras.getString( ActivityHelper.Keys.CORE_USER_CACHE_DIR );
             mCoreUserConfigDir = extras.getString( ActivityHelper.Keys.CORE_USER_CONFIG_DIR );
@@ -643,6 +729,43 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
         android.os.Process.killProcess(android.os.Process.myPid());
     }
 
+    @Override
+    public void onTrimMemory(int level)
+    {
+        super.onTrimMemory(level);
+
+        if (!mIsRunning)
+            return;
+
+        // Caches are dropped by the emulation thread at the next frame
+        switch (level)
+        {
+            case TRIM_MEMORY_RUNNING_MODERATE:
+            case TRIM_MEMORY_RUNNING_LOW:
+            case TRIM_MEMORY_BACKGROUND:
+                Log.i("CoreService", "Trim memory, level " + level);
+                NativeExports.emuTrimMemory(NativeConstants.M64TRIM_MODERATE);
+                break;
+            case TRIM_MEMORY_RUNNING_CRITICAL:
+            case TRIM_MEMORY_MODERATE:
+            case TRIM_MEMORY_COMPLETE:
+                Log.i("CoreService", "Trim memory, level " + level);
+                NativeExports.emuTrimMemory(NativeConstants.M64TRIM_CRITICAL);
+                break;
+            default:
+                break;
+        }
+    }
+
+    @Override
+    public void onLowMemory()
+    {
+        super.onLowMemory();
+
+        if (mIsRunning)
+            NativeExports.emuTrimMemory(NativeConstants.M64TRIM_CRITICAL);
+    }
+
     @Override
     public IBinder onBind(Intent intent) {
         return mBinder;
@@ -701,6 +824,10 @@ public class CoreService extends Service implements NativeImports.OnFpsChangedLi
         {
             NativeExports.emuPause();
         }
+        else
+        {
+            logAudioStats();
+        }
     }
 
     public void forceExit()
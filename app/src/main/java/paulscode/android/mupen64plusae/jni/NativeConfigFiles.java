@@ -67,6 +67,7 @@ class NativeConfigFiles
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "window width", String.valueOf( game.videoRenderWidth ) );
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "window height", String.valueOf( game.videoRenderHeight ) );
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "auto frameskip", boolToNum( game.isGln64AutoFrameskipEnabled ) );
+        gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "predictive frameskip", boolToNum( game.isGln64PredictiveFrameskipEnabled ) );
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "max frameskip", String.valueOf( game.gln64MaxFrameskip ) );
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "polygon offset hack", boolToNum( global.isPolygonOffsetHackEnabled ) );
         gln64_conf.put( ConfigFile.SECTIONLESS_NAME, "polygon offset factor", String.valueOf( global.videoPolygonOffset ) );
@@ -90,6 +91,8 @@ class NativeConfigFiles
         mupen64plus_cfg.put( "Audio-OpenSLES", "SECONDARY_BUFFER_NBR", String.valueOf( global.audioSLESSecondaryBufferNbr ) );   // Number of secondary buffer.
         mupen64plus_cfg.put( "Audio-OpenSLES", "SAMPLING_RATE", String.valueOf( global.audioSLESSamplingRate ) );                // Sampling rate
         mupen64plus_cfg.put( "Audio-OpenSLES", "TIME_STRETCH_ENABLED", boolToTF( global.enableSLESAudioTimeSretching ) );        // Enable audio time stretching to prevent crackling
+        mupen64plus_cfg.put( "Audio-OpenSLES", "DYNAMIC_RATE_CONTROL", boolToTF( global.enableSLESDynamicRateControl ) );       // Steer the resampling rate by the buffer level instead of time stretching
+        mupen64plus_cfg.put( "Audio-OpenSLES", "AAUDIO_ENABLED", boolToTF( global.audioSLESUseAAudio ) );                        // Use low latency AAudio output if available
 
         mupen64plus_cfg.put( "Core", "Version", "1.010000" );                                                               // Mupen64Plus Core config parameter set version number.  Please don't change this version number.
         mupen64plus_cfg.put( "Core", "OnScreenDisplay", "False" );                                                          // Draw on-screen display if True, otherwise don't draw OSD
@@ -101,6 +104,7 @@ class NativeConfigFiles
         mupen64plus_cfg.put( "Core", "SaveSRAMPath", '"' + game.getSramDataDir() + '"' );                                        // Path to directory where SRAM/EEPROM data (in-game saves) are stored. If this is blank, the default value of ${UserConfigPath}/save will be used
         mupen64plus_cfg.put( "Core", "SharedDataPath", '"' + appData.coreSharedDataDir + '"' );                             // Path to a directory to search when looking for shared data files
         mupen64plus_cfg.put( "Core", "CountPerOp", String.valueOf( game.countPerOp ) );                                     // Count per op
+        mupen64plus_cfg.put( "Core", "RunAheadFrames", String.valueOf( game.runAheadFrames ) );                             // Number of frames emulated ahead of the inputs
 
         mupen64plus_cfg.put( "CoreEvents", "Version", "1.000000" );                                                         // Mupen64Plus CoreEvents config parameter set version number.  Please don't change this version number.
         mupen64plus_cfg.put( "CoreEvents", "Kbd Mapping Stop", EMPTY );
@@ -184,6 +188,7 @@ class NativeConfigFiles
         mupen64plus_cfg.put( "rsp-cxd4", "Version", "1" );
         mupen64plus_cfg.put( "rsp-cxd4", "DisplayListToGraphicsPlugin", boolToNum(game.rspHleVideo) );
         mupen64plus_cfg.put( "rsp-cxd4", "AudioListToAudioPlugin", "0" );
+        mupen64plus_cfg.put( "rsp-cxd4", "AudioListToRspHle", boolToNum(!game.rspHleVideo) );                                // Run audio in HLE when graphics are LLE
         mupen64plus_cfg.put( "rsp-cxd4", "WaitForCPUHost", "0" );
         mupen64plus_cfg.put( "rsp-cxd4", "SupportCPUSemaphoreLock", "0" );
             
@@ -263,12 +268,18 @@ class NativeConfigFiles
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "bilinearMode", String.valueOf( game.glideN64Prefs.bilinearMode ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "MaxAnisotropy", String.valueOf( game.glideN64Prefs.maxAnisotropy ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableNoise", boolToTF( game.glideN64Prefs.enableNoise ) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableShaderNoise", boolToTF( game.glideN64Prefs.enableShaderNoise ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableLOD", boolToTF( game.glideN64Prefs.enableLOD ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableHWLighting", boolToTF( game.glideN64Prefs.enableHWLighting ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "CorrectTexrectCoords", String.valueOf( game.glideN64Prefs.correctTexrectCoords ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableNativeResTexrects", boolToTF( game.glideN64Prefs.enableNativeResTexrects) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableLegacyBlending", boolToTF( game.glideN64Prefs.enableLegacyBlending) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableFragmentDepthWrite", boolToTF( game.glideN64Prefs.enableFragmentDepthWrite) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "ThreadedVideo", boolToTF( game.glideN64Prefs.threadedVideo) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableAsyncShaderCompile", boolToTF( game.glideN64Prefs.enableAsyncShaderCompile) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableVertexCache", boolToTF( game.glideN64Prefs.enableVertexCache) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "FastTextureHash", boolToTF( game.glideN64Prefs.fastTextureHash) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableGPUTMEM", boolToTF( game.glideN64Prefs.enableGPUTMEM) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableBlitScreenWorkaround", boolToTF( global.enableBlitScreenWorkaround) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "EnableFBEmulation", boolToTF( game.glideN64Prefs.enableFBEmulation ));
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "BufferSwapMode", String.valueOf( game.glideN64Prefs.bufferSwapMode ));
@@ -283,6 +294,8 @@ class NativeConfigFiles
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txEnhancementMode", String.valueOf( game.glideN64Prefs.txEnhancementMode ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txDeposterize", boolToTF( game.glideN64Prefs.txDeposterize ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txFilterIgnoreBG", boolToTF( game.glideN64Prefs.txFilterIgnoreBG ) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txAsyncFilter", boolToTF( game.glideN64Prefs.txAsyncFilter ) );
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txGPUEnhancement", boolToTF( game.glideN64Prefs.txGPUEnhancement ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txCacheSize", String.valueOf( game.glideN64Prefs.txCacheSize ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txHiresEnable", boolToTF( game.glideN64Prefs.txHiresEnable ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txPath", global.hiResTextureDir);
@@ -301,6 +314,7 @@ class NativeConfigFiles
             putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txForce16bpp", boolToTF( game.glideN64Prefs.txForce16bpp ) );
             putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txSaveCache", boolToTF( game.glideN64Prefs.txSaveCache ) );
         }
+        putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txEtc2Compression", boolToTF( game.glideN64Prefs.txEtc2Compression ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "txHresAltCRC", boolToTF( game.glideN64Prefs.txHresAltCRC ) );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "fontName", "DroidSans.ttf" );
         putGLideN64Setting(mupen64plus_cfg, glideN64_conf, game, "fontSize", "18" );
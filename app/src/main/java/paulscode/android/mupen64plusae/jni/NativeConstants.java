@@ -39,6 +39,9 @@ public class NativeConstants
     public static final int M64CORE_INPUT_GAMESHARK     = 9;
     public static final int M64CORE_STATE_LOADCOMPLETE  = 10;
     public static final int M64CORE_STATE_SAVECOMPLETE  = 11;
+
+    public static final int M64TRIM_MODERATE            = 1;
+    public static final int M64TRIM_CRITICAL            = 2;
     
     public static final int PAK_TYPE_NONE               = 1;
     public static final int PAK_TYPE_MEMORY             = 2;
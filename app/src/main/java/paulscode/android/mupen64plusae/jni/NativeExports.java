@@ -41,6 +41,18 @@ public class NativeExports
 
     static boolean mLibrariesLoaded = false;
 
+    // Layout of the audioGetStats array
+    // see mupen64plus-audio-sles/src/main.h
+    public static final int AUDIO_STAT_UNDERRUNS = 0;
+    public static final int AUDIO_STAT_QUEUE_MS = 1;
+    public static final int AUDIO_STAT_QUEUE_MIN_MS = 2;
+    public static final int AUDIO_STAT_QUEUE_MAX_MS = 3;
+    public static final int AUDIO_STAT_LATENCY_MS = 4;
+    public static final int AUDIO_STAT_RATIO_PPM = 5;
+    public static final int AUDIO_STAT_SAMPLE_RATE = 6;
+    public static final int AUDIO_STAT_AAUDIO = 7;
+    public static final int AUDIO_STAT_COUNT = 8;
+
 
     
     // TODO: Add javadoc
@@ -100,6 +112,16 @@ public class NativeExports
     static native void emuDestroySurface();
 
     static native void FPSEnabled(int recalc);
+
+    static native int readStatus(int[] status);
+
+    static native void setFramePacing(int mode);
+
+    static native void setPerformanceHint(long targetFrameNs);
+
+    static native int audioGetStats(String audioLib, int[] stats);
+
+    static native int audioGetQueueHistory(String audioLib, int[] history);
     
     static native int emuGetState();
     
@@ -111,6 +133,8 @@ public class NativeExports
 
     static native int emuReset();
 
+    static native void emuTrimMemory(int level);
+
     static native void setNativeWindow(Surface surface);
 
     static native void unsetNativeWindow();
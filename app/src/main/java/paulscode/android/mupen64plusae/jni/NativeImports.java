@@ -20,11 +20,15 @@
  */
 package paulscode.android.mupen64plusae.jni;
 
+import android.os.Handler;
+import android.os.Looper;
+
 import java.util.ArrayList;
 
 /**
- * Call-ins made from the native ae-imports library to Java. Any function names changed here should
- * also be changed in the corresponding C code, and vice versa.
+ * Status posted by the native ae-imports library, polled from the main thread so that the
+ * emulation and render threads never call into Java. The status block layout should also be
+ * changed in the corresponding C code, and vice versa.
  *
  * see jni/ae-bridge/ae_imports.cpp
  */
@@ -58,6 +62,73 @@ public class NativeImports
     //Frame rate info - used by ae-vidext
     private static final ArrayList<OnFpsChangedListener> sFpsListeners = new ArrayList<>();
 
+    // Status block layout, see ae_imports.h
+    private static final int STATUS_FPS = 0;
+    private static final int STATUS_EVENT_COUNT = 1;
+    private static final int STATUS_EVENTS = 2;
+    private static final int STATUS_MAX_EVENTS = 16;
+    private static final int STATUS_SIZE = STATUS_EVENTS + 2 * STATUS_MAX_EVENTS;
+
+    // A new frame rate is posted a few times per second at most, state changes are rare
+    private static final int STATUS_POLL_PERIOD_MS = 50;
+
+    private static final int[] sStatus = new int[STATUS_SIZE];
+    private static final Handler sStatusHandler = new Handler( Looper.getMainLooper() );
+    private static boolean sStatusPolling = false;
+
+    private static final Runnable sStatusPoller = new Runnable()
+    {
+        @Override
+        public void run()
+        {
+            pollStatus();
+
+            synchronized( sStatus )
+            {
+                boolean hasListeners;
+                synchronized( sStateCallbackLock )
+                {
+                    hasListeners = !sStateCallbackListeners.isEmpty();
+                }
+                synchronized( sFpsListeners )
+                {
+                    hasListeners |= !sFpsListeners.isEmpty();
+                }
+
+                sStatusPolling = hasListeners;
+                if( sStatusPolling )
+                    sStatusHandler.postDelayed( this, STATUS_POLL_PERIOD_MS );
+            }
+        }
+    };
+
+    private static void startStatusPolling()
+    {
+        synchronized( sStatus )
+        {
+            if( !sStatusPolling )
+            {
+                sStatusPolling = true;
+                sStatusHandler.postDelayed( sStatusPoller, STATUS_POLL_PERIOD_MS );
+            }
+        }
+    }
+
+    /**
+     * Dispatches the status posted by the native code since the last poll to the listeners.
+     */
+    private static void pollStatus()
+    {
+        if( NativeExports.readStatus( sStatus ) == 0 )
+            return;
+
+        for( int i = 0; i < sStatus[STATUS_EVENT_COUNT]; i++ )
+            stateCallback( sStatus[STATUS_EVENTS + 2 * i], sStatus[STATUS_EVENTS + 2 * i + 1] );
+
+        if( sStatus[STATUS_FPS] >= 0 )
+            FPSCounter( sStatus[STATUS_FPS] );
+    }
+
     static void addOnStateCallbackListener( OnStateCallbackListener listener )
     {
         synchronized( sStateCallbackLock )
@@ -66,6 +137,8 @@ public class NativeImports
             if( !sStateCallbackListeners.contains( listener ) )
                 sStateCallbackListeners.add( listener );
         }
+
+        startStatusPolling();
     }
 
     static void removeOnStateCallbackListener( OnStateCallbackListener listener )
@@ -81,9 +154,8 @@ public class NativeImports
      * 
      * @param paramChanged The changed parameter's ID.
      * @param newValue The new value of the changed parameter.
-     * see mupen64plus-ae/app/src/main/jni/ae-bridge/ae_imports.cpp
      */
-    static void stateCallback( int paramChanged, int newValue )
+    private static void stateCallback( int paramChanged, int newValue )
     {
         synchronized( sStateCallbackLock )
         {
@@ -113,9 +185,11 @@ public class NativeImports
                 NativeExports.FPSEnabled(fpsRecalcPeriod);
             }
         }
+
+        startStatusPolling();
     }
 
-    static void FPSCounter (int fps)
+    private static void FPSCounter (int fps)
     {
         synchronized (sFpsListeners)
         {
@@ -97,6 +97,9 @@ public class AppData
 
     /** True if device is running marshmallow or later (24 - Android 7.0.x) */
     private static final boolean IS_NOUGAT = Build.VERSION.SDK_INT >= Build.VERSION_CODES.N;
+
+    /** True if device is running Oreo MR1 or later (27 - Android 8.1.x) */
+    public static final boolean IS_OREO_MR1 = Build.VERSION.SDK_INT >= Build.VERSION_CODES.O_MR1;
     
     /** The hardware info, refreshed at the beginning of every session. */
     final HardwareInfo hardwareInfo;
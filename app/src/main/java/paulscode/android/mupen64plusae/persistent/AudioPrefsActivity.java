@@ -37,9 +37,11 @@ public class AudioPrefsActivity extends AppCompatPreferenceActivity implements O
 {
     // These constants must match the keys used in res/xml/preferences.xml
     private static final String AUDIO_SLES_TIME_STRETCH = "audioSLESTimeStretch";
+    private static final String AUDIO_SLES_DYNAMIC_RATE = "audioSLESDynamicRate";
     private static final String AUDIO_SLES_BUFFER_NBR = "audioSLESBufferNbr2";
     private static final String AUDIO_SLES_SAMPLING_RATE = "audioSLESSamplingRate2";
     private static final String AUDIO_SLES_FLOATING_POINT = "audioSLESFloatingPoint";
+    private static final String AUDIO_SLES_AAUDIO = "audioSLESAAudio";
     private static final String AUDIO_SYNCHRONIZE = "audioSynchronize";
     private static final String AUDIO_SWAP_CHANNELS = "audioSwapChannels";
 
@@ -112,10 +114,13 @@ public class AudioPrefsActivity extends AppCompatPreferenceActivity implements O
         mGlobalPrefs = new GlobalPrefs(this, mAppData);
 
         // Enable audio prefs if audio is enabled
-        PrefUtil.enablePreference(this, AUDIO_SLES_TIME_STRETCH, mGlobalPrefs.audioPlugin.name.equals(AUDIO_SLES_PLUGIN));
-        PrefUtil.enablePreference(this, AUDIO_SLES_BUFFER_NBR, mGlobalPrefs.audioPlugin.name.equals(AUDIO_SLES_PLUGIN) && mGlobalPrefs.enableSLESAudioTimeSretching);
+        PrefUtil.enablePreference(this, AUDIO_SLES_DYNAMIC_RATE, mGlobalPrefs.audioPlugin.name.equals(AUDIO_SLES_PLUGIN));
+        PrefUtil.enablePreference(this, AUDIO_SLES_TIME_STRETCH, mGlobalPrefs.audioPlugin.name.equals(AUDIO_SLES_PLUGIN) && !mGlobalPrefs.enableSLESDynamicRateControl);
+        PrefUtil.enablePreference(this, AUDIO_SLES_BUFFER_NBR, mGlobalPrefs.audioPlugin.name.equals(AUDIO_SLES_PLUGIN) &&
+            (mGlobalPrefs.enableSLESAudioTimeSretching || mGlobalPrefs.enableSLESDynamicRateControl));
         PrefUtil.enablePreference(this, AUDIO_SLES_SAMPLING_RATE, mGlobalPrefs.audioPlugin.name.equals( AUDIO_SLES_PLUGIN ) );
         PrefUtil.enablePreference(this, AUDIO_SLES_FLOATING_POINT, mGlobalPrefs.audioPlugin.name.equals( AUDIO_SLES_PLUGIN ) );
+        PrefUtil.enablePreference(this, AUDIO_SLES_AAUDIO, mGlobalPrefs.audioPlugin.name.equals( AUDIO_SLES_PLUGIN ) );
         PrefUtil.enablePreference(this, AUDIO_SYNCHRONIZE, mGlobalPrefs.audioPlugin.enabled);
         PrefUtil.enablePreference(this, AUDIO_SWAP_CHANNELS, mGlobalPrefs.audioPlugin.enabled);
 
@@ -123,6 +128,11 @@ public class AudioPrefsActivity extends AppCompatPreferenceActivity implements O
         {
             PrefUtil.removePreference(this, ROOT, AUDIO_SLES_FLOATING_POINT);
         }
+
+        if(!AppData.IS_OREO_MR1)
+        {
+            PrefUtil.removePreference(this, ROOT, AUDIO_SLES_AAUDIO);
+        }
     }
 
     @Override
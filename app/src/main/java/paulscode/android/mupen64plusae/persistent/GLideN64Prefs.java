@@ -32,6 +32,9 @@ public class GLideN64Prefs {
     /** Enable color noise emulation. */
     public final boolean enableNoise;
 
+    /** Compute noise in shaders instead of sampling noise textures. */
+    public final boolean enableShaderNoise;
+
     /** Enable LOD emulation. */
     public final boolean enableLOD;
 
@@ -53,6 +56,21 @@ public class GLideN64Prefs {
     /** Enable writing of fragment depth. Some mobile GPUs do not support it, thus it made optional. Leave enabled. */
     public final boolean enableFragmentDepthWrite;
 
+    /** Execute OpenGL calls in a separate thread. */
+    public final boolean threadedVideo;
+
+    /** Link new shaders in background and keep drawing with the current shader until they are ready. */
+    public final boolean enableAsyncShaderCompile;
+
+    /** Reuse transformed vertices of static geometry. */
+    public final boolean enableVertexCache;
+
+    /** Identify cached textures with xxHash instead of CRC32. */
+    public final boolean fastTextureHash;
+
+    /** Decode textures from TMEM in shaders instead of the texture cache. */
+    public final boolean enableGPUTMEM;
+
     /** Enable frame and|or depth buffer emulation. */
     public final boolean enableFBEmulation;
 
@@ -123,6 +141,12 @@ public class GLideN64Prefs {
     /** Don't filter background textures. */
     public final boolean txFilterIgnoreBG;
 
+    /** Filter textures in background, unfiltered textures are shown meanwhile. */
+    public final boolean txAsyncFilter;
+
+    /** Run xBRZ texture enhancement in a compute shader. */
+    public final boolean txGPUEnhancement;
+
     /** Size of filtered textures cache in megabytes. */
     public final int txCacheSize;
 
@@ -141,6 +165,9 @@ public class GLideN64Prefs {
     /** Force use 16bit texture formats for HD textures. */
     public final boolean txForce16bpp;
 
+    /** Compress HD and enhanced textures to ETC2. */
+    public final boolean txEtc2Compression;
+
     /** Save texture cache to hard disk. */
     public final boolean txSaveCache;
 
@@ -157,12 +184,18 @@ public class GLideN64Prefs {
         bilinearMode = getSafeInt( emulationProfile, "bilinearMode", 0);
         maxAnisotropy = getSafeInt( emulationProfile, "MaxAnisotropy", 0);
         enableNoise = emulationProfile.get( "EnableNoise", "True" ).equals( "True" );
+        enableShaderNoise = emulationProfile.get( "EnableShaderNoise", "False" ).equals( "True" );
         enableLOD = emulationProfile.get( "EnableLOD", "True" ).equals( "True" );
         enableHWLighting = emulationProfile.get( "EnableHWLighting", "False" ).equals( "True" );
         correctTexrectCoords = getSafeInt( emulationProfile, "CorrectTexrectCoords", 0);
 
         enableLegacyBlending = emulationProfile.get( "EnableLegacyBlending", "True" ).equals( "True" );
         enableFragmentDepthWrite = emulationProfile.get( "EnableFragmentDepthWrite", "False" ).equals( "True" );
+        threadedVideo = emulationProfile.get( "ThreadedVideo", "False" ).equals( "True" );
+        enableAsyncShaderCompile = emulationProfile.get( "EnableAsyncShaderCompile", "False" ).equals( "True" );
+        enableVertexCache = emulationProfile.get( "EnableVertexCache", "False" ).equals( "True" );
+        fastTextureHash = emulationProfile.get( "FastTextureHash", "True" ).equals( "True" );
+        enableGPUTMEM = emulationProfile.get( "EnableGPUTMEM", "False" ).equals( "True" );
         enableFBEmulation = emulationProfile.get( "EnableFBEmulation", "True" ).equals( "True" );
         bufferSwapMode = getSafeInt( emulationProfile, "BufferSwapMode", 2);
         enableCopyColorToRDRAM = getSafeInt( emulationProfile, "EnableCopyColorToRDRAM", 0);
@@ -191,12 +224,15 @@ public class GLideN64Prefs {
         txEnhancementMode = enableNativeResTexrects ? 0 :getSafeInt( emulationProfile, "txEnhancementMode", 0);
         txDeposterize = emulationProfile.get( "txDeposterize", "False" ).equals( "True" );
         txFilterIgnoreBG = emulationProfile.get( "txFilterIgnoreBG", "True" ).equals( "True" );
+        txAsyncFilter = emulationProfile.get( "txAsyncFilter", "False" ).equals( "True" );
+        txGPUEnhancement = emulationProfile.get( "txGPUEnhancement", "False" ).equals( "True" );
         txCacheSize = getSafeInt( emulationProfile, "txCacheSize", 128);
         txHiresEnable = emulationProfile.get( "txHiresEnable", "False" ).equals( "True" );
         txHiresFullAlphaChannel = emulationProfile.get( "txHiresFullAlphaChannel", "False" ).equals( "True" );
         txHresAltCRC = emulationProfile.get( "txHresAltCRC", "False" ).equals( "True" );
         txCacheCompression = emulationProfile.get( "txCacheCompression", "True" ).equals( "True" );
         txForce16bpp = emulationProfile.get( "txForce16bpp", "False" ).equals( "True" );
+        txEtc2Compression = emulationProfile.get( "txEtc2Compression", "False" ).equals( "True" );
         txSaveCache = emulationProfile.get( "txSaveCache", "False" ).equals( "True" );
         forceGammaCorrection = emulationProfile.get( "ForceGammaCorrection", "False" ).equals( "True" );
         gammaCorrectionLevel = getSafeInt( emulationProfile, "GammaCorrectionLevel", 10)/10.0f;
@@ -163,6 +163,9 @@ public class GamePrefs
     /** True if auto-frameskip is enabled in the gln64 library. */
     public final boolean isGln64AutoFrameskipEnabled;
 
+    /** True if auto-frameskip in the gln64 library predicts skips from the measured frame cost. */
+    public final boolean isGln64PredictiveFrameskipEnabled;
+
     /** True if fog is enabled in the gln64 library. */
     public final boolean isGln64FogEnabled;
 
@@ -275,6 +278,9 @@ public class GamePrefs
     /** Core CountPerOp setting */
     public final int countPerOp;
 
+    /** Number of frames the core emulates ahead of the inputs, 0 to disable */
+    public final int runAheadFrames;
+
     /** The method used for auto holding buttons. */
     public final int touchscreenAutoHold;
 
@@ -438,6 +444,7 @@ public class GamePrefs
         int maxFrameskip = getSafeInt( emulationProfile, "gln64Frameskip", 0 );
         isGln64AutoFrameskipEnabled = maxFrameskip < 0;
         gln64MaxFrameskip = Math.abs( maxFrameskip );
+        isGln64PredictiveFrameskipEnabled = emulationProfile.get( "gln64PredictiveFrameskip", "0" ).equals( "1" );
         isGln64FogEnabled = emulationProfile.get( "gln64Fog", "0" ).equals( "1" );
         isGln64SaiEnabled = emulationProfile.get( "gln64Sai", "0" ).equals( "1" );
         isGln64ScreenClearEnabled = emulationProfile.get( "gln64ScreenClear", "1" ).equals( "1" );
@@ -574,6 +581,7 @@ public class GamePrefs
 
         //A value of zero means default for the game as specified in mupen64plus.ini
         countPerOp = mPreferences.getInt( "screenAdvancedCountPerOp", 0 );
+        runAheadFrames = mPreferences.getInt( "screenAdvancedRunAheadFrames", 0 );
     }
 
     private void actionReloadAssets(Context context)
@@ -102,6 +102,9 @@ public class GlobalPrefs
     /** The subdirectory containing crash logs. */
     public final String crashLogDir;
 
+    /** The subdirectory containing the per-ROM performance profiles. */
+    public final String performanceProfilesDir;
+
     /** The subdirectory returned from the core's ConfigGetUserDataPath() method. */
     public final String coreUserDataDir;
 
@@ -243,6 +246,15 @@ public class GlobalPrefs
     /** True if immersive mode should be used (KitKat only). */
     public final boolean isImmersiveModeEnabled;
 
+    /** Frame pacing mode: 0 off, 1 smooth, 2 low latency. */
+    public final int displayFramePacing;
+
+    /** True if the game window asks for sustained performance mode (Nougat and up). */
+    public final boolean isSustainedPerformanceModeEnabled;
+
+    /** True if performance settings are timed and tuned per ROM. */
+    public final boolean isPerformanceProfileEnabled;
+
     /** True if framelimiter is used. */
     public final boolean isFramelimiterEnabled;
 
@@ -264,6 +276,9 @@ public class GlobalPrefs
     /** Stretch audio to prevent crackling in SLES audio plugin */
     public final boolean enableSLESAudioTimeSretching;
 
+    /** Resample audio with the rate steered by the buffer level instead of stretching it */
+    public final boolean enableSLESDynamicRateControl;
+
     /** Size of secondary buffer in output samples. This is SLES's hardware buffer, which directly affects latency. */
     public final int audioSLESSecondaryBufferSize;
 
@@ -276,6 +291,9 @@ public class GlobalPrefs
     /** Use SLES floating point samples */
     public final boolean audioSLESFloatingPoint;
 
+    /** Use low latency AAudio output instead of SLES */
+    public final boolean audioSLESUseAAudio;
+
     /** True if big-screen navigation mode is enabled. */
     public final boolean isBigScreenMode;
 
@@ -387,6 +405,7 @@ public class GlobalPrefs
         unzippedRomsDir = galleryCacheDir + "/UnzippedRoms";
         String profilesDir = appData.userDataDir + "/Profiles";
         crashLogDir = appData.userDataDir + "/CrashLogs";
+        performanceProfilesDir = appData.userDataDir + "/PerformanceProfiles";
         final String coreConfigDir = appData.userDataDir + "/CoreConfig";
         coreUserDataDir = coreConfigDir + "/UserData";
         coreUserCacheDir = coreConfigDir + "/UserCache";
@@ -447,6 +466,9 @@ public class GlobalPrefs
         isImmersiveModeEnabled = mPreferences.getBoolean( "displayImmersiveMode_v2", true );
         DetermineResolutionData(context);
         displayOrientation = getSafeInt( mPreferences, "displayOrientation", 0 );
+        displayFramePacing = getSafeInt( mPreferences, "displayFramePacing", 0 );
+        isSustainedPerformanceModeEnabled = mPreferences.getBoolean( "displaySustainedPerformance", false );
+        isPerformanceProfileEnabled = mPreferences.getBoolean( "displayPerformanceProfile", false );
         final int transparencyPercent = mPreferences.getInt( "displayActionBarTransparency", 80 );
         displayActionBarTransparency = ( 255 * transparencyPercent ) / 100;
 
@@ -522,14 +544,17 @@ public class GlobalPrefs
         AudioManager audioManager = (AudioManager) context.getSystemService(Context.AUDIO_SERVICE);
         audioSwapChannels = mPreferences.getBoolean( "audioSwapChannels", false );
         enableSLESAudioTimeSretching = mPreferences.getBoolean( "audioSLESTimeStretch", true );
+        enableSLESDynamicRateControl = mPreferences.getBoolean( "audioSLESDynamicRate", false );
         audioSLESSecondaryBufferNbr = getSafeInt( mPreferences, "audioSLESBufferNbr2", 10 );
         audioSLESFloatingPoint = mPreferences.getBoolean( "audioSLESFloatingPoint", false );
+        audioSLESUseAAudio = AppData.IS_OREO_MR1 && mPreferences.getBoolean( "audioSLESAAudio", true );
 
-        boolean audioSlesSamplingRateGame = mPreferences.getString( "audioSLESSamplingRate2", "game" ).equals("game");
+        boolean audioSlesSamplingRateGame = mPreferences.getString( "audioSLESSamplingRate2", "auto" ).equals("game");
 
         int tempAudioSLESSamplingRate = 0;
 
-        //If sampling rate is not set to game, then automatically determine best sampling rate
+        //If sampling rate is not set to game, then use the native rate of the device. The plugin
+        //resamples to it, so Android doesn't resample again and can use its fast mixer path
         if(!audioSlesSamplingRateGame) {
             try {
                 tempAudioSLESSamplingRate = Integer.parseInt(audioManager.getProperty(AudioManager.PROPERTY_OUTPUT_SAMPLE_RATE));
@@ -42,7 +42,6 @@ import org.apache.commons.compress.archivers.sevenz.SevenZArchiveEntry;
 import org.apache.commons.compress.archivers.sevenz.SevenZFile;
 import org.mupen64plusae.v3.alpha.R;
 
-import java.io.BufferedInputStream;
 import java.io.File;
 import java.io.IOException;
 import java.io.InputStream;
@@ -159,18 +158,20 @@ public class ExtractRomService extends Service {
                 while (entries.hasMoreElements() && !lbFound) {
                     final ZipEntry zipEntry = entries.nextElement();
 
+                    final String entryName = new File(zipEntry.getName()).getName();
+                    lbFound = entryName.equals(romFileName);
+
+                    // Only inflate the entry we are looking for
+                    if (!lbFound) {
+                        continue;
+                    }
+
                     try {
                         final InputStream zipStream = zipFile.getInputStream(zipEntry);
-
                         final File destDir = new File(mExtractZipPath);
-                        final String entryName = new File(zipEntry.getName()).getName();
-
-                        lbFound = entryName.equals(romFileName);
 
-                        if(entryName.equals(romFileName)) {
-                            File tempRomPath = FileUtil.extractRomFile(destDir, zipEntry.getName(), zipStream);
-                            Log.i("ExtractRomService", "Extracted zip entry: " + tempRomPath);
-                        }
+                        File tempRomPath = FileUtil.extractRomFile(destDir, zipEntry.getName(), zipStream);
+                        Log.i("ExtractRomService", "Extracted zip entry: " + tempRomPath);
 
                         zipStream.close();
                     } catch (final IOException e) {
@@ -198,18 +199,20 @@ public class ExtractRomService extends Service {
 
                 while( (zipEntry = zipFile.getNextEntry()) != null && !lbFound)
                 {
-                    try {
-                        final InputStream zipStream = new BufferedInputStream(new SevenZInputStream(zipFile));
+                    final String entryName = new File(zipEntry.getName()).getName();
+                    lbFound = entryName.equals(romFileName);
 
-                        final File destDir = new File(mExtractZipPath);
-                        final String entryName = new File(zipEntry.getName()).getName();
+                    // Entries are decoded lazily, skipping over the others is cheap
+                    if (!lbFound) {
+                        continue;
+                    }
 
-                        lbFound = entryName.equals(romFileName);
+                    try {
+                        final InputStream zipStream = new SevenZInputStream(zipFile);
+                        final File destDir = new File(mExtractZipPath);
 
-                        if (entryName.equals(romFileName)) {
-                            File tempRomPath = FileUtil.extractRomFile(destDir, zipEntry.getName(), zipStream);
-                            Log.i("ExtractRomService", "Extracted zip entry: " + tempRomPath);
-                        }
+                        File tempRomPath = FileUtil.extractRomFile(destDir, zipEntry.getName(), zipStream);
+                        Log.i("ExtractRomService", "Extracted zip entry: " + tempRomPath);
 
                         zipStream.close();
                     } catch (final IOException e) {
@@ -33,6 +33,23 @@ public enum CountryCode {
 	public byte getValue() {
 		return value;
 	}
+
+	// Same PAL codes as the core, every other code runs at the NTSC VI rate
+	public boolean isPal() {
+		switch (this) {
+		case GERMANY:
+		case FRANCE:
+		case ITALY:
+		case EUROPE_1:
+		case SPAIN:
+		case AUSTRALIA:
+		case EUROPE_2:
+		case AUSTRALIA_ALT:
+			return true;
+		default:
+			return false;
+		}
+	}
 	
 	@Override
 	public String toString() {
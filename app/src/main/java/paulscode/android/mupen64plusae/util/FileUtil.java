@@ -509,10 +509,13 @@ public final class FileUtil
         zipStream.close();
     }
 
+    /** Size of the copy buffer used when inflating ROM archive entries */
+    private static final int EXTRACT_BUFFER_SIZE = 64 * 1024;
+
     public static File extractRomFile( File destDir, String zipEntryName, InputStream inStream )
     {        
         // Read the first 4 bytes of the entry
-        byte[] buffer = new byte[1024];
+        byte[] buffer = new byte[EXTRACT_BUFFER_SIZE];
         try
         {
             if( inStream.read( buffer, 0, 4 ) != 4 )
@@ -529,30 +532,32 @@ public final class FileUtil
         makeDirs(destDir.getPath());
         String entryName = new File( zipEntryName ).getName();
         File extractedFile = new File( destDir, entryName );
+
+        // Stream into a temporary file first so an interrupted extraction never leaves a
+        // truncated ROM behind that later looks like a valid cached copy
+        File tempFile = new File( destDir, entryName + ".part" );
+        boolean success = false;
         try
         {
             // Open the output stream (throws exceptions)
-            OutputStream outStream = new FileOutputStream( extractedFile );
+            OutputStream outStream = new FileOutputStream( tempFile );
             try
             {
-                // Buffer the stream
-                outStream = new BufferedOutputStream( outStream );
-                
                 // Write the first four bytes we already peeked at (throws exceptions)
                 outStream.write( buffer, 0, 4 );
                 
-                // Read/write the remainder of the zip entry (throws exceptions)
+                // Read/write the remainder of the zip entry (throws exceptions), the copy
+                // buffer is large enough that no extra buffering layer is needed
                 int n;
                 while( ( n = inStream.read( buffer ) ) >= 0 )
                 {
                     outStream.write( buffer, 0, n );
                 }
-                return extractedFile;
+                success = true;
             }
             catch( IOException e )
             {
                 Log.w( "extractRomFile", e );
-                return null;
             }
             finally
             {
@@ -563,8 +568,16 @@ public final class FileUtil
         catch( IOException e )
         {
             Log.w( "extractRomFile", e );
+        }
+
+        if( !success || !tempFile.renameTo( extractedFile ) )
+        {
+            if( tempFile.exists() && !tempFile.delete() )
+                Log.w( "extractRomFile", "Unable to remove " + tempFile.getPath() );
             return null;
         }
+
+        return extractedFile;
     }
 
     public static String ExtractFirstROMFromZip(String zipPath, String unzippedRomDir)
@@ -23,9 +23,13 @@ LOCAL_PATH := $(call my-dir)
 MY_LOCAL_C_INCLUDES := $(M64P_API_INCLUDES)
 
 MY_LOCAL_SRC_FILES :=            \
+    aaudio_output.cpp           \
     main.cpp                    \
     osal_dynamiclib_unix.cpp    \
-    threadqueue.cpp             \
+    resampler.cpp               \
+    ringbuffer.cpp              \
+    samples.cpp                 \
+    telemetry.cpp               \
 
 MY_LOCAL_CFLAGS :=         \
     $(COMMON_CFLAGS)    \
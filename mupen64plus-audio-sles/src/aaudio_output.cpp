@@ -0,0 +1,319 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - aaudio_output.cpp                            *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <aaudio/AAudio.h>
+#include <android/log.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+
+#include "aaudio_output.h"
+#include "ringbuffer.h"
+
+#define LOG_TAG "aaudio-output"
+
+/* Number of bursts the device buffer is sized to, two is the usual minimum
+   that still allows the callback to be scheduled late once without glitching */
+#define BURSTS_PER_BUFFER 2
+
+/* AAudio entry points, resolved from libaaudio.so at runtime */
+static void* l_AAudioLib = NULL;
+static decltype(&AAudio_createStreamBuilder) p_createStreamBuilder = NULL;
+static decltype(&AAudio_convertResultToText) p_convertResultToText = NULL;
+static decltype(&AAudioStreamBuilder_setSampleRate) p_setSampleRate = NULL;
+static decltype(&AAudioStreamBuilder_setChannelCount) p_setChannelCount = NULL;
+static decltype(&AAudioStreamBuilder_setFormat) p_setFormat = NULL;
+static decltype(&AAudioStreamBuilder_setSharingMode) p_setSharingMode = NULL;
+static decltype(&AAudioStreamBuilder_setPerformanceMode) p_setPerformanceMode = NULL;
+static decltype(&AAudioStreamBuilder_setDataCallback) p_setDataCallback = NULL;
+static decltype(&AAudioStreamBuilder_setErrorCallback) p_setErrorCallback = NULL;
+static decltype(&AAudioStreamBuilder_openStream) p_openStream = NULL;
+static decltype(&AAudioStreamBuilder_delete) p_deleteBuilder = NULL;
+static decltype(&AAudioStream_requestStart) p_requestStart = NULL;
+static decltype(&AAudioStream_requestStop) p_requestStop = NULL;
+static decltype(&AAudioStream_close) p_close = NULL;
+static decltype(&AAudioStream_getFramesPerBurst) p_getFramesPerBurst = NULL;
+static decltype(&AAudioStream_setBufferSizeInFrames) p_setBufferSizeInFrames = NULL;
+static decltype(&AAudioStream_getSampleRate) p_getSampleRate = NULL;
+static decltype(&AAudioStream_getSharingMode) p_getSharingMode = NULL;
+static decltype(&AAudioStream_getFramesWritten) p_getFramesWritten = NULL;
+static decltype(&AAudioStream_getTimestamp) p_getTimestamp = NULL;
+
+/* Stream state, l_StreamLock serializes open/close against the restart thread */
+static pthread_mutex_t l_StreamLock = PTHREAD_MUTEX_INITIALIZER;
+static AAudioStream* l_Stream = NULL;
+static int l_RequestedRate = 0;
+static int l_SampleRate = 0;
+static bool l_FloatSamples = false;
+static unsigned int l_FrameBytes = 4;
+
+static RingBuffer l_Ring;
+static std::atomic<bool> l_Primed(false);
+static std::atomic<unsigned int> l_Underruns(0);
+
+template<typename T>
+static bool LoadSymbol(T& func, const char* name)
+{
+    func = (T) dlsym(l_AAudioLib, name);
+    return func != NULL;
+}
+
+static bool LoadLibrary(void)
+{
+    if (l_AAudioLib != NULL)
+        return true;
+
+    l_AAudioLib = dlopen("libaaudio.so", RTLD_NOW);
+    if (l_AAudioLib == NULL)
+        return false;
+
+    if (!LoadSymbol(p_createStreamBuilder, "AAudio_createStreamBuilder") ||
+        !LoadSymbol(p_convertResultToText, "AAudio_convertResultToText") ||
+        !LoadSymbol(p_setSampleRate, "AAudioStreamBuilder_setSampleRate") ||
+        !LoadSymbol(p_setChannelCount, "AAudioStreamBuilder_setChannelCount") ||
+        !LoadSymbol(p_setFormat, "AAudioStreamBuilder_setFormat") ||
+        !LoadSymbol(p_setSharingMode, "AAudioStreamBuilder_setSharingMode") ||
+        !LoadSymbol(p_setPerformanceMode, "AAudioStreamBuilder_setPerformanceMode") ||
+        !LoadSymbol(p_setDataCallback, "AAudioStreamBuilder_setDataCallback") ||
+        !LoadSymbol(p_setErrorCallback, "AAudioStreamBuilder_setErrorCallback") ||
+        !LoadSymbol(p_openStream, "AAudioStreamBuilder_openStream") ||
+        !LoadSymbol(p_deleteBuilder, "AAudioStreamBuilder_delete") ||
+        !LoadSymbol(p_requestStart, "AAudioStream_requestStart") ||
+        !LoadSymbol(p_requestStop, "AAudioStream_requestStop") ||
+        !LoadSymbol(p_close, "AAudioStream_close") ||
+        !LoadSymbol(p_getFramesPerBurst, "AAudioStream_getFramesPerBurst") ||
+        !LoadSymbol(p_setBufferSizeInFrames, "AAudioStream_setBufferSizeInFrames") ||
+        !LoadSymbol(p_getSampleRate, "AAudioStream_getSampleRate") ||
+        !LoadSymbol(p_getSharingMode, "AAudioStream_getSharingMode") ||
+        !LoadSymbol(p_getFramesWritten, "AAudioStream_getFramesWritten") ||
+        !LoadSymbol(p_getTimestamp, "AAudioStream_getTimestamp"))
+    {
+        __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "libaaudio.so is missing entry points");
+        dlclose(l_AAudioLib);
+        l_AAudioLib = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static aaudio_data_callback_result_t DataCallback(AAudioStream* stream, void* userData, void* audioData, int32_t numFrames)
+{
+    size_t bytes = (size_t) numFrames * l_FrameBytes;
+    size_t read = l_Ring.read(audioData, bytes);
+
+    if (read < bytes)
+    {
+        memset((unsigned char*) audioData + read, 0, bytes - read);
+
+        /* Don't count the silence before the first samples arrived */
+        if (l_Primed.load(std::memory_order_relaxed))
+            ++l_Underruns;
+    }
+
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+static bool OpenStream(aaudio_sharing_mode_t sharingMode);
+static void CloseStream(void);
+
+static void* RestartThread(void* param)
+{
+    pthread_mutex_lock(&l_StreamLock);
+
+    if (l_Stream != NULL)
+    {
+        CloseStream();
+
+        if (!OpenStream(AAUDIO_SHARING_MODE_EXCLUSIVE) && !OpenStream(AAUDIO_SHARING_MODE_SHARED))
+            __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Couldn't reopen AAudio stream");
+    }
+
+    pthread_mutex_unlock(&l_StreamLock);
+
+    return NULL;
+}
+
+static void ErrorCallback(AAudioStream* stream, void* userData, aaudio_result_t error)
+{
+    __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "AAudio stream error: %s", p_convertResultToText(error));
+
+    /* The stream can't be closed from its own callback. Reopen it from a
+       separate thread, e.g. to follow a switch to headphones */
+    if (error == AAUDIO_ERROR_DISCONNECTED)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, RestartThread, NULL) == 0)
+            pthread_detach(thread);
+    }
+}
+
+static bool OpenStream(aaudio_sharing_mode_t sharingMode)
+{
+    AAudioStreamBuilder* builder = NULL;
+    aaudio_result_t result = p_createStreamBuilder(&builder);
+    if (result != AAUDIO_OK)
+        return false;
+
+    p_setSampleRate(builder, l_RequestedRate);
+    p_setChannelCount(builder, 2);
+    p_setFormat(builder, l_FloatSamples ? AAUDIO_FORMAT_PCM_FLOAT : AAUDIO_FORMAT_PCM_I16);
+    p_setSharingMode(builder, sharingMode);
+    p_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    p_setDataCallback(builder, DataCallback, NULL);
+    p_setErrorCallback(builder, ErrorCallback, NULL);
+
+    AAudioStream* stream = NULL;
+    result = p_openStream(builder, &stream);
+    p_deleteBuilder(builder);
+
+    if (result != AAUDIO_OK)
+    {
+        __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Couldn't open %s AAudio stream: %s",
+            sharingMode == AAUDIO_SHARING_MODE_EXCLUSIVE ? "exclusive" : "shared",
+            p_convertResultToText(result));
+        return false;
+    }
+
+    /* Keep the device buffer as small as the burst size negotiated with the
+       hardware allows, the ring buffer in front of it absorbs the jitter */
+    int32_t burst = p_getFramesPerBurst(stream);
+    if (burst > 0)
+        p_setBufferSizeInFrames(stream, burst * BURSTS_PER_BUFFER);
+
+    result = p_requestStart(stream);
+    if (result != AAUDIO_OK)
+    {
+        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Couldn't start AAudio stream: %s", p_convertResultToText(result));
+        p_close(stream);
+        return false;
+    }
+
+    l_Stream = stream;
+    l_SampleRate = p_getSampleRate(stream);
+
+    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Opened %s AAudio stream: %d Hz, burst %d frames",
+        p_getSharingMode(stream) == AAUDIO_SHARING_MODE_EXCLUSIVE ? "exclusive" : "shared",
+        l_SampleRate, burst);
+
+    return true;
+}
+
+static void CloseStream(void)
+{
+    if (l_Stream == NULL)
+        return;
+
+    p_requestStop(l_Stream);
+    p_close(l_Stream);
+    l_Stream = NULL;
+}
+
+int aaudio_open(int sampleRate, bool floatSamples, unsigned int bufferFrames)
+{
+    if (!LoadLibrary())
+        return 0;
+
+    pthread_mutex_lock(&l_StreamLock);
+
+    CloseStream();
+
+    l_RequestedRate = sampleRate;
+    l_FloatSamples = floatSamples;
+    l_FrameBytes = floatSamples ? 8 : 4;
+    l_Primed = false;
+    l_Underruns = 0;
+
+    bool success = l_Ring.init(bufferFrames * l_FrameBytes) &&
+        (OpenStream(AAUDIO_SHARING_MODE_EXCLUSIVE) || OpenStream(AAUDIO_SHARING_MODE_SHARED));
+
+    if (!success)
+        l_Ring.release();
+
+    pthread_mutex_unlock(&l_StreamLock);
+
+    return success ? l_SampleRate : 0;
+}
+
+void aaudio_close(void)
+{
+    pthread_mutex_lock(&l_StreamLock);
+
+    CloseStream();
+    l_Ring.release();
+
+    pthread_mutex_unlock(&l_StreamLock);
+}
+
+bool aaudio_is_open(void)
+{
+    return l_Ring.capacity() != 0;
+}
+
+unsigned int aaudio_write(const void* frames, unsigned int count)
+{
+    l_Primed = true;
+    return l_Ring.write(frames, (size_t) count * l_FrameBytes) / l_FrameBytes;
+}
+
+unsigned int aaudio_queued_frames(void)
+{
+    return l_Ring.readAvailable() / l_FrameBytes;
+}
+
+unsigned int aaudio_underruns(void)
+{
+    return l_Underruns;
+}
+
+int aaudio_latency_frames(void)
+{
+    int latency = -1;
+
+    pthread_mutex_lock(&l_StreamLock);
+
+    if (l_Stream != NULL && l_SampleRate > 0)
+    {
+        int64_t framePosition = 0;
+        int64_t frameTime = 0;
+
+        /* The timestamp tells when a given frame was presented, extrapolate
+           it to now and compare with what the callback handed over so far */
+        if (p_getTimestamp(l_Stream, CLOCK_MONOTONIC, &framePosition, &frameTime) == AAUDIO_OK)
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t elapsed = ((int64_t) now.tv_sec * 1000000000LL + now.tv_nsec) - frameTime;
+            int64_t presented = framePosition + elapsed * l_SampleRate / 1000000000LL;
+            int64_t pending = p_getFramesWritten(l_Stream) - presented;
+
+            if (pending < 0)
+                pending = 0;
+
+            latency = (int) pending + (int) aaudio_queued_frames();
+        }
+    }
+
+    pthread_mutex_unlock(&l_StreamLock);
+
+    return latency;
+}
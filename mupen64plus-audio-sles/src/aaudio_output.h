@@ -0,0 +1,49 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - aaudio_output.h                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __AAUDIO_OUTPUT_H__
+#define __AAUDIO_OUTPUT_H__
+
+/* AAudio output stream fed from a ring buffer by the data callback.
+   libaaudio is loaded at runtime so the plugin still runs on Android versions
+   without it, in which case aaudio_open fails and OpenSL ES should be used. */
+
+/* Opens a stereo low latency stream. floatSamples selects 32 bit float instead
+   of 16 bit integer samples, bufferFrames is the size of the ring buffer that
+   sits in front of the device. Returns the sample rate the device actually
+   opened with, or 0 on failure. */
+int aaudio_open(int sampleRate, bool floatSamples, unsigned int bufferFrames);
+void aaudio_close(void);
+bool aaudio_is_open(void);
+
+/* Queues frames for playback, returns how many fit into the ring buffer */
+unsigned int aaudio_write(const void* frames, unsigned int count);
+
+/* Number of frames queued but not yet handed to the device */
+unsigned int aaudio_queued_frames(void);
+
+/* Number of times the device had to play silence because the ring ran dry */
+unsigned int aaudio_underruns(void);
+
+/* Frames between the ring buffer input and the speaker, measured with the
+   stream timestamps. Returns -1 while the device has no timestamp yet. */
+int aaudio_latency_frames(void);
+
+#endif /* __AAUDIO_OUTPUT_H__ */
@@ -0,0 +1,39 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - ai_dump.h                                    *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __AI_DUMP_H__
+#define __AI_DUMP_H__
+
+#include <stdint.h>
+
+/* Format of the AI DMA streams saved by the plugin when it is built with
+   ENABLE_AI_DUMP, which tools/audio_bench replays. The file starts with
+   AI_DUMP_MAGIC, followed by one record per AI DMA: an ai_dump_record header
+   in host order and then the samples exactly as the game left them in RDRAM. */
+#define AI_DUMP_MAGIC "AIDUMP01"
+#define AI_DUMP_MAGIC_SIZE 8
+
+struct ai_dump_record
+{
+    uint32_t frequency;
+    uint32_t length;
+};
+
+#endif /* __AI_DUMP_H__ */
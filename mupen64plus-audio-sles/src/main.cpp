@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <errno.h>
 #include <math.h>
 #include <SoundTouch.h>
@@ -42,9 +43,17 @@
 #include "m64p_frontend.h"
 #include "main.h"
 #include "osal_dynamiclib.h"
-#include "threadqueue.h"
+#include "aaudio_output.h"
+#include "ringbuffer.h"
+#include "resampler.h"
+#include "samples.h"
+#include "telemetry.h"
 #include <jni.h>
 
+#ifdef ENABLE_AI_DUMP
+#include "ai_dump.h"
+#endif
+
 #include <SLES/OpenSLES_Android.h>
 
 typedef struct slesState
@@ -56,10 +65,6 @@ typedef struct slesState
 
 } slesState;
 
-/* Default start-time size of primary buffer (in equivalent output samples).
-   This is the buffer where audio is loaded after it's extracted from n64's memory. */
-#define PRIMARY_BUFFER_SIZE 16384
-
 /* Size of a single secondary buffer, in output samples. This is the requested size of OpenSLES's
    hardware buffer, this should be a power of two. */
 #define DEFAULT_SECONDARY_BUFFER_SIZE 256
@@ -73,6 +78,14 @@ typedef struct slesState
 /* This is the requested number of OpenSLES's hardware buffers */
 #define SECONDARY_BUFFER_NBR 100
 
+/* Size of the queue between the emulation thread and the audio consumer thread, in bytes. The
+   samples are stored already converted to the output format. */
+#define AUDIO_QUEUE_SIZE (256 * 1024)
+
+/* Maximum deviation from the nominal rate the dynamic rate control may apply, small enough to
+   not be audible as a change in pitch */
+#define MAX_RATE_DELTA 0.005
+
 /* number of bytes per sample */
 #define N64_SAMPLE_BYTES 4
 
@@ -90,12 +103,6 @@ static m64p_handle l_ConfigAudio;
 
 /* Read header for type definition */
 static AUDIO_INFO AudioInfo;
-/* Pointer to the primary audio buffer */
-static unsigned char *primaryBuffer = NULL;
-/* Size of the primary buffer */
-static int primaryBufferBytes = 0;
-/* Size of the primary audio buffer in equivalent output samples */
-static int PrimaryBufferSize = PRIMARY_BUFFER_SIZE;
 /* Pointer to secondary buffers */
 static unsigned char ** secondaryBuffers = NULL;
 /* Size of a single secondary audio buffer in output samples */
@@ -104,12 +111,18 @@ static int SecondaryBufferSize = DEFAULT_SECONDARY_BUFFER_SIZE;
 static int TimeStretchEnabled = true;
 /* Index of the next secondary buffer available */
 static int secondaryBufferIndex = 0;
+/* Number of frames already resampled into the current secondary buffer */
+static int secondaryBufferFill = 0;
+/** Dynamic rate control enabled */
+static int DynamicRateEnabled = 0;
 /* Number of secondary buffers */
 static unsigned int SecondaryBufferNbr = SECONDARY_BUFFER_NBR;
 /* Audio frequency, this is usually obtained from the game, but for compatibility we set default value */
 static int GameFreq = DEFAULT_FREQUENCY;
 /* SpeedFactor is used to increase/decrease game playback speed */
 static unsigned int speed_factor = 100;
+/* Speed factor set by the core, speed_factor is lower while fast-forward skips audio */
+static unsigned int game_speed_factor = 100;
 /* If this is true then left and right channels are swapped */
 static int SwapChannels = 0;
 /* Number of secondary buffers to target */
@@ -118,25 +131,44 @@ static int TargetSecondaryBuffers = 20;
 static int SamplingRateSelection = 0;
 /* Output Audio frequency */
 static int OutputFreq;
+/* Use AAudio instead of OpenSLES for output when the device supports it */
+static int AAudioEnabled = 0;
 /* Indicate that the audio plugin failed to initialize, so the emulator can keep running without sound */
 static int critical_failure = 0;
 
+using namespace soundtouch;
+
+/* Header of each queue entry. The frames that follow it are read in place, wrapData and
+   wrapFrames describe the part of them stored at the start of the queue after it wrapped */
 typedef struct queueData_ {
-    unsigned char *data;
-    unsigned int length;
+    const SAMPLETYPE *data;
+    const SAMPLETYPE *wrapData;
+    unsigned int frames;
+    unsigned int wrapFrames;
     timespec timestamp;
 } queueData;
 
-void processAudio(const unsigned char* buffer, unsigned int length);
+/* Keeps every entry aligned to whole frames so an entry never wraps in the middle of one */
+static_assert(sizeof(queueData) % SLES_SAMPLE_BYTES == 0, "queueData must be a multiple of the frame size");
+
+void processAudio(const queueData* entry);
+void resampleAudio(const queueData* entry);
+static void QueueSecondaryBuffer(int outSamples);
+void UpdateAAudioState(void);
 static void* audioConsumerStretch(void*);
 static void* audioConsumerNoStretch(void*);
+static void* audioConsumerResample(void*);
 static pthread_t audioConsumerThread;
-static struct threadqueue audioConsumerQueue;
+
+/* Each queue entry is a queueData header followed by the samples. The emulation thread is the only
+   producer and the consumer thread the only reader, the semaphore counts the complete entries */
+static RingBuffer audioConsumerQueue;
+static sem_t audioConsumerSignal;
 
 static volatile bool shutdown = true;
 
-using namespace soundtouch;
 static SoundTouch soundTouch;
+static Resampler resampler;
 
 /* SLES state */
 slesState state;
@@ -172,6 +204,9 @@ ptr_ConfigGetParamBool     ConfigGetParamBool = NULL;
 ptr_ConfigGetParamString   ConfigGetParamString = NULL;
 ptr_CoreDoCommand          CoreDoCommand = NULL;
 
+/* Added in Front-end API v2.1.4, may be missing */
+static ptr_CoreSetThreadRole CoreSetThreadRole = NULL;
+
 /* Global functions */
 static void DebugMessage(int level, const char *message, ...)
 {
@@ -189,6 +224,51 @@ static void DebugMessage(int level, const char *message, ...)
     va_end(args);
 }
 
+#ifdef ENABLE_AI_DUMP
+/* Records every AI DMA into the user data directory, see ai_dump.h */
+static ptr_ConfigGetUserDataPath ConfigGetUserDataPath = NULL;
+static FILE* l_AiDump = NULL;
+
+static void OpenAiDump(void)
+{
+    char path[1024];
+
+    if (ConfigGetUserDataPath == NULL)
+        return;
+
+    snprintf(path, sizeof(path), "%s/ai_dump.bin", ConfigGetUserDataPath());
+    l_AiDump = fopen(path, "wb");
+    if (l_AiDump == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't open %s for writing", path);
+        return;
+    }
+
+    fwrite(AI_DUMP_MAGIC, 1, AI_DUMP_MAGIC_SIZE, l_AiDump);
+    DebugMessage(M64MSG_INFO, "Recording AI DMA to %s", path);
+}
+
+static void WriteAiDump(const unsigned char* samples, unsigned int length)
+{
+    ai_dump_record record;
+
+    if (l_AiDump == NULL)
+        return;
+
+    record.frequency = GameFreq;
+    record.length = length;
+    fwrite(&record, sizeof(record), 1, l_AiDump);
+    fwrite(samples, 1, length, l_AiDump);
+}
+
+static void CloseAiDump(void)
+{
+    if (l_AiDump != NULL)
+        fclose(l_AiDump);
+    l_AiDump = NULL;
+}
+#endif
+
 void queueCallback(SLAndroidSimpleBufferQueueItf caller, void *context);
 
 static void CloseAudio(void)
@@ -196,23 +276,21 @@ static void CloseAudio(void)
     if(!shutdown)
     {
        shutdown = true;
+       sem_post(&audioConsumerSignal);
        pthread_join(audioConsumerThread,NULL);
 
-       thread_queue_cleanup(&audioConsumerQueue, 1);
+       sem_destroy(&audioConsumerSignal);
     }
 
+    audioConsumerQueue.release();
+
+    aaudio_close();
+
     int i = 0;
     
     secondaryBufferIndex = 0;
+    secondaryBufferFill = 0;
     
-    /* Delete Primary buffer */
-    if (primaryBuffer != NULL)
-    {
-        primaryBufferBytes = 0;
-        free(primaryBuffer);
-        primaryBuffer = NULL;
-    }
-
     /* Delete Secondary buffers */
     if (secondaryBuffers != NULL)
     {
@@ -259,23 +337,6 @@ static void CloseAudio(void)
     }
 }
 
-static int CreatePrimaryBuffer(void)
-{
-    unsigned int primaryBytes = (unsigned int) (PrimaryBufferSize * N64_SAMPLE_BYTES);
-
-    DebugMessage(M64MSG_VERBOSE, "Allocating memory for primary audio buffer: %i bytes.", primaryBytes);
-
-    primaryBuffer = (unsigned char*) malloc(primaryBytes);
-
-    if (primaryBuffer == NULL)
-        return 0;
-
-    memset(primaryBuffer, 0, primaryBytes);
-    primaryBufferBytes = primaryBytes;
-
-    return 1;
-}
-
 static int CreateSecondaryBuffers(void)
 {
     int i = 0;
@@ -314,16 +375,95 @@ void OnInitFailure(void)
    critical_failure = 1;
 }
 
+static int CreateSLESPlayer(SLuint32 sample_rate)
+{
+    /* Engine object */
+    SLresult result = slCreateEngine(&engineObject, 0, NULL, 0, NULL, NULL);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    result = (*engineObject)->Realize(engineObject, SL_BOOLEAN_FALSE);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    result = (*engineObject)->GetInterface(engineObject, SL_IID_ENGINE, &engineEngine);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* Output mix object */
+    result = (*engineEngine)->CreateOutputMix(engineEngine, &outputMixObject, 0, NULL, NULL);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    result = (*outputMixObject)->Realize(outputMixObject, SL_BOOLEAN_FALSE);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    SLDataLocator_AndroidSimpleBufferQueue loc_bufq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, SecondaryBufferNbr*2};
+
+#ifdef FP_ENABLED
+
+    SLAndroidDataFormat_PCM_EX format_pcm = {SL_ANDROID_DATAFORMAT_PCM_EX, 2, sample_rate,
+                   32, 32, SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT,
+                   SL_BYTEORDER_LITTLEENDIAN, SL_ANDROID_PCM_REPRESENTATION_FLOAT};
+#else
+    SLDataFormat_PCM format_pcm = {SL_DATAFORMAT_PCM,2, sample_rate,
+                   SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
+                   (SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT), SL_BYTEORDER_LITTLEENDIAN};
+#endif
+
+    SLDataSource audioSrc = {&loc_bufq, &format_pcm};
+
+    /* Configure audio sink */
+    SLDataLocator_OutputMix loc_outmix = {SL_DATALOCATOR_OUTPUTMIX, outputMixObject};
+    SLDataSink audioSnk = {&loc_outmix, NULL};
+
+    /* Create audio player */
+    const SLInterfaceID ids1[] = {SL_IID_ANDROIDSIMPLEBUFFERQUEUE};
+    const SLboolean req1[] = {SL_BOOLEAN_TRUE};
+    result = (*engineEngine)->CreateAudioPlayer(engineEngine, &(playerObject), &audioSrc, &audioSnk, 1, ids1, req1);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* Realize the player */
+    result = (*playerObject)->Realize(playerObject, SL_BOOLEAN_FALSE);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* Get the play interface */
+    result = (*playerObject)->GetInterface(playerObject, SL_IID_PLAY, &(playerPlay));
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* Get the buffer queue interface */
+    result = (*playerObject)->GetInterface(playerObject, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &(bufferQueue));
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* register callback on the buffer queue */
+    result = (*bufferQueue)->RegisterCallback(bufferQueue, queueCallback, &state);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    /* set the player's state to playing */
+    result = (*playerPlay)->SetPlayState(playerPlay, SL_PLAYSTATE_PLAYING);
+    if(result != SL_RESULT_SUCCESS)
+        return 0;
+
+    return 1;
+}
+
 static void InitializeAudio(int freq)
 {
    /* reload these because they gets re-assigned from data below, and InitializeAudio can be called more than once */
    GameFreq = ConfigGetParamInt(l_ConfigAudio, "DEFAULT_FREQUENCY");
    SwapChannels = ConfigGetParamBool(l_ConfigAudio, "SWAP_CHANNELS");
-   PrimaryBufferSize = ConfigGetParamInt(l_ConfigAudio, "PRIMARY_BUFFER_SIZE");
    SecondaryBufferSize = ConfigGetParamInt(l_ConfigAudio, "SECONDARY_BUFFER_SIZE");
    TargetSecondaryBuffers = ConfigGetParamInt(l_ConfigAudio, "SECONDARY_BUFFER_NBR");
    SamplingRateSelection = ConfigGetParamInt(l_ConfigAudio, "SAMPLING_RATE");
    TimeStretchEnabled = ConfigGetParamBool(l_ConfigAudio, "TIME_STRETCH_ENABLED");
+   DynamicRateEnabled = ConfigGetParamBool(l_ConfigAudio, "DYNAMIC_RATE_CONTROL");
+   AAudioEnabled = ConfigGetParamBool(l_ConfigAudio, "AAUDIO_ENABLED");
 
     SLuint32 sample_rate;
 
@@ -351,29 +491,14 @@ static void InitializeAudio(int freq)
 			OutputFreq = 44100;
 			sample_rate = SL_SAMPLINGRATE_44_1;
 		}
-	} else {
+	} else if (SamplingRateSelection >= 8000 && SamplingRateSelection <= 192000) {
+		/* Usually the native rate of the device. Matching it avoids a second resampler in
+		   AudioFlinger, which would also keep the player off the fast mixer track */
 		OutputFreq = SamplingRateSelection;
-
-		switch (SamplingRateSelection) {
-			case 16000:
-				sample_rate = SL_SAMPLINGRATE_16;
-				break;
-			case 24000:
-				sample_rate = SL_SAMPLINGRATE_24;
-				break;
-			case 32000:
-				sample_rate = SL_SAMPLINGRATE_32;
-				break;
-			case 44100:
-				sample_rate = SL_SAMPLINGRATE_44_1;
-				break;
-			case 48000:
-				sample_rate = SL_SAMPLINGRATE_48;
-				break;
-			default:
-				OutputFreq = 32000;
-				sample_rate = SL_SAMPLINGRATE_32;
-		}
+		sample_rate = (SLuint32) SamplingRateSelection * 1000; /* SLES rates are in milliHertz */
+	} else {
+		OutputFreq = 32000;
+		sample_rate = SL_SAMPLINGRATE_32;
 	}
 
     DebugMessage(M64MSG_INFO, "Requesting frequency: %iHz.", OutputFreq);
@@ -381,13 +506,6 @@ static void InitializeAudio(int freq)
     /* Close everything because InitializeAudio can be called more than once */
     CloseAudio();
 
-    /* Create primary buffer */
-    if(!CreatePrimaryBuffer())
-    {
-       OnInitFailure();
-       return;
-    }
-
     /* Create secondary buffers */
     if(!CreateSecondaryBuffers())
     {
@@ -399,115 +517,45 @@ static void InitializeAudio(int freq)
     state.totalBuffersProcessed = 0;
     state.errors = 0;
 
-    /* Engine object */
-    SLresult result = slCreateEngine(&engineObject, 0, NULL, 0, NULL, NULL);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
-
-    result = (*engineObject)->Realize(engineObject, SL_BOOLEAN_FALSE);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
-
-    result = (*engineObject)->GetInterface(engineObject, SL_IID_ENGINE, &engineEngine);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
-
-    /* Output mix object */
-    result = (*engineEngine)->CreateOutputMix(engineEngine, &outputMixObject, 0, NULL, NULL);
-    if(result != SL_RESULT_SUCCESS)
+    if (AAudioEnabled)
     {
-       OnInitFailure();
-       return;
-    }
-
-    result = (*outputMixObject)->Realize(outputMixObject, SL_BOOLEAN_FALSE);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
-
-    SLDataLocator_AndroidSimpleBufferQueue loc_bufq = {SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE, SecondaryBufferNbr*2};
-
 #ifdef FP_ENABLED
-
-    SLAndroidDataFormat_PCM_EX format_pcm = {SL_ANDROID_DATAFORMAT_PCM_EX, 2, sample_rate,
-                   32, 32, SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT,
-                   SL_BYTEORDER_LITTLEENDIAN, SL_ANDROID_PCM_REPRESENTATION_FLOAT};
+        int rate = aaudio_open(OutputFreq, true, SecondaryBufferNbr * SecondaryBufferSize);
 #else
-    SLDataFormat_PCM format_pcm = {SL_DATAFORMAT_PCM,2, sample_rate,
-                   SL_PCMSAMPLEFORMAT_FIXED_16, SL_PCMSAMPLEFORMAT_FIXED_16,
-                   (SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT), SL_BYTEORDER_LITTLEENDIAN};
+        int rate = aaudio_open(OutputFreq, false, SecondaryBufferNbr * SecondaryBufferSize);
 #endif
-
-    SLDataSource audioSrc = {&loc_bufq, &format_pcm};
-
-    /* Configure audio sink */
-    SLDataLocator_OutputMix loc_outmix = {SL_DATALOCATOR_OUTPUTMIX, outputMixObject};
-    SLDataSink audioSnk = {&loc_outmix, NULL};
-
-    /* Create audio player */
-    const SLInterfaceID ids1[] = {SL_IID_ANDROIDSIMPLEBUFFERQUEUE};
-    const SLboolean req1[] = {SL_BOOLEAN_TRUE};
-    result = (*engineEngine)->CreateAudioPlayer(engineEngine, &(playerObject), &audioSrc, &audioSnk, 1, ids1, req1);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
-
-    /* Realize the player */
-    result = (*playerObject)->Realize(playerObject, SL_BOOLEAN_FALSE);
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
+        if (rate != 0)
+        {
+            if (rate != OutputFreq)
+                DebugMessage(M64MSG_INFO, "AAudio opened with frequency: %iHz.", rate);
+            OutputFreq = rate;
+        }
+        else
+            DebugMessage(M64MSG_WARNING, "Couldn't open AAudio, falling back to OpenSLES");
     }
 
-    /* Get the play interface */
-    result = (*playerObject)->GetInterface(playerObject, SL_IID_PLAY, &(playerPlay));
-    if(result != SL_RESULT_SUCCESS)
+    if (!aaudio_is_open() && !CreateSLESPlayer(sample_rate))
     {
        OnInitFailure();
        return;
     }
 
-    /* Get the buffer queue interface */
-    result = (*playerObject)->GetInterface(playerObject, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &(bufferQueue));
-    if(result != SL_RESULT_SUCCESS)
-    {
-       OnInitFailure();
-       return;
-    }
+    telemetry_reset(OutputFreq);
 
-    /* register callback on the buffer queue */
-    result = (*bufferQueue)->RegisterCallback(bufferQueue, queueCallback, &state);
-    if(result != SL_RESULT_SUCCESS)
+    /* Create the queue to the consumer thread */
+    if (!audioConsumerQueue.init(AUDIO_QUEUE_SIZE))
     {
        OnInitFailure();
        return;
     }
 
-    /* set the player's state to playing */
-    result = (*playerPlay)->SetPlayState(playerPlay, SL_PLAYSTATE_PLAYING);
-    if(result != SL_RESULT_SUCCESS)
+    sem_init(&audioConsumerSignal, 0, 0);
+    shutdown = false;
+    if(DynamicRateEnabled)
     {
-       OnInitFailure();
-       return;
+        pthread_create( &audioConsumerThread, NULL, audioConsumerResample, NULL);
     }
-
-    thread_queue_init(&audioConsumerQueue);
-    shutdown = false;
-    if(TimeStretchEnabled)
+    else if(TimeStretchEnabled)
     {
         pthread_create( &audioConsumerThread, NULL, audioConsumerStretch, NULL);
     }
@@ -524,11 +572,12 @@ static void ReadConfig(void)
     /* read the configuration values into our static variables */
     GameFreq = ConfigGetParamInt(l_ConfigAudio, "DEFAULT_FREQUENCY");
     SwapChannels = ConfigGetParamBool(l_ConfigAudio, "SWAP_CHANNELS");
-    PrimaryBufferSize = ConfigGetParamInt(l_ConfigAudio, "PRIMARY_BUFFER_SIZE");
     SecondaryBufferSize = ConfigGetParamInt(l_ConfigAudio, "SECONDARY_BUFFER_SIZE");
     TargetSecondaryBuffers = ConfigGetParamInt(l_ConfigAudio, "SECONDARY_BUFFER_NBR");
     SamplingRateSelection = ConfigGetParamInt(l_ConfigAudio, "SAMPLING_RATE");
     TimeStretchEnabled = ConfigGetParamBool(l_ConfigAudio, "TIME_STRETCH_ENABLED");
+    DynamicRateEnabled = ConfigGetParamBool(l_ConfigAudio, "DYNAMIC_RATE_CONTROL");
+    AAudioEnabled = ConfigGetParamBool(l_ConfigAudio, "AAUDIO_ENABLED");
 }
 
 /* Mupen64Plus plugin functions */
@@ -578,6 +627,10 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     ConfigGetParamBool = (ptr_ConfigGetParamBool) osal_dynlib_getproc(CoreLibHandle, "ConfigGetParamBool");
     ConfigGetParamString = (ptr_ConfigGetParamString) osal_dynlib_getproc(CoreLibHandle, "ConfigGetParamString");
     CoreDoCommand =  (ptr_CoreDoCommand) osal_dynlib_getproc(CoreLibHandle, "CoreDoCommand");
+    CoreSetThreadRole = (ptr_CoreSetThreadRole) osal_dynlib_getproc(CoreLibHandle, "CoreSetThreadRole");
+#ifdef ENABLE_AI_DUMP
+    ConfigGetUserDataPath = (ptr_ConfigGetUserDataPath) osal_dynlib_getproc(CoreLibHandle, "ConfigGetUserDataPath");
+#endif
 
     if (!ConfigOpenSection || !ConfigDeleteSection || !ConfigSetParameter || !ConfigGetParameter ||
         !ConfigSetDefaultInt || !ConfigSetDefaultFloat || !ConfigSetDefaultBool || !ConfigSetDefaultString ||
@@ -625,11 +678,12 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     ConfigSetDefaultFloat(l_ConfigAudio, "Version",             CONFIG_PARAM_VERSION,  "Mupen64Plus SDL Audio Plugin config parameter version number");
     ConfigSetDefaultInt(l_ConfigAudio, "DEFAULT_FREQUENCY",     DEFAULT_FREQUENCY,     "Frequency which is used if rom doesn't want to change it");
     ConfigSetDefaultBool(l_ConfigAudio, "SWAP_CHANNELS",        0,                     "Swaps left and right channels");
-    ConfigSetDefaultInt(l_ConfigAudio, "PRIMARY_BUFFER_SIZE",   PRIMARY_BUFFER_SIZE,   "Size of primary buffer in output samples. This is where audio is loaded after it's extracted from n64's memory.");
     ConfigSetDefaultInt(l_ConfigAudio, "SECONDARY_BUFFER_SIZE", DEFAULT_SECONDARY_BUFFER_SIZE, "Size of secondary buffer in output samples. This is OpenSLES's hardware buffer.");
     ConfigSetDefaultInt(l_ConfigAudio, "SECONDARY_BUFFER_NBR" , SECONDARY_BUFFER_NBR,  "Number of secondary buffers.");
-    ConfigSetDefaultInt(l_ConfigAudio, "SAMPLING_RATE" ,        0,                     "Sampling rate, (0=game original, 16, 24, 32, 441, 48");
+    ConfigSetDefaultInt(l_ConfigAudio, "SAMPLING_RATE" ,        0,                     "Sampling rate in Hz, 0=game original. The native rate of the device avoids resampling by Android");
     ConfigSetDefaultBool(l_ConfigAudio, "TIME_STRETCH_ENABLED", 1,                     "Enable audio time stretching to prevent crackling");
+    ConfigSetDefaultBool(l_ConfigAudio, "DYNAMIC_RATE_CONTROL", 0,                     "Resample with the rate steered by the buffer level instead of time stretching, SoundTouch is only used when the game speed is changed");
+    ConfigSetDefaultBool(l_ConfigAudio, "AAUDIO_ENABLED",       0,                     "Use low latency AAudio output if available (Android 8.1+), OpenSLES otherwise");
 
     if (bSaveConfig && ConfigAPIVersion >= 0x020100)
         ConfigSaveSection("Audio-OpenSLES");
@@ -701,6 +755,99 @@ EXPORT void CALL AiDacrateChanged( int SystemType )
     InitializeAudio(f);
 }
 
+static void ConvertSamples(unsigned char* dst, const unsigned char* src, unsigned int frames)
+{
+#ifdef FP_ENABLED
+    samples_convert_float((float*)dst, src, frames, SwapChannels != 0);
+#else
+    samples_convert_s16((int16_t*)dst, src, frames, SwapChannels != 0);
+#endif
+}
+
+/* Hands samples over to the consumer thread, this never allocates or blocks. The samples are
+   converted straight from RDRAM into the queue, which is the only copy made of them before they
+   reach SoundTouch or the resampler. AiLenChanged is called when the DMA starts, so RDRAM holds
+   the whole buffer at this point and the game may reuse it as soon as we return. */
+static void AddQueueData(const unsigned char* data, unsigned int length)
+{
+    if (shutdown)
+        return;
+
+    queueData entry;
+    entry.data = NULL;
+    entry.wrapData = NULL;
+    entry.frames = length / N64_SAMPLE_BYTES;
+    entry.wrapFrames = 0;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &entry.timestamp);
+
+    size_t bytes = (size_t) entry.frames * SLES_SAMPLE_BYTES;
+    unsigned char* first;
+    unsigned char* second;
+    size_t firstBytes;
+
+    if (audioConsumerQueue.writeAvailable() < sizeof(entry) + bytes)
+    {
+        DebugMessage(M64MSG_WARNING, "AddQueueData(): Audio queue overflow.");
+        return;
+    }
+
+    audioConsumerQueue.write(&entry, sizeof(entry));
+    audioConsumerQueue.writeSpans(bytes, &first, &firstBytes, &second);
+
+    unsigned int firstFrames = (unsigned int) (firstBytes / SLES_SAMPLE_BYTES);
+    ConvertSamples(first, data, firstFrames);
+    ConvertSamples(second, data + firstFrames * N64_SAMPLE_BYTES, entry.frames - firstFrames);
+
+    audioConsumerQueue.commitWrite(bytes);
+    sem_post(&audioConsumerSignal);
+}
+
+/* Waits for the next entry from the emulation thread, returns 0 on timeout or shutdown */
+static int GetQueueData(const struct timespec* timeout, queueData* entry)
+{
+    struct timespec abstimeout;
+    clock_gettime(CLOCK_REALTIME, &abstimeout);
+    abstimeout.tv_sec += timeout->tv_sec;
+    abstimeout.tv_nsec += timeout->tv_nsec;
+    if (abstimeout.tv_nsec >= 1000000000)
+    {
+        abstimeout.tv_sec++;
+        abstimeout.tv_nsec -= 1000000000;
+    }
+
+    while (sem_timedwait(&audioConsumerSignal, &abstimeout) != 0)
+    {
+        if (errno != EINTR)
+            return 0;
+    }
+
+    /* CloseAudio posts the semaphore without an entry to wake us up */
+    if (audioConsumerQueue.readAvailable() < sizeof(queueData))
+        return 0;
+
+    audioConsumerQueue.read(entry, sizeof(queueData));
+
+    const unsigned char* first;
+    const unsigned char* second;
+    size_t firstBytes;
+
+    audioConsumerQueue.readSpans((size_t) entry->frames * SLES_SAMPLE_BYTES, &first, &firstBytes, &second);
+
+    unsigned int firstFrames = (unsigned int) (firstBytes / SLES_SAMPLE_BYTES);
+    entry->data = (const SAMPLETYPE*) first;
+    entry->wrapData = (const SAMPLETYPE*) second;
+    entry->wrapFrames = entry->frames - firstFrames;
+    entry->frames = firstFrames;
+
+    return 1;
+}
+
+/* Hands the space of an entry returned by GetQueueData back once its samples were consumed */
+static void ReleaseQueueData(const queueData* entry)
+{
+    audioConsumerQueue.commitRead((size_t) (entry->frames + entry->wrapFrames) * SLES_SAMPLE_BYTES);
+}
+
 bool isSpeedLimiterEnabled(void)
 {
    int e = 1;
@@ -708,20 +855,28 @@ bool isSpeedLimiterEnabled(void)
    return  e;
 }
 
-EXPORT void CALL AiLenChanged(void)
+/* Display lists the video plugin skips after each rendered one, 0 with cores not knowing it */
+static unsigned int getRenderSkip(void)
+{
+   int skip = 0;
+   if (CoreDoCommand(M64CMD_CORE_STATE_QUERY, M64CORE_RENDER_SKIP, &skip) != M64ERR_SUCCESS)
+      return 0;
+   return skip > 0 ? skip : 0;
+}
+
+/* Queues the samples and keeps the game in sync with them, the samples are either read from
+   RDRAM by AiLenChanged or already batched up by the core for AiPushSamples.
+
+   When the core speed limiter is off the audio output paces the game: whenever more audio is
+   buffered than the consumer targets, the emulation thread sleeps until the surplus has played.
+   The output drains at exactly the device rate, so this neither drifts from wall clock time
+   nor needs to spin to stay accurate. */
+static void PushSamples(const unsigned char* samples, unsigned int length)
 {
-    static const double minSleepNeededForReset = -5.0;
-    static const double minSleepNeeded = -0.1;
     static const double maxSleepNeeded = 0.5;
-    static bool hasBeenReset = false;
-    static unsigned long totalElapsedSamples = 0;
-    static double gameStartTime = 0;
     static int lastSpeedFactor = 100;
     static bool lastSpeedLimiterEnabledState = false;
-    static bool busyWait = false;
-    static int busyWaitEnableCount = 0;
-    static int busyWaitDisableCount = 0;
-    static const int busyWaitCheck = 30;
+    static unsigned int decimationCounter = 0;
 
     if (critical_failure == 1)
         return;
@@ -730,113 +885,79 @@ EXPORT void CALL AiLenChanged(void)
         return;
 
     bool limiterEnabled = isSpeedLimiterEnabled();
-    
-    timespec time;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
-    double timeDouble = static_cast<double>(time.tv_sec) +
-          static_cast<double>(time.tv_nsec)/1.0e9;
 
-    //if this is the first time or we are resuming from pause
-    if(gameStartTime == 0 || !hasBeenReset || lastSpeedFactor != speed_factor || lastSpeedLimiterEnabledState != limiterEnabled)
+    //While fast-forward skips rendering, keep one of every renderSkip + 1 buffers as well,
+    //the others would only be stretched to play back that much faster
+    unsigned int decimation = limiterEnabled ? getRenderSkip() + 1 : 1;
+    unsigned int outputSpeedFactor = game_speed_factor / decimation;
+    if (outputSpeedFactor < 10)
+        outputSpeedFactor = 10;
+    else if (outputSpeedFactor > 300)
+        outputSpeedFactor = 300;
+    speed_factor = outputSpeedFactor;
+
+    if (decimation > 1 && decimationCounter++ % decimation != 0)
+        return;
+
+    //Let the consumer settle again after a change of speed or pacing
+    if(lastSpeedFactor != speed_factor || lastSpeedLimiterEnabledState != limiterEnabled)
     {
         lastSpeedLimiterEnabledState = limiterEnabled;
-        gameStartTime = timeDouble;
-        totalElapsedSamples = 0;
-        hasBeenReset = true;
-        totalElapsedSamples = 0;
+        lastSpeedFactor = speed_factor;
         state.totalBuffersProcessed = 0;
     }
 
-    lastSpeedFactor = speed_factor;
-
-    unsigned int LenReg = *AudioInfo.AI_LEN_REG;
-    unsigned char * p = AudioInfo.RDRAM + (*AudioInfo.AI_DRAM_ADDR_REG & 0xFFFFFF);
-    
-    queueData* theQueueData = (queueData*)malloc(sizeof(queueData));
-    theQueueData->data = (unsigned char*)malloc(LenReg);
-    theQueueData->length = LenReg;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &theQueueData->timestamp);
-
-    memcpy(theQueueData->data, p, LenReg);
-
-    thread_queue_add(&audioConsumerQueue, theQueueData, 0);
+    AddQueueData(samples, length);
 
-    //Calculate total ellapsed game time
-    totalElapsedSamples += LenReg/N64_SAMPLE_BYTES;
-    double speedFactor = static_cast<double>(speed_factor)/100.0;
-    double totalElapsedGameTime = ((double)totalElapsedSamples)/(double)GameFreq/speedFactor;
+#ifdef ENABLE_AI_DUMP
+    WriteAiDump(samples, length);
+#endif
 
     //Slow the game down if sync game to audio is enabled
     if(!limiterEnabled)
     {
-        double totalRealTimeElapsed = timeDouble - gameStartTime;
-        double sleepNeeded = totalElapsedGameTime - totalRealTimeElapsed;
-
-        if(sleepNeeded < minSleepNeededForReset || sleepNeeded > (maxSleepNeeded/speedFactor))
-        {
-            hasBeenReset = false;
-        }
-
-        //We don't want to let the game get too far ahead, otherwise we may have a sudden burst of speed
-        if(sleepNeeded < minSleepNeeded)
-        {
-            gameStartTime -= minSleepNeeded;
-        }
-
-        //Enable busywait mode if we have X callbacks of negative sleep. Don't disable busywait
-        //until we have X positive callbacks
-        if(sleepNeeded <= 0.0) {
-            ++busyWaitEnableCount;
-        } else {
-            busyWaitEnableCount = 0;
+        double speedFactor = static_cast<double>(speed_factor)/100.0;
+
+        //Samples waiting for the consumer play back speedFactor times faster than the game rate
+        double pendingFrames = (double) (audioConsumerQueue.readAvailable() / SLES_SAMPLE_BYTES);
+        double bufferedTime = pendingFrames/(double)GameFreq/speedFactor +
+                telemetry_queue_depth_ms()/1000.0;
+
+        double bufferMultiplier = ((double) OutputFreq / DEFAULT_FREQUENCY) *
+                ((double)DEFAULT_SECONDARY_BUFFER_SIZE/SecondaryBufferSize);
+        double targetTime = TargetSecondaryBuffers * bufferMultiplier * SecondaryBufferSize / (double)OutputFreq;
+
+        double sleepNeeded = bufferedTime - targetTime;
+        if (sleepNeeded > maxSleepNeeded/speedFactor)
+            sleepNeeded = maxSleepNeeded/speedFactor;
+
+        if (sleepNeeded > 0.0) {
+            //Assumes sleep time of less than 2 seconds
+            time_t sleepSec = static_cast<time_t>(sleepNeeded);
+            long sleepNanosec = (sleepNeeded - sleepSec) * 1e9;
+
+            timespec sleepTime;
+            sleepTime.tv_sec = sleepSec;
+            sleepTime.tv_nsec = sleepNanosec;
+            nanosleep(&sleepTime, NULL);
         }
+    }
+}
 
-        if(busyWaitEnableCount == busyWaitCheck) {
-            busyWait = true;
-            busyWaitEnableCount = 0;
-            busyWaitDisableCount = 0;
-        }
+EXPORT void CALL AiLenChanged(void)
+{
+    if (!l_PluginInit)
+        return;
 
-        if(busyWait) {
-            if(sleepNeeded > 0) {
-                ++busyWaitDisableCount;
-            }
+    unsigned int LenReg = *AudioInfo.AI_LEN_REG;
+    unsigned char * p = AudioInfo.RDRAM + (*AudioInfo.AI_DRAM_ADDR_REG & 0xFFFFFF);
 
-            if(busyWaitDisableCount == busyWaitCheck) {
-                busyWait = false;
-            }
-        }
+    PushSamples(p, LenReg);
+}
 
-       //Useful logging
-       //DebugMessage(M64MSG_ERROR, "Real=%f, Game=%f, sleep=%f, start=%f, time=%f, speed=%d, sleep_before_factor=%f",
-       //             totalRealTimeElapsed, totalElapsedGameTime, sleepNeeded, gameStartTime, timeDouble, speed_factor, sleepNeeded*speedFactor);
-        if (sleepNeeded > 0.0 && sleepNeeded < (maxSleepNeeded / speedFactor)) {
-            if (busyWait) {
-                double endTime = timeDouble + sleepNeeded;
-
-                timespec time;
-                clock_gettime(CLOCK_MONOTONIC_RAW, &time);
-                double currTime = static_cast<double>(time.tv_sec) +
-                                  static_cast<double>(time.tv_nsec) / 1.0e9;
-                while (currTime < endTime) {
-                    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
-                    currTime = static_cast<double>(time.tv_sec) +
-                               static_cast<double>(time.tv_nsec) / 1.0e9;
-                }
-            } else {
-                //Assumes sleep time of less than 2 seconds
-                time_t sleepSec = static_cast<time_t>(sleepNeeded);
-                long sleepNanosec = (sleepNeeded - sleepSec) * 1e9;
-
-                if (sleepSec > 0 || sleepNanosec != 0) {
-                    timespec sleepTime;
-                    sleepTime.tv_sec = sleepSec;
-                    sleepTime.tv_nsec = sleepNanosec;
-                    nanosleep(&sleepTime, NULL);
-                }
-            }
-        }
-    }
+EXPORT void CALL AiPushSamples(const void *Samples, unsigned int Size)
+{
+    PushSamples((const unsigned char*) Samples, Size);
 }
 
 double TimeDiff(struct timespec* currTime, struct timespec* prevTime)
@@ -857,6 +978,9 @@ float GetAverageTime( double* feedTimes, int numTimes)
 }
 
 void *audioConsumerStretch(void *param) {
+    if (CoreSetThreadRole != NULL)
+        CoreSetThreadRole(M64THREAD_AUDIO);
+
     /*
 	static int sequenceLenMS = 63;
 	static int seekWindowMS = 16;
@@ -873,6 +997,7 @@ void *audioConsumerStretch(void *param) {
     soundTouch.setRate((double) GameFreq / (double) OutputFreq);
     double speedFactor = static_cast<double>(speed_factor) / 100.0;
     soundTouch.setTempo(speedFactor);
+    telemetry_ratio(speedFactor);
 
     double bufferMultiplier = ((double) OutputFreq / DEFAULT_FREQUENCY) *
             ((double)DEFAULT_SECONDARY_BUFFER_SIZE/SecondaryBufferSize);
@@ -898,7 +1023,7 @@ void *audioConsumerStretch(void *param) {
     const float maxSpeedUpRate = 0.5;
     const float slowRate = 0.05;
 	const float defaultSampleLength = 0.01666;
-    queueData *currQueueData = NULL;
+    queueData currQueueData;
     struct timespec prevTime;
 
     clock_gettime(CLOCK_MONOTONIC_RAW, &prevTime);
@@ -920,27 +1045,24 @@ void *audioConsumerStretch(void *param) {
     float averageFeedTime = defaultSampleLength;
 
     while (!shutdown) {
+        UpdateAAudioState();
         int slesQueueLength = state.limit - state.value;
 
         ranDry = slesQueueLength < minQueueSize;
 
-        struct threadmsg msg;
-
-        int result = thread_queue_get(&audioConsumerQueue, &waitTime, &msg);
+        if (GetQueueData(&waitTime, &currQueueData)) {
+            int threadQueueLength = (int) audioConsumerQueue.readAvailable();
 
-        if (result != ETIMEDOUT) {
-            int threadQueueLength = thread_queue_length(&audioConsumerQueue);
-
-            currQueueData = (queueData *) msg.data;
-            unsigned int dataLength = currQueueData->length;
+            unsigned int dataFrames = currQueueData.frames + currQueueData.wrapFrames;
 			float temp = averageGameTime / averageFeedTime;
 
             if (state.totalBuffersProcessed < state.limit) {
 
                 speedFactor = static_cast<double>(speed_factor)/100.0;
                 soundTouch.setTempo(speedFactor);
+                telemetry_ratio(speedFactor);
 
-                processAudio(currQueueData->data, dataLength);
+                processAudio(&currQueueData);
 
             } else {
 
@@ -970,11 +1092,14 @@ void *audioConsumerStretch(void *param) {
                     slowAdjustment = (temp2) / 100;
 
                     soundTouch.setTempo(slowAdjustment);
+                    telemetry_ratio(slowAdjustment);
                 }
 
-                processAudio(currQueueData->data, dataLength);
+                processAudio(&currQueueData);
             }
 
+            ReleaseQueueData(&currQueueData);
+
 			++state.totalBuffersProcessed;
 
             //Useful logging
@@ -987,9 +1112,9 @@ void *audioConsumerStretch(void *param) {
             //We don't want to calculate the average until we give everything a time to settle.
 
             //Figure out how much to slow down by
-            double timeDiff = TimeDiff(&currQueueData->timestamp, &prevTime);
+            double timeDiff = TimeDiff(&currQueueData.timestamp, &prevTime);
 
-            prevTime = currQueueData->timestamp;
+            prevTime = currQueueData.timestamp;
 
             //sometimes this ends up as less than 0, not sure how
             if (timeDiff > 0) {
@@ -998,7 +1123,7 @@ void *audioConsumerStretch(void *param) {
 
             averageFeedTime = GetAverageTime(feedTimes, feedTimesSet ? feedTimeWindowSize : (feedTimeIndex + 1));
 
-            gameTimes[feedTimeIndex] = (float) dataLength / (float) N64_SAMPLE_BYTES / (float) GameFreq;
+            gameTimes[feedTimeIndex] = (float) dataFrames / (float) GameFreq;
             averageGameTime = GetAverageTime(gameTimes, feedTimesSet ? feedTimeWindowSize : (feedTimeIndex + 1));
 
             ++feedTimeIndex;
@@ -1012,9 +1137,6 @@ void *audioConsumerStretch(void *param) {
 			if(feedTimeWindowSize > maxWindowSize) {
 				feedTimeWindowSize = maxWindowSize;
 			}
-
-            free(currQueueData->data);
-            free(currQueueData);
         }
     }
 
@@ -1024,15 +1146,19 @@ void *audioConsumerStretch(void *param) {
 
 void* audioConsumerNoStretch(void* param)
 {
+    if (CoreSetThreadRole != NULL)
+        CoreSetThreadRole(M64THREAD_AUDIO);
+
     soundTouch.setSampleRate(GameFreq);
     soundTouch.setChannels(2);
     soundTouch.setSetting( SETTING_USE_QUICKSEEK, 1 );
     soundTouch.setSetting( SETTING_USE_AA_FILTER, 1 );
     double speedFactor = static_cast<double>(speed_factor)/100.0;
     soundTouch.setTempo(speedFactor);
+    telemetry_ratio(speedFactor);
 
     soundTouch.setRate((double)GameFreq/(double)OutputFreq);
-    queueData* currQueueData = NULL;
+    queueData currQueueData;
 
     int lastSpeedFactor = speed_factor;
 
@@ -1043,26 +1169,103 @@ void* audioConsumerNoStretch(void* param)
 
     while(!shutdown)
     {
-        struct threadmsg msg;
-
-        int result = thread_queue_get(&audioConsumerQueue, &waitTime, &msg);
-
-        if( result != ETIMEDOUT )
+        if( GetQueueData(&waitTime, &currQueueData) )
         {
-            currQueueData = (queueData*)msg.data;
-            int dataLength = currQueueData->length;
-
             if(lastSpeedFactor != speed_factor)
             {
                 lastSpeedFactor = speed_factor;
                 double speedFactor = static_cast<double>(speed_factor)/100.0;
                 soundTouch.setTempo(speedFactor);
+                telemetry_ratio(speedFactor);
             }
 
-            processAudio(currQueueData->data, dataLength);
+            processAudio(&currQueueData);
+            ReleaseQueueData(&currQueueData);
+        }
+    }
+
+    return 0;
+}
+
+void* audioConsumerResample(void* param)
+{
+    if (CoreSetThreadRole != NULL)
+        CoreSetThreadRole(M64THREAD_AUDIO);
+
+    /* SoundTouch is only used while the game runs at a different speed */
+    soundTouch.setSampleRate(GameFreq);
+    soundTouch.setChannels(2);
+    soundTouch.setSetting( SETTING_USE_QUICKSEEK, 1 );
+    soundTouch.setSetting( SETTING_USE_AA_FILTER, 1 );
+    soundTouch.setRate((double)GameFreq/(double)OutputFreq);
+
+    resampler.reset();
+    double nominalRatio = (double)GameFreq/(double)OutputFreq;
+
+    double bufferMultiplier = ((double) OutputFreq / DEFAULT_FREQUENCY) *
+            ((double)DEFAULT_SECONDARY_BUFFER_SIZE/SecondaryBufferSize);
+    int targetQueueSize = (int) (TargetSecondaryBuffers * bufferMultiplier);
+    if (targetQueueSize < 1)
+        targetQueueSize = 1;
+
+    queueData currQueueData;
+
+    int lastSpeedFactor = 100;
 
-            free(currQueueData->data);
-            free(currQueueData);
+    //How long to wait for some data
+    struct timespec waitTime;
+    waitTime.tv_sec = 1;
+    waitTime.tv_nsec = 0;
+
+    while(!shutdown)
+    {
+        if( GetQueueData(&waitTime, &currQueueData) )
+        {
+            int speedFactor = speed_factor;
+
+            if(speedFactor != lastSpeedFactor)
+            {
+                if(lastSpeedFactor == 100)
+                {
+                    /* Flush what was already resampled before switching over */
+                    if(secondaryBufferFill != 0)
+                    {
+                        QueueSecondaryBuffer(secondaryBufferFill);
+                        secondaryBufferFill = 0;
+                    }
+                }
+                else if(speedFactor == 100)
+                {
+                    soundTouch.clear();
+                }
+
+                soundTouch.setTempo(static_cast<double>(speedFactor)/100.0);
+                telemetry_ratio(static_cast<double>(speedFactor)/100.0);
+                lastSpeedFactor = speedFactor;
+            }
+
+            if(speedFactor == 100)
+            {
+                /* Steer the rate so the output queue converges on the target size */
+                UpdateAAudioState();
+                int queueLength = state.limit - state.value;
+                double delta = (double)(queueLength - targetQueueSize) / (double)targetQueueSize;
+
+                if(delta > 1.0)
+                    delta = 1.0;
+                else if(delta < -1.0)
+                    delta = -1.0;
+
+                resampler.setRatio(nominalRatio * (1.0 + MAX_RATE_DELTA * delta));
+                telemetry_ratio(1.0 + MAX_RATE_DELTA * delta);
+                resampleAudio(&currQueueData);
+            }
+            else
+            {
+                processAudio(&currQueueData);
+            }
+
+            ReleaseQueueData(&currQueueData);
         }
     }
 
@@ -1079,57 +1282,67 @@ void queueCallback(SLAndroidSimpleBufferQueueItf caller, void *context)
 
     if (result == SL_RESULT_SUCCESS) {
 		state->value = state->limit - st.count;
+
+		/* The buffer that just finished was the last one queued */
+		if (st.count == 0 && !shutdown)
+			telemetry_underrun();
     }
 }
 
-void processAudio(const unsigned char* buffer, unsigned int length)
+/* Mirrors the AAudio ring buffer fill level into the SLES queue state so the
+   buffer management above works the same for both outputs */
+void UpdateAAudioState(void)
 {
-   if (length < primaryBufferBytes)
-   {
-       unsigned int i;
-
-       for ( i = 0 ; i < length ; i += 4 )
-       {
-           if(SwapChannels == 0)
-           {
-               /* Left channel */
-              primaryBuffer[ i ] = buffer[ i + 2 ];
-              primaryBuffer[ i + 1 ] = buffer[ i + 3 ];
-
-               /* Right channel */
-              primaryBuffer[ i + 2 ] = buffer[ i ];
-              primaryBuffer[ i + 3 ] = buffer[ i + 1 ];
-           }
-           else
-           {
-               /* Left channel */
-              primaryBuffer[ i ] = buffer[ i ];
-              primaryBuffer[ i + 1 ] = buffer[ i + 1 ];
-
-               /* Right channel */
-              primaryBuffer[ i + 2 ] = buffer[ i + 2 ];
-              primaryBuffer[ i + 3 ] = buffer[ i + 3 ];
-           }
-       }
-   }
+    if (aaudio_is_open())
+    {
+        unsigned int queuedBuffers = (aaudio_queued_frames() + SecondaryBufferSize - 1) / SecondaryBufferSize;
+        state.value = state.limit - (int)queuedBuffers;
+    }
+}
+
+/* Hands the current secondary buffer over to the output and moves on to the next one */
+static void QueueSecondaryBuffer(int outSamples)
+{
+   UpdateAAudioState();
+
+   if (aaudio_is_open())
+      telemetry_queue_depth(aaudio_queued_frames());
    else
-       DebugMessage(M64MSG_WARNING, "processAudio(): Audio primary buffer overflow.");
+      telemetry_queue_depth((unsigned int)(state.limit - state.value) * SecondaryBufferSize);
 
-#ifdef FP_ENABLED
-   int numSamples = length/sizeof(short);
-   short* primaryBufferShort = (short*)primaryBuffer;
-   float primaryBufferFloat[numSamples];
+   /* Drop the samples if the output queue is full */
+   if (state.value <= 0)
+      return;
 
-   for(int index = 0; index < numSamples; ++index)
+   if (aaudio_is_open())
    {
-      primaryBufferFloat[index] = static_cast<float>(primaryBufferShort[index])/32767.0;
+      if (aaudio_write(secondaryBuffers[secondaryBufferIndex], outSamples) != (unsigned int)outSamples)
+      {
+          state.errors++;
+      }
    }
+   else
+   {
+      SLresult result = (*bufferQueue)->Enqueue(bufferQueue, secondaryBuffers[secondaryBufferIndex],
+         outSamples*SLES_SAMPLE_BYTES);
 
-   soundTouch.putSamples((SAMPLETYPE*)primaryBufferFloat, length/N64_SAMPLE_BYTES);
+      if(result != SL_RESULT_SUCCESS)
+      {
+          state.errors++;
+      }
+   }
 
-#else
-   soundTouch.putSamples((SAMPLETYPE*)primaryBuffer, length/N64_SAMPLE_BYTES);
-#endif
+   secondaryBufferIndex++;
+
+   if(secondaryBufferIndex > (SecondaryBufferNbr-1))
+      secondaryBufferIndex = 0;
+}
+
+void processAudio(const queueData* entry)
+{
+   soundTouch.putSamples(entry->data, entry->frames);
+   if (entry->wrapFrames != 0)
+      soundTouch.putSamples(entry->wrapData, entry->wrapFrames);
 
    int outSamples = 0;
 
@@ -1137,23 +1350,36 @@ void processAudio(const unsigned char* buffer, unsigned int length)
    {
       outSamples = soundTouch.receiveSamples((SAMPLETYPE*)secondaryBuffers[secondaryBufferIndex], SecondaryBufferSize);
 
-      if(outSamples != 0 && state.value > 0)
-      {
-         SLresult result = (*bufferQueue)->Enqueue(bufferQueue, secondaryBuffers[secondaryBufferIndex],
-            outSamples*SLES_SAMPLE_BYTES);
+      if(outSamples != 0)
+         QueueSecondaryBuffer(outSamples);
+   }
+   while (outSamples != 0);
+}
 
-          if(result != SL_RESULT_SUCCESS)
-          {
-              state.errors++;
-          }
+/* Resamples straight into the secondary buffers and queues each one once it's full */
+static void resampleFrames(const SAMPLETYPE* in, unsigned int inFrames)
+{
+   while (inFrames > 0)
+   {
+      SAMPLETYPE* out = (SAMPLETYPE*)secondaryBuffers[secondaryBufferIndex] + secondaryBufferFill * 2;
+      unsigned int consumed = 0;
 
-         secondaryBufferIndex++;
+      secondaryBufferFill += resampler.process(in, inFrames, &consumed, out, SecondaryBufferSize - secondaryBufferFill);
+      in += consumed * 2;
+      inFrames -= consumed;
 
-         if(secondaryBufferIndex > (SecondaryBufferNbr-1))
-            secondaryBufferIndex = 0;
+      if (secondaryBufferFill == SecondaryBufferSize)
+      {
+         QueueSecondaryBuffer(secondaryBufferFill);
+         secondaryBufferFill = 0;
       }
    }
-   while (outSamples != 0);
+}
+
+void resampleAudio(const queueData* entry)
+{
+   resampleFrames(entry->data, entry->frames);
+   resampleFrames(entry->wrapData, entry->wrapFrames);
 }
 
 EXPORT int CALL InitiateAudio( AUDIO_INFO Audio_Info )
@@ -1173,6 +1399,10 @@ EXPORT int CALL RomOpen(void)
     ReadConfig();
     InitializeAudio(GameFreq);
 
+#ifdef ENABLE_AI_DUMP
+    OpenAiDump();
+#endif
+
     return 1;
 }
 
@@ -1186,6 +1416,10 @@ EXPORT void CALL RomClosed( void )
 
     DebugMessage(M64MSG_VERBOSE, "Cleaning up OpenSLES sound plugin...");
 
+#ifdef ENABLE_AI_DUMP
+    CloseAiDump();
+#endif
+
     CloseAudio();
 }
 
@@ -1197,8 +1431,8 @@ EXPORT void CALL SetSpeedFactor(int percentage)
 {	
     if (!l_PluginInit)
         return;
-    if (percentage >= 10 && percentage <= 300)
-        speed_factor = percentage;
+    if (percentage >= 10 && percentage <= 1000)
+        game_speed_factor = percentage;
 }
 
 EXPORT void CALL VolumeMute(void)
@@ -1227,3 +1461,53 @@ EXPORT const char * CALL VolumeGetString(void)
     return "100%";
 }
 
+/* Not part of the plugin API, the Android frontend looks these up to display
+   and log the output timing. Both return the number of entries filled. */
+extern "C" EXPORT int CALL AudioGetStats(int* stats, int count)
+{
+    int values[AUDIO_STAT_COUNT];
+    int queueMin = 0;
+    int queueMax = 0;
+    int latency = -1;
+
+    if (stats == NULL || count <= 0)
+        return 0;
+
+    telemetry_history(NULL, TELEMETRY_HISTORY_SIZE, &queueMin, &queueMax);
+
+    if (aaudio_is_open())
+        latency = aaudio_latency_frames();
+
+    if (latency >= 0 && OutputFreq > 0)
+        latency = (int) ((long long) latency * 1000 / OutputFreq);
+    else
+        latency = telemetry_queue_depth_ms();
+
+    values[AUDIO_STAT_UNDERRUNS] = (int) (telemetry_underruns() + aaudio_underruns());
+    values[AUDIO_STAT_QUEUE_MS] = telemetry_queue_depth_ms();
+    values[AUDIO_STAT_QUEUE_MIN_MS] = queueMin;
+    values[AUDIO_STAT_QUEUE_MAX_MS] = queueMax;
+    values[AUDIO_STAT_LATENCY_MS] = latency;
+    values[AUDIO_STAT_RATIO_PPM] = (int) (telemetry_get_ratio() * 1000000.0 + 0.5);
+    values[AUDIO_STAT_SAMPLE_RATE] = OutputFreq;
+    values[AUDIO_STAT_AAUDIO] = aaudio_is_open() ? 1 : 0;
+
+    if (count > AUDIO_STAT_COUNT)
+        count = AUDIO_STAT_COUNT;
+
+    memcpy(stats, values, count * sizeof(int));
+
+    return count;
+}
+
+/* Queue depth history in milliseconds, oldest first */
+extern "C" EXPORT int CALL AudioGetQueueHistory(int* history, int count)
+{
+    int queueMin = 0;
+    int queueMax = 0;
+
+    if (history == NULL)
+        return 0;
+
+    return telemetry_history(history, count, &queueMin, &queueMax);
+}
@@ -27,6 +27,17 @@
 #define CONFIG_API_VERSION       		0x020100
 #define CONFIG_PARAM_VERSION     		1.00
 
+/* Layout of the array filled by AudioGetStats, shared with the frontend */
+#define AUDIO_STAT_UNDERRUNS     0   /* times the output ran dry since the ROM was opened */
+#define AUDIO_STAT_QUEUE_MS      1   /* current output queue depth */
+#define AUDIO_STAT_QUEUE_MIN_MS  2   /* lowest queue depth in the history */
+#define AUDIO_STAT_QUEUE_MAX_MS  3   /* highest queue depth in the history */
+#define AUDIO_STAT_LATENCY_MS    4   /* measured with AAudio, estimated from the queue with OpenSL ES */
+#define AUDIO_STAT_RATIO_PPM     5   /* playback speed relative to nominal, 1000000 is 1.0 */
+#define AUDIO_STAT_SAMPLE_RATE   6   /* output sample rate */
+#define AUDIO_STAT_AAUDIO        7   /* 1 when playing through AAudio */
+#define AUDIO_STAT_COUNT         8
+
 #define VERSION_PRINTF_SPLIT(x) (((x) >> 16) & 0xffff), (((x) >> 8) & 0xff), ((x) & 0xff)
 
 /* declarations of pointers to Core config functions */
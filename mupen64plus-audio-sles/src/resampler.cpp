@@ -0,0 +1,118 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - resampler.cpp                                *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <string.h>
+
+#include "resampler.h"
+
+Resampler::Resampler() :
+    mRatio(1.0)
+{
+    reset();
+}
+
+void Resampler::reset()
+{
+    memset(mWindow, 0, sizeof(mWindow));
+    mFrac = 0.0;
+}
+
+void Resampler::setRatio(double ratio)
+{
+    if (ratio > 0.0)
+        mRatio = ratio;
+}
+
+static inline float Interpolate(const float* w, float t)
+{
+    float c1 = 0.5f * (w[2] - w[0]);
+    float c2 = w[0] - 2.5f * w[1] + 2.0f * w[2] - 0.5f * w[3];
+    float c3 = 0.5f * (w[3] - w[0]) + 1.5f * (w[1] - w[2]);
+
+    return ((c3 * t + c2) * t + c1) * t + w[1];
+}
+
+static inline void Store(int16_t* out, float value)
+{
+    if (value > 32767.0f)
+        value = 32767.0f;
+    else if (value < -32768.0f)
+        value = -32768.0f;
+
+    *out = (int16_t) (value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+static inline void Store(float* out, float value)
+{
+    *out = value;
+}
+
+template<typename T>
+unsigned int Resampler::processFrames(const T* in, unsigned int inFrames, unsigned int* consumed,
+    T* out, unsigned int outFrames)
+{
+    unsigned int used = 0;
+    unsigned int produced = 0;
+
+    while (produced < outFrames)
+    {
+        /* Advance the window until the output position lies within it */
+        while (mFrac >= 1.0)
+        {
+            if (used == inFrames)
+                goto done;
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                float* w = mWindow[channel];
+                w[0] = w[1];
+                w[1] = w[2];
+                w[2] = w[3];
+                w[3] = (float) in[used * 2 + channel];
+            }
+
+            ++used;
+            mFrac -= 1.0;
+        }
+
+        float t = (float) mFrac;
+        Store(&out[produced * 2], Interpolate(mWindow[0], t));
+        Store(&out[produced * 2 + 1], Interpolate(mWindow[1], t));
+
+        ++produced;
+        mFrac += mRatio;
+    }
+
+done:
+    *consumed = used;
+    return produced;
+}
+
+unsigned int Resampler::process(const int16_t* in, unsigned int inFrames, unsigned int* consumed,
+    int16_t* out, unsigned int outFrames)
+{
+    return processFrames(in, inFrames, consumed, out, outFrames);
+}
+
+unsigned int Resampler::process(const float* in, unsigned int inFrames, unsigned int* consumed,
+    float* out, unsigned int outFrames)
+{
+    return processFrames(in, inFrames, consumed, out, outFrames);
+}
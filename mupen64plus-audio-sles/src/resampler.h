@@ -0,0 +1,59 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - resampler.h                                  *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __RESAMPLER_H__
+#define __RESAMPLER_H__
+
+#include <stdint.h>
+
+/* Streaming stereo resampler using 4 point cubic (Catmull-Rom) interpolation. It's much
+   cheaper than SoundTouch and the ratio can be changed at any time without artifacts,
+   which makes it suitable for steering the output rate by the buffer fill level. */
+class Resampler
+{
+public:
+    Resampler();
+
+    void reset();
+
+    /* Number of input frames consumed per output frame */
+    void setRatio(double ratio);
+    double ratio() const { return mRatio; }
+
+    /* Resamples until either all input frames are consumed or the output is full.
+       Returns the number of output frames, consumed is set to the input frames used. */
+    unsigned int process(const int16_t* in, unsigned int inFrames, unsigned int* consumed,
+        int16_t* out, unsigned int outFrames);
+    unsigned int process(const float* in, unsigned int inFrames, unsigned int* consumed,
+        float* out, unsigned int outFrames);
+
+private:
+    template<typename T>
+    unsigned int processFrames(const T* in, unsigned int inFrames, unsigned int* consumed,
+        T* out, unsigned int outFrames);
+
+    /* Last four input frames per channel, the output lies between the middle two */
+    float mWindow[2][4];
+    /* Position of the next output frame after mWindow[][1], in input frames */
+    double mFrac;
+    double mRatio;
+};
+
+#endif /* __RESAMPLER_H__ */
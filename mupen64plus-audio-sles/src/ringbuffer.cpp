@@ -0,0 +1,171 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - ringbuffer.cpp                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ringbuffer.h"
+
+RingBuffer::RingBuffer() :
+    mBuffer(NULL),
+    mCapacity(0),
+    mReadPos(0),
+    mWritePos(0)
+{
+}
+
+RingBuffer::~RingBuffer()
+{
+    release();
+}
+
+bool RingBuffer::init(size_t capacity)
+{
+    release();
+
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    mBuffer = (unsigned char*) malloc(size);
+    if (mBuffer == NULL)
+        return false;
+
+    memset(mBuffer, 0, size);
+    mCapacity = size;
+    mReadPos.store(0);
+    mWritePos.store(0);
+
+    return true;
+}
+
+void RingBuffer::release()
+{
+    free(mBuffer);
+    mBuffer = NULL;
+    mCapacity = 0;
+    mReadPos.store(0);
+    mWritePos.store(0);
+}
+
+size_t RingBuffer::write(const void* data, size_t bytes)
+{
+    size_t writePos = mWritePos.load(std::memory_order_relaxed);
+    size_t readPos = mReadPos.load(std::memory_order_acquire);
+    size_t available = mCapacity - (writePos - readPos);
+
+    if (bytes > available)
+        bytes = available;
+
+    size_t offset = writePos & (mCapacity - 1);
+    size_t first = mCapacity - offset;
+    if (first > bytes)
+        first = bytes;
+
+    memcpy(mBuffer + offset, data, first);
+    memcpy(mBuffer, (const unsigned char*) data + first, bytes - first);
+
+    mWritePos.store(writePos + bytes, std::memory_order_release);
+
+    return bytes;
+}
+
+bool RingBuffer::writeSpans(size_t bytes, unsigned char** first, size_t* firstBytes, unsigned char** second)
+{
+    size_t writePos = mWritePos.load(std::memory_order_relaxed);
+    size_t readPos = mReadPos.load(std::memory_order_acquire);
+
+    if (bytes > mCapacity - (writePos - readPos))
+        return false;
+
+    size_t offset = writePos & (mCapacity - 1);
+    size_t contiguous = mCapacity - offset;
+
+    *first = mBuffer + offset;
+    *firstBytes = contiguous < bytes ? contiguous : bytes;
+    *second = mBuffer;
+
+    return true;
+}
+
+void RingBuffer::commitWrite(size_t bytes)
+{
+    mWritePos.store(mWritePos.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t RingBuffer::writeAvailable() const
+{
+    return mCapacity - readAvailable();
+}
+
+size_t RingBuffer::read(void* data, size_t bytes)
+{
+    size_t readPos = mReadPos.load(std::memory_order_relaxed);
+    size_t writePos = mWritePos.load(std::memory_order_acquire);
+    size_t available = writePos - readPos;
+
+    if (bytes > available)
+        bytes = available;
+
+    size_t offset = readPos & (mCapacity - 1);
+    size_t first = mCapacity - offset;
+    if (first > bytes)
+        first = bytes;
+
+    memcpy(data, mBuffer + offset, first);
+    memcpy((unsigned char*) data + first, mBuffer, bytes - first);
+
+    mReadPos.store(readPos + bytes, std::memory_order_release);
+
+    return bytes;
+}
+
+bool RingBuffer::readSpans(size_t bytes, const unsigned char** first, size_t* firstBytes, const unsigned char** second)
+{
+    size_t readPos = mReadPos.load(std::memory_order_relaxed);
+    size_t writePos = mWritePos.load(std::memory_order_acquire);
+
+    if (bytes > writePos - readPos)
+        return false;
+
+    size_t offset = readPos & (mCapacity - 1);
+    size_t contiguous = mCapacity - offset;
+
+    *first = mBuffer + offset;
+    *firstBytes = contiguous < bytes ? contiguous : bytes;
+    *second = mBuffer;
+
+    return true;
+}
+
+void RingBuffer::commitRead(size_t bytes)
+{
+    mReadPos.store(mReadPos.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t RingBuffer::readAvailable() const
+{
+    return mWritePos.load(std::memory_order_acquire) - mReadPos.load(std::memory_order_acquire);
+}
+
+void RingBuffer::clear()
+{
+    mReadPos.store(mWritePos.load(std::memory_order_acquire), std::memory_order_release);
+}
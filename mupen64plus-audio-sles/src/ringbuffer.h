@@ -0,0 +1,73 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - ringbuffer.h                                 *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __RINGBUFFER_H__
+#define __RINGBUFFER_H__
+
+#include <atomic>
+#include <stddef.h>
+
+/* Lock-free byte ring buffer for exactly one producer and one consumer thread.
+   Neither side ever blocks or allocates once the buffer has been initialized. */
+class RingBuffer
+{
+public:
+    RingBuffer();
+    ~RingBuffer();
+
+    /* Allocates the storage, capacity is rounded up to a power of two */
+    bool init(size_t capacity);
+    void release();
+
+    /* Producer side, returns the number of bytes actually written */
+    size_t write(const void* data, size_t bytes);
+    size_t writeAvailable() const;
+
+    /* Producer side without the intermediate copy: returns false if fewer than
+       bytes are free, otherwise the space to fill, split in two where it wraps.
+       The data becomes visible to the consumer with commitWrite. */
+    bool writeSpans(size_t bytes, unsigned char** first, size_t* firstBytes, unsigned char** second);
+    void commitWrite(size_t bytes);
+
+    /* Consumer side, returns the number of bytes actually read */
+    size_t read(void* data, size_t bytes);
+    size_t readAvailable() const;
+
+    /* Consumer side without the copy: returns false if fewer than bytes are
+       queued, otherwise where they are stored, split in two where the buffer
+       wraps. The space is handed back to the producer with commitRead. */
+    bool readSpans(size_t bytes, const unsigned char** first, size_t* firstBytes, const unsigned char** second);
+    void commitRead(size_t bytes);
+
+    /* Drops all queued data, only call this from the consumer side */
+    void clear();
+
+    size_t capacity() const { return mCapacity; }
+
+private:
+    unsigned char* mBuffer;
+    size_t mCapacity;
+
+    /* Free running positions, wrapped into the buffer with mCapacity - 1 */
+    std::atomic<size_t> mReadPos;
+    std::atomic<size_t> mWritePos;
+};
+
+#endif /* __RINGBUFFER_H__ */
@@ -0,0 +1,102 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - samples.cpp                                  *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "samples.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SAMPLES_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SAMPLES_SSE2
+#endif
+
+#define SAMPLE_SCALE (1.0f / 32767.0f)
+
+static inline uint32_t convert_frame(uint32_t frame, bool swapChannels)
+{
+    return swapChannels ? frame : (frame >> 16) | (frame << 16);
+}
+
+void samples_convert_s16(int16_t* dst, const unsigned char* src, unsigned int frames, bool swapChannels)
+{
+    const uint32_t* in = (const uint32_t*) src;
+    uint32_t* out = (uint32_t*) dst;
+    unsigned int i = 0;
+
+#if defined(SAMPLES_NEON)
+    for (; i + 4 <= frames; i += 4)
+    {
+        int16x8_t v = vld1q_s16((const int16_t*) (in + i));
+        if (!swapChannels)
+            v = vrev32q_s16(v);
+        vst1q_s16((int16_t*) (out + i), v);
+    }
+#elif defined(SAMPLES_SSE2)
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) (in + i));
+        if (!swapChannels)
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i*) (out + i), v);
+    }
+#endif
+
+    for (; i < frames; ++i)
+        out[i] = convert_frame(in[i], swapChannels);
+}
+
+void samples_convert_float(float* dst, const unsigned char* src, unsigned int frames, bool swapChannels)
+{
+    const uint32_t* in = (const uint32_t*) src;
+    unsigned int i = 0;
+
+#if defined(SAMPLES_NEON)
+    for (; i + 4 <= frames; i += 4)
+    {
+        int16x8_t v = vld1q_s16((const int16_t*) (in + i));
+        if (!swapChannels)
+            v = vrev32q_s16(v);
+        vst1q_f32(dst + i * 2, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), SAMPLE_SCALE));
+        vst1q_f32(dst + i * 2 + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), SAMPLE_SCALE));
+    }
+#elif defined(SAMPLES_SSE2)
+    const __m128 scale = _mm_set1_ps(SAMPLE_SCALE);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) (in + i));
+        if (!swapChannels)
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+        /* sign extend by moving each sample into the upper half of a 32 bit lane */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i * 2, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i * 2 + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+
+    for (; i < frames; ++i)
+    {
+        uint32_t frame = convert_frame(in[i], swapChannels);
+        dst[i * 2] = (float) (int16_t) (frame & 0xffff) * SAMPLE_SCALE;
+        dst[i * 2 + 1] = (float) (int16_t) (frame >> 16) * SAMPLE_SCALE;
+    }
+}
@@ -0,0 +1,32 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - samples.h                                    *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __SAMPLES_H__
+#define __SAMPLES_H__
+
+#include <stdint.h>
+
+/* Converts N64 stereo frames into interleaved left/right output samples in a single pass.
+   In host order the N64 stores the left sample in the upper half of each 32 bit frame, so
+   the halves are exchanged unless swapChannels is set. */
+void samples_convert_s16(int16_t* dst, const unsigned char* src, unsigned int frames, bool swapChannels);
+void samples_convert_float(float* dst, const unsigned char* src, unsigned int frames, bool swapChannels);
+
+#endif /* __SAMPLES_H__ */
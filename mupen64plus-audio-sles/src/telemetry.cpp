@@ -0,0 +1,131 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - telemetry.cpp                                *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include <time.h>
+#include <atomic>
+
+#include "telemetry.h"
+
+static std::atomic<int> l_SampleRate(0);
+static std::atomic<unsigned int> l_Underruns(0);
+static std::atomic<int> l_QueueDepthMs(0);
+static std::atomic<int> l_RatioPpm(1000000);
+
+/* Ring of per interval minimums, l_HistoryCount is the number of completed
+   intervals and only ever grows until the next reset */
+static std::atomic<int> l_History[TELEMETRY_HISTORY_SIZE];
+static std::atomic<unsigned int> l_HistoryCount(0);
+
+/* Current interval, only touched by the thread feeding the output */
+static long long l_IntervalStart = 0;
+static int l_IntervalMin = -1;
+
+static long long NowMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void telemetry_reset(int sampleRate)
+{
+    l_SampleRate = sampleRate;
+    l_Underruns = 0;
+    l_QueueDepthMs = 0;
+    l_RatioPpm = 1000000;
+    l_HistoryCount = 0;
+    l_IntervalStart = NowMs();
+    l_IntervalMin = -1;
+}
+
+void telemetry_queue_depth(unsigned int frames)
+{
+    int sampleRate = l_SampleRate.load(std::memory_order_relaxed);
+    if (sampleRate <= 0)
+        return;
+
+    int depthMs = (int) ((long long) frames * 1000 / sampleRate);
+    l_QueueDepthMs.store(depthMs, std::memory_order_relaxed);
+
+    if (l_IntervalMin < 0 || depthMs < l_IntervalMin)
+        l_IntervalMin = depthMs;
+
+    long long now = NowMs();
+    if (now - l_IntervalStart >= TELEMETRY_INTERVAL_MS)
+    {
+        unsigned int count = l_HistoryCount.load(std::memory_order_relaxed);
+        l_History[count % TELEMETRY_HISTORY_SIZE].store(l_IntervalMin, std::memory_order_relaxed);
+        l_HistoryCount.store(count + 1, std::memory_order_release);
+
+        l_IntervalStart = now;
+        l_IntervalMin = -1;
+    }
+}
+
+void telemetry_underrun(void)
+{
+    ++l_Underruns;
+}
+
+void telemetry_ratio(double ratio)
+{
+    l_RatioPpm.store((int) (ratio * 1000000.0 + 0.5), std::memory_order_relaxed);
+}
+
+unsigned int telemetry_underruns(void)
+{
+    return l_Underruns;
+}
+
+int telemetry_queue_depth_ms(void)
+{
+    return l_QueueDepthMs.load(std::memory_order_relaxed);
+}
+
+double telemetry_get_ratio(void)
+{
+    return l_RatioPpm.load(std::memory_order_relaxed) / 1000000.0;
+}
+
+int telemetry_history(int* history, int count, int* min, int* max)
+{
+    unsigned int total = l_HistoryCount.load(std::memory_order_acquire);
+    unsigned int available = total < TELEMETRY_HISTORY_SIZE ? total : TELEMETRY_HISTORY_SIZE;
+
+    if (count < 0)
+        count = 0;
+    if ((unsigned int) count > available)
+        count = (int) available;
+
+    for (int i = 0; i < count; ++i)
+    {
+        int value = l_History[(total - count + i) % TELEMETRY_HISTORY_SIZE].load(std::memory_order_relaxed);
+
+        if (history != NULL)
+            history[i] = value;
+        if (i == 0 || value < *min)
+            *min = value;
+        if (i == 0 || value > *max)
+            *max = value;
+    }
+
+    return count;
+}
@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - telemetry.h                                  *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+/* Timing statistics of the audio output, collected by the audio threads and
+   read by the frontend through AudioGetStats. Every function is safe to call
+   from any thread. */
+
+/* Number of queue depth samples kept, one per TELEMETRY_INTERVAL_MS */
+#define TELEMETRY_HISTORY_SIZE 64
+#define TELEMETRY_INTERVAL_MS 100
+
+/* Clears all statistics, sampleRate is the rate the output runs at */
+void telemetry_reset(int sampleRate);
+
+/* Output queue depth in frames, each history entry keeps the lowest depth
+   seen during its interval since that is what leads to underruns */
+void telemetry_queue_depth(unsigned int frames);
+
+/* The output played silence because no samples were queued */
+void telemetry_underrun(void);
+
+/* Current playback speed relative to the nominal rate, 1.0 when neither time
+   stretching nor dynamic rate control is adjusting it */
+void telemetry_ratio(double ratio);
+
+unsigned int telemetry_underruns(void);
+int telemetry_queue_depth_ms(void);
+double telemetry_get_ratio(void);
+
+/* Copies up to count history entries in milliseconds, oldest first, and
+   returns how many were copied. min and max receive the range of the copied
+   entries and are left untouched if there are none. */
+int telemetry_history(int* history, int count, int* min, int* max);
+
+#endif /* __TELEMETRY_H__ */
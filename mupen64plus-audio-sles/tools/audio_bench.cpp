@@ -0,0 +1,379 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-audio-sles - tools/audio_bench.cpp                        *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Replays AI DMA streams recorded with ENABLE_AI_DUMP (see ai_dump.h) through
+   the processing the audio consumer threads use, into a null output, and
+   reports the CPU time spent per second of audio for each mode:
+
+     convert   sample conversion only, the cost of the queue path
+     stretch   SoundTouch time stretching and rate conversion (default mode)
+     resample  the cubic resampler of the dynamic rate control mode
+
+   The delay column is how much audio the processing holds back, that is the
+   time fed in minus the time that came out, after each DMA. It is the latency
+   a mode adds on top of the output buffers, which AudioGetStats measures on
+   the device. Without a dump file a sine wave is generated with -g. */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include <SoundTouch.h>
+
+#include "ai_dump.h"
+#include "resampler.h"
+#include "samples.h"
+
+using namespace soundtouch;
+
+#define N64_SAMPLE_BYTES 4
+
+struct Chunk
+{
+    unsigned int frequency;
+    size_t offset;
+    unsigned int frames;
+};
+
+struct Stream
+{
+    std::vector<unsigned char> data;
+    std::vector<Chunk> chunks;
+    double seconds;
+};
+
+struct Options
+{
+    unsigned int outputFreq;
+    unsigned int bufferSize;
+    unsigned int speed;
+    unsigned int passes;
+    bool swapChannels;
+};
+
+enum { MODE_CONVERT, MODE_STRETCH, MODE_RESAMPLE, MODE_COUNT };
+
+static const char* const modeNames[MODE_COUNT] = { "convert", "stretch", "resample" };
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+}
+
+static void addChunk(Stream* stream, unsigned int frequency, unsigned int length)
+{
+    Chunk chunk;
+
+    chunk.frequency = frequency;
+    chunk.offset = stream->data.size() - length;
+    chunk.frames = length / N64_SAMPLE_BYTES;
+    stream->chunks.push_back(chunk);
+    stream->seconds += (double) chunk.frames / frequency;
+}
+
+static bool loadDump(const char* filename, Stream* stream)
+{
+    char magic[AI_DUMP_MAGIC_SIZE];
+    ai_dump_record record;
+    FILE* f = fopen(filename, "rb");
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "Couldn't open %s\n", filename);
+        return false;
+    }
+
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+        memcmp(magic, AI_DUMP_MAGIC, AI_DUMP_MAGIC_SIZE) != 0)
+    {
+        fprintf(stderr, "%s is not an AI dump\n", filename);
+        fclose(f);
+        return false;
+    }
+
+    while (fread(&record, sizeof(record), 1, f) == 1)
+    {
+        size_t offset = stream->data.size();
+
+        if (record.frequency == 0 || record.length % N64_SAMPLE_BYTES != 0)
+        {
+            fprintf(stderr, "%s is corrupted\n", filename);
+            break;
+        }
+
+        stream->data.resize(offset + record.length);
+        if (fread(&stream->data[offset], 1, record.length, f) != record.length)
+        {
+            stream->data.resize(offset);
+            break;
+        }
+
+        addChunk(stream, record.frequency, record.length);
+    }
+
+    fclose(f);
+    return !stream->chunks.empty();
+}
+
+/* A 440 Hz tone at 33600 Hz in DMAs of one 60 Hz frame, laid out like RDRAM
+   holds it in host order: left sample in the upper half of each frame */
+static void generateSine(Stream* stream, double seconds)
+{
+    static const unsigned int frequency = 33600;
+    static const unsigned int chunkFrames = frequency / 60;
+    unsigned int total = (unsigned int) (seconds * frequency);
+
+    for (unsigned int i = 0; i < total; i += chunkFrames)
+    {
+        size_t offset = stream->data.size();
+
+        stream->data.resize(offset + chunkFrames * N64_SAMPLE_BYTES);
+        uint32_t* frames = (uint32_t*) &stream->data[offset];
+
+        for (unsigned int j = 0; j < chunkFrames; ++j)
+        {
+            int16_t s = (int16_t) (sin(2.0 * M_PI * 440.0 * (i + j) / frequency) * 16000.0);
+            frames[j] = ((uint32_t) (uint16_t) s << 16) | (uint16_t) s;
+        }
+
+        addChunk(stream, frequency, chunkFrames * N64_SAMPLE_BYTES);
+    }
+}
+
+static void convert(SAMPLETYPE* dst, const unsigned char* src, unsigned int frames, bool swapChannels)
+{
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+    samples_convert_float(dst, src, frames, swapChannels);
+#else
+    samples_convert_s16(dst, src, frames, swapChannels);
+#endif
+}
+
+/* Runs one pass over the stream. Returns the elapsed time in seconds, the
+   delay statistics are in milliseconds. */
+static double runPass(int mode, const Stream& stream, const Options& opts, double* avgDelay, double* maxDelay)
+{
+    SoundTouch soundTouch;
+    Resampler resampler;
+    std::vector<SAMPLETYPE> in;
+    std::vector<SAMPLETYPE> out(opts.bufferSize * 2);
+    unsigned int frequency = 0;
+    double speedFactor = opts.speed / 100.0;
+    double inTime = 0.0, outTime = 0.0, delaySum = 0.0;
+    volatile SAMPLETYPE sink = 0;
+
+    *avgDelay = *maxDelay = 0.0;
+
+    double start = now();
+
+    for (size_t i = 0; i < stream.chunks.size(); ++i)
+    {
+        const Chunk& chunk = stream.chunks[i];
+        unsigned int outFrames = 0;
+
+        /* The consumers are set up again when the game changes its rate */
+        if (chunk.frequency != frequency)
+        {
+            frequency = chunk.frequency;
+            soundTouch.clear();
+            soundTouch.setSampleRate(frequency);
+            soundTouch.setChannels(2);
+            soundTouch.setSetting(SETTING_USE_QUICKSEEK, 1);
+            soundTouch.setSetting(SETTING_USE_AA_FILTER, 1);
+            soundTouch.setRate((double) frequency / opts.outputFreq);
+            soundTouch.setTempo(speedFactor);
+            resampler.reset();
+            resampler.setRatio((double) frequency / opts.outputFreq);
+        }
+
+        if (in.size() < chunk.frames * 2)
+            in.resize(chunk.frames * 2);
+        convert(&in[0], &stream.data[chunk.offset], chunk.frames, opts.swapChannels);
+
+        if (mode == MODE_CONVERT)
+        {
+            sink = in[chunk.frames - 1];
+            continue;
+        }
+        else if (mode == MODE_STRETCH)
+        {
+            unsigned int received;
+
+            soundTouch.putSamples(&in[0], chunk.frames);
+            while ((received = soundTouch.receiveSamples(&out[0], opts.bufferSize)) != 0)
+                outFrames += received;
+
+            inTime += (double) chunk.frames / frequency / speedFactor;
+        }
+        else
+        {
+            const SAMPLETYPE* src = &in[0];
+            unsigned int left = chunk.frames;
+
+            while (left > 0)
+            {
+                unsigned int consumed = 0;
+                outFrames += resampler.process(src, left, &consumed, &out[0], opts.bufferSize);
+                src += consumed * 2;
+                left -= consumed;
+            }
+
+            inTime += (double) chunk.frames / frequency;
+        }
+
+        sink = out[0];
+        outTime += (double) outFrames / opts.outputFreq;
+
+        /* The resampler may produce slightly ahead of its input */
+        double delay = (inTime - outTime) * 1000.0;
+        if (delay < 0.0)
+            delay = 0.0;
+        delaySum += delay;
+        if (delay > *maxDelay)
+            *maxDelay = delay;
+    }
+
+    double elapsed = now() - start;
+
+    (void) sink;
+    if (mode != MODE_CONVERT)
+        *avgDelay = delaySum / stream.chunks.size();
+
+    return elapsed;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options] [dump.bin...]\n"
+        "  -r rate     output sample rate (default 48000)\n"
+        "  -b frames   secondary buffer size (default 256)\n"
+        "  -s percent  speed factor for the stretch mode (default 100)\n"
+        "  -n passes   passes over each stream (default 5)\n"
+        "  -w          swap left and right channels\n"
+        "  -g seconds  generate a sine wave instead of reading dumps\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    Options opts;
+    double generate = 0.0;
+    int first = 1;
+
+    opts.outputFreq = 48000;
+    opts.bufferSize = 256;
+    opts.speed = 100;
+    opts.passes = 5;
+    opts.swapChannels = false;
+
+    for (; first < argc && argv[first][0] == '-'; ++first)
+    {
+        const char* arg = argv[first];
+
+        if (strcmp(arg, "-w") == 0)
+            opts.swapChannels = true;
+        else if (first + 1 < argc && strcmp(arg, "-r") == 0)
+            opts.outputFreq = atoi(argv[++first]);
+        else if (first + 1 < argc && strcmp(arg, "-b") == 0)
+            opts.bufferSize = atoi(argv[++first]);
+        else if (first + 1 < argc && strcmp(arg, "-s") == 0)
+            opts.speed = atoi(argv[++first]);
+        else if (first + 1 < argc && strcmp(arg, "-n") == 0)
+            opts.passes = atoi(argv[++first]);
+        else if (first + 1 < argc && strcmp(arg, "-g") == 0)
+            generate = atof(argv[++first]);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (opts.outputFreq == 0 || opts.bufferSize == 0 || opts.speed < 10 || opts.speed > 300 ||
+        opts.passes == 0 || (first == argc && generate <= 0.0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Stream> streams;
+    std::vector<const char*> names;
+
+    if (generate > 0.0)
+    {
+        streams.push_back(Stream());
+        streams.back().seconds = 0.0;
+        generateSine(&streams.back(), generate);
+        names.push_back("sine");
+    }
+
+    for (int i = first; i < argc; ++i)
+    {
+        streams.push_back(Stream());
+        streams.back().seconds = 0.0;
+        if (!loadDump(argv[i], &streams.back()))
+        {
+            streams.pop_back();
+            continue;
+        }
+        names.push_back(argv[i]);
+    }
+
+    printf("%s samples, output %u Hz, buffer %u frames, speed %u%%\n",
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+        "float",
+#else
+        "s16",
+#endif
+        opts.outputFreq, opts.bufferSize, opts.speed);
+    printf("%-24s %-9s %8s %12s %10s %10s\n", "stream", "mode", "audio s", "us/s audio", "realtime", "delay ms");
+
+    for (size_t s = 0; s < streams.size(); ++s)
+    {
+        for (int mode = 0; mode < MODE_COUNT; ++mode)
+        {
+            double best = 0.0, avgDelay = 0.0, maxDelay = 0.0;
+
+            /* The fastest pass is the one least disturbed by the rest of the system */
+            for (unsigned int pass = 0; pass < opts.passes; ++pass)
+            {
+                double elapsed = runPass(mode, streams[s], opts, &avgDelay, &maxDelay);
+                if (pass == 0 || elapsed < best)
+                    best = elapsed;
+            }
+
+            char delay[32] = "-";
+            if (mode != MODE_CONVERT)
+                snprintf(delay, sizeof(delay), "%.1f/%.1f", avgDelay, maxDelay);
+
+            printf("%-24s %-9s %8.1f %12.1f %9.0fx %10s\n", names[s], modeNames[mode],
+                streams[s].seconds, best * 1.0e6 / streams[s].seconds,
+                best > 0.0 ? streams[s].seconds / best : 0.0, delay);
+        }
+    }
+
+    return 0;
+}
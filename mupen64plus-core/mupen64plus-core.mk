@@ -31,13 +31,20 @@ LOCAL_SRC_FILES :=                                              \
     $(SRCDIR)/main/cheat.c                                      \
     $(SRCDIR)/device/device.c                                   \
     $(SRCDIR)/main/eventloop.c                                  \
+    $(SRCDIR)/main/gfx_trace.c                                  \
+    $(SRCDIR)/main/input_log.c                                  \
     $(SRCDIR)/main/main.c                                       \
     $(SRCDIR)/main/md5.c                                        \
     $(SRCDIR)/main/profile.c                                    \
     $(SRCDIR)/main/rom.c                                        \
+    $(SRCDIR)/main/rewind.c                                     \
+    $(SRCDIR)/main/rsp_async.c                                  \
+    $(SRCDIR)/main/runahead.c                                   \
     $(SRCDIR)/main/savestates.c                                 \
     $(SRCDIR)/main/sdl_key_converter.c                          \
+    $(SRCDIR)/main/thread_placement.c                           \
     $(SRCDIR)/main/util.c                                       \
+    $(SRCDIR)/main/workqueue.c                                  \
     $(SRCDIR)/main/zip/ioapi.c                                  \
     $(SRCDIR)/main/zip/unzip.c                                  \
     $(SRCDIR)/main/zip/zip.c                                    \
@@ -76,6 +83,7 @@ LOCAL_SRC_FILES :=                                              \
     $(SRCDIR)/device/r4300/tlb.c                                \
     $(SRCDIR)/device/r4300/new_dynarec/new_dynarec.c            \
     $(SRCDIR)/device/r4300/idec.c                               \
+    $(SRCDIR)/device/r4300/idle_loop.c                          \
     $(SRCDIR)/device/rcp/rdp/rdp_core.c                         \
     $(SRCDIR)/device/rdram/rdram.c                              \
     $(SRCDIR)/device/rcp/ri/ri_controller.c                     \
@@ -97,11 +105,19 @@ LOCAL_CFLAGS :=         \
     $(COMMON_CFLAGS)    \
     -DANDROID           \
     -DIOAPI_NO_64       \
+    -DM64P_PARALLEL     \
     -DNOCRYPT           \
     -DNOUNCRYPT         \
+    -DNO_SDL_EVENTS     \
     -DUSE_GLES=1        \
     -DUSE_SDL
 
+# r4300 block entries/invalidations (M64CMD_PROFILE_BLOCKS_DUMP), as in the unix Makefile
+ifeq ($(DBG_BLOCK_PROFILE), 1)
+    LOCAL_SRC_FILES += $(SRCDIR)/device/r4300/block_profiler.c
+    LOCAL_CFLAGS += -DPROFILE_BLOCKS
+endif
+
 LOCAL_LDFLAGS :=                                                    \
     $(COMMON_LDFLAGS)                                               \
     -Wl,-Bsymbolic                                                  \
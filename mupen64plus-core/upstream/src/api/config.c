@@ -23,6 +23,7 @@
  * outside of the core library.
  */
 
+#include <ctype.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +42,10 @@
 #define MUPEN64PLUS_CFG_NAME "mupen64plus.cfg"
 
 #define SECTION_MAGIC 0xDBDC0580
+#define VAR_MAGIC     0xDBDC0581
+
+/* number of hash buckets indexing the variables of each section */
+#define SECTION_VAR_BUCKETS 32
 
 struct external_config {
   char *file;
@@ -48,6 +53,8 @@ struct external_config {
 };
 
 typedef struct _config_var {
+  unsigned int          magic;
+  unsigned int          hash;
   char                 *name;
   m64p_type             type;
   union {
@@ -57,12 +64,15 @@ typedef struct _config_var {
   } val;
   char                 *comment;
   struct _config_var   *next;
+  struct _config_var   *hash_next;
   } config_var;
 
 typedef struct _config_section {
   unsigned int            magic;
+  unsigned int            hash;
   char                   *name;
   struct _config_var     *first_var;
+  struct _config_var     *var_buckets[SECTION_VAR_BUCKETS];
   struct _config_section *next;
   } config_section;
 
@@ -91,6 +101,23 @@ static int is_numeric(const char *string)
     return (rval == 1);
 }
 
+/* Case-insensitive FNV-1a hash of a section or parameter name. Names which
+ * compare equal with osal_insensitive_strcmp() always get the same hash, so
+ * lookups only need to compare the strings when the hashes match.
+ */
+static unsigned int config_name_hash(const char *name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*name != '\0')
+    {
+        hash ^= (unsigned int) tolower((unsigned char) *name++);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
 /* This function returns a pointer to the pointer of the requested section
  * (i.e. a pointer the next field of the previous element, or to the first node).
  *
@@ -102,9 +129,11 @@ static int is_numeric(const char *string)
 static config_section **find_section_link(config_list *list, const char *ParamName)
 {
     config_section **curr_sec_link;
+    unsigned int hash = config_name_hash(ParamName);
+
     for (curr_sec_link = list; *curr_sec_link != NULL; curr_sec_link = &(*curr_sec_link)->next)
     {
-        if (osal_insensitive_strcmp(ParamName, (*curr_sec_link)->name) == 0)
+        if ((*curr_sec_link)->hash == hash && osal_insensitive_strcmp(ParamName, (*curr_sec_link)->name) == 0)
             break;
     }
 
@@ -147,6 +176,8 @@ static config_var *config_var_create(const char *ParamName, const char *ParamHel
 
     memset(var, 0, sizeof(config_var));
 
+    var->magic = VAR_MAGIC;
+    var->hash = config_name_hash(ParamName);
     var->name = strdup(ParamName);
     if (var->name == NULL)
     {
@@ -171,16 +202,18 @@ static config_var *config_var_create(const char *ParamName, const char *ParamHel
         var->comment = NULL;
 
     var->next = NULL;
+    var->hash_next = NULL;
     return var;
 }
 
 static config_var *find_section_var(config_section *section, const char *ParamName)
 {
-    /* walk through the linked list of variables in the section */
+    /* walk through the hash bucket which holds this name */
+    unsigned int hash = config_name_hash(ParamName);
     config_var *curr_var;
-    for (curr_var = section->first_var; curr_var != NULL; curr_var = curr_var->next)
+    for (curr_var = section->var_buckets[hash % SECTION_VAR_BUCKETS]; curr_var != NULL; curr_var = curr_var->hash_next)
     {
-        if (osal_insensitive_strcmp(ParamName, curr_var->name) == 0)
+        if (curr_var->hash == hash && osal_insensitive_strcmp(ParamName, curr_var->name) == 0)
             return curr_var;
     }
 
@@ -188,6 +221,14 @@ static config_var *find_section_var(config_section *section, const char *ParamNa
     return NULL;
 }
 
+static void index_var_in_section(config_section *section, config_var *var)
+{
+    config_var **bucket = &section->var_buckets[var->hash % SECTION_VAR_BUCKETS];
+
+    var->hash_next = *bucket;
+    *bucket = var;
+}
+
 static void append_var_to_section(config_section *section, config_var *var)
 {
     config_var *last_var;
@@ -195,6 +236,8 @@ static void append_var_to_section(config_section *section, config_var *var)
     if (section == NULL || var == NULL || section->magic != SECTION_MAGIC)
         return;
 
+    index_var_in_section(section, var);
+
     if (section->first_var == NULL)
     {
         section->first_var = var;
@@ -212,6 +255,7 @@ static void delete_var(config_var *var)
 {
     if (var->type == M64TYPE_STRING)
         free(var->val.string);
+    var->magic = 0;
     free(var->name);
     free(var->comment);
     free(var);
@@ -232,6 +276,7 @@ static void delete_section(config_section *pSection)
         curr_var = next_var;
     }
 
+    pSection->magic = 0;
     free(pSection->name);
     free(pSection);
 }
@@ -263,6 +308,7 @@ static config_section *config_section_create(const char *ParamName)
         return NULL;
 
     sec->magic = SECTION_MAGIC;
+    sec->hash = config_name_hash(ParamName);
     sec->name = strdup(ParamName);
     if (sec->name == NULL)
     {
@@ -270,6 +316,7 @@ static config_section *config_section_create(const char *ParamName)
         return NULL;
     }
     sec->first_var = NULL;
+    memset(sec->var_buckets, 0, sizeof(sec->var_buckets));
     sec->next = NULL;
     return sec;
 }
@@ -330,6 +377,7 @@ static config_section * section_deepcopy(config_section *orig_section)
         }
 
         /* add the new variable to the new section */
+        index_var_in_section(new_section, new_var);
         if (last_new_var == NULL)
             new_section->first_var = new_var;
         else
@@ -342,6 +390,87 @@ static config_section * section_deepcopy(config_section *orig_section)
     return new_section;
 }
 
+/* These functions translate the actual type of a variable into the type which
+ * is asked for by one of the Get functions named in 'FuncName'
+ */
+static int var_to_int(const config_var *var, const char *FuncName)
+{
+    switch(var->type)
+    {
+        case M64TYPE_INT:
+            return var->val.integer;
+        case M64TYPE_FLOAT:
+            return (int) var->val.number;
+        case M64TYPE_BOOL:
+            return (var->val.integer != 0);
+        case M64TYPE_STRING:
+            return atoi(var->val.string);
+        default:
+            DebugMessage(M64MSG_ERROR, "%s(): invalid internal parameter type for '%s'", FuncName, var->name);
+            return 0;
+    }
+}
+
+static float var_to_float(const config_var *var, const char *FuncName)
+{
+    switch(var->type)
+    {
+        case M64TYPE_INT:
+            return (float) var->val.integer;
+        case M64TYPE_FLOAT:
+            return var->val.number;
+        case M64TYPE_BOOL:
+            return (var->val.integer != 0) ? 1.0f : 0.0f;
+        case M64TYPE_STRING:
+            return (float) atof(var->val.string);
+        default:
+            DebugMessage(M64MSG_ERROR, "%s(): invalid internal parameter type for '%s'", FuncName, var->name);
+            return 0.0;
+    }
+}
+
+static int var_to_bool(const config_var *var, const char *FuncName)
+{
+    switch(var->type)
+    {
+        case M64TYPE_INT:
+            return (var->val.integer != 0);
+        case M64TYPE_FLOAT:
+            return (var->val.number != 0.0);
+        case M64TYPE_BOOL:
+            return var->val.integer;
+        case M64TYPE_STRING:
+            return (osal_insensitive_strcmp(var->val.string, "true") == 0);
+        default:
+            DebugMessage(M64MSG_ERROR, "%s(): invalid internal parameter type for '%s'", FuncName, var->name);
+            return 0;
+    }
+}
+
+static const char *var_to_string(const config_var *var, const char *FuncName)
+{
+    static char outstr[64];  /* warning: not thread safe */
+
+    switch(var->type)
+    {
+        case M64TYPE_INT:
+            snprintf(outstr, 63, "%i", var->val.integer);
+            outstr[63] = 0;
+            return outstr;
+        case M64TYPE_FLOAT:
+            snprintf(outstr, 63, "%f", var->val.number);
+            outstr[63] = 0;
+            return outstr;
+        case M64TYPE_BOOL:
+            return (var->val.integer ? "True" : "False");
+        case M64TYPE_STRING:
+            return var->val.string;
+        default:
+            DebugMessage(M64MSG_ERROR, "%s(): invalid internal parameter type for '%s'", FuncName, var->name);
+            return "";
+    }
+}
+
 static void copy_configlist_active_to_saved(void)
 {
     config_section *curr_section = l_ConfigListActive;
@@ -1387,21 +1516,7 @@ EXPORT int CALL ConfigGetParamInt(m64p_handle ConfigSectionHandle, const char *P
         return 0;
     }
 
-    /* translate the actual variable type to an int */
-    switch(var->type)
-    {
-        case M64TYPE_INT:
-            return var->val.integer;
-        case M64TYPE_FLOAT:
-            return (int) var->val.number;
-        case M64TYPE_BOOL:
-            return (var->val.integer != 0);
-        case M64TYPE_STRING:
-            return atoi(var->val.string);
-        default:
-            DebugMessage(M64MSG_ERROR, "ConfigGetParamInt(): invalid internal parameter type for '%s'", ParamName);
-            return 0;
-    }
+    return var_to_int(var, "ConfigGetParamInt");
 }
 
 EXPORT float CALL ConfigGetParamFloat(m64p_handle ConfigSectionHandle, const char *ParamName)
@@ -1431,21 +1546,7 @@ EXPORT float CALL ConfigGetParamFloat(m64p_handle ConfigSectionHandle, const cha
         return 0.0;
     }
 
-    /* translate the actual variable type to an int */
-    switch(var->type)
-    {
-        case M64TYPE_INT:
-            return (float) var->val.integer;
-        case M64TYPE_FLOAT:
-            return var->val.number;
-        case M64TYPE_BOOL:
-            return (var->val.integer != 0) ? 1.0f : 0.0f;
-        case M64TYPE_STRING:
-            return (float) atof(var->val.string);
-        default:
-            DebugMessage(M64MSG_ERROR, "ConfigGetParamFloat(): invalid internal parameter type for '%s'", ParamName);
-            return 0.0;
-    }
+    return var_to_float(var, "ConfigGetParamFloat");
 }
 
 EXPORT int CALL ConfigGetParamBool(m64p_handle ConfigSectionHandle, const char *ParamName)
@@ -1475,26 +1576,11 @@ EXPORT int CALL ConfigGetParamBool(m64p_handle ConfigSectionHandle, const char *
         return 0;
     }
 
-    /* translate the actual variable type to an int */
-    switch(var->type)
-    {
-        case M64TYPE_INT:
-            return (var->val.integer != 0);
-        case M64TYPE_FLOAT:
-            return (var->val.number != 0.0);
-        case M64TYPE_BOOL:
-            return var->val.integer;
-        case M64TYPE_STRING:
-            return (osal_insensitive_strcmp(var->val.string, "true") == 0);
-        default:
-            DebugMessage(M64MSG_ERROR, "ConfigGetParamBool(): invalid internal parameter type for '%s'", ParamName);
-            return 0;
-    }
+    return var_to_bool(var, "ConfigGetParamBool");
 }
 
 EXPORT const char * CALL ConfigGetParamString(m64p_handle ConfigSectionHandle, const char *ParamName)
 {
-    static char outstr[64];  /* warning: not thread safe */
     config_section *section;
     config_var *var;
 
@@ -1520,25 +1606,87 @@ EXPORT const char * CALL ConfigGetParamString(m64p_handle ConfigSectionHandle, c
         return "";
     }
 
-    /* translate the actual variable type to an int */
-    switch(var->type)
+    return var_to_string(var, "ConfigGetParamString");
+}
+
+/* -------------------------------------------------------- */
+/* Handle-based Get functions, exported outside of the Core */
+/* -------------------------------------------------------- */
+
+EXPORT m64p_error CALL ConfigGetParamHandle(m64p_handle ConfigSectionHandle, const char *ParamName, m64p_handle *ParamHandle)
+{
+    config_section *section;
+    config_var *var;
+
+    /* check input conditions */
+    if (!l_ConfigInit)
+        return M64ERR_NOT_INIT;
+    if (ConfigSectionHandle == NULL || ParamName == NULL || ParamHandle == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    section = (config_section *) ConfigSectionHandle;
+    if (section->magic != SECTION_MAGIC)
+        return M64ERR_INPUT_INVALID;
+
+    /* if this parameter doesn't already exist, return an error */
+    var = find_section_var(section, ParamName);
+    if (var == NULL)
+        return M64ERR_INPUT_NOT_FOUND;
+
+    *ParamHandle = var;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT int CALL ConfigReadParamInt(m64p_handle ParamHandle)
+{
+    const config_var *var = (const config_var *) ParamHandle;
+
+    if (var == NULL || var->magic != VAR_MAGIC)
     {
-        case M64TYPE_INT:
-            snprintf(outstr, 63, "%i", var->val.integer);
-            outstr[63] = 0;
-            return outstr;
-        case M64TYPE_FLOAT:
-            snprintf(outstr, 63, "%f", var->val.number);
-            outstr[63] = 0;
-            return outstr;
-        case M64TYPE_BOOL:
-            return (var->val.integer ? "True" : "False");
-        case M64TYPE_STRING:
-            return var->val.string;
-        default:
-            DebugMessage(M64MSG_ERROR, "ConfigGetParamString(): invalid internal parameter type for '%s'", ParamName);
-            return "";
+        DebugMessage(M64MSG_ERROR, "ConfigReadParamInt(): ParamHandle invalid!");
+        return 0;
+    }
+
+    return var_to_int(var, "ConfigReadParamInt");
+}
+
+EXPORT float CALL ConfigReadParamFloat(m64p_handle ParamHandle)
+{
+    const config_var *var = (const config_var *) ParamHandle;
+
+    if (var == NULL || var->magic != VAR_MAGIC)
+    {
+        DebugMessage(M64MSG_ERROR, "ConfigReadParamFloat(): ParamHandle invalid!");
+        return 0.0;
+    }
+
+    return var_to_float(var, "ConfigReadParamFloat");
+}
+
+EXPORT int CALL ConfigReadParamBool(m64p_handle ParamHandle)
+{
+    const config_var *var = (const config_var *) ParamHandle;
+
+    if (var == NULL || var->magic != VAR_MAGIC)
+    {
+        DebugMessage(M64MSG_ERROR, "ConfigReadParamBool(): ParamHandle invalid!");
+        return 0;
+    }
+
+    return var_to_bool(var, "ConfigReadParamBool");
+}
+
+EXPORT const char * CALL ConfigReadParamString(m64p_handle ParamHandle)
+{
+    const config_var *var = (const config_var *) ParamHandle;
+
+    if (var == NULL || var->magic != VAR_MAGIC)
+    {
+        DebugMessage(M64MSG_ERROR, "ConfigReadParamString(): ParamHandle invalid!");
+        return "";
     }
+
+    return var_to_string(var, "ConfigReadParamString");
 }
 
 /* ------------------------------------------------------ */
@@ -34,6 +34,7 @@
 #include "debugger/dbg_memory.h"
 #include "device/device.h"
 #include "device/memory/memory.h"
+#include "device/r4300/cached_interp.h"
 #include "device/r4300/r4300_core.h"
 #include "m64p_debugger.h"
 #include "m64p_types.h"
@@ -48,6 +49,7 @@ static void (*callback_ui_vi)(void) = NULL;
 
 static void (*callback_core_compare)(unsigned int) = NULL;
 static void (*callback_core_data_sync)(int, void *) = NULL;
+static void (*callback_core_lockstep)(unsigned int, unsigned int) = NULL;
 
 /* global Functions for use by the Core */
 
@@ -82,6 +84,12 @@ void CoreCompareDataSync(int length, void *ptr)
         (*callback_core_data_sync)(length, ptr);
 }
 
+void CoreLockstepCallback(unsigned int event_type)
+{
+    if (callback_core_lockstep != NULL)
+        (*callback_core_lockstep)(event_type, (unsigned int) g_dev.rdram.dram_size);
+}
+
 /* exported functions for use by the front-end User Interface */
 
 EXPORT m64p_error CALL DebugSetCoreCompare(void (*dbg_core_compare)(unsigned int), void (*dbg_core_data_sync)(int, void *))
@@ -90,6 +98,12 @@ EXPORT m64p_error CALL DebugSetCoreCompare(void (*dbg_core_compare)(unsigned int
     callback_core_data_sync = dbg_core_data_sync;
     return M64ERR_SUCCESS;
 }
+
+EXPORT m64p_error CALL DebugSetCoreLockstep(void (*dbg_core_lockstep)(unsigned int, unsigned int))
+{
+    callback_core_lockstep = dbg_core_lockstep;
+    return M64ERR_SUCCESS;
+}
  
 EXPORT m64p_error CALL DebugSetCallbacks(void (*dbg_frontend_init)(void), void (*dbg_frontend_update)(unsigned int pc), void (*dbg_frontend_vi)(void))
 {
@@ -377,6 +391,16 @@ EXPORT int CALL DebugBreakpointLookup(unsigned int address, unsigned int size, u
 #endif
 }
 
+#ifdef DBG
+/* Execution breakpoints are compiled into the cached interpreter blocks */
+static int update_breakpoints(int result)
+{
+    if (get_r4300_emumode(&g_dev.r4300) == EMUMODE_INTERPRETER)
+        cached_interp_update_breakpoints(&g_dev.r4300);
+    return result;
+}
+#endif
+
 EXPORT int CALL DebugBreakpointCommand(m64p_dbg_bkp_command command, unsigned int index, m64p_breakpoint *bkp)
 {
 #ifdef DBG
@@ -385,24 +409,24 @@ EXPORT int CALL DebugBreakpointCommand(m64p_dbg_bkp_command command, unsigned in
     switch (command)
     {
         case M64P_BKP_CMD_ADD_ADDR:
-            return add_breakpoint(mem, index);
+            return update_breakpoints(add_breakpoint(mem, index));
         case M64P_BKP_CMD_ADD_STRUCT:
-            return add_breakpoint_struct(mem, bkp);
+            return update_breakpoints(add_breakpoint_struct(mem, bkp));
         case M64P_BKP_CMD_REPLACE:
             replace_breakpoint_num(mem, index, bkp);
-            return 0;
+            return update_breakpoints(0);
         case M64P_BKP_CMD_REMOVE_ADDR:
             remove_breakpoint_by_address(mem, index);
-            return 0;
+            return update_breakpoints(0);
         case M64P_BKP_CMD_REMOVE_IDX:
             remove_breakpoint_by_num(mem, index);
-            return 0;
+            return update_breakpoints(0);
         case M64P_BKP_CMD_ENABLE:
             enable_breakpoint(mem, index);
-            return 0;
+            return update_breakpoints(0);
         case M64P_BKP_CMD_DISABLE:
             disable_breakpoint(mem, index);
-            return 0;
+            return update_breakpoints(0);
         case M64P_BKP_CMD_CHECK:
             return check_breakpoints(index);
         default:
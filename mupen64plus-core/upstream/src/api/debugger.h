@@ -41,6 +41,7 @@ typedef enum {
 extern void DebuggerCallback(eDbgCallbackType type, unsigned int param);
 extern void CoreCompareCallback(void);
 extern void CoreCompareDataSync(int length, void *ptr);
+extern void CoreLockstepCallback(unsigned int event_type);
 
 #endif /* API_DEBUGGER_H */
 
@@ -35,12 +35,19 @@
 #include "m64p_config.h"
 #include "m64p_frontend.h"
 #include "m64p_types.h"
+#ifdef PROFILE_BLOCKS
+#include "device/r4300/block_profiler.h"
+#endif
 #include "main/cheat.h"
 #include "main/eventloop.h"
+#include "main/input_log.h"
 #include "main/main.h"
 #include "main/md5.h"
+#include "main/profile.h"
+#include "main/rewind.h"
 #include "main/rom.h"
 #include "main/savestates.h"
+#include "main/thread_placement.h"
 #include "main/util.h"
 #include "main/version.h"
 #include "main/workqueue.h"
@@ -79,6 +86,7 @@ EXPORT m64p_error CALL CoreStartup(int APIVersion, const char *ConfigPath, const
     plugin_connect(M64PLUGIN_CORE, NULL);
 
     savestates_init();
+    event_queue_init();
 
     /* next, start up the configuration handling code by loading and parsing the config file */
     if (ConfigInit(ConfigPath, DataPath) != M64ERR_SUCCESS)
@@ -112,10 +120,12 @@ EXPORT m64p_error CALL CoreShutdown(void)
         return M64ERR_NOT_INIT;
 
     /* close down some core sub-systems */
+    wait_rom_settings();
     romdatabase_close();
     ConfigShutdown();
     workqueue_shutdown();
     savestates_deinit();
+    event_queue_deinit();
 
     /* tell SDL to shut down */
     SDL_Quit();
@@ -187,6 +197,7 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
             if (g_EmulatorRunning || !l_ROMOpen)
                 return M64ERR_INVALID_STATE;
             l_ROMOpen = 0;
+            input_log_stop();
             cheat_delete_all(&g_cheat_ctx);
             cheat_uninit(&g_cheat_ctx);
             return close_rom();
@@ -213,6 +224,7 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
                 return M64ERR_INPUT_ASSERT;
             if ((int)sizeof(m64p_rom_settings) < ParamInt)
                 ParamInt = sizeof(m64p_rom_settings);
+            wait_rom_settings();
             memcpy(ParamPtr, &ROM_SETTINGS, ParamInt);
             return M64ERR_SUCCESS;
         case M64CMD_EXECUTE:
@@ -263,14 +275,16 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
                 return M64ERR_INVALID_STATE;
             keysym = ParamInt & 0xffff;
             keymod = (ParamInt >> 16) & 0xffff;
-            event_sdl_keydown(keysym, keymod);
+            if (!event_queue_push_key(1, keysym, keymod))
+                return M64ERR_NO_MEMORY;
             return M64ERR_SUCCESS;
         case M64CMD_SEND_SDL_KEYUP:
             if (!g_EmulatorRunning)
                 return M64ERR_INVALID_STATE;
             keysym = ParamInt & 0xffff;
             keymod = (ParamInt >> 16) & 0xffff;
-            event_sdl_keyup(keysym, keymod);
+            if (!event_queue_push_key(0, keysym, keymod))
+                return M64ERR_NO_MEMORY;
             return M64ERR_SUCCESS;
         case M64CMD_SET_FRAME_CALLBACK:
             *(void**)&g_FrameCallback = ParamPtr;
@@ -304,6 +318,47 @@ EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void *P
                 return M64ERR_INPUT_INVALID;
             g_media_loader = *(m64p_media_loader*)ParamPtr;
             return M64ERR_SUCCESS;
+        case M64CMD_REWIND:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (!rewind_request())
+                return M64ERR_INVALID_STATE;
+            return M64ERR_SUCCESS;
+        case M64CMD_PROFILE_BLOCKS_DUMP:
+#ifdef PROFILE_BLOCKS
+            if (block_profiler_dump(ParamInt, (const char *) ParamPtr) != 0)
+                return M64ERR_NO_MEMORY;
+            return M64ERR_SUCCESS;
+#else
+            return M64ERR_UNSUPPORTED;
+#endif
+        case M64CMD_PROFILE_TIMINGS:
+            if (ParamPtr != NULL && ParamInt != sizeof(m64p_profile_timings))
+                return M64ERR_INPUT_INVALID;
+            timed_sections_set_output((m64p_profile_timings *) ParamPtr);
+            return M64ERR_SUCCESS;
+        case M64CMD_PROFILE_FRAMES:
+            if (ParamPtr == NULL || ParamInt != sizeof(m64p_profile_frames))
+                return M64ERR_INPUT_INVALID;
+            if (((m64p_profile_frames *) ParamPtr)->frames == NULL)
+                return M64ERR_INPUT_ASSERT;
+            timed_sections_get_frames((m64p_profile_frames *) ParamPtr);
+            return M64ERR_SUCCESS;
+        case M64CMD_PROFILE_TRACE_DUMP:
+            if (ParamPtr == NULL)
+                return M64ERR_INPUT_ASSERT;
+            if (!timed_sections_dump_trace((const char *) ParamPtr))
+                return M64ERR_FILES;
+            return M64ERR_SUCCESS;
+        case M64CMD_TRIM_MEMORY:
+            if (ParamInt < M64TRIM_MODERATE || ParamInt > M64TRIM_CRITICAL)
+                return M64ERR_INPUT_INVALID;
+            main_trim_memory(ParamInt);
+            return M64ERR_SUCCESS;
+        case M64CMD_INPUT_LOG:
+            if (g_EmulatorRunning || !l_ROMOpen)
+                return M64ERR_INVALID_STATE;
+            return input_log_start((m64p_input_log_mode) ParamInt, (const char *) ParamPtr);
         default:
             return M64ERR_INPUT_INVALID;
     }
@@ -379,4 +434,31 @@ EXPORT m64p_error CALL CoreGetRomSettings(m64p_rom_settings *RomSettings, int Ro
     return M64ERR_SUCCESS;
 }
 
+EXPORT m64p_error CALL CoreGetRdramGenerations(const unsigned int **Generations, int *PageShift, int *PagesCount)
+{
+    if (!l_CoreInit)
+        return M64ERR_NOT_INIT;
+    if (Generations == NULL || PageShift == NULL || PagesCount == NULL)
+        return M64ERR_INPUT_ASSERT;
+    if (!l_ROMOpen)
+        return M64ERR_INVALID_STATE;
+    /* recompiled code stores to RDRAM without going through the core */
+    if (g_dev.r4300.emumode == EMUMODE_DYNAREC)
+        return M64ERR_UNSUPPORTED;
+
+    *Generations = g_dev.rdram.generations;
+    *PageShift = RDRAM_GENERATION_SHIFT;
+    *PagesCount = (int)(g_dev.rdram.dram_size >> RDRAM_GENERATION_SHIFT);
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL CoreSetThreadRole(m64p_thread_role Role)
+{
+    if (!l_CoreInit)
+        return M64ERR_NOT_INIT;
+
+    return thread_placement_apply(Role);
+}
+
 
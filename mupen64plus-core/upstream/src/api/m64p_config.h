@@ -198,6 +198,37 @@ EXPORT int          CALL ConfigGetParamBool(m64p_handle, const char *);
 EXPORT const char * CALL ConfigGetParamString(m64p_handle, const char *);
 #endif
 
+/* ConfigGetParamHandle()
+ *
+ * This function looks up one of the emulator's parameters in the given section
+ * and returns a handle to it, which stays valid until the section is deleted
+ * or reverted, or the core configuration is shut down. The parameter must
+ * already exist.
+ */
+typedef m64p_error (*ptr_ConfigGetParamHandle)(m64p_handle, const char *, m64p_handle *);
+#if defined(M64P_CORE_PROTOTYPES)
+EXPORT m64p_error CALL ConfigGetParamHandle(m64p_handle, const char *, m64p_handle *);
+#endif
+
+/* ConfigReadParam***()
+ *
+ * These functions retrieve the value of a parameter through a handle given by
+ * ConfigGetParamHandle(), without looking up its name again. They are meant
+ * for values which are read repeatedly, such as once per frame. If the handle
+ * is invalid, an error is sent to the front-end via the DebugCallback()
+ * function, and either a 0 (zero) or an empty string will be returned.
+ */
+typedef int          (*ptr_ConfigReadParamInt)(m64p_handle);
+typedef float        (*ptr_ConfigReadParamFloat)(m64p_handle);
+typedef int          (*ptr_ConfigReadParamBool)(m64p_handle);
+typedef const char * (*ptr_ConfigReadParamString)(m64p_handle);
+#if defined(M64P_CORE_PROTOTYPES)
+EXPORT int          CALL ConfigReadParamInt(m64p_handle);
+EXPORT float        CALL ConfigReadParamFloat(m64p_handle);
+EXPORT int          CALL ConfigReadParamBool(m64p_handle);
+EXPORT const char * CALL ConfigReadParamString(m64p_handle);
+#endif
+
 /* ConfigGetSharedDataFilepath()
  *
  * This function is provided to allow a plugin to retrieve a full pathname to a
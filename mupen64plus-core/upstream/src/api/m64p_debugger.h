@@ -54,6 +54,17 @@ typedef m64p_error (*ptr_DebugSetCoreCompare)(void (*)(unsigned int), void (*)(i
 EXPORT m64p_error CALL DebugSetCoreCompare(void (*)(unsigned int), void (*)(int, void *));
 #endif
 
+/* DebugSetCoreLockstep()
+ *
+ * This function is called by the front-end to supply a callback function
+ * pointer which is called at every R4300 interrupt event, for running two
+ * emulator cores in lockstep.
+ */
+typedef m64p_error (*ptr_DebugSetCoreLockstep)(void (*)(unsigned int, unsigned int));
+#if defined(M64P_CORE_PROTOTYPES)
+EXPORT m64p_error CALL DebugSetCoreLockstep(void (*)(unsigned int, unsigned int));
+#endif
+
 /* DebugSetRunState()
  *
  * This function sets the run state of the R4300 CPU emulator.
@@ -133,6 +133,28 @@ typedef m64p_error (*ptr_CoreGetRomSettings)(m64p_rom_settings *, int, int, int)
 EXPORT m64p_error CALL CoreGetRomSettings(m64p_rom_settings *, int, int, int);
 #endif
 
+/* CoreGetRdramGenerations()
+ *
+ * This function gives access to the per-page RDRAM write counters of the core.
+ * A counter is incremented each time the core writes to its page, so a video
+ * plugin can skip re-hashing texture or framebuffer memory it has already seen.
+ */
+typedef m64p_error (*ptr_CoreGetRdramGenerations)(const unsigned int **, int *, int *);
+#if defined(M64P_CORE_PROTOTYPES)
+EXPORT m64p_error CALL CoreGetRdramGenerations(const unsigned int **, int *, int *);
+#endif
+
+/* CoreSetThreadRole()
+ *
+ * This function moves the calling thread to the CPU cores the core's thread
+ * placement policy gives to the given kind of thread. Plugins call it at the
+ * start of the threads they create.
+ */
+typedef m64p_error (*ptr_CoreSetThreadRole)(m64p_thread_role);
+#if defined(M64P_CORE_PROTOTYPES)
+EXPORT m64p_error CALL CoreSetThreadRole(m64p_thread_role);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
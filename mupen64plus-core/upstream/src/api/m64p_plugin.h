@@ -180,6 +180,13 @@ EXPORT int  CALL RomOpen(void);
 EXPORT void CALL RomClosed(void);
 #endif
 
+/* common plugin spec extension, optional: releases caches when the system is low on
+   memory. Level is a m64p_trim_level, returns the number of bytes released. */
+typedef unsigned int (*ptr_TrimMemory)(int Level);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT unsigned int CALL TrimMemory(int Level);
+#endif
+
 /* video plugin function pointer types */
 typedef void (*ptr_ChangeWindow)(void);
 typedef int  (*ptr_InitiateGFX)(GFX_INFO Gfx_Info);
@@ -208,6 +215,12 @@ EXPORT void CALL SetRenderingCallback(void (*callback)(int));
 EXPORT void CALL ResizeVideoOutput(int width, int height);
 #endif
 
+/* video plugin spec extension, optional: display lists to skip after each rendered one */
+typedef void (*ptr_SetRenderSkip)(int Count);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT void CALL SetRenderSkip(int Count);
+#endif
+
 /* frame buffer plugin spec extension */
 typedef struct
 {
@@ -237,6 +250,10 @@ typedef int  (*ptr_VolumeGetLevel)(void);
 typedef void (*ptr_VolumeSetLevel)(int level);
 typedef void (*ptr_VolumeMute)(void);
 typedef const char * (*ptr_VolumeGetString)(void);
+
+/* audio plugin spec extension, optional: receives samples the core has already
+   read from RDRAM, so several AI DMAs can be handed over in one call */
+typedef void (*ptr_AiPushSamples)(const void *Samples, unsigned int Size);
 #if defined(M64P_PLUGIN_PROTOTYPES)
 EXPORT void CALL AiDacrateChanged(int SystemType);
 EXPORT void CALL AiLenChanged(void);
@@ -249,6 +266,7 @@ EXPORT int  CALL VolumeGetLevel(void);
 EXPORT void CALL VolumeSetLevel(int level);
 EXPORT void CALL VolumeMute(void);
 EXPORT const char * CALL VolumeGetString(void);
+EXPORT void CALL AiPushSamples(const void *Samples, unsigned int Size);
 #endif
 
 /* input plugin function pointers */
@@ -132,7 +132,8 @@ typedef enum {
   M64CORE_AUDIO_MUTE,
   M64CORE_INPUT_GAMESHARK,
   M64CORE_STATE_LOADCOMPLETE,
-  M64CORE_STATE_SAVECOMPLETE
+  M64CORE_STATE_SAVECOMPLETE,
+  M64CORE_RENDER_SKIP
 } m64p_core_param;
 
 typedef enum {
@@ -157,9 +158,81 @@ typedef enum {
   M64CMD_READ_SCREEN,
   M64CMD_RESET,
   M64CMD_ADVANCE_FRAME,
-  M64CMD_SET_MEDIA_LOADER
+  M64CMD_SET_MEDIA_LOADER,
+  M64CMD_PROFILE_BLOCKS_DUMP,
+  M64CMD_REWIND,
+  M64CMD_PROFILE_TIMINGS,
+  M64CMD_INPUT_LOG,
+  M64CMD_PROFILE_FRAMES,
+  M64CMD_PROFILE_TRACE_DUMP,
+  M64CMD_TRIM_MEMORY
 } m64p_command;
 
+/* How much M64CMD_TRIM_MEMORY and the plugins' TrimMemory() release */
+typedef enum {
+  M64TRIM_MODERATE = 1,         /* caches which are cheap to rebuild */
+  M64TRIM_CRITICAL              /* everything which can be rebuilt or done without */
+} m64p_trim_level;
+
+typedef enum {
+  M64INPUT_LOG_STOP = 0,
+  M64INPUT_LOG_RECORD,
+  M64INPUT_LOG_REPLAY
+} m64p_input_log_mode;
+
+/* Filled in by the core at each VI after M64CMD_PROFILE_TIMINGS.
+ * Times are in nanoseconds, each subsystem excluding the ones it calls into. */
+typedef struct {
+  unsigned int vi_limit;          /* set by the front-end: stop the emulator after this many VIs, 0 = never */
+  unsigned int vi_count;          /* VIs timed so far */
+  unsigned long long *vi_ns;      /* set by the front-end: optional array of vi_limit entries, receives each VI's wall time */
+  unsigned long long total_ns;
+  unsigned long long cpu_ns;      /* r4300 emulation and everything not listed below */
+  unsigned long long compiler_ns; /* dynamic recompiler */
+  unsigned long long rsp_ns;      /* RSP plugin */
+  unsigned long long gfx_ns;      /* video plugin display lists, RDP lists and screen updates */
+  unsigned long long audio_ns;    /* audio plugin */
+  unsigned long long idle_ns;     /* speed limiter */
+  unsigned long long interrupt_ns;/* r4300 interrupt handling */
+} m64p_profile_timings;
+
+/* Parts of the emulator timed per frame while M64CMD_PROFILE_TIMINGS is active */
+typedef enum {
+  M64PROFILE_CPU = 0,
+  M64PROFILE_COMPILER,
+  M64PROFILE_INTERRUPT,
+  M64PROFILE_RSP,               /* DoRspCycles */
+  M64PROFILE_GFX_DLIST,         /* ProcessDList */
+  M64PROFILE_GFX_RDP_LIST,      /* ProcessRDPList */
+  M64PROFILE_GFX_SCREEN,        /* UpdateScreen */
+  M64PROFILE_AUDIO_ALIST,       /* ProcessAList */
+  M64PROFILE_AUDIO_SAMPLES,     /* AiLenChanged, AiPushSamples */
+  M64PROFILE_IDLE,              /* speed limiter sleep */
+  M64PROFILE_SECTION_COUNT
+} m64p_profile_section;
+
+typedef struct {
+  unsigned int vi;              /* VI ending the frame, counted from the first timed one */
+  unsigned long long start_ns;  /* from the start of timing */
+  unsigned long long total_ns;
+  unsigned long long section_ns[M64PROFILE_SECTION_COUNT];
+} m64p_profile_frame;
+
+typedef struct {
+  unsigned int capacity;        /* set by the front-end: number of entries in frames */
+  unsigned int count;           /* number of frames copied, oldest first */
+  m64p_profile_frame *frames;   /* set by the front-end */
+} m64p_profile_frames;
+
+/* Kinds of threads for CoreSetThreadRole() */
+typedef enum {
+  M64THREAD_EMULATION = 1,      /* the thread running the emulation */
+  M64THREAD_RENDER,             /* a thread doing a plugin's main rendering */
+  M64THREAD_WORKER,             /* helper threads splitting up per frame work */
+  M64THREAD_AUDIO,              /* audio output feeding threads */
+  M64THREAD_BACKGROUND          /* file I/O and compression, no deadline */
+} m64p_thread_role;
+
 typedef struct {
   uint32_t address;
   int      value;
@@ -38,6 +38,11 @@ struct storage_backend_interface
     /* Notify the storage backend that data should be persisted
      */
     void (*save)(void* storage);
+
+    /* Notify the storage backend that only size bytes at offset changed
+     * and should be persisted. NULL if the storage can only be saved as a whole.
+     */
+    void (*save_range)(void* storage, size_t offset, size_t size);
 };
 
 #endif
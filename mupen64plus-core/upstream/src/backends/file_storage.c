@@ -21,19 +21,292 @@
 
 #include "file_storage.h"
 
+#include <SDL.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
 #include "backends/api/storage_backend.h"
 #include "device/dd/dd_controller.h"
 #include "main/util.h"
+#include "osal/files.h"
+
+/* how long a storage can stay dirty before being written */
+enum { FILE_STORAGE_FLUSH_DELAY_MS = 1000 };
+
+/* storages which can be written back. Only used from the emulation thread */
+static LIST_HEAD(l_storages);
+/* protects file_storage.writing, shared with the workqueue */
+static SDL_mutex* l_writing_lock;
+
+static void init_write_behind(struct file_storage* fstorage)
+{
+    if (l_writing_lock == NULL) {
+        l_writing_lock = SDL_CreateMutex();
+    }
+
+    fstorage->shadow = NULL;
+    fstorage->dirty = 0;
+    fstorage->dirty_ticks = 0;
+    fstorage->writing = 0;
+    fstorage->mapped = 0;
+    fstorage->journal = NULL;
+    fstorage->shadow_blocks = NULL;
+    fstorage->shadow_count = 0;
+    list_add_tail(&fstorage->list, &l_storages);
+}
+
+static int is_writing(const struct file_storage* fstorage)
+{
+    int writing;
+
+    SDL_LockMutex(l_writing_lock);
+    writing = fstorage->writing;
+    SDL_UnlockMutex(l_writing_lock);
+
+    return writing;
+}
+
+static void set_writing(struct file_storage* fstorage, int writing)
+{
+    SDL_LockMutex(l_writing_lock);
+    fstorage->writing = writing;
+    SDL_UnlockMutex(l_writing_lock);
+}
+
+static void report_write_error(file_status_t err, const char* filename)
+{
+    switch(err)
+    {
+    case file_open_error:
+        DebugMessage(M64MSG_WARNING, "couldn't open storage file '%s' for writing", filename);
+        break;
+    case file_read_error:
+    case file_write_error:
+        DebugMessage(M64MSG_WARNING, "failed to write storage file '%s'", filename);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Write to a temporary file first, then rename it over the old one,
+ * so that a crash in the middle never leaves a truncated save file. */
+static file_status_t write_to_file_safe(const char* filename, const void* data, size_t size)
+{
+    file_status_t err;
+    char* tmp_filename = formatstr("%s.tmp", filename);
+    if (tmp_filename == NULL) {
+        return write_to_file(filename, data, size);
+    }
+
+    err = write_to_file(tmp_filename, data, size);
+    if (err == file_ok) {
+#ifdef _WIN32
+        /* rename doesn't replace existing files on windows */
+        remove(filename);
+#endif
+        if (rename(tmp_filename, filename) != 0) {
+            err = file_write_error;
+        }
+    }
+    if (err != file_ok) {
+        remove(tmp_filename);
+    }
+
+    free(tmp_filename);
+    return err;
+}
+
+static void file_storage_write_work(struct work_struct* work)
+{
+    struct file_storage* fstorage = container_of(work, struct file_storage, work);
+
+    report_write_error(write_to_file_safe(fstorage->filename, fstorage->shadow, fstorage->size),
+                       fstorage->filename);
+
+    /* the shadow buffer is no longer used */
+    set_writing(fstorage, 0);
+}
+
+static size_t journal_blocks(const struct file_storage* fstorage)
+{
+    return (fstorage->size + FILE_STORAGE_JOURNAL_BLOCK - 1) / FILE_STORAGE_JOURNAL_BLOCK;
+}
+
+static size_t journal_block_size(const struct file_storage* fstorage, size_t block)
+{
+    size_t offset = block * FILE_STORAGE_JOURNAL_BLOCK;
+    return (fstorage->size - offset < FILE_STORAGE_JOURNAL_BLOCK)
+        ? fstorage->size - offset
+        : FILE_STORAGE_JOURNAL_BLOCK;
+}
+
+/* Write some blocks of a journaled storage in place, taking them either
+ * one after the other from blocks_data, or from the storage data if
+ * blocks_data is NULL. */
+static file_status_t write_journal_blocks(const struct file_storage* fstorage,
+                                          const uint8_t* blocks_data, const uint32_t* blocks, size_t count)
+{
+    file_status_t err = file_ok;
+    size_t i;
+    FILE* f = fopen(fstorage->filename, "r+b");
+    if (f == NULL) {
+        return file_open_error;
+    }
+
+    for (i = 0; i < count && err == file_ok; ++i) {
+        size_t offset = (size_t)blocks[i] * FILE_STORAGE_JOURNAL_BLOCK;
+        size_t size = journal_block_size(fstorage, blocks[i]);
+        const uint8_t* src = (blocks_data != NULL)
+            ? blocks_data + i * FILE_STORAGE_JOURNAL_BLOCK
+            : fstorage->data + offset;
+
+        if (fseek(f, (long)offset, SEEK_SET) != 0 || fwrite(src, 1, size, f) != size) {
+            err = file_write_error;
+        }
+    }
+
+    if (fclose(f) != 0 && err == file_ok) {
+        err = file_write_error;
+    }
+
+    return err;
+}
+
+/* Write all journaled blocks straight from the storage data */
+static void write_journal_sync(struct file_storage* fstorage)
+{
+    size_t block, count = journal_blocks(fstorage);
+    file_status_t err = file_ok;
+
+    for (block = 0; block < count && err == file_ok; ++block) {
+        if (fstorage->journal[block / 8] & (1 << (block % 8))) {
+            uint32_t index = (uint32_t)block;
+            err = write_journal_blocks(fstorage, NULL, &index, 1);
+        }
+    }
+
+    memset(fstorage->journal, 0, (count + 7) / 8);
+    report_write_error(err, fstorage->filename);
+}
+
+static void journal_write_work(struct work_struct* work)
+{
+    struct file_storage* fstorage = container_of(work, struct file_storage, work);
+
+    report_write_error(write_journal_blocks(fstorage, fstorage->shadow, fstorage->shadow_blocks, fstorage->shadow_count),
+                       fstorage->filename);
+
+    /* these blocks are written, release them */
+    free(fstorage->shadow);
+    free(fstorage->shadow_blocks);
+    fstorage->shadow = NULL;
+    fstorage->shadow_blocks = NULL;
+    fstorage->shadow_count = 0;
+    set_writing(fstorage, 0);
+}
+
+static void flush_journal(struct file_storage* fstorage)
+{
+    size_t block, blocks = journal_blocks(fstorage);
+    size_t i, count = 0;
+
+    for (block = 0; block < blocks; ++block) {
+        if (fstorage->journal[block / 8] & (1 << (block % 8))) {
+            ++count;
+        }
+    }
+
+    fstorage->shadow = malloc(count * FILE_STORAGE_JOURNAL_BLOCK);
+    fstorage->shadow_blocks = malloc(count * sizeof(uint32_t));
+    if (fstorage->shadow == NULL || fstorage->shadow_blocks == NULL) {
+        free(fstorage->shadow);
+        free(fstorage->shadow_blocks);
+        fstorage->shadow = NULL;
+        fstorage->shadow_blocks = NULL;
+        /* write synchronously then */
+        fstorage->dirty = 0;
+        write_journal_sync(fstorage);
+        return;
+    }
+
+    /* snapshot changed blocks, so the emulation can keep modifying them */
+    for (block = 0, i = 0; block < blocks; ++block) {
+        if (fstorage->journal[block / 8] & (1 << (block % 8))) {
+            memcpy(fstorage->shadow + i * FILE_STORAGE_JOURNAL_BLOCK,
+                   fstorage->data + block * FILE_STORAGE_JOURNAL_BLOCK,
+                   journal_block_size(fstorage, block));
+            fstorage->shadow_blocks[i++] = (uint32_t)block;
+        }
+    }
+    fstorage->shadow_count = count;
+    memset(fstorage->journal, 0, (blocks + 7) / 8);
+    fstorage->dirty = 0;
+    set_writing(fstorage, 1);
+
+    init_work_prio(&fstorage->work, journal_write_work, NULL, WORK_PRIORITY_IO);
+    queue_work(&fstorage->work);
+}
+
+static void wait_file_storage(const struct file_storage* fstorage)
+{
+    while (is_writing(fstorage)) {
+        SDL_Delay(1);
+    }
+}
+
+static void flush_file_storage(struct file_storage* fstorage)
+{
+    if (!fstorage->dirty || is_writing(fstorage)) {
+        return;
+    }
+
+    if (fstorage->journal != NULL) {
+        flush_journal(fstorage);
+        return;
+    }
+
+    if (fstorage->shadow == NULL) {
+        fstorage->shadow = malloc(fstorage->size);
+        if (fstorage->shadow == NULL) {
+            /* write synchronously then */
+            fstorage->dirty = 0;
+            report_write_error(write_to_file_safe(fstorage->filename, fstorage->data, fstorage->size),
+                               fstorage->filename);
+            return;
+        }
+    }
+
+    /* snapshot data, so the emulation can keep modifying it */
+    memcpy(fstorage->shadow, fstorage->data, fstorage->size);
+    fstorage->dirty = 0;
+    set_writing(fstorage, 1);
+
+    init_work_prio(&fstorage->work, file_storage_write_work, NULL, WORK_PRIORITY_IO);
+    queue_work(&fstorage->work);
+}
+
+void flush_file_storages(int force)
+{
+    struct file_storage* fstorage;
+    unsigned int now = SDL_GetTicks();
+
+    list_for_each_entry_t(fstorage, &l_storages, struct file_storage, list) {
+        if (fstorage->dirty && (force || now - fstorage->dirty_ticks >= FILE_STORAGE_FLUSH_DELAY_MS)) {
+            flush_file_storage(fstorage);
+        }
+    }
+}
 
 int open_file_storage(struct file_storage* fstorage, size_t size, const char* filename)
 {
     /* ! Take ownership of filename ! */
     fstorage->filename = filename;
     fstorage->size = size;
+    init_write_behind(fstorage);
 
     /* allocate memory for holding data */
     fstorage->data = malloc(fstorage->size);
@@ -47,11 +320,21 @@ int open_file_storage(struct file_storage* fstorage, size_t size, const char* fi
 
 int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
 {
+    file_status_t err = file_ok;
+
     fstorage->data = NULL;
     fstorage->size = 0;
     fstorage->filename = NULL;
+    init_write_behind(fstorage);
 
-    file_status_t err = load_file(filename, (void**)&fstorage->data, &fstorage->size);
+    /* pages of a mapping are only read as they get accessed */
+    fstorage->data = osal_map_file(filename, &fstorage->size);
+    if (fstorage->data != NULL) {
+        fstorage->mapped = 1;
+    }
+    else {
+        err = load_file(filename, (void**)&fstorage->data, &fstorage->size);
+    }
 
     if (err == file_ok) {
         /* ! take ownsership of filename ! */
@@ -61,10 +344,70 @@ int open_rom_file_storage(struct file_storage* fstorage, const char* filename)
     return err;
 }
 
+int open_journal_file_storage(struct file_storage* fstorage, const char* filename)
+{
+    file_status_t err = open_rom_file_storage(fstorage, filename);
+
+    if (err == file_ok) {
+        fstorage->journal = calloc((journal_blocks(fstorage) + 7) / 8, 1);
+        if (fstorage->journal == NULL) {
+            err = file_read_error;
+        }
+    }
+
+    return err;
+}
+
+static void release_file_storage_data(struct file_storage* fstorage)
+{
+    if (fstorage->mapped) {
+        osal_unmap_file(fstorage->data, fstorage->size);
+    }
+    else {
+        free((void*)fstorage->data);
+    }
+
+    fstorage->data = NULL;
+    fstorage->mapped = 0;
+}
+
+void replace_file_storage_data(struct file_storage* fstorage, uint8_t* data, size_t size)
+{
+    release_file_storage_data(fstorage);
+    fstorage->data = data;
+    fstorage->size = size;
+
+    /* the journal no longer matches the file */
+    free(fstorage->journal);
+    fstorage->journal = NULL;
+}
+
 void close_file_storage(struct file_storage* fstorage)
 {
-    free((void*)fstorage->data);
+    /* zeroed storages were never opened */
+    if (fstorage->list.next != NULL) {
+        wait_file_storage(fstorage);
+        if (fstorage->dirty) {
+            fstorage->dirty = 0;
+            if (fstorage->journal != NULL) {
+                write_journal_sync(fstorage);
+            }
+            else {
+                report_write_error(write_to_file_safe(fstorage->filename, fstorage->data, fstorage->size),
+                                   fstorage->filename);
+            }
+        }
+        list_del(&fstorage->list);
+        fstorage->list.next = fstorage->list.prev = NULL;
+    }
+
+    release_file_storage_data(fstorage);
+    free(fstorage->shadow);
+    free(fstorage->journal);
     free((void*)fstorage->filename);
+    fstorage->shadow = NULL;
+    fstorage->journal = NULL;
+    fstorage->filename = NULL;
 }
 
 
@@ -80,21 +423,44 @@ static size_t file_storage_size(const void* storage)
     return fstorage->size;
 }
 
+static void mark_file_storage_dirty(struct file_storage* fstorage)
+{
+    /* actual writing is done later by flush_file_storages */
+    if (!fstorage->dirty) {
+        fstorage->dirty = 1;
+        fstorage->dirty_ticks = SDL_GetTicks();
+    }
+}
+
 static void file_storage_save(void* storage)
 {
     struct file_storage* fstorage = (struct file_storage*)storage;
 
-    switch(write_to_file(fstorage->filename, fstorage->data, fstorage->size))
-    {
-    case file_open_error:
-        DebugMessage(M64MSG_WARNING, "couldn't open storage file '%s' for writing", fstorage->filename);
-        break;
-    case file_write_error:
-        DebugMessage(M64MSG_WARNING, "failed to write storage file '%s'", fstorage->filename);
-        break;
-    default:
-        break;
+    if (fstorage->journal != NULL) {
+        memset(fstorage->journal, 0xff, (journal_blocks(fstorage) + 7) / 8);
     }
+
+    mark_file_storage_dirty(fstorage);
+}
+
+static void file_storage_save_range(void* storage, size_t offset, size_t size)
+{
+    struct file_storage* fstorage = (struct file_storage*)storage;
+    size_t block;
+
+    if (fstorage->journal == NULL) {
+        file_storage_save(storage);
+        return;
+    }
+
+    if (size > 0) {
+        for (block = offset / FILE_STORAGE_JOURNAL_BLOCK;
+             block <= (offset + size - 1) / FILE_STORAGE_JOURNAL_BLOCK; ++block) {
+            fstorage->journal[block / 8] |= (uint8_t)(1 << (block % 8));
+        }
+    }
+
+    mark_file_storage_dirty(fstorage);
 }
 
 static void file_storage_parent_save(void* storage)
@@ -138,7 +504,8 @@ const struct storage_backend_interface g_ifile_storage =
 {
     file_storage_data,
     file_storage_size,
-    file_storage_save
+    file_storage_save,
+    file_storage_save_range
 };
 
 
@@ -146,6 +513,7 @@ const struct storage_backend_interface g_ifile_storage_ro =
 {
     file_storage_data,
     file_storage_size,
+    NULL,
     NULL
 };
 
@@ -153,12 +521,15 @@ const struct storage_backend_interface g_isubfile_storage =
 {
     file_storage_data,
     file_storage_size,
-    file_storage_parent_save
+    file_storage_parent_save,
+    NULL
 };
 
+/* converting the whole disk back takes too long to be done on each write */
 const struct storage_backend_interface g_ifile_storage_dd_sdk_dump =
 {
     file_storage_data,
     file_storage_size,
-    file_storage_dd_sdk_dump_save
+    file_storage_dd_sdk_dump_save,
+    NULL
 };
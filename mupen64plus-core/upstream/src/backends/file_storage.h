@@ -25,18 +25,54 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "main/list.h"
+#include "main/workqueue.h"
+
 struct file_storage
 {
     uint8_t* data;
     size_t size;
     const char* filename;
+
+    /* write-behind state:
+     * save only marks the storage dirty, data is then copied to shadow
+     * and written by the workqueue when flush_file_storages decides so */
+    uint8_t* shadow;
+    int dirty;
+    unsigned int dirty_ticks;
+    int writing;
+    struct work_struct work;
+    struct list_head list;
+
+    /* set if data is a mapping of the file rather than an allocation */
+    int mapped;
+
+    /* journaled storages are written back in place, one block at a time:
+     * journal has a bit per FILE_STORAGE_JOURNAL_BLOCK bytes changed since
+     * the last write, shadow then holds shadow_count such blocks, whose
+     * indices are in shadow_blocks */
+    uint8_t* journal;
+    uint32_t* shadow_blocks;
+    size_t shadow_count;
 };
 
+enum { FILE_STORAGE_JOURNAL_BLOCK = 0x1000 };
+
 
 int open_file_storage(struct file_storage* storage, size_t size, const char* filename);
+/* The file is mapped rather than loaded, when the platform allows it */
 int open_rom_file_storage(struct file_storage* storage, const char* filename);
+/* Same as open_rom_file_storage, and keep a journal so that saves only write
+ * the blocks which changed. */
+int open_journal_file_storage(struct file_storage* storage, const char* filename);
+/* Replace the data of a storage by a buffer allocated with malloc */
+void replace_file_storage_data(struct file_storage* storage, uint8_t* data, size_t size);
 void close_file_storage(struct file_storage* storage);
 
+/* Start writing dirty storages. If force is 0, only those which have been
+ * dirty for a while are written, so bursts of saves get coalesced. */
+void flush_file_storages(int force);
+
 extern const struct storage_backend_interface g_ifile_storage;
 extern const struct storage_backend_interface g_ifile_storage_ro;
 extern const struct storage_backend_interface g_isubfile_storage;
@@ -20,13 +20,17 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "backends/api/audio_out_backend.h"
+#include "backends/plugins_compat/plugins_compat.h"
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "device/rdram/rdram.h"
+#include "main/profile.h"
 #include "main/rom.h"
+#include "main/runahead.h"
 #include "plugin/plugin.h"
 
 static void audio_plugin_set_format(void* aout, unsigned int frequency, unsigned int bits)
@@ -51,11 +55,17 @@ static void audio_plugin_push_samples(void* aout, const void* buffer, size_t siz
     uint32_t saved_ai_length = ai->regs[AI_LEN_REG];
     uint32_t saved_ai_dram = ai->regs[AI_DRAM_ADDR_REG];
 
+    /* these samples will be played again by the real timeline */
+    if (runahead_is_ahead())
+        return;
+
     /* exploit the fact that buffer points in g_dev.rdram.dram to retreive dram_addr_reg value */
     ai->regs[AI_DRAM_ADDR_REG] = (uint32_t)((uint8_t*)buffer - (uint8_t*)ai->ri->rdram->dram);
     ai->regs[AI_LEN_REG] = (uint32_t)size;
 
+    timed_section_start(TIMED_SECTION_AUDIO_SAMPLES);
     audio.aiLenChanged();
+    timed_section_end(TIMED_SECTION_AUDIO_SAMPLES);
 
     ai->regs[AI_LEN_REG] = saved_ai_length;
     ai->regs[AI_DRAM_ADDR_REG] = saved_ai_dram;
@@ -66,3 +76,79 @@ const struct audio_out_backend_interface g_iaudio_out_backend_plugin_compat =
     audio_plugin_set_format,
     audio_plugin_push_samples
 };
+
+
+void init_audio_out_batch(struct audio_out_batch* batch, struct ai_controller* ai)
+{
+    batch->ai = ai;
+    batch->size = 0;
+    batch->flush_size = AUDIO_OUT_BATCH_SIZE / 4;
+}
+
+void audio_out_batch_flush(struct audio_out_batch* batch)
+{
+    if (batch->size == 0)
+        return;
+
+    timed_section_start(TIMED_SECTION_AUDIO_SAMPLES);
+    audio.aiPushSamples(batch->buffer, (unsigned int)batch->size);
+    timed_section_end(TIMED_SECTION_AUDIO_SAMPLES);
+    batch->size = 0;
+}
+
+static void audio_plugin_batch_set_format(void* aout, unsigned int frequency, unsigned int bits)
+{
+    struct audio_out_batch* batch = (struct audio_out_batch*)aout;
+    size_t flush_size;
+
+    /* pending samples still belong to the previous format */
+    audio_out_batch_flush(batch);
+
+    audio_plugin_set_format(batch->ai, frequency, bits);
+
+    /* one video frame worth of 16bit stereo samples, rounded to whole frames */
+    flush_size = (batch->ai->vi->expected_refresh_rate == 0)
+        ? AUDIO_OUT_BATCH_SIZE / 4
+        : (size_t)(frequency / batch->ai->vi->expected_refresh_rate) * 4;
+
+    if (flush_size > AUDIO_OUT_BATCH_SIZE)
+        flush_size = AUDIO_OUT_BATCH_SIZE;
+    else if (flush_size < 4)
+        flush_size = 4;
+
+    batch->flush_size = flush_size;
+}
+
+static void audio_plugin_batch_push_samples(void* aout, const void* buffer, size_t size)
+{
+    struct audio_out_batch* batch = (struct audio_out_batch*)aout;
+
+    if (runahead_is_ahead())
+        return;
+
+    /* samples have to be copied out right away, RDRAM may be reused once the DMA is over */
+    if (batch->size + size > AUDIO_OUT_BATCH_SIZE)
+    {
+        audio_out_batch_flush(batch);
+
+        if (size > AUDIO_OUT_BATCH_SIZE)
+        {
+            timed_section_start(TIMED_SECTION_AUDIO_SAMPLES);
+            audio.aiPushSamples(buffer, (unsigned int)size);
+            timed_section_end(TIMED_SECTION_AUDIO_SAMPLES);
+            return;
+        }
+    }
+
+    memcpy(batch->buffer + batch->size, buffer, size);
+    batch->size += size;
+
+    if (batch->size >= batch->flush_size)
+        audio_out_batch_flush(batch);
+}
+
+const struct audio_out_backend_interface g_iaudio_out_backend_plugin_batch =
+{
+    audio_plugin_batch_set_format,
+    audio_plugin_batch_push_samples
+};
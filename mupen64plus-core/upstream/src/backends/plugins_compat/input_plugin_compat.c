@@ -26,6 +26,7 @@
 #include "backends/api/rumble_backend.h"
 #include "plugin/plugin.h"
 
+#include "main/input_log.h"
 #include "main/main.h"
 
 #include <stdint.h>
@@ -56,6 +57,7 @@ static m64p_error input_plugin_get_input(void* opaque, uint32_t* input_)
 {
     struct controller_input_compat* cin_compat = (struct controller_input_compat*)opaque;
     BUTTONS keys = { 0 };
+    int present;
 
     int pak_change_requested = 0;
 
@@ -64,8 +66,11 @@ static m64p_error input_plugin_get_input(void* opaque, uint32_t* input_)
         input.getKeys(cin_compat->control_id, &keys);
     }
 
+    /* let a recorded/replayed input log see or replace the buttons */
+    present = input_log_filter(cin_compat->control_id, Controls[cin_compat->control_id].Present, &keys);
+
     /* return an error if controller is not plugged */
-    if (!Controls[cin_compat->control_id].Present) {
+    if (!present) {
         return M64ERR_SYSTEM_FAIL;
     }
 
@@ -29,11 +29,36 @@
 
 #include <stdint.h>
 
+struct ai_controller;
+
 /* Audio Out backend interface */
 
 extern const struct audio_out_backend_interface
     g_iaudio_out_backend_plugin_compat;
 
+/* Batches the samples of several AI DMAs and hands them to the plugin
+ * through its AiPushSamples extension, avoiding one plugin call per DMA
+ * (or per partial read of AI_LEN). Only usable if audio.aiPushSamples is set.
+ */
+#define AUDIO_OUT_BATCH_SIZE 16384
+
+struct audio_out_batch
+{
+    struct ai_controller* ai;
+
+    unsigned char buffer[AUDIO_OUT_BATCH_SIZE];
+    size_t size;
+
+    /* flush once this many bytes are pending, about one video frame */
+    size_t flush_size;
+};
+
+void init_audio_out_batch(struct audio_out_batch* batch, struct ai_controller* ai);
+void audio_out_batch_flush(struct audio_out_batch* batch);
+
+extern const struct audio_out_backend_interface
+    g_iaudio_out_backend_plugin_batch;
+
 /* Controller Input backend interface */
 
 struct controller_input_compat
@@ -93,9 +93,7 @@ unsigned int cart_rom_dma_write(void* opaque, uint8_t* dram, uint32_t dram_addr,
 
     if (cart_addr + length < cart_rom->rom_size)
     {
-        for(i = 0; i < length; ++i) {
-            dram[(dram_addr+i)^S8] = mem[(cart_addr+i)^S8];
-        }
+        copy_mem_bytes(dram, dram_addr, mem, cart_addr, length);
     }
     else
     {
@@ -103,10 +101,8 @@ unsigned int cart_rom_dma_write(void* opaque, uint8_t* dram, uint32_t dram_addr,
             ? 0
             : cart_rom->rom_size - cart_addr;
 
-        for (i = 0; i < diff; ++i) {
-            dram[(dram_addr+i)^S8] = mem[(cart_addr+i)^S8];
-        }
-        for (; i < length; ++i) {
+        copy_mem_bytes(dram, dram_addr, mem, cart_addr, diff);
+        for (i = diff; i < length; ++i) {
             dram[(dram_addr+i)^S8] = 0;
         }
     }
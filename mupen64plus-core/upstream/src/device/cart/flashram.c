@@ -71,9 +71,7 @@ static void flashram_command(struct flashram* flashram, uint32_t command)
         break;
         case FLASHRAM_MODE_WRITE:
         {
-            for (i = 0; i < 128; ++i) {
-                mem[(flashram->erase_offset+i)^S8] = dram[(flashram->write_pointer+i)^S8];
-            }
+            copy_mem_bytes(mem, flashram->erase_offset, dram, flashram->write_pointer, 128);
             flashram->istorage->save(flashram->storage);
         }
         break;
@@ -143,7 +141,6 @@ void write_flashram_command(void* opaque, uint32_t address, uint32_t value, uint
 
 unsigned int flashram_dma_write(void* opaque, uint8_t* dram, uint32_t dram_addr, uint32_t cart_addr, uint32_t length)
 {
-    size_t i;
     struct flashram* flashram = (struct flashram*)opaque;
     const uint8_t* mem = flashram->istorage->data(flashram->storage);
 
@@ -157,9 +154,7 @@ unsigned int flashram_dma_write(void* opaque, uint8_t* dram, uint32_t dram_addr,
     case FLASHRAM_MODE_READ:
         cart_addr = (cart_addr & 0xffff) * 2; // ???
 
-        for(i = 0; i < length; ++i) {
-            dram[(dram_addr+i)^S8] = mem[(cart_addr+i)^S8];
-        }
+        copy_mem_bytes(dram, dram_addr, mem, cart_addr, length);
         break;
     default:
         DebugMessage(M64MSG_WARNING, "unknown dma_read_flashram: %x", flashram->mode);
@@ -44,15 +44,12 @@ void init_sram(struct sram* sram,
 
 unsigned int sram_dma_read(void* opaque, const uint8_t* dram, uint32_t dram_addr, uint32_t cart_addr, uint32_t length)
 {
-    size_t i;
     struct sram* sram = (struct sram*)opaque;
     uint8_t* mem = sram->istorage->data(sram->storage);
 
     cart_addr &= SRAM_ADDR_MASK;
 
-    for (i = 0; i < length; ++i) {
-        mem[(cart_addr+i)^S8] = dram[(dram_addr+i)^S8];
-    }
+    copy_mem_bytes(mem, cart_addr, dram, dram_addr, length);
 
     sram->istorage->save(sram->storage);
 
@@ -61,15 +58,12 @@ unsigned int sram_dma_read(void* opaque, const uint8_t* dram, uint32_t dram_addr
 
 unsigned int sram_dma_write(void* opaque, uint8_t* dram, uint32_t dram_addr, uint32_t cart_addr, uint32_t length)
 {
-    size_t i;
     struct sram* sram = (struct sram*)opaque;
     const uint8_t* mem = sram->istorage->data(sram->storage);
 
     cart_addr &= SRAM_ADDR_MASK;
 
-    for (i = 0; i < length; ++i) {
-        dram[(dram_addr+i)^S8] = mem[(cart_addr+i)^S8];
-    }
+    copy_mem_bytes(dram, dram_addr, mem, cart_addr, length);
 
     return /* length / 8 */0x1000;
 }
@@ -223,9 +223,10 @@ static void write_sector(struct dd_controller* dd)
 		disk_mem[offset + i] = dd->ds_buf[i ^ 3];
     }
 
-#if 0 /* disabled for now, because it causes too much slowdowns */
-    dd->idisk->save(dd->disk);
-#endif
+    /* only this sector gets written back */
+    if (dd->idisk->save_range != NULL) {
+        dd->idisk->save_range(dd->disk, offset, length);
+    }
 }
 
 static void seek_track(struct dd_controller* dd)
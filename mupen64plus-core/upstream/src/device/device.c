@@ -173,6 +173,7 @@ void init_device(struct device* dev,
     init_memory(&dev->mem, mappings, ARRAY_SIZE(mappings), base, &dbg_handler);
 
     init_rdram(&dev->rdram, mem_base_u32(base, MM_RDRAM_DRAM), dram_size, &dev->r4300);
+    apply_mem_direct(&dev->mem, MM_RDRAM_DRAM, MM_RDRAM_DRAM + dram_size - 1, dev->rdram.dram);
 
     init_r4300(&dev->r4300, &dev->mem, &dev->mi, &dev->rdram, interrupt_handlers,
             emumode, count_per_op, no_compiled_jump, randomize_interrupt);
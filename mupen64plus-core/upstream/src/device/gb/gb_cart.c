@@ -96,10 +96,12 @@ static void read_ram(const void* ram_storage, const struct storage_backend_inter
     }
 }
 
-static void write_ram(void* ram_storage, const struct storage_backend_interface* iram_storage, unsigned int enabled, uint16_t address, const uint8_t* data, size_t size, uint8_t mask)
+static void write_ram(struct gb_cart* gb_cart, unsigned int enabled, uint16_t address, const uint8_t* data, size_t size, uint8_t mask)
 {
     size_t i;
     uint8_t* dst;
+    void* ram_storage = gb_cart->ram_storage;
+    const struct storage_backend_interface* iram_storage = gb_cart->iram_storage;
 
     assert(size > 0);
 
@@ -129,6 +131,11 @@ static void write_ram(void* ram_storage, const struct storage_backend_interface*
             dst[i] &= mask;
         }
     }
+
+    /* battery backed RAM is written back later, once writes settle down */
+    if ((gb_cart->extra_devices & GED_BATTERY) && iram_storage->save != NULL) {
+        iram_storage->save(ram_storage);
+    }
 }
 
 
@@ -179,7 +186,7 @@ static int write_gb_cart_nombc(struct gb_cart* gb_cart, uint16_t address, const
 
     /* 0xa000-0xbfff: RAM */
     case (0xa000 >> 13):
-        write_ram(gb_cart->ram_storage, gb_cart->iram_storage, 1, address - 0xa000, data, size, UINT8_C(0xff));
+        write_ram(gb_cart, 1, address - 0xa000, data, size, UINT8_C(0xff));
         break;
 
     default:
@@ -265,7 +272,7 @@ static int write_gb_cart_mbc1(struct gb_cart* gb_cart, uint16_t address, const u
 
     /* 0xa000-0xbfff: RAM bank 00-03 */
     case (0xa000 >> 13):
-        write_ram(gb_cart->ram_storage, gb_cart->iram_storage, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
+        write_ram(gb_cart, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
         break;
 
     default:
@@ -328,7 +335,7 @@ static int write_gb_cart_mbc2(struct gb_cart* gb_cart, uint16_t address, const u
 
     /* 0xa000-0xa1ff: internal 512x4bit RAM */
     case (0xa000 >> 13):
-        write_ram(gb_cart->ram_storage, gb_cart->iram_storage, gb_cart->ram_enable, (address - 0xa000), data, size, UINT8_C(0x0f));
+        write_ram(gb_cart, gb_cart->ram_enable, (address - 0xa000), data, size, UINT8_C(0x0f));
         break;
 
     default:
@@ -453,7 +460,7 @@ static int write_gb_cart_mbc3(struct gb_cart* gb_cart, uint16_t address, const u
         case 0x05:
         case 0x06:
         case 0x07:
-            write_ram(gb_cart->ram_storage, gb_cart->iram_storage, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
+            write_ram(gb_cart, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
             break;
 
         /* RTC registers */
@@ -553,7 +560,7 @@ static int write_gb_cart_mbc5(struct gb_cart* gb_cart, uint16_t address, const u
 
     /* 0xa000-0xbfff: RAM bank 00-0f */
     case (0xa000 >> 13):
-        write_ram(gb_cart->ram_storage, gb_cart->iram_storage, gb_cart->ram_enable, (address - 0xa000) + ((gb_cart->ram_bank & 0x07)* 0x2000), data, size, UINT8_C(0xff));
+        write_ram(gb_cart, gb_cart->ram_enable, (address - 0xa000) + ((gb_cart->ram_bank & 0x07)* 0x2000), data, size, UINT8_C(0xff));
         break;
 
     default:
@@ -661,7 +668,7 @@ static int write_gb_cart_pocket_cam(struct gb_cart* gb_cart, uint16_t address, c
             write_m64282fp_regs(&gb_cart->cam, (address & 0x7f), value);
         }
         else {
-            write_ram(gb_cart->ram_storage, gb_cart->iram_storage, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
+            write_ram(gb_cart, gb_cart->ram_enable, (address - 0xa000) + (gb_cart->ram_bank * 0x2000), data, size, UINT8_C(0xff));
         }
         break;
 
@@ -29,8 +29,6 @@
 #include "device/pif/pif.h"
 
 #ifdef DBG
-#include <string.h>
-
 #include "device/r4300/r4300_core.h"
 
 #include "debugger/dbg_breakpoints.h"
@@ -41,6 +39,13 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__GNUC__) && !defined(__MINGW32__)
+#include <sys/mman.h>
+#endif
 
 #ifdef DBG
 enum
@@ -89,6 +94,8 @@ void activate_memory_break_read(struct memory* mem, uint32_t address)
     if (!(*bp_check & (BP_CHECK_READ | BP_CHECK_WRITE))) {
         *saved_handler = *handler;
         *handler = *dbg_handler;
+        mem->saved_direct[region] = mem->direct[region];
+        mem->direct[region] = NULL;
     }
 
     /* activate bp read */
@@ -108,6 +115,7 @@ void deactivate_memory_break_read(struct memory* mem, uint32_t address)
     /* if neither read nor write bp is active, restore handler */
     if (!(*bp_check & (BP_CHECK_READ | BP_CHECK_WRITE))) {
         *handler = *saved_handler;
+        mem->direct[region] = mem->saved_direct[region];
     }
 }
 
@@ -123,6 +131,8 @@ void activate_memory_break_write(struct memory* mem, uint32_t address)
     if (!(*bp_check & (BP_CHECK_READ | BP_CHECK_WRITE))) {
         *saved_handler = *handler;
         *handler = *dbg_handler;
+        mem->saved_direct[region] = mem->direct[region];
+        mem->direct[region] = NULL;
     }
 
     /* activate bp write */
@@ -142,6 +152,7 @@ void deactivate_memory_break_write(struct memory* mem, uint32_t address)
     /* if neither read nor write bp is active, restore handler */
     if (!(*bp_check & (BP_CHECK_READ | BP_CHECK_WRITE))) {
         *handler = *saved_handler;
+        mem->direct[region] = mem->saved_direct[region];
     }
 }
 
@@ -193,6 +204,7 @@ static void map_region(struct memory* mem,
     {
         mem->saved_handlers[region] = *handler;
         mem->handlers[region] = mem->dbg_handler;
+        mem->saved_direct[region] = NULL;
     }
     else
 #endif
@@ -200,6 +212,10 @@ static void map_region(struct memory* mem,
         (void)type;
         mem->handlers[region] = *handler;
     }
+
+    /* remapped regions go through their handler until
+     * apply_mem_direct says otherwise */
+    mem->direct[region] = NULL;
 }
 
 void apply_mem_mapping(struct memory* mem, const struct mem_mapping* mapping)
@@ -213,6 +229,65 @@ void apply_mem_mapping(struct memory* mem, const struct mem_mapping* mapping)
     }
 }
 
+/* Allow loads/stores to the 64KB aligned [begin, end] range to bypass
+ * the region handlers and access host memory at ptr directly.
+ * Must be called after apply_mem_mapping for the same range. */
+void apply_mem_direct(struct memory* mem, uint32_t begin, uint32_t end, uint32_t* ptr)
+{
+    size_t i;
+    uint16_t first = begin >> 16;
+    uint16_t last  = end   >> 16;
+
+    for (i = first; i <= last; ++i) {
+        uint32_t* direct = ptr + (((i - first) << 16) >> 2);
+#ifdef DBG
+        if (mem->bp_checks[i] & (BP_CHECK_READ | BP_CHECK_WRITE)) {
+            mem->saved_direct[i] = direct;
+            continue;
+        }
+#endif
+        mem->direct[i] = direct;
+    }
+}
+
+void copy_mem_bytes(uint8_t* dst, uint32_t dst_addr, const uint8_t* src, uint32_t src_addr, size_t length)
+{
+    size_t i;
+    size_t count;
+    unsigned int shift;
+    uint32_t* dst32;
+    const uint32_t* src32;
+
+    /* bytes up to the first destination word */
+    for (; length > 0 && (dst_addr & 3) != 0; --length) {
+        dst[(dst_addr++)^S8] = src[(src_addr++)^S8];
+    }
+
+    count = length / 4;
+    dst32 = (uint32_t*)(dst + dst_addr);
+    src32 = (const uint32_t*)(src + (src_addr & ~UINT32_C(3)));
+    shift = (src_addr & 3) * 8;
+
+    /* host words hold their bytes in the big-endian order, so a misaligned
+     * source word can be put together from two host words */
+    if (shift == 0) {
+        memcpy(dst32, src32, count * 4);
+    }
+    else {
+        for (i = 0; i < count; ++i) {
+            dst32[i] = (src32[i] << shift) | (src32[i + 1] >> (32 - shift));
+        }
+    }
+
+    dst_addr += (uint32_t)(count * 4);
+    src_addr += (uint32_t)(count * 4);
+    length -= count * 4;
+
+    for (; length > 0; --length) {
+        dst[(dst_addr++)^S8] = src[(src_addr++)^S8];
+    }
+}
+
 enum {
     MB_RDRAM_DRAM = 0,
     MB_CART_ROM = MB_RDRAM_DRAM + RDRAM_MAX_SIZE,
@@ -230,12 +305,129 @@ enum {
 #define MEM_BASE_PTR(mem_base)  ((void*)((uintptr_t)(mem_base) & ~0x1))
 #define SET_MEM_BASE_MODE(mem_base) (mem_base = (void*)((uintptr_t)(mem_base) | 0x1))
 
+/* The full mem base only reserves address space. Memory is committed for
+ * the regions backed by the mem base, and pages are only made resident once
+ * touched, so it costs no more than the compressed layout but keeps plain
+ * pointer arithmetic for address translation.
+ *
+ * Some readers run a little past the end of a region: the cached interpreter
+ * decodes the word following the last instruction of a block, and TLB blocks
+ * span more than a page. So a guard page is committed after each region.
+ * Plugins mask RDRAM addresses with 0xffffff, so the RDRAM region covers the
+ * whole 16MB that mask can reach.
+ */
+enum { MEM_BASE_GUARD_SIZE = 0x1000 };
+
+static const struct
+{
+    uint32_t address;
+    size_t size;
+} mem_base_regions[] =
+{
+    { MM_RDRAM_DRAM, 2 * RDRAM_MAX_SIZE },
+    { MM_RSP_MEM,    SP_MEM_SIZE },
+    { MM_DD_ROM,     DD_ROM_MAX_SIZE },
+    { MM_CART_ROM,   CART_ROM_MAX_SIZE },
+    { MM_PIF_MEM,    PIF_ROM_SIZE + PIF_RAM_SIZE },
+};
+
+#if defined(WIN32)
+static void* reserve_mem_base(size_t size)
+{
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static int commit_mem_base_region(void* addr, size_t size)
+{
+    return VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+static void unreserve_mem_base(void* mem_base, size_t size)
+{
+    VirtualFree(mem_base, 0, MEM_RELEASE);
+}
+#elif defined(__GNUC__) && !defined(__MINGW32__)
+
+#ifndef  MAP_ANONYMOUS
+#ifdef MAP_ANON
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+static void* reserve_mem_base(size_t size)
+{
+    void* mem_base = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    return (mem_base == MAP_FAILED) ? NULL : mem_base;
+}
+
+static int commit_mem_base_region(void* addr, size_t size)
+{
+    if (mprotect(addr, size, PROT_READ | PROT_WRITE) != 0) {
+        return 0;
+    }
+
+#ifdef MADV_HUGEPAGE
+    /* RDRAM is accessed all over, back it with huge pages where available */
+    if (size >= RDRAM_MAX_SIZE) {
+        madvise(addr, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    return 1;
+}
+
+static void unreserve_mem_base(void* mem_base, size_t size)
+{
+    munmap(mem_base, size);
+}
+#else
+static void* reserve_mem_base(size_t size)
+{
+    return malloc(size);
+}
+
+static int commit_mem_base_region(void* addr, size_t size)
+{
+    return 1;
+}
+
+static void unreserve_mem_base(void* mem_base, size_t size)
+{
+    free(mem_base);
+}
+#endif
+
+static void* init_full_mem_base(void)
+{
+    size_t i;
+    void* mem_base = reserve_mem_base(MB_MAX_SIZE_FULL);
+
+    if (mem_base == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < sizeof(mem_base_regions)/sizeof(mem_base_regions[0]); ++i) {
+        if (!commit_mem_base_region((uint8_t*)mem_base + mem_base_regions[i].address,
+                                    mem_base_regions[i].size + MEM_BASE_GUARD_SIZE)) {
+            unreserve_mem_base(mem_base, MB_MAX_SIZE_FULL);
+            return NULL;
+        }
+    }
+
+    return mem_base;
+}
+
 void* init_mem_base(void)
 {
     void* mem_base;
 
-    /* First try the full mem base alloc */
-    mem_base = malloc(MB_MAX_SIZE_FULL);
+    /* First try the full mem base reservation */
+    mem_base = init_full_mem_base();
     if (mem_base == NULL) {
         /* if it failed, try the compressed mem base alloc */
         mem_base = malloc(MB_MAX_SIZE);
@@ -257,7 +449,12 @@ void* init_mem_base(void)
 
 void release_mem_base(void* mem_base)
 {
-    free(MEM_BASE_PTR(mem_base));
+    if (MEM_BASE_MODE(mem_base) == 0) {
+        unreserve_mem_base(mem_base, MB_MAX_SIZE_FULL);
+    }
+    else {
+        free(MEM_BASE_PTR(mem_base));
+    }
 }
 
 uint32_t* mem_base_u32(void* mem_base, uint32_t address)
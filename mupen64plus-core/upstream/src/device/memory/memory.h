@@ -52,12 +52,16 @@ struct mem_mapping
 struct memory
 {
     struct mem_handler handlers[0x10000];
+    /* host pointer to the start of each region that can be accessed
+     * without going through its handler (plain RAM), NULL otherwise */
+    uint32_t* direct[0x10000];
     void* base;
 
 #ifdef DBG
     int memtype[0x10000];
     unsigned char bp_checks[0x10000];
     struct mem_handler saved_handlers[0x10000];
+    uint32_t* saved_direct[0x10000];
     struct mem_handler dbg_handler;
 #endif
 };
@@ -67,6 +71,10 @@ static osal_inline void masked_write(uint32_t* dst, uint32_t value, uint32_t mas
     *dst = (*dst & ~mask) | (value & mask);
 }
 
+/* Copies length bytes from src_addr to dst_addr, both buffers holding big-endian
+ * bytes in host 32-bit words like RDRAM does. Whole words at the source are read. */
+void copy_mem_bytes(uint8_t* dst, uint32_t dst_addr, const uint8_t* src, uint32_t src_addr, size_t length);
+
 void init_memory(struct memory* mem,
                  struct mem_mapping* mappings, size_t mappings_count,
                  void* base,
@@ -77,6 +85,14 @@ static osal_inline const struct mem_handler* mem_get_handler(const struct memory
     return &mem->handlers[address >> 16];
 }
 
+/* Returns host pointer to the word at (physical) address if its region is
+ * directly accessible, NULL if the access must go through the handler. */
+static osal_inline uint32_t* mem_get_direct(const struct memory* mem, uint32_t address)
+{
+    uint32_t* direct = mem->direct[address >> 16];
+    return (direct == NULL) ? NULL : &direct[(address & 0xffff) >> 2];
+}
+
 static osal_inline void mem_read32(const struct mem_handler* handler, uint32_t address, uint32_t* value)
 {
     handler->read32(handler->opaque, address, value);
@@ -88,6 +104,7 @@ static osal_inline void mem_write32(const struct mem_handler* handler, uint32_t
 }
 
 void apply_mem_mapping(struct memory* mem, const struct mem_mapping* mapping);
+void apply_mem_direct(struct memory* mem, uint32_t begin, uint32_t end, uint32_t* ptr);
 
 void* init_mem_base(void);
 void release_mem_base(void* mem_base);
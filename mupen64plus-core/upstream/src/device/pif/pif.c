@@ -95,6 +95,17 @@ static void post_setup_channel(struct pif_channel* channel)
         channel->rx, channel->rx_buf);
 }
 
+static void disable_pif_channels(struct pif* pif)
+{
+    size_t k;
+
+    for (k = 0; k < PIF_CHANNELS_COUNT; ++k) {
+        disable_pif_channel(&pif->channels[k]);
+    }
+
+    pif->format_valid = 0;
+}
+
 void disable_pif_channel(struct pif_channel* channel)
 {
     channel->tx = NULL;
@@ -143,8 +154,6 @@ void init_pif(struct pif* pif,
 
 void reset_pif(struct pif* pif, unsigned int reset_type)
 {
-    size_t i;
-
     /* HACK: for allowing pifbootrom execution */
     unsigned int rom_type = (pif->cic.version == CIC_8303) ? 1 : 0;
     unsigned int s7 = 0;
@@ -153,9 +162,7 @@ void reset_pif(struct pif* pif, unsigned int reset_type)
     assert((reset_type & ~0x1) == 0);
 
     /* disable channel processing */
-    for (i = 0; i < PIF_CHANNELS_COUNT; ++i) {
-        disable_pif_channel(&pif->channels[i]);
-    }
+    disable_pif_channels(pif);
 
     /* set PIF_24 with reset informations */
     uint32_t* pif24 = (uint32_t*)(pif->ram + 0x24);
@@ -171,10 +178,35 @@ void reset_pif(struct pif* pif, unsigned int reset_type)
     pif->ram[0x3f] = 0x00;
 }
 
-void setup_channels_format(struct pif* pif)
+/* Games poll their controllers several times per frame with the same command
+ * block, so when the command bytes are unchanged the channels already point
+ * at the right place in PIF RAM and only the device post setup is redone.
+ */
+static int reuse_channels_format(struct pif* pif)
+{
+    size_t k;
+
+    if (!pif->format_valid
+    || memcmp(pif->format, pif->ram, sizeof(pif->format)) != 0) {
+        return 0;
+    }
+
+    for (k = 0; k < PIF_CHANNELS_COUNT; ++k) {
+        if (pif->channels[k].tx != NULL) {
+            post_setup_channel(&pif->channels[k]);
+        }
+    }
+
+    return 1;
+}
+
+static void parse_channels_format(struct pif* pif)
 {
     size_t i = 0;
     size_t k = 0;
+    unsigned int cacheable = 1;
+
+    memcpy(pif->format, pif->ram, sizeof(pif->format));
 
     while (i < PIF_RAM_SIZE && k < PIF_CHANNELS_COUNT)
     {
@@ -204,6 +236,8 @@ void setup_channels_format(struct pif* pif)
             dummy_reset_buffer[k][2] = 0xff;
 
             setup_pif_channel(&pif->channels[k], dummy_reset_buffer[k]);
+            /* the reset buffer gets overwritten by the response */
+            cacheable = 0;
             ++k;
             ++i;
             }
@@ -231,6 +265,15 @@ void setup_channels_format(struct pif* pif)
         }
     }
 
+    pif->format_valid = cacheable;
+}
+
+void setup_channels_format(struct pif* pif)
+{
+    if (!reuse_channels_format(pif)) {
+        parse_channels_format(pif);
+    }
+
     /* Zilmar-Spec plugin expect a call with control_id = -1 when RAM processing is done */
     if (input.controllerCommand) {
         input.controllerCommand(-1, NULL);
@@ -315,7 +358,6 @@ void process_pif_ram(struct pif* pif)
 {
     uint8_t flags = pif->ram[0x3f];
     uint8_t clrmask = 0x00;
-    size_t k;
 
     if (flags == 0) {
 #ifdef DEBUG_PIF
@@ -335,9 +377,7 @@ void process_pif_ram(struct pif* pif)
     if (flags & 0x02)
     {
         /* disable channel processing when doing CIC challenge */
-        for (k = 0; k < PIF_CHANNELS_COUNT; ++k) {
-            disable_pif_channel(&pif->channels[k]);
-        }
+        disable_pif_channels(pif);
 
         /* CIC Challenge */
         process_cic_challenge(pif);
@@ -55,6 +55,10 @@ struct pif
     uint8_t* ram;
     struct pif_channel channels[PIF_CHANNELS_COUNT];
 
+    /* command bytes the current channel layout was parsed from */
+    uint8_t format[PIF_RAM_SIZE - 1];
+    unsigned int format_valid;
+
     struct cic cic;
 
     struct r4300_core* r4300;
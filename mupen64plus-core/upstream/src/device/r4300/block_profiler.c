@@ -0,0 +1,223 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profiler.c                                        *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "block_profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+
+struct block_profiler_ring
+{
+    struct block_profiler_event events[BLOCK_PROFILER_RING_SIZE];
+    /* total number of events ever written, only modified by the emulation thread */
+    volatile uint32_t head;
+};
+
+struct block_profiler_stats
+{
+    uint32_t addr;
+    uint32_t entries;
+    uint32_t compiles;
+    uint32_t invalidations;
+    uint64_t cycles;
+};
+
+static struct block_profiler_ring l_ring;
+
+static uint32_t l_current_addr;
+static uint32_t l_current_count;
+static int l_has_current;
+
+static void push_event(uint32_t addr, uint32_t cycles, uint32_t type)
+{
+    uint32_t head = l_ring.head;
+    struct block_profiler_event* e = &l_ring.events[head & (BLOCK_PROFILER_RING_SIZE - 1)];
+
+    e->addr = addr;
+    e->cycles = cycles;
+    e->type = type;
+
+    /* publish the event only once it is fully written */
+#if defined(__GNUC__)
+    __sync_synchronize();
+#endif
+    l_ring.head = head + 1;
+}
+
+void block_profiler_reset(void)
+{
+    l_ring.head = 0;
+    l_has_current = 0;
+}
+
+void block_profiler_enter(uint32_t addr, uint32_t count)
+{
+    if (l_has_current) {
+        push_event(l_current_addr, count - l_current_count, BLOCK_PROFILER_ENTER);
+    }
+
+    l_current_addr = addr;
+    l_current_count = count;
+    l_has_current = 1;
+}
+
+void block_profiler_compile(uint32_t addr)
+{
+    push_event(addr, 0, BLOCK_PROFILER_COMPILE);
+}
+
+void block_profiler_invalidate(uint32_t addr)
+{
+    push_event(addr, 0, BLOCK_PROFILER_INVALIDATE);
+}
+
+/* open addressing table used to aggregate the ring at dump time */
+static struct block_profiler_stats* find_stats(struct block_profiler_stats* table, size_t table_size, uint32_t addr)
+{
+    size_t i = ((addr >> 2) * UINT32_C(2654435761)) & (table_size - 1);
+
+    while (table[i].entries | table[i].compiles | table[i].invalidations) {
+        if (table[i].addr == addr) {
+            return &table[i];
+        }
+        i = (i + 1) & (table_size - 1);
+    }
+
+    table[i].addr = addr;
+    return &table[i];
+}
+
+static int compare_cycles(const void* a, const void* b)
+{
+    const struct block_profiler_stats* sa = (const struct block_profiler_stats*)a;
+    const struct block_profiler_stats* sb = (const struct block_profiler_stats*)b;
+
+    if (sa->cycles != sb->cycles) {
+        return (sa->cycles < sb->cycles) ? 1 : -1;
+    }
+    return (sa->entries < sb->entries) ? 1 : (sa->entries > sb->entries) ? -1 : 0;
+}
+
+static int compare_invalidations(const void* a, const void* b)
+{
+    const struct block_profiler_stats* sa = (const struct block_profiler_stats*)a;
+    const struct block_profiler_stats* sb = (const struct block_profiler_stats*)b;
+
+    return (sa->invalidations < sb->invalidations) ? 1 : (sa->invalidations > sb->invalidations) ? -1 : 0;
+}
+
+int block_profiler_dump(int top_n, const char* filename)
+{
+    /* twice the ring size keeps the load factor of the table <= 0.5 */
+    const size_t table_size = 2 * BLOCK_PROFILER_RING_SIZE;
+    struct block_profiler_stats* table;
+    uint32_t head, count, i;
+    size_t n, k;
+    uint64_t total_cycles = 0;
+
+    head = l_ring.head;
+#if defined(__GNUC__)
+    __sync_synchronize();
+#endif
+    count = (head < BLOCK_PROFILER_RING_SIZE) ? head : BLOCK_PROFILER_RING_SIZE;
+
+    table = calloc(table_size, sizeof(*table));
+    if (table == NULL) {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate block profiler table");
+        return -1;
+    }
+
+    for (i = head - count; i != head; ++i) {
+        const struct block_profiler_event* e = &l_ring.events[i & (BLOCK_PROFILER_RING_SIZE - 1)];
+        struct block_profiler_stats* s = find_stats(table, table_size, e->addr);
+
+        switch (e->type)
+        {
+        case BLOCK_PROFILER_ENTER:
+            ++s->entries;
+            s->cycles += e->cycles;
+            total_cycles += e->cycles;
+            break;
+        case BLOCK_PROFILER_COMPILE:
+            ++s->compiles;
+            break;
+        case BLOCK_PROFILER_INVALIDATE:
+            ++s->invalidations;
+            break;
+        }
+    }
+
+    /* compact used slots */
+    for (n = 0, k = 0; k < table_size; ++k) {
+        if (table[k].entries | table[k].compiles | table[k].invalidations) {
+            table[n++] = table[k];
+        }
+    }
+
+    if (top_n <= 0) {
+        top_n = 32;
+    }
+
+    qsort(table, n, sizeof(*table), compare_cycles);
+
+    DebugMessage(M64MSG_INFO, "Block profile: %u events, %u distinct addresses", count, (unsigned int)n);
+    for (k = 0; k < n && k < (size_t)top_n && table[k].entries != 0; ++k) {
+        DebugMessage(M64MSG_INFO, "  %08x: %6.2f%% cycles=%llu entries=%u compiles=%u",
+            table[k].addr,
+            (total_cycles != 0) ? 100.0 * (double)table[k].cycles / (double)total_cycles : 0.0,
+            (unsigned long long)table[k].cycles,
+            table[k].entries,
+            table[k].compiles);
+    }
+
+    if (filename != NULL) {
+        FILE* f = fopen(filename, "w");
+        if (f == NULL) {
+            DebugMessage(M64MSG_ERROR, "Failed to open block profile file: %s", filename);
+        }
+        else {
+            fprintf(f, "addr,cycles,entries,compiles,invalidations\n");
+            for (k = 0; k < n; ++k) {
+                fprintf(f, "%08x,%llu,%u,%u,%u\n",
+                    table[k].addr,
+                    (unsigned long long)table[k].cycles,
+                    table[k].entries,
+                    table[k].compiles,
+                    table[k].invalidations);
+            }
+            fclose(f);
+        }
+    }
+
+    qsort(table, n, sizeof(*table), compare_invalidations);
+
+    for (k = 0; k < n && k < (size_t)top_n && table[k].invalidations != 0; ++k) {
+        DebugMessage(M64MSG_INFO, "  invalidated %08x: %u times", table[k].addr, table[k].invalidations);
+    }
+
+    free(table);
+    return 0;
+}
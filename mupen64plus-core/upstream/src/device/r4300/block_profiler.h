@@ -0,0 +1,75 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profiler.h                                        *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_DEVICE_R4300_BLOCK_PROFILER_H
+#define M64P_DEVICE_R4300_BLOCK_PROFILER_H
+
+#include <stdint.h>
+
+/* Block-level profiler for the cached interpreter and the new dynarec.
+ *
+ * Events are appended by the emulation thread to a fixed-size ring which
+ * is never locked: the writer only publishes its head index once an event
+ * is complete, and the reader copies whatever is in the ring when a dump
+ * is requested. Old events are overwritten, so a dump represents the most
+ * recent BLOCK_PROFILER_RING_SIZE events.
+ *
+ * With the cached interpreter every jump is seen and cycles are exact.
+ * With the new dynarec only lookups going through get_addr/get_addr_ht
+ * are seen (directly linked branches are not), and cycles are only as
+ * precise as the CP0 count updates done at interrupt checks.
+ *
+ * Hooks are only compiled in when PROFILE_BLOCKS is defined.
+ */
+
+#define BLOCK_PROFILER_RING_SIZE 0x10000 /* must be a power of 2 */
+
+enum block_profiler_event_type
+{
+    BLOCK_PROFILER_ENTER,
+    BLOCK_PROFILER_COMPILE,
+    BLOCK_PROFILER_INVALIDATE
+};
+
+struct block_profiler_event
+{
+    uint32_t addr;
+    uint32_t cycles;
+    uint32_t type;
+};
+
+/* Reset the ring and the current block tracking */
+void block_profiler_reset(void);
+
+/* Record entry in block starting at addr. count is the current CP0 count,
+ * used to attribute elapsed cycles to the block being left. */
+void block_profiler_enter(uint32_t addr, uint32_t count);
+
+/* Record a block (re)compilation or invalidation at addr */
+void block_profiler_compile(uint32_t addr);
+void block_profiler_invalidate(uint32_t addr);
+
+/* Print the top_n hottest blocks and most invalidated pages. If filename is
+ * not NULL, all aggregated blocks are also written to it as CSV.
+ * Returns 0 on success */
+int block_profiler_dump(int top_n, const char* filename);
+
+#endif /* M64P_DEVICE_R4300_BLOCK_PROFILER_H */
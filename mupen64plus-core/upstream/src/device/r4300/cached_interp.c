@@ -34,22 +34,35 @@
 #include "api/m64p_types.h"
 #include "device/r4300/r4300_core.h"
 #include "device/r4300/idec.h"
+#include "device/r4300/idle_loop.h"
 #include "main/main.h"
 #include "osal/preproc.h"
 
 #ifdef DBG
+#include "debugger/dbg_breakpoints.h"
 #include "debugger/dbg_debugger.h"
 #endif
 
+#ifdef PROFILE_BLOCKS
+#include "device/r4300/block_profiler.h"
+#endif
+
 // -----------------------------------------------------------
 // Cached interpreter functions (and fallback for dynarec).
 // -----------------------------------------------------------
 #ifdef DBG
-#define UPDATE_DEBUGGER() if (g_DebuggerActive) update_debugger(*r4300_pc(r4300))
+/* While running, only instructions wrapped by cached_interp_BREAKPOINT check breakpoints */
+#define UPDATE_DEBUGGER() if (g_DebuggerActive && g_dbg_runstate != M64P_DBG_RUNSTATE_RUNNING) update_debugger(*r4300_pc(r4300))
 #else
 #define UPDATE_DEBUGGER() do { } while(0)
 #endif
 
+#ifdef PROFILE_BLOCKS
+#define PROFILE_BLOCK_ENTER(addr) block_profiler_enter((addr), r4300_cp0_regs(&r4300->cp0)[CP0_COUNT_REG])
+#else
+#define PROFILE_BLOCK_ENTER(addr) do { } while(0)
+#endif
+
 #define DECLARE_R4300 struct r4300_core* r4300 = &g_dev.r4300;
 #define PCADDR *r4300_pc(r4300)
 #define ADD_TO_PC(x) (*r4300_pc_struct(r4300)) += x;
@@ -78,6 +91,7 @@ void cached_interp_##name(void) \
         if (take_jump && !r4300->skip_jump) \
         { \
             (*r4300_pc_struct(r4300))=r4300->cached_interp.actual->block+((jump_target-r4300->cached_interp.actual->start)>>2); \
+            PROFILE_BLOCK_ENTER(jump_target); \
         } \
     } \
     else \
@@ -245,6 +259,63 @@ void cached_interp_NOTCOMPILED2(void)
     cached_interp_NOTCOMPILED();
 }
 
+/* Wraps the branch closing a polling loop found by idle_loop_analyze */
+static void cached_interp_IDLE_LOOP(void)
+{
+    DECLARE_R4300
+    struct precomp_instr* branch = *r4300_pc_struct(r4300);
+    struct precomp_instr* start = branch + 1 + branch->f.i.immediate;
+    uint32_t loads = branch->idle_loads;
+    struct precomp_instr* inst;
+
+    branch->idle_ops();
+
+    /* only consider the loop when it branched back without an interrupt */
+    if (*r4300_pc_struct(r4300) != start) {
+        return;
+    }
+
+    for (inst = start; loads != 0; ++inst, loads >>= 1)
+    {
+        if ((loads & 1) == 0) {
+            continue;
+        }
+
+        if (inst->ops == cached_interp_NOTCOMPILED || inst->ops == cached_interp_NOTCOMPILED2
+         || !idle_loop_is_stable_address((uint32_t)(*inst->f.i.rs + inst->f.i.immediate))) {
+            return;
+        }
+    }
+
+    idle_loop_taken(r4300, branch->addr, (unsigned int)(branch - start) + 2);
+}
+
+#ifdef DBG
+/* Wraps an instruction with an enabled execution breakpoint */
+static void cached_interp_BREAKPOINT(void)
+{
+    DECLARE_R4300
+    struct precomp_instr* inst = *r4300_pc_struct(r4300);
+
+    /* when paused or stepping, update_debugger already ran for this instruction */
+    if (g_dbg_runstate == M64P_DBG_RUNSTATE_RUNNING) {
+        update_debugger(inst->addr);
+    }
+
+    inst->debug_ops();
+}
+
+static void set_breakpoint_ops(struct precomp_instr* inst)
+{
+    if (check_breakpoints(inst->addr) == -1) {
+        return;
+    }
+
+    inst->debug_ops = inst->ops;
+    inst->ops = cached_interp_BREAKPOINT;
+}
+#endif
+
 /* TODO: implement them properly */
 #define cached_interp_BC0F        cached_interp_NI
 #define cached_interp_BC0F_IDLE   cached_interp_NI
@@ -344,6 +415,46 @@ static void (*const ci_table[R4300_OPCODES_COUNT])(void) =
 };
 #undef X
 
+/* Turn a regular in-block branch into a polling loop check when the loop
+ * it closes qualifies. iw and i index the instruction words of the block. */
+static void detect_idle_loop(struct precomp_instr* inst, const uint32_t* iw, int i, enum r4300_opcode opcode)
+{
+    int start;
+    uint32_t loads;
+
+    switch (opcode)
+    {
+    case R4300_OP_BEQ:
+    case R4300_OP_BEQL:
+    case R4300_OP_BNE:
+    case R4300_OP_BNEL:
+    case R4300_OP_BLEZ:
+    case R4300_OP_BLEZL:
+    case R4300_OP_BGTZ:
+    case R4300_OP_BGTZL:
+    case R4300_OP_BLTZ:
+    case R4300_OP_BLTZL:
+    case R4300_OP_BGEZ:
+    case R4300_OP_BGEZL:
+        break;
+    default:
+        return;
+    }
+
+    start = i + 1 + inst->f.i.immediate;
+    if (start < 0 || start > i || (i + 2 - start) > IDLE_LOOP_MAX_LENGTH) {
+        return;
+    }
+
+    if (!idle_loop_analyze(iw + start, i + 2 - start, &loads)) {
+        return;
+    }
+
+    inst->idle_ops = inst->ops;
+    inst->idle_loads = loads;
+    inst->ops = cached_interp_IDLE_LOOP;
+}
+
 /* return 0:normal, 1:idle, 2:out */
 static int infer_jump_sub_type(uint32_t target, uint32_t pc, uint32_t next_iw, const struct precomp_block* block)
 {
@@ -755,7 +866,11 @@ void cached_interp_init_block(struct r4300_core* r4300, uint32_t address)
 
     /* allocate block */
     if (*block == NULL) {
-        *block = malloc(sizeof(struct precomp_block));
+        *block = block_arena_alloc(&r4300->cached_interp.arena, sizeof(struct precomp_block));
+        if (*block == NULL) {
+            DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate memory for cached interpreter.");
+            return;
+        }
         (*block)->block = NULL;
         (*block)->start = address & ~UINT32_C(0xfff);
         (*block)->end = (address & ~UINT32_C(0xfff)) + 0x1000;
@@ -773,7 +888,7 @@ void cached_interp_init_block(struct r4300_core* r4300, uint32_t address)
     if (!b->block)
     {
         size_t memsize = get_block_memsize(b);
-        b->block = (struct precomp_instr*)malloc(memsize);
+        b->block = (struct precomp_instr*)block_arena_alloc(&r4300->cached_interp.arena, memsize);
         if (!b->block) {
             DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate memory for cached interpreter.");
             return;
@@ -820,10 +935,8 @@ void cached_interp_init_block(struct r4300_core* r4300, uint32_t address)
 
 void cached_interp_free_block(struct precomp_block* block)
 {
-    if (block->block) {
-        free(block->block);
-        block->block = NULL;
-    }
+    /* block instructions are given back with the arena */
+    block->block = NULL;
 }
 
 void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struct precomp_block* block, uint32_t func)
@@ -842,6 +955,10 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
     /* reset xxhash */
     block->xxhash = 0;
 
+#ifdef PROFILE_BLOCKS
+    block_profiler_compile(func);
+#endif
+
 
     for (i = (func & 0xFFF) / 4, finished = 0; finished != 2; ++i)
     {
@@ -860,6 +977,12 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
 
         /* decode instruction */
         opcode = r4300_decode(inst, r4300, r4300_get_idec(iw[i]), iw[i], iw[i+1], block);
+        detect_idle_loop(inst, iw, i, opcode);
+#ifdef DBG
+        if (g_DebuggerActive) {
+            set_breakpoint_ops(inst);
+        }
+#endif
 
         /* decode ending conditions */
         if (i >= length2) { finished = 2; }
@@ -896,6 +1019,39 @@ void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw,
 #endif
 }
 
+#ifdef DBG
+void cached_interp_update_breakpoints(struct r4300_core* r4300)
+{
+    struct precomp_block** const blocks = r4300->cached_interp.blocks;
+    struct precomp_instr* inst;
+    int i, j, length;
+
+    /* rewrap the compiled instructions, the other ones are handled when compiled */
+    for (i = 0; i < 0x100000; ++i)
+    {
+        if (blocks[i] == NULL || blocks[i]->block == NULL) {
+            continue;
+        }
+
+        length = get_block_length(blocks[i]);
+        for (j = 0; j < length; ++j)
+        {
+            inst = &blocks[i]->block[j];
+
+            if (inst->ops == cached_interp_BREAKPOINT) {
+                inst->ops = inst->debug_ops;
+            }
+
+            if (inst->ops != cached_interp_NOTCOMPILED
+             && inst->ops != cached_interp_NOTCOMPILED2
+             && inst->ops != cached_interp_FIN_BLOCK) {
+                set_breakpoint_ops(inst);
+            }
+        }
+    }
+}
+#endif
+
 void cached_interpreter_jump_to(struct r4300_core* r4300, uint32_t address)
 {
     struct cached_interp* const cinterp = &r4300->cached_interp;
@@ -916,9 +1072,107 @@ void cached_interpreter_jump_to(struct r4300_core* r4300, uint32_t address)
     /* set new PC */
     cinterp->actual = cinterp->blocks[address >> 12];
     (*r4300_pc_struct(r4300)) = cinterp->actual->block + ((address - cinterp->actual->start) >> 2);
+
+    PROFILE_BLOCK_ENTER(address);
 }
 
 
+#define BLOCK_ARENA_CHUNK_SIZE (4 * 1024 * 1024)
+#define BLOCK_ARENA_ALIGN 16
+
+struct block_arena_chunk
+{
+    struct block_arena_chunk* next;
+    size_t size;
+    size_t used;
+};
+
+struct block_arena_free
+{
+    struct block_arena_free* next;
+    size_t size;
+};
+
+static size_t block_arena_round(size_t size)
+{
+    return (size + BLOCK_ARENA_ALIGN - 1) & ~(size_t)(BLOCK_ARENA_ALIGN - 1);
+}
+
+void* cached_interp_alloc_chunk(size_t size)
+{
+    return malloc(size);
+}
+
+void cached_interp_free_chunk(void* ptr, size_t size)
+{
+    free(ptr);
+}
+
+void* block_arena_alloc(struct block_arena* arena, size_t size)
+{
+    struct block_arena_free** prev;
+    struct block_arena_chunk* chunk;
+    size_t header = block_arena_round(sizeof(struct block_arena_chunk));
+    void* ptr;
+
+    size = block_arena_round(size);
+
+    /* recycle a region of the same size which was given back earlier */
+    for (prev = &arena->free_list; *prev != NULL; prev = &(*prev)->next) {
+        if ((*prev)->size == size) {
+            ptr = *prev;
+            *prev = (*prev)->next;
+            return ptr;
+        }
+    }
+
+    chunk = arena->chunks;
+    if (chunk == NULL || chunk->used + size > chunk->size) {
+        size_t chunk_size = (header + size > BLOCK_ARENA_CHUNK_SIZE)
+            ? header + size
+            : BLOCK_ARENA_CHUNK_SIZE;
+
+        chunk = (struct block_arena_chunk*)arena->alloc_chunk(chunk_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        chunk->used = header;
+        arena->chunks = chunk;
+    }
+
+    ptr = (unsigned char*)chunk + chunk->used;
+    chunk->used += size;
+
+    return ptr;
+}
+
+void block_arena_free(struct block_arena* arena, void* ptr, size_t size)
+{
+    struct block_arena_free* region = (struct block_arena_free*)ptr;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    region->size = block_arena_round(size);
+    region->next = arena->free_list;
+    arena->free_list = region;
+}
+
+void block_arena_release(struct block_arena* arena)
+{
+    while (arena->chunks != NULL) {
+        struct block_arena_chunk* chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        arena->free_chunk(chunk, chunk->size);
+    }
+
+    arena->free_list = NULL;
+}
+
 void init_blocks(struct cached_interp* cinterp)
 {
     size_t i;
@@ -927,6 +1181,9 @@ void init_blocks(struct cached_interp* cinterp)
         cinterp->invalid_code[i] = 1;
         cinterp->blocks[i] = NULL;
     }
+
+    cinterp->arena.chunks = NULL;
+    cinterp->arena.free_list = NULL;
 }
 
 void free_blocks(struct cached_interp* cinterp)
@@ -937,10 +1194,11 @@ void free_blocks(struct cached_interp* cinterp)
         if (cinterp->blocks[i])
         {
             cinterp->free_block(cinterp->blocks[i]);
-            free(cinterp->blocks[i]);
             cinterp->blocks[i] = NULL;
         }
     }
+
+    block_arena_release(&cinterp->arena);
 }
 
 void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address, size_t size)
@@ -969,6 +1227,9 @@ void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address
                  || r4300->cached_interp.blocks[i]->block[(addr & 0xfff) / 4].ops != r4300->cached_interp.not_compiled)
                 {
                     r4300->cached_interp.invalid_code[i] = 1;
+#ifdef PROFILE_BLOCKS
+                    block_profiler_invalidate(addr & ~UINT32_C(0xfff));
+#endif
                     /* go directly to next i */
                     addr &= ~0xfff;
                     addr |= 0xffc;
@@ -986,16 +1247,21 @@ void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address
 
 void run_cached_interpreter(struct r4300_core* r4300)
 {
-    while (!*r4300_stop(r4300))
+    /* r4300_pc_struct and r4300_stop are out of line, so look them up once
+     * instead of twice per dispatched instruction */
+    struct precomp_instr** const pc = r4300_pc_struct(r4300);
+    const int* const stop = r4300_stop(r4300);
+
+    while (!*stop)
     {
 #ifdef COMPARE_CORE
-        if ((*r4300_pc_struct(r4300))->ops == cached_interp_FIN_BLOCK && ((*r4300_pc_struct(r4300))->addr < 0x80000000 || (*r4300_pc_struct(r4300))->addr >= 0xc0000000))
-            virtual_to_physical_address(r4300, (*r4300_pc_struct(r4300))->addr, 2);
+        if ((*pc)->ops == cached_interp_FIN_BLOCK && ((*pc)->addr < 0x80000000 || (*pc)->addr >= 0xc0000000))
+            virtual_to_physical_address(r4300, (*pc)->addr, 2);
         CoreCompareCallback();
 #endif
 #ifdef DBG
-        if (g_DebuggerActive) update_debugger((*r4300_pc_struct(r4300))->addr);
+        if (g_DebuggerActive && g_dbg_runstate != M64P_DBG_RUNSTATE_RUNNING) update_debugger((*pc)->addr);
 #endif
-        (*r4300_pc_struct(r4300))->ops();
+        (*pc)->ops();
     }
 }
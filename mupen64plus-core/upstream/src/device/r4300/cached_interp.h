@@ -30,6 +30,7 @@ struct cached_interp;
 struct r4300_idec;
 struct precomp_block;
 struct precomp_instr;
+struct block_arena;
 
 enum r4300_opcode r4300_decode(struct precomp_instr* inst, struct r4300_core* r4300, const struct r4300_idec* idec, uint32_t iw, uint32_t next_iw, const struct precomp_block* block);
 
@@ -41,11 +42,23 @@ void cached_interp_free_block(struct precomp_block* block);
 
 void cached_interp_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struct precomp_block* block, uint32_t func);
 
+void* cached_interp_alloc_chunk(size_t size);
+void cached_interp_free_chunk(void* ptr, size_t size);
+
+void* block_arena_alloc(struct block_arena* arena, size_t size);
+void block_arena_free(struct block_arena* arena, void* ptr, size_t size);
+void block_arena_release(struct block_arena* arena);
+
 void init_blocks(struct cached_interp* cinterp);
 void free_blocks(struct cached_interp* cinterp);
 
 void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address, size_t size);
 
+#ifdef DBG
+/* Wraps compiled instructions with execution breakpoints after breakpoints changed */
+void cached_interp_update_breakpoints(struct r4300_core* r4300);
+#endif
+
 void run_cached_interpreter(struct r4300_core* r4300);
 
 /* Jumps to the given address. This is for the cached interpreter. */
@@ -133,7 +133,7 @@ enum r4300_cp0_registers
 
 
 
-enum { INTERRUPT_NODES_POOL_CAPACITY = 16 };
+enum { INTERRUPT_QUEUE_CAPACITY = 16 };
 
 struct interrupt_event
 {
@@ -141,23 +141,12 @@ struct interrupt_event
     unsigned int count;
 };
 
-struct node
-{
-    struct interrupt_event data;
-    struct node *next;
-};
-
-struct pool
-{
-    struct node nodes [INTERRUPT_NODES_POOL_CAPACITY];
-    struct node* stack[INTERRUPT_NODES_POOL_CAPACITY];
-    size_t index;
-};
-
+/* Events are kept ordered by trigger time in a contiguous array,
+ * events[0] being the next one to trigger. */
 struct interrupt_queue
 {
-    struct pool pool;
-    struct node* first;
+    struct interrupt_event events[INTERRUPT_QUEUE_CAPACITY];
+    size_t size;
 };
 
 struct interrupt_handler
@@ -27,6 +27,8 @@
 
 #include "new_dynarec/new_dynarec.h" /* for NEW_DYNAREC_ARM */
 
+int g_fpu_host_rounding = -1;
+
 void init_cp1(struct cp1* cp1, struct new_dynarec_hot_state* new_dynarec_hot_state)
 {
 #if NEW_DYNAREC == NEW_DYNAREC_ARM
@@ -120,6 +122,9 @@ void update_x86_rounding_mode(struct cp1* cp1)
 {
     uint32_t fcr31 = *r4300_cp1_fcr31(cp1);
 
+    /* let the fpu.h helpers switch the host FPU on their next use */
+    g_fpu_host_rounding = -1;
+
     switch (fcr31 & 3)
     {
     case 0: /* Round to nearest, or to even if equidistant */
@@ -111,5 +111,9 @@ void set_fpr_pointers(struct cp1* cp1, uint32_t newStatus);
 
 void update_x86_rounding_mode(struct cp1* cp1);
 
+/* Guest rounding mode (FCR31 & 3) the host FPU was last switched to by the
+ * fpu.h helpers, or -1 when it has to be set again before the next use */
+extern int g_fpu_host_rounding;
+
 #endif /* M64P_DEVICE_R4300_CP1_H */
 
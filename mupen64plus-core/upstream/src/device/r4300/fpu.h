@@ -25,6 +25,8 @@
 #include <math.h>
 #include <stdint.h>
 
+#include "cp1.h"
+
 #ifdef _MSC_VER
 #define M64P_FPU_INLINE static __inline
 #include <float.h>
@@ -53,9 +55,18 @@ static __inline float  truncf(float x) { return (float)(int)x; }
 #define FCR31_CMP_BIT UINT32_C(0x800000)
 
 
+/* Switching the host rounding mode is expensive (it serializes the FPU on
+ * most hosts), so only do it when the guest mode differs from the current one */
 M64P_FPU_INLINE void set_rounding(const uint32_t* fcr31)
 {
-    switch(*fcr31 & 3) {
+    int mode = *fcr31 & 3;
+
+    if (mode == g_fpu_host_rounding)
+        return;
+
+    g_fpu_host_rounding = mode;
+
+    switch(mode) {
     case 0: /* Round to nearest, or to even if equidistant */
         fesetround(FE_TONEAREST);
         break;
@@ -0,0 +1,220 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "idle_loop.h"
+
+#include <stdint.h>
+
+#include "device/device.h"
+#include "device/r4300/r4300_core.h"
+
+#define RS_OF(iw) (((iw) >> 21) & 0x1f)
+#define RT_OF(iw) (((iw) >> 16) & 0x1f)
+#define RD_OF(iw) (((iw) >> 11) & 0x1f)
+
+enum idle_loop_instr_kind
+{
+    IDLE_LOOP_INSTR_REJECT,
+    IDLE_LOOP_INSTR_ALU,
+    IDLE_LOOP_INSTR_LOAD,
+    IDLE_LOOP_INSTR_BRANCH
+};
+
+/* Classify one instruction word, filling the mask of registers it reads
+ * and the register it writes (0 for none). Anything with side effects
+ * besides writing a GPR is rejected. */
+static enum idle_loop_instr_kind idle_loop_decode(uint32_t iw, uint32_t* reads, unsigned int* write)
+{
+    const uint32_t rs = UINT32_C(1) << RS_OF(iw);
+    const uint32_t rt = UINT32_C(1) << RT_OF(iw);
+
+    *reads = 0;
+    *write = 0;
+
+    switch (iw >> 26)
+    {
+    case 0: /* SPECIAL */
+        switch (iw & 0x3f)
+        {
+        case 0: case 2: case 3:             /* SLL, SRL, SRA */
+        case 56: case 58: case 59:          /* DSLL, DSRL, DSRA */
+        case 60: case 62: case 63:          /* DSLL32, DSRL32, DSRA32 */
+            *reads = rt;
+            *write = RD_OF(iw);
+            return IDLE_LOOP_INSTR_ALU;
+
+        case 4: case 6: case 7:             /* SLLV, SRLV, SRAV */
+        case 20: case 22: case 23:          /* DSLLV, DSRLV, DSRAV */
+        case 33: case 35:                   /* ADDU, SUBU */
+        case 36: case 37: case 38: case 39: /* AND, OR, XOR, NOR */
+        case 42: case 43:                   /* SLT, SLTU */
+        case 45: case 47:                   /* DADDU, DSUBU */
+            *reads = rs | rt;
+            *write = RD_OF(iw);
+            return IDLE_LOOP_INSTR_ALU;
+
+        default:
+            return IDLE_LOOP_INSTR_REJECT;
+        }
+
+    case 1: /* REGIMM */
+        switch (RT_OF(iw))
+        {
+        case 0: case 1: case 2: case 3:     /* BLTZ, BGEZ, BLTZL, BGEZL */
+            *reads = rs;
+            return IDLE_LOOP_INSTR_BRANCH;
+        default:
+            return IDLE_LOOP_INSTR_REJECT;
+        }
+
+    case 4: case 5: case 20: case 21:       /* BEQ, BNE, BEQL, BNEL */
+        *reads = rs | rt;
+        return IDLE_LOOP_INSTR_BRANCH;
+
+    case 6: case 7: case 22: case 23:       /* BLEZ, BGTZ, BLEZL, BGTZL */
+        *reads = rs;
+        return IDLE_LOOP_INSTR_BRANCH;
+
+    case 9: case 10: case 11:               /* ADDIU, SLTI, SLTIU */
+    case 12: case 13: case 14:              /* ANDI, ORI, XORI */
+    case 25:                                /* DADDIU */
+        *reads = rs;
+        *write = RT_OF(iw);
+        return IDLE_LOOP_INSTR_ALU;
+
+    case 15:                                /* LUI */
+        *write = RT_OF(iw);
+        return IDLE_LOOP_INSTR_ALU;
+
+    case 32: case 33: case 35:              /* LB, LH, LW */
+    case 36: case 37: case 39:              /* LBU, LHU, LWU */
+    case 55:                                /* LD */
+        *reads = rs;
+        *write = RT_OF(iw);
+        return IDLE_LOOP_INSTR_LOAD;
+
+    default:
+        return IDLE_LOOP_INSTR_REJECT;
+    }
+}
+
+int idle_loop_analyze(const uint32_t* iw, unsigned int length, uint32_t* loads)
+{
+    uint32_t reads[IDLE_LOOP_MAX_LENGTH];
+    unsigned int writes[IDLE_LOOP_MAX_LENGTH];
+    uint32_t written = 0, all_written = 0;
+    unsigned int i, j;
+
+    if (length < 2 || length > IDLE_LOOP_MAX_LENGTH) {
+        return 0;
+    }
+
+    *loads = 0;
+
+    for (i = 0; i < length; ++i)
+    {
+        enum idle_loop_instr_kind kind = idle_loop_decode(iw[i], &reads[i], &writes[i]);
+
+        /* the branch must be the one closing the loop, right before its delay slot */
+        if (kind == IDLE_LOOP_INSTR_REJECT
+         || (kind == IDLE_LOOP_INSTR_BRANCH) != (i == length - 2)) {
+            return 0;
+        }
+
+        if (kind == IDLE_LOOP_INSTR_LOAD) {
+            *loads |= UINT32_C(1) << i;
+        }
+
+        if (writes[i] != 0) {
+            all_written |= UINT32_C(1) << writes[i];
+        }
+    }
+
+    for (i = 0; i < length; ++i)
+    {
+        /* a register carried over from the previous iteration makes the
+         * loop state evolve (counters and the like) */
+        if (reads[i] & all_written & ~written) {
+            return 0;
+        }
+
+        if (writes[i] != 0) {
+            written |= UINT32_C(1) << writes[i];
+        }
+
+        /* load addresses get checked once the iteration is over, so the base
+         * register must still hold the value used by the load */
+        if (*loads & (UINT32_C(1) << i)) {
+            for (j = i + 1; j < length; ++j) {
+                if (writes[j] == RS_OF(iw[i])) {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+int idle_loop_is_stable_address(uint32_t address)
+{
+    /* only consider unmapped segments, TLB lookups are left to the loop itself */
+    if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
+        return 0;
+    }
+
+    address &= UINT32_C(0x1fffffff);
+
+    /* VI and AI registers (current line, remaining length) follow count
+     * directly and are deliberately left out, as are the cartridge save and
+     * 64DD domains */
+    return (address < MM_RDRAM_REGS)
+        || (address >= MM_RSP_MEM && address < MM_RSP_REGS2)
+        || (address >= MM_DPC_REGS && address < MM_VI_REGS)
+        || (address >= MM_PI_REGS && address < MM_RI_REGS)
+        || (address >= MM_SI_REGS && address < MM_DOM2_ADDR1)
+        || (address >= MM_CART_ROM && address < MM_PIF_MEM);
+}
+
+void idle_loop_taken(struct r4300_core* r4300, uint32_t branch, unsigned int length)
+{
+    struct idle_loop* loop = &r4300->idle_loop;
+    uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
+    const uint32_t next_interrupt = *r4300_cp0_next_interrupt(&r4300->cp0);
+    int skip;
+
+    cp0_update_count(r4300);
+
+    /* The previous iteration ran with nothing else in between (any
+     * interrupt or event would have added to count or moved next_interrupt),
+     * so every following one will do the same until the next event. */
+    if (loop->branch == branch
+     && loop->next_interrupt == next_interrupt
+     && cp0_regs[CP0_COUNT_REG] - loop->count == (length - 1) * r4300->cp0.count_per_op)
+    {
+        skip = next_interrupt - cp0_regs[CP0_COUNT_REG];
+        if (skip > 3) cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC));
+    }
+
+    loop->branch = branch;
+    loop->count = cp0_regs[CP0_COUNT_REG];
+    loop->next_interrupt = next_interrupt;
+}
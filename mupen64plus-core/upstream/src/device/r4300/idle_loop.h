@@ -0,0 +1,63 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_DEVICE_R4300_IDLE_LOOP_H
+#define M64P_DEVICE_R4300_IDLE_LOOP_H
+
+#include <stdint.h>
+
+struct r4300_core;
+
+/* Longest polling loop considered, in instructions (loop start to delay slot) */
+enum { IDLE_LOOP_MAX_LENGTH = 16 };
+
+/* Tracks the last taken loop branch so that a loop is only fast-forwarded
+ * once it has been seen completing a full iteration on its own. */
+struct idle_loop
+{
+    uint32_t branch;
+    uint32_t count;
+    uint32_t next_interrupt;
+
+    /* pure interpreter analysis cache */
+    uint32_t cached_branch;
+    uint32_t cached_iw;
+    uint32_t cached_loads;
+    int cached_idle;
+};
+
+/* Checks whether the instructions iw[0..length-1] form a polling loop: a
+ * backward branch in the second to last slot whose body only does register
+ * arithmetic and loads, and computes the same register state every iteration
+ * as long as the memory it reads doesn't change. On success, loads is set to
+ * the bitmask of load positions within the loop. */
+int idle_loop_analyze(const uint32_t* iw, unsigned int length, uint32_t* loads);
+
+/* Checks whether a load from a virtual address can only change when an
+ * interrupt queue event is processed. */
+int idle_loop_is_stable_address(uint32_t address);
+
+/* Called after the branch ending a polling loop was taken. Skips count
+ * forward to the next interrupt when the loop just ran a whole iteration
+ * without anything else happening. */
+void idle_loop_taken(struct r4300_core* r4300, uint32_t branch, unsigned int length);
+
+#endif /* M64P_DEVICE_R4300_IDLE_LOOP_H */
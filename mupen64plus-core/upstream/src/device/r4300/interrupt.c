@@ -34,6 +34,7 @@
 #include <string.h>
 
 #include "api/callbacks.h"
+#include "api/debugger.h"
 #include "api/m64p_types.h"
 #include "device/pif/bootrom_hle.h"
 #include "device/r4300/cached_interp.h"
@@ -44,58 +45,40 @@
 #include "device/rcp/ai/ai_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "main/main.h"
+#include "main/profile.h"
+#include "main/rewind.h"
+#include "main/runahead.h"
 #include "main/savestates.h"
 
 
 /***************************************************************************
- * Pool of Single Linked List Nodes
+ * Interrupt Queue
  **************************************************************************/
 
-static struct node* alloc_node(struct pool* p);
-static void free_node(struct pool* p, struct node* node);
-static void clear_pool(struct pool* p);
-
-
-/* node allocation/deallocation on a given pool */
-static struct node* alloc_node(struct pool* p)
+static void clear_queue(struct interrupt_queue* q)
 {
-    /* return NULL if pool is too small */
-    if (p->index >= INTERRUPT_NODES_POOL_CAPACITY) {
-        return NULL;
-    }
-
-    return p->stack[p->index++];
+    q->size = 0;
 }
 
-static void free_node(struct pool* p, struct node* node)
+/* insert event at position index, shifting later events */
+static int insert_event(struct interrupt_queue* q, size_t index, int type, unsigned int count)
 {
-    if (p->index == 0 || node == NULL) {
-        return;
+    if (q->size >= INTERRUPT_QUEUE_CAPACITY) {
+        return 0;
     }
 
-    p->stack[--p->index] = node;
-}
-
-/* release all nodes */
-static void clear_pool(struct pool* p)
-{
-    size_t i;
-
-    for (i = 0; i < INTERRUPT_NODES_POOL_CAPACITY; ++i) {
-        p->stack[i] = &p->nodes[i];
-    }
+    memmove(&q->events[index + 1], &q->events[index], (q->size - index) * sizeof(q->events[0]));
+    q->events[index].type = type;
+    q->events[index].count = count;
+    ++q->size;
 
-    p->index = 0;
+    return 1;
 }
 
-/***************************************************************************
- * Interrupt Queue
- **************************************************************************/
-
-static void clear_queue(struct interrupt_queue* q)
+static void delete_event(struct interrupt_queue* q, size_t index)
 {
-    q->first = NULL;
-    clear_pool(&q->pool);
+    --q->size;
+    memmove(&q->events[index], &q->events[index + 1], (q->size - index) * sizeof(q->events[0]));
 }
 
 static int before_event(const struct cp0* cp0, unsigned int evt1, unsigned int evt2, int type2)
@@ -152,8 +135,8 @@ void add_interrupt_event(struct cp0* cp0, int type, unsigned int delay)
 
 void add_interrupt_event_count(struct cp0* cp0, int type, unsigned int count)
 {
-    struct node* event;
-    struct node* e;
+    struct interrupt_queue* q = &cp0->q;
+    size_t e;
     int special;
     const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(cp0);
@@ -164,137 +147,97 @@ void add_interrupt_event_count(struct cp0* cp0, int type, unsigned int count)
         cp0->special_done = 0;
     }
 
-    if (get_event(&cp0->q, type)) {
+    if (get_event(q, type)) {
         DebugMessage(M64MSG_WARNING, "two events of type 0x%x in interrupt queue", type);
     }
 
-    event = alloc_node(&cp0->q.pool);
-    if (event == NULL)
+    if (q->size >= INTERRUPT_QUEUE_CAPACITY)
     {
-        DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
+        DebugMessage(M64MSG_ERROR, "Interrupt queue is full, can't add new interrupt event");
         return;
     }
 
-    event->data.count = count;
-    event->data.type = type;
-
-    if (cp0->q.first == NULL)
-    {
-        cp0->q.first = event;
-        event->next = NULL;
-        *cp0_next_interrupt = cp0->q.first->data.count;
-    }
-    else if (before_event(cp0, count, cp0->q.first->data.count, cp0->q.first->data.type) && !special)
+    if (q->size == 0
+    || (before_event(cp0, count, q->events[0].count, q->events[0].type) && !special))
     {
-        event->next = cp0->q.first;
-        cp0->q.first = event;
-        *cp0_next_interrupt = cp0->q.first->data.count;
+        insert_event(q, 0, type, count);
+        *cp0_next_interrupt = count;
     }
     else
     {
-        for (e = cp0->q.first;
-            e->next != NULL &&
-            (!before_event(cp0, count, e->next->data.count, e->next->data.type) || special);
-            e = e->next);
+        /* special events always go last, others go after the events
+         * which trigger before or at the same time */
+        for (e = 1;
+            e < q->size &&
+            (!before_event(cp0, count, q->events[e].count, q->events[e].type) || special);
+            ++e);
 
-        if (e->next == NULL)
-        {
-            e->next = event;
-            event->next = NULL;
-        }
-        else
-        {
-            if (!special)
-                for(; e->next != NULL && e->next->data.count == count; e = e->next);
+        if (!special)
+            for (; e < q->size && q->events[e].count == count; ++e);
 
-            event->next = e->next;
-            e->next = event;
-        }
+        insert_event(q, e, type, count);
     }
 }
 
 static void remove_interrupt_event(struct cp0* cp0)
 {
-    struct node* e;
+    struct interrupt_queue* q = &cp0->q;
     const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
     uint32_t count = cp0_regs[CP0_COUNT_REG];
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(cp0);
 
-    e = cp0->q.first;
-    cp0->q.first = e->next;
-    free_node(&cp0->q.pool, e);
+    delete_event(q, 0);
 
-    *cp0_next_interrupt = (cp0->q.first != NULL
-         && (cp0->q.first->data.count > count
-         || (count - cp0->q.first->data.count) < UINT32_C(0x80000000)))
-        ? cp0->q.first->data.count
+    *cp0_next_interrupt = (q->size != 0
+         && (q->events[0].count > count
+         || (count - q->events[0].count) < UINT32_C(0x80000000)))
+        ? q->events[0].count
         : 0;
 }
 
 unsigned int get_event(const struct interrupt_queue* q, int type)
 {
-    const struct node* e = q->first;
+    size_t e;
 
-    if (e == NULL) {
-        return 0;
-    }
-
-    if (e->data.type == type) {
-        return e->data.count;
+    for (e = 0; e < q->size; ++e) {
+        if (q->events[e].type == type) {
+            return q->events[e].count;
+        }
     }
 
-    for (; e->next != NULL && e->next->data.type != type; e = e->next);
-
-    return (e->next != NULL)
-        ? e->next->data.count
-        : 0;
+    return 0;
 }
 
 int get_next_event_type(const struct interrupt_queue* q)
 {
-    return (q->first == NULL)
+    return (q->size == 0)
         ? 0
-        : q->first->data.type;
+        : q->events[0].type;
 }
 
 void remove_event(struct interrupt_queue* q, int type)
 {
-    struct node* to_del;
-    struct node* e = q->first;
-
-    if (e == NULL) {
-        return;
-    }
-
-    if (e->data.type == type)
-    {
-        q->first = e->next;
-        free_node(&q->pool, e);
-    }
-    else
-    {
-        for (; e->next != NULL && e->next->data.type != type; e = e->next);
+    size_t e;
 
-        if (e->next != NULL)
-        {
-            to_del = e->next;
-            e->next = to_del->next;
-            free_node(&q->pool, to_del);
+    for (e = 0; e < q->size; ++e) {
+        if (q->events[e].type == type) {
+            delete_event(q, e);
+            return;
         }
     }
 }
 
 void translate_event_queue(struct cp0* cp0, unsigned int base)
 {
-    struct node* e;
+    size_t e;
     const uint32_t* cp0_regs = r4300_cp0_regs(cp0);
 
     remove_event(&cp0->q, COMPARE_INT);
     remove_event(&cp0->q, SPECIAL_INT);
 
-    for (e = cp0->q.first; e != NULL; e = e->next)
+    for (e = 0; e < cp0->q.size; ++e)
     {
-        e->data.count = (e->data.count - cp0_regs[CP0_COUNT_REG]) + base;
+        cp0->q.events[e].count = (cp0->q.events[e].count - cp0_regs[CP0_COUNT_REG]) + base;
     }
     add_interrupt_event_count(cp0, COMPARE_INT, cp0_regs[CP0_COMPARE_REG]);
     add_interrupt_event_count(cp0, SPECIAL_INT, 0);
@@ -303,14 +246,14 @@ void translate_event_queue(struct cp0* cp0, unsigned int base)
 int save_eventqueue_infos(const struct cp0* cp0, char *buf)
 {
     int len;
-    struct node* e;
+    size_t e;
 
     len = 0;
 
-    for (e = cp0->q.first; e != NULL; e = e->next)
+    for (e = 0; e < cp0->q.size; ++e)
     {
-        memcpy(buf + len    , &e->data.type , 4);
-        memcpy(buf + len + 4, &e->data.count, 4);
+        memcpy(buf + len    , &cp0->q.events[e].type , 4);
+        memcpy(buf + len + 4, &cp0->q.events[e].count, 4);
         len += 8;
     }
 
@@ -343,7 +286,6 @@ void init_interrupt(struct cp0* cp0)
 
 void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_cause)
 {
-    struct node* event;
     uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(&r4300->cp0);
 
@@ -359,28 +301,13 @@ void r4300_check_interrupt(struct r4300_core* r4300, uint32_t cause_ip, int set_
     }
     if (cp0_regs[CP0_STATUS_REG] & cp0_regs[CP0_CAUSE_REG] & UINT32_C(0xFF00))
     {
-        event = alloc_node(&r4300->cp0.q.pool);
-
-        if (event == NULL)
+        if (!insert_event(&r4300->cp0.q, 0, CHECK_INT, cp0_regs[CP0_COUNT_REG]))
         {
-            DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
+            DebugMessage(M64MSG_ERROR, "Interrupt queue is full, can't add new interrupt event");
             return;
         }
 
-        event->data.count = *cp0_next_interrupt = cp0_regs[CP0_COUNT_REG];
-        event->data.type = CHECK_INT;
-
-        if (r4300->cp0.q.first == NULL)
-        {
-            r4300->cp0.q.first = event;
-            event->next = NULL;
-        }
-        else
-        {
-            event->next = r4300->cp0.q.first;
-            r4300->cp0.q.first = event;
-
-        }
+        *cp0_next_interrupt = cp0_regs[CP0_COUNT_REG];
     }
 }
 
@@ -521,11 +448,24 @@ void gen_interrupt(struct r4300_core* r4300)
         if (savestates_get_job() == savestates_job_load)
         {
             savestates_load();
+            runahead_reset();
+            return;
+        }
+
+        if (rewind_restore_pending())
+        {
+            runahead_reset();
+            return;
+        }
+
+        if (runahead_restore_pending())
+        {
             return;
         }
 
         if (r4300->reset_hard_job)
         {
+            runahead_reset();
             call_interrupt_handler(&r4300->cp0, 11);
             return;
         }
@@ -536,9 +476,9 @@ void gen_interrupt(struct r4300_core* r4300)
         uint32_t dest = r4300->skip_jump;
         r4300->skip_jump = 0;
 
-        *cp0_next_interrupt = (r4300->cp0.q.first->data.count > cp0_regs[CP0_COUNT_REG]
-                || (cp0_regs[CP0_COUNT_REG] - r4300->cp0.q.first->data.count) < UINT32_C(0x80000000))
-            ? r4300->cp0.q.first->data.count
+        *cp0_next_interrupt = (r4300->cp0.q.events[0].count > cp0_regs[CP0_COUNT_REG]
+                || (cp0_regs[CP0_COUNT_REG] - r4300->cp0.q.events[0].count) < UINT32_C(0x80000000))
+            ? r4300->cp0.q.events[0].count
             : 0;
 
         r4300->cp0.last_addr = dest;
@@ -546,7 +486,13 @@ void gen_interrupt(struct r4300_core* r4300)
         return;
     }
 
-    switch (r4300->cp0.q.first->data.type)
+    /* every emulator reaches this point at the same Count with its live
+     * registers written back, which makes it the place to compare two of them */
+    CoreLockstepCallback(r4300->cp0.q.events[0].type);
+
+    timed_section_start(TIMED_SECTION_INTERRUPT);
+
+    switch (r4300->cp0.q.events[0].type)
     {
         case VI_INT:
             remove_interrupt_event(&r4300->cp0);
@@ -603,19 +549,25 @@ void gen_interrupt(struct r4300_core* r4300)
             break;
 
         default:
-            DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", r4300->cp0.q.first->data.type);
+            DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", r4300->cp0.q.events[0].type);
             remove_interrupt_event(&r4300->cp0);
             exception_general(r4300);
             break;
     }
 
+    timed_section_end(TIMED_SECTION_INTERRUPT);
+
     if (!r4300->cp0.interrupt_unsafe_state)
     {
-        if (savestates_get_job() == savestates_job_save)
+        /* only states of the real timeline are saved */
+        if (savestates_get_job() == savestates_job_save && !runahead_is_ahead())
         {
             savestates_save();
             return;
         }
+
+        rewind_capture_pending();
+        runahead_capture_pending();
     }
 }
 
@@ -67,7 +67,6 @@ void write_dword_new(int pcaddr, int count, int diff);
 
 static void *dyna_linker(void * src, u_int vaddr);
 static void *dyna_linker_ds(void * src, u_int vaddr);
-static void invalidate_addr(u_int addr);
 
 static u_int literals[1024][2];
 static unsigned int needs_clear_cache[1<<(TARGET_SIZE_2-17)];
@@ -2425,6 +2424,18 @@ static void emit_ftosizd(int s,int d)
   output_w32(0xeebd0bc0|((d&14)<<11)|((d&1)<<22)|(s&7));
 } 
 
+static void emit_ftosis(int s,int d)
+{
+  assem_debug("ftosis s%d,s%d",d,s);
+  output_w32(0xeebd0a40|((d&14)<<11)|((d&1)<<22)|((s&14)>>1)|((s&1)<<5));
+} 
+
+static void emit_ftosid(int s,int d)
+{
+  assem_debug("ftosid s%d,d%d",d,s);
+  output_w32(0xeebd0b40|((d&14)<<11)|((d&1)<<22)|(s&7));
+} 
+
 static void emit_fsitos(int s,int d)
 {
   assem_debug("fsitos s%d,s%d",d,s);
@@ -2551,6 +2562,18 @@ static void emit_fmstat(void)
   output_w32(0xeef1fa10);
 } 
 
+static void emit_fmrx_fpscr(int rt)
+{
+  assem_debug("fmrx %s,fpscr",regname[rt]);
+  output_w32(0xeef10a10|(rt<<12));
+} 
+
+static void emit_fmxr_fpscr(int rs)
+{
+  assem_debug("fmxr fpscr,%s",regname[rs]);
+  output_w32(0xeee10a10|(rs<<12));
+} 
+
 static void emit_bicne_imm(int rs,int imm,int rt)
 {
   u_int armval, ret;
@@ -3724,6 +3747,29 @@ static void fconv_assemble_arm(int i,struct regstat *i_regs)
     emit_fsts(13,temp);
     return;
   }
+
+  if((opcode2[i]==0x10||opcode2[i]==0x11)&&((source[i]&0x3f)==0x0c||(source[i]&0x3f)==0x0e||(source[i]&0x3f)==0x0f)) { // round/ceil/floor_w_s/d
+    // Convert with the rounding mode of the instruction, then restore fpscr
+    if(opcode2[i]==0x10) {
+      emit_readword((u_int)&g_dev.r4300.new_dynarec_hot_state.cp1_regs_simple[(source[i]>>11)&0x1f],temp);
+      emit_flds(temp,15);
+    }else{
+      emit_readword((u_int)&g_dev.r4300.new_dynarec_hot_state.cp1_regs_double[(source[i]>>11)&0x1f],temp);
+      emit_vldr(temp,7);
+    }
+    emit_fmrx_fpscr(temp);
+    emit_andimm(temp,~(0x3<<22),HOST_TEMPREG);
+    emit_orimm(HOST_TEMPREG,g_dev.r4300.new_dynarec_hot_state.rounding_modes[source[i]&3],HOST_TEMPREG);
+    emit_fmxr_fpscr(HOST_TEMPREG);
+    if(opcode2[i]==0x10)
+      emit_ftosis(15,15);
+    else
+      emit_ftosid(7,15);
+    emit_fmxr_fpscr(temp);
+    emit_readword((u_int)&g_dev.r4300.new_dynarec_hot_state.cp1_regs_simple[(source[i]>>6)&0x1f],temp);
+    emit_fsts(15,temp);
+    return;
+  }
   #endif
   
   // C emulation code
@@ -4722,11 +4768,6 @@ static void do_clear_cache(void)
   }
 }
 
-static void invalidate_addr(u_int addr)
-{
-  invalidate_block(addr>>12);
-}
-
 // CPU-architecture-specific initialization
 static void arch_init(void) {
 
@@ -44,6 +44,10 @@
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rsp/rsp_core.h"
 
+#ifdef PROFILE_BLOCKS
+#include "device/r4300/block_profiler.h"
+#endif
+
 #if !defined(WIN32)
 #include <sys/mman.h>
 #endif
@@ -194,6 +198,7 @@ static void TLBWR_new(void);
 
 int new_recompile_block(int addr);
 void invalidate_block(u_int block);
+void invalidate_addr(u_int addr);
 void *get_addr_ht(u_int vaddr);
 
 static void wb_register(signed char r,signed char regmap[],uint64_t dirty,uint64_t is32);
@@ -262,6 +267,9 @@ static u_int hash_table[65536][4];
 static struct ll_entry *jump_in[4096];
 static struct ll_entry *jump_dirty[4096];
 static struct ll_entry *jump_out[4096];
+// For each RDRAM page of jump_in, one bit per 64-byte line holding compiled code.
+// Writes to other lines of a protected page don't need to invalidate anything.
+static uint64_t code_lines[2048];
 
 #if COUNT_NOTCOMPILEDS
 static int notcompiledCount = 0;
@@ -1963,6 +1971,9 @@ void *get_addr(u_int vaddr)
   if(vpage>262143&&r4300->cp0.tlb.LUT_r[vaddr>>12]) vpage&=2047; // jump_dirty uses a hash of the virtual address instead
   if(vpage>2048) vpage=2048+(vpage&2047);
   struct ll_entry *head;
+#ifdef PROFILE_BLOCKS
+  block_profiler_enter(vaddr,r4300_cp0_regs(&r4300->cp0)[CP0_COUNT_REG]);
+#endif
   //DebugMessage(M64MSG_VERBOSE, "TRACE: count=%d next=%d (get_addr %x,page %d)",r4300_cp0_regs(&g_dev.r4300.cp0)[CP0_COUNT_REG],g_dev.r4300.cp0.next_interrupt,vaddr,page);
   head=jump_in[page];
   while(head!=NULL) {
@@ -2027,6 +2038,10 @@ void *get_addr_ht(u_int vaddr)
 {
   //DebugMessage(M64MSG_VERBOSE, "TRACE: count=%d next=%d (get_addr_ht %x)",r4300_cp0_regs(&g_dev.r4300.cp0)[CP0_COUNT_REG],g_dev.r4300.cp0.next_interrupt,vaddr);
   u_int *ht_bin=hash_table[((vaddr>>16)^vaddr)&0xFFFF];
+#ifdef PROFILE_BLOCKS
+  if(ht_bin[0]==vaddr||ht_bin[2]==vaddr)
+    block_profiler_enter(vaddr,r4300_cp0_regs(&g_dev.r4300.cp0)[CP0_COUNT_REG]);
+#endif
   if(ht_bin[0]==vaddr) return (void *)ht_bin[1];
   if(ht_bin[2]==vaddr) return (void *)ht_bin[3];
   return get_addr(vaddr);
@@ -2165,6 +2180,33 @@ static void *check_addr(u_int vaddr)
   return 0;
 }
 
+// Mark the 64-byte lines holding MIPS code between host addresses start and end
+static void mark_code_lines(u_int start,u_int end)
+{
+  u_int offset;
+  if(start-(u_int)g_dev.rdram.dram>=0x800000) return;
+  for(offset=start-(u_int)g_dev.rdram.dram;offset<end-(u_int)g_dev.rdram.dram;offset=(offset|63)+1) {
+    if(offset>=0x800000) break;
+    code_lines[offset>>12]|=UINT64_C(1)<<((offset>>6)&63);
+  }
+}
+
+// Returns non-zero if [addr,addr+size) may overlap compiled code in the
+// jump_in page of addr. Pages outside RDRAM are not tracked.
+static int code_in_range(u_int addr,u_int size)
+{
+  u_int block=addr>>12;
+  u_int page=block^0x80000;
+  u_int first,last;
+  uint64_t mask;
+  if(page>262143&&g_dev.r4300.cp0.tlb.LUT_r[block]) page=(g_dev.r4300.cp0.tlb.LUT_r[block]^0x80000000)>>12;
+  if(page>=2048) return 1;
+  first=(addr>>6)&63;
+  last=(size>=0x1000-(addr&0xfff))?63:((addr+size-1)>>6)&63;
+  mask=(last==63?~UINT64_C(0):((UINT64_C(1)<<(last+1))-1))&~((UINT64_C(1)<<first)-1);
+  return (code_lines[page]&mask)!=0;
+}
+
 // This is called when we write to a compiled block (see do_invstub)
 static void invalidate_page(u_int page)
 {
@@ -2172,6 +2214,7 @@ static void invalidate_page(u_int page)
   struct ll_entry *next;
   head=jump_in[page];
   jump_in[page]=0;
+  if(page<2048) code_lines[page]=0;
   while(head!=NULL) {
     inv_debug("INVALIDATE: %x\n",head->vaddr);
     remove_hash(head->vaddr);
@@ -2204,6 +2247,9 @@ void invalidate_block(u_int block)
   if(vpage>262143&&g_dev.r4300.cp0.tlb.LUT_r[block]) vpage&=2047; // jump_dirty uses a hash of the virtual address instead
   if(vpage>2048) vpage=2048+(vpage&2047);
   inv_debug("INVALIDATE: %x (%d)\n",block<<12,page);
+#ifdef PROFILE_BLOCKS
+  block_profiler_invalidate(block<<12);
+#endif
   //inv_debug("invalid_code[block]=%d\n",g_dev.r4300.cached_interp.invalid_code[block]);
   u_int first,last;
   first=last=page;
@@ -2257,6 +2303,13 @@ void invalidate_block(u_int block)
   #endif
 }
 
+// Called by generated code on stores to pages holding compiled code.
+void invalidate_addr(u_int addr)
+{
+  if(!code_in_range(addr,4)) return;
+  invalidate_block(addr>>12);
+}
+
 // This is called when loading a save state.
 // Anything could have changed, so invalidate everything.
 static void invalidate_all_pages(void)
@@ -2308,7 +2361,11 @@ void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t addre
 
         for(i = begin; i <= end; ++i) {
             if(r4300->cached_interp.invalid_code[i] == 0) {
-                invalidate_block(i);
+                uint32_t page_begin = (i == begin) ? address : (uint32_t)(i << 12);
+                uint32_t page_end = (i == end) ? address+size : (uint32_t)((i+1) << 12);
+                if (code_in_range(page_begin, page_end - page_begin)) {
+                    invalidate_block(i);
+                }
             }
         }
     }
@@ -2355,6 +2412,7 @@ void clean_blocks(u_int page)
               //DebugMessage(M64MSG_VERBOSE, "page=%x, addr=%x",page,head->vaddr);
               //assert(head->vaddr>>12==(page|0x80000));
               ll_add_32(jump_in+ppage,head->vaddr,head->reg32,clean_addr);
+              mark_code_lines(start,end);
               u_int *ht_bin=hash_table[((head->vaddr>>16)^head->vaddr)&0xFFFF];
               if(!head->reg32) {
                 if(ht_bin[0]==head->vaddr) {
@@ -7601,6 +7659,7 @@ void new_dynarec_init(void)
     hash_table[n][0]=hash_table[n][2]=-1;
   memset(g_dev.r4300.new_dynarec_hot_state.mini_ht,-1,sizeof(g_dev.r4300.new_dynarec_hot_state.mini_ht));
   memset(g_dev.r4300.new_dynarec_hot_state.restore_candidate,0,sizeof(g_dev.r4300.new_dynarec_hot_state.restore_candidate));
+  memset(code_lines,0,sizeof(code_lines));
   copy_size=0;
   expirep=16384; // Expiry pointer, +2 blocks
   g_dev.r4300.new_dynarec_hot_state.pending_exception=0;
@@ -7645,6 +7704,9 @@ int new_recompile_block(int addr)
 #if COUNT_NOTCOMPILEDS
   notcompiledCount++;
   DebugMessage(M64MSG_VERBOSE, "notcompiledCount=%i", notcompiledCount );
+#endif
+#ifdef PROFILE_BLOCKS
+  block_profiler_compile((u_int)addr&~3);
 #endif
   start = (u_int)addr&~3;
   //assert(((u_int)addr&1)==0);
@@ -10838,6 +10900,7 @@ int new_recompile_block(int addr)
   #endif
   assert((u_int)out-beginning<MAX_OUTPUT_BLOCK_SIZE);
   memcpy(copy,(char*)source,slen*4);
+  mark_code_lines((u_int)source,(u_int)source+slen*4);
   u_int *ptr=(u_int*)copy;
   ptr[slen]=dirty_entry_count;
 
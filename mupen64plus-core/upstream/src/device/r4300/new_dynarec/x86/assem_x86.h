@@ -14,7 +14,13 @@
 
 #define USE_MINI_HT 1
 
+/* Code cache size can be raised at build time to expire blocks less often */
+#ifndef TARGET_SIZE_2
 #define TARGET_SIZE_2 25 // 2^25 = 32 megabytes
+#endif
+#if TARGET_SIZE_2 < 25 || TARGET_SIZE_2 > 28
+#error "TARGET_SIZE_2 must be between 25 (32MB) and 28 (256MB)"
+#endif
 #define JUMP_TABLE_SIZE 0 // Not needed for 32-bit x86
 
 /* x86 calling convention:
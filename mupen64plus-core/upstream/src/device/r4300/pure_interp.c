@@ -29,6 +29,7 @@
 #include "api/callbacks.h"
 #include "api/debugger.h"
 #include "api/m64p_types.h"
+#include "device/r4300/idle_loop.h"
 #include "device/r4300/r4300_core.h"
 #include "osal/preproc.h"
 
@@ -38,6 +39,7 @@
 
 
 static void InterpretOpcode(struct r4300_core* r4300);
+static void check_idle_loop(struct r4300_core* r4300, uint32_t branch, uint32_t target);
 
 #define DECLARE_R4300
 #define PCADDR r4300->interp_PC.addr
@@ -46,6 +48,7 @@ static void InterpretOpcode(struct r4300_core* r4300);
 #define DECLARE_JUMP(name, destination, condition, link, likely, cop1) \
    static void name(struct r4300_core* r4300, uint32_t op) \
    { \
+      const uint32_t branch_addr = r4300->interp_PC.addr; \
       const int take_jump = (condition); \
       const uint32_t jump_target = (destination); \
       int64_t *link_register = (link); \
@@ -72,6 +75,10 @@ static void InterpretOpcode(struct r4300_core* r4300);
          cp0_update_count(r4300); \
       } \
       r4300->cp0.last_addr = r4300->interp_PC.addr; \
+      if (take_jump && !cop1 && link_register == &r4300_regs(r4300)[0]) \
+      { \
+         check_idle_loop(r4300, branch_addr, jump_target); \
+      } \
       if (*r4300_cp0_next_interrupt(&r4300->cp0) <= r4300_cp0_regs(&r4300->cp0)[CP0_COUNT_REG]) gen_interrupt(r4300); \
    } \
    static void name##_IDLE(struct r4300_core* r4300, uint32_t op) \
@@ -713,6 +720,51 @@ void InterpretOpcode(struct r4300_core* r4300)
 	} /* switch ((op >> 26) & 0x3F) */
 }
 
+/* Called after a taken backward branch, fast-forwards polling loops the same
+ * way the cached interpreter does. The analysis of the last loop seen is
+ * cached since a spinning loop keeps hitting the same branch. */
+static void check_idle_loop(struct r4300_core* r4300, uint32_t branch, uint32_t target)
+{
+    struct idle_loop* loop = &r4300->idle_loop;
+    const uint32_t* iw;
+    uint32_t loads;
+    unsigned int length, i;
+
+    if (target > branch || r4300->interp_PC.addr != target) {
+        return;
+    }
+
+    /* the whole loop, delay slot included, has to sit in one page */
+    length = ((branch - target) >> 2) + 2;
+    if (length > IDLE_LOOP_MAX_LENGTH || (target >> 12) != ((branch + 4) >> 12)) {
+        return;
+    }
+
+    iw = fast_mem_access(r4300, target);
+    if (iw == NULL) {
+        return;
+    }
+
+    if (loop->cached_branch != branch || loop->cached_iw != iw[length - 2]) {
+        loop->cached_branch = branch;
+        loop->cached_iw = iw[length - 2];
+        loop->cached_idle = idle_loop_analyze(iw, length, &loop->cached_loads);
+    }
+
+    if (!loop->cached_idle) {
+        return;
+    }
+
+    for (i = 0, loads = loop->cached_loads; loads != 0; ++i, loads >>= 1)
+    {
+        if ((loads & 1) && !idle_loop_is_stable_address((uint32_t)(r4300_regs(r4300)[RS_OF(iw[i])] + IMM16S_OF(iw[i])))) {
+            return;
+        }
+    }
+
+    idle_loop_taken(r4300, branch, length);
+}
+
 void run_pure_interpreter(struct r4300_core* r4300)
 {
    *r4300_stop(r4300) = 0;
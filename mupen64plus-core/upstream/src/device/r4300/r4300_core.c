@@ -78,6 +78,7 @@ void poweron_r4300(struct r4300_core* r4300)
     r4300->skip_jump = 0;
     r4300->reset_hard_job = 0;
 
+    memset(&r4300->idle_loop, 0, sizeof(r4300->idle_loop));
 
     /* recomp init */
 #ifndef NEW_DYNAREC
@@ -151,6 +152,8 @@ void run_r4300(struct r4300_core* r4300)
         r4300->cached_interp.init_block = dynarec_init_block;
         r4300->cached_interp.free_block = dynarec_free_block;
         r4300->cached_interp.recompile_block = dynarec_recompile_block;
+        r4300->cached_interp.arena.alloc_chunk = malloc_exec;
+        r4300->cached_interp.arena.free_chunk = free_exec;
 
         init_blocks(&r4300->cached_interp);
         dyna_start(dynarec_setup_code);
@@ -172,6 +175,8 @@ void run_r4300(struct r4300_core* r4300)
         r4300->cached_interp.init_block = cached_interp_init_block;
         r4300->cached_interp.free_block = cached_interp_free_block;
         r4300->cached_interp.recompile_block = cached_interp_recompile_block;
+        r4300->cached_interp.arena.alloc_chunk = cached_interp_alloc_chunk;
+        r4300->cached_interp.arena.free_chunk = cached_interp_free_chunk;
 
         init_blocks(&r4300->cached_interp);
         cached_interpreter_jump_to(r4300, UINT32_C(0xa4000040));
@@ -274,6 +279,10 @@ uint32_t *fast_mem_access(struct r4300_core* r4300, uint32_t address)
      * Removing error checking saves some time, but the emulator may crash. */
 
     if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
+        const struct tlb_host_entry* e = tlb_lookup_host(r4300->cp0.tlb.host_r, address);
+        if (e != NULL)
+            return tlb_host_word(e, address);
+
         address = virtual_to_physical_address(r4300, address, 2);
         if (address == 0) // TLB exception
             return NULL;
@@ -291,6 +300,12 @@ uint32_t *fast_mem_access(struct r4300_core* r4300, uint32_t address)
 int r4300_read_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_t* value)
 {
     if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
+        const struct tlb_host_entry* e = tlb_lookup_host(r4300->cp0.tlb.host_r, address);
+        if (e != NULL) {
+            *value = *tlb_host_word(e, address);
+            return 1;
+        }
+
         address = virtual_to_physical_address(r4300, address, 0);
         if (address == 0) {
             return 0;
@@ -299,6 +314,12 @@ int r4300_read_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_t
 
     address &= UINT32_C(0x1ffffffc);
 
+    const uint32_t* direct = mem_get_direct(r4300->mem, address);
+    if (direct != NULL) {
+        *value = *direct;
+        return 1;
+    }
+
     mem_read32(mem_get_handler(r4300->mem, address), address & ~UINT32_C(3), value);
 
     return 1;
@@ -317,6 +338,13 @@ int r4300_read_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_
     }
 
     if ((address & UINT32_C(0xc0000000)) != UINT32_C(0x80000000)) {
+        const struct tlb_host_entry* e = tlb_lookup_host(r4300->cp0.tlb.host_r, address);
+        if (e != NULL) {
+            const uint32_t* host = tlb_host_word(e, address);
+            *value = ((uint64_t)host[0] << 32) | host[1];
+            return 1;
+        }
+
         address = virtual_to_physical_address(r4300, address, 0);
         if (address == 0) {
             return 0;
@@ -325,6 +353,12 @@ int r4300_read_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64_
 
     address &= UINT32_C(0x1ffffffc);
 
+    const uint32_t* direct = mem_get_direct(r4300->mem, address);
+    if (direct != NULL) {
+        *value = ((uint64_t)direct[0] << 32) | direct[1];
+        return 1;
+    }
+
     const struct mem_handler* handler = mem_get_handler(r4300->mem, address);
     mem_read32(handler, address + 0, &w[0]);
     mem_read32(handler, address + 4, &w[1]);
@@ -344,6 +378,14 @@ int r4300_write_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_
 
         invalidate_r4300_cached_code(r4300, address, 4);
 
+        const struct tlb_host_entry* e = tlb_lookup_host(r4300->cp0.tlb.host_w, address);
+        if (e != NULL) {
+            invalidate_r4300_cached_code(r4300, e->ppage | (address & UINT32_C(0xfff)), 4);
+            mark_rdram_written(r4300->rdram, tlb_host_rdram_address(e, address), 4);
+            masked_write(tlb_host_word(e, address), value, mask);
+            return 1;
+        }
+
         address = virtual_to_physical_address(r4300, address, 1);
         if (address == 0) {
             return 0;
@@ -354,6 +396,13 @@ int r4300_write_aligned_word(struct r4300_core* r4300, uint32_t address, uint32_
 
     address &= UINT32_C(0x1ffffffc);
 
+    uint32_t* direct = mem_get_direct(r4300->mem, address);
+    if (direct != NULL) {
+        mark_rdram_written(r4300->rdram, address, 4);
+        masked_write(direct, value, mask);
+        return 1;
+    }
+
     mem_write32(mem_get_handler(r4300->mem, address), address & ~UINT32_C(3), value, mask);
 
     return 1;
@@ -373,6 +422,16 @@ int r4300_write_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64
 
         invalidate_r4300_cached_code(r4300, address, 8);
 
+        const struct tlb_host_entry* e = tlb_lookup_host(r4300->cp0.tlb.host_w, address);
+        if (e != NULL) {
+            uint32_t* host = tlb_host_word(e, address);
+            invalidate_r4300_cached_code(r4300, e->ppage | (address & UINT32_C(0xfff)), 8);
+            mark_rdram_written(r4300->rdram, tlb_host_rdram_address(e, address), 8);
+            masked_write(&host[0], value >> 32, mask >> 32);
+            masked_write(&host[1], value      , mask      );
+            return 1;
+        }
+
         address = virtual_to_physical_address(r4300, address, 1);
         if (address == 0) {
             return 0;
@@ -383,6 +442,14 @@ int r4300_write_aligned_dword(struct r4300_core* r4300, uint32_t address, uint64
 
     address &= UINT32_C(0x1ffffffc);
 
+    uint32_t* direct = mem_get_direct(r4300->mem, address);
+    if (direct != NULL) {
+        mark_rdram_written(r4300->rdram, address, 8);
+        masked_write(&direct[0], value >> 32, mask >> 32);
+        masked_write(&direct[1], value      , mask      );
+        return 1;
+    }
+
     const struct mem_handler* handler = mem_get_handler(r4300->mem, address);
     mem_write32(handler, address + 0, value >> 32, mask >> 32);
     mem_write32(handler, address + 4, value      , mask      );
@@ -31,6 +31,7 @@
 
 #include "cp0.h"
 #include "cp1.h"
+#include "idle_loop.h"
 
 #include "recomp_types.h" /* for precomp_instr, regcache_state */
 
@@ -48,6 +49,7 @@ struct cached_interp
     char invalid_code[0x100000];
     struct precomp_block* blocks[0x100000];
     struct precomp_block* actual;
+    struct block_arena arena;
 
     void (*fin_block)(void);
     void (*not_compiled)(void);
@@ -93,6 +95,9 @@ struct r4300_core
     /* from pure_interp.c */
     struct precomp_instr interp_PC;
 
+    /* from idle_loop.c */
+    struct idle_loop idle_loop;
+
     /* from cached_interp.c.
      * XXX: more work is needed to correctly encapsulate these */
     struct cached_interp cached_interp;
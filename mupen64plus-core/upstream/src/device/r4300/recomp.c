@@ -43,9 +43,7 @@
 #include "device/r4300/recomp_types.h"
 #include "device/r4300/tlb.h"
 #include "main/main.h"
-#if defined(PROFILE)
 #include "main/profile.h"
-#endif
 
 #if defined(__x86_64__)
   #include "x86_64/regcache.h"
@@ -53,9 +51,6 @@
   #include "x86/regcache.h"
 #endif
 
-static void *malloc_exec(size_t size);
-static void free_exec(void *ptr, size_t length);
-
 /* defined in <arch>/assemble.c */
 void init_assembler(struct r4300_core* r4300, void *block_jumps_table, int block_jumps_number, void *block_riprel_table, int block_riprel_number);
 void free_assembler(struct r4300_core* r4300, void **block_jumps_table, int *block_jumps_number, void **block_riprel_table, int *block_riprel_number);
@@ -451,15 +446,18 @@ static void (*const recomp_funcs[R4300_OPCODES_COUNT])(struct r4300_core* r4300)
 void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
 {
     int i, length, already_exist = 1;
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_COMPILER);
-#endif
 
     struct precomp_block** block = &r4300->cached_interp.blocks[address >> 12];
 
     /* allocate block */
     if (*block == NULL) {
-        *block = malloc(sizeof(struct precomp_block));
+        *block = block_arena_alloc(&r4300->cached_interp.arena, sizeof(struct precomp_block));
+        if (*block == NULL) {
+            DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate executable memory for dynamic recompiler. Try to use an interpreter mode.");
+            timed_section_end(TIMED_SECTION_COMPILER);
+            return;
+        }
         (*block)->block = NULL;
         (*block)->start = address & ~UINT32_C(0xfff);
         (*block)->end = (address & ~UINT32_C(0xfff)) + 0x1000;
@@ -480,7 +478,7 @@ void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
     if (!b->block)
     {
         size_t memsize = get_block_memsize(b);
-        b->block = (struct precomp_instr *) malloc_exec(memsize);
+        b->block = (struct precomp_instr *) block_arena_alloc(&r4300->cached_interp.arena, memsize);
         if (!b->block) {
             DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate executable memory for dynamic recompiler. Try to use an interpreter mode.");
             return;
@@ -498,7 +496,7 @@ void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
 #else
         r4300->recomp.max_code_length = 32768;
 #endif
-        b->code = (unsigned char *) malloc_exec(r4300->recomp.max_code_length);
+        b->code = (unsigned char *) block_arena_alloc(&r4300->cached_interp.arena, r4300->recomp.max_code_length);
     }
     else
     {
@@ -596,17 +594,14 @@ void dynarec_init_block(struct r4300_core* r4300, uint32_t address)
             dynarec_init_block(r4300, alt_addr);
         }
     }
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_COMPILER);
-#endif
 }
 
 void dynarec_free_block(struct precomp_block* block)
 {
-    size_t memsize = get_block_memsize(block);
-
-    if (block->block) { free_exec(block->block, memsize); block->block = NULL; }
-    if (block->code) { free_exec(block->code, block->max_code_length); block->code = NULL; }
+    /* block instructions and code are given back with the arena */
+    block->block = NULL;
+    block->code = NULL;
     if (block->jumps_table) { free(block->jumps_table); block->jumps_table = NULL; }
     if (block->riprel_table) { free(block->riprel_table); block->riprel_table = NULL; }
 }
@@ -623,9 +618,7 @@ void dynarec_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struc
     int block_start_in_tlb = ((block->start & UINT32_C(0xc0000000)) != UINT32_C(0x80000000));
     int block_not_in_tlb = (block->start >= UINT32_C(0xc0000000) || block->end < UINT32_C(0x80000000));
 
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_COMPILER);
-#endif
 
     length = get_block_length(block);
     length2 = length - 2 + (length >> 2);
@@ -753,9 +746,7 @@ void dynarec_recompile_block(struct r4300_core* r4300, const uint32_t* iw, struc
     r4300->recomp.pfProfile = NULL;
 #endif
 
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_COMPILER);
-#endif
 }
 
 /**********************************************************************
@@ -987,7 +978,7 @@ int dynarec_write_aligned_dword(void)
 /**********************************************************************
  ************** allocate memory with executable bit set ***************
  **********************************************************************/
-static void *malloc_exec(size_t size)
+void *malloc_exec(size_t size)
 {
 #if defined(WIN32)
     return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
@@ -1012,9 +1003,9 @@ static void *malloc_exec(size_t size)
 /**********************************************************************
  ************* reallocate memory with executable bit set **************
  **********************************************************************/
-void *realloc_exec(void *ptr, size_t oldsize, size_t newsize)
+void *realloc_exec(struct block_arena* arena, void *ptr, size_t oldsize, size_t newsize)
 {
-    void* block = malloc_exec(newsize);
+    void* block = block_arena_alloc(arena, newsize);
     if (block != NULL)
     {
         size_t copysize;
@@ -1023,14 +1014,14 @@ void *realloc_exec(void *ptr, size_t oldsize, size_t newsize)
             : newsize;
         memcpy(block, ptr, copysize);
     }
-    free_exec(ptr, oldsize);
+    block_arena_free(arena, ptr, oldsize);
     return block;
 }
 
 /**********************************************************************
  **************** frees memory with executable bit set ****************
  **********************************************************************/
-static void free_exec(void *ptr, size_t length)
+void free_exec(void *ptr, size_t length)
 {
 #if defined(WIN32)
     VirtualFree(ptr, 0, MEM_RELEASE);
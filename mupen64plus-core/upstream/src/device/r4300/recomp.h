@@ -27,6 +27,7 @@
 
 struct r4300_core;
 struct precomp_block;
+struct block_arena;
 
 void dynarec_init_block(struct r4300_core* r4300, uint32_t address);
 void dynarec_free_block(struct precomp_block* block);
@@ -35,7 +36,9 @@ void recompile_opcode(struct r4300_core* r4300);
 void dyna_jump(void);
 void dyna_start(void (*code)(void));
 void dyna_stop(struct r4300_core* r4300);
-void *realloc_exec(void *ptr, size_t oldsize, size_t newsize);
+void *malloc_exec(size_t size);
+void *realloc_exec(struct block_arena* arena, void *ptr, size_t oldsize, size_t newsize);
+void free_exec(void *ptr, size_t length);
 
 void (*const recomp_ops[64])(struct r4300_core* r4300);
 
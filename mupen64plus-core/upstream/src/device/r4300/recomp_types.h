@@ -69,6 +69,13 @@ struct precomp_instr
     } f;
     uint32_t addr; /* word-aligned instruction address in r4300 address space */
 
+    /* these fields are cached interpreter specific */
+    void (*idle_ops)(void); /* original branch handler of a polling loop */
+    uint32_t idle_loads; /* bitmask of loads in the polling loop, from loop start */
+#ifdef DBG
+    void (*debug_ops)(void); /* original handler of an instruction with an execution breakpoint */
+#endif
+
     /* these fields are recomp specific */
     unsigned int local_addr; /* byte offset to start of corresponding x86_64 instructions, from start of code block */
     struct reg_cache reg_cache_infos;
@@ -91,5 +98,17 @@ struct precomp_block
     unsigned int xxhash;
 };
 
+/* Precomp blocks, their instructions and their recompiled code are carved out
+ * of large chunks instead of being allocated one guest page at a time.
+ * Memory only goes back to the system when the whole arena is released. */
+struct block_arena
+{
+    void* (*alloc_chunk)(size_t size);
+    void (*free_chunk)(void* ptr, size_t size);
+
+    struct block_arena_chunk* chunks;
+    struct block_arena_free* free_list;
+};
+
 #endif /* M64P_DEVICE_R4300_RECOMP_TYPES_H */
 
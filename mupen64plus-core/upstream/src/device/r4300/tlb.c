@@ -22,6 +22,7 @@
 #include "tlb.h"
 
 #include "api/m64p_types.h"
+#include "device/memory/memory.h"
 #include "device/r4300/r4300_core.h"
 #include "device/rdram/rdram.h"
 
@@ -34,6 +35,34 @@ void poweron_tlb(struct tlb* tlb)
     memset(tlb->entries, 0, 32 * sizeof(tlb->entries[0]));
     memset(tlb->LUT_r, 0, 0x100000 * sizeof(tlb->LUT_r[0]));
     memset(tlb->LUT_w, 0, 0x100000 * sizeof(tlb->LUT_w[0]));
+    tlb_flush_host_cache(tlb);
+}
+
+void tlb_flush_host_cache(struct tlb* tlb)
+{
+    size_t i;
+
+    for (i = 0; i < TLB_HOST_CACHE_SIZE; ++i) {
+        tlb->host_r[i].vpage = TLB_HOST_INVALID;
+        tlb->host_w[i].vpage = TLB_HOST_INVALID;
+    }
+}
+
+static void fill_host_cache(struct tlb_host_entry* cache, const struct memory* mem, uint32_t address, uint32_t paddr)
+{
+#ifndef DBG
+    /* only RDRAM-like pages which don't need their handler are cached */
+    uint32_t* host = mem_get_direct(mem, paddr & UINT32_C(0x1ffff000));
+    if (host != NULL) {
+        struct tlb_host_entry* e = &cache[(address >> 12) & (TLB_HOST_CACHE_SIZE - 1)];
+        e->vpage = address >> 12;
+        e->ppage = paddr & UINT32_C(0xfffff000);
+        e->host = host;
+    }
+#else
+    /* breakpoints can revoke direct access at any time */
+    (void)cache; (void)mem; (void)address; (void)paddr;
+#endif
 }
 
 void tlb_unmap(struct tlb* tlb, size_t entry)
@@ -44,6 +73,8 @@ void tlb_unmap(struct tlb* tlb, size_t entry)
     assert(entry < 32);
     e = &tlb->entries[entry];
 
+    tlb_flush_host_cache(tlb);
+
     if (e->v_even)
     {
         for (i=e->start_even; i<e->end_even; i += 0x1000)
@@ -71,6 +102,8 @@ void tlb_map(struct tlb* tlb, size_t entry)
     assert(entry < 32);
     e = &tlb->entries[entry];
 
+    tlb_flush_host_cache(tlb);
+
     if (e->v_even)
     {
         if (e->start_even < e->end_even &&
@@ -102,8 +135,9 @@ void tlb_map(struct tlb* tlb, size_t entry)
 
 uint32_t virtual_to_physical_address(struct r4300_core* r4300, uint32_t address, int w)
 {
-    const struct tlb* tlb = &r4300->cp0.tlb;
+    struct tlb* tlb = &r4300->cp0.tlb;
     unsigned int addr = address >> 12;
+    uint32_t paddr;
 
 #ifdef NEW_DYNAREC
     if (r4300->emumode == EMUMODE_DYNAREC)
@@ -130,12 +164,20 @@ uint32_t virtual_to_physical_address(struct r4300_core* r4300, uint32_t address,
     if (w == 1)
     {
         if (tlb->LUT_w[addr])
-            return (tlb->LUT_w[addr] & UINT32_C(0xFFFFF000)) | (address & UINT32_C(0xFFF));
+        {
+            paddr = (tlb->LUT_w[addr] & UINT32_C(0xFFFFF000)) | (address & UINT32_C(0xFFF));
+            fill_host_cache(tlb->host_w, r4300->mem, address, paddr);
+            return paddr;
+        }
     }
     else
     {
         if (tlb->LUT_r[addr])
-            return (tlb->LUT_r[addr] & UINT32_C(0xFFFFF000)) | (address & UINT32_C(0xFFF));
+        {
+            paddr = (tlb->LUT_r[addr] & UINT32_C(0xFFFFF000)) | (address & UINT32_C(0xFFF));
+            fill_host_cache(tlb->host_r, r4300->mem, address, paddr);
+            return paddr;
+        }
     }
     //printf("tlb exception !!! @ %x, %x, add:%x\n", address, w, r4300->pc->addr);
     //getchar();
@@ -25,6 +25,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "osal/preproc.h"
+
 struct r4300_core;
 
 struct tlb_entry
@@ -52,11 +54,27 @@ struct tlb_entry
    unsigned int phys_odd;
 };
 
+enum { TLB_HOST_CACHE_SIZE = 256 };
+enum { TLB_HOST_INVALID = 0xffffffff };
+
+/* Translation of a mapped 4KB page to directly accessible host memory */
+struct tlb_host_entry
+{
+    uint32_t vpage;     /* virtual address >> 12, TLB_HOST_INVALID if unused */
+    uint32_t ppage;     /* physical page, as returned by virtual_to_physical_address */
+    uint32_t* host;
+};
+
 struct tlb
 {
     struct tlb_entry entries[32];
     uint32_t LUT_r[0x100000];
     uint32_t LUT_w[0x100000];
+
+    /* direct-mapped caches of the LUT_r and LUT_w hits,
+     * filled by virtual_to_physical_address */
+    struct tlb_host_entry host_r[TLB_HOST_CACHE_SIZE];
+    struct tlb_host_entry host_w[TLB_HOST_CACHE_SIZE];
 };
 
 void poweron_tlb(struct tlb* tlb);
@@ -64,6 +82,28 @@ void poweron_tlb(struct tlb* tlb);
 void tlb_unmap(struct tlb* tlb, size_t entry);
 void tlb_map(struct tlb* tlb, size_t entry);
 
+/* Must be called whenever the LUTs or the memory direct pointers change */
+void tlb_flush_host_cache(struct tlb* tlb);
+
 uint32_t virtual_to_physical_address(struct r4300_core* r4300, uint32_t address, int w);
 
+/* Returns the cached translation of address from host_r or host_w,
+ * or NULL if it has to go through virtual_to_physical_address */
+static osal_inline const struct tlb_host_entry* tlb_lookup_host(const struct tlb_host_entry* cache, uint32_t address)
+{
+    const struct tlb_host_entry* e = &cache[(address >> 12) & (TLB_HOST_CACHE_SIZE - 1)];
+    return (e->vpage == (address >> 12)) ? e : NULL;
+}
+
+static osal_inline uint32_t* tlb_host_word(const struct tlb_host_entry* e, uint32_t address)
+{
+    return &e->host[(address & UINT32_C(0xffc)) >> 2];
+}
+
+/* ppage has the kseg0 bit set, this is the RDRAM offset of the word at address */
+static osal_inline uint32_t tlb_host_rdram_address(const struct tlb_host_entry* e, uint32_t address)
+{
+    return (e->ppage & UINT32_C(0x1ffff000)) | (address & UINT32_C(0xffc));
+}
+
 #endif /* M64P_DEVICE_R4300_TLB_H */
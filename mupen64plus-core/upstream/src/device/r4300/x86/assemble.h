@@ -74,7 +74,7 @@ static osal_inline void put8(unsigned char octet)
     r4300->recomp.code_length++;
     if (r4300->recomp.code_length == r4300->recomp.max_code_length)
     {
-        *r4300->recomp.inst_pointer = (unsigned char *) realloc_exec(*r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
+        *r4300->recomp.inst_pointer = (unsigned char *) realloc_exec(&r4300->cached_interp.arena, *r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
         r4300->recomp.max_code_length += 8192;
     }
 }
@@ -85,7 +85,7 @@ static osal_inline void put32(unsigned int dword)
 
     if ((r4300->recomp.code_length+4) >= r4300->recomp.max_code_length)
     {
-        *r4300->recomp.inst_pointer = (unsigned char *) realloc_exec(*r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
+        *r4300->recomp.inst_pointer = (unsigned char *) realloc_exec(&r4300->cached_interp.arena, *r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
         r4300->recomp.max_code_length += 8192;
     }
     *((unsigned int *)(&(*r4300->recomp.inst_pointer)[r4300->recomp.code_length])) = dword;
@@ -85,7 +85,7 @@ static osal_inline void put8(unsigned char octet)
     r4300->recomp.code_length++;
     if (r4300->recomp.code_length == r4300->recomp.max_code_length)
     {
-        *r4300->recomp.inst_pointer = realloc_exec(*r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
+        *r4300->recomp.inst_pointer = realloc_exec(&r4300->cached_interp.arena, *r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
         r4300->recomp.max_code_length += 8192;
     }
 }
@@ -96,7 +96,7 @@ static osal_inline void put32(unsigned int dword)
 
     if ((r4300->recomp.code_length + 4) >= r4300->recomp.max_code_length)
     {
-        *r4300->recomp.inst_pointer = realloc_exec(*r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
+        *r4300->recomp.inst_pointer = realloc_exec(&r4300->cached_interp.arena, *r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
         r4300->recomp.max_code_length += 8192;
     }
     *((unsigned int *) (*r4300->recomp.inst_pointer + r4300->recomp.code_length)) = dword;
@@ -109,7 +109,7 @@ static osal_inline void put64(unsigned long long qword)
 
     if ((r4300->recomp.code_length + 8) >= r4300->recomp.max_code_length)
     {
-        *r4300->recomp.inst_pointer = realloc_exec(*r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
+        *r4300->recomp.inst_pointer = realloc_exec(&r4300->cached_interp.arena, *r4300->recomp.inst_pointer, r4300->recomp.max_code_length, r4300->recomp.max_code_length+8192);
         r4300->recomp.max_code_length += 8192;
     }
     *((unsigned long long *) (*r4300->recomp.inst_pointer + r4300->recomp.code_length)) = qword;
@@ -30,6 +30,7 @@
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rcp/vi/vi_controller.h"
 #include "device/rdram/rdram.h"
+#include "main/rsp_async.h"
 
 
 #define AI_STATUS_BUSY UINT32_C(0x40000000)
@@ -173,6 +174,9 @@ void read_ai_regs(void* opaque, uint32_t address, uint32_t* value)
 
     if (reg == AI_LEN_REG)
     {
+        /* samples get pushed from RDRAM */
+        rsp_async_sync();
+
         *value = get_remaining_dma_length(ai);
         if (*value < ai->last_read)
         {
@@ -226,6 +230,8 @@ void ai_end_of_dma_event(void* opaque)
 {
     struct ai_controller* ai = (struct ai_controller*)opaque;
 
+    rsp_async_sync();
+
     if (ai->last_read != 0)
     {
         unsigned int diff = ai->fifo[0].length - ai->last_read;
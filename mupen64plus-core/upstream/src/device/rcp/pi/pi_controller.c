@@ -34,6 +34,7 @@
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rdp/rdp_core.h"
 #include "device/rcp/ri/ri_controller.h"
+#include "main/rsp_async.h"
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -61,6 +62,8 @@ static void dma_pi_read(struct pi_controller* pi)
     const struct pi_dma_handler* handler = NULL;
     void* opaque = NULL;
 
+    rsp_async_sync();
+
     pi->get_pi_dma_handler(pi->cart, pi->dd, cart_addr, &opaque, &handler);
 
     if (handler == NULL) {
@@ -90,6 +93,8 @@ static void dma_pi_write(struct pi_controller* pi)
     const struct pi_dma_handler* handler = NULL;
     void* opaque = NULL;
 
+    rsp_async_sync();
+
     pi->get_pi_dma_handler(pi->cart, pi->dd, cart_addr, &opaque, &handler);
 
     if (handler == NULL) {
@@ -99,6 +104,7 @@ static void dma_pi_write(struct pi_controller* pi)
 
     unsigned int cycles = handler->dma_write(opaque, dram, dram_addr, cart_addr, length);
 
+    mark_rdram_written(pi->ri->rdram, dram_addr, length);
     post_framebuffer_write(&pi->dp->fb, dram_addr, length);
 
     /* Mark DMA as busy */
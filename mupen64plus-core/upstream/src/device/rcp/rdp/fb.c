@@ -225,11 +225,15 @@ void protect_framebuffers(struct fb* fb)
             invalidate_r4300_cached_code(fb->r4300, 0, 0);
         }
     }
+
+    /* TLB mapped accesses must go through the fb handlers too */
+    tlb_flush_host_cache(&fb->r4300->cp0.tlb);
 }
 
 void unprotect_framebuffers(struct fb* fb)
 {
     size_t i;
+    uint32_t begin, end;
     struct mem_mapping ram_mapping = { 0, 0, M64P_MEM_RDRAM, { fb->rdram, RW(rdram_dram) } };
 
     /* return early if FB info is not supported or empty */
@@ -248,5 +252,14 @@ void unprotect_framebuffers(struct fb* fb)
         ram_mapping.begin = fb->infos[i].addr;
         ram_mapping.end   = fb->infos[i].addr + fb_buffer_size(&fb->infos[i]) - 1;
         apply_mem_mapping(fb->mem, &ram_mapping);
+
+        /* and the direct access of the whole regions that were remapped */
+        begin = ram_mapping.begin & ~UINT32_C(0xffff);
+        if (begin < fb->rdram->dram_size) {
+            end = (ram_mapping.end < fb->rdram->dram_size) ? ram_mapping.end : fb->rdram->dram_size - 1;
+            apply_mem_direct(fb->mem, begin, end, fb->rdram->dram + begin / 4);
+        }
     }
+
+    tlb_flush_host_cache(&fb->r4300->cp0.tlb);
 }
@@ -26,6 +26,8 @@
 #include "device/memory/memory.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rsp/rsp_core.h"
+#include "main/profile.h"
+#include "main/runahead.h"
 #include "plugin/plugin.h"
 
 static void update_dpc_status(struct rdp_core* dp, uint32_t w)
@@ -41,8 +43,12 @@ static void update_dpc_status(struct rdp_core* dp, uint32_t w)
 
         if (dp->do_on_unfreeze & DELAY_DP_INT)
             signal_rcp_interrupt(dp->mi, MI_INTR_DP);
-        if (dp->do_on_unfreeze & DELAY_UPDATESCREEN)
+        if ((dp->do_on_unfreeze & DELAY_UPDATESCREEN) && !runahead_video_hidden())
+        {
+            timed_section_start(TIMED_SECTION_GFX_SCREEN);
             gfx.updateScreen();
+            timed_section_end(TIMED_SECTION_GFX_SCREEN);
+        }
         dp->do_on_unfreeze = 0;
     }
     if (w & DPC_SET_FREEZE) dp->dpc_regs[DPC_STATUS_REG] |= DPC_STATUS_FREEZE;
@@ -116,7 +122,12 @@ void write_dpc_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mas
         break;
     case DPC_END_REG:
         dp->dpc_regs[DPC_STATUS_REG] |= DPC_STATUS_END_VALID;
-        gfx.processRDPList();
+        if (!runahead_video_hidden())
+        {
+            timed_section_start(TIMED_SECTION_GFX_RDP_LIST);
+            gfx.processRDPList();
+            timed_section_end(TIMED_SECTION_GFX_RDP_LIST);
+        }
         signal_rcp_interrupt(dp->mi, MI_INTR_DP);
         break;
     }
@@ -30,14 +30,13 @@
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rdram/rdram.h"
 #include "main/main.h"
-#if defined(PROFILE)
 #include "main/profile.h"
-#endif
+#include "main/rsp_async.h"
 #include "plugin/plugin.h"
 
 static void dma_sp_write(struct rsp_core* sp)
 {
-    unsigned int i,j;
+    unsigned int j;
 
     unsigned int l = sp->regs[SP_RD_LEN_REG];
 
@@ -54,18 +53,15 @@ static void dma_sp_write(struct rsp_core* sp)
     for(j=0; j<count; j++) {
         pre_framebuffer_read(&sp->dp->fb, dramaddr);
 
-        for(i=0; i<length; i++) {
-            spmem[memaddr^S8] = dram[dramaddr^S8];
-            memaddr++;
-            dramaddr++;
-        }
-        dramaddr+=skip;
+        copy_mem_bytes(spmem, memaddr, dram, dramaddr, length);
+        memaddr += length;
+        dramaddr += length + skip;
     }
 }
 
 static void dma_sp_read(struct rsp_core* sp)
 {
-    unsigned int i,j;
+    unsigned int j;
 
     unsigned int l = sp->regs[SP_WR_LEN_REG];
 
@@ -80,14 +76,13 @@ static void dma_sp_read(struct rsp_core* sp)
     unsigned char *dram = (unsigned char*)sp->ri->rdram->dram;
 
     for(j=0; j<count; j++) {
-        for(i=0; i<length; i++) {
-            dram[dramaddr^S8] = spmem[memaddr^S8];
-            memaddr++;
-            dramaddr++;
-        }
+        copy_mem_bytes(dram, dramaddr, spmem, memaddr, length);
+        memaddr += length;
+
+        mark_rdram_written(sp->ri->rdram, dramaddr, length);
 
-        post_framebuffer_write(&sp->dp->fb, dramaddr - length, length);
-        dramaddr+=skip;
+        post_framebuffer_write(&sp->dp->fb, dramaddr, length);
+        dramaddr += length + skip;
     }
 }
 
@@ -173,6 +168,8 @@ void init_rsp(struct rsp_core* sp,
 
 void poweron_rsp(struct rsp_core* sp)
 {
+    rsp_async_sync();
+
     memset(sp->mem, 0, SP_MEM_SIZE);
     memset(sp->regs, 0, SP_REGS_COUNT*sizeof(uint32_t));
     memset(sp->regs2, 0, SP_REGS2_COUNT*sizeof(uint32_t));
@@ -188,6 +185,8 @@ void read_rsp_mem(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    rsp_async_sync();
+
     *value = sp->mem[addr];
 }
 
@@ -196,6 +195,8 @@ void write_rsp_mem(void* opaque, uint32_t address, uint32_t value, uint32_t mask
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t addr = rsp_mem_address(address);
 
+    rsp_async_sync();
+
     masked_write(&sp->mem[addr], value, mask);
 }
 
@@ -205,6 +206,8 @@ void read_rsp_regs(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    rsp_async_sync();
+
     *value = sp->regs[reg];
 
     if (reg == SP_SEMAPHORE_REG)
@@ -218,6 +221,8 @@ void write_rsp_regs(void* opaque, uint32_t address, uint32_t value, uint32_t mas
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg(address);
 
+    rsp_async_sync();
+
     switch(reg)
     {
     case SP_STATUS_REG:
@@ -249,6 +254,8 @@ void read_rsp_regs2(void* opaque, uint32_t address, uint32_t* value)
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    rsp_async_sync();
+
     *value = sp->regs2[reg];
 }
 
@@ -257,28 +264,97 @@ void write_rsp_regs2(void* opaque, uint32_t address, uint32_t value, uint32_t ma
     struct rsp_core* sp = (struct rsp_core*)opaque;
     uint32_t reg = rsp_reg2(address);
 
+    rsp_async_sync();
+
     masked_write(&sp->regs2[reg], value, mask);
 }
 
+/* Bookkeeping shared by synchronous and asynchronous tasks once the plugin
+ * returned. The SP interrupt event of asynchronous tasks is scheduled when
+ * they are started, so it is only needed when event_scheduled is 0. */
+static void end_sp_task(struct rsp_core* sp, uint32_t sp_delay_time, int event_scheduled)
+{
+    sp->rsp_task_locked = 0;
+    sp->mi->r4300->cp0.interrupt_unsafe_state &= ~INTR_UNSAFE_RSP;
+    if ((sp->regs[SP_STATUS_REG] & (SP_STATUS_HALT | SP_STATUS_BROKE)) == 0)
+    {
+        sp->rsp_task_locked = 1;
+        sp->mi->r4300->cp0.interrupt_unsafe_state |= INTR_UNSAFE_RSP;
+        sp->mi->regs[MI_INTR_REG] |= MI_INTR_SP;
+    }
+    if (sp->mi->regs[MI_INTR_REG] & MI_INTR_SP)
+    {
+        if (!event_scheduled)
+        {
+            cp0_update_count(sp->mi->r4300);
+            add_interrupt_event(&sp->mi->r4300->cp0, SP_INT, sp_delay_time);
+        }
+        sp->mi->regs[MI_INTR_REG] &= ~MI_INTR_SP;
+    }
+
+    sp->regs[SP_STATUS_REG] &=
+        ~(SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT);
+}
+
+static void end_async_sp_task(void* opaque)
+{
+    struct rsp_core* sp = (struct rsp_core*)opaque;
+
+    sp->regs2[SP_PC_REG] |= sp->async_save_pc;
+
+    end_sp_task(sp, 4000, sp->async_event_scheduled);
+}
+
+/* Audio tasks don't touch anything the CPU can see until their results get
+ * used, so they can run alongside the CPU until the next access to RSP or MI
+ * state, AI or PI DMA, or their SP interrupt. */
+static void start_async_sp_task(struct rsp_core* sp, uint32_t save_pc)
+{
+    int deferred;
+
+    sp->async_save_pc = save_pc;
+
+    /* HLE audio tasks always finish with a break, so schedule the SP interrupt
+     * the task is going to request now, at the same count as a synchronous
+     * task would */
+    sp->async_event_scheduled = (sp->regs[SP_STATUS_REG] & SP_STATUS_INTR_BREAK) != 0;
+    if (sp->async_event_scheduled)
+    {
+        cp0_update_count(sp->mi->r4300);
+        add_interrupt_event(&sp->mi->r4300->cp0, SP_INT, 4000);
+    }
+
+    /* With lookahead the task is only joined where its results are used, so
+     * apply what joining a task ending on a break does to MI and CP0 state
+     * right away, as a synchronous task would */
+    deferred = sp->async_event_scheduled && rsp_async_lookahead();
+    if (deferred)
+    {
+        sp->rsp_task_locked = 0;
+        sp->mi->r4300->cp0.interrupt_unsafe_state &= ~INTR_UNSAFE_RSP;
+        sp->mi->regs[MI_INTR_REG] &= ~MI_INTR_SP;
+    }
+
+    rsp_async_start(end_async_sp_task, sp, deferred);
+}
+
 void do_SP_Task(struct rsp_core* sp)
 {
     uint32_t save_pc = sp->regs2[SP_PC_REG] & ~0xfff;
 
     uint32_t sp_delay_time;
 
+    rsp_async_sync();
+
     if (sp->mem[0xfc0/4] == 1)
     {
         unprotect_framebuffers(&sp->dp->fb);
 
         //gfx.processDList();
         sp->regs2[SP_PC_REG] &= 0xfff;
-#if defined(PROFILE)
-        timed_section_start(TIMED_SECTION_GFX);
-#endif
+        timed_section_start(TIMED_SECTION_RSP);
         rsp.doRspCycles(0xffffffff);
-#if defined(PROFILE)
-        timed_section_end(TIMED_SECTION_GFX);
-#endif
+        timed_section_end(TIMED_SECTION_RSP);
         sp->regs2[SP_PC_REG] |= save_pc;
         new_frame();
 
@@ -300,13 +376,16 @@ void do_SP_Task(struct rsp_core* sp)
     {
         //audio.processAList();
         sp->regs2[SP_PC_REG] &= 0xfff;
-#if defined(PROFILE)
-        timed_section_start(TIMED_SECTION_AUDIO);
-#endif
+
+        if (rsp_async_enabled())
+        {
+            start_async_sp_task(sp, save_pc);
+            return;
+        }
+
+        timed_section_start(TIMED_SECTION_RSP);
         rsp.doRspCycles(0xffffffff);
-#if defined(PROFILE)
-        timed_section_end(TIMED_SECTION_AUDIO);
-#endif
+        timed_section_end(TIMED_SECTION_RSP);
         sp->regs2[SP_PC_REG] |= save_pc;
 
         sp_delay_time = 4000;
@@ -314,35 +393,26 @@ void do_SP_Task(struct rsp_core* sp)
     else
     {
         sp->regs2[SP_PC_REG] &= 0xfff;
+        timed_section_start(TIMED_SECTION_RSP);
         rsp.doRspCycles(0xffffffff);
+        timed_section_end(TIMED_SECTION_RSP);
         sp->regs2[SP_PC_REG] |= save_pc;
 
-        sp_delay_time = 0;
-    }
+        /* other tasks (jpeg decoding, ...) write to dram behind our back */
+        mark_rdram_written(sp->ri->rdram, 0, sp->ri->rdram->dram_size);
 
-    sp->rsp_task_locked = 0;
-    sp->mi->r4300->cp0.interrupt_unsafe_state &= ~INTR_UNSAFE_RSP;
-    if ((sp->regs[SP_STATUS_REG] & (SP_STATUS_HALT | SP_STATUS_BROKE)) == 0)
-    {
-        sp->rsp_task_locked = 1;
-        sp->mi->r4300->cp0.interrupt_unsafe_state |= INTR_UNSAFE_RSP;
-        sp->mi->regs[MI_INTR_REG] |= MI_INTR_SP;
-    }
-    if (sp->mi->regs[MI_INTR_REG] & MI_INTR_SP)
-    {
-        cp0_update_count(sp->mi->r4300);
-        add_interrupt_event(&sp->mi->r4300->cp0, SP_INT, sp_delay_time);
-        sp->mi->regs[MI_INTR_REG] &= ~MI_INTR_SP;
+        sp_delay_time = 0;
     }
 
-    sp->regs[SP_STATUS_REG] &=
-        ~(SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT);
+    end_sp_task(sp, sp_delay_time, 0);
 }
 
 void rsp_interrupt_event(void* opaque)
 {
     struct rsp_core* sp = (struct rsp_core*)opaque;
 
+    rsp_async_sync();
+
     if (!sp->rsp_task_locked)
     {
         sp->regs[SP_STATUS_REG] |=
@@ -83,6 +83,10 @@ struct rsp_core
     uint32_t regs2[SP_REGS2_COUNT];
     uint32_t rsp_task_locked;
 
+    /* state of a task running on the RSP thread */
+    uint32_t async_save_pc;
+    int async_event_scheduled;
+
     struct mi_controller* mi;
     struct rdp_core* dp;
     struct ri_controller* ri;
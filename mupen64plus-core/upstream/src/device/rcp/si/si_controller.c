@@ -31,6 +31,7 @@
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/ri/ri_controller.h"
 #include "device/rdram/rdram.h"
+#include "main/rsp_async.h"
 #include "osal/preproc.h"
 
 enum
@@ -68,6 +69,8 @@ static void copy_pif_rdram(struct si_controller* si)
     uint32_t* pif_ram = (uint32_t*)si->pif->ram;
     uint32_t* dram = (uint32_t*)(&si->ri->rdram->dram[rdram_dram_address(dram_addr)]);
 
+    rsp_async_sync();
+
     if (si->dma_dir == SI_DMA_WRITE) {
         for(i = 0; i < (PIF_RAM_SIZE / 4); ++i) {
             pif_ram[i] = fromhl(dram[i]);
@@ -77,6 +80,7 @@ static void copy_pif_rdram(struct si_controller* si)
         for(i = 0; i < (PIF_RAM_SIZE / 4); ++i) {
             dram[i] = tohl(pif_ram[i]);
         }
+        mark_rdram_written(si->ri->rdram, rdram_dram_address(dram_addr) << 2, PIF_RAM_SIZE);
     }
 }
 
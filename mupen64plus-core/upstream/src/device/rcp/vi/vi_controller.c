@@ -28,6 +28,8 @@
 #include "device/r4300/r4300_core.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "main/main.h"
+#include "main/profile.h"
+#include "main/runahead.h"
 #include "plugin/plugin.h"
 
 unsigned int vi_clock_from_tv_standard(m64p_system_type tv_standard)
@@ -149,8 +151,12 @@ void vi_vertical_interrupt_event(void* opaque)
     struct vi_controller* vi = (struct vi_controller*)opaque;
     if (vi->dp->do_on_unfreeze & DELAY_DP_INT)
         vi->dp->do_on_unfreeze |= DELAY_UPDATESCREEN;
-    else
+    else if (!runahead_video_hidden())
+    {
+        timed_section_start(TIMED_SECTION_GFX_SCREEN);
         gfx.updateScreen();
+        timed_section_end(TIMED_SECTION_GFX_SCREEN);
+    }
 
     /* allow main module to do things on VI event */
     new_vi();
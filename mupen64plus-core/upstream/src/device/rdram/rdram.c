@@ -116,6 +116,10 @@ static void map_corrupt_rdram(struct rdram* rdram, int corrupt)
     mapping.handler.write32 = write_rdram_dram;
 
     apply_mem_mapping(rdram->r4300->mem, &mapping);
+    if (!corrupt) {
+        apply_mem_direct(rdram->r4300->mem, mapping.begin, mapping.end, rdram->dram);
+    }
+    tlb_flush_host_cache(&rdram->r4300->cp0.tlb);
 #ifndef NEW_DYNAREC
     rdram->r4300->recomp.fast_memory = (corrupt) ? 0 : 1;
     invalidate_r4300_cached_code(rdram->r4300, 0, 0);
@@ -139,6 +143,7 @@ void poweron_rdram(struct rdram* rdram)
     size_t modules = get_modules_count(rdram);
     memset(rdram->regs, 0, RDRAM_MAX_MODULES_COUNT*RDRAM_REGS_COUNT*sizeof(uint32_t));
     memset(rdram->dram, 0, rdram->dram_size);
+    mark_rdram_written(rdram, 0, rdram->dram_size);
 
     DebugMessage(M64MSG_INFO, "Initializing %u RDRAM modules for a total of %u MB",
         modules, rdram->dram_size / (1024*1024));
@@ -240,4 +245,5 @@ void write_rdram_dram(void* opaque, uint32_t address, uint32_t value, uint32_t m
     uint32_t addr = rdram_dram_address(address);
 
     masked_write(&rdram->dram[addr], value, mask);
+    mark_rdram_written(rdram, addr << 2, 4);
 }
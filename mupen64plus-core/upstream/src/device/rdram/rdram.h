@@ -47,6 +47,10 @@ enum rdram_registers
 /* IPL3 rdram initialization accepts up to 8 RDRAM modules */
 enum { RDRAM_MAX_MODULES_COUNT = 8 };
 
+/* Write generations are counted per 1KB of dram (8MB max) */
+enum { RDRAM_GENERATION_SHIFT = 10 };
+enum { RDRAM_GENERATIONS_COUNT = 0x800000 >> RDRAM_GENERATION_SHIFT };
+
 struct rdram
 {
     uint32_t regs[RDRAM_MAX_MODULES_COUNT][RDRAM_REGS_COUNT];
@@ -54,6 +58,10 @@ struct rdram
     uint32_t* dram;
     size_t dram_size;
 
+    /* bumped each time the core writes to the matching dram page,
+     * so video plugins can tell which ranges they need to hash again */
+    unsigned int generations[RDRAM_GENERATIONS_COUNT];
+
     struct r4300_core* r4300;
 };
 
@@ -67,6 +75,24 @@ static osal_inline uint32_t rdram_dram_address(uint32_t address)
     return (address & 0xffffff) >> 2;
 }
 
+static osal_inline void mark_rdram_written(struct rdram* rdram, uint32_t address, size_t length)
+{
+    size_t page, last;
+
+    if (length == 0 || address >= rdram->dram_size) {
+        return;
+    }
+
+    if (length > rdram->dram_size - address) {
+        length = rdram->dram_size - address;
+    }
+
+    last = (address + length - 1) >> RDRAM_GENERATION_SHIFT;
+    for (page = address >> RDRAM_GENERATION_SHIFT; page <= last; ++page) {
+        ++rdram->generations[page];
+    }
+}
+
 void init_rdram(struct rdram* rdram,
                 uint32_t* dram,
                 size_t dram_size,
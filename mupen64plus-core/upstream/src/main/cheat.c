@@ -46,108 +46,241 @@
 /* local definitions */
 #define CHEAT_CODE_MAGIC_VALUE UINT32_C(0xDEAD0000)
 
-typedef struct cheat_code {
-    uint32_t address;
-    uint32_t value;
+/* cheat codes are compiled into these operations when they are added, 16-bit
+ * ones have odd types */
+enum cheat_op_type
+{
+    CHEAT_OP_WRITE_8,
+    CHEAT_OP_WRITE_16,
+    CHEAT_OP_IF_EQUAL_8,
+    CHEAT_OP_IF_EQUAL_16,
+    CHEAT_OP_IF_NOT_EQUAL_8,
+    CHEAT_OP_IF_NOT_EQUAL_16
+};
+
+#define CHEAT_OP_IS_16BIT(type) ((type) & 1)
+
+#define CHEAT_OP_GS_BUTTON 0x1 /* only while the GS button is pressed */
+#define CHEAT_OP_SAVE_OLD  0x2 /* keep the overwritten value to restore it */
+
+typedef struct cheat_op {
+    uint32_t offset;    /* in RDRAM, already adjusted for the host byte order */
+    uint32_t address;   /* for invalidating recompiled code */
     uint32_t old_value;
-    struct list_head list;
-} cheat_code_t;
+    uint16_t value;
+    uint8_t type;
+    uint8_t flags;
+    unsigned int skip;  /* operations to skip when a condition is false */
+} cheat_op_t;
 
 typedef struct cheat {
     char *name;
     int enabled;
     int was_enabled;
-    struct list_head cheat_codes;
+    /* boot time operations come first, followed by the VI ones */
+    cheat_op_t *ops;
+    unsigned int num_boot_ops;
+    unsigned int num_ops;
     struct list_head list;
 } cheat_t;
 
 /* private functions */
-static uint16_t read_address_16bit(struct r4300_core* r4300, uint32_t address)
+static void set_op(cheat_op_t *op, int type, int flags, uint32_t address, uint32_t value)
 {
-    return *(uint16_t*)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S16)));
+    op->offset = (address & 0xFFFFFF) ^ (CHEAT_OP_IS_16BIT(type) ? S16 : S8);
+    /* mask out bit 24 which is used by GS codes to specify 8/16 bits */
+    op->address = address & 0xfeffffff;
+    op->old_value = CHEAT_CODE_MAGIC_VALUE;
+    op->value = (uint16_t)(CHEAT_OP_IS_16BIT(type) ? value : (uint8_t)value);
+    op->type = (uint8_t)type;
+    op->flags = (uint8_t)flags;
+    op->skip = 0;
 }
 
-static uint8_t read_address_8bit(struct r4300_core* r4300, uint32_t address)
+/* compiles a code into its VI time operations, or only counts them if ops is
+ * NULL. Boot time and unknown codes don't do anything at VI time. */
+static unsigned int compile_vi_code(cheat_op_t *ops, uint32_t address, uint32_t value)
 {
-    return *(uint8_t*)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S8)));
+    int type;
+    int flags;
+
+    switch (address & 0xFF000000)
+    {
+    /* normal cheat code */
+    case 0x80000000:
+    case 0xA0000000:
+        type = CHEAT_OP_WRITE_8;
+        flags = CHEAT_OP_SAVE_OLD;
+        break;
+    case 0x81000000:
+    case 0xA1000000:
+        type = CHEAT_OP_WRITE_16;
+        flags = CHEAT_OP_SAVE_OLD;
+        break;
+    /* GS button triggers cheat code */
+    case 0x88000000:
+    case 0xA8000000:
+        type = CHEAT_OP_WRITE_8;
+        flags = CHEAT_OP_GS_BUTTON;
+        break;
+    case 0x89000000:
+    case 0xA9000000:
+        type = CHEAT_OP_WRITE_16;
+        flags = CHEAT_OP_GS_BUTTON;
+        break;
+    /* conditional cheat codes */
+    case 0xD0000000: type = CHEAT_OP_IF_EQUAL_8; flags = 0; break;
+    case 0xD1000000: type = CHEAT_OP_IF_EQUAL_16; flags = 0; break;
+    case 0xD2000000: type = CHEAT_OP_IF_NOT_EQUAL_8; flags = 0; break;
+    case 0xD3000000: type = CHEAT_OP_IF_NOT_EQUAL_16; flags = 0; break;
+    case 0xD8000000: type = CHEAT_OP_IF_EQUAL_8; flags = CHEAT_OP_GS_BUTTON; break;
+    case 0xD9000000: type = CHEAT_OP_IF_EQUAL_16; flags = CHEAT_OP_GS_BUTTON; break;
+    case 0xDB000000: type = CHEAT_OP_IF_NOT_EQUAL_8; flags = CHEAT_OP_GS_BUTTON; break;
+    case 0xDA000000: type = CHEAT_OP_IF_NOT_EQUAL_16; flags = CHEAT_OP_GS_BUTTON; break;
+    case 0xEE000000:
+        /* most likely, this doesnt do anything. */
+        if (ops != NULL) {
+            set_op(&ops[0], CHEAT_OP_WRITE_16, 0, 0xF1000318, 0x0040);
+            set_op(&ops[1], CHEAT_OP_WRITE_16, 0, 0xF100031A, 0x0000);
+        }
+        return 2;
+    default:
+        return 0;
+    }
+
+    if (ops != NULL) {
+        set_op(ops, type, flags, address, value);
+    }
+    return 1;
 }
 
-static void update_address_16bit(struct r4300_core* r4300, uint32_t address, uint16_t new_value)
+static int is_boot_code(uint32_t address)
 {
-    *(uint16_t*)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S16))) = new_value;
-    /* mask out bit 24 which is used by GS codes to specify 8/16 bits */
-    address &= 0xfeffffff;
-    invalidate_r4300_cached_code(r4300, address, 2);
+    return (address & 0xFF000000) == 0xF0000000 || (address & 0xFF000000) == 0xF1000000;
 }
 
-static void update_address_8bit(struct r4300_core* r4300, uint32_t address, uint8_t new_value)
+static int is_conditional_code(uint32_t address)
 {
-    *(uint8_t*)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S8))) = new_value;
-    invalidate_r4300_cached_code(r4300, address, 1);
+    return (address & 0xF0000000) == 0xD0000000;
 }
 
-static int address_equal_to_8bit(struct r4300_core* r4300, uint32_t address, uint8_t value)
+/* replaces the operations of a cheat with the compiled codes */
+static int compile_cheat(cheat_t *cheat, const m64p_cheat_code *codes, unsigned int num_codes)
 {
-    uint8_t value_read;
-    value_read = *(uint8_t*)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S8)));
-    return value_read == value;
+    unsigned int *vi_start;
+    unsigned int num_boot_ops = 0;
+    unsigned int num_vi_ops = 0;
+    unsigned int i, k;
+    cheat_op_t *ops;
+
+    /* index of the first VI operation of each code */
+    vi_start = malloc((num_codes + 1) * sizeof(*vi_start));
+    if (vi_start == NULL)
+        return 0;
+
+    for (i = 0; i < num_codes; i++)
+    {
+        if (is_boot_code(codes[i].address))
+            num_boot_ops++;
+
+        vi_start[i] = num_vi_ops;
+        num_vi_ops += compile_vi_code(NULL, codes[i].address, codes[i].value);
+    }
+    vi_start[num_codes] = num_vi_ops;
+
+    ops = malloc((num_boot_ops + num_vi_ops + 1) * sizeof(*ops));
+    if (ops == NULL)
+    {
+        free(vi_start);
+        return 0;
+    }
+
+    free(cheat->ops);
+    cheat->ops = ops;
+    cheat->num_boot_ops = num_boot_ops;
+    cheat->num_ops = num_boot_ops + num_vi_ops;
+
+    num_boot_ops = 0;
+    for (i = 0; i < num_codes; i++)
+    {
+        uint32_t address = codes[i].address;
+        cheat_op_t *op = &ops[cheat->num_boot_ops + vi_start[i]];
+
+        /* code should only be written once at boot time */
+        if (is_boot_code(address)) {
+            set_op(&ops[num_boot_ops++], (address & 0xFF000000) == 0xF0000000 ? CHEAT_OP_WRITE_8 : CHEAT_OP_WRITE_16,
+                   CHEAT_OP_SAVE_OLD, address, codes[i].value);
+        }
+
+        if (compile_vi_code(op, address, codes[i].value) != 0 && is_conditional_code(address))
+        {
+            /* if condition false, skip next non-test code */
+            for (k = i + 1; k < num_codes && is_conditional_code(codes[k].address); k++);
+            op->skip = vi_start[k < num_codes ? k + 1 : num_codes] - vi_start[i + 1];
+        }
+    }
+
+    free(vi_start);
+    return 1;
 }
 
-static int address_equal_to_16bit(struct r4300_core* r4300, uint32_t address, uint16_t value)
+static uint32_t read_op(const unsigned char *dram, const cheat_op_t *op)
 {
-    uint16_t value_read;
-    value_read = *(unsigned short *)(((unsigned char*)r4300->rdram->dram + ((address & 0xFFFFFF)^S16)));
-    return value_read == value;
+    if (CHEAT_OP_IS_16BIT(op->type))
+        return *(const uint16_t*)(dram + op->offset);
+    else
+        return *(dram + op->offset);
 }
 
-/* individual application - returns 0 if we are supposed to skip the next cheat
- * (only really used on conditional codes)
- */
-static int execute_cheat(struct r4300_core* r4300, uint32_t address, uint32_t value, uint32_t* old_value)
+static void write_op(struct r4300_core* r4300, unsigned char *dram, const cheat_op_t *op, uint32_t value)
 {
-    switch (address & 0xFF000000)
+    if (CHEAT_OP_IS_16BIT(op->type)) {
+        *(uint16_t*)(dram + op->offset) = (uint16_t)value;
+        invalidate_r4300_cached_code(r4300, op->address, 2);
+        mark_rdram_written(r4300->rdram, op->offset, 2);
+    }
+    else {
+        *(dram + op->offset) = (uint8_t)value;
+        invalidate_r4300_cached_code(r4300, op->address, 1);
+        mark_rdram_written(r4300->rdram, op->offset, 1);
+    }
+}
+
+static void execute_write(struct r4300_core* r4300, unsigned char *dram, cheat_op_t *op)
+{
+    /* if old value should be saved and is uninitialized, write current value to it */
+    if ((op->flags & CHEAT_OP_SAVE_OLD) && op->old_value == CHEAT_CODE_MAGIC_VALUE) {
+        op->old_value = read_op(dram, op);
+    }
+    write_op(r4300, dram, op, op->value);
+}
+
+static void execute_vi_ops(struct r4300_core* r4300, unsigned char *dram, cheat_t *cheat, int gs_active)
+{
+    unsigned int i;
+
+    for (i = cheat->num_boot_ops; i < cheat->num_ops; i++)
     {
-    case 0x80000000:
-    case 0x88000000:
-    case 0xA0000000:
-    case 0xA8000000:
-    case 0xF0000000:
-        /* if pointer to old value is valid and uninitialized, write current value to it */
-        if (old_value && (*old_value == CHEAT_CODE_MAGIC_VALUE)) {
-            *old_value = read_address_8bit(r4300, address);
-        }
-        update_address_8bit(r4300, address, (uint8_t)value);
-        return 1;
-    case 0x81000000:
-    case 0x89000000:
-    case 0xA1000000:
-    case 0xA9000000:
-    case 0xF1000000:
-        /* if pointer to old value is valid and uninitialized, write current value to it */
-        if (old_value && (*old_value == CHEAT_CODE_MAGIC_VALUE)) {
-            *old_value = read_address_16bit(r4300, address);
+        cheat_op_t *op = &cheat->ops[i];
+        int active = gs_active || !(op->flags & CHEAT_OP_GS_BUTTON);
+
+        switch (op->type)
+        {
+        case CHEAT_OP_WRITE_8:
+        case CHEAT_OP_WRITE_16:
+            if (active)
+                execute_write(r4300, dram, op);
+            break;
+        case CHEAT_OP_IF_EQUAL_8:
+        case CHEAT_OP_IF_EQUAL_16:
+            if (!active || read_op(dram, op) != op->value)
+                i += op->skip;
+            break;
+        default:
+            if (!active || read_op(dram, op) == op->value)
+                i += op->skip;
+            break;
         }
-        update_address_16bit(r4300, address, (uint16_t)value);
-        return 1;
-    case 0xD0000000:
-    case 0xD8000000:
-        return address_equal_to_8bit(r4300, address, (uint8_t)value);
-    case 0xD1000000:
-    case 0xD9000000:
-        return address_equal_to_16bit(r4300, address, (uint16_t)value);
-    case 0xD2000000:
-    case 0xDB000000:
-        return !(address_equal_to_8bit(r4300, address, (uint8_t)value));
-    case 0xD3000000:
-    case 0xDA000000:
-        return !(address_equal_to_16bit(r4300, address, (uint16_t)value));
-    case 0xEE000000:
-        /* most likely, this doesnt do anything. */
-        execute_cheat(r4300, 0xF1000318, 0x0040, NULL);
-        execute_cheat(r4300, 0xF100031A, 0x0000, NULL);
-        return 1;
-    default:
-        return 1;
     }
 }
 
@@ -166,12 +299,10 @@ static cheat_t *find_or_create_cheat(struct cheat_ctx* ctx, const char *name)
     if (found)
     {
         /* delete any pre-existing cheat codes */
-        cheat_code_t *code, *safe;
-
-        list_for_each_entry_safe_t(code, safe, &cheat->cheat_codes, cheat_code_t, list) {
-            list_del(&code->list);
-            free(code);
-        }
+        free(cheat->ops);
+        cheat->ops = NULL;
+        cheat->num_boot_ops = 0;
+        cheat->num_ops = 0;
 
         cheat->enabled = 0;
         cheat->was_enabled = 0;
@@ -182,7 +313,9 @@ static cheat_t *find_or_create_cheat(struct cheat_ctx* ctx, const char *name)
         cheat->name = strdup(name);
         cheat->enabled = 0;
         cheat->was_enabled = 0;
-        INIT_LIST_HEAD(&cheat->cheat_codes);
+        cheat->ops = NULL;
+        cheat->num_boot_ops = 0;
+        cheat->num_ops = 0;
         list_add_tail(&cheat->list, &ctx->active_cheats);
     }
 
@@ -205,11 +338,13 @@ void cheat_uninit(struct cheat_ctx* ctx)
     ctx->mutex = NULL;
 }
 
+
 void cheat_apply_cheats(struct cheat_ctx* ctx, struct r4300_core* r4300, int entry)
 {
+    unsigned char *dram = (unsigned char*)r4300->rdram->dram;
     cheat_t *cheat;
-    cheat_code_t *code;
-    int cond_failed;
+    unsigned int i;
+    int gs_active;
 
     if (list_empty(&ctx->active_cheats))
         return;
@@ -220,6 +355,8 @@ void cheat_apply_cheats(struct cheat_ctx* ctx, struct r4300_core* r4300, int ent
         return;
     }
 
+    gs_active = event_gameshark_active();
+
     list_for_each_entry_t(cheat, &ctx->active_cheats, cheat_t, list) {
         if (cheat->enabled)
         {
@@ -227,65 +364,12 @@ void cheat_apply_cheats(struct cheat_ctx* ctx, struct r4300_core* r4300, int ent
             switch(entry)
             {
             case ENTRY_BOOT:
-                list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list) {
-                    /* code should only be written once at boot time */
-                    if ((code->address & 0xF0000000) == 0xF0000000) {
-                        execute_cheat(r4300, code->address, code->value, &code->old_value);
-                    }
+                for (i = 0; i < cheat->num_boot_ops; i++) {
+                    execute_write(r4300, dram, &cheat->ops[i]);
                 }
                 break;
             case ENTRY_VI:
-                /* a cheat starts without failed preconditions */
-                cond_failed = 0;
-
-                list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list) {
-                    /* conditional cheat codes */
-                    if ((code->address & 0xF0000000) == 0xD0000000)
-                    {
-                        /* if code needs GS button pressed and it's not, skip it */
-                        if (((code->address & 0xFF000000) == 0xD8000000 ||
-                                    (code->address & 0xFF000000) == 0xD9000000 ||
-                                    (code->address & 0xFF000000) == 0xDA000000 ||
-                                    (code->address & 0xFF000000) == 0xDB000000) &&
-                                !event_gameshark_active()) {
-                            /* if condition false, skip next code non-test code */
-                            cond_failed = 1;
-                        }
-
-                        /* if condition false, skip next code non-test code */
-                        if (!execute_cheat(r4300, code->address, code->value, NULL)) {
-                            cond_failed = 1;
-                        }
-                    }
-                    else {
-                        /* preconditions were false for this non-test code
-                         * reset the condition state and skip the cheat
-                         */
-                        if (cond_failed) {
-                            cond_failed = 0;
-                            continue;
-                        }
-
-                        switch (code->address & 0xFF000000) {
-                        /* GS button triggers cheat code */
-                        case 0x88000000:
-                        case 0x89000000:
-                        case 0xA8000000:
-                        case 0xA9000000:
-                            if (event_gameshark_active()) {
-                                execute_cheat(r4300, code->address, code->value, NULL);
-                            }
-                            break;
-                            /* normal cheat code */
-                        default:
-                            /* exclude boot-time cheat codes */
-                            if ((code->address & 0xF0000000) != 0xF0000000) {
-                                execute_cheat(r4300, code->address, code->value, &code->old_value);
-                            }
-                            break;
-                        }
-                    }
-                }
+                execute_vi_ops(r4300, dram, cheat, gs_active);
                 break;
             default:
                 break;
@@ -298,12 +382,15 @@ void cheat_apply_cheats(struct cheat_ctx* ctx, struct r4300_core* r4300, int ent
             switch(entry)
             {
             case ENTRY_VI:
-                list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list) {
+                /* backwards, so that the value saved first for an address wins */
+                for (i = cheat->num_ops; i-- > 0; ) {
+                    cheat_op_t *op = &cheat->ops[i];
+
                     /* set memory back to old value and clear saved copy of old value */
-                    if(code->old_value != CHEAT_CODE_MAGIC_VALUE)
+                    if (op->old_value != CHEAT_CODE_MAGIC_VALUE)
                     {
-                        execute_cheat(r4300, code->address, code->old_value, NULL);
-                        code->old_value = CHEAT_CODE_MAGIC_VALUE;
+                        write_op(r4300, dram, op, op->old_value);
+                        op->old_value = CHEAT_CODE_MAGIC_VALUE;
                     }
                 }
                 break;
@@ -320,7 +407,6 @@ void cheat_apply_cheats(struct cheat_ctx* ctx, struct r4300_core* r4300, int ent
 void cheat_delete_all(struct cheat_ctx* ctx)
 {
     cheat_t *cheat, *safe_cheat;
-    cheat_code_t *code, *safe_code;
 
     if (list_empty(&ctx->active_cheats))
         return;
@@ -333,11 +419,7 @@ void cheat_delete_all(struct cheat_ctx* ctx)
 
     list_for_each_entry_safe_t(cheat, safe_cheat, &ctx->active_cheats, cheat_t, list) {
         free(cheat->name);
-
-        list_for_each_entry_safe_t(code, safe_code, &cheat->cheat_codes, cheat_code_t, list) {
-            list_del(&code->list);
-            free(code);
-        }
+        free(cheat->ops);
         list_del(&cheat->list);
         free(cheat);
     }
@@ -371,9 +453,12 @@ int cheat_set_enabled(struct cheat_ctx* ctx, const char* name, int enabled)
     return 0;
 }
 
+
 int cheat_add_new(struct cheat_ctx* ctx, const char* name, m64p_cheat_code* code_list, int num_codes)
 {
     cheat_t *cheat;
+    m64p_cheat_code *codes;
+    unsigned int count = 0;
     int i, j;
 
     if (ctx->mutex == NULL || SDL_LockMutex(ctx->mutex) != 0)
@@ -393,6 +478,22 @@ int cheat_add_new(struct cheat_ctx* ctx, const char* name, m64p_cheat_code* code
     /* default for new cheats is enabled */
     cheat->enabled = 1;
 
+    for (i = 0; i < num_codes; i++)
+    {
+        if ((code_list[i].address & 0xFFFF0000) == 0x50000000 && i < num_codes - 1)
+            count += (code_list[i++].address & 0xFF00) >> 8;
+        else
+            count++;
+    }
+
+    codes = malloc((count + 1) * sizeof(*codes));
+    if (codes == NULL)
+    {
+        SDL_UnlockMutex(ctx->mutex);
+        return 0;
+    }
+
+    count = 0;
     for (i = 0; i < num_codes; i++)
     {
         /* if this is a 'patch' code, convert it and dump out all of the individual codes */
@@ -406,11 +507,9 @@ int cheat_add_new(struct cheat_ctx* ctx, const char* name, m64p_cheat_code* code
             i += 1;
             for (j = 0; j < code_count; j++)
             {
-                cheat_code_t *code = malloc(sizeof(*code));
-                code->address = cur_addr;
-                code->value = cur_value;
-                code->old_value = CHEAT_CODE_MAGIC_VALUE;
-                list_add_tail(&code->list, &cheat->cheat_codes);
+                codes[count].address = cur_addr;
+                codes[count].value = cur_value;
+                count++;
                 cur_addr += incr_addr;
                 cur_value += incr_value;
             }
@@ -418,14 +517,19 @@ int cheat_add_new(struct cheat_ctx* ctx, const char* name, m64p_cheat_code* code
         else
         {
             /* just a normal code */
-            cheat_code_t *code = malloc(sizeof(*code));
-            code->address = code_list[i].address;
-            code->value = code_list[i].value;
-            code->old_value = CHEAT_CODE_MAGIC_VALUE;
-            list_add_tail(&code->list, &cheat->cheat_codes);
+            codes[count++] = code_list[i];
         }
     }
 
+    if (!compile_cheat(cheat, codes, count))
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate memory for cheat '%s'", name);
+        free(codes);
+        SDL_UnlockMutex(ctx->mutex);
+        return 0;
+    }
+
+    free(codes);
     SDL_UnlockMutex(ctx->mutex);
     return 1;
 }
@@ -141,6 +141,22 @@ static int JoyCmdActive[16][2];  /* if extra joystick commands are added above,
 
 static int GamesharkActive = 0;
 
+/* Key events pushed by the front-end, which are handled by the emulation thread
+ * at the next VI. The count is read without the lock, so that checking an empty
+ * queue costs nothing but a load.
+ */
+#define EVENT_QUEUE_SIZE 64
+
+typedef struct {
+  int keydown;
+  int keysym;
+  int keymod;
+} frontend_event;
+
+static frontend_event  l_EventQueue[EVENT_QUEUE_SIZE];
+static volatile int    l_EventQueueCount = 0;
+static SDL_mutex      *l_EventQueueLock = NULL;
+
 /*********************************************************************************************************
 * static functions for eventloop.c
 */
@@ -295,6 +311,7 @@ static int MatchJoyCommand(const SDL_Event *event, eJoyCommand cmd)
     return 0;
 }
 
+#if !defined(NO_SDL_EVENTS)
 /*********************************************************************************************************
 * sdl event filter
 */
@@ -418,6 +435,7 @@ static int SDLCALL event_sdl_filter(void *userdata, SDL_Event *event)
 
     return 1;  // add this event to SDL queue
 }
+#endif
 
 /*********************************************************************************************************
 * global functions
@@ -432,6 +450,15 @@ void event_initialize(void)
         for (j = 0; j < 2; j++)
             JoyCmdActive[i][j] = 0;
 
+    /* drop any key events left over from the previous game */
+    if (l_EventQueueLock != NULL)
+    {
+        SDL_LockMutex(l_EventQueueLock);
+        l_EventQueueCount = 0;
+        SDL_UnlockMutex(l_EventQueueLock);
+    }
+
+#if !defined(NO_SDL_EVENTS)
     /* activate any joysticks which are referenced in the joystick event command strings */
     const int NumJoysticks = SDL_NumJoysticks();
     if (NumJoysticks > 0)
@@ -504,6 +531,71 @@ void event_initialize(void)
     if (SDL_EventState(SDL_SYSWMEVENT, SDL_QUERY) != SDL_ENABLE)
         DebugMessage(M64MSG_WARNING, "Failed to change event state: %s", SDL_GetError());
 #endif
+#endif /* !NO_SDL_EVENTS */
+}
+
+void event_queue_init(void)
+{
+    l_EventQueueLock = SDL_CreateMutex();
+    l_EventQueueCount = 0;
+}
+
+void event_queue_deinit(void)
+{
+    if (l_EventQueueLock != NULL)
+        SDL_DestroyMutex(l_EventQueueLock);
+    l_EventQueueLock = NULL;
+}
+
+int event_queue_push_key(int keydown, int keysym, int keymod)
+{
+    int queued = 0;
+
+    if (l_EventQueueLock == NULL)
+        return 0;
+
+    SDL_LockMutex(l_EventQueueLock);
+    if (l_EventQueueCount < EVENT_QUEUE_SIZE)
+    {
+        frontend_event *event = &l_EventQueue[l_EventQueueCount];
+        event->keydown = keydown;
+        event->keysym = keysym;
+        event->keymod = keymod;
+        l_EventQueueCount++;
+        queued = 1;
+    }
+    SDL_UnlockMutex(l_EventQueueLock);
+
+    return queued;
+}
+
+void event_check_inputs(void)
+{
+    frontend_event events[EVENT_QUEUE_SIZE];
+    int i, count;
+
+    if (l_EventQueueCount != 0 && l_EventQueueLock != NULL)
+    {
+        /* take the events out first, as handling them may take a while (loading a state, etc) */
+        SDL_LockMutex(l_EventQueueLock);
+        count = l_EventQueueCount;
+        memcpy(events, l_EventQueue, count * sizeof(frontend_event));
+        l_EventQueueCount = 0;
+        SDL_UnlockMutex(l_EventQueueLock);
+
+        for (i = 0; i < count; i++)
+        {
+            if (events[i].keydown)
+                event_sdl_keydown(events[i].keysym, events[i].keymod);
+            else
+                event_sdl_keyup(events[i].keysym, events[i].keymod);
+        }
+    }
+
+#if !defined(NO_SDL_EVENTS)
+    /* run the SDL event filter over anything the window system sent */
+    SDL_PumpEvents();
+#endif
 }
 
 int event_set_core_defaults(void)
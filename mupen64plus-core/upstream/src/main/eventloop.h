@@ -24,6 +24,10 @@
 
 extern int event_set_core_defaults(void);
 extern void event_initialize(void);
+extern void event_queue_init(void);
+extern void event_queue_deinit(void);
+extern int event_queue_push_key(int keydown, int keysym, int keymod);
+extern void event_check_inputs(void);
 extern void event_sdl_keydown(int keysym, int keymod);
 extern void event_sdl_keyup(int keysym, int keymod);
 extern int event_gameshark_active(void);
@@ -0,0 +1,244 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - gfx_trace.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "gfx_trace.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "device/memory/memory.h"
+#include "main.h"
+#include "plugin/plugin.h"
+#include "rsp_async.h"
+
+struct gfx_trace
+{
+    FILE* file;
+
+    /* memory as last written to the trace */
+    uint8_t* rdram;
+    uint8_t dmem[GFX_TRACE_PAGE_SIZE];
+    uint8_t imem[GFX_TRACE_PAGE_SIZE];
+    uint32_t rdram_size;
+
+    unsigned int frame;
+    unsigned int frames;
+
+    /* plugin functions the tracing ones forward to */
+    gfx_plugin_functions gfx;
+};
+
+static struct gfx_trace l_trace;
+
+
+static void write_record(uint32_t type, uint32_t arg, const void* payload, size_t size)
+{
+    struct gfx_trace_record record;
+
+    record.type = type;
+    record.arg = arg;
+
+    if (fwrite(&record, sizeof(record), 1, l_trace.file) != 1
+     || fwrite(payload, size, 1, l_trace.file) != 1)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to write video plugin trace, stopping");
+        gfx_trace_stop();
+    }
+}
+
+static void write_page(uint32_t type, uint32_t arg, uint8_t* shadow, const uint8_t* mem)
+{
+    if (memcmp(shadow, mem, GFX_TRACE_PAGE_SIZE) == 0)
+        return;
+
+    memcpy(shadow, mem, GFX_TRACE_PAGE_SIZE);
+    write_record(type, arg, shadow, GFX_TRACE_PAGE_SIZE);
+}
+
+static void write_memory(void)
+{
+    const uint8_t* rdram = (const uint8_t*)mem_base_u32(g_mem_base, MM_RDRAM_DRAM);
+    const uint8_t* sp_mem = (const uint8_t*)mem_base_u32(g_mem_base, MM_RSP_MEM);
+    uint32_t page;
+
+    for (page = 0; page < l_trace.rdram_size / GFX_TRACE_PAGE_SIZE && l_trace.file != NULL; ++page)
+    {
+        write_page(GFX_TRACE_RDRAM_PAGE, page,
+                   l_trace.rdram + page * GFX_TRACE_PAGE_SIZE,
+                   rdram + page * GFX_TRACE_PAGE_SIZE);
+    }
+
+    if (l_trace.file != NULL)
+        write_page(GFX_TRACE_DMEM, 0, l_trace.dmem, sp_mem);
+    if (l_trace.file != NULL)
+        write_page(GFX_TRACE_IMEM, 0, l_trace.imem, sp_mem + 0x1000);
+}
+
+/* Records the memory and registers the plugin is about to see */
+static void write_call(uint32_t type)
+{
+    static const size_t dpc_regs[GFX_TRACE_DPC_NUM] = {
+        DPC_START_REG, DPC_END_REG, DPC_CURRENT_REG, DPC_STATUS_REG,
+        DPC_CLOCK_REG, DPC_BUFBUSY_REG, DPC_PIPEBUSY_REG, DPC_TMEM_REG
+    };
+    static const size_t vi_regs[GFX_TRACE_VI_NUM] = {
+        VI_STATUS_REG, VI_ORIGIN_REG, VI_WIDTH_REG, VI_V_INTR_REG,
+        VI_CURRENT_REG, VI_BURST_REG, VI_V_SYNC_REG, VI_H_SYNC_REG,
+        VI_LEAP_REG, VI_H_START_REG, VI_V_START_REG, VI_V_BURST_REG,
+        VI_X_SCALE_REG, VI_Y_SCALE_REG
+    };
+    struct gfx_trace_registers regs;
+    size_t i;
+
+    /* an audio task may still be writing to RDRAM */
+    rsp_async_sync();
+
+    write_memory();
+    if (l_trace.file == NULL)
+        return;
+
+    regs.mi_intr = g_dev.mi.regs[MI_INTR_REG];
+    regs.sp_status = g_dev.sp.regs[SP_STATUS_REG];
+    for (i = 0; i < GFX_TRACE_DPC_NUM; ++i)
+        regs.dpc[i] = g_dev.dp.dpc_regs[dpc_regs[i]];
+    for (i = 0; i < GFX_TRACE_VI_NUM; ++i)
+        regs.vi[i] = g_dev.vi.regs[vi_regs[i]];
+
+    write_record(type, l_trace.frame, &regs, sizeof(regs));
+}
+
+static void trace_ProcessDList(void)
+{
+    ptr_ProcessDList process_dlist = l_trace.gfx.processDList;
+
+    write_call(GFX_TRACE_PROCESS_DLIST);
+    process_dlist();
+}
+
+static void trace_ProcessRDPList(void)
+{
+    ptr_ProcessRDPList process_rdp_list = l_trace.gfx.processRDPList;
+
+    write_call(GFX_TRACE_PROCESS_RDP_LIST);
+    process_rdp_list();
+}
+
+static void trace_UpdateScreen(void)
+{
+    ptr_UpdateScreen update_screen = l_trace.gfx.updateScreen;
+
+    write_call(GFX_TRACE_UPDATE_SCREEN);
+
+    if (l_trace.frames != 0 && ++l_trace.frame >= l_trace.frames)
+    {
+        DebugMessage(M64MSG_INFO, "Recorded %u frames of video plugin trace", l_trace.frame);
+        gfx_trace_stop();
+    }
+
+    update_screen();
+}
+
+static void trace_ViStatusChanged(void)
+{
+    ptr_ViStatusChanged vi_status_changed = l_trace.gfx.viStatusChanged;
+
+    write_call(GFX_TRACE_VI_STATUS_CHANGED);
+    vi_status_changed();
+}
+
+static void trace_ViWidthChanged(void)
+{
+    ptr_ViWidthChanged vi_width_changed = l_trace.gfx.viWidthChanged;
+
+    write_call(GFX_TRACE_VI_WIDTH_CHANGED);
+    vi_width_changed();
+}
+
+
+int gfx_trace_start(const char* filename, unsigned int frames)
+{
+    struct gfx_trace_header header;
+
+    if (l_trace.file != NULL)
+        return 0;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = GFX_TRACE_MAGIC;
+    header.version = GFX_TRACE_VERSION;
+    header.rdram_size = (uint32_t)g_dev.rdram.dram_size;
+    memcpy(header.rom_header, mem_base_u32(g_mem_base, MM_CART_ROM), GFX_TRACE_ROM_HEADER_SIZE);
+
+    l_trace.rdram = calloc(1, header.rdram_size);
+    if (l_trace.rdram == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate video plugin trace buffer");
+        return 0;
+    }
+
+    l_trace.file = fopen(filename, "wb");
+    if (l_trace.file == NULL || fwrite(&header, sizeof(header), 1, l_trace.file) != 1)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to open video plugin trace file '%s'", filename);
+        if (l_trace.file != NULL)
+            fclose(l_trace.file);
+        l_trace.file = NULL;
+        free(l_trace.rdram);
+        l_trace.rdram = NULL;
+        return 0;
+    }
+
+    memset(l_trace.dmem, 0, GFX_TRACE_PAGE_SIZE);
+    memset(l_trace.imem, 0, GFX_TRACE_PAGE_SIZE);
+    l_trace.rdram_size = header.rdram_size;
+    l_trace.frame = 0;
+    l_trace.frames = frames;
+
+    l_trace.gfx = gfx;
+    gfx.processDList = trace_ProcessDList;
+    gfx.processRDPList = trace_ProcessRDPList;
+    gfx.updateScreen = trace_UpdateScreen;
+    gfx.viStatusChanged = trace_ViStatusChanged;
+    gfx.viWidthChanged = trace_ViWidthChanged;
+
+    DebugMessage(M64MSG_INFO, "Recording video plugin trace to '%s'", filename);
+    return 1;
+}
+
+void gfx_trace_stop(void)
+{
+    if (l_trace.file == NULL)
+        return;
+
+    gfx.processDList = l_trace.gfx.processDList;
+    gfx.processRDPList = l_trace.gfx.processRDPList;
+    gfx.updateScreen = l_trace.gfx.updateScreen;
+    gfx.viStatusChanged = l_trace.gfx.viStatusChanged;
+    gfx.viWidthChanged = l_trace.gfx.viWidthChanged;
+
+    fclose(l_trace.file);
+    l_trace.file = NULL;
+    free(l_trace.rdram);
+    l_trace.rdram = NULL;
+}
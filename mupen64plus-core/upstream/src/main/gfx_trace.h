@@ -0,0 +1,103 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - gfx_trace.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_GFX_TRACE_H
+#define M64P_MAIN_GFX_TRACE_H
+
+#include <stdint.h>
+
+/* Video plugin trace file format, replayed by tools/gfx_bench.c. All values
+ * are stored in host byte order.
+ *
+ * The file starts with a header, followed by a sequence of records. Each
+ * record begins with its type and an argument. Memory records carry one page
+ * of RDRAM, DMEM or IMEM that changed since it was last recorded; all of them
+ * start out as zero. Call records stand for one call into the video plugin and
+ * carry the registers it can see through GFX_INFO at that moment. */
+
+#define GFX_TRACE_MAGIC 0x4754344d /* "M4TG" */
+#define GFX_TRACE_VERSION 1
+
+#define GFX_TRACE_PAGE_SIZE 0x1000
+#define GFX_TRACE_ROM_HEADER_SIZE 0x40
+
+enum gfx_trace_record_type
+{
+    GFX_TRACE_RDRAM_PAGE,       /* arg: page index, payload: GFX_TRACE_PAGE_SIZE bytes */
+    GFX_TRACE_DMEM,             /* arg: unused, payload: GFX_TRACE_PAGE_SIZE bytes */
+    GFX_TRACE_IMEM,             /* arg: unused, payload: GFX_TRACE_PAGE_SIZE bytes */
+    GFX_TRACE_PROCESS_DLIST,    /* arg: frame, payload: struct gfx_trace_registers */
+    GFX_TRACE_PROCESS_RDP_LIST, /* arg: frame, payload: struct gfx_trace_registers */
+    GFX_TRACE_UPDATE_SCREEN,    /* arg: frame, payload: struct gfx_trace_registers */
+    GFX_TRACE_VI_STATUS_CHANGED,/* arg: frame, payload: struct gfx_trace_registers */
+    GFX_TRACE_VI_WIDTH_CHANGED, /* arg: frame, payload: struct gfx_trace_registers */
+    GFX_TRACE_RECORD_NUM
+};
+
+/* in the order of the GFX_INFO pointers */
+enum gfx_trace_dpc_register
+{
+    GFX_TRACE_DPC_START, GFX_TRACE_DPC_END, GFX_TRACE_DPC_CURRENT, GFX_TRACE_DPC_STATUS,
+    GFX_TRACE_DPC_CLOCK, GFX_TRACE_DPC_BUFBUSY, GFX_TRACE_DPC_PIPEBUSY, GFX_TRACE_DPC_TMEM,
+    GFX_TRACE_DPC_NUM
+};
+
+enum gfx_trace_vi_register
+{
+    GFX_TRACE_VI_STATUS, GFX_TRACE_VI_ORIGIN, GFX_TRACE_VI_WIDTH, GFX_TRACE_VI_INTR,
+    GFX_TRACE_VI_V_CURRENT_LINE, GFX_TRACE_VI_TIMING, GFX_TRACE_VI_V_SYNC, GFX_TRACE_VI_H_SYNC,
+    GFX_TRACE_VI_LEAP, GFX_TRACE_VI_H_START, GFX_TRACE_VI_V_START, GFX_TRACE_VI_V_BURST,
+    GFX_TRACE_VI_X_SCALE, GFX_TRACE_VI_Y_SCALE,
+    GFX_TRACE_VI_NUM
+};
+
+struct gfx_trace_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rdram_size;
+    uint8_t rom_header[GFX_TRACE_ROM_HEADER_SIZE];
+};
+
+struct gfx_trace_record
+{
+    uint32_t type;
+    uint32_t arg;
+};
+
+struct gfx_trace_registers
+{
+    uint32_t mi_intr;
+    uint32_t sp_status;
+    uint32_t dpc[GFX_TRACE_DPC_NUM];
+    uint32_t vi[GFX_TRACE_VI_NUM];
+};
+
+#ifndef GFX_TRACE_FORMAT_ONLY
+
+/* Starts recording the calls into the video plugin to filename, for the next
+ * frames screen updates (0 records until gfx_trace_stop) */
+int gfx_trace_start(const char* filename, unsigned int frames);
+void gfx_trace_stop(void);
+
+#endif
+
+#endif /* M64P_MAIN_GFX_TRACE_H */
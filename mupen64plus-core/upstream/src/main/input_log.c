@@ -0,0 +1,275 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - input_log.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "input_log.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "rom.h"
+#include "savestates.h"
+
+enum { INPUT_LOG_HEADER_SIZE = 5 * 4 };
+enum { INPUT_LOG_RECORD_SIZE = INPUT_LOG_CONTROLLERS * 4 };
+
+struct input_log
+{
+    m64p_input_log_mode mode;
+    FILE* file;
+    uint32_t present;
+
+    /* replay: all records, read when the replay starts */
+    uint8_t* records;
+    size_t count;
+
+    /* record: last buttons read from each controller */
+    uint32_t keys[INPUT_LOG_CONTROLLERS];
+
+    size_t frame;
+    int started;
+};
+
+static struct input_log l_log;
+
+
+static void store_le32(uint8_t* p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t load_le32(const uint8_t* p)
+{
+    return (uint32_t)p[0]
+        | ((uint32_t)p[1] << 8)
+        | ((uint32_t)p[2] << 16)
+        | ((uint32_t)p[3] << 24);
+}
+
+static int write_header(void)
+{
+    uint8_t buf[INPUT_LOG_HEADER_SIZE];
+
+    store_le32(buf + 0, INPUT_LOG_MAGIC);
+    store_le32(buf + 4, INPUT_LOG_VERSION);
+    store_le32(buf + 8, ROM_HEADER.CRC1);
+    store_le32(buf + 12, ROM_HEADER.CRC2);
+    store_le32(buf + 16, l_log.present);
+
+    return fseek(l_log.file, 0, SEEK_SET) == 0
+        && fwrite(buf, sizeof(buf), 1, l_log.file) == 1;
+}
+
+static m64p_error start_record(const char* filename)
+{
+    l_log.file = fopen(filename, "wb");
+    if (l_log.file == NULL || !write_header())
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to open input log '%s' for writing", filename);
+        if (l_log.file != NULL)
+            fclose(l_log.file);
+        l_log.file = NULL;
+        return M64ERR_FILES;
+    }
+
+    DebugMessage(M64MSG_INFO, "Recording input to '%s'", filename);
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error start_replay(const char* filename)
+{
+    uint8_t buf[INPUT_LOG_HEADER_SIZE];
+    long size;
+    FILE* f = fopen(filename, "rb");
+
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to open input log '%s'", filename);
+        return M64ERR_FILES;
+    }
+
+    if (fread(buf, sizeof(buf), 1, f) != 1
+     || load_le32(buf + 0) != INPUT_LOG_MAGIC
+     || load_le32(buf + 4) != INPUT_LOG_VERSION)
+    {
+        DebugMessage(M64MSG_ERROR, "'%s' is not a supported input log", filename);
+        fclose(f);
+        return M64ERR_INPUT_INVALID;
+    }
+
+    if (load_le32(buf + 8) != ROM_HEADER.CRC1 || load_le32(buf + 12) != ROM_HEADER.CRC2)
+        DebugMessage(M64MSG_WARNING, "Input log '%s' was recorded with another ROM", filename);
+
+    l_log.present = load_le32(buf + 16);
+
+    if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < INPUT_LOG_HEADER_SIZE
+     || fseek(f, INPUT_LOG_HEADER_SIZE, SEEK_SET) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to read input log '%s'", filename);
+        fclose(f);
+        return M64ERR_FILES;
+    }
+
+    l_log.count = (size_t)(size - INPUT_LOG_HEADER_SIZE) / INPUT_LOG_RECORD_SIZE;
+    l_log.records = malloc(l_log.count * INPUT_LOG_RECORD_SIZE + 1);
+    if (l_log.records == NULL)
+    {
+        fclose(f);
+        return M64ERR_NO_MEMORY;
+    }
+
+    if (l_log.count != 0 && fread(l_log.records, l_log.count * INPUT_LOG_RECORD_SIZE, 1, f) != 1)
+    {
+        DebugMessage(M64MSG_ERROR, "Failed to read input log '%s'", filename);
+        free(l_log.records);
+        l_log.records = NULL;
+        fclose(f);
+        return M64ERR_FILES;
+    }
+
+    fclose(f);
+    DebugMessage(M64MSG_INFO, "Replaying %u VIs of input from '%s'", (unsigned int)l_log.count, filename);
+    return M64ERR_SUCCESS;
+}
+
+m64p_error input_log_start(m64p_input_log_mode mode, const char* filename)
+{
+    m64p_error rval;
+
+    input_log_stop();
+
+    if (mode == M64INPUT_LOG_STOP)
+        return M64ERR_SUCCESS;
+    if (filename == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    memset(&l_log, 0, sizeof(l_log));
+
+    switch (mode)
+    {
+    case M64INPUT_LOG_RECORD: rval = start_record(filename); break;
+    case M64INPUT_LOG_REPLAY: rval = start_replay(filename); break;
+    default: return M64ERR_INPUT_INVALID;
+    }
+
+    if (rval == M64ERR_SUCCESS)
+        l_log.mode = mode;
+    return rval;
+}
+
+void input_log_stop(void)
+{
+    int written;
+
+    switch (l_log.mode)
+    {
+    case M64INPUT_LOG_RECORD:
+        /* plugged controllers are only known once they have been read */
+        written = write_header();
+        if (fclose(l_log.file) != 0 || !written)
+            DebugMessage(M64MSG_ERROR, "Failed to write input log");
+        else
+            DebugMessage(M64MSG_INFO, "Recorded %u VIs of input", (unsigned int)l_log.frame);
+        l_log.file = NULL;
+        break;
+    case M64INPUT_LOG_REPLAY:
+        free(l_log.records);
+        l_log.records = NULL;
+        break;
+    default:
+        break;
+    }
+
+    l_log.mode = M64INPUT_LOG_STOP;
+}
+
+int input_log_filter(int control_id, int present, BUTTONS* keys)
+{
+    if (control_id < 0 || control_id >= INPUT_LOG_CONTROLLERS)
+        return present;
+
+    switch (l_log.mode)
+    {
+    case M64INPUT_LOG_RECORD:
+        if (present)
+            l_log.present |= UINT32_C(1) << control_id;
+        l_log.keys[control_id] = present ? keys->Value : 0;
+        break;
+    case M64INPUT_LOG_REPLAY:
+        if (!l_log.started)
+            break;
+        present = (l_log.present >> control_id) & 1;
+        keys->Value = load_le32(l_log.records
+            + l_log.frame * INPUT_LOG_RECORD_SIZE + control_id * 4);
+        break;
+    default:
+        break;
+    }
+
+    return present;
+}
+
+void input_log_new_vi(void)
+{
+    uint8_t buf[INPUT_LOG_RECORD_SIZE];
+    int i;
+
+    if (l_log.mode == M64INPUT_LOG_STOP)
+        return;
+
+    if (!l_log.started)
+    {
+        if (savestates_get_job() == savestates_job_load)
+            return;
+
+        l_log.started = 1;
+        l_log.frame = 0;
+        if (l_log.mode == M64INPUT_LOG_REPLAY && l_log.count == 0)
+            input_log_stop();
+        return;
+    }
+
+    if (l_log.mode == M64INPUT_LOG_RECORD)
+    {
+        for (i = 0; i < INPUT_LOG_CONTROLLERS; ++i)
+            store_le32(buf + i * 4, l_log.keys[i]);
+
+        if (fwrite(buf, sizeof(buf), 1, l_log.file) != 1)
+        {
+            DebugMessage(M64MSG_ERROR, "Failed to write input log, stopping");
+            input_log_stop();
+            return;
+        }
+        ++l_log.frame;
+    }
+    else if (++l_log.frame >= l_log.count)
+    {
+        DebugMessage(M64MSG_INFO, "Input replay finished after %u VIs", (unsigned int)l_log.frame);
+        input_log_stop();
+    }
+}
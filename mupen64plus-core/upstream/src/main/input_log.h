@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - input_log.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef M64P_MAIN_INPUT_LOG_H
+#define M64P_MAIN_INPUT_LOG_H
+
+#include <stdint.h>
+
+#include "api/m64p_plugin.h"
+#include "api/m64p_types.h"
+
+/* Controller input log, recorded and replayed once per VI.
+ *
+ * The file starts with a header, followed by one record per VI holding the
+ * buttons of the 4 controllers, all in little endian. While recording, the
+ * last buttons read from the input plugin during a VI are stored; while
+ * replaying, they are returned to every read until the next VI. Logs start
+ * at the first VI after a pending savestate has been loaded, so that a run
+ * started from the same savestate gets the same input on the same frames.
+ * Run-ahead should be disabled while recording or replaying. */
+
+#define INPUT_LOG_MAGIC 0x4c49344d /* "M4IL" */
+#define INPUT_LOG_VERSION 1
+
+enum { INPUT_LOG_CONTROLLERS = 4 };
+
+struct input_log_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rom_crc1;
+    uint32_t rom_crc2;
+    uint32_t present;   /* bit i set if controller i was plugged */
+};
+
+/* Has to be called while the emulator is not running */
+m64p_error input_log_start(m64p_input_log_mode mode, const char* filename);
+void input_log_stop(void);
+
+/* called by the input backend after polling a controller,
+ * returns the plugged state to use for it */
+int input_log_filter(int control_id, int present, BUTTONS* keys);
+
+/* called on every VI by the main loop */
+void input_log_new_vi(void);
+
+#endif
@@ -35,6 +35,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
 #define M64P_CORE_PROTOTYPES 1
 #include "api/callbacks.h"
 #include "api/config.h"
@@ -60,6 +67,8 @@
 #include "device/gb/gb_cart.h"
 #include "device/pif/bootrom_hle.h"
 #include "eventloop.h"
+#include "gfx_trace.h"
+#include "input_log.h"
 #include "main.h"
 #include "cheat.h"
 #include "osal/files.h"
@@ -67,17 +76,23 @@
 #include "osd/osd.h"
 #include "osd/screenshot.h"
 #include "plugin/plugin.h"
-#if defined(PROFILE)
 #include "profile.h"
-#endif
+#include "rewind.h"
+#include "runahead.h"
 #include "rom.h"
+#include "rsp_async.h"
 #include "savestates.h"
+#include "thread_placement.h"
 #include "util.h"
 
 #ifdef DBG
 #include "debugger/dbg_debugger.h"
 #endif
 
+#ifdef PROFILE_BLOCKS
+#include "device/r4300/block_profiler.h"
+#endif
+
 #ifdef WITH_LIRC
 #include "lirc.h"
 #endif //WITH_LIRC
@@ -116,6 +131,9 @@ static int   l_TakeScreenshot = 0;       // Tell OSD Rendering callback to take
 static int   l_SpeedFactor = 100;        // percentage of nominal game speed at which emulator is running
 static int   l_FrameAdvance = 0;         // variable to check if we pause on next frame
 static int   l_MainSpeedLimit = 1;       // insert delay during vi_interrupt to keep speed at real-time
+static int   l_TrimMemoryLevel = 0;      // m64p_trim_level requested while the emulator runs, 0 if none
+static int   l_AudioOutFlushPending = 0; // speed factor changed, push the batched samples at the next VI
+static int   l_RenderSkip = 0;           // display lists the video plugin skips after each rendered one
 
 static osd_message_t *l_msgVol = NULL;
 static osd_message_t *l_msgFF = NULL;
@@ -125,6 +143,8 @@ static osd_message_t *l_msgPause = NULL;
 enum { PAK_MAX_SIZE = 4 };
 static size_t l_paks_idx[GAME_CONTROLLERS_COUNT];
 static void* l_paks[GAME_CONTROLLERS_COUNT][PAK_MAX_SIZE];
+
+static struct audio_out_batch l_aout_batch; // used if the audio plugin has the AiPushSamples extension
 static const struct pak_interface* l_ipaks[PAK_MAX_SIZE];
 static size_t l_pak_type_idx[6];
 
@@ -213,7 +233,7 @@ static void main_check_inputs(void)
 #ifdef WITH_LIRC
     lircCheckInput();
 #endif
-    SDL_PumpEvents();
+    event_check_inputs();
 }
 
 /*********************************************************************************************************
@@ -259,8 +279,12 @@ int main_set_core_defaults(void)
     ConfigSetDefaultBool(g_CoreConfig, "NoCompiledJump", 0, "Disable compiled jump commands in dynamic recompiler (should be set to False) ");
     ConfigSetDefaultBool(g_CoreConfig, "DisableExtraMem", 0, "Disable 4MB expansion RAM pack. May be necessary for some games");
     ConfigSetDefaultBool(g_CoreConfig, "AutoStateSlotIncrement", 0, "Increment the save state slot after each save operation");
-    ConfigSetDefaultBool(g_CoreConfig, "EnableDebugger", 0, "Activate the R4300 debugger when ROM execution begins, if core was built with Debugger support");
+    ConfigSetDefaultBool(g_CoreConfig, "EnableDebugger", 0, "Activate the R4300 debugger when ROM execution begins, if core was built with Debugger support. The Dynamic Recompiler is replaced by the Cached Interpreter");
     ConfigSetDefaultInt(g_CoreConfig, "CurrentStateSlot", 0, "Save state slot (0-9) to use when saving/loading the emulator state");
+    ConfigSetDefaultInt(g_CoreConfig, "RewindBufferSize", 0, "Memory budget in MB of the rewind history (0 disables rewinding). Must be at least 33 MB");
+    ConfigSetDefaultInt(g_CoreConfig, "RewindInterval", 1, "Number of VIs between two rewind captures");
+    ConfigSetDefaultInt(g_CoreConfig, "RunAheadFrames", 0, "Number of frames emulated ahead of the inputs to hide the game's own input lag (0 disables run-ahead). Each frame costs a full emulated frame and a savestate");
+    ConfigSetDefaultInt(g_CoreConfig, "SaveStateCompressionLevel", 1, "Gzip compression level (0-9) of Mupen64Plus save states. Lower is faster, higher gives smaller files");
     ConfigSetDefaultString(g_CoreConfig, "ScreenshotPath", "", "Path to directory where screenshots are saved. If this is blank, the default value of ${UserDataPath}/screenshot will be used");
     ConfigSetDefaultString(g_CoreConfig, "SaveStatePath", "", "Path to directory where emulator save states (snapshots) are saved. If this is blank, the default value of ${UserDataPath}/save will be used");
     ConfigSetDefaultString(g_CoreConfig, "SaveSRAMPath", "", "Path to directory where SRAM/EEPROM data (in-game saves) are stored. If this is blank, the default value of ${UserDataPath}/save will be used");
@@ -269,6 +293,11 @@ int main_set_core_defaults(void)
     ConfigSetDefaultBool(g_CoreConfig, "DisableSpecRecomp", 1, "Disable speculative precompilation in new dynarec");
     ConfigSetDefaultBool(g_CoreConfig, "RandomizeInterrupt", 1, "Randomize PI/SI Interrupt Timing");
     ConfigSetDefaultInt(g_CoreConfig, "SiDmaDuration", -1, "Duration of SI DMA (-1: use per game settings)");
+    ConfigSetDefaultBool(g_CoreConfig, "AsyncAudioRsp", 0, "Run RSP audio tasks on a separate thread, alongside the emulated CPU (experimental)");
+    ConfigSetDefaultBool(g_CoreConfig, "AsyncAudioRspLookahead", 0, "With AsyncAudioRsp, only wait for audio tasks where their output is used instead of on every interrupt");
+    ConfigSetDefaultBool(g_CoreConfig, "ThreadPlacement", 0, "On CPUs with big and little cores, keep the emulation thread on the big cores, worker threads off the little cores and background work on the little cores");
+    ConfigSetDefaultString(g_CoreConfig, "GfxTraceFile", "", "Record the memory and registers seen by the video plugin to this file, for replay with gfx_bench. Leave blank to disable");
+    ConfigSetDefaultInt(g_CoreConfig, "GfxTraceFrames", 0, "Number of frames to record to GfxTraceFile (0: until the emulation stops)");
 
     /* handle upgrades */
     if (bUpgrade)
@@ -295,6 +324,7 @@ void main_speeddown(int percent)
         l_SpeedFactor -= percent;
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "%s %d%%", "Playback speed:", l_SpeedFactor);
         audio.setSpeedFactor(l_SpeedFactor);
+        l_AudioOutFlushPending = 1;
         StateChanged(M64CORE_SPEED_FACTOR, l_SpeedFactor);
     }
 }
@@ -306,6 +336,7 @@ void main_speedup(int percent)
         l_SpeedFactor += percent;
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "%s %d%%", "Playback speed:", l_SpeedFactor);
         audio.setSpeedFactor(l_SpeedFactor);
+        l_AudioOutFlushPending = 1;
         StateChanged(M64CORE_SPEED_FACTOR, l_SpeedFactor);
     }
 }
@@ -323,21 +354,35 @@ static void main_speedset(int percent)
     l_SpeedFactor = percent;
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "%s %d%%", "Playback speed:", l_SpeedFactor);
     audio.setSpeedFactor(l_SpeedFactor);
+    l_AudioOutFlushPending = 1;
     StateChanged(M64CORE_SPEED_FACTOR, l_SpeedFactor);
 }
 
+static void main_set_render_skip(int count)
+{
+    l_RenderSkip = count;
+    if (gfx.setRenderSkip != NULL)
+        gfx.setRenderSkip(count);
+    StateChanged(M64CORE_RENDER_SKIP, l_RenderSkip);
+}
+
 void main_set_fastforward(int enable)
 {
     static int ff_state = 0;
     static int SavedSpeedFactor = 100;
+    static int SavedRenderSkip = 0;
 
     if (enable && !ff_state)
     {
         ff_state = 1; /* activate fast-forward */
         SavedSpeedFactor = l_SpeedFactor;
+        SavedRenderSkip = l_RenderSkip;
         l_SpeedFactor = 250;
         audio.setSpeedFactor(l_SpeedFactor);
+        l_AudioOutFlushPending = 1;
         StateChanged(M64CORE_SPEED_FACTOR, l_SpeedFactor);
+        /* render every other frame */
+        main_set_render_skip(1);
         // set fast-forward indicator
         l_msgFF = osd_new_message(OSD_TOP_RIGHT, "Fast Forward");
         osd_message_set_static(l_msgFF);
@@ -348,7 +393,9 @@ void main_set_fastforward(int enable)
         ff_state = 0; /* de-activate fast-forward */
         l_SpeedFactor = SavedSpeedFactor;
         audio.setSpeedFactor(l_SpeedFactor);
+        l_AudioOutFlushPending = 1;
         StateChanged(M64CORE_SPEED_FACTOR, l_SpeedFactor);
+        main_set_render_skip(SavedRenderSkip);
         // remove message
         osd_delete_message(l_msgFF);
         l_msgFF = NULL;
@@ -404,6 +451,56 @@ void main_advance_one(void)
     StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 }
 
+static void trim_memory(int level)
+{
+    unsigned int released = 0;
+
+    if (level >= M64TRIM_CRITICAL)
+        released += (unsigned int) rewind_trim();
+
+    released += plugin_trim_memory(level);
+
+    DebugMessage(M64MSG_INFO, "Memory trim level %i: %u KB released", level, released / 1024);
+}
+
+void main_trim_memory(int level)
+{
+    /* the caches belong to the emulation thread, which handles the request at its next VI */
+    if (!g_EmulatorRunning)
+    {
+        trim_memory(level);
+        return;
+    }
+
+    if (level > l_TrimMemoryLevel)
+        l_TrimMemoryLevel = level;
+}
+
+static void main_trim_memory_pending(void)
+{
+    int level = l_TrimMemoryLevel;
+
+    if (level == 0)
+        return;
+
+    l_TrimMemoryLevel = 0;
+    trim_memory(level);
+}
+
+void main_audio_out_flush(void)
+{
+    /* a no-op unless the audio plugin has the AiPushSamples extension */
+    l_AudioOutFlushPending = 0;
+    audio_out_batch_flush(&l_aout_batch);
+}
+
+static void main_audio_out_flush_pending(void)
+{
+    /* the batch belongs to the emulation thread, speed changes may come from any */
+    if (l_AudioOutFlushPending)
+        main_audio_out_flush();
+}
+
 static void main_draw_volume_osd(void)
 {
     char msgString[64];
@@ -519,6 +616,9 @@ m64p_error main_core_state_query(m64p_core_param param, int *rval)
         case M64CORE_INPUT_GAMESHARK:
             *rval = event_gameshark_active();
             break;
+        case M64CORE_RENDER_SKIP:
+            *rval = l_RenderSkip;
+            break;
         // these are only used for callbacks; they cannot be queried or set
         case M64CORE_STATE_LOADCOMPLETE:
         case M64CORE_STATE_SAVECOMPLETE:
@@ -614,6 +714,13 @@ m64p_error main_core_state_set(m64p_core_param param, int val)
                 return M64ERR_INVALID_STATE;
             event_set_gameshark(val);
             return M64ERR_SUCCESS;
+        case M64CORE_RENDER_SKIP:
+            if (!g_EmulatorRunning)
+                return M64ERR_INVALID_STATE;
+            if (val < 0 || val > 9)
+                return M64ERR_INPUT_INVALID;
+            main_set_render_skip(val);
+            return M64ERR_SUCCESS;
         // these are only used for callbacks; they cannot be queried or set
         case M64CORE_STATE_LOADCOMPLETE:
         case M64CORE_STATE_SAVECOMPLETE:
@@ -744,85 +851,108 @@ void new_frame(void)
     }
 }
 
-#define SAMPLE_COUNT 3
+/* The speed limiter sleeps until an absolute deadline per VI, so the time spent
+ * emulating a frame and the sleep overshoot don't add up into drift. The OS
+ * sleep is ended early by the spin window and the rest is waited out on the
+ * clock, which keeps the wake-up jitter of the scheduler out of frame delivery. */
+#if defined(WIN32)
+/* Sleep() may overshoot by a whole scheduler tick */
+#define SPEED_LIMITER_SPIN_NS 2000000LL
+
+static long long int speed_limiter_time(void)
+{
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER counter;
+
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (counter.QuadPart / freq.QuadPart) * 1000000000
+         + (counter.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+}
+
+static void speed_limiter_sleep_until(long long int deadline)
+{
+    long long int remaining = deadline - speed_limiter_time() - SPEED_LIMITER_SPIN_NS;
+
+    if (remaining > 0)
+        SDL_Delay((unsigned int)(remaining / 1000000));
+}
+#else
+#define SPEED_LIMITER_SPIN_NS 200000LL
+
+static long long int speed_limiter_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long int)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void speed_limiter_sleep_until(long long int deadline)
+{
+    long long int wake = deadline - SPEED_LIMITER_SPIN_NS;
+    struct timespec ts;
+
+#if defined(__APPLE__)
+    /* no clock_nanosleep, the relative sleep is still aimed at the deadline */
+    wake -= speed_limiter_time();
+    if (wake <= 0)
+        return;
+    ts.tv_sec = (time_t)(wake / 1000000000);
+    ts.tv_nsec = (long)(wake % 1000000000);
+    while (nanosleep(&ts, &ts) == EINTR)
+        ;
+#else
+    ts.tv_sec = (time_t)(wake / 1000000000);
+    ts.tv_nsec = (long)(wake % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+#endif
+}
+#endif
+
 static void apply_speed_limiter(void)
 {
-    static unsigned long totalVIs = 0;
-    static int resetOnce = 0;
+    static long long int deadline = 0;
     static int lastSpeedFactor = 100;
-    static unsigned int StartFPSTime = 0;
-    static const double defaultSpeedFactor = 100.0;
-    unsigned int CurrentFPSTime = SDL_GetTicks();
-    static double sleepTimes[SAMPLE_COUNT];
-    static unsigned int sleepTimesIndex = 0;
 
-    // calculate frame duration based upon ROM setting (50/60hz) and mupen64plus speed adjustment
-    const double VILimitMilliseconds = 1000.0 / g_dev.vi.expected_refresh_rate;
-    const double SpeedFactorMultiple = defaultSpeedFactor/l_SpeedFactor;
-    const double AdjustedLimit = VILimitMilliseconds * SpeedFactorMultiple;
+    /* more behind or ahead of the deadline than this was a pause, a load or a
+     * clock jump, the limiter restarts from now instead of catching up */
+    static const long long int maxLagNs = 50000000;
 
-    //if this is the first time or we are resuming from pause
-    if(StartFPSTime == 0 || !resetOnce || lastSpeedFactor != l_SpeedFactor)
-    {
-       StartFPSTime = CurrentFPSTime;
-       totalVIs = 0;
-       resetOnce = 1;
-    }
-    else
-    {
-        ++totalVIs;
-    }
+    long long int now = speed_limiter_time();
 
-    lastSpeedFactor = l_SpeedFactor;
+    // calculate frame duration based upon ROM setting (50/60hz) and mupen64plus speed adjustment
+    const long long int viRate = (long long int)g_dev.vi.expected_refresh_rate * l_SpeedFactor;
+    // without a refresh rate there is nothing to limit to, and 0 below means so
+    const long long int viPeriodNs = (viRate > 0) ? 1000000000LL * 100 / viRate : 0;
 
-#if defined(PROFILE)
     timed_section_start(TIMED_SECTION_IDLE);
-#endif
 
 #ifdef DBG
     if(g_DebuggerActive) DebuggerCallback(DEBUG_UI_VI, 0);
 #endif
 
-    double totalElapsedGameTime = AdjustedLimit*totalVIs;
-    double elapsedRealTime = CurrentFPSTime - StartFPSTime;
-    double sleepTime = totalElapsedGameTime - elapsedRealTime;
-
-    //Reset if the sleep needed is an unreasonable value
-    static const double minSleepNeeded = -50;
-    static const double maxSleepNeeded = 50;
-    if(sleepTime < minSleepNeeded || sleepTime > (maxSleepNeeded*SpeedFactorMultiple))
+    if (!l_MainSpeedLimit || viPeriodNs == 0 || deadline == 0 || lastSpeedFactor != l_SpeedFactor
+     || now - deadline > maxLagNs * 100 / l_SpeedFactor
+     || deadline - now > viPeriodNs + maxLagNs)
     {
-       resetOnce = 0;
-    }
-
-    sleepTimes[sleepTimesIndex%SAMPLE_COUNT] = sleepTime;
-    sleepTimesIndex++;
-
-    unsigned int elementsForAverage = sleepTimesIndex > SAMPLE_COUNT ? SAMPLE_COUNT : sleepTimesIndex;
-
-    // compute the average sleepTime
-    double sum = 0;
-    unsigned int index;
-    for(index = 0; index < elementsForAverage; index++)
-    {
-        sum += sleepTimes[index];
+        deadline = now + viPeriodNs;
+        lastSpeedFactor = l_SpeedFactor;
+        timed_section_end(TIMED_SECTION_IDLE);
+        return;
     }
 
-    double averageSleep = sum/elementsForAverage;
-
-    int sleepMs = (int)averageSleep;
-
-    if(sleepMs > 0 && sleepMs < maxSleepNeeded*SpeedFactorMultiple && l_MainSpeedLimit)
+    if (deadline > now)
     {
-       DebugMessage(M64MSG_VERBOSE, "    apply_speed_limiter(): Waiting %ims", sleepMs);
-
-       SDL_Delay(sleepMs);
+        speed_limiter_sleep_until(deadline);
+        while (speed_limiter_time() < deadline)
+            ;
     }
 
+    deadline += viPeriodNs;
 
-#if defined(PROFILE)
     timed_section_end(TIMED_SECTION_IDLE);
-#endif
 }
 
 /* TODO: make a GameShark module and move that there */
@@ -846,12 +976,15 @@ static void pause_loop(void)
 {
     if(g_rom_pause)
     {
+        main_audio_out_flush();
+        flush_file_storages(1);
         osd_render();  // draw Paused message in case gfx.updateScreen didn't do it
         VidExt_GL_SwapBuffers();
         while(g_rom_pause)
         {
             SDL_Delay(10);
             main_check_inputs();
+            main_trim_memory_pending();
         }
     }
 }
@@ -866,8 +999,20 @@ void new_vi(void)
 
     gs_apply_cheats(&g_cheat_ctx);
 
+    /* frames emulated ahead take no real time */
+    if (runahead_new_vi())
+        return;
+
+    timed_sections_new_vi();
+    input_log_new_vi();
+
+    /* before the limiter waits at the new speed */
+    main_audio_out_flush_pending();
     apply_speed_limiter();
     main_check_inputs();
+    rewind_new_vi();
+    main_trim_memory_pending();
+    flush_file_storages(0);
 
     pause_loop();
 }
@@ -1035,8 +1180,8 @@ static void load_dd_disk(struct file_storage* dd_disk, const struct storage_back
         goto no_disk;
     }
 
-    /* open file */
-    if (open_rom_file_storage(dd_disk, dd_disk_filename) != file_ok) {
+    /* open file, MAME dumps are then accessed and written back in place */
+    if (open_journal_file_storage(dd_disk, dd_disk_filename) != file_ok) {
         DebugMessage(M64MSG_ERROR, "Failed to load DD Disk: %s.", dd_disk_filename);
         goto no_disk;
     }
@@ -1062,9 +1207,7 @@ static void load_dd_disk(struct file_storage* dd_disk, const struct storage_back
         }
 
         dd_convert_to_mame(buffer, dd_disk->data);
-        free(dd_disk->data);
-        dd_disk->data = buffer;
-        dd_disk->size = MAME_FORMAT_DUMP_SIZE;
+        replace_file_storage_data(dd_disk, buffer, MAME_FORMAT_DUMP_SIZE);
         *dd_idisk = &g_ifile_storage_dd_sdk_dump;
         format_desc = "SDK";
         } break;
@@ -1256,13 +1399,24 @@ m64p_error main_run(void)
     /* XXX: select type of flashram from db */
     uint32_t flashram_type = MX29L1100_ID;
 
+    /* the ROM database settings are needed from here on */
+    wait_rom_settings();
 
     /* take the r4300 emulator mode from the config file at this point and cache it in a global variable */
     emumode = ConfigGetParamInt(g_CoreConfig, "R4300Emulator");
+#ifdef DBG
+    /* recompiled code does not stop on breakpoints, the cached interpreter checks the instructions they are on */
+    if (emumode == EMUMODE_DYNAREC && ConfigGetParamBool(g_CoreConfig, "EnableDebugger"))
+    {
+        DebugMessage(M64MSG_WARNING, "Debugger enabled, using the cached interpreter instead of the dynamic recompiler");
+        emumode = EMUMODE_INTERPRETER;
+    }
+#endif
 
     /* set some other core parameters based on the config file values */
     savestates_set_autoinc_slot(ConfigGetParamBool(g_CoreConfig, "AutoStateSlotIncrement"));
     savestates_select_slot(ConfigGetParamInt(g_CoreConfig, "CurrentStateSlot"));
+    savestates_set_compression_level(ConfigGetParamInt(g_CoreConfig, "SaveStateCompressionLevel"));
     no_compiled_jump = ConfigGetParamBool(g_CoreConfig, "NoCompiledJump");
     randomize_interrupt = ConfigGetParamBool(g_CoreConfig, "RandomizeInterrupt");
 #ifdef NEW_DYNAREC
@@ -1271,6 +1425,9 @@ m64p_error main_run(void)
 
     count_per_op = ConfigGetParamInt(g_CoreConfig, "CountPerOp");
 
+    /* main_run is called from the thread which runs the emulation */
+    thread_placement_apply(M64THREAD_EMULATION);
+
     if (ROM_PARAMS.disableextramem)
         disable_extra_mem = ROM_PARAMS.disableextramem;
     else
@@ -1463,13 +1620,22 @@ m64p_error main_run(void)
     }
 
 
+    /* batch samples and bypass the AI registers if the audio plugin can take them directly */
+    void* aout = &g_dev.ai;
+    const struct audio_out_backend_interface* iaout = &g_iaudio_out_backend_plugin_compat;
+    if (audio.aiPushSamples != NULL) {
+        init_audio_out_batch(&l_aout_batch, &g_dev.ai);
+        aout = &l_aout_batch;
+        iaout = &g_iaudio_out_backend_plugin_batch;
+    }
+
     init_device(&g_dev,
                 g_mem_base,
                 emumode,
                 count_per_op,
                 no_compiled_jump,
                 randomize_interrupt,
-                &g_dev.ai, &g_iaudio_out_backend_plugin_compat,
+                aout, iaout,
                 si_dma_duration,
                 rdram_size,
                 joybus_devices, ijoybus_devices,
@@ -1490,6 +1656,11 @@ m64p_error main_run(void)
     {
         goto on_gfx_open_failure;
     }
+    if (strlen(ConfigGetParamString(g_CoreConfig, "GfxTraceFile")) != 0)
+    {
+        gfx_trace_start(ConfigGetParamString(g_CoreConfig, "GfxTraceFile"),
+                        (unsigned int)ConfigGetParamInt(g_CoreConfig, "GfxTraceFrames"));
+    }
     if (!audio.romOpen())
     {
         goto on_audio_open_failure;
@@ -1529,10 +1700,33 @@ m64p_error main_run(void)
     g_EmulatorRunning = 1;
     StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 
+    /* the video plugin starts out rendering every display list */
+    l_RenderSkip = 0;
+
+    rewind_init((size_t)ConfigGetParamInt(g_CoreConfig, "RewindBufferSize") * 1024 * 1024,
+                ConfigGetParamInt(g_CoreConfig, "RewindInterval"));
+    runahead_init(ConfigGetParamInt(g_CoreConfig, "RunAheadFrames"));
+
+    if (ConfigGetParamBool(g_CoreConfig, "AsyncAudioRsp"))
+        rsp_async_init(ConfigGetParamBool(g_CoreConfig, "AsyncAudioRspLookahead"));
+
+#ifdef PROFILE_BLOCKS
+    /* a dump only covers the ROM being run, even after it stops */
+    block_profiler_reset();
+#endif
+
     poweron_device(&g_dev);
     pif_bootrom_hle_execute(&g_dev.r4300);
     run_device(&g_dev);
 
+    main_audio_out_flush();
+    rsp_async_deinit();
+    rewind_deinit();
+    runahead_deinit();
+    gfx_trace_stop();
+    input_log_stop();
+    timed_sections_set_output(NULL);
+
     /* now begin to shut down */
 #ifdef WITH_LIRC
     lircStop();
@@ -1575,6 +1769,7 @@ m64p_error main_run(void)
 on_input_open_failure:
     audio.romClosed();
 on_audio_open_failure:
+    gfx_trace_stop();
     gfx.romClosed();
 on_gfx_open_failure:
     /* release gb_carts */
@@ -66,6 +66,8 @@ m64p_error main_run(void);
 void main_stop(void);
 void main_toggle_pause(void);
 void main_advance_one(void);
+void main_trim_memory(int level);
+void main_audio_out_flush(void);
 
 void main_speedup(int percent);
 void main_speeddown(int percent);
@@ -23,11 +23,68 @@
 
 #include "profile.h"
 
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
+#include "main/main.h"
+#include "main/savestates.h"
+
+enum { MAX_SECTION_DEPTH = 8 };
+
+static const char* const section_names[NUM_TIMED_SECTIONS] =
+{
+    "cpu", "compiler", "interrupts", "DoRspCycles",
+    "ProcessDList", "ProcessRDPList", "UpdateScreen",
+    "ProcessAList", "audio samples", "speed limiter"
+};
+
+struct open_section
+{
+    enum timed_section outer;
+    long long int start;
+};
+
+/* one run of a section, as raw get_time() values */
+struct timed_event
+{
+    long long int start;
+    uint32_t duration;
+    uint32_t section;
+};
 
 static long long int time_in_section[NUM_TIMED_SECTIONS];
-static long long int last_start[NUM_TIMED_SECTIONS];
+static long long int last_reported[NUM_TIMED_SECTIONS];
+static long long int last_refresh;
+
+static struct open_section section_stack[MAX_SECTION_DEPTH];
+static unsigned int section_depth;
+static enum timed_section current_section = TIMED_SECTION_CPU;
+static long long int last_switch;
+
+#if defined(PROFILE)
+static int l_enabled = 1;
+#else
+static int l_enabled = 0;
+#endif
+
+/* set by the front-end thread, picked up by the emulation thread at the next VI */
+static m64p_profile_timings* volatile l_requested_timings;
+static m64p_profile_timings* l_timings;
+static int l_timings_started;
+static long long int l_timings_start;
+static long long int l_timings_base[NUM_TIMED_SECTIONS];
+static long long int l_frame_base[NUM_TIMED_SECTIONS];
+static long long int l_last_vi;
+
+/* rings, allocated the first time timings are collected */
+static m64p_profile_frame* l_frames;
+static unsigned int l_frame_count;
+static struct timed_event* l_events;
+static unsigned int l_event_count;
 
 #if defined(WIN32) && !defined(__MINGW32__)
   // timing
@@ -44,7 +101,9 @@ static long long int last_start[NUM_TIMED_SECTIONS];
       static LARGE_INTEGER freq = { 0 };
       if (freq.QuadPart == 0)
           QueryPerformanceFrequency(&freq);
-      return time * 1000000000 / freq.QuadPart;
+      /* split to not overflow on long runs */
+      return (time / freq.QuadPart) * 1000000000
+           + (time % freq.QuadPart) * 1000000000 / freq.QuadPart;
   }
 
 #else  /* Not WIN32 */
@@ -63,37 +122,280 @@ static long long int last_start[NUM_TIMED_SECTIONS];
   }
 #endif
 
+static void switch_section(long long int now, enum timed_section section)
+{
+   time_in_section[current_section] += now - last_switch;
+   last_switch = now;
+   current_section = section;
+}
+
 void timed_section_start(enum timed_section section)
 {
-   last_start[section] = get_time();
+   long long int now;
+
+   if (!l_enabled)
+      return;
+
+   now = get_time();
+   if (section_depth < MAX_SECTION_DEPTH)
+   {
+      section_stack[section_depth].outer = current_section;
+      section_stack[section_depth].start = now;
+   }
+   ++section_depth;
+
+   switch_section(now, section);
 }
 
 void timed_section_end(enum timed_section section)
 {
-   long long int end = get_time();
-   time_in_section[section] += end - last_start[section];
+   enum timed_section outer = TIMED_SECTION_CPU;
+   long long int now;
+
+   if (!l_enabled || section_depth == 0)
+      return;
+
+   now = get_time();
+   --section_depth;
+   if (section_depth < MAX_SECTION_DEPTH)
+   {
+      outer = section_stack[section_depth].outer;
+
+      if (l_timings_started && l_events != NULL)
+      {
+         struct timed_event* event = &l_events[l_event_count++ % PROFILE_EVENT_COUNT];
+         long long int duration = now - section_stack[section_depth].start;
+
+         event->start = section_stack[section_depth].start;
+         event->duration = (duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration;
+         event->section = section;
+      }
+   }
+
+   switch_section(now, outer);
 }
 
 void timed_sections_refresh()
 {
    long long int curr_time = get_time();
-   if(time_to_nsec(curr_time - last_start[TIMED_SECTION_ALL]) >= 2000000000)
+   long long int all = curr_time - last_refresh;
+   char line[512];
+   int i, len;
+
+   if(time_to_nsec(all) < 2000000000)
+      return;
+
+   switch_section(curr_time, current_section);
+
+   len = 0;
+   for (i = 0; i < NUM_TIMED_SECTIONS && len < (int)sizeof(line); ++i)
    {
-      time_in_section[TIMED_SECTION_ALL] = curr_time - last_start[TIMED_SECTION_ALL];
-      DebugMessage(M64MSG_INFO, "gfx=%f%% - audio=%f%% - compiler=%f%%, idle=%f%%",
-         100.0 * (double)time_in_section[TIMED_SECTION_GFX] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_AUDIO] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_COMPILER] / time_in_section[TIMED_SECTION_ALL],
-         100.0 * (double)time_in_section[TIMED_SECTION_IDLE] / time_in_section[TIMED_SECTION_ALL]);
-      DebugMessage(M64MSG_INFO, "gfx=%llins - audio=%llins - compiler %llins - idle=%llins",
-         time_to_nsec(time_in_section[TIMED_SECTION_GFX]),
-         time_to_nsec(time_in_section[TIMED_SECTION_AUDIO]),
-         time_to_nsec(time_in_section[TIMED_SECTION_COMPILER]),
-         time_to_nsec(time_in_section[TIMED_SECTION_IDLE]));
-      time_in_section[TIMED_SECTION_GFX] = 0;
-      time_in_section[TIMED_SECTION_AUDIO] = 0;
-      time_in_section[TIMED_SECTION_COMPILER] = 0;
-      time_in_section[TIMED_SECTION_IDLE] = 0;
-      last_start[TIMED_SECTION_ALL] = curr_time;
+      long long int delta = time_in_section[i] - last_reported[i];
+      last_reported[i] = time_in_section[i];
+
+      len += snprintf(line + len, sizeof(line) - len, "%s%s=%.2f%% (%llins)",
+                      (i == 0) ? "" : " - ", section_names[i],
+                      100.0 * (double)delta / all, time_to_nsec(delta));
    }
+   DebugMessage(M64MSG_INFO, "%s", line);
+
+   last_refresh = curr_time;
+}
+
+void timed_sections_set_output(m64p_profile_timings* timings)
+{
+   l_requested_timings = timings;
+}
+
+static unsigned long long section_nsec(enum timed_section section)
+{
+   return (unsigned long long)time_to_nsec(time_in_section[section] - l_timings_base[section]);
+}
+
+static void start_timings(long long int curr_time)
+{
+   int i;
+
+   if (l_frames == NULL)
+      l_frames = malloc(PROFILE_FRAME_COUNT * sizeof(*l_frames));
+   if (l_events == NULL)
+      l_events = malloc(PROFILE_EVENT_COUNT * sizeof(*l_events));
+   if (l_frames == NULL || l_events == NULL)
+      DebugMessage(M64MSG_WARNING, "Failed to allocate profiler frame history");
+
+   switch_section(curr_time, current_section);
+   for (i = 0; i < NUM_TIMED_SECTIONS; ++i)
+   {
+      l_timings_base[i] = time_in_section[i];
+      l_frame_base[i] = time_in_section[i];
+   }
+   l_timings_start = curr_time;
+   l_last_vi = curr_time;
+   l_frame_count = 0;
+   l_event_count = 0;
+   l_timings->vi_count = 0;
+   l_timings_started = 1;
+}
+
+static void record_frame(long long int curr_time)
+{
+   m64p_profile_frame* frame;
+   int i;
+
+   if (l_frames == NULL)
+      return;
+
+   frame = &l_frames[l_frame_count % PROFILE_FRAME_COUNT];
+   frame->vi = l_timings->vi_count;
+   frame->start_ns = (unsigned long long)time_to_nsec(l_last_vi - l_timings_start);
+   frame->total_ns = (unsigned long long)time_to_nsec(curr_time - l_last_vi);
+   for (i = 0; i < NUM_TIMED_SECTIONS; ++i)
+   {
+      frame->section_ns[i] = (unsigned long long)time_to_nsec(time_in_section[i] - l_frame_base[i]);
+      l_frame_base[i] = time_in_section[i];
+   }
+   ++l_frame_count;
+}
+
+/* Called at each VI */
+void timed_sections_new_vi(void)
+{
+   m64p_profile_timings* timings = l_requested_timings;
+   long long int curr_time;
+
+   if (timings != l_timings)
+   {
+      l_timings = timings;
+      l_timings_started = 0;
+#if !defined(PROFILE)
+      l_enabled = (timings != NULL);
+      if (!l_enabled)
+      {
+         /* open sections won't be ended */
+         section_depth = 0;
+         current_section = TIMED_SECTION_CPU;
+      }
+#endif
+   }
+
+   if (l_timings == NULL
+    || (l_timings->vi_limit != 0 && l_timings->vi_count >= l_timings->vi_limit))
+      return;
+
+   curr_time = get_time();
+
+   /* only start once a pending savestate is loaded,
+    * so that runs from the same state time the same frames */
+   if (!l_timings_started)
+   {
+      if (savestates_get_job() != savestates_job_load)
+         start_timings(curr_time);
+      return;
+   }
+
+   switch_section(curr_time, current_section);
+   record_frame(curr_time);
+
+   if (l_timings->vi_ns != NULL && l_timings->vi_count < l_timings->vi_limit)
+      l_timings->vi_ns[l_timings->vi_count] = (unsigned long long)time_to_nsec(curr_time - l_last_vi);
+   l_last_vi = curr_time;
+   ++l_timings->vi_count;
+
+   l_timings->total_ns = (unsigned long long)time_to_nsec(curr_time - l_timings_start);
+   l_timings->cpu_ns = section_nsec(TIMED_SECTION_CPU);
+   l_timings->compiler_ns = section_nsec(TIMED_SECTION_COMPILER);
+   l_timings->interrupt_ns = section_nsec(TIMED_SECTION_INTERRUPT);
+   l_timings->rsp_ns = section_nsec(TIMED_SECTION_RSP);
+   l_timings->gfx_ns = section_nsec(TIMED_SECTION_GFX_DLIST)
+                     + section_nsec(TIMED_SECTION_GFX_RDP_LIST)
+                     + section_nsec(TIMED_SECTION_GFX_SCREEN);
+   l_timings->audio_ns = section_nsec(TIMED_SECTION_AUDIO_ALIST)
+                       + section_nsec(TIMED_SECTION_AUDIO_SAMPLES);
+   l_timings->idle_ns = section_nsec(TIMED_SECTION_IDLE);
+
+   if (l_timings->vi_limit != 0 && l_timings->vi_count >= l_timings->vi_limit)
+      main_stop();
+}
+
+void timed_sections_get_frames(m64p_profile_frames* frames)
+{
+   unsigned int count = (l_frame_count < PROFILE_FRAME_COUNT) ? l_frame_count : PROFILE_FRAME_COUNT;
+   unsigned int i;
+
+   if (l_frames == NULL)
+      count = 0;
+   if (count > frames->capacity)
+      count = frames->capacity;
+
+   for (i = 0; i < count; ++i)
+      frames->frames[i] = l_frames[(l_frame_count - count + i) % PROFILE_FRAME_COUNT];
+   frames->count = count;
+}
+
+static double time_to_usec(long long int time)
+{
+   return (double)time_to_nsec(time) / 1000.0;
+}
+
+/* Chrome trace event format, also read by Perfetto: frames on one track,
+ * section runs nested on another */
+int timed_sections_dump_trace(const char* filename)
+{
+   unsigned int frame_count = (l_frame_count < PROFILE_FRAME_COUNT) ? l_frame_count : PROFILE_FRAME_COUNT;
+   unsigned int event_count = (l_event_count < PROFILE_EVENT_COUNT) ? l_event_count : PROFILE_EVENT_COUNT;
+   unsigned int i;
+   int j;
+   FILE* f;
+
+   if (l_frames == NULL || l_events == NULL)
+   {
+      DebugMessage(M64MSG_ERROR, "No profiler timings were collected");
+      return 0;
+   }
+
+   f = fopen(filename, "w");
+   if (f == NULL)
+   {
+      DebugMessage(M64MSG_ERROR, "Failed to open profiler trace file '%s'", filename);
+      return 0;
+   }
+
+   fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+   fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"frames\"}},\n");
+   fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"emulation\"}}");
+
+   for (i = 0; i < frame_count; ++i)
+   {
+      const m64p_profile_frame* frame = &l_frames[(l_frame_count - frame_count + i) % PROFILE_FRAME_COUNT];
+
+      fprintf(f, ",\n{\"name\":\"VI %u\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+              frame->vi, frame->start_ns / 1000.0, frame->total_ns / 1000.0);
+      for (j = 0; j < NUM_TIMED_SECTIONS; ++j)
+         fprintf(f, "%s\"%s\":%.3f", (j == 0) ? "" : ",", section_names[j], frame->section_ns[j] / 1000.0);
+      fprintf(f, "}}");
+   }
+
+   for (i = 0; i < event_count; ++i)
+   {
+      const struct timed_event* event = &l_events[(l_event_count - event_count + i) % PROFILE_EVENT_COUNT];
+
+      /* sections already open when timing started */
+      if (event->start < l_timings_start)
+         continue;
+
+      fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}",
+              section_names[event->section],
+              time_to_usec(event->start - l_timings_start), time_to_usec(event->duration));
+   }
+
+   fprintf(f, "\n]}\n");
+
+   if (fclose(f) != 0)
+   {
+      DebugMessage(M64MSG_ERROR, "Failed to write profiler trace file '%s'", filename);
+      return 0;
+   }
+
+   DebugMessage(M64MSG_INFO, "Wrote %u frames and %u section runs to '%s'", frame_count, event_count, filename);
+   return 1;
 }
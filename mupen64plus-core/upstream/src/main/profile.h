@@ -24,18 +24,44 @@
 #ifndef PROFILE_H
 #define PROFILE_H
 
+#include "api/m64p_types.h"
+
+/* Sections nest: time spent in a section started while another one is open
+ * is only accounted to the inner one. Time outside of any section goes to
+ * TIMED_SECTION_CPU. */
 enum timed_section
 {
-    TIMED_SECTION_ALL,
-    TIMED_SECTION_GFX,
-    TIMED_SECTION_AUDIO,
-    TIMED_SECTION_COMPILER,
-    TIMED_SECTION_IDLE,
-    NUM_TIMED_SECTIONS
+    TIMED_SECTION_CPU = M64PROFILE_CPU,
+    TIMED_SECTION_COMPILER = M64PROFILE_COMPILER,
+    TIMED_SECTION_INTERRUPT = M64PROFILE_INTERRUPT,
+    TIMED_SECTION_RSP = M64PROFILE_RSP,
+    TIMED_SECTION_GFX_DLIST = M64PROFILE_GFX_DLIST,
+    TIMED_SECTION_GFX_RDP_LIST = M64PROFILE_GFX_RDP_LIST,
+    TIMED_SECTION_GFX_SCREEN = M64PROFILE_GFX_SCREEN,
+    TIMED_SECTION_AUDIO_ALIST = M64PROFILE_AUDIO_ALIST,
+    TIMED_SECTION_AUDIO_SAMPLES = M64PROFILE_AUDIO_SAMPLES,
+    TIMED_SECTION_IDLE = M64PROFILE_IDLE,
+    NUM_TIMED_SECTIONS = M64PROFILE_SECTION_COUNT
 };
 
+/* Sections are only timed in PROFILE builds or while a front-end
+ * collects timings with M64CMD_PROFILE_TIMINGS. They must be started
+ * and ended on the emulation thread. */
 void timed_section_start(enum timed_section section);
 void timed_section_end(enum timed_section section);
 void timed_sections_refresh(void);
 
+void timed_sections_set_output(m64p_profile_timings* timings);
+void timed_sections_new_vi(void);
+
+/* While timings are collected, the time spent in each section is also kept
+ * for the last PROFILE_FRAME_COUNT frames, and every section run for the last
+ * PROFILE_EVENT_COUNT runs. Both are meant to be read while the emulator is
+ * paused or stopped. */
+enum { PROFILE_FRAME_COUNT = 1024 };
+enum { PROFILE_EVENT_COUNT = 1 << 18 };
+
+void timed_sections_get_frames(m64p_profile_frames* frames);
+int timed_sections_dump_trace(const char* filename);
+
 #endif
@@ -0,0 +1,374 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rewind.c                                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rewind.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main.h"
+#include "savestates.h"
+
+enum { REWIND_STATE_WORDS = SAVESTATE_M64P_SIZE / 4 };
+enum { REWIND_MAX_ENTRIES = 0x1000 };
+/* equal words tolerated inside a run before starting a new one,
+ * a run header costs 2 words */
+enum { REWIND_RUN_GAP = 2 };
+
+struct rewind_entry
+{
+    size_t offset;  /* in arena */
+    size_t size;    /* in bytes */
+};
+
+struct rewind_history
+{
+    unsigned char* arena;
+    size_t arena_size;
+
+    /* last captured state, and buffer used to serialize the next one */
+    uint32_t* current;
+    uint32_t* scratch;
+    int has_current;
+
+    /* circular list of backward deltas, oldest first */
+    struct rewind_entry entries[REWIND_MAX_ENTRIES];
+    size_t first;
+    size_t count;
+
+    unsigned int interval;
+    unsigned int vi_counter;
+    int capture_pending;
+    int restore_pending;
+};
+
+static struct rewind_history l_rewind;
+
+
+static struct rewind_entry* entry_at(size_t i)
+{
+    return &l_rewind.entries[(l_rewind.first + i) % REWIND_MAX_ENTRIES];
+}
+
+static void drop_oldest(void)
+{
+    l_rewind.first = (l_rewind.first + 1) % REWIND_MAX_ENTRIES;
+    --l_rewind.count;
+}
+
+/* Reserve size bytes in the arena after the newest entry,
+ * dropping as many of the oldest entries as needed.
+ * Returns NULL if size can never fit. */
+static unsigned char* alloc_entry(size_t size)
+{
+    size_t offset = 0;
+    struct rewind_entry* entry;
+
+    if (size > l_rewind.arena_size) {
+        return NULL;
+    }
+
+    if (l_rewind.count == REWIND_MAX_ENTRIES) {
+        drop_oldest();
+    }
+
+    /* live entries occupy [tail, head) of the arena,
+     * or [tail, end) and [0, head) once they have wrapped around */
+    while (l_rewind.count > 0) {
+        const struct rewind_entry* oldest = entry_at(0);
+        const struct rewind_entry* newest = entry_at(l_rewind.count - 1);
+        size_t tail = oldest->offset;
+        size_t head = newest->offset + newest->size;
+
+        if (newest->offset >= tail) {
+            if (head + size <= l_rewind.arena_size) {
+                offset = head;
+                break;
+            }
+            if (size <= tail) {
+                offset = 0;
+                break;
+            }
+        }
+        else if (head + size <= tail) {
+            offset = head;
+            break;
+        }
+
+        drop_oldest();
+    }
+
+    entry = entry_at(l_rewind.count++);
+    entry->offset = offset;
+    entry->size = size;
+
+    return l_rewind.arena + offset;
+}
+
+/* Find the next run of words which differ between a and b, starting at *i.
+ * Returns the run length (0 if there is none) and sets *i to its start. */
+static size_t next_run(const uint32_t* a, const uint32_t* b, size_t* i)
+{
+    size_t k = *i;
+    size_t last;
+
+    while (k < REWIND_STATE_WORDS) {
+        if (REWIND_STATE_WORDS - k >= 16 && memcmp(&a[k], &b[k], 64) == 0) {
+            k += 16;
+        }
+        else if (a[k] == b[k]) {
+            ++k;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (k == REWIND_STATE_WORDS) {
+        return 0;
+    }
+
+    *i = last = k;
+    for (++k; k < REWIND_STATE_WORDS && k - last <= REWIND_RUN_GAP; ++k) {
+        if (a[k] != b[k]) {
+            last = k;
+        }
+    }
+
+    return last + 1 - *i;
+}
+
+static size_t delta_size(const uint32_t* a, const uint32_t* b)
+{
+    size_t i = 0;
+    size_t n;
+    size_t size = 0;
+
+    while ((n = next_run(a, b, &i)) != 0) {
+        size += (2 + n) * sizeof(uint32_t);
+        i += n;
+    }
+
+    return size;
+}
+
+/* Write XOR delta between current and next to dst (can be NULL)
+ * and update current to next. */
+static void encode_delta(uint32_t* dst, uint32_t* current, const uint32_t* next)
+{
+    size_t i = 0;
+    size_t k, n;
+
+    while ((n = next_run(current, next, &i)) != 0) {
+        if (dst != NULL) {
+            *dst++ = (uint32_t)i;
+            *dst++ = (uint32_t)n;
+            for (k = 0; k < n; ++k) {
+                *dst++ = current[i + k] ^ next[i + k];
+            }
+        }
+        memcpy(&current[i], &next[i], n * sizeof(uint32_t));
+        i += n;
+    }
+}
+
+static void apply_delta(uint32_t* state, const uint32_t* delta, size_t size)
+{
+    const uint32_t* end = delta + size / sizeof(uint32_t);
+    size_t k;
+
+    while (delta < end) {
+        uint32_t i = *delta++;
+        uint32_t n = *delta++;
+        for (k = 0; k < n; ++k) {
+            state[i + k] ^= *delta++;
+        }
+    }
+}
+
+
+int rewind_init(size_t budget, unsigned int interval)
+{
+    rewind_deinit();
+
+    if (budget == 0) {
+        return 0;
+    }
+
+    /* the 2 full states are accounted in the budget */
+    if (budget <= 2 * SAVESTATE_M64P_SIZE) {
+        DebugMessage(M64MSG_WARNING, "Rewind buffer must be at least %u MB",
+                     (unsigned int)(2 * SAVESTATE_M64P_SIZE / (1024 * 1024)) + 1);
+        return -1;
+    }
+
+    l_rewind.arena_size = budget - 2 * SAVESTATE_M64P_SIZE;
+    l_rewind.arena = malloc(l_rewind.arena_size);
+    l_rewind.current = calloc(1, SAVESTATE_M64P_SIZE);
+    l_rewind.scratch = calloc(1, SAVESTATE_M64P_SIZE);
+    if (l_rewind.arena == NULL || l_rewind.current == NULL || l_rewind.scratch == NULL) {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate rewind buffer");
+        rewind_deinit();
+        return -1;
+    }
+
+    l_rewind.interval = (interval == 0) ? 1 : interval;
+
+    DebugMessage(M64MSG_INFO, "Rewind enabled: %u KB of history, capture every %u VI",
+                 (unsigned int)(l_rewind.arena_size / 1024), l_rewind.interval);
+
+    return 0;
+}
+
+void rewind_deinit(void)
+{
+    free(l_rewind.arena);
+    free(l_rewind.current);
+    free(l_rewind.scratch);
+    memset(&l_rewind, 0, sizeof(l_rewind));
+}
+
+void rewind_new_vi(void)
+{
+    if (l_rewind.arena == NULL || l_rewind.restore_pending) {
+        return;
+    }
+
+    if (++l_rewind.vi_counter >= l_rewind.interval) {
+        l_rewind.vi_counter = 0;
+        l_rewind.capture_pending = 1;
+    }
+}
+
+size_t rewind_trim(void)
+{
+#if !defined(WIN32) && defined(MADV_DONTNEED)
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin, end;
+    size_t released = 0;
+    size_t i;
+
+    if (l_rewind.arena == NULL || l_rewind.count == 0) {
+        return 0;
+    }
+
+    for (i = 0; i < l_rewind.count; ++i) {
+        released += entry_at(i)->size;
+    }
+    l_rewind.first = 0;
+    l_rewind.count = 0;
+
+    /* the arena is now unused, its pages are given back and
+     * come back zeroed when the next deltas are written */
+    begin = ((uintptr_t)l_rewind.arena + page_size - 1) & ~(page_size - 1);
+    end = ((uintptr_t)l_rewind.arena + l_rewind.arena_size) & ~(page_size - 1);
+    if (end > begin) {
+        madvise((void*)begin, end - begin, MADV_DONTNEED);
+    }
+
+    DebugMessage(M64MSG_INFO, "Rewind history dropped, %u KB released", (unsigned int)(released / 1024));
+    return released;
+#else
+    /* the history can't be given back without freeing the arena */
+    return 0;
+#endif
+}
+
+int rewind_request(void)
+{
+    if (l_rewind.arena == NULL || l_rewind.count == 0) {
+        return 0;
+    }
+
+    l_rewind.restore_pending = 1;
+    return 1;
+}
+
+int rewind_restore_pending(void)
+{
+    struct rewind_entry* entry;
+
+    if (!l_rewind.restore_pending) {
+        return 0;
+    }
+
+    l_rewind.restore_pending = 0;
+    l_rewind.capture_pending = 0;
+    l_rewind.vi_counter = 0;
+
+    if (l_rewind.count == 0) {
+        return 0;
+    }
+
+    /* step back current snapshot and drop the delta we just used */
+    entry = entry_at(--l_rewind.count);
+    apply_delta(l_rewind.current, (const uint32_t*)(l_rewind.arena + entry->offset), entry->size);
+
+    /* loading may byteswap its input, so keep current pristine */
+    memcpy(l_rewind.scratch, l_rewind.current, SAVESTATE_M64P_SIZE);
+    main_audio_out_flush();
+    savestates_load_m64p_mem(&g_dev, l_rewind.scratch);
+
+    return 1;
+}
+
+void rewind_capture_pending(void)
+{
+    size_t size;
+    unsigned char* dst;
+
+    if (!l_rewind.capture_pending) {
+        return;
+    }
+
+    l_rewind.capture_pending = 0;
+
+    savestates_save_m64p_mem(&g_dev, l_rewind.scratch);
+
+    if (!l_rewind.has_current) {
+        memcpy(l_rewind.current, l_rewind.scratch, SAVESTATE_M64P_SIZE);
+        l_rewind.has_current = 1;
+        return;
+    }
+
+    size = delta_size(l_rewind.current, l_rewind.scratch);
+    if (size == 0) {
+        /* nothing changed, no need to remember it */
+        return;
+    }
+
+    dst = alloc_entry(size);
+    if (dst == NULL) {
+        /* history can't span this capture, restart from here */
+        l_rewind.first = 0;
+        l_rewind.count = 0;
+    }
+
+    encode_delta((uint32_t*)dst, l_rewind.current, l_rewind.scratch);
+}
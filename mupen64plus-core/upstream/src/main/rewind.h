@@ -0,0 +1,53 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rewind.h                                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_REWIND_H
+#define M64P_MAIN_REWIND_H
+
+#include <stddef.h>
+
+/* In-memory rewind history.
+ *
+ * Every few VIs the whole machine state is serialized with the savestate
+ * code and compared against the previously captured state. Only the XOR
+ * of the words which changed is kept, in a fixed-size ring: applying the
+ * newest delta to the current snapshot gives back the previous snapshot.
+ * When the ring is full the oldest deltas are dropped. */
+
+int rewind_init(size_t budget, unsigned int interval);
+void rewind_deinit(void);
+
+/* called on every VI by the main loop */
+void rewind_new_vi(void);
+
+/* Ask to step back to the previous captured state.
+ * Returns 0 if rewinding is disabled or the history is empty. */
+int rewind_request(void);
+
+/* Drop the whole history when the system runs low on memory.
+ * Returns the number of bytes released. */
+size_t rewind_trim(void);
+
+/* called by the core at points where the state can be saved/restored */
+int rewind_restore_pending(void);
+void rewind_capture_pending(void);
+
+#endif
@@ -20,6 +20,8 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include <SDL.h>
+#include <SDL_thread.h>
 #include <ctype.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -42,6 +44,7 @@
 #include "osd/osd.h"
 #include "rom.h"
 #include "util.h"
+#include "workqueue.h"
 
 #define CHUNKSIZE 1024*128 /* Read files 128KB at a time. */
 
@@ -63,6 +66,17 @@ m64p_rom_header   ROM_HEADER;
 rom_params        ROM_PARAMS;
 m64p_rom_settings ROM_SETTINGS;
 
+/* The MD5 hash of the ROM and its database lookup run on the workqueue,
+ * overlapped with whatever the frontend does before starting the emulation */
+struct rom_lookup
+{
+    struct work_struct work;
+    SDL_sem* done;
+    int pending;
+};
+
+static struct rom_lookup l_rom_lookup;
+
 static m64p_system_type rom_country_code_to_system_type(uint16_t country_code);
 
 static const uint8_t Z64_SIGNATURE[4] = { 0x80, 0x37, 0x12, 0x40 };
@@ -129,49 +143,20 @@ static void swap_copy_rom(void* dst, const void* src, size_t len, unsigned char*
     }
 }
 
-m64p_error open_rom(const unsigned char* romimage, unsigned int size)
+static void rom_lookup_work(struct work_struct* work)
 {
     md5_state_t state;
     md5_byte_t digest[16];
     romdatabase_entry* entry;
-    char buffer[256];
-    unsigned char imagetype;
     int i;
 
-    /* check input requirements */
-    if (romimage == NULL || !is_valid_rom(romimage))
-    {
-        DebugMessage(M64MSG_ERROR, "open_rom(): not a valid ROM image");
-        return M64ERR_INPUT_INVALID;
-    }
-
-    /* Clear Byte-swapped flag, since ROM is now deleted. */
-    g_MemHasBeenBSwapped = 0;
-    /* allocate new buffer for ROM and copy into this buffer */
-    g_rom_size = size;
-    swap_copy_rom((uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), romimage, size, &imagetype);
-
-    memcpy(&ROM_HEADER, (uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), sizeof(m64p_rom_header));
-
     /* Calculate MD5 hash  */
     md5_init(&state);
     md5_append(&state, (const md5_byte_t*)((uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM)), g_rom_size);
     md5_finish(&state, digest);
     for ( i = 0; i < 16; ++i )
-        sprintf(buffer+i*2, "%02X", digest[i]);
-    buffer[32] = '\0';
-    strcpy(ROM_SETTINGS.MD5, buffer);
-
-    /* add some useful properties to ROM_PARAMS */
-    ROM_PARAMS.systemtype = rom_country_code_to_system_type(ROM_HEADER.Country_code);
-    ROM_PARAMS.countperop = DEFAULT_COUNT_PER_OP;
-    ROM_PARAMS.disableextramem = DEFAULT_DISABLE_EXTRA_MEM;
-    ROM_PARAMS.sidmaduration = DEFAULT_SI_DMA_DURATION;
-    ROM_PARAMS.cheats = NULL;
-
-    memcpy(ROM_PARAMS.headername, ROM_HEADER.Name, 20);
-    ROM_PARAMS.headername[20] = '\0';
-    trim(ROM_PARAMS.headername); /* Remove trailing whitespace from ROM name. */
+        sprintf(ROM_SETTINGS.MD5+i*2, "%02X", digest[i]);
+    ROM_SETTINGS.MD5[32] = '\0';
 
     /* Look up this ROM in the .ini file and fill in goodname, etc */
     if ((entry=ini_search_by_md5(digest)) != NULL ||
@@ -205,12 +190,73 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
         ROM_PARAMS.sidmaduration = DEFAULT_SI_DMA_DURATION;
         ROM_PARAMS.cheats = NULL;
     }
+}
 
-    /* print out a bunch of info about the ROM */
+static void print_rom_settings(void)
+{
     DebugMessage(M64MSG_INFO, "Goodname: %s", ROM_SETTINGS.goodname);
+    DebugMessage(M64MSG_INFO, "MD5: %s", ROM_SETTINGS.MD5);
+    DebugMessage(M64MSG_VERBOSE, "Save type: %d", ROM_SETTINGS.savetype);
+}
+
+static void rom_lookup_done(struct work_struct* work)
+{
+    struct rom_lookup* lookup = container_of(work, struct rom_lookup, work);
+
+    SDL_SemPost(lookup->done);
+}
+
+m64p_error open_rom(const unsigned char* romimage, unsigned int size)
+{
+    char buffer[256];
+    unsigned char imagetype;
+
+    /* check input requirements */
+    if (romimage == NULL || !is_valid_rom(romimage))
+    {
+        DebugMessage(M64MSG_ERROR, "open_rom(): not a valid ROM image");
+        return M64ERR_INPUT_INVALID;
+    }
+
+    /* the previous ROM may still be being hashed */
+    wait_rom_settings();
+
+    /* Clear Byte-swapped flag, since ROM is now deleted. */
+    g_MemHasBeenBSwapped = 0;
+    /* allocate new buffer for ROM and copy into this buffer */
+    g_rom_size = size;
+    swap_copy_rom((uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), romimage, size, &imagetype);
+
+    memcpy(&ROM_HEADER, (uint8_t*)mem_base_u32(g_mem_base, MM_CART_ROM), sizeof(m64p_rom_header));
+
+    /* add some useful properties to ROM_PARAMS */
+    ROM_PARAMS.systemtype = rom_country_code_to_system_type(ROM_HEADER.Country_code);
+    ROM_PARAMS.countperop = DEFAULT_COUNT_PER_OP;
+    ROM_PARAMS.disableextramem = DEFAULT_DISABLE_EXTRA_MEM;
+    ROM_PARAMS.sidmaduration = DEFAULT_SI_DMA_DURATION;
+    ROM_PARAMS.cheats = NULL;
+
+    memcpy(ROM_PARAMS.headername, ROM_HEADER.Name, 20);
+    ROM_PARAMS.headername[20] = '\0';
+    trim(ROM_PARAMS.headername); /* Remove trailing whitespace from ROM name. */
+
+    /* hash the ROM in the background, or right now if that isn't possible */
+    l_rom_lookup.done = SDL_CreateSemaphore(0);
+    if (l_rom_lookup.done != NULL)
+    {
+        l_rom_lookup.pending = 1;
+        init_work_prio(&l_rom_lookup.work, rom_lookup_work, rom_lookup_done, WORK_PRIORITY_ROM);
+        queue_work(&l_rom_lookup.work);
+    }
+    else
+    {
+        rom_lookup_work(&l_rom_lookup.work);
+        print_rom_settings();
+    }
+
+    /* print out a bunch of info about the ROM */
     DebugMessage(M64MSG_INFO, "Name: %s", ROM_HEADER.Name);
     imagestring(imagetype, buffer);
-    DebugMessage(M64MSG_INFO, "MD5: %s", ROM_SETTINGS.MD5);
     DebugMessage(M64MSG_INFO, "CRC: %08" PRIX32 " %08" PRIX32, tohl(ROM_HEADER.CRC1), tohl(ROM_HEADER.CRC2));
     DebugMessage(M64MSG_INFO, "Imagetype: %s", buffer);
     DebugMessage(M64MSG_INFO, "Rom size: %d bytes (or %d Mb or %d Megabits)", g_rom_size, g_rom_size/1024/1024, g_rom_size/1024/1024*8);
@@ -224,13 +270,27 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
     countrycodestring(ROM_HEADER.Country_code, buffer);
     DebugMessage(M64MSG_INFO, "Country: %s", buffer);
     DebugMessage(M64MSG_VERBOSE, "PC = %" PRIX32, tohl(ROM_HEADER.PC));
-    DebugMessage(M64MSG_VERBOSE, "Save type: %d", ROM_SETTINGS.savetype);
 
     return M64ERR_SUCCESS;
 }
 
+void wait_rom_settings(void)
+{
+    if (!l_rom_lookup.pending)
+        return;
+
+    SDL_SemWait(l_rom_lookup.done);
+    SDL_DestroySemaphore(l_rom_lookup.done);
+    l_rom_lookup.done = NULL;
+    l_rom_lookup.pending = 0;
+
+    print_rom_settings();
+}
+
 m64p_error close_rom(void)
 {
+    wait_rom_settings();
+
     /* Clear Byte-swapped flag, since ROM is now deleted. */
     g_MemHasBeenBSwapped = 0;
     DebugMessage(M64MSG_STATUS, "Rom closed.");
@@ -267,127 +327,192 @@ static m64p_system_type rom_country_code_to_system_type(uint16_t country_code)
     }
 }
 
-static size_t romdatabase_resolve_round(void)
+/* Upper bound on RefMD5 chain length, anything deeper is treated as a loop. */
+enum { ROMDATABASE_MAX_REF_DEPTH = 16 };
+
+/* Resolve the RefMD5 of a single entry, resolving the referenced entry first
+ * so that chains are handled in one pass over the database.
+ */
+static void romdatabase_resolve_entry(romdatabase_entry* entry, unsigned int depth)
 {
-    romdatabase_search *entry;
     romdatabase_entry *ref;
-    size_t skipped = 0;
 
-    /* Resolve RefMD5 references */
-    for (entry = g_romdatabase.list; entry; entry = entry->next_entry) {
-        if (!entry->entry.refmd5)
-            continue;
-
-        ref = ini_search_by_md5(entry->entry.refmd5);
-        if (!ref) {
-            DebugMessage(M64MSG_WARNING, "ROM Database: Error solving RefMD5s");
-            continue;
-        }
+    if (!entry->refmd5)
+        return;
 
-        /* entry is not yet resolved, skip for now */
-        if (ref->refmd5) {
-            skipped++;
-            continue;
-        }
+    if (depth >= ROMDATABASE_MAX_REF_DEPTH) {
+        DebugMessage(M64MSG_ERROR, "Unable to resolve rom database entries (loop)");
+        return;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_GOODNAME) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_GOODNAME)) {
-            entry->entry.goodname = strdup(ref->goodname);
-            if (entry->entry.goodname)
-                entry->entry.set_flags |= ROMDATABASE_ENTRY_GOODNAME;
-        }
+    ref = ini_search_by_md5(entry->refmd5);
+    if (!ref) {
+        DebugMessage(M64MSG_WARNING, "ROM Database: Error solving RefMD5s");
+        free(entry->refmd5);
+        entry->refmd5 = NULL;
+        return;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_CRC) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_CRC)) {
-            entry->entry.crc1 = ref->crc1;
-            entry->entry.crc2 = ref->crc2;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_CRC;
-        }
+    romdatabase_resolve_entry(ref, depth + 1);
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_STATUS) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_STATUS)) {
-            entry->entry.status = ref->status;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_STATUS;
-        }
+    /* reference is part of a loop, leave entry unresolved */
+    if (ref->refmd5)
+        return;
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_SAVETYPE) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_SAVETYPE)) {
-            entry->entry.savetype = ref->savetype;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_SAVETYPE;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_GOODNAME) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_GOODNAME)) {
+        entry->goodname = strdup(ref->goodname);
+        if (entry->goodname)
+            entry->set_flags |= ROMDATABASE_ENTRY_GOODNAME;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_PLAYERS) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_PLAYERS)) {
-            entry->entry.players = ref->players;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_PLAYERS;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_CRC) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_CRC)) {
+        entry->crc1 = ref->crc1;
+        entry->crc2 = ref->crc2;
+        entry->set_flags |= ROMDATABASE_ENTRY_CRC;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_RUMBLE) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_RUMBLE)) {
-            entry->entry.rumble = ref->rumble;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_RUMBLE;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_STATUS) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_STATUS)) {
+        entry->status = ref->status;
+        entry->set_flags |= ROMDATABASE_ENTRY_STATUS;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_COUNTEROP) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_COUNTEROP)) {
-            entry->entry.countperop = ref->countperop;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_COUNTEROP;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_SAVETYPE) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_SAVETYPE)) {
+        entry->savetype = ref->savetype;
+        entry->set_flags |= ROMDATABASE_ENTRY_SAVETYPE;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_CHEATS) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_CHEATS)) {
-            if (ref->cheats)
-                entry->entry.cheats = strdup(ref->cheats);
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_CHEATS;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_PLAYERS) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_PLAYERS)) {
+        entry->players = ref->players;
+        entry->set_flags |= ROMDATABASE_ENTRY_PLAYERS;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_EXTRAMEM) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_EXTRAMEM)) {
-            entry->entry.disableextramem = ref->disableextramem;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_EXTRAMEM;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_RUMBLE) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_RUMBLE)) {
+        entry->rumble = ref->rumble;
+        entry->set_flags |= ROMDATABASE_ENTRY_RUMBLE;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_TRANSFERPAK) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_TRANSFERPAK)) {
-            entry->entry.transferpak = ref->transferpak;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_TRANSFERPAK;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_COUNTEROP) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_COUNTEROP)) {
+        entry->countperop = ref->countperop;
+        entry->set_flags |= ROMDATABASE_ENTRY_COUNTEROP;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_MEMPAK) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_MEMPAK)) {
-            entry->entry.mempak = ref->mempak;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_MEMPAK;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_CHEATS) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_CHEATS)) {
+        if (ref->cheats)
+            entry->cheats = strdup(ref->cheats);
+        entry->set_flags |= ROMDATABASE_ENTRY_CHEATS;
+    }
 
-        if (!isset_bitmask(entry->entry.set_flags, ROMDATABASE_ENTRY_SIDMADURATION) &&
-            isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_SIDMADURATION)) {
-            entry->entry.sidmaduration = ref->sidmaduration;
-            entry->entry.set_flags |= ROMDATABASE_ENTRY_SIDMADURATION;
-        }
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_EXTRAMEM) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_EXTRAMEM)) {
+        entry->disableextramem = ref->disableextramem;
+        entry->set_flags |= ROMDATABASE_ENTRY_EXTRAMEM;
+    }
 
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_TRANSFERPAK) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_TRANSFERPAK)) {
+        entry->transferpak = ref->transferpak;
+        entry->set_flags |= ROMDATABASE_ENTRY_TRANSFERPAK;
+    }
+
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_MEMPAK) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_MEMPAK)) {
+        entry->mempak = ref->mempak;
+        entry->set_flags |= ROMDATABASE_ENTRY_MEMPAK;
+    }
 
-        free(entry->entry.refmd5);
-        entry->entry.refmd5 = NULL;
+    if (!isset_bitmask(entry->set_flags, ROMDATABASE_ENTRY_SIDMADURATION) &&
+        isset_bitmask(ref->set_flags, ROMDATABASE_ENTRY_SIDMADURATION)) {
+        entry->sidmaduration = ref->sidmaduration;
+        entry->set_flags |= ROMDATABASE_ENTRY_SIDMADURATION;
     }
 
-    return skipped;
+
+    free(entry->refmd5);
+    entry->refmd5 = NULL;
 }
 
 static void romdatabase_resolve(void)
 {
-    size_t last_skipped = (size_t)~0ULL;
-    size_t skipped;
+    romdatabase_search *search;
 
-    do {
-        skipped = romdatabase_resolve_round();
-        if (skipped == last_skipped) {
-            DebugMessage(M64MSG_ERROR, "Unable to resolve rom database entries (loop)");
-            break;
-        }
-        last_skipped = skipped;
-    } while (skipped > 0);
+    /* Resolve RefMD5 references */
+    for (search = g_romdatabase.list; search; search = search->next_entry)
+        romdatabase_resolve_entry(&search->entry, 0);
+}
+
+static int romdatabase_order_cmp(const romdatabase_search* a, const romdatabase_search* b)
+{
+    /* later entries sort first so that they shadow earlier duplicates */
+    return (a->order < b->order) - (a->order > b->order);
+}
+
+static int romdatabase_md5_cmp(const void* pa, const void* pb)
+{
+    const romdatabase_search* a = *(const romdatabase_search* const*)pa;
+    const romdatabase_search* b = *(const romdatabase_search* const*)pb;
+    int r = memcmp(a->entry.md5, b->entry.md5, 16);
+
+    return (r != 0) ? r : romdatabase_order_cmp(a, b);
+}
+
+static int romdatabase_crc_key_cmp(unsigned int crc1, unsigned int crc2, const romdatabase_search* b)
+{
+    if (crc1 != b->entry.crc1)
+        return (crc1 < b->entry.crc1) ? -1 : 1;
+    if (crc2 != b->entry.crc2)
+        return (crc2 < b->entry.crc2) ? -1 : 1;
+    return 0;
+}
+
+static int romdatabase_crc_cmp(const void* pa, const void* pb)
+{
+    const romdatabase_search* a = *(const romdatabase_search* const*)pa;
+    const romdatabase_search* b = *(const romdatabase_search* const*)pb;
+    int r = romdatabase_crc_key_cmp(a->entry.crc1, a->entry.crc2, b);
+
+    return (r != 0) ? r : romdatabase_order_cmp(a, b);
+}
+
+/* Build the sorted md5 and crc lookup arrays from the entry list. Only entries
+ * with a CRC of their own are indexed by crc, as before. */
+static void romdatabase_build_index(unsigned int count)
+{
+    romdatabase_search *search;
+    size_t md5_count = 0, crc_count = 0;
+
+    g_romdatabase.md5_index = (romdatabase_search**) malloc(count * sizeof(romdatabase_search*));
+    g_romdatabase.crc_index = (romdatabase_search**) malloc(count * sizeof(romdatabase_search*));
+    if (count > 0 && (g_romdatabase.md5_index == NULL || g_romdatabase.crc_index == NULL)) {
+        DebugMessage(M64MSG_ERROR, "ROM Database: Failed to allocate lookup index");
+        free(g_romdatabase.md5_index);
+        free(g_romdatabase.crc_index);
+        g_romdatabase.md5_index = g_romdatabase.crc_index = NULL;
+        g_romdatabase.md5_count = g_romdatabase.crc_count = 0;
+        return;
+    }
+
+    for (search = g_romdatabase.list; search; search = search->next_entry) {
+        g_romdatabase.md5_index[md5_count++] = search;
+        if (isset_bitmask(search->entry.set_flags, ROMDATABASE_ENTRY_CRC))
+            g_romdatabase.crc_index[crc_count++] = search;
+    }
+
+    qsort(g_romdatabase.md5_index, md5_count, sizeof(romdatabase_search*), romdatabase_md5_cmp);
+    qsort(g_romdatabase.crc_index, crc_count, sizeof(romdatabase_search*), romdatabase_crc_cmp);
+
+    g_romdatabase.md5_count = md5_count;
+    g_romdatabase.crc_count = crc_count;
 }
 
+
 /********************************************************************************************/
 /* INI Rom database functions */
 
@@ -398,8 +523,8 @@ void romdatabase_open(void)
     romdatabase_search* search = NULL;
     romdatabase_search** next_search;
 
-    int counter, value, lineno;
-    unsigned char index;
+    int value, lineno;
+    unsigned int count = 0;
     const char *pathname = ConfigGetSharedDataFilepath("mupen64plus.ini");
 
     if(g_romdatabase.have_database)
@@ -415,10 +540,10 @@ void romdatabase_open(void)
     g_romdatabase.have_database = 1;
 
     /* Clear premade indices. */
-    for(counter = 0; counter < 255; ++counter)
-        g_romdatabase.crc_lists[counter] = NULL;
-    for(counter = 0; counter < 255; ++counter)
-        g_romdatabase.md5_lists[counter] = NULL;
+    g_romdatabase.md5_index = NULL;
+    g_romdatabase.crc_index = NULL;
+    g_romdatabase.md5_count = 0;
+    g_romdatabase.crc_count = 0;
     g_romdatabase.list = NULL;
 
     next_search = &g_romdatabase.list;
@@ -464,11 +589,7 @@ void romdatabase_open(void)
             search->entry.set_flags = ROMDATABASE_ENTRY_NONE;
 
             search->next_entry = NULL;
-            search->next_crc = NULL;
-            /* Index MD5s by first 8 bits. */
-            index = search->entry.md5[0];
-            search->next_md5 = g_romdatabase.md5_lists[index];
-            g_romdatabase.md5_lists[index] = search;
+            search->order = count++;
 
             break;
         }
@@ -491,15 +612,12 @@ void romdatabase_open(void)
                 if (sscanf(l.value, "%X %X%c", &search->entry.crc1,
                     &search->entry.crc2, &garbage_sweeper) == 2)
                 {
-                    /* Index CRCs by first 8 bits. */
-                    index = search->entry.crc1 >> 24;
-                    search->next_crc = g_romdatabase.crc_lists[index];
-                    g_romdatabase.crc_lists[index] = search;
                     search->entry.set_flags |= ROMDATABASE_ENTRY_CRC;
                 }
                 else
                 {
                     search->entry.crc1 = search->entry.crc2 = 0;
+                    search->entry.set_flags &= ~ROMDATABASE_ENTRY_CRC;
                     DebugMessage(M64MSG_WARNING, "ROM Database: Invalid CRC on line %i", lineno);
                 }
             }
@@ -656,6 +774,7 @@ void romdatabase_open(void)
     }
 
     fclose(fPtr);
+    romdatabase_build_index(count);
     romdatabase_resolve();
 }
 
@@ -675,42 +794,60 @@ void romdatabase_close(void)
         free(g_romdatabase.list);
         g_romdatabase.list = search;
         }
+
+    free(g_romdatabase.md5_index);
+    free(g_romdatabase.crc_index);
+    g_romdatabase.md5_index = NULL;
+    g_romdatabase.crc_index = NULL;
+    g_romdatabase.md5_count = 0;
+    g_romdatabase.crc_count = 0;
+    g_romdatabase.have_database = 0;
 }
 
 static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5)
 {
-    romdatabase_search* search;
+    size_t lo = 0, hi = g_romdatabase.md5_count;
 
     if(!g_romdatabase.have_database)
         return NULL;
 
-    search = g_romdatabase.md5_lists[md5[0]];
-
-    while (search != NULL && memcmp(search->entry.md5, md5, 16) != 0)
-        search = search->next_md5;
+    /* find the first (latest defined) entry with a matching md5 */
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (memcmp(g_romdatabase.md5_index[mid]->entry.md5, md5, 16) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-    if(search==NULL)
+    if (lo == g_romdatabase.md5_count || memcmp(g_romdatabase.md5_index[lo]->entry.md5, md5, 16) != 0)
         return NULL;
 
-    return &(search->entry);
+    return &(g_romdatabase.md5_index[lo]->entry);
 }
 
 romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2)
 {
-    romdatabase_search* search;
+    size_t lo = 0, hi = g_romdatabase.crc_count;
 
     if(!g_romdatabase.have_database) 
         return NULL;
 
-    search = g_romdatabase.crc_lists[((crc1 >> 24) & 0xff)];
-
-    while (search != NULL && search->entry.crc1 != crc1 && search->entry.crc2 != crc2)
-        search = search->next_crc;
+    /* find the first (latest defined) entry with matching crcs */
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (romdatabase_crc_key_cmp(crc1, crc2, g_romdatabase.crc_index[mid]) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-    if(search == NULL) 
+    if (lo == g_romdatabase.crc_count || romdatabase_crc_key_cmp(crc1, crc2, g_romdatabase.crc_index[lo]) != 0)
         return NULL;
 
-    return &(search->entry);
+    return &(g_romdatabase.crc_index[lo]->entry);
 }
 
 
@@ -41,6 +41,10 @@
 m64p_error open_rom(const unsigned char* romimage, unsigned int size);
 m64p_error close_rom(void);
 
+/* open_rom fills in the database dependent parts of ROM_SETTINGS and
+ * ROM_PARAMS in the background, this waits until they are ready */
+void wait_rom_settings(void);
+
 extern int g_rom_size;
 
 typedef struct _rom_params
@@ -147,15 +151,19 @@ typedef struct _romdatabase_search
 {
     romdatabase_entry entry;
     struct _romdatabase_search* next_entry;
-    struct _romdatabase_search* next_crc;
-    struct _romdatabase_search* next_md5;
+    unsigned int order; /* Position in the database file, later entries win on duplicates. */
 } romdatabase_search;
 
+/* Entries are kept in file order in list, md5_index and crc_index hold the same
+ * entries sorted by md5 and by crc1/crc2 for binary search lookups.
+ */
 typedef struct
 {
     int have_database;
-    romdatabase_search* crc_lists[256];
-    romdatabase_search* md5_lists[256];
+    romdatabase_search** md5_index;
+    romdatabase_search** crc_index;
+    size_t md5_count;
+    size_t crc_count;
     romdatabase_search* list;
 } _romdatabase;
 
@@ -0,0 +1,139 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rsp_async.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "rsp_async.h"
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include <stddef.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main/thread_placement.h"
+#include "plugin/plugin.h"
+
+int g_rsp_async_pending = 0;
+int g_rsp_async_deferred = 0;
+
+static struct
+{
+    SDL_Thread* thread;
+    SDL_sem* start;
+    SDL_sem* done;
+    int quit;
+    int lookahead;
+
+    void (*done_cb)(void*);
+    void* opaque;
+} rsp_async;
+
+static int rsp_async_thread(void* data)
+{
+    thread_placement_apply(M64THREAD_WORKER);
+
+    for (;;)
+    {
+        SDL_SemWait(rsp_async.start);
+        if (rsp_async.quit)
+            break;
+
+        rsp.doRspCycles(0xffffffff);
+
+        SDL_SemPost(rsp_async.done);
+    }
+
+    return 0;
+}
+
+int rsp_async_init(int lookahead)
+{
+    rsp_async.quit = 0;
+    rsp_async.lookahead = lookahead;
+    rsp_async.start = SDL_CreateSemaphore(0);
+    rsp_async.done = SDL_CreateSemaphore(0);
+    if (rsp_async.start == NULL || rsp_async.done == NULL)
+        goto fail;
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+    rsp_async.thread = SDL_CreateThread(rsp_async_thread, "m64prsp", NULL);
+#else
+    rsp_async.thread = SDL_CreateThread(rsp_async_thread, NULL);
+#endif
+    if (rsp_async.thread == NULL)
+        goto fail;
+
+    return 0;
+
+fail:
+    DebugMessage(M64MSG_WARNING, "Couldn't start RSP thread, running RSP tasks synchronously");
+    if (rsp_async.start != NULL)
+        SDL_DestroySemaphore(rsp_async.start);
+    if (rsp_async.done != NULL)
+        SDL_DestroySemaphore(rsp_async.done);
+    rsp_async.start = rsp_async.done = NULL;
+    return -1;
+}
+
+void rsp_async_deinit(void)
+{
+    if (rsp_async.thread == NULL)
+        return;
+
+    rsp_async_sync();
+
+    rsp_async.quit = 1;
+    SDL_SemPost(rsp_async.start);
+    SDL_WaitThread(rsp_async.thread, NULL);
+
+    SDL_DestroySemaphore(rsp_async.start);
+    SDL_DestroySemaphore(rsp_async.done);
+    rsp_async.thread = NULL;
+    rsp_async.start = rsp_async.done = NULL;
+}
+
+int rsp_async_enabled(void)
+{
+    return rsp_async.thread != NULL;
+}
+
+int rsp_async_lookahead(void)
+{
+    return rsp_async.thread != NULL && rsp_async.lookahead;
+}
+
+void rsp_async_start(void (*done)(void*), void* opaque, int deferred)
+{
+    rsp_async.done_cb = done;
+    rsp_async.opaque = opaque;
+    g_rsp_async_pending = 1;
+    g_rsp_async_deferred = deferred;
+
+    SDL_SemPost(rsp_async.start);
+}
+
+void rsp_async_wait_task(void)
+{
+    SDL_SemWait(rsp_async.done);
+    g_rsp_async_pending = 0;
+    g_rsp_async_deferred = 0;
+
+    rsp_async.done_cb(rsp_async.opaque);
+}
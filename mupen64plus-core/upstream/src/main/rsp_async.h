@@ -0,0 +1,71 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rsp_async.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_RSP_ASYNC_H
+#define M64P_MAIN_RSP_ASYNC_H
+
+#include "osal/preproc.h"
+
+/* Set while an RSP task runs on the worker thread. Only ever changed by the
+ * emulation thread. */
+extern int g_rsp_async_pending;
+
+/* Set while the task in flight has already applied its MI side effects, so
+ * it only has to be waited for where its results are used */
+extern int g_rsp_async_deferred;
+
+/* With lookahead, deferrable tasks are no longer joined on MI accesses and
+ * interrupts, only by the SP, the AI DMA reading their output, PI/SI DMA, the
+ * next task and savestates */
+int rsp_async_init(int lookahead);
+void rsp_async_deinit(void);
+
+/* Returns non-zero if RSP tasks may be dispatched to the worker thread */
+int rsp_async_enabled(void);
+
+/* Returns non-zero if deferrable tasks are only joined where their results
+ * are used */
+int rsp_async_lookahead(void);
+
+/* Runs the RSP plugin on the worker thread. done(opaque) is called back on
+ * the emulation thread once the task is waited for. deferred tells the task
+ * doesn't change MI or CP0 state when joined. */
+void rsp_async_start(void (*done)(void*), void* opaque, int deferred);
+
+void rsp_async_wait_task(void);
+
+/* Waits for the RSP task in flight, if any. Must be called before touching
+ * any state the RSP plugin may access while running. */
+static osal_inline void rsp_async_sync(void)
+{
+    if (g_rsp_async_pending)
+        rsp_async_wait_task();
+}
+
+/* Waits for the RSP task in flight unless it was deferred. Used before
+ * touching MI state, which deferred tasks leave alone. */
+static osal_inline void rsp_async_sync_mi(void)
+{
+    if (g_rsp_async_pending && !g_rsp_async_deferred)
+        rsp_async_wait_task();
+}
+
+#endif /* M64P_MAIN_RSP_ASYNC_H */
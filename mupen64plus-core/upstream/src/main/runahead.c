@@ -0,0 +1,156 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - runahead.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "runahead.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "main.h"
+#include "savestates.h"
+
+enum { RUNAHEAD_MAX_FRAMES = 8 };
+
+enum runahead_phase
+{
+    RUNAHEAD_REAL,      /* real timeline, video hidden */
+    RUNAHEAD_AHEAD,     /* ahead of the real timeline, video hidden */
+    RUNAHEAD_SHOWN      /* last frame ahead, the one presented */
+};
+
+struct runahead
+{
+    /* state at the end of the last real frame */
+    uint32_t* snapshot;
+
+    unsigned int frames;
+    unsigned int ahead;
+    enum runahead_phase phase;
+    int capture_pending;
+    int restore_pending;
+};
+
+static struct runahead l_runahead;
+
+
+int runahead_init(unsigned int frames)
+{
+    runahead_deinit();
+
+    if (frames == 0) {
+        return 0;
+    }
+
+    if (frames > RUNAHEAD_MAX_FRAMES) {
+        DebugMessage(M64MSG_WARNING, "Run-ahead limited to %u frames", RUNAHEAD_MAX_FRAMES);
+        frames = RUNAHEAD_MAX_FRAMES;
+    }
+
+    l_runahead.snapshot = calloc(1, SAVESTATE_M64P_SIZE);
+    if (l_runahead.snapshot == NULL) {
+        DebugMessage(M64MSG_ERROR, "Failed to allocate run-ahead buffer");
+        return -1;
+    }
+
+    l_runahead.frames = frames;
+
+    DebugMessage(M64MSG_INFO, "Run-ahead enabled: %u frame(s)", frames);
+
+    return 0;
+}
+
+void runahead_deinit(void)
+{
+    free(l_runahead.snapshot);
+    memset(&l_runahead, 0, sizeof(l_runahead));
+}
+
+int runahead_new_vi(void)
+{
+    if (l_runahead.snapshot == NULL) {
+        return 0;
+    }
+
+    if (l_runahead.phase == RUNAHEAD_REAL) {
+        l_runahead.capture_pending = 1;
+        return 0;
+    }
+
+    if (++l_runahead.ahead >= l_runahead.frames) {
+        /* hide whatever is rendered until the real frame is back */
+        l_runahead.phase = RUNAHEAD_AHEAD;
+        l_runahead.restore_pending = 1;
+    }
+    else if (l_runahead.ahead + 1 == l_runahead.frames) {
+        l_runahead.phase = RUNAHEAD_SHOWN;
+    }
+
+    return 1;
+}
+
+int runahead_is_ahead(void)
+{
+    return l_runahead.phase != RUNAHEAD_REAL;
+}
+
+int runahead_video_hidden(void)
+{
+    return l_runahead.snapshot != NULL && l_runahead.phase != RUNAHEAD_SHOWN;
+}
+
+void runahead_reset(void)
+{
+    l_runahead.phase = RUNAHEAD_REAL;
+    l_runahead.ahead = 0;
+    l_runahead.capture_pending = 0;
+    l_runahead.restore_pending = 0;
+}
+
+int runahead_restore_pending(void)
+{
+    if (!l_runahead.restore_pending) {
+        return 0;
+    }
+
+    runahead_reset();
+
+    /* each snapshot is restored once, loading may byteswap it in place */
+    savestates_load_m64p_mem(&g_dev, l_runahead.snapshot);
+
+    return 1;
+}
+
+void runahead_capture_pending(void)
+{
+    if (!l_runahead.capture_pending) {
+        return;
+    }
+
+    l_runahead.capture_pending = 0;
+
+    savestates_save_m64p_mem(&g_dev, l_runahead.snapshot);
+
+    l_runahead.ahead = 0;
+    l_runahead.phase = (l_runahead.frames == 1) ? RUNAHEAD_SHOWN : RUNAHEAD_AHEAD;
+}
@@ -0,0 +1,52 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - runahead.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_RUNAHEAD_H
+#define M64P_MAIN_RUNAHEAD_H
+
+/* Run-ahead input latency reduction.
+ *
+ * After each frame of the real timeline the machine state is saved in
+ * memory, then the next frames are emulated ahead of time with the audio
+ * muted and only the last one shown. The saved state is then restored and
+ * the next real frame is emulated with the video hidden, so the screen
+ * always reflects the inputs frames later than the real timeline would. */
+
+int runahead_init(unsigned int frames);
+void runahead_deinit(void);
+
+/* Called on every VI by the main loop.
+ * Returns 1 if the VI ends a frame emulated ahead of the real timeline. */
+int runahead_new_vi(void);
+
+/* state is ahead of the real timeline: audio is muted, nothing must be saved */
+int runahead_is_ahead(void);
+/* video plugin must not render */
+int runahead_video_hidden(void);
+
+/* Go back to the real timeline after the state was replaced by other means */
+void runahead_reset(void);
+
+/* called by the core at points where the state can be saved/restored */
+int runahead_restore_pending(void);
+void runahead_capture_pending(void);
+
+#endif
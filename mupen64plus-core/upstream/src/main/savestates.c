@@ -41,6 +41,7 @@
 #include "device/device.h"
 #include "main/list.h"
 #include "main/main.h"
+#include "main/rsp_async.h"
 #include "osal/preproc.h"
 #include "osd/osd.h"
 #include "plugin/plugin.h"
@@ -72,6 +73,7 @@ static char *fname = NULL;
 
 static unsigned int slot = 0;
 static int autoinc_save_slot = 0;
+static int compression_level = 1;
 
 static SDL_mutex *savestates_lock;
 
@@ -79,6 +81,36 @@ struct savestate_work {
     char *filepath;
     char *data;
     size_t size;
+    int level;
+    struct work_struct work;
+};
+
+/* Mupen64plus savestates are written as a series of gzip members, each one
+ * holding SAVESTATE_CHUNK_SIZE bytes of the state. Concatenated members are
+ * still a valid gzip file for gzread, but as they are compressed
+ * independently they can also be inflated in parallel. The compressed size
+ * of every member is stored in an extra field of the first member header:
+ * 'M' 'C' LEN(2) chunk_size(4) chunk_count(4) member_size(4)[chunk_count] */
+enum { SAVESTATE_CHUNK_SIZE = 0x100000 };
+enum { SAVESTATE_CHUNK_COUNT = (SAVESTATE_M64P_SIZE + SAVESTATE_CHUNK_SIZE - 1) / SAVESTATE_CHUNK_SIZE };
+enum { SAVESTATE_INDEX_SIZE = 4 + 8 + 4 * SAVESTATE_CHUNK_COUNT };
+enum { SAVESTATE_INFLATE_HELPERS = 2 };
+
+struct savestate_chunks {
+    const unsigned char *file;
+    unsigned char *data;
+    size_t offset[SAVESTATE_CHUNK_COUNT];
+    size_t size[SAVESTATE_CHUNK_COUNT];
+    unsigned int next;
+    unsigned int completed;
+    unsigned int refs;
+    int failed;
+    SDL_mutex *lock;
+    SDL_sem *done;
+};
+
+struct savestate_inflate_helper {
+    struct savestate_chunks *chunks;
     struct work_struct work;
 };
 
@@ -142,6 +174,17 @@ void savestates_set_autoinc_slot(int b)
     autoinc_save_slot = b;
 }
 
+void savestates_set_compression_level(int level)
+{
+    if (level < 0 || level > 9)
+    {
+        DebugMessage(M64MSG_WARNING, "Invalid save state compression level %d, using 1", level);
+        level = 1;
+    }
+
+    compression_level = level;
+}
+
 void savestates_inc_slot(void)
 {
     if(++slot>9)
@@ -188,126 +231,22 @@ static void savestates_clear_job(void)
 #define PUTDATA(buff, type, value) \
     do { type x = value; PUTARRAY(&x, buff, type, 1); } while(0)
 
-static int savestates_load_m64p(struct device* dev, char *filepath)
+/* Restore device state from an in-memory Mupen64plus savestate.
+ * savestateData, queue, additionalData and data_0001_0200 point to the
+ * respective sections of the savestate which must be at least as large
+ * as what the given version stores. Data is byteswapped in place. */
+static void savestates_deserialize_m64p(struct device* dev, unsigned int version,
+                                        unsigned char *savestateData, char *queue,
+                                        unsigned char *additionalData,
+                                        unsigned char *data_0001_0200)
 {
-    unsigned char header[44];
-    gzFile f;
-    unsigned int version;
     int i;
     uint32_t FCR31;
-
-    size_t savestateSize;
-    unsigned char *savestateData, *curr;
-    char queue[1024];
-    unsigned char additionalData[4];
-    unsigned char data_0001_0200[4096]; // 4k for extra state from v1.2
     uint64_t flashram_status;
+    unsigned char *curr = savestateData;
 
     uint32_t* cp0_regs = r4300_cp0_regs(&dev->r4300.cp0);
 
-    SDL_LockMutex(savestates_lock);
-
-    f = gzopen(filepath, "rb");
-    if(f==NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-
-    /* Read and check Mupen64Plus magic number. */
-    if (gzread(f, header, 44) != 44)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr = header;
-
-    if(strncmp((char *)curr, savestate_magic, 8)!=0)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", filepath);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr += 8;
-
-    version = *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    version = (version << 8) | *curr++;
-    if((version >> 16) != (savestate_latest_version >> 16))
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", version);
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-
-    if(memcmp((char *)curr, ROM_SETTINGS.MD5, 32))
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State ROM MD5 does not match current ROM.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    curr += 32;
-
-    /* Read the rest of the savestate */
-    savestateSize = 16788244;
-    savestateData = curr = (unsigned char *)malloc(savestateSize);
-    if (savestateData == NULL)
-    {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
-        gzclose(f);
-        SDL_UnlockMutex(savestates_lock);
-        return 0;
-    }
-    if (version == 0x00010000) /* original savestate version */
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            (gzread(f, queue, sizeof(queue)) % 4) != 0)
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.0 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, additionalData, sizeof(additionalData)) != sizeof(additionalData))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.1 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
-    {
-        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
-            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
-            gzread(f, additionalData, sizeof(additionalData)) != sizeof(additionalData) ||
-            gzread(f, data_0001_0200, sizeof(data_0001_0200)) != sizeof(data_0001_0200))
-        {
-            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.2 data from %s", filepath);
-            free(savestateData);
-            gzclose(f);
-            SDL_UnlockMutex(savestates_lock);
-            return 0;
-        }
-    }
-
-    gzclose(f);
-    SDL_UnlockMutex(savestates_lock);
-
     // Parse savestate
     dev->rdram.regs[0][RDRAM_CONFIG_REG]       = GETDATA(curr, uint32_t);
     dev->rdram.regs[0][RDRAM_DEVICE_ID_REG]    = GETDATA(curr, uint32_t);
@@ -424,6 +363,7 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     dev->dp.dps_regs[DPS_BUFTEST_DATA_REG] = GETDATA(curr, uint32_t);
 
     COPYARRAY(dev->rdram.dram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+    mark_rdram_written(&dev->rdram, 0, RDRAM_MAX_SIZE);
     COPYARRAY(dev->sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
     COPYARRAY(dev->pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
@@ -437,6 +377,7 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
 
     COPYARRAY(dev->r4300.cp0.tlb.LUT_r, curr, uint32_t, 0x100000);
     COPYARRAY(dev->r4300.cp0.tlb.LUT_w, curr, uint32_t, 0x100000);
+    tlb_flush_host_cache(&dev->r4300.cp0.tlb);
 
     *r4300_llbit(&dev->r4300) = GETDATA(curr, unsigned int);
     COPYARRAY(r4300_regs(&dev->r4300), curr, int64_t, 32);
@@ -863,6 +804,395 @@ static int savestates_load_m64p(struct device* dev, char *filepath)
     dev->r4300.cp0.interrupt_unsafe_state = 0;
 
     *r4300_cp0_last_addr(&dev->r4300.cp0) = *r4300_pc(&dev->r4300);
+}
+
+void savestates_load_m64p_mem(struct device* dev, void *data)
+{
+    /* same layout as the savestate file written by savestates_save_m64p */
+    unsigned char *savestateData = (unsigned char *)data + 44;
+    char *queue = (char *)savestateData + 16788244;
+    unsigned char *additionalData = (unsigned char *)queue + 1024;
+    unsigned char *data_0001_0200 = additionalData + 4;
+
+    rsp_async_sync();
+
+    savestates_deserialize_m64p(dev, savestate_latest_version,
+                                savestateData, queue, additionalData, data_0001_0200);
+}
+
+static uint16_t savestates_get_le16(const unsigned char *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t savestates_get_le32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void savestates_put_le16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void savestates_put_le32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+/* Inflate the gzip member at member into dst, which must end up exactly full.
+ * Only the header fields written by savestates_write_member are accepted. */
+static int savestates_inflate_member(const unsigned char *member, size_t member_size,
+                                     unsigned char *dst, size_t dst_size)
+{
+    z_stream strm;
+    size_t header_size = 10;
+    int ret;
+
+    if (member_size < header_size + 8 || member[0] != 0x1f || member[1] != 0x8b
+     || member[2] != Z_DEFLATED || (member[3] & ~0x04) != 0)
+        return 0;
+
+    /* FEXTRA */
+    if (member[3] & 0x04)
+    {
+        header_size += 2 + savestates_get_le16(member + 10);
+        if (member_size < header_size + 8)
+            return 0;
+    }
+
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+        return 0;
+
+    strm.next_in = (Bytef *)(member + header_size);
+    strm.avail_in = (uInt)(member_size - header_size);
+    strm.next_out = dst;
+    strm.avail_out = (uInt)dst_size;
+    ret = inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+
+    /* the deflate stream must fill dst and be followed by the trailer only */
+    if (ret != Z_STREAM_END || strm.avail_out != 0 || strm.avail_in != 8)
+        return 0;
+
+    return savestates_get_le32(strm.next_in) == crc32(0L, dst, (uInt)dst_size)
+        && savestates_get_le32(strm.next_in + 4) == (uint32_t)dst_size;
+}
+
+static void savestates_release_chunks(struct savestate_chunks *chunks)
+{
+    unsigned int refs;
+
+    SDL_LockMutex(chunks->lock);
+    refs = --chunks->refs;
+    SDL_UnlockMutex(chunks->lock);
+
+    if (refs == 0)
+    {
+        SDL_DestroySemaphore(chunks->done);
+        SDL_DestroyMutex(chunks->lock);
+        free(chunks);
+    }
+}
+
+/* Inflate chunks until none are left. Run by the loading thread and by the
+ * workqueue helpers alike; whoever completes the last chunk posts done. */
+static void savestates_inflate_chunks(struct savestate_chunks *chunks)
+{
+    unsigned int i;
+    int ok;
+
+    for (;;)
+    {
+        SDL_LockMutex(chunks->lock);
+        i = chunks->next < SAVESTATE_CHUNK_COUNT ? chunks->next++ : SAVESTATE_CHUNK_COUNT;
+        SDL_UnlockMutex(chunks->lock);
+
+        if (i == SAVESTATE_CHUNK_COUNT)
+            break;
+
+        ok = savestates_inflate_member(chunks->file + chunks->offset[i], chunks->size[i],
+                                       chunks->data + (size_t)i * SAVESTATE_CHUNK_SIZE,
+                                       i == SAVESTATE_CHUNK_COUNT - 1
+                                       ? SAVESTATE_M64P_SIZE - (size_t)i * SAVESTATE_CHUNK_SIZE
+                                       : SAVESTATE_CHUNK_SIZE);
+
+        SDL_LockMutex(chunks->lock);
+        if (!ok)
+            chunks->failed = 1;
+        if (++chunks->completed == SAVESTATE_CHUNK_COUNT)
+            SDL_SemPost(chunks->done);
+        SDL_UnlockMutex(chunks->lock);
+    }
+}
+
+static void savestates_inflate_work(struct work_struct *work)
+{
+    struct savestate_inflate_helper *helper = container_of(work, struct savestate_inflate_helper, work);
+    struct savestate_chunks *chunks = helper->chunks;
+
+    free(helper);
+    savestates_inflate_chunks(chunks);
+    savestates_release_chunks(chunks);
+}
+
+/* Inflate a chunked savestate file into data, which must hold
+ * SAVESTATE_M64P_SIZE bytes. Returns -1 if the file has no chunk index,
+ * 0 if it is damaged and 1 on success. */
+static int savestates_inflate_chunked(const unsigned char *file, size_t file_size, unsigned char *data)
+{
+    const unsigned char *index = file + 12;
+    struct savestate_chunks *chunks;
+    struct savestate_inflate_helper *helper;
+    size_t offset;
+    unsigned int i;
+    int ret;
+
+    if (file_size < 12 + SAVESTATE_INDEX_SIZE || file[0] != 0x1f || file[1] != 0x8b
+     || !(file[3] & 0x04) || savestates_get_le16(file + 10) != SAVESTATE_INDEX_SIZE
+     || index[0] != 'M' || index[1] != 'C'
+     || savestates_get_le16(index + 2) != SAVESTATE_INDEX_SIZE - 4
+     || savestates_get_le32(index + 4) != SAVESTATE_CHUNK_SIZE
+     || savestates_get_le32(index + 8) != SAVESTATE_CHUNK_COUNT)
+        return -1;
+
+    chunks = calloc(1, sizeof(*chunks));
+    if (chunks == NULL)
+        return 0;
+
+    for (i = 0, offset = 0; i < SAVESTATE_CHUNK_COUNT; ++i)
+    {
+        chunks->offset[i] = offset;
+        chunks->size[i] = savestates_get_le32(index + 12 + 4 * i);
+        if (chunks->size[i] > file_size - offset)
+        {
+            free(chunks);
+            return 0;
+        }
+        offset += chunks->size[i];
+    }
+
+    chunks->file = file;
+    chunks->data = data;
+    chunks->refs = 1;
+    chunks->lock = SDL_CreateMutex();
+    chunks->done = SDL_CreateSemaphore(0);
+    if (chunks->lock == NULL || chunks->done == NULL)
+    {
+        if (chunks->lock != NULL)
+            SDL_DestroyMutex(chunks->lock);
+        if (chunks->done != NULL)
+            SDL_DestroySemaphore(chunks->done);
+        free(chunks);
+        return 0;
+    }
+
+    /* Helpers that only get to run once every chunk is taken just drop
+     * their reference, so a busy workqueue never delays the load. */
+    for (i = 0; i < SAVESTATE_INFLATE_HELPERS; ++i)
+    {
+        helper = malloc(sizeof(*helper));
+        if (helper == NULL)
+            break;
+
+        helper->chunks = chunks;
+        SDL_LockMutex(chunks->lock);
+        ++chunks->refs;
+        SDL_UnlockMutex(chunks->lock);
+
+        init_work_prio(&helper->work, savestates_inflate_work, NULL, WORK_PRIORITY_ROM);
+        queue_work(&helper->work);
+    }
+
+    savestates_inflate_chunks(chunks);
+    SDL_SemWait(chunks->done);
+
+    ret = !chunks->failed;
+    savestates_release_chunks(chunks);
+
+    return ret;
+}
+
+/* Check the 44 bytes Mupen64plus savestate header and extract its version. */
+static int savestates_check_m64p_header(const unsigned char *header, unsigned int *version,
+                                        const char *filepath)
+{
+    const unsigned char *curr = header;
+
+    if(strncmp((const char *)curr, savestate_magic, 8)!=0)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State file: %s is not a valid Mupen64plus savestate.", filepath);
+        return 0;
+    }
+    curr += 8;
+
+    *version = *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    *version = (*version << 8) | *curr++;
+    if((*version >> 16) != (savestate_latest_version >> 16))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State version (%08x) isn't compatible. Please update Mupen64Plus.", *version);
+        return 0;
+    }
+
+    if(memcmp((const char *)curr, ROM_SETTINGS.MD5, 32))
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State ROM MD5 does not match current ROM.");
+        return 0;
+    }
+
+    return 1;
+}
+
+/* Load a chunked savestate. Returns -1 if filepath isn't one, in which
+ * case it still has to go through gzread. */
+static int savestates_load_m64p_chunked(struct device* dev, char *filepath)
+{
+    void *file;
+    size_t file_size;
+    unsigned char *data;
+    unsigned int version;
+    int ret;
+
+    /* The file is read rather than mapped: a save running as soon as the
+     * lock is released would truncate it under the mapping. */
+    SDL_LockMutex(savestates_lock);
+    if (load_file(filepath, &file, &file_size) != file_ok)
+    {
+        SDL_UnlockMutex(savestates_lock);
+        return -1;
+    }
+    SDL_UnlockMutex(savestates_lock);
+
+    data = malloc(SAVESTATE_M64P_SIZE);
+    if (data == NULL)
+    {
+        free(file);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        return 0;
+    }
+
+    ret = savestates_inflate_chunked((const unsigned char *)file, file_size, data);
+    free(file);
+
+    if (ret == 0)
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate data from %s", filepath);
+    else if (ret == 1 && !savestates_check_m64p_header(data, &version, filepath))
+        ret = 0;
+    else if (ret == 1)
+    {
+        savestates_deserialize_m64p(dev, version, data + 44, (char *)data + 44 + 16788244,
+                                    data + 44 + 16788244 + 1024, data + 44 + 16788244 + 1024 + 4);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
+    }
+
+    free(data);
+    return ret;
+}
+
+static int savestates_load_m64p(struct device* dev, char *filepath)
+{
+    unsigned char header[44];
+    gzFile f;
+    unsigned int version;
+
+    size_t savestateSize;
+    unsigned char *savestateData, *curr;
+    char queue[1024];
+    unsigned char additionalData[4];
+    unsigned char data_0001_0200[4096]; // 4k for extra state from v1.2
+    int ret;
+
+    ret = savestates_load_m64p_chunked(dev, filepath);
+    if (ret >= 0)
+        return ret;
+
+    SDL_LockMutex(savestates_lock);
+
+    f = gzopen(filepath, "rb");
+    if(f==NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", filepath);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Read and check Mupen64Plus magic number. */
+    if (gzread(f, header, 44) != 44)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read header from state file %s", filepath);
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    if (!savestates_check_m64p_header(header, &version, filepath))
+    {
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+
+    /* Read the rest of the savestate */
+    savestateSize = 16788244;
+    savestateData = curr = (unsigned char *)malloc(savestateSize);
+    if (savestateData == NULL)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to load state.");
+        gzclose(f);
+        SDL_UnlockMutex(savestates_lock);
+        return 0;
+    }
+    if (version == 0x00010000) /* original savestate version */
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            (gzread(f, queue, sizeof(queue)) % 4) != 0)
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.0 data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+    else if (version == 0x00010100) // saves entire eventqueue plus 4-byte using_tlb flags
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
+            gzread(f, additionalData, sizeof(additionalData)) != sizeof(additionalData))
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.1 data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+    else // version >= 0x00010200  saves entire eventqueue, 4-byte using_tlb flags and extra state
+    {
+        if (gzread(f, savestateData, savestateSize) != (int)savestateSize ||
+            gzread(f, queue, sizeof(queue)) != sizeof(queue) ||
+            gzread(f, additionalData, sizeof(additionalData)) != sizeof(additionalData) ||
+            gzread(f, data_0001_0200, sizeof(data_0001_0200)) != sizeof(data_0001_0200))
+        {
+            main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not read Mupen64Plus savestate 1.2 data from %s", filepath);
+            free(savestateData);
+            gzclose(f);
+            SDL_UnlockMutex(savestates_lock);
+            return 0;
+        }
+    }
+
+    gzclose(f);
+    SDL_UnlockMutex(savestates_lock);
+
+    savestates_deserialize_m64p(dev, version, savestateData, queue, additionalData, data_0001_0200);
 
     free(savestateData);
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "State loaded from: %s", namefrompath(filepath));
@@ -1149,6 +1479,7 @@ static int savestates_load_pj64(struct device* dev,
     // RDRAM
     memset(dev->rdram.dram, 0, RDRAM_MAX_SIZE);
     COPYARRAY(dev->rdram.dram, curr, uint32_t, SaveRDRAMSize/4);
+    mark_rdram_written(&dev->rdram, 0, RDRAM_MAX_SIZE);
 
     // DMEM + IMEM
     COPYARRAY(dev->sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
@@ -1315,6 +1646,11 @@ int savestates_load(void)
     char *filepath = NULL;
     int ret = 0;
 
+    /* an RSP task in flight would race with the state being read */
+    rsp_async_sync();
+    /* batched samples were produced before the state being loaded */
+    main_audio_out_flush();
+
     if (fname == NULL) // For slots, autodetect the savestate type
     {
         // try M64P type first
@@ -1389,35 +1725,139 @@ int savestates_load(void)
     return ret;
 }
 
+/* Write data as one gzip member, with extra in its header if not NULL.
+ * Returns the size of the member, or 0 on error. */
+static size_t savestates_write_member(FILE *f, const unsigned char *data, size_t size, int level,
+                                      const unsigned char *extra, size_t extra_size,
+                                      unsigned char *buffer, size_t buffer_size)
+{
+    unsigned char header[12];
+    unsigned char trailer[8];
+    size_t header_size = extra != NULL ? 12 : 10;
+    size_t member_size, n;
+    z_stream strm;
+    int ret;
+
+    memset(header, 0, sizeof(header));
+    header[0] = 0x1f;
+    header[1] = 0x8b;
+    header[2] = Z_DEFLATED;
+    header[3] = extra != NULL ? 0x04 : 0; /* FEXTRA */
+    header[9] = 0xff; /* unknown OS */
+    savestates_put_le16(header + 10, (uint16_t)extra_size);
+
+    if (fwrite(header, 1, header_size, f) != header_size
+     || (extra != NULL && fwrite(extra, 1, extra_size, f) != extra_size))
+        return 0;
+    member_size = header_size + extra_size;
+
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return 0;
+
+    strm.next_in = (Bytef *)data;
+    strm.avail_in = (uInt)size;
+    do
+    {
+        strm.next_out = buffer;
+        strm.avail_out = (uInt)buffer_size;
+        ret = deflate(&strm, Z_FINISH);
+        if (ret == Z_STREAM_ERROR)
+            break;
+
+        n = buffer_size - strm.avail_out;
+        if (fwrite(buffer, 1, n, f) != n)
+        {
+            ret = Z_ERRNO;
+            break;
+        }
+        member_size += n;
+    } while (ret != Z_STREAM_END);
+    deflateEnd(&strm);
+
+    if (ret != Z_STREAM_END)
+        return 0;
+
+    savestates_put_le32(trailer, (uint32_t)crc32(0L, data, (uInt)size));
+    savestates_put_le32(trailer + 4, (uint32_t)size);
+    if (fwrite(trailer, 1, sizeof(trailer), f) != sizeof(trailer))
+        return 0;
+
+    return member_size + sizeof(trailer);
+}
+
+/* Write data, which holds SAVESTATE_M64P_SIZE bytes, as a chunked savestate */
+static int savestates_write_chunked(FILE *f, const unsigned char *data, int level)
+{
+    enum { BUFFER_SIZE = 0x10000 };
+    unsigned char index[SAVESTATE_INDEX_SIZE];
+    unsigned char *buffer;
+    size_t member_size, chunk_size;
+    unsigned int i;
+
+    buffer = malloc(BUFFER_SIZE);
+    if (buffer == NULL)
+        return 0;
+
+    memset(index, 0, sizeof(index));
+    index[0] = 'M';
+    index[1] = 'C';
+    savestates_put_le16(index + 2, SAVESTATE_INDEX_SIZE - 4);
+    savestates_put_le32(index + 4, SAVESTATE_CHUNK_SIZE);
+    savestates_put_le32(index + 8, SAVESTATE_CHUNK_COUNT);
+
+    for (i = 0; i < SAVESTATE_CHUNK_COUNT; ++i)
+    {
+        chunk_size = i == SAVESTATE_CHUNK_COUNT - 1
+                   ? SAVESTATE_M64P_SIZE - (size_t)i * SAVESTATE_CHUNK_SIZE
+                   : SAVESTATE_CHUNK_SIZE;
+
+        /* the index is filled in once all member sizes are known */
+        member_size = savestates_write_member(f, data + (size_t)i * SAVESTATE_CHUNK_SIZE, chunk_size, level,
+                                              i == 0 ? index : NULL, i == 0 ? sizeof(index) : 0,
+                                              buffer, BUFFER_SIZE);
+        if (member_size == 0)
+        {
+            free(buffer);
+            return 0;
+        }
+        savestates_put_le32(index + 12 + 4 * i, (uint32_t)member_size);
+    }
+    free(buffer);
+
+    return fseek(f, 12, SEEK_SET) == 0 && fwrite(index, 1, sizeof(index), f) == sizeof(index);
+}
+
 static void savestates_save_m64p_work(struct work_struct *work)
 {
-    gzFile f;
-    int gzres;
+    FILE *f;
     struct savestate_work *save = container_of(work, struct savestate_work, work);
 
     SDL_LockMutex(savestates_lock);
 
-    // Write the state to a GZIP file
-    f = gzopen(save->filepath, "wb");
+    f = fopen(save->filepath, "wb");
 
     if (f==NULL)
     {
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not open state file: %s", save->filepath);
-        free(save->data);
-        return;
+        goto out;
     }
 
-    gzres = gzwrite(f, save->data, save->size);
-    if ((gzres < 0) || ((size_t)gzres != save->size))
+    if (!savestates_write_chunked(f, (const unsigned char *)save->data, save->level))
     {
         main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
-        gzclose(f);
-        free(save->data);
-        return;
+        fclose(f);
+        goto out;
     }
 
-    gzclose(f);
+    if (fclose(f) != 0)
+    {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Could not write data to state file: %s", save->filepath);
+        goto out;
+    }
     main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Saved state to: %s", namefrompath(save->filepath));
+
+out:
     free(save->data);
     free(save->filepath);
     free(save);
@@ -1425,46 +1865,23 @@ static void savestates_save_m64p_work(struct work_struct *work)
     SDL_UnlockMutex(savestates_lock);
 }
 
-static int savestates_save_m64p(const struct device* dev, char *filepath)
+/* Serialize device state in the Mupen64plus savestate format to data,
+ * which must hold SAVESTATE_M64P_SIZE bytes. Bytes skipped by the format
+ * are left untouched, so data should be zeroed once by the caller. */
+static void savestates_serialize_m64p(const struct device* dev, char *data)
 {
     unsigned char outbuf[4];
     int i;
     uint64_t flashram_status;
 
     char queue[1024];
-
-    struct savestate_work *save;
-    char *curr;
+    char *curr = data;
 
     /* OK to cast away const qualifier */
     const uint32_t* cp0_regs = r4300_cp0_regs((struct cp0*)&dev->r4300.cp0);
 
-    save = malloc(sizeof(*save));
-    if (!save) {
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
-
-    save->filepath = strdup(filepath);
-
-    if(autoinc_save_slot)
-        savestates_inc_slot();
-
     save_eventqueue_infos(&dev->r4300.cp0, queue);
 
-    // Allocate memory for the save state data
-    save->size = 16788288 + sizeof(queue) + 4 + 4096;
-    save->data = curr = malloc(save->size);
-    if (save->data == NULL)
-    {
-        free(save->filepath);
-        free(save);
-        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
-        return 0;
-    }
-
-    memset(save->data, 0, save->size);
-
     // Write the save state data to memory
     PUTARRAY(savestate_magic, curr, unsigned char, 8);
 
@@ -1800,8 +2217,47 @@ static int savestates_save_m64p(const struct device* dev, char *filepath)
         PUTDATA(curr, unsigned int, dev->dd.bm_zone);
         PUTDATA(curr, unsigned int, dev->dd.bm_track_offset);
     }
+}
+
+void savestates_save_m64p_mem(const struct device* dev, void *data)
+{
+    rsp_async_sync();
+
+    savestates_serialize_m64p(dev, (char *)data);
+}
+
+static int savestates_save_m64p(const struct device* dev, char *filepath)
+{
+    struct savestate_work *save;
+
+    save = malloc(sizeof(*save));
+    if (!save) {
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+    save->filepath = strdup(filepath);
+
+    if(autoinc_save_slot)
+        savestates_inc_slot();
+
+    // Allocate memory for the save state data
+    save->size = SAVESTATE_M64P_SIZE;
+    save->level = compression_level;
+    /* calloc instead of malloc+memset: large zeroed allocations come
+     * straight from the OS and don't need to be touched on this thread */
+    save->data = calloc(1, save->size);
+    if (save->data == NULL)
+    {
+        free(save->filepath);
+        free(save);
+        main_message(M64MSG_STATUS, OSD_BOTTOM_LEFT, "Insufficient memory to save state.");
+        return 0;
+    }
+
+    savestates_serialize_m64p(dev, save->data);
 
-    init_work(&save->work, savestates_save_m64p_work);
+    init_work_prio(&save->work, savestates_save_m64p_work, NULL, WORK_PRIORITY_COMPRESSION);
     queue_work(&save->work);
 
     return 1;
@@ -2044,6 +2500,9 @@ int savestates_save(void)
     int ret = 0;
     const struct device* dev = &g_dev;
 
+    /* let a pending RSP task land in the state */
+    rsp_async_sync();
+
     /* Can only save PJ64 savestates on VI / COMPARE interrupt.
        Otherwise try again in a little while. */
     if ((type == savestates_type_pj64_zip ||
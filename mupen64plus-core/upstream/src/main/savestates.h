@@ -40,6 +40,11 @@ typedef enum _savestates_type
     savestates_type_pj64_unc
 } savestates_type;
 
+/* Size of an uncompressed Mupen64plus savestate */
+enum { SAVESTATE_M64P_SIZE = 16788288 + 1024 + 4 + 4096 };
+
+struct device;
+
 savestates_job savestates_get_job(void);
 void savestates_set_job(savestates_job j, savestates_type t, const char *fn);
 void savestates_init(void);
@@ -48,10 +53,14 @@ void savestates_deinit(void);
 int savestates_load(void);
 int savestates_save(void);
 
+void savestates_save_m64p_mem(const struct device* dev, void *data);
+void savestates_load_m64p_mem(struct device* dev, void *data);
+
 void savestates_select_slot(unsigned int s);
 unsigned int savestates_get_slot(void);
 void savestates_set_autoinc_slot(int b);
 void savestates_inc_slot(void);
+void savestates_set_compression_level(int level);
 
 #endif /* __SAVESTAVES_H__ */
 
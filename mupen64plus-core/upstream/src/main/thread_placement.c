@@ -0,0 +1,154 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - thread_placement.c                                      *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "thread_placement.h"
+
+#include <stddef.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#define M64P_CORE_PROTOTYPES 1
+#include "api/callbacks.h"
+#include "api/config.h"
+#include "api/m64p_config.h"
+#include "main/main.h"
+
+#if defined(__linux__)
+static unsigned long read_cpu_value(int cpu, const char* name)
+{
+    char path[128];
+    unsigned long value = 0;
+    FILE* f;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+    f = fopen(path, "r");
+    if (f == NULL)
+        return 0;
+
+    if (fscanf(f, "%lu", &value) != 1)
+        value = 0;
+
+    fclose(f);
+    return value;
+}
+
+/* 0 for cores which are offline or can't be told apart */
+static unsigned long cpu_capacity(int cpu)
+{
+    unsigned long capacity = read_cpu_value(cpu, "cpu_capacity");
+
+    if (capacity == 0)
+        capacity = read_cpu_value(cpu, "cpufreq/cpuinfo_max_freq");
+
+    return capacity;
+}
+#endif
+
+m64p_error thread_placement_apply(m64p_thread_role role)
+{
+    switch (role)
+    {
+    case M64THREAD_EMULATION:
+    case M64THREAD_RENDER:
+    case M64THREAD_WORKER:
+    case M64THREAD_AUDIO:
+    case M64THREAD_BACKGROUND:
+        break;
+    default:
+        return M64ERR_INPUT_INVALID;
+    }
+
+    if (!ConfigGetParamBool(g_CoreConfig, "ThreadPlacement"))
+        return M64ERR_SUCCESS;
+
+#if defined(__linux__)
+    {
+        unsigned long capacities[CPU_SETSIZE];
+        unsigned long min_capacity = 0;
+        unsigned long max_capacity = 0;
+        cpu_set_t set;
+        long count = sysconf(_SC_NPROCESSORS_CONF);
+        int cpu;
+
+        if (count > CPU_SETSIZE)
+            count = CPU_SETSIZE;
+
+        for (cpu = 0; cpu < count; ++cpu)
+        {
+            capacities[cpu] = cpu_capacity(cpu);
+            if (capacities[cpu] == 0)
+                continue;
+
+            if (min_capacity == 0 || capacities[cpu] < min_capacity)
+                min_capacity = capacities[cpu];
+            if (capacities[cpu] > max_capacity)
+                max_capacity = capacities[cpu];
+        }
+
+        /* all cores alike, leave placement to the scheduler */
+        if (min_capacity == max_capacity)
+            return M64ERR_SUCCESS;
+
+        CPU_ZERO(&set);
+        for (cpu = 0; cpu < count; ++cpu)
+        {
+            if (capacities[cpu] == 0)
+                continue;
+
+            switch (role)
+            {
+            case M64THREAD_EMULATION:
+            case M64THREAD_RENDER:
+                if (capacities[cpu] == max_capacity)
+                    CPU_SET(cpu, &set);
+                break;
+            case M64THREAD_WORKER:
+            case M64THREAD_AUDIO:
+                if (capacities[cpu] > min_capacity)
+                    CPU_SET(cpu, &set);
+                break;
+            case M64THREAD_BACKGROUND:
+                if (capacities[cpu] == min_capacity)
+                    CPU_SET(cpu, &set);
+                break;
+            }
+        }
+
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        {
+            DebugMessage(M64MSG_WARNING, "couldn't set the affinity of a thread with role %d", (int)role);
+            return M64ERR_SYSTEM_FAIL;
+        }
+
+        return M64ERR_SUCCESS;
+    }
+#else
+    return M64ERR_UNSUPPORTED;
+#endif
+}
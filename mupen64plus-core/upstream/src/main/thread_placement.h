@@ -0,0 +1,35 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - thread_placement.h                                      *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_THREAD_PLACEMENT_H
+#define M64P_MAIN_THREAD_PLACEMENT_H
+
+#include "api/m64p_types.h"
+
+/* When the ThreadPlacement core parameter is set, restricts the calling
+ * thread to the cores matching its role: the fastest cores for the emulation
+ * and render threads, all but the slowest ones for workers and audio, and the
+ * slowest ones for background work. Cores are told apart by their capacity
+ * (or maximum frequency), so nothing is changed on CPUs with a single kind of
+ * core. */
+m64p_error thread_placement_apply(m64p_thread_role role);
+
+#endif
@@ -27,8 +27,8 @@
 #define MUPEN_CORE_NAME "Mupen64Plus Core"
 #define MUPEN_CORE_VERSION 0x020501
 
-#define FRONTEND_API_VERSION 0x020102
-#define CONFIG_API_VERSION   0x020301
+#define FRONTEND_API_VERSION 0x020106
+#define CONFIG_API_VERSION   0x020400
 #define DEBUG_API_VERSION    0x020000
 #define VIDEXT_API_VERSION   0x030100
 
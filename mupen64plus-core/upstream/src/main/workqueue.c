@@ -30,11 +30,12 @@
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
 #include "main/list.h"
+#include "main/thread_placement.h"
 
-#define WORKQUEUE_THREADS 1
+#define WORKQUEUE_THREADS 2
 
 struct workqueue_mgmt_globals {
-    struct list_head work_queue;
+    struct list_head work_queue[WORK_PRIORITY_COUNT];
     struct list_head thread_queue;
     struct list_head thread_list;
     SDL_mutex *lock;
@@ -53,6 +54,23 @@ static void workqueue_dismiss(struct work_struct *work)
 {
 }
 
+/* must be called with workqueue_mgmt.lock held */
+static struct work_struct *workqueue_pop_work(void)
+{
+    size_t i;
+    struct work_struct *work;
+
+    for (i = 0; i < WORK_PRIORITY_COUNT; i++) {
+        if (!list_empty(&workqueue_mgmt.work_queue[i])) {
+            work = list_first_entry(&workqueue_mgmt.work_queue[i], struct work_struct, list);
+            list_del_init(&work->list);
+            return work;
+        }
+    }
+
+    return NULL;
+}
+
 static struct work_struct *workqueue_get_work(struct workqueue_thread *thread)
 {
     int found = 0;
@@ -61,10 +79,9 @@ static struct work_struct *workqueue_get_work(struct workqueue_thread *thread)
     while (1) {
         SDL_LockMutex(workqueue_mgmt.lock);
         list_del_init(&thread->list);
-        if (!list_empty(&workqueue_mgmt.work_queue)) {
+        work = workqueue_pop_work();
+        if (work != NULL) {
             found = 1;
-            work = list_first_entry(&workqueue_mgmt.work_queue, struct work_struct, list);
-            list_del_init(&work->list);
         } else {
             list_add(&thread->list, &workqueue_mgmt.thread_queue);
 	    SDL_CondWait(thread->work_avail, workqueue_mgmt.lock);
@@ -83,6 +100,8 @@ static int workqueue_thread_handler(void *data)
     struct workqueue_thread *thread = data;
     struct work_struct *work;
 
+    thread_placement_apply(M64THREAD_BACKGROUND);
+
     while (1) {
         work = workqueue_get_work(thread);
         if (work->func == workqueue_dismiss) {
@@ -90,7 +109,7 @@ static int workqueue_thread_handler(void *data)
             break;
         }
 
-        work->func(work);
+        run_work(work);
     }
 
     return 0;
@@ -102,7 +121,8 @@ int workqueue_init(void)
     struct workqueue_thread *thread;
 
     memset(&workqueue_mgmt, 0, sizeof(workqueue_mgmt));
-    INIT_LIST_HEAD(&workqueue_mgmt.work_queue);
+    for (i = 0; i < WORK_PRIORITY_COUNT; i++)
+        INIT_LIST_HEAD(&workqueue_mgmt.work_queue[i]);
     INIT_LIST_HEAD(&workqueue_mgmt.thread_queue);
     INIT_LIST_HEAD(&workqueue_mgmt.thread_list);
 
@@ -154,9 +174,10 @@ void workqueue_shutdown(void)
     struct work_struct *work;
     struct workqueue_thread *thread, *safe;
 
+    /* lowest priority so that all pending work gets done first */
     for (i = 0; i < WORKQUEUE_THREADS; i++) {
         work = malloc(sizeof(*work));
-        init_work(work, workqueue_dismiss);
+        init_work_prio(work, workqueue_dismiss, NULL, WORK_PRIORITY_COUNT - 1);
         queue_work(work);
     }
 
@@ -167,7 +188,10 @@ void workqueue_shutdown(void)
         free(thread);
     }
 
-    if (!list_empty(&workqueue_mgmt.work_queue))
+    SDL_LockMutex(workqueue_mgmt.lock);
+    work = workqueue_pop_work();
+    SDL_UnlockMutex(workqueue_mgmt.lock);
+    if (work != NULL)
         DebugMessage(M64MSG_WARNING, "Stopped workqueue with work still pending");
  
     SDL_DestroyMutex(workqueue_mgmt.lock);
@@ -178,7 +202,7 @@ int queue_work(struct work_struct *work)
     struct workqueue_thread *thread;
 
     SDL_LockMutex(workqueue_mgmt.lock);
-    list_add_tail(&work->list, &workqueue_mgmt.work_queue);
+    list_add_tail(&work->list, &workqueue_mgmt.work_queue[work->priority]);
     if (!list_empty(&workqueue_mgmt.thread_queue)) {
         thread = list_first_entry(&workqueue_mgmt.thread_queue, struct workqueue_thread, list);
         list_del_init(&thread->list);
@@ -27,10 +27,23 @@
 
 struct work_struct;
 
+/* Pending work is run in this order, then in queuing order */
+enum work_priority {
+    WORK_PRIORITY_ROM,          /* ROM hashing, holds up the emulation start */
+    WORK_PRIORITY_IO,           /* background I/O (save files) */
+    WORK_PRIORITY_COMPRESSION,  /* savestate compression */
+    WORK_PRIORITY_ENCODE,       /* screenshot encoding */
+    WORK_PRIORITY_COUNT
+};
+
 struct work_struct *work;
 typedef void (*work_func_t)(struct work_struct *work);
 struct work_struct {
     work_func_t func;
+    /* optional, called after func on the same thread.
+     * If set, func must leave freeing the work to it. */
+    work_func_t done;
+    enum work_priority priority;
     struct list_head list;
 };
 
@@ -38,6 +51,25 @@ static osal_inline void init_work(struct work_struct *work, work_func_t func)
 {
     INIT_LIST_HEAD(&work->list);
     work->func = func;
+    work->done = NULL;
+    work->priority = WORK_PRIORITY_COMPRESSION;
+}
+
+static osal_inline void init_work_prio(struct work_struct *work, work_func_t func,
+                                       work_func_t done, enum work_priority priority)
+{
+    init_work(work, func);
+    work->done = done;
+    work->priority = priority;
+}
+
+static osal_inline void run_work(struct work_struct *work)
+{
+    work_func_t done = work->done;
+
+    work->func(work);
+    if (done != NULL)
+        done(work);
 }
 
 #ifdef M64P_PARALLEL
@@ -59,7 +91,7 @@ static osal_inline void workqueue_shutdown(void)
 
 static osal_inline int queue_work(struct work_struct *work)
 {
-    work->func(work);
+    run_work(work);
     return 0;
 }
 
@@ -26,6 +26,8 @@
 #if !defined (OSAL_FILES_H)
 #define OSAL_FILES_H
 
+#include <stddef.h>
+
 /* some file-related preprocessor definitions */
 #if defined(WIN32) && !defined(__MINGW32__)
   #include <io.h> // For _unlink()
@@ -57,5 +59,12 @@ extern const char * osal_get_user_configpath(void);
 extern const char * osal_get_user_datapath(void);
 extern const char * osal_get_user_cachepath(void);
 
+/* Map a whole file in memory, so that its pages are only read when accessed.
+ * The mapping is private: writes to it are never carried to the file.
+ * Returns NULL on failure, otherwise the size of the file is stored in *size.
+ */
+extern void * osal_map_file(const char *filename, size_t *size);
+extern void osal_unmap_file(void *addr, size_t size);
+
 #endif /* OSAL_FILES_H */
 
@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -232,4 +234,31 @@ const char * osal_get_user_cachepath(void)
     return NULL;
 }
 
+void * osal_map_file(const char *filename, size_t *size)
+{
+    struct stat fileinfo;
+    void *addr;
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &fileinfo) != 0 || fileinfo.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
 
+    addr = mmap(NULL, (size_t) fileinfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);  /* the mapping keeps the file open */
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    *size = (size_t) fileinfo.st_size;
+    return addr;
+}
+
+void osal_unmap_file(void *addr, size_t size)
+{
+    munmap(addr, size);
+}
@@ -25,6 +25,7 @@
 
 #include <direct.h>
 #include <shlobj.h>
+#include <windows.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -204,4 +205,38 @@ const char * osal_get_user_cachepath(void)
     return osal_get_user_configpath();
 }
 
+void * osal_map_file(const char *filename, size_t *size)
+{
+    HANDLE file, mapping;
+    LARGE_INTEGER filesize;
+    void *addr;
+
+    file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &filesize) || filesize.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    /* copy-on-write view, the file itself is only read */
+    mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
 
+    addr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);  /* the view keeps the mapping alive */
+    if (addr == NULL)
+        return NULL;
+
+    *size = (size_t) filesize.QuadPart;
+    return addr;
+}
+
+void osal_unmap_file(void *addr, size_t size)
+{
+    UnmapViewOfFile(addr);
+}
@@ -24,13 +24,14 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include <SDL_thread.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "OGLFT.h"
-
 #define M64P_CORE_PROTOTYPES 1
 #include "api/m64p_config.h"
 #include "api/m64p_vidext.h"
@@ -41,18 +42,36 @@ extern "C" {
 
 #define FONT_FILENAME "font.ttf"
 
+// characters in the glyph atlas, the message text is taken as Latin-1
+#define OSD_FIRST_GLYPH  32
+#define OSD_NUM_GLYPHS   (256 - OSD_FIRST_GLYPH)
+#define OSD_ATLAS_WIDTH  1024
+#define OSD_ATLAS_HEIGHT 2048
+#define OSD_MAX_TEXTURE_UNITS 8
+
 typedef void (APIENTRYP PTRGLACTIVETEXTURE)(GLenum texture);
 static PTRGLACTIVETEXTURE pglActiveTexture = NULL;
 
+typedef struct {
+    float advance;
+    float left, top;        // bitmap position relative to the pen, in pixels
+    float width, height;    // bitmap size, in pixels
+    float u0, v0, u1, v1;   // bitmap position in the atlas
+} osd_glyph_t;
+
 // static variables for OSD
 static int l_OsdInitialized = 0;
 
 static LIST_HEAD(l_messageQueue);
-static OGLFT::Monochrome *l_font;
-static float l_fLineHeight = -1.0;
-
-static void animation_none(osd_message_t *);
-static void animation_fade(osd_message_t *);
+static osd_glyph_t l_glyphs[OSD_NUM_GLYPHS];
+static GLuint l_atlasTexture = 0;
+static float l_fAscender = 0.0f;
+static float l_fDescender = 0.0f;
+static float l_fLineHeight = 0.0f;
+static int l_iTextureUnits = 1;
+
+static float animation_none(osd_message_t *);
+static float animation_fade(osd_message_t *);
 static void osd_remove_message(osd_message_t *msg);
 static osd_message_t * osd_message_valid(osd_message_t *testmsg);
 
@@ -60,118 +79,231 @@ static float fCornerScroll[OSD_NUM_CORNERS];
 
 static SDL_mutex *osd_list_lock;
 
-// animation handlers
-static void (*l_animations[OSD_NUM_ANIM_TYPES])(osd_message_t *) = {
+// animation handlers, returning the alpha of the message
+static float (*l_animations[OSD_NUM_ANIM_TYPES])(osd_message_t *) = {
     animation_none, // animation handler for OSD_NONE
     animation_fade  // animation handler for OSD_FADE
 };
 
 // private functions
-// draw message on screen
+// renders the glyphs of the font into a single alpha texture, so that all the
+// messages can be drawn with one texture and one batch of quads
+static int build_glyph_atlas(const char *fontpath, float point_size)
+{
+    FT_Library library;
+    FT_Face face;
+    int i, x = 1, y = 1, rowHeight = 0, atlasHeight;
+
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Could not initialize freetype library.");
+        return 0;
+    }
+    if (fontpath == NULL || FT_New_Face(library, fontpath, 0, &face) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Could not construct face from %s", fontpath);
+        FT_Done_FreeType(library);
+        return 0;
+    }
+    FT_Set_Char_Size(face, (FT_F26Dot6)(point_size * 64), (FT_F26Dot6)(point_size * 64), 100, 100);
+
+    l_fAscender = face->size->metrics.ascender / 64.0f;
+    l_fDescender = face->size->metrics.descender / 64.0f;
+    l_fLineHeight = face->size->metrics.height / 64.0f;
+
+    unsigned char *pixels = (unsigned char *) calloc(OSD_ATLAS_WIDTH, OSD_ATLAS_HEIGHT);
+    if (pixels == NULL)
+    {
+        FT_Done_Face(face);
+        FT_Done_FreeType(library);
+        return 0;
+    }
+
+    memset(l_glyphs, 0, sizeof(l_glyphs));
+    for (i = 0; i < OSD_NUM_GLYPHS; i++)
+    {
+        if (FT_Load_Char(face, OSD_FIRST_GLYPH + i, FT_LOAD_RENDER) != 0)
+            continue;
+
+        FT_GlyphSlot slot = face->glyph;
+        int w = slot->bitmap.width;
+        int h = slot->bitmap.rows;
+
+        l_glyphs[i].advance = slot->advance.x / 64.0f;
+        if (w == 0 || h == 0)
+            continue;
+
+        // one pixel of padding keeps the glyphs from bleeding into each other
+        if (x + w + 1 > OSD_ATLAS_WIDTH)
+        {
+            x = 1;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        if (y + h + 1 > OSD_ATLAS_HEIGHT)
+            break;
+
+        for (int row = 0; row < h; row++)
+            memcpy(pixels + (y + row) * OSD_ATLAS_WIDTH + x, slot->bitmap.buffer + row * slot->bitmap.pitch, w);
+
+        l_glyphs[i].left = (float) slot->bitmap_left;
+        l_glyphs[i].top = (float) slot->bitmap_top;
+        l_glyphs[i].width = (float) w;
+        l_glyphs[i].height = (float) h;
+        l_glyphs[i].u0 = (float) x;
+        l_glyphs[i].v0 = (float) y;
+        l_glyphs[i].u1 = (float) (x + w);
+        l_glyphs[i].v1 = (float) (y + h);
+
+        x += w + 1;
+        if (h > rowHeight)
+            rowHeight = h;
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    // only upload the rows in use, rounded to a power of two for old GL versions
+    for (atlasHeight = 1; atlasHeight < y + rowHeight + 1; atlasHeight *= 2)
+        ;
+    for (i = 0; i < OSD_NUM_GLYPHS; i++)
+    {
+        l_glyphs[i].u0 /= OSD_ATLAS_WIDTH;
+        l_glyphs[i].u1 /= OSD_ATLAS_WIDTH;
+        l_glyphs[i].v0 /= atlasHeight;
+        l_glyphs[i].v1 /= atlasHeight;
+    }
+
+    GLint iBoundTexture;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &iBoundTexture);
+    glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glGenTextures(1, &l_atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, l_atlasTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, OSD_ATLAS_WIDTH, atlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+
+    glPopClientAttrib();
+    glBindTexture(GL_TEXTURE_2D, (GLuint) iBoundTexture);
+    free(pixels);
+
+    return 1;
+}
+
+static float measure_text(const char *text)
+{
+    float width = 0.0f;
+
+    for (const unsigned char *pch = (const unsigned char *) text; *pch != '\0'; pch++)
+    {
+        if (*pch >= OSD_FIRST_GLYPH)
+            width += l_glyphs[*pch - OSD_FIRST_GLYPH].advance;
+    }
+
+    return width;
+}
+
+// add the quads of a message to the current batch
 static void draw_message(osd_message_t *msg, int width, int height)
 {
     float x = 0.,
           y = 0.;
 
-    if(!l_font || !l_font->isValid())
-        return;
-
-    // set color. alpha is hard coded to 1. animation can change this
-    l_font->setForegroundColor(msg->color[R], msg->color[G], msg->color[B], 1.0);
-    l_font->setBackgroundColor(0.0, 0.0, 0.0, 0.0);
+    // get the bounding box if invalid
+    if (msg->sizebox[0] == 0 && msg->sizebox[2] == 0)  // xmin and xmax
+    {
+        msg->sizebox[0] = 0.0f;
+        msg->sizebox[1] = l_fDescender;
+        msg->sizebox[2] = measure_text(msg->text);
+        msg->sizebox[3] = l_fAscender;
+    }
+    float textWidth = msg->sizebox[2] - msg->sizebox[0];
 
-    // set justification based on corner
+    // justify the text based on corner, y is the baseline
     switch(msg->corner)
     {
         case OSD_TOP_LEFT:
-            l_font->setVerticalJustification(OGLFT::Face::TOP);
-            l_font->setHorizontalJustification(OGLFT::Face::LEFT);
+        case OSD_MIDDLE_LEFT:
+        case OSD_BOTTOM_LEFT:
+        default:
             x = 0.;
-            y = (float)height;
             break;
         case OSD_TOP_CENTER:
-            l_font->setVerticalJustification(OGLFT::Face::TOP);
-            l_font->setHorizontalJustification(OGLFT::Face::CENTER);
-            x = ((float)width)/2.0f;
-            y = (float)height;
+        case OSD_MIDDLE_CENTER:
+        case OSD_BOTTOM_CENTER:
+            x = ((float)width - textWidth)/2.0f;
             break;
         case OSD_TOP_RIGHT:
-            l_font->setVerticalJustification(OGLFT::Face::TOP);
-            l_font->setHorizontalJustification(OGLFT::Face::RIGHT);
-            x = (float)width;
-            y = (float)height;
+        case OSD_MIDDLE_RIGHT:
+        case OSD_BOTTOM_RIGHT:
+            x = (float)width - textWidth;
             break;
-        case OSD_MIDDLE_LEFT:
-            l_font->setVerticalJustification(OGLFT::Face::MIDDLE);
-            l_font->setHorizontalJustification(OGLFT::Face::LEFT);
-            x = 0.;
-            y = ((float)height)/2.0f;
+    }
+    switch(msg->corner)
+    {
+        case OSD_TOP_LEFT:
+        case OSD_TOP_CENTER:
+        case OSD_TOP_RIGHT:
+            y = (float)height - l_fAscender;
             break;
+        case OSD_MIDDLE_LEFT:
         case OSD_MIDDLE_CENTER:
-            l_font->setVerticalJustification(OGLFT::Face::MIDDLE);
-            l_font->setHorizontalJustification(OGLFT::Face::CENTER);
-            x = ((float)width)/2.0f;
-            y = ((float)height)/2.0f;
-            break;
         case OSD_MIDDLE_RIGHT:
-            l_font->setVerticalJustification(OGLFT::Face::MIDDLE);
-            l_font->setHorizontalJustification(OGLFT::Face::RIGHT);
-            x = (float)width;
-            y = ((float)height)/2.0f;
-            break;
-        case OSD_BOTTOM_LEFT:
-            l_font->setVerticalJustification(OGLFT::Face::BOTTOM);
-            l_font->setHorizontalJustification(OGLFT::Face::LEFT);
-            x = 0.;
-            y = 0.;
-            break;
-        case OSD_BOTTOM_CENTER:
-            l_font->setVerticalJustification(OGLFT::Face::BOTTOM);
-            l_font->setHorizontalJustification(OGLFT::Face::CENTER);
-            x = ((float)width)/2.0f;
-            y = 0.;
-            break;
-        case OSD_BOTTOM_RIGHT:
-            l_font->setVerticalJustification(OGLFT::Face::BOTTOM);
-            l_font->setHorizontalJustification(OGLFT::Face::RIGHT);
-            x = (float)width;
-            y = 0.;
+            y = ((float)height - l_fAscender - l_fDescender)/2.0f;
             break;
         default:
-            l_font->setVerticalJustification(OGLFT::Face::BOTTOM);
-            l_font->setHorizontalJustification(OGLFT::Face::LEFT);
-            x = 0.;
-            y = 0.;
+            y = -l_fDescender;
             break;
     }
 
     // apply animation for current message state
-    (*l_animations[msg->animation[msg->state]])(msg);
+    float alpha = (*l_animations[msg->animation[msg->state]])(msg);
+    glColor4f(msg->color[R], msg->color[G], msg->color[B], alpha);
 
     // xoffset moves message left
     x -= msg->xoffset;
     // yoffset moves message up
     y += msg->yoffset;
 
-    // get the bounding box if invalid
-    if (msg->sizebox[0] == 0 && msg->sizebox[2] == 0)  // xmin and xmax
+    // the atlas is sampled without filtering, keep the glyphs on whole pixels
+    x = floorf(x + 0.5f);
+    y = floorf(y + 0.5f);
+
+    for (const unsigned char *pch = (const unsigned char *) msg->text; *pch != '\0'; pch++)
     {
-        OGLFT::BBox bbox = l_font->measure_nominal(msg->text);
-        msg->sizebox[0] = bbox.x_min_;
-        msg->sizebox[1] = bbox.y_min_;
-        msg->sizebox[2] = bbox.x_max_;
-        msg->sizebox[3] = bbox.y_max_;
-    }
+        if (*pch < OSD_FIRST_GLYPH)
+            continue;
 
-    // draw the text line
-    l_font->draw(x, y, msg->text, msg->sizebox);
+        const osd_glyph_t *glyph = &l_glyphs[*pch - OSD_FIRST_GLYPH];
+        if (glyph->width > 0.0f)
+        {
+            float x0 = x + glyph->left;
+            float x1 = x0 + glyph->width;
+            float y1 = y + glyph->top;
+            float y0 = y1 - glyph->height;
+
+            glTexCoord2f(glyph->u0, glyph->v1); glVertex2f(x0, y0);
+            glTexCoord2f(glyph->u1, glyph->v1); glVertex2f(x1, y0);
+            glTexCoord2f(glyph->u1, glyph->v0); glVertex2f(x1, y1);
+            glTexCoord2f(glyph->u0, glyph->v0); glVertex2f(x0, y1);
+        }
+        x += glyph->advance;
+    }
 }
 
 // null animation handler
-static void animation_none(osd_message_t *msg) { }
+static float animation_none(osd_message_t *msg)
+{
+    return 1.;
+}
 
 // fade in/out animation handler
-static void animation_fade(osd_message_t *msg)
+static float animation_fade(osd_message_t *msg)
 {
     float alpha = 1.;
     float elapsed_frames;
@@ -191,13 +323,13 @@ static void animation_fade(osd_message_t *msg)
     if(total_frames != 0.)
         alpha = elapsed_frames / total_frames;
 
-    l_font->setForegroundColor(msg->color[R], msg->color[G], msg->color[B], alpha);
+    return alpha;
 }
 
 // sets message Y offset depending on where they are in the message queue
 static float get_message_offset(osd_message_t *msg, float fLinePos)
 {
-    float offset = (float) (l_font->height() * fLinePos);
+    float offset = l_fLineHeight * fLinePos;
 
     switch(msg->corner)
     {
@@ -224,22 +356,6 @@ void osd_init(int width, int height)
         return;
     }
 
-    if (!OGLFT::Init_FT())
-    {
-        DebugMessage(M64MSG_ERROR, "Could not initialize freetype library.");
-        return;
-    }
-
-    fontpath = ConfigGetSharedDataFilepath(FONT_FILENAME);
-
-    l_font = new OGLFT::Monochrome(fontpath, (float) height / 35.0f);  // make font size proportional to screen height
-
-    if (!l_font || !l_font->isValid())
-    {
-        DebugMessage(M64MSG_ERROR, "Could not construct face from %s", fontpath);
-        return;
-    }
-
 #if SDL_VERSION_ATLEAST(2,0,0)
     int gl_context;
     VidExt_GL_GetAttribute(M64P_GL_CONTEXT_PROFILE_MASK, &gl_context);
@@ -254,17 +370,21 @@ void osd_init(int width, int height)
     for (int i = 0; i < OSD_NUM_CORNERS; i++)
         fCornerScroll[i] = 0.0;
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-#if defined(GL_RASTER_POSITION_UNCLIPPED_IBM)
-    glEnable(GL_RASTER_POSITION_UNCLIPPED_IBM);
-#endif
-
     pglActiveTexture = (PTRGLACTIVETEXTURE) VidExt_GL_GetProcAddress("glActiveTexture");
     if (pglActiveTexture == NULL)
     {
         DebugMessage(M64MSG_WARNING, "OpenGL function glActiveTexture() not supported.  OSD deactivated.");
         return;
     }
+    glGetIntegerv(GL_MAX_TEXTURE_UNITS_ARB, &l_iTextureUnits);
+    if (l_iTextureUnits > OSD_MAX_TEXTURE_UNITS)
+        l_iTextureUnits = OSD_MAX_TEXTURE_UNITS;
+
+    fontpath = ConfigGetSharedDataFilepath(FONT_FILENAME);
+
+    // make font size proportional to screen height
+    if (!build_glyph_atlas(fontpath, (float) height / 35.0f))
+        return;
 
     // set initialized flag
     l_OsdInitialized = 1;
@@ -275,11 +395,11 @@ void osd_exit(void)
 {
     osd_message_t *msg, *safe;
 
-    // delete font renderer
-    if (l_font)
+    // delete the glyph atlas
+    if (l_atlasTexture != 0)
     {
-        delete l_font;
-        l_font = NULL;
+        glDeleteTextures(1, &l_atlasTexture);
+        l_atlasTexture = 0;
     }
 
     // delete message queue
@@ -291,9 +411,6 @@ void osd_exit(void)
     }
     SDL_UnlockMutex(osd_list_lock);
 
-    // shut down the Freetype library
-    OGLFT::Uninit_FT();
-
     SDL_DestroyMutex(osd_list_lock);
 
     // reset initialized flag
@@ -315,29 +432,27 @@ void osd_render()
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
 
-    // save all the attributes
-    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    // save only the state changed below, the fragment program enable is
+    // saved by hand for drivers leaving it out of the enable bit
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
     bool bFragmentProg = glIsEnabled(GL_FRAGMENT_PROGRAM_ARB) != 0;
-    bool bColorArray = glIsEnabled(GL_COLOR_ARRAY) != 0;
-    bool bTexCoordArray = glIsEnabled(GL_TEXTURE_COORD_ARRAY) != 0;
-    bool bSecColorArray = glIsEnabled(GL_SECONDARY_COLOR_ARRAY) != 0;
-
-    // deactivate all the texturing units
-    GLint  iActiveTex;
-    bool bTexture2D[8];
-    glGetIntegerv(GL_ACTIVE_TEXTURE_ARB, &iActiveTex);
-    for (i = 0; i < 8; i++)
+
+    // texture the quads with the atlas on the first unit only
+    for (i = l_iTextureUnits - 1; i >= 0; i--)
     {
         pglActiveTexture(GL_TEXTURE0_ARB + i);
-        bTexture2D[i] = glIsEnabled(GL_TEXTURE_2D) != 0;
-        glDisable(GL_TEXTURE_2D);
+        if (i > 0)
+            glDisable(GL_TEXTURE_2D);
     }
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, l_atlasTexture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
     // save the matrices and set up new ones
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
     glLoadIdentity();
-    gluOrtho2D(viewport[0],viewport[2],viewport[1],viewport[3]);
+    glOrtho(viewport[0], viewport[2], viewport[1], viewport[3], -1.0, 1.0);
 
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
@@ -353,26 +468,20 @@ void osd_render()
     glDisable(GL_STENCIL_TEST);
     glDisable(GL_FRAGMENT_PROGRAM_ARB);
     glDisable(GL_COLOR_MATERIAL);
+#if defined(GL_COLOR_SUM)
+    glDisable(GL_COLOR_SUM);
+#endif
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glDisableClientState(GL_COLOR_ARRAY);
-    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-    glDisableClientState(GL_SECONDARY_COLOR_ARRAY);
-    glShadeModel(GL_FLAT);
-
-    // get line height if invalid
-    if (l_fLineHeight < 0.0)
-    {
-        OGLFT::BBox bbox = l_font->measure("01abjZpqRGB");
-        l_fLineHeight = (bbox.y_max_ - bbox.y_min_) / 30.0f;
-    }
-
-    // keeps track of next message position for each corner
+    // keeps track of next message position for each corner, in lines
     float fCornerPos[OSD_NUM_CORNERS];
     for (i = 0; i < OSD_NUM_CORNERS; i++)
-        fCornerPos[i] = 0.5f * l_fLineHeight;
+        fCornerPos[i] = 0.5f;
+
+    // all the messages go in a single batch
+    glBegin(GL_QUADS);
 
     SDL_LockMutex(osd_list_lock);
     list_for_each_entry_safe_t(msg, safe, &l_messageQueue, osd_message_t, list) {
@@ -403,16 +512,18 @@ void osd_render()
         if (msg->corner >= OSD_MIDDLE_LEFT && msg->corner <= OSD_MIDDLE_RIGHT)  // don't scroll the middle messages
             fStartOffset = fCornerPos[msg->corner];
         else
-            fStartOffset = fCornerPos[msg->corner] + (fCornerScroll[msg->corner] * l_fLineHeight);
+            fStartOffset = fCornerPos[msg->corner] + fCornerScroll[msg->corner];
         msg->yoffset += get_message_offset(msg, fStartOffset);
 
         draw_message(msg, viewport[2], viewport[3]);
 
         msg->yoffset -= get_message_offset(msg, fStartOffset);
-        fCornerPos[msg->corner] += l_fLineHeight;
+        fCornerPos[msg->corner] += 1.0f;
     }
     SDL_UnlockMutex(osd_list_lock);
 
+    glEnd();
+
     // do the scrolling
     for (int i = 0; i < OSD_NUM_CORNERS; i++)
     {
@@ -428,26 +539,9 @@ void osd_render()
     glPopMatrix();
 
     // restore the attributes
-    for (int i = 0; i < 8; i++)
-    {
-        pglActiveTexture(GL_TEXTURE0_ARB + i);
-        if (bTexture2D[i])
-            glEnable(GL_TEXTURE_2D);
-        else
-            glDisable(GL_TEXTURE_2D);
-    }
-    pglActiveTexture(iActiveTex);
     glPopAttrib();
     if (bFragmentProg)
         glEnable(GL_FRAGMENT_PROGRAM_ARB);
-    if (bColorArray)
-        glEnableClientState(GL_COLOR_ARRAY);
-    if (bTexCoordArray)
-        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-    if (bSecColorArray)
-        glEnableClientState(GL_SECONDARY_COLOR_ARRAY);
-
-    glFinish();
 }
 
 // creates a new osd_message_t, adds it to the message queue and returns it in case
@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <zlib.h>
 
 #include "osd.h"
 
@@ -36,6 +37,7 @@
 #include "main/main.h"
 #include "main/rom.h"
 #include "main/util.h"
+#include "main/workqueue.h"
 #include "osal/files.h"
 #include "osal/preproc.h"
 #include "plugin/plugin.h"
@@ -58,7 +60,10 @@ static void user_write_data(png_structp png_write, png_bytep data, png_size_t le
 {
     FILE *fPtr = (FILE *) png_get_io_ptr(png_write);
     if (fwrite(data, 1, length, fPtr) != length)
+    {
         DebugMessage(M64MSG_ERROR, "Failed to write %zi bytes to screenshot file.", length);
+        png_error(png_write, "write failed");
+    }
 }
 
 static void user_flush_data(png_structp png_write)
@@ -89,32 +94,45 @@ static int SaveRGBBufferToFile(const char *filename, const unsigned char *buf, i
         DebugMessage(M64MSG_ERROR, "Error creating PNG info struct.");
         return 2;
     }
-    // Set the jumpback
-    if (setjmp(png_jmpbuf(png_write)))
+    // allocate row pointers, the image is stored bottom-up
+    png_byte **row_pointers = (png_byte **) malloc(height * sizeof(png_bytep));
+    if (row_pointers == NULL)
     {
         png_destroy_write_struct(&png_write, &png_info);
-        DebugMessage(M64MSG_ERROR, "Error calling setjmp()");
-        return 3;
+        DebugMessage(M64MSG_ERROR, "Error allocating PNG row pointers.");
+        return 2;
+    }
+    for (i = 0; i < height; i++)
+    {
+        row_pointers[i] = (png_byte *) (buf + (height - 1 - i) * pitch);
     }
     // open the file to write
     FILE *savefile = fopen(filename, "wb");
     if (savefile == NULL)
     {
+        free(row_pointers);
+        png_destroy_write_struct(&png_write, &png_info);
         DebugMessage(M64MSG_ERROR, "Error opening '%s' to save screenshot.", filename);
         return 4;
     }
+    // Set the jumpback
+    if (setjmp(png_jmpbuf(png_write)))
+    {
+        png_destroy_write_struct(&png_write, &png_info);
+        free(row_pointers);
+        fclose(savefile);
+        DebugMessage(M64MSG_ERROR, "Error writing PNG file '%s'.", filename);
+        return 3;
+    }
     // set function pointers in the PNG library, for write callbacks
     png_set_write_fn(png_write, (png_voidp) savefile, user_write_data, user_flush_data);
     // set the info
     png_set_IHDR(png_write, png_info, width, height, 8, PNG_COLOR_TYPE_RGB,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-    // allocate row pointers and scale each row to 24-bit color
-    png_byte **row_pointers;
-    row_pointers = (png_byte **) malloc(height * sizeof(png_bytep));
-    for (i = 0; i < height; i++)
-    {
-        row_pointers[i] = (png_byte *) (buf + (height - 1 - i) * pitch);
-    }
+    // a single filter and the fastest zlib level spend a fraction of the
+    // default time for files only slightly larger
+    png_set_filter(png_write, 0, PNG_FILTER_SUB);
+    png_set_compression_level(png_write, Z_BEST_SPEED);
     // set the row pointers
     png_set_rows(png_write, png_info, row_pointers);
     // write the picture to disk
@@ -128,6 +146,40 @@ static int SaveRGBBufferToFile(const char *filename, const unsigned char *buf, i
     return 0;
 }
 
+struct screenshot_work {
+    char *filename;
+    unsigned char *frame;
+    int width;
+    int height;
+    int frame_number;
+    int result;
+    struct work_struct work;
+};
+
+static void screenshot_work(struct work_struct *work)
+{
+    struct screenshot_work *shot = container_of(work, struct screenshot_work, work);
+
+    // write the image to a PNG
+    shot->result = SaveRGBBufferToFile(shot->filename, shot->frame, shot->width, shot->height, shot->width * 3);
+}
+
+static void screenshot_work_done(struct work_struct *work)
+{
+    struct screenshot_work *shot = container_of(work, struct screenshot_work, work);
+
+    // print message -- this allows developers to capture frames and use them in the regression test
+    if (shot->result == 0)
+        main_message(M64MSG_INFO, OSD_BOTTOM_LEFT, "Captured screenshot for frame %i.", shot->frame_number);
+    else
+        main_message(M64MSG_ERROR, OSD_BOTTOM_LEFT, "Failed to save screenshot for frame %i.", shot->frame_number);
+
+    // free the memory
+    free(shot->frame);
+    free(shot->filename);
+    free(shot);
+}
+
 static int CurrentShotIndex;
 
 static char *GetNextScreenshotPath(void)
@@ -202,6 +254,13 @@ void TakeScreenshot(int iFrameNumber)
     if (filename == NULL)
         return;
 
+    struct screenshot_work *shot = malloc(sizeof(*shot));
+    if (shot == NULL)
+    {
+        free(filename);
+        return;
+    }
+
     // get the width and height
     int width = 640;
     int height = 480;
@@ -211,6 +270,7 @@ void TakeScreenshot(int iFrameNumber)
     unsigned char *pucFrame = (unsigned char *) malloc(width * height * 3);
     if (pucFrame == NULL)
     {
+        free(shot);
         free(filename);
         return;
     }
@@ -218,12 +278,14 @@ void TakeScreenshot(int iFrameNumber)
     // grab the back image from OpenGL by calling the video plugin
     gfx.readScreen(pucFrame, &width, &height, 0);
 
-    // write the image to a PNG
-    SaveRGBBufferToFile(filename, pucFrame, width, height, width * 3);
-    // free the memory
-    free(pucFrame);
-    free(filename);
-    // print message -- this allows developers to capture frames and use them in the regression test
-    main_message(M64MSG_INFO, OSD_BOTTOM_LEFT, "Captured screenshot for frame %i.", iFrameNumber);
+    // PNG encoding is slow, leave it to the workqueue
+    shot->filename = filename;
+    shot->frame = pucFrame;
+    shot->width = width;
+    shot->height = height;
+    shot->frame_number = iFrameNumber;
+    shot->result = 0;
+    init_work_prio(&shot->work, screenshot_work, screenshot_work_done, WORK_PRIORITY_ENCODE);
+    queue_work(&shot->work);
 }
 
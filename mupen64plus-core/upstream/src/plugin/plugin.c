@@ -39,7 +39,10 @@
 #include "dummy_rsp.h"
 #include "dummy_video.h"
 #include "main/main.h"
+#include "main/profile.h"
 #include "main/rom.h"
+#include "main/rsp_async.h"
+#include "main/runahead.h"
 #include "main/version.h"
 #include "osal/dynamiclib.h"
 #include "plugin.h"
@@ -71,7 +74,9 @@ static const gfx_plugin_functions dummy_gfx = {
     dummyvideo_ResizeVideoOutput,
     dummyvideo_FBRead,
     dummyvideo_FBWrite,
-    dummyvideo_FBGetFrameBufferInfo
+    dummyvideo_FBGetFrameBufferInfo,
+    NULL,
+    NULL
 };
 
 static const audio_plugin_functions dummy_audio = {
@@ -88,7 +93,9 @@ static const audio_plugin_functions dummy_audio = {
     dummyaudio_VolumeGetLevel,
     dummyaudio_VolumeSetLevel,
     dummyaudio_VolumeMute,
-    dummyaudio_VolumeGetString
+    dummyaudio_VolumeGetString,
+    NULL,
+    NULL
 };
 
 static const input_plugin_functions dummy_input = {
@@ -101,14 +108,16 @@ static const input_plugin_functions dummy_input = {
     dummyinput_RomOpen,
     dummyinput_SDL_KeyDown,
     dummyinput_SDL_KeyUp,
-    dummyinput_RenderCallback
+    dummyinput_RenderCallback,
+    NULL
 };
 
 static const rsp_plugin_functions dummy_rsp = {
     dummyrsp_PluginGetVersion,
     dummyrsp_DoRspCycles,
     dummyrsp_InitiateRSP,
-    dummyrsp_RomClosed
+    dummyrsp_RomClosed,
+    NULL
 };
 
 static GFX_INFO gfx_info;
@@ -128,6 +137,42 @@ static void EmptyFunc(void)
 {
 }
 
+/* given to the RSP plugin instead of the video plugin functions,
+ * so that it follows later changes to gfx */
+static void rsp_process_dlist(void)
+{
+    if (!runahead_video_hidden())
+    {
+        timed_section_start(TIMED_SECTION_GFX_DLIST);
+        gfx.processDList();
+        timed_section_end(TIMED_SECTION_GFX_DLIST);
+    }
+}
+
+static void rsp_process_rdp_list(void)
+{
+    if (!runahead_video_hidden())
+    {
+        timed_section_start(TIMED_SECTION_GFX_RDP_LIST);
+        gfx.processRDPList();
+        timed_section_end(TIMED_SECTION_GFX_RDP_LIST);
+    }
+}
+
+static void rsp_process_alist(void)
+{
+    /* asynchronous audio tasks run off the emulation thread */
+    if (rsp_async_enabled())
+    {
+        audio.processAList();
+        return;
+    }
+
+    timed_section_start(TIMED_SECTION_AUDIO_ALIST);
+    audio.processAList();
+    timed_section_end(TIMED_SECTION_AUDIO_ALIST);
+}
+
 // Handy macro to avoid code bloat when loading symbols
 #define GET_FUNC(type, field, name) \
     ((*(void**)(&(field)) = osal_dynlib_getproc(plugin_handle, name)) != NULL)
@@ -193,6 +238,8 @@ static m64p_error plugin_connect_gfx(m64p_dynlib_handle plugin_handle)
 
         /* set function pointers for optional functions */
         *(void**)&gfx.resizeVideoOutput = osal_dynlib_getproc(plugin_handle, "ResizeVideoOutput");
+        *(void**)&gfx.setRenderSkip = osal_dynlib_getproc(plugin_handle, "SetRenderSkip");
+        *(void**)&gfx.trimMemory = osal_dynlib_getproc(plugin_handle, "TrimMemory");
 
         /* check the version info */
         (*gfx.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
@@ -323,6 +370,10 @@ static m64p_error plugin_connect_audio(m64p_dynlib_handle plugin_handle)
             return M64ERR_INPUT_INVALID;
         }
 
+        /* optional extensions */
+        *(void**)&audio.aiPushSamples = osal_dynlib_getproc(plugin_handle, "AiPushSamples");
+        *(void**)&audio.trimMemory = osal_dynlib_getproc(plugin_handle, "TrimMemory");
+
         /* check the version info */
         (*audio.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
         if (PluginType != M64PLUGIN_AUDIO || (APIVersion & 0xffff0000) != (AUDIO_API_VERSION & 0xffff0000))
@@ -394,6 +445,9 @@ static m64p_error plugin_connect_input(m64p_dynlib_handle plugin_handle)
             return M64ERR_INPUT_INVALID;
         }
 
+        /* set function pointers for optional functions */
+        *(void**)&input.trimMemory = osal_dynlib_getproc(plugin_handle, "TrimMemory");
+
         /* check the version info */
         (*input.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
         if (PluginType != M64PLUGIN_INPUT || (APIVersion & 0xffff0000) != (INPUT_API_VERSION & 0xffff0000))
@@ -469,6 +523,9 @@ static m64p_error plugin_connect_rsp(m64p_dynlib_handle plugin_handle)
             return M64ERR_INPUT_INVALID;
         }
 
+        /* set function pointers for optional functions */
+        *(void**)&rsp.trimMemory = osal_dynlib_getproc(plugin_handle, "TrimMemory");
+
         /* check the version info */
         (*rsp.getVersion)(&PluginType, &PluginVersion, &APIVersion, NULL, NULL);
         if (PluginType != M64PLUGIN_RSP || (APIVersion & 0xffff0000) != (RSP_API_VERSION & 0xffff0000))
@@ -511,9 +568,9 @@ static m64p_error plugin_start_rsp(void)
     rsp_info.DPC_PIPEBUSY_REG = &g_dev.dp.dpc_regs[DPC_PIPEBUSY_REG];
     rsp_info.DPC_TMEM_REG = &g_dev.dp.dpc_regs[DPC_TMEM_REG];
     rsp_info.CheckInterrupts = EmptyFunc;
-    rsp_info.ProcessDlistList = gfx.processDList;
-    rsp_info.ProcessAlistList = audio.processAList;
-    rsp_info.ProcessRdpList = gfx.processRDPList;
+    rsp_info.ProcessDlistList = rsp_process_dlist;
+    rsp_info.ProcessAlistList = rsp_process_alist;
+    rsp_info.ProcessRdpList = rsp_process_rdp_list;
     rsp_info.ShowCFB = gfx.showCFB;
 
     /* call the RSP plugin  */
@@ -567,6 +624,27 @@ m64p_error plugin_start(m64p_plugin_type type)
     return M64ERR_INTERNAL;
 }
 
+static unsigned int trim_plugin_memory(ptr_TrimMemory trimMemory, const char *name, int level)
+{
+    unsigned int released;
+
+    if (trimMemory == NULL)
+        return 0;
+
+    released = trimMemory(level);
+    if (released > 0)
+        DebugMessage(M64MSG_INFO, "%s plugin released %u KB.", name, released / 1024);
+    return released;
+}
+
+unsigned int plugin_trim_memory(int level)
+{
+    return trim_plugin_memory(gfx.trimMemory, "Video", level)
+         + trim_plugin_memory(audio.trimMemory, "Audio", level)
+         + trim_plugin_memory(input.trimMemory, "Input", level)
+         + trim_plugin_memory(rsp.trimMemory, "RSP", level);
+}
+
 m64p_error plugin_check(void)
 {
     if (!l_GfxAttached)
@@ -31,6 +31,9 @@ extern m64p_error plugin_connect(m64p_plugin_type, m64p_dynlib_handle plugin_han
 extern m64p_error plugin_start(m64p_plugin_type);
 extern m64p_error plugin_check(void);
 
+/* calls TrimMemory() of the plugins which have it, returns the total number of bytes released */
+extern unsigned int plugin_trim_memory(int level);
+
 enum { NUM_CONTROLLER = 4 };
 extern CONTROL Controls[NUM_CONTROLLER];
 
@@ -63,6 +66,12 @@ typedef struct _gfx_plugin_functions
 	ptr_FBRead          fBRead;
 	ptr_FBWrite         fBWrite;
 	ptr_FBGetFrameBufferInfo fBGetFrameBufferInfo;
+
+	/* video plugin spec extension, NULL if the plugin doesn't provide it */
+	ptr_SetRenderSkip   setRenderSkip;
+
+	/* common plugin spec extension, NULL if the plugin doesn't provide it */
+	ptr_TrimMemory      trimMemory;
 } gfx_plugin_functions;
 
 extern gfx_plugin_functions gfx;
@@ -84,6 +93,10 @@ typedef struct _audio_plugin_functions
 	ptr_VolumeSetLevel    volumeSetLevel;
 	ptr_VolumeMute        volumeMute;
 	ptr_VolumeGetString   volumeGetString;
+
+	/* audio and common plugin spec extensions, NULL if the plugin doesn't provide them */
+	ptr_AiPushSamples     aiPushSamples;
+	ptr_TrimMemory        trimMemory;
 } audio_plugin_functions;
 
 extern audio_plugin_functions audio;
@@ -101,6 +114,9 @@ typedef struct _input_plugin_functions
 	ptr_SDL_KeyDown         keyDown;
 	ptr_SDL_KeyUp           keyUp;
 	ptr_RenderCallback      renderCallback;
+
+	/* common plugin spec extension, NULL if the plugin doesn't provide it */
+	ptr_TrimMemory          trimMemory;
 } input_plugin_functions;
 
 extern input_plugin_functions input;
@@ -112,6 +128,9 @@ typedef struct _rsp_plugin_functions
 	ptr_DoRspCycles         doRspCycles;
 	ptr_InitiateRSP         initiateRSP;
 	ptr_RomClosed           romClosed;
+
+	/* common plugin spec extension, NULL if the plugin doesn't provide it */
+	ptr_TrimMemory          trimMemory;
 } rsp_plugin_functions;
 
 extern rsp_plugin_functions rsp;
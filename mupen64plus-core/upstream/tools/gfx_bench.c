@@ -0,0 +1,1345 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - gfx_bench.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Replays a video plugin trace recorded by the core (see GfxTraceFile and
+ * src/main/gfx_trace.h) through any video plugin, without a window, and
+ * reports the time spent in the plugin and the GL calls it made per frame.
+ *
+ * The runner stands in for the core: it exports the config and video
+ * extension API the plugin looks up, keeping the config in memory and
+ * rendering to an EGL pbuffer. Build with "make gfx_bench" in
+ * projects/unix. */
+
+#define _GNU_SOURCE
+#define M64P_CORE_PROTOTYPES 1
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include "api/m64p_common.h"
+#include "api/m64p_config.h"
+#include "api/m64p_frontend.h"
+#include "api/m64p_plugin.h"
+#include "api/m64p_types.h"
+#include "api/m64p_vidext.h"
+#include "main/version.h"
+
+#define GFX_TRACE_FORMAT_ONLY
+#include "main/gfx_trace.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#ifndef EGL_CONTEXT_MAJOR_VERSION
+#define EGL_CONTEXT_MAJOR_VERSION 0x3098
+#define EGL_CONTEXT_MINOR_VERSION 0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK 0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT 0x00000001
+#define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT 0x00000002
+#endif
+#ifndef EGL_OPENGL_ES3_BIT
+#define EGL_OPENGL_ES3_BIT 0x00000040
+#endif
+
+static int l_verbose = 0;
+static const char* l_data_dir = ".";
+
+
+/* Config: sections and parameters kept in memory, never saved */
+
+struct parameter
+{
+    struct parameter* next;
+    char name[64];
+    m64p_type type;
+    int value_int;
+    float value_float;
+    char value_string[256];
+    char help[256];
+};
+
+struct section
+{
+    struct section* next;
+    char name[64];
+    struct parameter* parameters;
+};
+
+/* values given on the command line, applied as the parameters are created */
+struct override
+{
+    struct override* next;
+    char section[64];
+    char name[64];
+    char value[256];
+};
+
+static struct section* l_sections = NULL;
+static struct override* l_overrides = NULL;
+
+static struct parameter* find_parameter(struct section* section, const char* name)
+{
+    struct parameter* parameter;
+
+    for (parameter = section->parameters; parameter != NULL; parameter = parameter->next)
+    {
+        if (strcmp(parameter->name, name) == 0)
+            return parameter;
+    }
+
+    return NULL;
+}
+
+static void set_from_string(struct parameter* parameter, const char* value)
+{
+    switch (parameter->type)
+    {
+    case M64TYPE_INT:
+        parameter->value_int = atoi(value);
+        break;
+    case M64TYPE_FLOAT:
+        parameter->value_float = (float)atof(value);
+        break;
+    case M64TYPE_BOOL:
+        parameter->value_int = (strcmp(value, "True") == 0 || strcmp(value, "true") == 0 || atoi(value) != 0);
+        break;
+    case M64TYPE_STRING:
+        snprintf(parameter->value_string, sizeof(parameter->value_string), "%s", value);
+        break;
+    }
+}
+
+static struct parameter* add_parameter(struct section* section, const char* name, m64p_type type)
+{
+    struct parameter* parameter = find_parameter(section, name);
+
+    if (parameter == NULL)
+    {
+        parameter = calloc(1, sizeof(*parameter));
+        if (parameter == NULL)
+            return NULL;
+        snprintf(parameter->name, sizeof(parameter->name), "%s", name);
+        parameter->next = section->parameters;
+        section->parameters = parameter;
+    }
+
+    parameter->type = type;
+    return parameter;
+}
+
+static m64p_error set_default(m64p_handle handle, const char* name, m64p_type type,
+                              int value_int, float value_float, const char* value_string, const char* help)
+{
+    struct section* section = (struct section*)handle;
+    struct parameter* parameter;
+    struct override* override;
+
+    if (section == NULL || name == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    /* existing parameters keep their value */
+    if (find_parameter(section, name) != NULL)
+        return M64ERR_SUCCESS;
+
+    parameter = add_parameter(section, name, type);
+    if (parameter == NULL)
+        return M64ERR_NO_MEMORY;
+
+    parameter->value_int = value_int;
+    parameter->value_float = value_float;
+    snprintf(parameter->value_string, sizeof(parameter->value_string), "%s", value_string != NULL ? value_string : "");
+    snprintf(parameter->help, sizeof(parameter->help), "%s", help != NULL ? help : "");
+
+    for (override = l_overrides; override != NULL; override = override->next)
+    {
+        if (strcmp(override->section, section->name) == 0 && strcmp(override->name, name) == 0)
+            set_from_string(parameter, override->value);
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigListSections(void* context, void (*SectionListCallback)(void*, const char*))
+{
+    struct section* section;
+
+    for (section = l_sections; section != NULL; section = section->next)
+        SectionListCallback(context, section->name);
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigOpenSection(const char* SectionName, m64p_handle* ConfigSectionHandle)
+{
+    struct section* section;
+
+    if (SectionName == NULL || ConfigSectionHandle == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    for (section = l_sections; section != NULL; section = section->next)
+    {
+        if (strcmp(section->name, SectionName) == 0)
+            break;
+    }
+
+    if (section == NULL)
+    {
+        section = calloc(1, sizeof(*section));
+        if (section == NULL)
+            return M64ERR_NO_MEMORY;
+        snprintf(section->name, sizeof(section->name), "%s", SectionName);
+        section->next = l_sections;
+        l_sections = section;
+    }
+
+    *ConfigSectionHandle = section;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigListParameters(m64p_handle ConfigSectionHandle, void* context,
+                                            void (*ParameterListCallback)(void*, const char*, m64p_type))
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter;
+
+    if (section == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    for (parameter = section->parameters; parameter != NULL; parameter = parameter->next)
+        ParameterListCallback(context, parameter->name, parameter->type);
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigSaveFile(void)
+{
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigSaveSection(const char* SectionName)
+{
+    return M64ERR_SUCCESS;
+}
+
+EXPORT int CALL ConfigHasUnsavedChanges(const char* SectionName)
+{
+    return 0;
+}
+
+EXPORT m64p_error CALL ConfigDeleteSection(const char* SectionName)
+{
+    struct section** link;
+
+    for (link = &l_sections; *link != NULL; link = &(*link)->next)
+    {
+        if (strcmp((*link)->name, SectionName) == 0)
+        {
+            struct section* section = *link;
+            *link = section->next;
+            while (section->parameters != NULL)
+            {
+                struct parameter* parameter = section->parameters;
+                section->parameters = parameter->next;
+                free(parameter);
+            }
+            free(section);
+            return M64ERR_SUCCESS;
+        }
+    }
+
+    return M64ERR_INPUT_NOT_FOUND;
+}
+
+EXPORT m64p_error CALL ConfigRevertChanges(const char* SectionName)
+{
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigSetParameter(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                          m64p_type ParamType, const void* ParamValue)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter;
+
+    if (section == NULL || ParamName == NULL || ParamValue == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    parameter = add_parameter(section, ParamName, ParamType);
+    if (parameter == NULL)
+        return M64ERR_NO_MEMORY;
+
+    switch (ParamType)
+    {
+    case M64TYPE_INT:
+    case M64TYPE_BOOL:
+        parameter->value_int = *(const int*)ParamValue;
+        break;
+    case M64TYPE_FLOAT:
+        parameter->value_float = *(const float*)ParamValue;
+        break;
+    case M64TYPE_STRING:
+        snprintf(parameter->value_string, sizeof(parameter->value_string), "%s", (const char*)ParamValue);
+        break;
+    default:
+        return M64ERR_INPUT_INVALID;
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigSetParameterHelp(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                              const char* ParamHelp)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter;
+
+    if (section == NULL || ParamName == NULL || ParamHelp == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    parameter = find_parameter(section, ParamName);
+    if (parameter == NULL)
+        return M64ERR_INPUT_NOT_FOUND;
+
+    snprintf(parameter->help, sizeof(parameter->help), "%s", ParamHelp);
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigGetParameter(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                          m64p_type ParamType, void* ParamValue, int MaxSize)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter;
+
+    if (section == NULL || ParamName == NULL || ParamValue == NULL || MaxSize < 1)
+        return M64ERR_INPUT_ASSERT;
+
+    parameter = find_parameter(section, ParamName);
+    if (parameter == NULL)
+        return M64ERR_INPUT_NOT_FOUND;
+
+    switch (ParamType)
+    {
+    case M64TYPE_INT:
+    case M64TYPE_BOOL:
+        if (MaxSize < (int)sizeof(int))
+            return M64ERR_INPUT_INVALID;
+        *(int*)ParamValue = ConfigGetParamInt(section, ParamName);
+        break;
+    case M64TYPE_FLOAT:
+        if (MaxSize < (int)sizeof(float))
+            return M64ERR_INPUT_INVALID;
+        *(float*)ParamValue = ConfigGetParamFloat(section, ParamName);
+        break;
+    case M64TYPE_STRING:
+        snprintf((char*)ParamValue, MaxSize, "%s", ConfigGetParamString(section, ParamName));
+        break;
+    default:
+        return M64ERR_INPUT_INVALID;
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL ConfigGetParameterType(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                              m64p_type* ParamType)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter;
+
+    if (section == NULL || ParamName == NULL || ParamType == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    parameter = find_parameter(section, ParamName);
+    if (parameter == NULL)
+        return M64ERR_INPUT_NOT_FOUND;
+
+    *ParamType = parameter->type;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT const char* CALL ConfigGetParameterHelp(m64p_handle ConfigSectionHandle, const char* ParamName)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter = (section != NULL && ParamName != NULL) ? find_parameter(section, ParamName) : NULL;
+
+    return parameter != NULL ? parameter->help : NULL;
+}
+
+EXPORT m64p_error CALL ConfigSetDefaultInt(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                           int ParamValue, const char* ParamHelp)
+{
+    return set_default(ConfigSectionHandle, ParamName, M64TYPE_INT, ParamValue, 0.0f, NULL, ParamHelp);
+}
+
+EXPORT m64p_error CALL ConfigSetDefaultFloat(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                             float ParamValue, const char* ParamHelp)
+{
+    return set_default(ConfigSectionHandle, ParamName, M64TYPE_FLOAT, 0, ParamValue, NULL, ParamHelp);
+}
+
+EXPORT m64p_error CALL ConfigSetDefaultBool(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                            int ParamValue, const char* ParamHelp)
+{
+    return set_default(ConfigSectionHandle, ParamName, M64TYPE_BOOL, ParamValue != 0, 0.0f, NULL, ParamHelp);
+}
+
+EXPORT m64p_error CALL ConfigSetDefaultString(m64p_handle ConfigSectionHandle, const char* ParamName,
+                                              const char* ParamValue, const char* ParamHelp)
+{
+    return set_default(ConfigSectionHandle, ParamName, M64TYPE_STRING, 0, 0.0f, ParamValue, ParamHelp);
+}
+
+EXPORT int CALL ConfigGetParamInt(m64p_handle ConfigSectionHandle, const char* ParamName)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter = (section != NULL && ParamName != NULL) ? find_parameter(section, ParamName) : NULL;
+
+    if (parameter == NULL)
+        return 0;
+
+    switch (parameter->type)
+    {
+    case M64TYPE_FLOAT:  return (int)parameter->value_float;
+    case M64TYPE_STRING: return atoi(parameter->value_string);
+    default:             return parameter->value_int;
+    }
+}
+
+EXPORT float CALL ConfigGetParamFloat(m64p_handle ConfigSectionHandle, const char* ParamName)
+{
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter = (section != NULL && ParamName != NULL) ? find_parameter(section, ParamName) : NULL;
+
+    if (parameter == NULL)
+        return 0.0f;
+
+    switch (parameter->type)
+    {
+    case M64TYPE_FLOAT:  return parameter->value_float;
+    case M64TYPE_STRING: return (float)atof(parameter->value_string);
+    default:             return (float)parameter->value_int;
+    }
+}
+
+EXPORT int CALL ConfigGetParamBool(m64p_handle ConfigSectionHandle, const char* ParamName)
+{
+    return ConfigGetParamInt(ConfigSectionHandle, ParamName) != 0;
+}
+
+EXPORT const char* CALL ConfigGetParamString(m64p_handle ConfigSectionHandle, const char* ParamName)
+{
+    static char value[256];
+    struct section* section = (struct section*)ConfigSectionHandle;
+    struct parameter* parameter = (section != NULL && ParamName != NULL) ? find_parameter(section, ParamName) : NULL;
+
+    if (parameter == NULL)
+        return "";
+
+    switch (parameter->type)
+    {
+    case M64TYPE_STRING:
+        return parameter->value_string;
+    case M64TYPE_FLOAT:
+        snprintf(value, sizeof(value), "%f", parameter->value_float);
+        return value;
+    case M64TYPE_BOOL:
+        return parameter->value_int ? "True" : "False";
+    default:
+        snprintf(value, sizeof(value), "%i", parameter->value_int);
+        return value;
+    }
+}
+
+EXPORT const char* CALL ConfigGetSharedDataFilepath(const char* filename)
+{
+    static char path[1024];
+    struct stat st;
+
+    if (filename == NULL)
+        return NULL;
+
+    snprintf(path, sizeof(path), "%s/%s", l_data_dir, filename);
+    return stat(path, &st) == 0 ? path : NULL;
+}
+
+EXPORT const char* CALL ConfigGetUserConfigPath(void)
+{
+    return l_data_dir;
+}
+
+EXPORT const char* CALL ConfigGetUserDataPath(void)
+{
+    return l_data_dir;
+}
+
+EXPORT const char* CALL ConfigGetUserCachePath(void)
+{
+    return l_data_dir;
+}
+
+EXPORT m64p_error CALL ConfigExternalOpen(const char* FileName, m64p_handle* Handle)
+{
+    return M64ERR_UNSUPPORTED;
+}
+
+EXPORT m64p_error CALL ConfigExternalClose(m64p_handle Handle)
+{
+    return M64ERR_UNSUPPORTED;
+}
+
+EXPORT m64p_error CALL ConfigExternalGetParameter(m64p_handle Handle, const char* SectionName,
+                                                  const char* ParamName, char* ParamPtr, int ParamMaxLength)
+{
+    return M64ERR_UNSUPPORTED;
+}
+
+
+/* Core */
+
+EXPORT m64p_error CALL CoreGetAPIVersions(int* ConfigVersion, int* DebugVersion, int* VidextVersion, int* ExtraVersion)
+{
+    if (ConfigVersion != NULL)
+        *ConfigVersion = CONFIG_API_VERSION;
+    if (DebugVersion != NULL)
+        *DebugVersion = DEBUG_API_VERSION;
+    if (VidextVersion != NULL)
+        *VidextVersion = VIDEXT_API_VERSION;
+    if (ExtraVersion != NULL)
+        *ExtraVersion = 0;
+
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL CoreDoCommand(m64p_command Command, int ParamInt, void* ParamPtr)
+{
+    return M64ERR_UNSUPPORTED;
+}
+
+static void debug_callback(void* context, int level, const char* message)
+{
+    if (level <= M64MSG_WARNING || l_verbose)
+        fprintf(stderr, "%s: %s\n", (const char*)context, message);
+}
+
+
+/* GL: wrappers counting the calls that matter for performance */
+
+enum gl_counter
+{
+    GL_COUNT_DRAW_ARRAYS,
+    GL_COUNT_DRAW_ELEMENTS,
+    GL_COUNT_CLEAR,
+    GL_COUNT_TEX_IMAGE_2D,
+    GL_COUNT_TEX_SUB_IMAGE_2D,
+    GL_COUNT_BIND_TEXTURE,
+    GL_COUNT_USE_PROGRAM,
+    GL_COUNT_BIND_FRAMEBUFFER,
+    GL_COUNT_BUFFER_DATA,
+    GL_COUNT_BUFFER_SUB_DATA,
+    GL_COUNT_READ_PIXELS,
+    GL_COUNT_NUM
+};
+
+static const char* const l_gl_counter_names[GL_COUNT_NUM] = {
+    "glDrawArrays",
+    "glDrawElements",
+    "glClear",
+    "glTexImage2D",
+    "glTexSubImage2D",
+    "glBindTexture",
+    "glUseProgram",
+    "glBindFramebuffer",
+    "glBufferData",
+    "glBufferSubData",
+    "glReadPixels"
+};
+
+static unsigned long long l_gl_counts[GL_COUNT_NUM];
+static void* l_gl_functions[GL_COUNT_NUM];
+
+/* The wrappers are exported, so they also take the place of the GL functions
+ * plugins link to directly. The real functions are looked up on first use. */
+static void* gl_function(enum gl_counter counter)
+{
+    if (l_gl_functions[counter] == NULL)
+    {
+        l_gl_functions[counter] = (void*)eglGetProcAddress(l_gl_counter_names[counter]);
+        if (l_gl_functions[counter] == NULL)
+            l_gl_functions[counter] = dlsym(RTLD_NEXT, l_gl_counter_names[counter]);
+        if (l_gl_functions[counter] == NULL)
+        {
+            fprintf(stderr, "Error: %s not found\n", l_gl_counter_names[counter]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ++l_gl_counts[counter];
+    return l_gl_functions[counter];
+}
+
+EXPORT void GL_APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLint, GLsizei))gl_function(GL_COUNT_DRAW_ARRAYS))(mode, first, count);
+}
+
+EXPORT void GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLsizei, GLenum, const void*))gl_function(GL_COUNT_DRAW_ELEMENTS))(mode, count, type, indices);
+}
+
+EXPORT void GL_APIENTRY glClear(GLbitfield mask)
+{
+    ((void (GL_APIENTRY*)(GLbitfield))gl_function(GL_COUNT_CLEAR))(mask);
+}
+
+EXPORT void GL_APIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width,
+                                         GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*))
+        gl_function(GL_COUNT_TEX_IMAGE_2D))(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+EXPORT void GL_APIENTRY glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+                                            GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*))
+        gl_function(GL_COUNT_TEX_SUB_IMAGE_2D))(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+EXPORT void GL_APIENTRY glBindTexture(GLenum target, GLuint texture)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLuint))gl_function(GL_COUNT_BIND_TEXTURE))(target, texture);
+}
+
+EXPORT void GL_APIENTRY glUseProgram(GLuint program)
+{
+    ((void (GL_APIENTRY*)(GLuint))gl_function(GL_COUNT_USE_PROGRAM))(program);
+}
+
+EXPORT void GL_APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLuint))gl_function(GL_COUNT_BIND_FRAMEBUFFER))(target, framebuffer);
+}
+
+EXPORT void GL_APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLsizeiptr, const void*, GLenum))gl_function(GL_COUNT_BUFFER_DATA))(target, size, data, usage);
+}
+
+EXPORT void GL_APIENTRY glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    ((void (GL_APIENTRY*)(GLenum, GLintptr, GLsizeiptr, const void*))gl_function(GL_COUNT_BUFFER_SUB_DATA))(target, offset, size, data);
+}
+
+EXPORT void GL_APIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
+                                         GLenum type, void* pixels)
+{
+    ((void (GL_APIENTRY*)(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*))
+        gl_function(GL_COUNT_READ_PIXELS))(x, y, width, height, format, type, pixels);
+}
+
+static const struct
+{
+    const char* name;
+    void* function;
+} l_gl_wrappers[GL_COUNT_NUM] = {
+    { "glDrawArrays", (void*)glDrawArrays },
+    { "glDrawElements", (void*)glDrawElements },
+    { "glClear", (void*)glClear },
+    { "glTexImage2D", (void*)glTexImage2D },
+    { "glTexSubImage2D", (void*)glTexSubImage2D },
+    { "glBindTexture", (void*)glBindTexture },
+    { "glUseProgram", (void*)glUseProgram },
+    { "glBindFramebuffer", (void*)glBindFramebuffer },
+    { "glBufferData", (void*)glBufferData },
+    { "glBufferSubData", (void*)glBufferSubData },
+    { "glReadPixels", (void*)glReadPixels }
+};
+
+
+/* Video extension: an EGL pbuffer of the requested size */
+
+static EGLDisplay l_egl_display = EGL_NO_DISPLAY;
+static EGLConfig l_egl_config;
+static EGLSurface l_egl_surface = EGL_NO_SURFACE;
+static EGLContext l_egl_context = EGL_NO_CONTEXT;
+static int l_gl_attributes[M64P_GL_CONTEXT_PROFILE_MASK + 1];
+static int l_finish = 0;
+static int l_width = 0;
+static int l_height = 0;
+
+EXPORT m64p_error CALL VidExt_Init(void)
+{
+    EGLDisplay (EGLAPIENTRY* get_platform_display)(EGLenum, void*, const EGLint*);
+
+    l_egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (l_egl_display != EGL_NO_DISPLAY && eglInitialize(l_egl_display, NULL, NULL))
+        return M64ERR_SUCCESS;
+
+    /* headless machines may only have Mesa's surfaceless platform */
+    *(void**)&get_platform_display = (void*)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display != NULL)
+    {
+        l_egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (l_egl_display != EGL_NO_DISPLAY && eglInitialize(l_egl_display, NULL, NULL))
+            return M64ERR_SUCCESS;
+    }
+
+    fprintf(stderr, "Error: no EGL display available\n");
+    l_egl_display = EGL_NO_DISPLAY;
+    return M64ERR_SYSTEM_FAIL;
+}
+
+EXPORT m64p_error CALL VidExt_Quit(void)
+{
+    if (l_egl_display == EGL_NO_DISPLAY)
+        return M64ERR_NOT_INIT;
+
+    eglMakeCurrent(l_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (l_egl_context != EGL_NO_CONTEXT)
+        eglDestroyContext(l_egl_display, l_egl_context);
+    if (l_egl_surface != EGL_NO_SURFACE)
+        eglDestroySurface(l_egl_display, l_egl_surface);
+    eglTerminate(l_egl_display);
+
+    l_egl_context = EGL_NO_CONTEXT;
+    l_egl_surface = EGL_NO_SURFACE;
+    l_egl_display = EGL_NO_DISPLAY;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_ListFullscreenModes(m64p_2d_size* SizeArray, int* NumSizes)
+{
+    if (SizeArray == NULL || NumSizes == NULL)
+        return M64ERR_INPUT_ASSERT;
+
+    SizeArray[0].uiWidth = 640;
+    SizeArray[0].uiHeight = 480;
+    *NumSizes = 1;
+    return M64ERR_SUCCESS;
+}
+
+static EGLSurface create_surface(int width, int height)
+{
+    const EGLint attributes[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+
+    return eglCreatePbufferSurface(l_egl_display, l_egl_config, attributes);
+}
+
+EXPORT m64p_error CALL VidExt_SetVideoMode(int Width, int Height, int BitsPerPixel, m64p_video_mode ScreenMode,
+                                           m64p_video_flags Flags)
+{
+    int es = l_gl_attributes[M64P_GL_CONTEXT_PROFILE_MASK] == M64P_GL_CONTEXT_PROFILE_ES;
+    int major = l_gl_attributes[M64P_GL_CONTEXT_MAJOR_VERSION];
+    int minor = l_gl_attributes[M64P_GL_CONTEXT_MINOR_VERSION];
+    EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, es ? (major >= 3 ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_ES2_BIT) : EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, l_gl_attributes[M64P_GL_ALPHA_SIZE],
+        EGL_DEPTH_SIZE, l_gl_attributes[M64P_GL_DEPTH_SIZE],
+        EGL_NONE
+    };
+    EGLint context_attributes[8];
+    EGLint configs = 0;
+    int i = 0;
+
+    if (l_egl_display == EGL_NO_DISPLAY)
+        return M64ERR_NOT_INIT;
+
+    if (l_egl_context != EGL_NO_CONTEXT)
+        return VidExt_ResizeWindow(Width, Height);
+
+    if (!eglBindAPI(es ? EGL_OPENGL_ES_API : EGL_OPENGL_API)
+     || !eglChooseConfig(l_egl_display, config_attributes, &l_egl_config, 1, &configs) || configs < 1)
+    {
+        fprintf(stderr, "Error: no EGL config for an %s context\n", es ? "OpenGL ES" : "OpenGL");
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    if (es || major > 0)
+    {
+        context_attributes[i++] = EGL_CONTEXT_MAJOR_VERSION;
+        context_attributes[i++] = major > 0 ? major : 2;
+        context_attributes[i++] = EGL_CONTEXT_MINOR_VERSION;
+        context_attributes[i++] = minor;
+    }
+    if (!es && major > 0)
+    {
+        context_attributes[i++] = EGL_CONTEXT_OPENGL_PROFILE_MASK;
+        context_attributes[i++] = l_gl_attributes[M64P_GL_CONTEXT_PROFILE_MASK] == M64P_GL_CONTEXT_PROFILE_CORE
+            ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT
+            : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT;
+    }
+    context_attributes[i] = EGL_NONE;
+
+    l_egl_context = eglCreateContext(l_egl_display, l_egl_config, EGL_NO_CONTEXT, context_attributes);
+    l_egl_surface = create_surface(Width, Height);
+    if (l_egl_context == EGL_NO_CONTEXT || l_egl_surface == EGL_NO_SURFACE
+     || !eglMakeCurrent(l_egl_display, l_egl_surface, l_egl_surface, l_egl_context))
+    {
+        fprintf(stderr, "Error: failed to create a %ix%i EGL pbuffer context (0x%x)\n", Width, Height, eglGetError());
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    l_width = Width;
+    l_height = Height;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_ResizeWindow(int Width, int Height)
+{
+    EGLSurface surface;
+
+    if (l_egl_context == EGL_NO_CONTEXT)
+        return M64ERR_NOT_INIT;
+    if (Width == l_width && Height == l_height)
+        return M64ERR_SUCCESS;
+
+    surface = create_surface(Width, Height);
+    if (surface == EGL_NO_SURFACE || !eglMakeCurrent(l_egl_display, surface, surface, l_egl_context))
+        return M64ERR_SYSTEM_FAIL;
+
+    eglDestroySurface(l_egl_display, l_egl_surface);
+    l_egl_surface = surface;
+    l_width = Width;
+    l_height = Height;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_SetCaption(const char* Title)
+{
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_ToggleFullScreen(void)
+{
+    return M64ERR_SUCCESS;
+}
+
+EXPORT void* CALL VidExt_GL_GetProcAddress(const char* Proc)
+{
+    size_t i;
+
+    if (Proc == NULL)
+        return NULL;
+
+    for (i = 0; i < GL_COUNT_NUM; ++i)
+    {
+        if (strcmp(Proc, l_gl_wrappers[i].name) == 0)
+            return l_gl_wrappers[i].function;
+    }
+
+    return (void*)eglGetProcAddress(Proc);
+}
+
+EXPORT m64p_error CALL VidExt_GL_SetAttribute(m64p_GLattr Attr, int Value)
+{
+    if (Attr < M64P_GL_DOUBLEBUFFER || Attr > M64P_GL_CONTEXT_PROFILE_MASK)
+        return M64ERR_INPUT_INVALID;
+
+    l_gl_attributes[Attr] = Value;
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_GL_GetAttribute(m64p_GLattr Attr, int* pValue)
+{
+    if (Attr < M64P_GL_DOUBLEBUFFER || Attr > M64P_GL_CONTEXT_PROFILE_MASK || pValue == NULL)
+        return M64ERR_INPUT_INVALID;
+
+    *pValue = l_gl_attributes[Attr];
+    return M64ERR_SUCCESS;
+}
+
+EXPORT m64p_error CALL VidExt_GL_SwapBuffers(void)
+{
+    static void (GL_APIENTRY* finish)(void) = NULL;
+
+    if (l_egl_context == EGL_NO_CONTEXT)
+        return M64ERR_NOT_INIT;
+
+    /* wait for the GPU, so that the frame time includes its work too */
+    if (l_finish)
+    {
+        if (finish == NULL)
+            finish = (void (GL_APIENTRY*)(void))eglGetProcAddress("glFinish");
+        if (finish != NULL)
+            finish();
+    }
+
+    eglSwapBuffers(l_egl_display, l_egl_surface);
+    return M64ERR_SUCCESS;
+}
+
+EXPORT uint32_t CALL VidExt_GL_GetDefaultFramebuffer(void)
+{
+    return 0;
+}
+
+
+/* Trace replay */
+
+struct plugin
+{
+    void* handle;
+    ptr_PluginStartup PluginStartup;
+    ptr_PluginShutdown PluginShutdown;
+    ptr_InitiateGFX InitiateGFX;
+    ptr_RomOpen RomOpen;
+    ptr_RomClosed RomClosed;
+    ptr_ProcessDList ProcessDList;
+    ptr_ProcessRDPList ProcessRDPList;
+    ptr_UpdateScreen UpdateScreen;
+    ptr_ViStatusChanged ViStatusChanged;
+    ptr_ViWidthChanged ViWidthChanged;
+    ptr_SetRenderingCallback SetRenderingCallback;
+};
+
+struct machine
+{
+    uint8_t header[GFX_TRACE_ROM_HEADER_SIZE];
+    uint8_t* rdram;
+    uint8_t sp_mem[2 * GFX_TRACE_PAGE_SIZE];
+    unsigned int rdram_size;
+    unsigned int mi_intr;
+    unsigned int sp_status;
+    unsigned int dpc[GFX_TRACE_DPC_NUM];
+    unsigned int vi[GFX_TRACE_VI_NUM];
+};
+
+struct frame_stats
+{
+    double* ms;
+    unsigned long long (*counts)[GL_COUNT_NUM];
+    size_t count;
+    size_t capacity;
+};
+
+static struct machine l_machine;
+
+static void check_interrupts(void)
+{
+}
+
+static void render_callback(int redrawn)
+{
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int load_plugin(struct plugin* plugin, const char* filename)
+{
+#define PLUGIN_FUNC(name) \
+    ((*(void**)&plugin->name = dlsym(plugin->handle, #name)) != NULL)
+
+    plugin->handle = dlopen(filename, RTLD_NOW);
+    if (plugin->handle == NULL)
+    {
+        fprintf(stderr, "Error: failed to load video plugin: %s\n", dlerror());
+        return 0;
+    }
+
+    if (!PLUGIN_FUNC(PluginStartup) || !PLUGIN_FUNC(PluginShutdown) || !PLUGIN_FUNC(InitiateGFX)
+     || !PLUGIN_FUNC(RomOpen) || !PLUGIN_FUNC(RomClosed) || !PLUGIN_FUNC(ProcessDList)
+     || !PLUGIN_FUNC(ProcessRDPList) || !PLUGIN_FUNC(UpdateScreen) || !PLUGIN_FUNC(ViStatusChanged)
+     || !PLUGIN_FUNC(ViWidthChanged))
+    {
+        fprintf(stderr, "Error: %s is not a video plugin\n", filename);
+        return 0;
+    }
+    *(void**)&plugin->SetRenderingCallback = dlsym(plugin->handle, "SetRenderingCallback");
+
+    return 1;
+#undef PLUGIN_FUNC
+}
+
+static int start_plugin(struct plugin* plugin)
+{
+    GFX_INFO info;
+
+    if (plugin->PluginStartup(dlopen(NULL, RTLD_NOW), "Video", debug_callback) != M64ERR_SUCCESS)
+    {
+        fprintf(stderr, "Error: video plugin startup failed\n");
+        return 0;
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.HEADER = l_machine.header;
+    info.RDRAM = l_machine.rdram;
+    info.DMEM = l_machine.sp_mem;
+    info.IMEM = l_machine.sp_mem + GFX_TRACE_PAGE_SIZE;
+    info.MI_INTR_REG = &l_machine.mi_intr;
+    info.DPC_START_REG = &l_machine.dpc[GFX_TRACE_DPC_START];
+    info.DPC_END_REG = &l_machine.dpc[GFX_TRACE_DPC_END];
+    info.DPC_CURRENT_REG = &l_machine.dpc[GFX_TRACE_DPC_CURRENT];
+    info.DPC_STATUS_REG = &l_machine.dpc[GFX_TRACE_DPC_STATUS];
+    info.DPC_CLOCK_REG = &l_machine.dpc[GFX_TRACE_DPC_CLOCK];
+    info.DPC_BUFBUSY_REG = &l_machine.dpc[GFX_TRACE_DPC_BUFBUSY];
+    info.DPC_PIPEBUSY_REG = &l_machine.dpc[GFX_TRACE_DPC_PIPEBUSY];
+    info.DPC_TMEM_REG = &l_machine.dpc[GFX_TRACE_DPC_TMEM];
+    info.VI_STATUS_REG = &l_machine.vi[GFX_TRACE_VI_STATUS];
+    info.VI_ORIGIN_REG = &l_machine.vi[GFX_TRACE_VI_ORIGIN];
+    info.VI_WIDTH_REG = &l_machine.vi[GFX_TRACE_VI_WIDTH];
+    info.VI_INTR_REG = &l_machine.vi[GFX_TRACE_VI_INTR];
+    info.VI_V_CURRENT_LINE_REG = &l_machine.vi[GFX_TRACE_VI_V_CURRENT_LINE];
+    info.VI_TIMING_REG = &l_machine.vi[GFX_TRACE_VI_TIMING];
+    info.VI_V_SYNC_REG = &l_machine.vi[GFX_TRACE_VI_V_SYNC];
+    info.VI_H_SYNC_REG = &l_machine.vi[GFX_TRACE_VI_H_SYNC];
+    info.VI_LEAP_REG = &l_machine.vi[GFX_TRACE_VI_LEAP];
+    info.VI_H_START_REG = &l_machine.vi[GFX_TRACE_VI_H_START];
+    info.VI_V_START_REG = &l_machine.vi[GFX_TRACE_VI_V_START];
+    info.VI_V_BURST_REG = &l_machine.vi[GFX_TRACE_VI_V_BURST];
+    info.VI_X_SCALE_REG = &l_machine.vi[GFX_TRACE_VI_X_SCALE];
+    info.VI_Y_SCALE_REG = &l_machine.vi[GFX_TRACE_VI_Y_SCALE];
+    info.CheckInterrupts = check_interrupts;
+    info.version = 2;
+    info.SP_STATUS_REG = &l_machine.sp_status;
+    info.RDRAM_SIZE = &l_machine.rdram_size;
+
+    if (!plugin->InitiateGFX(info))
+    {
+        fprintf(stderr, "Error: InitiateGFX failed\n");
+        return 0;
+    }
+
+    if (plugin->SetRenderingCallback != NULL)
+        plugin->SetRenderingCallback(render_callback);
+
+    if (!plugin->RomOpen())
+    {
+        fprintf(stderr, "Error: RomOpen failed\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+static uint8_t* load_trace(const char* filename, size_t* size)
+{
+    FILE* file = fopen(filename, "rb");
+    uint8_t* data = NULL;
+    long length;
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error: failed to open trace '%s'\n", filename);
+        return NULL;
+    }
+
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = malloc(length);
+        if (data != NULL && fread(data, 1, length, file) != (size_t)length)
+        {
+            free(data);
+            data = NULL;
+        }
+        *size = length;
+    }
+
+    fclose(file);
+    if (data == NULL)
+        fprintf(stderr, "Error: failed to read trace '%s'\n", filename);
+    return data;
+}
+
+static void set_registers(const struct gfx_trace_registers* regs)
+{
+    size_t i;
+
+    l_machine.mi_intr = regs->mi_intr;
+    l_machine.sp_status = regs->sp_status;
+    for (i = 0; i < GFX_TRACE_DPC_NUM; ++i)
+        l_machine.dpc[i] = regs->dpc[i];
+    for (i = 0; i < GFX_TRACE_VI_NUM; ++i)
+        l_machine.vi[i] = regs->vi[i];
+}
+
+static void add_frame(struct frame_stats* stats, double ms, const unsigned long long* counts)
+{
+    if (stats->count == stats->capacity)
+    {
+        stats->capacity = stats->capacity != 0 ? 2 * stats->capacity : 1024;
+        stats->ms = realloc(stats->ms, stats->capacity * sizeof(*stats->ms));
+        stats->counts = realloc(stats->counts, stats->capacity * sizeof(*stats->counts));
+        if (stats->ms == NULL || stats->counts == NULL)
+        {
+            fprintf(stderr, "Error: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    stats->ms[stats->count] = ms;
+    memcpy(stats->counts[stats->count], counts, sizeof(*stats->counts));
+    ++stats->count;
+}
+
+/* Replays the trace once from zeroed memory, adding the frames to stats */
+static int replay(const struct plugin* plugin, const uint8_t* data, size_t size, struct frame_stats* stats)
+{
+    const size_t page_count = l_machine.rdram_size / GFX_TRACE_PAGE_SIZE;
+    size_t offset = sizeof(struct gfx_trace_header);
+    unsigned long long counts[GL_COUNT_NUM];
+    double frame_ms = 0.0;
+    size_t i;
+
+    memset(l_machine.rdram, 0, l_machine.rdram_size);
+    memset(l_machine.sp_mem, 0, sizeof(l_machine.sp_mem));
+    memcpy(counts, l_gl_counts, sizeof(counts));
+
+    while (offset + sizeof(struct gfx_trace_record) <= size)
+    {
+        struct gfx_trace_record record;
+        const uint8_t* payload = data + offset + sizeof(record);
+        size_t payload_size;
+        double start;
+
+        memcpy(&record, data + offset, sizeof(record));
+        payload_size = (record.type <= GFX_TRACE_IMEM) ? GFX_TRACE_PAGE_SIZE : sizeof(struct gfx_trace_registers);
+        if (record.type >= GFX_TRACE_RECORD_NUM || offset + sizeof(record) + payload_size > size)
+        {
+            fprintf(stderr, "Error: corrupt trace at offset %zu\n", offset);
+            return 0;
+        }
+        offset += sizeof(record) + payload_size;
+
+        switch (record.type)
+        {
+        case GFX_TRACE_RDRAM_PAGE:
+            if (record.arg >= page_count)
+            {
+                fprintf(stderr, "Error: RDRAM page %u out of range\n", record.arg);
+                return 0;
+            }
+            memcpy(l_machine.rdram + (size_t)record.arg * GFX_TRACE_PAGE_SIZE, payload, GFX_TRACE_PAGE_SIZE);
+            continue;
+        case GFX_TRACE_DMEM:
+            memcpy(l_machine.sp_mem, payload, GFX_TRACE_PAGE_SIZE);
+            continue;
+        case GFX_TRACE_IMEM:
+            memcpy(l_machine.sp_mem + GFX_TRACE_PAGE_SIZE, payload, GFX_TRACE_PAGE_SIZE);
+            continue;
+        }
+
+        set_registers((const struct gfx_trace_registers*)payload);
+
+        /* only the time spent in the plugin counts */
+        start = now_ms();
+        switch (record.type)
+        {
+        case GFX_TRACE_PROCESS_DLIST:     plugin->ProcessDList(); break;
+        case GFX_TRACE_PROCESS_RDP_LIST:  plugin->ProcessRDPList(); break;
+        case GFX_TRACE_UPDATE_SCREEN:     plugin->UpdateScreen(); break;
+        case GFX_TRACE_VI_STATUS_CHANGED: plugin->ViStatusChanged(); break;
+        case GFX_TRACE_VI_WIDTH_CHANGED:  plugin->ViWidthChanged(); break;
+        }
+        frame_ms += now_ms() - start;
+
+        if (record.type == GFX_TRACE_UPDATE_SCREEN)
+        {
+            for (i = 0; i < GL_COUNT_NUM; ++i)
+                counts[i] = l_gl_counts[i] - counts[i];
+            add_frame(stats, frame_ms, counts);
+            memcpy(counts, l_gl_counts, sizeof(counts));
+            frame_ms = 0.0;
+        }
+    }
+
+    return 1;
+}
+
+static void report(const struct frame_stats* stats, size_t warmup)
+{
+    double total = 0.0, min = 0.0, max = 0.0;
+    unsigned long long counts[GL_COUNT_NUM];
+    size_t frames, i, j;
+
+    if (stats->count <= warmup)
+    {
+        printf("No frames measured (%zu frames replayed, %zu warm-up frames)\n", stats->count, warmup);
+        return;
+    }
+
+    frames = stats->count - warmup;
+    memset(counts, 0, sizeof(counts));
+    for (i = warmup; i < stats->count; ++i)
+    {
+        double ms = stats->ms[i];
+
+        total += ms;
+        if (i == warmup || ms < min)
+            min = ms;
+        if (i == warmup || ms > max)
+            max = ms;
+        for (j = 0; j < GL_COUNT_NUM; ++j)
+            counts[j] += stats->counts[i][j];
+    }
+
+    printf("Frames:              %zu (after %zu warm-up frames)\n", frames, warmup);
+    printf("ms/frame:            %.3f avg, %.3f min, %.3f max (%.1f fps)\n",
+           total / frames, min, max, total > 0.0 ? 1000.0 * frames / total : 0.0);
+    printf("GL calls per frame:\n");
+    for (j = 0; j < GL_COUNT_NUM; ++j)
+        printf("  %-18s %10.1f\n", l_gl_counter_names[j], (double)counts[j] / frames);
+}
+
+static int add_override(const char* setting)
+{
+    /* Section[Param]=value, as with the console front-end's --set */
+    struct override* override = calloc(1, sizeof(*override));
+    const char* open = strchr(setting, '[');
+    const char* close = open != NULL ? strchr(open, ']') : NULL;
+
+    if (override == NULL || open == NULL || close == NULL || close[1] != '=')
+    {
+        free(override);
+        return 0;
+    }
+
+    snprintf(override->section, sizeof(override->section), "%.*s", (int)(open - setting), setting);
+    snprintf(override->name, sizeof(override->name), "%.*s", (int)(close - open - 1), open + 1);
+    snprintf(override->value, sizeof(override->value), "%s", close + 2);
+    override->next = l_overrides;
+    l_overrides = override;
+    return 1;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <video plugin> <trace file>\n"
+            "Options:\n"
+            "  -d <dir>                  directory of the plugin's data and cache files (default: .)\n"
+            "  -s <Section[Param]=value> set a config parameter, may be repeated\n"
+            "  -n <count>                replay the trace count times (default: 1)\n"
+            "  -w <frames>               leave the first frames out of the results (default: 0)\n"
+            "  -f                        wait for the GPU at every buffer swap\n"
+            "  -v                        show all the plugin messages\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    struct gfx_trace_header header;
+    struct frame_stats stats;
+    struct plugin plugin;
+    const char* plugin_file = NULL;
+    const char* trace_file = NULL;
+    unsigned int loops = 1;
+    size_t warmup = 0;
+    uint8_t* data;
+    size_t size = 0;
+    unsigned int i;
+    int ok = 1;
+
+    for (i = 1; i < (unsigned int)argc; ++i)
+    {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < (unsigned int)argc)
+            l_data_dir = argv[++i];
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < (unsigned int)argc && add_override(argv[i + 1]))
+            ++i;
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < (unsigned int)argc)
+            loops = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < (unsigned int)argc)
+            warmup = (size_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-f") == 0)
+            l_finish = 1;
+        else if (strcmp(argv[i], "-v") == 0)
+            l_verbose = 1;
+        else if (argv[i][0] != '-' && plugin_file == NULL)
+            plugin_file = argv[i];
+        else if (argv[i][0] != '-' && trace_file == NULL)
+            trace_file = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (plugin_file == NULL || trace_file == NULL)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    data = load_trace(trace_file, &size);
+    if (data == NULL)
+        return EXIT_FAILURE;
+
+    memcpy(&header, data, size >= sizeof(header) ? sizeof(header) : 0);
+    if (size < sizeof(header) || header.magic != GFX_TRACE_MAGIC || header.version != GFX_TRACE_VERSION)
+    {
+        fprintf(stderr, "Error: '%s' is not a version %u video plugin trace\n", trace_file, GFX_TRACE_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    memcpy(l_machine.header, header.rom_header, GFX_TRACE_ROM_HEADER_SIZE);
+    l_machine.rdram_size = header.rdram_size;
+    l_machine.rdram = calloc(1, header.rdram_size);
+    if (l_machine.rdram == NULL)
+    {
+        fprintf(stderr, "Error: failed to allocate %u bytes of RDRAM\n", header.rdram_size);
+        return EXIT_FAILURE;
+    }
+
+    memset(&plugin, 0, sizeof(plugin));
+    if (!load_plugin(&plugin, plugin_file))
+        return EXIT_FAILURE;
+
+    memset(&stats, 0, sizeof(stats));
+    if (start_plugin(&plugin))
+    {
+        for (i = 0; i < loops && ok; ++i)
+            ok = replay(&plugin, data, size, &stats);
+
+        plugin.RomClosed();
+        report(&stats, warmup);
+    }
+    else
+        ok = 0;
+
+    plugin.PluginShutdown();
+    dlclose(plugin.handle);
+
+    free(stats.ms);
+    free(stats.counts);
+    free(l_machine.rdram);
+    free(data);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
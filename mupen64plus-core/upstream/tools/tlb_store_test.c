@@ -0,0 +1,128 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - tlb_store_test.c                                        *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Checks that r4300 stores through a TLB mapping bump the RDRAM generation
+ * counters, on the first store which goes through virtual_to_physical_address
+ * as well as on the following ones served from the TLB host cache.
+ *
+ * Only r4300_core.c and tlb.c are linked in, the functions of the cached
+ * interpreter and exception handling they reference are stubbed below.
+ * Build and run with "make test" in projects/unix. */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "device/memory/memory.h"
+#include "device/r4300/r4300_core.h"
+#include "device/r4300/tlb.h"
+#include "device/rdram/rdram.h"
+
+void DebugMessage(int level, const char *message, ...)
+{
+}
+
+void TLB_refill_exception(struct r4300_core* r4300, uint32_t address, int w)
+{
+}
+
+void invalidate_cached_code_hacktarux(struct r4300_core* r4300, uint32_t address, size_t size)
+{
+}
+
+#ifdef NEW_DYNAREC
+void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t address, size_t size)
+{
+}
+#endif
+
+enum { TEST_VADDR = 0x00010000, TEST_PADDR = 0x00200000 };
+
+static struct r4300_core r4300;
+static struct memory mem;
+static struct rdram rdram;
+static uint32_t dram[RDRAM_MAX_SIZE / 4];
+
+static int failures;
+
+static void check(int cond, const char* what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+static unsigned int generation(uint32_t paddr)
+{
+    return rdram.generations[paddr >> RDRAM_GENERATION_SHIFT];
+}
+
+int main(void)
+{
+    size_t i;
+    unsigned int gen;
+    struct tlb_entry* e = &r4300.cp0.tlb.entries[0];
+
+    rdram.dram = dram;
+    rdram.dram_size = RDRAM_MAX_SIZE;
+    for (i = 0; i < RDRAM_MAX_SIZE >> 16; ++i) {
+        mem.direct[i] = dram + (i << 14);
+    }
+
+    r4300.emumode = EMUMODE_PURE_INTERPRETER;
+    r4300.mem = &mem;
+    r4300.rdram = &rdram;
+
+    /* map one writable 4KB page at TEST_VADDR to TEST_PADDR */
+    poweron_tlb(&r4300.cp0.tlb);
+    e->v_even = 1;
+    e->d_even = 1;
+    e->start_even = TEST_VADDR;
+    e->end_even = TEST_VADDR + 0xfff;
+    e->phys_even = TEST_PADDR;
+    tlb_map(&r4300.cp0.tlb, 0);
+
+    gen = generation(TEST_PADDR + 0x10);
+    r4300_write_aligned_word(&r4300, TEST_VADDR + 0x10, 0x12345678, ~UINT32_C(0));
+    check(dram[(TEST_PADDR + 0x10) / 4] == 0x12345678, "word store through the LUT reaches RDRAM");
+    check(generation(TEST_PADDR + 0x10) == gen + 1, "word store through the LUT bumps the generation");
+
+#ifndef DBG
+    check(tlb_lookup_host(r4300.cp0.tlb.host_w, TEST_VADDR) != NULL, "first store fills the TLB host cache");
+#endif
+
+    gen = generation(TEST_PADDR + 0x20);
+    r4300_write_aligned_word(&r4300, TEST_VADDR + 0x20, 0x9abcdef0, ~UINT32_C(0));
+    check(dram[(TEST_PADDR + 0x20) / 4] == 0x9abcdef0, "word store through the host cache reaches RDRAM");
+    check(generation(TEST_PADDR + 0x20) == gen + 1, "word store through the host cache bumps the generation");
+
+    gen = generation(TEST_PADDR + 0x800);
+    r4300_write_aligned_dword(&r4300, TEST_VADDR + 0x800, UINT64_C(0x0123456789abcdef), ~UINT64_C(0));
+    check(dram[(TEST_PADDR + 0x800) / 4] == 0x01234567 && dram[(TEST_PADDR + 0x804) / 4] == 0x89abcdef,
+          "dword store through the host cache reaches RDRAM");
+    check(generation(TEST_PADDR + 0x800) == gen + 1, "dword store through the host cache bumps the generation");
+
+    if (failures == 0) {
+        printf("tlb store test passed\n");
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
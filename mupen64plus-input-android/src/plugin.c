@@ -21,6 +21,8 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
 #include <jni.h>
 #include <android/log.h>
 
@@ -44,6 +46,9 @@
 #define RD_WRITEEPROM       		0x05   	// write eeprom
 #define RD_RESETCONTROLLER  		0xff   	// reset controller
 
+// Button events buffered per controller between two polls, must be a power of two
+#define INPUT_QUEUE_SIZE            64
+
 // Internal constants
 static const unsigned short BUTTON_BITS[] =
 {
@@ -65,15 +70,31 @@ static const unsigned short BUTTON_BITS[] =
         0x8000   // Reserved2
 };
 
+// Button state change, stamped with the CLOCK_MONOTONIC time it was received
+typedef struct
+{
+    int64_t time;
+    unsigned short buttons;
+} InputEvent;
+
+// Single producer (Java input thread), single consumer (emulation thread) ring
+typedef struct
+{
+    InputEvent events[INPUT_QUEUE_SIZE];
+    unsigned int head;          // written by the producer only
+    unsigned int tail;          // written by the consumer only
+    unsigned int latest;        // most recent buttons | x << 16 | y << 24
+    int overflow;               // events were dropped, resync from latest
+} InputQueue;
+
 // Internal variables
 static JavaVM* _javaVM;
 static jclass _jniClass = NULL;
 static jmethodID _jniRumble = NULL;
 static int _androidPluggedState[4];
 static int _androidPakType[4];
-static unsigned char _androidButtonState[4][16];
-static signed char _androidAnalogX[4];
-static signed char _androidAnalogY[4];
+static InputQueue _inputQueues[4];
+static unsigned short _polledButtons[4];
 static int _pluginInitialized = 0;
 static CONTROL* _controllerInfos = NULL;
 
@@ -108,6 +129,66 @@ static unsigned char DataCRC(unsigned char* data, int length)
     return remainder;
 }
 
+static int64_t MonotonicTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void PushState(InputQueue* queue, unsigned short buttons, signed char x, signed char y)
+{
+    unsigned int latest = __atomic_load_n(&queue->latest, __ATOMIC_RELAXED);
+    unsigned int head = queue->head;
+
+    // Only button changes are queued, the axes always read as their latest value
+    if ((latest & 0xffff) != buttons)
+    {
+        if (head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) < INPUT_QUEUE_SIZE)
+        {
+            InputEvent* event = &queue->events[head & (INPUT_QUEUE_SIZE - 1)];
+            event->time = MonotonicTime();
+            event->buttons = buttons;
+            __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            __atomic_store_n(&queue->overflow, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    latest = buttons | ((unsigned char) x << 16) | ((unsigned int) (unsigned char) y << 24);
+    __atomic_store_n(&queue->latest, latest, __ATOMIC_RELEASE);
+}
+
+// Returns the button state at pollTime. Presses not seen by a poll yet are held
+// until the next one, so a tap shorter than the polling interval is not lost.
+static unsigned short PopState(InputQueue* queue, unsigned short buttons, int64_t pollTime)
+{
+    unsigned int tail = queue->tail;
+    unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    unsigned short unpolled = 0;
+
+    while (tail != head)
+    {
+        const InputEvent* event = &queue->events[tail & (INPUT_QUEUE_SIZE - 1)];
+
+        if (event->time > pollTime || (unpolled & ~event->buttons) != 0)
+            break;
+
+        unpolled |= event->buttons & ~buttons;
+        buttons = event->buttons;
+        ++tail;
+    }
+
+    __atomic_store_n(&queue->tail, tail, __ATOMIC_RELEASE);
+
+    if (tail == head && __atomic_exchange_n(&queue->overflow, 0, __ATOMIC_ACQUIRE))
+        buttons = __atomic_load_n(&queue->latest, __ATOMIC_ACQUIRE) & 0xffff;
+
+    return buttons;
+}
+
 /*******************************************************************************
  Functions called automatically by JNI framework
  *******************************************************************************/
@@ -159,16 +240,20 @@ JNIEXPORT void JNICALL Java_paulscode_android_mupen64plusae_jni_NativeInput_setC
 JNIEXPORT void JNICALL Java_paulscode_android_mupen64plusae_jni_NativeInput_setState(JNIEnv* env, jclass jcls, jint controllerNum, jbooleanArray mp64pButtons,
         jint mp64pXAxis, jint mp64pYAxis)
 {
-    jboolean* elements = (*env)->GetBooleanArrayElements(env, mp64pButtons, NULL);
+    if (controllerNum > 3 || controllerNum < 0)
+        return;
+
+    jboolean elements[16];
+    unsigned short buttons = 0;
     int b;
+    (*env)->GetBooleanArrayRegion(env, mp64pButtons, 0, 16, elements);
     for (b = 0; b < 16; b++)
     {
-        _androidButtonState[controllerNum][b] = elements[b];
+        if (elements[b])
+            buttons |= BUTTON_BITS[b];
     }
-    (*env)->ReleaseBooleanArrayElements(env, mp64pButtons, elements, 0);
 
-    _androidAnalogX[controllerNum] = (signed char) ((int) mp64pXAxis);
-    _androidAnalogY[controllerNum] = (signed char) ((int) mp64pYAxis);
+    PushState(&_inputQueues[controllerNum], buttons, (signed char) ((int) mp64pXAxis), (signed char) ((int) mp64pYAxis));
 }
 
 //*****************************************************************************
@@ -280,20 +365,15 @@ EXPORT void CALL InitiateControllers(CONTROL_INFO controlInfo)
 
 EXPORT void CALL GetKeys(int controllerNum, BUTTONS* keys)
 {
-    // Reset the controller state
-    keys->Value = 0;
+    InputQueue* queue = &_inputQueues[controllerNum];
 
-    // Set the button bits
-    int b;
-    for (b = 0; b < 16; b++)
-    {
-        if (_androidButtonState[controllerNum][b])
-            keys->Value |= BUTTON_BITS[b];
-    }
+    // Replay the button events received up to this poll
+    _polledButtons[controllerNum] = PopState(queue, _polledButtons[controllerNum], MonotonicTime());
 
-    // Set the analog bytes
-    keys->X_AXIS = _androidAnalogX[controllerNum];
-    keys->Y_AXIS = _androidAnalogY[controllerNum];
+    unsigned int latest = __atomic_load_n(&queue->latest, __ATOMIC_ACQUIRE);
+    keys->Value = _polledButtons[controllerNum];
+    keys->X_AXIS = (signed char) (latest >> 16);
+    keys->Y_AXIS = (signed char) (latest >> 24);
 }
 
 EXPORT void CALL ControllerCommand(int controllerNum, unsigned char* command)
@@ -4,20 +4,22 @@
 include $(CLEAR_VARS)
 LOCAL_PATH := $(JNI_LOCAL_PATH)
 SRCDIR := upstream
+RSPHLEDIR := ../mupen64plus-rsp-hle/upstream/src
 
-MY_LOCAL_CFLAGS := $(COMMON_CFLAGS) -DM64P_PLUGIN_API
+MY_LOCAL_CFLAGS := $(COMMON_CFLAGS) -DM64P_PLUGIN_API -DUSE_RSP_HLE
 
 LOCAL_MODULE := mupen64plus-rsp-cxd4
 LOCAL_ARM_MODE := arm
-LOCAL_C_INCLUDES := $(M64P_API_INCLUDES)
+LOCAL_C_INCLUDES := $(M64P_API_INCLUDES) $(LOCAL_PATH)/$(RSPHLEDIR)
 
 ifeq ($(TARGET_ARCH_ABI), armeabi-v7a)
     MY_LOCAL_CFLAGS += -DUSE_SSE2NEON -D__ARM_NEON__ -mfpu=neon
 else ifeq ($(TARGET_ARCH_ABI), x86)
-    MY_LOCAL_CFLAGS += -ARCH_MIN_SSE2
+    MY_LOCAL_CFLAGS += -DARCH_MIN_SSE2
 endif
 
 LOCAL_SRC_FILES := \
+    $(SRCDIR)/hle_audio.c \
     $(SRCDIR)/module.c \
     $(SRCDIR)/su.c \
     $(SRCDIR)/osal_dynamiclib_unix.c \
@@ -26,7 +28,20 @@ LOCAL_SRC_FILES := \
     $(SRCDIR)/vu/logical.c \
     $(SRCDIR)/vu/multiply.c \
     $(SRCDIR)/vu/select.c \
-    $(SRCDIR)/vu/vu.c
+    $(SRCDIR)/vu/vu.c \
+    $(RSPHLEDIR)/alist.c \
+    $(RSPHLEDIR)/alist_audio.c \
+    $(RSPHLEDIR)/alist_naudio.c \
+    $(RSPHLEDIR)/alist_nead.c \
+    $(RSPHLEDIR)/audio.c \
+    $(RSPHLEDIR)/cicx105.c \
+    $(RSPHLEDIR)/hle.c \
+    $(RSPHLEDIR)/jpeg.c \
+    $(RSPHLEDIR)/memory.c \
+    $(RSPHLEDIR)/mp3.c \
+    $(RSPHLEDIR)/musyx.c \
+    $(RSPHLEDIR)/re2.c \
+    $(RSPHLEDIR)/task_cache.c
 
 LOCAL_CFLAGS := $(MY_LOCAL_CFLAGS)
 LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS)
@@ -0,0 +1,155 @@
+/******************************************************************************\
+* Project:  Audio Tasks Forwarded to the HLE Core of rsp-hle                   *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifdef USE_RSP_HLE
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <m64p_types.h>
+
+#include "module.h"
+#include "hle_audio.h"
+
+#include "hle.h"
+#include "hle_external.h"
+
+extern RSP_INFO RSP_INFO_NAME;
+
+static struct hle_t hle;
+static int forwarded;
+
+void hle_audio_init(void)
+{
+    hle_init(&hle,
+        GET_RSP_INFO(RDRAM),
+        GET_RSP_INFO(DMEM),
+        GET_RSP_INFO(IMEM),
+        GET_RSP_INFO(MI_INTR_REG),
+        GET_RSP_INFO(SP_MEM_ADDR_REG),
+        GET_RSP_INFO(SP_DRAM_ADDR_REG),
+        GET_RSP_INFO(SP_RD_LEN_REG),
+        GET_RSP_INFO(SP_WR_LEN_REG),
+        GET_RSP_INFO(SP_STATUS_REG),
+        GET_RSP_INFO(SP_DMA_FULL_REG),
+        GET_RSP_INFO(SP_DMA_BUSY_REG),
+        GET_RSP_INFO(SP_PC_REG),
+        GET_RSP_INFO(SP_SEMAPHORE_REG),
+        GET_RSP_INFO(DPC_START_REG),
+        GET_RSP_INFO(DPC_END_REG),
+        GET_RSP_INFO(DPC_CURRENT_REG),
+        GET_RSP_INFO(DPC_STATUS_REG),
+        GET_RSP_INFO(DPC_CLOCK_REG),
+        GET_RSP_INFO(DPC_BUFBUSY_REG),
+        GET_RSP_INFO(DPC_PIPEBUSY_REG),
+        GET_RSP_INFO(DPC_TMEM_REG),
+        NULL);
+    return;
+}
+
+int hle_audio_task(void)
+{
+    forwarded = 0;
+    hle_execute(&hle);
+    return (forwarded == 0);
+}
+
+/*
+ * the callbacks the HLE core expects from its user
+ */
+static void hle_message(int level, const char* format, va_list args)
+{
+    char body[1024];
+
+    vsnprintf(body, sizeof(body), format, args);
+    hle_audio_message(level, body);
+    return;
+}
+
+void HleVerboseMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    va_start(args, message);
+    hle_message(M64MSG_VERBOSE, message, args);
+    va_end(args);
+}
+
+void HleInfoMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    va_start(args, message);
+    hle_message(M64MSG_INFO, message, args);
+    va_end(args);
+}
+
+void HleErrorMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    va_start(args, message);
+    hle_message(M64MSG_ERROR, message, args);
+    va_end(args);
+}
+
+void HleWarnMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+
+    va_start(args, message);
+    hle_message(M64MSG_WARNING, message, args);
+    va_end(args);
+}
+
+void HleCheckInterrupts(void* user_defined)
+{
+    GET_RSP_INFO(CheckInterrupts)();
+}
+
+void HleProcessDlistList(void* user_defined)
+{
+    if (GET_RSP_INFO(ProcessDlistList) != NULL)
+        GET_RSP_INFO(ProcessDlistList)();
+}
+
+void HleProcessAlistList(void* user_defined)
+{
+    if (GET_RSP_INFO(ProcessAlistList) != NULL)
+        GET_RSP_INFO(ProcessAlistList)();
+}
+
+void HleProcessRdpList(void* user_defined)
+{
+    if (GET_RSP_INFO(ProcessRdpList) != NULL)
+        GET_RSP_INFO(ProcessRdpList)();
+}
+
+void HleShowCFB(void* user_defined)
+{
+    if (GET_RSP_INFO(ShowCFB) != NULL)
+        GET_RSP_INFO(ShowCFB)();
+}
+
+/*
+ * Called for the ucodes rsp-hle cannot identify.  Nothing has been done to
+ * the task yet at this point, so reporting it as handled just hands it back
+ * to DoRspCycles for LLE.
+ */
+int HleForwardTask(void* user_defined)
+{
+    forwarded = 1;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/******************************************************************************\
+* Project:  Audio Tasks Forwarded to the HLE Core of rsp-hle                   *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+#ifndef _HLE_AUDIO_H_
+#define _HLE_AUDIO_H_
+
+/*
+ * Builds defining USE_RSP_HLE compile the rsp-hle core in, so audio tasks can
+ * run in HLE while graphics (and everything else) keeps running in LLE.
+ */
+
+/*
+ * Points the HLE core to the RCP state, once RSP_INFO has been filled in.
+ */
+extern void hle_audio_init(void);
+
+/*
+ * Runs the audio task in DMEM.  Returns zero if rsp-hle does not know the
+ * ucode, leaving the task untouched for the interpreter.
+ */
+extern int hle_audio_task(void);
+
+/*
+ * Provided by module.c for the rsp-hle messages.
+ */
+extern void hle_audio_message(int level, const char* body);
+
+#endif
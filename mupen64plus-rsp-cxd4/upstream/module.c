@@ -28,6 +28,13 @@
 #include "module.h"
 #include "su.h"
 
+#ifdef USE_RSP_HLE
+#if !defined(M64P_PLUGIN_API)
+#error "USE_RSP_HLE requires the Mupen64Plus plugin API."
+#endif
+#include "hle_audio.h"
+#endif
+
 RSP_INFO RSP_INFO_NAME;
 
 #define RSP_CXD4_VERSION 0x0101
@@ -68,6 +75,9 @@ NOINLINE void update_conf(const char* source)
     CFG_HLE_AUD = ConfigGetParamBool(l_ConfigRsp, "AudioListToAudioPlugin");
     CFG_WAIT_FOR_CPU_HOST = ConfigGetParamBool(l_ConfigRsp, "WaitForCPUHost");
     CFG_MEND_SEMAPHORE_LOCK = ConfigGetParamBool(l_ConfigRsp, "SupportCPUSemaphoreLock");
+#ifdef USE_RSP_HLE
+    CFG_RSP_HLE_AUD = ConfigGetParamBool(l_ConfigRsp, "AudioListToRspHle");
+#endif
 }
 
 static void DebugMessage(int level, const char *message, ...)
@@ -86,6 +96,13 @@ static void DebugMessage(int level, const char *message, ...)
   va_end(args);
 }
 
+#ifdef USE_RSP_HLE
+void hle_audio_message(int level, const char* body)
+{
+    DebugMessage(level, "%s", body);
+}
+#endif
+
 EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Context,
                                      void (*DebugCallback)(void *, int, const char *))
 {
@@ -179,6 +196,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     ConfigSetDefaultBool(l_ConfigRsp, "AudioListToAudioPlugin", 0, "Send audio lists to the audio plugin");
     ConfigSetDefaultBool(l_ConfigRsp, "WaitForCPUHost", 0, "Force CPU-RSP signals synchronization");
     ConfigSetDefaultBool(l_ConfigRsp, "SupportCPUSemaphoreLock", 0, "Support CPU-RSP semaphore lock");
+#ifdef USE_RSP_HLE
+    ConfigSetDefaultBool(l_ConfigRsp, "AudioListToRspHle", 0, "Run audio lists with the built-in rsp-hle instead of LLE (AudioListToAudioPlugin takes precedence)");
+#endif
 
     if (bSaveConfig && ConfigAPIVersion >= 0x020100)
         ConfigSaveSection("rsp-cxd4");
@@ -313,6 +333,10 @@ EXPORT unsigned int CALL DoRspCycles(unsigned int cycles)
 #endif
 #ifdef EXTERN_COMMAND_LIST_ABI
     case M_AUDTASK:
+#ifdef USE_RSP_HLE
+        if (CFG_HLE_AUD == 0 && CFG_RSP_HLE_AUD != 0 && hle_audio_task())
+            return 0;
+#endif
         if (CFG_HLE_AUD == 0)
             break;
 
@@ -443,6 +467,9 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, pu32 CycleCount)
     GBI_phase = GET_RSP_INFO(ProcessRdpList);
     if (GBI_phase == NULL)
         GBI_phase = no_LLE;
+#ifdef USE_RSP_HLE
+    hle_audio_init();
+#endif
     return;
 }
 
@@ -64,6 +64,12 @@ typedef enum {
 #define CFG_MEND_SEMAPHORE_LOCK     (*(pi32)(conf + 0x14))
 #define CFG_TRACE_RSP_REGISTERS     (*(pi32)(conf + 0x18))
 
+/*
+ * Builds with rsp-hle compiled in (USE_RSP_HLE) can run audio tasks through
+ * it and keep LLE for everything else, usually the graphics ucodes.
+ */
+#define CFG_RSP_HLE_AUD             (*(pi32)(conf + 0x1C))
+
 /*
  * Update RSP configuration memory from local file resource.
  */
@@ -30,6 +30,45 @@ pu8 DRAM;
 pu8 DMEM;
 pu8 IMEM;
 
+/*
+ * predecoded IMEM:  one slot per instruction word, holding the handler the
+ * word resolves to and the operand fields it needs, so that run_task() does
+ * not decode the same loop body again each time through it
+ *
+ * Slots are decoded lazily, and each keeps the word it was decoded from.
+ * IMEM DMA during a task and CPU writes to IMEM between tasks are caught by
+ * check_predecoded_IMEM() comparing those words against IMEM.
+ */
+typedef struct predecoded_op predecoded_op;
+typedef int(*p_op_func)(const predecoded_op* op, u32 PC);
+struct predecoded_op {
+    p_op_func func; /* 0 to continue, 1 for a taken branch, -1 to halt */
+    u32 inst;
+    union {
+        p_vector_func vector;
+        mwc2_func transfer;
+    } target;
+    s16 offset;
+    u8 rs, rt, rd, sa; /* op, vt, vs, vd for COP2; base, vt, -, element for LWC2/SWC2 */
+};
+static predecoded_op predecoded_IMEM[0x1000 / 4];
+
+static void check_predecoded_IMEM(void);
+
+/*
+ * PREDECODE_TEST builds a run_task() which can also decode every word again
+ * as it is fetched, leaving predecoded_IMEM alone.  tools/predecode_test.c
+ * checks the predecoded slots against that.
+ */
+#ifdef PREDECODE_TEST
+int predecode_bypass;
+#define FETCH_OP(PC)    (predecode_bypass \
+  ? (decode_op(&fetched, *(pu32)(IMEM + FIT_IMEM(PC))), &fetched) \
+  : &predecoded_IMEM[FIT_IMEM(PC) / 4])
+#else
+#define FETCH_OP(PC)    (&predecoded_IMEM[FIT_IMEM(PC) / 4])
+#endif
+
 NOINLINE void res_S(void)
 {
     message("RESERVED.");
@@ -204,6 +243,7 @@ MT_CMD_CLOCK       ,MT_READ_ONLY       ,MT_READ_ONLY       ,MT_READ_ONLY
 void SP_DMA_READ(void)
 {
     unsigned int offC, offD; /* SP cache and dynamic DMA pointers */
+    unsigned int touched; /* OR of every offC, to tell if IMEM was written */
     register unsigned int length;
     register unsigned int count;
     register unsigned int skip;
@@ -217,6 +257,7 @@ void SP_DMA_READ(void)
     ++length;
     ++count;
     skip += length;
+    touched = 0;
     do {
         register unsigned int i;
 
@@ -229,12 +270,15 @@ void SP_DMA_READ(void)
                 *(pi64)(DRAM + offD)
               & (offD & ~MAX_DRAM_DMA_ADDR ? 0 : ~0) /* 0 if (addr > limit) */
             ;
+            touched |= offC;
             i += 0x008;
         } while (i < length);
     } while (count);
 
     if ((*CR[0x0] & 0x1000) ^ (offC & 0x1000))
         message("DMA over the DMEM-to-IMEM gap.");
+    if (touched & 0x1000)
+        check_predecoded_IMEM();
     GET_RCP_REG(SP_DMA_BUSY_REG)  =  0x00000000;
     GET_RCP_REG(SP_STATUS_REG)   &= ~SP_STATUS_DMA_BUSY;
     return;
@@ -1979,123 +2023,481 @@ PROFILE_MODE void COP2(u32 inst)
     }
 }
 
+/*** predecoded instruction handlers ***/
+
+#define OP_BRANCH(name) \
+static int op_##name(const predecoded_op* op, u32 PC) \
+{ \
+    return name(op->inst, PC); \
+}
+#define OP_SCALAR(name) \
+static int op_##name(const predecoded_op* op, u32 PC) \
+{ \
+    (void)PC; \
+    name(op->inst); \
+    return 0; \
+}
+
+OP_BRANCH(REGIMM)
+OP_BRANCH(BEQ)
+OP_BRANCH(BNE)
+OP_BRANCH(BLEZ)
+OP_BRANCH(BGTZ)
+
+OP_SCALAR(ADDIU)
+OP_SCALAR(SLTI)
+OP_SCALAR(SLTIU)
+OP_SCALAR(ANDI)
+OP_SCALAR(ORI)
+OP_SCALAR(XORI)
+OP_SCALAR(LUI)
+OP_SCALAR(LB)
+OP_SCALAR(LH)
+OP_SCALAR(LW)
+OP_SCALAR(LBU)
+OP_SCALAR(LHU)
+OP_SCALAR(SB)
+OP_SCALAR(SH)
+OP_SCALAR(SW)
+
+static int op_J(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    J(op->inst);
+    return 1;
+}
+static int op_JAL(const predecoded_op* op, u32 PC)
+{
+    JAL(op->inst, PC);
+    return 1;
+}
+
+static int op_reserved(const predecoded_op* op, u32 PC)
+{
+    (void)op;
+    (void)PC;
+    res_S();
+    return 0;
+}
+
+static int op_SLL(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rt] << op->sa;
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SRL(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = (u32)(SR[op->rt]) >> op->sa;
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SRA(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = (s32)(SR[op->rt]) >> op->sa;
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SLLV(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rt] << MASK_SA(SR[op->rs]);
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SRLV(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = (u32)(SR[op->rt]) >> MASK_SA(SR[op->rs]);
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SRAV(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = (s32)(SR[op->rt]) >> MASK_SA(SR[op->rs]);
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_JR(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    set_PC(SR[op->rs]);
+    return 1;
+}
+static int op_JALR(const predecoded_op* op, u32 PC)
+{
+    SR[op->rd] = FIT_IMEM(PC + LINK_OFF);
+    SR[zero] = 0x00000000;
+    set_PC(SR[op->rs]);
+    return 1;
+}
+static int op_BREAK(const predecoded_op* op, u32 PC)
+{
+    return SPECIAL(op->inst, PC);
+}
+static int op_ADDU(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rs] + SR[op->rt];
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SUBU(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rs] - SR[op->rt];
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_AND(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rs] & SR[op->rt];
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_OR(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rs] | SR[op->rt];
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_XOR(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = SR[op->rs] ^ SR[op->rt];
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_NOR(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = ~(SR[op->rs] | SR[op->rt]);
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SLT(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = ((s32)(SR[op->rs]) < (s32)(SR[op->rt]));
+    SR[zero] = 0x00000000;
+    return 0;
+}
+static int op_SLTU(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    SR[op->rd] = ((u32)(SR[op->rs]) < (u32)(SR[op->rt]));
+    SR[zero] = 0x00000000;
+    return 0;
+}
+
+static int op_COP0(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    COP0(op->inst);
+    return (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT) ? -1 : 0;
+}
+
+static int op_MFC2(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    MFC2(op->rt, op->rd, op->sa >> 1);
+    return 0;
+}
+static int op_CFC2(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    CFC2(op->rt, op->rd);
+    return 0;
+}
+static int op_MTC2(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    MTC2(op->rt, op->rd, op->sa >> 1);
+    return 0;
+}
+static int op_CTC2(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    CTC2(op->rt, op->rd);
+    return 0;
+}
+
+/* vector operand, no element selection */
+static int op_VEC(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+#ifdef ARCH_MIN_SSE2
+    *(v16 *)(VR[op->sa]) = op->target.vector(*(v16 *)VR[op->rd], *(v16 *)VR[op->rt]);
+#else
+    op->target.vector(&VR[op->rd][0], &VR[op->rt][0]);
+    vector_copy(&VR[op->sa][0], &V_result[0]);
+#endif
+    return 0;
+}
+
+/* quarter-vector element selection: 0Q, 1Q */
+static int op_VEC_Q(const predecoded_op* op, u32 PC)
+{
+#ifdef ARCH_MIN_SSE2
+    v16 target;
+    const unsigned int e = op->rs - 0x12;
+#else
+    register unsigned int i;
+    const unsigned int e = op->rs & 0xF;
+#endif
+
+    (void)PC;
+#ifdef ARCH_MIN_SSE2
+#ifdef __ARM_NEON__
+    target = (v16)vld1q_u16(&VR[op->rt][0 + e]);
+    target = (v16)vshlq_n_u32((uint32x4_t)target, 16);
+    target = (v16)vorrq_u16((uint16x8_t)target,
+                            (uint16x8_t)vshrq_n_u32((uint32x4_t)target, 16));
+#else
+    shuffle_temporary[0] = VR[op->rt][0 + e];
+    shuffle_temporary[2] = VR[op->rt][2 + e];
+    shuffle_temporary[4] = VR[op->rt][4 + e];
+    shuffle_temporary[6] = VR[op->rt][6 + e];
+    target = *(v16 *)(&shuffle_temporary[0]);
+    target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
+    target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(2, 2, 0, 0));
+#endif
+    *(v16 *)(VR[op->sa]) = op->target.vector(*(v16 *)VR[op->rd], target);
+#else
+    for (i = 0; i < N; i++)
+        shuffle_temporary[i] = VR[op->rt][(i & 0xE) + (e & 0x1)];
+    op->target.vector(&VR[op->rd][0], &shuffle_temporary[0]);
+    vector_copy(&VR[op->sa][0], &V_result[0]);
+#endif
+    return 0;
+}
+
+/* half-vector element selection: 0H to 3H */
+static int op_VEC_H(const predecoded_op* op, u32 PC)
+{
+#ifdef ARCH_MIN_SSE2
+    v16 target;
+    const unsigned int e = op->rs - 0x14;
+#else
+    register unsigned int i;
+    const unsigned int e = op->rs & 0xF;
+#endif
+
+    (void)PC;
+#ifdef ARCH_MIN_SSE2
+#ifdef __ARM_NEON__
+    target = (v16)vcombine_s16(vdup_n_s16(VR[op->rt][0 + e]),
+                               vdup_n_s16(VR[op->rt][4 + e]));
+#else
+    target = _mm_setzero_si128();
+    target = _mm_insert_epi16(target, VR[op->rt][0 + e], 0);
+    target = _mm_insert_epi16(target, VR[op->rt][4 + e], 4);
+    target = _mm_shufflehi_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
+    target = _mm_shufflelo_epi16(target, _MM_SHUFFLE(0, 0, 0, 0));
+#endif
+    *(v16 *)(VR[op->sa]) = op->target.vector(*(v16 *)VR[op->rd], target);
+#else
+    for (i = 0; i < N; i++)
+        shuffle_temporary[i] = VR[op->rt][(i & 0xC) + (e & 0x3)];
+    op->target.vector(&VR[op->rd][0], &shuffle_temporary[0]);
+    vector_copy(&VR[op->sa][0], &V_result[0]);
+#endif
+    return 0;
+}
+
+/* whole-vector element selection: 0W to 7W */
+static int op_VEC_W(const predecoded_op* op, u32 PC)
+{
+#ifndef ARCH_MIN_SSE2
+    register unsigned int i;
+    const unsigned int e = op->rs & 0xF;
+#endif
+
+    (void)PC;
+#ifdef ARCH_MIN_SSE2
+    *(v16 *)(VR[op->sa]) = op->target.vector(
+        *(v16 *)VR[op->rd],
+        _mm_set1_epi16(VR[op->rt][op->rs - 0x18])
+    );
+#else
+    for (i = 0; i < N; i++)
+        shuffle_temporary[i] = VR[op->rt][e % N];
+    op->target.vector(&VR[op->rd][0], &shuffle_temporary[0]);
+    vector_copy(&VR[op->sa][0], &V_result[0]);
+#endif
+    return 0;
+}
+
+static int op_MWC2(const predecoded_op* op, u32 PC)
+{
+    (void)PC;
+    op->target.transfer(op->rt, op->sa, op->offset, op->rs);
+    return 0;
+}
+
+static int op_decode(const predecoded_op* op, u32 PC);
+
+static p_op_func decode_SPECIAL(u32 inst)
+{
+    switch (inst % 64) {
+    case 000:  return op_SLL;
+    case 002:  return op_SRL;
+    case 003:  return op_SRA;
+    case 004:  return op_SLLV;
+    case 006:  return op_SRLV;
+    case 007:  return op_SRAV;
+    case 010:  return op_JR;
+    case 011:  return op_JALR;
+    case 015:  return op_BREAK;
+    case 040:
+    case 041:  return op_ADDU;
+    case 042:
+    case 043:  return op_SUBU;
+    case 044:  return op_AND;
+    case 045:  return op_OR;
+    case 046:  return op_XOR;
+    case 047:  return op_NOR;
+    case 052:  return op_SLT;
+    case 053:  return op_SLTU;
+    default:   return op_reserved;
+    }
+}
+
+static p_op_func decode_COP2(predecoded_op* op)
+{
+    op->target.vector = COP2_C2[op->inst % (1 << 6)];
+
+    switch (op->rs) {
+    case 000:  return op_MFC2;
+    case 002:  return op_CFC2;
+    case 004:  return op_MTC2;
+    case 006:  return op_CTC2;
+    case 020:
+    case 021:  return op_VEC;
+    case 022:
+    case 023:  return op_VEC_Q;
+    case 024:
+    case 025:
+    case 026:
+    case 027:  return op_VEC_H;
+    case 030:
+    case 031:
+    case 032:
+    case 033:
+    case 034:
+    case 035:
+    case 036:
+    case 037:  return op_VEC_W;
+    default:   return op_reserved;
+    }
+}
+
+static void decode_op(predecoded_op* op, u32 inst)
+{
+    const u32 offset = inst % 128; /* LWC2 and SWC2 offsets are 7-bit */
+
+    op->inst   = inst;
+    op->rs     = (inst >> 21) % (1 << 5);
+    op->rt     = (inst >> 16) % (1 << 5);
+    op->rd     = (inst >> 11) % (1 << 5);
+    op->sa     = (inst >>  6) % (1 << 5);
+    op->offset = (s16)((offset & 64) ? (s32)offset - 128 : (s32)offset);
+
+    switch (inst >> 26) {
+    case 000:  op->func = decode_SPECIAL(inst);  break;
+    case 001:  op->func = op_REGIMM;  break;
+    case 002:  op->func = op_J;  break;
+    case 003:  op->func = op_JAL;  break;
+    case 004:  op->func = op_BEQ;  break;
+    case 005:  op->func = op_BNE;  break;
+    case 006:  op->func = op_BLEZ;  break;
+    case 007:  op->func = op_BGTZ;  break;
+    case 010: /* ADDI:  Traps don't exist on the RCP. */
+    case 011:  op->func = op_ADDIU;  break;
+    case 012:  op->func = op_SLTI;  break;
+    case 013:  op->func = op_SLTIU;  break;
+    case 014:  op->func = op_ANDI;  break;
+    case 015:  op->func = op_ORI;  break;
+    case 016:  op->func = op_XORI;  break;
+    case 017:  op->func = op_LUI;  break;
+    case 020:  op->func = op_COP0;  break;
+    case 022:  op->func = decode_COP2(op);  break;
+    case 040:  op->func = op_LB;  break;
+    case 041:  op->func = op_LH;  break;
+    case 043:  op->func = op_LW;  break;
+    case 044:  op->func = op_LBU;  break;
+    case 045:  op->func = op_LHU;  break;
+    case 050:  op->func = op_SB;  break;
+    case 051:  op->func = op_SH;  break;
+    case 053:  op->func = op_SW;  break;
+    case 062: /* LWC2 */
+        op->sa = (inst >> 7) % (1 << 4);
+        op->target.transfer = LWC2[op->rd];
+        op->func = op_MWC2;
+        break;
+    case 072: /* SWC2 */
+        op->sa = (inst >> 7) % (1 << 4);
+        op->target.transfer = SWC2[op->rd];
+        op->func = op_MWC2;
+        break;
+    default:   op->func = op_reserved;
+    }
+}
+
+/* handler of slots not decoded yet, or whose word changed */
+static int op_decode(const predecoded_op* op, u32 PC)
+{
+    const unsigned int slot = (unsigned int)(op - &predecoded_IMEM[0]);
+    predecoded_op* decoded = &predecoded_IMEM[slot];
+
+    decode_op(decoded, *(pu32)(IMEM + 4*slot));
+    inst_word = decoded->inst; /* run_task() read it before the decode */
+    return decoded->func(decoded, PC);
+}
+
+static void check_predecoded_IMEM(void)
+{
+    register unsigned int slot;
+
+    for (slot = 0; slot < 0x1000 / 4; slot++)
+        if (predecoded_IMEM[slot].func == NULL
+         || predecoded_IMEM[slot].inst != *(pu32)(IMEM + 4*slot))
+            predecoded_IMEM[slot].func = op_decode;
+}
+
 NOINLINE void run_task(void)
 {
     register u32 PC;
+    register const predecoded_op* op;
+#ifdef PREDECODE_TEST
+    predecoded_op fetched;
+#endif
+
+    check_predecoded_IMEM();
 
     PC = FIT_IMEM(GET_RCP_REG(SP_PC_REG));
     for (;;) {
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
+        op = FETCH_OP(PC);
 #ifdef EMULATE_STATIC_PC
         PC = (PC + 0x004);
 EX:
 #endif
+        inst_word = op->inst;
 #ifdef SP_EXECUTE_LOG
         step_SP_commands(inst_word);
 #endif
 
-#if (0 != 0)
-        if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
-            goto RSP_halted_CPU_exit_point; /* Only BREAK and COP0 set this. */
-        SR[zero] = 0x00000000; /* already handled on per-instruction basis */
-#endif
-        switch (inst_word >> 26) {
-        case 000: /* SPECIAL */
-            switch (SPECIAL(inst_word, PC)) {
-            case -1: /* BREAK */
-                goto RSP_halted_CPU_exit_point;
-            case +1: /* JR and JALR */
-                JUMP;
-            }
-            break;
-        case 001: /* REGIMM */
-            if (REGIMM(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 002:
-            J(inst_word);
-            JUMP;
-        case 003:
-            JAL(inst_word, PC);
+        switch (op->func(op, PC)) {
+        case -1: /* BREAK, or COP0 halted the RSP */
+            goto RSP_halted_CPU_exit_point;
+        case +1: /* branch or jump taken */
             JUMP;
-        case 004:
-            if (BEQ(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 005:
-            if (BNE(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 006:
-            if (BLEZ(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 007:
-            if (BGTZ(inst_word, PC) != 0)
-                JUMP;
-            break;
-        case 010: /* ADDI:  Traps don't exist on the RCP. */
-        case 011:
-            ADDIU(inst_word);
-            break;
-        case 012:
-            SLTI(inst_word);
-            break;
-        case 013:
-            SLTIU(inst_word);
-            break;
-        case 014:
-            ANDI(inst_word);
-            break;
-        case 015:
-            ORI(inst_word);
-            break;
-        case 016:
-            XORI(inst_word);
-            break;
-        case 017:
-            LUI(inst_word);
-            break;
-        case 020:
-            COP0(inst_word);
-            if (GET_RCP_REG(SP_STATUS_REG) & SP_STATUS_HALT)
-                goto RSP_halted_CPU_exit_point;
-            break;
-        case 022:
-            COP2(inst_word);
-            break;
-        case 040:
-            LB(inst_word);
-            break;
-        case 041:
-            LH(inst_word);
-            break;
-        case 043:
-            LW(inst_word);
-            break;
-        case 044:
-            LBU(inst_word);
-            break;
-        case 045:
-            LHU(inst_word);
-            break;
-        case 050:
-            SB(inst_word);
-            break;
-        case 051:
-            SH(inst_word);
-            break;
-        case 053:
-            SW(inst_word);
-            break;
-        case 062: /* LWC2 */
-            MWC2_load(inst_word);
-            break;
-        case 072: /* SWC2 */
-            MWC2_store(inst_word);
-            break;
-        default:
-            res_S();
         }
 
 #ifndef EMULATE_STATIC_PC
@@ -2111,7 +2513,7 @@ EX:
 #else
         continue;
 set_branch_delay:
-        inst_word = *(pi32)(IMEM + FIT_IMEM(PC));
+        op = FETCH_OP(PC);
         PC = FIT_IMEM(temp_PC);
         goto EX;
 #endif
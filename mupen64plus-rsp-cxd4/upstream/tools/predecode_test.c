@@ -0,0 +1,446 @@
+/******************************************************************************\
+* Project:  Parity Test of the Predecoded IMEM Against Decoding Every Fetch    *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * su.c is built with PREDECODE_TEST and linked against the vector unit
+ * objects of the plugin.  Every task is run twice from the same state:  once
+ * from predecoded_IMEM, and once with predecode_bypass set, decoding each
+ * word as it is fetched.  Scalar and vector registers, flags, DMEM, IMEM and
+ * the RCP registers must match afterwards.
+ *
+ * The pseudo random microcode DMAs DRAM over IMEM, often just ahead of the
+ * PC, and between tasks the harness writes IMEM the way the CPU does through
+ * SP_IMEM, or uploads the whole program again.  The predecoded slots are
+ * kept across tasks, so stale ones are executed if either invalidation is
+ * missed.
+ *
+ * Whatever ends up in IMEM always comes from the same generator, so that no
+ * word can loop or DMA out of bounds:  branches only go forward, jumps only
+ * go to the BREAK words at the end of IMEM, and DMA registers are only ever
+ * moved to from $26, $27 and $28, which keep safe values.  No DMA back to
+ * DRAM is generated, so DRAM stays made of those words.  VRCP, VRSQ and the
+ * like are left out because divide.c keeps state the harness cannot save.
+ *
+ * Build and run with "make test" in projects/unix.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "su.h"
+#include "vu/vu.h"
+
+#define PROGRAMS    200
+#define TASKS       50
+
+#define CODE_END    0xF00 /* IMEM from here on is BREAK */
+#define DRAM_SIZE   0x11000
+#define DMA_MAX     0x100
+
+enum { REG_MEM = 26, REG_DRAM = 27, REG_LEN = 28 };
+
+extern int predecode_bypass;
+
+RSP_INFO RSP_INFO_NAME;
+p_func GBI_phase;
+
+NOINLINE void message(const char* body)
+{
+    (void)body;
+    return;
+}
+
+static void no_op(void)
+{
+    return;
+}
+
+static struct {
+    unsigned int MI_INTR;
+    unsigned int SP_MEM_ADDR, SP_DRAM_ADDR, SP_RD_LEN, SP_WR_LEN;
+    unsigned int SP_STATUS, SP_DMA_FULL, SP_DMA_BUSY, SP_PC, SP_SEMAPHORE;
+    unsigned int DPC_START, DPC_END, DPC_CURRENT, DPC_STATUS;
+    unsigned int DPC_CLOCK, DPC_BUFBUSY, DPC_PIPEBUSY, DPC_TMEM;
+} regs;
+
+ALIGNED static u8 dram[DRAM_SIZE];
+ALIGNED static u8 SP_mem[0x2000]; /* DMA goes past DMEM into IMEM */
+#define dmem    (SP_mem + 0x0000)
+#define imem    (SP_mem + 0x1000)
+static u32 program[0x1000 / 4];
+
+typedef struct {
+    u32 SR[32];
+    ALIGNED i16 VR[32][N << VR_STATIC_WRAPAROUND];
+    ALIGNED i16 VACC[3][N];
+    ALIGNED i16 cf_ne[N], cf_co[N], cf_clip[N], cf_comp[N], cf_vce[N];
+    ALIGNED u8 DMEM[0x1000];
+    ALIGNED u8 IMEM[0x1000];
+    unsigned int regs[sizeof(regs) / sizeof(unsigned int)];
+} rsp_state;
+
+static rsp_state start, predecoded, decoded;
+
+static void save(rsp_state* state)
+{
+    memcpy(state->SR, SR, sizeof(SR));
+    memcpy(state->VR, VR, sizeof(VR));
+    memcpy(state->VACC, VACC, sizeof(VACC));
+    memcpy(state->cf_ne, cf_ne, sizeof(cf_ne));
+    memcpy(state->cf_co, cf_co, sizeof(cf_co));
+    memcpy(state->cf_clip, cf_clip, sizeof(cf_clip));
+    memcpy(state->cf_comp, cf_comp, sizeof(cf_comp));
+    memcpy(state->cf_vce, cf_vce, sizeof(cf_vce));
+    memcpy(state->DMEM, dmem, 0x1000);
+    memcpy(state->IMEM, imem, 0x1000);
+    memcpy(state->regs, &regs, sizeof(regs));
+}
+
+static void restore(const rsp_state* state)
+{
+    memcpy(SR, state->SR, sizeof(SR));
+    memcpy(VR, state->VR, sizeof(VR));
+    memcpy(VACC, state->VACC, sizeof(VACC));
+    memcpy(cf_ne, state->cf_ne, sizeof(cf_ne));
+    memcpy(cf_co, state->cf_co, sizeof(cf_co));
+    memcpy(cf_clip, state->cf_clip, sizeof(cf_clip));
+    memcpy(cf_comp, state->cf_comp, sizeof(cf_comp));
+    memcpy(cf_vce, state->cf_vce, sizeof(cf_vce));
+    memcpy(dmem, state->DMEM, 0x1000);
+    memcpy(imem, state->IMEM, 0x1000);
+    memcpy(&regs, state->regs, sizeof(regs));
+}
+
+static void init_RSP(void)
+{
+    RSP_INFO_NAME.RDRAM = dram;
+    RSP_INFO_NAME.DMEM = dmem;
+    RSP_INFO_NAME.IMEM = imem;
+    RSP_INFO_NAME.MI_INTR_REG = &regs.MI_INTR;
+    RSP_INFO_NAME.SP_MEM_ADDR_REG = &regs.SP_MEM_ADDR;
+    RSP_INFO_NAME.SP_DRAM_ADDR_REG = &regs.SP_DRAM_ADDR;
+    RSP_INFO_NAME.SP_RD_LEN_REG = &regs.SP_RD_LEN;
+    RSP_INFO_NAME.SP_WR_LEN_REG = &regs.SP_WR_LEN;
+    RSP_INFO_NAME.SP_STATUS_REG = &regs.SP_STATUS;
+    RSP_INFO_NAME.SP_DMA_FULL_REG = &regs.SP_DMA_FULL;
+    RSP_INFO_NAME.SP_DMA_BUSY_REG = &regs.SP_DMA_BUSY;
+    RSP_INFO_NAME.SP_PC_REG = &regs.SP_PC;
+    RSP_INFO_NAME.SP_SEMAPHORE_REG = &regs.SP_SEMAPHORE;
+    RSP_INFO_NAME.DPC_START_REG = &regs.DPC_START;
+    RSP_INFO_NAME.DPC_END_REG = &regs.DPC_END;
+    RSP_INFO_NAME.DPC_CURRENT_REG = &regs.DPC_CURRENT;
+    RSP_INFO_NAME.DPC_STATUS_REG = &regs.DPC_STATUS;
+    RSP_INFO_NAME.DPC_CLOCK_REG = &regs.DPC_CLOCK;
+    RSP_INFO_NAME.DPC_BUFBUSY_REG = &regs.DPC_BUFBUSY;
+    RSP_INFO_NAME.DPC_PIPEBUSY_REG = &regs.DPC_PIPEBUSY;
+    RSP_INFO_NAME.DPC_TMEM_REG = &regs.DPC_TMEM;
+    RSP_INFO_NAME.CheckInterrupts = no_op;
+    RSP_INFO_NAME.ProcessDlistList = no_op;
+    RSP_INFO_NAME.ProcessAlistList = no_op;
+    RSP_INFO_NAME.ProcessRdpList = no_op;
+    RSP_INFO_NAME.ShowCFB = no_op;
+    GBI_phase = no_op;
+
+    DRAM = dram;
+    DMEM = dmem;
+    IMEM = imem;
+    CR[0x0] = &regs.SP_MEM_ADDR;
+    CR[0x1] = &regs.SP_DRAM_ADDR;
+    CR[0x2] = &regs.SP_RD_LEN;
+    CR[0x3] = &regs.SP_WR_LEN;
+    CR[0x4] = &regs.SP_STATUS;
+    CR[0x5] = &regs.SP_DMA_FULL;
+    CR[0x6] = &regs.SP_DMA_BUSY;
+    CR[0x7] = &regs.SP_SEMAPHORE;
+    CR[0x8] = &regs.DPC_START;
+    CR[0x9] = &regs.DPC_END;
+    CR[0xA] = &regs.DPC_CURRENT;
+    CR[0xB] = &regs.DPC_STATUS;
+    CR[0xC] = &regs.DPC_CLOCK;
+    CR[0xD] = &regs.DPC_BUFBUSY;
+    CR[0xE] = &regs.DPC_PIPEBUSY;
+    CR[0xF] = &regs.DPC_TMEM;
+    MF_SP_STATUS_TIMEOUT = 32767;
+}
+
+/*
+ * xorshift32, so that runs are reproducible whatever the libc
+ */
+static u32 seed = 0x2545F491;
+
+static u32 rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed);
+}
+
+static void rnd_fill(void* buffer, size_t size)
+{
+    register size_t i;
+
+    for (i = 0; i < size / 4; i++)
+        ((pu32)buffer)[i] = rnd();
+}
+
+/*
+ * any scalar register but the three holding DMA register values
+ */
+static unsigned int rnd_gpr(void)
+{
+    register unsigned int gpr;
+
+    gpr = rnd() % 29;
+    return (gpr < REG_MEM) ? gpr : gpr + 3;
+}
+
+#define R_TYPE(rs, rt, rd, sa, funct) \
+    ((u32)(rs) << 21 | (u32)(rt) << 16 | (u32)(rd) << 11 | (u32)(sa) << 6 | (funct))
+#define I_TYPE(op, rs, rt, imm) \
+    ((u32)(op) << 26 | (u32)(rs) << 21 | (u32)(rt) << 16 | ((imm) & 0xFFFFu))
+#define BREAK_WORD  R_TYPE(0, 0, 0, 0, 015)
+
+static u32 rnd_DMA_value(unsigned int reg, unsigned int PC)
+{
+    unsigned int length, count, ahead;
+
+    switch (reg) {
+    case REG_MEM:
+        if (rnd() % 2)
+            return (rnd() % (CODE_END - DMA_MAX + 8)) & ~7u;
+        ahead = (PC + 8 + rnd() % 0x100) & ~7u; /* code not run yet */
+        if (ahead > CODE_END - DMA_MAX)
+            ahead = (rnd() % (CODE_END - DMA_MAX + 8)) & ~7u;
+        return 0x1000 | ahead;
+    case REG_DRAM:
+        return (rnd() % 0x10000) & ~7u;
+    default:
+        length = 8 * (1 + rnd() % (DMA_MAX / 8));
+        count = rnd() % (DMA_MAX / length);
+        return (count << 12) | (length - 1);
+    }
+}
+
+/*
+ * one instruction, or an ORI and MTC0 pair setting a DMA register, which
+ * starts the transfer when it is SP_RD_LEN
+ */
+static unsigned int rnd_code(pu32 code, unsigned int PC)
+{
+    static const unsigned char specials[] = {
+        000, 002, 003, 004, 006, 007, 040, 041, 042, 043,
+        044, 045, 046, 047, 052, 053,
+    };
+    static const unsigned char immediates[] = {
+        010, 011, 012, 013, 014, 015, 016, 017,
+    };
+    static const unsigned char loads_stores[] = {
+        040, 041, 043, 044, 045, 050, 051, 053,
+    };
+    static const unsigned char regimms[] = { 000, 001, 020, 021, };
+    static const unsigned char readable_CR[] = { 0, 1, 2, 3, 5, 6, };
+    unsigned int choice, reg, funct;
+
+    choice = rnd() % 100;
+    if (choice < 8) {
+        reg = REG_MEM + rnd() % 3;
+        code[0] = I_TYPE(015, 0, reg, rnd_DMA_value(reg, PC));
+        code[1] = 020u << 26 | 004u << 21 | (u32)reg << 16 | (reg - REG_MEM) << 11;
+        return 2;
+    }
+    if (choice < 18) {
+        const u32 offset = 1 + rnd() % 63; /* from CODE_END - 4, lands in BREAK */
+
+        switch (rnd() % 5) {
+        case 0:
+            code[0] = I_TYPE(001, rnd() % 32, regimms[rnd() % 4], offset);
+            break;
+        default:
+            code[0] = I_TYPE(004 + rnd() % 4, rnd() % 32, rnd() % 32, offset);
+        }
+        return 1;
+    }
+    if (choice < 20) {
+        code[0] = (002u + rnd() % 2) << 26 | (CODE_END + 4*(rnd() % 64)) >> 2;
+        return 1;
+    }
+    if (choice < 23) {
+        code[0] = 020u << 26 | (u32)rnd_gpr() << 16
+          | (u32)readable_CR[rnd() % sizeof(readable_CR)] << 11;
+        return 1;
+    }
+    if (choice < 40) {
+        do {
+            funct = rnd() % 64;
+        } while (funct >= 060 && funct < 067); /* divide.c keeps state */
+        code[0] = 022u << 26 | 1u << 25 | (rnd() % 16) << 21
+          | (rnd() % 32) << 16 | (rnd() % 32) << 11 | (rnd() % 32) << 6 | funct;
+        return 1;
+    }
+    if (choice < 46) {
+        code[0] = 022u << 26 | (2*(rnd() % 4)) << 21 | (u32)rnd_gpr() << 16
+          | (rnd() % 32) << 11 | (rnd() % 16) << 7;
+        return 1;
+    }
+    if (choice < 58) {
+        code[0] = (rnd() % 2 ? 062u : 072u) << 26 | (rnd() % 32) << 21
+          | (rnd() % 32) << 16 | (rnd() % 12) << 11 | (rnd() % 16) << 7
+          | (rnd() % 128);
+        return 1;
+    }
+    if (choice < 70) {
+        const unsigned int op = loads_stores[rnd() % sizeof(loads_stores)];
+
+        code[0] = I_TYPE(op, rnd() % 32, op < 050 ? rnd_gpr() : rnd() % 32, rnd());
+        return 1;
+    }
+    if (choice < 82) {
+        code[0] = I_TYPE(immediates[rnd() % sizeof(immediates)],
+            rnd() % 32, rnd_gpr(), rnd());
+        return 1;
+    }
+    code[0] = R_TYPE(rnd() % 32, rnd() % 32, rnd_gpr(), rnd() % 32,
+        specials[rnd() % sizeof(specials)]);
+    return 1;
+}
+
+static void rnd_program(void)
+{
+    u32 code[2];
+    register unsigned int PC, words;
+
+    for (PC = 0; PC < CODE_END; PC += 4*words) {
+        words = rnd_code(code, PC);
+        if (PC + 4*words > CODE_END)
+            words = 1;
+        memcpy(&program[PC / 4], code, 4*words);
+    }
+    for (PC = CODE_END; PC < 0x1000; PC += 4)
+        program[PC / 4] = BREAK_WORD;
+}
+
+static void rnd_DRAM(void)
+{
+    u32 code[2];
+    register unsigned int addr, words;
+
+    for (addr = 0; addr < DRAM_SIZE; addr += 4*words) {
+        words = rnd_code(code, rnd() % CODE_END);
+        if (addr + 4*words > DRAM_SIZE)
+            words = 1;
+        memcpy(dram + addr, code, 4*words);
+    }
+}
+
+/*
+ * what the CPU does to the RSP between two tasks
+ */
+static void CPU_writes(void)
+{
+    u32 code[2];
+    register unsigned int i, count, PC;
+
+    switch (rnd() % 8) {
+    case 0: /* microcode uploaded again */
+        memcpy(imem, program, 0x1000);
+        break;
+    case 1:
+    case 2:
+    case 3:
+    case 4: /* SP_IMEM stores */
+        count = 1 + rnd() % 8;
+        for (i = 0; i < count; i++) {
+            PC = 4 * (rnd() % (CODE_END / 4));
+            rnd_code(code, PC);
+            *(pu32)(imem + PC) = code[0];
+        }
+        break;
+    }
+
+    for (i = 0; i < 32; i++)
+        if (rnd() % 4 == 0 && i != REG_MEM && i != REG_DRAM && i != REG_LEN)
+            SR[i] = rnd();
+    SR[0] = 0x00000000;
+    regs.SP_STATUS = 0x00000000;
+    regs.SP_PC = (rnd() % 4) ? 0x000 : 4 * (rnd() % (CODE_END / 4));
+}
+
+static const char* first_difference(const rsp_state* a, const rsp_state* b)
+{
+#define DIFFERS(member) \
+    if (memcmp(a->member, b->member, sizeof(a->member)) != 0) return #member
+    DIFFERS(SR);
+    DIFFERS(VR);
+    DIFFERS(VACC);
+    DIFFERS(cf_ne);
+    DIFFERS(cf_co);
+    DIFFERS(cf_clip);
+    DIFFERS(cf_comp);
+    DIFFERS(cf_vce);
+    DIFFERS(DMEM);
+    DIFFERS(IMEM);
+    DIFFERS(regs);
+#undef DIFFERS
+    return NULL;
+}
+
+int main(void)
+{
+    const char* difference;
+    unsigned int programs, tasks, start_PC;
+    unsigned int failures = 0;
+
+    init_RSP();
+    rnd_DRAM();
+
+    for (programs = 0; programs < PROGRAMS && failures == 0; programs++) {
+        rnd_program();
+        memcpy(imem, program, 0x1000);
+        rnd_fill(dmem, 0x1000);
+        rnd_fill(VR, sizeof(VR));
+        rnd_fill(SR, sizeof(SR));
+        SR[REG_MEM] = SR[REG_DRAM] = SR[REG_LEN] = 0x00000000;
+
+        for (tasks = 0; tasks < TASKS; tasks++) {
+            CPU_writes();
+            start_PC = regs.SP_PC;
+            save(&start);
+
+            predecode_bypass = 0;
+            run_task();
+            save(&predecoded);
+
+            restore(&start);
+            predecode_bypass = 1;
+            run_task();
+            save(&decoded);
+
+            difference = first_difference(&predecoded, &decoded);
+            if (difference == NULL) {
+                restore(&predecoded);
+                continue;
+            }
+            printf(
+                "FAIL: program %u, task %u from PC 0x%03X:  %s differs "
+                "from decoding every fetch\n",
+                programs, tasks, start_PC, difference);
+            ++failures;
+            break;
+        }
+    }
+
+    if (failures == 0)
+        printf("predecode parity test passed\n");
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+/******************************************************************************\
+* Project:  Scalar Build Renames for the Vector Multiply Parity Test          *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * Forced into the second build of vu/multiply.c, made without ARCH_MIN_SSE2,
+ * which simd_parity_test.c checks the SSE2 or NEON build against.  Its
+ * operations and the VU state it works on get a scalar_ prefix, so that both
+ * builds can be linked into the same program.
+ */
+#ifndef _SIMD_PARITY_H_
+#define _SIMD_PARITY_H_
+
+#define VACC        scalar_VACC
+#define V_result    scalar_V_result
+
+#define mulf_v_msp  scalar_mulf_v_msp
+#define mulu_v_msp  scalar_mulu_v_msp
+#define mudl_v_msp  scalar_mudl_v_msp
+#define mudm_v_msp  scalar_mudm_v_msp
+#define mudn_v_msp  scalar_mudn_v_msp
+#define mudh_v_msp  scalar_mudh_v_msp
+#define macf_v_msp  scalar_macf_v_msp
+#define macu_v_msp  scalar_macu_v_msp
+#define madl_v_msp  scalar_madl_v_msp
+#define madm_v_msp  scalar_madm_v_msp
+#define madn_v_msp  scalar_madn_v_msp
+#define madh_v_msp  scalar_madh_v_msp
+
+#endif
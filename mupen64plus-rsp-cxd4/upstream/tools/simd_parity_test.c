@@ -0,0 +1,195 @@
+/******************************************************************************\
+* Project:  Parity Test of the SIMD Vector Multiplies Against the Scalar Ones  *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * vu/multiply.c is linked twice:  as built for the plugin (SSE2 on x86, the
+ * native NEON paths on ARM with NEON=1) and a second time without
+ * ARCH_MIN_SSE2, with its symbols renamed by simd_parity.h.  Every VMUL*,
+ * VMUD*, VMAC* and VMAD* operation is run through both on the same pseudo
+ * random operands and accumulator, with the 0x8000 and 0x7FFF corner cases
+ * and accumulators near the clamp limits mixed in.  Results and
+ * accumulators must match.
+ *
+ * Build and run with "make test" in projects/unix.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "vu/multiply.h"
+
+#define SEQUENCES   20000
+#define SEQUENCE_OPS    16
+
+ALIGNED i16 VACC[3][N];
+#ifndef ARCH_MIN_SSE2
+ALIGNED i16 V_result[N];
+#endif
+
+/*
+ * the scalar build, see simd_parity.h
+ */
+ALIGNED i16 scalar_VACC[3][N];
+ALIGNED i16 scalar_V_result[N];
+
+typedef VECTOR_OPERATION (*vector_op)(v16, v16);
+typedef void (*scalar_op)(pi16, pi16);
+
+extern void scalar_mulf_v_msp(pi16 vs, pi16 vt);
+extern void scalar_mulu_v_msp(pi16 vs, pi16 vt);
+extern void scalar_mudl_v_msp(pi16 vs, pi16 vt);
+extern void scalar_mudm_v_msp(pi16 vs, pi16 vt);
+extern void scalar_mudn_v_msp(pi16 vs, pi16 vt);
+extern void scalar_mudh_v_msp(pi16 vs, pi16 vt);
+extern void scalar_macf_v_msp(pi16 vs, pi16 vt);
+extern void scalar_macu_v_msp(pi16 vs, pi16 vt);
+extern void scalar_madl_v_msp(pi16 vs, pi16 vt);
+extern void scalar_madm_v_msp(pi16 vs, pi16 vt);
+extern void scalar_madn_v_msp(pi16 vs, pi16 vt);
+extern void scalar_madh_v_msp(pi16 vs, pi16 vt);
+
+static const struct {
+    const char* name;
+    vector_op simd;
+    scalar_op scalar;
+} ops[] = {
+    { "VMULF", VMULF, scalar_mulf_v_msp },
+    { "VMULU", VMULU, scalar_mulu_v_msp },
+    { "VMUDL", VMUDL, scalar_mudl_v_msp },
+    { "VMUDM", VMUDM, scalar_mudm_v_msp },
+    { "VMUDN", VMUDN, scalar_mudn_v_msp },
+    { "VMUDH", VMUDH, scalar_mudh_v_msp },
+    { "VMACF", VMACF, scalar_macf_v_msp },
+    { "VMACU", VMACU, scalar_macu_v_msp },
+    { "VMADL", VMADL, scalar_madl_v_msp },
+    { "VMADM", VMADM, scalar_madm_v_msp },
+    { "VMADN", VMADN, scalar_madn_v_msp },
+    { "VMADH", VMADH, scalar_madh_v_msp },
+};
+#define OP_COUNT    (sizeof(ops) / sizeof(ops[0]))
+
+/*
+ * xorshift32, so that runs are reproducible whatever the libc
+ */
+static u32 seed = 0x2545F491;
+
+static u32 rnd(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed);
+}
+
+static i16 rnd_element(void)
+{
+    static const u16 corners[] = {
+        0x0000, 0x0001, 0x7FFF, 0x8000, 0x8001, 0xFFFF, 0x4000, 0xC000,
+    };
+
+    if (rnd() % 4 == 0)
+        return (i16)corners[rnd() % (sizeof(corners) / sizeof(corners[0]))];
+    return (i16)rnd();
+}
+
+static void rnd_vector(i16* v)
+{
+    register int i;
+
+    for (i = 0; i < N; i++)
+        v[i] = rnd_element();
+}
+
+static void run_simd(vector_op op, i16* VD, i16* VS, i16* VT)
+{
+#ifdef ARCH_MIN_SSE2
+    *(v16 *)VD = op(*(v16 *)VS, *(v16 *)VT);
+#else
+    op(VS, VT);
+    memcpy(VD, V_result, sizeof(V_result));
+#endif
+}
+
+static void dump(const char* what, const i16* v)
+{
+    register int i;
+
+    printf("    %-14s", what);
+    for (i = 0; i < N; i++)
+        printf(" %04X", (u16)v[i]);
+    printf("\n");
+}
+
+int main(void)
+{
+    ALIGNED i16 VS[N], VT[N], VD[N], scalar_VD[N];
+    ALIGNED i16 acc[3][N];
+    unsigned int sequence, k;
+    unsigned int failures = 0;
+
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    printf("checking NEON vector multiplies\n");
+#elif defined(ARCH_MIN_SSE2)
+    printf("checking SSE2 vector multiplies\n");
+#else
+    printf("no SIMD build, checking the scalar vector multiplies against themselves\n");
+#endif
+
+    for (sequence = 0; sequence < SEQUENCES && failures == 0; sequence++) {
+        rnd_vector(VACC[HI]);
+        rnd_vector(VACC[MD]);
+        rnd_vector(VACC[LO]);
+        memcpy(scalar_VACC, VACC, sizeof(VACC));
+
+/*
+ * Several operations in a row, to also check them on the accumulators left
+ * by one another rather than only on random ones.
+ */
+        for (k = 0; k < SEQUENCE_OPS; k++) {
+            const unsigned int op = rnd() % OP_COUNT;
+
+            memcpy(acc, VACC, sizeof(acc));
+            rnd_vector(VS);
+            rnd_vector(VT);
+
+            run_simd(ops[op].simd, VD, VS, VT);
+            ops[op].scalar(VS, VT);
+            memcpy(scalar_VD, scalar_V_result, sizeof(scalar_VD));
+
+            if (memcmp(VD, scalar_VD, sizeof(VD)) == 0
+             && memcmp(VACC, scalar_VACC, sizeof(VACC)) == 0)
+                continue;
+
+            printf("FAIL: %s differs from the scalar build\n", ops[op].name);
+            dump("VS", VS);
+            dump("VT", VT);
+            dump("ACC HI in", acc[HI]);
+            dump("ACC MD in", acc[MD]);
+            dump("ACC LO in", acc[LO]);
+            dump("VD", VD);
+            dump("VD scalar", scalar_VD);
+            dump("ACC HI", VACC[HI]);
+            dump("ACC HI scalar", scalar_VACC[HI]);
+            dump("ACC MD", VACC[MD]);
+            dump("ACC MD scalar", scalar_VACC[MD]);
+            dump("ACC LO", VACC[LO]);
+            dump("ACC LO scalar", scalar_VACC[LO]);
+            ++failures;
+            break;
+        }
+    }
+
+    if (failures == 0)
+        printf("simd parity test passed\n");
+    return (failures == 0) ? 0 : 1;
+}
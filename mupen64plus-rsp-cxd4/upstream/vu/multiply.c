@@ -26,6 +26,81 @@
 #define _mm_mullo_epu16(dst, src) \
     _mm_mullo_epi16(dst, src)
 
+#ifdef __ARM_NEON__
+/*
+ * SSE2NEON has to emulate the unsigned compares and the interleaving packs
+ * which the SSE2 paths rely on with several NEON instructions each, so ARM
+ * builds take these native NEON paths instead.  The accumulator slices are
+ * zipped into 32-bit lanes where NEON can add and saturate them directly.
+ */
+static INLINE int16x8_t neon_clamp_am(int16x8_t acc_md, int16x8_t acc_hi)
+{ /* signed clamp of accumulator bits 47:16 */
+    int16x8x2_t acc;
+
+    acc = vzipq_s16(acc_md, acc_hi);
+    return vcombine_s16(
+        vqmovn_s32((int32x4_t)acc.val[0]),
+        vqmovn_s32((int32x4_t)acc.val[1]));
+}
+
+static INLINE int16x8_t neon_clamp_al(
+    int16x8_t acc_lo, int16x8_t acc_md, int16x8_t acc_hi)
+{ /* acc_lo unless bits 47:16 need clamping, matching SIGNED_CLAMP_AL */
+    int16x8_t clamped;
+    uint16x8_t in_range;
+
+    clamped = neon_clamp_am(acc_md, acc_hi);
+    in_range = vceqq_s16(clamped, acc_md);
+    clamped = veorq_s16(clamped, vdupq_n_s16((i16)0x8000));
+    return vbslq_s16(in_range, acc_lo, clamped);
+}
+
+static INLINE void neon_mul_su(
+    int32x4_t* prod_0, int32x4_t* prod_1, int16x8_t vs, int16x8_t vt)
+{ /* (s16)vs * (u16)vt as 32-bit products */
+    *prod_0 = vmulq_s32(
+        vmovl_s16(vget_low_s16(vs)),
+        (int32x4_t)vmovl_u16(vget_low_u16((uint16x8_t)vt)));
+    *prod_1 = vmulq_s32(
+        vmovl_s16(vget_high_s16(vs)),
+        (int32x4_t)vmovl_u16(vget_high_u16((uint16x8_t)vt)));
+}
+
+static INLINE void neon_accumulate(
+    int32x4_t addend_0, int32x4_t addend_1, int32x4_t sign_0, int32x4_t sign_1)
+{ /* 48-bit accumulator += sign-extended 33-bit addend */
+    int16x8x2_t acc;
+    int16x8_t acc_hi;
+    uint32x4_t sum_0, sum_1;
+    int32x4_t carry_0, carry_1;
+
+    acc = vzipq_s16(vld1q_s16(VACC_L), vld1q_s16(VACC_M));
+    acc_hi = vld1q_s16(VACC_H);
+
+    sum_0 = vaddq_u32((uint32x4_t)acc.val[0], (uint32x4_t)addend_0);
+    sum_1 = vaddq_u32((uint32x4_t)acc.val[1], (uint32x4_t)addend_1);
+    carry_0 = (int32x4_t)vcltq_u32(sum_0, (uint32x4_t)acc.val[0]);
+    carry_1 = (int32x4_t)vcltq_u32(sum_1, (uint32x4_t)acc.val[1]);
+
+/*
+ * Both the sign and the carry out of bit 31 are ~0 or 0, so bits 47:32 just
+ * have to subtract the carry from the sign extension of the addend.
+ */
+    acc_hi = vaddq_s16(acc_hi, vcombine_s16(
+        vmovn_s32(vsubq_s32(sign_0, carry_0)),
+        vmovn_s32(vsubq_s32(sign_1, carry_1))));
+
+    acc = vuzpq_s16((int16x8_t)sum_0, (int16x8_t)sum_1);
+    vst1q_s16(VACC_L, acc.val[0]);
+    vst1q_s16(VACC_M, acc.val[1]);
+    vst1q_s16(VACC_H, acc_hi);
+}
+
+static INLINE void SIGNED_CLAMP_AM(pi16 VD)
+{ /* typical sign-clamp of accumulator-mid (bits 31:16) */
+    vst1q_s16(VD, neon_clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+}
+#else
 static INLINE void SIGNED_CLAMP_AM(pi16 VD)
 { /* typical sign-clamp of accumulator-mid (bits 31:16) */
     v16 dst, src;
@@ -40,6 +115,7 @@ static INLINE void SIGNED_CLAMP_AM(pi16 VD)
     _mm_store_si128((v16 *)VD, dst);
     return;
 }
+#endif
 #else
 static INLINE void SIGNED_CLAMP_AM(pi16 VD)
 { /* typical sign-clamp of accumulator-mid (bits 31:16) */
@@ -155,7 +231,37 @@ INLINE static void do_macu(pi16 VD, pi16 VS, pi16 VT)
 
 VECTOR_OPERATION VMULF(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8_t prod_lo, prod_md, negative;
+    int32x4_t prod_0, prod_1;
+
+    prod_0 = vmull_s16(vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    prod_1 = vmull_s16(vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+
+/*
+ * VQRDMULH computes the clamped (2*s*t + 32768) >> 16 in one go.  The rounded
+ * shift of the doubled product also wraps (-32768 * -32768) the RSP way.
+ */
+    prod_lo = vmulq_s16((int16x8_t)vs, (int16x8_t)vt);
+    prod_lo = veorq_s16(vshlq_n_s16(prod_lo, 1), vdupq_n_s16((i16)0x8000));
+    prod_md = vcombine_s16(
+        vrshrn_n_s32(vshlq_n_s32(prod_0, 1), 16),
+        vrshrn_n_s32(vshlq_n_s32(prod_1, 1), 16));
+    vs = (v16)vqrdmulhq_s16((int16x8_t)vs, (int16x8_t)vt);
+
+/*
+ * The clamped result only differs from the middle slice in the corner case,
+ * where the product is positive although its middle slice has bit 15 set.
+ */
+    negative = vshrq_n_s16(prod_md, 15);
+    negative = veorq_s16(negative,
+        (int16x8_t)vmvnq_u16(vceqq_s16((int16x8_t)vs, prod_md)));
+
+    vst1q_s16(VACC_L, prod_lo);
+    vst1q_s16(VACC_M, prod_md);
+    vst1q_s16(VACC_H, negative);
+    return (vs);
+#elif defined(ARCH_MIN_SSE2)
     v16 negative;
     v16 round;
     v16 prod_hi, prod_lo;
@@ -227,7 +333,38 @@ VECTOR_OPERATION VMULF(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMULU(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8_t prod_lo, prod_md, negative, result;
+    int32x4_t prod_0, prod_1;
+
+/*
+ * The accumulator is set exactly like VMULF does.  See VMULF for annotations.
+ */
+    prod_0 = vmull_s16(vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    prod_1 = vmull_s16(vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+
+    prod_lo = vmulq_s16((int16x8_t)vs, (int16x8_t)vt);
+    prod_lo = veorq_s16(vshlq_n_s16(prod_lo, 1), vdupq_n_s16((i16)0x8000));
+    prod_md = vcombine_s16(
+        vrshrn_n_s32(vshlq_n_s32(prod_0, 1), 16),
+        vrshrn_n_s32(vshlq_n_s32(prod_1, 1), 16));
+    result = vqrdmulhq_s16((int16x8_t)vs, (int16x8_t)vt);
+
+    negative = vshrq_n_s16(prod_md, 15);
+    negative = veorq_s16(negative,
+        (int16x8_t)vmvnq_u16(vceqq_s16(result, prod_md)));
+
+    vst1q_s16(VACC_L, prod_lo);
+    vst1q_s16(VACC_M, prod_md);
+    vst1q_s16(VACC_H, negative);
+
+/*
+ * unsigned clamp:  0 if negative, 0xFFFF if bit 15 of the middle slice is set
+ */
+    result = vorrq_s16(prod_md, vshrq_n_s16(prod_md, 15));
+    result = vbicq_s16(result, negative);
+    return ((v16)result);
+#elif defined(ARCH_MIN_SSE2)
     v16 negative;
     v16 round;
     v16 prod_hi, prod_lo;
@@ -291,7 +428,20 @@ VECTOR_OPERATION VMULU(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    uint16x8_t prod_hi;
+
+    prod_hi = vcombine_u16(
+        vshrn_n_u32(vmull_u16(
+            vget_low_u16((uint16x8_t)vs), vget_low_u16((uint16x8_t)vt)), 16),
+        vshrn_n_u32(vmull_u16(
+            vget_high_u16((uint16x8_t)vs), vget_high_u16((uint16x8_t)vt)), 16));
+
+    vst1q_s16(VACC_L, (int16x8_t)prod_hi);
+    vst1q_s16(VACC_M, vdupq_n_s16(0));
+    vst1q_s16(VACC_H, vdupq_n_s16(0));
+    return ((v16)prod_hi); /* no possibilities to clamp */
+#elif defined(ARCH_MIN_SSE2)
     vs = _mm_mulhi_epu16(vs, vt);
     vector_wipe(vt); /* (UINT16_MAX * UINT16_MAX) >> 16 too small for MD/HI */
     *(v16 *)VACC_L = vs;
@@ -315,7 +465,18 @@ VECTOR_OPERATION VMUDL(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8x2_t prod;
+    int32x4_t prod_0, prod_1;
+
+    neon_mul_su(&prod_0, &prod_1, (int16x8_t)vs, (int16x8_t)vt);
+    prod = vuzpq_s16((int16x8_t)prod_0, (int16x8_t)prod_1);
+
+    vst1q_s16(VACC_L, prod.val[0]);
+    vst1q_s16(VACC_M, prod.val[1]);
+    vst1q_s16(VACC_H, vshrq_n_s16(prod.val[1], 15));
+    return ((v16)prod.val[1]);
+#elif defined(ARCH_MIN_SSE2)
     v16 prod_hi, prod_lo;
 
     prod_lo = _mm_mullo_epi16(vs, vt);
@@ -354,7 +515,18 @@ VECTOR_OPERATION VMUDM(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8x2_t prod;
+    int32x4_t prod_0, prod_1;
+
+    neon_mul_su(&prod_0, &prod_1, (int16x8_t)vt, (int16x8_t)vs);
+    prod = vuzpq_s16((int16x8_t)prod_0, (int16x8_t)prod_1);
+
+    vst1q_s16(VACC_L, prod.val[0]);
+    vst1q_s16(VACC_M, prod.val[1]);
+    vst1q_s16(VACC_H, vshrq_n_s16(prod.val[1], 15));
+    return ((v16)prod.val[0]);
+#elif defined(ARCH_MIN_SSE2)
     v16 prod_hi, prod_lo;
 
     prod_lo = _mm_mullo_epi16(vs, vt);
@@ -392,7 +564,19 @@ VECTOR_OPERATION VMUDN(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8x2_t prod;
+    int32x4_t prod_0, prod_1;
+
+    prod_0 = vmull_s16(vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    prod_1 = vmull_s16(vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+    prod = vuzpq_s16((int16x8_t)prod_0, (int16x8_t)prod_1);
+
+    vst1q_s16(VACC_L, vdupq_n_s16(0));
+    vst1q_s16(VACC_M, prod.val[0]); /* acc 31..16 storing (VS*VT)15..0 */
+    vst1q_s16(VACC_H, prod.val[1]); /* acc 47..32 storing (VS*VT)31..16 */
+    return ((v16)vcombine_s16(vqmovn_s32(prod_0), vqmovn_s32(prod_1)));
+#elif defined(ARCH_MIN_SSE2)
     v16 prod_high;
 
     prod_high = _mm_mulhi_epi16(vs, vt);
@@ -433,6 +617,21 @@ VECTOR_OPERATION VMUDH(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMACF(v16 vs, v16 vt)
 {
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int32x4_t prod_0, prod_1;
+
+    prod_0 = vmull_s16(vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    prod_1 = vmull_s16(vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+
+/*
+ * The doubled product needs 33 bits.  Its low 32 bits wrap, so the sign has
+ * to come from the product before doubling.
+ */
+    neon_accumulate(
+        vshlq_n_s32(prod_0, 1), vshlq_n_s32(prod_1, 1),
+        vshrq_n_s32(prod_0, 31), vshrq_n_s32(prod_1, 31));
+    return ((v16)neon_clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+#else
     ALIGNED i16 VD[N];
 #ifdef ARCH_MIN_SSE2
     ALIGNED i16 VS[N], VT[N];
@@ -454,10 +653,32 @@ VECTOR_OPERATION VMACF(v16 vs, v16 vt)
     vector_copy(V_result, VD);
     return;
 #endif
+#endif
 }
 
 VECTOR_OPERATION VMACU(v16 vs, v16 vt)
 {
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8_t acc_md, clamped;
+    int32x4_t prod_0, prod_1;
+
+    prod_0 = vmull_s16(vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    prod_1 = vmull_s16(vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+
+    neon_accumulate(
+        vshlq_n_s32(prod_0, 1), vshlq_n_s32(prod_1, 1),
+        vshrq_n_s32(prod_0, 31), vshrq_n_s32(prod_1, 31));
+
+/*
+ * Same unsigned clamp as UNSIGNED_CLAMP:  negative results become 0, and
+ * results clamped down to +32767 become 0xFFFF.
+ */
+    acc_md = vld1q_s16(VACC_M);
+    clamped = neon_clamp_am(acc_md, vld1q_s16(VACC_H));
+    acc_md = (int16x8_t)vcgtq_s16(clamped, acc_md);
+    clamped = vbicq_s16(clamped, vshrq_n_s16(clamped, 15));
+    return ((v16)vorrq_s16(clamped, acc_md));
+#else
     ALIGNED i16 VD[N];
 #ifdef ARCH_MIN_SSE2
     ALIGNED i16 VS[N], VT[N];
@@ -479,11 +700,38 @@ VECTOR_OPERATION VMACU(v16 vs, v16 vt)
     vector_copy(V_result, VD);
     return;
 #endif
+#endif
 }
 
 VECTOR_OPERATION VMADL(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    uint16x8_t acc_hi, acc_md, acc_lo;
+    uint16x8_t prod_hi;
+    uint16x8_t overflow;
+
+    prod_hi = vcombine_u16(
+        vshrn_n_u32(vmull_u16(
+            vget_low_u16((uint16x8_t)vs), vget_low_u16((uint16x8_t)vt)), 16),
+        vshrn_n_u32(vmull_u16(
+            vget_high_u16((uint16x8_t)vs), vget_high_u16((uint16x8_t)vt)), 16));
+
+    acc_lo = vld1q_u16((u16 *)VACC_L);
+    acc_md = vld1q_u16((u16 *)VACC_M);
+    acc_hi = vld1q_u16((u16 *)VACC_H);
+
+    acc_lo = vaddq_u16(acc_lo, prod_hi);
+    overflow = vcltq_u16(acc_lo, prod_hi); /* overflow:  (x + y < y) */
+    acc_md = vsubq_u16(acc_md, overflow);
+    overflow = vandq_u16(overflow, vceqq_u16(acc_md, vdupq_n_u16(0)));
+    acc_hi = vsubq_u16(acc_hi, overflow);
+
+    vst1q_u16((u16 *)VACC_L, acc_lo);
+    vst1q_u16((u16 *)VACC_M, acc_md);
+    vst1q_u16((u16 *)VACC_H, acc_hi);
+    return ((v16)neon_clamp_al(
+        (int16x8_t)acc_lo, (int16x8_t)acc_md, (int16x8_t)acc_hi));
+#elif defined(ARCH_MIN_SSE2)
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi;
     v16 overflow, overflow_new;
@@ -558,7 +806,14 @@ VECTOR_OPERATION VMADL(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMADM(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int32x4_t prod_0, prod_1;
+
+    neon_mul_su(&prod_0, &prod_1, (int16x8_t)vs, (int16x8_t)vt);
+    neon_accumulate(prod_0, prod_1,
+        vshrq_n_s32(prod_0, 31), vshrq_n_s32(prod_1, 31));
+    return ((v16)neon_clamp_am(vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+#elif defined(ARCH_MIN_SSE2)
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow;
@@ -621,7 +876,15 @@ VECTOR_OPERATION VMADM(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMADN(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int32x4_t prod_0, prod_1;
+
+    neon_mul_su(&prod_0, &prod_1, (int16x8_t)vt, (int16x8_t)vs);
+    neon_accumulate(prod_0, prod_1,
+        vshrq_n_s32(prod_0, 31), vshrq_n_s32(prod_1, 31));
+    return ((v16)neon_clamp_al(
+        vld1q_s16(VACC_L), vld1q_s16(VACC_M), vld1q_s16(VACC_H)));
+#elif defined(ARCH_MIN_SSE2)
     v16 acc_hi, acc_md, acc_lo;
     v16 prod_hi, prod_lo;
     v16 overflow;
@@ -702,7 +965,25 @@ VECTOR_OPERATION VMADN(v16 vs, v16 vt)
 
 VECTOR_OPERATION VMADH(v16 vs, v16 vt)
 {
-#ifdef ARCH_MIN_SSE2
+#if defined(ARCH_MIN_SSE2) && defined(__ARM_NEON__)
+    int16x8x2_t acc;
+    int32x4_t acc_0, acc_1;
+
+/*
+ * Accumulator bits 47:16 fit in 32-bit lanes, so VMLAL does the whole
+ * multiply-accumulate, carries included.  Bits 15:0 stay untouched.
+ */
+    acc = vzipq_s16(vld1q_s16(VACC_M), vld1q_s16(VACC_H));
+    acc_0 = vmlal_s16((int32x4_t)acc.val[0],
+        vget_low_s16((int16x8_t)vs), vget_low_s16((int16x8_t)vt));
+    acc_1 = vmlal_s16((int32x4_t)acc.val[1],
+        vget_high_s16((int16x8_t)vs), vget_high_s16((int16x8_t)vt));
+
+    acc = vuzpq_s16((int16x8_t)acc_0, (int16x8_t)acc_1);
+    vst1q_s16(VACC_M, acc.val[0]);
+    vst1q_s16(VACC_H, acc.val[1]);
+    return ((v16)vcombine_s16(vqmovn_s32(acc_0), vqmovn_s32(acc_1)));
+#elif defined(ARCH_MIN_SSE2)
     v16 acc_mid;
     v16 prod_high;
 
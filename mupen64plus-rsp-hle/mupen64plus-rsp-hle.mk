@@ -24,10 +24,15 @@ LOCAL_SRC_FILES :=           \
     $(SRCDIR)/musyx.c        \
     $(SRCDIR)/plugin.c       \
     $(SRCDIR)/re2.c          \
+    $(SRCDIR)/task_cache.c   \
     $(SRCDIR)/osal_dynamiclib_unix.c          \
 
 LOCAL_CFLAGS := $(COMMON_CFLAGS)
 
+ifeq ($(TARGET_ARCH_ABI), armeabi-v7a)
+    LOCAL_CFLAGS += -mfpu=neon
+endif
+
 LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS)
 
 LOCAL_LDFLAGS := $(COMMON_LDFLAGS) -Wl,-version-script,$(LOCAL_PATH)/$(SRCDIR)/rsp_api_export.ver
@@ -23,6 +23,7 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -96,6 +97,162 @@ static int16_t ramp_step(struct ramp_t* ramp)
     return (int16_t)(ramp->value >> 16);
 }
 
+/* Block kernels work on 8 consecutive samples at once (in DMEM order, which
+ * keeps the S swizzle consistent between all buffers). They give the same
+ * results as the per-sample loops as long as the buffers involved are either
+ * identical or at least a block apart. */
+static bool blocks_apart(int16_t* const* buffers, size_t n)
+{
+    size_t i, j;
+
+    for(i = 0; i < n; ++i) {
+        for(j = i + 1; j < n; ++j) {
+            ptrdiff_t d = buffers[i] - buffers[j];
+            if (d != 0 && d > -8 && d < 8)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static void mix_block(int16_t* dst, const int16_t* src, const int16_t* gains)
+{
+#if defined(HLE_SSE2)
+    __m128i d = _mm_loadu_si128((const __m128i*)dst);
+    __m128i s = _mm_loadu_si128((const __m128i*)src);
+    __m128i g = _mm_loadu_si128((const __m128i*)gains);
+
+    _mm_storeu_si128((__m128i*)dst, mix_sse2(d, s, g));
+#elif defined(HLE_NEON)
+    vst1q_s16(dst, mix_neon(vld1q_s16(dst), vld1q_s16(src), vld1q_s16(gains)));
+#else
+    size_t i;
+
+    for(i = 0; i < 8; ++i)
+        sample_mix(dst + i, src[i], gains[i]);
+#endif
+}
+
+static void envmix_ramp_gains(int16_t* gains, struct ramp_t* ramps, int16_t dry, int16_t wet)
+{
+    int16_t l_vol = ramp_step(&ramps[0]);
+    int16_t r_vol = ramp_step(&ramps[1]);
+
+    gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
+    gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
+    gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
+    gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+}
+
+/* mix the next 8 input samples into the n first buffers of dl, dr, wl, wr,
+ * stepping the ramps once per sample */
+static void envmix_ramp_block(size_t n, int16_t* const* buffers, const int16_t* in,
+                              struct ramp_t* ramps, int16_t dry, int16_t wet)
+{
+    int16_t gains[4][8];
+    int16_t src[8];
+    size_t i, k;
+
+    for(k = 0; k < 8; ++k) {
+        int16_t g[4];
+        envmix_ramp_gains(g, ramps, dry, wet);
+
+        for(i = 0; i < 4; ++i)
+            gains[i][k^S] = g[i];
+    }
+
+    /* input can be one of the outputs */
+    memcpy(src, in, sizeof(src));
+
+    for(i = 0; i < n; ++i)
+        mix_block(buffers[i], src, gains[i]);
+}
+
+/* common loop for envmixers with linear ramps.
+ * buffers holds in, dl, dr, wl, wr */
+static void envmix_ramp(size_t n, int16_t* const* buffers, size_t count,
+                        struct ramp_t* ramps, int16_t dry, int16_t wet)
+{
+    size_t i, k = 0;
+
+    if (blocks_apart(buffers, n + 1)) {
+        for(; k + 8 <= count; k += 8) {
+            int16_t* dst[4];
+
+            for(i = 0; i < n; ++i)
+                dst[i] = buffers[i + 1] + k;
+
+            envmix_ramp_block(n, dst, buffers[0] + k, ramps, dry, wet);
+        }
+    }
+
+    for(; k < count; ++k) {
+        int16_t  gains[4];
+        int16_t* dst[4];
+
+        for(i = 0; i < n; ++i)
+            dst[i] = buffers[i + 1] + (k^S);
+
+        envmix_ramp_gains(gains, ramps, dry, wet);
+        alist_envmix_mix(n, dst, gains, buffers[0][k^S]);
+    }
+}
+
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+static void envmix_nead_blocks(const int16_t* in, int16_t* dl, int16_t* dr, int16_t* wl, int16_t* wr,
+                               unsigned count, uint16_t* env_values, const uint16_t* env_steps,
+                               const int16_t* xors)
+{
+#if defined(HLE_SSE2)
+    const __m128i x0 = _mm_set1_epi16(xors[0]);
+    const __m128i x1 = _mm_set1_epi16(xors[1]);
+    const __m128i x2 = _mm_set1_epi16(xors[2]);
+    const __m128i x3 = _mm_set1_epi16(xors[3]);
+#endif
+
+    for(; count != 0; count -= 8) {
+#if defined(HLE_SSE2)
+        const __m128i e0 = _mm_set1_epi16((int16_t)env_values[0]);
+        const __m128i e1 = _mm_set1_epi16((int16_t)env_values[1]);
+        const __m128i e2 = _mm_set1_epi16((int16_t)env_values[2]);
+
+        __m128i s  = _mm_loadu_si128((const __m128i*)in);
+        __m128i l  = _mm_xor_si128(mulhi_su16_sse2(s, e0), x0);
+        __m128i r  = _mm_xor_si128(mulhi_su16_sse2(s, e1), x1);
+        __m128i l2 = _mm_xor_si128(mulhi_su16_sse2(l, e2), x2);
+        __m128i r2 = _mm_xor_si128(mulhi_su16_sse2(r, e2), x3);
+
+        _mm_storeu_si128((__m128i*)dl, _mm_adds_epi16(_mm_loadu_si128((const __m128i*)dl), l));
+        _mm_storeu_si128((__m128i*)dr, _mm_adds_epi16(_mm_loadu_si128((const __m128i*)dr), r));
+        _mm_storeu_si128((__m128i*)wl, _mm_adds_epi16(_mm_loadu_si128((const __m128i*)wl), l2));
+        _mm_storeu_si128((__m128i*)wr, _mm_adds_epi16(_mm_loadu_si128((const __m128i*)wr), r2));
+#elif defined(HLE_NEON)
+        int16x8_t s  = vld1q_s16(in);
+        int16x8_t l  = veorq_s16(mulhi_su16_neon(s, env_values[0]), vdupq_n_s16(xors[0]));
+        int16x8_t r  = veorq_s16(mulhi_su16_neon(s, env_values[1]), vdupq_n_s16(xors[1]));
+        int16x8_t l2 = veorq_s16(mulhi_su16_neon(l, env_values[2]), vdupq_n_s16(xors[2]));
+        int16x8_t r2 = veorq_s16(mulhi_su16_neon(r, env_values[2]), vdupq_n_s16(xors[3]));
+
+        vst1q_s16(dl, vqaddq_s16(vld1q_s16(dl), l));
+        vst1q_s16(dr, vqaddq_s16(vld1q_s16(dr), r));
+        vst1q_s16(wl, vqaddq_s16(vld1q_s16(wl), l2));
+        vst1q_s16(wr, vqaddq_s16(vld1q_s16(wr), r2));
+#endif
+
+        env_values[0] += env_steps[0];
+        env_values[1] += env_steps[1];
+        env_values[2] += env_steps[2];
+
+        dl += 8;
+        dr += 8;
+        wl += 8;
+        wr += 8;
+        in += 8;
+    }
+}
+#endif
+
 /* global functions */
 void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int abi_size)
 {
@@ -105,6 +262,8 @@ void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int
     const uint32_t *alist = dram_u32(hle, *dmem_u32(hle, TASK_DATA_PTR));
     const uint32_t *const alist_end = alist + (*dmem_u32(hle, TASK_DATA_SIZE) >> 2);
 
+    hle->alist_pcm_count = 0;
+
     while (alist != alist_end) {
         w1 = *(alist++);
         w2 = *(alist++);
@@ -115,9 +274,23 @@ void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int
             (*abi[acmd])(hle, w1, w2);
         else
             HleWarnMessage(hle->user_defined, "Invalid ABI command %u", acmd);
+
+        /* the ADPCM output copy only outlives the command right after it */
+        if (hle->alist_pcm_ttl == 0)
+            hle->alist_pcm_count = 0;
+        else
+            --hle->alist_pcm_ttl;
     }
 }
 
+/* for commands which leave DMEM untouched (buffer setup), so the ADPCM output
+ * copy stays usable by the command following them */
+void alist_keep_pcm(struct hle_t* hle)
+{
+    if (hle->alist_pcm_count != 0)
+        hle->alist_pcm_ttl = 1;
+}
+
 uint32_t alist_get_address(struct hle_t* hle, uint32_t so, const uint32_t *segments, size_t n)
 {
     uint8_t  segment = (so >> 24) & 0x3f;
@@ -268,11 +441,13 @@ void alist_envmix_exp(
 {
     size_t n = (aux) ? 4 : 2;
 
-    const int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
+    int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
     int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
     int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
     int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
     int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const all_buffers[5] = { in, dl, dr, wl, wr };
+    const bool use_blocks = blocks_apart(all_buffers, n + 1);
 
     struct ramp_t ramps[2];
     int32_t exp_seq[2];
@@ -323,22 +498,24 @@ void alist_envmix_exp(
             ramps[1].step = (exp_seq[1] - ramps[1].value) >> 3;
         }
 
+        if (use_blocks) {
+            int16_t* buffers[4] = { dl + ptr, dr + ptr, wl + ptr, wr + ptr };
+
+            envmix_ramp_block(n, buffers, in + ptr, ramps, dry, wet);
+            ptr += 8;
+            continue;
+        }
+
         for (x = 0; x < 8; ++x) {
             int16_t  gains[4];
             int16_t* buffers[4];
-            int16_t l_vol = ramp_step(&ramps[0]);
-            int16_t r_vol = ramp_step(&ramps[1]);
 
             buffers[0] = dl + (ptr^S);
             buffers[1] = dr + (ptr^S);
             buffers[2] = wl + (ptr^S);
             buffers[3] = wr + (ptr^S);
 
-            gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-            gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-            gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-            gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
+            envmix_ramp_gains(gains, ramps, dry, wet);
             alist_envmix_mix(n, buffers, gains, in[ptr^S]);
             ++ptr;
         }
@@ -370,14 +547,15 @@ void alist_envmix_ge(
         const int32_t *rate,
         uint32_t address)
 {
-    unsigned k;
     size_t n = (aux) ? 4 : 2;
 
-    const int16_t* const in = (int16_t*)(hle->alist_buffer + dmemi);
-    int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
-    int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
-    int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
-    int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const buffers[5] = {
+        (int16_t*)(hle->alist_buffer + dmemi),
+        (int16_t*)(hle->alist_buffer + dmem_dl),
+        (int16_t*)(hle->alist_buffer + dmem_dr),
+        (int16_t*)(hle->alist_buffer + dmem_wl),
+        (int16_t*)(hle->alist_buffer + dmem_wr)
+    };
 
     struct ramp_t ramps[2];
     short save_buffer[40];
@@ -403,25 +581,7 @@ void alist_envmix_ge(
         ramps[1].value  = *(int32_t *)(save_buffer + 18);   /* 14-15 */
     }
 
-    count >>= 1;
-    for (k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(n, buffers, gains, in[k^S]);
-    }
+    envmix_ramp(n, buffers, count >> 1, ramps, dry, wet);
 
     *(int16_t *)(save_buffer +  0) = wet;               /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;               /* 2-3 */
@@ -448,15 +608,16 @@ void alist_envmix_lin(
         const int32_t *rate,
         uint32_t address)
 {
-    size_t k;
     struct ramp_t ramps[2];
     int16_t save_buffer[40];
 
-    const int16_t * const in = (int16_t*)(hle->alist_buffer + dmemi);
-    int16_t* const dl = (int16_t*)(hle->alist_buffer + dmem_dl);
-    int16_t* const dr = (int16_t*)(hle->alist_buffer + dmem_dr);
-    int16_t* const wl = (int16_t*)(hle->alist_buffer + dmem_wl);
-    int16_t* const wr = (int16_t*)(hle->alist_buffer + dmem_wr);
+    int16_t* const buffers[5] = {
+        (int16_t*)(hle->alist_buffer + dmemi),
+        (int16_t*)(hle->alist_buffer + dmem_dl),
+        (int16_t*)(hle->alist_buffer + dmem_dr),
+        (int16_t*)(hle->alist_buffer + dmem_wl),
+        (int16_t*)(hle->alist_buffer + dmem_wr)
+    };
 
     memcpy((uint8_t *)save_buffer, hle->dram + address, 80);
     if (init) {
@@ -478,25 +639,7 @@ void alist_envmix_lin(
         ramps[1].value  = *(int32_t *)(save_buffer + 18); /* 16-17 */
     }
 
-    count >>= 1;
-    for(k = 0; k < count; ++k) {
-        int16_t  gains[4];
-        int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
-
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
-
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-        alist_envmix_mix(4, buffers, gains, in[k^S]);
-    }
+    envmix_ramp(4, buffers, count >> 1, ramps, dry, wet);
 
     *(int16_t *)(save_buffer +  0) = wet;            /* 0-1 */
     *(int16_t *)(save_buffer +  2) = dry;            /* 2-3 */
@@ -534,6 +677,17 @@ void alist_envmix_nead(
     if (swap_wet_LR)
         swap(&wl, &wr);
 
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    {
+        int16_t* const buffers[5] = { in, dl, dr, wl, wr };
+
+        if (blocks_apart(buffers, 5)) {
+            envmix_nead_blocks(in, dl, dr, wl, wr, count, env_values, env_steps, xors);
+            return;
+        }
+    }
+#endif
+
     while (count != 0) {
         size_t i;
         for(i = 0; i < 8; ++i) {
@@ -569,6 +723,25 @@ void alist_mix(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
 
     count >>= 1;
 
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    if (dst == src || src - dst >= 8 || dst - src >= 8) {
+#if defined(HLE_SSE2)
+        const __m128i g = _mm_set1_epi16(gain);
+
+        for(; count >= 8; count -= 8, dst += 8, src += 8) {
+            __m128i d = _mm_loadu_si128((const __m128i*)dst);
+            __m128i s = _mm_loadu_si128((const __m128i*)src);
+            _mm_storeu_si128((__m128i*)dst, mix_sse2(d, s, g));
+        }
+#else
+        const int16x8_t g = vdupq_n_s16(gain);
+
+        for(; count >= 8; count -= 8, dst += 8, src += 8)
+            vst1q_s16(dst, mix_neon(vld1q_s16(dst), vld1q_s16(src), g));
+#endif
+    }
+#endif
+
     while(count != 0) {
         sample_mix(dst, *src, gain);
 
@@ -584,6 +757,32 @@ void alist_multQ44(struct hle_t* hle, uint16_t dmem, uint16_t count, int8_t gain
 
     count >>= 1;
 
+#if defined(HLE_SSE2)
+    {
+        const __m128i g = _mm_set1_epi16(gain);
+
+        for(; count >= 8; count -= 8, dst += 8) {
+            __m128i d  = _mm_loadu_si128((const __m128i*)dst);
+            __m128i lo = _mm_mullo_epi16(d, g);
+            __m128i hi = _mm_mulhi_epi16(d, g);
+            __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 4);
+            __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 4);
+            _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(p0, p1));
+        }
+    }
+#elif defined(HLE_NEON)
+    {
+        const int16x4_t g = vdup_n_s16(gain);
+
+        for(; count >= 8; count -= 8, dst += 8) {
+            int16x8_t d  = vld1q_s16(dst);
+            int32x4_t p0 = vshrq_n_s32(vmull_s16(vget_low_s16(d), g), 4);
+            int32x4_t p1 = vshrq_n_s32(vmull_s16(vget_high_s16(d), g), 4);
+            vst1q_s16(dst, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+        }
+    }
+#endif
+
     while(count != 0) {
         *dst = clamp_s16(*dst * gain >> 4);
 
@@ -599,6 +798,20 @@ void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
 
     count >>= 1;
 
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    if (dst == src || src - dst >= 8 || dst - src >= 8) {
+        for(; count >= 8; count -= 8, dst += 8, src += 8) {
+#if defined(HLE_SSE2)
+            __m128i d = _mm_loadu_si128((const __m128i*)dst);
+            __m128i s = _mm_loadu_si128((const __m128i*)src);
+            _mm_storeu_si128((__m128i*)dst, _mm_adds_epi16(d, s));
+#else
+            vst1q_s16(dst, vqaddq_s16(vld1q_s16(dst), vld1q_s16(src)));
+#endif
+        }
+    }
+#endif
+
     while(count != 0) {
         *dst = clamp_s16(*dst + *src);
 
@@ -638,6 +851,33 @@ static void alist_resample_save(struct hle_t* hle, uint32_t address, uint16_t po
     *dram_u16(hle, address + 8) = pitch_accu;
 }
 
+/* Resampling usually reads back what the previous ADPCM command decoded. When
+ * all the samples it reads are in the linear copy of that output (and no
+ * output sample lands on them), taps are read from the copy rather than
+ * through the DMEM swizzle. Returns the first tap, or NULL. */
+static const int16_t* resample_pcm_taps(struct hle_t* hle, uint16_t ipos, uint16_t opos,
+                                        uint16_t count, uint32_t pitch, uint32_t pitch_accu)
+{
+    uint32_t first = ipos;
+    uint32_t last  = ipos + 3 + (uint32_t)((pitch_accu + (uint64_t)pitch * (count - 1)) >> 16);
+    unsigned k;
+
+    if (hle->alist_pcm_count == 0 || count == 0)
+        return NULL;
+
+    if (first < hle->alist_pcm_pos || last >= (uint32_t)hle->alist_pcm_pos + hle->alist_pcm_count)
+        return NULL;
+
+    if ((uint32_t)opos + count > 0x800 || (opos <= last && (uint32_t)opos + count > first))
+        return NULL;
+
+    /* the 4 history samples were just written to DMEM */
+    for(k = 0; k < 4; ++k)
+        hle->alist_pcm[first - hle->alist_pcm_pos + k] = *sample(hle, ipos + k);
+
+    return hle->alist_pcm + (first - hle->alist_pcm_pos);
+}
+
 void alist_resample(
         struct hle_t* hle,
         bool init,
@@ -649,6 +889,7 @@ void alist_resample(
         uint32_t address)
 {
     uint32_t pitch_accu;
+    const int16_t* taps;
 
     uint16_t ipos = dmemi >> 1;
     uint16_t opos = dmemo >> 1;
@@ -663,6 +904,24 @@ void alist_resample(
     else
         alist_resample_load(hle, address, ipos, &pitch_accu);
 
+    taps = resample_pcm_taps(hle, ipos, opos, count, pitch, pitch_accu);
+
+    while (taps != NULL && count != 0) {
+        const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8);
+
+        *sample(hle, opos++) = clamp_s16( (
+            (taps[0] * lut[0]) +
+            (taps[1] * lut[1]) +
+            (taps[2] * lut[2]) +
+            (taps[3] * lut[3]) ) >> 15);
+
+        pitch_accu += pitch;
+        taps += (pitch_accu >> 16);
+        ipos += (pitch_accu >> 16);
+        pitch_accu &= 0xffff;
+        --count;
+    }
+
     while (count != 0) {
         const int16_t* lut = RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8);
 
@@ -754,6 +1013,7 @@ void alist_adpcm(
         uint32_t last_frame_address)
 {
     int16_t last_frame[16];
+    int16_t* pcm;
     size_t i;
 
     adpcm_predict_frame_t predict_frame = (two_bit_per_sample)
@@ -767,6 +1027,22 @@ void alist_adpcm(
     else
         dram_load_u16(hle, (uint16_t*)last_frame, (loop) ? loop_address : last_frame_address, 16);
 
+    /* keep a linear copy of the output for the resampler, see alist_process */
+    pcm = ((dmemo & 1) == 0 && (dmemo >> 1) + 16 + (count >> 1) <= 0x800)
+        ? hle->alist_pcm
+        : NULL;
+
+    if (pcm != NULL) {
+        hle->alist_pcm_pos   = dmemo >> 1;
+        hle->alist_pcm_count = 16 + (count >> 1);
+        hle->alist_pcm_ttl   = 1;
+
+        memcpy(pcm, last_frame, sizeof(last_frame));
+        pcm += 16;
+    }
+    else
+        hle->alist_pcm_count = 0;
+
     for(i = 0; i < 16; ++i, dmemo += 2)
         *alist_s16(hle, dmemo) = last_frame[i];
 
@@ -784,6 +1060,11 @@ void alist_adpcm(
         for(i = 0; i < 16; ++i, dmemo += 2)
             *alist_s16(hle, dmemo) = last_frame[i];
 
+        if (pcm != NULL) {
+            memcpy(pcm, last_frame, sizeof(last_frame));
+            pcm += 16;
+        }
+
         count -= 32;
     }
 
@@ -196,6 +196,8 @@ static void SETBUFF(struct hle_t* hle, uint32_t w1, uint32_t w2)
         hle->alist_audio.out   = (w2 >> 16) + DMEM_BASE;
         hle->alist_audio.count = w2;
     }
+
+    alist_keep_pcm(hle);
 }
 
 static void DMEMMOVE(struct hle_t* hle, uint32_t w1, uint32_t w2)
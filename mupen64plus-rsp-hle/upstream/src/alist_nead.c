@@ -69,6 +69,8 @@ static void SETBUFF(struct hle_t* hle, uint32_t w1, uint32_t w2)
     hle->alist_nead.in    = w1;
     hle->alist_nead.out   = (w2 >> 16);
     hle->alist_nead.count = w2;
+
+    alist_keep_pcm(hle);
 }
 
 static void ADPCM(struct hle_t* hle, uint32_t w1, uint32_t w2)
@@ -26,6 +26,17 @@
 
 #include "common.h"
 
+/* SIMD paths are picked at compile time from the target,
+ * HLE_NO_SIMD forces the scalar code (see tools/simd_parity_test.c) */
+#if defined(HLE_NO_SIMD)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HLE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HLE_NEON
+#endif
+
 static inline int16_t clamp_s16(int_fast32_t x)
 {
     x = (x < INT16_MIN) ? INT16_MIN: x;
@@ -39,5 +50,93 @@ static inline int32_t vmulf(int16_t x, int16_t y)
     return (((int32_t)(x))*((int32_t)(y))+0x4000)>>15;
 }
 
+#if defined(HLE_SSE2)
+/* clamp_s16(d + ((s * g) >> 15)) */
+static inline __m128i mix_sse2(__m128i d, __m128i s, __m128i g)
+{
+    __m128i lo = _mm_mullo_epi16(s, g);
+    __m128i hi = _mm_mulhi_epi16(s, g);
+    __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+    __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+
+    p0 = _mm_add_epi32(p0, _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16));
+    p1 = _mm_add_epi32(p1, _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16));
+
+    return _mm_packs_epi32(p0, p1);
+}
+
+/* clamp_s16(d + ((s * g + 0x4000) >> 15)) */
+static inline __m128i mixr_sse2(__m128i d, __m128i s, __m128i g)
+{
+    const __m128i round = _mm_set1_epi32(0x4000);
+    __m128i lo = _mm_mullo_epi16(s, g);
+    __m128i hi = _mm_mulhi_epi16(s, g);
+    __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+    __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+
+    p0 = _mm_add_epi32(p0, _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16));
+    p1 = _mm_add_epi32(p1, _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16));
+
+    return _mm_packs_epi32(p0, p1);
+}
+
+/* (int16_t)(((int32_t)a * (uint32_t)b) >> 16) */
+static inline __m128i mulhi_su16_sse2(__m128i a, __m128i b)
+{
+    return _mm_sub_epi16(_mm_mulhi_epu16(a, b), _mm_and_si128(_mm_srai_epi16(a, 15), b));
+}
+
+/* ((a[i] * b[i] + 0x4000) >> 15) of 8 samples, folded to 4 lanes
+ * (lane k holds the terms k and k + 4) */
+static inline __m128i mulr_fold_sse2(__m128i a, __m128i b)
+{
+    const __m128i round = _mm_set1_epi32(0x4000);
+    __m128i lo = _mm_mullo_epi16(a, b);
+    __m128i hi = _mm_mulhi_epi16(a, b);
+    __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+    __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+
+    return _mm_add_epi32(p0, p1);
+}
+#elif defined(HLE_NEON)
+static inline int16x8_t mix_neon(int16x8_t d, int16x8_t s, int16x8_t g)
+{
+    int32x4_t p0 = vshrq_n_s32(vmull_s16(vget_low_s16(s), vget_low_s16(g)), 15);
+    int32x4_t p1 = vshrq_n_s32(vmull_s16(vget_high_s16(s), vget_high_s16(g)), 15);
+
+    p0 = vaddw_s16(p0, vget_low_s16(d));
+    p1 = vaddw_s16(p1, vget_high_s16(d));
+
+    return vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+}
+
+static inline int16x8_t mixr_neon(int16x8_t d, int16x8_t s, int16x8_t g)
+{
+    int32x4_t p0 = vrshrq_n_s32(vmull_s16(vget_low_s16(s), vget_low_s16(g)), 15);
+    int32x4_t p1 = vrshrq_n_s32(vmull_s16(vget_high_s16(s), vget_high_s16(g)), 15);
+
+    p0 = vaddw_s16(p0, vget_low_s16(d));
+    p1 = vaddw_s16(p1, vget_high_s16(d));
+
+    return vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+}
+
+static inline int16x8_t mulhi_su16_neon(int16x8_t a, uint16_t b)
+{
+    int32x4_t p0 = vmulq_n_s32(vmovl_s16(vget_low_s16(a)), (int32_t)b);
+    int32x4_t p1 = vmulq_n_s32(vmovl_s16(vget_high_s16(a)), (int32_t)b);
+
+    return vcombine_s16(vshrn_n_s32(p0, 16), vshrn_n_s32(p1, 16));
+}
+
+static inline int32x4_t mulr_fold_neon(int16x8_t a, int16x8_t b)
+{
+    int32x4_t p0 = vrshrq_n_s32(vmull_s16(vget_low_s16(a), vget_low_s16(b)), 15);
+    int32x4_t p1 = vrshrq_n_s32(vmull_s16(vget_high_s16(a), vget_high_s16(b)), 15);
+
+    return vaddq_s32(p0, p1);
+}
+#endif
+
 #endif
 
@@ -33,27 +33,43 @@
 #include "memory.h"
 #include "ucodes.h"
 
+#define XXH_INLINE_ALL
+#include "xxHash/xxhash.h"
+
 #define min(a,b) (((a) < (b)) ? (a) : (b))
 
 /* some rdp status flags */
 #define DP_STATUS_FREEZE            0x2
 
+/* bytes of ucode and ucode_data hashed to tell ucodes loaded at the same place apart */
+#define UCODE_HASH_SIZE             0x40
+
+/* identification inputs besides the task structure and the hashed bytes */
+#define UCODE_FLAG_HLE_GFX          0x1
+#define UCODE_FLAG_HLE_AUD          0x2
+#define UCODE_FLAG_NO_DATA_PTR      0x4
+
 
 
 /* helper functions prototypes */
 static unsigned int sum_bytes(const unsigned char *bytes, unsigned int size);
 static bool is_task(struct hle_t* hle);
+static void send_alist_to_audio_plugin(struct hle_t* hle);
 static void send_dlist_to_gfx_plugin(struct hle_t* hle);
-static bool try_fast_audio_dispatching(struct hle_t* hle);
-static bool try_fast_task_dispatching(struct hle_t* hle);
-static void normal_task_dispatching(struct hle_t* hle);
+static void skip_task(struct hle_t* hle);
+static ucode_func_t identify_audio_ucode(struct hle_t* hle);
+static ucode_func_t identify_task_by_type(struct hle_t* hle);
+static ucode_func_t identify_task_by_sum(struct hle_t* hle);
+static ucode_func_t identify_re2_task(struct hle_t* hle);
+static void task_dispatching(struct hle_t* hle);
+static void unknown_task(struct hle_t* hle);
 static void non_task_dispatching(struct hle_t* hle);
-static bool try_re2_task_dispatching(struct hle_t* hle);
 
 #ifdef ENABLE_TASK_DUMP
 static void dump_binary(struct hle_t* hle, const char *const filename,
                         const unsigned char *const bytes, unsigned int size);
 static void dump_task(struct hle_t* hle, const char *const filename);
+static void dump_task_snapshot(struct hle_t* hle);
 static void dump_unknown_task(struct hle_t* hle, unsigned int sum);
 static void dump_unknown_non_task(struct hle_t* hle, unsigned int sum);
 #endif
@@ -110,8 +126,10 @@ void hle_init(struct hle_t* hle,
 void hle_execute(struct hle_t* hle)
 {
     if (is_task(hle)) {
-        if (!try_fast_task_dispatching(hle))
-            normal_task_dispatching(hle);
+#ifdef ENABLE_TASK_DUMP
+        dump_task_snapshot(hle);
+#endif
+        task_dispatching(hle);
     } else {
         non_task_dispatching(hle);
     }
@@ -144,6 +162,11 @@ static bool is_task(struct hle_t* hle)
     return (*dmem_u32(hle, TASK_UCODE_BOOT_SIZE) <= 0x1000);
 }
 
+static void skip_task(struct hle_t* hle)
+{
+    rsp_break(hle, SP_STATUS_TASKDONE);
+}
+
 void rsp_break(struct hle_t* hle, unsigned int setbits)
 {
     *hle->sp_status |= setbits | SP_STATUS_BROKE | SP_STATUS_HALT;
@@ -177,7 +200,7 @@ static void send_dlist_to_gfx_plugin(struct hle_t* hle)
     }
 }
 
-static bool try_fast_audio_dispatching(struct hle_t* hle)
+static ucode_func_t identify_audio_ucode(struct hle_t* hle)
 {
     /* identify audio ucode by using the content of ucode_data */
     uint32_t ucode_data = *dmem_u32(hle, TASK_UCODE_DATA);
@@ -189,11 +212,11 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             switch(v)
             {
             case 0x1e24138c: /* audio ABI (most common) */
-                alist_process_audio(hle); return true;
+                return alist_process_audio;
             case 0x1dc8138c: /* GoldenEye */
-                alist_process_audio_ge(hle); return true;
+                return alist_process_audio_ge;
             case 0x1e3c1390: /* BlastCorp, DiddyKongRacing */
-                alist_process_audio_bc(hle); return true;
+                return alist_process_audio_bc;
             default:
                 HleWarnMessage(hle->user_defined, "ABI1 identification regression: v=%08x", v);
             }
@@ -202,33 +225,33 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             switch(v)
             {
             case 0x11181350: /* MarioKart, WaveRace (E) */
-                alist_process_nead_mk(hle); return true;
+                return alist_process_nead_mk;
             case 0x111812e0: /* StarFox (J) */
-                alist_process_nead_sfj(hle); return true;
+                return alist_process_nead_sfj;
             case 0x110412ac: /* WaveRace (J RevB) */
-                alist_process_nead_wrjb(hle); return true;
+                return alist_process_nead_wrjb;
             case 0x110412cc: /* StarFox/LylatWars (except J) */
-                alist_process_nead_sf(hle); return true;
+                return alist_process_nead_sf;
             case 0x1cd01250: /* FZeroX */
-                alist_process_nead_fz(hle); return true;
+                return alist_process_nead_fz;
             case 0x1f08122c: /* YoshisStory */
-                alist_process_nead_ys(hle); return true;
+                return alist_process_nead_ys;
             case 0x1f38122c: /* 1080° Snowboarding */
-                alist_process_nead_1080(hle); return true;
+                return alist_process_nead_1080;
             case 0x1f681230: /* Zelda OoT / Zelda MM (J, J RevA) */
-                alist_process_nead_oot(hle); return true;
+                return alist_process_nead_oot;
             case 0x1f801250: /* Zelda MM (except J, J RevA, E Beta), PokemonStadium 2 */
-                alist_process_nead_mm(hle); return true;
+                return alist_process_nead_mm;
             case 0x109411f8: /* Zelda MM (E Beta) */
-                alist_process_nead_mmb(hle); return true;
+                return alist_process_nead_mmb;
             case 0x1eac11b8: /* AnimalCrossing */
-                alist_process_nead_ac(hle); return true;
+                return alist_process_nead_ac;
             case 0x00010010: /* MusyX v2 (IndianaJones, BattleForNaboo) */
-                musyx_v2_task(hle); return true;
+                return musyx_v2_task;
             case 0x1f701238: /* Mario Artist Talent Studio */
-                alist_process_nead_mats(hle); return true;
+                return alist_process_nead_mats;
             case 0x1f4c1230: /* FZeroX Expansion */
-                alist_process_nead_efz(hle); return true;
+                return alist_process_nead_efz;
             default:
                 HleWarnMessage(hle->user_defined, "ABI2 identification regression: v=%08x", v);
             }
@@ -241,59 +264,52 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             RogueSquadron, ResidentEvil2, PolarisSnoCross,
             TheWorldIsNotEnough, RugratsInParis, NBAShowTime,
             HydroThunder, Tarzan, GauntletLegend, Rush2049 */
-            musyx_v1_task(hle); return true;
+            return musyx_v1_task;
         case 0x0000127c: /* naudio (many games) */
-            alist_process_naudio(hle); return true;
+            return alist_process_naudio;
         case 0x00001280: /* BanjoKazooie */
-            alist_process_naudio_bk(hle); return true;
+            return alist_process_naudio_bk;
         case 0x1c58126c: /* DonkeyKong */
-            alist_process_naudio_dk(hle); return true;
+            return alist_process_naudio_dk;
         case 0x1ae8143c: /* BanjoTooie, JetForceGemini, MickeySpeedWayUSA, PerfectDark */
-            alist_process_naudio_mp3(hle); return true;
+            return alist_process_naudio_mp3;
         case 0x1ab0140c: /* ConkerBadFurDay */
-            alist_process_naudio_cbfd(hle); return true;
+            return alist_process_naudio_cbfd;
 
         default:
             HleWarnMessage(hle->user_defined, "ABI3 identification regression: v=%08x", v);
         }
     }
 
-    return false;
+    return NULL;
 }
 
-static bool try_fast_task_dispatching(struct hle_t* hle)
+static ucode_func_t identify_task_by_type(struct hle_t* hle)
 {
     /* identify task ucode by its type */
     switch (*dmem_u32(hle, TASK_TYPE)) {
     case 1:
         /* Resident evil 2 */
         if (*dmem_u32(hle, TASK_DATA_PTR) == 0) {
-            return try_re2_task_dispatching(hle);
+            return identify_re2_task(hle);
         }
 
         if (hle->hle_gfx) {
-            send_dlist_to_gfx_plugin(hle);
-            return true;
+            return send_dlist_to_gfx_plugin;
         }
         break;
 
     case 2:
         if (hle->hle_aud) {
-            send_alist_to_audio_plugin(hle);
-            return true;
-        } else if (try_fast_audio_dispatching(hle))
-            return true;
-        break;
-
-    case 7:
-        HleShowCFB(hle->user_defined);
-        break;
+            return send_alist_to_audio_plugin;
+        }
+        return identify_audio_ucode(hle);
     }
 
-    return false;
+    return NULL;
 }
 
-static void normal_task_dispatching(struct hle_t* hle)
+static ucode_func_t identify_task_by_sum(struct hle_t* hle)
 {
     const unsigned int sum =
         sum_bytes((void*)dram_u32(hle, *dmem_u32(hle, TASK_UCODE)), min(*dmem_u32(hle, TASK_UCODE_SIZE), 0xf80) >> 1);
@@ -302,37 +318,94 @@ static void normal_task_dispatching(struct hle_t* hle)
     /* StoreVe12: found in Zelda Ocarina of Time [misleading task->type == 4] */
     case 0x278:
         /* Nothing to emulate */
-        rsp_break(hle, SP_STATUS_TASKDONE);
-        return;
+        return skip_task;
 
     /* GFX: Twintris [misleading task->type == 0] */
     case 0x212ee:
         if (hle->hle_gfx) {
-            send_dlist_to_gfx_plugin(hle);
-            return;
+            return send_dlist_to_gfx_plugin;
         }
         break;
 
     /* JPEG: found in Pokemon Stadium J */
     case 0x2c85a:
-        jpeg_decode_PS0(hle);
-        return;
+        return jpeg_decode_PS0;
 
     /* JPEG: found in Zelda Ocarina of Time, Pokemon Stadium 1, Pokemon Stadium 2 */
     case 0x2caa6:
-        jpeg_decode_PS(hle);
-        return;
+        return jpeg_decode_PS;
 
     /* JPEG: found in Ogre Battle, Bottom of the 9th */
     case 0x130de:
     case 0x278b0:
-        jpeg_decode_OB(hle);
+        return jpeg_decode_OB;
+    }
+
+    return NULL;
+}
+
+/**
+ * Identifying a ucode can mean summing up to 2KB of it, so the result is kept
+ * for the next tasks running the same ucode. Entries are keyed on the task
+ * fields identification depends on, plus a hash of the start of ucode and
+ * ucode_data which tells apart a ucode loaded where another one used to be.
+ **/
+static void task_dispatching(struct hle_t* hle)
+{
+    struct ucode_cache_entry_t key;
+    struct ucode_cache_entry_t* entry;
+    unsigned int i;
+
+    key.type       = *dmem_u32(hle, TASK_TYPE);
+    key.ucode      = *dmem_u32(hle, TASK_UCODE);
+    key.ucode_size = *dmem_u32(hle, TASK_UCODE_SIZE);
+    key.ucode_data = *dmem_u32(hle, TASK_UCODE_DATA);
+    key.flags      = (hle->hle_gfx ? UCODE_FLAG_HLE_GFX : 0)
+                   | (hle->hle_aud ? UCODE_FLAG_HLE_AUD : 0)
+                   | ((*dmem_u32(hle, TASK_DATA_PTR) == 0) ? UCODE_FLAG_NO_DATA_PTR : 0);
+    key.hash       = XXH64(dram_u32(hle, key.ucode), UCODE_HASH_SIZE, 0);
+    key.hash       = XXH64(dram_u32(hle, key.ucode_data), UCODE_HASH_SIZE, key.hash);
+
+    if (key.type == 7)
+        HleShowCFB(hle->user_defined);
+
+    for (i = 0; i < UCODE_CACHE_SIZE; ++i) {
+        entry = &hle->ucode_cache[i];
+
+        if (entry->func != NULL
+         && entry->type == key.type
+         && entry->ucode == key.ucode
+         && entry->ucode_size == key.ucode_size
+         && entry->ucode_data == key.ucode_data
+         && entry->flags == key.flags
+         && entry->hash == key.hash) {
+            entry->func(hle);
+            return;
+        }
+    }
+
+    key.func = identify_task_by_type(hle);
+    if (key.func == NULL)
+        key.func = identify_task_by_sum(hle);
+
+    if (key.func == NULL) {
+        unknown_task(hle);
         return;
     }
 
+    hle->ucode_cache[hle->ucode_cache_next] = key;
+    hle->ucode_cache_next = (hle->ucode_cache_next + 1) % UCODE_CACHE_SIZE;
+
+    key.func(hle);
+}
+
+static void unknown_task(struct hle_t* hle)
+{
     /* Forward task to RSP Fallback.
      * If task is not forwarded, use the regular "unknown task" path */
     if (HleForwardTask(hle->user_defined) != 0) {
+        const unsigned int sum =
+            sum_bytes((void*)dram_u32(hle, *dmem_u32(hle, TASK_UCODE)), min(*dmem_u32(hle, TASK_UCODE_SIZE), 0xf80) >> 1);
 
         /* Send task_done signal for unknown ucodes to allow further processings */
         rsp_break(hle, SP_STATUS_TASKDONE);
@@ -367,7 +440,7 @@ static void non_task_dispatching(struct hle_t* hle)
 }
 
 /* Resident evil 2 */
-static bool try_re2_task_dispatching(struct hle_t* hle)
+static ucode_func_t identify_re2_task(struct hle_t* hle)
 {
     const unsigned int sum =
         sum_bytes((void*)dram_u32(hle, *dmem_u32(hle, TASK_UCODE)), 256);
@@ -375,19 +448,16 @@ static bool try_re2_task_dispatching(struct hle_t* hle)
     switch (sum) {
 
     case 0x450f:
-        resize_bilinear_task(hle);
-        return true;
+        return resize_bilinear_task;
 
     case 0x3b44:
-        decode_video_frame_task(hle);
-        return true;
+        return decode_video_frame_task;
 
     case 0x3d84:
-        fill_video_double_buffer_task(hle);
-        return true;
+        return fill_video_double_buffer_task;
     }
 
-    return false;
+    return NULL;
 }
 
 #ifdef ENABLE_TASK_DUMP
@@ -486,4 +556,42 @@ static void dump_task(struct hle_t* hle, const char *const filename)
     } else
         fclose(f);
 }
+
+/* Save DMEM, IMEM and RDRAM as they are before a task runs, so that the task
+ * can be replayed outside of the emulator (see tools/hle_bench.c).
+ * Only one task every TASK_SNAPSHOT_PERIOD is saved to keep the dump rate sane. */
+#define TASK_SNAPSHOT_PERIOD 1024
+#define TASK_SNAPSHOT_DRAM_SIZE 0x800000
+
+static void dump_task_snapshot(struct hle_t* hle)
+{
+    static unsigned int task_count = 0;
+    static const char magic[8] = "HLESNAP1";
+    const uint32_t dram_size = TASK_SNAPSHOT_DRAM_SIZE;
+    char filename[256];
+    unsigned int sum;
+    FILE *f;
+
+    if ((task_count++ % TASK_SNAPSHOT_PERIOD) != 0)
+        return;
+
+    sum = sum_bytes((void*)dram_u32(hle, *dmem_u32(hle, TASK_UCODE)), min(*dmem_u32(hle, TASK_UCODE_SIZE), 0xf80) >> 1);
+
+    sprintf(&filename[0], "snapshot_%u_%x_%u.bin", *dmem_u32(hle, TASK_TYPE), sum, task_count - 1);
+
+    f = fopen(filename, "wb");
+    if (f == NULL) {
+        HleErrorMessage(hle->user_defined, "Couldn't open %s for writing !", filename);
+        return;
+    }
+
+    if (fwrite(magic, 1, sizeof(magic), f) != sizeof(magic)
+     || fwrite(hle->dmem, 1, 0x1000, f) != 0x1000
+     || fwrite(hle->imem, 1, 0x1000, f) != 0x1000
+     || fwrite(&dram_size, sizeof(dram_size), 1, f) != 1
+     || fwrite(hle->dram, 1, dram_size, f) != dram_size)
+        HleErrorMessage(hle->user_defined, "Writing error on %s", filename);
+
+    fclose(f);
+}
 #endif
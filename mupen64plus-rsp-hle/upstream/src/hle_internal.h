@@ -24,8 +24,25 @@
 
 #include <stdint.h>
 
+#include "task_cache.h"
 #include "ucodes.h"
 
+typedef void (*ucode_func_t)(struct hle_t* hle);
+
+/* a task ucode identified by hle.c, with what its identification relied on */
+struct ucode_cache_entry_t
+{
+    uint32_t type;
+    uint32_t ucode;
+    uint32_t ucode_size;
+    uint32_t ucode_data;
+    uint32_t flags;
+    uint64_t hash;
+    ucode_func_t func;
+};
+
+enum { UCODE_CACHE_SIZE = 8 };
+
 /* rsp hle internal state - internal usage only */
 struct hle_t
 {
@@ -60,9 +77,20 @@ struct hle_t
     int hle_gfx;
     int hle_aud;
 
+    /* hle.c */
+    struct ucode_cache_entry_t ucode_cache[UCODE_CACHE_SIZE];
+    unsigned int ucode_cache_next;
+
     /* alist.c */
     uint8_t alist_buffer[0x1000];
 
+    /* alist.c: last ADPCM output in sample order, kept for the RESAMPLE
+     * command which usually consumes it (see alist_adpcm) */
+    int16_t alist_pcm[0x800];
+    uint16_t alist_pcm_pos;
+    uint16_t alist_pcm_count;
+    unsigned int alist_pcm_ttl;
+
     /* alist_audio.c */
     struct alist_audio_t alist_audio;
 
@@ -74,6 +102,9 @@ struct hle_t
 
     /* mp3.c */
     uint8_t  mp3_buffer[0x1000];
+
+    /* task_cache.c */
+    struct task_cache_t task_cache;
 };
 
 /* some mips interface interrupt flags */
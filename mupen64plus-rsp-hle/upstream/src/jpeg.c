@@ -29,6 +29,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "task_cache.h"
 
 #define SUBBLOCK_SIZE 64
 
@@ -38,6 +39,7 @@ typedef void (*subblock_transform_t)(int16_t *dst, const int16_t *src);
 /* standard jpeg ucode decoder */
 static void jpeg_decode_std(struct hle_t* hle,
                             const char *const version,
+                            uint32_t cache_id,
                             const subblock_transform_t transform_luma,
                             const subblock_transform_t transform_chroma,
                             const tile_line_emitter_t emit_line);
@@ -72,7 +74,7 @@ static void ReorderSubBlock(int16_t *dst, const int16_t *src, const unsigned int
 static void MultSubBlocks(int16_t *dst, const int16_t *src1, const int16_t *src2, unsigned int shift);
 static void ScaleSubBlock(int16_t *dst, const int16_t *src, int16_t scale);
 static void RShiftSubBlock(int16_t *dst, const int16_t *src, unsigned int shift);
-static void InverseDCT1D(const float *const x, float *dst, unsigned int stride);
+static void InverseDCT1D(const float x[8][8], float dst[8][8]);
 static void InverseDCTSubBlock(int16_t *dst, const int16_t *src);
 static void RescaleYSubBlock(int16_t *dst, const int16_t *src);
 static void RescaleUVSubBlock(int16_t *dst, const int16_t *src);
@@ -140,7 +142,7 @@ static const float IDCT_K[10] = {
  **************************************************************************/
 void jpeg_decode_PS0(struct hle_t* hle)
 {
-    jpeg_decode_std(hle, "PS0", RescaleYSubBlock, RescaleUVSubBlock, EmitYUVTileLine);
+    jpeg_decode_std(hle, "PS0", TASK_CACHE_JPEG_PS0, RescaleYSubBlock, RescaleUVSubBlock, EmitYUVTileLine);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
 
@@ -150,7 +152,7 @@ void jpeg_decode_PS0(struct hle_t* hle)
  **************************************************************************/
 void jpeg_decode_PS(struct hle_t* hle)
 {
-    jpeg_decode_std(hle, "PS", NULL, NULL, EmitRGBATileLine);
+    jpeg_decode_std(hle, "PS", TASK_CACHE_JPEG_PS, NULL, NULL, EmitRGBATileLine);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
 
@@ -161,6 +163,7 @@ void jpeg_decode_OB(struct hle_t* hle)
 {
     int16_t qtable[SUBBLOCK_SIZE];
     unsigned int mb;
+    struct task_cache_query query;
 
     int32_t y_dc = 0;
     int32_t u_dc = 0;
@@ -183,6 +186,16 @@ void jpeg_decode_OB(struct hle_t* hle)
             RShiftSubBlock(qtable, DEFAULT_QTABLE, -qscale);
     }
 
+    /* macroblocks are decoded in place */
+    task_cache_begin(hle, &query, TASK_CACHE_JPEG_OB, address,
+                     (uint64_t)macroblock_count * (2 * 6 * SUBBLOCK_SIZE));
+    task_cache_hash_value(hle, &query, (uint32_t)qscale);
+
+    if (task_cache_replay(hle, &query)) {
+        rsp_break(hle, SP_STATUS_TASKDONE);
+        return;
+    }
+
     for (mb = 0; mb < macroblock_count; ++mb) {
         int16_t macroblock[6 * SUBBLOCK_SIZE];
 
@@ -192,6 +205,8 @@ void jpeg_decode_OB(struct hle_t* hle)
 
         address += (2 * 6 * SUBBLOCK_SIZE);
     }
+
+    task_cache_store(hle, &query);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
 
@@ -199,6 +214,7 @@ void jpeg_decode_OB(struct hle_t* hle)
 /* local functions */
 static void jpeg_decode_std(struct hle_t* hle,
                             const char *const version,
+                            uint32_t cache_id,
                             const subblock_transform_t transform_luma,
                             const subblock_transform_t transform_chroma,
                             const tile_line_emitter_t emit_line)
@@ -216,6 +232,7 @@ static void jpeg_decode_std(struct hle_t* hle,
     /* macroblock contains at most 6 subblocks */
     int16_t macroblock[6 * SUBBLOCK_SIZE];
     uint32_t data_ptr;
+    struct task_cache_query query;
 
     if (*dmem_u32(hle, TASK_FLAGS) & 0x1) {
         HleWarnMessage(hle->user_defined,
@@ -254,6 +271,17 @@ static void jpeg_decode_std(struct hle_t* hle,
     dram_load_u16(hle, (uint16_t *)qtables[1], qtableU_ptr, SUBBLOCK_SIZE);
     dram_load_u16(hle, (uint16_t *)qtables[2], qtableV_ptr, SUBBLOCK_SIZE);
 
+    /* macroblocks are decoded in place */
+    task_cache_begin(hle, &query, cache_id, address,
+                     (uint64_t)macroblock_count * (2 * macroblock_size));
+    task_cache_hash_value(hle, &query, mode);
+    task_cache_hash(hle, &query, qtableY_ptr, 2 * SUBBLOCK_SIZE);
+    task_cache_hash(hle, &query, qtableU_ptr, 2 * SUBBLOCK_SIZE);
+    task_cache_hash(hle, &query, qtableV_ptr, 2 * SUBBLOCK_SIZE);
+
+    if (task_cache_replay(hle, &query))
+        return;
+
     for (mb = 0; mb < macroblock_count; ++mb) {
         dram_load_u16(hle, (uint16_t *)macroblock, address, macroblock_size);
         decode_macroblock_std(transform_luma, transform_chroma,
@@ -266,6 +294,8 @@ static void jpeg_decode_std(struct hle_t* hle,
 
         address += 2 * macroblock_size;
     }
+
+    task_cache_store(hle, &query);
 }
 
 static uint8_t clamp_u8(int16_t x)
@@ -312,21 +342,20 @@ static uint16_t GetRGBA(int16_t y, int16_t u, int16_t v)
     return (r << 4) | (g >> 1) | (b >> 6) | 1;
 }
 
+/* The first half of a tile line comes from the first luma subblock and the
+ * second half from the next one. Each half is a loop compilers can vectorize. */
 static void EmitYUVTileLine(struct hle_t* hle, const int16_t *y, const int16_t *u, uint32_t address)
 {
     uint32_t uyvy[8];
+    unsigned int i;
 
     const int16_t *const v  = u + SUBBLOCK_SIZE;
     const int16_t *const y2 = y + SUBBLOCK_SIZE;
 
-    uyvy[0] = GetUYVY(y[0],  y[1],  u[0], v[0]);
-    uyvy[1] = GetUYVY(y[2],  y[3],  u[1], v[1]);
-    uyvy[2] = GetUYVY(y[4],  y[5],  u[2], v[2]);
-    uyvy[3] = GetUYVY(y[6],  y[7],  u[3], v[3]);
-    uyvy[4] = GetUYVY(y2[0], y2[1], u[4], v[4]);
-    uyvy[5] = GetUYVY(y2[2], y2[3], u[5], v[5]);
-    uyvy[6] = GetUYVY(y2[4], y2[5], u[6], v[6]);
-    uyvy[7] = GetUYVY(y2[6], y2[7], u[7], v[7]);
+    for (i = 0; i < 4; ++i)
+        uyvy[i] = GetUYVY(y[2 * i], y[2 * i + 1], u[i], v[i]);
+    for (i = 0; i < 4; ++i)
+        uyvy[4 + i] = GetUYVY(y2[2 * i], y2[2 * i + 1], u[4 + i], v[4 + i]);
 
     dram_store_u32(hle, uyvy, address, 8);
 }
@@ -334,26 +363,15 @@ static void EmitYUVTileLine(struct hle_t* hle, const int16_t *y, const int16_t *
 static void EmitRGBATileLine(struct hle_t* hle, const int16_t *y, const int16_t *u, uint32_t address)
 {
     uint16_t rgba[16];
+    unsigned int i;
 
     const int16_t *const v  = u + SUBBLOCK_SIZE;
     const int16_t *const y2 = y + SUBBLOCK_SIZE;
 
-    rgba[0]  = GetRGBA(y[0],  u[0], v[0]);
-    rgba[1]  = GetRGBA(y[1],  u[0], v[0]);
-    rgba[2]  = GetRGBA(y[2],  u[1], v[1]);
-    rgba[3]  = GetRGBA(y[3],  u[1], v[1]);
-    rgba[4]  = GetRGBA(y[4],  u[2], v[2]);
-    rgba[5]  = GetRGBA(y[5],  u[2], v[2]);
-    rgba[6]  = GetRGBA(y[6],  u[3], v[3]);
-    rgba[7]  = GetRGBA(y[7],  u[3], v[3]);
-    rgba[8]  = GetRGBA(y2[0], u[4], v[4]);
-    rgba[9]  = GetRGBA(y2[1], u[4], v[4]);
-    rgba[10] = GetRGBA(y2[2], u[5], v[5]);
-    rgba[11] = GetRGBA(y2[3], u[5], v[5]);
-    rgba[12] = GetRGBA(y2[4], u[6], v[6]);
-    rgba[13] = GetRGBA(y2[5], u[6], v[6]);
-    rgba[14] = GetRGBA(y2[6], u[7], v[7]);
-    rgba[15] = GetRGBA(y2[7], u[7], v[7]);
+    for (i = 0; i < 8; ++i)
+        rgba[i] = GetRGBA(y[i], u[i / 2], v[i / 2]);
+    for (i = 0; i < 8; ++i)
+        rgba[8 + i] = GetRGBA(y2[i], u[4 + i / 2], v[4 + i / 2]);
 
     dram_store_u16(hle, rgba, address, 16);
 }
@@ -514,69 +532,71 @@ static void RShiftSubBlock(int16_t *dst, const int16_t *src, unsigned int shift)
  * Computations use single precision floats
  * Implementation based on Wikipedia :
  * http://fr.wikipedia.org/wiki/Transform%C3%A9e_en_cosinus_discr%C3%A8te
+ *
+ * Eight 1D IDCTs are computed side by side, x[k][i] being coefficient k of
+ * the i-th one, so that compilers can process them with SIMD instructions.
  **************************************************************************/
-static void InverseDCT1D(const float *const x, float *dst, unsigned int stride)
+static void InverseDCT1D(const float x[8][8], float dst[8][8])
 {
-    float e[4];
-    float f[4];
-    float x26, x1357, x15, x37, x17, x35;
-
-    x15   = IDCT_K[2] * (x[1] + x[5]);
-    x37   = IDCT_K[3] * (x[3] + x[7]);
-    x17   = IDCT_K[8] * (x[1] + x[7]);
-    x35   = IDCT_K[9] * (x[3] + x[5]);
-    x1357 = IDCT_C3   * (x[1] + x[3] + x[5] + x[7]);
-    x26   = IDCT_C6   * (x[2] + x[6]);
-
-    f[0] = x[0] + x[4];
-    f[1] = x[0] - x[4];
-    f[2] = x26  + IDCT_K[0] * x[2];
-    f[3] = x26  + IDCT_K[1] * x[6];
-
-    e[0] = x1357 + x15 + IDCT_K[4] * x[1] + x17;
-    e[1] = x1357 + x37 + IDCT_K[6] * x[3] + x35;
-    e[2] = x1357 + x15 + IDCT_K[5] * x[5] + x35;
-    e[3] = x1357 + x37 + IDCT_K[7] * x[7] + x17;
-
-    *dst = f[0] + f[2] + e[0];
-    dst += stride;
-    *dst = f[1] + f[3] + e[1];
-    dst += stride;
-    *dst = f[1] - f[3] + e[2];
-    dst += stride;
-    *dst = f[0] - f[2] + e[3];
-    dst += stride;
-    *dst = f[0] - f[2] - e[3];
-    dst += stride;
-    *dst = f[1] - f[3] - e[2];
-    dst += stride;
-    *dst = f[1] + f[3] - e[1];
-    dst += stride;
-    *dst = f[0] + f[2] - e[0];
+    unsigned int i;
+
+    for (i = 0; i < 8; ++i) {
+        float e[4];
+        float f[4];
+        float x26, x1357, x15, x37, x17, x35;
+
+        x15   = IDCT_K[2] * (x[1][i] + x[5][i]);
+        x37   = IDCT_K[3] * (x[3][i] + x[7][i]);
+        x17   = IDCT_K[8] * (x[1][i] + x[7][i]);
+        x35   = IDCT_K[9] * (x[3][i] + x[5][i]);
+        x1357 = IDCT_C3   * (x[1][i] + x[3][i] + x[5][i] + x[7][i]);
+        x26   = IDCT_C6   * (x[2][i] + x[6][i]);
+
+        f[0] = x[0][i] + x[4][i];
+        f[1] = x[0][i] - x[4][i];
+        f[2] = x26  + IDCT_K[0] * x[2][i];
+        f[3] = x26  + IDCT_K[1] * x[6][i];
+
+        e[0] = x1357 + x15 + IDCT_K[4] * x[1][i] + x17;
+        e[1] = x1357 + x37 + IDCT_K[6] * x[3][i] + x35;
+        e[2] = x1357 + x15 + IDCT_K[5] * x[5][i] + x35;
+        e[3] = x1357 + x37 + IDCT_K[7] * x[7][i] + x17;
+
+        dst[0][i] = f[0] + f[2] + e[0];
+        dst[1][i] = f[1] + f[3] + e[1];
+        dst[2][i] = f[1] - f[3] + e[2];
+        dst[3][i] = f[0] - f[2] + e[3];
+        dst[4][i] = f[0] - f[2] - e[3];
+        dst[5][i] = f[1] - f[3] - e[2];
+        dst[6][i] = f[1] + f[3] - e[1];
+        dst[7][i] = f[0] + f[2] - e[0];
+    }
 }
 
 static void InverseDCTSubBlock(int16_t *dst, const int16_t *src)
 {
-    float x[8];
-    float block[SUBBLOCK_SIZE];
+    float x[8][8];
+    float block[8][8];
     unsigned int i, j;
 
-    /* idct 1d on rows (+transposition) */
-    for (i = 0; i < 8; ++i) {
+    /* idct 1d on rows, block[j][i] is then element j of row i */
+    for (i = 0; i < 8; ++i)
         for (j = 0; j < 8; ++j)
-            x[j] = (float)src[i * 8 + j];
+            x[j][i] = (float)src[i * 8 + j];
 
-        InverseDCT1D(x, &block[i], 8);
-    }
+    InverseDCT1D(x, block);
 
-    /* idct 1d on columns (thanks to previous transposition) */
-    for (i = 0; i < 8; ++i) {
-        InverseDCT1D(&block[i * 8], x, 1);
+    /* idct 1d on columns */
+    for (i = 0; i < 8; ++i)
+        for (j = 0; j < 8; ++j)
+            x[j][i] = block[i][j];
 
-        /* C4 = 1 normalization implies a division by 8 */
+    InverseDCT1D(x, block);
+
+    /* C4 = 1 normalization implies a division by 8 */
+    for (i = 0; i < 8; ++i)
         for (j = 0; j < 8; ++j)
-            dst[i + j * 8] = (int16_t)x[j] >> 3;
-    }
+            dst[i * 8 + j] = (int16_t)block[i][j] >> 3;
 }
 
 static void RescaleYSubBlock(int16_t *dst, const int16_t *src)
@@ -23,9 +23,51 @@
 
 #include "memory.h"
 
+/* Local functions */
+
+/* In the host order of a 4-byte aligned run, 16-bit elements are swapped in
+ * pairs and bytes are reversed in fours (nothing changes on big-endian hosts).
+ * Both permutations are their own inverse, so the same helpers load and store,
+ * and compilers turn the loops into vector shuffles. */
+static void swap_u8_quads(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i += 4) {
+        dst[i + 0] = src[i + (0 ^ S8)];
+        dst[i + 1] = src[i + (1 ^ S8)];
+        dst[i + 2] = src[i + (2 ^ S8)];
+        dst[i + 3] = src[i + (3 ^ S8)];
+    }
+}
+
+static void swap_u16_pairs(uint16_t* dst, const uint16_t* src, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i += 2) {
+        dst[i + 0] = src[i + (0 ^ S)];
+        dst[i + 1] = src[i + (1 ^ S)];
+    }
+}
+
 /* Global functions */
 void load_u8(uint8_t* dst, const unsigned char* buffer, unsigned address, size_t count)
 {
+    size_t run;
+
+    while (count != 0 && (address & 3) != 0) {
+        *(dst++) = *u8(buffer, address);
+        address += 1;
+        --count;
+    }
+
+    run = count & ~(size_t)3;
+    swap_u8_quads(dst, buffer + address, run);
+    dst += run;
+    address += run;
+    count -= run;
+
     while (count != 0) {
         *(dst++) = *u8(buffer, address);
         address += 1;
@@ -35,11 +77,23 @@ void load_u8(uint8_t* dst, const unsigned char* buffer, unsigned address, size_t
 
 void load_u16(uint16_t* dst, const unsigned char* buffer, unsigned address, size_t count)
 {
-    while (count != 0) {
+    size_t run;
+
+    if (count != 0 && (address & 2) != 0) {
         *(dst++) = *u16(buffer, address);
         address += 2;
         --count;
     }
+
+    run = count & ~(size_t)1;
+    swap_u16_pairs(dst, (const uint16_t*)(buffer + address), run);
+    dst += run;
+    address += run * 2;
+    count -= run;
+
+    if (count != 0) {
+        *dst = *u16(buffer, address);
+    }
 }
 
 void load_u32(uint32_t* dst, const unsigned char* buffer, unsigned address, size_t count)
@@ -50,6 +104,20 @@ void load_u32(uint32_t* dst, const unsigned char* buffer, unsigned address, size
 
 void store_u8(unsigned char* buffer, unsigned address, const uint8_t* src, size_t count)
 {
+    size_t run;
+
+    while (count != 0 && (address & 3) != 0) {
+        *u8(buffer, address) = *(src++);
+        address += 1;
+        --count;
+    }
+
+    run = count & ~(size_t)3;
+    swap_u8_quads(buffer + address, src, run);
+    src += run;
+    address += run;
+    count -= run;
+
     while (count != 0) {
         *u8(buffer, address) = *(src++);
         address += 1;
@@ -59,11 +127,23 @@ void store_u8(unsigned char* buffer, unsigned address, const uint8_t* src, size_
 
 void store_u16(unsigned char* buffer, unsigned address, const uint16_t* src, size_t count)
 {
-    while (count != 0) {
+    size_t run;
+
+    if (count != 0 && (address & 2) != 0) {
         *u16(buffer, address) = *(src++);
         address += 2;
         --count;
     }
+
+    run = count & ~(size_t)1;
+    swap_u16_pairs((uint16_t*)(buffer + address), src, run);
+    src += run;
+    address += run * 2;
+    count -= run;
+
+    if (count != 0) {
+        *u16(buffer, address) = *src;
+    }
 }
 
 void store_u32(unsigned char* buffer, unsigned address, const uint32_t* src, size_t count)
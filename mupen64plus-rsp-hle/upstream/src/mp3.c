@@ -21,6 +21,7 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -167,6 +168,35 @@ static const uint16_t DeWindowLUT [0x420] = {
     0x0B37, 0xF736, 0x037A, 0xFF38, 0x005D, 0xFFF3, 0x0000, 0x0000
 };
 
+/* sum of ((x[i] * lut[i] + 0x4000) >> 15) over 16 samples, subtracting odd
+ * terms instead of adding them when alternate is set */
+static int32_t dewindow16(const int16_t* x, const uint16_t* lut, bool alternate)
+{
+    int32_t t[4];
+
+#if defined(HLE_SSE2)
+    __m128i s = _mm_add_epi32(
+            mulr_fold_sse2(_mm_loadu_si128((const __m128i*)x), _mm_loadu_si128((const __m128i*)lut)),
+            mulr_fold_sse2(_mm_loadu_si128((const __m128i*)(x + 8)), _mm_loadu_si128((const __m128i*)(lut + 8))));
+    _mm_storeu_si128((__m128i*)t, s);
+#elif defined(HLE_NEON)
+    int32x4_t s = vaddq_s32(
+            mulr_fold_neon(vld1q_s16(x), vld1q_s16((const int16_t*)lut)),
+            mulr_fold_neon(vld1q_s16(x + 8), vld1q_s16((const int16_t*)(lut + 8))));
+    vst1q_s32(t, s);
+#else
+    int i;
+
+    t[0] = t[1] = t[2] = t[3] = 0;
+    for (i = 0; i < 16; i++)
+        t[i & 3] += ((int)x[i] * (short)lut[i] + 0x4000) >> 0xF;
+#endif
+
+    return (alternate)
+        ? t[0] - t[1] + t[2] - t[3]
+        : t[0] + t[1] + t[2] + t[3];
+}
+
 static void MP3AB0(int32_t* v)
 {
     /* Part 2 - 100% Accurate */
@@ -271,7 +301,7 @@ static void InnerLoop(struct hle_t* hle,
     uint32_t t1;
     uint32_t t2;
     uint32_t t3;
-    int32_t v2 = 0, v4 = 0, v6 = 0, v8 = 0;
+    int32_t v2 = 0, v4 = 0;
     uint32_t offset;
     uint32_t addptr;
     int x;
@@ -577,28 +607,18 @@ static void InnerLoop(struct hle_t* hle,
 
     offset = 0x10 - (t4 >> 1);
     for (x = 0; x < 8; x++) {
-        int32_t v0;
-        int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
-
-        for (i = 7; i >= 0; i--) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            addptr += 2;
-            offset++;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+        const int16_t* window = (int16_t *)(hle->mp3_buffer + addptr);
+        int32_t v0  = dewindow16(window +  0, DeWindowLUT + offset + 0x00, false);
+        int32_t v18 = dewindow16(window + 16, DeWindowLUT + offset + 0x20, false);
+
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
         *(int16_t *)(hle->mp3_buffer + (outPtr ^ S16)) = v0;
         *(int16_t *)(hle->mp3_buffer + ((outPtr + 2)^S16)) = v18;
         outPtr += 4;
-        addptr += 0x30;
-        offset += 0x38;
+        addptr += 0x40;
+        offset += 0x40;
     }
 
     offset = 0x10 - (t4 >> 1) + 8 * 0x40;
@@ -626,33 +646,21 @@ static void InnerLoop(struct hle_t* hle,
     addptr -= 0x50;
 
     for (x = 0; x < 8; x++) {
-        int32_t v0;
-        int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
+        const int16_t* window = (int16_t *)(hle->mp3_buffer + addptr);
+        int32_t v0, v18;
 
         offset = (0x22F - (t4 >> 1) + x * 0x40);
 
-        for (i = 0; i < 4; i++) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v2 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x20) * (short)DeWindowLUT[offset + 0x01] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v4 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x30) * (short)DeWindowLUT[offset + 0x09] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v6 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x00) * (short)DeWindowLUT[offset + 0x21] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            v8 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x10) * (short)DeWindowLUT[offset + 0x29] + 0x4000) >> 0xF;
-            addptr += 4;
-            offset += 2;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+        v0  = dewindow16(window + 16, DeWindowLUT + offset + 0x00, true);
+        v18 = dewindow16(window +  0, DeWindowLUT + offset + 0x20, true);
+
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
         *(int16_t *)(hle->mp3_buffer + ((outPtr + 2)^S16)) = v0;
         *(int16_t *)(hle->mp3_buffer + ((outPtr + 4)^S16)) = v18;
         outPtr += 4;
-        addptr -= 0x50;
+        addptr -= 0x40;
     }
 
     tmp = outPtr;
@@ -174,6 +174,7 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains);
 
+static void envmix_subframe(int16_t *y, const int16_t *x, int32_t env, int32_t env_step);
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain);
 static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain);
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs);
@@ -672,6 +673,7 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
                               unsigned segbase, unsigned offset, uint32_t last_sample_ptr)
 {
     int i, k;
+    int16_t resampled[SUBFRAME_SIZE];
 
     /* parse VOICE structure */
     const uint16_t pitch_q16   = *dram_u16(hle, voice_ptr + VOICE_PITCH_Q16);
@@ -696,6 +698,7 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
     int32_t  v4_env_step[4];
     int16_t *v4_dst[4];
     int16_t  v4[4];
+    int16_t  v;
 
     dram_load_u32(hle, (uint32_t *)v4_env,      voice_ptr + VOICE_ENV_BEGIN, 4);
     dram_load_u32(hle, (uint32_t *)v4_env_step, voice_ptr + VOICE_ENV_STEP,  4);
@@ -723,7 +726,6 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
         /* update sample and lut pointers and then pitch_accu */
         const int16_t *lut = (RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
         int dist;
-        int16_t v;
 
         sample += (pitch_accu >> 16);
         pitch_accu &= 0xffff;
@@ -735,18 +737,16 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
             sample = sample_restart + dist;
 
         /* apply resample filter */
-        v = clamp_s16(dot4(sample, lut));
+        resampled[i] = clamp_s16(dot4(sample, lut));
+    }
 
-        for (k = 0; k < 4; ++k) {
-            /* envmix */
-            int32_t accu = (v * (v4_env[k] >> 16)) >> 15;
-            v4[k] = clamp_s16(accu);
-            *(v4_dst[k]) = clamp_s16(accu + *(v4_dst[k]));
+    /* envmix */
+    v = resampled[SUBFRAME_SIZE - 1];
+    for (k = 0; k < 4; ++k) {
+        int32_t last_env = (uint32_t)v4_env[k] + (SUBFRAME_SIZE - 1) * (uint32_t)v4_env_step[k];
 
-            /* update envelopes and dst pointers */
-            ++(v4_dst[k]);
-            v4_env[k] += v4_env_step[k];
-        }
+        envmix_subframe(v4_dst[k], resampled, v4_env[k], v4_env_step[k]);
+        v4[k] = clamp_s16((v * (last_env >> 16)) >> 15);
     }
 
     /* save last resampled sample */
@@ -856,11 +856,29 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 {
     unsigned i;
 
+#if defined(HLE_SSE2)
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(subframe + i));
+        __m128i* left  = (__m128i*)(musyx->left + i);
+        __m128i* right = (__m128i*)(musyx->right + i);
+
+        _mm_storeu_si128(left,  _mm_adds_epi16(_mm_loadu_si128(left),  v));
+        _mm_storeu_si128(right, _mm_adds_epi16(_mm_loadu_si128(right), v));
+    }
+#elif defined(HLE_NEON)
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t v = vld1q_s16(subframe + i);
+
+        vst1q_s16(musyx->left + i,  vqaddq_s16(vld1q_s16(musyx->left + i),  v));
+        vst1q_s16(musyx->right + i, vqaddq_s16(vld1q_s16(musyx->right + i), v));
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         musyx->left[i]  = clamp_s16(musyx->left[i]  + v);
         musyx->right[i] = clamp_s16(musyx->right[i] + v);
     }
+#endif
 }
 
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
@@ -868,6 +886,33 @@ static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subfra
 {
     unsigned i;
 
+#if defined(HLE_SSE2)
+    const __m128i g0 = _mm_set1_epi16((int16_t)gains[0]);
+    const __m128i g1 = _mm_set1_epi16((int16_t)gains[1]);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        __m128i v  = _mm_loadu_si128((const __m128i*)(subframe + i));
+        __m128i v1 = mulhi_su16_sse2(v, g0);
+        __m128i v2 = mulhi_su16_sse2(v, g1);
+        __m128i* left  = (__m128i*)(musyx->left + i);
+        __m128i* right = (__m128i*)(musyx->right + i);
+        __m128i* cc0   = (__m128i*)(musyx->cc0 + i);
+
+        _mm_storeu_si128(left,  _mm_adds_epi16(_mm_loadu_si128(left),  v1));
+        _mm_storeu_si128(right, _mm_adds_epi16(_mm_loadu_si128(right), v1));
+        _mm_storeu_si128(cc0,   _mm_adds_epi16(_mm_loadu_si128(cc0),   v2));
+    }
+#elif defined(HLE_NEON)
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t v  = vld1q_s16(subframe + i);
+        int16x8_t v1 = mulhi_su16_neon(v, gains[0]);
+        int16x8_t v2 = mulhi_su16_neon(v, gains[1]);
+
+        vst1q_s16(musyx->left + i,  vqaddq_s16(vld1q_s16(musyx->left + i),  v1));
+        vst1q_s16(musyx->right + i, vqaddq_s16(vld1q_s16(musyx->right + i), v1));
+        vst1q_s16(musyx->cc0 + i,   vqaddq_s16(vld1q_s16(musyx->cc0 + i),   v2));
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         int16_t v1 = (int32_t)(v * gains[0]) >> 16;
@@ -877,6 +922,51 @@ static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subfra
         musyx->right[i] = clamp_s16(musyx->right[i] + v1);
         musyx->cc0[i]   = clamp_s16(musyx->cc0[i]   + v2);
     }
+#endif
+}
+
+/* y[i] += (x[i] * (env >> 16)) >> 15, with env stepping once per sample */
+static void envmix_subframe(int16_t *y, const int16_t *x, int32_t env, int32_t env_step)
+{
+    unsigned int i;
+
+#if defined(HLE_SSE2)
+    const uint32_t env_u = env, step_u = env_step;
+    __m128i e0 = _mm_set_epi32(env_u + 3 * step_u, env_u + 2 * step_u, env_u + step_u, env_u);
+    __m128i e1 = _mm_add_epi32(e0, _mm_set1_epi32(4 * step_u));
+    const __m128i step = _mm_set1_epi32(8 * step_u);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        __m128i g = _mm_packs_epi32(_mm_srai_epi32(e0, 16), _mm_srai_epi32(e1, 16));
+        __m128i d = _mm_loadu_si128((const __m128i*)(y + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(x + i));
+
+        _mm_storeu_si128((__m128i*)(y + i), mix_sse2(d, s, g));
+
+        e0 = _mm_add_epi32(e0, step);
+        e1 = _mm_add_epi32(e1, step);
+    }
+#elif defined(HLE_NEON)
+    static const int32_t lanes[4] = { 0, 1, 2, 3 };
+    int32x4_t e0 = vmlaq_n_s32(vdupq_n_s32(env), vld1q_s32(lanes), env_step);
+    int32x4_t e1 = vaddq_s32(e0, vdupq_n_s32(4 * (uint32_t)env_step));
+    const int32x4_t step = vdupq_n_s32(8 * (uint32_t)env_step);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        int16x8_t g = vcombine_s16(vshrn_n_s32(e0, 16), vshrn_n_s32(e1, 16));
+
+        vst1q_s16(y + i, mix_neon(vld1q_s16(y + i), vld1q_s16(x + i), g));
+
+        e0 = vaddq_s32(e0, step);
+        e1 = vaddq_s32(e1, step);
+    }
+#else
+    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+        int32_t accu = (x[i] * (env >> 16)) >> 15;
+        y[i] = clamp_s16(accu + y[i]);
+        env += env_step;
+    }
+#endif
 }
 
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
@@ -888,8 +978,23 @@ static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain)
 {
     unsigned int i;
 
+#if defined(HLE_SSE2)
+    const __m128i g = _mm_set1_epi16(hgain);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(y + i));
+        __m128i s = _mm_loadu_si128((const __m128i*)(x + i));
+        _mm_storeu_si128((__m128i*)(y + i), mixr_sse2(d, s, g));
+    }
+#elif defined(HLE_NEON)
+    const int16x8_t g = vdupq_n_s16(hgain);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8)
+        vst1q_s16(y + i, mixr_neon(vld1q_s16(y + i), vld1q_s16(x + i), g));
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i)
         mix_samples(&y[i], x[i], hgain);
+#endif
 }
 
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
@@ -902,6 +1007,45 @@ static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t
     h[2] = (hgain * hcoeffs[2]) >> 15;
     h[3] = (hgain * hcoeffs[3]) >> 15;
 
+#if defined(HLE_SSE2) || defined(HLE_NEON)
+    /* h only leaves the s16 range when hgain and hcoeff are both -0x8000 */
+    if (h[0] <= INT16_MAX && h[1] <= INT16_MAX && h[2] <= INT16_MAX && h[3] <= INT16_MAX) {
+#if defined(HLE_SSE2)
+        const __m128i h01 = _mm_set_epi16(h[1], h[0], h[1], h[0], h[1], h[0], h[1], h[0]);
+        const __m128i h23 = _mm_set_epi16(h[3], h[2], h[3], h[2], h[3], h[2], h[3], h[2]);
+
+        for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+            __m128i x0 = _mm_loadu_si128((const __m128i*)(x + i));
+            __m128i x1 = _mm_loadu_si128((const __m128i*)(x + i + 1));
+            __m128i x2 = _mm_loadu_si128((const __m128i*)(x + i + 2));
+            __m128i x3 = _mm_loadu_si128((const __m128i*)(x + i + 3));
+            __m128i d  = _mm_loadu_si128((const __m128i*)(y + i));
+
+            __m128i v0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(x2, x3), h23));
+            __m128i v1 = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(x2, x3), h23));
+
+            v0 = _mm_add_epi32(_mm_srai_epi32(v0, 15), _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16));
+            v1 = _mm_add_epi32(_mm_srai_epi32(v1, 15), _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16));
+
+            _mm_storeu_si128((__m128i*)(y + i), _mm_packs_epi32(v0, v1));
+        }
+#else
+        for (i = 0; i < SUBFRAME_SIZE; i += 4) {
+            int32x4_t v = vmull_n_s16(vld1_s16(x + i), (int16_t)h[0]);
+            v = vmlal_n_s16(v, vld1_s16(x + i + 1), (int16_t)h[1]);
+            v = vmlal_n_s16(v, vld1_s16(x + i + 2), (int16_t)h[2]);
+            v = vmlal_n_s16(v, vld1_s16(x + i + 3), (int16_t)h[3]);
+            v = vaddw_s16(vshrq_n_s32(v, 15), vld1_s16(y + i));
+
+            vst1_s16(y + i, vqmovn_s32(v));
+        }
+#endif
+        return;
+    }
+#endif
+
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int32_t v = (h[0] * x[i] + h[1] * x[i + 1] + h[2] * x[i + 2] + h[3] * x[i + 3]) >> 15;
         y[i] = clamp_s16(y[i] + v);
@@ -928,12 +1072,30 @@ static void interleave_stage_v1(struct hle_t* hle, musyx_t *musyx, uint32_t outp
     right = musyx->right;
     dst  = dram_u32(hle, output_ptr);
 
+#if defined(HLE_SSE2) && !defined(M64P_BIG_ENDIAN)
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        __m128i l = _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(left + i)),  _mm_set1_epi16(base_left));
+        __m128i r = _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(right + i)), _mm_set1_epi16(base_right));
+
+        _mm_storeu_si128((__m128i*)(dst + i),     _mm_unpacklo_epi16(r, l));
+        _mm_storeu_si128((__m128i*)(dst + i + 4), _mm_unpackhi_epi16(r, l));
+    }
+#elif defined(HLE_NEON) && !defined(M64P_BIG_ENDIAN)
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        int16x8x2_t lr;
+        lr.val[1] = vqaddq_s16(vld1q_s16(left + i),  vdupq_n_s16(base_left));
+        lr.val[0] = vqaddq_s16(vld1q_s16(right + i), vdupq_n_s16(base_right));
+
+        vst2q_s16((int16_t*)(dst + i), lr);
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         uint16_t l = clamp_s16(*(left++)  + base_left);
         uint16_t r = clamp_s16(*(right++) + base_right);
 
         *(dst++) = (l << 16) | r;
     }
+#endif
 }
 
 static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
@@ -51,6 +51,7 @@
 #define RSP_HLE_CONFIG_FALLBACK "RspFallback"
 #define RSP_HLE_CONFIG_HLE_GFX  "DisplayListToGraphicsPlugin"
 #define RSP_HLE_CONFIG_HLE_AUD  "AudioListToAudioPlugin"
+#define RSP_HLE_CONFIG_TASK_CACHE "TaskCacheSize"
 
 
 #define VERSION_PRINTF_SPLIT(x) (((x) >> 16) & 0xffff), (((x) >> 8) & 0xff), ((x) & 0xff)
@@ -387,6 +388,8 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
         "Send display lists to the graphics plugin");
     ConfigSetDefaultBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_AUD, 0,
         "Send audio lists to the audio plugin");
+    ConfigSetDefaultInt(l_ConfigRspHle, RSP_HLE_CONFIG_TASK_CACHE, 0,
+        "Size in KiB of the cache replaying results of repeated JPEG and RE2 video tasks (0 = disabled)");
 
     if (bSaveConfig && ConfigAPIVersion >= 0x020100)
         ConfigSaveSection(RSP_HLE_CONFIG_SECTION);
@@ -408,6 +411,7 @@ EXPORT m64p_error CALL PluginShutdown(void)
     l_CoreHandle = NULL;
 
     teardown_rsp_fallback();
+    task_cache_clear(&g_hle);
 
     l_PluginInit = 0;
     return M64ERR_SUCCESS;
@@ -480,6 +484,9 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int* CycleCount)
     g_hle.hle_gfx = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_GFX);
     g_hle.hle_aud = ConfigGetParamBool(l_ConfigRspHle, RSP_HLE_CONFIG_HLE_AUD);
 
+    int task_cache_kib = ConfigGetParamInt(l_ConfigRspHle, RSP_HLE_CONFIG_TASK_CACHE);
+    task_cache_set_budget(&g_hle, (task_cache_kib > 0) ? (size_t)task_cache_kib * 1024 : 0);
+
     /* notify fallback plugin */
     if (l_InitiateRSP) {
         l_InitiateRSP(Rsp_Info, CycleCount);
@@ -488,6 +495,8 @@ EXPORT void CALL InitiateRSP(RSP_INFO Rsp_Info, unsigned int* CycleCount)
 
 EXPORT void CALL RomClosed(void)
 {
+    task_cache_clear(&g_hle);
+
     /* notify fallback plugin */
     if (l_RomClosed) {
         l_RomClosed();
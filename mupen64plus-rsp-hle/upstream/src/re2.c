@@ -26,6 +26,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "task_cache.h"
 
 #define SATURATE8(x) ((unsigned int) x <= 255 ? x : (x < 0 ? 0: 255))
 
@@ -50,10 +51,30 @@ void resize_bilinear_task(struct hle_t* hle)
     int a, b, c ,d, index, y_index, xr, yr, blue, green, red, addr, i, j;
     long long x, y, x_diff, y_diff, one_min_x_diff, one_min_y_diff;
     unsigned short pixel;
+    struct task_cache_query query;
 
     src_addr += (src_offset >> 16) * (320 * 3);
     x = y = 0;
 
+    if (dst_width > 0 && dst_height > 0 && x_ratio >= 0 && y_ratio >= 0) {
+        /* bilinear taps reach one pixel right and one line below the last sample */
+        long long last_xr = ((long long)(dst_width - 1) * x_ratio) >> 16;
+        long long last_yr = ((long long)(dst_height - 1) * y_ratio) >> 16;
+
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_RESIZE_BILINEAR, dst_addr,
+                         (uint64_t)dst_width * dst_height * 2);
+        task_cache_hash(hle, &query, data_ptr, 40);
+        task_cache_hash(hle, &query, src_addr, (uint64_t)(last_yr * 320 + last_xr + 322) * 3);
+    }
+    else {
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_RESIZE_BILINEAR, dst_addr, 0);
+    }
+
+    if (task_cache_replay(hle, &query)) {
+        rsp_break(hle, SP_STATUS_TASKDONE);
+        return;
+    }
+
     for(i = 0; i < dst_height; i++)
     {
         yr = (int)(y >> 16);
@@ -97,6 +118,7 @@ void resize_bilinear_task(struct hle_t* hle)
         y += y_ratio;
     }
 
+    task_cache_store(hle, &query);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
 
@@ -136,6 +158,28 @@ void decode_video_frame_task(struct hle_t* hle)
     uint8_t Y, Cb, Cr;
     uint32_t pixel;
     int pY_1st_row, pY_2nd_row, pDest_1st_row, pDest_2nd_row;
+    struct task_cache_query query;
+
+    if (nMovieWidth > 0 && nMovieHeight > 0 && nScreenDMAIncrement >= 0) {
+        /* each pass consumes two luma lines and one chroma line */
+        uint64_t rows = (nMovieHeight + 1) / 2;
+        uint64_t cols = (nMovieWidth + 1) / 2;
+
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_DECODE_VIDEO_FRAME, pDestination,
+                         (rows - 1) * nScreenDMAIncrement + (nScreenDMAIncrement >> 1) + cols * 8);
+        task_cache_hash(hle, &query, data_ptr, 40);
+        task_cache_hash(hle, &query, pLuminance, (rows - 1) * 2 * nMovieWidth + nMovieWidth + cols * 2);
+        task_cache_hash(hle, &query, pCb, rows * cols);
+        task_cache_hash(hle, &query, pCr, rows * cols);
+    }
+    else {
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_DECODE_VIDEO_FRAME, pDestination, 0);
+    }
+
+    if (task_cache_replay(hle, &query)) {
+        rsp_break(hle, SP_STATUS_TASKDONE);
+        return;
+    }
 
     for (i = 0; i < nMovieHeight; i += 2)
     {
@@ -176,6 +220,7 @@ void decode_video_frame_task(struct hle_t* hle)
         pDestination += nScreenDMAIncrement;
     }
 
+    task_cache_store(hle, &query);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
 
@@ -200,6 +245,25 @@ void fill_video_double_buffer_task(struct hle_t* hle)
     int i, j;
     int r, g, b;
     uint32_t pixel, pixel1, pixel2;
+    struct task_cache_query query;
+
+    if (width > 0 && height > 0 && stride >= 0) {
+        /* pixels are processed by whole words */
+        uint64_t size = (uint64_t)(height - 1) * stride + align(width, 4);
+
+        /* destination is blended with source, so it is both read and written */
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_FILL_VIDEO_DOUBLE_BUFFER, pDest, size);
+        task_cache_hash(hle, &query, data_ptr, 0x2c);
+        task_cache_hash(hle, &query, pSrc, size);
+    }
+    else {
+        task_cache_begin(hle, &query, TASK_CACHE_RE2_FILL_VIDEO_DOUBLE_BUFFER, pDest, 0);
+    }
+
+    if (task_cache_replay(hle, &query)) {
+        rsp_break(hle, SP_STATUS_TASKDONE);
+        return;
+    }
 
     for(i = 0; i < height; i++)
     {
@@ -220,5 +284,6 @@ void fill_video_double_buffer_task(struct hle_t* hle)
       pDest += stride;
     }
 
+    task_cache_store(hle, &query);
     rsp_break(hle, SP_STATUS_TASKDONE);
 }
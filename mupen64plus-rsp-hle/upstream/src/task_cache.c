@@ -0,0 +1,208 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - task_cache.c                                    *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hle_internal.h"
+#include "memory.h"
+#include "task_cache.h"
+
+#define XXH_INLINE_ALL
+#include "xxHash/xxhash.h"
+
+/* tasks never legitimately touch memory beyond the expanded RDRAM */
+#define TASK_CACHE_DRAM_SIZE 0x800000
+
+struct task_cache_entry
+{
+    struct task_cache_entry* prev;
+    struct task_cache_entry* next;
+    uint64_t key;
+    uint32_t address;
+    uint32_t size;
+    /* followed by size bytes of output */
+};
+
+/* local functions */
+static uint8_t* entry_data(struct task_cache_entry* entry)
+{
+    return (uint8_t*)(entry + 1);
+}
+
+static void unlink_entry(struct task_cache_t* cache, struct task_cache_entry* entry)
+{
+    if (entry->prev != NULL)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+}
+
+static void push_front(struct task_cache_t* cache, struct task_cache_entry* entry)
+{
+    entry->prev = NULL;
+    entry->next = cache->head;
+
+    if (cache->head != NULL)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+
+    cache->head = entry;
+}
+
+static void evict_until(struct task_cache_t* cache, size_t budget)
+{
+    while (cache->tail != NULL && cache->size > budget) {
+        struct task_cache_entry* entry = cache->tail;
+
+        unlink_entry(cache, entry);
+        cache->size -= entry->size;
+        free(entry);
+    }
+}
+
+/* widen [address, address+size) to whole dram words, as dram is stored in host order */
+static bool dram_region(uint32_t* address, uint64_t size, uint32_t* aligned_size)
+{
+    uint64_t begin = *address & 0xffffff;
+    uint64_t end = begin + size;
+
+    begin &= ~UINT64_C(3);
+    end = (end + 3) & ~UINT64_C(3);
+
+    if (size > TASK_CACHE_DRAM_SIZE || end > TASK_CACHE_DRAM_SIZE)
+        return false;
+
+    *address = (uint32_t)begin;
+    *aligned_size = (uint32_t)(end - begin);
+    return true;
+}
+
+
+/* global functions */
+void task_cache_set_budget(struct hle_t* hle, size_t budget)
+{
+    hle->task_cache.budget = budget;
+    evict_until(&hle->task_cache, budget);
+}
+
+void task_cache_clear(struct hle_t* hle)
+{
+    evict_until(&hle->task_cache, 0);
+}
+
+void task_cache_begin(struct hle_t* hle, struct task_cache_query* query,
+                      uint32_t task_id, uint32_t address, uint64_t size)
+{
+    query->valid = (hle->task_cache.budget != 0)
+                && (size != 0)
+                && dram_region(&address, size, &query->size)
+                && (query->size <= hle->task_cache.budget);
+
+    if (!query->valid)
+        return;
+
+    query->address = address;
+    query->key = XXH64(&task_id, sizeof(task_id), 0);
+    query->key = XXH64(hle->dram + address, query->size, query->key);
+}
+
+void task_cache_hash(struct hle_t* hle, struct task_cache_query* query,
+                     uint32_t address, uint64_t size)
+{
+    uint32_t aligned_size;
+
+    if (!query->valid || size == 0)
+        return;
+
+    if (!dram_region(&address, size, &aligned_size)) {
+        query->valid = false;
+        return;
+    }
+
+    task_cache_hash_value(hle, query, address);
+    task_cache_hash_value(hle, query, aligned_size);
+    query->key = XXH64(hle->dram + address, aligned_size, query->key);
+}
+
+void task_cache_hash_value(struct hle_t* UNUSED(hle), struct task_cache_query* query,
+                           uint32_t value)
+{
+    if (!query->valid)
+        return;
+
+    query->key = XXH64(&value, sizeof(value), query->key);
+}
+
+bool task_cache_replay(struct hle_t* hle, const struct task_cache_query* query)
+{
+    struct task_cache_t* cache = &hle->task_cache;
+    struct task_cache_entry* entry;
+
+    if (!query->valid)
+        return false;
+
+    for (entry = cache->head; entry != NULL; entry = entry->next) {
+        if (entry->key == query->key
+         && entry->address == query->address
+         && entry->size == query->size) {
+
+            memcpy(hle->dram + entry->address, entry_data(entry), entry->size);
+
+            unlink_entry(cache, entry);
+            push_front(cache, entry);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void task_cache_store(struct hle_t* hle, const struct task_cache_query* query)
+{
+    struct task_cache_t* cache = &hle->task_cache;
+    struct task_cache_entry* entry;
+
+    if (!query->valid)
+        return;
+
+    evict_until(cache, cache->budget - query->size);
+
+    entry = malloc(sizeof(*entry) + query->size);
+    if (entry == NULL)
+        return;
+
+    entry->key = query->key;
+    entry->address = query->address;
+    entry->size = query->size;
+    memcpy(entry_data(entry), hle->dram + query->address, query->size);
+
+    push_front(cache, entry);
+    cache->size += entry->size;
+}
@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - task_cache.h                                    *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef TASK_CACHE_H
+#define TASK_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct hle_t;
+struct task_cache_entry;
+
+/* identifies the task kind in the cache key */
+enum
+{
+    TASK_CACHE_JPEG_PS0,
+    TASK_CACHE_JPEG_PS,
+    TASK_CACHE_JPEG_OB,
+    TASK_CACHE_RE2_RESIZE_BILINEAR,
+    TASK_CACHE_RE2_DECODE_VIDEO_FRAME,
+    TASK_CACHE_RE2_FILL_VIDEO_DOUBLE_BUFFER
+};
+
+/* LRU cache of task results, keyed by a hash of everything the task reads */
+struct task_cache_t
+{
+    struct task_cache_entry* head;
+    struct task_cache_entry* tail;
+    size_t size;
+    size_t budget;
+};
+
+/* Describe one cacheable task invocation.
+ * The output region is always hashed as part of the key, so bytes inside it
+ * which the task leaves untouched are replayed with their current value. */
+struct task_cache_query
+{
+    uint64_t key;
+    uint32_t address;
+    uint32_t size;
+    bool valid;
+};
+
+void task_cache_set_budget(struct hle_t* hle, size_t budget);
+void task_cache_clear(struct hle_t* hle);
+
+void task_cache_begin(struct hle_t* hle, struct task_cache_query* query,
+                      uint32_t task_id, uint32_t address, uint64_t size);
+void task_cache_hash(struct hle_t* hle, struct task_cache_query* query,
+                     uint32_t address, uint64_t size);
+void task_cache_hash_value(struct hle_t* hle, struct task_cache_query* query,
+                           uint32_t value);
+
+bool task_cache_replay(struct hle_t* hle, const struct task_cache_query* query);
+void task_cache_store(struct hle_t* hle, const struct task_cache_query* query);
+
+#endif
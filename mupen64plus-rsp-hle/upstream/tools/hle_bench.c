@@ -0,0 +1,321 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - hle_bench.c                                     *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Standalone benchmark replaying RSP tasks captured by a DUMP=1 build of the
+ * plugin (see dump_task_snapshot in src/hle.c).
+ *
+ * Each snapshot holds DMEM, IMEM and RDRAM as they were right before a task
+ * started. The task is executed repeatedly from that state and the time spent
+ * in hle_execute is reported per snapshot and per audio ABI.
+ *
+ * Usage: mupen64plus-rsp-hle-bench [-n iterations] snapshot_*.bin
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hle.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "memory.h"
+
+#define DEFAULT_ITERATIONS 200
+#define MAX_DRAM_SIZE 0x800000
+#define MAX_GROUPS 32
+
+struct snapshot
+{
+    unsigned char dmem[0x1000];
+    unsigned char imem[0x1000];
+    unsigned char* dram;
+    uint32_t dram_size;
+};
+
+struct group
+{
+    char name[64];
+    unsigned int count;
+    double total_ns;
+};
+
+/* emulated RSP state */
+static struct hle_t g_hle;
+static unsigned char g_dmem[0x1000];
+static unsigned char g_imem[0x1000];
+static unsigned char* g_dram;
+static unsigned int g_regs[18];
+
+/* set whenever a task leaves the HLE code path */
+static int g_unhandled;
+
+static struct group g_groups[MAX_GROUPS];
+static unsigned int g_group_count;
+
+
+/* hle_external.h callbacks */
+void HleVerboseMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleInfoMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleErrorMessage(void* UNUSED(user_defined), const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void HleWarnMessage(void* UNUSED(user_defined), const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void HleCheckInterrupts(void* UNUSED(user_defined))
+{
+}
+
+void HleProcessDlistList(void* UNUSED(user_defined))
+{
+    g_unhandled = 1;
+}
+
+void HleProcessAlistList(void* UNUSED(user_defined))
+{
+    g_unhandled = 1;
+}
+
+void HleProcessRdpList(void* UNUSED(user_defined))
+{
+    g_unhandled = 1;
+}
+
+void HleShowCFB(void* UNUSED(user_defined))
+{
+}
+
+int HleForwardTask(void* UNUSED(user_defined))
+{
+    g_unhandled = 1;
+    return -1;
+}
+
+
+/* local functions */
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int load_snapshot(const char* filename, struct snapshot* snapshot)
+{
+    char magic[8];
+    int ok;
+    FILE* f = fopen(filename, "rb");
+
+    if (f == NULL) {
+        fprintf(stderr, "Couldn't open %s\n", filename);
+        return 0;
+    }
+
+    ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+      && memcmp(magic, "HLESNAP1", sizeof(magic)) == 0
+      && fread(snapshot->dmem, 1, 0x1000, f) == 0x1000
+      && fread(snapshot->imem, 1, 0x1000, f) == 0x1000
+      && fread(&snapshot->dram_size, sizeof(snapshot->dram_size), 1, f) == 1
+      && snapshot->dram_size <= MAX_DRAM_SIZE
+      && fread(snapshot->dram, 1, snapshot->dram_size, f) == snapshot->dram_size;
+
+    fclose(f);
+
+    if (!ok)
+        fprintf(stderr, "%s is not a valid task snapshot\n", filename);
+
+    return ok;
+}
+
+static void restore_snapshot(const struct snapshot* snapshot)
+{
+    memcpy(g_dmem, snapshot->dmem, 0x1000);
+    memcpy(g_imem, snapshot->imem, 0x1000);
+    memcpy(g_dram, snapshot->dram, snapshot->dram_size);
+    memset(g_regs, 0, sizeof(g_regs));
+}
+
+/* mirrors the identification done by try_fast_audio_dispatching in hle.c */
+static void describe_task(struct hle_t* hle, char* name, size_t size)
+{
+    const uint32_t type = *dmem_u32(hle, TASK_TYPE);
+    const uint32_t ucode_data = *dmem_u32(hle, TASK_UCODE_DATA);
+    uint32_t v;
+
+    if (type == 1 && *dmem_u32(hle, TASK_DATA_PTR) == 0) {
+        snprintf(name, size, "re2");
+    }
+    else if (type == 2) {
+        if (*dram_u32(hle, ucode_data) == 0x00000001) {
+            if (*dram_u32(hle, ucode_data + 0x30) == 0xf0000f00) {
+                v = *dram_u32(hle, ucode_data + 0x28);
+                snprintf(name, size, "alist_audio (%08x)", v);
+            }
+            else {
+                v = *dram_u32(hle, ucode_data + 0x10);
+                snprintf(name, size, "%s (%08x)", (v == 0x00010010) ? "musyx_v2" : "alist_nead", v);
+            }
+        }
+        else {
+            v = *dram_u32(hle, ucode_data + 0x10);
+            snprintf(name, size, "%s (%08x)", (v == 0x00000001) ? "musyx_v1" : "alist_naudio", v);
+        }
+    }
+    else {
+        snprintf(name, size, "task_type_%u", type);
+    }
+}
+
+static void account(const char* name, double ns)
+{
+    unsigned int i;
+    size_t abi_length = strcspn(name, " ");
+
+    for (i = 0; i < g_group_count; ++i) {
+        if (strlen(g_groups[i].name) == abi_length && strncmp(g_groups[i].name, name, abi_length) == 0)
+            break;
+    }
+
+    if (i == g_group_count) {
+        if (g_group_count == MAX_GROUPS)
+            return;
+
+        memcpy(g_groups[i].name, name, abi_length);
+        g_groups[i].name[abi_length] = '\0';
+        ++g_group_count;
+    }
+
+    g_groups[i].count++;
+    g_groups[i].total_ns += ns;
+}
+
+static void bench_snapshot(const char* filename, const struct snapshot* snapshot, unsigned int iterations)
+{
+    char name[64];
+    unsigned int i;
+    double total = 0.0;
+    double best = 0.0;
+
+    restore_snapshot(snapshot);
+    describe_task(&g_hle, name, sizeof(name));
+
+    for (i = 0; i < iterations; ++i) {
+        double start;
+        double elapsed;
+
+        restore_snapshot(snapshot);
+        g_unhandled = 0;
+
+        start = now_ns();
+        hle_execute(&g_hle);
+        elapsed = now_ns() - start;
+
+        if (g_unhandled) {
+            printf("%-40s %-26s not handled by HLE, skipped\n", filename, name);
+            return;
+        }
+
+        total += elapsed;
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    printf("%-40s %-26s %10.0f ns/task (best %.0f)\n", filename, name, total / iterations, best);
+    account(name, total / iterations);
+}
+
+
+/* Global functions */
+int main(int argc, char** argv)
+{
+    struct snapshot snapshot;
+    unsigned int iterations = DEFAULT_ITERATIONS;
+    unsigned int i;
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-n") == 0) {
+        iterations = (unsigned int)strtoul(argv[arg + 1], NULL, 0);
+        arg += 2;
+    }
+
+    if (arg >= argc || iterations == 0) {
+        fprintf(stderr, "usage: %s [-n iterations] snapshot_*.bin\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    g_dram = calloc(1, MAX_DRAM_SIZE);
+    snapshot.dram = malloc(MAX_DRAM_SIZE);
+    if (g_dram == NULL || snapshot.dram == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    hle_init(&g_hle, g_dram, g_dmem, g_imem,
+             &g_regs[0],
+             &g_regs[1], &g_regs[2], &g_regs[3], &g_regs[4], &g_regs[5],
+             &g_regs[6], &g_regs[7], &g_regs[8], &g_regs[9],
+             &g_regs[10], &g_regs[11], &g_regs[12], &g_regs[13],
+             &g_regs[14], &g_regs[15], &g_regs[16], &g_regs[17],
+             NULL);
+
+    /* display lists and unknown ucodes are outside the scope of this benchmark */
+    g_hle.hle_gfx = 1;
+    g_hle.hle_aud = 0;
+
+    for (; arg < argc; ++arg) {
+        if (load_snapshot(argv[arg], &snapshot))
+            bench_snapshot(argv[arg], &snapshot, iterations);
+    }
+
+    if (g_group_count != 0) {
+        printf("\n");
+        for (i = 0; i < g_group_count; ++i) {
+            printf("%-26s %4u snapshot(s) %10.0f ns/task\n",
+                   g_groups[i].name, g_groups[i].count, g_groups[i].total_ns / g_groups[i].count);
+        }
+    }
+
+    free(snapshot.dram);
+    free(g_dram);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - simd_parity.h                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Forced into the second, scalar only (HLE_NO_SIMD) build of the sources
+ * checked by simd_parity_test.c. Renames their global functions so that
+ * both builds can be linked into the same program. */
+
+#ifndef SIMD_PARITY_H
+#define SIMD_PARITY_H
+
+/* alist.c */
+#define alist_add                       scalar_alist_add
+#define alist_adpcm                     scalar_alist_adpcm
+#define alist_clear                     scalar_alist_clear
+#define alist_copy_blocks               scalar_alist_copy_blocks
+#define alist_copy_every_other_sample   scalar_alist_copy_every_other_sample
+#define alist_envmix_exp                scalar_alist_envmix_exp
+#define alist_envmix_ge                 scalar_alist_envmix_ge
+#define alist_envmix_lin                scalar_alist_envmix_lin
+#define alist_envmix_nead               scalar_alist_envmix_nead
+#define alist_filter                    scalar_alist_filter
+#define alist_get_address               scalar_alist_get_address
+#define alist_iirf                      scalar_alist_iirf
+#define alist_interleave                scalar_alist_interleave
+#define alist_keep_pcm                  scalar_alist_keep_pcm
+#define alist_load                      scalar_alist_load
+#define alist_mix                       scalar_alist_mix
+#define alist_move                      scalar_alist_move
+#define alist_multQ44                   scalar_alist_multQ44
+#define alist_polef                     scalar_alist_polef
+#define alist_process                   scalar_alist_process
+#define alist_repeat64                  scalar_alist_repeat64
+#define alist_resample                  scalar_alist_resample
+#define alist_resample_zoh              scalar_alist_resample_zoh
+#define alist_save                      scalar_alist_save
+#define alist_set_address               scalar_alist_set_address
+
+/* mp3.c */
+#define mp3_task                        scalar_mp3_task
+
+/* musyx.c */
+#define musyx_v1_task                   scalar_musyx_v1_task
+#define musyx_v2_task                   scalar_musyx_v2_task
+
+#endif
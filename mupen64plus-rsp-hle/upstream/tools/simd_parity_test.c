@@ -0,0 +1,615 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - simd_parity_test.c                                *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Checks the SSE2/NEON kernels against the scalar code they replace.
+ *
+ * The checked sources are compiled a second time with HLE_NO_SIMD and their
+ * functions renamed with a scalar_ prefix (see simd_parity.h). Both versions
+ * are run on the same pseudo random DMEM and RDRAM contents, with random
+ * offsets, counts and parameters, including buffers that alias or overlap,
+ * and their results must be identical.
+ *
+ * Which SIMD path is checked depends on the target the test is built for.
+ * Build and run with "make test" in projects/unix.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "alist.h"
+#include "arithmetics.h"
+#include "common.h"
+#include "hle.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "memory.h"
+#include "ucodes.h"
+
+#define ITERATIONS 5000
+#define DRAM_SIZE 0x10000
+
+/* scalar builds of the checked functions, see simd_parity.h */
+void scalar_alist_envmix_exp(struct hle_t* hle, bool init, bool aux,
+        uint16_t dmem_dl, uint16_t dmem_dr, uint16_t dmem_wl, uint16_t dmem_wr,
+        uint16_t dmemi, uint16_t count, int16_t dry, int16_t wet,
+        const int16_t *vol, const int16_t *target, const int32_t *rate, uint32_t address);
+void scalar_alist_envmix_ge(struct hle_t* hle, bool init, bool aux,
+        uint16_t dmem_dl, uint16_t dmem_dr, uint16_t dmem_wl, uint16_t dmem_wr,
+        uint16_t dmemi, uint16_t count, int16_t dry, int16_t wet,
+        const int16_t *vol, const int16_t *target, const int32_t *rate, uint32_t address);
+void scalar_alist_envmix_lin(struct hle_t* hle, bool init,
+        uint16_t dmem_dl, uint16_t dmem_dr, uint16_t dmem_wl, uint16_t dmem_wr,
+        uint16_t dmemi, uint16_t count, int16_t dry, int16_t wet,
+        const int16_t *vol, const int16_t *target, const int32_t *rate, uint32_t address);
+void scalar_alist_envmix_nead(struct hle_t* hle, bool swap_wet_LR,
+        uint16_t dmem_dl, uint16_t dmem_dr, uint16_t dmem_wl, uint16_t dmem_wr,
+        uint16_t dmemi, unsigned count, uint16_t *env_values, uint16_t *env_steps,
+        const int16_t *xors);
+void scalar_alist_mix(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count, int16_t gain);
+void scalar_alist_multQ44(struct hle_t* hle, uint16_t dmem, uint16_t count, int8_t gain);
+void scalar_alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count);
+void scalar_mp3_task(struct hle_t* hle, unsigned int index, uint32_t address);
+void scalar_musyx_v1_task(struct hle_t* hle);
+void scalar_musyx_v2_task(struct hle_t* hle);
+
+/* the two states compared, simd one first */
+static struct hle_t g_hle[2];
+static unsigned char g_dram[2][DRAM_SIZE];
+static unsigned char g_dmem[2][0x1000];
+static unsigned int g_sp_status[2];
+static unsigned int g_mi_intr[2];
+
+static unsigned int g_failures;
+
+
+/* xorshift32, so that runs are reproducible whatever the libc */
+static uint32_t g_seed = 0x2545f491;
+
+static uint32_t rnd(void)
+{
+    g_seed ^= g_seed << 13;
+    g_seed ^= g_seed >> 17;
+    g_seed ^= g_seed << 5;
+    return g_seed;
+}
+
+static uint32_t rnd_below(uint32_t n)
+{
+    return rnd() % n;
+}
+
+/* even DMEM offset of a buffer of size bytes. Half of the time it is picked
+ * close to near, to get aliased and overlapping buffers. */
+static uint16_t rnd_offset(uint16_t size, uint16_t near)
+{
+    int offset = (rnd() & 1)
+        ? (int)near + 2 * ((int)rnd_below(21) - 10)
+        : (int)rnd_below(0x1000);
+
+    offset &= ~1;
+
+    if (offset < 0)
+        offset = 0;
+    if (offset > 0x1000 - size)
+        offset = (0x1000 - size) & ~1;
+
+    return (uint16_t)offset;
+}
+
+static void rnd_fill(unsigned char* buffer, size_t size)
+{
+    size_t i;
+
+    for(i = 0; i < size; i += 4) {
+        uint32_t v = rnd();
+        memcpy(buffer + i, &v, 4);
+    }
+}
+
+static void randomize(void)
+{
+    rnd_fill(g_hle[0].alist_buffer, sizeof(g_hle[0].alist_buffer));
+    rnd_fill(g_hle[0].mp3_buffer, sizeof(g_hle[0].mp3_buffer));
+    rnd_fill(g_dram[0], DRAM_SIZE);
+    rnd_fill(g_dmem[0], sizeof(g_dmem[0]));
+
+    g_sp_status[0] = g_sp_status[1] = rnd();
+    g_mi_intr[0] = g_mi_intr[1] = rnd();
+
+    memcpy(g_hle[1].alist_buffer, g_hle[0].alist_buffer, sizeof(g_hle[0].alist_buffer));
+    memcpy(g_hle[1].mp3_buffer, g_hle[0].mp3_buffer, sizeof(g_hle[0].mp3_buffer));
+    memcpy(g_dram[1], g_dram[0], DRAM_SIZE);
+    memcpy(g_dmem[1], g_dmem[0], sizeof(g_dmem[0]));
+}
+
+static bool compare(const char* kernel, unsigned int iteration)
+{
+    if (memcmp(g_hle[0].alist_buffer, g_hle[1].alist_buffer, sizeof(g_hle[0].alist_buffer)) != 0
+     || memcmp(g_hle[0].mp3_buffer, g_hle[1].mp3_buffer, sizeof(g_hle[0].mp3_buffer)) != 0
+     || g_sp_status[0] != g_sp_status[1] || g_mi_intr[0] != g_mi_intr[1]
+     || memcmp(g_dram[0], g_dram[1], DRAM_SIZE) != 0
+     || memcmp(g_dmem[0], g_dmem[1], sizeof(g_dmem[0])) != 0) {
+        printf("FAIL: %s differs from the scalar code at iteration %u\n", kernel, iteration);
+        ++g_failures;
+        return false;
+    }
+
+    return true;
+}
+
+
+static void check_mix(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        uint16_t count = 2 * rnd_below(0x400);
+        uint16_t dmemi = rnd_offset(count, 0x800);
+        uint16_t dmemo = rnd_offset(count, dmemi);
+        int16_t gain = (int16_t)rnd();
+
+        randomize();
+        alist_mix(&g_hle[0], dmemo, dmemi, count, gain);
+        scalar_alist_mix(&g_hle[1], dmemo, dmemi, count, gain);
+
+        if (!compare("alist_mix", i))
+            return;
+    }
+}
+
+static void check_add(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        uint16_t count = 2 * rnd_below(0x400);
+        uint16_t dmemi = rnd_offset(count, 0x800);
+        uint16_t dmemo = rnd_offset(count, dmemi);
+
+        randomize();
+        alist_add(&g_hle[0], dmemo, dmemi, count);
+        scalar_alist_add(&g_hle[1], dmemo, dmemi, count);
+
+        if (!compare("alist_add", i))
+            return;
+    }
+}
+
+static void check_multQ44(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        uint16_t count = 2 * rnd_below(0x400);
+        uint16_t dmem = rnd_offset(count, 0x800);
+        int8_t gain = (int8_t)rnd();
+
+        randomize();
+        alist_multQ44(&g_hle[0], dmem, count, gain);
+        scalar_alist_multQ44(&g_hle[1], dmem, count, gain);
+
+        if (!compare("alist_multQ44", i))
+            return;
+    }
+}
+
+/* parameters shared by the envmixers with ramps */
+struct envmix_args
+{
+    bool init;
+    bool aux;
+    uint16_t dmem[5];   /* in, dl, dr, wl, wr */
+    uint16_t count;
+    int16_t dry;
+    int16_t wet;
+    int16_t vol[2];
+    int16_t target[2];
+    int32_t rate[2];
+    uint32_t address;
+};
+
+/* size is the number of bytes used in each buffer for the count drawn */
+static void rnd_envmix_args(struct envmix_args* args, uint16_t count, uint16_t size)
+{
+    size_t k;
+
+    args->init = rnd() & 1;
+    args->aux = rnd() & 1;
+    args->count = count;
+    args->dmem[0] = rnd_offset(size, 0x800);
+    for(k = 1; k < 5; ++k)
+        args->dmem[k] = rnd_offset(size, args->dmem[rnd_below(k)]);
+    args->dry = (int16_t)rnd();
+    args->wet = (int16_t)rnd();
+
+    for(k = 0; k < 2; ++k) {
+        args->vol[k] = (int16_t)rnd();
+        args->target[k] = (int16_t)rnd();
+        /* keep vol * rate within int32_t */
+        args->rate[k] = (int32_t)(rnd() & 0xffff) - 0x8000;
+    }
+
+    /* the saved state in RDRAM is random when !init */
+    args->address = rnd_below(DRAM_SIZE - 80);
+}
+
+static void check_envmix_exp(void)
+{
+    unsigned int i;
+    struct envmix_args a;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        /* 8 samples are mixed per 16 bytes of count */
+        uint16_t count = 16 * rnd_below(0x40);
+
+        rnd_envmix_args(&a, count, count);
+        randomize();
+        alist_envmix_exp(&g_hle[0], a.init, a.aux, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+        scalar_alist_envmix_exp(&g_hle[1], a.init, a.aux, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+
+        if (!compare("alist_envmix_exp", i))
+            return;
+    }
+}
+
+static void check_envmix_ge(void)
+{
+    unsigned int i;
+    struct envmix_args a;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        uint16_t count = 2 * rnd_below(0x200);
+
+        rnd_envmix_args(&a, count, count);
+        randomize();
+        alist_envmix_ge(&g_hle[0], a.init, a.aux, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+        scalar_alist_envmix_ge(&g_hle[1], a.init, a.aux, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+
+        if (!compare("alist_envmix_ge", i))
+            return;
+    }
+}
+
+static void check_envmix_lin(void)
+{
+    unsigned int i;
+    struct envmix_args a;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        uint16_t count = 2 * rnd_below(0x200);
+
+        rnd_envmix_args(&a, count, count);
+        randomize();
+        alist_envmix_lin(&g_hle[0], a.init, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+        scalar_alist_envmix_lin(&g_hle[1], a.init, a.dmem[1], a.dmem[2], a.dmem[3], a.dmem[4], a.dmem[0],
+                a.count, a.dry, a.wet, a.vol, a.target, a.rate, a.address);
+
+        if (!compare("alist_envmix_lin", i))
+            return;
+    }
+}
+
+static void check_envmix_nead(void)
+{
+    unsigned int i;
+    size_t k;
+
+    for(i = 0; i < ITERATIONS; ++i) {
+        /* count is rounded up to a multiple of 8 samples */
+        unsigned count = rnd_below(0x100);
+        uint16_t size = 2 * align(count, 8);
+        bool swap_wet_LR = rnd() & 1;
+        uint16_t dmem[5];
+        uint16_t env_values[2][3];
+        uint16_t env_steps[3];
+        int16_t xors[4];
+
+        dmem[0] = rnd_offset(size, 0x800);
+        for(k = 1; k < 5; ++k)
+            dmem[k] = rnd_offset(size, dmem[rnd_below(k)]);
+
+        for(k = 0; k < 3; ++k) {
+            env_values[0][k] = env_values[1][k] = (uint16_t)rnd();
+            env_steps[k] = (uint16_t)rnd();
+        }
+
+        for(k = 0; k < 4; ++k)
+            xors[k] = (int16_t)rnd();
+
+        randomize();
+        alist_envmix_nead(&g_hle[0], swap_wet_LR, dmem[1], dmem[2], dmem[3], dmem[4], dmem[0],
+                count, env_values[0], env_steps, xors);
+        scalar_alist_envmix_nead(&g_hle[1], swap_wet_LR, dmem[1], dmem[2], dmem[3], dmem[4], dmem[0],
+                count, env_values[1], env_steps, xors);
+
+        if (!compare("alist_envmix_nead", i))
+            return;
+
+        if (memcmp(env_values[0], env_values[1], sizeof(env_values[0])) != 0) {
+            printf("FAIL: alist_envmix_nead envelope differs from the scalar code at iteration %u\n", i);
+            ++g_failures;
+            return;
+        }
+    }
+}
+
+
+static void check_mp3(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < ITERATIONS / 5; ++i) {
+        /* 8 header bytes and 3 frames of 0x180 bytes are processed in place */
+        unsigned int index = 2 * rnd_below(16);
+        uint32_t address = 8 * rnd_below((DRAM_SIZE - 0x488) / 8);
+
+        randomize();
+        mp3_task(&g_hle[0], index, address);
+        scalar_mp3_task(&g_hle[1], index, address);
+
+        if (!compare("mp3_task", i))
+            return;
+    }
+}
+
+
+/* MusyX tasks follow pointers found in RDRAM. Random contents are laid out
+ * as valid sound frame descriptors (SFD), with the fields offsets and sizes
+ * of musyx.c, so that every access stays within the buffers. */
+enum {
+    MUSYX_SFD           = 0x1000,
+    MUSYX_STATE         = 0x3000,
+    MUSYX_SFX           = 0x4000,
+    MUSYX_CBUFFER       = 0x4100,
+    MUSYX_OUTPUT        = 0x5000,
+    MUSYX_PTR_24        = 0x6000,
+    MUSYX_PTR_18        = 0x6100,
+    MUSYX_INTERLEAVE_IN = 0x7000,
+    MUSYX_PTR_1C        = 0x9800,
+    MUSYX_PTR_20        = 0x9a00,
+    MUSYX_SAMPLES       = 0xa000,
+
+    MUSYX_SUBFRAME_SIZE = 192,
+    MUSYX_MAX_VOICES    = 32,
+    MUSYX_VOICE_SIZE    = 0x50,
+    MUSYX_MAX_SFD       = 2,
+    MUSYX_VOICES_PER_SFD = 4
+};
+
+static void rnd_musyx_voice(struct hle_t* hle, uint32_t voice, uint32_t samples, bool last, uint32_t output)
+{
+    /* PCM16 samples, at least 32 and at most the 0x200 of the sample buffer */
+    uint16_t count = 4 * (8 + rnd_below(121));
+    uint8_t skip = rnd_below(16);
+    uint16_t split = 1 + rnd_below(count);
+    uint16_t start = skip + rnd_below(4);
+    uint16_t end_point = start + 4 + rnd_below(count - 9 - start);
+    size_t k;
+
+    /* random env, with steps that keep it within int32_t over a subframe */
+    for(k = 0; k < 4; ++k) {
+        *dram_u32(hle, voice + 0x00 + 4 * k) = (rnd() & 0x7fffffff) - 0x40000000;
+        *dram_u32(hle, voice + 0x10 + 4 * k) = (int32_t)rnd() >> 10;
+    }
+
+    *dram_u16(hle, voice + 0x20) = (uint16_t)rnd();         /* pitch */
+    *dram_u16(hle, voice + 0x22) = rnd_below(0x2000);       /* pitch shift, at most 2 samples per step */
+    *dram_u32(hle, voice + 0x24) = samples;                 /* catsrc 0 */
+    *dram_u32(hle, voice + 0x28) = samples + 2 * split;
+    *dram_u16(hle, voice + 0x2c) = 2 * split;
+    *dram_u16(hle, voice + 0x2e) = 2 * (count - split);
+    *dram_u8 (hle, voice + 0x3c) = 0;                       /* PCM16 */
+    *dram_u8 (hle, voice + 0x3e) = skip;
+    *dram_u16(hle, voice + 0x40) = count - skip;
+    *dram_u16(hle, voice + 0x42) = 0;                       /* no catsrc 1 */
+    *dram_u32(hle, voice + 0x44) = last ? output : 0;
+    *dram_u16(hle, voice + 0x48) = end_point;
+    /* restart relative to the segment, with a loop longer than a pitch step */
+    *dram_u16(hle, voice + 0x4a) = rnd_below(end_point - 2);
+    *dram_u16(hle, voice + 0x4e) = start - skip;
+}
+
+static void rnd_musyx_sfx(struct hle_t* hle)
+{
+    /* at least 4 subframes, so that any sfx index below 4 fits */
+    uint32_t length = 4 * MUSYX_SUBFRAME_SIZE + rnd_below(MUSYX_SUBFRAME_SIZE + 1);
+    size_t k;
+
+    *dram_u32(hle, MUSYX_SFX + 0x00) = MUSYX_CBUFFER;
+    *dram_u32(hle, MUSYX_SFX + 0x04) = length;
+    *dram_u16(hle, MUSYX_SFX + 0x08) = rnd_below(9);
+
+    for(k = 0; k < 8; ++k)
+        *dram_u32(hle, MUSYX_SFX + 0x0c + 4 * k) = 1 + rnd_below(length - 1);
+
+    /* keep the sum of the 4 FIR products within int32_t */
+    for(k = 0; k < 4; ++k)
+        *dram_u16(hle, MUSYX_SFX + 0x40 + 2 * k) = (uint16_t)((int16_t)rnd() >> 2);
+}
+
+/* lays out count SFD of the given version, returns the address of the first one */
+static uint32_t rnd_musyx_task(struct hle_t* hle, int version, unsigned int count)
+{
+    const uint32_t voices_offset = (version == 1) ? 0x10 : 0x28;
+    const uint32_t output_size = (version == 1) ? 0x300 : 0x480;
+    uint32_t sfd = MUSYX_SFD;
+    unsigned int s, j, k;
+
+    rnd_musyx_sfx(hle);
+
+    for(s = 0; s < count; ++s) {
+        const uint32_t output = MUSYX_OUTPUT + s * output_size;
+        const unsigned int voices = 1 + rnd_below(MUSYX_VOICES_PER_SFD);
+        uint32_t voice = sfd + voices_offset;
+
+        *dram_u16(hle, sfd + 0x02) = rnd_below(4);          /* sfx index */
+        *dram_u32(hle, sfd + 0x08) = MUSYX_STATE + s * 0x300;
+        *dram_u32(hle, sfd + 0x0c) = (rnd_below(4) != 0) ? MUSYX_SFX : 0;
+
+        if (version == 2) {
+            *dram_u32(hle, sfd + 0x10) = 0;                 /* unsupported */
+            *dram_u32(hle, sfd + 0x18) = MUSYX_PTR_18;
+            *dram_u32(hle, sfd + 0x1c) = MUSYX_PTR_1C;
+            *dram_u32(hle, sfd + 0x20) = MUSYX_PTR_20;
+            *dram_u32(hle, sfd + 0x24) = MUSYX_PTR_24;
+
+            for(k = 0; k < 8; ++k)
+                *dram_u32(hle, MUSYX_PTR_18 + 8 * k) = MUSYX_INTERLEAVE_IN + k * 6 * MUSYX_SUBFRAME_SIZE;
+        }
+
+        for(j = 0; j < voices; ++j, voice += MUSYX_VOICE_SIZE)
+            rnd_musyx_voice(hle, voice, MUSYX_SAMPLES + (s * MUSYX_VOICES_PER_SFD + j) * 0x400, j + 1 == voices, output);
+
+        /* sometimes skip the voice stage */
+        if (rnd_below(8) == 0)
+            *dram_u16(hle, sfd + voices_offset + 0x2c) = 0;
+
+        sfd += voices_offset + MUSYX_MAX_VOICES * MUSYX_VOICE_SIZE;
+    }
+
+    return MUSYX_SFD;
+}
+
+static void check_musyx(int version)
+{
+    unsigned int i;
+
+    for(i = 0; i < ITERATIONS / 5; ++i) {
+        unsigned int count = 1 + rnd_below(MUSYX_MAX_SFD);
+        uint32_t sfd;
+
+        randomize();
+        sfd = rnd_musyx_task(&g_hle[0], version, count);
+        memcpy(g_dram[1], g_dram[0], DRAM_SIZE);
+
+        *dmem_u32(&g_hle[0], TASK_DATA_PTR) = *dmem_u32(&g_hle[1], TASK_DATA_PTR) = sfd;
+        *dmem_u32(&g_hle[0], TASK_DATA_SIZE) = *dmem_u32(&g_hle[1], TASK_DATA_SIZE) = count;
+
+        if (version == 1) {
+            musyx_v1_task(&g_hle[0]);
+            scalar_musyx_v1_task(&g_hle[1]);
+        } else {
+            musyx_v2_task(&g_hle[0]);
+            scalar_musyx_v2_task(&g_hle[1]);
+        }
+
+        if (!compare((version == 1) ? "musyx_v1_task" : "musyx_v2_task", i))
+            return;
+    }
+}
+
+
+/* hle_external.h, nothing is expected to be reported by the checked kernels */
+void HleVerboseMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleInfoMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleErrorMessage(void* UNUSED(user_defined), const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void HleWarnMessage(void* UNUSED(user_defined), const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void HleCheckInterrupts(void* UNUSED(user_defined))
+{
+}
+
+void HleProcessDlistList(void* UNUSED(user_defined))
+{
+}
+
+void HleProcessAlistList(void* UNUSED(user_defined))
+{
+}
+
+void HleProcessRdpList(void* UNUSED(user_defined))
+{
+}
+
+void HleShowCFB(void* UNUSED(user_defined))
+{
+}
+
+int HleForwardTask(void* UNUSED(user_defined))
+{
+    return -1;
+}
+
+
+int main(void)
+{
+    size_t k;
+
+    for(k = 0; k < 2; ++k) {
+        g_hle[k].dram = g_dram[k];
+        g_hle[k].dmem = g_dmem[k];
+        g_hle[k].sp_status = &g_sp_status[k];
+        g_hle[k].mi_intr = &g_mi_intr[k];
+    }
+
+#if defined(HLE_SSE2)
+    printf("checking SSE2 kernels\n");
+#elif defined(HLE_NEON)
+    printf("checking NEON kernels\n");
+#else
+    printf("no SIMD kernels on this target, checking the scalar code against itself\n");
+#endif
+
+    check_mix();
+    check_add();
+    check_multQ44();
+    check_envmix_exp();
+    check_envmix_ge();
+    check_envmix_lin();
+    check_envmix_nead();
+    check_mp3();
+    check_musyx(1);
+    check_musyx(2);
+
+    if (g_failures == 0)
+        printf("simd parity test passed\n");
+
+    return (g_failures == 0) ? 0 : 1;
+}
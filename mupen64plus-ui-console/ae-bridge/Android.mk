@@ -14,7 +14,7 @@ LOCAL_SRC_FILES := ae_imports.cpp
 
 LOCAL_CFLAGS := $(COMMON_CFLAGS)
 
-LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS)
+LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS) -std=c++11
 
 LOCAL_LDFLAGS := $(COMMON_LDFLAGS)
 
@@ -36,7 +36,7 @@ LOCAL_SRC_FILES := ae_exports.cpp
 
 LOCAL_CFLAGS := $(COMMON_CFLAGS)
 
-LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS)
+LOCAL_CPPFLAGS := $(COMMON_CPPFLAGS) -std=c++11
 
 LOCAL_LDFLAGS := $(COMMON_LDFLAGS)
 
@@ -56,7 +56,7 @@ LOCAL_STATIC_LIBRARIES := EGLLoader
 
 LOCAL_C_INCLUDES := $(M64P_API_INCLUDES) $(GL_INCLUDES)
 
-LOCAL_SRC_FILES := ae_vidext.cpp
+LOCAL_SRC_FILES := ae_vidext.cpp ae_framepacing.cpp ae_perfhint.cpp
 
 LOCAL_CFLAGS := $(COMMON_CFLAGS) -DEGL
 
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <dlfcn.h>
 #include <unistd.h>
+#include <mutex>
 #include "SDL.h"
 #include "m64p_types.h"
 #include "ae_imports.h"
@@ -51,17 +52,23 @@ static void *handleFront;    // libmupen64plus-ui-console.so
 typedef jint        (*pJNI_OnLoad)      (JavaVM* vm, void* reserved);
 typedef int         (*pAeiInit)         (JNIEnv* env, jclass cls);
 typedef int         (*pAeiDestroy)      (JNIEnv* env);
+typedef int         (*pAeiReadStatus)   (int* status, int size);
 typedef m64p_error  (*pCoreShutdown)    (void);
 typedef m64p_error  (*pCoreDoCommand)   (m64p_command, int, void *);
 typedef int         (*pFrontMain)       (int argc, char* argv[]);
+typedef int         (*pAudioGetArray)   (int* values, int count);
 
 // Function pointers
 static pAeiInit         aeiInit         = NULL;
 static pAeiDestroy      aeiDestroy      = NULL;
+static pAeiReadStatus   aeiReadStatus   = NULL;
 static pCoreDoCommand   coreDoCommand   = NULL;
 static pCoreShutdown    coreShutdown    = NULL;
 static pFrontMain       frontMain       = NULL;
 
+// Java polls the status from its own thread, keep ae-imports loaded while it does
+static std::mutex       statusLock;
+
 void checkLibraryError(const char* message)
 {
     const char* error = dlerror();
@@ -92,6 +99,37 @@ int unloadLibrary(void* handle, const char* libName)
     return code;
 }
 
+// Calls one of the optional array getters of the audio plugin, if the plugin that is currently
+// loaded provides it. The front-end owns the plugin handle, so only look up the already loaded
+// library instead of loading it again.
+jint callAudioGetArray(JNIEnv* env, jstring jaudioLib, jintArray jvalues, const char* funcName)
+{
+    const char *audioLib = env->GetStringUTFChars(jaudioLib, 0);
+    void* handle = dlopen(audioLib, RTLD_NOW | RTLD_NOLOAD);
+    env->ReleaseStringUTFChars(jaudioLib, audioLib);
+
+    if (!handle)
+    {
+        // Not loaded yet or anymore, clear the error so it doesn't show up later
+        dlerror();
+        return 0;
+    }
+
+    jint count = 0;
+    pAudioGetArray audioGetArray = (pAudioGetArray) dlsym(handle, funcName);
+    if (audioGetArray)
+    {
+        jint* values = env->GetIntArrayElements(jvalues, NULL);
+        count = audioGetArray(values, env->GetArrayLength(jvalues));
+        env->ReleaseIntArrayElements(jvalues, values, 0);
+    }
+    else
+        dlerror();
+
+    dlclose(handle);
+    return count;
+}
+
 void* locateFunction(void* handle, const char* libName, const char* funcName)
 {
     char message[256];
@@ -150,18 +188,22 @@ extern "C" DECLSPEC void SDLCALL Java_paulscode_android_mupen64plusae_jni_Native
     // Find library functions
     aeiInit       = (pAeiInit)       locateFunction(handleAEI,   "ae-imports",             "Android_JNI_InitImports");
     aeiDestroy    = (pAeiDestroy)    locateFunction(handleAEI,   "ae-imports",             "Android_JNI_DestroyImports");
+    pAeiReadStatus readStatus = (pAeiReadStatus) locateFunction(handleAEI, "ae-imports",   "Android_JNI_ReadStatus");
     coreDoCommand = (pCoreDoCommand) locateFunction(handleCore,  "mupen64plus-core",       "CoreDoCommand");
     coreShutdown  = (pCoreShutdown)  locateFunction(handleCore,  "mupen64plus-core",       "CoreShutdown");
     frontMain     = (pFrontMain)     locateFunction(handleFront, "mupen64plus-ui-console", "SDL_main");
 
     // Make sure we don't have any typos
-    if (!aeiInit || !aeiDestroy || !coreDoCommand || !frontMain || !coreShutdown)
+    if (!aeiInit || !aeiDestroy || !readStatus || !coreDoCommand || !frontMain || !coreShutdown)
     {
         LOGE("Could not load library functions: be sure they are named and typedef'd correctly");
     } else {
 		// Initialize dependencies
 		jclass nativeImports = env->FindClass("paulscode/android/mupen64plusae/jni/NativeImports");
 		aeiInit(env, nativeImports);
+
+		std::lock_guard<std::mutex> guard(statusLock);
+		aeiReadStatus = readStatus;
 	}
 }
 
@@ -175,6 +217,10 @@ extern "C" DECLSPEC void SDLCALL Java_paulscode_android_mupen64plusae_jni_Native
     aeiDestroy(env);
 
     // Nullify function pointers so that they can no longer be used
+    {
+        std::lock_guard<std::mutex> guard(statusLock);
+        aeiReadStatus = NULL;
+    }
     aeiInit         = NULL;
     aeiDestroy      = NULL;
     coreDoCommand   = NULL;
@@ -255,6 +301,12 @@ extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_
     else
         vsyncEnabled(1);
     if (coreDoCommand) coreDoCommand(M64CMD_CORE_STATE_SET, M64CORE_SPEED_FACTOR, &speed_factor);
+
+    // Fast-forward renders about as many frames per second as at normal speed
+    int render_skip = speed_factor > 100 ? speed_factor / 100 - 1 : 0;
+    if (render_skip > 9)
+        render_skip = 9;
+    if (coreDoCommand) coreDoCommand(M64CMD_CORE_STATE_SET, M64CORE_RENDER_SKIP, &render_skip);
 }
 
 extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_emuSetFramelimiter(JNIEnv* env, jclass cls, jboolean enabled)
@@ -342,3 +394,30 @@ extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_
 {
     if (coreDoCommand) coreDoCommand(M64CMD_RESET, 0, NULL);
 }
+
+extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_emuTrimMemory(JNIEnv* env, jclass cls, jint level)
+{
+    if (coreDoCommand) coreDoCommand(M64CMD_TRIM_MEMORY, level, NULL);
+}
+
+extern "C" DECLSPEC jint Java_paulscode_android_mupen64plusae_jni_NativeExports_readStatus(JNIEnv* env, jclass cls, jintArray jstatus)
+{
+    std::lock_guard<std::mutex> guard(statusLock);
+    if (!aeiReadStatus)
+        return 0;
+
+    jint* status = env->GetIntArrayElements(jstatus, NULL);
+    jint count = aeiReadStatus(status, env->GetArrayLength(jstatus));
+    env->ReleaseIntArrayElements(jstatus, status, 0);
+    return count;
+}
+
+extern "C" DECLSPEC jint Java_paulscode_android_mupen64plusae_jni_NativeExports_audioGetStats(JNIEnv* env, jclass cls, jstring jaudioLib, jintArray jstats)
+{
+    return callAudioGetArray(env, jaudioLib, jstats, "AudioGetStats");
+}
+
+extern "C" DECLSPEC jint Java_paulscode_android_mupen64plusae_jni_NativeExports_audioGetQueueHistory(JNIEnv* env, jclass cls, jstring jaudioLib, jintArray jhistory)
+{
+    return callAudioGetArray(env, jaudioLib, jhistory, "AudioGetQueueHistory");
+}
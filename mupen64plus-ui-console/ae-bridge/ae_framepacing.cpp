@@ -0,0 +1,252 @@
+#include "ae_framepacing.h"
+#include "ae_imports.h"
+#include <android/looper.h>
+#include <EGL/eglext.h>
+#include <dlfcn.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// AChoreographer is only available since API 24 and minSdkVersion is lower, so load it at runtime
+struct AChoreographer;
+typedef void (*AChoreographer_frameCallback)(long frameTimeNanos, void* data);
+typedef void (*AChoreographer_frameCallback64)(int64_t frameTimeNanos, void* data);
+typedef AChoreographer* (*PFN_AChoreographer_getInstance)();
+typedef void (*PFN_AChoreographer_postFrameCallback)(AChoreographer* choreographer, AChoreographer_frameCallback callback, void* data);
+typedef void (*PFN_AChoreographer_postFrameCallback64)(AChoreographer* choreographer, AChoreographer_frameCallback64 callback, void* data);
+typedef EGLBoolean (EGLAPIENTRYP PFN_eglPresentationTimeANDROID)(EGLDisplay dpy, EGLSurface surface, int64_t time);
+
+static PFN_AChoreographer_getInstance ptrAChoreographer_getInstance = nullptr;
+static PFN_AChoreographer_postFrameCallback ptrAChoreographer_postFrameCallback = nullptr;
+static PFN_AChoreographer_postFrameCallback64 ptrAChoreographer_postFrameCallback64 = nullptr;
+static PFN_eglPresentationTimeANDROID ptrEglPresentationTimeANDROID = nullptr;
+static bool presentationTimeChecked = false;
+
+static std::mutex choreographerAccess;
+static std::thread choreographerThread;
+static ALooper* choreographerLooper = nullptr;
+static std::atomic<bool> choreographerQuit(false);
+
+// Written by the choreographer thread, read when swapping
+static std::atomic<int64_t> lastVsyncTime(0);
+static std::atomic<int64_t> vsyncPeriod(0);
+static std::atomic<int> pacingMode(FRAME_PACING_OFF);
+
+// Only used by the thread swapping buffers
+static int64_t lastSwapTime = 0;
+static int64_t frameInterval = 0;
+static int64_t lastPresentTime = 0;
+
+static const int64_t maxFrameInterval = 250000000LL;
+
+static int64_t getMonotonicTime()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (int64_t) spec.tv_sec * 1000000000LL + spec.tv_nsec;
+}
+
+static void postVsyncCallback(AChoreographer* choreographer);
+
+static void onVsync(int64_t frameTime)
+{
+    const int64_t last = lastVsyncTime.load();
+    if (last != 0 && frameTime > last) {
+        // Callbacks can miss vsyncs, so divide by the number of periods that passed
+        const int64_t diff = frameTime - last;
+        int64_t period = vsyncPeriod.load();
+        if (period == 0) {
+            if (diff < maxFrameInterval)
+                period = diff;
+        } else {
+            const int64_t periods = (diff + period / 2) / period;
+            if (periods >= 1 && periods <= 4)
+                period += (diff / periods - period) / 8;
+        }
+        vsyncPeriod.store(period);
+    }
+    lastVsyncTime.store(frameTime);
+}
+
+static void vsyncCallback(long frameTimeNanos, void* data)
+{
+    int64_t frameTime = frameTimeNanos;
+    if (sizeof(long) < sizeof(int64_t)) {
+        // 32 bit long wraps every 4 seconds, restore the high bits from the current time
+        const int64_t now = getMonotonicTime();
+        frameTime = (now & ~0xFFFFFFFFLL) | (uint32_t) frameTimeNanos;
+        if (frameTime > now)
+            frameTime -= 0x100000000LL;
+    }
+    onVsync(frameTime);
+    postVsyncCallback(static_cast<AChoreographer*>(data));
+}
+
+static void vsyncCallback64(int64_t frameTimeNanos, void* data)
+{
+    onVsync(frameTimeNanos);
+    postVsyncCallback(static_cast<AChoreographer*>(data));
+}
+
+static void postVsyncCallback(AChoreographer* choreographer)
+{
+    if (choreographerQuit)
+        return;
+
+    if (ptrAChoreographer_postFrameCallback64 != nullptr)
+        ptrAChoreographer_postFrameCallback64(choreographer, vsyncCallback64, choreographer);
+    else
+        ptrAChoreographer_postFrameCallback(choreographer, vsyncCallback, choreographer);
+}
+
+static void choreographerLoop()
+{
+    ALooper* looper = ALooper_prepare(0);
+    ALooper_acquire(looper);
+    {
+        std::unique_lock<std::mutex> guard(choreographerAccess);
+        choreographerLooper = looper;
+    }
+
+    AChoreographer* choreographer = ptrAChoreographer_getInstance();
+    if (choreographer != nullptr) {
+        postVsyncCallback(choreographer);
+        while (!choreographerQuit)
+            ALooper_pollOnce(-1, nullptr, nullptr, nullptr);
+    } else {
+        LOGE("framePacing: AChoreographer_getInstance() failed");
+    }
+}
+
+static bool loadChoreographer()
+{
+    if (ptrAChoreographer_getInstance != nullptr)
+        return true;
+
+    void* libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (libandroid == nullptr)
+        return false;
+
+    ptrAChoreographer_getInstance = (PFN_AChoreographer_getInstance) dlsym(libandroid, "AChoreographer_getInstance");
+    ptrAChoreographer_postFrameCallback = (PFN_AChoreographer_postFrameCallback) dlsym(libandroid, "AChoreographer_postFrameCallback");
+    ptrAChoreographer_postFrameCallback64 = (PFN_AChoreographer_postFrameCallback64) dlsym(libandroid, "AChoreographer_postFrameCallback64");
+
+    if (ptrAChoreographer_getInstance == nullptr ||
+        (ptrAChoreographer_postFrameCallback == nullptr && ptrAChoreographer_postFrameCallback64 == nullptr)) {
+        ptrAChoreographer_getInstance = nullptr;
+        return false;
+    }
+    return true;
+}
+
+static void stopChoreographer()
+{
+    if (!choreographerThread.joinable())
+        return;
+
+    choreographerQuit = true;
+    {
+        std::unique_lock<std::mutex> guard(choreographerAccess);
+        if (choreographerLooper != nullptr)
+            ALooper_wake(choreographerLooper);
+    }
+    choreographerThread.join();
+
+    std::unique_lock<std::mutex> guard(choreographerAccess);
+    if (choreographerLooper != nullptr) {
+        ALooper_release(choreographerLooper);
+        choreographerLooper = nullptr;
+    }
+}
+
+void framePacingSetMode(int mode)
+{
+    stopChoreographer();
+    lastVsyncTime = 0;
+    vsyncPeriod = 0;
+    pacingMode = FRAME_PACING_OFF;
+
+    if (mode == FRAME_PACING_OFF)
+        return;
+
+    if (!loadChoreographer()) {
+        LOGI("framePacing: AChoreographer is not available, frame pacing disabled");
+        return;
+    }
+
+    choreographerQuit = false;
+    choreographerThread = std::thread(choreographerLoop);
+    pacingMode = mode;
+}
+
+void framePacingReset()
+{
+    lastSwapTime = 0;
+    frameInterval = 0;
+    lastPresentTime = 0;
+}
+
+bool framePacingBeforeSwap(EGLDisplay display, EGLSurface surface)
+{
+    if (pacingMode == FRAME_PACING_OFF)
+        return true;
+
+    if (!presentationTimeChecked) {
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (extensions != nullptr && strstr(extensions, "EGL_ANDROID_presentation_time") != nullptr)
+            ptrEglPresentationTimeANDROID = (PFN_eglPresentationTimeANDROID) eglGetProcAddress("eglPresentationTimeANDROID");
+        if (ptrEglPresentationTimeANDROID == nullptr)
+            LOGI("framePacing: EGL_ANDROID_presentation_time is not supported");
+        presentationTimeChecked = true;
+    }
+
+    const int64_t period = vsyncPeriod.load();
+    const int64_t vsync = lastVsyncTime.load();
+    if (ptrEglPresentationTimeANDROID == nullptr || period == 0)
+        return true;
+
+    const int64_t now = getMonotonicTime();
+    if (lastSwapTime != 0) {
+        const int64_t interval = now - lastSwapTime;
+        if (interval < maxFrameInterval) {
+            frameInterval = frameInterval == 0 ? interval : frameInterval + (interval - frameInterval) / 8;
+        } else {
+            // Long stall, e.g. loading a state or a dropped surface: start over
+            frameInterval = 0;
+            lastPresentTime = 0;
+        }
+    }
+    lastSwapTime = now;
+
+    if (frameInterval == 0)
+        return true;
+
+    // Number of vsyncs each frame stays on screen, e.g. 2 for 60 VI/s on a 120Hz display
+    int64_t vsyncsPerFrame = (frameInterval + period / 2) / period;
+    if (vsyncsPerFrame < 1)
+        vsyncsPerFrame = 1;
+
+    int64_t target = lastPresentTime + vsyncsPerFrame * period;
+
+    // A late frame is shown as soon as possible and the cadence restarts from it
+    const int64_t earliest = now + (pacingMode == FRAME_PACING_LOW_LATENCY ? period : 2 * period);
+    if (target < earliest)
+        target = earliest;
+
+    // Snap to the vsync grid
+    if (vsync != 0 && target > vsync)
+        target = vsync + ((target - vsync + period / 2) / period) * period;
+    if (target <= lastPresentTime)
+        target = lastPresentTime + period;
+
+    // Emulation runs ahead of the display, don't let the queue grow
+    if (pacingMode == FRAME_PACING_LOW_LATENCY && target - now > (vsyncsPerFrame + 1) * period)
+        return false;
+
+    // Ask for half a period before the vsync so that timing jitter can't push the frame one vsync later
+    ptrEglPresentationTimeANDROID(display, surface, target - period / 2);
+    lastPresentTime = target;
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef __AE_FRAMEPACING_H__
+#define __AE_FRAMEPACING_H__
+
+#include <EGL/egl.h>
+
+// Frame pacing modes, must match the displayFramePacing preference values
+enum FramePacingMode {
+    FRAME_PACING_OFF = 0,         // Swap as soon as the frame is done
+    FRAME_PACING_SMOOTH = 1,      // Present each frame on the vsync grid at a steady cadence
+    FRAME_PACING_LOW_LATENCY = 2  // Like smooth, but queue at most one vsync ahead and drop late frames
+};
+
+void framePacingSetMode(int mode);
+
+// Schedules presentation of the next frame, returns false if the frame should be dropped
+bool framePacingBeforeSwap(EGLDisplay display, EGLSurface surface);
+
+// Forgets the cadence history, used after the surface changed or emulation was paused
+void framePacingReset();
+
+#endif
@@ -19,6 +19,8 @@
  * Authors: Paul Lamb, littleguy77
  */
 
+#include <atomic>
+#include <mutex>
 #include "SDL.h"
 #include "ae_imports.h"
 
@@ -28,12 +30,13 @@
 
 JavaVM* mJavaVM;
 
-// Imported java class reference
-static jclass mActivityClass;
-
-// Imported java method references
-static jmethodID midStateCallback;
-static jmethodID midFPSCounter;
+// Status posted by the emulation and render threads. Java polls it from its own thread through
+// NativeExports.readStatus, so posting never needs a JNI call on those threads.
+static std::atomic<int> mStatusFps(-1);
+static std::mutex mStatusEventsLock;
+static int mStatusEvents[2 * AE_STATUS_MAX_EVENTS];
+static int mStatusEventFirst = 0;
+static int mStatusEventCount = 0;
 
 /*******************************************************************************
  Functions called automatically by JNI framework
@@ -54,21 +57,16 @@ extern DECLSPEC void Android_JNI_InitImports(JNIEnv* env, jclass cls)
 {
     LOGI("Android_JNI_InitImports()");
 
-    mActivityClass = (jclass) env->NewGlobalRef(cls);
-    midStateCallback = env->GetStaticMethodID(mActivityClass, "stateCallback", "(II)V");
-    midFPSCounter = env->GetStaticMethodID(mActivityClass, "FPSCounter", "(I)V");
-    if (!midStateCallback || !midFPSCounter)
-    {
-        LOGE("Couldn't locate Java callbacks, check that they're named and typed correctly");
-    }
+    std::lock_guard<std::mutex> guard(mStatusEventsLock);
+    mStatusFps = -1;
+    mStatusEventFirst = 0;
+    mStatusEventCount = 0;
 }
 
 // Called by ae-exports
 extern DECLSPEC void Android_JNI_DestroyImports(JNIEnv* env)
 {
     LOGI("Android_JNI_DestroyImports()");
-
-    env->DeleteGlobalRef(mActivityClass);
 }
 
 extern DECLSPEC void Android_JNI_StateCallback(void* context, m64p_core_param paramChanged, int newValue)
@@ -94,18 +92,45 @@ extern DECLSPEC void Android_JNI_StateCallback(void* context, m64p_core_param pa
 	 *            (successful)   1
 	 *            (unsuccessful) 0
      */
-    JNIEnv *env;
-    if (mJavaVM->GetEnv((void**) &env, JNI_VERSION_1_6) != JNI_OK)
-        return;
-    env->CallStaticVoidMethod(mActivityClass, midStateCallback, (int) paramChanged, newValue);
+    std::lock_guard<std::mutex> guard(mStatusEventsLock);
+
+    // Java has not polled for a while, the oldest changes are the least relevant
+    if (mStatusEventCount == AE_STATUS_MAX_EVENTS)
+    {
+        LOGW("Dropping state change %d, Java is not reading the status", mStatusEvents[2 * mStatusEventFirst]);
+        mStatusEventFirst = (mStatusEventFirst + 1) % AE_STATUS_MAX_EVENTS;
+        --mStatusEventCount;
+    }
+
+    int i = (mStatusEventFirst + mStatusEventCount) % AE_STATUS_MAX_EVENTS;
+    mStatusEvents[2 * i] = (int) paramChanged;
+    mStatusEvents[2 * i + 1] = newValue;
+    ++mStatusEventCount;
 }
 
 extern DECLSPEC void Android_JNI_FPSCounter(int fps)
 {
-    JNIEnv *env;
-    if (mJavaVM->GetEnv((void**) &env, JNI_VERSION_1_6) != JNI_OK) {
-        mJavaVM->AttachCurrentThread(&env, NULL);
-        return;
+    mStatusFps.store(fps, std::memory_order_relaxed);
+}
+
+extern DECLSPEC int Android_JNI_ReadStatus(int* status, int size)
+{
+    if (size < AE_STATUS_SIZE)
+        return 0;
+
+    status[AE_STATUS_FPS] = mStatusFps.exchange(-1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard(mStatusEventsLock);
+    for (int n = 0; n < mStatusEventCount; n++)
+    {
+        int i = (mStatusEventFirst + n) % AE_STATUS_MAX_EVENTS;
+        status[AE_STATUS_EVENTS + 2 * n] = mStatusEvents[2 * i];
+        status[AE_STATUS_EVENTS + 2 * n + 1] = mStatusEvents[2 * i + 1];
     }
-    env->CallStaticVoidMethod(mActivityClass, midFPSCounter, fps);
+    status[AE_STATUS_EVENT_COUNT] = mStatusEventCount;
+
+    int count = AE_STATUS_EVENTS + 2 * mStatusEventCount;
+    mStatusEventFirst = 0;
+    mStatusEventCount = 0;
+    return count;
 }
\ No newline at end of file
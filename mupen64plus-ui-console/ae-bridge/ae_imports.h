@@ -36,6 +36,13 @@
 #define printf(...) LOGV(__VA_ARGS__)
 #endif
 
+// Layout of the status block filled by Android_JNI_ReadStatus, keep in sync with NativeImports.java
+#define AE_STATUS_FPS           0   // frame rate measured since the last read, or -1
+#define AE_STATUS_EVENT_COUNT   1   // number of state changes that follow
+#define AE_STATUS_EVENTS        2   // pairs of changed parameter and new value, oldest first
+#define AE_STATUS_MAX_EVENTS    16
+#define AE_STATUS_SIZE          (AE_STATUS_EVENTS + 2 * AE_STATUS_MAX_EVENTS)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +62,9 @@ extern void         Android_JNI_StateCallback(void* context, m64p_core_param par
 
 // Called by ae-vidext
 extern void         Android_JNI_FPSCounter(int fps);
+
+// Called by ae-exports, moves the status posted since the last call to status
+extern int          Android_JNI_ReadStatus(int* status, int size);
 #ifdef __cplusplus
 }
 #endif
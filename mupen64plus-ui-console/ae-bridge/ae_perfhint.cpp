@@ -0,0 +1,164 @@
+#include "ae_perfhint.h"
+#include "ae_imports.h"
+#include <dlfcn.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+
+// APerformanceHint is only available since API 33 and minSdkVersion is lower, so load it at runtime
+struct APerformanceHintManager;
+struct APerformanceHintSession;
+typedef APerformanceHintManager* (*PFN_APerformanceHint_getManager)();
+typedef APerformanceHintSession* (*PFN_APerformanceHint_createSession)(APerformanceHintManager* manager, const int32_t* threadIds, size_t size, int64_t initialTargetWorkDurationNanos);
+typedef int (*PFN_APerformanceHint_updateTargetWorkDuration)(APerformanceHintSession* session, int64_t targetDurationNanos);
+typedef int (*PFN_APerformanceHint_reportActualWorkDuration)(APerformanceHintSession* session, int64_t actualDurationNanos);
+typedef void (*PFN_APerformanceHint_closeSession)(APerformanceHintSession* session);
+
+static PFN_APerformanceHint_getManager ptrAPerformanceHint_getManager = nullptr;
+static PFN_APerformanceHint_createSession ptrAPerformanceHint_createSession = nullptr;
+static PFN_APerformanceHint_updateTargetWorkDuration ptrAPerformanceHint_updateTargetWorkDuration = nullptr;
+static PFN_APerformanceHint_reportActualWorkDuration ptrAPerformanceHint_reportActualWorkDuration = nullptr;
+static PFN_APerformanceHint_closeSession ptrAPerformanceHint_closeSession = nullptr;
+
+static std::mutex sessionAccess;
+static std::atomic<int64_t> viPeriod(0);
+static int32_t emuThread = 0;
+static bool sessionFailed = false;
+
+// Only used by the thread swapping buffers, under sessionAccess
+static APerformanceHintSession* session = nullptr;
+static int32_t renderThread = 0;
+static int64_t lastSwapTime = 0;
+static int64_t lastCpuTime = 0;
+static int64_t frameInterval = 0;
+static int64_t visPerFrame = 1;
+
+static const int64_t maxFrameInterval = 250000000LL;
+static const int64_t maxVisPerFrame = 4;
+
+static int64_t getTime(clockid_t clock)
+{
+    struct timespec spec;
+    clock_gettime(clock, &spec);
+    return (int64_t) spec.tv_sec * 1000000000LL + spec.tv_nsec;
+}
+
+static bool loadPerformanceHint()
+{
+    if (ptrAPerformanceHint_getManager != nullptr)
+        return true;
+
+    void* libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+    if (libandroid == nullptr)
+        return false;
+
+    ptrAPerformanceHint_createSession = (PFN_APerformanceHint_createSession) dlsym(libandroid, "APerformanceHint_createSession");
+    ptrAPerformanceHint_updateTargetWorkDuration = (PFN_APerformanceHint_updateTargetWorkDuration) dlsym(libandroid, "APerformanceHint_updateTargetWorkDuration");
+    ptrAPerformanceHint_reportActualWorkDuration = (PFN_APerformanceHint_reportActualWorkDuration) dlsym(libandroid, "APerformanceHint_reportActualWorkDuration");
+    ptrAPerformanceHint_closeSession = (PFN_APerformanceHint_closeSession) dlsym(libandroid, "APerformanceHint_closeSession");
+
+    if (ptrAPerformanceHint_createSession == nullptr || ptrAPerformanceHint_updateTargetWorkDuration == nullptr ||
+        ptrAPerformanceHint_reportActualWorkDuration == nullptr || ptrAPerformanceHint_closeSession == nullptr)
+        return false;
+
+    ptrAPerformanceHint_getManager = (PFN_APerformanceHint_getManager) dlsym(libandroid, "APerformanceHint_getManager");
+    return ptrAPerformanceHint_getManager != nullptr;
+}
+
+static void closeSession()
+{
+    if (session != nullptr) {
+        ptrAPerformanceHint_closeSession(session);
+        session = nullptr;
+    }
+    renderThread = 0;
+    lastSwapTime = 0;
+    lastCpuTime = 0;
+    frameInterval = 0;
+    visPerFrame = 1;
+}
+
+void perfHintSetTarget(int64_t targetFrameNs)
+{
+    std::unique_lock<std::mutex> guard(sessionAccess);
+
+    closeSession();
+    viPeriod = 0;
+    sessionFailed = false;
+
+    if (targetFrameNs <= 0)
+        return;
+
+    if (!loadPerformanceHint()) {
+        LOGI("perfHint: APerformanceHint is not available, performance hints disabled");
+        return;
+    }
+
+    emuThread = gettid();
+    viPeriod = targetFrameNs;
+}
+
+void perfHintFrameDone()
+{
+    const int64_t period = viPeriod.load();
+    if (period == 0)
+        return;
+
+    std::unique_lock<std::mutex> guard(sessionAccess);
+
+    const int32_t thread = gettid();
+    if (session != nullptr && thread != renderThread)
+        closeSession();
+
+    if (session == nullptr) {
+        if (sessionFailed)
+            return;
+
+        // With a threaded video plugin the buffers are swapped from another thread than the emulation one
+        const int32_t threads[2] = { emuThread, thread };
+        APerformanceHintManager* manager = ptrAPerformanceHint_getManager();
+        if (manager != nullptr)
+            session = ptrAPerformanceHint_createSession(manager, threads, emuThread == thread ? 1 : 2, period);
+
+        if (session == nullptr) {
+            LOGE("perfHint: APerformanceHint_createSession() failed");
+            sessionFailed = true;
+            return;
+        }
+
+        renderThread = thread;
+        lastSwapTime = getTime(CLOCK_MONOTONIC);
+        lastCpuTime = getTime(CLOCK_THREAD_CPUTIME_ID);
+        return;
+    }
+
+    // Thread CPU time leaves out the speed limiter sleep and time blocked in the swap
+    const int64_t now = getTime(CLOCK_MONOTONIC);
+    const int64_t cpuTime = getTime(CLOCK_THREAD_CPUTIME_ID);
+    const int64_t interval = now - lastSwapTime;
+    const int64_t work = cpuTime - lastCpuTime;
+    lastSwapTime = now;
+    lastCpuTime = cpuTime;
+
+    // Long stall, e.g. pausing or loading a state: don't report it
+    if (interval >= maxFrameInterval) {
+        frameInterval = 0;
+        return;
+    }
+
+    // Games rendering at 30 or 20 fps swap every 2 or 3 VIs, their frames get that much time
+    frameInterval = frameInterval == 0 ? interval : frameInterval + (interval - frameInterval) / 8;
+    int64_t vis = (frameInterval + period / 2) / period;
+    if (vis < 1)
+        vis = 1;
+    if (vis > maxVisPerFrame)
+        vis = maxVisPerFrame;
+    if (vis != visPerFrame) {
+        ptrAPerformanceHint_updateTargetWorkDuration(session, vis * period);
+        visPerFrame = vis;
+    }
+
+    if (work > 0)
+        ptrAPerformanceHint_reportActualWorkDuration(session, work);
+}
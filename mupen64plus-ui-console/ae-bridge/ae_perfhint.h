@@ -0,0 +1,13 @@
+#ifndef __AE_PERFHINT_H__
+#define __AE_PERFHINT_H__
+
+#include <stdint.h>
+
+// Starts reporting frame work durations for the calling (emulation) thread, targetFrameNs is
+// the VI period of the game. 0 stops reporting.
+void perfHintSetTarget(int64_t targetFrameNs);
+
+// Reports the work done for the frame being presented, called by the thread swapping buffers
+void perfHintFrameDone();
+
+#endif
@@ -1,6 +1,8 @@
 #include <GL/EGLLoader.h>
 #include "ae_vidext.h"
 #include "ae_imports.h"
+#include "ae_framepacing.h"
+#include "ae_perfhint.h"
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 #include <android/native_window.h>
@@ -69,6 +71,15 @@ size_t FindIndex( const EGLint a[], size_t size, int value )
     return ( index == (size/sizeof(EGLint)) ? -1 : index );
 }
 
+// Every frame is redrawn from scratch, so don't make tiled GPUs preserve the previous one
+static EGLSurface CreateWindowSurface()
+{
+    EGLSurface windowSurface = eglCreateWindowSurface(display, config, (EGLNativeWindowType)native_window, windowAttribList);
+    if (windowSurface != EGL_NO_SURFACE)
+        eglSurfaceAttrib(display, windowSurface, EGL_SWAP_BEHAVIOR, EGL_BUFFER_DESTROYED);
+    return windowSurface;
+}
+
 extern DECLSPEC m64p_error VidExtFuncInit()
 {
 	std::unique_lock<std::mutex> guard(nativeWindowAccess);
@@ -138,7 +149,7 @@ extern DECLSPEC m64p_error VidExtFuncSetMode(int Width, int Height, int BitsPerP
 		{
 			LOGI("VidExtFuncSetMode: Initializing surface");
 
-			if (!(surface = eglCreateWindowSurface(display, config, (EGLNativeWindowType)native_window, windowAttribList)))
+			if (!(surface = CreateWindowSurface()))
 			{
 				LOGE("eglCreateWindowSurface() returned error %d", eglGetError());
 				return M64ERR_INVALID_STATE;
@@ -336,7 +347,7 @@ extern DECLSPEC m64p_error VidExtFuncGLSwapBuf()
 
 			LOGI("VidExtFuncGLSwapBuf: New surface has been detected");
 
-			if (!(surface = eglCreateWindowSurface(display, config, (EGLNativeWindowType)native_window, windowAttribList))) {
+			if (!(surface = CreateWindowSurface())) {
 				LOGE("eglCreateWindowSurface() returned error %d", eglGetError());
 				return M64ERR_INVALID_STATE;
 			}
@@ -353,6 +364,7 @@ extern DECLSPEC m64p_error VidExtFuncGLSwapBuf()
 			}
 
 			eglSwapInterval(display, vsync);
+			framePacingReset();
 
 			new_surface = false;
 		}
@@ -364,9 +376,11 @@ extern DECLSPEC m64p_error VidExtFuncGLSwapBuf()
 				oldVsync = vsync;
 			}
 
-			if (!isPaused) {
+			if (!isPaused && framePacingBeforeSwap(display, surface)) {
 				eglSwapBuffers(display, surface);
 			}
+
+			perfHintFrameDone();
 		}
 	}
 
@@ -475,6 +489,16 @@ extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_
     FPSRecalcPeriod = recalc;
 }
 
+extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_setFramePacing(JNIEnv* env, jclass cls, int mode)
+{
+    framePacingSetMode(mode);
+}
+
+extern "C" DECLSPEC void Java_paulscode_android_mupen64plusae_jni_NativeExports_setPerformanceHint(JNIEnv* env, jclass cls, jlong targetFrameNs)
+{
+    perfHintSetTarget(targetFrameNs);
+}
+
 extern DECLSPEC void vsyncEnabled(int enabled)
 {
     vsync = enabled;
@@ -15,9 +15,12 @@ LOCAL_C_INCLUDES :=         \
     $(AE_BRIDGE_INCLUDES)   \
 
 LOCAL_SRC_FILES :=                      \
+    $(SRCDIR)/async_log.c               \
+    $(SRCDIR)/autotune.c                \
     $(SRCDIR)/cheat.c                   \
     $(SRCDIR)/compare_core.c            \
     $(SRCDIR)/core_interface.c          \
+    $(SRCDIR)/lockstep.c                \
     $(SRCDIR)/main.c                    \
     $(SRCDIR)/osal_dynamiclib_unix.c    \
     $(SRCDIR)/osal_files_unix.c         \
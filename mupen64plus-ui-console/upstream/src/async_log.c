@@ -0,0 +1,245 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - async_log.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+/* This file takes the writing of debug messages off the threads producing them.
+ * The core and every plugin log through DebugCallback(): messages are copied to
+ * a bounded ring and a thread writes them to stdout/logcat, so verbose logging
+ * costs the emulation and render threads a copy rather than a synchronous write.
+ *
+ * The ring is a multi-producer queue with a sequence number per slot: producers
+ * claim a slot with a compare-and-swap on the head, then publish it by bumping
+ * its sequence. The writer is the only consumer.
+ */
+
+#include <string.h>
+
+#include <SDL.h>
+#include <SDL_thread.h>
+
+#include "async_log.h"
+
+#if SDL_VERSION_ATLEAST(2,0,0)
+
+#define LOG_SLOTS     512        /* must be a power of two */
+#define LOG_CONTEXT   32
+#define LOG_MESSAGE   1024
+
+typedef struct {
+    SDL_atomic_t seq;
+    int          level;
+    char         context[LOG_CONTEXT];
+    char         message[LOG_MESSAGE];
+} log_slot;
+
+static log_slot        l_Ring[LOG_SLOTS];
+static SDL_atomic_t    l_Head;      /* next slot to claim */
+static SDL_atomic_t    l_Tail;      /* next slot to write */
+static SDL_atomic_t    l_Running;
+static SDL_atomic_t    l_Producers; /* async_log_push() calls in flight */
+static SDL_sem        *l_Ready = NULL;
+static SDL_Thread     *l_Writer = NULL;
+static async_log_sink  l_Sink = NULL;
+
+/* difference of two slot positions, which wrap around */
+static int pos_diff(int a, int b)
+{
+    return (int) ((unsigned int) a - (unsigned int) b);
+}
+
+static void copy_string(char *dst, const char *src, size_t size)
+{
+    size_t length = strlen(src);
+
+    if (length > size - 1)
+        length = size - 1;
+
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+}
+
+/* writes the published messages in order, returns the number written */
+static int drain(void)
+{
+    int count = 0;
+    int pos = SDL_AtomicGet(&l_Tail);
+
+    for (;;)
+    {
+        log_slot *slot = &l_Ring[pos & (LOG_SLOTS - 1)];
+
+        if (pos_diff(SDL_AtomicGet(&slot->seq), pos) != 1)
+            break;
+
+        (*l_Sink)(slot->context, slot->level, slot->message);
+
+        /* hand the slot back to the producers, one lap later */
+        SDL_AtomicSet(&slot->seq, (int) ((unsigned int) pos + LOG_SLOTS));
+        pos = (int) ((unsigned int) pos + 1);
+        SDL_AtomicSet(&l_Tail, pos);
+        count++;
+    }
+
+    return count;
+}
+
+static int SDLCALL writer_loop(void *unused)
+{
+    while (SDL_AtomicGet(&l_Running))
+    {
+        SDL_SemWait(l_Ready);
+        drain();
+    }
+
+    return 0;
+}
+
+int async_log_start(async_log_sink sink)
+{
+    int i;
+
+    if (l_Writer != NULL)
+        return 1;
+
+    for (i = 0; i < LOG_SLOTS; i++)
+        SDL_AtomicSet(&l_Ring[i].seq, i);
+    SDL_AtomicSet(&l_Head, 0);
+    SDL_AtomicSet(&l_Tail, 0);
+    l_Sink = sink;
+
+    l_Ready = SDL_CreateSemaphore(0);
+    if (l_Ready == NULL)
+        return 0;
+
+    SDL_AtomicSet(&l_Running, 1);
+    l_Writer = SDL_CreateThread(writer_loop, "LogWriter", NULL);
+    if (l_Writer == NULL)
+    {
+        SDL_AtomicSet(&l_Running, 0);
+        SDL_DestroySemaphore(l_Ready);
+        l_Ready = NULL;
+        return 0;
+    }
+
+    return 1;
+}
+
+void async_log_stop(void)
+{
+    if (l_Writer == NULL)
+        return;
+
+    SDL_AtomicSet(&l_Running, 0);
+    SDL_SemPost(l_Ready);
+    SDL_WaitThread(l_Writer, NULL);
+    l_Writer = NULL;
+
+    /* producers past the l_Running check may still post l_Ready */
+    while (SDL_AtomicGet(&l_Producers) != 0)
+        SDL_Delay(1);
+
+    /* messages published while the writer was exiting */
+    drain();
+
+    SDL_DestroySemaphore(l_Ready);
+    l_Ready = NULL;
+}
+
+static int queue_message(const char *Context, int level, const char *message)
+{
+    log_slot *slot;
+    int pos;
+
+    pos = SDL_AtomicGet(&l_Head);
+    for (;;)
+    {
+        int diff;
+
+        slot = &l_Ring[pos & (LOG_SLOTS - 1)];
+        diff = pos_diff(SDL_AtomicGet(&slot->seq), pos);
+
+        if (diff == 0)
+        {
+            if (SDL_AtomicCAS(&l_Head, pos, (int) ((unsigned int) pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            /* the ring is full: wait for the writer rather than lose the message */
+            if (!SDL_AtomicGet(&l_Running))
+                return 0;
+            SDL_Delay(1);
+        }
+
+        pos = SDL_AtomicGet(&l_Head);
+    }
+
+    slot->level = level;
+    copy_string(slot->context, (Context != NULL) ? Context : "", LOG_CONTEXT);
+    copy_string(slot->message, message, LOG_MESSAGE);
+
+    SDL_AtomicSet(&slot->seq, (int) ((unsigned int) pos + 1));
+    SDL_SemPost(l_Ready);
+
+    return 1;
+}
+
+int async_log_push(const char *Context, int level, const char *message)
+{
+    int queued;
+
+    /* counted before l_Running is checked, so that async_log_stop() waits for
+     * this call before it destroys l_Ready */
+    SDL_AtomicAdd(&l_Producers, 1);
+    queued = SDL_AtomicGet(&l_Running) ? queue_message(Context, level, message) : 0;
+    SDL_AtomicAdd(&l_Producers, -1);
+
+    return queued;
+}
+
+void async_log_flush(void)
+{
+    while (SDL_AtomicGet(&l_Running) && SDL_AtomicGet(&l_Tail) != SDL_AtomicGet(&l_Head))
+        SDL_Delay(1);
+}
+
+#else /* SDL 1.2 has no atomics: messages are written by the threads logging them */
+
+int async_log_start(async_log_sink sink)
+{
+    return 0;
+}
+
+void async_log_stop(void)
+{
+}
+
+int async_log_push(const char *Context, int level, const char *message)
+{
+    return 0;
+}
+
+void async_log_flush(void)
+{
+}
+
+#endif
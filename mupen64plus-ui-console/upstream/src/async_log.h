@@ -0,0 +1,39 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - async_log.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+
+#if !defined(ASYNC_LOG_H)
+#define ASYNC_LOG_H
+
+typedef void (*async_log_sink)(const char *Context, int level, const char *message);
+
+/* starts the thread writing queued messages to sink, returns non-zero on success.
+ * Without it (or with SDL 1.2), async_log_push() refuses every message */
+int async_log_start(async_log_sink sink);
+/* writes out every queued message and stops the writer thread */
+void async_log_stop(void);
+/* queues a copy of the message, returns zero if the caller has to write it itself */
+int async_log_push(const char *Context, int level, const char *message);
+/* waits until every message queued so far has been written */
+void async_log_flush(void);
+
+#endif /* ASYNC_LOG_H */
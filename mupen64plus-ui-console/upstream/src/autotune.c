@@ -0,0 +1,499 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - autotune.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* This file tunes performance settings per ROM. Each run of a ROM without a
+ * finished profile plays with one candidate setting and times the frames of
+ * the first minutes of play with the core's timed sections. Once every
+ * candidate is measured, the ones beating the user's setting clearly are
+ * written to the profile and applied in all later runs.
+ *
+ * Only settings which don't change the emulation results are candidates,
+ * so CountPerOp and framebuffer emulation are left to the ROM database and
+ * the user. A candidate is marked as failed in the profile before it runs,
+ * so a setting crashing the emulator is never tried again or picked. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "autotune.h"
+#include "core_interface.h"
+#include "m64p_types.h"
+#include "main.h"
+#include "osal_preproc.h"
+#include "plugin.h"
+
+/* boot and intros are not timed, then about two minutes of play are */
+#define AUTOTUNE_WARMUP_VIS      3600
+#define AUTOTUNE_MEASURE_VIS     7200
+/* frame callbacks further apart were paused or loading and are not counted */
+#define AUTOTUNE_MAX_GAP_NS      250000000ULL
+/* how much faster than the user's setting a candidate has to be, in percent */
+#define AUTOTUNE_MIN_GAIN        5
+
+#define AUTOTUNE_MAX_CANDIDATES  8
+#define AUTOTUNE_MAX_ENTRIES     32
+#define AUTOTUNE_NAME_LEN        64
+
+typedef struct {
+    const char *section;    /* NULL for the user's settings */
+    const char *param;
+    int         value;
+    char        name[AUTOTUNE_NAME_LEN];
+} AutotuneCandidate;
+
+typedef enum {
+    ENTRY_MEASURED,
+    ENTRY_FAILED,           /* started but never finished */
+    ENTRY_APPLY             /* picked once all candidates were measured */
+} AutotuneEntryType;
+
+typedef struct {
+    AutotuneEntryType type;
+    char              name[AUTOTUNE_NAME_LEN];
+    double            ms;   /* busy time per VI of ENTRY_MEASURED */
+} AutotuneEntry;
+
+static AutotuneCandidate l_Candidates[AUTOTUNE_MAX_CANDIDATES];
+static int               l_CandidateCount = 0;
+static AutotuneEntry     l_Entries[AUTOTUNE_MAX_ENTRIES];
+static int               l_EntryCount = 0;
+static int               l_Done = 0;
+static char              l_ProfilePath[PATH_MAX];
+
+/* settings changed for this run, with the user's value they replaced */
+typedef struct {
+    const AutotuneCandidate *candidate;
+    int                      saved;
+} AutotuneOverride;
+
+static AutotuneOverride  l_Overrides[AUTOTUNE_MAX_CANDIDATES];
+static int               l_OverrideCount = 0;
+
+/* the candidate timed in this run */
+static const AutotuneCandidate *l_Measuring = NULL;
+
+static m64p_profile_timings l_Timings;
+static int                  l_TimingsStarted = 0;
+static unsigned long long   l_LastTotalNs = 0;
+static unsigned long long   l_LastBusyNs = 0;
+static unsigned int         l_LastVIs = 0;
+static unsigned long long   l_MeasuredNs = 0;
+static unsigned int         l_MeasuredVIs = 0;
+
+/*********************************************************************************************************
+* candidates
+*/
+
+static void AddCandidate(const char *Section, const char *Param, int Value)
+{
+    AutotuneCandidate *c;
+
+    if (l_CandidateCount >= AUTOTUNE_MAX_CANDIDATES)
+        return;
+
+    c = &l_Candidates[l_CandidateCount++];
+    c->section = Section;
+    c->param = Param;
+    c->value = Value;
+    if (Section == NULL)
+        snprintf(c->name, sizeof(c->name), "default");
+    else
+        snprintf(c->name, sizeof(c->name), "%s/%s=%i", Section, Param, Value);
+}
+
+static int GetIntParam(const char *Section, const char *Param, int *Value)
+{
+    m64p_handle Handle;
+    m64p_type Type;
+
+    if ((*ConfigOpenSection)(Section, &Handle) != M64ERR_SUCCESS
+     || (*ConfigGetParameterType)(Handle, Param, &Type) != M64ERR_SUCCESS
+     || Type != M64TYPE_INT)
+        return 0;
+
+    *Value = (*ConfigGetParamInt)(Handle, Param);
+    return 1;
+}
+
+static int SetIntParam(const char *Section, const char *Param, int Value)
+{
+    m64p_handle Handle;
+
+    return (*ConfigOpenSection)(Section, &Handle) == M64ERR_SUCCESS
+        && (*ConfigSetParameter)(Handle, Param, M64TYPE_INT, &Value) == M64ERR_SUCCESS;
+}
+
+static int ApplyCandidate(const AutotuneCandidate *c)
+{
+    AutotuneOverride *o;
+
+    if (c->section == NULL)
+        return 1;
+    if (l_OverrideCount >= AUTOTUNE_MAX_CANDIDATES)
+        return 0;
+
+    o = &l_Overrides[l_OverrideCount];
+    if (!GetIntParam(c->section, c->param, &o->saved) || !SetIntParam(c->section, c->param, c->value))
+        return 0;
+
+    o->candidate = c;
+    l_OverrideCount++;
+    return 1;
+}
+
+static void RestoreSettings(void)
+{
+    while (l_OverrideCount > 0)
+    {
+        const AutotuneOverride *o = &l_Overrides[--l_OverrideCount];
+        SetIntParam(o->candidate->section, o->candidate->param, o->saved);
+    }
+}
+
+static void BuildCandidates(void)
+{
+    int Value;
+
+    l_CandidateCount = 0;
+    AddCandidate(NULL, NULL, 0);
+
+    /* the pure interpreter is only ever picked on purpose */
+    if (GetIntParam("Core", "R4300Emulator", &Value) && Value != 0)
+        AddCandidate("Core", "R4300Emulator", Value == 1 ? 2 : 1);
+
+    /* angrylion renders the same image with any number of workers */
+    if (g_PluginMap[0].libname != NULL && strncmp(g_PluginMap[0].libname, "angrylion", 9) == 0
+     && GetIntParam("Video-AngrylionPlus", "NumWorkers", &Value))
+    {
+        static const int Workers[] = { 2, 4 };
+        int CPUs = 4;
+        unsigned int i;
+#if SDL_VERSION_ATLEAST(2,0,0)
+        CPUs = SDL_GetCPUCount();
+#endif
+        for (i = 0; i < sizeof(Workers) / sizeof(Workers[0]); i++)
+        {
+            if (Workers[i] != Value && Workers[i] < CPUs)
+                AddCandidate("Video-AngrylionPlus", "NumWorkers", Workers[i]);
+        }
+    }
+}
+
+static const AutotuneCandidate *FindCandidate(const char *Name)
+{
+    int i;
+
+    for (i = 0; i < l_CandidateCount; i++)
+    {
+        if (strcmp(l_Candidates[i].name, Name) == 0)
+            return &l_Candidates[i];
+    }
+    return NULL;
+}
+
+/*********************************************************************************************************
+* profile file
+*/
+
+static AutotuneEntry *FindEntry(const char *Name)
+{
+    int i;
+
+    for (i = 0; i < l_EntryCount; i++)
+    {
+        if (l_Entries[i].type != ENTRY_APPLY && strcmp(l_Entries[i].name, Name) == 0)
+            return &l_Entries[i];
+    }
+    return NULL;
+}
+
+static AutotuneEntry *AddEntry(AutotuneEntryType Type, const char *Name)
+{
+    AutotuneEntry *e;
+
+    if (l_EntryCount >= AUTOTUNE_MAX_ENTRIES)
+        return NULL;
+
+    e = &l_Entries[l_EntryCount++];
+    e->type = Type;
+    e->ms = 0.0;
+    snprintf(e->name, sizeof(e->name), "%s", Name);
+    return e;
+}
+
+/* lines are "done", "apply (name)", "(name) failed" or "(name) (ms per VI)" */
+static void ReadProfile(void)
+{
+    char Line[256], First[AUTOTUNE_NAME_LEN], Second[AUTOTUNE_NAME_LEN];
+    FILE *f;
+
+    l_EntryCount = 0;
+    l_Done = 0;
+
+    f = fopen(l_ProfilePath, "r");
+    if (f == NULL)
+        return;
+
+    while (fgets(Line, sizeof(Line), f) != NULL)
+    {
+        int Fields = sscanf(Line, "%63s %63s", First, Second);
+        AutotuneEntry *e;
+
+        if (Fields < 1 || First[0] == '#')
+            continue;
+
+        if (strcmp(First, "done") == 0)
+            l_Done = 1;
+        else if (Fields < 2)
+            continue;
+        else if (strcmp(First, "apply") == 0)
+            AddEntry(ENTRY_APPLY, Second);
+        else if (strcmp(Second, "failed") == 0)
+            AddEntry(ENTRY_FAILED, First);
+        else if ((e = AddEntry(ENTRY_MEASURED, First)) != NULL)
+            e->ms = atof(Second);
+    }
+
+    fclose(f);
+}
+
+static void WriteProfile(void)
+{
+    FILE *f;
+    int i;
+
+    f = fopen(l_ProfilePath, "w");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "couldn't write performance profile '%s'.", l_ProfilePath);
+        return;
+    }
+
+    fprintf(f, "# busy ms per VI of each setting, the applied ones once done\n");
+    for (i = 0; i < l_EntryCount; i++)
+    {
+        const AutotuneEntry *e = &l_Entries[i];
+
+        if (e->type == ENTRY_MEASURED)
+            fprintf(f, "%s %.3f\n", e->name, e->ms);
+        else if (e->type == ENTRY_FAILED)
+            fprintf(f, "%s failed\n", e->name);
+    }
+    if (l_Done)
+    {
+        fprintf(f, "done\n");
+        for (i = 0; i < l_EntryCount; i++)
+        {
+            if (l_Entries[i].type == ENTRY_APPLY)
+                fprintf(f, "apply %s\n", l_Entries[i].name);
+        }
+    }
+
+    fclose(f);
+}
+
+/* picks the fastest value of each parameter if it beats the user's one */
+static void FinishProfile(void)
+{
+    const AutotuneEntry *Default = FindEntry("default");
+    int i, j;
+
+    l_Done = 1;
+    if (Default == NULL || Default->type != ENTRY_MEASURED)
+        return;
+
+    for (i = 1; i < l_CandidateCount; i++)
+    {
+        const AutotuneCandidate *c = &l_Candidates[i];
+        const AutotuneEntry *e = FindEntry(c->name);
+        int Best = 1;
+
+        if (e == NULL || e->type != ENTRY_MEASURED
+         || e->ms * 100.0 > Default->ms * (100 - AUTOTUNE_MIN_GAIN))
+            continue;
+
+        for (j = 1; j < l_CandidateCount; j++)
+        {
+            const AutotuneCandidate *o = &l_Candidates[j];
+            const AutotuneEntry *oe = FindEntry(o->name);
+
+            if (j != i && strcmp(o->section, c->section) == 0 && strcmp(o->param, c->param) == 0
+             && oe != NULL && oe->type == ENTRY_MEASURED && (oe->ms < e->ms || (oe->ms == e->ms && j < i)))
+                Best = 0;
+        }
+
+        if (Best)
+        {
+            AddEntry(ENTRY_APPLY, c->name);
+            DebugMessage(M64MSG_INFO, "performance profile: %s is %.1f%% faster than the default.",
+                         c->name, 100.0 * (Default->ms - e->ms) / Default->ms);
+        }
+    }
+}
+
+/*********************************************************************************************************
+* public functions
+*/
+
+int autotune_start(const char *ProfileDir)
+{
+    m64p_rom_settings RomSettings;
+    const AutotuneCandidate *Next = NULL;
+    size_t DirLen;
+    int i;
+
+    if ((*CoreDoCommand)(M64CMD_ROM_GET_SETTINGS, sizeof(RomSettings), &RomSettings) != M64ERR_SUCCESS)
+    {
+        DebugMessage(M64MSG_WARNING, "couldn't get the ROM MD5, performance profiles are disabled.");
+        return 0;
+    }
+
+    DirLen = strlen(ProfileDir);
+    if (DirLen > 0 && ProfileDir[DirLen - 1] == OSAL_DIR_SEPARATOR)
+        snprintf(l_ProfilePath, sizeof(l_ProfilePath), "%s%s.profile", ProfileDir, RomSettings.MD5);
+    else
+        snprintf(l_ProfilePath, sizeof(l_ProfilePath), "%s%c%s.profile", ProfileDir, OSAL_DIR_SEPARATOR, RomSettings.MD5);
+
+    BuildCandidates();
+    ReadProfile();
+
+    if (!l_Done)
+    {
+        for (i = 0; i < l_CandidateCount && Next == NULL; i++)
+        {
+            if (FindEntry(l_Candidates[i].name) == NULL)
+                Next = &l_Candidates[i];
+        }
+
+        /* only the last run was missing */
+        if (Next == NULL)
+        {
+            FinishProfile();
+            WriteProfile();
+        }
+    }
+
+    if (l_Done)
+    {
+        for (i = 0; i < l_EntryCount; i++)
+        {
+            const AutotuneCandidate *c;
+
+            if (l_Entries[i].type != ENTRY_APPLY)
+                continue;
+            c = FindCandidate(l_Entries[i].name);
+            if (c != NULL && ApplyCandidate(c))
+                DebugMessage(M64MSG_INFO, "performance profile: using %s", c->name);
+        }
+        return 0;
+    }
+
+    /* kept as failed if this run never gets to autotune_finish() */
+    AddEntry(ENTRY_FAILED, Next->name);
+    WriteProfile();
+
+    if (!ApplyCandidate(Next))
+        return 0;
+    l_Measuring = Next;
+
+    memset(&l_Timings, 0, sizeof(l_Timings));
+    l_TimingsStarted = 0;
+    l_MeasuredNs = 0;
+    l_MeasuredVIs = 0;
+    if ((*CoreDoCommand)(M64CMD_PROFILE_TIMINGS, sizeof(l_Timings), &l_Timings) != M64ERR_SUCCESS)
+    {
+        DebugMessage(M64MSG_WARNING, "core can't time frames, performance profiles are disabled.");
+        autotune_finish();
+        return 0;
+    }
+
+    DebugMessage(M64MSG_INFO, "performance profile: measuring %s", Next->name);
+    return 1;
+}
+
+void autotune_frame(void)
+{
+    unsigned long long TotalNs, BusyNs;
+    unsigned int VIs;
+
+    if (l_Measuring == NULL || l_MeasuredVIs >= AUTOTUNE_MEASURE_VIS || l_Timings.vi_count == 0)
+        return;
+
+    /* the speed limiter and audio output wait on the host, not on the settings */
+    TotalNs = l_Timings.total_ns;
+    BusyNs = TotalNs - l_Timings.idle_ns - l_Timings.audio_ns;
+    VIs = l_Timings.vi_count;
+
+    if (l_TimingsStarted && VIs > AUTOTUNE_WARMUP_VIS && TotalNs - l_LastTotalNs < AUTOTUNE_MAX_GAP_NS)
+    {
+        l_MeasuredNs += BusyNs - l_LastBusyNs;
+        l_MeasuredVIs += VIs - l_LastVIs;
+    }
+
+    l_TimingsStarted = 1;
+    l_LastTotalNs = TotalNs;
+    l_LastBusyNs = BusyNs;
+    l_LastVIs = VIs;
+}
+
+void autotune_finish(void)
+{
+    const AutotuneCandidate *c = l_Measuring;
+    AutotuneEntry *e;
+    int i;
+
+    RestoreSettings();
+
+    if (c == NULL)
+        return;
+    l_Measuring = NULL;
+
+    (*CoreDoCommand)(M64CMD_PROFILE_TIMINGS, 0, NULL);
+
+    e = FindEntry(c->name);
+    if (e == NULL)
+        return;
+
+    if (l_MeasuredVIs >= AUTOTUNE_MEASURE_VIS)
+    {
+        e->type = ENTRY_MEASURED;
+        e->ms = l_MeasuredNs / 1e6 / l_MeasuredVIs;
+        DebugMessage(M64MSG_INFO, "performance profile: %s takes %.3f ms per VI", c->name, e->ms);
+    }
+    else
+    {
+        /* played too short to tell, try again next time */
+        *e = l_Entries[--l_EntryCount];
+    }
+
+    for (i = 0; i < l_CandidateCount; i++)
+    {
+        if (FindEntry(l_Candidates[i].name) == NULL)
+            break;
+    }
+    if (i == l_CandidateCount)
+        FinishProfile();
+
+    WriteProfile();
+}
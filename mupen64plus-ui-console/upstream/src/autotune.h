@@ -0,0 +1,37 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - autotune.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if !defined(AUTOTUNE_H)
+#define AUTOTUNE_H
+
+/* applies the tuned settings of the opened ROM from its profile in ProfileDir,
+ * or the next candidate setting still to be measured, and starts timing it.
+ * Must be called after the plugins are attached and before the emulation runs.
+ * Returns non-zero if the frame callback has to call autotune_frame(). */
+int autotune_start(const char *ProfileDir);
+/* accounts the frame time since the previous call, from the frame callback */
+void autotune_frame(void);
+/* stores the measurement in the profile and restores the user's settings,
+ * so they are not saved to the configuration file. Does nothing if
+ * autotune_start() changed nothing. */
+void autotune_finish(void);
+
+#endif /* AUTOTUNE_H */
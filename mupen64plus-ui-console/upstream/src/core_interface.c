@@ -89,6 +89,7 @@ ptr_ConfigGetUserCachePath      ConfigGetUserCachePath = NULL;
 /* definitions of pointers to Core debugger functions */
 ptr_DebugSetCallbacks      DebugSetCallbacks = NULL;
 ptr_DebugSetCoreCompare    DebugSetCoreCompare = NULL;
+ptr_DebugSetCoreLockstep   DebugSetCoreLockstep = NULL;
 ptr_DebugSetRunState       DebugSetRunState = NULL;
 ptr_DebugGetState          DebugGetState = NULL;
 ptr_DebugStep              DebugStep = NULL;
@@ -277,6 +278,7 @@ m64p_error AttachCoreLib(const char *CoreLibFilepath)
     /* get function pointers to the debugger functions */
     DebugSetCallbacks = (ptr_DebugSetCallbacks) osal_dynlib_getproc(CoreHandle, "DebugSetCallbacks");
     DebugSetCoreCompare = (ptr_DebugSetCoreCompare) osal_dynlib_getproc(CoreHandle, "DebugSetCoreCompare");
+    DebugSetCoreLockstep = (ptr_DebugSetCoreLockstep) osal_dynlib_getproc(CoreHandle, "DebugSetCoreLockstep");
     DebugSetRunState = (ptr_DebugSetRunState) osal_dynlib_getproc(CoreHandle, "DebugSetRunState");
     DebugGetState = (ptr_DebugGetState) osal_dynlib_getproc(CoreHandle, "DebugGetState");
     DebugStep = (ptr_DebugStep) osal_dynlib_getproc(CoreHandle, "DebugStep");
@@ -344,6 +346,7 @@ m64p_error DetachCoreLib(void)
 
     DebugSetCallbacks = NULL;
     DebugSetCoreCompare = NULL;
+    DebugSetCoreLockstep = NULL;
     DebugSetRunState = NULL;
     DebugGetState = NULL;
     DebugStep = NULL;
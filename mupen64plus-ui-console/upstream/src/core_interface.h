@@ -82,6 +82,7 @@ extern ptr_ConfigGetUserCachePath      ConfigGetUserCachePath;
 /* declarations of pointers to Core debugger functions */
 extern ptr_DebugSetCallbacks      DebugSetCallbacks;
 extern ptr_DebugSetCoreCompare    DebugSetCoreCompare;
+extern ptr_DebugSetCoreLockstep   DebugSetCoreLockstep;
 extern ptr_DebugSetRunState       DebugSetRunState;
 extern ptr_DebugGetState          DebugGetState;
 extern ptr_DebugStep              DebugStep;
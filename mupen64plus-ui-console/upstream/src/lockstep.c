@@ -0,0 +1,336 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - lockstep.c                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+/* This file runs two R4300 emulators in lockstep: the UI process (the target)
+ * compares its state against a forked copy of itself (the reference) at every
+ * interrupt event, reports the first point where they diverge and how fast
+ * each of them ran.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "core_interface.h"
+#include "lockstep.h"
+#include "m64p_types.h"
+#include "main.h"
+
+#if !defined(WIN32)
+
+/* the RDRAM is hashed every this many sync points */
+#define LOCKSTEP_RDRAM_INTERVAL  64
+
+#define CP0_COUNT_REG            9
+
+typedef struct {
+    unsigned int       sync;
+    unsigned int       event_type;
+    unsigned int       pc;
+    unsigned int       has_rdram_hash;
+    unsigned long long rdram_hash;
+    unsigned long long emu_ns;      /* time spent emulating up to this sync point */
+    long long          reg[32];
+    long long          hi;
+    long long          lo;
+    unsigned int       cop0[32];
+    long long          fgr[32];
+} lockstep_state;
+
+/* local variables */
+static LockstepRole l_Role = LOCKSTEP_DISABLE;
+static FILE *l_Pipe = NULL;
+static pid_t l_ReferencePid = -1;
+static int l_EmuMode[3] = { -1, -1, -1 };   /* indexed by LockstepRole */
+
+static unsigned int l_SyncCount = 0;
+static unsigned long long l_EmuNs = 0;
+static unsigned long long l_LastSyncNs = 0;
+static unsigned long long l_ReferenceEmuNs = 0;
+static unsigned int l_LastRdramMatch = 0;
+static unsigned int l_RegisterMismatches = 0;
+static int l_Diverged = 0;
+
+static const char *EmuModeName(int EmuMode)
+{
+    switch (EmuMode)
+    {
+        case 0:  return "pure interpreter";
+        case 1:  return "cached interpreter";
+        case 2:  return "dynamic recompiler";
+        default: return "unknown emulator";
+    }
+}
+
+static unsigned long long lockstep_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static unsigned long long hash_rdram(const unsigned int *dram, unsigned int size)
+{
+    /* FNV-1a on 32-bit words */
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    unsigned int i;
+
+    for (i = 0; i < size / 4; i++)
+    {
+        hash ^= dram[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void get_state(lockstep_state *state, unsigned int event_type, unsigned int dram_size)
+{
+    const unsigned int *dram = (const unsigned int *) DebugMemGetPointer(M64P_DBG_PTR_RDRAM);
+
+    memset(state, 0, sizeof(*state));
+    state->sync = l_SyncCount;
+    state->event_type = event_type;
+    state->pc = *(unsigned int *) DebugGetCPUDataPtr(M64P_CPU_PC);
+    if (l_SyncCount % LOCKSTEP_RDRAM_INTERVAL == 0 && dram != NULL)
+    {
+        state->has_rdram_hash = 1;
+        state->rdram_hash = hash_rdram(dram, dram_size);
+    }
+    state->emu_ns = l_EmuNs;
+    memcpy(state->reg, DebugGetCPUDataPtr(M64P_CPU_REG_REG), sizeof(state->reg));
+    state->hi = *(long long *) DebugGetCPUDataPtr(M64P_CPU_REG_HI);
+    state->lo = *(long long *) DebugGetCPUDataPtr(M64P_CPU_REG_LO);
+    memcpy(state->cop0, DebugGetCPUDataPtr(M64P_CPU_REG_COP0), sizeof(state->cop0));
+    memcpy(state->fgr, DebugGetCPUDataPtr(M64P_CPU_REG_COP1_FGR_64), sizeof(state->fgr));
+}
+
+static int registers_differ(const lockstep_state *mine, const lockstep_state *ref)
+{
+    return memcmp(mine->reg, ref->reg, sizeof(mine->reg)) != 0 || mine->hi != ref->hi || mine->lo != ref->lo
+        || memcmp(mine->cop0, ref->cop0, sizeof(mine->cop0)) != 0 || memcmp(mine->fgr, ref->fgr, sizeof(mine->fgr)) != 0;
+}
+
+static void print_register_mismatch(const lockstep_state *mine, const lockstep_state *ref)
+{
+    int i;
+
+    printf("Lockstep: registers differ at sync %u (Count %08x, PC %08x), the dynamic recompiler may\n"
+           "          not have written back registers which are dead at this point:\n",
+           mine->sync, mine->cop0[CP0_COUNT_REG], mine->pc);
+    for (i = 0; i < 32; i++)
+    {
+        if (mine->reg[i] != ref->reg[i])
+            printf("    reg[%2d]  %016llx  reference %016llx\n", i, (unsigned long long) mine->reg[i], (unsigned long long) ref->reg[i]);
+    }
+    if (mine->hi != ref->hi)
+        printf("    hi       %016llx  reference %016llx\n", (unsigned long long) mine->hi, (unsigned long long) ref->hi);
+    if (mine->lo != ref->lo)
+        printf("    lo       %016llx  reference %016llx\n", (unsigned long long) mine->lo, (unsigned long long) ref->lo);
+    for (i = 0; i < 32; i++)
+    {
+        if (mine->cop0[i] != ref->cop0[i])
+            printf("    cop0[%2d] %08x          reference %08x\n", i, mine->cop0[i], ref->cop0[i]);
+    }
+    for (i = 0; i < 32; i++)
+    {
+        if (mine->fgr[i] != ref->fgr[i])
+            printf("    fgr[%2d]  %016llx  reference %016llx\n", i, (unsigned long long) mine->fgr[i], (unsigned long long) ref->fgr[i]);
+    }
+}
+
+static void compare_state(const lockstep_state *mine, const lockstep_state *ref)
+{
+    const char *what = NULL;
+
+    if (mine->event_type != ref->event_type)
+        what = "interrupt event";
+    else if (mine->cop0[CP0_COUNT_REG] != ref->cop0[CP0_COUNT_REG])
+        what = "Count register";
+    else if (mine->pc != ref->pc)
+        what = "program counter";
+    else if (mine->has_rdram_hash && ref->has_rdram_hash && mine->rdram_hash != ref->rdram_hash)
+        what = "RDRAM";
+
+    if (what != NULL)
+    {
+        printf("Lockstep: first divergence at sync %u, in the %s:\n", mine->sync, what);
+        printf("    target     event %2u  Count %08x  PC %08x\n", mine->event_type, mine->cop0[CP0_COUNT_REG], mine->pc);
+        printf("    reference  event %2u  Count %08x  PC %08x\n", ref->event_type, ref->cop0[CP0_COUNT_REG], ref->pc);
+        if (mine->event_type == ref->event_type && mine->cop0[CP0_COUNT_REG] == ref->cop0[CP0_COUNT_REG] && mine->pc == ref->pc)
+            printf("    RDRAM last matched at sync %u\n", l_LastRdramMatch);
+        if (registers_differ(mine, ref))
+            print_register_mismatch(mine, ref);
+        l_Diverged = 1;
+        (*CoreDoCommand)(M64CMD_STOP, 0, NULL);
+        return;
+    }
+
+    if (mine->has_rdram_hash && ref->has_rdram_hash)
+        l_LastRdramMatch = mine->sync;
+
+    if (registers_differ(mine, ref) && l_RegisterMismatches++ == 0)
+        print_register_mismatch(mine, ref);
+}
+
+static void lockstep_sync(unsigned int event_type, unsigned int dram_size)
+{
+    lockstep_state mine, ref;
+
+    /* time spent in here waiting for the other emulator or hashing doesn't count */
+    if (l_LastSyncNs != 0)
+        l_EmuNs += lockstep_time_ns() - l_LastSyncNs;
+
+    get_state(&mine, event_type, dram_size);
+
+    if (l_Role == LOCKSTEP_REFERENCE)
+    {
+        if (fwrite(&mine, sizeof(mine), 1, l_Pipe) != 1)
+        {
+            /* the target stopped */
+            DebugSetCoreLockstep(NULL);
+            (*CoreDoCommand)(M64CMD_STOP, 0, NULL);
+            return;
+        }
+    }
+    else
+    {
+        if (fread(&ref, sizeof(ref), 1, l_Pipe) != 1)
+        {
+            printf("Lockstep: reference emulator stopped at sync %u.\n", l_SyncCount);
+            DebugSetCoreLockstep(NULL);
+            (*CoreDoCommand)(M64CMD_STOP, 0, NULL);
+            return;
+        }
+        l_ReferenceEmuNs = ref.emu_ns;
+        compare_state(&mine, &ref);
+        if (l_Diverged)
+        {
+            DebugSetCoreLockstep(NULL);
+            return;
+        }
+    }
+
+    l_SyncCount++;
+    l_LastSyncNs = lockstep_time_ns();
+}
+
+#endif /* !WIN32 */
+
+/* global functions */
+LockstepRole lockstep_start(int TargetEmuMode, int ReferenceEmuMode)
+{
+#if defined(WIN32)
+    DebugMessage(M64MSG_ERROR, "--lockstep feature not supported on Windows platform.");
+    return LOCKSTEP_DISABLE;
+#else
+    int fds[2];
+
+    if (DebugSetCoreLockstep == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "can't use --lockstep feature with this Mupen64Plus core library.");
+        return LOCKSTEP_DISABLE;
+    }
+    if (pipe(fds) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "couldn't create the lockstep pipe.");
+        return LOCKSTEP_DISABLE;
+    }
+
+    fflush(stdout);
+    l_ReferencePid = fork();
+    if (l_ReferencePid < 0)
+    {
+        DebugMessage(M64MSG_ERROR, "couldn't fork the lockstep reference emulator.");
+        close(fds[0]);
+        close(fds[1]);
+        return LOCKSTEP_DISABLE;
+    }
+
+    if (l_ReferencePid == 0)
+    {
+        /* the target closing its end stops us instead of killing us */
+        signal(SIGPIPE, SIG_IGN);
+        close(fds[0]);
+        l_Pipe = fdopen(fds[1], "wb");
+        l_Role = LOCKSTEP_REFERENCE;
+    }
+    else
+    {
+        close(fds[1]);
+        l_Pipe = fdopen(fds[0], "rb");
+        l_Role = LOCKSTEP_TARGET;
+    }
+    l_EmuMode[LOCKSTEP_TARGET] = TargetEmuMode;
+    l_EmuMode[LOCKSTEP_REFERENCE] = ReferenceEmuMode;
+
+    if (l_Pipe == NULL || DebugSetCoreLockstep(lockstep_sync) != M64ERR_SUCCESS)
+    {
+        DebugMessage(M64MSG_ERROR, "couldn't set up the lockstep %s.", (l_Role == LOCKSTEP_REFERENCE) ? "reference" : "target");
+        if (l_Role == LOCKSTEP_REFERENCE)
+            _exit(1);
+        return LOCKSTEP_DISABLE;
+    }
+
+    if (l_Role == LOCKSTEP_TARGET)
+        DebugMessage(M64MSG_INFO, "Lockstep: comparing the %s against the %s (pid %i).",
+                     EmuModeName(TargetEmuMode), EmuModeName(ReferenceEmuMode), (int) l_ReferencePid);
+    return l_Role;
+#endif
+}
+
+int lockstep_finish(void)
+{
+#if defined(WIN32)
+    return 0;
+#else
+    if (l_Role == LOCKSTEP_DISABLE)
+        return 0;
+
+    DebugSetCoreLockstep(NULL);
+    fclose(l_Pipe);
+    l_Pipe = NULL;
+
+    if (l_Role == LOCKSTEP_REFERENCE)
+        return 0;
+
+    waitpid(l_ReferencePid, NULL, 0);
+
+    printf("\nLockstep report: %u sync points compared, %s\n", l_SyncCount,
+           l_Diverged ? "emulators diverged" : "no divergence");
+    if (l_RegisterMismatches > 0)
+        printf("    registers differed at %u sync points\n", l_RegisterMismatches);
+    printf("    target:    %-18s  %10.3f s emulating\n", EmuModeName(l_EmuMode[LOCKSTEP_TARGET]), l_EmuNs / 1e9);
+    printf("    reference: %-18s  %10.3f s emulating\n", EmuModeName(l_EmuMode[LOCKSTEP_REFERENCE]), l_ReferenceEmuNs / 1e9);
+    if (l_EmuNs > 0 && l_ReferenceEmuNs > 0)
+        printf("    the target ran %.2fx as fast as the reference\n", (double) l_ReferenceEmuNs / l_EmuNs);
+    printf("\n");
+
+    return l_Diverged;
+#endif
+}
@@ -0,0 +1,39 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - lockstep.h                                              *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#if !defined(LOCKSTEP_H)
+#define LOCKSTEP_H
+
+typedef enum {
+  LOCKSTEP_DISABLE = 0,
+  LOCKSTEP_TARGET = 1,     /* compares its state against the reference */
+  LOCKSTEP_REFERENCE = 2   /* forked process sending its state to the target */
+} LockstepRole;
+
+/* forks the reference emulator and returns the role of the calling process,
+ * or LOCKSTEP_DISABLE on error */
+LockstepRole lockstep_start(int TargetEmuMode, int ReferenceEmuMode);
+/* prints the lockstep report in the target process and waits for the reference to exit,
+ * returns non-zero if the two emulators diverged */
+int lockstep_finish(void);
+
+#endif /* LOCKSTEP_H */
@@ -34,16 +34,22 @@
 #include <SDL_main.h>
 #include <SDL_thread.h>
 
+#include "async_log.h"
+#include "autotune.h"
 #include "cheat.h"
 #include "compare_core.h"
 #include "core_interface.h"
 #include "debugger.h"
+#include "lockstep.h"
 #include "m64p_types.h"
 #include "main.h"
 #include "osal_preproc.h"
 #include "osal_files.h"
 #include "plugin.h"
 #include "version.h"
+#ifdef M64P_HEADLESS
+#include "vidext_headless.h"
+#endif
 
 #ifdef VIDEXT_HEADER
 #define xstr(s) str(s)
@@ -54,6 +60,10 @@
 /* Version number for UI-Console config section parameters */
 #define CONFIG_PARAM_VERSION     1.00
 
+/* frames kept by the core for the --benchmark slowest frames list */
+#define BENCHMARK_FRAME_HISTORY  1024
+#define BENCHMARK_SLOWEST_FRAMES 5
+
 /** global variables **/
 int    g_Verbose = 0;
 
@@ -68,6 +78,10 @@ static const char *l_CoreLibPath = NULL;
 static const char *l_ConfigDirPath = NULL;
 static const char *l_ROMFilepath = NULL;       // filepath of ROM to load & run at startup
 static const char *l_SaveStatePath = NULL;     // save state to load at startup
+static const char *l_InputLogPath = NULL;      // input log to record or replay
+static const char *l_ProfileTracePath = NULL;  // Chrome trace of the last profiled frames, written at exit
+static const char *l_AutotuneDir = NULL;       // directory of the per-ROM performance profiles
+static m64p_input_log_mode l_InputLogMode = M64INPUT_LOG_STOP;
 
 #if defined(SHAREDIR)
   static const char *l_DataDirPath = SHAREDIR;
@@ -77,9 +91,16 @@ static const char *l_SaveStatePath = NULL;     // save state to load at startup
 
 static int  *l_TestShotList = NULL;      // list of screenshots to take for regression test support
 static int   l_TestShotIdx = 0;          // index of next screenshot frame in list
+static int   l_AutotuneActive = 0;       // a setting is timed for the performance profile
 static int   l_SaveOptions = 1;          // save command-line options in configuration file (enabled by default)
 static int   l_CoreCompareMode = 0;      // 0 = disable, 1 = send, 2 = receive
 static int   l_LaunchDebugger = 0;
+#ifdef M64P_HEADLESS
+static int   l_Headless = 0;          // render offscreen through EGL instead of opening a window
+#endif
+static int   l_BenchmarkVIs = 0;      // number of VIs to time with --benchmark, 0 = disabled
+static int   l_LockstepEmuMode = -1;  // reference emulator of --lockstep, -1 = disabled
+static LockstepRole l_LockstepRole = LOCKSTEP_DISABLE;
 
 static eCheatMode l_CheatMode = CHEAT_DISABLE;
 static char      *l_CheatNumList = NULL;
@@ -101,45 +122,56 @@ void DebugMessage(int level, const char *message, ...)
   va_end(args);
 }
 
-void DebugCallback(void *Context, int level, const char *message)
+static void WriteDebugMessage(const char *Context, int level, const char *message)
 {
 #ifdef ANDROID
     if (level == M64MSG_ERROR)
-        __android_log_print(ANDROID_LOG_ERROR, (const char *) Context, "%s", message);
+        __android_log_print(ANDROID_LOG_ERROR, Context, "%s", message);
     else if (level == M64MSG_WARNING)
-        __android_log_print(ANDROID_LOG_WARN, (const char *) Context, "%s", message);
+        __android_log_print(ANDROID_LOG_WARN, Context, "%s", message);
     else if (level == M64MSG_INFO)
-        __android_log_print(ANDROID_LOG_INFO, (const char *) Context, "%s", message);
+        __android_log_print(ANDROID_LOG_INFO, Context, "%s", message);
     else if (level == M64MSG_STATUS)
-        __android_log_print(ANDROID_LOG_DEBUG, (const char *) Context, "%s", message);
+        __android_log_print(ANDROID_LOG_DEBUG, Context, "%s", message);
     else if (level == M64MSG_VERBOSE)
-    {
-        if (g_Verbose)
-            __android_log_print(ANDROID_LOG_VERBOSE, (const char *) Context, "%s", message);
-    }
+        __android_log_print(ANDROID_LOG_VERBOSE, Context, "%s", message);
     else
-        __android_log_print(ANDROID_LOG_ERROR, (const char *) Context, "Unknown: %s", message);
+        __android_log_print(ANDROID_LOG_ERROR, Context, "Unknown: %s", message);
 #else
     if (level == M64MSG_ERROR)
-        printf("%s Error: %s\n", (const char *) Context, message);
+        printf("%s Error: %s\n", Context, message);
     else if (level == M64MSG_WARNING)
-        printf("%s Warning: %s\n", (const char *) Context, message);
+        printf("%s Warning: %s\n", Context, message);
     else if (level == M64MSG_INFO)
-        printf("%s: %s\n", (const char *) Context, message);
+        printf("%s: %s\n", Context, message);
     else if (level == M64MSG_STATUS)
-        printf("%s Status: %s\n", (const char *) Context, message);
+        printf("%s Status: %s\n", Context, message);
     else if (level == M64MSG_VERBOSE)
-    {
-        if (g_Verbose)
-            printf("%s: %s\n", (const char *) Context, message);
-    }
+        printf("%s: %s\n", Context, message);
     else
-        printf("%s Unknown: %s\n", (const char *) Context, message);
+        printf("%s Unknown: %s\n", Context, message);
 #endif
 }
 
+void DebugCallback(void *Context, int level, const char *message)
+{
+    if (level == M64MSG_VERBOSE && !g_Verbose)
+        return;
+
+    /* the messages logged before an error are out before it, in case it is fatal */
+    if (level == M64MSG_ERROR)
+        async_log_flush();
+    else if (async_log_push((const char *) Context, level, message))
+        return;
+
+    WriteDebugMessage((const char *) Context, level, message);
+}
+
 static void FrameCallback(unsigned int FrameIndex)
 {
+    if (l_AutotuneActive)
+        autotune_frame();
+
     // take a screenshot if we need to
     if (l_TestShotList != NULL)
     {
@@ -361,6 +393,7 @@ static void printUsage(const char *progname)
            "    --fullscreen           : use fullscreen display mode\n"
            "    --windowed             : use windowed display mode\n"
            "    --resolution (res)     : display resolution (640x480, 800x600, 1024x768, etc)\n"
+           "    --headless             : render offscreen without a window (requires build with HEADLESS=1)\n"
            "    --nospeedlimit         : disable core speed limiter (should be used with dummy audio plugin)\n"
            "    --cheats (cheat-spec)  : enable or list cheat codes for the given rom file\n"
            "    --corelib (filepath)   : use core library (filepath) (can be only filename or full path)\n"
@@ -376,6 +409,11 @@ static void printUsage(const char *progname)
            "    --emumode (mode)       : set emu mode to: 0=Pure Interpreter 1=Interpreter 2=DynaRec\n"
            "    --savestate (filepath) : savestate loaded at startup\n"
            "    --testshots (list)     : take screenshots at frames given in comma-separated (list), then quit\n"
+           "    --benchmark (count)    : run (count) VIs without speed limit, then quit and print timings\n"
+           "    --record-input (file)  : record controller input to (file), one entry per VI\n"
+           "    --replay-input (file)  : replay controller input recorded in (file)\n"
+           "    --profile-trace (file) : write a Chrome/Perfetto trace of the last profiled frames to (file) at exit\n"
+           "    --autotune (dir)       : time performance settings per ROM and keep the fastest in a profile in (dir)\n"
            "    --set (param-spec)     : set a configuration variable, format: ParamSection[ParamName]=Value\n"
            "    --gb-rom-{1,2,3,4}     : define GB cart rom to load inside transferpak {1,2,3,4}\n"
            "    --gb-ram-{1,2,3,4}     : define GB cart ram to load inside transferpak {1,2,3,4}\n"
@@ -383,6 +421,7 @@ static void printUsage(const char *progname)
            "    --dd-disk              : define disk to load into the disk drive\n"
            "    --core-compare-send    : use the Core Comparison debugging feature, in data sending mode\n"
            "    --core-compare-recv    : use the Core Comparison debugging feature, in data receiving mode\n"
+           "    --lockstep (emumode)   : run a copy of the emulator with (emumode) and compare against it at every interrupt\n"
            "    --nosaveoptions        : do not save the given command-line options in configuration file\n"
            "    --verbose              : print lots of information\n"
            "    --help                 : see this help message\n\n"
@@ -541,6 +580,15 @@ static int ParseCommandLineInitial(int argc, const char **argv)
             l_DataDirPath = argv[i+1];
             i++;
         }
+        else if (strcmp(argv[i], "--headless") == 0)
+        {
+#ifdef M64P_HEADLESS
+            l_Headless = 1;
+#else
+            DebugMessage(M64MSG_ERROR, "--headless is not supported, this front-end was built without HEADLESS=1");
+            return 1;
+#endif
+        }
         else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
         {
             printUsage(argv[0]);
@@ -595,6 +643,9 @@ static m64p_error ParseCommandLineFinal(int argc, const char **argv)
         {   /* these are handled in ParseCommandLineInitial */
             i++;
         }
+        else if (strcmp(argv[i], "--headless") == 0)
+        {   /* handled in ParseCommandLineInitial */
+        }
         else if (strcmp(argv[i], "--resolution") == 0 && ArgsLeft >= 1)
         {
             const char *res = argv[i+1];
@@ -677,6 +728,35 @@ static m64p_error ParseCommandLineFinal(int argc, const char **argv)
             l_TestShotList = ParseNumberList(argv[i+1], NULL);
             i++;
         }
+        else if (strcmp(argv[i], "--benchmark") == 0 && ArgsLeft >= 1)
+        {
+            int EnableSpeedLimit = 0;
+            l_BenchmarkVIs = atoi(argv[i+1]);
+            i++;
+            if (l_BenchmarkVIs <= 0)
+            {
+                DebugMessage(M64MSG_ERROR, "invalid --benchmark VI count '%s'", argv[i]);
+                return M64ERR_INPUT_INVALID;
+            }
+            if ((*CoreDoCommand)(M64CMD_CORE_STATE_SET, M64CORE_SPEED_LIMITER, &EnableSpeedLimit) != M64ERR_SUCCESS)
+                DebugMessage(M64MSG_WARNING, "core gave error while disabling the speed limiter for --benchmark");
+        }
+        else if ((strcmp(argv[i], "--record-input") == 0 || strcmp(argv[i], "--replay-input") == 0) && ArgsLeft >= 1)
+        {
+            l_InputLogMode = (strcmp(argv[i], "--record-input") == 0) ? M64INPUT_LOG_RECORD : M64INPUT_LOG_REPLAY;
+            l_InputLogPath = argv[i+1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--profile-trace") == 0 && ArgsLeft >= 1)
+        {
+            l_ProfileTracePath = argv[i+1];
+            i++;
+        }
+        else if (strcmp(argv[i], "--autotune") == 0 && ArgsLeft >= 1)
+        {
+            l_AutotuneDir = argv[i+1];
+            i++;
+        }
         else if (strcmp(argv[i], "--set") == 0 && ArgsLeft >= 1)
         {
             if (SetConfigParameter(argv[i+1]) != 0)
@@ -695,6 +775,16 @@ static m64p_error ParseCommandLineFinal(int argc, const char **argv)
         {
             l_CoreCompareMode = 2;
         }
+        else if (strcmp(argv[i], "--lockstep") == 0 && ArgsLeft >= 1)
+        {
+            l_LockstepEmuMode = atoi(argv[i+1]);
+            i++;
+            if (l_LockstepEmuMode < 0 || l_LockstepEmuMode > 2)
+            {
+                DebugMessage(M64MSG_ERROR, "invalid --lockstep emumode '%s'", argv[i]);
+                return M64ERR_INPUT_INVALID;
+            }
+        }
         else if (strcmp(argv[i], "--nosaveoptions") == 0)
         {
             l_SaveOptions = 0;
@@ -837,6 +927,114 @@ static m64p_media_loader l_media_loader =
 };
 
 
+/*********************************************************************************************************
+ *  Benchmark report
+ */
+
+static int CompareFrameTimes(const void *a, const void *b)
+{
+    unsigned long long x = *(const unsigned long long *) a;
+    unsigned long long y = *(const unsigned long long *) b;
+    return (x > y) - (x < y);
+}
+
+/* nearest-rank percentile of a sorted list */
+static double FrameTimePercentile(const unsigned long long *Sorted, unsigned int Count, unsigned int Percent)
+{
+    unsigned int idx = (unsigned int) (((unsigned long long) Count * Percent + 99) / 100);
+    if (idx > 0)
+        idx--;
+    return Sorted[idx] / 1e6;
+}
+
+static void PrintBenchmarkLine(const char *Name, unsigned long long Time, const m64p_profile_timings *Timings)
+{
+    printf("    %-12s %9.3f s %8.3f ms/VI %6.2f%%\n", Name, Time / 1e9,
+           Time / 1e6 / Timings->vi_count, 100.0 * Time / Timings->total_ns);
+}
+
+static int CompareSlowestFrames(const void *a, const void *b)
+{
+    unsigned long long x = ((const m64p_profile_frame *) a)->total_ns;
+    unsigned long long y = ((const m64p_profile_frame *) b)->total_ns;
+    return (x < y) - (x > y);
+}
+
+/* where the time of the slowest recent frames went */
+static void PrintSlowestFrames(void)
+{
+    static const char * const SectionNames[M64PROFILE_SECTION_COUNT] = {
+        "cpu", "recompiler", "interrupts", "DoRspCycles", "ProcessDList", "ProcessRDPList",
+        "UpdateScreen", "ProcessAList", "audio samples", "speed limiter"
+    };
+    m64p_profile_frames Frames;
+    unsigned int i, j;
+
+    Frames.capacity = BENCHMARK_FRAME_HISTORY;
+    Frames.count = 0;
+    Frames.frames = (m64p_profile_frame *) malloc(sizeof(m64p_profile_frame) * Frames.capacity);
+    if (Frames.frames == NULL)
+        return;
+    if ((*CoreDoCommand)(M64CMD_PROFILE_FRAMES, sizeof(Frames), &Frames) != M64ERR_SUCCESS || Frames.count == 0)
+    {
+        free(Frames.frames);
+        return;
+    }
+
+    qsort(Frames.frames, Frames.count, sizeof(Frames.frames[0]), CompareSlowestFrames);
+    printf("Slowest of the last %u frames (ms):\n", Frames.count);
+    for (i = 0; i < Frames.count && i < BENCHMARK_SLOWEST_FRAMES; i++)
+    {
+        const m64p_profile_frame *Frame = &Frames.frames[i];
+        printf("    VI %-7u %8.3f =", Frame->vi, Frame->total_ns / 1e6);
+        for (j = 0; j < M64PROFILE_SECTION_COUNT; j++)
+        {
+            if (Frame->section_ns[j] >= 10000)
+                printf(" %s %.2f", SectionNames[j], Frame->section_ns[j] / 1e6);
+        }
+        printf("\n");
+    }
+    printf("\n");
+
+    free(Frames.frames);
+}
+
+static void PrintBenchmarkReport(m64p_profile_timings *Timings)
+{
+    unsigned int count = Timings->vi_count;
+    unsigned long long sum = 0;
+    unsigned int i;
+
+    if (count == 0 || Timings->total_ns == 0)
+    {
+        DebugMessage(M64MSG_ERROR, "emulation stopped before any VI could be timed.");
+        return;
+    }
+    if (count < Timings->vi_limit)
+        DebugMessage(M64MSG_WARNING, "emulation stopped after %u of %u VIs.", count, Timings->vi_limit);
+
+    printf("\nBenchmark: %u VIs in %.3f s (%.2f VI/s)\n", count, Timings->total_ns / 1e9, count * 1e9 / Timings->total_ns);
+    PrintBenchmarkLine("cpu", Timings->cpu_ns, Timings);
+    PrintBenchmarkLine("recompiler", Timings->compiler_ns, Timings);
+    PrintBenchmarkLine("interrupts", Timings->interrupt_ns, Timings);
+    PrintBenchmarkLine("rsp plugin", Timings->rsp_ns, Timings);
+    PrintBenchmarkLine("gfx plugin", Timings->gfx_ns, Timings);
+    PrintBenchmarkLine("audio plugin", Timings->audio_ns, Timings);
+    PrintBenchmarkLine("idle", Timings->idle_ns, Timings);
+
+    qsort(Timings->vi_ns, count, sizeof(Timings->vi_ns[0]), CompareFrameTimes);
+    for (i = 0; i < count; i++)
+        sum += Timings->vi_ns[i];
+    printf("Frame time (ms): mean %.3f, min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n\n",
+           sum / 1e6 / count, Timings->vi_ns[0] / 1e6,
+           FrameTimePercentile(Timings->vi_ns, count, 50),
+           FrameTimePercentile(Timings->vi_ns, count, 90),
+           FrameTimePercentile(Timings->vi_ns, count, 99),
+           Timings->vi_ns[count - 1] / 1e6);
+
+    PrintSlowestFrames();
+}
+
 /*********************************************************************************************************
 * main function
 */
@@ -852,13 +1050,7 @@ static m64p_media_loader l_media_loader =
 #define CALLBACK_FUNC NULL
 #endif
 
-#ifndef WIN32
-/* Allow external modules to call the main function as a library method.  This is useful for user
- * interfaces that simply layer on top of (rather than re-implement) UI-Console (e.g. mupen64plus-ae).
- */
-__attribute__ ((visibility("default")))
-#endif
-int main(int argc, char *argv[])
+static int RunFrontEnd(int argc, char *argv[])
 {
     int i;
 
@@ -887,15 +1079,30 @@ int main(int argc, char *argv[])
         return 3;
     }
 
-#ifdef VIDEXT_HEADER
-    rval = CoreOverrideVidExt(&vidExtFunctions);
-    if (rval != M64ERR_SUCCESS)
+#ifdef M64P_HEADLESS
+    if (l_Headless)
     {
-        DebugMessage(M64MSG_ERROR, "couldn't start VidExt library.");
-        DetachCoreLib();
-        return 14;
+        rval = CoreOverrideVidExt(&g_HeadlessVidExt);
+        if (rval != M64ERR_SUCCESS)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't start headless VidExt.");
+            DetachCoreLib();
+            return 14;
+        }
     }
+    else
 #endif
+    {
+#ifdef VIDEXT_HEADER
+        rval = CoreOverrideVidExt(&vidExtFunctions);
+        if (rval != M64ERR_SUCCESS)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't start VidExt library.");
+            DetachCoreLib();
+            return 14;
+        }
+#endif
+    }
 
     /* Open configuration sections */
     rval = OpenConfigurationHandles();
@@ -936,51 +1143,100 @@ int main(int argc, char *argv[])
     if (l_SaveOptions)
         SaveConfigurationOptions();
 
-    /* load ROM image */
-    FILE *fPtr = fopen(l_ROMFilepath, "rb");
-    if (fPtr == NULL)
+    /* fork the reference emulator for --lockstep, both copies must take the same interrupts */
+    if (l_LockstepEmuMode >= 0)
     {
-        DebugMessage(M64MSG_ERROR, "couldn't open ROM file '%s' for reading.", l_ROMFilepath);
-        (*CoreShutdown)();
-        DetachCoreLib();
-        return 7;
+        int EmuMode = (*ConfigGetParamInt)(l_ConfigCore, "R4300Emulator");
+        int RandomizeInterrupt = 0;
+        int EnableSpeedLimit = 0;
+        (*ConfigSetParameter)(l_ConfigCore, "RandomizeInterrupt", M64TYPE_BOOL, &RandomizeInterrupt);
+        (*CoreDoCommand)(M64CMD_CORE_STATE_SET, M64CORE_SPEED_LIMITER, &EnableSpeedLimit);
+        /* the writer thread would not survive the fork in the reference */
+        async_log_stop();
+        l_LockstepRole = lockstep_start(EmuMode, l_LockstepEmuMode);
+        async_log_start(WriteDebugMessage);
+        if (l_LockstepRole == LOCKSTEP_DISABLE)
+        {
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 17;
+        }
+        if (l_LockstepRole == LOCKSTEP_REFERENCE)
+        {
+            /* leave the outputs to the target */
+            (*ConfigSetParameter)(l_ConfigCore, "R4300Emulator", M64TYPE_INT, &l_LockstepEmuMode);
+            l_SaveOptions = 0;
+            l_ProfileTracePath = NULL;
+            if (l_InputLogMode == M64INPUT_LOG_RECORD)
+                l_InputLogMode = M64INPUT_LOG_STOP;
+            if (l_TestShotList != NULL)
+            {
+                free(l_TestShotList);
+                l_TestShotList = NULL;
+            }
+        }
     }
 
-    /* get the length of the ROM, allocate memory buffer, load it from disk */
-    long romlength = 0;
-    fseek(fPtr, 0L, SEEK_END);
-    romlength = ftell(fPtr);
-    fseek(fPtr, 0L, SEEK_SET);
-    unsigned char *ROM_buffer = (unsigned char *) malloc(romlength);
+    /* load ROM image
+     * mapping the file avoids holding a second full copy of the image in
+     * anonymous memory while the core makes its own copy */
+    size_t romlength = 0;
+    int rom_mapped = 1;
+    unsigned char *ROM_buffer = (unsigned char *) osal_file_map(l_ROMFilepath, &romlength);
     if (ROM_buffer == NULL)
     {
-        DebugMessage(M64MSG_ERROR, "couldn't allocate %li-byte buffer for ROM image file '%s'.", romlength, l_ROMFilepath);
-        fclose(fPtr);
-        (*CoreShutdown)();
-        DetachCoreLib();
-        return 8;
-    }
-    else if (fread(ROM_buffer, 1, romlength, fPtr) != romlength)
-    {
-        DebugMessage(M64MSG_ERROR, "couldn't read %li bytes from ROM image file '%s'.", romlength, l_ROMFilepath);
-        free(ROM_buffer);
+        rom_mapped = 0;
+
+        FILE *fPtr = fopen(l_ROMFilepath, "rb");
+        if (fPtr == NULL)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't open ROM file '%s' for reading.", l_ROMFilepath);
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 7;
+        }
+
+        /* get the length of the ROM, allocate memory buffer, load it from disk */
+        fseek(fPtr, 0L, SEEK_END);
+        romlength = ftell(fPtr);
+        fseek(fPtr, 0L, SEEK_SET);
+        ROM_buffer = (unsigned char *) malloc(romlength);
+        if (ROM_buffer == NULL)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't allocate %li-byte buffer for ROM image file '%s'.", (long) romlength, l_ROMFilepath);
+            fclose(fPtr);
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 8;
+        }
+        else if (fread(ROM_buffer, 1, romlength, fPtr) != romlength)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't read %li bytes from ROM image file '%s'.", (long) romlength, l_ROMFilepath);
+            free(ROM_buffer);
+            fclose(fPtr);
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 9;
+        }
         fclose(fPtr);
-        (*CoreShutdown)();
-        DetachCoreLib();
-        return 9;
     }
-    fclose(fPtr);
 
     /* Try to load the ROM image into the core */
-    if ((*CoreDoCommand)(M64CMD_ROM_OPEN, (int) romlength, ROM_buffer) != M64ERR_SUCCESS)
+    rval = (*CoreDoCommand)(M64CMD_ROM_OPEN, (int) romlength, ROM_buffer);
+
+    /* the core copies the ROM image, so we can release this buffer immediately */
+    if (rom_mapped)
+        osal_file_unmap(ROM_buffer, romlength);
+    else
+        free(ROM_buffer);
+
+    if (rval != M64ERR_SUCCESS)
     {
         DebugMessage(M64MSG_ERROR, "core failed to open ROM image file '%s'.", l_ROMFilepath);
-        free(ROM_buffer);
         (*CoreShutdown)();
         DetachCoreLib();
         return 10;
     }
-    free(ROM_buffer); /* the core copies the ROM image, so we can release this buffer immediately */
 
     /* handle the cheat codes */
     CheatStart(l_CheatMode, l_CheatNumList);
@@ -1039,6 +1295,42 @@ int main(int argc, char *argv[])
         }
     }
 
+    /* record or replay controller input, from the savestate on if one was given */
+    if (l_InputLogPath != NULL)
+    {
+        if ((*CoreDoCommand)(M64CMD_INPUT_LOG, l_InputLogMode, (void *) l_InputLogPath) != M64ERR_SUCCESS)
+        {
+            DebugMessage(M64MSG_ERROR, "couldn't %s input log '%s'.",
+                         l_InputLogMode == M64INPUT_LOG_RECORD ? "record" : "replay", l_InputLogPath);
+            (*CoreDoCommand)(M64CMD_ROM_CLOSE, 0, NULL);
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 15;
+        }
+    }
+
+    /* time the given number of VIs, the core stops the emulator after the last one */
+    m64p_profile_timings BenchTimings;
+    memset(&BenchTimings, 0, sizeof(BenchTimings));
+    if (l_BenchmarkVIs > 0 || l_ProfileTracePath != NULL)
+    {
+        if (l_BenchmarkVIs > 0)
+        {
+            BenchTimings.vi_limit = (unsigned int) l_BenchmarkVIs;
+            BenchTimings.vi_ns = (unsigned long long *) malloc(sizeof(unsigned long long) * l_BenchmarkVIs);
+        }
+        if ((l_BenchmarkVIs > 0 && BenchTimings.vi_ns == NULL)
+         || (*CoreDoCommand)(M64CMD_PROFILE_TIMINGS, sizeof(BenchTimings), &BenchTimings) != M64ERR_SUCCESS)
+        {
+            DebugMessage(M64MSG_ERROR, "can't use --benchmark or --profile-trace features with this Mupen64Plus core library.");
+            free(BenchTimings.vi_ns);
+            (*CoreDoCommand)(M64CMD_ROM_CLOSE, 0, NULL);
+            (*CoreShutdown)();
+            DetachCoreLib();
+            return 16;
+        }
+    }
+
     /* Setup debugger */
     if (l_LaunchDebugger)
     {
@@ -1061,9 +1353,45 @@ int main(int argc, char *argv[])
 #endif
     }
 
+    /* apply or measure the settings of the performance profile, the other
+     * profiling options need the core's timings for themselves */
+    if (l_AutotuneDir != NULL)
+    {
+        if (l_BenchmarkVIs > 0 || l_ProfileTracePath != NULL || l_LockstepRole != LOCKSTEP_DISABLE)
+            DebugMessage(M64MSG_WARNING, "--autotune can't be used with --benchmark, --profile-trace or --lockstep.");
+        else
+            l_AutotuneActive = autotune_start(l_AutotuneDir);
+
+        if (l_AutotuneActive && l_TestShotList == NULL
+         && (*CoreDoCommand)(M64CMD_SET_FRAME_CALLBACK, 0, FrameCallback) != M64ERR_SUCCESS)
+        {
+            DebugMessage(M64MSG_WARNING, "couldn't set frame callback, --autotune will not measure.");
+        }
+    }
+
     /* run the game */
     (*CoreDoCommand)(M64CMD_EXECUTE, 0, NULL);
 
+    if (l_AutotuneDir != NULL)
+    {
+        autotune_finish();
+        l_AutotuneActive = 0;
+    }
+
+    int LockstepDiverged = lockstep_finish();
+
+    if (l_BenchmarkVIs > 0)
+    {
+        if (l_LockstepRole != LOCKSTEP_REFERENCE)
+            PrintBenchmarkReport(&BenchTimings);
+        free(BenchTimings.vi_ns);
+    }
+    if (l_ProfileTracePath != NULL)
+    {
+        if ((*CoreDoCommand)(M64CMD_PROFILE_TRACE_DUMP, 0, (void *) l_ProfileTracePath) != M64ERR_SUCCESS)
+            DebugMessage(M64MSG_WARNING, "couldn't write profile trace '%s'.", l_ProfileTracePath);
+    }
+
     /* detach plugins from core and unload them */
     for (i = 0; i < 4; i++)
         (*CoreDetachPlugin)(g_PluginMap[i].type);
@@ -1084,6 +1412,23 @@ int main(int argc, char *argv[])
     if (l_TestShotList != NULL)
         free(l_TestShotList);
 
-    return 0;
+    return LockstepDiverged ? 17 : 0;
 }
 
+#ifndef WIN32
+/* Allow external modules to call the main function as a library method.  This is useful for user
+ * interfaces that simply layer on top of (rather than re-implement) UI-Console (e.g. mupen64plus-ae).
+ */
+__attribute__ ((visibility("default")))
+#endif
+int main(int argc, char *argv[])
+{
+    int rval;
+
+    /* debug messages from the core and the plugins are written by a separate thread */
+    async_log_start(WriteDebugMessage);
+    rval = RunFrontEnd(argc, argv);
+    async_log_stop();
+
+    return rval;
+}
@@ -60,5 +60,10 @@ extern const char *osal_libsearchpath[];
 extern osal_lib_search *osal_library_search(const char *searchpath);
 extern void             osal_free_lib_list(osal_lib_search *head);
 
+/* functions for mapping a whole file read-only in memory.
+ * Pages are loaded by the OS on demand, and can be dropped under memory pressure */
+extern void *osal_file_map(const char *filepath, size_t *size);
+extern void  osal_file_unmap(void *data, size_t size);
+
 #endif /* #define OSAL_FILES_H */
 
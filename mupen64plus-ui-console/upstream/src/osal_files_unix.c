@@ -28,7 +28,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include "m64p_types.h"
 #include "main.h"
@@ -112,3 +116,33 @@ void osal_free_lib_list(osal_lib_search *head)
     }
 }
 
+void *osal_file_map(const char *filepath, size_t *size)
+{
+    struct stat st;
+    void *data;
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* the mapping keeps a reference to the file */
+    if (data == MAP_FAILED)
+        return NULL;
+
+    /* the core reads the image once, from start to end */
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    *size = st.st_size;
+    return data;
+}
+
+void osal_file_unmap(void *data, size_t size)
+{
+    munmap(data, size);
+}
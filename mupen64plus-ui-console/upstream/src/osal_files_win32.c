@@ -104,3 +104,37 @@ void osal_free_lib_list(osal_lib_search *head)
         head = next;
     }
 }
+
+void *osal_file_map(const char *filepath, size_t *size)
+{
+    LARGE_INTEGER filesize;
+    HANDLE mapping;
+    void *data;
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &filesize) || filesize.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); /* the view keeps a reference to the mapping */
+    if (data == NULL)
+        return NULL;
+
+    *size = (size_t) filesize.QuadPart;
+    return data;
+}
+
+void osal_file_unmap(void *data, size_t size)
+{
+    UnmapViewOfFile(data);
+}
@@ -104,17 +104,20 @@ static m64p_error PluginLoadTry(const char *filepath, int MapIndex)
     return M64ERR_SUCCESS;
 }
 
-/* global functions */
-m64p_error PluginSearchLoad(m64p_handle ConfigUI)
+/* list the libraries in the plugin search directory, the first time one of them is needed */
+static m64p_error PluginDirSearch(m64p_handle ConfigUI, osal_lib_search **lib_filelist, int *searched)
 {
-    osal_lib_search *lib_filelist = NULL;
     int i;
 
+    if (*searched)
+        return M64ERR_SUCCESS;
+    *searched = 1;
+
     /* start by checking the directory given on the command line */
     if (g_PluginDir != NULL)
     {
-        lib_filelist = osal_library_search(g_PluginDir);
-        if (lib_filelist == NULL)
+        *lib_filelist = osal_library_search(g_PluginDir);
+        if (*lib_filelist == NULL)
         {
             DebugMessage(M64MSG_ERROR, "No plugins found in --plugindir path: %s", g_PluginDir);
             return M64ERR_INPUT_NOT_FOUND;
@@ -122,15 +125,15 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
     }
 
     /* if no plugins found, search the PluginDir in the UI-console section of the config file */
-    if (lib_filelist == NULL)
+    if (*lib_filelist == NULL)
     {
         const char *plugindir = (*ConfigGetParamString)(ConfigUI, "PluginDir");
-        lib_filelist = osal_library_search(plugindir);
+        *lib_filelist = osal_library_search(plugindir);
     }
 
     /* for MacOS, look for plugins in the Frameworks folder of the app bundle */
 #if defined(__APPLE__)
-    if (lib_filelist == NULL)
+    if (*lib_filelist == NULL)
     {
         CFBundleRef mainBundle = CFBundleGetMainBundle();
         if (mainBundle != NULL)
@@ -143,7 +146,7 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
                 {
                     strcat(libPath, "/");
                     DebugMessage(M64MSG_INFO, "Searching for plugins at: %s", libPath);
-                    lib_filelist = osal_library_search(libPath);
+                    *lib_filelist = osal_library_search(libPath);
                 }
                 CFRelease(frameworksURL);
             }
@@ -152,17 +155,29 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
 #endif
 
     /* if still no plugins found, search some common system folders */
-    if (lib_filelist == NULL)
+    if (*lib_filelist == NULL)
     {
         for (i = 0; i < osal_libsearchdirs; i++)
         {
-            lib_filelist = osal_library_search(osal_libsearchpath[i]);
-            if (lib_filelist != NULL)
+            *lib_filelist = osal_library_search(osal_libsearchpath[i]);
+            if (*lib_filelist != NULL)
                 break;
         }
     }
 
+    return M64ERR_SUCCESS;
+}
+
+/* global functions */
+m64p_error PluginSearchLoad(m64p_handle ConfigUI)
+{
+    osal_lib_search *lib_filelist = NULL;
+    int searched = 0;
+    m64p_error rval;
+    int i;
+
     /* try to load one of each type of plugin */
+    /* plugins given with a full path are loaded without listing the plugin search directory */
     for (i = 0; i < 4; i++)
     {
         m64p_plugin_type type = g_PluginMap[i].type;
@@ -191,7 +206,11 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
             }
             else /* otherwise search through the plugin directory to find a match with this name */
             {
-                osal_lib_search *curr = lib_filelist;
+                osal_lib_search *curr;
+                rval = PluginDirSearch(ConfigUI, &lib_filelist, &searched);
+                if (rval != M64ERR_SUCCESS)
+                    return rval;
+                curr = lib_filelist;
                 while (curr != NULL && g_PluginMap[i].handle == NULL)
                 {
                     if (strncmp(curr->filename, cmdline_path, strlen(cmdline_path)) == 0)
@@ -223,7 +242,11 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
                 }
                 else /* otherwise search through the plugin directory to find a match with this name */
                 {
-                    osal_lib_search *curr = lib_filelist;
+                    osal_lib_search *curr;
+                    rval = PluginDirSearch(ConfigUI, &lib_filelist, &searched);
+                    if (rval != M64ERR_SUCCESS)
+                        return rval;
+                    curr = lib_filelist;
                     while (curr != NULL && g_PluginMap[i].handle == NULL)
                     {
                         if (strncmp(curr->filename, config_path, strlen(config_path)) == 0)
@@ -236,7 +259,11 @@ m64p_error PluginSearchLoad(m64p_handle ConfigUI)
         /* As a last resort, search for any appropriate plugin in search directory */
         if (!use_dummy && g_PluginMap[i].handle == NULL)
         {
-            osal_lib_search *curr = lib_filelist;
+            osal_lib_search *curr;
+            rval = PluginDirSearch(ConfigUI, &lib_filelist, &searched);
+            if (rval != M64ERR_SUCCESS)
+                return rval;
+            curr = lib_filelist;
             while (curr != NULL && g_PluginMap[i].handle == NULL)
             {
                 PluginLoadTry(curr->filepath, i);
@@ -0,0 +1,388 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - vidext_headless.c                                       *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2018 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* This file contains the video extension functions used with --headless,
+ * which give the video plugin an offscreen EGL context instead of a window
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include "m64p_types.h"
+#include "main.h"
+#include "vidext_headless.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#ifndef EGL_CONTEXT_MAJOR_VERSION
+#define EGL_CONTEXT_MAJOR_VERSION 0x3098
+#define EGL_CONTEXT_MINOR_VERSION 0x30FB
+#define EGL_CONTEXT_OPENGL_PROFILE_MASK 0x30FD
+#define EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT 0x00000001
+#define EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT 0x00000002
+#endif
+#ifndef EGL_OPENGL_ES3_BIT
+#define EGL_OPENGL_ES3_BIT 0x00000040
+#endif
+/* GL_RGBA8_OES and GL_DEPTH24_STENCIL8_OES, core in desktop GL and GLES 3 */
+#define HEADLESS_COLOR_FORMAT 0x8058
+#define HEADLESS_DEPTH_FORMAT 0x88F0
+
+/* GL functions needed for the surfaceless framebuffer, looked up at runtime
+ * so that this doesn't tie the front-end to one GL library */
+typedef void   (GL_APIENTRY *ptr_glGenFramebuffers)(GLsizei, GLuint *);
+typedef void   (GL_APIENTRY *ptr_glDeleteFramebuffers)(GLsizei, const GLuint *);
+typedef void   (GL_APIENTRY *ptr_glBindFramebuffer)(GLenum, GLuint);
+typedef void   (GL_APIENTRY *ptr_glGenRenderbuffers)(GLsizei, GLuint *);
+typedef void   (GL_APIENTRY *ptr_glDeleteRenderbuffers)(GLsizei, const GLuint *);
+typedef void   (GL_APIENTRY *ptr_glBindRenderbuffer)(GLenum, GLuint);
+typedef void   (GL_APIENTRY *ptr_glRenderbufferStorage)(GLenum, GLenum, GLsizei, GLsizei);
+typedef void   (GL_APIENTRY *ptr_glFramebufferRenderbuffer)(GLenum, GLenum, GLenum, GLuint);
+typedef GLenum (GL_APIENTRY *ptr_glCheckFramebufferStatus)(GLenum);
+typedef void   (GL_APIENTRY *ptr_glFlush)(void);
+
+/** static (local) variables **/
+static EGLDisplay l_Display = EGL_NO_DISPLAY;
+static EGLConfig  l_Config;
+static EGLSurface l_Surface = EGL_NO_SURFACE;
+static EGLContext l_Context = EGL_NO_CONTEXT;
+static int        l_Attributes[M64P_GL_CONTEXT_PROFILE_MASK + 1];
+static int        l_Width = 0;
+static int        l_Height = 0;
+static GLuint     l_Framebuffer = 0;
+static GLuint     l_Renderbuffers[2] = { 0, 0 };
+
+/*********************************************************************************************************
+ *  Surfaceless framebuffer
+ */
+
+/* (re)allocates the storage of the framebuffer, which is left bound */
+static int AllocateFramebuffer(int Width, int Height)
+{
+    ptr_glBindRenderbuffer BindRenderbuffer = (ptr_glBindRenderbuffer) eglGetProcAddress("glBindRenderbuffer");
+    ptr_glRenderbufferStorage RenderbufferStorage = (ptr_glRenderbufferStorage) eglGetProcAddress("glRenderbufferStorage");
+    ptr_glBindFramebuffer BindFramebuffer = (ptr_glBindFramebuffer) eglGetProcAddress("glBindFramebuffer");
+
+    if (BindRenderbuffer == NULL || RenderbufferStorage == NULL || BindFramebuffer == NULL)
+        return 0;
+
+    BindRenderbuffer(GL_RENDERBUFFER, l_Renderbuffers[0]);
+    RenderbufferStorage(GL_RENDERBUFFER, HEADLESS_COLOR_FORMAT, Width, Height);
+    BindRenderbuffer(GL_RENDERBUFFER, l_Renderbuffers[1]);
+    RenderbufferStorage(GL_RENDERBUFFER, HEADLESS_DEPTH_FORMAT, Width, Height);
+    BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    BindFramebuffer(GL_FRAMEBUFFER, l_Framebuffer);
+    return 1;
+}
+
+static int FramebufferComplete(void)
+{
+    ptr_glCheckFramebufferStatus CheckFramebufferStatus = (ptr_glCheckFramebufferStatus) eglGetProcAddress("glCheckFramebufferStatus");
+
+    return CheckFramebufferStatus != NULL && CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+static int CreateFramebuffer(int Width, int Height)
+{
+    ptr_glGenFramebuffers GenFramebuffers = (ptr_glGenFramebuffers) eglGetProcAddress("glGenFramebuffers");
+    ptr_glGenRenderbuffers GenRenderbuffers = (ptr_glGenRenderbuffers) eglGetProcAddress("glGenRenderbuffers");
+    ptr_glFramebufferRenderbuffer FramebufferRenderbuffer = (ptr_glFramebufferRenderbuffer) eglGetProcAddress("glFramebufferRenderbuffer");
+
+    if (GenFramebuffers == NULL || GenRenderbuffers == NULL || FramebufferRenderbuffer == NULL)
+        return 0;
+
+    GenFramebuffers(1, &l_Framebuffer);
+    GenRenderbuffers(2, l_Renderbuffers);
+    if (!AllocateFramebuffer(Width, Height))
+        return 0;
+
+    FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, l_Renderbuffers[0]);
+    FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, l_Renderbuffers[1]);
+    FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, l_Renderbuffers[1]);
+    return FramebufferComplete();
+}
+
+static void DestroyFramebuffer(void)
+{
+    ptr_glDeleteFramebuffers DeleteFramebuffers = (ptr_glDeleteFramebuffers) eglGetProcAddress("glDeleteFramebuffers");
+    ptr_glDeleteRenderbuffers DeleteRenderbuffers = (ptr_glDeleteRenderbuffers) eglGetProcAddress("glDeleteRenderbuffers");
+
+    if (l_Framebuffer != 0 && DeleteFramebuffers != NULL && DeleteRenderbuffers != NULL)
+    {
+        DeleteFramebuffers(1, &l_Framebuffer);
+        DeleteRenderbuffers(2, l_Renderbuffers);
+    }
+
+    l_Framebuffer = 0;
+    l_Renderbuffers[0] = l_Renderbuffers[1] = 0;
+}
+
+/*********************************************************************************************************
+ *  Video extension functions
+ */
+
+static m64p_error HeadlessInit(void)
+{
+    EGLDisplay (EGLAPIENTRY *GetPlatformDisplay)(EGLenum, void *, const EGLint *);
+
+    memset(l_Attributes, 0, sizeof(l_Attributes));
+    l_Attributes[M64P_GL_DEPTH_SIZE] = 24;
+
+    l_Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (l_Display != EGL_NO_DISPLAY && eglInitialize(l_Display, NULL, NULL))
+        return M64ERR_SUCCESS;
+
+    /* machines without a display server may only have Mesa's surfaceless platform */
+    *(void **) &GetPlatformDisplay = (void *) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (GetPlatformDisplay != NULL)
+    {
+        l_Display = GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (l_Display != EGL_NO_DISPLAY && eglInitialize(l_Display, NULL, NULL))
+            return M64ERR_SUCCESS;
+    }
+
+    DebugMessage(M64MSG_ERROR, "headless: couldn't initialize an EGL display");
+    l_Display = EGL_NO_DISPLAY;
+    return M64ERR_SYSTEM_FAIL;
+}
+
+static m64p_error HeadlessQuit(void)
+{
+    if (l_Display == EGL_NO_DISPLAY)
+        return M64ERR_NOT_INIT;
+
+    if (l_Context != EGL_NO_CONTEXT)
+        DestroyFramebuffer();
+    eglMakeCurrent(l_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (l_Context != EGL_NO_CONTEXT)
+        eglDestroyContext(l_Display, l_Context);
+    if (l_Surface != EGL_NO_SURFACE)
+        eglDestroySurface(l_Display, l_Surface);
+    eglTerminate(l_Display);
+
+    l_Context = EGL_NO_CONTEXT;
+    l_Surface = EGL_NO_SURFACE;
+    l_Display = EGL_NO_DISPLAY;
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessListModes(m64p_2d_size *SizeArray, int *NumSizes)
+{
+    if (SizeArray == NULL || NumSizes == NULL || *NumSizes < 1)
+        return M64ERR_INPUT_ASSERT;
+
+    SizeArray[0].uiWidth = l_Width > 0 ? l_Width : 640;
+    SizeArray[0].uiHeight = l_Height > 0 ? l_Height : 480;
+    *NumSizes = 1;
+    return M64ERR_SUCCESS;
+}
+
+static int ChooseConfig(int Profile, int Major, EGLint SurfaceType)
+{
+    EGLint RenderableType = EGL_OPENGL_BIT;
+    EGLint NumConfigs = 0;
+
+    if (Profile == M64P_GL_CONTEXT_PROFILE_ES)
+        RenderableType = Major >= 3 ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_ES2_BIT;
+
+    {
+        const EGLint ConfigAttributes[] = {
+            EGL_SURFACE_TYPE, SurfaceType,
+            EGL_RENDERABLE_TYPE, RenderableType,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, l_Attributes[M64P_GL_ALPHA_SIZE],
+            EGL_DEPTH_SIZE, SurfaceType == EGL_PBUFFER_BIT ? l_Attributes[M64P_GL_DEPTH_SIZE] : 0,
+            EGL_NONE
+        };
+
+        return eglChooseConfig(l_Display, ConfigAttributes, &l_Config, 1, &NumConfigs) && NumConfigs > 0;
+    }
+}
+
+static m64p_error HeadlessResizeWindow(int Width, int Height);
+
+static m64p_error HeadlessSetMode(int Width, int Height, int BitsPerPixel, int ScreenMode, int Flags)
+{
+    int Profile = l_Attributes[M64P_GL_CONTEXT_PROFILE_MASK];
+    int Major = l_Attributes[M64P_GL_CONTEXT_MAJOR_VERSION];
+    int Minor = l_Attributes[M64P_GL_CONTEXT_MINOR_VERSION];
+    EGLint ContextAttributes[7];
+    int i = 0;
+
+    if (l_Display == EGL_NO_DISPLAY)
+        return M64ERR_NOT_INIT;
+
+    if (l_Context != EGL_NO_CONTEXT)
+        return HeadlessResizeWindow(Width, Height);
+
+    if (!eglBindAPI(Profile == M64P_GL_CONTEXT_PROFILE_ES ? EGL_OPENGL_ES_API : EGL_OPENGL_API))
+    {
+        DebugMessage(M64MSG_ERROR, "headless: EGL doesn't support the requested OpenGL API");
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    /* fall back to a framebuffer object on displays without pbuffers */
+    if (ChooseConfig(Profile, Major, EGL_PBUFFER_BIT))
+    {
+        const EGLint SurfaceAttributes[] = { EGL_WIDTH, Width, EGL_HEIGHT, Height, EGL_NONE };
+        l_Surface = eglCreatePbufferSurface(l_Display, l_Config, SurfaceAttributes);
+    }
+    else if (!ChooseConfig(Profile, Major, EGL_DONT_CARE))
+    {
+        DebugMessage(M64MSG_ERROR, "headless: no EGL config available for the requested OpenGL version");
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    if (Profile == M64P_GL_CONTEXT_PROFILE_ES || Major > 0)
+    {
+        ContextAttributes[i++] = EGL_CONTEXT_MAJOR_VERSION;
+        ContextAttributes[i++] = Major > 0 ? Major : 2;
+        ContextAttributes[i++] = EGL_CONTEXT_MINOR_VERSION;
+        ContextAttributes[i++] = Minor;
+    }
+    if (Profile != M64P_GL_CONTEXT_PROFILE_ES && Major > 0)
+    {
+        ContextAttributes[i++] = EGL_CONTEXT_OPENGL_PROFILE_MASK;
+        ContextAttributes[i++] = Profile == M64P_GL_CONTEXT_PROFILE_CORE ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT
+                                                                         : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT;
+    }
+    ContextAttributes[i] = EGL_NONE;
+
+    l_Context = eglCreateContext(l_Display, l_Config, EGL_NO_CONTEXT, ContextAttributes);
+    if (l_Context == EGL_NO_CONTEXT || !eglMakeCurrent(l_Display, l_Surface, l_Surface, l_Context))
+    {
+        DebugMessage(M64MSG_ERROR, "headless: couldn't create the EGL context (error 0x%x)", eglGetError());
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    if (l_Surface == EGL_NO_SURFACE && !CreateFramebuffer(Width, Height))
+    {
+        DebugMessage(M64MSG_ERROR, "headless: couldn't create a %ix%i framebuffer", Width, Height);
+        return M64ERR_SYSTEM_FAIL;
+    }
+
+    DebugMessage(M64MSG_INFO, "headless: rendering %ix%i to %s", Width, Height,
+                 l_Surface != EGL_NO_SURFACE ? "an EGL pbuffer" : "a framebuffer object");
+    l_Width = Width;
+    l_Height = Height;
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessSetCaption(const char *Title)
+{
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessToggleFS(void)
+{
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessResizeWindow(int Width, int Height)
+{
+    if (l_Context == EGL_NO_CONTEXT)
+        return M64ERR_NOT_INIT;
+    if (Width == l_Width && Height == l_Height)
+        return M64ERR_SUCCESS;
+
+    if (l_Surface != EGL_NO_SURFACE)
+    {
+        const EGLint SurfaceAttributes[] = { EGL_WIDTH, Width, EGL_HEIGHT, Height, EGL_NONE };
+        EGLSurface Surface = eglCreatePbufferSurface(l_Display, l_Config, SurfaceAttributes);
+
+        if (Surface == EGL_NO_SURFACE || !eglMakeCurrent(l_Display, Surface, Surface, l_Context))
+            return M64ERR_SYSTEM_FAIL;
+        eglDestroySurface(l_Display, l_Surface);
+        l_Surface = Surface;
+    }
+    else if (!AllocateFramebuffer(Width, Height) || !FramebufferComplete())
+        return M64ERR_SYSTEM_FAIL;
+
+    l_Width = Width;
+    l_Height = Height;
+    return M64ERR_SUCCESS;
+}
+
+static void * HeadlessGLGetProc(const char *Proc)
+{
+    return (void *) eglGetProcAddress(Proc);
+}
+
+static m64p_error HeadlessGLSetAttr(m64p_GLattr Attr, int Value)
+{
+    if (Attr < M64P_GL_DOUBLEBUFFER || Attr > M64P_GL_CONTEXT_PROFILE_MASK)
+        return M64ERR_INPUT_INVALID;
+
+    l_Attributes[Attr] = Value;
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessGLGetAttr(m64p_GLattr Attr, int *pValue)
+{
+    if (Attr < M64P_GL_DOUBLEBUFFER || Attr > M64P_GL_CONTEXT_PROFILE_MASK || pValue == NULL)
+        return M64ERR_INPUT_INVALID;
+
+    *pValue = l_Attributes[Attr];
+    return M64ERR_SUCCESS;
+}
+
+static m64p_error HeadlessGLSwapBuf(void)
+{
+    if (l_Context == EGL_NO_CONTEXT)
+        return M64ERR_NOT_INIT;
+
+    if (l_Surface != EGL_NO_SURFACE)
+        eglSwapBuffers(l_Display, l_Surface);
+    else
+    {
+        ptr_glFlush Flush = (ptr_glFlush) eglGetProcAddress("glFlush");
+        if (Flush != NULL)
+            Flush();
+    }
+
+    return M64ERR_SUCCESS;
+}
+
+static uint32_t HeadlessGLGetDefaultFramebuffer(void)
+{
+    return l_Framebuffer;
+}
+
+m64p_video_extension_functions g_HeadlessVidExt = {12,
+                                                   HeadlessInit,
+                                                   HeadlessQuit,
+                                                   HeadlessListModes,
+                                                   HeadlessSetMode,
+                                                   HeadlessGLGetProc,
+                                                   HeadlessGLSetAttr,
+                                                   HeadlessGLGetAttr,
+                                                   HeadlessGLSwapBuf,
+                                                   HeadlessSetCaption,
+                                                   HeadlessToggleFS,
+                                                   HeadlessResizeWindow,
+                                                   HeadlessGLGetDefaultFramebuffer};
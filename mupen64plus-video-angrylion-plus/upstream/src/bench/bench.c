@@ -0,0 +1,285 @@
+//
+// bench.c: headless replay of RDP command traces for benchmarking
+//
+
+#include "core/rdp.h"
+#include "core/plugin.h"
+#include "core/screen.h"
+#include "core/msg.h"
+#include "core/trace.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint8_t* rdram;
+static uint32_t rdram_size;
+static uint8_t dmem[TRACE_DMEM_SIZE];
+
+static uint32_t dp_reg[DP_NUM_REG];
+static uint32_t vi_reg[VI_NUM_REG];
+static uint32_t* dp_reg_ptr[DP_NUM_REG];
+static uint32_t* vi_reg_ptr[VI_NUM_REG];
+
+static uint32_t num_frames;
+
+void plugin_init(void)
+{
+    uint32_t i;
+    for (i = 0; i < DP_NUM_REG; i++) {
+        dp_reg_ptr[i] = &dp_reg[i];
+    }
+    for (i = 0; i < VI_NUM_REG; i++) {
+        vi_reg_ptr[i] = &vi_reg[i];
+    }
+}
+
+void plugin_sync_dp(void)
+{
+}
+
+uint32_t** plugin_get_dp_registers(void)
+{
+    return dp_reg_ptr;
+}
+
+uint32_t** plugin_get_vi_registers(void)
+{
+    return vi_reg_ptr;
+}
+
+uint8_t* plugin_get_rdram(void)
+{
+    return rdram;
+}
+
+uint32_t plugin_get_rdram_size(void)
+{
+    return rdram_size;
+}
+
+uint8_t* plugin_get_dmem(void)
+{
+    return dmem;
+}
+
+uint8_t* plugin_get_rom_header(void)
+{
+    return NULL;
+}
+
+void plugin_close(void)
+{
+}
+
+void screen_init(struct rdp_config* config)
+{
+}
+
+void screen_swap(bool blank)
+{
+    num_frames++;
+}
+
+bool screen_map(struct rdp_frame_buffer* fb)
+{
+    return false;
+}
+
+void screen_write(struct rdp_frame_buffer* fb, int32_t output_height)
+{
+}
+
+void screen_read(struct rdp_frame_buffer* fb, bool rgb)
+{
+    fb->width = fb->height = fb->pitch = 0;
+}
+
+void screen_set_fullscreen(bool fullscreen)
+{
+}
+
+bool screen_get_fullscreen(void)
+{
+    return false;
+}
+
+void screen_toggle_fullscreen(void)
+{
+}
+
+void screen_close(void)
+{
+}
+
+void msg_error(const char* err, ...)
+{
+    va_list arg;
+    va_start(arg, err);
+    fprintf(stderr, "error: ");
+    vfprintf(stderr, err, arg);
+    fprintf(stderr, "\n");
+    va_end(arg);
+    exit(1);
+}
+
+void msg_warning(const char* err, ...)
+{
+    va_list arg;
+    va_start(arg, err);
+    fprintf(stderr, "warning: ");
+    vfprintf(stderr, err, arg);
+    fprintf(stderr, "\n");
+    va_end(arg);
+}
+
+void msg_debug(const char* err, ...)
+{
+}
+
+static double time_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool read_payload(FILE* fp, void* dst, size_t size)
+{
+    return fread(dst, size, 1, fp) == 1;
+}
+
+static bool replay(FILE* fp)
+{
+    struct trace_record record;
+
+    while (fread(&record, sizeof(record), 1, fp) == 1) {
+        switch (record.type) {
+            case TRACE_RECORD_RDRAM_PAGE:
+                if (record.arg >= rdram_size / TRACE_PAGE_SIZE ||
+                    !read_payload(fp, rdram + record.arg * TRACE_PAGE_SIZE, TRACE_PAGE_SIZE)) {
+                    return false;
+                }
+                break;
+
+            case TRACE_RECORD_DMEM:
+                if (!read_payload(fp, dmem, TRACE_DMEM_SIZE)) {
+                    return false;
+                }
+                break;
+
+            case TRACE_RECORD_DP_UPDATE:
+                if (!read_payload(fp, dp_reg, sizeof(dp_reg))) {
+                    return false;
+                }
+                rdp_update();
+                break;
+
+            case TRACE_RECORD_VI_UPDATE:
+                if (!read_payload(fp, vi_reg, sizeof(vi_reg))) {
+                    return false;
+                }
+                rdp_update_vi();
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return feof(fp) != 0;
+}
+
+static void print_cmd_stats(void)
+{
+#ifdef RDP_PROFILE
+    struct rdp_cmd_stats stats[RDP_NUM_CMDS];
+    uint32_t i;
+
+    rdp_get_cmd_stats(stats);
+
+    printf("\n%-32s %12s %12s %10s\n", "command", "count", "time [ms]", "avg [ns]");
+    for (i = 0; i < RDP_NUM_CMDS; i++) {
+        if (stats[i].count) {
+            printf("%-32s %12llu %12.2f %10.0f\n", stats[i].name,
+                (unsigned long long)stats[i].count, stats[i].time_ns / 1e6,
+                (double)stats[i].time_ns / stats[i].count);
+        }
+    }
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    struct rdp_config config;
+    struct trace_header header;
+
+    if (argc < 2) {
+        printf("usage: %s <trace> [workers] [vi mode]\n", argv[0]);
+        printf("  workers: 0 = one per logical processor (default), -1 = no parallel processing\n");
+        printf("  vi mode: 0 = filtered (default), 1 = unfiltered, 2 = depth, 3 = coverage\n");
+        return 1;
+    }
+
+    rdp_config_defaults(&config);
+
+    if (argc > 2) {
+        int workers = atoi(argv[2]);
+        config.parallel = workers >= 0;
+        config.num_workers = workers > 0 ? workers : 0;
+    }
+
+    if (argc > 3) {
+        config.vi.mode = atoi(argv[3]);
+    }
+
+    FILE* fp = fopen(argv[1], "rb");
+    if (!fp) {
+        msg_error("can't open %s", argv[1]);
+    }
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 || header.magic != TRACE_MAGIC) {
+        msg_error("%s is not a trace file", argv[1]);
+    }
+
+    if (header.version != TRACE_VERSION) {
+        msg_error("unsupported trace version %u", header.version);
+    }
+
+    if (header.rdram_size == 0 || header.rdram_size > RDRAM_MAX_SIZE) {
+        msg_error("invalid RDRAM size %u", header.rdram_size);
+    }
+
+    rdram_size = header.rdram_size;
+    rdram = calloc(rdram_size, 1);
+    if (!rdram) {
+        msg_error("out of memory");
+    }
+
+    rdp_init(&config);
+
+    double start = time_seconds();
+    bool complete = replay(fp);
+    double elapsed = time_seconds() - start;
+
+    if (!complete) {
+        msg_warning("trace is truncated or damaged, results are incomplete");
+    }
+
+    printf("workers: %s\n", config.parallel ? (config.num_workers ? argv[2] : "auto") : "off");
+    printf("frames: %u\n", num_frames);
+    printf("time: %.3f s\n", elapsed);
+    if (num_frames && elapsed > 0) {
+        printf("speed: %.2f frames/s, %.3f ms/frame\n", num_frames / elapsed, elapsed * 1000 / num_frames);
+    }
+
+    print_cmd_stats();
+
+    rdp_close();
+    fclose(fp);
+    free(rdram);
+
+    return 0;
+}
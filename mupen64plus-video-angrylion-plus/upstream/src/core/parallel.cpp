@@ -4,33 +4,34 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstdint>
-#include <functional>
+#include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
+// called at the start of each worker thread
+static void (*thread_hook)(void);
+
 class Parallel
 {
 public:
+    typedef void (*task_t)(std::uint32_t);
+
     Parallel(std::uint32_t num_workers) :
-        m_num_workers(std::min(num_workers, 64U))
+        m_num_workers(std::max(std::min(num_workers, static_cast<std::uint32_t>(PARALLEL_MAX_WORKERS)), 1u))
     {
-        // mask for m_tasks_done when all workers have finished their task
-        // except for worker 0, which runs in the main thread
-        m_all_tasks_done = ((1LL << m_num_workers) - 1) & ~1;
-
-        // give workers an empty task
-        m_task = [](std::uint32_t) {};
+        m_task = nullptr;
+        m_work = 0;
+        m_tasks_pending = 0;
+        m_sleepers = 0;
         m_accept_work = true;
-        start_work();
 
-        // create worker threads
-        for (std::uint32_t worker_id = 1; worker_id < m_num_workers; worker_id++) {
+        // create worker threads, worker 0 only has its own thread for
+        // asynchronous tasks and otherwise runs in the main thread
+        for (std::uint32_t worker_id = 0; worker_id < m_num_workers; worker_id++) {
             m_workers.emplace_back(std::thread(&Parallel::do_work, this, worker_id));
         }
-
-        // synchronize workers to prepare them for real tasks
-        wait();
     }
 
     ~Parallel() {
@@ -39,7 +40,7 @@ public:
 
         // exit worker main loops
         m_accept_work = false;
-        start_work();
+        start_work(nullptr, 0);
 
         // join worker threads to make sure they have finished
         for (auto& thread : m_workers) {
@@ -50,80 +51,139 @@ public:
         m_workers.clear();
     }
 
-    void run(std::function<void(std::uint32_t)>&& task) {
+    void run(task_t task) {
         // don't allow more tasks if workers are stopping
         if (!m_accept_work) {
             throw std::runtime_error("Workers are exiting and no longer accept work");
         }
 
-        // prepare task for workers and send signal so they start working
-        m_task = task;
-        start_work();
+        // wait for asynchronous tasks that are still running
+        wait();
+
+        // send signal to all workers except worker 0 so they start working
+        start_work(task, 1);
 
         // run worker 0 directly on main thread
-        m_task(0);
+        task(0);
 
         // wait for all workers to finish
         wait();
     }
 
+    void run_async(task_t task) {
+        // don't allow more tasks if workers are stopping
+        if (!m_accept_work) {
+            throw std::runtime_error("Workers are exiting and no longer accept work");
+        }
+
+        // only one task can run at a time
+        wait();
+
+        // let all workers including worker 0 start working and return
+        // to the caller without waiting
+        start_work(task, 0);
+    }
+
+    void wait() {
+        // wait for all workers to finish their task
+        wait_for([this] {
+            return m_tasks_pending.load(std::memory_order_acquire) == 0;
+        });
+    }
+
     std::uint32_t num_workers() {
         return m_num_workers;
     }
 
 private:
-    std::function<void(std::uint32_t)> m_task;
+    // number of polls before a waiting thread goes to sleep, long enough to
+    // cover the time between two flushes of a busy command buffer
+    static const std::uint32_t SPIN_COUNT = 4096;
+
+    task_t m_task;
     std::vector<std::thread> m_workers;
     std::mutex m_signal_mutex;
-    std::condition_variable m_signal_work;
-    std::condition_variable m_signal_done;
-    std::atomic<uint64_t> m_tasks_done;
-    std::uint64_t m_all_tasks_done;
+    std::condition_variable m_signal;
+    // generation counter in the upper bits, the lowest bit is set if
+    // worker 0 runs the task in the main thread
+    std::atomic<std::uint32_t> m_work;
+    std::atomic<std::uint32_t> m_tasks_pending;
+    std::atomic<std::uint32_t> m_sleepers;
     std::atomic<bool> m_accept_work;
     const std::uint32_t m_num_workers;
 
-    void start_work() {
+    template <typename Predicate>
+    void wait_for(Predicate done) {
+        // spin briefly, waking up a sleeping thread costs more than a short
+        // busy wait if the other side is almost done
+        for (std::uint32_t i = 0; i < SPIN_COUNT; i++) {
+            if (done()) {
+                return;
+            }
+            if (i >= SPIN_COUNT / 2) {
+                std::this_thread::yield();
+            }
+        }
+
+        // go to sleep until notify() is called, the sleeper count is raised
+        // before the condition is checked again so no wakeup is lost
         std::unique_lock<std::mutex> ul(m_signal_mutex);
+        m_sleepers++;
+        m_signal.wait(ul, done);
+        m_sleepers--;
+    }
 
-        // clear task bits for all workers
-        m_tasks_done = 0;
+    void notify() {
+        // only take the lock if there is a thread sleeping
+        if (m_sleepers > 0) {
+            std::unique_lock<std::mutex> ul(m_signal_mutex);
+            m_signal.notify_all();
+        }
+    }
+
+    void start_work(task_t task, std::uint32_t first_worker) {
+        // publish task before the new generation becomes visible to the workers
+        m_task = task;
+        m_tasks_pending = m_num_workers - first_worker;
+        m_work = ((m_work >> 1) + 1) << 1 | first_worker;
 
-        // wake up all workers
-        m_signal_work.notify_all();
+        // wake up sleeping workers
+        notify();
     }
 
     void do_work(std::uint32_t worker_id) {
-        const std::uint64_t worker_mask = 1LL << worker_id;
+        std::uint32_t work = 0;
 
-        while (m_accept_work) {
-            // do the work
-            m_task(worker_id);
+        if (thread_hook) {
+            thread_hook();
+        }
 
-            {
-                std::unique_lock<std::mutex> ul(m_signal_mutex);
+        while (true) {
+            // wait for the next generation of work
+            wait_for([&work, this] {
+                return m_work.load(std::memory_order_acquire) != work;
+            });
+            work = m_work.load(std::memory_order_acquire);
 
-                // mark task as done
-                m_tasks_done |= worker_mask;
+            if (!m_accept_work) {
+                break;
+            }
+
+            // worker 0 runs in the main thread for synchronous tasks
+            if (worker_id < (work & 1)) {
+                continue;
+            }
 
-                // notify main thread
-                m_signal_done.notify_one();
+            // do the work
+            m_task(worker_id);
 
-                // take a break and wait for more work
-                m_signal_work.wait(ul, [worker_mask, this] {
-                    return (m_tasks_done & worker_mask) == 0;
-                });
+            // mark task as done and notify main thread if this was the last one
+            if (m_tasks_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                notify();
             }
         }
     }
 
-    void wait() {
-        // wait for all workers to set their task bits
-        std::unique_lock<std::mutex> ul(m_signal_mutex);
-        m_signal_done.wait(ul, [this] {
-            return m_tasks_done == m_all_tasks_done;
-        });
-    }
-
     void operator=(const Parallel&) = delete;
     Parallel(const Parallel&) = delete;
 };
@@ -131,6 +191,11 @@ private:
 // C interface for the Parallel class
 static std::unique_ptr<Parallel> parallel;
 
+void parallel_set_thread_hook(void hook(void))
+{
+    thread_hook = hook;
+}
+
 void parallel_init(uint32_t num)
 {
     // auto-select number of workers based on the number of cores
@@ -146,6 +211,16 @@ void parallel_run(void task(uint32_t))
     parallel->run(task);
 }
 
+void parallel_run_async(void task(uint32_t))
+{
+    parallel->run_async(task);
+}
+
+void parallel_wait()
+{
+    parallel->wait();
+}
+
 uint32_t parallel_num_workers()
 {
     return parallel->num_workers();
@@ -6,8 +6,14 @@ extern "C" {
 
 #include <stdint.h>
 
+// upper limit for the number of workers
+#define PARALLEL_MAX_WORKERS 64
+
+void parallel_set_thread_hook(void hook(void));
 void parallel_init(uint32_t num);
 void parallel_run(void task(uint32_t));
+void parallel_run_async(void task(uint32_t));
+void parallel_wait();
 uint32_t parallel_num_workers();
 void parallel_close();
 
@@ -4,6 +4,7 @@
 #include "msg.h"
 #include "screen.h"
 #include "parallel.h"
+#include "trace.h"
 
 #include <memory.h>
 #include <string.h>
@@ -11,6 +12,10 @@
 #include <stdio.h>
 #include <assert.h>
 
+#ifdef RDP_PROFILE
+#include <time.h>
+#endif
+
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define CLAMP(x, lo, hi) (((x) > (hi)) ? (hi) : (((x) < (lo)) ? (lo) : (x)))
@@ -47,6 +52,26 @@
 #define STRICTINLINE inline
 #endif
 
+// alignment for data written by one thread while others access data next to it
+#define CACHE_LINE_SIZE 64
+
+#ifdef _MSC_VER
+#define CACHE_ALIGNED __declspec(align(CACHE_LINE_SIZE))
+#elif defined(__GNUC__)
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+#else
+#define CACHE_ALIGNED
+#endif
+
+// SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RDP_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RDP_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 // bit constants for DP_STATUS
 #define DP_STATUS_XBUS_DMA      0x001   // DMEM DMA mode is set
 #define DP_STATUS_FREEZE        0x002   // Freeze has been set
@@ -241,10 +266,16 @@ struct combiner_inputs
     int add_a1;
 };
 
-struct rdp_state
+// Each worker writes its state for every pixel, so states are cache line aligned
+// and padded to keep adjacent workers from sharing a line.
+struct CACHE_ALIGNED rdp_state
 {
     uint32_t worker_id;
 
+    // range of scanlines rendered by this worker, end is exclusive
+    int32_t band_begin;
+    int32_t band_end;
+
     int blshifta;
     int blshiftb;
     int pastblshifta;
@@ -375,6 +406,8 @@ struct rdp_state
     uint32_t primitive_z;
     uint16_t primitive_delta_z;
 
+    void (*render_spans_ptr)(struct rdp_state*, int, int, int, int);
+
     // tex
     int ti_format;
     int ti_size;
@@ -390,10 +423,17 @@ struct rdp_state
     // zbuffer
     uint32_t zb_address;
     int32_t pastrawdzmem;
+
+#ifdef RDP_PROFILE
+    // number of executed commands and time spent in them, by command ID
+    uint64_t cmd_count[RDP_NUM_CMDS];
+    uint64_t cmd_time[RDP_NUM_CMDS];
+#endif
 };
 
 
 static struct rdp_state* rdp_states;
+static void* rdp_states_alloc;
 static struct rdp_config config;
 static struct rdp_config config_new;
 static struct plugin_api* plugin;
@@ -431,6 +471,7 @@ static STRICTINLINE int32_t irand(int32_t* seed)
 static void deduce_derivatives(struct rdp_state* rdp);
 
 #include "rdp/rdram.c"
+#include "rdp/trace.c"
 #include "rdp/cmd.c"
 #include "rdp/dither.c"
 #include "rdp/blender.c"
@@ -476,6 +517,13 @@ void rdp_init_worker(uint32_t worker_id)
     rasterizer_init(rdp);
 }
 
+static struct rdp_state* rdp_alloc_states(uint32_t num)
+{
+    // malloc doesn't guarantee the alignment of rdp_state
+    rdp_states_alloc = malloc(num * sizeof(struct rdp_state) + CACHE_LINE_SIZE - 1);
+    return (struct rdp_state*)(((uintptr_t)rdp_states_alloc + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+}
+
 void rdp_init(struct rdp_config* _config)
 {
     if (_config) {
@@ -507,10 +555,10 @@ void rdp_init(struct rdp_config* _config)
 
     if (config.parallel) {
         parallel_init(config.num_workers);
-        rdp_states = malloc(parallel_num_workers() * sizeof(struct rdp_state));
+        rdp_states = rdp_alloc_states(parallel_num_workers());
         parallel_run(rdp_init_worker);
     } else {
-        rdp_states = malloc(sizeof(struct rdp_state));
+        rdp_states = rdp_alloc_states(1);
         rdp_init_worker(0);
     }
 }
@@ -691,6 +739,13 @@ static void deduce_derivatives(struct rdp_state* rdp)
         rdp->other_modes.f.getditherlevel = 2;
 
     rdp->other_modes.f.dolod = rdp->other_modes.tex_lod_en || lodfracused;
+
+    // select the span renderer specialized for the current modes
+    int zmode = (rdp->other_modes.z_compare_en << 1) | rdp->other_modes.z_update_en;
+    if (rdp->other_modes.cycle_type == CYCLE_TYPE_2)
+        rdp->render_spans_ptr = render_spans_2cycle_func[rdp->other_modes.f.textureuselevel1][zmode];
+    else
+        rdp->render_spans_ptr = render_spans_1cycle_func[rdp->other_modes.f.textureuselevel0][zmode];
 }
 
 void rdp_close(void)
@@ -701,7 +756,8 @@ void rdp_close(void)
     screen_close();
 
     if (rdp_states) {
-        free(rdp_states);
+        free(rdp_states_alloc);
+        rdp_states_alloc = NULL;
         rdp_states = NULL;
     }
 }
@@ -80,3 +80,22 @@ void rdp_update_config(struct rdp_config* config);
 void rdp_update_vi(void);
 void rdp_update(void);
 void rdp_close(void);
+
+// records all RDP and VI updates with the memory they use for later replay
+bool rdp_trace_begin(const char* path);
+void rdp_trace_end(void);
+
+#ifdef RDP_PROFILE
+// number of RDP command IDs
+#define RDP_NUM_CMDS 64
+
+struct rdp_cmd_stats
+{
+    const char* name;
+    uint64_t count;
+    uint64_t time_ns;   // summed up over all workers
+};
+
+// collects the command statistics since rdp_init, stats needs RDP_NUM_CMDS entries
+void rdp_get_cmd_stats(struct rdp_cmd_stats* stats);
+#endif
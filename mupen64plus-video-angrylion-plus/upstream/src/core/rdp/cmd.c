@@ -1,6 +1,9 @@
 // maximum number of commands to buffer for parallel processing
 #define CMD_BUFFER_SIZE 1024
 
+// number of command buffers, one is filled while the workers run the other
+#define CMD_BUFFER_COUNT 2
+
 // maximum data size of a single command in bytes
 #define CMD_MAX_SIZE 176
 
@@ -48,12 +51,34 @@
 #define CMD_ID_SET_MASK_IMAGE                  0x3e
 #define CMD_ID_SET_COLOR_IMAGE                 0x3f
 
-static uint32_t rdp_cmd_buf[CMD_BUFFER_SIZE][CMD_MAX_INTS];
-static uint32_t rdp_cmd_buf_pos;
+// number of scanlines a primitive can touch, same as the size of rdp_state.span
+#define CMD_BIN_ROWS 1024
+
+static struct CACHE_ALIGNED cmd_buffer
+{
+    uint32_t cmd[CMD_BUFFER_SIZE][CMD_MAX_INTS];
+    uint32_t num_cmds;
+
+    // first and last scanline of each buffered command, unbounded for non-primitives
+    int32_t rows[CMD_BUFFER_SIZE][2];
+
+    // scanline bands of the workers for the buffered commands
+    int32_t band_begin[PARALLEL_MAX_WORKERS];
+    int32_t band_end[PARALLEL_MAX_WORKERS];
+} rdp_cmd_buffers[CMD_BUFFER_COUNT];
+
+// buffer that is currently filled and the command being read into it. Written
+// for every command word, so it is kept off the cache lines the workers read
+static struct CACHE_ALIGNED
+{
+    struct cmd_buffer* buf;
+    uint32_t pos;
+    uint32_t id;
+    uint32_t len;
+} rdp_cmd_fill = { &rdp_cmd_buffers[0] };
 
-static uint32_t rdp_cmd_pos;
-static uint32_t rdp_cmd_id;
-static uint32_t rdp_cmd_len;
+// buffer that is run by the workers
+static struct cmd_buffer* rdp_cmd_buf_run = &rdp_cmd_buffers[1];
 
 static void rdp_invalid(struct rdp_state* rdp, const uint32_t* args);
 static void rdp_noop(struct rdp_state* rdp, const uint32_t* args);
@@ -166,40 +191,181 @@ static const struct
     {rdp_set_color_image,   8,   true,  "Set_Color_Image"}
 };
 
+#ifdef RDP_PROFILE
+static uint64_t cmd_time_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void rdp_get_cmd_stats(struct rdp_cmd_stats* stats)
+{
+    uint32_t num_workers = config.parallel ? parallel_num_workers() : 1;
+    uint32_t cmd_id, worker_id;
+
+    for (cmd_id = 0; cmd_id < RDP_NUM_CMDS; cmd_id++) {
+        stats[cmd_id].name = rdp_commands[cmd_id].name;
+        stats[cmd_id].count = 0;
+        stats[cmd_id].time_ns = 0;
+    }
+
+    // workers only write their statistics while rendering
+    if (config.parallel) {
+        parallel_wait();
+    }
+
+    for (worker_id = 0; worker_id < num_workers; worker_id++) {
+        for (cmd_id = 0; cmd_id < RDP_NUM_CMDS; cmd_id++) {
+            stats[cmd_id].count += rdp_states[worker_id].cmd_count[cmd_id];
+            stats[cmd_id].time_ns += rdp_states[worker_id].cmd_time[cmd_id];
+        }
+    }
+}
+#endif
+
 static void cmd_run(struct rdp_state* rdp, const uint32_t* arg)
 {
     uint32_t cmd_id = CMD_ID(arg);
+#ifdef RDP_PROFILE
+    uint64_t start = cmd_time_ns();
     rdp_commands[cmd_id].handler(rdp, arg);
+    rdp->cmd_time[cmd_id] += cmd_time_ns() - start;
+    rdp->cmd_count[cmd_id]++;
+#else
+    rdp_commands[cmd_id].handler(rdp, arg);
+#endif
+}
+
+static bool cmd_get_rows(const uint32_t* cmd, int32_t* first, int32_t* last)
+{
+    int32_t yl, yh;
+    uint32_t cmd_id = CMD_ID(cmd);
+
+    if (cmd_id >= CMD_ID_FILL_TRIANGLE && cmd_id <= CMD_ID_SHADE_TEXTURE_Z_BUFFER_TRIANGLE) {
+        yl = SIGN(cmd[0], 14);
+        yh = SIGN(cmd[1], 14);
+    } else if (cmd_id == CMD_ID_TEXTURE_RECTANGLE || cmd_id == CMD_ID_TEXTURE_RECTANGLE_FLIP ||
+               cmd_id == CMD_ID_FILL_RECTANGLE) {
+        yl = cmd[0] & 0xfff;
+        yh = cmd[1] & 0xfff;
+    } else {
+        return false;
+    }
+
+    // coordinates are in quarter scanlines, the edge walker may also touch the
+    // scanline below the primitive
+    *first = CLAMP(yh >> 2, 0, CMD_BIN_ROWS - 1);
+    *last = CLAMP((yl >> 2) + 1, 0, CMD_BIN_ROWS - 1);
+    return true;
+}
+
+static void cmd_bin(struct cmd_buffer* buf)
+{
+    // number of primitives touching each scanline, as estimate for the number of spans
+    static int32_t row_spans[CMD_BIN_ROWS + 1];
+    uint32_t num_workers = parallel_num_workers();
+    uint32_t total = 0;
+    uint32_t pos;
+    int32_t y;
+
+    memset(row_spans, 0, sizeof(row_spans));
+
+    for (pos = 0; pos < buf->num_cmds; pos++) {
+        int32_t* rows = buf->rows[pos];
+        if (cmd_get_rows(buf->cmd[pos], &rows[0], &rows[1])) {
+            row_spans[rows[0]]++;
+            row_spans[rows[1] + 1]--;
+            total += rows[1] - rows[0] + 1;
+        } else {
+            rows[0] = INT32_MIN;
+            rows[1] = INT32_MAX;
+        }
+    }
+
+    // nothing to render, bands are unused
+    if (total == 0) {
+        return;
+    }
+
+    // split scanlines into contiguous bands with the same number of spans each
+    uint32_t worker = 0;
+    int32_t spans = 0;
+    uint32_t sum = 0;
+    buf->band_begin[0] = 0;
+    for (y = 0; y < CMD_BIN_ROWS; y++) {
+        spans += row_spans[y];
+        sum += spans;
+        while (worker + 1 < num_workers && (uint64_t)sum * num_workers >= (uint64_t)total * (worker + 1)) {
+            buf->band_end[worker] = y + 1;
+            buf->band_begin[++worker] = y + 1;
+        }
+    }
+    buf->band_end[worker] = CMD_BIN_ROWS;
+
+    // workers without spans get empty bands
+    while (++worker < num_workers) {
+        buf->band_begin[worker] = buf->band_end[worker] = CMD_BIN_ROWS;
+    }
 }
 
 static void cmd_run_buffered(uint32_t worker_id)
 {
+    struct rdp_state* rdp = &rdp_states[worker_id];
+    const struct cmd_buffer* buf = rdp_cmd_buf_run;
     uint32_t pos;
-    for (pos = 0; pos < rdp_cmd_buf_pos; pos++) {
-        cmd_run(&rdp_states[worker_id], rdp_cmd_buf[pos]);
+
+    rdp->band_begin = buf->band_begin[worker_id];
+    rdp->band_end = buf->band_end[worker_id];
+
+    for (pos = 0; pos < buf->num_cmds; pos++) {
+        // skip primitives outside of the band, all other commands update worker state
+        if (buf->rows[pos][1] < rdp->band_begin || buf->rows[pos][0] >= rdp->band_end) {
+            continue;
+        }
+        cmd_run(rdp, buf->cmd[pos]);
     }
 }
 
 static void cmd_flush(void)
 {
     // only run if there's something buffered
-    if (rdp_cmd_buf_pos) {
-        // let workers run all buffered commands in parallel
-        parallel_run(cmd_run_buffered);
+    if (rdp_cmd_fill.buf->num_cmds) {
+        struct cmd_buffer* buf = rdp_cmd_fill.buf;
+
+        // assign scanlines to workers by the spans of the buffered primitives
+        cmd_bin(buf);
+
+        // wait until the workers are done with the other buffer, then let them
+        // run all buffered commands in parallel while the next buffer is filled
+        parallel_wait();
+        rdp_cmd_fill.buf = rdp_cmd_buf_run;
+        rdp_cmd_buf_run = buf;
+        parallel_run_async(cmd_run_buffered);
+
         // reset buffer by starting from the beginning
-        rdp_cmd_buf_pos = 0;
+        rdp_cmd_fill.buf->num_cmds = 0;
     }
 }
 
+static void cmd_sync(void)
+{
+    // run all pending commands and wait for the workers to finish them
+    cmd_flush();
+    parallel_wait();
+}
+
 static void cmd_init(void)
 {
-    rdp_cmd_pos = 0;
-    rdp_cmd_id = 0;
-    rdp_cmd_len = CMD_MAX_INTS;
+    rdp_cmd_fill.pos = 0;
+    rdp_cmd_fill.id = 0;
+    rdp_cmd_fill.len = CMD_MAX_INTS;
 }
 
 void rdp_update(void)
 {
+    trace_dp_update();
+
     uint32_t** dp_reg = plugin_get_dp_registers();
     uint32_t dp_current_al = (*dp_reg[DP_CURRENT] & ~7) >> 2;
     uint32_t dp_end_al = (*dp_reg[DP_END] & ~7) >> 2;
@@ -214,50 +380,50 @@ void rdp_update(void)
         uint32_t i, toload;
         bool xbus_dma = (*dp_reg[DP_STATUS] & DP_STATUS_XBUS_DMA) != 0;
         uint32_t* dmem = (uint32_t*)plugin_get_dmem();
-        uint32_t* cmd_buf = rdp_cmd_buf[rdp_cmd_buf_pos];
+        uint32_t* cmd_buf = rdp_cmd_fill.buf->cmd[rdp_cmd_fill.buf->num_cmds];
 
         // when reading the first int, extract the command ID and update the buffer length
-        if (rdp_cmd_pos == 0) {
+        if (rdp_cmd_fill.pos == 0) {
             if (xbus_dma) {
-                cmd_buf[rdp_cmd_pos++] = dmem[dp_current_al++ & 0x3ff];
+                cmd_buf[rdp_cmd_fill.pos++] = dmem[dp_current_al++ & 0x3ff];
             } else {
-                cmd_buf[rdp_cmd_pos++] = rdram_read_idx32(dp_current_al++);
+                cmd_buf[rdp_cmd_fill.pos++] = rdram_read_idx32(dp_current_al++);
             }
 
-            rdp_cmd_id = CMD_ID(cmd_buf);
-            rdp_cmd_len = rdp_commands[rdp_cmd_id].length >> 2;
+            rdp_cmd_fill.id = CMD_ID(cmd_buf);
+            rdp_cmd_fill.len = rdp_commands[rdp_cmd_fill.id].length >> 2;
         }
 
         // copy more data from the N64 to the local command buffer
-        toload = MIN(dp_end_al - dp_current_al, rdp_cmd_len - 1);
+        toload = MIN(dp_end_al - dp_current_al, rdp_cmd_fill.len - 1);
 
         if (xbus_dma) {
             for (i = 0; i < toload; i++) {
-                cmd_buf[rdp_cmd_pos++] = dmem[dp_current_al++ & 0x3ff];
+                cmd_buf[rdp_cmd_fill.pos++] = dmem[dp_current_al++ & 0x3ff];
             }
         } else {
             for (i = 0; i < toload; i++) {
-                cmd_buf[rdp_cmd_pos++] = rdram_read_idx32(dp_current_al++);
+                cmd_buf[rdp_cmd_fill.pos++] = rdram_read_idx32(dp_current_al++);
             }
         }
 
         // if there's enough data for the current command...
-        if (rdp_cmd_pos == rdp_cmd_len) {
+        if (rdp_cmd_fill.pos == rdp_cmd_fill.len) {
             // check if parallel processing is enabled
             if (config.parallel) {
                 // special case: sync_full always needs to be run in main thread
-                if (rdp_cmd_id == CMD_ID_SYNC_FULL) {
-                    // first, run all pending commands
-                    cmd_flush();
+                if (rdp_cmd_fill.id == CMD_ID_SYNC_FULL) {
+                    // first, finish all pending commands
+                    cmd_sync();
 
                     // parameters are unused, so NULL is fine
                     rdp_sync_full(NULL, NULL);
                 } else {
                     // increment buffer position
-                    rdp_cmd_buf_pos++;
+                    rdp_cmd_fill.buf->num_cmds++;
 
                     // flush buffer when it is full or when the current command requires a sync
-                    if (rdp_cmd_buf_pos >= CMD_BUFFER_SIZE || rdp_commands[rdp_cmd_id].sync) {
+                    if (rdp_cmd_fill.buf->num_cmds >= CMD_BUFFER_SIZE || rdp_commands[rdp_cmd_fill.id].sync) {
                         cmd_flush();
                     }
                 }
@@ -112,29 +112,90 @@ static INLINE void set_mul_alpha_input(struct rdp_state* rdp, int32_t **input, i
     }
 }
 
-static STRICTINLINE int32_t color_combiner_equation(int32_t a, int32_t b, int32_t c, int32_t d)
+// evaluates the color combiner equation for all four channels at once, the RGB
+// channels keep the 8 fractional bits and alpha is reduced to 9 bits
+static STRICTINLINE void combiner_equation_rgba(struct color* out, const struct color* a, const struct color* b, const struct color* c, const struct color* d)
 {
-
-
-
-
-
-    a = special_9bit_exttable[a];
-    b = special_9bit_exttable[b];
-    c = SIGNF(c, 9);
-    d = special_9bit_exttable[d];
-    a = ((a - b) * c) + (d << 8) + 0x80;
-    return (a & 0x1ffff);
+#if defined(RDP_SIMD_SSE2)
+    const __m128i top_bits = _mm_set1_epi32(0x180);
+    const __m128i sign_bit = _mm_set1_epi32(0x100);
+    __m128i va = _mm_loadu_si128((const __m128i*)a);
+    __m128i vb = _mm_loadu_si128((const __m128i*)b);
+    __m128i vc = _mm_loadu_si128((const __m128i*)c);
+    __m128i vd = _mm_loadu_si128((const __m128i*)d);
+
+    // same as special_9bit_exttable
+    va = _mm_or_si128(va, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(va, top_bits), top_bits), _mm_set1_epi32(~0x1ff)));
+    vb = _mm_or_si128(vb, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(vb, top_bits), top_bits), _mm_set1_epi32(~0x1ff)));
+    vd = _mm_or_si128(vd, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(vd, top_bits), top_bits), _mm_set1_epi32(~0x1ff)));
+
+    // same as SIGNF(c, 9)
+    vc = _mm_or_si128(vc, _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(vc, sign_bit)));
+
+    // both factors fit into 16 bits, so the 32 bit product is assembled from
+    // the low and high halves of a 16 bit multiplication
+    __m128i diff = _mm_packs_epi32(_mm_sub_epi32(va, vb), _mm_setzero_si128());
+    vc = _mm_packs_epi32(vc, _mm_setzero_si128());
+    __m128i prod = _mm_unpacklo_epi16(_mm_mullo_epi16(diff, vc), _mm_mulhi_epi16(diff, vc));
+
+    __m128i sum = _mm_add_epi32(_mm_add_epi32(prod, _mm_slli_epi32(vd, 8)), _mm_set1_epi32(0x80));
+    _mm_storeu_si128((__m128i*)out, sum);
+#elif defined(RDP_SIMD_NEON)
+    const int32x4_t top_bits = vdupq_n_s32(0x180);
+    const int32x4_t sign_bit = vdupq_n_s32(0x100);
+    const int32x4_t ext_bits = vdupq_n_s32(~0x1ff);
+    int32x4_t va = vld1q_s32(&a->r);
+    int32x4_t vb = vld1q_s32(&b->r);
+    int32x4_t vc = vld1q_s32(&c->r);
+    int32x4_t vd = vld1q_s32(&d->r);
+
+    // same as special_9bit_exttable
+    va = vorrq_s32(va, vandq_s32(vreinterpretq_s32_u32(vceqq_s32(vandq_s32(va, top_bits), top_bits)), ext_bits));
+    vb = vorrq_s32(vb, vandq_s32(vreinterpretq_s32_u32(vceqq_s32(vandq_s32(vb, top_bits), top_bits)), ext_bits));
+    vd = vorrq_s32(vd, vandq_s32(vreinterpretq_s32_u32(vceqq_s32(vandq_s32(vd, top_bits), top_bits)), ext_bits));
+
+    // same as SIGNF(c, 9)
+    vc = vorrq_s32(vc, vnegq_s32(vandq_s32(vc, sign_bit)));
+
+    int32x4_t sum = vmlaq_s32(vaddq_s32(vshlq_n_s32(vd, 8), vdupq_n_s32(0x80)), vsubq_s32(va, vb), vc);
+    vst1q_s32(&out->r, sum);
+#else
+    out->r = ((special_9bit_exttable[a->r] - special_9bit_exttable[b->r]) * SIGNF(c->r, 9)) + (special_9bit_exttable[d->r] << 8) + 0x80;
+    out->g = ((special_9bit_exttable[a->g] - special_9bit_exttable[b->g]) * SIGNF(c->g, 9)) + (special_9bit_exttable[d->g] << 8) + 0x80;
+    out->b = ((special_9bit_exttable[a->b] - special_9bit_exttable[b->b]) * SIGNF(c->b, 9)) + (special_9bit_exttable[d->b] << 8) + 0x80;
+    out->a = ((special_9bit_exttable[a->a] - special_9bit_exttable[b->a]) * SIGNF(c->a, 9)) + (special_9bit_exttable[d->a] << 8) + 0x80;
+#endif
+
+    out->r &= 0x1ffff;
+    out->g &= 0x1ffff;
+    out->b &= 0x1ffff;
+    out->a = (out->a >> 8) & 0x1ff;
 }
 
-static STRICTINLINE int32_t alpha_combiner_equation(int32_t a, int32_t b, int32_t c, int32_t d)
+// gathers the combiner inputs of a cycle, a zero multiplier makes the equation
+// reduce to the add input, so there is no separate path for it
+static STRICTINLINE void combiner_cycle(struct rdp_state* rdp, int cycle)
 {
-    a = special_9bit_exttable[a];
-    b = special_9bit_exttable[b];
-    c = SIGNF(c, 9);
-    d = special_9bit_exttable[d];
-    a = (((a - b) * c) + (d << 8) + 0x80) >> 8;
-    return (a & 0x1ff);
+    struct color a, b, c, d;
+
+    a.r = *rdp->combiner_rgbsub_a_r[cycle];
+    a.g = *rdp->combiner_rgbsub_a_g[cycle];
+    a.b = *rdp->combiner_rgbsub_a_b[cycle];
+    a.a = *rdp->combiner_alphasub_a[cycle];
+    b.r = *rdp->combiner_rgbsub_b_r[cycle];
+    b.g = *rdp->combiner_rgbsub_b_g[cycle];
+    b.b = *rdp->combiner_rgbsub_b_b[cycle];
+    b.a = *rdp->combiner_alphasub_b[cycle];
+    c.r = *rdp->combiner_rgbmul_r[cycle];
+    c.g = *rdp->combiner_rgbmul_g[cycle];
+    c.b = *rdp->combiner_rgbmul_b[cycle];
+    c.a = *rdp->combiner_alphamul[cycle];
+    d.r = *rdp->combiner_rgbadd_r[cycle];
+    d.g = *rdp->combiner_rgbadd_g[cycle];
+    d.b = *rdp->combiner_rgbadd_b[cycle];
+    d.a = *rdp->combiner_alphaadd[cycle];
+
+    combiner_equation_rgba(&rdp->combined_color, &a, &b, &c, &d);
 }
 
 static STRICTINLINE int32_t chroma_key_min(struct rdp_state* rdp, struct color* col)
@@ -186,39 +247,7 @@ static STRICTINLINE void combiner_1cycle(struct rdp_state* rdp, int adseed, uint
 
 
 
-    if (rdp->combiner_rgbmul_r[1] != &zero_color)
-    {
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-        rdp->combined_color.r = color_combiner_equation(*rdp->combiner_rgbsub_a_r[1],*rdp->combiner_rgbsub_b_r[1],*rdp->combiner_rgbmul_r[1],*rdp->combiner_rgbadd_r[1]);
-        rdp->combined_color.g = color_combiner_equation(*rdp->combiner_rgbsub_a_g[1],*rdp->combiner_rgbsub_b_g[1],*rdp->combiner_rgbmul_g[1],*rdp->combiner_rgbadd_g[1]);
-        rdp->combined_color.b = color_combiner_equation(*rdp->combiner_rgbsub_a_b[1],*rdp->combiner_rgbsub_b_b[1],*rdp->combiner_rgbmul_b[1],*rdp->combiner_rgbadd_b[1]);
-    }
-    else
-    {
-        rdp->combined_color.r = ((special_9bit_exttable[*rdp->combiner_rgbadd_r[1]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.g = ((special_9bit_exttable[*rdp->combiner_rgbadd_g[1]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.b = ((special_9bit_exttable[*rdp->combiner_rgbadd_b[1]] << 8) + 0x80) & 0x1ffff;
-    }
-
-    if (rdp->combiner_alphamul[1] != &zero_color)
-        rdp->combined_color.a = alpha_combiner_equation(*rdp->combiner_alphasub_a[1],*rdp->combiner_alphasub_b[1],*rdp->combiner_alphamul[1],*rdp->combiner_alphaadd[1]);
-    else
-        rdp->combined_color.a = special_9bit_exttable[*rdp->combiner_alphaadd[1]] & 0x1ff;
+    combiner_cycle(rdp, 1);
 
     rdp->pixel_color.a = special_9bit_clamptable[rdp->combined_color.a];
     if (rdp->pixel_color.a == 0xff)
@@ -288,23 +317,7 @@ static STRICTINLINE void combiner_2cycle(struct rdp_state* rdp, int adseed, uint
     int32_t keyalpha, temp;
     struct color chromabypass;
 
-    if (rdp->combiner_rgbmul_r[0] != &zero_color)
-    {
-        rdp->combined_color.r = color_combiner_equation(*rdp->combiner_rgbsub_a_r[0],*rdp->combiner_rgbsub_b_r[0],*rdp->combiner_rgbmul_r[0],*rdp->combiner_rgbadd_r[0]);
-        rdp->combined_color.g = color_combiner_equation(*rdp->combiner_rgbsub_a_g[0],*rdp->combiner_rgbsub_b_g[0],*rdp->combiner_rgbmul_g[0],*rdp->combiner_rgbadd_g[0]);
-        rdp->combined_color.b = color_combiner_equation(*rdp->combiner_rgbsub_a_b[0],*rdp->combiner_rgbsub_b_b[0],*rdp->combiner_rgbmul_b[0],*rdp->combiner_rgbadd_b[0]);
-    }
-    else
-    {
-        rdp->combined_color.r = ((special_9bit_exttable[*rdp->combiner_rgbadd_r[0]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.g = ((special_9bit_exttable[*rdp->combiner_rgbadd_g[0]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.b = ((special_9bit_exttable[*rdp->combiner_rgbadd_b[0]] << 8) + 0x80) & 0x1ffff;
-    }
-
-    if (rdp->combiner_alphamul[0] != &zero_color)
-        rdp->combined_color.a = alpha_combiner_equation(*rdp->combiner_alphasub_a[0],*rdp->combiner_alphasub_b[0],*rdp->combiner_alphamul[0],*rdp->combiner_alphaadd[0]);
-    else
-        rdp->combined_color.a = special_9bit_exttable[*rdp->combiner_alphaadd[0]] & 0x1ff;
+    combiner_cycle(rdp, 0);
 
 
 
@@ -371,23 +384,7 @@ static STRICTINLINE void combiner_2cycle(struct rdp_state* rdp, int adseed, uint
         chromabypass.b = *rdp->combiner_rgbsub_a_b[1];
     }
 
-    if (rdp->combiner_rgbmul_r[1] != &zero_color)
-    {
-        rdp->combined_color.r = color_combiner_equation(*rdp->combiner_rgbsub_a_r[1],*rdp->combiner_rgbsub_b_r[1],*rdp->combiner_rgbmul_r[1],*rdp->combiner_rgbadd_r[1]);
-        rdp->combined_color.g = color_combiner_equation(*rdp->combiner_rgbsub_a_g[1],*rdp->combiner_rgbsub_b_g[1],*rdp->combiner_rgbmul_g[1],*rdp->combiner_rgbadd_g[1]);
-        rdp->combined_color.b = color_combiner_equation(*rdp->combiner_rgbsub_a_b[1],*rdp->combiner_rgbsub_b_b[1],*rdp->combiner_rgbmul_b[1],*rdp->combiner_rgbadd_b[1]);
-    }
-    else
-    {
-        rdp->combined_color.r = ((special_9bit_exttable[*rdp->combiner_rgbadd_r[1]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.g = ((special_9bit_exttable[*rdp->combiner_rgbadd_g[1]] << 8) + 0x80) & 0x1ffff;
-        rdp->combined_color.b = ((special_9bit_exttable[*rdp->combiner_rgbadd_b[1]] << 8) + 0x80) & 0x1ffff;
-    }
-
-    if (rdp->combiner_alphamul[1] != &zero_color)
-        rdp->combined_color.a = alpha_combiner_equation(*rdp->combiner_alphasub_a[1],*rdp->combiner_alphasub_b[1],*rdp->combiner_alphamul[1],*rdp->combiner_alphaadd[1]);
-    else
-        rdp->combined_color.a = special_9bit_exttable[*rdp->combiner_alphaadd[1]] & 0x1ff;
+    combiner_cycle(rdp, 1);
 
     if (!rdp->other_modes.key_en)
     {
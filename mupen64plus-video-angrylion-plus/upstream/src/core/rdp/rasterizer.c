@@ -177,7 +177,7 @@ static STRICTINLINE void rgbaz_correct_clip(struct rdp_state* rdp, int offx, int
     *z = zanded;
 }
 
-static void render_spans_1cycle_complete(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_1cycle_complete(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -364,12 +364,12 @@ static void render_spans_1cycle_complete(struct rdp_state* rdp, int start, int e
             combiner_1cycle(rdp, adith, &curpixel_cvg);
 
             rdp->fbread1_ptr(rdp, curpixel, &curpixel_memcvg);
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -392,7 +392,7 @@ static void render_spans_1cycle_complete(struct rdp_state* rdp, int start, int e
 }
 
 
-static void render_spans_1cycle_notexel1(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_1cycle_notexel1(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -535,12 +535,12 @@ static void render_spans_1cycle_notexel1(struct rdp_state* rdp, int start, int e
             combiner_1cycle(rdp, adith, &curpixel_cvg);
 
             rdp->fbread1_ptr(rdp, curpixel, &curpixel_memcvg);
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -563,7 +563,7 @@ static void render_spans_1cycle_notexel1(struct rdp_state* rdp, int start, int e
 }
 
 
-static void render_spans_1cycle_notex(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_1cycle_notex(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -673,12 +673,12 @@ static void render_spans_1cycle_notex(struct rdp_state* rdp, int start, int end,
             combiner_1cycle(rdp, adith, &curpixel_cvg);
 
             rdp->fbread1_ptr(rdp, curpixel, &curpixel_memcvg);
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -696,7 +696,7 @@ static void render_spans_1cycle_notex(struct rdp_state* rdp, int start, int end,
     }
 }
 
-static void render_spans_2cycle_complete(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_2cycle_complete(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -877,12 +877,12 @@ static void render_spans_2cycle_complete(struct rdp_state* rdp, int start, int e
 
             rdp->fbread2_ptr(rdp, curpixel, &curpixel_memcvg);
 
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit, acalpha))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -914,7 +914,7 @@ static void render_spans_2cycle_complete(struct rdp_state* rdp, int start, int e
 
 
 
-static void render_spans_2cycle_notexelnext(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_2cycle_notexelnext(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -1056,12 +1056,12 @@ static void render_spans_2cycle_notexelnext(struct rdp_state* rdp, int start, in
 
 
 
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit, acalpha))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -1086,7 +1086,7 @@ static void render_spans_2cycle_notexelnext(struct rdp_state* rdp, int start, in
 }
 
 
-static void render_spans_2cycle_notexel1(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_2cycle_notexel1(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -1224,12 +1224,12 @@ static void render_spans_2cycle_notexel1(struct rdp_state* rdp, int start, int e
 
             rdp->fbread2_ptr(rdp, curpixel, &curpixel_memcvg);
 
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit, acalpha))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
 
@@ -1255,7 +1255,7 @@ static void render_spans_2cycle_notexel1(struct rdp_state* rdp, int start, int e
 }
 
 
-static void render_spans_2cycle_notex(struct rdp_state* rdp, int start, int end, int tilenum, int flip)
+static inline void render_spans_2cycle_notex(struct rdp_state* rdp, int start, int end, int tilenum, int flip, int z_compare_en, int z_update_en)
 {
     int zb = rdp->zb_address >> 1;
     int zbcur;
@@ -1366,12 +1366,12 @@ static void render_spans_2cycle_notex(struct rdp_state* rdp, int start, int end,
 
             rdp->fbread2_ptr(rdp, curpixel, &curpixel_memcvg);
 
-            if (z_compare(rdp, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
+            if (z_compare(rdp, z_compare_en, zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(rdp, &fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit, acalpha))
                 {
                     rdp->fbwrite_ptr(rdp, curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (rdp->other_modes.z_update_en)
+                    if (z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -1392,6 +1392,46 @@ static void render_spans_2cycle_notex(struct rdp_state* rdp, int start, int end,
     }
 }
 
+// generates a variant of a span renderer for each combination of z_compare_en
+// and z_update_en, so the compiler can resolve the per-pixel depth branches
+// at compile time
+#define RENDER_SPANS_SPECIALIZE(name) \
+    static void name##_z00(struct rdp_state* rdp, int start, int end, int tilenum, int flip) \
+    { name(rdp, start, end, tilenum, flip, 0, 0); } \
+    static void name##_z01(struct rdp_state* rdp, int start, int end, int tilenum, int flip) \
+    { name(rdp, start, end, tilenum, flip, 0, 1); } \
+    static void name##_z10(struct rdp_state* rdp, int start, int end, int tilenum, int flip) \
+    { name(rdp, start, end, tilenum, flip, 1, 0); } \
+    static void name##_z11(struct rdp_state* rdp, int start, int end, int tilenum, int flip) \
+    { name(rdp, start, end, tilenum, flip, 1, 1); }
+
+#define RENDER_SPANS_VARIANTS(name) {name##_z00, name##_z01, name##_z10, name##_z11}
+
+RENDER_SPANS_SPECIALIZE(render_spans_1cycle_complete)
+RENDER_SPANS_SPECIALIZE(render_spans_1cycle_notexel1)
+RENDER_SPANS_SPECIALIZE(render_spans_1cycle_notex)
+RENDER_SPANS_SPECIALIZE(render_spans_2cycle_complete)
+RENDER_SPANS_SPECIALIZE(render_spans_2cycle_notexelnext)
+RENDER_SPANS_SPECIALIZE(render_spans_2cycle_notexel1)
+RENDER_SPANS_SPECIALIZE(render_spans_2cycle_notex)
+
+// indexed by textureuselevel0 and (z_compare_en << 1) | z_update_en
+static void (*render_spans_1cycle_func[3][4])(struct rdp_state*, int, int, int, int) =
+{
+    RENDER_SPANS_VARIANTS(render_spans_1cycle_complete),
+    RENDER_SPANS_VARIANTS(render_spans_1cycle_notexel1),
+    RENDER_SPANS_VARIANTS(render_spans_1cycle_notex)
+};
+
+// indexed by textureuselevel1 and (z_compare_en << 1) | z_update_en
+static void (*render_spans_2cycle_func[4][4])(struct rdp_state*, int, int, int, int) =
+{
+    RENDER_SPANS_VARIANTS(render_spans_2cycle_complete),
+    RENDER_SPANS_VARIANTS(render_spans_2cycle_notexelnext),
+    RENDER_SPANS_VARIANTS(render_spans_2cycle_notexel1),
+    RENDER_SPANS_VARIANTS(render_spans_2cycle_notex)
+};
+
 static void render_spans_fill(struct rdp_state* rdp, int start, int end, int flip)
 {
     if (rdp->fb_size == PIXEL_SIZE_4BIT)
@@ -1904,9 +1944,6 @@ static void edgewalker_for_prims(struct rdp_state* rdp, int32_t* ewdata)
     xfrac = ((xright >> 8) & 0xff);
 
 
-    uint32_t worker_id = rdp->worker_id;
-    uint32_t num_workers = config.parallel ? parallel_num_workers() : 1;
-
     if (flip)
     {
     for (k = ycur; k <= ylfar; k++)
@@ -1987,7 +2024,7 @@ static void edgewalker_for_prims(struct rdp_state* rdp, int32_t* ewdata)
             {
                 rdp->span[j].lx = maxxmx;
                 rdp->span[j].rx = minxhx;
-                rdp->span[j].validline  = !allinval && !allover && !allunder && (!rdp->scfield || (rdp->scfield && !(rdp->sckeepodd ^ (j & 1)))) && (!config.parallel || j % num_workers == worker_id);
+                rdp->span[j].validline  = !allinval && !allover && !allunder && (!rdp->scfield || (rdp->scfield && !(rdp->sckeepodd ^ (j & 1)))) && (!config.parallel || (j >= rdp->band_begin && j < rdp->band_end));
 
             }
 
@@ -2074,7 +2111,7 @@ static void edgewalker_for_prims(struct rdp_state* rdp, int32_t* ewdata)
             {
                 rdp->span[j].lx = minxmx;
                 rdp->span[j].rx = maxxhx;
-                rdp->span[j].validline  = !allinval && !allover && !allunder && (!rdp->scfield || (rdp->scfield && !(rdp->sckeepodd ^ (j & 1)))) && (!config.parallel || j % num_workers == worker_id);
+                rdp->span[j].validline  = !allinval && !allover && !allunder && (!rdp->scfield || (rdp->scfield && !(rdp->sckeepodd ^ (j & 1)))) && (!config.parallel || (j >= rdp->band_begin && j < rdp->band_end));
             }
 
         }
@@ -2096,21 +2133,8 @@ static void edgewalker_for_prims(struct rdp_state* rdp, int32_t* ewdata)
     switch(rdp->other_modes.cycle_type)
     {
         case CYCLE_TYPE_1:
-            switch (rdp->other_modes.f.textureuselevel0)
-            {
-                case 0: render_spans_1cycle_complete(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-                case 1: render_spans_1cycle_notexel1(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-                case 2: default: render_spans_1cycle_notex(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-            }
-            break;
         case CYCLE_TYPE_2:
-            switch (rdp->other_modes.f.textureuselevel1)
-            {
-                case 0: render_spans_2cycle_complete(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-                case 1: render_spans_2cycle_notexelnext(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-                case 2: render_spans_2cycle_notexel1(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-                case 3: default: render_spans_2cycle_notex(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
-            }
+            rdp->render_spans_ptr(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip);
             break;
         case CYCLE_TYPE_COPY: render_spans_copy(rdp, yhlimit >> 2, yllimit >> 2, tilenum, flip); break;
         case CYCLE_TYPE_FILL: render_spans_fill(rdp, yhlimit >> 2, yllimit >> 2, flip); break;
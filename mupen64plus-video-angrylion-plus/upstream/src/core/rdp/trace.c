@@ -0,0 +1,116 @@
+//
+// trace.c: RDP command trace capture
+//
+
+static FILE* trace_file;
+static uint8_t* trace_rdram_shadow;
+static uint8_t trace_dmem_shadow[TRACE_DMEM_SIZE];
+
+static void trace_write(uint32_t type, uint32_t arg, const void* payload, size_t size)
+{
+    struct trace_record record = { type, arg };
+    if (fwrite(&record, sizeof(record), 1, trace_file) != 1 ||
+        fwrite(payload, size, 1, trace_file) != 1) {
+        msg_warning("trace: write failed, stopping capture");
+        rdp_trace_end();
+    }
+}
+
+static void trace_write_memory(void)
+{
+    uint8_t* rdram = plugin_get_rdram();
+    uint8_t* dmem = plugin_get_dmem();
+    uint32_t rdram_size = plugin_get_rdram_size();
+    uint32_t page;
+
+    // the workers must not write into RDRAM while it is compared
+    if (config.parallel) {
+        parallel_wait();
+    }
+
+    for (page = 0; page < rdram_size / TRACE_PAGE_SIZE && trace_file; page++) {
+        uint32_t offset = page * TRACE_PAGE_SIZE;
+        if (memcmp(trace_rdram_shadow + offset, rdram + offset, TRACE_PAGE_SIZE)) {
+            memcpy(trace_rdram_shadow + offset, rdram + offset, TRACE_PAGE_SIZE);
+            trace_write(TRACE_RECORD_RDRAM_PAGE, page, rdram + offset, TRACE_PAGE_SIZE);
+        }
+    }
+
+    if (trace_file && memcmp(trace_dmem_shadow, dmem, TRACE_DMEM_SIZE)) {
+        memcpy(trace_dmem_shadow, dmem, TRACE_DMEM_SIZE);
+        trace_write(TRACE_RECORD_DMEM, 0, dmem, TRACE_DMEM_SIZE);
+    }
+}
+
+static void trace_write_registers(uint32_t type, uint32_t** regs, uint32_t num_regs)
+{
+    uint32_t values[DP_NUM_REG > VI_NUM_REG ? DP_NUM_REG : VI_NUM_REG];
+    uint32_t i;
+
+    for (i = 0; i < num_regs; i++) {
+        values[i] = *regs[i];
+    }
+
+    trace_write(type, 0, values, num_regs * sizeof(uint32_t));
+}
+
+static void trace_dp_update(void)
+{
+    if (!trace_file) {
+        return;
+    }
+
+    trace_write_memory();
+    if (trace_file) {
+        trace_write_registers(TRACE_RECORD_DP_UPDATE, plugin_get_dp_registers(), DP_NUM_REG);
+    }
+}
+
+static void trace_vi_update(void)
+{
+    if (!trace_file) {
+        return;
+    }
+
+    trace_write_memory();
+    if (trace_file) {
+        trace_write_registers(TRACE_RECORD_VI_UPDATE, plugin_get_vi_registers(), VI_NUM_REG);
+    }
+}
+
+bool rdp_trace_begin(const char* path)
+{
+    struct trace_header header = { TRACE_MAGIC, TRACE_VERSION, plugin_get_rdram_size() };
+
+    rdp_trace_end();
+
+    // start with empty shadow memory, so the first update records everything
+    trace_rdram_shadow = calloc(header.rdram_size, 1);
+    memset(trace_dmem_shadow, 0, sizeof(trace_dmem_shadow));
+
+    trace_file = fopen(path, "wb");
+    if (!trace_rdram_shadow || !trace_file) {
+        msg_warning("trace: can't open %s", path);
+        rdp_trace_end();
+        return false;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, trace_file) != 1) {
+        msg_warning("trace: write failed, stopping capture");
+        rdp_trace_end();
+        return false;
+    }
+
+    return true;
+}
+
+void rdp_trace_end(void)
+{
+    if (trace_file) {
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+
+    free(trace_rdram_shadow);
+    trace_rdram_shadow = NULL;
+}
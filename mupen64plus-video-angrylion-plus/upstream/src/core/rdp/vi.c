@@ -87,6 +87,18 @@ static uint32_t prescale[PRESCALE_WIDTH * PRESCALE_HEIGHT];
 static uint32_t prescale_ptr;
 static int32_t linecount;
 
+// output buffer of the unfiltered modes, mapped from the screen if possible
+static struct rdp_frame_buffer fb_fast;
+static bool fb_fast_skip;
+
+// registers and frame buffer hash of the last filtered frame per field, the
+// filter pass is skipped when neither has changed since and the previous
+// output still in prescale is reused
+static uint32_t vi_cache_regs[12];
+static uint64_t vi_cache_hash[2];
+static bool vi_cache_valid[2];
+static bool vi_cache_hit;
+
 // parsed VI registers
 static uint32_t** vi_reg_ptr;
 static union vi_reg_ctrl ctrl;
@@ -122,6 +134,10 @@ static void vi_init(void)
     oldvstart = 1337;
     prevwasblank = false;
 
+    memset(vi_cache_regs, 0, sizeof(vi_cache_regs));
+    vi_cache_valid[0] = vi_cache_valid[1] = false;
+    vi_cache_hit = false;
+
     // select filter functions based on config
     if (config.vi.mode == VI_MODE_NORMAL) {
         vi_process_start_ptr = vi_process_start;
@@ -135,6 +151,67 @@ static void vi_init(void)
     }
 }
 
+static uint64_t vi_hash_frame_buffer(void)
+{
+    // hash all lines the filters may fetch from, including the neighboring
+    // lines used by the AA, divot and dither filters
+    int32_t line_begin = MAX((int32_t)(y_start >> 10) - 1, 0);
+    int32_t line_end = (int32_t)((y_start + MAX(vres, 0) * y_add) >> 10) + 3;
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint32_t i;
+
+    if (ctrl.type & 1) {
+        uint32_t begin = (frame_buffer >> 2) + line_begin * vi_width_low;
+        uint32_t end = MIN((frame_buffer >> 2) + line_end * vi_width_low, idxlim32 + 1);
+        for (i = begin; i < end; i++) {
+            hash = (hash ^ rdram32[i]) * 0x100000001b3ULL;
+        }
+    } else {
+        uint32_t begin = (frame_buffer >> 1) + line_begin * vi_width_low;
+        uint32_t end = MIN((frame_buffer >> 1) + line_end * vi_width_low, idxlim16 + 1);
+        for (i = begin >> 1; i < (end + 1) >> 1; i++) {
+            hash = (hash ^ rdram32[i]) * 0x100000001b3ULL;
+        }
+
+        // the coverage bits are stored separately for 16 bit frame buffers
+        for (i = begin; i + 8 <= end; i += 8) {
+            uint64_t hval;
+            memcpy(&hval, &rdram_hidden[i], sizeof(hval));
+            hash = (hash ^ hval) * 0x100000001b3ULL;
+        }
+        for (; i < end; i++) {
+            hash = (hash ^ rdram_hidden[i]) * 0x100000001b3ULL;
+        }
+    }
+
+    return hash;
+}
+
+static bool vi_cache_check(void)
+{
+    uint32_t regs[] = {
+        ctrl.raw, frame_buffer, vi_width_low, v_sync,
+        h_start, v_start, hres, vres,
+        x_add, x_start, y_add, y_start
+    };
+
+    // a change of the timing or scaling registers may move the image in
+    // prescale, so the output of both fields has to be refiltered
+    if (memcmp(regs, vi_cache_regs, sizeof(regs))) {
+        memcpy(vi_cache_regs, regs, sizeof(regs));
+        vi_cache_valid[0] = vi_cache_valid[1] = false;
+    }
+
+    uint64_t hash = vi_hash_frame_buffer();
+    bool hit = vi_cache_valid[lowerfield] && vi_cache_hash[lowerfield] == hash;
+
+    vi_cache_hash[lowerfield] = hash;
+    vi_cache_valid[lowerfield] = true;
+
+    return hit;
+}
+
 static bool vi_process_start(void)
 {
     uint32_t final = 0;
@@ -236,6 +313,7 @@ static bool vi_process_start(void)
         // blank signal, clear entire screen buffer
         memset(tvfadeoutstate, 0, PRESCALE_HEIGHT * sizeof(uint32_t));
         memset(prescale, 0, sizeof(prescale));
+        vi_cache_valid[0] = vi_cache_valid[1] = false;
     } else {
         // clear left border
         int32_t j;
@@ -320,9 +398,25 @@ static bool vi_process_start(void)
         }
     }
 
+    vi_cache_hit = validh && !isblank && vi_cache_check();
+
     return validh;
 }
 
+static void vi_get_rows(uint32_t worker_id, int32_t rows, int32_t* y_begin, int32_t* y_end)
+{
+    // give each worker one contiguous chunk of scanlines, so neighboring
+    // scanlines that share fetched pixels are processed by the same worker
+    if (config.parallel) {
+        uint32_t num_workers = parallel_num_workers();
+        *y_begin = (int32_t)((int64_t)rows * worker_id / num_workers);
+        *y_end = (int32_t)((int64_t)rows * (worker_id + 1) / num_workers);
+    } else {
+        *y_begin = 0;
+        *y_end = rows;
+    }
+}
+
 static void vi_process(uint32_t worker_id)
 {
     int32_t y;
@@ -349,20 +443,28 @@ static void vi_process(uint32_t worker_id)
 
     bool cache_init = false;
 
+    if (vi_cache_hit) {
+        return;
+    }
+
     pixels = 0;
 
     int32_t* seed = &rdp_states[worker_id].seed_vi;
 
-    int32_t y_begin = 0;
-    int32_t y_end = vres;
-    int32_t y_inc = 1;
+    int32_t y_begin, y_end;
+    vi_get_rows(worker_id, vres, &y_begin, &y_end);
 
-    if (config.parallel) {
-        y_begin = worker_id;
-        y_inc = parallel_num_workers();
+    // the fetch bug state depends on all previous scanlines, so restore the
+    // state the serial loop would have at the first scanline of this worker
+    for (y = 0; y < y_begin; y++) {
+        if (((y_start + y * y_add) >> 10) == ((y_start + (y + 1) * y_add) >> 10)) {
+            fetchbugstate = 2;
+        } else {
+            fetchbugstate >>= 1;
+        }
     }
 
-    for (y = y_begin; y < y_end; y += y_inc) {
+    for (y = y_begin; y < y_end; y++) {
         int32_t x;
         uint32_t x_offs = x_start;
         uint32_t curry = y_start + y * y_add;
@@ -569,33 +671,41 @@ static bool vi_process_start_fast(void)
         return false;
     }
 
+    // drop every other interlaced frame to avoid "wobbly" output due to the
+    // vertical offset, the previous frame just stays on screen
+    fb_fast_skip = ctrl.serrate && v_current_line;
+    if (fb_fast_skip) {
+        return true;
+    }
+
+    fb_fast.width = hres_raw;
+    fb_fast.height = vres_raw;
+    fb_fast.pitch = hres_raw;
+
+    // write the frame directly into the upload buffer of the screen so it
+    // doesn't have to be copied again, fall back to prescale otherwise
+    if (!screen_map(&fb_fast)) {
+        fb_fast.pixels = prescale;
+    }
+
     return true;
 }
 
 static void vi_process_fast(uint32_t worker_id)
 {
     int32_t y;
-    int32_t y_begin = 0;
-    int32_t y_end = vres_raw;
-    int32_t y_inc = 1;
+    int32_t y_begin, y_end;
 
-    // drop every other interlaced frame to avoid "wobbly" output due to the
-    // vertical offset
-    // TODO: completely skip rendering these frames in unfiltered to improve
-    // performance?
-    if (ctrl.serrate && v_current_line) {
+    if (fb_fast_skip) {
         return;
     }
 
-    if (config.parallel) {
-        y_begin = worker_id;
-        y_inc = parallel_num_workers();
-    }
+    vi_get_rows(worker_id, vres_raw, &y_begin, &y_end);
 
-    for (y = y_begin; y < y_end; y += y_inc) {
+    for (y = y_begin; y < y_end; y++) {
         int32_t x;
         int32_t line = y * vi_width_low;
-        uint32_t* dst = prescale + y * hres_raw;
+        uint32_t* dst = fb_fast.pixels + y * fb_fast.pitch;
 
         for (x = 0; x < hres_raw; x++) {
             uint32_t r, g, b;
@@ -651,11 +761,9 @@ static void vi_process_fast(uint32_t worker_id)
 
 static void vi_process_end_fast(void)
 {
-    struct rdp_frame_buffer fb;
-    fb.pixels = prescale;
-    fb.width = hres_raw;
-    fb.height = vres_raw;
-    fb.pitch = hres_raw;
+    if (fb_fast_skip) {
+        return;
+    }
 
     int32_t filtered_height = (vres << 1) * V_SYNC_NTSC / v_sync;
     int32_t output_height = hres_raw * filtered_height / hres;
@@ -664,11 +772,13 @@ static void vi_process_end_fast(void)
         output_height = output_height * 3 / 4;
     }
 
-    screen_write(&fb, output_height);
+    screen_write(&fb_fast, output_height);
 }
 
 void rdp_update_vi(void)
 {
+    trace_vi_update();
+
     // check for configuration errors
     if (config.vi.mode >= VI_MODE_NUM) {
         msg_error("Invalid VI mode: %d", config.vi.mode);
@@ -733,6 +843,11 @@ void rdp_update_vi(void)
         vbusclock = true;
     }
 
+    // wait for commands that the workers are still rendering into the frame buffer
+    if (config.parallel) {
+        parallel_wait();
+    }
+
     // try to init VI frame, abort if there's nothing to display
     if (!vi_process_start_ptr()) {
         screen_swap(true);
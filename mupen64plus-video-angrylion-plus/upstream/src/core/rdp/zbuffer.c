@@ -213,7 +213,7 @@ static STRICTINLINE uint32_t dz_compress(uint32_t value)
     return j;
 }
 
-static STRICTINLINE uint32_t z_compare(struct rdp_state* rdp, uint32_t zcurpixel, uint32_t sz, uint16_t dzpix, int dzpixenc, uint32_t* blend_en, uint32_t* prewrap, uint32_t* curpixel_cvg, uint32_t curpixel_memcvg)
+static STRICTINLINE uint32_t z_compare(struct rdp_state* rdp, uint32_t z_compare_en, uint32_t zcurpixel, uint32_t sz, uint16_t dzpix, int dzpixenc, uint32_t* blend_en, uint32_t* prewrap, uint32_t* curpixel_cvg, uint32_t curpixel_memcvg)
 {
 
 
@@ -225,7 +225,7 @@ static STRICTINLINE uint32_t z_compare(struct rdp_state* rdp, uint32_t zcurpixel
     uint32_t oz, dzmem;
     int32_t rawdzmem;
 
-    if (rdp->other_modes.z_compare_en)
+    if (z_compare_en)
     {
         PAIRREAD16(zval, hval, zcurpixel);
         oz = z_decompress(zval);
@@ -7,6 +7,7 @@
 
 void screen_init(struct rdp_config* config);
 void screen_swap(bool blank);
+bool screen_map(struct rdp_frame_buffer* fb);
 void screen_write(struct rdp_frame_buffer* fb, int32_t output_height);
 void screen_read(struct rdp_frame_buffer* fb, bool rgb);
 void screen_set_fullscreen(bool fullscreen);
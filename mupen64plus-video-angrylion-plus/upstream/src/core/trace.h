@@ -0,0 +1,43 @@
+#pragma once
+
+#include "rdp.h"
+
+#include <stdint.h>
+
+// RDP command trace file format, all values are stored in host byte order.
+//
+// The file starts with a header, followed by a sequence of records. Each
+// record begins with its type and an argument, followed by a payload with a
+// fixed size per type. RDRAM and DMEM contents are only recorded when they
+// changed since the previous update, the first update records all of RDRAM.
+
+#define TRACE_MAGIC 0x54504c41 // "ALPT"
+#define TRACE_VERSION 1
+
+// size of the RDRAM pages that are compared and recorded
+#define TRACE_PAGE_SIZE 0x1000
+
+// size of the RSP data memory
+#define TRACE_DMEM_SIZE 0x1000
+
+enum trace_record_type
+{
+    TRACE_RECORD_RDRAM_PAGE,    // arg: page index, payload: TRACE_PAGE_SIZE bytes
+    TRACE_RECORD_DMEM,          // arg: unused, payload: TRACE_DMEM_SIZE bytes
+    TRACE_RECORD_DP_UPDATE,     // arg: unused, payload: DP_NUM_REG registers
+    TRACE_RECORD_VI_UPDATE,     // arg: unused, payload: VI_NUM_REG registers
+    TRACE_RECORD_NUM
+};
+
+struct trace_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rdram_size;
+};
+
+struct trace_record
+{
+    uint32_t type;
+    uint32_t arg;
+};
@@ -19,6 +19,10 @@
 static GLuint program;
 static GLuint vao;
 static GLuint texture;
+static GLuint pbo;
+
+// pixel buffer currently mapped for writing by gl_screen_map
+static uint8_t* pbo_mapped;
 
 static int32_t tex_width;
 static int32_t tex_height;
@@ -168,12 +172,47 @@ void gl_screen_init(struct rdp_config* config)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 
+    // prepare pixel buffer for direct texture uploads
+    glGenBuffers(1, &pbo);
+
     // check if there was an error when using any of the commands above
     gl_check_errors();
 }
 
+bool gl_screen_map(struct rdp_frame_buffer* fb)
+{
+    GLsizeiptr size = fb->pitch * fb->height * sizeof(*fb->pixels);
+
+    // orphan the previous storage so that the driver doesn't have to wait
+    // for the last upload to finish before the buffer can be written again
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    pbo_mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    fb->pixels = (uint32_t*)pbo_mapped;
+
+    gl_check_errors();
+
+    return pbo_mapped != NULL;
+}
+
 bool gl_screen_write(struct rdp_frame_buffer* fb, int32_t output_height)
 {
+    const GLvoid* pixels = fb->pixels;
+
+    // if the frame was written into the mapped pixel buffer, upload directly
+    // from there instead of the client memory
+    if (pbo_mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+            msg_debug("%s: pixel buffer contents lost", __FUNCTION__);
+        }
+        pixels = (const GLvoid*)((uint8_t*)fb->pixels - pbo_mapped);
+        pbo_mapped = NULL;
+    }
+
     bool buffer_size_changed = tex_width != fb->width || tex_height != fb->height;
 
     // check if the framebuffer size has changed
@@ -186,15 +225,17 @@ bool gl_screen_write(struct rdp_frame_buffer* fb, int32_t output_height)
 
         // reallocate texture buffer on GPU
         glTexImage2D(GL_TEXTURE_2D, 0, TEX_INTERNAL_FORMAT, tex_width,
-            tex_height, 0, TEX_FORMAT, TEX_TYPE, fb->pixels);
+            tex_height, 0, TEX_FORMAT, TEX_TYPE, pixels);
 
         msg_debug("%s: resized framebuffer texture: %dx%d", __FUNCTION__, tex_width, tex_height);
     } else {
         // copy local buffer to GPU texture buffer
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tex_width, tex_height,
-            TEX_FORMAT, TEX_TYPE, fb->pixels);
+            TEX_FORMAT, TEX_TYPE, pixels);
     }
 
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
     // update output size
     tex_display_height = output_height;
 
@@ -254,6 +295,14 @@ void gl_screen_close(void)
 
     tex_display_height = 0;
 
+    if (pbo_mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pbo_mapped = NULL;
+    }
+
+    glDeleteBuffers(1, &pbo);
     glDeleteTextures(1, &texture);
     glDeleteVertexArrays(1, &vao);
     glDeleteProgram(program);
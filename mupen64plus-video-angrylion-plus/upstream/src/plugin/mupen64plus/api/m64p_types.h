@@ -159,6 +159,15 @@ typedef enum {
   M64CMD_ADVANCE_FRAME
 } m64p_command;
 
+/* Kinds of threads for CoreSetThreadRole() */
+typedef enum {
+  M64THREAD_EMULATION = 1,      /* the thread running the emulation */
+  M64THREAD_RENDER,             /* a thread doing a plugin's main rendering */
+  M64THREAD_WORKER,             /* helper threads splitting up per frame work */
+  M64THREAD_AUDIO,              /* audio output feeding threads */
+  M64THREAD_BACKGROUND          /* file I/O and compression, no deadline */
+} m64p_thread_role;
+
 typedef struct {
   uint32_t address;
   int      value;
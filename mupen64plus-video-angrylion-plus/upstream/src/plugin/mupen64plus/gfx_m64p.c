@@ -34,6 +34,8 @@
 #define KEY_VI_WIDESCREEN "ViWidescreen"
 #define KEY_VI_HIDE_OVERSCAN "ViHideOverscan"
 
+#define KEY_TRACE_FILE "TraceFile"
+
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -46,13 +48,20 @@
 
 #include "core/version.h"
 #include "core/msg.h"
+#include "core/parallel.h"
 
 static ptr_ConfigOpenSection      ConfigOpenSection = NULL;
 static ptr_ConfigSaveSection      ConfigSaveSection = NULL;
 static ptr_ConfigSetDefaultInt    ConfigSetDefaultInt = NULL;
 static ptr_ConfigSetDefaultBool   ConfigSetDefaultBool = NULL;
+static ptr_ConfigSetDefaultString ConfigSetDefaultString = NULL;
 static ptr_ConfigGetParamInt      ConfigGetParamInt = NULL;
 static ptr_ConfigGetParamBool     ConfigGetParamBool = NULL;
+static ptr_ConfigGetParamString   ConfigGetParamString = NULL;
+
+/* from m64p_frontend.h, added in Front-end API v2.1.4 and may be missing */
+typedef m64p_error (*ptr_CoreSetThreadRole)(m64p_thread_role);
+static ptr_CoreSetThreadRole CoreSetThreadRole = NULL;
 
 static bool warn_hle;
 static bool plugin_initialized;
@@ -89,6 +98,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle _CoreLibHandle, void *Co
     ConfigSetDefaultBool = (ptr_ConfigSetDefaultBool)DLSYM(CoreLibHandle, "ConfigSetDefaultBool");
     ConfigGetParamInt = (ptr_ConfigGetParamInt)DLSYM(CoreLibHandle, "ConfigGetParamInt");
     ConfigGetParamBool = (ptr_ConfigGetParamBool)DLSYM(CoreLibHandle, "ConfigGetParamBool");
+    ConfigSetDefaultString = (ptr_ConfigSetDefaultString)DLSYM(CoreLibHandle, "ConfigSetDefaultString");
+    ConfigGetParamString = (ptr_ConfigGetParamString)DLSYM(CoreLibHandle, "ConfigGetParamString");
+    CoreSetThreadRole = (ptr_CoreSetThreadRole)DLSYM(CoreLibHandle, "CoreSetThreadRole");
 
     ConfigOpenSection("Video-General", &configVideoGeneral);
     ConfigOpenSection("Video-Angrylion-Plus", &configVideoAngrylionPlus);
@@ -105,6 +117,7 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle _CoreLibHandle, void *Co
     ConfigSetDefaultInt(configVideoAngrylionPlus, KEY_VI_INTERP, config.vi.interp, "Scaling interpolation type (0=NN, 1=Linear)");
     ConfigSetDefaultBool(configVideoAngrylionPlus, KEY_VI_WIDESCREEN, config.vi.widescreen, "Use anamorphic 16:9 output mode if True");
     ConfigSetDefaultBool(configVideoAngrylionPlus, KEY_VI_HIDE_OVERSCAN, config.vi.hide_overscan, "Hide overscan area in filteded mode if True");
+    ConfigSetDefaultString(configVideoAngrylionPlus, KEY_TRACE_FILE, "", "Record RDP command trace for the alp-bench tool to this file (empty=disabled)");
 
     ConfigSaveSection("Video-General");
     ConfigSaveSection("Video-Angrylion-Plus");
@@ -177,6 +190,11 @@ EXPORT void CALL ProcessRDPList(void)
     rdp_update();
 }
 
+static void place_worker_thread(void)
+{
+    CoreSetThreadRole(M64THREAD_WORKER);
+}
+
 EXPORT int CALL RomOpen (void)
 {
     window_fullscreen = ConfigGetParamBool(configVideoGeneral, KEY_FULLSCREEN);
@@ -190,12 +208,20 @@ EXPORT int CALL RomOpen (void)
     config.vi.widescreen = ConfigGetParamBool(configVideoAngrylionPlus, KEY_VI_WIDESCREEN);
     config.vi.hide_overscan = ConfigGetParamBool(configVideoAngrylionPlus, KEY_VI_HIDE_OVERSCAN);
 
+    parallel_set_thread_hook(CoreSetThreadRole ? place_worker_thread : NULL);
     rdp_init(&config);
+
+    const char* trace_file = ConfigGetParamString(configVideoAngrylionPlus, KEY_TRACE_FILE);
+    if (trace_file && trace_file[0]) {
+        rdp_trace_begin(trace_file);
+    }
+
     return 1;
 }
 
 EXPORT void CALL RomClosed (void)
 {
+    rdp_trace_end();
     rdp_close();
 }
 
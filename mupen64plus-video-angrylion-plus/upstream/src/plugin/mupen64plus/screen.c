@@ -82,6 +82,11 @@ void screen_swap(bool blank)
     CoreVideo_GL_SwapBuffers();
 }
 
+bool screen_map(struct rdp_frame_buffer* buffer)
+{
+    return gl_screen_map(buffer);
+}
+
 void screen_write(struct rdp_frame_buffer* buffer, int32_t output_height)
 {
     gl_screen_write(buffer, output_height);
@@ -148,6 +148,11 @@ void screen_init(struct rdp_config* config)
     gl_screen_init(config);
 }
 
+bool screen_map(struct rdp_frame_buffer* buffer)
+{
+    return gl_screen_map(buffer);
+}
+
 void screen_write(struct rdp_frame_buffer* buffer, int32_t output_height)
 {
     gl_screen_write(buffer, output_height);
@@ -44,11 +44,31 @@ extern "C" {
 #endif
 }
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MATH_NEON
+#endif
+
 #include <math.h>
 #include "3dmath.h"
 
 void calc_light (VERTEX *v)
 {
+#ifdef MATH_NEON
+  // LIGHT starts with r, g, b, a so each light's colour is one vector load
+  float32x4_t color = vld1q_f32(&rdp.light[rdp.num_lights].r);
+  for (wxUint32 l=0; l<rdp.num_lights; l++)
+  {
+    float light_intensity = rdp.light_vector[l][0]*v->vec[0] + rdp.light_vector[l][1]*v->vec[1] + rdp.light_vector[l][2]*v->vec[2];
+    if (light_intensity > 0.0f)
+      color = vmlaq_n_f32(color, vld1q_f32(&rdp.light[l].r), light_intensity);
+  }
+  color = vmulq_n_f32(vminq_f32(color, vdupq_n_f32(1.0f)), 255.0f);
+  uint32x4_t rgb = vcvtq_u32_f32(color);
+  v->r = (wxUint8)vgetq_lane_u32(rgb, 0);
+  v->g = (wxUint8)vgetq_lane_u32(rgb, 1);
+  v->b = (wxUint8)vgetq_lane_u32(rgb, 2);
+#else
   float light_intensity = 0.0f;
   float color[3] = {rdp.light[rdp.num_lights].r, rdp.light[rdp.num_lights].g, rdp.light[rdp.num_lights].b};
   for (wxUint32 l=0; l<rdp.num_lights; l++)
@@ -70,6 +90,7 @@ void calc_light (VERTEX *v)
   v->r = (wxUint8)(color[0]*255.0f);
   v->g = (wxUint8)(color[1]*255.0f);
   v->b = (wxUint8)(color[2]*255.0f);
+#endif
 }
 
 //*
@@ -188,6 +209,35 @@ void InverseTransformVectorC (float *src, float *dst, float mat[4][4])
   dst[2] = mat[2][0]*src[0] + mat[2][1]*src[1] + mat[2][2]*src[2];
 }
 
+static inline void TransformVertex(VERTEX *v, float *pos, float mat[4][4])
+{
+  float x = pos[0], y = pos[1], z = pos[2];
+  v->x = x*mat[0][0] + y*mat[1][0] + z*mat[2][0] + mat[3][0];
+  v->y = x*mat[0][1] + y*mat[1][1] + z*mat[2][1] + mat[3][1];
+  v->z = x*mat[0][2] + y*mat[1][2] + z*mat[2][2] + mat[3][2];
+  v->w = x*mat[0][3] + y*mat[1][3] + z*mat[2][3] + mat[3][3];
+
+  if (fabs(v->w) < 0.001) v->w = 0.001f;
+  v->oow = 1.0f / v->w;
+  v->x_w = v->x * v->oow;
+  v->y_w = v->y * v->oow;
+  v->z_w = v->z * v->oow;
+
+  v->scr_off = 0;
+  if (v->x < -v->w) v->scr_off |= 1;
+  if (v->x > v->w) v->scr_off |= 2;
+  if (v->y < -v->w) v->scr_off |= 4;
+  if (v->y > v->w) v->scr_off |= 8;
+  if (v->w < 0.1f) v->scr_off |= 16;
+//    if (v->z_w > 1.0f) v->scr_off |= 32;
+}
+
+void TransformVerticesC(VERTEX *v, float (*pos)[4], int n, float mat[4][4])
+{
+  for (int i = 0; i < n; i++)
+    TransformVertex(&v[i], pos[i], mat);
+}
+
 void MulMatricesC(float m1[4][4],float m2[4][4],float r[4][4])
 {
     float row[4][4];
@@ -235,6 +285,7 @@ TRANSFORMVECTOR TransformVector = TransformVectorC;
 TRANSFORMVECTOR InverseTransformVector = InverseTransformVectorC;
 DOTPRODUCT DotProduct = DotProductC;
 NORMALIZEVECTOR NormalizeVector = NormalizeVectorC;
+TRANSFORMVERTICES TransformVertices = TransformVerticesC;
 
 void MulMatricesSSE(float m1[4][4],float m2[4][4],float r[4][4])
 {
@@ -381,6 +432,110 @@ void MulMatricesSSE(float m1[4][4],float m2[4][4],float r[4][4])
 #endif // _WIN32
   }
 
+#ifdef MATH_NEON
+// The NEON versions keep the C versions' order of operations, so on targets
+// where vmla is a separate multiply and add (AArch64) they give the same
+// results; only 1/w on 32-bit ARM, which lacks a vector divide, is refined
+// from an estimate instead.
+void MulMatricesNEON(float m1[4][4],float m2[4][4],float r[4][4])
+{
+  float32x4_t row0 = vld1q_f32(m2[0]);
+  float32x4_t row1 = vld1q_f32(m2[1]);
+  float32x4_t row2 = vld1q_f32(m2[2]);
+  float32x4_t row3 = vld1q_f32(m2[3]);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    float32x4_t leftrow = vld1q_f32(m1[i]);
+    float32x4_t destrow = vmulq_lane_f32(row0, vget_low_f32(leftrow), 0);
+    destrow = vmlaq_lane_f32(destrow, row1, vget_low_f32(leftrow), 1);
+    destrow = vmlaq_lane_f32(destrow, row2, vget_high_f32(leftrow), 0);
+    destrow = vmlaq_lane_f32(destrow, row3, vget_high_f32(leftrow), 1);
+    vst1q_f32(r[i], destrow);
+  }
+}
+
+void TransformVectorNEON(float *src, float *dst, float mat[4][4])
+{
+  float32x4_t res = vmulq_n_f32(vld1q_f32(mat[0]), src[0]);
+  res = vmlaq_n_f32(res, vld1q_f32(mat[1]), src[1]);
+  res = vmlaq_n_f32(res, vld1q_f32(mat[2]), src[2]);
+  vst1_f32(dst, vget_low_f32(res));
+  dst[2] = vgetq_lane_f32(res, 2);
+}
+
+void InverseTransformVectorNEON(float *src, float *dst, float mat[4][4])
+{
+  // deinterleaving load: col.val[j] holds mat[0..3][j]
+  float32x4x4_t col = vld4q_f32(mat[0]);
+  float32x4_t res = vmulq_n_f32(col.val[0], src[0]);
+  res = vmlaq_n_f32(res, col.val[1], src[1]);
+  res = vmlaq_n_f32(res, col.val[2], src[2]);
+  vst1_f32(dst, vget_low_f32(res));
+  dst[2] = vgetq_lane_f32(res, 2);
+}
+
+void TransformVerticesNEON(VERTEX *v, float (*pos)[4], int n, float mat[4][4])
+{
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    // four positions at once, one lane per vertex: p.val[0] holds the x's
+    float32x4x4_t p = vld4q_f32(pos[i]);
+    float32x4_t c[4];
+    for (int j = 0; j < 4; j++)
+    {
+      c[j] = vmulq_n_f32(p.val[0], mat[0][j]);
+      c[j] = vmlaq_n_f32(c[j], p.val[1], mat[1][j]);
+      c[j] = vmlaq_n_f32(c[j], p.val[2], mat[2][j]);
+      c[j] = vaddq_f32(c[j], vdupq_n_f32(mat[3][j]));
+    }
+    float32x4_t w = c[3];
+    w = vbslq_f32(vcltq_f32(vabsq_f32(w), vdupq_n_f32(0.001f)), vdupq_n_f32(0.001f), w);
+#ifdef __aarch64__
+    float32x4_t oow = vdivq_f32(vdupq_n_f32(1.0f), w);
+#else
+    float32x4_t oow = vrecpeq_f32(w);
+    oow = vmulq_f32(vrecpsq_f32(w, oow), oow);
+    oow = vmulq_f32(vrecpsq_f32(w, oow), oow);
+#endif
+    float32x4_t neg_w = vnegq_f32(w);
+    uint32x4_t off = vandq_u32(vcltq_f32(c[0], neg_w), vdupq_n_u32(1));
+    off = vorrq_u32(off, vandq_u32(vcgtq_f32(c[0], w), vdupq_n_u32(2)));
+    off = vorrq_u32(off, vandq_u32(vcltq_f32(c[1], neg_w), vdupq_n_u32(4)));
+    off = vorrq_u32(off, vandq_u32(vcgtq_f32(c[1], w), vdupq_n_u32(8)));
+    off = vorrq_u32(off, vandq_u32(vcltq_f32(w, vdupq_n_f32(0.1f)), vdupq_n_u32(16)));
+
+    DECLAREALIGN16VAR(out[8][4]);
+    wxUint32 scr_off[4];
+    vst1q_f32(out[0], c[0]);
+    vst1q_f32(out[1], c[1]);
+    vst1q_f32(out[2], c[2]);
+    vst1q_f32(out[3], w);
+    vst1q_f32(out[4], oow);
+    vst1q_f32(out[5], vmulq_f32(c[0], oow));
+    vst1q_f32(out[6], vmulq_f32(c[1], oow));
+    vst1q_f32(out[7], vmulq_f32(c[2], oow));
+    vst1q_u32(scr_off, off);
+    for (int j = 0; j < 4; j++)
+    {
+      VERTEX *vj = &v[i + j];
+      vj->x = out[0][j];
+      vj->y = out[1][j];
+      vj->z = out[2][j];
+      vj->w = out[3][j];
+      vj->oow = out[4][j];
+      vj->x_w = out[5][j];
+      vj->y_w = out[6][j];
+      vj->z_w = out[7][j];
+      vj->scr_off = scr_off[j];
+    }
+  }
+  for (; i < n; i++)
+    TransformVertex(&v[i], pos[i], mat);
+}
+#endif // MATH_NEON
+
 
 
   void math_init()
@@ -451,6 +606,13 @@ void MulMatricesSSE(float m1[4][4],float m2[4][4],float r[4][4])
         MulMatrices = MulMatricesSSE;
         LOG("3DNOW! detected.\n");
       }
+#ifdef MATH_NEON
+      MulMatrices = MulMatricesNEON;
+      TransformVector = TransformVectorNEON;
+      InverseTransformVector = InverseTransformVectorNEON;
+      TransformVertices = TransformVerticesNEON;
+      LOG("NEON detected.\n");
+#endif
 
 #endif //_DEBUG
     }
@@ -52,3 +52,8 @@ typedef float (*DOTPRODUCT)(float *v1, float *v2);
 extern DOTPRODUCT DotProduct;
 typedef void (*NORMALIZEVECTOR)(float *v);
 extern NORMALIZEVECTOR NormalizeVector;
+// Transforms n object space positions (x, y, z, unused) by mat into the clip
+// space fields of the n consecutive vertices starting at v: x, y, z, w, oow,
+// x_w, y_w, z_w and the scr_off clip codes.
+typedef void (*TRANSFORMVERTICES)(VERTEX *v, float (*pos)[4], int n, float mat[4][4]);
+extern TRANSFORMVERTICES TransformVertices;
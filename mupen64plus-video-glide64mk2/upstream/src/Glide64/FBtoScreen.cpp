@@ -47,10 +47,70 @@
 #include "FBtoScreen.h"
 #include "TexCache.h"
 
+// What DrawFrameBufferToScreen last downloaded at offset_fb_to_screen.
+// Games drawing with the CPU rewrite their frame buffer each frame, but
+// often only part of it, so rows that did not change are not sent again.
+static struct
+{
+  bool valid;
+  GrLOD_t lod;
+  GrAspectRatio_t aspect;
+  GrTextureFormat_t format;
+  wxUint32 width, height;
+} fb_tex;
+static wxUint32 fb_tex_copy[512*512];
+
+void ResetFrameBufferToScreen()
+{
+  fb_tex.valid = false;
+}
+
+static void DownloadFBtoScreenTexture(wxUint32 tex_adr, GrTexInfo & t_info, wxUint32 width, wxUint32 height, wxUint32 texwidth)
+{
+  const wxUint32 bpp = (t_info.format == GR_TEXFMT_ARGB_8888) ? 4 : 2;
+  const wxUint32 pitch = texwidth * bpp;
+  const wxUint32 row_size = width * bpp;
+  wxUint8 * rows = (wxUint8*)t_info.data;
+  wxUint8 * copy = (wxUint8*)fb_tex_copy;
+
+  if (fb_tex.valid && fb_tex.lod == t_info.largeLodLog2 && fb_tex.aspect == t_info.aspectRatioLog2 &&
+      fb_tex.format == t_info.format && fb_tex.width == width && fb_tex.height == height)
+  {
+    int first = -1, last = -1;
+    for (wxUint32 y = 0; y < height; y++)
+    {
+      if (memcmp(rows + y*pitch, copy + y*pitch, row_size))
+      {
+        if (first < 0)
+          first = y;
+        last = y;
+      }
+    }
+    if (first < 0)
+      return;
+    if (grTexDownloadMipMapLevelPartial(GR_TMU0, tex_adr, t_info.largeLodLog2, t_info.largeLodLog2,
+      t_info.aspectRatioLog2, t_info.format, GR_MIPMAPLEVELMASK_BOTH, rows + first*pitch, first, last))
+    {
+      memcpy(copy + first*pitch, rows + first*pitch, (last - first)*pitch + row_size);
+      return;
+    }
+  }
+
+  grTexDownloadMipMap (GR_TMU0, tex_adr, GR_MIPMAPLEVELMASK_BOTH, &t_info);
+  memcpy(copy, rows, (height - 1)*pitch + row_size);
+  fb_tex.valid = true;
+  fb_tex.lod = t_info.largeLodLog2;
+  fb_tex.aspect = t_info.aspectRatioLog2;
+  fb_tex.format = t_info.format;
+  fb_tex.width = width;
+  fb_tex.height = height;
+}
+
+// texture_size 0 is for textures outside the texture cache, always on TMU0
 static int SetupFBtoScreenCombiner(wxUint32 texture_size, wxUint32 opaque)
 {
   int tmu;
-  if (voodoo.tmem_ptr[GR_TMU0]+texture_size < voodoo.tex_max_addr[0])
+  if (texture_size == 0 || voodoo.tmem_ptr[GR_TMU0]+texture_size < voodoo.tex_max_addr[0])
   {
     tmu = GR_TMU0;
     grTexCombine( GR_TMU1,
@@ -394,15 +454,10 @@ bool DrawFrameBufferToScreen(FB_TO_SCREEN_INFO & fb_info)
     t_info.data = tex;
   }
 
-  int tmu = SetupFBtoScreenCombiner(grTexTextureMemRequired(GR_MIPMAPLEVELMASK_BOTH, &t_info), fb_info.opaque);
-  grTexDownloadMipMap (tmu,
-    voodoo.tex_min_addr[tmu]+voodoo.tmem_ptr[tmu],
-    GR_MIPMAPLEVELMASK_BOTH,
-    &t_info);
-  grTexSource (tmu,
-    voodoo.tex_min_addr[tmu]+voodoo.tmem_ptr[tmu],
-    GR_MIPMAPLEVELMASK_BOTH,
-    &t_info);
+  int tmu = SetupFBtoScreenCombiner(0, fb_info.opaque);
+  wxUint32 tex_adr = voodoo.tex_min_addr[GR_TMU0] + offset_fb_to_screen;
+  DownloadFBtoScreenTexture(tex_adr, t_info, width, height, texwidth);
+  grTexSource (tmu, tex_adr, GR_MIPMAPLEVELMASK_BOTH, &t_info);
   if (settings.hacks&hack_RE2)
   {
     DrawRE2Video(fb_info, scale);
@@ -58,6 +58,7 @@ typedef struct
 } FB_TO_SCREEN_INFO;
 
 bool DrawFrameBufferToScreen(FB_TO_SCREEN_INFO & fb_info);
+void ResetFrameBufferToScreen();
 void DrawDepthBufferToScreen(FB_TO_SCREEN_INFO & fb_info);
 
 #endif  // #ifndef FBtoSCREEN_H
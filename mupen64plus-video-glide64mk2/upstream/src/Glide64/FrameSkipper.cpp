@@ -21,11 +21,21 @@
 #include <SDL_timer.h>
 
 FrameSkipper::FrameSkipper()
-  : _skipType(AUTO), _maxSkips(2), _targetFPS(60),
+  : _skipType(AUTO), _maxSkips(2), _targetFPS(60), _speedFactor(100),
     _skipCounter(0), _initialTicks(0), _actualFrame(0)
 {
 }
 
+void FrameSkipper::setSpeedFactor(int percent)
+{
+  if (percent > 0 && percent != _speedFactor)
+  {
+    _speedFactor = percent;
+    // Start over so frames timed at the old speed are not held against the new one
+    _initialTicks = 0;
+  }
+}
+
 void FrameSkipper::update()
 {
   if (_maxSkips < 1)
@@ -42,7 +52,7 @@ void FrameSkipper::update()
   {
     // Compute the frame number we want be at, based on elapsed time and target FPS
     unsigned int elapsedMilliseconds = SDL_GetTicks() - _initialTicks;
-    unsigned int desiredFrame = (elapsedMilliseconds * _targetFPS) / 1000;
+    unsigned int desiredFrame = ((unsigned long long) elapsedMilliseconds * _targetFPS * _speedFactor) / 100000;
 
     // Record the frame number we are actually at
     _actualFrame++;
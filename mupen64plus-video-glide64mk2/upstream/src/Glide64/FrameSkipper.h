@@ -31,6 +31,9 @@ public:
 
   void setTargetFPS(int fps) { _targetFPS = fps; }
 
+  // Emulation speed in percent, the frame rate to keep up with scales with it
+  void setSpeedFactor(int percent);
+
   bool willSkipNext() { return (_skipCounter > 0); }
 
   void update();
@@ -39,6 +42,7 @@ private:
   int _skipType;
   int _maxSkips;
   int _targetFPS;
+  int _speedFactor;
   int _skipCounter;
   unsigned int _initialTicks;
   unsigned int _actualFrame;
@@ -59,6 +59,7 @@
   #define PATH_MAX 4096
 #endif
 #include "osal_dynamiclib.h"
+#include "m64p_frontend.h"
 #ifdef TEXTURE_FILTER // Hiroshi Morii <koolsmoky@users.sourceforge.net>
 #include <stdarg.h>
 int  ghq_dmptex_toggle_key = 0;
@@ -120,6 +121,7 @@ ptr_VidExt_ResizeWindow          CoreVideo_ResizeWindow = NULL;
 ptr_VidExt_GL_GetProcAddress     CoreVideo_GL_GetProcAddress = NULL;
 ptr_VidExt_GL_SetAttribute       CoreVideo_GL_SetAttribute = NULL;
 ptr_VidExt_GL_SwapBuffers        CoreVideo_GL_SwapBuffers = NULL;
+static ptr_CoreDoCommand CoreDoCommand = NULL;
 int to_fullscreen = FALSE;
 int fullscreen = FALSE;
 int romopen = FALSE;
@@ -183,6 +185,7 @@ GrTexInfo fontTex;
 GrTexInfo cursorTex;
 wxUint32   offset_font = 0;
 wxUint32   offset_cursor = 0;
+wxUint32   offset_fb_to_screen = 0;
 wxUint32   offset_textures = 0;
 wxUint32   offset_texbuf1 = 0;
 
@@ -1043,10 +1046,19 @@ void guLoadTextures ()
     GR_MIPMAPLEVELMASK_BOTH,
     &cursorTex);
 
-  // Round to higher 16
-  offset_textures = ((offset_cursor + grTexTextureMemRequired (GR_MIPMAPLEVELMASK_BOTH, &cursorTex))
+  offset_fb_to_screen = ((offset_cursor + grTexTextureMemRequired (GR_MIPMAPLEVELMASK_BOTH, &cursorTex))
     & 0xFFFFFFF0) + 16;
   free (cursorTex.data);
+
+  // ** Frame buffer to screen texture **
+  // Kept apart from the texture cache, so that DrawFrameBufferToScreen can
+  // update only what changed since the last frame
+  GrLOD_t fb_lod = voodoo.max_tex_size >= 512 ? GR_LOD_LOG2_512 : GR_LOD_LOG2_256;
+  ResetFrameBufferToScreen();
+
+  // Round to higher 16
+  offset_textures = ((offset_fb_to_screen + grTexCalcMemRequired (fb_lod, fb_lod, GR_ASPECT_LOG2_1x1, GR_TEXFMT_ARGB_8888))
+    & 0xFFFFFFF0) + 16;
 }
 
 #ifdef TEXTURE_FILTER
@@ -1577,6 +1589,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
         return M64ERR_INCOMPATIBLE;
     }
 
+    /* Only used to follow the emulation speed, so it is not required */
+    CoreDoCommand = (ptr_CoreDoCommand) osal_dynlib_getproc(CoreLibHandle, "CoreDoCommand");
+
     const char *configDir = ConfigGetSharedDataFilepath("Glide64mk2.ini");
     if (configDir)
     {
@@ -2090,6 +2105,11 @@ wxUint32 update_screen_count = 0;
 EXPORT void CALL UpdateScreen (void)
 {
 #ifdef USE_FRAMESKIPPER
+  // keep skipping in step with fast forward and audio driven pacing
+  int speedFactor = 100;
+  if (CoreDoCommand != NULL)
+    CoreDoCommand(M64CMD_CORE_STATE_QUERY, M64CORE_SPEED_FACTOR, &speedFactor);
+  frameSkipper.setSpeedFactor(speedFactor);
   frameSkipper.update();
 #endif
 #ifdef LOG_KEY
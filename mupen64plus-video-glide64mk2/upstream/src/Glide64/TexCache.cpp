@@ -50,6 +50,14 @@ wxUint8 tex2[1024*1024*4];
 wxUint8 *texture;
 wxUint8 *texture_buffer = tex1;
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TEX_NEON
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEX_SSE2
+#endif
+
 #include "TexLoad.h"	// texture loading functions, ONLY INCLUDE IN THIS FILE!!!
 #include "MiClWr32b.h"
 #include "MiClWr16b.h"	// Mirror/Clamp/Wrap functions, ONLY INCLUDE IN THIS FILE!!!
@@ -92,19 +100,37 @@ typedef struct HIRESTEX_t {
 
 typedef struct NODE_t {
   wxUint32	crc;
+  wxUint32	flags;
+  wxUint32	width, height;
   wxUIntPtr	data;
   int		tmu;
   int		number;
   NODE_t	*pNext;
 } NODE;
 
+// Buckets are keyed by crc and the tile parameters, nodes come from a pool
+// that can hold every cache entry of both tmus so adding one never allocates
 NODE *cachelut[65536];
+static NODE cachenodes[MAX_TMU*MAX_CACHE];
+static int n_cachenodes = 0;
+
+static inline wxUint32 CacheBucket (wxUint32 crc, wxUint32 width, wxUint32 height, wxUint32 flags)
+{
+  wxUint32 key = crc ^ (width * 0x9E3779B1) ^ (height * 0x85EBCA77) ^ flags;
+  return (key ^ (key >> 16)) & 0xFFFF;
+}
 
-void AddToList (NODE **list, wxUint32 crc, wxUIntPtr data, int tmu, int number)
+void AddToList (CACHE_LUT *cache, int tmu, int number)
 {
-  NODE *node = new NODE;
-  node->crc = crc;
-  node->data = data;
+  if (n_cachenodes >= MAX_TMU*MAX_CACHE)
+    return;
+  NODE *node = &cachenodes[n_cachenodes++];
+  NODE **list = &cachelut[CacheBucket(cache->crc, cache->width, cache->height, cache->flags)];
+  node->crc = cache->crc;
+  node->flags = cache->flags;
+  node->width = cache->width;
+  node->height = cache->height;
+  node->data = wxPtrToUInt(cache);
   node->tmu = tmu;
   node->number = number;
   node->pNext = *list;
@@ -114,22 +140,13 @@ void AddToList (NODE **list, wxUint32 crc, wxUIntPtr data, int tmu, int number)
     rdp.n_cached[tmu^1] = rdp.n_cached[tmu];
 }
 
-void DeleteList (NODE **list)
-{
-  while (*list)
-  {
-    NODE *next = (*list)->pNext;
-    delete (*list);
-    *list = next;
-  }
-}
-
 void TexCacheInit ()
 {
   for (int i=0; i<65536; i++)
   {
     cachelut[i] = NULL;
   }
+  n_cachenodes = 0;
 }
 
 //****************************************************************
@@ -142,12 +159,29 @@ void ClearCache ()
   voodoo.tmem_ptr[1] = voodoo.tex_UMA ? offset_textures : offset_texbuf1;
   rdp.n_cached[1] = 0;
 
-  for (int i=0; i<65536; i++)
+  // Only the buckets that were used need to be emptied
+  for (int i=0; i<n_cachenodes; i++)
   {
-    DeleteList (&cachelut[i]);
+    NODE *node = &cachenodes[i];
+    cachelut[CacheBucket(node->crc, node->width, node->height, node->flags)] = NULL;
   }
+  n_cachenodes = 0;
 }
 
+//****************************************************************
+// Last tmem CRC of each texture. The CRC only depends on tmem contents and
+// the tile parameters below, so it is reused until the next load into tmem.
+
+typedef struct TMEM_CRC_t {
+  int valid;
+  wxUint32 stamp;
+  int fast_crc;
+  int t_mem, line, size, wid_64, bpl, crc_height;
+  wxUint32 crc;
+} TMEM_CRC;
+
+static TMEM_CRC tmem_crc[2];
+
 //****************************************************************
 uint32_t textureCRC(uint8_t *addr, int width, int height, int line)
 {
@@ -355,53 +389,81 @@ void GetTexInfo (int id, int tile)
   if (rdp.tiles[tile].size == 3)
     line <<= 1;
   wxUint32 crc = 0;
-  if (settings.fast_crc)
+  TMEM_CRC *last = &tmem_crc[id];
+  if (last->valid && last->stamp == rdp.tmem_stamp &&
+      last->fast_crc == settings.fast_crc &&
+      last->t_mem == rdp.tiles[tile].t_mem &&
+      last->line == line &&
+      last->size == rdp.tiles[tile].size &&
+      last->wid_64 == wid_64 &&
+      last->bpl == bpl &&
+      last->crc_height == crc_height)
   {
+    crc = last->crc;
     line = (line - wid_64) << 3;
     if (wid_64 < 1) wid_64 = 1;
-    uint8_t * addr = (((uint8_t*)rdp.tmem) + (rdp.tiles[tile].t_mem<<3));
-    if (crc_height > 0) // Check the CRC
-    {
-      if (rdp.tiles[tile].size < 3)
-        crc = textureCRC(addr, wid_64, crc_height, line);
-      else //32b texture
-      {
-        int line_2 = line >> 1;
-        int wid_64_2 = max(1, wid_64 >> 1);
-        crc = textureCRC(addr, wid_64_2, crc_height, line_2);
-        crc += textureCRC(addr+0x800, wid_64_2, crc_height, line_2);
-      }
-    }
+    LRDP("tmem unchanged, ");
   }
   else
   {
-    crc = 0xFFFFFFFF;
-    wxUIntPtr addr = wxPtrToUInt(rdp.tmem) + (rdp.tiles[tile].t_mem<<3);
-    wxUint32 line2 = max(line,1);
-    if (rdp.tiles[tile].size < 3)
+    last->valid = TRUE;
+    last->stamp = rdp.tmem_stamp;
+    last->fast_crc = settings.fast_crc;
+    last->t_mem = rdp.tiles[tile].t_mem;
+    last->line = line;
+    last->size = rdp.tiles[tile].size;
+    last->wid_64 = wid_64;
+    last->bpl = bpl;
+    last->crc_height = crc_height;
+    if (settings.fast_crc)
     {
-      line2 <<= 3;
-      for (int y = 0; y < crc_height; y++)
+      line = (line - wid_64) << 3;
+      if (wid_64 < 1) wid_64 = 1;
+      uint8_t * addr = (((uint8_t*)rdp.tmem) + (rdp.tiles[tile].t_mem<<3));
+      if (crc_height > 0) // Check the CRC
       {
-        crc = CRC32( crc, reinterpret_cast<void*>(addr), bpl );
-        addr += line2;
+        if (rdp.tiles[tile].size < 3)
+          crc = textureCRC(addr, wid_64, crc_height, line);
+        else //32b texture
+        {
+          int line_2 = line >> 1;
+          int wid_64_2 = max(1, wid_64 >> 1);
+          crc = textureCRC(addr, wid_64_2, crc_height, line_2);
+          crc += textureCRC(addr+0x800, wid_64_2, crc_height, line_2);
+        }
       }
     }
-    else //32b texture
+    else
     {
-      line2 <<= 2;
-      //32b texel is split in two 16b parts, so bpl/2 and line/2.
-      //Min value for bpl is 4, because when width==1 first 2 bytes of tmem will not be used.
-      bpl = max(bpl >> 1, 4);
-      for (int y = 0; y < crc_height; y++)
+      crc = 0xFFFFFFFF;
+      wxUIntPtr addr = wxPtrToUInt(rdp.tmem) + (rdp.tiles[tile].t_mem<<3);
+      wxUint32 line2 = max(line,1);
+      if (rdp.tiles[tile].size < 3)
+      {
+        line2 <<= 3;
+        for (int y = 0; y < crc_height; y++)
+        {
+          crc = CRC32( crc, reinterpret_cast<void*>(addr), bpl );
+          addr += line2;
+        }
+      }
+      else //32b texture
       {
-        crc = CRC32( crc, reinterpret_cast<void*>(addr), bpl);
-        crc = CRC32( crc, reinterpret_cast<void*>(addr + 0x800), bpl);
-        addr += line2;
+        line2 <<= 2;
+        //32b texel is split in two 16b parts, so bpl/2 and line/2.
+        //Min value for bpl is 4, because when width==1 first 2 bytes of tmem will not be used.
+        bpl = max(bpl >> 1, 4);
+        for (int y = 0; y < crc_height; y++)
+        {
+          crc = CRC32( crc, reinterpret_cast<void*>(addr), bpl);
+          crc = CRC32( crc, reinterpret_cast<void*>(addr + 0x800), bpl);
+          addr += line2;
+        }
       }
+      line = (line - wid_64) << 3;
+      if (wid_64 < 1) wid_64 = 1;
     }
-    line = (line - wid_64) << 3;
-    if (wid_64 < 1) wid_64 = 1;
+    last->crc = crc;
   }
   if ((rdp.tiles[tile].size < 2) && (rdp.tlut_mode || rdp.tiles[tile].format == 2))
   {
@@ -456,34 +518,32 @@ void GetTexInfo (int id, int tile)
     modfactor = cmb.modfactor_1;
   }
 
-  NODE *node = cachelut[crc>>16];
+  NODE *node = cachelut[CacheBucket(crc, rdp.tiles[tile].width, rdp.tiles[tile].height, flags)];
   wxUint32 mod_mask = (rdp.tiles[tile].format == 2)?0xFFFFFFFF:0xF0F0F0F0;
   while (node)
   {
-    if (node->crc == crc)
+    if (node->crc == crc &&
+        /*tex_found[id][node->tmu] == -1 &&
+        rdp.tiles[tile].palette == cache->palette &&
+        rdp.tiles[tile].format == cache->format &&
+        rdp.tiles[tile].size == cache->size &&*/
+        rdp.tiles[tile].width == node->width &&
+        rdp.tiles[tile].height == node->height &&
+        flags == node->flags)
     {
       cache = (CACHE_LUT*)node->data;
-      if (/*tex_found[id][node->tmu] == -1 &&
-          rdp.tiles[tile].palette == cache->palette &&
-          rdp.tiles[tile].format == cache->format &&
-          rdp.tiles[tile].size == cache->size &&*/
-          rdp.tiles[tile].width == cache->width &&
-          rdp.tiles[tile].height == cache->height &&
-          flags == cache->flags)
+      if (!(mod+cache->mod) || (cache->mod == mod &&
+        (cache->mod_color&mod_mask) == (modcolor&mod_mask) &&
+        (cache->mod_color1&mod_mask) == (modcolor1&mod_mask) &&
+        (cache->mod_color2&mod_mask) == (modcolor2&mod_mask) &&
+        abs((int)(cache->mod_factor - modfactor)) < 8))
       {
-        if (!(mod+cache->mod) || (cache->mod == mod &&
-          (cache->mod_color&mod_mask) == (modcolor&mod_mask) &&
-          (cache->mod_color1&mod_mask) == (modcolor1&mod_mask) &&
-          (cache->mod_color2&mod_mask) == (modcolor2&mod_mask) &&
-          abs((int)(cache->mod_factor - modfactor)) < 8))
+        FRDP (" | | | |- Texture found in cache (tmu=%d).\n", node->tmu);
+        tex_found[id][node->tmu] = node->number;
+        if (voodoo.tex_UMA)
         {
-          FRDP (" | | | |- Texture found in cache (tmu=%d).\n", node->tmu);
-          tex_found[id][node->tmu] = node->number;
-          if (voodoo.tex_UMA)
-          {
-            tex_found[id][node->tmu^1] = node->number;
-            return;
-          }
+          tex_found[id][node->tmu^1] = node->number;
+          return;
         }
       }
     }
@@ -1061,7 +1121,7 @@ void LoadTex (int id, int tmu)
 #endif
 
   // Add this cache to the list
-  AddToList (&cachelut[cache->crc>>16], cache->crc, wxPtrToUInt(cache), tmu, rdp.n_cached[tmu]);
+  AddToList (cache, tmu, rdp.n_cached[tmu]);
 
   // temporary
   cache->t_info.format = GR_TEXFMT_ARGB_1555;
@@ -37,6 +37,37 @@
 //
 //****************************************************************
 
+//****************************************************************
+// Row helpers shared by the loaders. A row is wid_64 qwords of tmem, odd rows
+// have the two dwords of every qword swapped which is what swap undoes.
+
+static inline void loadRowCopy(const uint32_t *src, uint32_t *dst, int wid_64, int swap)
+{
+  int i = 0;
+#if defined(TEX_NEON)
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    uint32x4_t v = vld1q_u32(src + (i << 1));
+    if (swap)
+      v = vrev64q_u32(v);
+    vst1q_u32(dst + (i << 1), v);
+  }
+#elif defined(TEX_SSE2)
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + (i << 1)));
+    if (swap)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128((__m128i *)(dst + (i << 1)), v);
+  }
+#endif
+  for (; i < wid_64; i++)
+  {
+    dst[(i << 1)] = src[(i << 1) + swap];
+    dst[(i << 1) + 1] = src[(i << 1) + (swap ^ 1)];
+  }
+}
+
 #include "TexLoad4b.h"
 #include "TexLoad8b.h"
 #include "TexLoad16b.h"
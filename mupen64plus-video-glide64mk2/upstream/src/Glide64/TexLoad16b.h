@@ -37,128 +37,67 @@
 //
 //****************************************************************
 
-static inline void load16bRGBA(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+// Byte swaps both texels of a dword and rotates RGBA5551 into ARGB1555
+static inline uint32_t rgba16Dword(uint32_t v)
+{
+  v = ((v << 8) & 0xFF00FF00) | ((v >> 8) & 0x00FF00FF);
+  return ((v >> 1) & 0x7FFF7FFF) | ((v << 15) & 0x80008000);
+}
+
+static inline void load16bRGBARow(const uint32_t *src, uint32_t *dst, int wid_64, int swap)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  uint32_t v10;
-  uint32_t v11;
-  uint32_t *v12;
-  uint32_t *v13;
-  int v14;
-  uint32_t v15;
-  uint32_t v16;
-  int v17;
-  int v18;
+  int i = 0;
+#if defined(TEX_NEON)
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    uint32x4_t v = vld1q_u32(src + (i << 1));
+    if (swap)
+      v = vrev64q_u32(v);
+    uint16x8_t t = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u32(v)));
+    t = vorrq_u16(vshrq_n_u16(t, 1), vshlq_n_u16(t, 15));
+    vst1q_u32(dst + (i << 1), vreinterpretq_u32_u16(t));
+  }
+#elif defined(TEX_SSE2)
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + (i << 1)));
+    if (swap)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_or_si128(_mm_srli_epi16(v, 1), _mm_slli_epi16(v, 15));
+    _mm_storeu_si128((__m128i *)(dst + (i << 1)), v);
+  }
+#endif
+  for (; i < wid_64; i++)
+  {
+    dst[(i << 1)] = rgba16Dword(src[(i << 1) + swap]);
+    dst[(i << 1) + 1] = rgba16Dword(src[(i << 1) + (swap ^ 1)]);
+  }
+}
 
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+static inline void load16bRGBA(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+{
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
   {
-    v17 = v8;
-    v9 = wid_64;
-    do
-    {
-      v10 = bswap32(*v6);
-      v11 = bswap32(v6[1]);
-      ALOWORD(v10) = __ROR__((uint16_t)v10, 1);
-      ALOWORD(v11) = __ROR__((uint16_t)v11, 1);
-      v10 = __ROR__(v10, 16);
-      v11 = __ROR__(v11, 16);
-      ALOWORD(v10) = __ROR__((uint16_t)v10, 1);
-      ALOWORD(v11) = __ROR__((uint16_t)v11, 1);
-      *v7 = v10;
-      v7[1] = v11;
-      v6 += 2;
-      v7 += 2;
-      --v9;
-    }
-    while ( v9 );
-    if ( v17 == 1 )
-      break;
-    v18 = v17 - 1;
-    v12 = (uint32_t *)&src[(line + (uintptr_t)v6 - (uintptr_t)src) & 0xFFF];
-    v13 = (uint32_t *)((char *)v7 + ext);
-    v14 = wid_64;
-    do
-    {
-      v15 = bswap32(v12[1]);
-      v16 = bswap32(*v12);
-      ALOWORD(v15) = __ROR__((uint16_t)v15, 1);
-      ALOWORD(v16) = __ROR__((uint16_t)v16, 1);
-      v15 = __ROR__(v15, 16);
-      v16 = __ROR__(v16, 16);
-      ALOWORD(v15) = __ROR__((uint16_t)v15, 1);
-      ALOWORD(v16) = __ROR__((uint16_t)v16, 1);
-      *v13 = v15;
-      v13[1] = v16;
-      v12 += 2;
-      v13 += 2;
-      --v14;
-    }
-    while ( v14 );
-    v6 = (uint32_t *)&src[(line + (uintptr_t)v12 - (uintptr_t)src) & 0xFFF];
-    v7 = (uint32_t *)((char *)v13 + ext);
-    v8 = v18 - 1;
+    load16bRGBARow(s, d, wid_64, y & 1);
+    // rows wrap around the 4k of tmem
+    s = (uint32_t *)&src[(line + ((uint8_t *)(s + (wid_64 << 1)) - src)) & 0xFFF];
+    d = (uint32_t *)((char *)(d + (wid_64 << 1)) + ext);
   }
-  while ( v18 != 1 );
 }
 
 static inline void load16bIA(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  uint32_t v10;
-  uint32_t *v11;
-  uint32_t *v12;
-  int v13;
-  uint32_t v14;
-  int v15;
-  int v16;
-
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
   {
-    v15 = v8;
-    v9 = wid_64;
-    do
-    {
-      v10 = v6[1];
-      *v7 = *v6;
-      v7[1] = v10;
-      v6 += 2;
-      v7 += 2;
-      --v9;
-    }
-    while ( v9 );
-    if ( v15 == 1 )
-      break;
-    v16 = v15 - 1;
-    v11 = (uint32_t *)((char *)v6 + line);
-    v12 = (uint32_t *)((char *)v7 + ext);
-    v13 = wid_64;
-    do
-    {
-      v14 = *v11;
-      *v12 = v11[1];
-      v12[1] = v14;
-      v11 += 2;
-      v12 += 2;
-      --v13;
-    }
-    while ( v13 );
-    v6 = (uint32_t *)((char *)v11 + line);
-    v7 = (uint32_t *)((char *)v12 + ext);
-    v8 = v16 - 1;
+    loadRowCopy(s, d, wid_64, y & 1);
+    s = (uint32_t *)((char *)(s + (wid_64 << 1)) + line);
+    d = (uint32_t *)((char *)(d + (wid_64 << 1)) + ext);
   }
-  while ( v16 != 1 );
 }
 
 
@@ -78,7 +78,39 @@ wxUint32 Load32bRGBA (wxUIntPtr dst, wxUIntPtr src, int wid_64, int height, int
     tex = (wxUint32 *)dst;
     wxUint16 *tex16 = (wxUint16*)dst;
     wxUint16 a, r, g, b;
-    for (wxUint32 i = 0; i < tex_size; i++) {
+    wxUint32 i = 0;
+    // Converted in place, every step loads its 8 texels before storing them
+    // and the 16 bit output never catches up with the 32 bit input
+#if defined(TEX_NEON)
+    for (; i + 8 <= tex_size; i += 8) {
+      uint32x4_t c0 = vshrq_n_u32(vld1q_u32(tex + i), 4);
+      uint32x4_t c1 = vshrq_n_u32(vld1q_u32(tex + i + 4), 4);
+      c0 = vandq_u32(c0, vdupq_n_u32(0x0F0F0F0F));
+      c1 = vandq_u32(c1, vdupq_n_u32(0x0F0F0F0F));
+      c0 = vorrq_u32(c0, vshrq_n_u32(c0, 4));
+      c1 = vorrq_u32(c1, vshrq_n_u32(c1, 4));
+      c0 = vorrq_u32(vandq_u32(c0, vdupq_n_u32(0xFF)), vandq_u32(vshrq_n_u32(c0, 8), vdupq_n_u32(0xFF00)));
+      c1 = vorrq_u32(vandq_u32(c1, vdupq_n_u32(0xFF)), vandq_u32(vshrq_n_u32(c1, 8), vdupq_n_u32(0xFF00)));
+      vst1q_u16(tex16 + i, vcombine_u16(vmovn_u32(c0), vmovn_u32(c1)));
+    }
+#elif defined(TEX_SSE2)
+    const __m128i nib = _mm_set1_epi32(0x0F0F0F0F);
+    const __m128i lo = _mm_set1_epi32(0xFF);
+    const __m128i hi = _mm_set1_epi32(0xFF00);
+    for (; i + 8 <= tex_size; i += 8) {
+      __m128i c0 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *)(tex + i)), 4), nib);
+      __m128i c1 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *)(tex + i + 4)), 4), nib);
+      c0 = _mm_or_si128(c0, _mm_srli_epi32(c0, 4));
+      c1 = _mm_or_si128(c1, _mm_srli_epi32(c1, 4));
+      c0 = _mm_or_si128(_mm_and_si128(c0, lo), _mm_and_si128(_mm_srli_epi32(c0, 8), hi));
+      c1 = _mm_or_si128(_mm_and_si128(c1, lo), _mm_and_si128(_mm_srli_epi32(c1, 8), hi));
+      // sign extend so the saturating pack keeps all 16 bits
+      c0 = _mm_srai_epi32(_mm_slli_epi32(c0, 16), 16);
+      c1 = _mm_srai_epi32(_mm_slli_epi32(c1, 16), 16);
+      _mm_storeu_si128((__m128i *)(tex16 + i), _mm_packs_epi32(c0, c1));
+    }
+#endif
+    for (; i < tex_size; i++) {
       c = tex[i];
       a = (c >> 28) & 0xF;
       r = (c >> 20) & 0xF;
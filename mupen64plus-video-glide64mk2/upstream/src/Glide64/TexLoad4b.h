@@ -323,270 +323,108 @@ static inline void load4bIAPal(uint8_t *src, uint8_t *dst, int wid_64, int heigh
   while ( v26 != 1 );
 }
 
-static inline void load4bIA(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+// Expands one dword of 4 bit texels into two dwords with one texel per byte,
+// the high nibble of every byte is the first texel
+static inline void spread4bDword(uint32_t v, uint32_t *dst)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  int v10;
-  uint32_t v11;
-  uint32_t *v12;
-  uint32_t v13;
-  uint32_t v14;
-  uint32_t v15;
-  uint32_t *v16;
-  uint32_t v17;
-  uint32_t v18;
-  uint32_t v19;
-  uint32_t v20;
-  uint32_t v21;
-  uint32_t v22;
-  uint32_t v23;
-  uint32_t v24;
-  uint32_t v25;
-  uint32_t v26;
-  uint32_t v27;
-  uint32_t v28;
-  uint32_t v29;
-  uint32_t v30;
-  uint32_t v31;
-  uint32_t v32;
-  uint32_t *v33;
-  uint32_t *v34;
-  int v35;
-  int v36;
-  uint32_t v37;
-  uint32_t v38;
-  uint32_t v39;
-  uint32_t *v40;
-  uint32_t v41;
-  uint32_t v42;
-  uint32_t v43;
-  uint32_t v44;
-  uint32_t v45;
-  uint32_t v46;
-  uint32_t v47;
-  uint32_t v48;
-  uint32_t v49;
-  uint32_t v50;
-  uint32_t v51;
-  uint32_t v52;
-  uint32_t v53;
-  uint32_t v54;
-  uint32_t v55;
-  uint32_t v56;
-  int v57;
-  int v58;
+  uint32_t hi = (v >> 4) & 0x0F0F0F0F;
+  uint32_t lo = v & 0x0F0F0F0F;
+  dst[0] = (hi & 0xFF) | ((lo & 0xFF) << 8) | ((hi & 0xFF00) << 8) | ((lo & 0xFF00) << 16);
+  dst[1] = ((hi >> 16) & 0xFF) | ((lo >> 8) & 0xFF00) | ((hi >> 8) & 0xFF0000) | (lo & 0xFF000000);
+}
 
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+// I4 -> I8 replicates the nibble, IA31 -> AI44 widens the alpha bit to a
+// nibble and the 3 bit intensity to 4 bits
+static inline uint32_t i4Texels(uint32_t t)
+{
+  return t | (t << 4);
+}
+
+static inline uint32_t ia31Texels(uint32_t t)
+{
+  return ((t & 0x01010101) * 0xF0) | (t & 0x0E0E0E0E) | ((t >> 3) & 0x01010101);
+}
+
+static inline void load4bRow(const uint32_t *src, uint32_t *dst, int wid_64, int swap, int ia)
+{
+  int i = 0;
+#if defined(TEX_NEON)
+  const uint8x16_t nib = vdupq_n_u8(0x0F);
+  const uint8x16_t one = vdupq_n_u8(0x01);
+  for (; i + 2 <= wid_64; i += 2)
   {
-    v57 = v8;
-    v9 = wid_64;
-    do
+    uint32x4_t v = vld1q_u32(src + (i << 1));
+    if (swap)
+      v = vrev64q_u32(v);
+    uint8x16_t b = vreinterpretq_u8_u32(v);
+    uint8x16x2_t t = vzipq_u8(vshrq_n_u8(b, 4), vandq_u8(b, nib));
+    for (int k = 0; k < 2; k++)
     {
-      v10 = v9;
-      v11 = bswap32(*v6);
-      v12 = v6 + 1;
-      v13 = v11;
-      v14 = (8 * (v11 & 0x100000)) | (4 * (v11 & 0x100000)) | (2 * (v11 & 0x100000)) | (v11 & 0x100000) | ((((v11 >> 16) & 0xE00) >> 3) & 0x100) | ((v11 >> 16) & 0xE00) | (8 * ((v11 >> 12) & 0x1000)) | (4 * ((v11 >> 12) & 0x1000)) | (2 * ((v11 >> 12) & 0x1000)) | ((v11 >> 12) & 0x1000) | ((((v11 >> 28) & 0xE) >> 3)) | ((v11 >> 28) & 0xE) | (8 * ((v11 >> 24) & 0x10)) | (4 * ((v11 >> 24) & 0x10)) | (2 * ((v11 >> 24) & 0x10)) | ((v11 >> 24) & 0x10);
-      v11 >>= 4;
-      v11 &= 0xE0000u;
-      v15 = v11 | v14;
-      v11 >>= 3;
-      *v7 = ((((v13 << 8) & 0xE000000) >> 3) & 0x1000000) | ((v13 << 8) & 0xE000000) | (8 * ((v13 << 12) & 0x10000000)) | (4 * ((v13 << 12) & 0x10000000)) | (2 * ((v13 << 12) & 0x10000000)) | ((v13 << 12) & 0x10000000) | (v11 & 0x10000) | v15;
-      v16 = v7 + 1;
-      v17 = 16 * (uint16_t)v13 & 0x1000;
-      v18 = (((v13 & 0xE00) >> 3) & 0x100) | (v13 & 0xE00) | (8 * v17) | (4 * v17) | (2 * v17) | (v17) | ((((v13 >> 12) & 0xE) >> 3)) | ((v13 >> 12) & 0xE) | (8 * ((v13 >> 8) & 0x10)) | (4 * ((v13 >> 8) & 0x10)) | (2 * ((v13 >> 8) & 0x10)) | ((v13 >> 8) & 0x10);
-      v19 = v13 << 16;
-      v20 = (8 * (v19 & 0x100000)) | (4 * (v19 & 0x100000)) | (2 * (v19 & 0x100000)) | (v19 & 0x100000) | v18;
-      v21 = v13 << 12;
-      v21 &= 0xE0000u;
-      v22 = v21 | v20;
-      v21 >>= 3;
-      *v16 = ((((v13 << 24) & 0xE000000) >> 3) & 0x1000000) | ((v13 << 24) & 0xE000000) | (8 * ((v13 << 28) & 0x10000000)) | (4 * ((v13 << 28) & 0x10000000)) | (2 * ((v13 << 28) & 0x10000000)) | ((v13 << 28) & 0x10000000) | (v21 & 0x10000) | v22;
-      ++v16;
-      v23 = bswap32(*v12);
-      v6 = v12 + 1;
-      v24 = v23;
-      v25 = (8 * (v23 & 0x100000)) | (4 * (v23 & 0x100000)) | (2 * (v23 & 0x100000)) | (v23 & 0x100000) | ((((v23 >> 16) & 0xE00) >> 3) & 0x100) | ((v23 >> 16) & 0xE00) | (8 * ((v23 >> 12) & 0x1000)) | (4 * ((v23 >> 12) & 0x1000)) | (2 * ((v23 >> 12) & 0x1000)) | ((v23 >> 12) & 0x1000) | (((v23 >> 28) & 0xE) >> 3) | ((v23 >> 28) & 0xE) | (8 * ((v23 >> 24) & 0x10)) | (4 * ((v23 >> 24) & 0x10)) | (2 * ((v23 >> 24) & 0x10)) | ((v23 >> 24) & 0x10);
-      v23 >>= 4;
-      v23 &= 0xE0000u;
-      v26 = v23 | v25;
-      v23 >>= 3;
-      *v16 = ((((v24 << 8) & 0xE000000) >> 3) & 0x1000000) | ((v24 << 8) & 0xE000000) | (8 * ((v24 << 12) & 0x10000000)) | (4 * ((v24 << 12) & 0x10000000)) | (2 * ((v24 << 12) & 0x10000000)) | ((v24 << 12) & 0x10000000) | (v23 & 0x10000) | (v26);
-      ++v16;
-      v27 = 16 * (uint16_t)v24 & 0x1000;
-      v28 = (((v24 & 0xE00) >> 3) & 0x100) | (v24 & 0xE00) | (8 * v27) | (4 * v27) | (2 * v27) | (v27) | ((((v24 >> 12) & 0xE) >> 3)) | ((v24 >> 12) & 0xE) | (8 * ((v24 >> 8) & 0x10)) | (4 * ((v24 >> 8) & 0x10)) | (2 * ((v24 >> 8) & 0x10)) | ((v24 >> 8) & 0x10);
-      v29 = v24 << 16;
-      v30 = (8 * (v29 & 0x100000)) | (4 * (v29 & 0x100000)) | (2 * (v29 & 0x100000)) | (v29 & 0x100000) | v28;
-      v31 = v24 << 12;
-      v31 &= 0xE0000u;
-      v32 = v31 | v30;
-      v31 >>= 3;
-      *v16 = ((((v24 << 24) & 0xE000000) >> 3) & 0x1000000) | ((v24 << 24) & 0xE000000) | (8 * ((v24 << 28) & 0x10000000)) | (4 * ((v24 << 28) & 0x10000000)) | (2 * ((v24 << 28) & 0x10000000)) | ((v24 << 28) & 0x10000000) | (v31 & 0x10000) | v32;
-      v7 = v16 + 1;
-      v9 = v10 - 1;
+      if (ia)
+        t.val[k] = vorrq_u8(vandq_u8(vtstq_u8(t.val[k], one), vdupq_n_u8(0xF0)),
+          vorrq_u8(vandq_u8(t.val[k], vdupq_n_u8(0x0E)), vshrq_n_u8(t.val[k], 3)));
+      else
+        t.val[k] = vorrq_u8(t.val[k], vshlq_n_u8(t.val[k], 4));
     }
-    while ( v10 != 1 );
-    if ( v57 == 1 )
-      break;
-    v58 = v57 - 1;
-    v33 = (uint32_t *)((char *)v6 + line);
-    v34 = (uint32_t *)((char *)v7 + ext);
-    v35 = wid_64;
-    do
+    vst1q_u8((uint8_t *)(dst + (i << 2)), t.val[0]);
+    vst1q_u8((uint8_t *)(dst + (i << 2) + 4), t.val[1]);
+  }
+#elif defined(TEX_SSE2)
+  const __m128i nib = _mm_set1_epi8(0x0F);
+  const __m128i one = _mm_set1_epi8(0x01);
+  const __m128i alpha = _mm_set1_epi8((char)0xF0);
+  const __m128i inten = _mm_set1_epi8(0x0E);
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + (i << 1)));
+    if (swap)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nib);
+    __m128i lo = _mm_and_si128(v, nib);
+    __m128i t[2] = { _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo) };
+    for (int k = 0; k < 2; k++)
     {
-      v36 = v35;
-      v37 = bswap32(v33[1]);
-      v38 = v37 >> 4;
-      v38 &= 0xE0000u;
-      v39 = v38 | (8 * (v37 & 0x100000)) | (4 * (v37 & 0x100000)) | (2 * (v37 & 0x100000)) | (v37 & 0x100000) | ((((v37 >> 16) & 0xE00) >> 3) & 0x100) | ((v37 >> 16) & 0xE00) | (8 * ((v37 >> 12) & 0x1000)) | (4 * ((v37 >> 12) & 0x1000)) | (2 * ((v37 >> 12) & 0x1000)) | ((v37 >> 12) & 0x1000) | (((v37 >> 28) & 0xE) >> 3) | ((v37 >> 28) & 0xE) | (8 * ((v37 >> 24) & 0x10)) | (4 * ((v37 >> 24) & 0x10)) | (2 * ((v37 >> 24) & 0x10)) | ((v37 >> 24) & 0x10);
-      v38 >>= 3;
-      *v34 = ((((v37 << 8) & 0xE000000) >> 3) & 0x1000000) | ((v37 << 8) & 0xE000000) | (8 * ((v37 << 12) & 0x10000000)) | (4 * ((v37 << 12) & 0x10000000)) | (2 * ((v37 << 12) & 0x10000000)) | ((v37 << 12) & 0x10000000) | (v38 & 0x10000) | v39;
-      v40 = v34 + 1;
-      v41 = 16 * (uint16_t)v37 & 0x1000;
-      v42 = (((v37 & 0xE00) >> 3) & 0x100) | (v37 & 0xE00) | (8 * v41) | (4 * v41) | (2 * v41) | v41 | (((v37 >> 12) & 0xE) >> 3) | ((v37 >> 12) & 0xE) | (8 * ((v37 >> 8) & 0x10)) | (4 * ((v37 >> 8) & 0x10)) | (2 * ((v37 >> 8) & 0x10)) | ((v37 >> 8) & 0x10);
-      v43 = v37 << 16;
-      v44 = (8 * (v43 & 0x100000)) | (4 * (v43 & 0x100000)) | (2 * (v43 & 0x100000)) | (v43 & 0x100000) | v42;
-      v45 = v37 << 12;
-      v45 &= 0xE0000u;
-      v46 = v45 | v44;
-      v45 >>= 3;
-      *v40 = ((((v37 << 24) & 0xE000000) >> 3) & 0x1000000) | ((v37 << 24) & 0xE000000) | (8 * ((v37 << 28) & 0x10000000)) | (4 * ((v37 << 28) & 0x10000000)) | (2 * ((v37 << 28) & 0x10000000)) | ((v37 << 28) & 0x10000000) | (v45 & 0x10000) | v46;
-      ++v40;
-      v47 = bswap32(*v33);
-      v33 += 2;
-      v48 = v47;
-      v49 = (8 * (v47 & 0x100000)) | (4 * (v47 & 0x100000)) | (2 * (v47 & 0x100000)) | (v47 & 0x100000) | ((((v47 >> 16) & 0xE00) >> 3) & 0x100) | ((v47 >> 16) & 0xE00) | (8 * ((v47 >> 12) & 0x1000)) | (4 * ((v47 >> 12) & 0x1000)) | (2 * ((v47 >> 12) & 0x1000)) | ((v47 >> 12) & 0x1000) | (((v47 >> 28) & 0xE) >> 3) | ((v47 >> 28) & 0xE) | (8 * ((v47 >> 24) & 0x10)) | (4 * ((v47 >> 24) & 0x10)) | (2 * ((v47 >> 24) & 0x10)) | ((v47 >> 24) & 0x10);
-      v47 >>= 4;
-      v47 &= 0xE0000u;
-      v50 = v47 | v49;
-      v47 >>= 3;
-      *v40 = ((((v48 << 8) & 0xE000000) >> 3) & 0x1000000) | ((v48 << 8) & 0xE000000) | (8 * ((v48 << 12) & 0x10000000)) | (4 * ((v48 << 12) & 0x10000000)) | (2 * ((v48 << 12) & 0x10000000)) | ((v48 << 12) & 0x10000000) | (v47 & 0x10000) | v50;
-      ++v40;
-      v51 = 16 * (uint16_t)v48 & 0x1000;
-      v52 = (((v48 & 0xE00) >> 3) & 0x100) | (v48 & 0xE00) | (8 * v51) | (4 * v51) | (2 * v51) | v51 | (((v48 >> 12) & 0xE) >> 3) | ((v48 >> 12) & 0xE) | (8 * ((v48 >> 8) & 0x10)) | (4 * ((v48 >> 8) & 0x10)) | (2 * ((v48 >> 8) & 0x10)) | ((v48 >> 8) & 0x10);
-      v53 = v48 << 16;
-      v54 = (8 * (v53 & 0x100000)) | (4 * (v53 & 0x100000)) | (2 * (v53 & 0x100000)) | (v53 & 0x100000) | v52;
-      v55 = v48 << 12;
-      v55 &= 0xE0000u;
-      v56 = v55 | v54;
-      v55 >>= 3;
-      *v40 = ((((v48 << 24) & 0xE000000) >> 3) & 0x1000000) | ((v48 << 24) & 0xE000000) | (8 * ((v48 << 28) & 0x10000000)) | (4 * ((v48 << 28) & 0x10000000)) | (2 * ((v48 << 28) & 0x10000000)) | ((v48 << 28) & 0x10000000) | (v55 & 0x10000) | v56;
-      v34 = v40 + 1;
-      v35 = v36 - 1;
+      if (ia)
+        t[k] = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(t[k], one), one), alpha),
+          _mm_or_si128(_mm_and_si128(t[k], inten), _mm_and_si128(_mm_srli_epi16(t[k], 3), one)));
+      else
+        t[k] = _mm_or_si128(t[k], _mm_slli_epi16(t[k], 4));
+      _mm_storeu_si128((__m128i *)(dst + (i << 2) + (k << 2)), t[k]);
     }
-    while ( v36 != 1 );
-    v6 = (uint32_t *)((char *)v33 + line);
-    v7 = (uint32_t *)((char *)v34 + ext);
-    v8 = v58 - 1;
   }
-  while ( v58 != 1 );
+#endif
+  for (; i < wid_64; i++)
+  {
+    uint32_t *d = dst + (i << 2);
+    spread4bDword(src[(i << 1) + swap], d);
+    spread4bDword(src[(i << 1) + (swap ^ 1)], d + 2);
+    for (int k = 0; k < 4; k++)
+      d[k] = ia ? ia31Texels(d[k]) : i4Texels(d[k]);
+  }
 }
 
-static inline void load4bI(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+static inline void load4bIA(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  int v10;
-  uint32_t v11;
-  uint32_t *v12;
-  uint32_t v13;
-  uint32_t v14;
-  uint32_t *v15;
-  uint32_t v16;
-  unsigned int v17;
-  unsigned int v18;
-  uint32_t v19;
-  uint32_t v20;
-  uint32_t *v21;
-  uint32_t *v22;
-  int v23;
-  int v24;
-  uint32_t v25;
-  uint32_t v26;
-  uint32_t *v27;
-  uint32_t v28;
-  uint32_t v29;
-  uint32_t v30;
-  uint32_t v31;
-  uint32_t v32;
-  int v33;
-  int v34;
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
+  {
+    load4bRow(s, d, wid_64, y & 1, 1);
+    s = (uint32_t *)((char *)(s + (wid_64 << 1)) + line);
+    d = (uint32_t *)((char *)(d + (wid_64 << 2)) + ext);
+  }
+}
 
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+static inline void load4bI(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+{
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
   {
-    v33 = v8;
-    v9 = wid_64;
-    do
-    {
-      v10 = v9;
-      v11 = bswap32(*v6);
-      v12 = v6 + 1;
-      v13 = v11;
-      v14 = (16 * ((v11 >> 16) & 0xF00)) | ((v11 >> 16) & 0xF00) | (16 * (v11 >> 28)) | (v11 >> 28);
-      v11 >>= 4;
-      *v7 = (16 * ((v13 << 8) & 0xF000000)) | ((v13 << 8) & 0xF000000) | (16 * (v11 & 0xF0000)) | (v11 & 0xF0000) | v14;
-      v15 = v7 + 1;
-      v16 = v13 << 12;
-      *v15 = (16 * ((v13 << 24) & 0xF000000)) | ((v13 << 24) & 0xF000000) | (16 * (v16 & 0xF0000)) | (v16 & 0xF0000) | (16 * (v13 & 0xF00)) | (v13 & 0xF00) | (16 * ((uint16_t)v13 >> 12)) | ((uint16_t)v13 >> 12);
-      ++v15;
-      v17 = bswap32(*v12);
-      v6 = v12 + 1;
-      v18 = v17;
-      v19 = (16 * ((v17 >> 16) & 0xF00)) | ((v17 >> 16) & 0xF00) | (16 * (v17 >> 28)) | (v17 >> 28);
-      v17 >>= 4;
-      *v15 = (16 * ((v18 << 8) & 0xF000000)) | ((v18 << 8) & 0xF000000) | (16 * (v17 & 0xF0000)) | (v17 & 0xF0000) | v19;
-      ++v15;
-      v20 = v18 << 12;
-      *v15 = (16 * ((v18 << 24) & 0xF000000)) | ((v18 << 24) & 0xF000000) | (16 * (v20 & 0xF0000)) | (v20 & 0xF0000) | (16 * (v18 & 0xF00)) | (v18 & 0xF00) | (16 * ((uint16_t)v18 >> 12)) | ((uint16_t)v18 >> 12);
-      v7 = v15 + 1;
-      v9 = v10 - 1;
-    }
-    while ( v10 != 1 );
-    if ( v33 == 1 )
-      break;
-    v34 = v33 - 1;
-    v21 = (uint32_t *)((char *)v6 + line);
-    v22 = (uint32_t *)((char *)v7 + ext);
-    v23 = wid_64;
-    do
-    {
-      v24 = v23;
-      v25 = bswap32(v21[1]);
-      v26 = v25 >> 4;
-      *v22 = (16 * ((v25 << 8) & 0xF000000)) | ((v25 << 8) & 0xF000000) | (16 * (v26 & 0xF0000)) | (v26 & 0xF0000) | (16 * ((v25 >> 16) & 0xF00)) | ((v25 >> 16) & 0xF00) | (16 * (v25 >> 28)) | (v25 >> 28);
-      v27 = v22 + 1;
-      v28 = v25 << 12;
-      *v27 = (16 * ((v25 << 24) & 0xF000000)) | ((v25 << 24) & 0xF000000) | (16 * (v28 & 0xF0000)) | (v28 & 0xF0000) | (16 * (v25 & 0xF00)) | (v25 & 0xF00) | (16 * ((uint16_t)v25 >> 12)) | ((uint16_t)v25 >> 12);
-      ++v27;
-      v29 = bswap32(*v21);
-      v21 += 2;
-      v30 = v29;
-      v31 = (16 * ((v29 >> 16) & 0xF00)) | ((v29 >> 16) & 0xF00) | (16 * (v29 >> 28)) | (v29 >> 28);
-      v29 >>= 4;
-      *v27 = (16 * ((v30 << 8) & 0xF000000)) | ((v30 << 8) & 0xF000000) | (16 * (v29 & 0xF0000)) | (v29 & 0xF0000) | v31;
-      ++v27;
-      v32 = v30 << 12;
-      *v27 = (16 * ((v30 << 24) & 0xF000000)) | ((v30 << 24) & 0xF000000) | (16 * (v32 & 0xF0000)) | (v32 & 0xF0000) | (16 * (v30 & 0xF00)) | (v30 & 0xF00) | (16 * ((uint16_t)v30 >> 12)) | ((uint16_t)v30 >> 12);
-      v22 = v27 + 1;
-      v23 = v24 - 1;
-    }
-    while ( v24 != 1 );
-    v6 = (uint32_t *)((char *)v21 + line);
-    v7 = (uint32_t *)((char *)v22 + ext);
-    v8 = v34 - 1;
+    load4bRow(s, d, wid_64, y & 1, 0);
+    s = (uint32_t *)((char *)(s + (wid_64 << 1)) + line);
+    d = (uint32_t *)((char *)(d + (wid_64 << 2)) + ext);
   }
-  while ( v34 != 1 );
 }
 
 //****************************************************************
@@ -242,132 +242,63 @@ static inline void load8bIA8(uint8_t *src, uint8_t *dst, int wid_64, int height,
   while ( v26 != 1 );
 }
 
-static inline void load8bIA4(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+// IA44 texels are stored as AI44 by swapping the nibbles of every byte
+static inline void load8bIA4Row(const uint32_t *src, uint32_t *dst, int wid_64, int swap)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  uint32_t v10;
-  uint32_t v11;
-  uint32_t *v12;
-  uint32_t *v13;
-  uint32_t v14;
-  uint32_t v15;
-  uint32_t *v16;
-  uint32_t *v17;
-  int v18;
-  uint32_t *v19;
-  uint32_t v20;
-  int v21;
-  int v22;
+  int i = 0;
+#if defined(TEX_NEON)
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    uint32x4_t v = vld1q_u32(src + (i << 1));
+    if (swap)
+      v = vrev64q_u32(v);
+    uint8x16_t t = vreinterpretq_u8_u32(v);
+    t = vorrq_u8(vshlq_n_u8(t, 4), vshrq_n_u8(t, 4));
+    vst1q_u32(dst + (i << 1), vreinterpretq_u32_u8(t));
+  }
+#elif defined(TEX_SSE2)
+  const __m128i hi = _mm_set1_epi8((char)0xF0);
+  const __m128i lo = _mm_set1_epi8(0x0F);
+  for (; i + 2 <= wid_64; i += 2)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)(src + (i << 1)));
+    if (swap)
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 4), hi), _mm_and_si128(_mm_srli_epi16(v, 4), lo));
+    _mm_storeu_si128((__m128i *)(dst + (i << 1)), v);
+  }
+#endif
+  for (; i < wid_64; i++)
+  {
+    uint32_t v0 = src[(i << 1) + swap];
+    uint32_t v1 = src[(i << 1) + (swap ^ 1)];
+    dst[(i << 1)] = ((v0 << 4) & 0xF0F0F0F0) | ((v0 >> 4) & 0x0F0F0F0F);
+    dst[(i << 1) + 1] = ((v1 << 4) & 0xF0F0F0F0) | ((v1 >> 4) & 0x0F0F0F0F);
+  }
+}
 
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+static inline void load8bIA4(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
+{
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
   {
-    v21 = v8;
-    v9 = wid_64;
-    do
-    {
-      v10 = *v6;
-      v11 = (*v6 >> 4) & 0xF0F0F0F;
-      v12 = v6 + 1;
-      *v7 = (16 * v10 & 0xF0F0F0F0) | v11;
-      v13 = v7 + 1;
-      v14 = (*v12 >> 4) & 0xF0F0F0F;
-      v15 = 16 * *v12 & 0xF0F0F0F0;
-      v6 = v12 + 1;
-      *v13 = v15 | v14;
-      v7 = v13 + 1;
-      --v9;
-    }
-    while ( v9 );
-    if ( v21 == 1 )
-      break;
-    v22 = v21 - 1;
-    v16 = (uint32_t *)((char *)v6 + line);
-    v17 = (uint32_t *)((char *)v7 + ext);
-    v18 = wid_64;
-    do
-    {
-      *v17 = (16 * v16[1] & 0xF0F0F0F0) | ((v16[1] >> 4) & 0xF0F0F0F);
-      v19 = v17 + 1;
-      v20 = *v16;
-      v16 += 2;
-      *v19 = (16 * v20 & 0xF0F0F0F0) | ((v20 >> 4) & 0xF0F0F0F);
-      v17 = v19 + 1;
-      --v18;
-    }
-    while ( v18 );
-    v6 = (uint32_t *)((char *)v16 + line);
-    v7 = (uint32_t *)((char *)v17 + ext);
-    v8 = v22 - 1;
+    load8bIA4Row(s, d, wid_64, y & 1);
+    s = (uint32_t *)((char *)(s + (wid_64 << 1)) + line);
+    d = (uint32_t *)((char *)(d + (wid_64 << 1)) + ext);
   }
-  while ( v22 != 1 );
 }
 
 static inline void load8bI(uint8_t *src, uint8_t *dst, int wid_64, int height, int line, int ext)
 {
-  uint32_t *v6;
-  uint32_t *v7;
-  int v8;
-  int v9;
-  uint32_t v10;
-  uint32_t *v11;
-  uint32_t *v12;
-  uint32_t v13;
-  uint32_t *v14;
-  uint32_t *v15;
-  int v16;
-  uint32_t *v17;
-  uint32_t v18;
-  int v19;
-  int v20;
-
-  v6 = (uint32_t *)src;
-  v7 = (uint32_t *)dst;
-  v8 = height;
-  do
+  uint32_t *s = (uint32_t *)src;
+  uint32_t *d = (uint32_t *)dst;
+  for (int y = 0; y < height; y++)
   {
-    v19 = v8;
-    v9 = wid_64;
-    do
-    {
-      v10 = *v6;
-      v11 = v6 + 1;
-      *v7 = v10;
-      v12 = v7 + 1;
-      v13 = *v11;
-      v6 = v11 + 1;
-      *v12 = v13;
-      v7 = v12 + 1;
-      --v9;
-    }
-    while ( v9 );
-    if ( v19 == 1 )
-      break;
-    v20 = v19 - 1;
-    v14 = (uint32_t *)((char *)v6 + line);
-    v15 = (uint32_t *)((char *)v7 + ext);
-    v16 = wid_64;
-    do
-    {
-      *v15 = v14[1];
-      v17 = v15 + 1;
-      v18 = *v14;
-      v14 += 2;
-      *v17 = v18;
-      v15 = v17 + 1;
-      --v16;
-    }
-    while ( v16 );
-    v6 = (uint32_t *)((char *)v14 + line);
-    v7 = (uint32_t *)((char *)v15 + ext);
-    v8 = v20 - 1;
+    loadRowCopy(s, d, wid_64, y & 1);
+    s = (uint32_t *)((char *)(s + (wid_64 << 1)) + line);
+    d = (uint32_t *)((char *)(d + (wid_64 << 1)) + ext);
   }
-  while ( v20 != 1 );
 }
 
 //****************************************************************
@@ -37,34 +37,84 @@
 //
 //****************************************************************
 
+typedef struct {
+	wxUint16 a[16], r[16], g[16], b[16];
+} MOD_LUT;
+
+// Most modifications only look at the channel they produce, so they are done
+// once for each of the 16 possible values and then applied through tables.
+// The tables hold the shifted result, a channel that overflows still spills
+// into its neighbour like it did with the per texel math.
+static void mod_apply_lut (wxUint16 *dst, int size, const MOD_LUT *lut)
+{
+	int i = 0;
+#if defined(TEX_NEON)
+	const wxUint16 *tab[4] = { lut->a, lut->r, lut->g, lut->b };
+	uint8x8x2_t tlo[4], thi[4];
+	for (int c = 0; c < 4; c++)
+	{
+		wxUint8 lo[16], hi[16];
+		for (int n = 0; n < 16; n++)
+		{
+			lo[n] = (wxUint8)tab[c][n];
+			hi[n] = (wxUint8)(tab[c][n] >> 8);
+		}
+		tlo[c].val[0] = vld1_u8(lo);
+		tlo[c].val[1] = vld1_u8(lo + 8);
+		thi[c].val[0] = vld1_u8(hi);
+		thi[c].val[1] = vld1_u8(hi + 8);
+	}
+	const uint16x8_t nib = vdupq_n_u16(0xF);
+	for (; i + 8 <= size; i += 8)
+	{
+		uint16x8_t col = vld1q_u16(dst + i);
+		uint8x8_t n[4];
+		n[0] = vmovn_u16(vshrq_n_u16(col, 12));
+		n[1] = vmovn_u16(vandq_u16(vshrq_n_u16(col, 8), nib));
+		n[2] = vmovn_u16(vandq_u16(vshrq_n_u16(col, 4), nib));
+		n[3] = vmovn_u16(vandq_u16(col, nib));
+		uint8x8_t lo = vtbl2_u8(tlo[0], n[0]);
+		uint8x8_t hi = vtbl2_u8(thi[0], n[0]);
+		for (int c = 1; c < 4; c++)
+		{
+			lo = vorr_u8(lo, vtbl2_u8(tlo[c], n[c]));
+			hi = vorr_u8(hi, vtbl2_u8(thi[c], n[c]));
+		}
+		vst1q_u16(dst + i, vorrq_u16(vmovl_u8(lo), vshlq_n_u16(vmovl_u8(hi), 8)));
+	}
+#endif
+	for (; i < size; i++)
+	{
+		wxUint16 col = dst[i];
+		dst[i] = lut->a[col >> 12] | lut->r[(col >> 8) & 0xF] | lut->g[(col >> 4) & 0xF] | lut->b[col & 0xF];
+	}
+}
+
 static void mod_tex_inter_color_using_factor (wxUint16 *dst, int size, wxUint32 color, wxUint32 factor)
 {
 	float percent = factor / 255.0f;
 	float percent_i = 1 - percent;
 	wxUint32 cr, cg, cb;
-	wxUint16 col, a;
-	wxUint8 r, g, b;
+	MOD_LUT lut;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		r = (wxUint8)(percent_i * ((col >> 8) & 0xF) + percent * cr);
-		g = (wxUint8)(percent_i * ((col >> 4) & 0xF) + percent * cg);
-		b = (wxUint8)(percent_i * (col & 0xF) + percent * cb);
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)(percent_i * n + percent * cr) << 8;
+		lut.g[n] = (wxUint8)(percent_i * n + percent * cg) << 4;
+		lut.b[n] = (wxUint8)(percent_i * n + percent * cb);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_inter_col_using_col1 (wxUint16 *dst, int size, wxUint32 color0, wxUint32 color1)
 {
 	wxUint32 cr, cg, cb;
-	wxUint16 col, a;
-	wxUint8 r, g, b;
+	MOD_LUT lut;
 
 	float percent_r = ((color1 >> 12) & 0xF) / 15.0f;
 	float percent_g = ((color1 >> 8) & 0xF) / 15.0f;
@@ -77,46 +127,41 @@ static void mod_tex_inter_col_using_col1 (wxUint16 *dst, int size, wxUint32 colo
 	cg = (color0 >> 8) & 0xF;
 	cb = (color0 >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		r = (wxUint8)(percent_r_i * ((col >> 8) & 0xF) + percent_r * cr);
-		g = (wxUint8)(percent_g_i * ((col >> 4) & 0xF) + percent_g * cg);
-		b = (wxUint8)(percent_b_i * (col & 0xF) + percent_b * cb);
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)(percent_r_i * n + percent_r * cr) << 8;
+		lut.g[n] = (wxUint8)(percent_g_i * n + percent_g * cg) << 4;
+		lut.b[n] = (wxUint8)(percent_b_i * n + percent_b * cb);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_full_color_sub_tex (wxUint16 *dst, int size, wxUint32 color)
 {
 	wxUint32 cr, cg, cb, ca;
-	wxUint16 col;
-	wxUint8 a, r, g, b;
+	MOD_LUT lut;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 	ca = color & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)(ca - ((col >> 12) & 0xF));
-		r = (wxUint8)(cr - ((col >> 8) & 0xF));
-		g = (wxUint8)(cg - ((col >> 4) & 0xF));
-		b = (wxUint8)(cb - (col & 0xF));
-		*(dst++) = (a << 12) | (r << 8) | (g << 4) | b;
+		lut.a[n] = (wxUint8)(ca - n) << 12;
+		lut.r[n] = (wxUint8)(cr - n) << 8;
+		lut.g[n] = (wxUint8)(cg - n) << 4;
+		lut.b[n] = (wxUint8)(cb - n);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_col_inter_col1_using_tex (wxUint16 *dst, int size, wxUint32 color0, wxUint32 color1)
 {
 	wxUint32 cr0, cg0, cb0, cr1, cg1, cb1;
-	wxUint16 col;
-	wxUint8 r, g, b;
-	wxUint16 a;
-	float percent_r, percent_g, percent_b;
+	MOD_LUT lut;
+	float percent;
 
 	cr0 = (color0 >> 12) & 0xF;
 	cg0 = (color0 >> 8) & 0xF;
@@ -125,18 +170,15 @@ static void mod_col_inter_col1_using_tex (wxUint16 *dst, int size, wxUint32 colo
 	cg1 = (color1 >> 8) & 0xF;
 	cb1 = (color1 >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		percent_r = ((col >> 8) & 0xF) / 15.0f;
-		percent_g = ((col >> 4) & 0xF) / 15.0f;
-		percent_b = (col & 0xF) / 15.0f;
-		r = min(15, (wxUint8)((1.0f-percent_r) * cr0 + percent_r * cr1 + 0.0001f));
-		g = min(15, (wxUint8)((1.0f-percent_g) * cg0 + percent_g * cg1 + 0.0001f));
-		b = min(15, (wxUint8)((1.0f-percent_b) * cb0 + percent_b * cb1 + 0.0001f));
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		percent = n / 15.0f;
+		lut.a[n] = n << 12;
+		lut.r[n] = min(15, (wxUint8)((1.0f-percent) * cr0 + percent * cr1 + 0.0001f)) << 8;
+		lut.g[n] = min(15, (wxUint8)((1.0f-percent) * cg0 + percent * cg1 + 0.0001f)) << 4;
+		lut.b[n] = min(15, (wxUint8)((1.0f-percent) * cb0 + percent * cb1 + 0.0001f));
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_col_inter_col1_using_texa (wxUint16 *dst, int size, wxUint32 color0, wxUint32 color1)
@@ -198,27 +240,22 @@ static void mod_col_inter_col1_using_texa__mul_tex (wxUint16 *dst, int size, wxU
 static void mod_col_inter_tex_using_tex (wxUint16 *dst, int size, wxUint32 color)
 {
 	wxUint32 cr, cg, cb;
-	wxUint16 col;
-	wxUint8 r, g, b;
-	wxUint16 a;
-	float percent_r, percent_g, percent_b;
+	MOD_LUT lut;
+	float percent;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		percent_r = ((col >> 8) & 0xF) / 15.0f;
-		percent_g = ((col >> 4) & 0xF) / 15.0f;
-		percent_b = (col & 0xF) / 15.0f;
-		r = (wxUint8)((1.0f-percent_r) * cr + percent_r * ((col & 0x0F00) >> 8));
-		g = (wxUint8)((1.0f-percent_g) * cg + percent_g * ((col & 0x00F0) >> 4));
-		b = (wxUint8)((1.0f-percent_b) * cb + percent_b * (col & 0x000F));       
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		percent = n / 15.0f;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)((1.0f-percent) * cr + percent * n) << 8;
+		lut.g[n] = (wxUint8)((1.0f-percent) * cg + percent * n) << 4;
+		lut.b[n] = (wxUint8)((1.0f-percent) * cb + percent * n);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_col_inter_tex_using_texa (wxUint16 *dst, int size, wxUint32 color)
@@ -284,57 +321,58 @@ static void mod_col2_inter__col_inter_col1_using_tex__using_texa (wxUint16 *dst,
 static void mod_tex_scale_fac_add_fac (wxUint16 *dst, int size, wxUint32 factor)
 {
 	float percent = factor / 255.0f;
-	wxUint16 col;
-	wxUint8 a;
 	float base_a = (1.0f - percent) * 15.0f;
+	MOD_LUT lut;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)(base_a + percent * (col>>12));
-		*(dst++) = (a<<12) | (col & 0x0FFF);
+		lut.a[n] = (wxUint8)(base_a + percent * n) << 12;
+		lut.r[n] = n << 8;
+		lut.g[n] = n << 4;
+		lut.b[n] = n;
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_sub_col_mul_fac_add_tex (wxUint16 *dst, int size, wxUint32 color, wxUint32 factor)
 {
 	float percent = factor / 255.0f;
 	wxUint32 cr, cg, cb;
-	wxUint16 col, a;
+	MOD_LUT lut;
 	float r, g, b;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		r = (float)((col >> 8) & 0xF);
+		r = (float)n;
 		r = /*max(*/(r - cr) * percent/*, 0.0f)*/ + r;
 		if (r > 15.0f) r = 15.0f;
 		if (r < 0.0f) r = 0.0f;
-		g = (float)((col >> 4) & 0xF);
+		g = (float)n;
 		g = /*max(*/(g - cg) * percent/*, 0.0f)*/ + g;
 		if (g > 15.0f) g = 15.0f;
 		if (g < 0.0f) g = 0.0f;
-		b = (float)(col & 0xF);
+		b = (float)n;
 		b = /*max(*/(b - cb) * percent/*, 0.0f)*/ + b;
 		if (b > 15.0f) b = 15.0f;
 		if (b < 0.0f) b = 0.0f;
 
-		*(dst++) = a | ((wxUint16)r << 8) | ((wxUint16)g << 4) | (wxUint16)b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint16)r << 8;
+		lut.g[n] = (wxUint16)g << 4;
+		lut.b[n] = (wxUint16)b;
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_scale_col_add_col (wxUint16 *dst, int size, wxUint32 color0, wxUint32 color1)
 {
 	wxUint32 cr0, cg0, cb0, cr1, cg1, cb1;
-	wxUint16 col;
-	wxUint8 r, g, b;
-	wxUint16 a;
-	float percent_r, percent_g, percent_b;
+	MOD_LUT lut;
+	float percent;
 
 	cr0 = (color0 >> 12) & 0xF;
 	cg0 = (color0 >> 8) & 0xF;
@@ -343,40 +381,34 @@ static void mod_tex_scale_col_add_col (wxUint16 *dst, int size, wxUint32 color0,
 	cg1 = (color1 >> 8) & 0xF;
 	cb1 = (color1 >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		percent_r = ((col >> 8) & 0xF) / 15.0f;
-		percent_g = ((col >> 4) & 0xF) / 15.0f;
-		percent_b = (col & 0xF) / 15.0f;
-		r = min(15, (wxUint8)(percent_r * cr0 + cr1 + 0.0001f));
-		g = min(15, (wxUint8)(percent_g * cg0 + cg1 + 0.0001f));
-		b = min(15, (wxUint8)(percent_b * cb0 + cb1 + 0.0001f));
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		percent = n / 15.0f;
+		lut.a[n] = n << 12;
+		lut.r[n] = min(15, (wxUint8)(percent * cr0 + cr1 + 0.0001f)) << 8;
+		lut.g[n] = min(15, (wxUint8)(percent * cg0 + cg1 + 0.0001f)) << 4;
+		lut.b[n] = min(15, (wxUint8)(percent * cb0 + cb1 + 0.0001f));
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_add_col (wxUint16 *dst, int size, wxUint32 color)
 {
 	wxUint32 cr, cg, cb;
-	wxUint16 col;
-	wxUint8 a, r, g, b;
+	MOD_LUT lut;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)((col >> 12) & 0xF);
-//		a = col & 0xF000;
-		r = (wxUint8)(cr + ((col >> 8) & 0xF))&0xF;
-		g = (wxUint8)(cg + ((col >> 4) & 0xF))&0xF;
-		b = (wxUint8)(cb + (col & 0xF))&0xF;
-		*(dst++) = (a << 12) | (r << 8) | (g << 4) | b;
+		lut.a[n] = n << 12;
+		lut.r[n] = ((wxUint8)(cr + n)&0xF) << 8;
+		lut.g[n] = ((wxUint8)(cg + n)&0xF) << 4;
+		lut.b[n] = (wxUint8)(cb + n)&0xF;
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_col_mul_texa_add_tex (wxUint16 *dst, int size, wxUint32 color)
@@ -406,61 +438,61 @@ static void mod_col_mul_texa_add_tex (wxUint16 *dst, int size, wxUint32 color)
 static void mod_tex_sub_col (wxUint16 *dst, int size, wxUint32 color)
 {
 	int cr, cg, cb;
-	wxUint16 col;
-	wxUint8 a, r, g, b;
+	MOD_LUT lut;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)(col & 0xF000);
-		r = (wxUint8)max((((col >> 8) & 0xF) - cr), 0);
-		g = (wxUint8)max((((col >> 4) & 0xF) - cg), 0);
-		b = (wxUint8)max(((col & 0xF) - cb), 0);
-		*(dst++) = (a << 12) | (r << 8) | (g << 4) | b;
+		// the alpha written here was always (wxUint8)(col & 0xF000), i.e. 0
+		lut.a[n] = 0;
+		lut.r[n] = (wxUint8)max((n - cr), 0) << 8;
+		lut.g[n] = (wxUint8)max((n - cg), 0) << 4;
+		lut.b[n] = (wxUint8)max((n - cb), 0);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_sub_col_mul_fac (wxUint16 *dst, int size, wxUint32 color, wxUint32 factor)
 {
 	float percent = factor / 255.0f;
 	wxUint32 cr, cg, cb;
-	wxUint16 col, a;
+	MOD_LUT lut;
 	float r, g, b;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)((col >> 12) & 0xF);
-		r = (float)((col >> 8) & 0xF);
+		r = (float)n;
 		r = (r - cr) * percent;
 		if (r > 15.0f) r = 15.0f;
 		if (r < 0.0f) r = 0.0f;
-		g = (float)((col >> 4) & 0xF);
+		g = (float)n;
 		g = (g - cg) * percent;
 		if (g > 15.0f) g = 15.0f;
 		if (g < 0.0f) g = 0.0f;
-		b = (float)(col & 0xF);
+		b = (float)n;
 		b = (b - cb) * percent;
 		if (b > 15.0f) b = 15.0f;
 		if (b < 0.0f) b = 0.0f;
 
-		*(dst++) = (a << 12) | ((wxUint16)r << 8) | ((wxUint16)g << 4) | (wxUint16)b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint16)r << 8;
+		lut.g[n] = (wxUint16)g << 4;
+		lut.b[n] = (wxUint16)b;
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_col_inter_tex_using_col1 (wxUint16 *dst, int size, wxUint32 color0, wxUint32 color1)
 {
 	wxUint32 cr, cg, cb;
-	wxUint16 col, a;
-	wxUint8 r, g, b;
+	MOD_LUT lut;
 
 	float percent_r = ((color1 >> 12) & 0xF) / 15.0f;
 	float percent_g = ((color1 >> 8) & 0xF) / 15.0f;
@@ -473,15 +505,14 @@ static void mod_col_inter_tex_using_col1 (wxUint16 *dst, int size, wxUint32 colo
 	cg = (color0 >> 8) & 0xF;
 	cb = (color0 >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = (wxUint8)((col >> 12) & 0xF);
-		r = (wxUint8)(percent_r * ((col >> 8) & 0xF) + percent_r_i * cr);
-		g = (wxUint8)(percent_g * ((col >> 4) & 0xF) + percent_g_i * cg);
-		b = (wxUint8)(percent_b * (col & 0xF) + percent_b_i * cb);
-		*(dst++) = (a << 12) | (r << 8) | (g << 4) | b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)(percent_r * n + percent_r_i * cr) << 8;
+		lut.g[n] = (wxUint8)(percent_g * n + percent_g_i * cg) << 4;
+		lut.b[n] = (wxUint8)(percent_b * n + percent_b_i * cb);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_inter_noise_using_col (wxUint16 *dst, int size, wxUint32 color)
@@ -536,42 +567,38 @@ static void mod_tex_inter_col_using_texa (wxUint16 *dst, int size, wxUint32 colo
 static void mod_tex_mul_col (wxUint16 *dst, int size, wxUint32 color)
 {
 	float cr, cg, cb;
-	wxUint16 col;
-	wxUint8 r, g, b;
-	wxUint16 a;
+	MOD_LUT lut;
 
 	cr = (float)((color >> 12) & 0xF)/16.0f;
 	cg = (float)((color >> 8) & 0xF)/16.0f;
 	cb = (float)((color >> 4) & 0xF)/16.0f;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		a = col & 0xF000;
-		r = (wxUint8)(cr * ((col & 0x0F00) >> 8));
-		g = (wxUint8)(cg * ((col & 0x00F0) >> 4));
-		b = (wxUint8)(cb * (col & 0x000F));
-		*(dst++) = a | (r << 8) | (g << 4) | b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)(cr * n) << 8;
+		lut.g[n] = (wxUint8)(cg * n) << 4;
+		lut.b[n] = (wxUint8)(cb * n);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
 
 static void mod_tex_scale_fac_add_col (wxUint16 *dst, int size, wxUint32 color, wxUint32 factor)
 {
 	float percent = factor / 255.0f;
 	wxUint32 cr, cg, cb;
-	wxUint16 col;
-	float r, g, b;
+	MOD_LUT lut;
 
 	cr = (color >> 12) & 0xF;
 	cg = (color >> 8) & 0xF;
 	cb = (color >> 4) & 0xF;
 
-	for (int i=0; i<size; i++)
+	for (int n=0; n<16; n++)
 	{
-		col = *dst;
-		r = cr + percent * (float)((col>>8)&0xF);
-		g = cg + percent * (float)((col>>4)&0xF);
-		b = cb + percent * (float)(col&0xF);
-		*(dst++) = (col&0xF000) | ((wxUint8)r << 8) | ((wxUint8)g << 4) | (wxUint8)b;
+		lut.a[n] = n << 12;
+		lut.r[n] = (wxUint8)(cr + percent * (float)n) << 8;
+		lut.g[n] = (wxUint8)(cg + percent * (float)n) << 4;
+		lut.b[n] = (wxUint8)(cb + percent * (float)n);
 	}
+	mod_apply_lut (dst, size, &lut);
 }
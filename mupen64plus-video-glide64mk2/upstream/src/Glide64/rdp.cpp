@@ -229,6 +229,7 @@ static int old_ucode = -1;
 void RDP::Reset()
 {
   memset(this, 0, sizeof(RDP_Base));
+  tmem_stamp++;
   // set all vertex numbers
   for (int i=0; i<MAX_VTX; i++)
     vtx[i].number = i;
@@ -281,6 +282,7 @@ RDP::RDP()
   v0 = vn = 0;
 
   frame_buffers = new COLOR_IMAGE[NUMTEXBUF+2];
+  tmem_stamp = 0;
 }
 
 RDP::~RDP()
@@ -2017,6 +2019,7 @@ static void rdp_loadblock()
     LoadBlock32b(tile, ul_s, ul_t, lr_s, dxt);
   else
     loadBlock((uint32_t *)gfx.RDRAM, (uint32_t *)dst, off, _dxt, cnt);
+  rdp.tmem_stamp++;
 
   rdp.timg.addr += cnt << 3;
   rdp.tiles[tile].lr_t = ul_t + ((dxt*cnt)>>11);
@@ -2254,6 +2257,7 @@ static void rdp_loadtile()
     unsigned char *end = ((unsigned char *)rdp.tmem) + 4096 - (wid_64<<3);
     loadTile((uint32_t *)gfx.RDRAM, (uint32_t *)dst, wid_64, height, line_n, offs, (uint32_t *)end);
   }
+  rdp.tmem_stamp++;
   FRDP("loadtile: tile: %d, ul_s: %d, ul_t: %d, lr_s: %d, lr_t: %d\n", tile,
     ul_s, ul_t, lr_s, lr_t);
 
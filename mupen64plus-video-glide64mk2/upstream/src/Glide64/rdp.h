@@ -818,6 +818,7 @@ struct RDP : public RDP_Base
   CACHE_LUT *cur_cache[MAX_TMU];
   wxUint32   cur_cache_n[MAX_TMU];
   int     n_cached[MAX_TMU];
+  wxUint32   tmem_stamp; // bumped whenever tmem is written, see GetTexInfo
 
   // Vertices
   VERTEX *vtx; //[MAX_VTX]
@@ -847,6 +848,7 @@ extern GrTexInfo  fontTex;
 extern GrTexInfo  cursorTex;
 extern wxUint32   offset_font;
 extern wxUint32   offset_cursor;
+extern wxUint32   offset_fb_to_screen;
 extern wxUint32   offset_textures;
 extern wxUint32   offset_texbuf1;
 
@@ -54,7 +54,7 @@ static void rsp_vertex(int v0, int n)
 {
   wxUint32 addr = segoffset(rdp.cmd1) & 0x00FFFFFF;
   int i;
-  float x, y, z;
+  DECLAREALIGN16VAR(pos[16][4]);
 
   rdp.v0 = v0; // Current vertex
   rdp.vn = n;  // Number to copy
@@ -83,43 +83,32 @@ static void rsp_vertex(int v0, int n)
 
   FRDP ("rsp:vertex v0:%d, n:%d, from: %08lx\n", v0, n, addr);
 
+  // Positions are gathered first so the whole batch goes through one
+  // TransformVertices call instead of a matrix multiply per vertex
+  for (i=0; i < (n<<4); i+=16)
+  {
+    float *p = pos[i>>4];
+    p[0] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 0)^1];
+    p[1] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 1)^1];
+    p[2] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 2)^1];
+    p[3] = 1.0f;
+  }
+  TransformVertices(&rdp.vtx[v0], pos, n, rdp.combined);
+
   for (i=0; i < (n<<4); i+=16)
   {
     VERTEX *v = &rdp.vtx[v0 + (i>>4)];
-    x   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 0)^1];
-    y   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 1)^1];
-    z   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 2)^1];
     v->flags  = ((wxUint16*)gfx.RDRAM)[(((addr+i) >> 1) + 3)^1];
     v->ou = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 4)^1];
     v->ov = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 5)^1];
     v->uv_scaled = 0;
     v->a    = ((wxUint8*)gfx.RDRAM)[(addr+i + 15)^3];
-
-    v->x = x*rdp.combined[0][0] + y*rdp.combined[1][0] + z*rdp.combined[2][0] + rdp.combined[3][0];
-    v->y = x*rdp.combined[0][1] + y*rdp.combined[1][1] + z*rdp.combined[2][1] + rdp.combined[3][1];
-    v->z = x*rdp.combined[0][2] + y*rdp.combined[1][2] + z*rdp.combined[2][2] + rdp.combined[3][2];
-    v->w = x*rdp.combined[0][3] + y*rdp.combined[1][3] + z*rdp.combined[2][3] + rdp.combined[3][3];
-
-
-    if (fabs(v->w) < 0.001) v->w = 0.001f;
-    v->oow = 1.0f / v->w;
-    v->x_w = v->x * v->oow;
-    v->y_w = v->y * v->oow;
-    v->z_w = v->z * v->oow;
     CalculateFog (v);
 
     v->uv_calculated = 0xFFFFFFFF;
     v->screen_translated = 0;
     v->shade_mod = 0;
 
-    v->scr_off = 0;
-    if (v->x < -v->w) v->scr_off |= 1;
-    if (v->x > v->w) v->scr_off |= 2;
-    if (v->y < -v->w) v->scr_off |= 4;
-    if (v->y > v->w) v->scr_off |= 8;
-    if (v->w < 0.1f) v->scr_off |= 16;
-//    if (v->z_w > 1.0f) v->scr_off |= 32;
-
     if (rdp.geom_mode & 0x00020000)
     {
       v->vec[0] = ((char*)gfx.RDRAM)[(addr+i + 12)^3];
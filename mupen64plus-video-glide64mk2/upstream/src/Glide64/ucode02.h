@@ -111,7 +111,7 @@ static void uc2_vertex ()
 
   wxUint32 addr = segoffset(rdp.cmd1);
   int v0, i, n;
-  float x, y, z;
+  DECLAREALIGN16VAR(pos[MAX_VTX][4]);
 
   rdp.vn = n = (rdp.cmd0 >> 12) & 0xFF;
   rdp.v0 = v0 = ((rdp.cmd0 >> 1) & 0x7F) - n;
@@ -131,42 +131,30 @@ static void uc2_vertex ()
     if (((short*)gfx.RDRAM)[(((addr) >> 1) + 4)^1] || ((short*)gfx.RDRAM)[(((addr) >> 1) + 5)^1])
       rdp.geom_mode ^= 0x40000;
   }
+  for (i=0; i < (n<<4); i+=16)
+  {
+    float *p = pos[i>>4];
+    p[0] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 0)^1];
+    p[1] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 1)^1];
+    p[2] = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 2)^1];
+    p[3] = 1.0f;
+  }
+  TransformVertices(&rdp.vtx[v0], pos, n, rdp.combined);
+
   for (i=0; i < (n<<4); i+=16)
   {
     VERTEX *v = &rdp.vtx[v0 + (i>>4)];
-    x   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 0)^1];
-    y   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 1)^1];
-    z   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 2)^1];
     v->flags  = ((wxUint16*)gfx.RDRAM)[(((addr+i) >> 1) + 3)^1];
     v->ou   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 4)^1];
     v->ov   = (float)((short*)gfx.RDRAM)[(((addr+i) >> 1) + 5)^1];
     v->uv_scaled = 0;
     v->a    = ((wxUint8*)gfx.RDRAM)[(addr+i + 15)^3];
-
-    v->x = x*rdp.combined[0][0] + y*rdp.combined[1][0] + z*rdp.combined[2][0] + rdp.combined[3][0];
-    v->y = x*rdp.combined[0][1] + y*rdp.combined[1][1] + z*rdp.combined[2][1] + rdp.combined[3][1];
-    v->z = x*rdp.combined[0][2] + y*rdp.combined[1][2] + z*rdp.combined[2][2] + rdp.combined[3][2];
-    v->w = x*rdp.combined[0][3] + y*rdp.combined[1][3] + z*rdp.combined[2][3] + rdp.combined[3][3];
-
-    if (fabs(v->w) < 0.001) v->w = 0.001f;
-    v->oow = 1.0f / v->w;
-    v->x_w = v->x * v->oow;
-    v->y_w = v->y * v->oow;
-    v->z_w = v->z * v->oow;
     CalculateFog (v);
 
     v->uv_calculated = 0xFFFFFFFF;
     v->screen_translated = 0;
     v->shade_mod = 0;
 
-    v->scr_off = 0;
-    if (v->x < -v->w) v->scr_off |= 1;
-    if (v->x > v->w) v->scr_off |= 2;
-    if (v->y < -v->w) v->scr_off |= 4;
-    if (v->y > v->w) v->scr_off |= 8;
-    if (v->w < 0.1f) v->scr_off |= 16;
-//    if (v->z_w > 1.0f) v->scr_off |= 32;
-
     if (rdp.geom_mode & 0x00020000)
     {
       v->vec[0] = ((char*)gfx.RDRAM)[(addr+i + 12)^3];
@@ -195,8 +183,7 @@ static void uc2_vertex ()
       }
       if (rdp.geom_mode & 0x00400000)
       {
-        float tmpvec[3] = {x, y, z};
-        calc_point_light (v, tmpvec);
+        calc_point_light (v, pos[i>>4]);
       }
       else
       {
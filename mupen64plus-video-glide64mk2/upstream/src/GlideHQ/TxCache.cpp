@@ -27,6 +27,7 @@
 
 #include <boost/filesystem.hpp>
 #include <zlib.h>
+#include <SDL.h>
 #include "TxCache.h"
 #include "TxDbg.h"
 #include "../Glide64/m64p.h"
@@ -38,6 +39,8 @@ TxCache::~TxCache()
   clear();
 
   delete _txUtil;
+
+  SDL_DestroyMutex(_mutex);
 }
 
 TxCache::TxCache(int options, int cachesize, const wchar_t *datapath,
@@ -45,6 +48,7 @@ TxCache::TxCache(int options, int cachesize, const wchar_t *datapath,
                  dispInfoFuncExt callback)
 {
   _txUtil = new TxUtil();
+  _mutex = SDL_CreateMutex();
 
   _options = options;
   _cacheSize = cachesize;
@@ -84,13 +88,18 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 
   if (!checksum || !info->data) return 0;
 
+  SDL_LockMutex(_mutex);
+
   uint8 *dest = info->data;
   uint16 format = info->format;
 
   if (!dataSize) {
     dataSize = _txUtil->sizeofTx(info->width, info->height, info->format);
 
-    if (!dataSize) return 0;
+    if (!dataSize) {
+      SDL_UnlockMutex(_mutex);
+      return 0;
+    }
 
     if (_options & (GZ_TEXCACHE|GZ_HIRESTEXCACHE)) {
       /* zlib compress it. compression level:1 (best speed) */
@@ -185,18 +194,22 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
       /* total cache size */
       _totalSize += dataSize;
 
+      SDL_UnlockMutex(_mutex);
       return 1;
     }
     free(tmpdata);
   }
 
+  SDL_UnlockMutex(_mutex);
   return 0;
 }
 
 boolean
 TxCache::get(uint64 checksum, GHQTexInfo *info)
 {
-  if (!checksum || _cache.empty()) return 0;
+  if (!checksum) return 0;
+
+  SDL_LockMutex(_mutex);
 
   /* find a match in cache */
   std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
@@ -217,6 +230,7 @@ TxCache::get(uint64 checksum, GHQTexInfo *info)
       uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
       if (uncompress(dest, &destLen, info->data, ((*itMap).second)->size) != Z_OK) {
         DBG_INFO(80, L"Error: zlib decompression failed!\n");
+        SDL_UnlockMutex(_mutex);
         return 0;
       }
       info->data = dest;
@@ -224,39 +238,65 @@ TxCache::get(uint64 checksum, GHQTexInfo *info)
       DBG_INFO(80, L"zlib decompressed: %.02fkb->%.02fkb\n", (float)(((*itMap).second)->size)/1000, (float)destLen/1000);
     }
 
+    SDL_UnlockMutex(_mutex);
     return 1;
   }
 
+  SDL_UnlockMutex(_mutex);
   return 0;
 }
 
+void
+TxCache::saveEntry(gzFile gzfp, uint64 checksum, const TXCACHE *txCache)
+{
+  uint8 *dest    = txCache->info.data;
+  uint32 destLen = txCache->size;
+  uint16 format  = txCache->info.format;
+
+  /* to keep things simple, we save the texture data in a zlib uncompressed state. */
+  /* sigh... for those who cannot wait the extra few seconds. changed to keep
+   * texture data in a zlib compressed state. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
+   * option is toggled, the cache will need to be rebuilt.
+   */
+  if (dest && destLen) {
+    /* texture checksum */
+    gzwrite(gzfp, &checksum, 8);
+
+    /* other texture info */
+    gzwrite(gzfp, &(txCache->info.width), 4);
+    gzwrite(gzfp, &(txCache->info.height), 4);
+    gzwrite(gzfp, &format, 2);
+
+    gzwrite(gzfp, &(txCache->info.smallLodLog2), 4);
+    gzwrite(gzfp, &(txCache->info.largeLodLog2), 4);
+    gzwrite(gzfp, &(txCache->info.aspectRatioLog2), 4);
+
+    gzwrite(gzfp, &(txCache->info.tiles), 4);
+    gzwrite(gzfp, &(txCache->info.untiled_width), 4);
+    gzwrite(gzfp, &(txCache->info.untiled_height), 4);
+
+    gzwrite(gzfp, &(txCache->info.is_hires_tex), 1);
+
+    gzwrite(gzfp, &destLen, 4);
+    gzwrite(gzfp, dest, destLen);
+  }
+}
+
 boolean
 TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 {
+  SDL_LockMutex(_mutex);
+
   if (!_cache.empty()) {
     /* dump cache to disk */
-    char cbuf[MAX_PATH];
-
     boost::filesystem::wpath cachepath(path);
     boost::filesystem::create_directory(cachepath);
 
-    /* Ugly hack to enable fopen/gzopen in Win9x */
-#ifdef BOOST_WINDOWS_API
-    wchar_t curpath[MAX_PATH];
-    GETCWD(MAX_PATH, curpath);
-    CHDIR(cachepath.wstring().c_str());
-#else
-    char curpath[MAX_PATH];
-    wcstombs(cbuf, cachepath.wstring().c_str(), MAX_PATH);
-    if (GETCWD(MAX_PATH, curpath) == NULL)
-        ERRLOG("Error while retrieving working directory!");
-    if (CHDIR(cbuf) != 0)
-        ERRLOG("Error while changing current directory to '%s'!", cbuf);
-#endif
-
-    wcstombs(cbuf, filename, MAX_PATH);
+    /* open it by its full name, changing the working directory is not
+     * an option while the hires cache may be built on another thread */
+    std::string cachefile = (cachepath / boost::filesystem::wpath(filename)).string();
 
-    gzFile gzfp = gzopen(cbuf, "wb1");
+    gzFile gzfp = gzopen(cachefile.c_str(), "wb1");
     DBG_INFO(80, L"gzfp:%x file:%ls\n", gzfp, filename);
     if (gzfp) {
       /* write header to determine config match */
@@ -264,49 +304,7 @@ TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 
       std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
       while (itMap != _cache.end()) {
-        uint8 *dest    = (*itMap).second->info.data;
-        uint32 destLen = (*itMap).second->size;
-        uint16 format  = (*itMap).second->info.format;
-
-        /* to keep things simple, we save the texture data in a zlib uncompressed state. */
-        /* sigh... for those who cannot wait the extra few seconds. changed to keep
-         * texture data in a zlib compressed state. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
-         * option is toggled, the cache will need to be rebuilt.
-         */
-        /*if (format & GR_TEXFMT_GZ) {
-          dest = _gzdest0;
-          destLen = _gzdestLen;
-          if (dest && destLen) {
-            if (uncompress(dest, &destLen, (*itMap).second->info.data, (*itMap).second->size) != Z_OK) {
-              dest = NULL;
-              destLen = 0;
-            }
-            format &= ~GR_TEXFMT_GZ;
-          }
-        }*/
-
-        if (dest && destLen) {
-          /* texture checksum */
-          gzwrite(gzfp, &((*itMap).first), 8);
-
-          /* other texture info */
-          gzwrite(gzfp, &((*itMap).second->info.width), 4);
-          gzwrite(gzfp, &((*itMap).second->info.height), 4);
-          gzwrite(gzfp, &format, 2);
-
-          gzwrite(gzfp, &((*itMap).second->info.smallLodLog2), 4);
-          gzwrite(gzfp, &((*itMap).second->info.largeLodLog2), 4);
-          gzwrite(gzfp, &((*itMap).second->info.aspectRatioLog2), 4);
-
-          gzwrite(gzfp, &((*itMap).second->info.tiles), 4);
-          gzwrite(gzfp, &((*itMap).second->info.untiled_width), 4);
-          gzwrite(gzfp, &((*itMap).second->info.untiled_height), 4);
-
-          gzwrite(gzfp, &((*itMap).second->info.is_hires_tex), 1);
-
-          gzwrite(gzfp, &destLen, 4);
-          gzwrite(gzfp, dest, destLen);
-        }
+        saveEntry(gzfp, (*itMap).first, (*itMap).second);
 
         itMap++;
 
@@ -316,38 +314,24 @@ TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
       }
       gzclose(gzfp);
     }
-
-    if (CHDIR(curpath) != 0)
-        ERRLOG("Error while changing current directory back to original path of '%s'!", curpath);
   }
 
-  return _cache.empty();
+  boolean ret = _cache.empty();
+  SDL_UnlockMutex(_mutex);
+
+  return ret;
 }
 
 boolean
 TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
 {
   /* find it on disk */
-  char cbuf[MAX_PATH];
-
   boost::filesystem::wpath cachepath(path);
+  std::string cachefile = (cachepath / boost::filesystem::wpath(filename)).string();
 
-#ifdef BOOST_WINDOWS_API
-  wchar_t curpath[MAX_PATH];
-  GETCWD(MAX_PATH, curpath);
-  CHDIR(cachepath.wstring().c_str());
-#else
-  char curpath[MAX_PATH];
-  wcstombs(cbuf, cachepath.wstring().c_str(), MAX_PATH);
-  if (GETCWD(MAX_PATH, curpath) == NULL)
-      ERRLOG("Error while retrieving working directory!");
-  if (CHDIR(cbuf) != 0)
-      ERRLOG("Error while changing current directory to '%s'!", cbuf);
-#endif
-
-  wcstombs(cbuf, filename, MAX_PATH);
+  SDL_LockMutex(_mutex);
 
-  gzFile gzfp = gzopen(cbuf, "rb");
+  gzFile gzfp = gzopen(cachefile.c_str(), "rb");
   DBG_INFO(80, L"gzfp:%x file:%ls\n", gzfp, filename);
   if (gzfp) {
     /* yep, we have it. load it into memory cache. */
@@ -485,16 +469,18 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
     }
   }
 
-  if (CHDIR(curpath) != 0)
-      ERRLOG("Error while changing current directory back to original path of '%s'!", curpath);
+  boolean ret = !_cache.empty();
+  SDL_UnlockMutex(_mutex);
 
-  return !_cache.empty();
+  return ret;
 }
 
 boolean
 TxCache::del(uint64 checksum)
 {
-  if (!checksum || _cache.empty()) return 0;
+  if (!checksum) return 0;
+
+  SDL_LockMutex(_mutex);
 
   std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
   if (itMap != _cache.end()) {
@@ -510,24 +496,29 @@ TxCache::del(uint64 checksum)
 
     DBG_INFO(80, L"removed from cache: checksum = %08X %08X\n", (uint32)(checksum & 0xffffffff), (uint32)(checksum >> 32));
 
+    SDL_UnlockMutex(_mutex);
     return 1;
   }
 
+  SDL_UnlockMutex(_mutex);
   return 0;
 }
 
 boolean
 TxCache::is_cached(uint64 checksum)
 {
-  std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
-  if (itMap != _cache.end()) return 1;
+  SDL_LockMutex(_mutex);
+  boolean ret = (_cache.find(checksum) != _cache.end());
+  SDL_UnlockMutex(_mutex);
 
-  return 0;
+  return ret;
 }
 
 void
 TxCache::clear()
 {
+  SDL_LockMutex(_mutex);
+
   if (!_cache.empty()) {
     std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
     while (itMap != _cache.end()) {
@@ -541,4 +532,6 @@ TxCache::clear()
   if (!_cachelist.empty()) _cachelist.clear();
 
   _totalSize = 0;
+
+  SDL_UnlockMutex(_mutex);
 }
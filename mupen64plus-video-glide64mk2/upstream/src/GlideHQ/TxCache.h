@@ -29,6 +29,9 @@
 #include <list>
 #include <map>
 #include <string>
+#include <zlib.h>
+
+struct SDL_mutex;
 
 class TxCache
 {
@@ -52,6 +55,10 @@ protected:
   int _totalSize;
   int _cacheSize;
   std::map<uint64, TXCACHE*> _cache;
+  /* guards _cache, _cachelist and the zlib buffers, the hires cache is
+   * filled on a worker thread while the renderer looks textures up */
+  SDL_mutex *_mutex;
+  static void saveEntry(gzFile gzfp, uint64 checksum, const TXCACHE *txCache);
   boolean save(const wchar_t *path, const wchar_t *filename, const int config);
   boolean load(const wchar_t *path, const wchar_t *filename, const int config);
   boolean del(uint64 checksum); /* checksum hi:palette low:texture */
@@ -55,23 +55,21 @@
 #include <zlib.h>
 #include <string>
 #include <SDL.h>
+#ifndef NO_FILTER_THREAD
+#include <SDL_thread.h>
+#endif
 #include "TxHiResCache.h"
 #include "TxDbg.h"
+#include "../Glide64/m64p.h"
 #include "../Glide64/Gfx_1.3.h"
 
+#define HIRESCACHE_CONFIG (HIRESTEXTURES_MASK|COMPRESS_HIRESTEX|COMPRESSION_MASK|TILE_HIRESTEX|FORCE16BPP_HIRESTEX|GZ_HIRESTEXCACHE|LET_TEXARTISTS_FLY)
+
 TxHiResCache::~TxHiResCache()
 {
-#ifdef DUMP_CACHE
-  if ((_options & DUMP_HIRESTEXCACHE) && !_haveCache && !_abortLoad) {
-    /* dump cache to disk */
-    std::wstring filename = _ident + L"_HIRESTEXTURES.dat";
-    boost::filesystem::wpath cachepath(_cachepath);
-    cachepath /= boost::filesystem::wpath(L"glidehq");
-    int config = _options & (HIRESTEXTURES_MASK|COMPRESS_HIRESTEX|COMPRESSION_MASK|TILE_HIRESTEX|FORCE16BPP_HIRESTEX|GZ_HIRESTEXCACHE|LET_TEXARTISTS_FLY);
-
-    TxCache::save(cachepath.wstring().c_str(), filename.c_str(), config);
-  }
-#endif
+  /* a half built cache is of no use to anyone */
+  _abortLoad = 1;
+  stopBuild();
 
   delete _txImage;
   delete _txQuantize;
@@ -92,6 +90,19 @@ TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
   _maxbpp    = maxbpp;
   _abortLoad = 0;
   _haveCache = 0;
+  _loading   = 0;
+  _replace   = 0;
+  _readDump  = 0;
+  _loadThread = NULL;
+#ifdef DUMP_CACHE
+  _dumpfp    = NULL;
+#endif
+
+#if !defined(NO_FILTER_THREAD)
+  /* the callback draws on screen, it must not be called from the worker.
+   * progress goes to the log instead. */
+  _callback = NULL;
+#endif
 
   /* assert local options */
   if (!(_options & COMPRESS_HIRESTEX))
@@ -102,33 +113,75 @@ TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
     return;
   }
 
-#ifdef DUMP_CACHE
-  /* read in hires texture cache */
-  if (_options & DUMP_HIRESTEXCACHE) {
-    /* find it on disk */
-    std::wstring filename = _ident + L"_HIRESTEXTURES.dat";
-    boost::filesystem::wpath cachepath(_cachepath);
-    cachepath /= boost::filesystem::wpath(L"glidehq");
-    int config = _options & (HIRESTEXTURES_MASK|COMPRESS_HIRESTEX|COMPRESSION_MASK|TILE_HIRESTEX|FORCE16BPP_HIRESTEX|GZ_HIRESTEXCACHE|LET_TEXARTISTS_FLY);
+  /* read in hires texture cache or hires textures in the background,
+   * textures show up as soon as they are added */
+  startBuild(0, 1);
+}
 
-    _haveCache = TxCache::load(cachepath.wstring().c_str(), filename.c_str(), config);
-  }
+int
+TxHiResCache::BuildThreadFunc(void *pCache)
+{
+  ((TxHiResCache *)pCache)->build();
+  return 0;
+}
+
+void
+TxHiResCache::startBuild(boolean replace, boolean readDump)
+{
+  _replace = replace;
+  _readDump = readDump;
+  _loading = 1;
+
+#if !defined(NO_FILTER_THREAD)
+#if SDL_VERSION_ATLEAST(2,0,0)
+  _loadThread = SDL_CreateThread(BuildThreadFunc, "hirestex", this);
+#else
+  _loadThread = SDL_CreateThread(BuildThreadFunc, this);
+#endif
+  if (_loadThread) return;
 #endif
 
-  /* read in hires textures */
-  if (!_haveCache) TxHiResCache::load(0);
+  build();
 }
 
-boolean
-TxHiResCache::empty()
+void
+TxHiResCache::stopBuild()
 {
-  return _cache.empty();
+  if (_loadThread) {
+    SDL_WaitThread(_loadThread, NULL);
+    _loadThread = NULL;
+  }
 }
 
-boolean
-TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial */
+void
+TxHiResCache::build()
 {
-  if (!_datapath.empty() && !_ident.empty()) {
+  uint32_t start = SDL_GetTicks();
+  boolean replace = _replace;
+
+#ifdef DUMP_CACHE
+  std::wstring filename = _ident + L"_HIRESTEXTURES.dat";
+  boost::filesystem::wpath cachepath(_cachepath);
+  cachepath /= boost::filesystem::wpath(L"glidehq");
+  boost::filesystem::wpath dumpfile = cachepath / boost::filesystem::wpath(filename);
+  boost::filesystem::wpath tmpfile = cachepath / boost::filesystem::wpath(filename + L".tmp");
+  int config = _options & HIRESCACHE_CONFIG;
+
+  /* read in hires texture cache */
+  if (_readDump && (_options & DUMP_HIRESTEXCACHE))
+    _haveCache = TxCache::load(cachepath.wstring().c_str(), filename.c_str(), config);
+
+  /* no usable dump, write entries to a temporary file while the textures
+   * load and only give it the real name once the whole pack is in */
+  if (!_haveCache && !replace && (_options & DUMP_HIRESTEXCACHE)) {
+    boost::filesystem::create_directory(cachepath);
+    _dumpfp = gzopen(tmpfile.string().c_str(), "wb1");
+    if (_dumpfp) gzwrite(_dumpfp, &config, 4);
+  }
+#endif
+
+  /* read in hires textures */
+  if (!_haveCache && !_datapath.empty() && !_ident.empty()) {
 
     if (!replace) TxCache::clear();
 
@@ -156,6 +209,58 @@ TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial */
     case JABO_HIRESTEXTURES:
       ;
     }
+  }
+
+#ifdef DUMP_CACHE
+  if (_dumpfp) {
+    gzclose(_dumpfp);
+    _dumpfp = NULL;
+    boost::system::error_code ec;
+    SDL_LockMutex(_mutex);
+    boolean nothing = _cache.empty();
+    SDL_UnlockMutex(_mutex);
+    if (_abortLoad || nothing)
+      boost::filesystem::remove(tmpfile, ec);
+    else
+      boost::filesystem::rename(tmpfile, dumpfile, ec);
+  }
+#endif
+
+  if (!_abortLoad) {
+    SDL_LockMutex(_mutex);
+    WriteLog(M64MSG_INFO, "%d hires textures ready, total mem:%.2fmb (%d ms)",
+             (int)_cache.size(), (float)_totalSize/1000000, (int)(SDL_GetTicks() - start));
+    SDL_UnlockMutex(_mutex);
+  }
+
+  _loading = 0;
+}
+
+boolean
+TxHiResCache::empty()
+{
+  /* still loading, textures may show up any moment */
+  if (_loading) return 0;
+
+  SDL_LockMutex(_mutex);
+  boolean ret = _cache.empty();
+  SDL_UnlockMutex(_mutex);
+
+  return ret;
+}
+
+boolean
+TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial */
+{
+  if (!_datapath.empty() && !_ident.empty()) {
+
+    /* finish or abandon the build that is still running */
+    _abortLoad = 1;
+    stopBuild();
+    _abortLoad = 0;
+    _haveCache = 0;
+
+    startBuild(replace, 0);
 
     return 1;
   }
@@ -177,31 +282,9 @@ TxHiResCache::loadHiResTextures(boost::filesystem::wpath dir_path, boolean repla
     return 0;
   }
 
-  /* XXX: deal with UNICODE fiasco!
-   * stupidity flows forth beneath this...
-   *
-   * I opted to use chdir in order to use fopen() for windows 9x.
-   */
-#ifdef _WIN32
-  wchar_t curpath[MAX_PATH];
-  GETCWD(MAX_PATH, curpath);
-  CHDIR(dir_path.wstring().c_str());
-#else
-  char curpath[MAX_PATH];
-  char cbuf[MAX_PATH];
-  wcstombs(cbuf, dir_path.wstring().c_str(), MAX_PATH);
-  if (GETCWD(MAX_PATH, curpath) == NULL)
-      ERRLOG("Error while retrieving working directory!");
-  if (CHDIR(cbuf) != 0)
-      ERRLOG("Error while changing current directory to '%s'!", cbuf);
-#endif
-
-  /* NOTE: I could use the boost::wdirectory_iterator and boost::wpath
-   * to resolve UNICODE file names and paths. But then, _wfopen() is
-   * required to get the file descriptor for MS Windows to pass into
-   * libpng, which is incompatible with Win9x. Win9x's fopen() cannot
-   * handle UNICODE names. UNICODE capable boost::filesystem is available
-   * with Boost1.34.1 built with VC8.0 (bjam --toolset=msvc-8.0 stage).
+  /* files are opened by their full path below. this used to chdir into
+   * the directory instead, which is not an option now that the pack is
+   * read on a worker thread: the working directory is process wide.
    *
    * RULE OF THUMB: NEVER save texture packs in NON-ASCII names!!
    */
@@ -349,9 +432,9 @@ TxHiResCache::loadHiResTextures(boost::filesystem::wpath dir_path, boolean repla
      */
     if (pfname == strstr(fname, "_rgb.") || pfname == strstr(fname, "_a.")) {
       strcpy(pfname, "_rgb.png");
-      if (!boost::filesystem::exists(fname)) {
+      if (!boost::filesystem::exists(dir_path / fname)) {
         strcpy(pfname, "_rgb.bmp");
-        if (!boost::filesystem::exists(fname)) {
+        if (!boost::filesystem::exists(dir_path / fname)) {
 #if !DEBUG
           INFO(80, L"-----\n");
           INFO(80, L"path: %ls\n", dir_path.string().c_str());
@@ -363,28 +446,28 @@ TxHiResCache::loadHiResTextures(boost::filesystem::wpath dir_path, boolean repla
       }
       /* _a.png */
       strcpy(pfname, "_a.png");
-      if ((fp = fopen(fname, "rb")) != NULL) {
+      if ((fp = fopen((dir_path / fname).string().c_str(), "rb")) != NULL) {
         tmptex = _txImage->readPNG(fp, &tmpwidth, &tmpheight, &tmpformat);
         fclose(fp);
       }
       if (!tmptex) {
         /* _a.bmp */
         strcpy(pfname, "_a.bmp");
-        if ((fp = fopen(fname, "rb")) != NULL) {
+        if ((fp = fopen((dir_path / fname).string().c_str(), "rb")) != NULL) {
           tmptex = _txImage->readBMP(fp, &tmpwidth, &tmpheight, &tmpformat);
           fclose(fp);
         }
       }
       /* _rgb.png */
       strcpy(pfname, "_rgb.png");
-      if ((fp = fopen(fname, "rb")) != NULL) {
+      if ((fp = fopen((dir_path / fname).string().c_str(), "rb")) != NULL) {
         tex = _txImage->readPNG(fp, &width, &height, &format);
         fclose(fp);
       }
       if (!tex) {
         /* _rgb.bmp */
         strcpy(pfname, "_rgb.bmp");
-        if ((fp = fopen(fname, "rb")) != NULL) {
+        if ((fp = fopen((dir_path / fname).string().c_str(), "rb")) != NULL) {
           tex = _txImage->readBMP(fp, &width, &height, &format);
           fclose(fp);
         }
@@ -477,7 +560,7 @@ TxHiResCache::loadHiResTextures(boost::filesystem::wpath dir_path, boolean repla
         pfname == strstr(fname, "_ciByRGBA.dds") ||
 #endif
         pfname == strstr(fname, "_ci.bmp")) {
-      if ((fp = fopen(fname, "rb")) != NULL) {
+      if ((fp = fopen((dir_path / fname).string().c_str(), "rb")) != NULL) {
         if      (strstr(fname, ".png")) tex = _txImage->readPNG(fp, &width, &height, &format);
         else if (strstr(fname, ".dds")) tex = _txImage->readDDS(fp, &width, &height, &format);
         else                            tex = _txImage->readBMP(fp, &width, &height, &format);
@@ -1061,28 +1144,54 @@ TxHiResCache::loadHiResTextures(boost::filesystem::wpath dir_path, boolean repla
         DBG_INFO(80, L"removed duplicate old cache.\n");
       }
 
+      /* zlib compress it here rather than in TxCache::add, whose
+       * buffers are shared with the renderer's texture filter. */
+      int dataSize = 0;
+      uint8 *gztex = NULL;
+      if (_options & GZ_HIRESTEXCACHE) {
+        uLong texSize = _txUtil->sizeofTx(width, height, format);
+        uLongf destLen = compressBound(texSize);
+        gztex = (uint8*)malloc(destLen);
+        if (gztex && compress2(gztex, &destLen, tex, texSize, 1) == Z_OK) {
+          tmpInfo.data = gztex;
+          tmpInfo.format |= GR_TEXFMT_GZ;
+          dataSize = destLen;
+        }
+      }
+
       /* add to cache */
-      if (TxCache::add(chksum64, &tmpInfo)) {
+      if (TxCache::add(chksum64, &tmpInfo, dataSize)) {
         now = SDL_GetTicks();
         diff = now - last;
 
+#ifdef DUMP_CACHE
+        if (_dumpfp) {
+          SDL_LockMutex(_mutex);
+          std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(chksum64);
+          if (itMap != _cache.end()) saveEntry(_dumpfp, chksum64, (*itMap).second);
+          SDL_UnlockMutex(_mutex);
+        }
+#endif
+
         /* Callback to display hires texture info.
          * Gonetz <gonetz(at)ngs.ru> */
-        if (_callback && diff > 250) {
-          wchar_t tmpbuf[MAX_PATH];
-          mbstowcs(tmpbuf, fname, MAX_PATH);
-          (*_callback)(L"[%d] total mem:%.2fmb - %ls\n", _cache.size(), (float)_totalSize/1000000, tmpbuf);
+        if (diff > 250) {
+          if (_callback) {
+            wchar_t tmpbuf[MAX_PATH];
+            mbstowcs(tmpbuf, fname, MAX_PATH);
+            (*_callback)(L"[%d] total mem:%.2fmb - %ls\n", _cache.size(), (float)_totalSize/1000000, tmpbuf);
+          } else {
+            WriteLog(M64MSG_VERBOSE, "[%d] hires textures loaded, total mem:%.2fmb", (int)_cache.size(), (float)_totalSize/1000000);
+          }
           last = now;
         }
         DBG_INFO(80, L"texture loaded!\n");
       }
+      free(gztex);
       free(tex);
     }
 
   }
 
-  if (CHDIR(curpath) != 0)
-      ERRLOG("Error while changing current directory back to original path of '%s'!", curpath);
-
   return 1;
 }
@@ -36,6 +36,8 @@
 #include "TxReSample.h"
 #include <boost/filesystem.hpp>
 
+struct SDL_Thread;
+
 class TxHiResCache : public TxCache
 {
 private:
@@ -43,11 +45,22 @@ private:
   int _maxheight;
   int _maxbpp;
   boolean _haveCache;
-  boolean _abortLoad;
+  volatile boolean _abortLoad;
+  volatile boolean _loading;  /* a build is running, empty() can't tell yet */
+  boolean _replace;           /* arguments of the build the worker runs */
+  boolean _readDump;
+  SDL_Thread *_loadThread;
+#ifdef DUMP_CACHE
+  gzFile _dumpfp;             /* entries are appended as they get loaded */
+#endif
   TxImage *_txImage;
   TxQuantize *_txQuantize;
   TxReSample *_txReSample;
   boolean loadHiResTextures(boost::filesystem::wpath dir_path, boolean replace);
+  void build();
+  void startBuild(boolean replace, boolean readDump);
+  void stopBuild();
+  static int BuildThreadFunc(void *pCache);
 public:
   ~TxHiResCache();
   TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
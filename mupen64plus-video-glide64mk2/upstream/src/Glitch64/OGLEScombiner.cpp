@@ -24,10 +24,12 @@
 #include <string.h>
 #include <stdlib.h>
 #endif // _WIN32
+#include <ctype.h>
 #include <math.h>
 #include <stdio.h>
 #include "glide.h"
 #include "glitchmain.h"
+#include "m64p.h"
 
 #include "../Glide64/winlnxdefs.h"
 #include "../Glide64/rdp.h" // for settings
@@ -306,6 +308,8 @@ void set_rotation_matrix(GLuint loc, int rotate)
     glUniformMatrix4fv(loc, 1, GL_FALSE, mat);
 }
 
+static void load_program_cache();
+
 void init_combiner()
 {
   int texture[4] = {0, 0, 0, 0};
@@ -431,6 +435,8 @@ void init_combiner()
   dither_enabled = 0;
   blackandwhite0 = 0;
   blackandwhite1 = 0;
+
+  load_program_cache();
 }
 
 void compile_chroma_shader()
@@ -471,6 +477,23 @@ void compile_chroma_shader()
   strcat(fragment_shader_chroma, "}");
 }
 
+//Everything update_uniforms() hands to a program, kept per program so an
+//unchanged combiner neither flushes the vertex buffer nor touches GL
+typedef struct _shader_uniforms
+{
+  float vertexOffset[3];
+  float textureSizes[4];
+  float fogModeEndScale[3];
+  float fogColor[3];
+  float alphaRef;
+  float constant_color[4];
+  float ccolor0[4];
+  float ccolor1[4];
+  float chroma_color[4];
+  float lambda;
+  int rotate;
+} shader_uniforms;
+
 typedef struct _shader_program_key
 {
   int color_combiner;
@@ -496,10 +519,253 @@ typedef struct _shader_program_key
   int alphaRef_location;
   int ditherTex_location;
   int chroma_color_location;
+  int constant_color_location;
+  int ccolor0_location;
+  int ccolor1_location;
+  int lambda_location;
+  int uniforms_valid;
+  shader_uniforms uniforms;
+  unsigned long long source_hash; //Of the fragment shader, identifies the program in the program cache
 } shader_program_key;
 
 static shader_program_key* shader_programs = NULL;
 static int number_of_programs = 0;
+static int current_program = -1; //Index of the program in use, -1 for the copy and depth shaders
+
+//Program binaries of the combiners a ROM used in its previous runs, read in
+//at ROM open and written back at ROM close when new programs were compiled.
+//The fragment shader source fully determines a program, so its hash is the
+//key, and the file is thrown away when the driver or vertex shader changes.
+#define PROGRAM_CACHE_MAGIC 0x53343647 //"G64S"
+#define PROGRAM_CACHE_VERSION 1
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+
+typedef struct _cached_program
+{
+  unsigned long long source_hash;
+  GLenum format;
+  GLsizei length;
+  void *binary;
+} cached_program;
+
+static cached_program* cached_programs = NULL;
+static int number_of_cached_programs = 0;
+static int program_cache_dirty = 0;
+static PFNGLGETPROGRAMBINARYOESPROC pglGetProgramBinaryOES = NULL;
+static PFNGLPROGRAMBINARYOESPROC pglProgramBinaryOES = NULL;
+
+static unsigned long long hash_string(const char *s, unsigned long long hash)
+{
+  //FNV-1a
+  for(; s != NULL && *s; s++)
+  {
+    hash ^= (unsigned char)*s;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static unsigned long long program_cache_fingerprint()
+{
+  unsigned long long hash = FNV_OFFSET_BASIS;
+  hash = hash_string((const char*)glGetString(GL_VENDOR), hash);
+  hash = hash_string((const char*)glGetString(GL_RENDERER), hash);
+  hash = hash_string((const char*)glGetString(GL_VERSION), hash);
+  return hash_string(vertex_shader, hash);
+}
+
+static int get_program_cache_path(char *path, size_t size)
+{
+  const char *cache_path = ConfigGetUserCachePath();
+  size_t len, i;
+  char name[sizeof(rdp.RomName)];
+
+  if(cache_path == NULL || rdp.RomName[0] == 0)
+    return 0;
+
+  //ROM names may contain anything
+  strncpy(name, rdp.RomName, sizeof(name));
+  name[sizeof(name)-1] = 0;
+  for(i = 0; name[i]; i++)
+    if(!isalnum((unsigned char)name[i]) && name[i] != '-')
+      name[i] = '_';
+
+  len = strlen(cache_path);
+  if(snprintf(path, size, "%s%sGlide64mk2_%s.shaders", cache_path,
+    (len > 0 && cache_path[len-1] == '/') ? "" : "/", name) >= (int)size)
+    return 0;
+
+  return 1;
+}
+
+static void free_program_cache()
+{
+  int i;
+  for(i=0; i<number_of_cached_programs; i++)
+    free(cached_programs[i].binary);
+  free(cached_programs);
+  cached_programs = NULL;
+  number_of_cached_programs = 0;
+}
+
+static void load_program_cache()
+{
+  const char *extensions = (const char*)glGetString(GL_EXTENSIONS);
+  GLint formats = 0;
+  char path[1024];
+  unsigned int header[2], count, i;
+  unsigned long long fingerprint;
+  FILE *f;
+
+  free_program_cache();
+  program_cache_dirty = 0;
+  pglGetProgramBinaryOES = NULL;
+  pglProgramBinaryOES = NULL;
+
+  if(extensions == NULL || strstr(extensions, "GL_OES_get_program_binary") == NULL)
+    return;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+  if(formats <= 0)
+    return;
+  pglGetProgramBinaryOES = (PFNGLGETPROGRAMBINARYOESPROC)CoreVideo_GL_GetProcAddress("glGetProgramBinaryOES");
+  pglProgramBinaryOES = (PFNGLPROGRAMBINARYOESPROC)CoreVideo_GL_GetProcAddress("glProgramBinaryOES");
+  if(pglGetProgramBinaryOES == NULL || pglProgramBinaryOES == NULL)
+  {
+    pglGetProgramBinaryOES = NULL;
+    pglProgramBinaryOES = NULL;
+    return;
+  }
+
+  if(!get_program_cache_path(path, sizeof(path)) || (f = fopen(path, "rb")) == NULL)
+    return;
+
+  if(fread(header, sizeof(header), 1, f) != 1 || header[0] != PROGRAM_CACHE_MAGIC || header[1] != PROGRAM_CACHE_VERSION ||
+    fread(&fingerprint, sizeof(fingerprint), 1, f) != 1 || fingerprint != program_cache_fingerprint() ||
+    fread(&count, sizeof(count), 1, f) != 1 || count > 0x10000)
+  {
+    fclose(f);
+    return;
+  }
+
+  cached_programs = (cached_program*)calloc(count, sizeof(cached_program));
+  for(i=0; cached_programs != NULL && i<count; i++)
+  {
+    cached_program *prog = &cached_programs[i];
+    unsigned int format, length;
+    if(fread(&prog->source_hash, sizeof(prog->source_hash), 1, f) != 1 ||
+      fread(&format, sizeof(format), 1, f) != 1 || fread(&length, sizeof(length), 1, f) != 1 ||
+      length == 0 || length > 0x1000000 || (prog->binary = malloc(length)) == NULL)
+      break;
+    number_of_cached_programs++;
+    prog->format = format;
+    prog->length = length;
+    if(fread(prog->binary, length, 1, f) != 1)
+    {
+      //drop everything, the file is damaged
+      free_program_cache();
+      break;
+    }
+  }
+  fclose(f);
+}
+
+//Load the binary of the program whose fragment shader hashes to source_hash
+//into program, instead of compiling and linking it
+static int use_cached_program(GLuint program, unsigned long long source_hash)
+{
+  GLint status = GL_FALSE;
+  int i;
+
+  if(pglProgramBinaryOES == NULL)
+    return 0;
+
+  for(i=0; i<number_of_cached_programs; i++)
+  {
+    if(cached_programs[i].source_hash == source_hash)
+    {
+      pglProgramBinaryOES(program, cached_programs[i].format, cached_programs[i].binary, cached_programs[i].length);
+      glGetProgramiv(program, GL_LINK_STATUS, &status);
+      //a driver update keeping the version string rejects binaries
+      return status == GL_TRUE;
+    }
+  }
+  return 0;
+}
+
+static int write_program_binary(FILE *f, unsigned long long source_hash, GLenum format, GLsizei length, const void *binary)
+{
+  unsigned int fmt = format, len = length;
+  return fwrite(&source_hash, sizeof(source_hash), 1, f) == 1 &&
+    fwrite(&fmt, sizeof(fmt), 1, f) == 1 && fwrite(&len, sizeof(len), 1, f) == 1 &&
+    fwrite(binary, length, 1, f) == 1;
+}
+
+static void save_program_cache()
+{
+  const unsigned int header[2] = { PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION };
+  unsigned long long fingerprint;
+  char path[1024];
+  unsigned int count = 0;
+  long count_pos;
+  int i, j, ok;
+  FILE *f;
+
+  if(!program_cache_dirty || pglGetProgramBinaryOES == NULL || !get_program_cache_path(path, sizeof(path)))
+    return;
+  program_cache_dirty = 0;
+
+  if((f = fopen(path, "wb")) == NULL)
+    return;
+
+  fingerprint = program_cache_fingerprint();
+  ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(&fingerprint, sizeof(fingerprint), 1, f) == 1;
+  count_pos = ftell(f);
+  ok = ok && fwrite(&count, sizeof(count), 1, f) == 1;
+
+  //programs of this run
+  for(i=0; ok && i<number_of_programs; i++)
+  {
+    GLint length = 0;
+    GLenum format = 0;
+    void *binary;
+
+    glGetProgramiv(shader_programs[i].program_object, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if(length <= 0 || (binary = malloc(length)) == NULL)
+      continue;
+    pglGetProgramBinaryOES(shader_programs[i].program_object, length, &length, &format, binary);
+    if(length > 0)
+    {
+      ok = write_program_binary(f, shader_programs[i].source_hash, format, length, binary);
+      count++;
+    }
+    free(binary);
+  }
+
+  //and those of previous runs this one did not use
+  for(i=0; ok && i<number_of_cached_programs; i++)
+  {
+    for(j=0; j<number_of_programs; j++)
+      if(shader_programs[j].source_hash == cached_programs[i].source_hash)
+        break;
+    if(j == number_of_programs)
+    {
+      ok = write_program_binary(f, cached_programs[i].source_hash, cached_programs[i].format,
+        cached_programs[i].length, cached_programs[i].binary);
+      count++;
+    }
+  }
+
+  ok = ok && fseek(f, count_pos, SEEK_SET) == 0 && fwrite(&count, sizeof(count), 1, f) == 1;
+  if(fclose(f) != 0 || !ok)
+    remove(path);
+}
+
+//Someone set a uniform of the current program directly
+static void invalidate_uniforms()
+{
+  if(current_program >= 0)
+    shader_programs[current_program].uniforms_valid = 0;
+}
 static int color_combiner_key;
 static int alpha_combiner_key;
 static int texture0_combiner_key;
@@ -507,57 +773,81 @@ static int texture1_combiner_key;
 static int texture0_combinera_key;
 static int texture1_combinera_key;
 
-void update_uniforms(shader_program_key prog)
+void update_uniforms(shader_program_key *prog)
 {
-  glUniform1i(prog.texture0_location, 0);
-  glUniform1i(prog.texture1_location, 1);
+  shader_uniforms u;
+
+  u.vertexOffset[0] = widtho;
+  u.vertexOffset[1] = heighto;
+  u.vertexOffset[2] = inverted_culling ? -1.0f : 1.0f;
+  u.textureSizes[0] = tex0_width;
+  u.textureSizes[1] = tex0_height;
+  u.textureSizes[2] = tex1_width;
+  u.textureSizes[3] = tex1_height;
+  u.fogModeEndScale[0] = fog_enabled != 2 ? 0.0f : 1.0f;
+  u.fogModeEndScale[1] = fogEnd;
+  u.fogModeEndScale[2] = 1.0f / (fogEnd - fogStart);
+  memcpy(u.fogColor, fogColor, sizeof(u.fogColor));
+  u.alphaRef = alpha_test ? alpha_ref/255.0f : -1.0f;
+  memcpy(u.constant_color, texture_env_color, sizeof(u.constant_color));
+  memcpy(u.ccolor0, ccolor0, sizeof(u.ccolor0));
+  memcpy(u.ccolor1, ccolor1, sizeof(u.ccolor1));
+  memcpy(u.chroma_color, chroma_color, sizeof(u.chroma_color));
+  u.lambda = lambda;
+  u.rotate = settings.rotate;
+
+  constant_color_location = prog->constant_color_location;
+  ccolor0_location = prog->ccolor0_location;
+  ccolor1_location = prog->ccolor1_location;
+
+  if(prog->uniforms_valid && !memcmp(&u, &prog->uniforms, sizeof(u)))
+    return;
 
-  glUniform3f(prog.vertexOffset_location,widtho,heighto,inverted_culling ? -1.0f : 1.0f);
-  glUniform4f(prog.textureSizes_location,tex0_width,tex0_height,tex1_width,tex1_height);
+  vbo_draw();
+
+  glUniform1i(prog->texture0_location, 0);
+  glUniform1i(prog->texture1_location, 1);
 
-  glUniform3f(prog.fogModeEndScale_location,
-    fog_enabled != 2 ? 0.0f : 1.0f,
-    fogEnd,
-    1.0f / (fogEnd - fogStart)
-    );
+  glUniform3f(prog->vertexOffset_location,u.vertexOffset[0],u.vertexOffset[1],u.vertexOffset[2]);
+  glUniform4f(prog->textureSizes_location,u.textureSizes[0],u.textureSizes[1],u.textureSizes[2],u.textureSizes[3]);
 
-  if(prog.fogColor_location != -1)
+  glUniform3f(prog->fogModeEndScale_location,u.fogModeEndScale[0],u.fogModeEndScale[1],u.fogModeEndScale[2]);
+
+  if(prog->fogColor_location != -1)
     {
-    glUniform3f(prog.fogColor_location,fogColor[0],fogColor[1],fogColor[2]);
+    glUniform3f(prog->fogColor_location,fogColor[0],fogColor[1],fogColor[2]);
   }
 
-  glUniform1f(prog.alphaRef_location,alpha_test ? alpha_ref/255.0f : -1.0f);
+  glUniform1f(prog->alphaRef_location,u.alphaRef);
 
-  constant_color_location = glGetUniformLocation(program_object, "constant_color");
   glUniform4f(constant_color_location, texture_env_color[0], texture_env_color[1],
         texture_env_color[2], texture_env_color[3]);
 
-  ccolor0_location = glGetUniformLocation(program_object, "ccolor0");
   glUniform4f(ccolor0_location, ccolor0[0], ccolor0[1], ccolor0[2], ccolor0[3]);
 
-  ccolor1_location = glGetUniformLocation(program_object, "ccolor1");
   glUniform4f(ccolor1_location, ccolor1[0], ccolor1[1], ccolor1[2], ccolor1[3]);
 
-  glUniform4f(prog.chroma_color_location, chroma_color[0], chroma_color[1],
+  glUniform4f(prog->chroma_color_location, chroma_color[0], chroma_color[1],
         chroma_color[2], chroma_color[3]);
 
       if(dither_enabled)
       {
-    glUniform1i(prog.ditherTex_location, 2);
+    glUniform1i(prog->ditherTex_location, 2);
       }
 
-  rotation_matrix_location = glGetUniformLocation(program_object, "rotation_matrix");
-  set_rotation_matrix(rotation_matrix_location, settings.rotate);
-  rotation_matrix_location = glGetUniformLocation(program_object, "rotation_matrix");
-  set_rotation_matrix(rotation_matrix_location, settings.rotate);
+  set_rotation_matrix(prog->rotation_matrix_location, settings.rotate);
+
+  glUniform1f(prog->lambda_location, lambda);
 
-      set_lambda();
+  prog->uniforms = u;
+  prog->uniforms_valid = 1;
 }
 
 void disable_textureSizes() 
 {
   int textureSizes_location = glGetUniformLocation(program_object_default,"textureSizes");
   glUniform4f(textureSizes_location,1,1,1,1);
+  invalidate_uniforms();
 }
 
 void compile_shader()
@@ -577,21 +867,22 @@ void compile_shader()
 
   for(i=0; i<number_of_programs; i++)
   {
-    shader_program_key prog = shader_programs[i];
-    if(prog.color_combiner == color_combiner_key &&
-      prog.alpha_combiner == alpha_combiner_key &&
-      prog.texture0_combiner == texture0_combiner_key &&
-      prog.texture1_combiner == texture1_combiner_key &&
-      prog.texture0_combinera == texture0_combinera_key &&
-      prog.texture1_combinera == texture1_combinera_key &&
-      prog.fog_enabled == fog_enabled &&
-      prog.chroma_enabled == chroma_enabled &&
-      prog.dither_enabled == dither_enabled &&
-      prog.blackandwhite0 == blackandwhite0 &&
-      prog.blackandwhite1 == blackandwhite1)
+    shader_program_key *prog = &shader_programs[i];
+    if(prog->color_combiner == color_combiner_key &&
+      prog->alpha_combiner == alpha_combiner_key &&
+      prog->texture0_combiner == texture0_combiner_key &&
+      prog->texture1_combiner == texture1_combiner_key &&
+      prog->texture0_combinera == texture0_combinera_key &&
+      prog->texture1_combinera == texture1_combinera_key &&
+      prog->fog_enabled == fog_enabled &&
+      prog->chroma_enabled == chroma_enabled &&
+      prog->dither_enabled == dither_enabled &&
+      prog->blackandwhite0 == blackandwhite0 &&
+      prog->blackandwhite1 == blackandwhite1)
     {
       program_object = shader_programs[i].program_object;
       glUseProgram(program_object);
+      current_program = i;
       update_uniforms(prog);
       return;
     }
@@ -643,26 +934,33 @@ void compile_shader()
   strcat(fragment_shader, fragment_shader_end);
   if(chroma_enabled) strcat(fragment_shader, fragment_shader_chroma);
 
-  shader_programs[number_of_programs].fragment_shader_object = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(shader_programs[number_of_programs].fragment_shader_object, 1, (const GLchar**)&fragment_shader, NULL);
-
-  glCompileShader(shader_programs[number_of_programs].fragment_shader_object);
-  check_compile(shader_programs[number_of_programs].fragment_shader_object);
-
   program_object = glCreateProgram();
   shader_programs[number_of_programs].program_object = program_object;
+  shader_programs[number_of_programs].fragment_shader_object = 0;
+  shader_programs[number_of_programs].source_hash = hash_string(fragment_shader, FNV_OFFSET_BASIS);
 
-  glBindAttribLocation(program_object,POSITION_ATTR,"aPosition");
-  glBindAttribLocation(program_object,COLOUR_ATTR,"aColor");
-  glBindAttribLocation(program_object,TEXCOORD_0_ATTR,"aMultiTexCoord0");
-  glBindAttribLocation(program_object,TEXCOORD_1_ATTR,"aMultiTexCoord1");
-  glBindAttribLocation(program_object,FOG_ATTR,"aFog");
+  if(!use_cached_program(program_object, shader_programs[number_of_programs].source_hash))
+  {
+    shader_programs[number_of_programs].fragment_shader_object = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(shader_programs[number_of_programs].fragment_shader_object, 1, (const GLchar**)&fragment_shader, NULL);
 
-  glAttachShader(program_object, shader_programs[number_of_programs].fragment_shader_object);
-  glAttachShader(program_object, vertex_shader_object);
+    glCompileShader(shader_programs[number_of_programs].fragment_shader_object);
+    check_compile(shader_programs[number_of_programs].fragment_shader_object);
 
-  glLinkProgram(program_object);
-  check_link(program_object);
+    glBindAttribLocation(program_object,POSITION_ATTR,"aPosition");
+    glBindAttribLocation(program_object,COLOUR_ATTR,"aColor");
+    glBindAttribLocation(program_object,TEXCOORD_0_ATTR,"aMultiTexCoord0");
+    glBindAttribLocation(program_object,TEXCOORD_1_ATTR,"aMultiTexCoord1");
+    glBindAttribLocation(program_object,FOG_ATTR,"aFog");
+
+    glAttachShader(program_object, shader_programs[number_of_programs].fragment_shader_object);
+    glAttachShader(program_object, vertex_shader_object);
+
+    glLinkProgram(program_object);
+    check_link(program_object);
+    program_cache_dirty = 1;
+  }
+  free(fragment_shader);
   glUseProgram(program_object);
 
   shader_programs[number_of_programs].rotation_matrix_location = glGetUniformLocation(program_object, "rotation_matrix");
@@ -674,17 +972,27 @@ void compile_shader()
   shader_programs[number_of_programs].fogColor_location = glGetUniformLocation(program_object, "fogColor");
   shader_programs[number_of_programs].alphaRef_location = glGetUniformLocation(program_object, "alphaRef");
   shader_programs[number_of_programs].chroma_color_location = glGetUniformLocation(program_object, "chroma_color");
+  shader_programs[number_of_programs].ditherTex_location = glGetUniformLocation(program_object, "ditherTex");
+  shader_programs[number_of_programs].constant_color_location = glGetUniformLocation(program_object, "constant_color");
+  shader_programs[number_of_programs].ccolor0_location = glGetUniformLocation(program_object, "ccolor0");
+  shader_programs[number_of_programs].ccolor1_location = glGetUniformLocation(program_object, "ccolor1");
+  shader_programs[number_of_programs].lambda_location = glGetUniformLocation(program_object, "lambda");
+  shader_programs[number_of_programs].uniforms_valid = 0;
+  current_program = number_of_programs;
 
-  update_uniforms(shader_programs[number_of_programs]);
+  update_uniforms(&shader_programs[number_of_programs]);
 
   number_of_programs++;
 }
 
 void free_combiners()
 {
+  save_program_cache();
+  free_program_cache();
   free(shader_programs);
   shader_programs = NULL;
   number_of_programs = 0;
+  current_program = -1;
 }
 
 void set_copy_shader()
@@ -693,6 +1001,7 @@ void set_copy_shader()
   int alphaRef_location;
 
   glUseProgram(program_object_default);
+  current_program = -1;
   texture0_location = glGetUniformLocation(program_object_default, "texture0");
   glUniform1i(texture0_location, 0);
 
@@ -707,6 +1016,7 @@ void set_depth_shader()
   int alphaRef_location;
 
   glUseProgram(program_object_depth);
+  current_program = -1;
   texture0_location = glGetUniformLocation(program_object_depth, "texture0");
   glUniform1i(texture0_location, 0);
 
@@ -718,7 +1028,9 @@ void set_depth_shader()
 void set_lambda()
 {
   int lambda_location = glGetUniformLocation(program_object, "lambda");
+  vbo_draw();
   glUniform1f(lambda_location, lambda);
+  invalidate_uniforms();
 }
 
 FX_ENTRY void FX_CALL 
@@ -748,6 +1060,7 @@ grConstantColorValue( GrColor_t value )
   constant_color_location = glGetUniformLocation(program_object, "constant_color");
   glUniform4f(constant_color_location, texture_env_color[0], texture_env_color[1], 
     texture_env_color[2], texture_env_color[3]);
+  invalidate_uniforms();
 }
 
 void writeGLSLColorOther(int other)
@@ -1770,6 +2083,7 @@ grChromakeyValue( GrColor_t value )
   chroma_color_location = glGetUniformLocation(program_object, "chroma_color");
   glUniform4f(chroma_color_location, chroma_color[0], chroma_color[1],
     chroma_color[2], chroma_color[3]);
+  invalidate_uniforms();
 }
 
 static void setPattern()
@@ -2884,4 +3198,5 @@ grConstantColorValueExt(GrChipID_t    tmu,
     ccolor1_location = glGetUniformLocation(program_object, "ccolor1");
     glUniform4f(ccolor1_location, ccolor1[0], ccolor1[1], ccolor1[2], ccolor1[3]);
   }
+  invalidate_uniforms();
 }
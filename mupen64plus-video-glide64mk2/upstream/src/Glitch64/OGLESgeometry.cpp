@@ -56,9 +56,18 @@ static int vertex_buffer_count = 0;
 static GLenum vertex_draw_mode;
 static bool vertex_buffer_enabled = false;
 
+cached_gl_state gl_cache;
+
+void cache_reset()
+{
+  memset(&gl_cache, 0xFF, sizeof(gl_cache));
+}
+
 void vbo_init()
 {
-  
+  //Fresh context, nothing is buffered and no attribute array is set up yet
+  vertex_buffer_count = 0;
+  vertex_buffer_enabled = false;
 }
 
 void vbo_draw()
@@ -71,27 +80,58 @@ void vbo_draw()
 }
 
 //Buffer vertices instead of glDrawArrays(...)
+//Fans and strips are unrolled into separate triangles so they join the same
+//batch as everything else, the buffer is only drawn when the GL state changes.
 void vbo_buffer(GLenum mode,GLint first,GLsizei count,void* pointers)
 {
-  if((count != 3 && mode != GL_TRIANGLES) || vertex_buffer_count + count > VERTEX_BUFFER_SIZE)
+  VERTEX *v = (VERTEX*)pointers;
+  int needed = mode == GL_TRIANGLES ? count : (count - 2) * 3;
+  int i;
+
+  if(count < 3)
+    return;
+
+  if(needed > VERTEX_BUFFER_SIZE)
   {
+    //Too large to unroll, draw it on its own like before
+    vbo_draw();
+    memcpy(vertex_buffer,pointers,count * VERTEX_SIZE);
+    vertex_buffer_count = count;
+    vertex_draw_mode = mode;
     vbo_draw();
+    return;
   }
 
-  memcpy(&vertex_buffer[vertex_buffer_count],pointers,count * VERTEX_SIZE);
-  vertex_buffer_count += count;
-
-  if(count == 3 || mode == GL_TRIANGLES)
+  if(vertex_buffer_count + needed > VERTEX_BUFFER_SIZE)
   {
-    vertex_draw_mode = GL_TRIANGLES;
+    vbo_draw();
   }
-  else
+
+  VERTEX *dst = &vertex_buffer[vertex_buffer_count];
+  switch(mode)
   {
-    vertex_draw_mode = mode;
-    vbo_draw(); //Triangle fans and strips can't be joined as easily, just draw them straight away.
+  case GL_TRIANGLE_FAN:
+    for(i = 2; i < count; i++)
+    {
+      memcpy(dst++,&v[0],VERTEX_SIZE);
+      memcpy(dst++,&v[i-1],VERTEX_SIZE);
+      memcpy(dst++,&v[i],VERTEX_SIZE);
+    }
+    break;
+  case GL_TRIANGLE_STRIP:
+    //Every other triangle has its first two vertices swapped to keep the winding
+    for(i = 2; i < count; i++)
+    {
+      memcpy(dst++,&v[(i & 1) ? i-1 : i-2],VERTEX_SIZE);
+      memcpy(dst++,&v[(i & 1) ? i-2 : i-1],VERTEX_SIZE);
+      memcpy(dst++,&v[i],VERTEX_SIZE);
+    }
+    break;
+  default:
+    memcpy(dst,v,count * VERTEX_SIZE);
   }
-
-
+  vertex_buffer_count += needed;
+  vertex_draw_mode = GL_TRIANGLES;
 }
 
 void vbo_enable()
@@ -520,6 +520,7 @@ grSstWinOpen(
     printf("(EE) Error setting videomode %dx%d\n", width, height);
     return false;
   }
+  cache_reset();
 
   char caption[500];
 # ifdef _DEBUG
@@ -1732,6 +1733,9 @@ grBufferSwap( FxU32 swap_interval )
       (*renderCallback)(1);
 //      if (program)
 //         glUseProgramObjectARB(program);
+      //The callback may draw with its own GL state, don't trust the cache afterwards
+      vbo_disable();
+      cache_reset();
   }
   int i;
   LOG("grBufferSwap(%d)\r\n", swap_interval);
@@ -2246,22 +2250,6 @@ grTexDownloadTable( GrTexTable_t type,
   display_warning("grTexDownloadTable");
 }
 
-FX_ENTRY FxBool FX_CALL
-grTexDownloadMipMapLevelPartial( GrChipID_t        tmu,
-                                FxU32             startAddress,
-                                GrLOD_t           thisLod,
-                                GrLOD_t           largeLod,
-                                GrAspectRatio_t   aspectRatio,
-                                GrTextureFormat_t format,
-                                FxU32             evenOdd,
-                                void              *data,
-                                int               start,
-                                int               end )
-{
-  display_warning("grTexDownloadMipMapLevelPartial");
-  return 1;
-}
-
 FX_ENTRY void FX_CALL
 grTexDownloadMipMapLevel( GrChipID_t        tmu,
                          FxU32             startAddress,
@@ -1,359 +1,396 @@
 void vbo_draw();
 
-static GLenum cached_ActiveTexture_texture;
+#define CACHED_TEXTURE_UNITS 8
+
+//Last values handed to GL, shared by all Glitch64 sources. cache_reset() fills
+//everything with 0xFF: an invalid enum, an impossible size, a NaN or a boolean
+//that is neither GL_TRUE nor GL_FALSE, so the next call always reaches GL.
+typedef struct _cached_gl_state
+{
+  GLenum ActiveTexture_texture;
+  GLuint BindTexture_texture[CACHED_TEXTURE_UNITS];
+  GLenum BlendEquation_mode;
+  GLenum BlendEquationSeparate_modeRGB;
+  GLenum BlendEquationSeparate_modeAlpha;
+  GLenum BlendFunc_sfactor;
+  GLenum BlendFunc_dfactor;
+  GLenum BlendFuncSeparate_srcRGB;
+  GLenum BlendFuncSeparate_dstRGB;
+  GLenum BlendFuncSeparate_srcAlpha;
+  GLenum BlendFuncSeparate_dstAlpha;
+  GLclampf ClearColor_red;
+  GLclampf ClearColor_green;
+  GLclampf ClearColor_blue;
+  GLclampf ClearColor_alpha;
+  GLclampf ClearDepthf_depth;
+  GLboolean ColorMask_red;
+  GLboolean ColorMask_green;
+  GLboolean ColorMask_blue;
+  GLboolean ColorMask_alpha;
+  GLenum CullFace_mode;
+  GLenum DepthFunc_func;
+  GLboolean DepthMask_flag;
+  GLclampf DepthRangef_zNear;
+  GLclampf DepthRangef_zFar;
+  GLboolean BLEND;
+  GLboolean CULL_FACE;
+  GLboolean DEPTH_TEST;
+  GLboolean DITHER;
+  GLboolean POLYGON_OFFSET_FILL;
+  GLboolean SAMPLE_ALPHA_TO_COVERAGE;
+  GLboolean SAMPLE_COVERAGE;
+  GLboolean SCISSOR_TEST;
+  GLboolean STENCIL_TEST;
+  GLenum FrontFace_mode;
+  GLfloat PolygonOffset_factor;
+  GLfloat PolygonOffset_units;
+  GLint Scissor_x;
+  GLint Scissor_y;
+  GLsizei Scissor_width;
+  GLsizei Scissor_height;
+  GLuint UseProgram_program;
+  GLint Viewport_x;
+  GLint Viewport_y;
+  GLsizei Viewport_width;
+  GLsizei Viewport_height;
+} cached_gl_state;
+
+extern cached_gl_state gl_cache;
+
+//Forget everything, needed whenever the context is recreated or someone else
+//may have touched the GL state behind our back.
+void cache_reset();
+
 void inline cache_glActiveTexture (GLenum texture)
 {
-  if(texture != cached_ActiveTexture_texture)
+  if(texture != gl_cache.ActiveTexture_texture)
   {
     vbo_draw();
     glActiveTexture(texture);
-    cached_ActiveTexture_texture = texture;
+    gl_cache.ActiveTexture_texture = texture;
   }
 }
 #define glActiveTexture(texture) cache_glActiveTexture(texture)
 
+//Only GL_TEXTURE_2D is ever bound, one entry per unit
 void inline cache_glBindTexture (GLenum target, GLuint texture)
 {
-    vbo_draw();
-    glBindTexture(target, texture);
+  GLuint unit = gl_cache.ActiveTexture_texture - GL_TEXTURE0;
+  if(target == GL_TEXTURE_2D && unit < CACHED_TEXTURE_UNITS)
+  {
+    if(texture == gl_cache.BindTexture_texture[unit])
+      return;
+    gl_cache.BindTexture_texture[unit] = texture;
+  }
+  vbo_draw();
+  glBindTexture(target, texture);
 }
 #define glBindTexture(target, texture) cache_glBindTexture(target, texture)
 
-static GLenum cached_BlendEquation_mode;
+//A deleted name may be reused for different contents, so drop it from every unit
+void inline cache_glDeleteTextures (GLsizei n, const GLuint *textures)
+{
+  int i, j;
+  vbo_draw();
+  glDeleteTextures(n, textures);
+  for(i = 0; i < n; i++)
+    for(j = 0; j < CACHED_TEXTURE_UNITS; j++)
+      if(gl_cache.BindTexture_texture[j] == textures[i])
+        gl_cache.BindTexture_texture[j] = 0xFFFFFFFF;
+}
+#define glDeleteTextures(n, textures) cache_glDeleteTextures(n, textures)
+
+//These change the contents or sampling of a texture the buffered triangles may
+//still use, and with glBindTexture cached there is no longer a rebind to flush
+void inline cache_glTexImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
+{
+  vbo_draw();
+  glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+#define glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels) cache_glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels)
+
+void inline cache_glCopyTexImage2D (GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
+{
+  vbo_draw();
+  glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
+}
+#define glCopyTexImage2D(target, level, internalformat, x, y, width, height, border) cache_glCopyTexImage2D(target, level, internalformat, x, y, width, height, border)
+
+void inline cache_glCopyTexSubImage2D (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  vbo_draw();
+  glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
+}
+#define glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height) cache_glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height)
+
+void inline cache_glTexParameteri (GLenum target, GLenum pname, GLint param)
+{
+  vbo_draw();
+  glTexParameteri(target, pname, param);
+}
+#define glTexParameteri(target, pname, param) cache_glTexParameteri(target, pname, param)
+
+void inline cache_glTexParameterf (GLenum target, GLenum pname, GLfloat param)
+{
+  vbo_draw();
+  glTexParameterf(target, pname, param);
+}
+#define glTexParameterf(target, pname, param) cache_glTexParameterf(target, pname, param)
+
+void inline cache_glBindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  vbo_draw();
+  glBindFramebuffer(target, framebuffer);
+}
+#define glBindFramebuffer(target, framebuffer) cache_glBindFramebuffer(target, framebuffer)
+
+void inline cache_glClear (GLbitfield mask)
+{
+  vbo_draw();
+  glClear(mask);
+}
+#define glClear(mask) cache_glClear(mask)
+
+void inline cache_glReadPixels (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels)
+{
+  vbo_draw();
+  glReadPixels(x, y, width, height, format, type, pixels);
+}
+#define glReadPixels(x, y, width, height, format, type, pixels) cache_glReadPixels(x, y, width, height, format, type, pixels)
+
 void inline cache_glBlendEquation ( GLenum mode )
 {
-  if(mode != cached_BlendEquation_mode)
+  if(mode != gl_cache.BlendEquation_mode)
   {
     vbo_draw();
     glBlendEquation(mode);
-    cached_BlendEquation_mode = mode;
+    gl_cache.BlendEquation_mode = mode;
   }
 }
 #define glBlendEquation(mode) cache_glBlendEquation(mode)
 
-static GLenum cached_BlendEquationSeparate_modeRGB;
-static GLenum cached_BlendEquationSeparate_modeAlpha;
 void inline cache_glBlendEquationSeparate (GLenum modeRGB, GLenum modeAlpha)
 {
-  if(modeRGB != cached_BlendEquationSeparate_modeRGB || modeAlpha != cached_BlendEquationSeparate_modeAlpha)
+  if(modeRGB != gl_cache.BlendEquationSeparate_modeRGB || modeAlpha != gl_cache.BlendEquationSeparate_modeAlpha)
   {
     vbo_draw();
     glBlendEquationSeparate(modeRGB, modeAlpha);
-    cached_BlendEquationSeparate_modeRGB = modeRGB;
-    cached_BlendEquationSeparate_modeAlpha = modeAlpha;
+    gl_cache.BlendEquationSeparate_modeRGB = modeRGB;
+    gl_cache.BlendEquationSeparate_modeAlpha = modeAlpha;
   }
 }
 #define glBlendEquationSeparate(modeRGB, modeAlpha) cache_glBlendEquationSeparate(modeRGB, modeAlpha)
 
-static GLenum cached_BlendFunc_sfactor;
-static GLenum cached_BlendFunc_dfactor;
 void inline cache_glBlendFunc (GLenum sfactor, GLenum dfactor)
 {
-  if(sfactor != cached_BlendFunc_sfactor || dfactor != cached_BlendFunc_dfactor)
+  if(sfactor != gl_cache.BlendFunc_sfactor || dfactor != gl_cache.BlendFunc_dfactor)
   {
     vbo_draw();
     glBlendFunc(sfactor, dfactor);
-    cached_BlendFunc_sfactor = sfactor;
-    cached_BlendFunc_dfactor = dfactor;
+    gl_cache.BlendFunc_sfactor = sfactor;
+    gl_cache.BlendFunc_dfactor = dfactor;
   }
 }
 #define glBlendFunc(sfactor, dfactor) cache_glBlendFunc(sfactor, dfactor)
 
-static GLenum cached_BlendFuncSeparate_srcRGB;
-static GLenum cached_BlendFuncSeparate_dstRGB;
-static GLenum cached_BlendFuncSeparate_srcAlpha;
-static GLenum cached_BlendFuncSeparate_dstAlpha;
 void inline cache_glBlendFuncSeparate (GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
 {
-  if(srcRGB != cached_BlendFuncSeparate_srcRGB || dstRGB != cached_BlendFuncSeparate_dstRGB || srcAlpha != cached_BlendFuncSeparate_srcAlpha || dstAlpha != cached_BlendFuncSeparate_dstAlpha)
+  if(srcRGB != gl_cache.BlendFuncSeparate_srcRGB || dstRGB != gl_cache.BlendFuncSeparate_dstRGB || srcAlpha != gl_cache.BlendFuncSeparate_srcAlpha || dstAlpha != gl_cache.BlendFuncSeparate_dstAlpha)
   {
     vbo_draw();
     glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
-    cached_BlendFuncSeparate_srcRGB = srcRGB;
-    cached_BlendFuncSeparate_dstRGB = dstRGB;
-    cached_BlendFuncSeparate_srcAlpha = srcAlpha;
-    cached_BlendFuncSeparate_dstAlpha = dstAlpha;
+    gl_cache.BlendFuncSeparate_srcRGB = srcRGB;
+    gl_cache.BlendFuncSeparate_dstRGB = dstRGB;
+    gl_cache.BlendFuncSeparate_srcAlpha = srcAlpha;
+    gl_cache.BlendFuncSeparate_dstAlpha = dstAlpha;
   }
 }
 #define glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha) cache_glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha)
 
-static GLclampf cached_ClearColor_red;
-static GLclampf cached_ClearColor_green;
-static GLclampf cached_ClearColor_blue;
-static GLclampf cached_ClearColor_alpha;
 void inline cache_glClearColor (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
 {
-  if(red != cached_ClearColor_red || green != cached_ClearColor_green || blue != cached_ClearColor_blue || alpha != cached_ClearColor_alpha)
+  if(red != gl_cache.ClearColor_red || green != gl_cache.ClearColor_green || blue != gl_cache.ClearColor_blue || alpha != gl_cache.ClearColor_alpha)
   {
     vbo_draw();
     glClearColor(red, green, blue, alpha);
-    cached_ClearColor_red = red;
-    cached_ClearColor_green = green;
-    cached_ClearColor_blue = blue;
-    cached_ClearColor_alpha = alpha;
+    gl_cache.ClearColor_red = red;
+    gl_cache.ClearColor_green = green;
+    gl_cache.ClearColor_blue = blue;
+    gl_cache.ClearColor_alpha = alpha;
   }
 }
 #define glClearColor(red, green, blue, alpha) cache_glClearColor(red, green, blue, alpha)
 
-static GLclampf cached_ClearDepthf_depth;
 void inline cache_glClearDepthf (GLclampf depth)
 {
-  if(depth != cached_ClearDepthf_depth)
+  if(depth != gl_cache.ClearDepthf_depth)
   {
     vbo_draw();
     glClearDepthf(depth);
-    cached_ClearDepthf_depth = depth;
+    gl_cache.ClearDepthf_depth = depth;
   }
 }
 #define glClearDepthf(depth) cache_glClearDepthf(depth)
 
-static GLenum cached_CullFace_mode;
+void inline cache_glColorMask (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+  if(red != gl_cache.ColorMask_red || green != gl_cache.ColorMask_green || blue != gl_cache.ColorMask_blue || alpha != gl_cache.ColorMask_alpha)
+  {
+    vbo_draw();
+    glColorMask(red, green, blue, alpha);
+    gl_cache.ColorMask_red = red;
+    gl_cache.ColorMask_green = green;
+    gl_cache.ColorMask_blue = blue;
+    gl_cache.ColorMask_alpha = alpha;
+  }
+}
+#define glColorMask(red, green, blue, alpha) cache_glColorMask(red, green, blue, alpha)
+
 void inline cache_glCullFace (GLenum mode)
 {
-  if(mode != cached_CullFace_mode)
+  if(mode != gl_cache.CullFace_mode)
   {
     vbo_draw();
     glCullFace(mode);
-    cached_CullFace_mode = mode;
+    gl_cache.CullFace_mode = mode;
   }
 }
 #define glCullFace(mode) cache_glCullFace(mode)
 
-static GLenum cached_DepthFunc_func;
 void inline cache_glDepthFunc (GLenum func)
 {
-  if(func != cached_DepthFunc_func)
+  if(func != gl_cache.DepthFunc_func)
   {
     vbo_draw();
     glDepthFunc(func);
-    cached_DepthFunc_func = func;
+    gl_cache.DepthFunc_func = func;
   }
 }
 #define glDepthFunc(func) cache_glDepthFunc(func)
 
-static GLboolean cached_DepthMask_flag;
 void inline cache_glDepthMask (GLboolean flag)
 {
-  if(flag != cached_DepthMask_flag)
+  if(flag != gl_cache.DepthMask_flag)
   {
     vbo_draw();
     glDepthMask(flag);
-    cached_DepthMask_flag = flag;
+    gl_cache.DepthMask_flag = flag;
   }
 }
 #define glDepthMask(flag) cache_glDepthMask(flag)
 
-static GLclampf cached_DepthRangef_zNear;
-static GLclampf cached_DepthRangef_zFar;
 void inline cache_glDepthRangef (GLclampf zNear, GLclampf zFar)
 {
-  if(zNear != cached_DepthRangef_zNear || zFar != cached_DepthRangef_zFar)
+  if(zNear != gl_cache.DepthRangef_zNear || zFar != gl_cache.DepthRangef_zFar)
   {
     vbo_draw();
     glDepthRangef(zNear, zFar);
-    cached_DepthRangef_zNear = zNear;
-    cached_DepthRangef_zFar = zFar;
+    gl_cache.DepthRangef_zNear = zNear;
+    gl_cache.DepthRangef_zFar = zFar;
   }
 }
 #define glDepthRangef(zNear, zFar) cache_glDepthRangef(zNear, zFar)
 
-static bool cached_BLEND = false;
-static bool cached_CULL_FACE = false;
-static bool cached_DEPTH_TEST = false;
-static bool cached_DITHER = false;
-static bool cached_POLYGON_OFFSET_FILL = false;
-static bool cached_SAMPLE_ALPHA_TO_COVERAGE = false;
-static bool cached_SAMPLE_COVERAGE = false;
-static bool cached_SCISSOR_TEST = false;
-static bool cached_STENCIL_TEST = false;
-void inline cache_glDisable (GLenum cap)
+static inline GLboolean *cache_cap (GLenum cap)
 {
-  if(cap == GL_BLEND && cached_BLEND)
-  {
-    vbo_draw();
-    glDisable(GL_BLEND);
-    cached_BLEND = false;
-  }
-  else if(cap == GL_CULL_FACE && cached_CULL_FACE)
-  {
-    vbo_draw();
-    glDisable(GL_CULL_FACE);
-    cached_CULL_FACE = false;
-  }
-  else if(cap == GL_DEPTH_TEST && cached_DEPTH_TEST)
-  {
-    vbo_draw();
-    glDisable(GL_DEPTH_TEST);
-    cached_DEPTH_TEST = false;
-  }
-  else if(cap == GL_DITHER && cached_DITHER)
-  {
-    vbo_draw();
-    glDisable(GL_DITHER);
-    cached_DITHER = false;
-  }
-  else if(cap == GL_POLYGON_OFFSET_FILL && cached_POLYGON_OFFSET_FILL)
-  {
-    vbo_draw();
-    glDisable(GL_POLYGON_OFFSET_FILL);
-    cached_POLYGON_OFFSET_FILL = false;
-  }
-  else if(cap == GL_SAMPLE_ALPHA_TO_COVERAGE && cached_SAMPLE_ALPHA_TO_COVERAGE)
-  {
-    vbo_draw();
-    glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-    cached_SAMPLE_ALPHA_TO_COVERAGE = false;
-  }
-  else if(cap == GL_SAMPLE_COVERAGE && cached_SAMPLE_COVERAGE)
-  {
-    vbo_draw();
-    glDisable(GL_SAMPLE_COVERAGE);
-    cached_SAMPLE_COVERAGE = false;
-  }
-  else if(cap == GL_SCISSOR_TEST && cached_SCISSOR_TEST)
-  {
-    vbo_draw();
-    glDisable(GL_SCISSOR_TEST);
-    cached_SCISSOR_TEST = false;
-  }
-  else if(cap == GL_STENCIL_TEST && cached_STENCIL_TEST)
-  {
-    vbo_draw();
-    glDisable(GL_STENCIL_TEST);
-    cached_STENCIL_TEST = false;
+  switch(cap)
+  {
+  case GL_BLEND: return &gl_cache.BLEND;
+  case GL_CULL_FACE: return &gl_cache.CULL_FACE;
+  case GL_DEPTH_TEST: return &gl_cache.DEPTH_TEST;
+  case GL_DITHER: return &gl_cache.DITHER;
+  case GL_POLYGON_OFFSET_FILL: return &gl_cache.POLYGON_OFFSET_FILL;
+  case GL_SAMPLE_ALPHA_TO_COVERAGE: return &gl_cache.SAMPLE_ALPHA_TO_COVERAGE;
+  case GL_SAMPLE_COVERAGE: return &gl_cache.SAMPLE_COVERAGE;
+  case GL_SCISSOR_TEST: return &gl_cache.SCISSOR_TEST;
+  case GL_STENCIL_TEST: return &gl_cache.STENCIL_TEST;
+  default: return NULL;
   }
 }
+
+//Capabilities the cache doesn't know about still reach GL, just uncached
+void inline cache_glDisable (GLenum cap)
+{
+  GLboolean *cached = cache_cap(cap);
+  if(cached && *cached == GL_FALSE)
+    return;
+  vbo_draw();
+  glDisable(cap);
+  if(cached)
+    *cached = GL_FALSE;
+}
 #define glDisable(cap) cache_glDisable(cap)
 
 void inline cache_glEnable (GLenum cap)
 {
-  if(cap == GL_BLEND && !cached_BLEND)
-  {
-    vbo_draw();
-    glEnable(GL_BLEND);
-    cached_BLEND = true;
-  }
-  else if(cap == GL_CULL_FACE && !cached_CULL_FACE)
-  {
-    vbo_draw();
-    glEnable(GL_CULL_FACE);
-    cached_CULL_FACE = true;
-  }
-  else if(cap == GL_DEPTH_TEST && !cached_DEPTH_TEST)
-  {
-    vbo_draw();
-    glEnable(GL_DEPTH_TEST);
-    cached_DEPTH_TEST = true;
-  }
-  else if(cap == GL_DITHER && !cached_DITHER)
-  {
-    vbo_draw();
-    glEnable(GL_DITHER);
-    cached_DITHER = true;
-  }
-  else if(cap == GL_POLYGON_OFFSET_FILL && !cached_POLYGON_OFFSET_FILL)
-  {
-    vbo_draw();
-    glEnable(GL_POLYGON_OFFSET_FILL);
-    cached_POLYGON_OFFSET_FILL = true;
-  }
-  else if(cap == GL_SAMPLE_ALPHA_TO_COVERAGE && !cached_SAMPLE_ALPHA_TO_COVERAGE)
-  {
-    vbo_draw();
-    glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-    cached_SAMPLE_ALPHA_TO_COVERAGE = true;
-  }
-  else if(cap == GL_SAMPLE_COVERAGE && !cached_SAMPLE_COVERAGE)
-  {
-    vbo_draw();
-    glEnable(GL_SAMPLE_COVERAGE);
-    cached_SAMPLE_COVERAGE = true;
-  }
-  else if(cap == GL_SCISSOR_TEST && !cached_SCISSOR_TEST)
-  {
-    vbo_draw();
-    glEnable(GL_SCISSOR_TEST);
-    cached_SCISSOR_TEST = true;
-  }
-  else if(cap == GL_STENCIL_TEST && !cached_STENCIL_TEST)
-  {
-    vbo_draw();
-    glEnable(GL_STENCIL_TEST);
-    cached_STENCIL_TEST = true;
-  }
+  GLboolean *cached = cache_cap(cap);
+  if(cached && *cached == GL_TRUE)
+    return;
+  vbo_draw();
+  glEnable(cap);
+  if(cached)
+    *cached = GL_TRUE;
 }
 #define glEnable(cap) cache_glEnable(cap)
 
-static GLenum cached_FrontFace_mode;
 void inline cache_glFrontFace (GLenum mode)
 {
-  if(mode != cached_FrontFace_mode)
+  if(mode != gl_cache.FrontFace_mode)
   {
     vbo_draw();
     glFrontFace(mode);
-    cached_FrontFace_mode = mode;
+    gl_cache.FrontFace_mode = mode;
   }
 }
 #define glFrontFace(mode) cache_glFrontFace(mode)
 
-static GLfloat cached_PolygonOffset_factor;
-static GLfloat cached_PolygonOffset_units;
 void inline cache_glPolygonOffset (GLfloat factor, GLfloat units)
 {
-  if(factor != cached_PolygonOffset_factor || units != cached_PolygonOffset_units)
+  if(factor != gl_cache.PolygonOffset_factor || units != gl_cache.PolygonOffset_units)
   {
     vbo_draw();
     glPolygonOffset(factor, units);
-    cached_PolygonOffset_factor = factor;
-    cached_PolygonOffset_units = units;
+    gl_cache.PolygonOffset_factor = factor;
+    gl_cache.PolygonOffset_units = units;
   }
 }
 #define glPolygonOffset(factor, units) cache_glPolygonOffset(factor, units)
 
-static GLint cached_Scissor_x;
-static GLint cached_Scissor_y;
-static GLsizei cached_Scissor_width;
-static GLsizei cached_Scissor_height;
 void inline cache_glScissor (GLint x, GLint y, GLsizei width, GLsizei height)
 {
-  if(x != cached_Scissor_x || y != cached_Scissor_y || width != cached_Scissor_width || height != cached_Scissor_height)
+  if(x != gl_cache.Scissor_x || y != gl_cache.Scissor_y || width != gl_cache.Scissor_width || height != gl_cache.Scissor_height)
   {
     vbo_draw();
     glScissor(x, y, width, height);
-    cached_Scissor_x = x;
-    cached_Scissor_y = y;
-    cached_Scissor_width = width;
-    cached_Scissor_height = height;
+    gl_cache.Scissor_x = x;
+    gl_cache.Scissor_y = y;
+    gl_cache.Scissor_width = width;
+    gl_cache.Scissor_height = height;
   }
 }
 #define glScissor(x, y, width, height) cache_glScissor(x, y, width, height)
 
-static GLuint cached_UseProgram_program;
 void inline cache_glUseProgram (GLuint program)
 {
-  if(program != cached_UseProgram_program)
+  if(program != gl_cache.UseProgram_program)
   {
     vbo_draw();
     glUseProgram(program);
-    cached_UseProgram_program = program;
+    gl_cache.UseProgram_program = program;
   }
 }
 #define glUseProgram(program) cache_glUseProgram(program)
 
-static GLint cached_Viewport_x;
-static GLint cached_Viewport_y;
-static GLsizei cached_Viewport_width;
-static GLsizei cached_Viewport_height;
 void inline cache_glViewport (GLint x, GLint y, GLsizei width, GLsizei height)
 {
-  if(x != cached_Viewport_x || y != cached_Viewport_y || width != cached_Viewport_width || height != cached_Viewport_height)
+  if(x != gl_cache.Viewport_x || y != gl_cache.Viewport_y || width != gl_cache.Viewport_width || height != gl_cache.Viewport_height)
   {
     vbo_draw();
     glViewport(x, y, width, height);
-    cached_Viewport_x = x;
-    cached_Viewport_y = y;
-    cached_Viewport_width = width;
-    cached_Viewport_height = height;
+    gl_cache.Viewport_x = x;
+    gl_cache.Viewport_y = y;
+    gl_cache.Viewport_width = width;
+    gl_cache.Viewport_height = height;
   }
 }
 #define glViewport(x, y, width, height) cache_glViewport(x, y, width, height)
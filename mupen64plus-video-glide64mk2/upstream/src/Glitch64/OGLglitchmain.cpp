@@ -2203,22 +2203,6 @@ grTexDownloadTable( GrTexTable_t type,
   display_warning("grTexDownloadTable");
 }
 
-FX_ENTRY FxBool FX_CALL
-grTexDownloadMipMapLevelPartial( GrChipID_t        tmu,
-                                FxU32             startAddress,
-                                GrLOD_t           thisLod,
-                                GrLOD_t           largeLod,
-                                GrAspectRatio_t   aspectRatio,
-                                GrTextureFormat_t format,
-                                FxU32             evenOdd,
-                                void              *data,
-                                int               start,
-                                int               end )
-{
-  display_warning("grTexDownloadMipMapLevelPartial");
-  return 1;
-}
-
 FX_ENTRY void FX_CALL
 grTexDownloadMipMapLevel( GrChipID_t        tmu,
                          FxU32             startAddress,
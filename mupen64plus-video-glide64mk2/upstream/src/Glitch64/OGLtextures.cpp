@@ -401,223 +401,229 @@ int grTexFormat2GLPackedFmt(int fmt, int * gltexfmt, int * glpixfmt, int * glpac
   return factor;
 }
 
-FX_ENTRY void FX_CALL
-grTexDownloadMipMap( GrChipID_t tmu,
-                    FxU32      startAddress,
-                    FxU32      evenOdd,
-                    GrTexInfo  *info )
+// Converts width*height texels of data to RGBA8 in the texture scratch buffer
+static int convert_texture(GrTextureFormat_t format, void *data, int width, int height, int *glformat)
 {
-  int width, height, i, j;
-  int factor;
-  int glformat = 0;
-  int gltexfmt, glpixfmt, glpackfmt;
-  LOG("grTexDownloadMipMap(%d,%d,%d)\r\n", tmu, startAddress, evenOdd);
-  if (info->largeLodLog2 != info->smallLodLog2) display_warning("grTexDownloadMipMap : loading more than one LOD");
-
-  if (info->aspectRatioLog2 < 0)
-  {
-    height = 1 << info->largeLodLog2;
-    width = height >> -info->aspectRatioLog2;
-  }
-  else
+  int i, j, factor;
+  // VP fixed the texture conversions to be more accurate, also swapped
+  // the for i/j loops so that is is less likely to break the memory cache
+  int n = 0, m = 0;
+  switch(format)
   {
-    width = 1 << info->largeLodLog2;
-    height = width >> info->aspectRatioLog2;
-  }
-
-  if (!packed_pixels_support)
-    factor = -1;
-  else
-    factor = grTexFormat2GLPackedFmt(info->format, &gltexfmt, &glpixfmt, &glpackfmt);
-
-  if (factor < 0) {
-
-    // VP fixed the texture conversions to be more accurate, also swapped
-    // the for i/j loops so that is is less likely to break the memory cache
-    int n = 0, m = 0;
-    switch(info->format)
+  case GR_TEXFMT_ALPHA_8:
+    for (i=0; i<height; i++)
     {
-    case GR_TEXFMT_ALPHA_8:
-      for (i=0; i<height; i++)
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned char*)info->data)[m];
-          texel |= (texel << 8);
-          texel |= (texel << 16);
-          ((unsigned int*)texture)[n] = texel;
-          m++;
-          n++;
-        }
+        unsigned int texel = (unsigned int)((unsigned char*)data)[m];
+        texel |= (texel << 8);
+        texel |= (texel << 16);
+        ((unsigned int*)texture)[n] = texel;
+        m++;
+        n++;
       }
-      factor = 1;
-      glformat = GL_INTENSITY8;
-      break;
-    case GR_TEXFMT_INTENSITY_8: // I8 support - H.Morii
-      for (i=0; i<height; i++)
+    }
+    factor = 1;
+    *glformat = GL_INTENSITY8;
+    break;
+  case GR_TEXFMT_INTENSITY_8: // I8 support - H.Morii
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned char*)info->data)[m];
-          texel |= (0xFF000000 | (texel << 16) | (texel << 8));
-          ((unsigned int*)texture)[n] = texel;
-          m++;
-          n++;
-        }
+        unsigned int texel = (unsigned int)((unsigned char*)data)[m];
+        texel |= (0xFF000000 | (texel << 16) | (texel << 8));
+        ((unsigned int*)texture)[n] = texel;
+        m++;
+        n++;
       }
-      factor = 1;
-      glformat = GL_LUMINANCE8;
-      break;
-    case GR_TEXFMT_ALPHA_INTENSITY_44:
+    }
+    factor = 1;
+    *glformat = GL_LUMINANCE8;
+    break;
+  case GR_TEXFMT_ALPHA_INTENSITY_44:
 #if 1
-      for (i=0; i<height; i++)
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned char*)info->data)[m];
+        unsigned int texel = (unsigned int)((unsigned char*)data)[m];
 #if 1
-          /* accurate conversion */
-          unsigned int texel_hi = (texel & 0x000000F0) << 20;
-          unsigned int texel_low = texel & 0x0000000F;
-          texel_low |= (texel_low << 4);
-          texel_hi |= ((texel_hi << 4) | (texel_low << 16) | (texel_low << 8) | texel_low);
+        /* accurate conversion */
+        unsigned int texel_hi = (texel & 0x000000F0) << 20;
+        unsigned int texel_low = texel & 0x0000000F;
+        texel_low |= (texel_low << 4);
+        texel_hi |= ((texel_hi << 4) | (texel_low << 16) | (texel_low << 8) | texel_low);
 #else
-          unsigned int texel_hi = (texel & 0x000000F0) << 24;
-          unsigned int texel_low = (texel & 0x0000000F) << 4;
-          texel_hi |= ((texel_low << 16) | (texel_low << 8) | texel_low);
+        unsigned int texel_hi = (texel & 0x000000F0) << 24;
+        unsigned int texel_low = (texel & 0x0000000F) << 4;
+        texel_hi |= ((texel_low << 16) | (texel_low << 8) | texel_low);
 #endif
-          ((unsigned int*)texture)[n] = texel_hi;
-          m++;
-          n++;
-        }
+        ((unsigned int*)texture)[n] = texel_hi;
+        m++;
+        n++;
       }
-      factor = 1;
-      glformat = GL_LUMINANCE4_ALPHA4;
+    }
+    factor = 1;
+    *glformat = GL_LUMINANCE4_ALPHA4;
 #endif
-      break;
-    case GR_TEXFMT_RGB_565:
-      for (i=0; i<height; i++)
+    break;
+  case GR_TEXFMT_RGB_565:
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned short*)info->data)[m];
-          unsigned int B = texel & 0x0000F800;
-          unsigned int G = texel & 0x000007E0;
-          unsigned int R = texel & 0x0000001F;
+        unsigned int texel = (unsigned int)((unsigned short*)data)[m];
+        unsigned int B = texel & 0x0000F800;
+        unsigned int G = texel & 0x000007E0;
+        unsigned int R = texel & 0x0000001F;
 #if 0
-          /* accurate conversion */
-          ((unsigned int*)texture)[n] = 0xFF000000 | (R << 19) | ((R >> 2) << 16) | (G << 5) | ((G >> 9) << 8) | (B >> 8) | (B >> 13);
+        /* accurate conversion */
+        ((unsigned int*)texture)[n] = 0xFF000000 | (R << 19) | ((R >> 2) << 16) | (G << 5) | ((G >> 9) << 8) | (B >> 8) | (B >> 13);
 #else
-          ((unsigned int*)texture)[n] = 0xFF000000 | (R << 19) | (G << 5) | (B >> 8);
+        ((unsigned int*)texture)[n] = 0xFF000000 | (R << 19) | (G << 5) | (B >> 8);
 #endif
-          m++;
-          n++;
-        }
+        m++;
+        n++;
       }
-      factor = 2;
-      glformat = GL_RGB;
-      break;
-    case GR_TEXFMT_ARGB_1555:
-      for (i=0; i<height; i++)
+    }
+    factor = 2;
+    *glformat = GL_RGB;
+    break;
+  case GR_TEXFMT_ARGB_1555:
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned short*)info->data)[m];
-          unsigned int A = texel & 0x00008000 ? 0xFF000000 : 0;
-          unsigned int B = texel & 0x00007C00;
-          unsigned int G = texel & 0x000003E0;
-          unsigned int R = texel & 0x0000001F;
+        unsigned int texel = (unsigned int)((unsigned short*)data)[m];
+        unsigned int A = texel & 0x00008000 ? 0xFF000000 : 0;
+        unsigned int B = texel & 0x00007C00;
+        unsigned int G = texel & 0x000003E0;
+        unsigned int R = texel & 0x0000001F;
 #if 0
-          /* accurate conversion */
-          ((unsigned int*)texture)[n] = A | (R << 19) | ((R >> 2) << 16) | (G << 6) | ((G >> 8) << 8) | (B >> 7) | (B >> 12);
+        /* accurate conversion */
+        ((unsigned int*)texture)[n] = A | (R << 19) | ((R >> 2) << 16) | (G << 6) | ((G >> 8) << 8) | (B >> 7) | (B >> 12);
 #else
-          ((unsigned int*)texture)[n] = A | (R << 19) | (G << 6) | (B >> 7);
+        ((unsigned int*)texture)[n] = A | (R << 19) | (G << 6) | (B >> 7);
 #endif
-          m++;
-          n++;
-        }
+        m++;
+        n++;
       }
-      factor = 2;
-      glformat = GL_RGB5_A1;
-      break;
-    case GR_TEXFMT_ALPHA_INTENSITY_88:
-      for (i=0; i<height; i++)
+    }
+    factor = 2;
+    *glformat = GL_RGB5_A1;
+    break;
+  case GR_TEXFMT_ALPHA_INTENSITY_88:
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int AI = (unsigned int)((unsigned short*)info->data)[m];
-          unsigned int I = (unsigned int)(AI & 0x000000FF);
-          ((unsigned int*)texture)[n] = (AI << 16) | (I << 8) | I;
-          m++;
-          n++;
-        }
+        unsigned int AI = (unsigned int)((unsigned short*)data)[m];
+        unsigned int I = (unsigned int)(AI & 0x000000FF);
+        ((unsigned int*)texture)[n] = (AI << 16) | (I << 8) | I;
+        m++;
+        n++;
       }
-      factor = 2;
-      glformat = GL_LUMINANCE8_ALPHA8;
-      break;
-    case GR_TEXFMT_ARGB_4444:
+    }
+    factor = 2;
+    *glformat = GL_LUMINANCE8_ALPHA8;
+    break;
+  case GR_TEXFMT_ARGB_4444:
 
-      for (i=0; i<height; i++)
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = (unsigned int)((unsigned short*)info->data)[m];
-          unsigned int A = texel & 0x0000F000;
-          unsigned int B = texel & 0x00000F00;
-          unsigned int G = texel & 0x000000F0;
-          unsigned int R = texel & 0x0000000F;
+        unsigned int texel = (unsigned int)((unsigned short*)data)[m];
+        unsigned int A = texel & 0x0000F000;
+        unsigned int B = texel & 0x00000F00;
+        unsigned int G = texel & 0x000000F0;
+        unsigned int R = texel & 0x0000000F;
 #if 0
-          /* accurate conversion */
-          ((unsigned int*)texture)[n] = (A << 16) | (A << 12) | (R << 20) | (R << 16) | (G << 8) | (G << 4) | (B >> 4) | (B >> 8);
+        /* accurate conversion */
+        ((unsigned int*)texture)[n] = (A << 16) | (A << 12) | (R << 20) | (R << 16) | (G << 8) | (G << 4) | (B >> 4) | (B >> 8);
 #else
-          ((unsigned int*)texture)[n] = (A << 16) | (R << 20) | (G << 8) | (B >> 4);
+        ((unsigned int*)texture)[n] = (A << 16) | (R << 20) | (G << 8) | (B >> 4);
 #endif
-          m++;
-          n++;
-        }
+        m++;
+        n++;
       }
-      factor = 2;
-      glformat = GL_RGBA4;
-      break;
-    case GR_TEXFMT_ARGB_8888:
-      for (i=0; i<height; i++)
+    }
+    factor = 2;
+    *glformat = GL_RGBA4;
+    break;
+  case GR_TEXFMT_ARGB_8888:
+    for (i=0; i<height; i++)
+    {
+      for (j=0; j<width; j++)
       {
-        for (j=0; j<width; j++)
-        {
-          unsigned int texel = ((unsigned int*)info->data)[m];
-          unsigned int A = texel & 0xFF000000;
-          unsigned int B = texel & 0x00FF0000;
-          unsigned int G = texel & 0x0000FF00;
-          unsigned int R = texel & 0x000000FF;
-          ((unsigned int*)texture)[n] = A | (R << 16) | G | (B >> 16);
-          m++;
-          n++;
-        }
+        unsigned int texel = ((unsigned int*)data)[m];
+        unsigned int A = texel & 0xFF000000;
+        unsigned int B = texel & 0x00FF0000;
+        unsigned int G = texel & 0x0000FF00;
+        unsigned int R = texel & 0x000000FF;
+        ((unsigned int*)texture)[n] = A | (R << 16) | G | (B >> 16);
+        m++;
+        n++;
       }
-      factor = 4;
-      glformat = GL_RGBA8;
-      break;
-    case GR_TEXFMT_ARGB_CMP_DXT1: // FXT1,DXT1,5 support - H.Morii
-      factor = 8;                 // HACKALERT: factor holds block bytes
-      glformat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
-      break;
-    case GR_TEXFMT_ARGB_CMP_DXT3: // FXT1,DXT1,5 support - H.Morii
-      factor = 16;                 // HACKALERT: factor holds block bytes
-      glformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-      break;
-    case GR_TEXFMT_ARGB_CMP_DXT5:
-      factor = 16;
-      glformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-      break;
-    case GR_TEXFMT_ARGB_CMP_FXT1:
-      factor = 8;
-      glformat = GL_COMPRESSED_RGBA_FXT1_3DFX;
-      break;
-    default:
-      display_warning("grTexDownloadMipMap : unknown texture format: %x", info->format);
-      factor = 0;
     }
+    factor = 4;
+    *glformat = GL_RGBA8;
+    break;
+  case GR_TEXFMT_ARGB_CMP_DXT1: // FXT1,DXT1,5 support - H.Morii
+    factor = 8;                 // HACKALERT: factor holds block bytes
+    *glformat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    break;
+  case GR_TEXFMT_ARGB_CMP_DXT3: // FXT1,DXT1,5 support - H.Morii
+    factor = 16;                 // HACKALERT: factor holds block bytes
+    *glformat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    break;
+  case GR_TEXFMT_ARGB_CMP_DXT5:
+    factor = 16;
+    *glformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    break;
+  case GR_TEXFMT_ARGB_CMP_FXT1:
+    factor = 8;
+    *glformat = GL_COMPRESSED_RGBA_FXT1_3DFX;
+    break;
+  default:
+    display_warning("grTexDownloadMipMap : unknown texture format: %x", format);
+    factor = 0;
+  }
+  return factor;
+}
+
+FX_ENTRY void FX_CALL
+grTexDownloadMipMap( GrChipID_t tmu,
+                    FxU32      startAddress,
+                    FxU32      evenOdd,
+                    GrTexInfo  *info )
+{
+  int width, height;
+  int factor;
+  int glformat = 0;
+  int gltexfmt, glpixfmt, glpackfmt;
+  LOG("grTexDownloadMipMap(%d,%d,%d)\r\n", tmu, startAddress, evenOdd);
+  if (info->largeLodLog2 != info->smallLodLog2) display_warning("grTexDownloadMipMap : loading more than one LOD");
+
+  if (info->aspectRatioLog2 < 0)
+  {
+    height = 1 << info->largeLodLog2;
+    width = height >> -info->aspectRatioLog2;
   }
+  else
+  {
+    width = 1 << info->largeLodLog2;
+    height = width >> info->aspectRatioLog2;
+  }
+
+  if (!packed_pixels_support)
+    factor = -1;
+  else
+    factor = grTexFormat2GLPackedFmt(info->format, &gltexfmt, &glpixfmt, &glpackfmt);
+
+  if (factor < 0)
+    factor = convert_texture(info->format, info->data, width, height, &glformat);
 
   if (nbTextureUnits <= 2)
     glActiveTextureARB(GL_TEXTURE1_ARB);
@@ -660,6 +666,73 @@ grTexDownloadMipMap( GrChipID_t tmu,
   glBindTexture(GL_TEXTURE_2D, default_texture);
 }
 
+FX_ENTRY FxBool FX_CALL
+grTexDownloadMipMapLevelPartial( GrChipID_t        tmu,
+                                FxU32             startAddress,
+                                GrLOD_t           thisLod,
+                                GrLOD_t           largeLod,
+                                GrAspectRatio_t   aspectRatio,
+                                GrTextureFormat_t format,
+                                FxU32             evenOdd,
+                                void              *data,
+                                int               start,
+                                int               end )
+{
+  int width, height;
+  int factor;
+  int glformat = 0;
+  int gltexfmt, glpixfmt, glpackfmt;
+  LOG("grTexDownloadMipMapLevelPartial(%d,%d,%d,%d,%d)\r\n", tmu, startAddress, thisLod, start, end);
+  if (thisLod != largeLod) display_warning("grTexDownloadMipMapLevelPartial : loading a smaller LOD");
+
+  if (aspectRatio < 0)
+  {
+    height = 1 << thisLod;
+    width = height >> -aspectRatio;
+  }
+  else
+  {
+    width = 1 << thisLod;
+    height = width >> aspectRatio;
+  }
+  if (start < 0 || start > end || end >= height)
+    return FXFALSE;
+
+  // Rows start to end of a texture grTexDownloadMipMap already created with
+  // the same size and format are replaced in place; data points at row start.
+  switch(format)
+  {
+  case GR_TEXFMT_ARGB_CMP_DXT1:
+  case GR_TEXFMT_ARGB_CMP_DXT3:
+  case GR_TEXFMT_ARGB_CMP_DXT5:
+  case GR_TEXFMT_ARGB_CMP_FXT1:
+    return FXFALSE;
+  }
+
+  if (!packed_pixels_support)
+    factor = -1;
+  else
+    factor = grTexFormat2GLPackedFmt(format, &gltexfmt, &glpixfmt, &glpackfmt);
+
+  if (factor < 0)
+    factor = convert_texture(format, data, width, end - start + 1, &glformat);
+  if (factor == 0)
+    return FXFALSE;
+
+  if (nbTextureUnits <= 2)
+    glActiveTextureARB(GL_TEXTURE1_ARB);
+  else
+    glActiveTextureARB(GL_TEXTURE2_ARB);
+
+  glBindTexture(GL_TEXTURE_2D, startAddress+1);
+  if (glformat)
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, start, width, end - start + 1, GL_RGBA, GL_UNSIGNED_BYTE, texture);
+  else
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, start, width, end - start + 1, glpixfmt, glpackfmt, data);
+  glBindTexture(GL_TEXTURE_2D, default_texture);
+  return FXTRUE;
+}
+
 int CheckTextureBufferFormat(GrChipID_t tmu, FxU32 startAddress, GrTexInfo *info );
 
 FX_ENTRY void FX_CALL
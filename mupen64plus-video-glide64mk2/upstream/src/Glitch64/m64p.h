@@ -29,6 +29,7 @@
 extern ptr_ConfigOpenSection      ConfigOpenSection;
 extern ptr_ConfigGetParamInt      ConfigGetParamInt;
 extern ptr_ConfigGetParamBool     ConfigGetParamBool;
+extern ptr_ConfigGetUserCachePath ConfigGetUserCachePath;
 
 extern ptr_VidExt_Init                  CoreVideo_Init;
 extern ptr_VidExt_Quit                  CoreVideo_Quit;
@@ -0,0 +1,69 @@
+#include "BandWorkers.h"
+
+void BandWorkers::start(u32 _numThreads)
+{
+	if (!m_threads.empty())
+		return;
+	m_stop = false;
+	for (u32 i = 1; i < _numThreads; ++i)
+		m_threads.emplace_back(&BandWorkers::_workerLoop, this, i);
+}
+
+void BandWorkers::stop()
+{
+	if (m_threads.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_signalWork.notify_all();
+	for (auto & thread : m_threads)
+		thread.join();
+	m_threads.clear();
+}
+
+void BandWorkers::_workerLoop(u32 _worker)
+{
+	u64 generation = 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_signalWork.wait(lock, [&]() { return m_stop || m_generation != generation; });
+		if (m_stop)
+			return;
+		generation = m_generation;
+
+		if (_worker < m_count) {
+			lock.unlock();
+			m_task(_worker);
+			lock.lock();
+		}
+
+		if (--m_running == 0)
+			m_signalDone.notify_one();
+	}
+}
+
+void BandWorkers::run(u32 _count, const std::function<void(u32)> & _task)
+{
+	if (_count < 2) {
+		for (u32 i = 0; i < _count; ++i)
+			_task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = _task;
+		m_count = _count;
+		m_running = u32(m_threads.size());
+		m_generation++;
+	}
+	m_signalWork.notify_all();
+
+	_task(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_signalDone.wait(lock, [this]() { return m_running == 0; });
+	m_task = nullptr;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Types.h"
+
+// Worker threads processing row bands of an image.
+// run() calls _task(0) .. _task(_count - 1) in parallel and returns when all are done,
+// _task(0) runs in the calling thread. _count must not exceed size().
+class BandWorkers
+{
+public:
+	~BandWorkers() { stop(); }
+
+	void start(u32 _numThreads);
+	void stop();
+	u32 size() const { return u32(m_threads.size()) + 1; }
+	void run(u32 _count, const std::function<void(u32)> & _task);
+
+private:
+	void _workerLoop(u32 _worker);
+
+	std::vector<std::thread> m_threads;
+	std::function<void(u32)> m_task;
+	u32 m_count = 0;
+	u32 m_running = 0;
+	u64 m_generation = 0;
+	bool m_stop = false;
+	std::mutex m_mutex;
+	std::condition_variable m_signalWork;
+	std::condition_variable m_signalDone;
+};
@@ -9,6 +9,7 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include <Performance.h>
 #include "Log.h"
 
 /*
@@ -244,7 +245,7 @@ u32 ColorBufferToRDRAM::_RGBAtoRGBA32(u32 _c) {
 	return (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
 }
 
-void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
+bool ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 {
 	const u32 stride = m_pCurFrameBuffer->m_width << m_pCurFrameBuffer->m_size >> 1;
 	const u32 max_height = std::min((u32)VI_GetMaxBufferHeight(m_pCurFrameBuffer->m_width), cutHeight(_startAddress, m_pCurFrameBuffer->m_height, stride));
@@ -264,7 +265,7 @@ void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 	const u8* pPixels = m_bufferReader->readPixels(x0, y0, width, height, m_pCurFrameBuffer->m_size, _sync);
 	frameBufferList().setCurrentDrawBuffer();
 	if (pPixels == nullptr)
-		return;
+		return false;
 
 	if (m_pCurFrameBuffer->m_size == G_IM_SIZ_32b) {
 		u32 *ptr_src = (u32*)pPixels;
@@ -300,8 +301,37 @@ void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 	m_pCurFrameBuffer->m_cleared = false;
 
 	m_bufferReader->cleanUp();
+	perf.addFBCopy();
 
 	gDP.changed |= CHANGED_SCISSOR;
+	return true;
+}
+
+void ColorBufferToRDRAM::_getRowsToCopy(u32 _height, u32 & _top, u32 & _bottom) const
+{
+	_top = 0;
+	_bottom = _height;
+
+	const FrameBuffer * pBuffer = m_pCurFrameBuffer;
+	if (pBuffer->m_dirtyTop == 0 && pBuffer->m_dirtyBottom >= _height)
+		return;
+
+	// Clean rows are skipped only if RDRAM still holds what the last copy wrote there.
+	const u32 stride = pBuffer->m_width << pBuffer->m_size >> 1;
+	if (pBuffer->m_fingerprint || pBuffer->m_RdramCopy.size() < _height * stride)
+		return;
+
+	// Keep 4 pixel alignment of 8 and 16 bit pixel swapping
+	const u32 top = std::min(pBuffer->m_dirtyTop & ~3U, _height);
+	const u32 bottom = std::min((pBuffer->m_dirtyBottom + 3) & ~3U, _height);
+	const u8 * pRdram = RDRAM + pBuffer->m_startAddress;
+	const u8 * pCopy = pBuffer->m_RdramCopy.data();
+	if (memcmp(pRdram, pCopy, top * stride) != 0 ||
+		memcmp(pRdram + bottom * stride, pCopy + bottom * stride, (_height - bottom) * stride) != 0)
+		return;
+
+	_top = top;
+	_bottom = std::max(top, bottom);
 }
 
 u32 ColorBufferToRDRAM::_getRealWidth(u32 _viWidth)
@@ -320,8 +350,29 @@ void ColorBufferToRDRAM::copyToRDRAM(u32 _address, bool _sync)
 {
 	if (!_prepareCopy(_address))
 		return;
-	const u32 numBytes = (m_pCurFrameBuffer->m_width*m_pCurFrameBuffer->m_height) << m_pCurFrameBuffer->m_size >> 1;
-	_copy(m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_startAddress + numBytes, _sync);
+
+	const u32 stride = m_pCurFrameBuffer->m_width << m_pCurFrameBuffer->m_size >> 1;
+	const u32 height = std::min((u32)VI_GetMaxBufferHeight(m_pCurFrameBuffer->m_width),
+		cutHeight(m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_height, stride));
+
+	// Asynchronous copy writes pixels of an older frame, it can't skip rows.
+	u32 top = 0;
+	u32 bottom = height;
+	if (_sync)
+		_getRowsToCopy(height, top, bottom);
+
+	if (top == bottom) {
+		// Nothing was drawn since the last copy
+		frameBufferList().setCurrentDrawBuffer();
+		m_pCurFrameBuffer->m_copiedToRdram = true;
+		m_pCurFrameBuffer->m_cleared = false;
+		gDP.changed |= CHANGED_SCISSOR;
+		return;
+	}
+
+	if (_copy(m_pCurFrameBuffer->m_startAddress + top * stride,
+			  m_pCurFrameBuffer->m_startAddress + bottom * stride, _sync) && _sync)
+		m_pCurFrameBuffer->clearDirtyRows();
 }
 
 void ColorBufferToRDRAM::copyChunkToRDRAM(u32 _startAddress)
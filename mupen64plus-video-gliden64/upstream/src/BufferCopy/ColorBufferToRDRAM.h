@@ -44,7 +44,9 @@ private:
 
 	bool _prepareCopy(u32& _startAddress);
 
-	void _copy(u32 _startAddress, u32 _endAddress, bool _sync);
+	bool _copy(u32 _startAddress, u32 _endAddress, bool _sync);
+
+	void _getRowsToCopy(u32 _height, u32 & _top, u32 & _bottom) const;
 
 	u32 _getRealWidth(u32 _viWidth);
 
@@ -12,6 +12,7 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include <Performance.h>
 
 #include <Graphics/Context.h>
 #include <Graphics/Parameters.h>
@@ -269,6 +270,7 @@ bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 		pBuffer->m_cleared = false;
 
 	m_pbuf->closeReadBuffer();
+	perf.addFBCopy();
 
 	gDP.changed |= CHANGED_SCISSOR;
 	return true;
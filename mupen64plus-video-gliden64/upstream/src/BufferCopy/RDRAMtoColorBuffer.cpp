@@ -7,6 +7,7 @@
 #include <Config.h>
 #include <N64.h>
 #include <VI.h>
+#include <Performance.h>
 
 #include <Graphics/Context.h>
 #include <Graphics/Parameters.h>
@@ -18,7 +19,12 @@ using namespace graphics;
 RDRAMtoColorBuffer::RDRAMtoColorBuffer()
 	: m_pCurBuffer(nullptr)
 	, m_pTexture(nullptr)
-	, m_pbuf(nullptr) {
+	, m_pbuf(nullptr)
+	, m_pRawTexture(nullptr)
+	, m_rawAddress(0)
+	, m_rawWidth(0)
+	, m_rawSize(0)
+	, m_rawHeight(0) {
 }
 
 RDRAMtoColorBuffer & RDRAMtoColorBuffer::get()
@@ -63,6 +69,43 @@ void RDRAMtoColorBuffer::init()
 	gfxContext.setTextureParameters(setParams);
 
 	m_pbuf = (u8*)malloc(m_pTexture->textureBytes);
+
+	if (!Context::IntegerTextures)
+		return;
+
+	m_rawProgram.reset(gfxContext.createRDRAMtoColorBufferShader());
+	if (!m_rawProgram)
+		return;
+
+	m_pRawTexture = textureCache().addFrameBufferTexture(false);
+	m_pRawTexture->format = G_IM_FMT_RGBA;
+	m_pRawTexture->clampS = 1;
+	m_pRawTexture->clampT = 1;
+	m_pRawTexture->frameBufferTexture = CachedTexture::fbOneSample;
+	m_pRawTexture->maskS = 0;
+	m_pRawTexture->maskT = 0;
+	m_pRawTexture->mirrorS = 0;
+	m_pRawTexture->mirrorT = 0;
+	m_pRawTexture->realWidth = m_pTexture->realWidth;
+	m_pRawTexture->realHeight = m_pTexture->realHeight;
+	m_pRawTexture->textureBytes = m_pRawTexture->realWidth * m_pRawTexture->realHeight * fbTexFormats.lutFormatBytes;
+
+	initParams.handle = m_pRawTexture->name;
+	initParams.width = m_pRawTexture->realWidth;
+	initParams.height = m_pRawTexture->realHeight;
+	initParams.internalFormat = fbTexFormats.lutInternalFormat;
+	initParams.format = fbTexFormats.lutFormat;
+	initParams.dataType = fbTexFormats.lutType;
+	gfxContext.init2DTexture(initParams);
+
+	setParams.handle = m_pRawTexture->name;
+	setParams.minFilter = textureParameters::FILTER_NEAREST;
+	setParams.magFilter = textureParameters::FILTER_NEAREST;
+	gfxContext.setTextureParameters(setParams);
+
+	m_rawShadow.resize(m_pRawTexture->realWidth * m_pRawTexture->realHeight);
+	m_rawRowNonZero.resize(m_pRawTexture->realHeight);
+	m_rawAddress = m_rawWidth = m_rawSize = m_rawHeight = 0;
 }
 
 void RDRAMtoColorBuffer::destroy()
@@ -71,7 +114,15 @@ void RDRAMtoColorBuffer::destroy()
 		textureCache().removeFrameBufferTexture(m_pTexture);
 		m_pTexture = nullptr;
 	}
+	if (m_pRawTexture != nullptr) {
+		textureCache().removeFrameBufferTexture(m_pRawTexture);
+		m_pRawTexture = nullptr;
+	}
+	m_rawProgram.reset();
+	m_rawShadow.clear();
+	m_rawRowNonZero.clear();
 	free(m_pbuf);
+	m_pbuf = nullptr;
 }
 
 void RDRAMtoColorBuffer::addAddress(u32 _address, u32 _size)
@@ -170,6 +221,119 @@ u32 RGBA32ToABGR32(u32 col, bool _bCFB)
 	return ((a << 24) | (b << 16) | (g << 8) | r);
 }
 
+// Buffer texture will be drawn with alpha, so the color must not be duplicated in RDRAM
+static
+void _clearBufferInRdram(u32 _address, u32 _width, u32 _height, u32 _size, bool _bUseAlpha)
+{
+	if (FBInfo::fbInfo.isSupported())
+		return;
+	if (!_bUseAlpha || config.frameBufferEmulation.copyToRDRAM != Config::ctDisable)
+		return;
+
+	u32 totalBytes = (_width * _height) << _size >> 1;
+	if (_address + totalBytes > RDRAMSize + 1)
+		totalBytes = RDRAMSize + 1 - _address;
+	memset(RDRAM + _address, 0, totalBytes);
+}
+
+bool RDRAMtoColorBuffer::_canConvertOnGPU(u32 _address, u32 _width, u32 _height) const
+{
+	if (m_pRawTexture == nullptr || (_address & 3) != 0)
+		return false;
+	const u32 rowWords = m_pCurBuffer->m_size == G_IM_SIZ_16b ? (_width >> 1) : _width;
+	if (m_pCurBuffer->m_size == G_IM_SIZ_16b && (_width & 1) != 0)
+		return false;
+	return rowWords > 0 && rowWords <= m_pRawTexture->realWidth && _height <= m_pRawTexture->realHeight;
+}
+
+// Upload raw RDRAM rows, which changed since the previous conversion of the same buffer.
+// Returns false if the whole area is black, like _copyBufferFromRdram.
+bool RDRAMtoColorBuffer::_updateRawTexture(u32 _address, u32 _width, u32 _height)
+{
+	const u32 size = m_pCurBuffer->m_size;
+	const u32 rowWords = size == G_IM_SIZ_16b ? (_width >> 1) : _width;
+	const u32 * src = reinterpret_cast<const u32*>(RDRAM + _address);
+	if (_address != m_rawAddress || _width != m_rawWidth || size != m_rawSize) {
+		m_rawAddress = _address;
+		m_rawWidth = _width;
+		m_rawSize = size;
+		m_rawHeight = 0;
+	}
+	// Rows not uploaded with the current layout yet are marked as changed.
+	for (u32 y = m_rawHeight; y < _height; ++y)
+		m_rawShadow[y * rowWords] = ~src[y * rowWords];
+	m_rawHeight = std::max(m_rawHeight, _height);
+
+	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
+	Context::UpdateTextureDataParams updateParams;
+	updateParams.handle = m_pRawTexture->name;
+	updateParams.textureUnitIndex = textureIndices::Tex[0];
+	updateParams.width = rowWords;
+	updateParams.format = fbTexFormats.lutFormat;
+	updateParams.internalFormat = fbTexFormats.lutInternalFormat;
+	updateParams.dataType = fbTexFormats.lutType;
+
+	bool bNonZero = false;
+	u32 dirtyStart = _height;
+	for (u32 y = 0; y <= _height; ++y) {
+		const bool bDirty = y < _height &&
+			memcmp(&m_rawShadow[y * rowWords], src + y * rowWords, rowWords * sizeof(u32)) != 0;
+		if (bDirty) {
+			memcpy(&m_rawShadow[y * rowWords], src + y * rowWords, rowWords * sizeof(u32));
+			u32 summ = 0;
+			for (u32 x = 0; x < rowWords; ++x)
+				summ |= src[y * rowWords + x];
+			m_rawRowNonZero[y] = summ != 0 ? 1 : 0;
+			if (dirtyStart == _height)
+				dirtyStart = y;
+		} else if (dirtyStart != _height) {
+			// Upload the run of changed rows straight from RDRAM.
+			updateParams.y = dirtyStart;
+			updateParams.height = y - dirtyStart;
+			updateParams.data = src + dirtyStart * rowWords;
+			gfxContext.update2DTexture(updateParams);
+			dirtyStart = _height;
+		}
+		if (y < _height && m_rawRowNonZero[y] != 0)
+			bNonZero = true;
+	}
+
+	return bNonZero;
+}
+
+void RDRAMtoColorBuffer::_drawRawTexture(u32 _width, u32 _height, bool _bCFB)
+{
+	m_rawProgram->setImageParams(_width, _height, m_pCurBuffer->m_size, !_bCFB);
+
+	const f32 scale = m_pCurBuffer->m_scale;
+	GraphicsDrawer::CopyRectParams copyParams;
+	copyParams.srcX0 = 0;
+	copyParams.srcY0 = 0;
+	copyParams.srcX1 = _width;
+	copyParams.srcY1 = _height;
+	copyParams.srcWidth = _width;
+	copyParams.srcHeight = _height;
+	copyParams.dstX0 = 0;
+	copyParams.dstY0 = 0;
+	copyParams.dstX1 = (s32)(_width * scale);
+	copyParams.dstY1 = (s32)(_height * scale);
+	copyParams.dstWidth = (u32)(m_pCurBuffer->m_width * scale);
+	copyParams.dstHeight = (u32)(VI_GetMaxBufferHeight(m_pCurBuffer->m_width) * scale);
+	copyParams.tex[0] = m_pRawTexture;
+	copyParams.filter = textureParameters::FILTER_NEAREST;
+	copyParams.combiner = m_rawProgram.get();
+	copyParams.blend = true;
+
+	gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, m_pCurBuffer->m_FBO);
+	m_pCurBuffer->setAllRowsDirty();
+	gfxContext.setBlending(blend::SRC_ALPHA, blend::ONE_MINUS_SRC_ALPHA);
+	dwnd().getDrawer().copyTexturedRect(copyParams);
+
+	frameBufferList().setCurrentDrawBuffer();
+
+	gDP.changed |= CHANGED_RENDERMODE | CHANGED_COMBINE | CHANGED_SCISSOR;
+}
+
 void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 {
 	Cleaner cleaner(this);
@@ -203,6 +367,15 @@ void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 
 	const bool bUseAlpha = !_bCFB && m_pCurBuffer->m_changed;
 
+	// Raw RDRAM words are uploaded as they are, conversion is done by shader.
+	if (m_vecAddress.empty() && _canConvertOnGPU(address, width, height)) {
+		const bool bCopy = _updateRawTexture(address, width, height);
+		_clearBufferInRdram(address, width, height, m_pCurBuffer->m_size, bUseAlpha);
+		if (bCopy)
+			_drawRawTexture(width, height, _bCFB);
+		return;
+	}
+
 	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
 
 	m_pTexture->width = width;
@@ -248,14 +421,7 @@ void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 		}
 	}
 
-	if (!FBInfo::fbInfo.isSupported()) {
-		if (bUseAlpha && config.frameBufferEmulation.copyToRDRAM == Config::ctDisable) {
-			u32 totalBytes = (width * height) << m_pCurBuffer->m_size >> 1;
-			if (address + totalBytes > RDRAMSize + 1)
-				totalBytes = RDRAMSize + 1 - address;
-			memset(RDRAM + address, 0, totalBytes);
-		}
-	}
+	_clearBufferInRdram(address, width, height, m_pCurBuffer->m_size, bUseAlpha);
 
 	if (!bCopy)
 		return;
@@ -296,11 +462,13 @@ void RDRAMtoColorBuffer::copyFromRDRAM(u32 _address, bool _bCFB)
 	CombinerInfo::get().updateParameters();
 
 	gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, m_pCurBuffer->m_FBO);
+	m_pCurBuffer->setAllRowsDirty();
 
 	GraphicsDrawer::TexturedRectParams texRectParams((float)x0, (float)y0, (float)width, (float)height,
 										 1.0f, 1.0f, 0, 0,
 										 false, true, false, m_pCurBuffer);
 	dwnd().getDrawer().drawTexturedRect(texRectParams);
+	perf.addFBCopy();
 
 	frameBufferList().setCurrentDrawBuffer();
 
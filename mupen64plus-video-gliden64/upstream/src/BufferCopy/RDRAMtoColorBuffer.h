@@ -9,6 +9,10 @@
 struct CachedTexture;
 struct FrameBuffer;
 
+namespace graphics {
+	class RDRAMtoColorBufferShaderProgram;
+}
+
 class RDRAMtoColorBuffer
 {
 public:
@@ -26,6 +30,10 @@ private:
 
 	void reset();
 
+	bool _canConvertOnGPU(u32 _address, u32 _width, u32 _height) const;
+	bool _updateRawTexture(u32 _address, u32 _width, u32 _height);
+	void _drawRawTexture(u32 _width, u32 _height, bool _bCFB);
+
 	class Cleaner
 	{
 	public:
@@ -44,6 +52,17 @@ private:
 	CachedTexture * m_pTexture;
 	std::vector<u32> m_vecAddress;
 	u8* m_pbuf;
+
+	// Raw RDRAM words of the last buffer converted on GPU.
+	// Only rows which differ from m_rawShadow are uploaded again.
+	CachedTexture * m_pRawTexture;
+	std::unique_ptr<graphics::RDRAMtoColorBufferShaderProgram> m_rawProgram;
+	std::vector<u32> m_rawShadow;
+	std::vector<u8> m_rawRowNonZero;
+	u32 m_rawAddress;
+	u32 m_rawWidth;
+	u32 m_rawSize;
+	u32 m_rawHeight;
 };
 
 #endif // RDRAMtoColorBuffer_H
@@ -1,7 +1,14 @@
 #include "Types.h"
 
+// Builds the CRC table and selects the fastest implementation supported by the CPU.
 void CRC_Init();
 
+// Use xxHash instead of CRC32 for CRC_Calculate and CRC_CalculatePalette.
+// Their results are only used as texture cache keys within one session.
+// CRC_Calculate_Strict always returns standard CRC32, e.g. for ucode detection.
+void CRC_SetFastHash(bool _enable);
+const char * CRC_GetImplementationName();
+
 u32 CRC_Calculate_Strict( u32 crc, const void *buffer, u32 count );
 u32 CRC_Calculate( u32 crc, const void *buffer, u32 count );
 u32 CRC_CalculatePalette( u32 crc, const void *buffer, u32 count );
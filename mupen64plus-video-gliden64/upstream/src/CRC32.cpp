@@ -1,9 +1,18 @@
 #include "CRC.h"
+#include "CRC32.h"
 
 #define CRC32_POLYNOMIAL     0x04C11DB7
 
 unsigned int CRCTable[ 256 ];
 
+typedef u32 (*CRCFunc)(u32 crc, const void * buffer, u32 count);
+
+static CRCFunc crcStrict = CRC32_Calculate;
+static CRCFunc crcCalculate = CRC32_Calculate;
+static CRCFunc crcPalette = CRC32_CalculatePalette;
+static const char * crcName = "CRC32";
+static bool fastHash = false;
+
 static
 u32 Reflect( u32 ref, char ch )
 {
@@ -19,6 +28,40 @@ u32 Reflect( u32 ref, char ch )
 	 return value;
 }
 
+static
+void _selectImplementation()
+{
+	if (CRC32_ARMV8_Supported()) {
+		crcStrict = CRC32_ARMV8_Calculate;
+		crcCalculate = CRC32_ARMV8_Calculate;
+		crcPalette = CRC32_ARMV8_CalculatePalette;
+		crcName = "CRC32 ARMv8";
+	} else if (CRC32C_SSE42_Supported()) {
+		crcStrict = CRC32_Calculate;
+		crcCalculate = CRC32C_SSE42_Calculate;
+		crcPalette = CRC32C_SSE42_CalculatePalette;
+		crcName = "CRC32C SSE4.2";
+	} else {
+		crcStrict = CRC32_Calculate;
+		crcCalculate = CRC32_Calculate;
+		crcPalette = CRC32_CalculatePalette;
+		crcName = "CRC32";
+	}
+
+	if (!fastHash)
+		return;
+
+#ifdef __NEON_OPT
+	crcCalculate = XXH_NEON_Calculate;
+	crcPalette = XXH_NEON_CalculatePalette;
+	crcName = "xxHash NEON";
+#else
+	crcCalculate = XXH_Calculate;
+	crcPalette = XXH_CalculatePalette;
+	crcName = "xxHash";
+#endif
+}
+
 void CRC_Init()
 {
 	u32 crc;
@@ -30,9 +73,22 @@ void CRC_Init()
 
 		CRCTable[i] = Reflect( crc, 32 );
 	}
+
+	_selectImplementation();
 }
 
-u32 CRC_Calculate( u32 crc, const void * buffer, u32 count )
+void CRC_SetFastHash(bool _enable)
+{
+	fastHash = _enable;
+	_selectImplementation();
+}
+
+const char * CRC_GetImplementationName()
+{
+	return crcName;
+}
+
+u32 CRC32_Calculate( u32 crc, const void * buffer, u32 count )
 {
 	u8 *p;
 	u32 orig = crc;
@@ -44,12 +100,7 @@ u32 CRC_Calculate( u32 crc, const void * buffer, u32 count )
 	return crc ^ orig;
 }
 
-u32 CRC_Calculate_Strict( u32 crc, const void * buffer, u32 count )
-{
-	return CRC_Calculate(crc, buffer, count);
-}
-
-u32 CRC_CalculatePalette(u32 crc, const void * buffer, u32 count )
+u32 CRC32_CalculatePalette(u32 crc, const void * buffer, u32 count )
 {
 	u8 *p;
 	u32 orig = crc;
@@ -64,3 +115,18 @@ u32 CRC_CalculatePalette(u32 crc, const void * buffer, u32 count )
 
 	return crc ^ orig;
 }
+
+u32 CRC_Calculate_Strict( u32 crc, const void * buffer, u32 count )
+{
+	return crcStrict(crc, buffer, count);
+}
+
+u32 CRC_Calculate( u32 crc, const void * buffer, u32 count )
+{
+	return crcCalculate(crc, buffer, count);
+}
+
+u32 CRC_CalculatePalette(u32 crc, const void * buffer, u32 count )
+{
+	return crcPalette(crc, buffer, count);
+}
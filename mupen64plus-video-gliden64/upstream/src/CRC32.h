@@ -0,0 +1,31 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "Types.h"
+
+// Implementations CRC_Init selects from at run time.
+// The hardware ones return false from *_Supported() if the build or the CPU lacks them.
+
+u32 CRC32_Calculate(u32 crc, const void * buffer, u32 count);
+u32 CRC32_CalculatePalette(u32 crc, const void * buffer, u32 count);
+
+// ARMv8 crc32 instructions. Same polynomial as CRC32_Calculate.
+bool CRC32_ARMV8_Supported();
+u32 CRC32_ARMV8_Calculate(u32 crc, const void * buffer, u32 count);
+u32 CRC32_ARMV8_CalculatePalette(u32 crc, const void * buffer, u32 count);
+
+// SSE4.2 crc32 instruction. It uses the Castagnoli polynomial,
+// so results differ from CRC32_Calculate.
+bool CRC32C_SSE42_Supported();
+u32 CRC32C_SSE42_Calculate(u32 crc, const void * buffer, u32 count);
+u32 CRC32C_SSE42_CalculatePalette(u32 crc, const void * buffer, u32 count);
+
+u32 XXH_Calculate(u32 crc, const void * buffer, u32 count);
+u32 XXH_CalculatePalette(u32 crc, const void * buffer, u32 count);
+
+#ifdef __NEON_OPT
+u32 XXH_NEON_Calculate(u32 crc, const void * buffer, u32 count);
+u32 XXH_NEON_CalculatePalette(u32 crc, const void * buffer, u32 count);
+#endif
+
+#endif // CRC32_H
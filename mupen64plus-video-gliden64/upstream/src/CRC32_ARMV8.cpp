@@ -10,14 +10,27 @@
 // either express or implied. See the LICENSE file for specific language governing
 // rights and limitations of this software.
 
-#include "CRC.h"
+#include "CRC32.h"
+
+#if defined(__ARM_FEATURE_CRC32)
 #include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#endif
 
-void CRC_Init()
+bool CRC32_ARMV8_Supported()
 {
+	// The crc32 instructions are optional before ARMv8.1.
+#if defined(__linux__) && defined(__aarch64__)
+	return (getauxval(AT_HWCAP) & (1 << 7)) != 0;	// HWCAP_CRC32
+#elif defined(__linux__)
+	return (getauxval(AT_HWCAP2) & (1 << 4)) != 0;	// HWCAP2_CRC32
+#else
+	return true;
+#endif
 }
 
-u32 CRC_Calculate( u32 crc, const void * buffer, u32 count )
+u32 CRC32_ARMV8_Calculate( u32 crc, const void * buffer, u32 count )
 {
 	u8 *p;
 	u32 orig = crc;
@@ -47,12 +60,7 @@ u32 CRC_Calculate( u32 crc, const void * buffer, u32 count )
 	return crc ^ orig;
 }
 
-u32 CRC_Calculate_Strict( u32 crc, const void * buffer, u32 count )
-{
-	return CRC_Calculate(crc, buffer, count);
-}
-
-u32 CRC_CalculatePalette(u32 crc, const void * buffer, u32 count )
+u32 CRC32_ARMV8_CalculatePalette(u32 crc, const void * buffer, u32 count )
 {
 	u8 *p;
 	u32 orig = crc;
@@ -66,3 +74,22 @@ u32 CRC_CalculatePalette(u32 crc, const void * buffer, u32 count )
 
 	return crc ^ orig;
 }
+
+#else // __ARM_FEATURE_CRC32
+
+bool CRC32_ARMV8_Supported()
+{
+	return false;
+}
+
+u32 CRC32_ARMV8_Calculate(u32 crc, const void * buffer, u32 count)
+{
+	return CRC32_Calculate(crc, buffer, count);
+}
+
+u32 CRC32_ARMV8_CalculatePalette(u32 crc, const void * buffer, u32 count)
+{
+	return CRC32_CalculatePalette(crc, buffer, count);
+}
+
+#endif // __ARM_FEATURE_CRC32
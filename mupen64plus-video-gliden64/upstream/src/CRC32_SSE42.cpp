@@ -0,0 +1,89 @@
+#include <string.h>
+#include "CRC32.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SSE42_TARGET
+#else
+// Only these functions are compiled for SSE4.2, they run after the CPU check.
+#define SSE42_TARGET __attribute__((target("sse4.2")))
+#endif
+
+bool CRC32C_SSE42_Supported()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 20)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+}
+
+SSE42_TARGET
+u32 CRC32C_SSE42_Calculate(u32 crc, const void * buffer, u32 count)
+{
+	const u8 * p = (const u8*)buffer;
+	u32 orig = crc;
+
+#if defined(__x86_64__) || defined(_M_X64)
+	u64 crc64 = crc;
+	while (count >= 8) {
+		u64 data;
+		memcpy(&data, p, 8);
+		crc64 = _mm_crc32_u64(crc64, data);
+		p += 8;
+		count -= 8;
+	}
+	crc = u32(crc64);
+#endif
+	while (count >= 4) {
+		u32 data;
+		memcpy(&data, p, 4);
+		crc = _mm_crc32_u32(crc, data);
+		p += 4;
+		count -= 4;
+	}
+	while (count--)
+		crc = _mm_crc32_u8(crc, *p++);
+
+	return crc ^ orig;
+}
+
+SSE42_TARGET
+u32 CRC32C_SSE42_CalculatePalette(u32 crc, const void * buffer, u32 count)
+{
+	const u8 * p = (const u8*)buffer;
+	u32 orig = crc;
+
+	while (count--) {
+		u16 data;
+		memcpy(&data, p, 2);
+		crc = _mm_crc32_u16(crc, data);
+		p += 8;
+	}
+
+	return crc ^ orig;
+}
+
+#else // x86
+
+bool CRC32C_SSE42_Supported()
+{
+	return false;
+}
+
+u32 CRC32C_SSE42_Calculate(u32 crc, const void * buffer, u32 count)
+{
+	return CRC32_Calculate(crc, buffer, count);
+}
+
+u32 CRC32C_SSE42_CalculatePalette(u32 crc, const void * buffer, u32 count)
+{
+	return CRC32_CalculatePalette(crc, buffer, count);
+}
+
+#endif // x86
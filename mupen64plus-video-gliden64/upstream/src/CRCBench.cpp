@@ -0,0 +1,84 @@
+// Micro-benchmark of the CRC and hash implementations used for texture cache keys.
+// Build with -DCRC_BENCH=On and run crc_bench [iterations].
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "CRC.h"
+#include "CRC32.h"
+
+typedef u32 (*HashFunc)(u32 crc, const void * buffer, u32 count);
+
+struct HashImpl
+{
+	const char * name;
+	HashFunc calculate;
+	HashFunc palette;
+	bool supported;
+};
+
+static
+double measure(HashFunc _func, const u8 * _data, u32 _size, u32 _iterations, u32 & _result)
+{
+	u32 crc = 0xFFFFFFFF;
+	const auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < _iterations; ++i)
+		crc = _func(crc, _data, _size);
+	const auto end = std::chrono::steady_clock::now();
+	_result = crc;
+	return std::chrono::duration<double, std::nano>(end - start).count() / _iterations;
+}
+
+int main(int argc, char * argv[])
+{
+	const u32 iterations = argc > 1 ? u32(atoi(argv[1])) : 2000;
+
+	CRC_Init();
+
+	const HashImpl impls[] = {
+		{ "CRC32", CRC32_Calculate, CRC32_CalculatePalette, true },
+		{ "CRC32 ARMv8", CRC32_ARMV8_Calculate, CRC32_ARMV8_CalculatePalette, CRC32_ARMV8_Supported() },
+		{ "CRC32C SSE4.2", CRC32C_SSE42_Calculate, CRC32C_SSE42_CalculatePalette, CRC32C_SSE42_Supported() },
+		{ "xxHash", XXH_Calculate, XXH_CalculatePalette, true },
+#ifdef __NEON_OPT
+		{ "xxHash NEON", XXH_NEON_Calculate, XXH_NEON_CalculatePalette, true },
+#endif
+	};
+
+	// Palette, TMEM sized textures, a 320x240 16bit background.
+	const u32 sizes[] = { 32, 512, 2048, 4096, 320 * 240 * 2 };
+
+	std::vector<u8> data(320 * 240 * 2);
+	srand(1);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = u8(rand());
+
+	printf("Default: %s\n", CRC_GetImplementationName());
+	printf("%-16s", "GB/s at bytes");
+	for (u32 size : sizes)
+		printf("%12u", size);
+	printf("%12s\n", "palette");
+
+	for (const HashImpl & impl : impls) {
+		printf("%-16s", impl.name);
+		if (!impl.supported) {
+			printf("not supported\n");
+			continue;
+		}
+		u32 result;
+		for (u32 size : sizes) {
+			const double ns = measure(impl.calculate, data.data(), size, iterations, result);
+			printf("%12.2f", size / ns);
+		}
+		// gDP.paletteCRC16 hashes 16 entries of 8 bytes
+		const double ns = measure(impl.palette, data.data(), 16, iterations, result);
+		printf("%10.1fns\n", ns);
+	}
+
+	if (CRC32_ARMV8_Supported() &&
+		CRC32_ARMV8_Calculate(0xFFFFFFFF, data.data(), 4096) != CRC32_Calculate(0xFFFFFFFF, data.data(), 4096))
+		printf("CRC32 ARMv8 result differs from CRC32!\n");
+
+	return 0;
+}
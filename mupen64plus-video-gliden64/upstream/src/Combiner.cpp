@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <cstring>
@@ -10,6 +12,8 @@
 #include "Config.h"
 #include "PluginAPI.h"
 #include "RSP.h"
+#include "Log.h"
+#include "Performance.h"
 #include "Graphics/Context.h"
 
 using namespace graphics;
@@ -94,14 +98,24 @@ void CombinerInfo::init()
 {
 	gfxContext.resetCombinerProgramBuilder();
 	m_pCurrent = nullptr;
+	_clearRecentCombiners();
 
 	m_shadersLoaded = 0;
+	m_shadersPrewarmed = 0;
+	m_prewarmList.clear();
 	if (config.generalEmulation.enableShadersStorage != 0 && !_loadShadersStorage()) {
 		for (auto cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
 			delete cur->second;
 		m_combiners.clear();
 	}
 
+	for (auto cur = m_combiners.begin(); cur != m_combiners.end(); ++cur)
+		m_prewarmList.push_back(cur->second);
+	std::stable_sort(m_prewarmList.begin(), m_prewarmList.end(),
+		[](const CombinerProgram * _lhs, const CombinerProgram * _rhs) {
+			return _lhs->getUsageCount() > _rhs->getUsageCount();
+		});
+
 	if (m_combiners.empty()) {
 		setPolygonMode(DrawingState::TexRect);
 		gDP.otherMode.cycleType = G_CYC_COPY;
@@ -120,6 +134,9 @@ void CombinerInfo::destroy()
 	m_texrectCopyProgram.reset();
 
 	m_pCurrent = nullptr;
+	_clearRecentCombiners();
+	m_prewarmList.clear();
+	m_shadersPrewarmed = 0;
 	if (config.generalEmulation.enableShadersStorage != 0)
 		_saveShadersStorage();
 	m_shadersLoaded = 0;
@@ -265,6 +282,7 @@ graphics::CombinerProgram * Combiner_Compile(CombinerKey key)
 		}
 	}
 
+	perf.addShaderCompile();
 	return gfxContext.createCombinerProgram(color, alpha, key);
 }
 
@@ -289,14 +307,35 @@ void CombinerInfo::setCombine(u64 _mux )
 		m_bChanged = false;
 		return;
 	}
-	auto iter = m_combiners.find(key);
-	if (iter != m_combiners.end()) {
-		m_pCurrent = iter->second;
-	} else {
-		m_pCurrent = Combiner_Compile(key);
-		m_pCurrent->update(true);
-		m_combiners[m_pCurrent->getKey()] = m_pCurrent;
+	graphics::CombinerProgram * pCombiner = nullptr;
+	for (u32 i = 0; i < RecentCombinersCount; ++i) {
+		if (m_recentCombiners[i].mux == key.getMux() && m_recentCombiners[i].program != nullptr) {
+			pCombiner = m_recentCombiners[i].program;
+			break;
+		}
+	}
+	if (pCombiner == nullptr) {
+		auto iter = m_combiners.find(key);
+		if (iter != m_combiners.end()) {
+			pCombiner = iter->second;
+		} else {
+			pCombiner = Combiner_Compile(key);
+			m_combiners[pCombiner->getKey()] = pCombiner;
+			if (pCombiner->isReady())
+				pCombiner->update(true);
+		}
+		m_recentCombiners[m_recentCombinerIdx].mux = key.getMux();
+		m_recentCombiners[m_recentCombinerIdx].program = pCombiner;
+		m_recentCombinerIdx = (m_recentCombinerIdx + 1) % RecentCombinersCount;
+	}
+	// Keep drawing with the current program while the new one is linked in background.
+	// Rect and triangle programs use different vertex attributes, so they can't replace each other.
+	if (m_pCurrent != nullptr && m_pCurrent != m_shadowmapProgram.get() &&
+		m_pCurrent->getKey().isRectKey() == key.isRectKey() && !pCombiner->isReady()) {
+		m_bChanged = false;
+		return;
 	}
+	m_pCurrent = pCombiner;
 	m_bChanged = true;
 }
 
@@ -318,6 +357,30 @@ ShaderProgram * CombinerInfo::getTexrectCopyProgram()
 	return m_texrectCopyProgram.get();
 }
 
+void CombinerInfo::prewarmShaders()
+{
+	if (m_prewarmList.empty())
+		return;
+
+	const auto budget = std::chrono::milliseconds(2);
+	const auto start = std::chrono::steady_clock::now();
+	while (m_shadersPrewarmed < m_prewarmList.size()) {
+		m_prewarmList[m_shadersPrewarmed++]->isReady();
+		if (std::chrono::steady_clock::now() - start >= budget)
+			return;
+	}
+
+	LOG(LOG_VERBOSE, "%u stored combiner shaders pre-warmed\n", m_shadersPrewarmed);
+	m_prewarmList.clear();
+}
+
+f32 CombinerInfo::getShadersPrewarmProgress() const
+{
+	if (m_prewarmList.empty())
+		return 1.0f;
+	return f32(m_shadersPrewarmed) / f32(m_prewarmList.size());
+}
+
 bool CombinerInfo::isShaderCacheSupported() const
 {
 	return config.generalEmulation.enableShadersStorage != 0 && Context::ShaderProgramBinary;
@@ -336,6 +399,15 @@ void CombinerInfo::setPolygonMode(DrawingState _drawingState)
 	}
 }
 
+void CombinerInfo::_clearRecentCombiners()
+{
+	for (u32 i = 0; i < RecentCombinersCount; ++i) {
+		m_recentCombiners[i].mux = 0;
+		m_recentCombiners[i].program = nullptr;
+	}
+	m_recentCombinerIdx = 0;
+}
+
 void CombinerInfo::_saveShadersStorage() const
 {
 	if (m_shadersLoaded >= m_combiners.size())
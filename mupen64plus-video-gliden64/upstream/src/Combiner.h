@@ -133,6 +133,11 @@ public:
 	size_t getCombinersNumber() const { return m_combiners.size();  }
 	bool isShaderCacheSupported() const;
 
+	// Create programs loaded from shaders storage, most used first, within a small time budget.
+	void prewarmShaders();
+	// Fraction of stored programs which are ready to use.
+	f32 getShadersPrewarmProgress() const;
+
 	static CombinerInfo & get();
 
 	void setPolygonMode(DrawingState _drawingState);
@@ -144,20 +149,37 @@ private:
 		, m_rectMode(true)
 		, m_shadersLoaded(0)
 		, m_configOptionsBitSet(0)
-		, m_pCurrent(nullptr) {}
+		, m_shadersPrewarmed(0)
+		, m_pCurrent(nullptr)
+		, m_recentCombinerIdx(0) {
+		_clearRecentCombiners();
+	}
 	CombinerInfo(const CombinerInfo &) = delete;
 
 	void _saveShadersStorage() const;
 	bool _loadShadersStorage();
+	void _clearRecentCombiners();
 
 	bool m_bChanged;
 	bool m_rectMode;
 	u32 m_shadersLoaded;
 	u32 m_configOptionsBitSet;
+	u32 m_shadersPrewarmed;
 
 	graphics::CombinerProgram * m_pCurrent;
 	graphics::Combiners m_combiners;
 
+	// Programs used last, checked before m_combiners.
+	// Games often switch between a few combiners, e.g. for triangles and texrects.
+	struct RecentCombiner {
+		u64 mux;
+		graphics::CombinerProgram * program;
+	};
+	enum { RecentCombinersCount = 4 };
+	RecentCombiner m_recentCombiners[RecentCombinersCount];
+	u32 m_recentCombinerIdx;
+	std::vector<graphics::CombinerProgram *> m_prewarmList;
+
 	std::unique_ptr<graphics::ShaderProgram> m_shadowmapProgram;
 	std::unique_ptr<graphics::ShaderProgram> m_texrectCopyProgram;
 };
@@ -26,16 +26,22 @@ void Config::resetToDefaults()
 	video.verticalSync = 0;
 	video.cropMode = cmDisable;
 	video.cropWidth = video.cropHeight = 0;
+	video.threadedVideo = 0;
 
 	texture.maxAnisotropy = 0;
 	texture.bilinearMode = BILINEAR_STANDARD;
 	texture.screenShotFormat = 0;
+	texture.fastTextureHash = 0;
+	texture.enableGPUTMEM = 0;
 
 	generalEmulation.enableLOD = 1;
 	generalEmulation.enableNoise = 1;
+	generalEmulation.enableShaderNoise = 0;
 	generalEmulation.enableHWLighting = 0;
 	generalEmulation.enableCustomSettings = 1;
 	generalEmulation.enableShadersStorage = 1;
+	generalEmulation.enableAsyncShaderCompile = 0;
+	generalEmulation.enableVertexCache = 0;
 	generalEmulation.correctTexrectCoords = tcDisable;
 	generalEmulation.enableNativeResTexrects = 0;
 	generalEmulation.enableLegacyBlending = 0;
@@ -54,12 +60,16 @@ void Config::resetToDefaults()
 	frameBufferEmulation.copyDepthToRDRAM = cdSoftwareRender;
 	frameBufferEmulation.copyFromRDRAM = 0;
 	frameBufferEmulation.copyAuxToRDRAM = 0;
+	frameBufferEmulation.color16BitBuffers = 0;
 	frameBufferEmulation.copyToRDRAM = ctDoubleBuffer;
 	frameBufferEmulation.N64DepthCompare = 0;
 	frameBufferEmulation.forceDepthBufferClear = 0;
 	frameBufferEmulation.aspect = a43;
 	frameBufferEmulation.bufferSwapMode = bsOnVerticalInterrupt;
 	frameBufferEmulation.nativeResFactor = 0;
+	frameBufferEmulation.dynamicResolution = 0;
+	frameBufferEmulation.dynamicResMinFactor = 1;
+	frameBufferEmulation.dynamicResMaxFactor = 4;
 	frameBufferEmulation.fbInfoReadColorChunk = 0;
 	frameBufferEmulation.fbInfoReadDepthChunk = 1;
 #ifndef MUPENPLUSAPI
@@ -72,6 +82,8 @@ void Config::resetToDefaults()
 	textureFilter.txEnhancementMode = 0;
 	textureFilter.txDeposterize = 0;
 	textureFilter.txFilterIgnoreBG = 0;
+	textureFilter.txAsyncFilter = 0;
+	textureFilter.txGPUEnhancement = 0;
 	textureFilter.txCacheSize = 100 * gc_uMegabyte;
 
 	textureFilter.txHiresEnable = 0;
@@ -80,6 +92,7 @@ void Config::resetToDefaults()
 	textureFilter.txDump = 0;
 
 	textureFilter.txForce16bpp = 0;
+	textureFilter.txEtc2Compression = 0;
 	textureFilter.txCacheCompression = 1;
 	textureFilter.txSaveCache = 1;
 
@@ -113,9 +126,11 @@ void Config::resetToDefaults()
 	onScreenDisplay.vis = 0;
 	onScreenDisplay.fps = 0;
 	onScreenDisplay.percent = 0;
+	onScreenDisplay.statistics = 0;
 	onScreenDisplay.pos = posBottomLeft;
 
 	debug.dumpMode = 0;
+	debug.saveStatistics = 0;
 }
 
 bool isHWLightingAllowed()
@@ -33,6 +33,7 @@ struct Config
 		u32 cropMode;
 		u32 cropWidth;
 		u32 cropHeight;
+		u32 threadedVideo;
 	} video;
 
 	struct
@@ -41,6 +42,8 @@ struct Config
 		f32 maxAnisotropyF;
 		u32 bilinearMode;
 		u32 screenShotFormat;
+		u32 fastTextureHash;
+		u32 enableGPUTMEM;
 	} texture;
 
 	enum TexrectCorrectionMode {
@@ -51,10 +54,13 @@ struct Config
 
 	struct {
 		u32 enableNoise;
+		u32 enableShaderNoise;
 		u32 enableLOD;
 		u32 enableHWLighting;
 		u32 enableCustomSettings;
 		u32 enableShadersStorage;
+		u32 enableAsyncShaderCompile;
+		u32 enableVertexCache;
 		u32 correctTexrectCoords;
 		u32 enableNativeResTexrects;
 		u32 enableLegacyBlending;
@@ -100,9 +106,13 @@ struct Config
 		u32 aspect; // 0: stretch ; 1: 4/3 ; 2: 16/9; 3: adjust
 		u32 bufferSwapMode; // 0: on VI update call; 1: on VI origin change; 2: on main frame buffer update
 		u32 nativeResFactor;
+		u32 dynamicResolution;	// Change nativeResFactor at run time to keep GPU frame time within the frame budget
+		u32 dynamicResMinFactor;
+		u32 dynamicResMaxFactor;
 		u32 N64DepthCompare;
 		u32 forceDepthBufferClear;
 		u32 copyAuxToRDRAM;
+		u32 color16BitBuffers;	// Use RGBA5551 textures for 16-bit color images
 		// Buffer read/write
 		u32 copyToRDRAM;
 		u32 copyDepthToRDRAM;
@@ -121,7 +131,9 @@ struct Config
 		u32 txEnhancementMode;			// Texture enhancement mode, eg 2xSAI
 		u32 txDeposterize;				// Deposterize texture before enhancement
 		u32 txFilterIgnoreBG;			// Do not apply filtering to backgrounds textures
-		u32 txCacheSize;				// Cache size in Mbytes
+		u32 txAsyncFilter;				// Filter textures in background, show unfiltered texture meanwhile
+		u32 txGPUEnhancement;			// Run xBRZ enhancement in a compute shader if the GPU supports it
+		u32 txCacheSize;				// Cache size in Mbytes. Also limits hi-res textures held in memory
 
 		u32 txHiresEnable;				// Use high-resolution texture packs
 		u32 txHiresFullAlphaChannel;	// Use alpha channel fully
@@ -129,6 +141,7 @@ struct Config
 		u32 txDump;						// Dump textures
 
 		u32 txForce16bpp;				// Force use 16bit color textures
+		u32 txEtc2Compression;			// Compress hi-res and enhanced textures to ETC2, needs GLES 3
 		u32 txCacheCompression;			// Zip textures cache
 		u32 txSaveCache;				// Save texture cache to hard disk
 
@@ -167,11 +180,13 @@ struct Config
 		u32 percent;
 		u32 internalResolution;
 		u32 renderingResolution;
+		u32 statistics;
 		u32 pos;
 	} onScreenDisplay;
 
 	struct {
 		u32 dumpMode;
+		u32 saveStatistics;	// Write frame statistics to a CSV file in the user cache folder
 	} debug;
 
 	void resetToDefaults();
@@ -10,6 +10,7 @@
 #include "VI.h"
 #include "Config.h"
 #include "DebugDump.h"
+#include "DepthBufferRender/DepthBufferRender.h"
 #include <Graphics/Context.h>
 #include <Graphics/Parameters.h>
 #include "DisplayWindow.h"
@@ -194,6 +195,8 @@ void DepthBuffer::setDepthAttachment(ObjectHandle _fbo, BufferTargetParam _targe
 	if (Context::DepthFramebufferTextures) {
 		params.textureHandle = m_pDepthBufferTexture->name;
 		params.textureTarget = config.video.multisampling != 0 ? textureTarget::TEXTURE_2D_MULTISAMPLE : textureTarget::TEXTURE_2D;
+		// Depth is attached to frame buffers only, which color is multisampled the same way
+		params.multisampled = Context::MultisampledRenderToTexture;
 	} else {
 		params.textureHandle = m_depthRenderbuffer;
 		params.textureTarget = textureTarget::RENDERBUFFER;
@@ -483,9 +486,11 @@ void DepthBufferList::clearBuffer(u32 _ulx, u32 _uly, u32 _lrx, u32 _lry)
 void DepthBuffer_Init()
 {
 	depthBufferList().init();
+	InitRasterizer();
 }
 
 void DepthBuffer_Destroy()
 {
+	DestroyRasterizer();
 	depthBufferList().destroy();
 }
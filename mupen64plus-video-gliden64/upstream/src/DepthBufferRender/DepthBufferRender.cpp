@@ -15,20 +15,16 @@
 //****************************************************************
 
 #include <algorithm>
+#include <thread>
+#include <vector>
 #include "N64.h"
 #include "gDP.h"
+#include "Config.h"
+#include "BandWorkers.h"
 #include "FrameBuffer.h"
 #include "DepthBuffer.h"
 #include "DepthBufferRender.h"
 
-static vertexi * max_vtx;                   // Max y vertex (ending vertex)
-static vertexi * start_vtx, *end_vtx;      // First and last vertex in array
-static vertexi * right_vtx, *left_vtx;     // Current right and left vertex
-
-static int right_height, left_height;
-static int right_x, right_dxdy, left_x, left_dxdy;
-static int left_z, left_dzdy;
-
 __inline int imul16(int x, int y)        // (x * y) >> 16
 {
 	return (((long long)x) * ((long long)y)) >> 16;
@@ -50,12 +46,37 @@ __inline int iceil(int x)
 	return (x >> 16);
 }
 
-static
-void RightSection(void)
+// Depth buffer and horizontal scissor the polygons are drawn to
+struct DepthTarget
+{
+	u16 * destptr;
+	const u16 * zLUT;
+	int width;
+	int ulx, lrx;
+};
+
+// Edge walker state of one polygon. Each worker thread has its own.
+struct PolygonScan
+{
+	const vertexi * max_vtx;                   // Max y vertex (ending vertex)
+	const vertexi * start_vtx, *end_vtx;      // First and last vertex in array
+	const vertexi * right_vtx, *left_vtx;     // Current right and left vertex
+
+	int right_height, left_height;
+	int right_x, right_dxdy, left_x, left_dxdy;
+	int left_z, left_dzdy;
+
+	void RightSection();
+	void LeftSection();
+	// Draws rows _first_y .. _last_y - 1 of the polygon
+	void Draw(const vertexi * vtx, int vertices, int dzdx, int _first_y, int _last_y, const DepthTarget & _target);
+};
+
+void PolygonScan::RightSection()
 {
 	// Walk backwards trough the vertex array
 
-	vertexi * v2, *v1 = right_vtx;
+	const vertexi * v2, *v1 = right_vtx;
 	if (right_vtx > start_vtx)
 		v2 = right_vtx - 1;
 	else
@@ -94,12 +115,11 @@ void RightSection(void)
 	right_x = v1->x + imul16(prestep, right_dxdy);
 }
 
-static
-void LeftSection(void)
+void PolygonScan::LeftSection()
 {
 	// Walk forward trough the vertex array
 
-	vertexi * v2, *v1 = left_vtx;
+	const vertexi * v2, *v1 = left_vtx;
 	if (left_vtx < end_vtx)
 		v2 = left_vtx + 1;
 	else
@@ -141,15 +161,14 @@ void LeftSection(void)
 	left_z = v1->z + imul16(prestep, left_dzdy);
 }
 
-
-void Rasterize(vertexi * vtx, int vertices, int dzdx)
+void PolygonScan::Draw(const vertexi * vtx, int vertices, int dzdx, int _first_y, int _last_y, const DepthTarget & _target)
 {
 	start_vtx = vtx;        // First vertex in array
 
 	// Search trough the vtx array to find min y, max y
 	// and the location of these structures.
 
-	vertexi * min_vtx = vtx;
+	const vertexi * min_vtx = vtx;
 	max_vtx = vtx;
 
 	int min_y = vtx->y;
@@ -191,24 +210,24 @@ void Rasterize(vertexi * vtx, int vertices, int dzdx)
 		LeftSection();
 	} while (left_height <= 0);
 
-	u16 * destptr = (u16*)(RDRAM + gDP.depthImageAddress);
+	u16 * destptr = _target.destptr;
 	int y1 = iceil(min_y);
-	if (y1 >= (int)gDP.scissor.lry)
+	if (y1 >= _last_y)
 		return;
 	int shift;
 
-	const u16 * const zLUT = depthBufferList().getZLUT();
-	const u32 depthBufferWidth = depthBufferList().getCurrent()->m_width;
+	const u16 * const zLUT = _target.zLUT;
+	const int depthBufferWidth = _target.width;
 
 	for (;;) {
 		int x1 = iceil(left_x);
-		if (x1 < (int)gDP.scissor.ulx)
-			x1 = (int)gDP.scissor.ulx;
+		if (x1 < _target.ulx)
+			x1 = _target.ulx;
 		int width = iceil(right_x) - x1;
-		if (x1 + width >= (int)gDP.scissor.lrx)
-			width = (int)(gDP.scissor.lrx - x1 - 1);
+		if (x1 + width >= _target.lrx)
+			width = _target.lrx - x1 - 1;
 
-		if (width > 0 && y1 >= (int)gDP.scissor.uly) {
+		if (width > 0 && y1 >= _first_y) {
 
 			// Prestep initial z
 
@@ -234,7 +253,7 @@ void Rasterize(vertexi * vtx, int vertices, int dzdx)
 
 		//destptr += rdp.zi_width;
 		y1++;
-		if (y1 >= (int)gDP.scissor.lry)
+		if (y1 >= _last_y)
 			return;
 
 		// Scan the right side
@@ -262,3 +281,105 @@ void Rasterize(vertexi * vtx, int vertices, int dzdx)
 		}
 	}
 }
+
+struct RasterPolygon
+{
+	vertexi vtx[12];
+	int vertices;
+	int dzdx;
+	int top, bottom;    // Rows iceil(min y) to iceil(max y) - 1 are covered
+	int left, right;
+};
+
+static std::vector<RasterPolygon> polygons;
+// Worker threads drawing row bands of the depth buffer
+static BandWorkers workers;
+
+// Batches with less pixels than that are drawn in the calling thread
+static const u64 minParallelPixels = 8192;
+
+void Rasterize(const vertexi * vtx, int vertices, int dzdx)
+{
+	polygons.emplace_back();
+	RasterPolygon & polygon = polygons.back();
+	std::copy_n(vtx, vertices, polygon.vtx);
+	polygon.vertices = vertices;
+	polygon.dzdx = dzdx;
+
+	int min_y = vtx[0].y, max_y = vtx[0].y;
+	int min_x = vtx[0].x, max_x = vtx[0].x;
+	for (int n = 1; n < vertices; n++) {
+		min_y = std::min(min_y, vtx[n].y);
+		max_y = std::max(max_y, vtx[n].y);
+		min_x = std::min(min_x, vtx[n].x);
+		max_x = std::max(max_x, vtx[n].x);
+	}
+	polygon.top = iceil(min_y);
+	polygon.bottom = iceil(max_y);
+	polygon.left = iceil(min_x);
+	polygon.right = iceil(max_x);
+}
+
+void FlushRasterizer()
+{
+	if (polygons.empty())
+		return;
+
+	DepthTarget target;
+	target.destptr = (u16*)(RDRAM + gDP.depthImageAddress);
+	target.zLUT = depthBufferList().getZLUT();
+	target.width = (int)depthBufferList().getCurrent()->m_width;
+	target.ulx = (int)gDP.scissor.ulx;
+	target.lrx = (int)gDP.scissor.lrx;
+
+	// Rows and number of pixels touched by the batch
+	int top = (int)gDP.scissor.lry;
+	int bottom = (int)gDP.scissor.uly;
+	u64 pixels = 0;
+	for (const RasterPolygon & polygon : polygons) {
+		const int polygonTop = std::max(polygon.top, (int)gDP.scissor.uly);
+		const int polygonBottom = std::min(polygon.bottom, (int)gDP.scissor.lry);
+		if (polygonTop >= polygonBottom)
+			continue;
+		top = std::min(top, polygonTop);
+		bottom = std::max(bottom, polygonBottom);
+		const int polygonWidth = std::min(polygon.right, target.lrx) - std::max(polygon.left, target.ulx);
+		if (polygonWidth > 0)
+			pixels += u64(polygonWidth) * u64(polygonBottom - polygonTop);
+	}
+
+	if (top < bottom) {
+		// Each band is drawn by one thread. The depth test keeps the lowest value
+		// of any order, so the result is the same as drawing polygons one by one.
+		const u32 bands = pixels < minParallelPixels ? 1 : std::min(workers.size(), u32(bottom - top));
+		const int bandHeight = (bottom - top + int(bands) - 1) / int(bands);
+		workers.run(bands, [&](u32 _band) {
+			const int first_y = top + int(_band) * bandHeight;
+			const int last_y = std::min(first_y + bandHeight, bottom);
+			PolygonScan scan;
+			for (const RasterPolygon & polygon : polygons) {
+				if (polygon.top < last_y && polygon.bottom > first_y)
+					scan.Draw(polygon.vtx, polygon.vertices, polygon.dzdx, first_y, last_y, target);
+			}
+		});
+	}
+
+	polygons.clear();
+}
+
+void InitRasterizer()
+{
+	if (config.frameBufferEmulation.enable == 0 ||
+		config.frameBufferEmulation.copyDepthToRDRAM != Config::cdSoftwareRender)
+		return;
+
+	const u32 numThreads = std::min(std::thread::hardware_concurrency(), 4U);
+	if (numThreads > 1)
+		workers.start(numThreads);
+}
+
+void DestroyRasterizer()
+{
+	workers.stop();
+	polygons.clear();
+}
@@ -14,6 +14,13 @@ struct vertexi
 	int z;         // z value in 16:16 bit fixed point
 };
 
-void Rasterize(vertexi * vtx, int vertices, int dzdx);
+// Adds polygon to the batch drawn by FlushRasterizer
+void Rasterize(const vertexi * vtx, int vertices, int dzdx);
+
+// Draws batched polygons to the current depth buffer. Rows are split in bands drawn in parallel.
+void FlushRasterizer();
+
+void InitRasterizer();
+void DestroyRasterizer();
 
 #endif //DEPTH_BUFFER_RENDER_H
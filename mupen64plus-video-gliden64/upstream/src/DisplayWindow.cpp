@@ -1,9 +1,15 @@
 #include <assert.h>
 #include <cstdlib>
+#include <algorithm>
 #include "Config.h"
 #include "RSP.h"
 #include "VI.h"
+#include "Combiner.h"
+#include "Performance.h"
+#include "FrameBuffer.h"
+#include "DepthBuffer.h"
 #include "Graphics/Context.h"
+#include "Graphics/Parameters.h"
 #include "DisplayWindow.h"
 
 void DisplayWindow::start()
@@ -12,6 +18,11 @@ void DisplayWindow::start()
 	gfxContext.init();
 	m_drawer._initData();
 	m_buffersSwapCount = 0;
+	m_dynResVIs = 0;
+	m_dynResFrames = 0;
+	m_dynResSkipFrames = 0;
+	m_dynResFactor = 0;
+	m_dynResLoad = 0.0f;
 }
 
 void DisplayWindow::stop()
@@ -28,8 +39,15 @@ void DisplayWindow::restart()
 
 void DisplayWindow::swapBuffers()
 {
+	perf.endFrame();
+	_measureDynamicResolution();
 	m_drawer.drawOSD();
+	// Only color of the window is presented
+	gfxContext.invalidateFramebuffer(graphics::ObjectHandle::null,
+		graphics::BlitMaskParam(u32(graphics::blitMask::DEPTH_BUFFER) | u32(graphics::blitMask::STENCIL_BUFFER)));
 	_swapBuffers();
+	perf.startFrame();
+	CombinerInfo::get().prewarmShaders();
 	if (!RSP.LLE) {
 		if ((config.generalEmulation.hacks & hack_doNotResetOtherModeL) == 0)
 			gDP.otherMode.l = 0;
@@ -106,6 +124,73 @@ void DisplayWindow::updateScale()
 	m_scaleY = m_height / (float)VI.height;
 }
 
+// Frames averaged before the dynamic resolution factor is changed
+static const u32 DynResWindowFrames = 60;
+// Timer results arrive a few frames late, don't take ones of the old factor
+static const u32 DynResSkipFrames = 8;
+
+bool DisplayWindow::_isDynamicResolution() const
+{
+	return config.frameBufferEmulation.dynamicResolution != 0 &&
+		config.frameBufferEmulation.enable != 0 &&
+		config.frameBufferEmulation.nativeResFactor != 0 &&
+		gfxContext.GpuTimer;
+}
+
+void DisplayWindow::_measureDynamicResolution()
+{
+	if (!_isDynamicResolution() || m_dynResVIs == 0)
+		return;
+
+	const u32 vis = m_dynResVIs;
+	m_dynResVIs = 0;
+	const f32 gpuTime = perf.getGpuTime();
+	if (gpuTime < 0.0f)
+		return;
+	if (m_dynResSkipFrames != 0) {
+		--m_dynResSkipFrames;
+		return;
+	}
+
+	// The game decides how many VIs a frame lasts, that is the time the GPU has for it
+	const f32 budget = vis * (VI.PAL ? 20.0f : 16.683f);
+	m_dynResLoad += gpuTime / budget;
+	if (++m_dynResFrames < DynResWindowFrames)
+		return;
+
+	const f32 load = m_dynResLoad / m_dynResFrames;
+	m_dynResLoad = 0.0f;
+	m_dynResFrames = 0;
+
+	// Fragment work grows with the square of the factor. The gap between the two
+	// thresholds keeps the factor from going back and forth.
+	const u32 factor = config.frameBufferEmulation.nativeResFactor;
+	const f32 nextLoad = load * f32((factor + 1) * (factor + 1)) / f32(factor * factor);
+	if (load > 0.9f && factor > std::max(config.frameBufferEmulation.dynamicResMinFactor, 1U))
+		m_dynResFactor = factor - 1;
+	else if (nextLoad < 0.75f && factor < config.frameBufferEmulation.dynamicResMaxFactor)
+		m_dynResFactor = factor + 1;
+}
+
+void DisplayWindow::updateDynamicResolution()
+{
+	if (!_isDynamicResolution())
+		return;
+
+	++m_dynResVIs;
+	if (m_dynResFactor == 0 || m_dynResFactor == config.frameBufferEmulation.nativeResFactor)
+		return;
+
+	// Called between frames: buffers of the old scale are dropped and made again at the new one on next use
+	config.frameBufferEmulation.nativeResFactor = m_dynResFactor;
+	m_dynResFactor = 0;
+	m_dynResSkipFrames = DynResSkipFrames;
+	frameBufferList().destroy();
+	depthBufferList().destroy();
+	frameBufferList().init();
+	depthBufferList().init();
+}
+
 void DisplayWindow::_setBufferSize()
 {
 	m_bAdjustScreen = false;
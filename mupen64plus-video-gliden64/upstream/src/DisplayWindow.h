@@ -22,6 +22,7 @@ public:
 	void readScreen2(void * _dest, int * _width, int * _height, int _front);
 
 	void updateScale();
+	void updateDynamicResolution();
 	f32 getScaleX() const { return m_scaleX; }
 	f32 getScaleY() const { return m_scaleY; }
 	f32 getAdjustScale() const { return m_adjustScale; }
@@ -62,11 +63,20 @@ protected:
 	f32 m_scaleY = 0;
 	f32 m_adjustScale = 0;
 
+	u32 m_dynResVIs = 0;
+	u32 m_dynResFrames = 0;
+	u32 m_dynResSkipFrames = 0;
+	u32 m_dynResFactor = 0;
+	f32 m_dynResLoad = 0.0f;
+
 	wchar_t m_strScreenDirectory[PLUGIN_PATH_SIZE];
 
 private:
 	GraphicsDrawer m_drawer;
 
+	bool _isDynamicResolution() const;
+	void _measureDynamicResolution();
+
 	virtual bool _start() = 0;
 	virtual void _stop() = 0;
 	virtual void _swapBuffers() = 0;
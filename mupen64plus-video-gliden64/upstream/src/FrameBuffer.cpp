@@ -54,6 +54,8 @@ FrameBuffer::FrameBuffer()
 	, m_resolved(false)
 	, m_pSubTexture(nullptr)
 	, m_copied(false)
+	, m_dirtyTop(0)
+	, m_dirtyBottom(~0U)
 	, m_pFrameBufferCopyTexture(nullptr)
 	, m_copyFBO(ObjectHandle::null)
 {
@@ -75,6 +77,16 @@ FrameBuffer::~FrameBuffer()
 	textureCache().removeFrameBufferTexture(m_pFrameBufferCopyTexture);
 }
 
+// 16-bit N64 color images don't need more than RGBA5551, and a 16-bit texture halves their bandwidth.
+// Multisample resolve blits need equal formats on both sides, so this is not done with MSAA.
+static
+bool _is16BitColorBuffer(u16 _size)
+{
+	return _size == G_IM_SIZ_16b &&
+		config.frameBufferEmulation.color16BitBuffers != 0 &&
+		config.video.multisampling == 0;
+}
+
 void FrameBuffer::_initTexture(u16 _width, u16 _height, u16 _format, u16 _size, CachedTexture *_pTexture)
 {
 	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
@@ -96,7 +108,9 @@ void FrameBuffer::_initTexture(u16 _width, u16 _height, u16 _format, u16 _size,
 	_pTexture->realWidth = _pTexture->width;
 	_pTexture->realHeight = _pTexture->height;
 	_pTexture->textureBytes = _pTexture->realWidth * _pTexture->realHeight;
-	if (_size > G_IM_SIZ_8b)
+	if (_is16BitColorBuffer(_size))
+		_pTexture->textureBytes *= fbTexFormats.color16FormatBytes;
+	else if (_size > G_IM_SIZ_8b)
 		_pTexture->textureBytes *= fbTexFormats.colorFormatBytes;
 	else
 		_pTexture->textureBytes *= fbTexFormats.monochromeFormatBytes;
@@ -112,7 +126,11 @@ void FrameBuffer::_setAndAttachTexture(ObjectHandle _fbo, CachedTexture *_pTextu
 		initParams.msaaLevel = config.video.multisampling;
 	initParams.width = _pTexture->realWidth;
 	initParams.height = _pTexture->realHeight;
-	if (_pTexture->size > G_IM_SIZ_8b) {
+	if (_is16BitColorBuffer(_pTexture->size)) {
+		initParams.internalFormat = fbTexFormat.color16InternalFormat;
+		initParams.format = fbTexFormat.color16Format;
+		initParams.dataType = fbTexFormat.color16Type;
+	} else if (_pTexture->size > G_IM_SIZ_8b) {
 		initParams.internalFormat = fbTexFormat.colorInternalFormat;
 		initParams.format = fbTexFormat.colorFormat;
 		initParams.dataType = fbTexFormat.colorType;
@@ -139,6 +157,8 @@ void FrameBuffer::_setAndAttachTexture(ObjectHandle _fbo, CachedTexture *_pTextu
 	bufTarget.attachment = bufferAttachment::COLOR_ATTACHMENT0;
 	bufTarget.textureTarget = _multisampling ? textureTarget::TEXTURE_2D_MULTISAMPLE : textureTarget::TEXTURE_2D;
 	bufTarget.textureHandle = _pTexture->name;
+	// Only the frame buffer itself is rendered to, resolve and copy buffers are blit targets
+	bufTarget.multisampled = Context::MultisampledRenderToTexture && _fbo == m_FBO;
 	gfxContext.addFrameBufferRenderTarget(bufTarget);
 	assert(!gfxContext.isFramebufferError());
 }
@@ -178,6 +198,7 @@ void FrameBuffer::init(u32 _address, u16 _format, u16 _size, u16 _width, bool _c
 	m_cfb = _cfb;
 	m_cleared = false;
 	m_fingerprint = false;
+	setAllRowsDirty();
 
 	const u16 maxHeight = VI_GetMaxBufferHeight(_width);
 	_initTexture(_width, maxHeight, _format, _size, m_pTexture);
@@ -227,6 +248,9 @@ void FrameBuffer::setBufferClearParams(u32 _fillcolor, s32 _ulx, s32 _uly, s32 _
 
 void FrameBuffer::copyRdram()
 {
+	// RDRAM may differ from the buffer content. ColorBufferToRDRAM clears dirty rows after its own copies.
+	setAllRowsDirty();
+
 	const u32 stride = m_width << m_size >> 1;
 	const u32 height = _cutHeight(m_startAddress, m_height, stride);
 	if (height == 0)
@@ -262,6 +286,30 @@ void FrameBuffer::setDirty()
 	m_RdramCopy.clear();
 }
 
+void FrameBuffer::setDirtyRows(u32 _top, u32 _bottom)
+{
+	if (_top >= _bottom)
+		return;
+	if (m_dirtyTop >= m_dirtyBottom) {
+		m_dirtyTop = _top;
+		m_dirtyBottom = _bottom;
+	} else {
+		m_dirtyTop = min(m_dirtyTop, _top);
+		m_dirtyBottom = max(m_dirtyBottom, _bottom);
+	}
+}
+
+void FrameBuffer::setAllRowsDirty()
+{
+	m_dirtyTop = 0;
+	m_dirtyBottom = ~0U;
+}
+
+void FrameBuffer::clearDirtyRows()
+{
+	m_dirtyTop = m_dirtyBottom = 0;
+}
+
 bool FrameBuffer::isValid(bool _forceCheck) const
 {
 	if (!_forceCheck) {
@@ -321,6 +369,9 @@ void FrameBuffer::resolveMultisampledTexture(bool _bForce)
 	if (m_resolved && !_bForce)
 		return;
 
+	// The blit overwrites the whole resolve buffer, don't load its old contents
+	gfxContext.invalidateFramebuffer(m_resolveFBO, blitMask::COLOR_BUFFER);
+
 	Context::BlitFramebuffersParams blitParams;
 	blitParams.readBuffer = m_FBO;
 	blitParams.drawBuffer = m_resolveFBO;
@@ -441,6 +492,8 @@ CachedTexture * FrameBuffer::_copyFrameBufferTexture()
 	if (m_pFrameBufferCopyTexture == nullptr)
 		_initCopyTexture();
 
+	gfxContext.invalidateFramebuffer(m_copyFBO, blitMask::COLOR_BUFFER);
+
 	Context::BlitFramebuffersParams blitParams;
 	blitParams.readBuffer = m_FBO;
 	blitParams.drawBuffer = m_copyFBO;
@@ -551,11 +604,14 @@ void FrameBufferList::init()
 void FrameBufferList::destroy() {
 	gfxContext.bindFramebuffer(bufferTarget::FRAMEBUFFER, ObjectHandle::null);
 	m_list.clear();
+	m_index.clear();
+	m_maxBufferLength = 0;
+	_invalidateLastFind();
 	m_pCurrent = nullptr;
 	m_pCopy = nullptr;
 }
 
-void FrameBufferList::setBufferChanged(f32 _maxY)
+void FrameBufferList::setBufferChanged(f32 _minY, f32 _maxY)
 {
 	gDP.colorImage.changed = TRUE;
 	gDP.colorImage.height = max(gDP.colorImage.height, (u32)_maxY);
@@ -565,6 +621,11 @@ void FrameBufferList::setBufferChanged(f32 _maxY)
 		m_pCurrent->m_cfb = false;
 		m_pCurrent->m_changed = true;
 		m_pCurrent->m_copiedToRdram = false;
+		// One more row for rounding of scaled buffers
+		const f32 top = max(_minY, gDP.scissor.uly);
+		const f32 bottom = min(_maxY, gDP.scissor.lry);
+		if (top < bottom)
+			m_pCurrent->setDirtyRows(u32(max(top - 1.0f, 0.0f)), u32(ceilf(bottom)) + 1);
 	}
 }
 
@@ -584,21 +645,74 @@ void FrameBufferList::setCurrentDrawBuffer() const
 		gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, m_list.back().m_FBO);
 }
 
+FrameBufferList::Index::iterator FrameBufferList::_lowerBound(u32 _address)
+{
+	return std::lower_bound(m_index.begin(), m_index.end(), _address,
+		[](const IndexEntry & _entry, u32 _address) { return _entry.startAddress < _address; });
+}
+
+void FrameBufferList::_updateMaxBufferLength(const FrameBuffer & _buffer)
+{
+	m_maxBufferLength = max(m_maxBufferLength, _buffer.m_endAddress - _buffer.m_startAddress + 1);
+	_invalidateLastFind();
+}
+
+FrameBuffer & FrameBufferList::_addBuffer(u32 _address, u16 _format, u16 _size, u16 _width, bool _cfb)
+{
+	m_list.emplace_front();
+	FrameBuffer & buffer = m_list.front();
+	buffer.init(_address, _format, _size, _width, _cfb);
+
+	IndexEntry entry;
+	entry.startAddress = buffer.m_startAddress;
+	entry.order = ++m_order;
+	entry.buffer = m_list.begin();
+	m_index.insert(_lowerBound(entry.startAddress), entry);
+	_updateMaxBufferLength(buffer);
+	return buffer;
+}
+
+FrameBufferList::FrameBuffers::iterator FrameBufferList::_removeBuffer(FrameBuffers::iterator _iter)
+{
+	for (auto entry = _lowerBound(_iter->m_startAddress); entry != m_index.end(); ++entry) {
+		if (entry->buffer == _iter) {
+			m_index.erase(entry);
+			break;
+		}
+	}
+	_invalidateLastFind();
+	return m_list.erase(_iter);
+}
+
 FrameBuffer * FrameBufferList::findBuffer(u32 _startAddress)
 {
-	for (auto iter = m_list.begin(); iter != m_list.end(); ++iter) {
-		if (iter->m_startAddress <= _startAddress && iter->m_endAddress >= _startAddress) // [  {  ]
-			return &(*iter);
+	if (m_lastFindValid && m_lastFindAddress == _startAddress)
+		return m_pLastFound;
+
+	// The buffer nearest to m_list front among those containing the address, as a front to back scan would find.
+	// Only buffers starting less than m_maxBufferLength bytes before the address can contain it.
+	const IndexEntry * pFound = nullptr;
+	auto entry = std::upper_bound(m_index.begin(), m_index.end(), _startAddress,
+		[](u32 _address, const IndexEntry & _entry) { return _address < _entry.startAddress; });
+	while (entry != m_index.begin()) {
+		--entry;
+		if (_startAddress - entry->startAddress >= m_maxBufferLength)
+			break;
+		if (entry->buffer->m_endAddress >= _startAddress && (pFound == nullptr || entry->order > pFound->order)) // [  {  ]
+			pFound = &(*entry);
 	}
-	return nullptr;
+
+	m_lastFindAddress = _startAddress;
+	m_pLastFound = pFound != nullptr ? &(*pFound->buffer) : nullptr;
+	m_lastFindValid = true;
+	return m_pLastFound;
 }
 
 FrameBuffer * FrameBufferList::getBuffer(u32 _startAddress)
 {
-	for (auto iter = m_list.begin(); iter != m_list.end(); ++iter) {
-		if (iter->m_startAddress == _startAddress)
-			return &(*iter);
-	}
+	auto entry = _lowerBound(_startAddress);
+	if (entry != m_index.end() && entry->startAddress == _startAddress)
+		return &(*entry->buffer);
 	return nullptr;
 }
 
@@ -620,25 +734,35 @@ void FrameBufferList::removeIntersections()
 {
 	assert(!m_list.empty());
 
-	FrameBuffers::iterator iter = m_list.end();
-	do {
-		--iter;
-		if (&(*iter) == m_pCurrent)
-			continue;
-		if (iter->m_startAddress <= m_pCurrent->m_startAddress && iter->m_endAddress >= m_pCurrent->m_startAddress) { // [  {  ]
-			if (isOverlapping(&(*iter), m_pCurrent)) {
-				iter->m_endAddress = m_pCurrent->m_startAddress - 1;
+	// Buffers which may intersect the current one, visited from m_list back to front
+	const u32 currentStart = m_pCurrent->m_startAddress;
+	const u32 minStart = currentStart > m_maxBufferLength ? currentStart - m_maxBufferLength : 0;
+	const u32 maxStart = max(currentStart, m_pCurrent->m_endAddress);
+	Index candidates;
+	for (auto entry = _lowerBound(minStart); entry != m_index.end() && entry->startAddress <= maxStart; ++entry) {
+		if (&(*entry->buffer) != m_pCurrent)
+			candidates.push_back(*entry);
+	}
+	std::sort(candidates.begin(), candidates.end(),
+		[](const IndexEntry & _a, const IndexEntry & _b) { return _a.order < _b.order; });
+
+	_invalidateLastFind();
+	for (const IndexEntry & entry : candidates) {
+		FrameBuffer * pBuffer = &(*entry.buffer);
+		if (pBuffer->m_startAddress <= m_pCurrent->m_startAddress && pBuffer->m_endAddress >= m_pCurrent->m_startAddress) { // [  {  ]
+			if (isOverlapping(pBuffer, m_pCurrent)) {
+				pBuffer->m_endAddress = m_pCurrent->m_startAddress - 1;
 				continue;
 			}
-			iter = m_list.erase(iter);
-		} else if (m_pCurrent->m_startAddress <= iter->m_startAddress && m_pCurrent->m_endAddress >= iter->m_startAddress) { // {  [  }
-			if (isOverlapping(m_pCurrent, &(*iter))) {
-				m_pCurrent->m_endAddress = iter->m_startAddress - 1;
+			_removeBuffer(entry.buffer);
+		} else if (m_pCurrent->m_startAddress <= pBuffer->m_startAddress && m_pCurrent->m_endAddress >= pBuffer->m_startAddress) { // {  [  }
+			if (isOverlapping(m_pCurrent, pBuffer)) {
+				m_pCurrent->m_endAddress = pBuffer->m_startAddress - 1;
 				continue;
 			}
-			iter = m_list.erase(iter);
+			_removeBuffer(entry.buffer);
 		}
-	} while (iter != m_list.begin());
+	}
 }
 
 FrameBuffer * FrameBufferList::findTmpBuffer(u32 _address)
@@ -654,9 +778,7 @@ void FrameBufferList::_createScreenSizeBuffer()
 {
 	if (VI.height == 0)
 		return;
-	m_list.emplace_front();
-	FrameBuffer & buffer = m_list.front();
-	buffer.init(VI.width * 2, G_IM_FMT_RGBA, G_IM_SIZ_16b, VI.width, false);
+	_addBuffer(VI.width * 2, G_IM_FMT_RGBA, G_IM_SIZ_16b, VI.width, false);
 }
 
 void FrameBufferList::saveBuffer(u32 _address, u16 _format, u16 _size, u16 _width, bool _cfb)
@@ -689,6 +811,7 @@ void FrameBufferList::saveBuffer(u32 _address, u16 _format, u16 _size, u16 _widt
 		bPrevIsDepth = m_pCurrent->m_isDepthBuffer;
 		m_pCurrent->m_readable = true;
 		m_pCurrent->updateEndAddress();
+		_updateMaxBufferLength(*m_pCurrent);
 
 		if (!m_pCurrent->_isMarioTennisScoreboard() &&
 			!m_pCurrent->m_isDepthBuffer &&
@@ -723,6 +846,7 @@ void FrameBufferList::saveBuffer(u32 _address, u16 _format, u16 _size, u16 _widt
 				f32 fillColor[4];
 				gDPGetFillColor(fillColor);
 				wnd.getDrawer().clearColorBuffer(fillColor);
+				m_pCurrent->setAllRowsDirty();
 				m_pCurrent->m_size = _size;
 				m_pCurrent->m_pTexture->format = _format;
 				m_pCurrent->m_pTexture->size = _size;
@@ -738,10 +862,7 @@ void FrameBufferList::saveBuffer(u32 _address, u16 _format, u16 _size, u16 _widt
 	const bool bNew = m_pCurrent == nullptr;
 	if  (bNew) {
 		// Wasn't found or removed, create a new one
-		m_list.emplace_front();
-		FrameBuffer & buffer = m_list.front();
-		buffer.init(_address, _format, _size, _width, _cfb);
-		m_pCurrent = &buffer;
+		m_pCurrent = &_addBuffer(_address, _format, _size, _width, _cfb);
 
 		if (m_pCurrent->_isMarioTennisScoreboard() || ((config.generalEmulation.hacks & hack_legoRacers) != 0 && _width == VI.width))
 			RDRAMtoColorBuffer::get().copyFromRDRAM(m_pCurrent->m_startAddress + 4, true);
@@ -785,7 +906,7 @@ void FrameBufferList::removeAux()
 				m_pCurrent = nullptr;
 				gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
 			}
-			iter = m_list.erase(iter);
+			iter = _removeBuffer(iter);
 			if (iter == m_list.end())
 				return;
 		}
@@ -794,15 +915,15 @@ void FrameBufferList::removeAux()
 
 void FrameBufferList::removeBuffer(u32 _address )
 {
-	for (auto iter = m_list.begin(); iter != m_list.end(); ++iter)
-		if (iter->m_startAddress == _address) {
-			if (&(*iter) == m_pCurrent) {
-				m_pCurrent = nullptr;
-				gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
-			}
-			m_list.erase(iter);
-			return;
-		}
+	auto entry = _lowerBound(_address);
+	if (entry == m_index.end() || entry->startAddress != _address)
+		return;
+
+	if (&(*entry->buffer) == m_pCurrent) {
+		m_pCurrent = nullptr;
+		gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
+	}
+	_removeBuffer(entry->buffer);
 }
 
 void FrameBufferList::removeBuffers(u32 _width)
@@ -814,7 +935,7 @@ void FrameBufferList::removeBuffers(u32 _width)
 				m_pCurrent = nullptr;
 				gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
 			}
-			iter = m_list.erase(iter);
+			iter = _removeBuffer(iter);
 			if (iter == m_list.end())
 				return;
 		}
@@ -915,8 +1036,13 @@ void FrameBufferList::_renderScreenSizeBuffer()
 	GraphicsDrawer & drawer = wnd.getDrawer();
 	FrameBuffer *pBuffer = &m_list.back();
 	PostProcessor & postProcessor = PostProcessor::get();
-	FrameBuffer * pFilteredBuffer = postProcessor.doGammaCorrection(postProcessor.doOrientationCorrection(pBuffer));
-	CachedTexture * pBufferTexture = pFilteredBuffer->m_pTexture;
+	CachedTexture * pBufferTexture = pBuffer->m_pTexture;
+	ObjectHandle readBuffer = pBuffer->m_FBO;
+	if (postProcessor.isActive() && pBufferTexture->frameBufferTexture == CachedTexture::fbMultiSample) {
+		pBuffer->resolveMultisampledTexture(true);
+		readBuffer = pBuffer->m_resolveFBO;
+		pBufferTexture = pBuffer->m_pResolveTexture;
+	}
 
 	const u32 wndWidth = wnd.getWidth();
 	const u32 wndHeight = wnd.getHeight();
@@ -929,6 +1055,10 @@ void FrameBufferList::_renderScreenSizeBuffer()
 	const s32 vOffset = (screenHeight - wndHeight) / 2 + wndHeightOffset;
 	s32 dstCoord[4] = { hOffset, vOffset, hOffset + static_cast<s32>(wndWidth), vOffset + static_cast<s32>(wndHeight) };
 
+	// Depth is cleared after the swap, so it needn't be stored
+	if (config.frameBufferEmulation.forceDepthBufferClear != 0)
+		gfxContext.invalidateFramebuffer(pBuffer->m_FBO, blitMask::DEPTH_BUFFER);
+
 	gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
 
 	float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
@@ -952,10 +1082,14 @@ void FrameBufferList::_renderScreenSizeBuffer()
 	blitParams.filter = filter;
 	blitParams.mask = blitMask::COLOR_BUFFER;
 	blitParams.tex[0] = pBufferTexture;
-	blitParams.combiner = CombinerInfo::get().getTexrectCopyProgram();
-	blitParams.readBuffer = pFilteredBuffer->m_FBO;
+	blitParams.combiner = postProcessor.getCopyProgram();
+	blitParams.readBuffer = readBuffer;
 
-	drawer.blitOrCopyTexturedRect(blitParams);
+	// Post processing needs the shader copy, a blit can't apply it
+	if (postProcessor.isActive())
+		drawer.copyTexturedRect(blitParams);
+	else
+		drawer.blitOrCopyTexturedRect(blitParams);
 
 	gfxContext.bindFramebuffer(bufferTarget::READ_FRAMEBUFFER, ObjectHandle::null);
 
@@ -1181,13 +1315,13 @@ void FrameBufferList::renderBuffer()
 		srcY1 = srcY0 + srcHeight;
 	}
 	PostProcessor & postProcessor = PostProcessor::get();
-	FrameBuffer * pFilteredBuffer = postProcessor.doGammaCorrection(postProcessor.doOrientationCorrection(pBuffer));
+	FrameBuffer * pDisplayBuffer = pBuffer;
 
 	if (rdpRes.vi_fsaa && rdpRes.vi_divot)
 		Xdivot = 1;
 
 	const f32 viScaleX = _FIXED2FLOAT(_SHIFTR(*REG.VI_X_SCALE, 0, 12), 10);
-	const f32 srcScaleX = pFilteredBuffer->m_scale;
+	const f32 srcScaleX = pDisplayBuffer->m_scale;
 	const f32 dstScaleX = wnd.getScaleX();
 	const s32 hx0 = rdpRes.vi_h_start;
 	const s32 h0 = (rdpRes.vi_ispal ? 128 : 108);
@@ -1198,8 +1332,8 @@ void FrameBufferList::renderBuffer()
 	dstX1 = wnd.getWidth() - (s32)((hx1*viScaleX + Xdivot) * dstScaleX);
 	srcWidth -= Xoffset + Xdivot;
 
-	const f32 srcScaleY = pFilteredBuffer->m_scale;
-	CachedTexture * pBufferTexture = pFilteredBuffer->m_pTexture;
+	const f32 srcScaleY = pDisplayBuffer->m_scale;
+	CachedTexture * pBufferTexture = pDisplayBuffer->m_pTexture;
 	const s32 hCrop = config.video.cropMode == Config::cmDisable ? 0 : s32(config.video.cropWidth * srcScaleX);
 	const s32 vCrop = config.video.cropMode == Config::cmDisable ? 0 : s32(config.video.cropHeight * srcScaleY);
 	s32 srcCoord[4] = { hCrop,
@@ -1221,14 +1355,18 @@ void FrameBufferList::renderBuffer()
 	TextureParam filter = textureParameters::FILTER_LINEAR;
 	ObjectHandle readBuffer;
 
-	if (pFilteredBuffer->m_pTexture->frameBufferTexture == CachedTexture::fbMultiSample) {
-		pFilteredBuffer->resolveMultisampledTexture(true);
-		readBuffer = pFilteredBuffer->m_resolveFBO;
-		pBufferTexture = pFilteredBuffer->m_pResolveTexture;
+	if (pDisplayBuffer->m_pTexture->frameBufferTexture == CachedTexture::fbMultiSample) {
+		pDisplayBuffer->resolveMultisampledTexture(true);
+		readBuffer = pDisplayBuffer->m_resolveFBO;
+		pBufferTexture = pDisplayBuffer->m_pResolveTexture;
 	} else {
-		readBuffer = pFilteredBuffer->m_FBO;
+		readBuffer = pDisplayBuffer->m_FBO;
 	}
 
+	// Depth is cleared after the swap, so it needn't be stored
+	if (config.frameBufferEmulation.forceDepthBufferClear != 0 && m_pCurrent != nullptr)
+		gfxContext.invalidateFramebuffer(m_pCurrent->m_FBO, blitMask::DEPTH_BUFFER);
+
 	gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, ObjectHandle::null);
 	float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 	drawer.clearColorBuffer(clearColor);
@@ -1249,7 +1387,7 @@ void FrameBufferList::renderBuffer()
 	blitParams.filter = filter;
 	blitParams.mask = blitMask::COLOR_BUFFER;
 	blitParams.tex[0] = pBufferTexture;
-	blitParams.combiner = CombinerInfo::get().getTexrectCopyProgram();
+	blitParams.combiner = postProcessor.getCopyProgram();
 	blitParams.readBuffer = readBuffer;
 	blitParams.invertY = true;
 
@@ -1257,22 +1395,22 @@ void FrameBufferList::renderBuffer()
 
 	if (pNextBuffer != nullptr) {
 		pNextBuffer->m_isMainBuffer = true;
-		pFilteredBuffer = postProcessor.doGammaCorrection(postProcessor.doOrientationCorrection(pNextBuffer));
+		pDisplayBuffer = pNextBuffer;
 		srcY1 = srcPartHeight;
 		dstY0 = dstY1;
 		dstY1 = dstY0 + dstPartHeight;
-		if (pFilteredBuffer->m_pTexture->frameBufferTexture == CachedTexture::fbMultiSample) {
-			pFilteredBuffer->resolveMultisampledTexture();
-			readBuffer = pFilteredBuffer->m_resolveFBO;
-			pBufferTexture = pFilteredBuffer->m_pResolveTexture;
+		if (pDisplayBuffer->m_pTexture->frameBufferTexture == CachedTexture::fbMultiSample) {
+			pDisplayBuffer->resolveMultisampledTexture();
+			readBuffer = pDisplayBuffer->m_resolveFBO;
+			pBufferTexture = pDisplayBuffer->m_pResolveTexture;
 		}
 		else {
-			readBuffer = pFilteredBuffer->m_FBO;
-			pBufferTexture = pFilteredBuffer->m_pTexture;
+			readBuffer = pDisplayBuffer->m_FBO;
+			pBufferTexture = pDisplayBuffer->m_pTexture;
 		}
 
 		blitParams.srcY0 = 0;
-		blitParams.srcY1 = min((s32)(srcY1*srcScaleY), (s32)pFilteredBuffer->m_pTexture->realHeight);
+		blitParams.srcY1 = min((s32)(srcY1*srcScaleY), (s32)pDisplayBuffer->m_pTexture->realHeight);
 		blitParams.srcWidth = pBufferTexture->realWidth;
 		blitParams.srcHeight = pBufferTexture->realHeight;
 		blitParams.dstX0 = hOffset;
@@ -25,6 +25,9 @@ struct FrameBuffer
 	void setBufferClearParams(u32 _fillcolor, s32 _ulx, s32 _uly, s32 _lrx, s32 _lry);
 	void copyRdram();
 	void setDirty();
+	void setDirtyRows(u32 _top, u32 _bottom);
+	void setAllRowsDirty();
+	void clearDirtyRows();
 	bool isValid(bool _forceCheck) const;
 	bool _isMarioTennisScoreboard() const;
 	bool isAuxiliary() const;
@@ -43,6 +46,8 @@ struct FrameBuffer
 	bool m_isMainBuffer;
 	bool m_readable;
 	bool m_copied;
+	// Rows changed since the last synchronous copy to RDRAM, m_dirtyBottom is exclusive
+	u32 m_dirtyTop, m_dirtyBottom;
 
 	struct {
 		u32 uls, ult;
@@ -104,7 +109,7 @@ public:
 	FrameBuffer * getCurrent() const {return m_pCurrent;}
 	void setCurrent(FrameBuffer * _pCurrent) { m_pCurrent = _pCurrent; }
 	void renderBuffer();
-	void setBufferChanged(f32 _maxY);
+	void setBufferChanged(f32 _minY, f32 _maxY);
 	void clearBuffersChanged();
 	void setCurrentDrawBuffer() const;
 	void fillRDRAM(s32 ulx, s32 uly, s32 lrx, s32 lry);
@@ -118,19 +123,45 @@ public:
 	static FrameBufferList & get();
 
 private:
-	FrameBufferList() : m_pCurrent(nullptr), m_pCopy(nullptr), m_prevColorImageHeight(0) {}
+	FrameBufferList() : m_pCurrent(nullptr), m_pCopy(nullptr), m_prevColorImageHeight(0)
+		, m_order(0), m_maxBufferLength(0), m_lastFindAddress(0), m_pLastFound(nullptr), m_lastFindValid(false) {}
 	FrameBufferList(const FrameBufferList &) = delete;
 
+	typedef std::list<FrameBuffer> FrameBuffers;
+
+	// Address index of m_list. Sorted by start address, newer buffers go first for the same address.
+	// m_order grows with each created buffer, so a higher order means closer to m_list front.
+	struct IndexEntry
+	{
+		u32 startAddress;
+		u32 order;
+		FrameBuffers::iterator buffer;
+	};
+	typedef std::vector<IndexEntry> Index;
+
 	void removeIntersections();
 
+	FrameBuffer & _addBuffer(u32 _address, u16 _format, u16 _size, u16 _width, bool _cfb);
+	FrameBuffers::iterator _removeBuffer(FrameBuffers::iterator _iter);
+	Index::iterator _lowerBound(u32 _address);
+	void _updateMaxBufferLength(const FrameBuffer & _buffer);
+	void _invalidateLastFind() { m_lastFindValid = false; }
+
 	void _createScreenSizeBuffer();
 	void _renderScreenSizeBuffer();
 
-	typedef std::list<FrameBuffer> FrameBuffers;
 	FrameBuffers m_list;
 	FrameBuffer * m_pCurrent;
 	FrameBuffer * m_pCopy;
 	u32 m_prevColorImageHeight;
+
+	Index m_index;
+	u32 m_order;
+	// Upper bound of m_endAddress - m_startAddress + 1 over the buffers, limits index searches
+	u32 m_maxBufferLength;
+	u32 m_lastFindAddress;
+	FrameBuffer * m_pLastFound;
+	bool m_lastFindValid;
 };
 
 inline
@@ -85,6 +85,7 @@ typedef unsigned char boolean;
 #define BRZ6X_ENHANCEMENT   0x00000c00
 
 #define DEPOSTERIZE         0x00001000
+#define ASYNC_FILTER_TEX    0x00002000 /* filter textures in background, see txfilter_filterready */
 
 #define HIRESTEXTURES_MASK  0x000f0000
 #define NO_HIRESTEXTURES    0x00000000
@@ -99,7 +100,7 @@ typedef unsigned char boolean;
 #define DUMP_TEXCACHE       0x01000000
 #define DUMP_HIRESTEXCACHE  0x02000000
 #define TILE_HIRESTEX       0x04000000
-#define UNDEFINED_0         0x08000000
+#define ETC2_TEX            0x08000000 /* compress hi-res and enhanced textures to ETC2 */
 #define FORCE16BPP_HIRESTEX 0x10000000
 #define FORCE16BPP_TEX      0x20000000
 #define LET_TEXARTISTS_FLY  0x40000000 /* a little freedom for texture artists */
@@ -245,6 +246,12 @@ txfilter_reloadhirestex();
 TAPI void TAPIENTRY
 txfilter_dumpcache(void);
 
+TAPI boolean TAPIENTRY
+txfilter_filterready(uint64 g64crc);
+
+TAPI uint32 TAPIENTRY
+txfilter_trimcache(boolean all);
+
 #ifdef __cplusplus
 }
 #endif
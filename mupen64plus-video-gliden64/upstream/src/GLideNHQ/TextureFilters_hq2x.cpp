@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 /* 2007 Mudlord - Added hq2xS lq2xS filters */
 
 #include "TextureFilters.h"
+#include "TextureFilters_simd.h"
 
 /************************************************************************/
 /* hq2x filters                                                         */
@@ -268,6 +269,35 @@ static int hq2x_interp_32_diff(uint32 p1, uint32 p2)
   return 0;
 }
 
+#ifdef TXFILTER_SIMD
+/* hq2x_interp_32_diff(c[k], c[4]) of the 8 neighbours, 4 at a time */
+static inline simd_i32 hq2x_interp_32_diff4(simd_i32 p1, simd_i32 p2)
+{
+  const simd_i32 byteMask = simd_set1(0xFF);
+  const simd_i32 same = simd_cmpeq(simd_and(p1, simd_set1(0xF8F8F8)), simd_and(p2, simd_set1(0xF8F8F8)));
+
+  const simd_i32 r = simd_sub(simd_and(p1, byteMask), simd_and(p2, byteMask));
+  const simd_i32 g = simd_sub(simd_and(simd_srl<8>(p1), byteMask), simd_and(simd_srl<8>(p2), byteMask));
+  const simd_i32 b = simd_sub(simd_and(simd_srl<16>(p1), byteMask), simd_and(simd_srl<16>(p2), byteMask));
+
+  const simd_i32 y = simd_add(simd_add(r, g), b);
+  const simd_i32 u = simd_sub(r, b);
+  const simd_i32 v = simd_sub(simd_sub(simd_add(g, g), r), b);
+
+  const simd_i32 diff = simd_or(simd_or(simd_abs_gt(y, simd_set1(INTERP_Y_LIMIT)),
+                                        simd_abs_gt(u, simd_set1(INTERP_U_LIMIT))),
+                                simd_abs_gt(v, simd_set1(INTERP_V_LIMIT)));
+  return simd_andnot(same, diff);
+}
+
+static inline unsigned char hq2x_interp_32_mask(const uint32 *c)
+{
+  const simd_i32 center = simd_set1((int32_t)c[4]);
+  return (unsigned char)(simd_movemask(hq2x_interp_32_diff4(simd_load(c), center)) |
+                         (simd_movemask(hq2x_interp_32_diff4(simd_load(c + 5), center)) << 4));
+}
+#endif /* TXFILTER_SIMD */
+
 /*static void interp_set(unsigned bits_per_pixel)
 {
    interp_bits_per_pixel = bits_per_pixel;
@@ -556,6 +586,9 @@ static void hq2x_32_def(uint32* dst0, uint32* dst1, const uint32* src0, const ui
 	  c[8] = src2[0];
 	}
 
+#ifdef TXFILTER_SIMD
+	mask = hq2x_interp_32_mask(c);
+#else
 	mask = 0;
 
 	if (hq2x_interp_32_diff(c[0], c[4]))
@@ -574,6 +607,7 @@ static void hq2x_32_def(uint32* dst0, uint32* dst1, const uint32* src0, const ui
 	  mask |= 1 << 6;
 	if (hq2x_interp_32_diff(c[8], c[4]))
 	  mask |= 1 << 7;
+#endif
 
 #define P0 dst0[0]
 #define P1 dst0[1]
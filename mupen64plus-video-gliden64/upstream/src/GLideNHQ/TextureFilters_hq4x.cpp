@@ -26,6 +26,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include "TextureFilters.h"
+#include "TextureFilters_simd.h"
 
 #if !_16BPP_HACK
 static uint32 RGB444toYUV[4096];
@@ -346,6 +347,39 @@ static int Diff_##n (uint##b w1, uint##b w2) \
 
 HQ4X_DIFF(888, 32)
 
+#ifdef TXFILTER_SIMD
+/* RGB888toYUV of 4 pixels, components kept in separate lanes */
+static inline void RGB888toYUV4(simd_i32 val, simd_i32 &Y, simd_i32 &u, simd_i32 &v)
+{
+  const simd_i32 byteMask = simd_set1(0xFF);
+  const simd_i32 r = simd_and(val, byteMask);
+  const simd_i32 g = simd_and(simd_srl<8>(val), byteMask);
+  const simd_i32 b = simd_and(simd_srl<16>(val), byteMask);
+
+  Y = simd_sra<2>(simd_add(simd_add(r, g), b));
+  u = simd_sra<2>(simd_sub(simd_add(simd_set1(0x200), r), b));
+  v = simd_sra<3>(simd_sub(simd_sub(simd_add(simd_set1(0x400), simd_add(g, g)), r), b));
+}
+
+static inline unsigned Diff4_888(simd_i32 w, simd_i32 Y1, simd_i32 u1, simd_i32 v1)
+{
+  simd_i32 Y2, u2, v2;
+  RGB888toYUV4(w, Y2, u2, v2);
+  const simd_i32 diff = simd_or(simd_or(simd_abs_gt(simd_sub(Y1, Y2), simd_set1(trY >> 16)),
+                                        simd_abs_gt(simd_sub(u1, u2), simd_set1(trU >> 8))),
+                                simd_abs_gt(simd_sub(v1, v2), simd_set1(trV)));
+  return simd_movemask(diff);
+}
+
+/* pattern of Diff_888(w[k], w[5]) for the 8 neighbours of w[5] */
+static inline int hq4x_pattern_888(const uint32 *w)
+{
+  simd_i32 Y1, u1, v1;
+  RGB888toYUV4(simd_set1((int32_t)w[5]), Y1, u1, v1);
+  return (int)(Diff4_888(simd_load(w + 1), Y1, u1, v1) | (Diff4_888(simd_load(w + 6), Y1, u1, v1) << 4));
+}
+#endif /* TXFILTER_SIMD */
+
 #if !_16BPP_HACK
 HQ4X_DIFF(444, 16)
 HQ4X_DIFF(555, 16)
@@ -709,9 +743,11 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
   uint32  c[10];
 
   int pattern;
+#ifndef TXFILTER_SIMD
   int flag;
 
   int YUV1, YUV2;
+#endif
 
   //   +----+----+----+
   //   |    |    |    |
@@ -753,6 +789,9 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
 		w[9] = w[8];
 	  }
 
+#ifdef TXFILTER_SIMD
+	  pattern = hq4x_pattern_888(w);
+#else
 	  pattern = 0;
 	  flag = 1;
 
@@ -770,6 +809,7 @@ void hq4x_8888(unsigned char * pIn, unsigned char * pOut, int Xres, int Yres, in
 		}
 		flag <<= 1;
 	  }
+#endif
 
 	  for (k=1; k<=9; k++)
 		c[k] = w[k];
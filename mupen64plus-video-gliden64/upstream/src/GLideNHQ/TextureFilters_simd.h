@@ -0,0 +1,108 @@
+#ifndef __TEXTUREFILTERS_SIMD_H__
+#define __TEXTUREFILTERS_SIMD_H__
+
+/* 4 lane integer and float vectors for SSE2 and NEON, used by the color
+ * distance stages of hq2x, hq4x and xBRZ filters. Filters fall back to their
+ * scalar code if neither is available or TXFILTER_NO_SIMD is defined. */
+
+#if !defined(TXFILTER_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TXFILTER_SIMD 1
+#define TXFILTER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TXFILTER_SIMD 1
+#define TXFILTER_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef TXFILTER_SIMD
+
+#include <stdint.h>
+
+#ifdef TXFILTER_SSE2
+typedef __m128i simd_i32;
+typedef __m128 simd_f32;
+
+static inline simd_i32 simd_load(const void *p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline simd_i32 simd_set1(int32_t v) { return _mm_set1_epi32(v); }
+static inline simd_i32 simd_set(int32_t v0, int32_t v1, int32_t v2, int32_t v3) { return _mm_setr_epi32(v0, v1, v2, v3); }
+static inline simd_i32 simd_add(simd_i32 a, simd_i32 b) { return _mm_add_epi32(a, b); }
+static inline simd_i32 simd_sub(simd_i32 a, simd_i32 b) { return _mm_sub_epi32(a, b); }
+static inline simd_i32 simd_and(simd_i32 a, simd_i32 b) { return _mm_and_si128(a, b); }
+static inline simd_i32 simd_or(simd_i32 a, simd_i32 b) { return _mm_or_si128(a, b); }
+static inline simd_i32 simd_andnot(simd_i32 a, simd_i32 b) { return _mm_andnot_si128(a, b); } /* ~a & b */
+static inline simd_i32 simd_cmpeq(simd_i32 a, simd_i32 b) { return _mm_cmpeq_epi32(a, b); }
+static inline simd_i32 simd_cmpgt(simd_i32 a, simd_i32 b) { return _mm_cmpgt_epi32(a, b); }
+template <int N> static inline simd_i32 simd_srl(simd_i32 a) { return _mm_srli_epi32(a, N); }
+template <int N> static inline simd_i32 simd_sra(simd_i32 a) { return _mm_srai_epi32(a, N); }
+static inline unsigned simd_movemask(simd_i32 m) { return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(m)); }
+
+static inline simd_f32 simd_tof32(simd_i32 a) { return _mm_cvtepi32_ps(a); }
+static inline simd_f32 simd_setf(float v) { return _mm_set1_ps(v); }
+static inline simd_f32 simd_addf(simd_f32 a, simd_f32 b) { return _mm_add_ps(a, b); }
+static inline simd_f32 simd_subf(simd_f32 a, simd_f32 b) { return _mm_sub_ps(a, b); }
+static inline simd_f32 simd_mulf(simd_f32 a, simd_f32 b) { return _mm_mul_ps(a, b); }
+static inline simd_f32 simd_minf(simd_f32 a, simd_f32 b) { return _mm_min_ps(a, b); }
+static inline simd_f32 simd_maxf(simd_f32 a, simd_f32 b) { return _mm_max_ps(a, b); }
+static inline simd_f32 simd_sqrtf(simd_f32 a) { return _mm_sqrt_ps(a); }
+static inline void simd_storef(float *p, simd_f32 a) { _mm_storeu_ps(p, a); }
+#endif
+
+#ifdef TXFILTER_NEON
+typedef int32x4_t simd_i32;
+typedef float32x4_t simd_f32;
+
+static inline simd_i32 simd_load(const void *p) { return vld1q_s32((const int32_t*)p); }
+static inline simd_i32 simd_set1(int32_t v) { return vdupq_n_s32(v); }
+static inline simd_i32 simd_set(int32_t v0, int32_t v1, int32_t v2, int32_t v3) { const int32_t v[4] = { v0, v1, v2, v3 }; return vld1q_s32(v); }
+static inline simd_i32 simd_add(simd_i32 a, simd_i32 b) { return vaddq_s32(a, b); }
+static inline simd_i32 simd_sub(simd_i32 a, simd_i32 b) { return vsubq_s32(a, b); }
+static inline simd_i32 simd_and(simd_i32 a, simd_i32 b) { return vandq_s32(a, b); }
+static inline simd_i32 simd_or(simd_i32 a, simd_i32 b) { return vorrq_s32(a, b); }
+static inline simd_i32 simd_andnot(simd_i32 a, simd_i32 b) { return vbicq_s32(b, a); } /* ~a & b */
+static inline simd_i32 simd_cmpeq(simd_i32 a, simd_i32 b) { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+static inline simd_i32 simd_cmpgt(simd_i32 a, simd_i32 b) { return vreinterpretq_s32_u32(vcgtq_s32(a, b)); }
+template <int N> static inline simd_i32 simd_srl(simd_i32 a) { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), N)); }
+template <int N> static inline simd_i32 simd_sra(simd_i32 a) { return vshrq_n_s32(a, N); }
+static inline unsigned simd_movemask(simd_i32 m)
+{
+	const int32_t bits[4] = { 1, 2, 4, 8 };
+	const int32x4_t b = vandq_s32(m, vld1q_s32(bits));
+	const int32x2_t s = vpadd_s32(vget_low_s32(b), vget_high_s32(b));
+	return (unsigned)vget_lane_s32(vpadd_s32(s, s), 0);
+}
+
+static inline simd_f32 simd_tof32(simd_i32 a) { return vcvtq_f32_s32(a); }
+static inline simd_f32 simd_setf(float v) { return vdupq_n_f32(v); }
+static inline simd_f32 simd_addf(simd_f32 a, simd_f32 b) { return vaddq_f32(a, b); }
+static inline simd_f32 simd_subf(simd_f32 a, simd_f32 b) { return vsubq_f32(a, b); }
+static inline simd_f32 simd_mulf(simd_f32 a, simd_f32 b) { return vmulq_f32(a, b); }
+static inline simd_f32 simd_minf(simd_f32 a, simd_f32 b) { return vminq_f32(a, b); }
+static inline simd_f32 simd_maxf(simd_f32 a, simd_f32 b) { return vmaxq_f32(a, b); }
+static inline simd_f32 simd_sqrtf(simd_f32 a)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vsqrtq_f32(a);
+#else
+	/* ARMv7 has no vector square root: 1/sqrt estimate refined by two Newton-Raphson steps */
+	const uint32x4_t zero = vceqq_f32(a, vdupq_n_f32(0.0f));
+	float32x4_t e = vrsqrteq_f32(a);
+	e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+	e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a, e), e));
+	return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(vmulq_f32(a, e)), zero));
+#endif
+}
+static inline void simd_storef(float *p, simd_f32 a) { vst1q_f32(p, a); }
+#endif
+
+/* lanes where |a| > limit */
+static inline simd_i32 simd_abs_gt(simd_i32 a, simd_i32 limit)
+{
+	return simd_or(simd_cmpgt(a, limit), simd_cmpgt(simd_sub(simd_set1(0), limit), a));
+}
+
+#endif /* TXFILTER_SIMD */
+
+#endif /* __TEXTUREFILTERS_SIMD_H__ */
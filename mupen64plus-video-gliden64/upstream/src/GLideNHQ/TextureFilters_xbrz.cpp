@@ -14,6 +14,7 @@
 // ****************************************************************************
 
 #include "TextureFilters_xbrz.h"
+#include "TextureFilters_simd.h"
 #include <cassert>
 #include <algorithm>
 #include <vector>
@@ -258,6 +259,46 @@ private:
 	std::vector<float> buffer; //consumes 64 MB memory; using double is only 2% faster, but takes 128 MB
 };
 
+#ifdef TXFILTER_SIMD
+//same distances as DistYCbCrBuffer, computed 4 at a time instead of looked up in 64 MB
+struct DistYCbCrSimd
+{
+	static simd_f32 dist4(simd_i32 pix1, simd_i32 pix2)
+	{
+		const simd_i32 byteMask = simd_set1(0xff);
+		const simd_i32 ones = simd_set1(255);
+		const simd_i32 even = simd_set1(~1);
+
+		//precision is reduced like in DistYCbCrBuffer: diff -> (diff + 255) / 2 * 2 - 255
+		auto quantize = [&](simd_i32 diff) { return simd_tof32(simd_sub(simd_and(simd_add(diff, ones), even), ones)); };
+		const simd_f32 r_diff = quantize(simd_sub(simd_and(pix1, byteMask), simd_and(pix2, byteMask)));
+		const simd_f32 g_diff = quantize(simd_sub(simd_and(simd_srl<8>(pix1), byteMask), simd_and(simd_srl<8>(pix2), byteMask)));
+		const simd_f32 b_diff = quantize(simd_sub(simd_and(simd_srl<16>(pix1), byteMask), simd_and(simd_srl<16>(pix2), byteMask)));
+
+		const float k_b = 0.0593f; //ITU-R BT.2020 conversion
+		const float k_r = 0.2627f; //
+		const float k_g = 1 - k_b - k_r;
+
+		const float scale_b = 0.5f / (1 - k_b);
+		const float scale_r = 0.5f / (1 - k_r);
+
+		//DistYCbCrBuffer indexes its table with red and blue swapped, do the same
+		const simd_f32 y = simd_addf(simd_addf(simd_mulf(simd_setf(k_r), b_diff), simd_mulf(simd_setf(k_g), g_diff)), simd_mulf(simd_setf(k_b), r_diff));
+		const simd_f32 c_b = simd_mulf(simd_setf(scale_b), simd_subf(r_diff, y));
+		const simd_f32 c_r = simd_mulf(simd_setf(scale_r), simd_subf(b_diff, y));
+
+		return simd_sqrtf(simd_addf(simd_addf(simd_mulf(y, y), simd_mulf(c_b, c_b)), simd_mulf(c_r, c_r)));
+	}
+
+	static double dist(uint32_t pix1, uint32_t pix2)
+	{
+		float d[4];
+		simd_storef(d, dist4(simd_set1(static_cast<int32_t>(pix1)), simd_set1(static_cast<int32_t>(pix2))));
+		return d[0];
+	}
+};
+#endif
+
 enum BlendType
 {
 	BLEND_NONE = 0,
@@ -307,11 +348,20 @@ BlendResult preProcessCorners(const Kernel_4x4& ker, const xbrz::ScalerCfg& cfg)
 		ker.g == ker.k))
 		return result;
 
+	const int weight = 4;
+#ifdef TXFILTER_SIMD
+	float d[12];
+	ColorDistance::dist4(d, simd_set(ker.i, ker.f, ker.n, ker.k), simd_set(ker.f, ker.c, ker.k, ker.h), cfg.luminanceWeight);
+	ColorDistance::dist4(d + 4, simd_set(ker.e, ker.j, ker.b, ker.g), simd_set(ker.j, ker.o, ker.g, ker.l), cfg.luminanceWeight);
+	ColorDistance::dist4(d + 8, simd_set(ker.j, ker.f, ker.j, ker.f), simd_set(ker.g, ker.k, ker.g, ker.k), cfg.luminanceWeight);
+	double jg = double(d[0]) + d[1] + d[2] + d[3] + weight * double(d[8]);
+	double fk = double(d[4]) + d[5] + d[6] + d[7] + weight * double(d[9]);
+#else
 	auto dist = [&](uint32_t pix1, uint32_t pix2) { return ColorDistance::dist(pix1, pix2, cfg.luminanceWeight); };
 
-	const int weight = 4;
 	double jg = dist(ker.i, ker.f) + dist(ker.f, ker.c) + dist(ker.n, ker.k) + dist(ker.k, ker.h) + weight * dist(ker.j, ker.g);
 	double fk = dist(ker.e, ker.j) + dist(ker.j, ker.o) + dist(ker.b, ker.g) + dist(ker.g, ker.l) + weight * dist(ker.f, ker.k);
+#endif
 
 	if (jg < fk) //test sample: 70% of values max(jg, fk) / min(jg, fk) are between 1.1 and 3.7 with median being 1.8
 	{
@@ -431,8 +481,21 @@ const xbrz::ScalerCfg& cfg)
 
 	if (getBottomR(blend) >= BLEND_NORMAL)
 	{
-		auto eq = [&](uint32_t pix1, uint32_t pix2) { return ColorDistance::dist(pix1, pix2, cfg.luminanceWeight) < cfg.equalColorTolerance; };
+#ifdef TXFILTER_SIMD
+		//all color distances used below, 4 at a time
+		float dists[12];
+		ColorDistance::dist4(dists, simd_set(e, e, e, g), simd_set(g, c, i, h), cfg.luminanceWeight);
+		ColorDistance::dist4(dists + 4, simd_set(h, i, f, e), simd_set(i, f, c, f), cfg.luminanceWeight);
+		ColorDistance::dist4(dists + 8, simd_set(e, f, h, e), simd_set(h, g, c, e), cfg.luminanceWeight);
+		const double dist_eg = dists[0], dist_ec = dists[1], dist_ei = dists[2], dist_gh = dists[3];
+		const double dist_hi = dists[4], dist_if = dists[5], dist_fc = dists[6], dist_ef = dists[7];
+		const double dist_eh = dists[8], dist_fg = dists[9], dist_hc = dists[10];
+#define DIST(pix1, pix2) dist_##pix1##pix2
+#else
 		auto dist = [&](uint32_t pix1, uint32_t pix2) { return ColorDistance::dist(pix1, pix2, cfg.luminanceWeight); };
+#define DIST(pix1, pix2) dist(pix1, pix2)
+#endif
+		auto eq = [&](double colorDist) { return colorDist < cfg.equalColorTolerance; };
 
 		const bool doLineBlend = [&]() -> bool
 		{
@@ -440,26 +503,27 @@ const xbrz::ScalerCfg& cfg)
 				return true;
 
 			//make sure there is no second blending in an adjacent rotation for this pixel: handles insular pixels, mario eyes
-			if (getTopR(blend) != BLEND_NONE && !eq(e, g)) //but support double-blending for 90 corners
+			if (getTopR(blend) != BLEND_NONE && !eq(DIST(e, g))) //but support double-blending for 90 corners
 				return false;
-			if (getBottomL(blend) != BLEND_NONE && !eq(e, c))
+			if (getBottomL(blend) != BLEND_NONE && !eq(DIST(e, c)))
 				return false;
 
 			//no full blending for L-shapes; blend corner only (handles "mario mushroom eyes")
-			if (!eq(e, i) && eq(g, h) && eq(h, i) && eq(i, f) && eq(f, c))
+			if (!eq(DIST(e, i)) && eq(DIST(g, h)) && eq(DIST(h, i)) && eq(DIST(i, f)) && eq(DIST(f, c)))
 				return false;
 
 			return true;
 		}();
 
-		const uint32_t px = dist(e, f) <= dist(e, h) ? f : h; //choose most similar color
+		const uint32_t px = DIST(e, f) <= DIST(e, h) ? f : h; //choose most similar color
 
 		OutputMatrix<Scaler::scale, rotDeg> out(target, trgWidth);
 
 		if (doLineBlend)
 		{
-			const double fg = dist(f, g); //test sample: 70% of values max(fg, hc) / min(fg, hc) are between 1.1 and 3.7 with median being 1.9
-			const double hc = dist(h, c); //
+			const double fg = DIST(f, g); //test sample: 70% of values max(fg, hc) / min(fg, hc) are between 1.1 and 3.7 with median being 1.9
+			const double hc = DIST(h, c); //
+#undef DIST
 
 			const bool haveShallowLine = cfg.steepDirectionThreshold * fg <= hc && e != g && d != g;
 			const bool haveSteepLine = cfg.steepDirectionThreshold * hc <= fg && e != c && b != c;
@@ -1031,12 +1095,23 @@ struct ColorDistanceBGR
 {
 	static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
 	{
+#ifdef TXFILTER_SIMD
+		return DistYCbCrSimd::dist(pix1, pix2);
+#else
 		return DistYCbCrBuffer::dist(pix1, pix2);
+#endif
 
 		//if (pix1 == pix2) //about 4% perf boost
 		//    return 0;
 		//return distYCbCr(pix1, pix2, luminanceWeight);
 	}
+
+#ifdef TXFILTER_SIMD
+	static void dist4(float* out, simd_i32 pix1, simd_i32 pix2, double luminanceWeight)
+	{
+		simd_storef(out, DistYCbCrSimd::dist4(pix1, pix2));
+	}
+#endif
 };
 
 struct ColorDistanceABGR
@@ -1055,7 +1130,11 @@ struct ColorDistanceABGR
 
 		//return std::min(a1, a2) * DistYCbCrBuffer::dist(pix1, pix2) + 255 * abs(a1 - a2);
 		//=> following code is 15% faster:
+#ifdef TXFILTER_SIMD
+		const double d = DistYCbCrSimd::dist(pix1, pix2);
+#else
 		const double d = DistYCbCrBuffer::dist(pix1, pix2);
+#endif
 		if (a1 < a2)
 			return a1 * d + 255 * (a2 - a1);
 		else
@@ -1063,6 +1142,17 @@ struct ColorDistanceABGR
 
 		//alternative? return std::sqrt(a1 * a2 * square(DistYCbCrBuffer::dist(pix1, pix2)) + square(255 * (a1 - a2)));
 	}
+
+#ifdef TXFILTER_SIMD
+	static void dist4(float* out, simd_i32 pix1, simd_i32 pix2, double luminanceWeight)
+	{
+		const simd_f32 a1 = simd_mulf(simd_tof32(simd_srl<24>(pix1)), simd_setf(1.0f / 255));
+		const simd_f32 a2 = simd_mulf(simd_tof32(simd_srl<24>(pix2)), simd_setf(1.0f / 255));
+		const simd_f32 aMin = simd_minf(a1, a2);
+		const simd_f32 d = DistYCbCrSimd::dist4(pix1, pix2);
+		simd_storef(out, simd_addf(simd_mulf(aMin, d), simd_mulf(simd_setf(255), simd_subf(simd_maxf(a1, a2), aMin))));
+	}
+#endif
 };
 
 
@@ -1089,7 +1179,9 @@ void xbrz::init()
 {
 	static bool inited = false;
 	if (!inited) {
+#ifndef TXFILTER_SIMD
 		DistYCbCrBuffer::dist(0, 0);
+#endif
 		inited = true;
 	}
 }
@@ -31,6 +31,42 @@
 #include <zlib.h>
 #include <memory.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <algorithm>
+
+/* Cache file layout:
+ *   TxCacheFileHeader
+ *   TxCacheFileEntry[count] sorted by checksum
+ *   texture data of each entry, zlib compressed if GL_TEXFMT_GZ is set in format
+ * The file is memory mapped by load() and entries are read from the mapping on
+ * first use, so only the table has to be valid at load time.
+ * Files written before this layout are gzip streams and still read as a whole.
+ */
+#define TXCACHE_FILE_MAGIC 0x31435447 /* "GTC1" */
+
+struct TxCacheFileHeader {
+	uint32 magic;
+	int config;
+	uint32 count;
+	uint32 reserved;
+};
+
+struct TxCacheFileEntry {
+	uint64 checksum;
+	uint64 offset;
+	uint32 size;
+	uint32 format;
+	int width;
+	int height;
+	uint16 texture_format;
+	uint16 pixel_type;
+	uint8 is_hires_tex;
+	uint8 reserved[3];
+};
+
+static_assert(sizeof(TxCacheFileHeader) == 16 && sizeof(TxCacheFileEntry) == 40,
+			  "Cache file structures must not depend on the platform");
 
 TxCache::~TxCache()
 {
@@ -45,6 +81,7 @@ TxCache::TxCache(int options, int cachesize, const wchar_t *cachePath, const wch
 	_cacheSize = cachesize;
 	_callback = callback;
 	_totalSize = 0;
+	_cacheFileEntries = 0;
 
 	/* save path name */
 	if (cachePath)
@@ -177,10 +214,49 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 	return 1;
 }
 
+boolean
+TxCache::_uncompress(GHQTexInfo *info, uint32 size)
+{
+	/* zlib decompress it */
+	if (info->format & GL_TEXFMT_GZ) {
+		uLongf destLen = _gzdestLen;
+		uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
+		if (uncompress(dest, &destLen, info->data, size) != Z_OK) {
+			DBG_INFO(80, wst("Error: zlib decompression failed!\n"));
+			return 0;
+		}
+		info->data = dest;
+		info->format &= ~GL_TEXFMT_GZ;
+		DBG_INFO(80, wst("zlib decompressed: %.02fkb->%.02fkb\n"), (float)size/1000, (float)destLen/1000);
+	}
+
+	return 1;
+}
+
+const TxCacheFileEntry *
+TxCache::_findInCacheFile(uint64 checksum) const
+{
+	if (_cacheFileEntries == 0)
+		return nullptr;
+
+	const TxCacheFileEntry *begin = (const TxCacheFileEntry*)(_cacheFile.data() + sizeof(TxCacheFileHeader));
+	const TxCacheFileEntry *end = begin + _cacheFileEntries;
+	const TxCacheFileEntry *entry = std::lower_bound(begin, end, checksum,
+		[](const TxCacheFileEntry & _entry, uint64 _checksum) { return _entry.checksum < _checksum; });
+	if (entry == end || entry->checksum != checksum)
+		return nullptr;
+
+	/* the table is validated at load time. the data is checked here */
+	if (entry->offset > _cacheFile.size() || entry->size > _cacheFile.size() - entry->offset)
+		return nullptr;
+
+	return entry;
+}
+
 boolean
 TxCache::get(uint64 checksum, GHQTexInfo *info)
 {
-	if (!checksum || _cache.empty()) return 0;
+	if (!checksum) return 0;
 
 	/* find a match in cache */
 	auto itMap = _cache.find(checksum);
@@ -195,20 +271,22 @@ TxCache::get(uint64 checksum, GHQTexInfo *info)
 			((*itMap).second)->it = --(_cachelist.end());
 		}
 
-		/* zlib decompress it */
-		if (info->format & GL_TEXFMT_GZ) {
-			uLongf destLen = _gzdestLen;
-			uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
-			if (uncompress(dest, &destLen, info->data, ((*itMap).second)->size) != Z_OK) {
-				DBG_INFO(80, wst("Error: zlib decompression failed!\n"));
-				return 0;
-			}
-			info->data = dest;
-			info->format &= ~GL_TEXFMT_GZ;
-			DBG_INFO(80, wst("zlib decompressed: %.02fkb->%.02fkb\n"), (float)(((*itMap).second)->size)/1000, (float)destLen/1000);
-		}
+		return _uncompress(info, ((*itMap).second)->size);
+	}
 
-		return 1;
+	/* read it from the mapped cache file */
+	const TxCacheFileEntry *entry = _findInCacheFile(checksum);
+	if (entry != nullptr) {
+		/* uncompressed data is used in place. it must not be modified. */
+		info->data = const_cast<uint8*>(_cacheFile.data() + entry->offset);
+		info->width = entry->width;
+		info->height = entry->height;
+		info->format = entry->format;
+		info->texture_format = entry->texture_format;
+		info->pixel_type = entry->pixel_type;
+		info->is_hires_tex = entry->is_hires_tex;
+
+		return _uncompress(info, entry->size);
 	}
 
 	return 0;
@@ -217,9 +295,46 @@ TxCache::get(uint64 checksum, GHQTexInfo *info)
 boolean
 TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 {
-	if (_cache.empty())
+	if (empty())
 		return 0;
 
+	/* textures to save: memory cache and entries of the mapped cache file */
+	struct SaveEntry {
+		TxCacheFileEntry entry;
+		const uint8 *data;
+	};
+	std::vector<SaveEntry> entries;
+	entries.reserve(_cache.size() + _cacheFileEntries);
+
+	const TxCacheFileEntry *fileBegin = (const TxCacheFileEntry*)(_cacheFile.data() + sizeof(TxCacheFileHeader));
+	const TxCacheFileEntry *fileEnd = fileBegin + _cacheFileEntries;
+	auto itMap = _cache.begin();
+	while (itMap != _cache.end() || fileBegin != fileEnd) {
+		SaveEntry saveEntry;
+		memset(&saveEntry.entry, 0, sizeof(TxCacheFileEntry));
+		if (fileBegin == fileEnd || (itMap != _cache.end() && (*itMap).first <= fileBegin->checksum)) {
+			const TXCACHE *txCache = (*itMap).second;
+			if (fileBegin != fileEnd && fileBegin->checksum == (*itMap).first)
+				++fileBegin;
+			saveEntry.entry.checksum = (*itMap).first;
+			saveEntry.entry.size = txCache->size;
+			saveEntry.entry.format = txCache->info.format;
+			saveEntry.entry.width = txCache->info.width;
+			saveEntry.entry.height = txCache->info.height;
+			saveEntry.entry.texture_format = txCache->info.texture_format;
+			saveEntry.entry.pixel_type = txCache->info.pixel_type;
+			saveEntry.entry.is_hires_tex = txCache->info.is_hires_tex;
+			saveEntry.data = txCache->info.data;
+			++itMap;
+		} else {
+			saveEntry.entry = *fileBegin;
+			saveEntry.data = _findInCacheFile(fileBegin->checksum) != nullptr ? _cacheFile.data() + fileBegin->offset : nullptr;
+			++fileBegin;
+		}
+		if (saveEntry.data != nullptr && saveEntry.entry.size != 0)
+			entries.push_back(saveEntry);
+	}
+
 	/* dump cache to disk */
 	char cbuf[MAX_PATH];
 
@@ -239,63 +354,73 @@ TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 
 	wcstombs(cbuf, filename, MAX_PATH);
 
-	gzFile gzfp = gzopen(cbuf, "wb1");
-	DBG_INFO(80, wst("gzfp:%x file:%ls\n"), gzfp, filename);
-	if (gzfp) {
-		/* write header to determine config match */
-		gzwrite(gzfp, &config, 4);
+	/* write to a temporary file. the current one is still mapped. */
+	const std::string tmpname = std::string(cbuf) + ".tmp";
+	FILE *fp = fopen(tmpname.c_str(), "wb");
+	DBG_INFO(80, wst("fp:%x file:%ls\n"), fp, filename);
+	boolean saved = 0;
+	if (fp) {
+		TxCacheFileHeader header;
+		header.magic = TXCACHE_FILE_MAGIC;
+		header.config = config;
+		header.count = (uint32)entries.size();
+		header.reserved = 0;
+
+		uint64 offset = sizeof(TxCacheFileHeader) + sizeof(TxCacheFileEntry) * entries.size();
+		for (SaveEntry & saveEntry : entries) {
+			saveEntry.entry.offset = offset;
+			offset += saveEntry.entry.size;
+		}
 
-		auto itMap = _cache.begin();
-		int total = 0;
-		while (itMap != _cache.end()) {
-			uint8 *dest = (*itMap).second->info.data;
-			uint32 destLen = (*itMap).second->size;
-			uint32 format = (*itMap).second->info.format;
-
-			/* to keep things simple, we save the texture data in a zlib uncompressed state. */
-			/* sigh... for those who cannot wait the extra few seconds. changed to keep
-	 * texture data in a zlib compressed state. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
-	 * option is toggled, the cache will need to be rebuilt.
-	 */
-			/*if (format & GL_TEXFMT_GZ) {
-	  dest = _gzdest0;
-	  destLen = _gzdestLen;
-	  if (dest && destLen) {
-	  if (uncompress(dest, &destLen, (*itMap).second->info.data, (*itMap).second->size) != Z_OK) {
-	  dest = nullptr;
-	  destLen = 0;
-	  }
-	  format &= ~GL_TEXFMT_GZ;
-	  }
-	  }*/
-
-			if (dest && destLen) {
-				/* texture checksum */
-				gzwrite(gzfp, &((*itMap).first), 8);
-
-				/* other texture info */
-				gzwrite(gzfp, &((*itMap).second->info.width), 4);
-				gzwrite(gzfp, &((*itMap).second->info.height), 4);
-				gzwrite(gzfp, &format, 4);
-				gzwrite(gzfp, &((*itMap).second->info.texture_format), 2);
-				gzwrite(gzfp, &((*itMap).second->info.pixel_type), 2);
-				gzwrite(gzfp, &((*itMap).second->info.is_hires_tex), 1);
-
-				gzwrite(gzfp, &destLen, 4);
-				gzwrite(gzfp, dest, destLen);
-			}
+		saved = fwrite(&header, sizeof(header), 1, fp) == 1;
+		for (auto it = entries.begin(); saved && it != entries.end(); ++it)
+			saved = fwrite(&it->entry, sizeof(TxCacheFileEntry), 1, fp) == 1;
 
-			itMap++;
+		int total = 0;
+		for (auto it = entries.begin(); saved && it != entries.end(); ++it) {
+			saved = fwrite(it->data, it->entry.size, 1, fp) == 1;
 
-			if (_callback)
-				(*_callback)(wst("Total textures saved to HDD: %d\n"), ++total);
+			/* skip in between to prevent the loop from being tied down to vsync */
+			if (_callback && (!(++total % 100) || total == (int)entries.size()))
+				(*_callback)(wst("Total textures saved to HDD: %d\n"), total);
 		}
-		gzclose(gzfp);
+
+		saved = (fclose(fp) == 0) && saved;
 	}
 
+	if (saved) {
+		/* replace the old file and map the new one */
+		_cacheFile.close();
+		_cacheFileEntries = 0;
+		remove(cbuf);
+		saved = rename(tmpname.c_str(), cbuf) == 0;
+		if (saved)
+			_openCacheFile(cbuf, config);
+	} else if (fp)
+		remove(tmpname.c_str());
+
 	CHDIR(curpath);
 
-	return _cache.empty() ? 0 : 1;
+	return saved;
+}
+
+boolean
+TxCache::_openCacheFile(const char *filename, int config)
+{
+	_cacheFileEntries = 0;
+	if (!_cacheFile.open(filename))
+		return 0;
+
+	const TxCacheFileHeader *header = (const TxCacheFileHeader*)_cacheFile.data();
+	if (_cacheFile.size() < sizeof(TxCacheFileHeader) || header->magic != TXCACHE_FILE_MAGIC ||
+		header->config != config ||
+		header->count > (_cacheFile.size() - sizeof(TxCacheFileHeader)) / sizeof(TxCacheFileEntry)) {
+		_cacheFile.close();
+		return 0;
+	}
+
+	_cacheFileEntries = header->count;
+	return _cacheFileEntries != 0;
 }
 
 boolean
@@ -317,6 +442,14 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
 
 	wcstombs(cbuf, filename, MAX_PATH);
 
+	if (_openCacheFile(cbuf, config)) {
+		if (_callback)
+			(*_callback)(wst("[%d] textures in %ls\n"), _cacheFileEntries, filename);
+		CHDIR(curpath);
+		return 1;
+	}
+
+	/* read old gzip stream as a whole */
 	gzFile gzfp = gzopen(cbuf, "rb");
 	DBG_INFO(80, wst("gzfp:%x file:%ls\n"), gzfp, filename);
 	if (gzfp) {
@@ -365,7 +498,7 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
 
 	CHDIR(curpath);
 
-	return !_cache.empty();
+	return !empty();
 }
 
 boolean
@@ -393,13 +526,44 @@ TxCache::del(uint64 checksum)
 	return 0;
 }
 
+uint32
+TxCache::trim(boolean all)
+{
+	/* free textures held in memory. unless all is set, only the ones
+	 * which can be read back from the mapped cache file are freed. */
+	const int totalSize = _totalSize;
+
+	auto itMap = _cache.begin();
+	while (itMap != _cache.end()) {
+		if (!all && _findInCacheFile((*itMap).first) == nullptr) {
+			++itMap;
+			continue;
+		}
+
+		if (!_cachelist.empty()) _cachelist.erase(((*itMap).second)->it);
+
+		free((*itMap).second->info.data);
+		_totalSize -= (*itMap).second->size;
+		delete (*itMap).second;
+		itMap = _cache.erase(itMap);
+	}
+
+	return (uint32)(totalSize - _totalSize);
+}
+
 boolean
 TxCache::is_cached(uint64 checksum)
 {
 	auto itMap = _cache.find(checksum);
 	if (itMap != _cache.end()) return 1;
 
-	return 0;
+	return _findInCacheFile(checksum) != nullptr;
+}
+
+boolean
+TxCache::empty() const
+{
+	return _cache.empty() && _cacheFileEntries == 0;
 }
 
 void
@@ -417,5 +581,8 @@ TxCache::clear()
 
 	if (!_cachelist.empty()) _cachelist.clear();
 
+	_cacheFile.close();
+	_cacheFileEntries = 0;
+
 	_totalSize = 0;
 }
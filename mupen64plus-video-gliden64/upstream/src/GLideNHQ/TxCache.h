@@ -29,6 +29,8 @@
 #include <list>
 #include <map>
 
+struct TxCacheFileEntry;
+
 class TxCache
 {
 private:
@@ -36,6 +38,12 @@ private:
   uint8 *_gzdest0;
   uint8 *_gzdest1;
   uint32 _gzdestLen;
+  /* cache file mapped by load(). textures missing in _cache are read from it. */
+  TxMappedFile _cacheFile;
+  uint32 _cacheFileEntries;
+  boolean _openCacheFile(const char *filename, int config);
+  const TxCacheFileEntry *_findInCacheFile(uint64 checksum) const;
+  boolean _uncompress(GHQTexInfo *info, uint32 size);
 protected:
   int _options;
   tx_wstring _ident;
@@ -52,7 +60,7 @@ protected:
   boolean save(const wchar_t *path, const wchar_t *filename, const int config);
   boolean load(const wchar_t *path, const wchar_t *filename, const int config);
   boolean del(uint64 checksum); /* checksum hi:palette low:texture */
-  boolean is_cached(uint64 checksum); /* checksum hi:palette low:texture */
+  boolean empty() const;
   void clear();
 public:
   ~TxCache();
@@ -62,6 +70,8 @@ public:
               GHQTexInfo *info, int dataSize = 0);
   boolean get(uint64 checksum, /* checksum hi:palette low:texture */
               GHQTexInfo *info);
+  boolean is_cached(uint64 checksum); /* checksum hi:palette low:texture */
+  uint32 trim(boolean all); /* returns bytes freed */
 };
 
 #endif /* __TXCACHE_H__ */
@@ -28,6 +28,7 @@
 #include <functional>
 #include <thread>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include <osal_files.h>
@@ -38,6 +39,9 @@
 
 void TxFilter::clear()
 {
+	/* stop background filtering */
+	_asyncShutdown();
+
 	/* clear hires texture cache */
 	delete _txHiResCache;
 
@@ -47,6 +51,9 @@ void TxFilter::clear()
 	/* free memory */
 	TxMemBuf::getInstance()->shutdown();
 
+	/* stop worker threads */
+	TxThreadPool::getInstance()->shutdown();
+
 	/* clear other stuff */
 	delete _txImage;
 	delete _txQuantize;
@@ -73,6 +80,7 @@ TxFilter::TxFilter(int maxwidth,
 	, _txTexCache(nullptr)
 	, _txHiResCache(nullptr)
 	, _txImage(nullptr)
+	, _asyncStop(0)
 {
 	/* HACKALERT: the emulator misbehaves and sometimes forgets to shutdown */
 	if ((ident && wcscmp(ident, wst("DEFAULT")) != 0 && _ident.compare(ident) == 0) &&
@@ -107,6 +115,7 @@ TxFilter::TxFilter(int maxwidth,
 
 	/* get number of CPU cores. */
 	_numcore = TxUtil::getNumberofProcessors();
+	TxThreadPool::getInstance()->init(_numcore);
 
 	_initialized = 0;
 
@@ -147,7 +156,7 @@ TxFilter::TxFilter(int maxwidth,
 
 	/* hires texture */
 #if HIRES_TEXTURE
-	_txHiResCache = new TxHiResCache(_maxwidth, _maxheight, _maxbpp, _options, texCachePath, texPackPath, _ident.c_str(), callback);
+	_txHiResCache = new TxHiResCache(_maxwidth, _maxheight, _maxbpp, _options, _cacheSize, texCachePath, texPackPath, _ident.c_str(), callback);
 
 	if (_txHiResCache->empty())
 		_options &= ~HIRESTEXTURES_MASK;
@@ -155,15 +164,110 @@ TxFilter::TxFilter(int maxwidth,
 
 	if (_tex1 && _tex2)
 		_initialized = 1;
+
+	/* background filtering needs the texture cache to pass the results */
+	if (_initialized && _cacheSize && (_options & ASYNC_FILTER_TEX))
+		_asyncThread = std::thread(&TxFilter::_asyncLoop, this);
+}
+
+void
+TxFilter::_asyncLoop()
+{
+	std::unique_lock<std::mutex> lock(_asyncMutex);
+	while (true) {
+		_asyncSignal.wait(lock, [this]() { return _asyncStop || !_asyncQueue.empty(); });
+		if (_asyncStop)
+			return;
+
+		AsyncTexture tex = _asyncQueue.front();
+		_asyncQueue.pop_front();
+		lock.unlock();
+
+		/* private buffers, the calling thread keeps using the shared ones.
+		 * enhancements scale textures up to 6x in each direction */
+		const int texels = tex.width * tex.height;
+		int bufTexels = texels * 36;
+		if (bufTexels > _maxwidth * _maxheight)
+			bufTexels = _maxwidth * _maxheight;
+		if (bufTexels < texels)
+			bufTexels = texels;
+		uint8 *tex1 = (uint8*)malloc(bufTexels << 2);
+		uint8 *tex2 = (uint8*)malloc(bufTexels << 2);
+		uint8 *result = nullptr;
+		if (tex1 != nullptr && tex2 != nullptr &&
+			_filter(tex.data, tex.width, tex.height, tex.format, tex1, tex2, &tex.info)) {
+			const int size = TxUtil::sizeofTx(tex.info.width, tex.info.height, ColorFormat(u32(tex.info.format)));
+			result = (uint8*)malloc(size);
+			if (result != nullptr)
+				memcpy(result, tex.info.data, size);
+		}
+		free(tex1);
+		free(tex2);
+		free(tex.data);
+		tex.data = result;
+		tex.info.data = result;
+
+		lock.lock();
+		_asyncDone.push_back(tex);
+	}
+}
+
+void
+TxFilter::_asyncFlush()
+{
+	std::vector<AsyncTexture> done;
+	{
+		std::lock_guard<std::mutex> lock(_asyncMutex);
+		done.swap(_asyncDone);
+	}
+
+	for (auto & tex : done) {
+		/* failed textures stay pending, so they are not queued again */
+		if (tex.data == nullptr)
+			continue;
+		_txTexCache->add(tex.crc, &tex.info);
+		free(tex.data);
+		_asyncPending.erase(tex.crc);
+	}
+}
+
+void
+TxFilter::_asyncShutdown()
+{
+	if (!_asyncThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_asyncMutex);
+		_asyncStop = 1;
+	}
+	_asyncSignal.notify_one();
+	_asyncThread.join();
+
+	for (auto & tex : _asyncQueue)
+		free(tex.data);
+	for (auto & tex : _asyncDone)
+		free(tex.data);
+	_asyncQueue.clear();
+	_asyncDone.clear();
+	_asyncPending.clear();
+	_asyncStop = 0;
+}
+
+boolean
+TxFilter::filterready(uint64 g64crc)
+{
+	if (!_initialized || !_asyncThread.joinable())
+		return 0;
+
+	_asyncFlush();
+	return _txTexCache->is_cached(g64crc);
 }
 
 boolean
 TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat, uint64 g64crc, GHQTexInfo *info)
 {
-	uint8 *texture = src;
-	uint8 *tmptex = _tex1;
 	assert(srcformat != graphics::colorFormat::RGBA);
-	ColorFormat destformat = srcformat;
 
 	/* We need to be initialized first! */
 	if (!_initialized) return 0;
@@ -173,19 +277,64 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 
 		/* calculate checksum of source texture */
 		if (!g64crc)
-			g64crc = (uint64)(TxUtil::checksumTx(texture, srcwidth, srcheight, srcformat));
+			g64crc = (uint64)(TxUtil::checksumTx(src, srcwidth, srcheight, srcformat));
 
 		DBG_INFO(80, wst("filter: crc:%08X %08X %d x %d gfmt:%x\n"),
 				 (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, u32(srcformat));
 
+		if (_asyncThread.joinable())
+			_asyncFlush();
+
 		/* check if we have it in cache */
 		if ((g64crc & 0xffffffff00000000) == 0 && /* we reach here only when there is no hires texture for this crc */
 				_txTexCache->get(g64crc, info)) {
 			DBG_INFO(80, wst("cache hit: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
 			return 1; /* yep, we've got it */
 		}
+
+		/* filter it in background, the caller uses the source texture meanwhile */
+		if (_asyncThread.joinable() && (g64crc & 0xffffffff00000000) == 0) {
+			if (_asyncPending.insert(g64crc).second) {
+				AsyncTexture tex;
+				const int size = TxUtil::sizeofTx(srcwidth, srcheight, srcformat);
+				tex.crc = g64crc;
+				tex.data = (uint8*)malloc(size);
+				tex.width = srcwidth;
+				tex.height = srcheight;
+				tex.format = srcformat;
+				if (tex.data == nullptr)
+					return 0;
+				memcpy(tex.data, src, size);
+				{
+					std::lock_guard<std::mutex> lock(_asyncMutex);
+					_asyncQueue.push_back(tex);
+				}
+				_asyncSignal.notify_one();
+			}
+			return 0;
+		}
 	}
 
+	if (!_filter(src, srcwidth, srcheight, srcformat, _tex1, _tex2, info))
+		return 0;
+
+	/* cache the texture. */
+	if (_cacheSize)
+		_txTexCache->add(g64crc, info);
+
+	DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
+
+	return 1;
+}
+
+boolean
+TxFilter::_filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
+				  uint8 *tex1, uint8 *tex2, GHQTexInfo *info) const
+{
+	uint8 *texture = src;
+	uint8 *tmptex = tex1;
+	ColorFormat destformat = srcformat;
+
 	/* Leave small textures alone because filtering makes little difference.
    * Moreover, some filters require at least 4 * 4 to work.
    * Bypass _options to do ARGB8888->16bpp if _maxbpp=16 or forced color reduction.
@@ -210,6 +359,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 			*/
 			int scale = 1, num_filters = 0;
 			uint32 filter = 0;
+			boolean enhanced = 0;
 
 			const uint32 enhancement = (_options & ENHANCEMENT_MASK);
 			switch (enhancement) {
@@ -298,7 +448,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 	   */
 			while (num_filters > 0) {
 
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 
 				uint8 *_texture = texture;
 				uint8 *_tmptex  = tmptex;
@@ -310,33 +460,17 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 					numcore--;
 				}
 				if (blkrow > 0 && numcore > 1) {
-					std::thread *thrd[MAX_NUMCORE];
-					unsigned int i;
-					int blkheight = blkrow << 2;
-					unsigned int srcStride = (srcwidth * blkheight) << 2;
-					unsigned int destStride = srcStride * scale * scale;
-					for (i = 0; i < numcore - 1; i++) {
-						thrd[i] = new std::thread(std::bind(filter_8888,
-																(uint32*)_texture,
-																srcwidth,
-																blkheight,
-																(uint32*)_tmptex,
-																filter,
-																i));
-						_texture += srcStride;
-						_tmptex  += destStride;
-					}
-					thrd[i] = new std::thread(std::bind(filter_8888,
-															(uint32*)_texture,
-															srcwidth,
-															srcheight - blkheight * i,
-															(uint32*)_tmptex,
-															filter,
-															i));
-					for (i = 0; i < numcore; i++) {
-						thrd[i]->join();
-						delete thrd[i];
-					}
+					const int blkheight = blkrow << 2;
+					const unsigned int srcStride = (srcwidth * blkheight) << 2;
+					const unsigned int destStride = srcStride * scale * scale;
+					TxThreadPool::getInstance()->run(numcore, [&](uint32 i) {
+						filter_8888((uint32*)(_texture + srcStride * i),
+									srcwidth,
+									(i < numcore - 1) ? blkheight : srcheight - blkheight * i,
+									(uint32*)(_tmptex + destStride * i),
+									filter,
+									i);
+					});
 				} else {
 					filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter, 0);
 				}
@@ -346,6 +480,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 					srcheight *= scale;
 					filter &= ~ENHANCEMENT_MASK;
 					scale = 1;
+					enhanced = 1;
 				}
 
 				texture = tmptex;
@@ -355,11 +490,21 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 			/*
 			* texture (re)conversions
 			*/
-			if (destformat == graphics::internalcolorFormat::RGBA8 && (_maxbpp < 32 || _options & FORCE16BPP_TEX)) {
+			if (destformat == graphics::internalcolorFormat::RGBA8 && enhanced && (_options & ETC2_TEX)) {
+				/* upscaled textures are the large ones, compress them for the GPU */
+				ColorFormat etc2format = TxUtil::isOpaque(texture, srcwidth, srcheight) ?
+					graphics::internalcolorFormat::COMPRESSED_RGB8_ETC2 :
+					graphics::internalcolorFormat::COMPRESSED_RGBA8_ETC2_EAC;
+				tmptex = (texture == tex1) ? tex2 : tex1;
+				if (_txQuantize->quantize(texture, tmptex, srcwidth, srcheight, graphics::internalcolorFormat::RGBA8, etc2format)) {
+					texture = tmptex;
+					destformat = etc2format;
+				}
+			} else if (destformat == graphics::internalcolorFormat::RGBA8 && (_maxbpp < 32 || _options & FORCE16BPP_TEX)) {
 				if (srcformat == graphics::internalcolorFormat::RGBA8)
 					srcformat = graphics::internalcolorFormat::RGBA4;
 				if (srcformat != graphics::internalcolorFormat::RGBA8) {
-					tmptex = (texture == _tex1) ? _tex2 : _tex1;
+					tmptex = (texture == tex1) ? tex2 : tex1;
 					if (!_txQuantize->quantize(texture, tmptex, srcwidth, srcheight, graphics::internalcolorFormat::RGBA8, srcformat)) {
 						DBG_INFO(80, wst("Error: unsupported format! gfmt:%x\n"), srcformat);
 						return 0;
@@ -373,7 +518,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 		else if (destformat == graphics::internalcolorFormat::RGBA4) {
 
 			int scale = 1;
-			tmptex = (texture == _tex1) ? _tex2 : _tex1;
+			tmptex = (texture == tex1) ? tex2 : tex1;
 
 			switch (_options & ENHANCEMENT_MASK) {
 			case HQ4X_ENHANCEMENT:
@@ -428,11 +573,11 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 			}
 
 			if (_options & SMOOTH_FILTER_MASK) {
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 				SmoothFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SMOOTH_FILTER_MASK));
 				texture = tmptex;
 			} else if (_options & SHARP_FILTER_MASK) {
-				tmptex = (texture == _tex1) ? _tex2 : _tex1;
+				tmptex = (texture == tex1) ? tex2 : tex1;
 				SharpFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SHARP_FILTER_MASK));
 				texture = tmptex;
 			}
@@ -447,12 +592,6 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 	info->is_hires_tex = 0;
 	setTextureFormat(destformat, info);
 
-	/* cache the texture. */
-	if (_cacheSize)
-		_txTexCache->add(g64crc, info);
-
-	DBG_INFO(80, wst("filtered texture: %d x %d gfmt:%x\n"), info->width, info->height, info->format);
-
 	return 1;
 }
 
@@ -644,6 +783,20 @@ TxFilter::reloadhirestex()
 	return 0;
 }
 
+uint32
+TxFilter::trimcache(boolean all)
+{
+	/* filtered textures can be filtered again, hires textures are
+	 * freed only when they can be read back from the cache file */
+	uint32 freed = _txTexCache->trim(all);
+
+#if HIRES_TEXTURE
+	freed += _txHiResCache->trim(0);
+#endif
+
+	return freed;
+}
+
 void
 TxFilter::dumpcache()
 {
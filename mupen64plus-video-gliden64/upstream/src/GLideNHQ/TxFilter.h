@@ -30,6 +30,8 @@
 #include "TxTexCache.h"
 #include "TxUtil.h"
 #include "TxImage.h"
+#include <deque>
+#include <set>
 
 class TxFilter
 {
@@ -50,6 +52,30 @@ private:
   TxHiResCache *_txHiResCache;
   TxImage *_txImage;
   boolean _initialized;
+
+  /* background filtering with ASYNC_FILTER_TEX.
+   * Finished textures are moved to the texture cache by the calling thread. */
+  struct AsyncTexture {
+	uint64 crc;
+	uint8 *data;
+	int width;
+	int height;
+	ColorFormat format;
+	GHQTexInfo info;
+  };
+  std::thread _asyncThread;
+  std::mutex _asyncMutex;
+  std::condition_variable _asyncSignal;
+  std::deque<AsyncTexture> _asyncQueue;
+  std::vector<AsyncTexture> _asyncDone;
+  std::set<uint64> _asyncPending; /* queued or failed, used by the calling thread only */
+  boolean _asyncStop;
+  void _asyncLoop();
+  void _asyncFlush();
+  void _asyncShutdown();
+
+  boolean _filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
+				  uint8 *tex1, uint8 *tex2, GHQTexInfo *info) const;
   void clear();
 public:
   ~TxFilter();
@@ -77,6 +103,8 @@ public:
   boolean dmptx(uint8 *src, int width, int height, int rowStridePixel, ColorFormat gfmt, uint16 n64fmt, uint64 r_crc64);
   boolean reloadhirestex();
   void dumpcache();
+  boolean filterready(uint64 g64crc);
+  uint32 trimcache(boolean all);
 };
 
 #endif /* __TXFILTER_H__ */
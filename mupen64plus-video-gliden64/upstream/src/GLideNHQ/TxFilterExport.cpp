@@ -108,6 +108,24 @@ txfilter_dumpcache(void)
 	  txFilter->dumpcache();
 }
 
+TAPI boolean TAPIENTRY
+txfilter_filterready(uint64 g64crc)
+{
+	if (txFilter)
+	  return txFilter->filterready(g64crc);
+
+	return 0;
+}
+
+TAPI uint32 TAPIENTRY
+txfilter_trimcache(boolean all)
+{
+	if (txFilter)
+	  return txFilter->trimcache(all);
+
+	return 0;
+}
+
 
 #ifdef __cplusplus
 }
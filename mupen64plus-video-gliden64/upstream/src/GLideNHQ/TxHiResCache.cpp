@@ -44,6 +44,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* texture pack index file layout version */
+#define HIRES_INDEX_VERSION 1
+
 TxHiResCache::~TxHiResCache()
 {
   delete _txImage;
@@ -55,6 +58,7 @@ TxHiResCache::TxHiResCache(int maxwidth,
 						   int maxheight,
 						   int maxbpp,
 						   int options,
+						   int cachesize,
 						   const wchar_t *cachePath,
 						   const wchar_t *texPackPath,
 						   const wchar_t *ident,
@@ -68,6 +72,7 @@ TxHiResCache::TxHiResCache(int maxwidth,
   _maxwidth  = maxwidth;
   _maxheight = maxheight;
   _maxbpp    = maxbpp;
+  _lazyCacheSize = cachesize;
   _abortLoad = 0;
   _cacheDumped = 0;
 
@@ -79,23 +84,23 @@ TxHiResCache::TxHiResCache(int maxwidth,
 	return;
   }
 
+  _cacheSize = _lazyCacheSize;
+
   /* read in hires texture cache */
   if (_options & DUMP_HIRESTEXCACHE) {
-	/* find it on disk */
+	/* find it on disk. textures are read from it on first use. */
 	_cacheDumped = TxCache::load(_cachePath.c_str(), _getFileName().c_str(), _getConfig());
   }
 
-/* read in hires textures */
-  if (!_cacheDumped) {
-	  if (TxHiResCache::load(0) && (_options & DUMP_HIRESTEXCACHE) != 0)
-		  _cacheDumped = TxCache::save(_cachePath.c_str(), _getFileName().c_str(), _getConfig());
-  }
+  /* index hires textures for those missing in the dumped cache. they are read in on first use. */
+  if (!_loadIndex())
+	  _indexHiResTextures(0);
 }
 
 void TxHiResCache::dump()
 {
-	if ((_options & DUMP_HIRESTEXCACHE) && !_cacheDumped && !_abortLoad && !empty()) {
-	  /* dump cache to disk */
+	if ((_options & DUMP_HIRESTEXCACHE) && !_cacheDumped && !_abortLoad && !TxCache::empty()) {
+	  /* dump cache to disk together with the textures already there */
 	  _cacheDumped = TxCache::save(_cachePath.c_str(), _getFileName().c_str(), _getConfig());
 	}
 }
@@ -107,14 +112,48 @@ tx_wstring TxHiResCache::_getFileName() const
 	return filename;
 }
 
+tx_wstring TxHiResCache::_getIndexFileName() const
+{
+	tx_wstring filename = _ident + wst("_HIRESTEXTURES.") + HIRESINDEX_EXT;
+	removeColon(filename);
+	return filename;
+}
+
+tx_wstring TxHiResCache::_getPackPath() const
+{
+	tx_wstring dir_path(_texPackPath);
+	dir_path += OSAL_DIR_SEPARATOR_STR;
+	dir_path += _ident;
+	return dir_path;
+}
+
 int TxHiResCache::_getConfig() const
 {
-	return _options & (HIRESTEXTURES_MASK | TILE_HIRESTEX | FORCE16BPP_HIRESTEX | GZ_HIRESTEXCACHE | LET_TEXARTISTS_FLY);
+	return _options & (HIRESTEXTURES_MASK | TILE_HIRESTEX | FORCE16BPP_HIRESTEX | ETC2_TEX | GZ_HIRESTEXCACHE | LET_TEXARTISTS_FLY);
 }
 
 boolean TxHiResCache::empty()
 {
-  return _cache.empty();
+  return TxCache::empty() && _index.empty();
+}
+
+boolean TxHiResCache::get(uint64 checksum, GHQTexInfo *info)
+{
+	if (TxCache::get(checksum, info))
+		return 1;
+
+	/* read in the texture from the texture pack on first use */
+	auto itIndex = _index.find(checksum);
+	if (itIndex == _index.end())
+		return 0;
+
+	if (!_loadHiResTexture(checksum, itIndex->second)) {
+		/* broken or removed file. do not try again. */
+		_index.erase(itIndex);
+		return 0;
+	}
+
+	return TxCache::get(checksum, info);
 }
 
 boolean TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial */
@@ -122,9 +161,19 @@ boolean TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial *
 	if (_texPackPath.empty() || _ident.empty())
 		return 0;
 
-	if (!replace) TxCache::clear();
+	if (!replace) {
+		TxCache::clear();
+		_index.clear();
+		_cacheSize = _lazyCacheSize;
+	}
 
-	tx_wstring dir_path(_texPackPath);
+	return _indexHiResTextures(replace);
+}
+
+boolean TxHiResCache::_indexHiResTextures(boolean replace)
+{
+	if (_texPackPath.empty() || _ident.empty())
+		return 0;
 
 	switch (_options & HIRESTEXTURES_MASK) {
 	case RICE_HIRESTEXTURES:
@@ -139,22 +188,76 @@ boolean TxHiResCache::load(boolean replace) /* 0 : reload, 1 : replace partial *
 		INFO(80, wst("  usage of only 2) and 3) highly recommended!\n"));
 		INFO(80, wst("  folder names must be in US-ASCII characters!\n"));
 
-		dir_path += OSAL_DIR_SEPARATOR_STR;
-		dir_path += _ident;
-
-		const LoadResult res = loadHiResTextures(dir_path.c_str(), replace);
-		if (res == resError) {
-			if (_callback) (*_callback)(wst("Texture pack load failed. Clear hiresolution texture cache.\n"));
-			INFO(80, wst("Texture pack load failed. Clear hiresolution texture cache.\n"));
-			_cache.clear();
-		}
+		const LoadResult res = _scanHiResTextures(_getPackPath().c_str(), std::string(), replace);
+		if (res == resOk && !_abortLoad)
+			_saveIndex();
 		return res == resOk ? 1 : 0;
 	}
 	return 0;
 }
 
+/* Rice hi-res textures file naming convention:
+ * <rom name>#<crc>#<fmt>#<siz>[#<palette crc>]<suffix>.<ext>
+ * Returns pointer to the suffix in _fname or nullptr if the name does not match.
+ */
+static
+char * parseFileName(char * _fname, const char * _ident, uint64 & _chksum64, uint32 & _fmt, uint32 & _siz)
+{
+#define CRCFMTSIZ_LEN 13
+#define PALCRC_LEN 9
+	char *pfname = _fname + strlen(_fname) - 4;
+	if (!(pfname == strstr(_fname, ".png") ||
+		  pfname == strstr(_fname, ".bmp") ||
+		  pfname == strstr(_fname, ".dds"))) {
+	  INFO(80, wst("Error: not png or bmp or dds!\n"));
+	  return nullptr;
+	}
+
+	uint32 chksum = 0, palchksum = 0;
+	const size_t identLen = strlen(_ident);
+	pfname = strstr(_fname, _ident);
+	if (pfname != _fname) pfname = 0;
+	if (pfname) {
+	  if (sscanf(pfname + identLen, "#%08X#%01X#%01X#%08X", &chksum, &_fmt, &_siz, &palchksum) == 4)
+		pfname += (identLen + CRCFMTSIZ_LEN + PALCRC_LEN);
+	  else if (sscanf(pfname + identLen, "#%08X#%01X#%01X", &chksum, &_fmt, &_siz) == 3)
+		pfname += (identLen + CRCFMTSIZ_LEN);
+	  else
+		pfname = 0;
+	}
+	if (!pfname) {
+	  INFO(80, wst("Error: not Rice texture naming convention!\n"));
+	  return nullptr;
+	}
+	if (!chksum) {
+	  INFO(80, wst("Error: crc32 = 0!\n"));
+	  return nullptr;
+	}
+
+	_chksum64 = (uint64)palchksum;
+	_chksum64 <<= 32;
+	_chksum64 |= (uint64)chksum;
+	return pfname;
+}
+
+std::string TxHiResCache::_getRiceIdent() const
+{
+	char fname[MAX_PATH];
+	wcstombs(fname, _ident.c_str(), MAX_PATH);
+	/* XXX case sensitivity fiasco!
+	 * files must use _a, _rgb, _all, _allciByRGBA, _ciByRGBA, _ci
+	 * and file extensions must be in lower case letters! */
+#ifdef OS_WINDOWS
+	{
+	  unsigned int i;
+	  for (i = 0; i < strlen(fname); i++) fname[i] = tolower(fname[i]);
+	}
+#endif
+	return std::string(fname);
+}
+
 TxHiResCache::LoadResult
-TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
+TxHiResCache::_scanHiResTextures(const wchar_t * dir_path, const std::string & prefix, boolean replace)
 {
   DBG_INFO(80, wst("-----\n"));
   DBG_INFO(80, wst("path: %ls\n"), dir_path);
@@ -167,18 +270,7 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 
   LoadResult result = resOk;
 
-#ifdef OS_WINDOWS
-  wchar_t curpath[MAX_PATH];
-  GETCWD(MAX_PATH, curpath);
-  CHDIR(dir_path);
-#else
-  char curpath[MAX_PATH];
-  char cbuf[MAX_PATH];
-  wcstombs(cbuf, dir_path, MAX_PATH);
-  GETCWD(MAX_PATH, curpath);
-  CHDIR(cbuf);
-#endif
-
+  const std::string ident = _getRiceIdent();
   void *dir = osal_search_dir_open(dir_path);
   const wchar_t *foundfilename;
   // the path of the texture
@@ -205,9 +297,12 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 	texturefilename += OSAL_DIR_SEPARATOR_STR;
 	texturefilename += foundfilename;
 
+	char fname[MAX_PATH];
+	wcstombs(fname, foundfilename, MAX_PATH);
+
 	/* recursive read into sub-directory */
 	if (osal_is_directory(texturefilename.c_str())) {
-		result = loadHiResTextures(texturefilename.c_str(), replace);
+		result = _scanHiResTextures(texturefilename.c_str(), prefix + fname + "/", replace);
 		if (result == resOk)
 			continue;
 		else
@@ -217,22 +312,6 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 	DBG_INFO(80, wst("-----\n"));
 	DBG_INFO(80, wst("file: %ls\n"), foundfilename);
 
-	int width = 0, height = 0;
-	ColorFormat format = graphics::internalcolorFormat::NOCOLOR;
-	uint8 *tex = nullptr;
-	int tmpwidth = 0, tmpheight = 0;
-	ColorFormat tmpformat = graphics::internalcolorFormat::NOCOLOR;
-	uint8 *tmptex= nullptr;
-	ColorFormat destformat = graphics::internalcolorFormat::NOCOLOR;
-
-	/* Rice hi-res textures: begin
-	 */
-	uint32 chksum = 0, fmt = 0, siz = 0, palchksum = 0;
-	char *pfname = nullptr, fname[MAX_PATH];
-	std::string ident;
-	FILE *fp = nullptr;
-
-	wcstombs(fname, _ident.c_str(), MAX_PATH);
 	/* XXX case sensitivity fiasco!
 	 * files must use _a, _rgb, _all, _allciByRGBA, _ciByRGBA, _ci
 	 * and file extensions must be in lower case letters! */
@@ -242,79 +321,122 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 	  for (i = 0; i < strlen(fname); i++) fname[i] = tolower(fname[i]);
 	}
 #endif
-	ident.assign(fname);
 
-	/* read in Rice's file naming convention */
-#define CRCFMTSIZ_LEN 13
-#define PALCRC_LEN 9
-	wcstombs(fname, foundfilename, MAX_PATH);
-	/* XXX case sensitivity fiasco!
-	 * files must use _a, _rgb, _all, _allciByRGBA, _ciByRGBA, _ci
-	 * and file extensions must be in lower case letters! */
-#ifdef OS_WINDOWS
-	{
-	  unsigned int i;
-	  for (i = 0; i < strlen(fname); i++) fname[i] = tolower(fname[i]);
-	}
-#endif
-	pfname = fname + strlen(fname) - 4;
-	if (!(pfname == strstr(fname, ".png") ||
-		  pfname == strstr(fname, ".bmp") ||
-		  pfname == strstr(fname, ".dds"))) {
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-	  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
-	  INFO(80, wst("Error: not png or bmp or dds!\n"));
+	uint64 chksum64 = 0;
+	uint32 fmt = 0, siz = 0;
+	if (parseFileName(fname, ident.c_str(), chksum64, fmt, siz) == nullptr)
 	  continue;
-	}
-	pfname = strstr(fname, ident.c_str());
-	if (pfname != fname) pfname = 0;
-	if (pfname) {
-	  if (sscanf(pfname + ident.size(), "#%08X#%01X#%01X#%08X", &chksum, &fmt, &siz, &palchksum) == 4)
-		pfname += (ident.size() + CRCFMTSIZ_LEN + PALCRC_LEN);
-	  else if (sscanf(pfname + ident.size(), "#%08X#%01X#%01X", &chksum, &fmt, &siz) == 3)
-		pfname += (ident.size() + CRCFMTSIZ_LEN);
-	  else
-		pfname = 0;
-	}
-	if (!pfname) {
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n", dir_path));
-	  INFO(80, wst("file: %ls\n", foundfilename));
-#endif
-	  INFO(80, wst("Error: not Rice texture naming convention!\n"));
-	  continue;
-	}
-	if (!chksum) {
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-	  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
-	  INFO(80, wst("Error: crc32 = 0!\n"));
-	  continue;
-	}
 
-	/* check if we already have it in hires texture cache */
-	if (!replace) {
-	  uint64 chksum64 = (uint64)palchksum;
-	  chksum64 <<= 32;
-	  chksum64 |= (uint64)chksum;
-	  if (TxCache::is_cached(chksum64)) {
-#if !DEBUG
-		INFO(80, wst("-----\n"));
-		INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-		INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
-		INFO(80, wst("Error: already cached! duplicate texture!\n"));
+	/* check if we already have it in the index */
+	if (_index.find(chksum64) != _index.end()) {
+	  if (!replace) {
+		/* _rgb.* and _a.* pairs share the checksum, either one reads in both */
+		INFO(80, wst("Error: already indexed! duplicate texture!\n"));
 		continue;
 	  }
+	  /* remove redundant in cache */
+	  if (TxCache::del(chksum64)) {
+		DBG_INFO(80, wst("removed duplicate old cache.\n"));
+	  }
+	}
+
+	DBG_INFO(80, wst("rom: %ls chksum:%08X %08X fmt:%x size:%x\n"), _ident.c_str(),
+			 (uint32)(chksum64 & 0xffffffff), (uint32)(chksum64 >> 32), fmt, siz);
+
+	_index[chksum64] = prefix + fname;
+
+	/* skip in between to prevent the loop from being tied down to vsync */
+	if (_callback && !(_index.size() % 100))
+	  (*_callback)(wst("[%d] hires textures indexed\n"), _index.size());
+
+  } while (foundfilename != nullptr);
+  osal_search_dir_close(dir);
+
+  return result;
+}
+
+boolean
+TxHiResCache::_loadHiResTexture(uint64 checksum, const std::string & filename)
+{
+	char fname[MAX_PATH];
+	wcstombs(fname, _getPackPath().c_str(), MAX_PATH);
+	const size_t pathLen = strlen(fname);
+	/* reserve space for _a.* -> _rgb.* substitution */
+	if (pathLen + filename.size() + 4 >= MAX_PATH)
+		return 0;
+	fname[pathLen] = '/';
+	strcpy(fname + pathLen + 1, filename.c_str());
+
+	uint64 chksum64 = 0;
+	uint32 fmt = 0, siz = 0;
+	char *pfname = parseFileName(strrchr(fname, '/') + 1, _getRiceIdent().c_str(), chksum64, fmt, siz);
+	if (pfname == nullptr || chksum64 != checksum)
+		return 0;
+
+	DBG_INFO(80, wst("rom: %ls chksum:%08X %08X fmt:%x size:%x\n"), _ident.c_str(),
+			 (uint32)(checksum & 0xffffffff), (uint32)(checksum >> 32), fmt, siz);
+
+	int width = 0, height = 0;
+	ColorFormat format = graphics::internalcolorFormat::NOCOLOR;
+	uint8 *tex = _readHiResTexture(fname, pfname, fmt, siz, width, height, format);
+	if (tex == nullptr)
+		return 0;
+
+	/* load it into hires texture cache. */
+	GHQTexInfo tmpInfo;
+	tmpInfo.data = tex;
+	tmpInfo.width = width;
+	tmpInfo.height = height;
+	tmpInfo.is_hires_tex = 1;
+	setTextureFormat(format, &tmpInfo);
+
+	const boolean added = TxCache::add(checksum, &tmpInfo);
+	free(tex);
+	if (added) {
+		_cacheDumped = 0;
+		DBG_INFO(80, wst("texture loaded!\n"));
 	}
+	return added;
+}
+
+/* read in <base><suffix>.png, or <base><suffix>.bmp if there is no png.
+ * fname is left untouched so that both halves of a pair can be read at once. */
+static
+uint8 * readRiceImage(TxImage * txImage, const char * fname, size_t baseLen, const char * suffix,
+					  int * width, int * height, ColorFormat * format)
+{
+	char path[MAX_PATH];
+	memcpy(path, fname, baseLen);
+	char * ext = path + baseLen + strlen(suffix);
+	strcpy(path + baseLen, suffix);
 
-	DBG_INFO(80, wst("rom: %ls chksum:%08X %08X fmt:%x size:%x\n"), _ident.c_str(), chksum, palchksum, fmt, siz);
+	uint8 *tex = nullptr;
+	FILE *fp;
+	strcpy(ext, ".png");
+	if ((fp = fopen(path, "rb")) != nullptr) {
+		tex = txImage->readPNG(fp, width, height, format);
+		fclose(fp);
+	}
+	if (!tex) {
+		strcpy(ext, ".bmp");
+		if ((fp = fopen(path, "rb")) != nullptr) {
+			tex = txImage->readBMP(fp, width, height, format);
+			fclose(fp);
+		}
+	}
+	return tex;
+}
+
+uint8 *
+TxHiResCache::_readHiResTexture(char *fname, char *pfname, uint32 fmt, uint32 siz,
+								int &width, int &height, ColorFormat &format)
+{
+	uint8 *tex = nullptr;
+	int tmpwidth = 0, tmpheight = 0;
+	ColorFormat tmpformat = graphics::internalcolorFormat::NOCOLOR;
+	uint8 *tmptex= nullptr;
+	ColorFormat destformat = graphics::internalcolorFormat::NOCOLOR;
+	FILE *fp = nullptr;
 
 	/* Deal with the wackiness some texture packs utilize Rice format.
 	 * Read in the following order: _a.* + _rgb.*, _all.png _ciByRGBA.png,
@@ -340,52 +462,22 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 	  if (!osal_path_existsA(fname)) {
 		strcpy(pfname, "_rgb.bmp");
 		if (!osal_path_existsA(fname)) {
-#if !DEBUG
-		  INFO(80, wst("-----\n"));
-		  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-		  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
 		  INFO(80, wst("Error: missing _rgb.*! _a.* must be paired with _rgb.*!\n"));
-		  continue;
-		}
-	  }
-	  /* _a.png */
-	  strcpy(pfname, "_a.png");
-	  if ((fp = fopen(fname, "rb")) != nullptr) {
-		tmptex = _txImage->readPNG(fp, &tmpwidth, &tmpheight, &tmpformat);
-		fclose(fp);
-	  }
-	  if (!tmptex) {
-		/* _a.bmp */
-		strcpy(pfname, "_a.bmp");
-		if ((fp = fopen(fname, "rb")) != nullptr) {
-		  tmptex = _txImage->readBMP(fp, &tmpwidth, &tmpheight, &tmpformat);
-		  fclose(fp);
-		}
-	  }
-	  /* _rgb.png */
-	  strcpy(pfname, "_rgb.png");
-	  if ((fp = fopen(fname, "rb")) != nullptr) {
-		tex = _txImage->readPNG(fp, &width, &height, &format);
-		fclose(fp);
-	  }
-	  if (!tex) {
-		/* _rgb.bmp */
-		strcpy(pfname, "_rgb.bmp");
-		if ((fp = fopen(fname, "rb")) != nullptr) {
-		  tex = _txImage->readBMP(fp, &width, &height, &format);
-		  fclose(fp);
+		  return nullptr;
 		}
 	  }
+	  /* decode _rgb.* and _a.* on two cores */
+	  const size_t baseLen = pfname - fname;
+	  TxThreadPool::getInstance()->run(2, [&](uint32 i) {
+		if (i == 0)
+		  tex = readRiceImage(_txImage, fname, baseLen, "_rgb", &width, &height, &format);
+		else
+		  tmptex = readRiceImage(_txImage, fname, baseLen, "_a", &tmpwidth, &tmpheight, &tmpformat);
+	  });
 	  if (tmptex) {
 		/* check if _rgb.* and _a.* have matching size and format. */
 		if (!tex || width != tmpwidth || height != tmpheight ||
 			format != graphics::internalcolorFormat::RGBA8 || tmpformat != graphics::internalcolorFormat::RGBA8) {
-#if !DEBUG
-		  INFO(80, wst("-----\n"));
-		  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-		  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
 		  if (!tex) {
 			INFO(80, wst("Error: missing _rgb.*!\n"));
 		  } else if (width != tmpwidth || height != tmpheight) {
@@ -397,7 +489,7 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 		  free(tmptex);
 		  tex = nullptr;
 		  tmptex = nullptr;
-		  continue;
+		  return nullptr;
 		}
 	  }
 	  /* make adjustments */
@@ -433,11 +525,6 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 		  tmptex = nullptr;
 		} else {
 		  /* clobber A comp. never a question of alpha. only RGB used. */
-#if !DEBUG
-		  INFO(80, wst("-----\n"));
-		  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-		  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
 		  INFO(80, wst("Warning: missing _a.*! only using _rgb.*. treat as opaque texture.\n"));
 		  int i;
 		  for (i = 0; i < height * width; i++) {
@@ -474,13 +561,8 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 
 	/* if we do not have a texture at this point we are screwed */
 	if (!tex) {
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-	  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
 	  INFO(80, wst("Error: load failed!\n"));
-	  continue;
+	  return nullptr;
 	}
 	DBG_INFO(80, wst("read in as %d x %d gfmt:%x\n"), tmpwidth, tmpheight, tmpformat);
 
@@ -489,13 +571,8 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 		(width * height) < 4) { /* TxQuantize requirement: width * height must be 4 or larger. */
 	  free(tex);
 	  tex = nullptr;
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-	  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
 	  INFO(80, wst("Error: not width * height > 4 or 8bit palette color or 32bpp or dxt1 or dxt3 or dxt5!\n"));
-	  continue;
+	  return nullptr;
 	}
 
 	/* analyze and determine best format to quantize */
@@ -641,7 +718,7 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 		  free(tex);
 		  tex = nullptr;
 		  DBG_INFO(80, wst("Error: minification failed!\n"));
-		  continue;
+		  return nullptr;
 		}
 	  }
 
@@ -656,18 +733,22 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 		  free(tex);
 		  tex = nullptr;
 		  DBG_INFO(80, wst("Error: aspect ratio adjustment failed!\n"));
-		  continue;
+		  return nullptr;
 		}
 #endif
 
 	  /* quantize */
 	  {
+		if (_options & ETC2_TEX) {
+			destformat = TxUtil::isOpaque(tex, width, height) ?
+				graphics::internalcolorFormat::COMPRESSED_RGB8_ETC2 :
+				graphics::internalcolorFormat::COMPRESSED_RGBA8_ETC2_EAC;
+		}
 		tmptex = (uint8 *)malloc(TxUtil::sizeofTx(width, height, destformat));
 		if (tmptex == nullptr) {
 			free(tex);
 			tex = nullptr;
-			result = resError;
-			break;
+			return nullptr;
 		}
 		if (destformat == graphics::internalcolorFormat::RGBA8 ||
 			destformat == graphics::internalcolorFormat::RGBA4) {
@@ -689,12 +770,7 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 
 
 	/* last minute validations */
-	if (!tex || !chksum || !width || !height || format == graphics::internalcolorFormat::NOCOLOR || width > _maxwidth || height > _maxheight) {
-#if !DEBUG
-	  INFO(80, wst("-----\n"));
-	  INFO(80, wst("path: %ls\n"), dir_path.string().c_str());
-	  INFO(80, wst("file: %ls\n"), it->path().leaf().c_str());
-#endif
+	if (!tex || !width || !height || format == graphics::internalcolorFormat::NOCOLOR || width > _maxwidth || height > _maxheight) {
 	  if (tex) {
 		free(tex);
 		tex = nullptr;
@@ -702,49 +778,118 @@ TxHiResCache::loadHiResTextures(const wchar_t * dir_path, boolean replace)
 	  } else {
 		INFO(80, wst("Error: load failed!!\n"));
 	  }
-	  continue;
+	  return nullptr;
 	}
 
-	/* load it into hires texture cache. */
-	{
-	  uint64 chksum64 = (uint64)palchksum;
-	  chksum64 <<= 32;
-	  chksum64 |= (uint64)chksum;
+	return tex;
+}
 
-	  GHQTexInfo tmpInfo;
-	  tmpInfo.data = tex;
-	  tmpInfo.width = width;
-	  tmpInfo.height = height;
-	  tmpInfo.is_hires_tex = 1;
-	  setTextureFormat(format, &tmpInfo);
+boolean
+TxHiResCache::_saveIndex() const
+{
+	if (_index.empty())
+		return 0;
 
-	  /* remove redundant in cache */
-	  if (replace && TxCache::del(chksum64)) {
-		DBG_INFO(80, wst("removed duplicate old cache.\n"));
-	  }
+	char cbuf[MAX_PATH];
 
-	  /* add to cache */
-	  const boolean added = TxCache::add(chksum64, &tmpInfo);
-	  free(tex);
-	  if (added) {
-		/* Callback to display hires texture info.
-		 * Gonetz <gonetz(at)ngs.ru> */
-		if (_callback) {
-		  wchar_t tmpbuf[MAX_PATH];
-		  mbstowcs(tmpbuf, fname, MAX_PATH);
-		  (*_callback)(wst("[%d] total mem:%.2fmb - %ls\n"), _cache.size(), (float)_totalSize/1000000, tmpbuf);
+	osal_mkdirp(_cachePath.c_str());
+
+	/* Ugly hack to enable fopen/gzopen in Win9x */
+#ifdef OS_WINDOWS
+	wchar_t curpath[MAX_PATH];
+	GETCWD(MAX_PATH, curpath);
+	CHDIR(_cachePath.c_str());
+#else
+	char curpath[MAX_PATH];
+	GETCWD(MAX_PATH, curpath);
+	wcstombs(cbuf, _cachePath.c_str(), MAX_PATH);
+	CHDIR(cbuf);
+#endif
+
+	wcstombs(cbuf, _getIndexFileName().c_str(), MAX_PATH);
+
+	gzFile gzfp = gzopen(cbuf, "wb1");
+	if (gzfp) {
+		/* write header to determine texture pack match */
+		const int version = HIRES_INDEX_VERSION;
+		const int config = _options & HIRESTEXTURES_MASK;
+		gzwrite(gzfp, &version, 4);
+		gzwrite(gzfp, &config, 4);
+
+		wcstombs(cbuf, _getPackPath().c_str(), MAX_PATH);
+		const uint32 pathLen = (uint32)strlen(cbuf);
+		gzwrite(gzfp, &pathLen, 4);
+		gzwrite(gzfp, cbuf, pathLen);
+
+		const uint32 count = (uint32)_index.size();
+		gzwrite(gzfp, &count, 4);
+		for (auto itIndex = _index.begin(); itIndex != _index.end(); ++itIndex) {
+			const uint16 nameLen = (uint16)itIndex->second.size();
+			gzwrite(gzfp, &itIndex->first, 8);
+			gzwrite(gzfp, &nameLen, 2);
+			gzwrite(gzfp, itIndex->second.c_str(), nameLen);
 		}
-		DBG_INFO(80, wst("texture loaded!\n"));
-	  } else {
-		  result = resError;
-		  break;
-	  }
+		gzclose(gzfp);
 	}
 
-  } while (foundfilename != nullptr);
-  osal_search_dir_close(dir);
+	CHDIR(curpath);
 
-  CHDIR(curpath);
+	return gzfp ? 1 : 0;
+}
 
-  return result;
+boolean
+TxHiResCache::_loadIndex()
+{
+	if (_texPackPath.empty() || (_options & HIRESTEXTURES_MASK) == 0)
+		return 0;
+
+	char cbuf[MAX_PATH];
+
+#ifdef OS_WINDOWS
+	wchar_t curpath[MAX_PATH];
+	GETCWD(MAX_PATH, curpath);
+	CHDIR(_cachePath.c_str());
+#else
+	char curpath[MAX_PATH];
+	GETCWD(MAX_PATH, curpath);
+	wcstombs(cbuf, _cachePath.c_str(), MAX_PATH);
+	CHDIR(cbuf);
+#endif
+
+	wcstombs(cbuf, _getIndexFileName().c_str(), MAX_PATH);
+
+	gzFile gzfp = gzopen(cbuf, "rb");
+	if (gzfp) {
+		int version = 0, config = 0;
+		uint32 pathLen = 0, count = 0;
+		gzread(gzfp, &version, 4);
+		gzread(gzfp, &config, 4);
+		gzread(gzfp, &pathLen, 4);
+
+		/* the index is valid for the same texture pack folder only */
+		char packPath[MAX_PATH];
+		wcstombs(cbuf, _getPackPath().c_str(), MAX_PATH);
+		boolean match = version == HIRES_INDEX_VERSION && config == (_options & HIRESTEXTURES_MASK) &&
+			pathLen == strlen(cbuf) && gzread(gzfp, packPath, pathLen) == (int)pathLen &&
+			strncmp(packPath, cbuf, pathLen) == 0 && gzread(gzfp, &count, 4) == 4;
+
+		for (uint32 i = 0; match && i < count; ++i) {
+			uint64 checksum = 0;
+			uint16 nameLen = 0;
+			match = gzread(gzfp, &checksum, 8) == 8 && gzread(gzfp, &nameLen, 2) == 2 &&
+				nameLen < MAX_PATH && gzread(gzfp, cbuf, nameLen) == nameLen;
+			if (match)
+				_index[checksum] = std::string(cbuf, nameLen);
+		}
+		gzclose(gzfp);
+
+		if (!match)
+			_index.clear();
+	}
+
+	CHDIR(curpath);
+
+	DBG_INFO(80, wst("hires textures indexed: %d\n"), _index.size());
+
+	return _index.empty() ? 0 : 1;
 }
@@ -34,6 +34,7 @@
 #include "TxQuantize.h"
 #include "TxImage.h"
 #include "TxReSample.h"
+#include <string>
 
 class TxHiResCache : public TxCache
 {
@@ -41,19 +42,31 @@ private:
   int _maxwidth;
   int _maxheight;
   int _maxbpp;
+  int _lazyCacheSize;
   boolean _cacheDumped;
   boolean _abortLoad;
   TxImage *_txImage;
   TxQuantize *_txQuantize;
   TxReSample *_txReSample;
   tx_wstring _texPackPath;
+  /* texture pack index. checksum -> texture file path relative to the pack folder.
+   * textures are read in on the first cache miss and evicted by _cacheSize. */
+  std::map<uint64, std::string> _index;
   enum LoadResult {
 	  resOk,
-	  resNotFound,
-	  resError
+	  resNotFound
   };
-  LoadResult loadHiResTextures(const wchar_t * dir_path, boolean replace);
+  boolean _indexHiResTextures(boolean replace);
+  LoadResult _scanHiResTextures(const wchar_t * dir_path, const std::string & prefix, boolean replace);
+  boolean _loadHiResTexture(uint64 checksum, const std::string & filename);
+  uint8 * _readHiResTexture(char *fname, char *pfname, uint32 fmt, uint32 siz,
+							int &width, int &height, ColorFormat &format);
+  boolean _saveIndex() const;
+  boolean _loadIndex();
+  std::string _getRiceIdent() const;
+  tx_wstring _getPackPath() const;
   tx_wstring _getFileName() const;
+  tx_wstring _getIndexFileName() const;
   int _getConfig() const;
 
 public:
@@ -62,12 +75,15 @@ public:
 			   int maxheight,
 			   int maxbpp,
 			   int options,
+			   int cachesize,
 			   const wchar_t *cachePath,
 			   const wchar_t *texPackPath,
 			   const wchar_t *ident,
 			   dispInfoFuncExt callback);
   boolean empty();
   boolean load(boolean replace);
+  boolean get(uint64 checksum, /* checksum hi:palette low:texture */
+              GHQTexInfo *info);
   void dump();
 };
 
@@ -28,7 +28,6 @@
 /* NOTE: The codes are not optimized. They can be made faster. */
 
 #include <functional>
-#include <thread>
 #include <assert.h>
 
 #include "TxQuantize.h"
@@ -819,6 +818,274 @@ TxQuantize::ARGB8888_I8_Slow(uint32* src, uint32* dst, int width, int height)
 	}
 }
 
+/* ETC2 compression.
+ * Color is encoded in the ETC1 compatible individual and differential modes,
+ * which every ETC2 decoder supports. Alpha is encoded as EAC.
+ * Texels of partial blocks repeat the last column and row. */
+
+static const int Etc1Modifiers[8][2] =
+{
+	{  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+	{ 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int EacModifiers[16][8] =
+{
+	{ -3, -6, -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 },
+	{ -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 },
+	{ -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 },
+	{ -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 },
+	{ -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 },
+	{ -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 },
+	{ -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 },
+	{ -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static inline int
+clamp255(int value)
+{
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/* Gathers a 4x4 block in the ETC2 texel order, k = x * 4 + y. */
+static void
+getBlock(const uint8* src, int width, int height, int bx, int by, uint8 block[16][4])
+{
+	for (int x = 0; x < 4; x++) {
+		const int sx = (bx + x < width) ? bx + x : width - 1;
+		for (int y = 0; y < 4; y++) {
+			const int sy = (by + y < height) ? by + y : height - 1;
+			const uint8* texel = src + ((sy * width + sx) << 2);
+			uint8* dst = block[(x << 2) + y];
+			dst[0] = texel[0];
+			dst[1] = texel[1];
+			dst[2] = texel[2];
+			dst[3] = texel[3];
+		}
+	}
+}
+
+static void
+putBlock(uint64 block, uint8* dst)
+{
+	for (int i = 0; i < 8; i++)
+		dst[i] = (uint8)(block >> (56 - (i << 3)));
+}
+
+/* Finds the best modifier table for 8 texels around base color. Returns squared error. */
+static int
+etc1SubBlock(const uint8 block[16][4], const int texels[8], const int base[3], int & table, int indices[8])
+{
+	int bestErr = 0x7fffffff;
+	for (int t = 0; t < 8; t++) {
+		const int modifiers[4] = { Etc1Modifiers[t][0], Etc1Modifiers[t][1], -Etc1Modifiers[t][0], -Etc1Modifiers[t][1] };
+		int colors[4][3];
+		for (int m = 0; m < 4; m++) {
+			for (int c = 0; c < 3; c++)
+				colors[m][c] = clamp255(base[c] + modifiers[m]);
+		}
+		int err = 0;
+		int idx[8];
+		for (int i = 0; i < 8 && err < bestErr; i++) {
+			const uint8* texel = block[texels[i]];
+			int texelErr = 0x7fffffff;
+			for (int m = 0; m < 4; m++) {
+				const int dr = colors[m][0] - texel[0];
+				const int dg = colors[m][1] - texel[1];
+				const int db = colors[m][2] - texel[2];
+				const int e = dr * dr + dg * dg + db * db;
+				if (e < texelErr) {
+					texelErr = e;
+					idx[i] = m;
+				}
+			}
+			err += texelErr;
+		}
+		if (err < bestErr) {
+			bestErr = err;
+			table = t;
+			for (int i = 0; i < 8; i++)
+				indices[i] = idx[i];
+		}
+	}
+	return bestErr;
+}
+
+static uint64
+etc2ColorBlock(const uint8 block[16][4])
+{
+	uint64 bestBlock = 0;
+	int bestErr = 0x7fffffff;
+
+	for (int flip = 0; flip < 2; flip++) {
+		/* flip 0: two 2x4 sub blocks side by side, flip 1: two 4x2 sub blocks on top of each other */
+		int texels[2][8];
+		int count[2] = { 0, 0 };
+		for (int k = 0; k < 16; k++) {
+			const int sub = flip ? ((k & 3) >> 1) : (k >> 3);
+			texels[sub][count[sub]++] = k;
+		}
+
+		int average[2][3];
+		for (int s = 0; s < 2; s++) {
+			for (int c = 0; c < 3; c++) {
+				int sum = 0;
+				for (int i = 0; i < 8; i++)
+					sum += block[texels[s][i]][c];
+				average[s][c] = (sum + 4) >> 3;
+			}
+		}
+
+		for (int diff = 0; diff < 2; diff++) {
+			int quant[2][3];
+			int base[2][3];
+			boolean valid = 1;
+			for (int s = 0; s < 2; s++) {
+				for (int c = 0; c < 3; c++) {
+					if (diff) {
+						quant[s][c] = (average[s][c] * 31 + 127) / 255;
+						base[s][c] = (quant[s][c] << 3) | (quant[s][c] >> 2);
+					} else {
+						quant[s][c] = (average[s][c] * 15 + 127) / 255;
+						base[s][c] = quant[s][c] * 17;
+					}
+				}
+			}
+			if (diff) {
+				for (int c = 0; c < 3; c++) {
+					const int delta = quant[1][c] - quant[0][c];
+					if (delta < -4 || delta > 3)
+						valid = 0;
+				}
+			}
+			if (!valid)
+				continue;
+
+			int table[2];
+			int indices[2][8];
+			const int err = etc1SubBlock(block, texels[0], base[0], table[0], indices[0]) +
+							etc1SubBlock(block, texels[1], base[1], table[1], indices[1]);
+			if (err >= bestErr)
+				continue;
+			bestErr = err;
+
+			uint32 hi;
+			if (diff) {
+				hi = ((uint32)quant[0][0] << 27) | (((quant[1][0] - quant[0][0]) & 7) << 24) |
+					 (quant[0][1] << 19) | (((quant[1][1] - quant[0][1]) & 7) << 16) |
+					 (quant[0][2] << 11) | (((quant[1][2] - quant[0][2]) & 7) << 8);
+			} else {
+				hi = ((uint32)quant[0][0] << 28) | (quant[1][0] << 24) |
+					 (quant[0][1] << 20) | (quant[1][1] << 16) |
+					 (quant[0][2] << 12) | (quant[1][2] << 8);
+			}
+			hi |= (table[0] << 5) | (table[1] << 2) | (diff << 1) | flip;
+
+			uint32 lo = 0;
+			for (int s = 0; s < 2; s++) {
+				for (int i = 0; i < 8; i++) {
+					const int k = texels[s][i];
+					lo |= ((uint32)(indices[s][i] >> 1) << (16 + k)) | ((uint32)(indices[s][i] & 1) << k);
+				}
+			}
+			bestBlock = ((uint64)hi << 32) | lo;
+		}
+	}
+	return bestBlock;
+}
+
+static uint64
+eacAlphaBlock(const uint8 block[16][4])
+{
+	int amin = 255, amax = 0;
+	for (int k = 0; k < 16; k++) {
+		if (block[k][3] < amin) amin = block[k][3];
+		if (block[k][3] > amax) amax = block[k][3];
+	}
+
+	if (amin == amax) {
+		/* table 13 has a zero modifier at index 4 */
+		uint64 res = ((uint64)amin << 56) | ((uint64)1 << 52) | ((uint64)13 << 48);
+		for (int k = 0; k < 16; k++)
+			res |= (uint64)4 << (45 - 3 * k);
+		return res;
+	}
+
+	uint64 bestBlock = 0;
+	int bestErr = 0x7fffffff;
+	for (int t = 0; t < 16; t++) {
+		const int tmin = EacModifiers[t][3];
+		const int tmax = EacModifiers[t][7];
+		const int range = tmax - tmin;
+		const int estimate = (amax - amin + (range >> 1)) / range;
+		for (int mul = estimate - 1; mul <= estimate + 1; mul++) {
+			if (mul < 1 || mul > 15)
+				continue;
+			const int base = clamp255((amin + amax - (tmin + tmax) * mul + 1) >> 1);
+			int values[8];
+			for (int i = 0; i < 8; i++)
+				values[i] = clamp255(base + EacModifiers[t][i] * mul);
+
+			int err = 0;
+			uint64 indices = 0;
+			for (int k = 0; k < 16 && err < bestErr; k++) {
+				int texelErr = 0x7fffffff, idx = 0;
+				for (int i = 0; i < 8; i++) {
+					const int d = values[i] - block[k][3];
+					if (d * d < texelErr) {
+						texelErr = d * d;
+						idx = i;
+					}
+				}
+				err += texelErr;
+				indices |= (uint64)idx << (45 - 3 * k);
+			}
+			if (err < bestErr) {
+				bestErr = err;
+				bestBlock = ((uint64)base << 56) | ((uint64)mul << 52) | ((uint64)t << 48) | indices;
+			}
+		}
+	}
+	return bestBlock;
+}
+
+void
+TxQuantize::ARGB8888_ETC2(uint32* src, uint32* dst, int width, int height)
+{
+	uint8 block[16][4];
+	uint8 *dest = (uint8 *)dst;
+	for (int y = 0; y < height; y += 4) {
+		for (int x = 0; x < width; x += 4) {
+			getBlock((uint8*)src, width, height, x, y, block);
+			putBlock(etc2ColorBlock(block), dest);
+			dest += 8;
+		}
+	}
+}
+
+void
+TxQuantize::ARGB8888_ETC2_EAC(uint32* src, uint32* dst, int width, int height)
+{
+	uint8 block[16][4];
+	uint8 *dest = (uint8 *)dst;
+	for (int y = 0; y < height; y += 4) {
+		for (int x = 0; x < width; x += 4) {
+			getBlock((uint8*)src, width, height, x, y, block);
+			putBlock(eacAlphaBlock(block), dest);
+			putBlock(etc2ColorBlock(block), dest + 8);
+			dest += 16;
+		}
+	}
+}
+
 void
 TxQuantize::P8_16BPP(uint32* src, uint32* dest, int width, int height, uint32* palette)
 {
@@ -831,10 +1098,34 @@ TxQuantize::P8_16BPP(uint32* src, uint32* dest, int width, int height, uint32* p
 	}
 }
 
+void
+TxQuantize::_run(quantizerFunc quantizer, uint8* src, uint8* dest, int width, int height, unsigned int srcBlockRow, unsigned int destBlockRow)
+{
+	/* split the texture into strips of 4 texel rows, one for each core */
+	unsigned int numcore = _numcore;
+	unsigned int blkrow = 0;
+	while (numcore > 1 && blkrow == 0) {
+		blkrow = (height >> 2) / numcore;
+		numcore--;
+	}
+	if (blkrow > 0 && numcore > 1) {
+		const int blkheight = blkrow << 2;
+		const unsigned int srcStride = srcBlockRow * blkrow;
+		const unsigned int destStride = destBlockRow * blkrow;
+		TxThreadPool::getInstance()->run(numcore, [&](uint32 i) {
+			(*this.*quantizer)((uint32*)(src + srcStride * i),
+							   (uint32*)(dest + destStride * i),
+							   width,
+							   (i < numcore - 1) ? blkheight : height - blkheight * i);
+		});
+	} else {
+		(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
+	}
+}
+
 boolean
 TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat srcformat, ColorFormat destformat, boolean fastQuantizer)
 {
-	typedef void (TxQuantize::*quantizerFunc)(uint32* src, uint32* dest, int width, int height);
 	assert(srcformat != graphics::colorFormat::RGBA);
 	assert(destformat != graphics::colorFormat::RGBA);
 	quantizerFunc quantizer;
@@ -853,42 +1144,22 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 		} else
 			return 0;
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-			std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
-			unsigned int destStride = srcStride << bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-				src  += srcStride;
-				dest += destStride;
-			}
-			thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
+		_run(quantizer, src, dest, width, height, (width << 4) >> bpp_shift, width << 4);
+
+	} else if (srcformat == graphics::internalcolorFormat::RGBA8 &&
+			   (destformat == graphics::internalcolorFormat::COMPRESSED_RGB8_ETC2 ||
+				destformat == graphics::internalcolorFormat::COMPRESSED_RGBA8_ETC2_EAC)) {
+		unsigned int blocksize;
+		if (destformat == graphics::internalcolorFormat::COMPRESSED_RGB8_ETC2) {
+			quantizer = &TxQuantize::ARGB8888_ETC2;
+			blocksize = 8;
 		} else {
-			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
+			quantizer = &TxQuantize::ARGB8888_ETC2_EAC;
+			blocksize = 16;
 		}
 
+		_run(quantizer, src, dest, width, height, width << 4, ((width + 3) >> 2) * blocksize);
+
 	} else if (srcformat == graphics::internalcolorFormat::RGBA8) {
 		if (destformat == graphics::internalcolorFormat::RGB5_A1) {
 			quantizer = fastQuantizer ? &TxQuantize::ARGB8888_ARGB1555 : &TxQuantize::ARGB8888_ARGB1555_ErrD;
@@ -902,41 +1173,7 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 		} else
 			return 0;
 
-		unsigned int numcore = _numcore;
-		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
-			blkrow = (height >> 2) / numcore;
-			numcore--;
-		}
-		if (blkrow > 0 && numcore > 1) {
-			std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << 2;
-			unsigned int destStride = srcStride >> bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));
-				src  += srcStride;
-				dest += destStride;
-			}
-			thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));
-			for (i = 0; i < numcore; i++) {
-				thrd[i]->join();
-				delete thrd[i];
-			}
-		} else {
-			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
-		}
+		_run(quantizer, src, dest, width, height, width << 4, (width << 4) >> bpp_shift);
 
 	} else {
 		return 0;
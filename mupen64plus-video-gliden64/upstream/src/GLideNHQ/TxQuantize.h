@@ -30,8 +30,13 @@
 class TxQuantize
 {
 private:
+  typedef void (TxQuantize::*quantizerFunc)(uint32* src, uint32* dest, int width, int height);
+
   int _numcore;
 
+  /* run quantizer on strips of the texture in the worker threads */
+  void _run(quantizerFunc quantizer, uint8* src, uint8* dest, int width, int height, unsigned int srcBlockRow, unsigned int destBlockRow);
+
   /* fast optimized... well, sort of. */
   void ARGB1555_ARGB8888(uint32* src, uint32* dst, int width, int height);
   void ARGB4444_ARGB8888(uint32* src, uint32* dst, int width, int height);
@@ -55,6 +60,10 @@ private:
   void ARGB8888_AI88_Slow(uint32* src, uint32* dst, int width, int height);
   void ARGB8888_I8_Slow(uint32* src, uint32* dst, int width, int height);
 
+  /* ETC2 block compression */
+  void ARGB8888_ETC2(uint32* src, uint32* dst, int width, int height);
+  void ARGB8888_ETC2_EAC(uint32* src, uint32* dst, int width, int height);
+
 public:
   TxQuantize();
   ~TxQuantize();
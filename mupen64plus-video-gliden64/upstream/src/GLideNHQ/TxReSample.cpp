@@ -23,6 +23,7 @@
 
 #include "TxReSample.h"
 #include "TxDbg.h"
+#include "TxUtil.h"
 #include <stdlib.h>
 #include <memory.h>
 
@@ -239,6 +240,12 @@ TxReSample::kaiser(double x)
 	return sinc(x) * besselI0(alpha * sqrt(1 - ratio * ratio)) / besselI0(alpha);
 }
 
+TxReSample::TxReSample()
+{
+	/* get number of CPU cores. */
+	_numcore = TxUtil::getNumberofProcessors();
+}
+
 boolean
 TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
 {
@@ -255,19 +262,20 @@ TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
    */
 	double half_window = 5.0;
 
-	int x, y, x2, y2, z;
-	double A, R, G, B;
-	uint32 texel;
-
 	int tmpwidth = *width / ratio;
 	int tmpheight = *height / ratio;
 
+	/* split the destination rows into bands, one for each core */
+	uint32 numband = _numcore;
+	if (numband > (uint32)tmpheight) numband = (uint32)tmpheight;
+	if (numband < 1) numband = 1;
+
 	/* resampled destination */
 	uint8 *tmptex = (uint8*)malloc((tmpwidth * tmpheight) << 2);
 	if (!tmptex) return 0;
 
-	/* work buffer. single row */
-	uint8 *workbuf = (uint8*)malloc(*width << 2);
+	/* work buffers. single row per band */
+	uint8 *workbuf = (uint8*)malloc((*width << 2) * numband);
 	if (!workbuf) {
 		free(tmptex);
 		return 0;
@@ -280,7 +288,7 @@ TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
 		free(workbuf);
 		return 0;
 	}
-	for (x = 0; x < half_window * ratio; x++) {
+	for (int x = 0; x < half_window * ratio; x++) {
 		//weight[x] = tent((double)x / ratio) / ratio;
 		//weight[x] = gaussian((double)x / ratio) / ratio;
 		//weight[x] = lanczos3((double)x / ratio) / ratio;
@@ -289,64 +297,74 @@ TxReSample::minify(uint8 **src, int *width, int *height, int ratio)
 	}
 
 	/* linear convolution */
-	for (y = 0; y < tmpheight; y++) {
-		for (x = 0; x < *width; x++) {
-			texel = ((uint32*)*src)[y * ratio * *width + x];
-			A = (double)(texel >> 24) * weight[0];
-			R = (double)((texel >> 16) & 0xff) * weight[0];
-			G = (double)((texel >>  8) & 0xff) * weight[0];
-			B = (double)((texel      ) & 0xff) * weight[0];
-			for (y2 = 1; y2 < half_window * ratio; y2++) {
-				z = y * ratio + y2;
-				if (z >= *height) z = *height - 1;
-				texel = ((uint32*)*src)[z * *width + x];
-				A += (double)(texel >> 24) * weight[y2];
-				R += (double)((texel >> 16) & 0xff) * weight[y2];
-				G += (double)((texel >>  8) & 0xff) * weight[y2];
-				B += (double)((texel      ) & 0xff) * weight[y2];
-				z = y * ratio - y2;
-				if (z < 0) z = 0;
-				texel = ((uint32*)*src)[z * *width + x];
-				A += (double)(texel >> 24) * weight[y2];
-				R += (double)((texel >> 16) & 0xff) * weight[y2];
-				G += (double)((texel >>  8) & 0xff) * weight[y2];
-				B += (double)((texel      ) & 0xff) * weight[y2];
+	const int bandheight = tmpheight / numband;
+	TxThreadPool::getInstance()->run(numband, [&](uint32 i) {
+		const int ystart = bandheight * i;
+		const int yend = (i < numband - 1) ? ystart + bandheight : tmpheight;
+		uint32 *rowbuf = (uint32*)workbuf + *width * i;
+		int x, x2, y2, z;
+		double A, R, G, B;
+		uint32 texel;
+
+		for (int y = ystart; y < yend; y++) {
+			for (x = 0; x < *width; x++) {
+				texel = ((uint32*)*src)[y * ratio * *width + x];
+				A = (double)(texel >> 24) * weight[0];
+				R = (double)((texel >> 16) & 0xff) * weight[0];
+				G = (double)((texel >>  8) & 0xff) * weight[0];
+				B = (double)((texel      ) & 0xff) * weight[0];
+				for (y2 = 1; y2 < half_window * ratio; y2++) {
+					z = y * ratio + y2;
+					if (z >= *height) z = *height - 1;
+					texel = ((uint32*)*src)[z * *width + x];
+					A += (double)(texel >> 24) * weight[y2];
+					R += (double)((texel >> 16) & 0xff) * weight[y2];
+					G += (double)((texel >>  8) & 0xff) * weight[y2];
+					B += (double)((texel      ) & 0xff) * weight[y2];
+					z = y * ratio - y2;
+					if (z < 0) z = 0;
+					texel = ((uint32*)*src)[z * *width + x];
+					A += (double)(texel >> 24) * weight[y2];
+					R += (double)((texel >> 16) & 0xff) * weight[y2];
+					G += (double)((texel >>  8) & 0xff) * weight[y2];
+					B += (double)((texel      ) & 0xff) * weight[y2];
+				}
+				if (A < 0) A = 0; else if (A > 255) A = 255;
+				if (R < 0) R = 0; else if (R > 255) R = 255;
+				if (G < 0) G = 0; else if (G > 255) G = 255;
+				if (B < 0) B = 0; else if (B > 255) B = 255;
+				rowbuf[x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
 			}
-			if (A < 0) A = 0; else if (A > 255) A = 255;
-			if (R < 0) R = 0; else if (R > 255) R = 255;
-			if (G < 0) G = 0; else if (G > 255) G = 255;
-			if (B < 0) B = 0; else if (B > 255) B = 255;
-			((uint32*)workbuf)[x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
-		}
-		for (x = 0; x < tmpwidth; x++) {
-			texel = ((uint32*)workbuf)[x * ratio];
-			A = (double)(texel >> 24) * weight[0];
-			R = (double)((texel >> 16) & 0xff) * weight[0];
-			G = (double)((texel >>  8) & 0xff) * weight[0];
-			B = (double)((texel      ) & 0xff) * weight[0];
-			for (x2 = 1; x2 < half_window * ratio; x2++) {
-				z = x * ratio + x2;
-				if (z >= *width) z = *width - 1;
-				texel = ((uint32*)workbuf)[z];
-				A += (double)(texel >> 24) * weight[x2];
-				R += (double)((texel >> 16) & 0xff) * weight[x2];
-				G += (double)((texel >>  8) & 0xff) * weight[x2];
-				B += (double)((texel      ) & 0xff) * weight[x2];
-				z = x * ratio - x2;
-				if (z < 0) z = 0;
-				texel = ((uint32*)workbuf)[z];
-				A += (double)(texel >> 24) * weight[x2];
-				R += (double)((texel >> 16) & 0xff) * weight[x2];
-				G += (double)((texel >>  8) & 0xff) * weight[x2];
-				B += (double)((texel      ) & 0xff) * weight[x2];
+			for (x = 0; x < tmpwidth; x++) {
+				texel = rowbuf[x * ratio];
+				A = (double)(texel >> 24) * weight[0];
+				R = (double)((texel >> 16) & 0xff) * weight[0];
+				G = (double)((texel >>  8) & 0xff) * weight[0];
+				B = (double)((texel      ) & 0xff) * weight[0];
+				for (x2 = 1; x2 < half_window * ratio; x2++) {
+					z = x * ratio + x2;
+					if (z >= *width) z = *width - 1;
+					texel = rowbuf[z];
+					A += (double)(texel >> 24) * weight[x2];
+					R += (double)((texel >> 16) & 0xff) * weight[x2];
+					G += (double)((texel >>  8) & 0xff) * weight[x2];
+					B += (double)((texel      ) & 0xff) * weight[x2];
+					z = x * ratio - x2;
+					if (z < 0) z = 0;
+					texel = rowbuf[z];
+					A += (double)(texel >> 24) * weight[x2];
+					R += (double)((texel >> 16) & 0xff) * weight[x2];
+					G += (double)((texel >>  8) & 0xff) * weight[x2];
+					B += (double)((texel      ) & 0xff) * weight[x2];
+				}
+				if (A < 0) A = 0; else if (A > 255) A = 255;
+				if (R < 0) R = 0; else if (R > 255) R = 255;
+				if (G < 0) G = 0; else if (G > 255) G = 255;
+				if (B < 0) B = 0; else if (B > 255) B = 255;
+				((uint32*)tmptex)[y * tmpwidth + x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
 			}
-			if (A < 0) A = 0; else if (A > 255) A = 255;
-			if (R < 0) R = 0; else if (R > 255) R = 255;
-			if (G < 0) G = 0; else if (G > 255) G = 255;
-			if (B < 0) B = 0; else if (B > 255) B = 255;
-			((uint32*)tmptex)[y * tmpwidth + x] = (((uint32)A << 24) | ((uint32)R << 16) | ((uint32)G << 8) | (uint32)B);
 		}
-	}
+	});
 
 	free(*src);
 	*src = tmptex;
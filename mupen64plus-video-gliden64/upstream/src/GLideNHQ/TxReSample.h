@@ -29,6 +29,8 @@
 class TxReSample
 {
 private:
+  int _numcore;
+
   double tent(double x);
   double gaussian(double x);
   double sinc(double x);
@@ -37,6 +39,7 @@ private:
   double besselI0(double x);
   double kaiser(double x);
 public:
+  TxReSample();
   boolean minify(uint8 **src, int *width, int *height, int ratio);
   boolean nextPow2(uint8** image, int* width, int* height, int bpp, boolean use_3dfx);
   int nextPow2(int num);
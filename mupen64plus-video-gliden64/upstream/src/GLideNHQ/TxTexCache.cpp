@@ -80,5 +80,5 @@ tx_wstring TxTexCache::_getFileName() const
 
 int TxTexCache::_getConfig() const
 {
-	return _options & (FILTER_MASK | ENHANCEMENT_MASK | FORCE16BPP_TEX | GZ_TEXCACHE);
+	return _options & (FILTER_MASK | ENHANCEMENT_MASK | FORCE16BPP_TEX | ETC2_TEX | GZ_TEXCACHE);
 }
@@ -26,6 +26,7 @@
 #include "TxDbg.h"
 #include <zlib.h>
 #include <assert.h>
+#include <stdint.h>
 
 #if defined (OS_WINDOWS)
 #include <malloc.h>
@@ -38,6 +39,13 @@
 #include <malloc.h>
 #endif
 
+#ifndef OS_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 /*
  * Utilities
  ******************************************************************************/
@@ -69,6 +77,10 @@ TxUtil::sizeofTx(int width, int height, ColorFormat format)
 		dataSize = (width * height) << 1;
 	} else if (format == graphics::internalcolorFormat::RGBA8) {
 		dataSize = (width * height) << 2;
+	} else if (format == graphics::internalcolorFormat::COMPRESSED_RGB8_ETC2) {
+		dataSize = ((width + 3) >> 2) * ((height + 3) >> 2) * 8;
+	} else if (format == graphics::internalcolorFormat::COMPRESSED_RGBA8_ETC2_EAC) {
+		dataSize = ((width + 3) >> 2) * ((height + 3) >> 2) * 16;
 	} else {
 		/* unsupported format */
 		DBG_INFO(80, wst("Error: cannot get size. unsupported gfmt:%x\n"), format);
@@ -77,6 +89,18 @@ TxUtil::sizeofTx(int width, int height, ColorFormat format)
 	return dataSize;
 }
 
+boolean
+TxUtil::isOpaque(const uint8 *src, int width, int height)
+{
+	const uint32 *texel = (const uint32*)src;
+	const int size = width * height;
+	for (int i = 0; i < size; i++) {
+		if ((texel[i] & 0xff000000) != 0xff000000)
+			return 0;
+	}
+	return 1;
+}
+
 uint32
 TxUtil::checksum(uint8 *src, int width, int height, int size, int rowStride)
 {
@@ -584,6 +608,193 @@ TxMemBuf::getThreadBuf(uint32 threadIdx, uint32 num, uint32 size)
 	return buf.data();
 }
 
+/*
+ * Worker threads
+ ******************************************************************************/
+TxThreadPool::TxThreadPool()
+	: _count(0)
+	, _running(0)
+	, _generation(0)
+	, _stop(0)
+{
+}
+
+TxThreadPool::~TxThreadPool()
+{
+	shutdown();
+}
+
+void
+TxThreadPool::init(uint32 numThreads)
+{
+	std::lock_guard<std::mutex> busy(_busy);
+	if (!_workers.empty())
+		return;
+
+	_stop = 0;
+	/* the calling thread is worker 0 */
+	for (uint32 i = 1; i < numThreads; i++)
+		_workers.emplace_back(&TxThreadPool::_workerLoop, this, i);
+}
+
+void
+TxThreadPool::shutdown()
+{
+	std::lock_guard<std::mutex> busy(_busy);
+	if (_workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = 1;
+	}
+	_signalWork.notify_all();
+	for (auto & worker : _workers)
+		worker.join();
+	_workers.clear();
+}
+
+void
+TxThreadPool::_workerLoop(uint32 worker)
+{
+	uint64 generation = 0;
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		_signalWork.wait(lock, [&]() { return _stop || _generation != generation; });
+		if (_stop)
+			return;
+		generation = _generation;
+
+		if (worker < _count) {
+			lock.unlock();
+			_task(worker);
+			lock.lock();
+		}
+
+		if (--_running == 0)
+			_signalDone.notify_one();
+	}
+}
+
+void
+TxThreadPool::run(uint32 count, const std::function<void(uint32)> & task)
+{
+	std::unique_lock<std::mutex> busy(_busy, std::try_to_lock);
+	if (!busy.owns_lock() || _workers.empty() || count < 2) {
+		for (uint32 i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_task = task;
+		_count = count;
+		_running = (uint32)_workers.size();
+		_generation++;
+	}
+	_signalWork.notify_all();
+
+	task(0);
+	/* more tasks than threads */
+	for (uint32 i = (uint32)_workers.size() + 1; i < count; i++)
+		task(i);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_signalDone.wait(lock, [this]() { return _running == 0; });
+	_task = nullptr;
+}
+
+/*
+ * Read only file mapping
+ ******************************************************************************/
+TxMappedFile::TxMappedFile()
+	: _data(nullptr)
+	, _size(0)
+#ifdef OS_WINDOWS
+	, _file(INVALID_HANDLE_VALUE)
+	, _mapping(nullptr)
+#endif
+{
+}
+
+TxMappedFile::~TxMappedFile()
+{
+	close();
+}
+
+boolean
+TxMappedFile::open(const char *filename)
+{
+	close();
+
+#ifdef OS_WINDOWS
+	_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+		return 0;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0 || (uint64)fileSize.QuadPart > (uint64)SIZE_MAX) {
+		close();
+		return 0;
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		close();
+		return 0;
+	}
+
+	_data = (const uint8*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (_data == nullptr) {
+		close();
+		return 0;
+	}
+	_size = (size_t)fileSize.QuadPart;
+#else
+	const int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64)st.st_size > (uint64)SIZE_MAX) {
+		::close(fd);
+		return 0;
+	}
+
+	void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	/* the mapping stays valid after the descriptor is closed */
+	::close(fd);
+	if (data == MAP_FAILED)
+		return 0;
+
+	_data = (const uint8*)data;
+	_size = (size_t)st.st_size;
+#endif
+
+	return 1;
+}
+
+void
+TxMappedFile::close()
+{
+#ifdef OS_WINDOWS
+	if (_data != nullptr)
+		UnmapViewOfFile(_data);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+#else
+	if (_data != nullptr)
+		munmap((void*)_data, _size);
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
 void setTextureFormat(ColorFormat internalFormat, GHQTexInfo * info)
 {
 	info->format = u32(internalFormat);
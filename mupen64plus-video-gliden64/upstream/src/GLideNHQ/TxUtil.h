@@ -31,8 +31,13 @@
 
 /* extension for cache files */
 #define TEXCACHE_EXT wst("htc")
+#define HIRESINDEX_EXT wst("hti")
 
 #include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 class TxUtil
 {
@@ -45,6 +50,7 @@ private:
 public:
 	static int sizeofTx(int width, int height, ColorFormat format);
 	static uint32 checksumTx(uint8 *data, int width, int height, ColorFormat format);
+	static boolean isOpaque(const uint8 *src, int width, int height); /* RGBA8 texture has no alpha */
 #if 0 /* unused */
 	static uint32 chkAlpha(uint32* src, int width, int height);
 #endif
@@ -73,6 +79,57 @@ public:
 	uint32 *getThreadBuf(uint32 threadIdx, uint32 num, uint32 size);
 };
 
+/* persistent worker threads for texture filters and quantizers.
+ * run() calls task(0) .. task(count - 1) in parallel and returns when all are done.
+ * task(0) runs in the calling thread. When the pool is not started or another
+ * thread is using it, all tasks run in the calling thread. */
+class TxThreadPool
+{
+private:
+	std::vector<std::thread> _workers;
+	std::function<void(uint32)> _task;
+	uint32 _count;
+	uint32 _running;
+	uint64 _generation;
+	boolean _stop;
+	std::mutex _busy;
+	std::mutex _mutex;
+	std::condition_variable _signalWork;
+	std::condition_variable _signalDone;
+	TxThreadPool();
+	void _workerLoop(uint32 worker);
+public:
+	static TxThreadPool* getInstance() {
+		static TxThreadPool txThreadPool;
+		return &txThreadPool;
+	}
+	~TxThreadPool();
+	void init(uint32 numThreads);
+	void shutdown();
+	void run(uint32 count, const std::function<void(uint32)> & task);
+};
+
+/* read only memory mapping of a whole file */
+class TxMappedFile
+{
+private:
+	const uint8 *_data;
+	size_t _size;
+#ifdef OS_WINDOWS
+	HANDLE _file;
+	HANDLE _mapping;
+#endif
+	TxMappedFile(const TxMappedFile &);
+	TxMappedFile & operator=(const TxMappedFile &);
+public:
+	TxMappedFile();
+	~TxMappedFile();
+	boolean open(const char *filename);
+	void close();
+	const uint8 *data() const { return _data; }
+	size_t size() const { return _size; }
+};
+
 void setTextureFormat(ColorFormat internalFormat, GHQTexInfo * info);
 
 #endif /* __TXUTIL_H__ */
@@ -0,0 +1,181 @@
+/*
+ * Texture Filtering benchmark
+ *
+ * Runs the hq2x, hq4x and xBRZ enhancers over sample textures and prints
+ * time and output checksum of each filter. Build once as is and once with
+ * -DTXFILTER_NO_SIMD to compare vectorized and scalar filters.
+ *
+ * Usage: bench_hq [-n iterations] [texture.png ...]
+ * Without textures, a set of generated 64x64 and 256x256 test images is used.
+ *
+ * this is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * this is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <png.h>
+#include "../TextureFilters.h"
+#include "../TextureFilters_simd.h"
+
+struct Texture
+{
+  int width, height;
+  std::vector<uint32> pixels; /* RGBA8, red in lowest byte */
+};
+
+static bool loadPng(const char *filename, Texture &tex)
+{
+  png_image image;
+  memset(&image, 0, sizeof(image));
+  image.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&image, filename))
+	return false;
+
+  image.format = PNG_FORMAT_RGBA;
+  tex.width = image.width;
+  tex.height = image.height;
+  tex.pixels.resize(image.width * image.height);
+  if (!png_image_finish_read(&image, NULL, tex.pixels.data(), 0, NULL)) {
+	png_image_free(&image);
+	return false;
+  }
+  return true;
+}
+
+/* flat areas, gradients, hard edges and noise like N64 textures have */
+static void makeTexture(int width, int height, unsigned seed, Texture &tex)
+{
+  static const uint32 palette[8] = {
+	0xFF000000, 0xFFFFFFFF, 0xFF2040C0, 0xFF30A030,
+	0xFFC08020, 0xFF8080FF, 0x80FF0000, 0x00000000
+  };
+
+  tex.width = width;
+  tex.height = height;
+  tex.pixels.resize(width * height);
+  srand(seed);
+  const int cell = 4 + (seed % 5) * 2;
+  for (int y = 0; y < height; y++) {
+	for (int x = 0; x < width; x++) {
+	  uint32 c;
+	  switch (((x / cell) * 7 + (y / cell) * 3 + seed) % 4) {
+	  case 0: /* flat */
+		c = palette[((x / cell) + (y / cell)) & 7];
+		break;
+	  case 1: /* gradient */
+		c = 0xFF000000 | ((x * 255 / width) << 16) | ((y * 255 / height) << 8) | ((x + y) & 0xFF);
+		break;
+	  case 2: /* diagonal edge */
+		c = (x % cell) > (y % cell) ? palette[2] : palette[4];
+		break;
+	  default: /* noise */
+		c = 0xFF000000 | (rand() & 0x3F3F3F) | 0x404040;
+		break;
+	  }
+	  tex.pixels[y * width + x] = c;
+	}
+  }
+}
+
+static uint32 checksum(const std::vector<uint32> &data, size_t count)
+{
+  uint32 hash = 2166136261u;
+  for (size_t i = 0; i < count; i++)
+	hash = (hash ^ data[i]) * 16777619u;
+  return hash;
+}
+
+enum Filter { HQ2X, HQ4X, XBRZ2, XBRZ3, XBRZ4, XBRZ5, XBRZ6 };
+
+static const struct {
+  Filter filter;
+  int scale;
+  const char *name;
+} filters[] = {
+  { HQ2X, 2, "hq2x" },
+  { HQ4X, 4, "hq4x" },
+  { XBRZ2, 2, "2xBRZ" },
+  { XBRZ3, 3, "3xBRZ" },
+  { XBRZ4, 4, "4xBRZ" },
+  { XBRZ5, 5, "5xBRZ" },
+  { XBRZ6, 6, "6xBRZ" },
+};
+
+static void runFilter(Filter filter, Texture &tex, uint32 *dest)
+{
+  uint32 *src = tex.pixels.data();
+  switch (filter) {
+  case HQ2X:
+	hq2x_32((uint8*)src, tex.width << 2, (uint8*)dest, tex.width << 3, tex.width, tex.height);
+	break;
+  case HQ4X:
+	hq4x_8888((uint8*)src, (uint8*)dest, tex.width, tex.height, tex.width, tex.width << 4);
+	break;
+  default:
+	xbrz::scale(2 + filter - XBRZ2, (const uint32_t *)src, (uint32_t *)dest, tex.width, tex.height, xbrz::ColorFormat::ABGR);
+	break;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  int iterations = 20;
+  std::vector<Texture> textures;
+
+  for (int i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+	  iterations = atoi(argv[++i]);
+	  continue;
+	}
+	Texture tex;
+	if (!loadPng(argv[i], tex)) {
+	  printf("Can't read %s\n", argv[i]);
+	  return 1;
+	}
+	textures.push_back(tex);
+  }
+
+  if (textures.empty()) {
+	for (unsigned i = 0; i < 8; i++) {
+	  Texture tex;
+	  makeTexture(i < 6 ? 64 : 256, i < 6 ? 64 : 256, i, tex);
+	  textures.push_back(tex);
+	}
+  }
+
+#ifdef TXFILTER_SIMD
+  printf("%u textures, %d iterations, SIMD filters\n", (unsigned)textures.size(), iterations);
+#else
+  printf("%u textures, %d iterations, scalar filters\n", (unsigned)textures.size(), iterations);
+#endif
+
+  xbrz::init();
+
+  for (const auto &f : filters) {
+	double ms = 0.0;
+	uint32 hash = 0;
+	for (auto &tex : textures) {
+	  const size_t count = (size_t)tex.width * tex.height * f.scale * f.scale;
+	  std::vector<uint32> dest(count);
+	  const auto start = std::chrono::steady_clock::now();
+	  for (int i = 0; i < iterations; i++)
+		runFilter(f.filter, tex, dest.data());
+	  ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	  hash = hash * 31 + checksum(dest, count);
+	}
+	printf("%-6s %10.2f ms  checksum %08x\n", f.name, ms / iterations, hash);
+  }
+
+  return 0;
+}
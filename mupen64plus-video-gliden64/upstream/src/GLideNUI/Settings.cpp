@@ -36,10 +36,12 @@ void _loadSettings(QSettings & settings)
 	config.texture.maxAnisotropy = settings.value("maxAnisotropy", config.texture.maxAnisotropy).toInt();
 	config.texture.bilinearMode = settings.value("bilinearMode", config.texture.bilinearMode).toInt();
 	config.texture.screenShotFormat = settings.value("screenShotFormat", config.texture.screenShotFormat).toInt();
+	config.texture.enableGPUTMEM = settings.value("enableGPUTMEM", config.texture.enableGPUTMEM).toInt();
 	settings.endGroup();
 
 	settings.beginGroup("generalEmulation");
 	config.generalEmulation.enableNoise = settings.value("enableNoise", config.generalEmulation.enableNoise).toInt();
+	config.generalEmulation.enableShaderNoise = settings.value("enableShaderNoise", config.generalEmulation.enableShaderNoise).toInt();
 	config.generalEmulation.enableLOD = settings.value("enableLOD", config.generalEmulation.enableLOD).toInt();
 	config.generalEmulation.enableHWLighting = settings.value("enableHWLighting", config.generalEmulation.enableHWLighting).toInt();
 	config.generalEmulation.enableShadersStorage = settings.value("enableShadersStorage", config.generalEmulation.enableShadersStorage).toInt();
@@ -112,6 +114,7 @@ void _loadSettings(QSettings & settings)
 	config.onScreenDisplay.percent = settings.value("showPercent", config.onScreenDisplay.percent).toInt();
 	config.onScreenDisplay.internalResolution = settings.value("showInternalResolution", config.onScreenDisplay.internalResolution).toInt();
 	config.onScreenDisplay.renderingResolution = settings.value("showRenderingResolution", config.onScreenDisplay.renderingResolution).toInt();
+	config.onScreenDisplay.statistics = settings.value("showStatistics", config.onScreenDisplay.statistics).toInt();
 	config.onScreenDisplay.pos = settings.value("osdPos", config.onScreenDisplay.pos).toInt();
 	settings.endGroup();
 
@@ -165,10 +168,12 @@ void writeSettings(const QString & _strIniFolder)
 	settings.setValue("maxAnisotropy", config.texture.maxAnisotropy);
 	settings.setValue("bilinearMode", config.texture.bilinearMode);
 	settings.setValue("screenShotFormat", config.texture.screenShotFormat);
+	settings.setValue("enableGPUTMEM", config.texture.enableGPUTMEM);
 	settings.endGroup();
 
 	settings.beginGroup("generalEmulation");
 	settings.setValue("enableNoise", config.generalEmulation.enableNoise);
+	settings.setValue("enableShaderNoise", config.generalEmulation.enableShaderNoise);
 	settings.setValue("enableLOD", config.generalEmulation.enableLOD);
 	settings.setValue("enableHWLighting", config.generalEmulation.enableHWLighting);
 	settings.setValue("enableShadersStorage", config.generalEmulation.enableShadersStorage);
@@ -228,6 +233,7 @@ void writeSettings(const QString & _strIniFolder)
 	settings.setValue("showPercent", config.onScreenDisplay.percent);
 	settings.setValue("showInternalResolution", config.onScreenDisplay.internalResolution);
 	settings.setValue("showRenderingResolution", config.onScreenDisplay.renderingResolution);
+	settings.setValue("showStatistics", config.onScreenDisplay.statistics);
 	settings.setValue("osdPos", config.onScreenDisplay.pos);
 	settings.endGroup();
 
@@ -16,10 +16,68 @@ namespace graphics {
 		vecOptions.push_back(config.frameBufferEmulation.N64DepthCompare);
 		vecOptions.push_back(config.generalEmulation.enableLegacyBlending);
 		vecOptions.push_back(config.generalEmulation.enableFragmentDepthWrite);
+		vecOptions.push_back(config.texture.enableGPUTMEM);
+		vecOptions.push_back(config.generalEmulation.enableShaderNoise);
 		u32 optionsSet = 0;
 		for (u32 i = 0; i < vecOptions.size(); ++i)
 			optionsSet |= vecOptions[i] << i;
 		return optionsSet;
 	}
 
+	/*---------------Combiners-------------*/
+
+	void Combiners::clear()
+	{
+		m_programs.clear();
+		m_slots.clear();
+	}
+
+	u32 Combiners::_findSlot(u64 _mux) const
+	{
+		// Fibonacci hashing spreads mux bits over the table index
+		const u32 mask = static_cast<u32>(m_slots.size()) - 1;
+		u32 i = static_cast<u32>((_mux * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+		while (m_slots[i].index != 0 && m_slots[i].mux != _mux)
+			i = (i + 1) & mask;
+		return i;
+	}
+
+	void Combiners::_rehash(size_t _capacity)
+	{
+		m_slots.assign(_capacity, Slot());
+		for (size_t i = 0; i < m_programs.size(); ++i) {
+			const u64 mux = m_programs[i].first.getMux();
+			Slot & slot = m_slots[_findSlot(mux)];
+			slot.mux = mux;
+			slot.index = static_cast<u32>(i + 1);
+		}
+	}
+
+	Combiners::iterator Combiners::find(const CombinerKey & _key)
+	{
+		if (m_slots.empty())
+			return end();
+		const Slot & slot = m_slots[_findSlot(_key.getMux())];
+		if (slot.index == 0)
+			return end();
+		return m_programs.begin() + (slot.index - 1);
+	}
+
+	CombinerProgram *& Combiners::operator[](const CombinerKey & _key)
+	{
+		iterator iter = find(_key);
+		if (iter != end())
+			return iter->second;
+
+		// Keep load factor at most 1/2, so probe sequences stay short
+		if ((m_programs.size() + 1) * 2 > m_slots.size())
+			_rehash(m_slots.empty() ? 256 : m_slots.size() * 2);
+
+		m_programs.emplace_back(_key, nullptr);
+		Slot & slot = m_slots[_findSlot(_key.getMux())];
+		slot.mux = _key.getMux();
+		slot.index = static_cast<u32>(m_programs.size());
+		return m_programs.back().second;
+	}
+
 }
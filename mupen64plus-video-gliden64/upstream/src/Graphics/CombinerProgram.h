@@ -1,5 +1,5 @@
 #pragma once
-#include <map>
+#include <utility>
 #include <vector>
 #include "CombinerKey.h"
 
@@ -22,8 +22,47 @@ namespace graphics {
 
 		virtual bool getBinaryForm(std::vector<char> & _buffer) = 0;
 
+		// False while the program is still being linked in background.
+		virtual bool isReady() = 0;
+
+		// Number of draw calls that used the program, kept in shaders storage.
+		virtual u32 getUsageCount() const = 0;
+
 		static u32 getShaderCombinerOptionsBits();
 	};
 
-	typedef std::map<CombinerKey, graphics::CombinerProgram *> Combiners;
+	// Combiner programs by key, looked up per draw call.
+	// Open addressing hash table with linear probing. It holds indices into an array of
+	// (key, program) pairs, which keeps programs in insertion order. Programs are never
+	// removed one by one, the whole container is cleared instead.
+	class Combiners
+	{
+	public:
+		typedef std::pair<CombinerKey, CombinerProgram *> value_type;
+		typedef std::vector<value_type>::iterator iterator;
+		typedef std::vector<value_type>::const_iterator const_iterator;
+
+		iterator begin() { return m_programs.begin(); }
+		iterator end() { return m_programs.end(); }
+		const_iterator begin() const { return m_programs.begin(); }
+		const_iterator end() const { return m_programs.end(); }
+		size_t size() const { return m_programs.size(); }
+		bool empty() const { return m_programs.empty(); }
+		void clear();
+
+		iterator find(const CombinerKey & _key);
+		CombinerProgram *& operator[](const CombinerKey & _key);
+
+	private:
+		struct Slot {
+			u64 mux = 0;
+			u32 index = 0; // index in m_programs + 1, 0 for an empty slot
+		};
+
+		u32 _findSlot(u64 _mux) const;
+		void _rehash(size_t _capacity);
+
+		std::vector<value_type> m_programs;
+		std::vector<Slot> m_slots;
+	};
 }
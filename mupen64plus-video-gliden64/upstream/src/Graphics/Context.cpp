@@ -15,6 +15,11 @@ bool Context::IntegerTextures = false;
 bool Context::ClipControl = false;
 bool Context::FramebufferFetch = false;
 bool Context::TextureBarrier = false;
+bool Context::ETC2Textures = false;
+bool Context::ComputeShaders = false;
+bool Context::GpuTimer = false;
+bool Context::MultisampledRenderToTexture = false;
+bool Context::ImmutableTextures = false;
 
 Context::Context() {}
 
@@ -38,6 +43,11 @@ void Context::init()
 	ClipControl = m_impl->isSupported(SpecialFeatures::ClipControl);
 	FramebufferFetch = m_impl->isSupported(SpecialFeatures::FramebufferFetch);
 	TextureBarrier = m_impl->isSupported(SpecialFeatures::TextureBarrier);
+	ETC2Textures = m_impl->isSupported(SpecialFeatures::ETC2Textures);
+	ComputeShaders = m_impl->isSupported(SpecialFeatures::ComputeShaders);
+	GpuTimer = m_impl->isSupported(SpecialFeatures::GpuTimer);
+	MultisampledRenderToTexture = m_impl->isSupported(SpecialFeatures::MultisampledRenderToTexture);
+	ImmutableTextures = m_impl->isSupported(SpecialFeatures::ImmutableTextures);
 }
 
 void Context::destroy()
@@ -176,6 +186,11 @@ void Context::textureBarrier()
 	m_impl->textureBarrier();
 }
 
+void Context::dispatchCompute(u32 _numGroupsX, u32 _numGroupsY, u32 _numGroupsZ)
+{
+	m_impl->dispatchCompute(_numGroupsX, _numGroupsY, _numGroupsZ);
+}
+
 /*---------------Framebuffer-------------*/
 
 const FramebufferTextureFormats & Context::getFramebufferTextureFormats()
@@ -218,6 +233,11 @@ bool Context::blitFramebuffers(const BlitFramebuffersParams & _params)
 	return m_impl->blitFramebuffers(_params);
 }
 
+void Context::invalidateFramebuffer(ObjectHandle _buffer, BlitMaskParam _mask)
+{
+	m_impl->invalidateFramebuffer(_buffer, _mask);
+}
+
 void Context::setDrawBuffers(u32 _num)
 {
 	m_impl->setDrawBuffers(_num);
@@ -281,19 +301,24 @@ ShaderProgram * Context::createTexrectCopyShader()
 	return m_impl->createTexrectCopyShader();
 }
 
-ShaderProgram * Context::createGammaCorrectionShader()
+ShaderProgram * Context::createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection)
 {
-	return m_impl->createGammaCorrectionShader();
+	return m_impl->createPostProcessShader(_gammaCorrection, _orientationCorrection);
 }
 
-ShaderProgram * Context::createOrientationCorrectionShader()
+TextDrawerShaderProgram * Context::createTextDrawerShader()
 {
-	return m_impl->createOrientationCorrectionShader();
+	return m_impl->createTextDrawerShader();
 }
 
-TextDrawerShaderProgram * Context::createTextDrawerShader()
+RDRAMtoColorBufferShaderProgram * Context::createRDRAMtoColorBufferShader()
 {
-	return m_impl->createTextDrawerShader();
+	return m_impl->createRDRAMtoColorBufferShader();
+}
+
+TextureUpscaleShaderProgram * Context::createTextureUpscaleShader(u32 _scale)
+{
+	return m_impl->createTextureUpscaleShader(_scale);
 }
 
 void Context::resetShaderProgram()
@@ -321,6 +346,23 @@ f32 Context::getMaxLineWidth()
 	return m_impl->getMaxLineWidth();
 }
 
+/*---------------Timer queries-------------*/
+
+void Context::beginGpuTimer()
+{
+	m_impl->beginGpuTimer();
+}
+
+void Context::endGpuTimer()
+{
+	m_impl->endGpuTimer();
+}
+
+f32 Context::getGpuTime() const
+{
+	return m_impl->getGpuTime();
+}
+
 bool Context::isError() const
 {
 	return m_impl->isError();
@@ -25,7 +25,12 @@ namespace graphics {
 		IntegerTextures,
 		ClipControl,
 		FramebufferFetch,
-		TextureBarrier
+		TextureBarrier,
+		ETC2Textures,
+		ComputeShaders,
+		GpuTimer,
+		MultisampledRenderToTexture,
+		ImmutableTextures
 	};
 
 	enum class ClampMode {
@@ -93,6 +98,7 @@ namespace graphics {
 			InternalColorFormatParam internalFormat;
 			DatatypeParam dataType;
 			const void * data = nullptr;
+			u32 dataSize = 0; // size of compressed data, 0 if data is not compressed
 		};
 
 		void init2DTexture(const InitTextureParams & _params);
@@ -154,6 +160,9 @@ namespace graphics {
 
 		void textureBarrier();
 
+		// Runs the active compute shader. Its image stores are visible to texture fetches afterwards.
+		void dispatchCompute(u32 _numGroupsX, u32 _numGroupsY, u32 _numGroupsZ);
+
 		/*---------------Framebuffer-------------*/
 
 		const FramebufferTextureFormats & getFramebufferTextureFormats();
@@ -182,6 +191,8 @@ namespace graphics {
 			BufferAttachmentParam attachment;
 			Parameter textureTarget;
 			ObjectHandle textureHandle;
+			// Render multisampled on chip and resolve into the texture, see MultisampledRenderToTexture
+			bool multisampled = false;
 		};
 
 		void addFrameBufferRenderTarget(const FrameBufferRenderTarget & _params);
@@ -204,6 +215,10 @@ namespace graphics {
 
 		bool blitFramebuffers(const BlitFramebuffersParams & _params);
 
+		// Contents of the attachments in _mask are not needed anymore, so tile based GPUs
+		// can skip loading or storing them. Null _buffer means the window framebuffer.
+		void invalidateFramebuffer(ObjectHandle _buffer, BlitMaskParam _mask);
+
 		void setDrawBuffers(u32 _num);
 
 		/*---------------Pixelbuffer-------------*/
@@ -232,12 +247,14 @@ namespace graphics {
 
 		ShaderProgram * createTexrectCopyShader();
 
-		ShaderProgram * createGammaCorrectionShader();
-
-		ShaderProgram * createOrientationCorrectionShader();
+		ShaderProgram * createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection);
 
 		TextDrawerShaderProgram * createTextDrawerShader();
 
+		RDRAMtoColorBufferShaderProgram * createRDRAMtoColorBufferShader();
+
+		TextureUpscaleShaderProgram * createTextureUpscaleShader(u32 _scale);
+
 		void resetShaderProgram();
 
 		/*---------------Draw-------------*/
@@ -271,6 +288,17 @@ namespace graphics {
 
 		f32 getMaxLineWidth();
 
+		/*---------------Timer queries-------------*/
+
+		// Measure GPU time of commands issued between begin and end. Timers can't be nested.
+		void beginGpuTimer();
+
+		void endGpuTimer();
+
+		// GPU time of the latest finished timer in milliseconds, negative if there is none.
+		// Results are read back a few frames late to avoid waiting for the GPU.
+		f32 getGpuTime() const;
+
 		/*---------------Misc-------------*/
 
 		bool isError() const;
@@ -287,6 +315,11 @@ namespace graphics {
 		static bool ClipControl;
 		static bool FramebufferFetch;
 		static bool TextureBarrier;
+		static bool ETC2Textures;
+		static bool ComputeShaders;
+		static bool GpuTimer;
+		static bool MultisampledRenderToTexture;
+		static bool ImmutableTextures;
 
 	private:
 		std::unique_ptr<ContextImpl> m_impl;
@@ -38,6 +38,7 @@ namespace graphics {
 		virtual void bindImageTexture(const Context::BindImageTextureParameters & _params) = 0;
 		virtual u32 convertInternalTextureFormat(u32 _format) const = 0;
 		virtual void textureBarrier() = 0;
+		virtual void dispatchCompute(u32 _numGroupsX, u32 _numGroupsY, u32 _numGroupsZ) = 0;
 		virtual FramebufferTextureFormats * getFramebufferTextureFormats() = 0;
 		virtual ObjectHandle createFramebuffer() = 0;
 		virtual void deleteFramebuffer(ObjectHandle _name) = 0;
@@ -46,6 +47,7 @@ namespace graphics {
 		virtual ObjectHandle createRenderbuffer() = 0;
 		virtual void initRenderbuffer(const Context::InitRenderbufferParams & _params) = 0;
 		virtual bool blitFramebuffers(const Context::BlitFramebuffersParams & _params) = 0;
+		virtual void invalidateFramebuffer(ObjectHandle _buffer, BlitMaskParam _mask) = 0;
 		virtual void setDrawBuffers(u32 _num) = 0;
 		virtual PixelReadBuffer * createPixelReadBuffer(size_t _sizeInBytes) = 0;
 		virtual ColorBufferReader * createColorBufferReader(CachedTexture * _pTexture) = 0;
@@ -58,14 +60,18 @@ namespace graphics {
 		virtual TexrectDrawerShaderProgram * createTexrectDrawerDrawShader() = 0;
 		virtual ShaderProgram * createTexrectDrawerClearShader() = 0;
 		virtual ShaderProgram * createTexrectCopyShader() = 0;
-		virtual ShaderProgram * createGammaCorrectionShader() = 0;
-		virtual ShaderProgram * createOrientationCorrectionShader() = 0;
+		virtual ShaderProgram * createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection) = 0;
 		virtual TextDrawerShaderProgram * createTextDrawerShader() = 0;
+		virtual RDRAMtoColorBufferShaderProgram * createRDRAMtoColorBufferShader() = 0;
+		virtual TextureUpscaleShaderProgram * createTextureUpscaleShader(u32 _scale) = 0;
 		virtual void resetShaderProgram() = 0;
 		virtual void drawTriangles(const Context::DrawTriangleParameters & _params) = 0;
 		virtual void drawRects(const Context::DrawRectParameters & _params) = 0;
 		virtual void drawLine(f32 _width, SPVertex * _vertices) = 0;
 		virtual f32 getMaxLineWidth() = 0;
+		virtual void beginGpuTimer() = 0;
+		virtual void endGpuTimer() = 0;
+		virtual f32 getGpuTime() const = 0;
 		virtual bool isSupported(SpecialFeatures _feature) const = 0;
 		virtual bool isError() const = 0;
 		virtual bool isFramebufferError() const = 0;
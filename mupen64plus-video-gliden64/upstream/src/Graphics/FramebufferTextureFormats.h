@@ -11,6 +11,12 @@ namespace graphics {
 		DatatypeParam colorType;
 		u32 colorFormatBytes;
 
+		// Color buffers of 16-bit N64 color images, if enabled in config
+		InternalColorFormatParam color16InternalFormat;
+		ColorFormatParam color16Format;
+		DatatypeParam color16Type;
+		u32 color16FormatBytes;
+
 		InternalColorFormatParam monochromeInternalFormat;
 		ColorFormatParam monochromeFormat;
 		DatatypeParam monochromeType;
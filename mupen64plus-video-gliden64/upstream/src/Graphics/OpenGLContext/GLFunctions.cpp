@@ -159,12 +159,19 @@ PFNGLUNMAPBUFFERPROC g_glUnmapBuffer;
 PFNGLDELETEBUFFERSPROC g_glDeleteBuffers;
 PFNGLBINDIMAGETEXTUREPROC g_glBindImageTexture;
 PFNGLMEMORYBARRIERPROC g_glMemoryBarrier;
+PFNGLDISPATCHCOMPUTEPROC g_glDispatchCompute;
 PFNGLGETSTRINGIPROC g_glGetStringi;
 PFNGLINVALIDATEFRAMEBUFFERPROC g_glInvalidateFramebuffer;
 PFNGLBUFFERSTORAGEPROC g_glBufferStorage;
 PFNGLFENCESYNCPROC g_glFenceSync;
 PFNGLCLIENTWAITSYNCPROC g_glClientWaitSync;
 PFNGLDELETESYNCPROC g_glDeleteSync;
+PFNGLGENQUERIESPROC g_glGenQueries;
+PFNGLDELETEQUERIESPROC g_glDeleteQueries;
+PFNGLBEGINQUERYPROC g_glBeginQuery;
+PFNGLENDQUERYPROC g_glEndQuery;
+PFNGLGETQUERYOBJECTUIVPROC g_glGetQueryObjectuiv;
+PFNGLGETQUERYOBJECTUI64VPROC g_glGetQueryObjectui64v;
 
 PFNGLGETUNIFORMBLOCKINDEXPROC g_glGetUniformBlockIndex;
 PFNGLUNIFORMBLOCKBINDINGPROC g_glUniformBlockBinding;
@@ -181,6 +188,9 @@ PFNGLPROGRAMPARAMETERIPROC g_glProgramParameteri;
 PFNGLTEXSTORAGE2DPROC g_glTexStorage2D;
 PFNGLTEXTURESTORAGE2DPROC g_glTextureStorage2D;
 PFNGLTEXTURESUBIMAGE2DPROC g_glTextureSubImage2D;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC g_glCompressedTexImage2D;
+PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC g_glCompressedTexSubImage2D;
+PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC g_glCompressedTextureSubImage2D;
 PFNGLTEXTURESTORAGE2DMULTISAMPLEEXTPROC g_glTextureStorage2DMultisample;
 PFNGLTEXTUREPARAMETERIPROC g_glTextureParameteri;
 PFNGLTEXTUREPARAMETERFPROC g_glTextureParameterf;
@@ -195,6 +205,7 @@ PFNGLTEXTUREBARRIERNVPROC g_glTextureBarrierNV;
 PFNGLCLEARBUFFERFVPROC g_glClearBufferfv;
 PFNGLENABLEIPROC g_glEnablei;
 PFNGLDISABLEIPROC g_glDisablei;
+PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC g_glFramebufferTexture2DMultisampleEXT;
 
 void initGLFunctions()
 {
@@ -303,12 +314,25 @@ void initGLFunctions()
 	GL_GET_PROC_ADR(PFNGLDELETEBUFFERSPROC, glDeleteBuffers);
 	GL_GET_PROC_ADR(PFNGLBINDIMAGETEXTUREPROC, glBindImageTexture);
 	GL_GET_PROC_ADR(PFNGLMEMORYBARRIERPROC, glMemoryBarrier);
+	GL_GET_PROC_ADR(PFNGLDISPATCHCOMPUTEPROC, glDispatchCompute);
 	GL_GET_PROC_ADR(PFNGLGETSTRINGIPROC, glGetStringi);
 	GL_GET_PROC_ADR(PFNGLINVALIDATEFRAMEBUFFERPROC, glInvalidateFramebuffer);
 	GL_GET_PROC_ADR(PFNGLBUFFERSTORAGEPROC, glBufferStorage);
 	GL_GET_PROC_ADR(PFNGLFENCESYNCPROC, glFenceSync);
 	GL_GET_PROC_ADR(PFNGLCLIENTWAITSYNCPROC, glClientWaitSync);
 	GL_GET_PROC_ADR(PFNGLDELETESYNCPROC, glDeleteSync);
+	GL_GET_PROC_ADR(PFNGLGENQUERIESPROC, glGenQueries);
+	GL_GET_PROC_ADR(PFNGLDELETEQUERIESPROC, glDeleteQueries);
+	GL_GET_PROC_ADR(PFNGLBEGINQUERYPROC, glBeginQuery);
+	GL_GET_PROC_ADR(PFNGLENDQUERYPROC, glEndQuery);
+	GL_GET_PROC_ADR(PFNGLGETQUERYOBJECTUIVPROC, glGetQueryObjectuiv);
+	GL_GET_PROC_ADR(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64v);
+	if (g_glGetQueryObjectui64v == nullptr) {
+		// GLES has the GL_EXT_disjoint_timer_query entry point only
+		PFNGLGETQUERYOBJECTUI64VPROC g_glGetQueryObjectui64vEXT;
+		GL_GET_PROC_ADR(PFNGLGETQUERYOBJECTUI64VPROC, glGetQueryObjectui64vEXT);
+		g_glGetQueryObjectui64v = g_glGetQueryObjectui64vEXT;
+	}
 
 	GL_GET_PROC_ADR(PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex);
 	GL_GET_PROC_ADR(PFNGLUNIFORMBLOCKBINDINGPROC, glUniformBlockBinding);
@@ -325,6 +349,9 @@ void initGLFunctions()
 	GL_GET_PROC_ADR(PFNGLTEXSTORAGE2DPROC, glTexStorage2D);
 	GL_GET_PROC_ADR(PFNGLTEXTURESTORAGE2DPROC, glTextureStorage2D);
 	GL_GET_PROC_ADR(PFNGLTEXTURESUBIMAGE2DPROC, glTextureSubImage2D);
+	GL_GET_PROC_ADR(PFNGLCOMPRESSEDTEXIMAGE2DPROC, glCompressedTexImage2D);
+	GL_GET_PROC_ADR(PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC, glCompressedTexSubImage2D);
+	GL_GET_PROC_ADR(PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC, glCompressedTextureSubImage2D);
 	GL_GET_PROC_ADR(PFNGLTEXTURESTORAGE2DMULTISAMPLEEXTPROC, glTextureStorage2DMultisample);
 
 	GL_GET_PROC_ADR(PFNGLTEXTUREPARAMETERIPROC, glTextureParameteri);
@@ -340,4 +367,5 @@ void initGLFunctions()
 	GL_GET_PROC_ADR(PFNGLCLEARBUFFERFVPROC, glClearBufferfv);
 	GL_GET_PROC_ADR(PFNGLENABLEIPROC, glEnablei);
 	GL_GET_PROC_ADR(PFNGLDISABLEIPROC, glDisablei);
+	GL_GET_PROC_ADR(PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC, glFramebufferTexture2DMultisampleEXT);
 }
@@ -34,13 +34,25 @@ typedef double GLdouble;
 #include <stdexcept>
 #include <sstream>
 #include "Log.h"
+#include "ThreadedOpenGl/opengl_Wrapper.h"
 
 #ifdef GL_ERROR_DEBUG
 #define CHECKED_GL_FUNCTION(proc_name, ...) checked([&]() { proc_name(__VA_ARGS__);}, #proc_name)
 #define CHECKED_GL_FUNCTION_WITH_RETURN(proc_name, ReturnType, ...) checkedWithReturn<ReturnType>([&]() { return proc_name(__VA_ARGS__);}, #proc_name)
+#define SYNC_GL_FUNCTION(proc_name, ...) CHECKED_GL_FUNCTION(proc_name, __VA_ARGS__)
+#define OFFSETS_GL_FUNCTION(proc_name, ...) CHECKED_GL_FUNCTION(proc_name, __VA_ARGS__)
+#define ARRAY_GL_FUNCTION(proc_name, size, ...) CHECKED_GL_FUNCTION(proc_name, __VA_ARGS__)
+#define COUNTED_ARRAY_GL_FUNCTION(proc_name, size, ...) CHECKED_GL_FUNCTION(proc_name, __VA_ARGS__)
+#define DATA_GL_FUNCTION(proc_name, ...) CHECKED_GL_FUNCTION(proc_name, __VA_ARGS__)
 #else
-#define CHECKED_GL_FUNCTION(proc_name, ...) proc_name(__VA_ARGS__)
-#define CHECKED_GL_FUNCTION_WITH_RETURN(proc_name, ReturnType, ...) proc_name(__VA_ARGS__)
+#define CHECKED_GL_FUNCTION(proc_name, ...) opengl::wrapFunction(proc_name)(__VA_ARGS__)
+#define CHECKED_GL_FUNCTION_WITH_RETURN(proc_name, ReturnType, ...) opengl::wrapFunction(proc_name)(__VA_ARGS__)
+// Variants for calls whose parameters do not tell how they may be recorded by FunctionWrapper
+#define SYNC_GL_FUNCTION(proc_name, ...) opengl::wrapSyncFunction(proc_name)(__VA_ARGS__)
+#define OFFSETS_GL_FUNCTION(proc_name, ...) opengl::FunctionWrapper::callWithOffsets(proc_name, __VA_ARGS__)
+#define ARRAY_GL_FUNCTION(proc_name, size, ...) opengl::FunctionWrapper::callWithArray<size>(proc_name, __VA_ARGS__)
+#define COUNTED_ARRAY_GL_FUNCTION(proc_name, size, ...) opengl::FunctionWrapper::callWithCountedArray<size>(proc_name, __VA_ARGS__)
+#define DATA_GL_FUNCTION(proc_name, ...) opengl::FunctionWrapper::callWithData(proc_name, __VA_ARGS__)
 #endif
 
 #define IS_GL_FUNCTION_VALID(proc_name) g_##proc_name != nullptr
@@ -48,7 +60,11 @@ typedef double GLdouble;
 
 #if defined(EGL) || defined(OS_IOS)
 
+#ifdef GL_ERROR_DEBUG
 #define glGetError g_glGetError
+#else
+#define glGetError(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glGetError, GLenum, __VA_ARGS__)
+#endif
 #define glBlendFunc(...) CHECKED_GL_FUNCTION(g_glBlendFunc, __VA_ARGS__)
 #define glPixelStorei(...) CHECKED_GL_FUNCTION(g_glPixelStorei, __VA_ARGS__)
 #define glClearColor(...) CHECKED_GL_FUNCTION(g_glClearColor, __VA_ARGS__)
@@ -72,13 +88,13 @@ typedef double GLdouble;
 #define glLineWidth(...) CHECKED_GL_FUNCTION(g_glLineWidth, __VA_ARGS__)
 #define glClear(...) CHECKED_GL_FUNCTION(g_glClear, __VA_ARGS__)
 #define glGetFloatv(...) CHECKED_GL_FUNCTION(g_glGetFloatv, __VA_ARGS__)
-#define glDeleteTextures(...) CHECKED_GL_FUNCTION(g_glDeleteTextures, __VA_ARGS__)
+#define glDeleteTextures(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteTextures, 1, __VA_ARGS__)
 #define glGenTextures(...) CHECKED_GL_FUNCTION(g_glGenTextures, __VA_ARGS__)
 #define glTexParameterf(...) CHECKED_GL_FUNCTION(g_glTexParameterf, __VA_ARGS__)
 #define glActiveTexture(...) CHECKED_GL_FUNCTION(g_glActiveTexture, __VA_ARGS__)
 #define glBlendColor(...) CHECKED_GL_FUNCTION(g_glBlendColor, __VA_ARGS__)
 #define glReadBuffer(...) CHECKED_GL_FUNCTION(g_glReadBuffer, __VA_ARGS__)
-#define glFinish(...) CHECKED_GL_FUNCTION(g_glFinish, __VA_ARGS__)
+#define glFinish(...) SYNC_GL_FUNCTION(g_glFinish, __VA_ARGS__)
 
 extern PFNGLBLENDFUNCPROC g_glBlendFunc;
 extern PFNGLPIXELSTOREIPROC g_glPixelStorei;
@@ -136,8 +152,8 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 #define glUniform4i(...) CHECKED_GL_FUNCTION(g_glUniform4i, __VA_ARGS__)
 
 #define glUniform4f(...) CHECKED_GL_FUNCTION(g_glUniform4f, __VA_ARGS__)
-#define glUniform3fv(...) CHECKED_GL_FUNCTION(g_glUniform3fv, __VA_ARGS__)
-#define glUniform4fv(...) CHECKED_GL_FUNCTION(g_glUniform4fv, __VA_ARGS__)
+#define glUniform3fv(...) COUNTED_ARRAY_GL_FUNCTION(g_glUniform3fv, 3, __VA_ARGS__)
+#define glUniform4fv(...) COUNTED_ARRAY_GL_FUNCTION(g_glUniform4fv, 4, __VA_ARGS__)
 #define glDetachShader(...) CHECKED_GL_FUNCTION(g_glDetachShader, __VA_ARGS__)
 #define glDeleteShader(...) CHECKED_GL_FUNCTION(g_glDeleteShader, __VA_ARGS__)
 #define glDeleteProgram(...) CHECKED_GL_FUNCTION(g_glDeleteProgram, __VA_ARGS__)
@@ -148,11 +164,11 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 
 #define glEnableVertexAttribArray(...) CHECKED_GL_FUNCTION(g_glEnableVertexAttribArray, __VA_ARGS__)
 #define glDisableVertexAttribArray(...) CHECKED_GL_FUNCTION(g_glDisableVertexAttribArray, __VA_ARGS__)
-#define glVertexAttribPointer(...) CHECKED_GL_FUNCTION(g_glVertexAttribPointer, __VA_ARGS__)
+#define glVertexAttribPointer(...) OFFSETS_GL_FUNCTION(g_glVertexAttribPointer, __VA_ARGS__)
 #define glBindAttribLocation(...) CHECKED_GL_FUNCTION(g_glBindAttribLocation, __VA_ARGS__)
 #define glVertexAttrib1f(...) CHECKED_GL_FUNCTION(g_glVertexAttrib1f, __VA_ARGS__)
 #define glVertexAttrib4f(...) CHECKED_GL_FUNCTION(g_glVertexAttrib4f, __VA_ARGS__)
-#define glVertexAttrib4fv(...) CHECKED_GL_FUNCTION(g_glVertexAttrib4fv, __VA_ARGS__)
+#define glVertexAttrib4fv(...) ARRAY_GL_FUNCTION(g_glVertexAttrib4fv, 4, __VA_ARGS__)
 
 #define glDepthRangef(...) CHECKED_GL_FUNCTION(g_glDepthRangef, __VA_ARGS__)
 #define glClearDepthf(...) CHECKED_GL_FUNCTION(g_glClearDepthf, __VA_ARGS__)
@@ -160,35 +176,42 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 #define glBindBuffer(...) CHECKED_GL_FUNCTION(g_glBindBuffer, __VA_ARGS__)
 #define glBindFramebuffer(...) CHECKED_GL_FUNCTION(g_glBindFramebuffer, __VA_ARGS__)
 #define glBindRenderbuffer(...) CHECKED_GL_FUNCTION(g_glBindRenderbuffer, __VA_ARGS__)
-#define glDrawBuffers(...) CHECKED_GL_FUNCTION(g_glDrawBuffers, __VA_ARGS__)
+#define glDrawBuffers(...) COUNTED_ARRAY_GL_FUNCTION(g_glDrawBuffers, 1, __VA_ARGS__)
 #define glGenFramebuffers(...) CHECKED_GL_FUNCTION(g_glGenFramebuffers, __VA_ARGS__)
-#define glDeleteFramebuffers(...) CHECKED_GL_FUNCTION(g_glDeleteFramebuffers, __VA_ARGS__)
+#define glDeleteFramebuffers(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteFramebuffers, 1, __VA_ARGS__)
 #define glFramebufferTexture2D(...) CHECKED_GL_FUNCTION(g_glFramebufferTexture2D, __VA_ARGS__)
 #define glTexImage2DMultisample(...) CHECKED_GL_FUNCTION(g_glTexImage2DMultisample, __VA_ARGS__)
 #define glTexStorage2DMultisample(...) CHECKED_GL_FUNCTION(g_glTexStorage2DMultisample, __VA_ARGS__)
 #define glGenRenderbuffers(...) CHECKED_GL_FUNCTION(g_glGenRenderbuffers, __VA_ARGS__)
 #define glRenderbufferStorage(...) CHECKED_GL_FUNCTION(g_glRenderbufferStorage, __VA_ARGS__)
-#define glDeleteRenderbuffers(...) CHECKED_GL_FUNCTION(g_glDeleteRenderbuffers, __VA_ARGS__)
+#define glDeleteRenderbuffers(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteRenderbuffers, 1, __VA_ARGS__)
 #define glFramebufferRenderbuffer(...) CHECKED_GL_FUNCTION(g_glFramebufferRenderbuffer, __VA_ARGS__)
 #define glCheckFramebufferStatus(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glCheckFramebufferStatus, GLenum, __VA_ARGS__)
 #define glBlitFramebuffer(...) CHECKED_GL_FUNCTION(g_glBlitFramebuffer, __VA_ARGS__)
 #define glGenVertexArrays(...) CHECKED_GL_FUNCTION(g_glGenVertexArrays, __VA_ARGS__)
 #define glBindVertexArray(...) CHECKED_GL_FUNCTION(g_glBindVertexArray, __VA_ARGS__)
-#define glDeleteVertexArrays(...) CHECKED_GL_FUNCTION(g_glDeleteVertexArrays, __VA_ARGS__);
+#define glDeleteVertexArrays(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteVertexArrays, 1, __VA_ARGS__);
 #define glGenBuffers(...) CHECKED_GL_FUNCTION(g_glGenBuffers, __VA_ARGS__)
 #define glBufferData(...) CHECKED_GL_FUNCTION(g_glBufferData, __VA_ARGS__)
 #define glMapBuffer(...) CHECKED_GL_FUNCTION(g_glMapBuffer, __VA_ARGS__)
 #define glMapBufferRange(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glMapBufferRange, void*, __VA_ARGS__)
 #define glUnmapBuffer(...) CHECKED_GL_FUNCTION(g_glUnmapBuffer, __VA_ARGS__)
-#define glDeleteBuffers(...) CHECKED_GL_FUNCTION(g_glDeleteBuffers, __VA_ARGS__)
+#define glDeleteBuffers(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteBuffers, 1, __VA_ARGS__)
 #define glBindImageTexture(...) CHECKED_GL_FUNCTION(g_glBindImageTexture, __VA_ARGS__)
 #define glMemoryBarrier(...) CHECKED_GL_FUNCTION(g_glMemoryBarrier, __VA_ARGS__)
+#define glDispatchCompute(...) CHECKED_GL_FUNCTION(g_glDispatchCompute, __VA_ARGS__)
 #define glGetStringi(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glGetStringi, const GLubyte*, __VA_ARGS__)
-#define glInvalidateFramebuffer(...) CHECKED_GL_FUNCTION(g_glInvalidateFramebuffer, __VA_ARGS__)
+#define glInvalidateFramebuffer(...) COUNTED_ARRAY_GL_FUNCTION(g_glInvalidateFramebuffer, 1, __VA_ARGS__)
 #define glBufferStorage(...) CHECKED_GL_FUNCTION(g_glBufferStorage, __VA_ARGS__)
 #define glFenceSync(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glFenceSync, GLsync, __VA_ARGS__)
-#define glClientWaitSync(...) CHECKED_GL_FUNCTION(g_glClientWaitSync, __VA_ARGS__)
+#define glClientWaitSync(...) CHECKED_GL_FUNCTION_WITH_RETURN(g_glClientWaitSync, GLenum, __VA_ARGS__)
 #define glDeleteSync(...) CHECKED_GL_FUNCTION(g_glDeleteSync, __VA_ARGS__)
+#define glGenQueries(...) CHECKED_GL_FUNCTION(g_glGenQueries, __VA_ARGS__)
+#define glDeleteQueries(...) COUNTED_ARRAY_GL_FUNCTION(g_glDeleteQueries, 1, __VA_ARGS__)
+#define glBeginQuery(...) CHECKED_GL_FUNCTION(g_glBeginQuery, __VA_ARGS__)
+#define glEndQuery(...) CHECKED_GL_FUNCTION(g_glEndQuery, __VA_ARGS__)
+#define glGetQueryObjectuiv(...) CHECKED_GL_FUNCTION(g_glGetQueryObjectuiv, __VA_ARGS__)
+#define glGetQueryObjectui64v(...) CHECKED_GL_FUNCTION(g_glGetQueryObjectui64v, __VA_ARGS__)
 
 #define glGetUniformBlockIndex(...) CHECKED_GL_FUNCTION(g_glGetUniformBlockIndex, __VA_ARGS__)
 #define glUniformBlockBinding(...) CHECKED_GL_FUNCTION(g_glUniformBlockBinding, __VA_ARGS__)
@@ -196,7 +219,7 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 #define glGetUniformIndices(...) CHECKED_GL_FUNCTION(g_glGetUniformIndices, __VA_ARGS__)
 #define glGetActiveUniformsiv(...) CHECKED_GL_FUNCTION(g_glGetActiveUniformsiv, __VA_ARGS__)
 #define glBindBufferBase(...) CHECKED_GL_FUNCTION(g_glBindBufferBase, __VA_ARGS__)
-#define glBufferSubData(...) CHECKED_GL_FUNCTION(g_glBufferSubData, __VA_ARGS__)
+#define glBufferSubData(...) DATA_GL_FUNCTION(g_glBufferSubData, __VA_ARGS__)
 
 #define glGetProgramBinary(...) CHECKED_GL_FUNCTION(g_glGetProgramBinary, __VA_ARGS__)
 #define glProgramBinary(...) CHECKED_GL_FUNCTION(g_glProgramBinary, __VA_ARGS__)
@@ -205,6 +228,9 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 #define glTexStorage2D(...) CHECKED_GL_FUNCTION(g_glTexStorage2D, __VA_ARGS__)
 #define glTextureStorage2D(...) CHECKED_GL_FUNCTION(g_glTextureStorage2D, __VA_ARGS__)
 #define glTextureSubImage2D(...) CHECKED_GL_FUNCTION(g_glTextureSubImage2D, __VA_ARGS__)
+#define glCompressedTexImage2D(...) CHECKED_GL_FUNCTION(g_glCompressedTexImage2D, __VA_ARGS__)
+#define glCompressedTexSubImage2D(...) CHECKED_GL_FUNCTION(g_glCompressedTexSubImage2D, __VA_ARGS__)
+#define glCompressedTextureSubImage2D(...) CHECKED_GL_FUNCTION(g_glCompressedTextureSubImage2D, __VA_ARGS__)
 #define glTextureStorage2DMultisample(...) CHECKED_GL_FUNCTION(g_glTextureStorage2DMultisample, __VA_ARGS__)
 #define glTextureParameteri(...) CHECKED_GL_FUNCTION(g_glTextureParameteri, __VA_ARGS__)
 #define glTextureParameterf(...) CHECKED_GL_FUNCTION(g_glTextureParameterf, __VA_ARGS__)
@@ -212,13 +238,19 @@ extern PFNGLBLENDCOLORPROC g_glBlendColor;
 #define glCreateBuffers(...) CHECKED_GL_FUNCTION(g_glCreateBuffers, __VA_ARGS__)
 #define glCreateFramebuffers(...) CHECKED_GL_FUNCTION(g_glCreateFramebuffers, __VA_ARGS__)
 #define glNamedFramebufferTexture(...) CHECKED_GL_FUNCTION(g_glNamedFramebufferTexture, __VA_ARGS__)
-#define glDrawRangeElementsBaseVertex(...) CHECKED_GL_FUNCTION(g_glDrawRangeElementsBaseVertex, __VA_ARGS__)
+#define glDrawRangeElementsBaseVertex(...) OFFSETS_GL_FUNCTION(g_glDrawRangeElementsBaseVertex, __VA_ARGS__)
 #define glFlushMappedBufferRange(...) CHECKED_GL_FUNCTION(g_glFlushMappedBufferRange, __VA_ARGS__)
 #define glTextureBarrier(...) CHECKED_GL_FUNCTION(g_glTextureBarrier, __VA_ARGS__)
 #define glTextureBarrierNV(...) CHECKED_GL_FUNCTION(g_glTextureBarrierNV, __VA_ARGS__)
-#define glClearBufferfv(...) CHECKED_GL_FUNCTION(g_glClearBufferfv, __VA_ARGS__)
+#define glClearBufferfv(...) ARRAY_GL_FUNCTION(g_glClearBufferfv, 4, __VA_ARGS__)
 #define glEnablei(...) CHECKED_GL_FUNCTION(g_glEnablei, __VA_ARGS__)
 #define glDisablei(...) CHECKED_GL_FUNCTION(g_glDisablei, __VA_ARGS__)
+#define glFramebufferTexture2DMultisampleEXT(...) CHECKED_GL_FUNCTION(g_glFramebufferTexture2DMultisampleEXT, __VA_ARGS__)
+
+#ifndef GL_EXT_multisampled_render_to_texture
+// GLES only extension, missing from the desktop GL headers
+typedef void (APIENTRYP PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC) (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level, GLsizei samples);
+#endif
 
 extern PFNGLCREATESHADERPROC g_glCreateShader;
 extern PFNGLCOMPILESHADERPROC g_glCompileShader;
@@ -282,12 +314,19 @@ extern PFNGLUNMAPBUFFERPROC g_glUnmapBuffer;
 extern PFNGLDELETEBUFFERSPROC g_glDeleteBuffers;
 extern PFNGLBINDIMAGETEXTUREPROC g_glBindImageTexture;
 extern PFNGLMEMORYBARRIERPROC g_glMemoryBarrier;
+extern PFNGLDISPATCHCOMPUTEPROC g_glDispatchCompute;
 extern PFNGLGETSTRINGIPROC g_glGetStringi;
 extern PFNGLINVALIDATEFRAMEBUFFERPROC g_glInvalidateFramebuffer;
 extern PFNGLBUFFERSTORAGEPROC g_glBufferStorage;
 extern PFNGLFENCESYNCPROC g_glFenceSync;
 extern PFNGLCLIENTWAITSYNCPROC g_glClientWaitSync;
 extern PFNGLDELETESYNCPROC g_glDeleteSync;
+extern PFNGLGENQUERIESPROC g_glGenQueries;
+extern PFNGLDELETEQUERIESPROC g_glDeleteQueries;
+extern PFNGLBEGINQUERYPROC g_glBeginQuery;
+extern PFNGLENDQUERYPROC g_glEndQuery;
+extern PFNGLGETQUERYOBJECTUIVPROC g_glGetQueryObjectuiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC g_glGetQueryObjectui64v;
 
 extern PFNGLGETUNIFORMBLOCKINDEXPROC g_glGetUniformBlockIndex;
 extern PFNGLUNIFORMBLOCKBINDINGPROC g_glUniformBlockBinding;
@@ -304,6 +343,9 @@ extern PFNGLPROGRAMPARAMETERIPROC g_glProgramParameteri;
 extern PFNGLTEXSTORAGE2DPROC g_glTexStorage2D;
 extern PFNGLTEXTURESTORAGE2DPROC g_glTextureStorage2D;
 extern PFNGLTEXTURESUBIMAGE2DPROC g_glTextureSubImage2D;
+extern PFNGLCOMPRESSEDTEXIMAGE2DPROC g_glCompressedTexImage2D;
+extern PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC g_glCompressedTexSubImage2D;
+extern PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC g_glCompressedTextureSubImage2D;
 extern PFNGLTEXTURESTORAGE2DMULTISAMPLEEXTPROC g_glTextureStorage2DMultisample;
 extern PFNGLTEXTUREPARAMETERIPROC g_glTextureParameteri;
 extern PFNGLTEXTUREPARAMETERFPROC g_glTextureParameterf;
@@ -318,6 +360,7 @@ extern PFNGLTEXTUREBARRIERNVPROC g_glTextureBarrierNV;
 extern PFNGLCLEARBUFFERFVPROC g_glClearBufferfv;
 extern PFNGLENABLEIPROC g_glEnablei;
 extern PFNGLDISABLEIPROC g_glDisablei;
+extern PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC g_glFramebufferTexture2DMultisampleEXT;
 
 void initGLFunctions();
 
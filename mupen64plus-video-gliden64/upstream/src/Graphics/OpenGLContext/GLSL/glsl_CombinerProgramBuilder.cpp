@@ -40,6 +40,35 @@ private:
 u32 g_cycleType = G_CYC_1CYCLE;
 TextureConvert g_textureConvert;
 
+// RDP and RSP state shared by all combiner programs, used instead of separate uniforms
+// unless GLES2 is used. Vertex and fragment shaders declare it the same way.
+// Layout must match RDPStateBuffer::State in glsl_CombinerProgramUniformFactory.cpp.
+static
+const char * strRDPStateBlock =
+	"layout (std140) uniform RDPState {	\n"
+	"  lowp vec4 uFogColor;				\n"
+	"  lowp vec4 uCenterColor;			\n"
+	"  lowp vec4 uScaleColor;			\n"
+	"  lowp vec4 uBlendColor;			\n"
+	"  lowp vec4 uEnvColor;				\n"
+	"  lowp vec4 uPrimColor;			\n"
+	"  mediump vec2 uFogScale;			\n"
+	"  mediump vec2 uTexScale;			\n"
+	"  lowp float uPrimLod;				\n"
+	"  lowp float uK4;					\n"
+	"  lowp float uK5;					\n"
+	"  lowp float uAlphaTestValue;		\n"
+	"  mediump float uMinLod;			\n"
+	"  lowp int uFogUsage;				\n"
+	"  lowp int uEnableAlphaTest;		\n"
+	"  lowp int uCvgXAlpha;				\n"
+	"  lowp int uAlphaCvgSel;			\n"
+	"  lowp int uMaxTile;				\n"
+	"  lowp int uEnableLod;				\n"
+	"  lowp int uTextureDetail;			\n"
+	"};									\n"
+	;
+
 /*---------------_compileCombiner-------------*/
 
 static
@@ -257,12 +286,18 @@ public:
 			"IN highp vec4 aModify;								\n"
 			"													\n"
 			"uniform int uTexturePersp;							\n"
-			"													\n"
-			"uniform lowp int uFogUsage;						\n"
-			"uniform mediump vec2 uFogScale;					\n"
 			"uniform mediump vec2 uScreenCoordsScale;			\n"
+			;
+		if (_glinfo.isGLES2) {
+			m_part +=
+				"uniform lowp int uFogUsage;						\n"
+				"uniform mediump vec2 uFogScale;					\n"
+				"uniform mediump vec2 uTexScale;					\n"
+				;
+		} else
+			m_part += strRDPStateBlock;
+		m_part +=
 			"													\n"
-			"uniform mediump vec2 uTexScale;					\n"
 			"uniform mediump vec2 uTexOffset[2];				\n"
 			"uniform mediump vec2 uCacheScale[2];				\n"
 			"uniform mediump vec2 uCacheOffset[2];				\n"
@@ -330,9 +365,16 @@ public:
 			"IN lowp float aNumLights;			\n"
 			"IN highp vec4 aModify;				\n"
 			"									\n"
-			"uniform lowp int uFogUsage;		\n"
-			"uniform mediump vec2 uFogScale;	\n"
 			"uniform mediump vec2 uScreenCoordsScale;\n"
+			;
+		if (_glinfo.isGLES2) {
+			m_part +=
+				"uniform lowp int uFogUsage;		\n"
+				"uniform mediump vec2 uFogScale;	\n"
+				;
+		} else
+			m_part += strRDPStateBlock;
+		m_part +=
 			"									\n"
 			"OUT lowp vec4 vShadeColor;			\n"
 			"OUT lowp float vNumLights;			\n"
@@ -730,31 +772,38 @@ public:
 		m_part =
 			"uniform sampler2D uTex0;		\n"
 			"uniform sampler2D uTex1;		\n"
-			"uniform lowp vec4 uFogColor;	\n"
-			"uniform lowp vec4 uCenterColor;\n"
-			"uniform lowp vec4 uScaleColor;	\n"
-			"uniform lowp vec4 uBlendColor;	\n"
-			"uniform lowp vec4 uEnvColor;	\n"
-			"uniform lowp vec4 uPrimColor;	\n"
-			"uniform lowp float uPrimLod;	\n"
-			"uniform lowp float uK4;		\n"
-			"uniform lowp float uK5;		\n"
 			"uniform lowp int uAlphaCompareMode;	\n"
 			"uniform lowp ivec2 uFbMonochrome;		\n"
 			"uniform lowp ivec2 uFbFixedAlpha;		\n"
-			"uniform lowp int uEnableAlphaTest;		\n"
-			"uniform lowp int uCvgXAlpha;			\n"
-			"uniform lowp int uAlphaCvgSel;			\n"
-			"uniform lowp float uAlphaTestValue;	\n"
 			"uniform lowp int uDepthSource;			\n"
 			"uniform highp float uPrimDepth;		\n"
 			"uniform mediump vec2 uScreenScale;		\n"
 			;
 
-		if (config.generalEmulation.enableLegacyBlending != 0) {
+		if (_glinfo.isGLES2) {
 			m_part +=
-				"uniform lowp int uFogUsage;		\n"
-			;
+				"uniform lowp vec4 uFogColor;	\n"
+				"uniform lowp vec4 uCenterColor;\n"
+				"uniform lowp vec4 uScaleColor;	\n"
+				"uniform lowp vec4 uBlendColor;	\n"
+				"uniform lowp vec4 uEnvColor;	\n"
+				"uniform lowp vec4 uPrimColor;	\n"
+				"uniform lowp float uPrimLod;	\n"
+				"uniform lowp float uK4;		\n"
+				"uniform lowp float uK5;		\n"
+				"uniform lowp int uEnableAlphaTest;		\n"
+				"uniform lowp int uCvgXAlpha;			\n"
+				"uniform lowp int uAlphaCvgSel;			\n"
+				"uniform lowp float uAlphaTestValue;	\n"
+				;
+		} else
+			m_part += strRDPStateBlock;
+
+		if (config.generalEmulation.enableLegacyBlending != 0) {
+			if (_glinfo.isGLES2)
+				m_part +=
+					"uniform lowp int uFogUsage;		\n"
+					;
 		} else {
 			m_part +=
 				"uniform lowp ivec4 uBlendMux1;		\n"
@@ -800,8 +849,8 @@ public:
 		if (config.frameBufferEmulation.N64DepthCompare != 0 && _glinfo.ext_fetch) {
 			m_part +=
 				"layout(location = 0) OUT lowp vec4 fragColor;	\n"
-				"layout(location = 1) inout highp vec4 depthZ;	\n"
-				"layout(location = 2) inout highp vec4 depthDeltaZ;	\n"
+				"layout(location = 1) inout highp uvec4 depthZ;	\n"
+				"layout(location = 2) inout highp uvec4 depthDeltaZ;	\n"
 				;
 		} else {
 			m_part +=
@@ -817,31 +866,38 @@ public:
 	ShaderFragmentGlobalVariablesNotex(const opengl::GLInfo & _glinfo)
 	{
 		m_part =
-			"uniform lowp vec4 uFogColor;	\n"
-			"uniform lowp vec4 uCenterColor;\n"
-			"uniform lowp vec4 uScaleColor;	\n"
-			"uniform lowp vec4 uBlendColor;	\n"
-			"uniform lowp vec4 uEnvColor;	\n"
-			"uniform lowp vec4 uPrimColor;	\n"
-			"uniform lowp float uPrimLod;	\n"
-			"uniform lowp float uK4;		\n"
-			"uniform lowp float uK5;		\n"
 			"uniform lowp int uAlphaCompareMode;	\n"
 			"uniform lowp ivec2 uFbMonochrome;		\n"
 			"uniform lowp ivec2 uFbFixedAlpha;		\n"
-			"uniform lowp int uEnableAlphaTest;		\n"
-			"uniform lowp int uCvgXAlpha;			\n"
-			"uniform lowp int uAlphaCvgSel;			\n"
-			"uniform lowp float uAlphaTestValue;	\n"
 			"uniform lowp int uDepthSource;			\n"
 			"uniform highp float uPrimDepth;		\n"
 			"uniform mediump vec2 uScreenScale;		\n"
 			;
 
-		if (config.generalEmulation.enableLegacyBlending != 0) {
+		if (_glinfo.isGLES2) {
 			m_part +=
-				"uniform lowp int uFogUsage;		\n"
+				"uniform lowp vec4 uFogColor;	\n"
+				"uniform lowp vec4 uCenterColor;\n"
+				"uniform lowp vec4 uScaleColor;	\n"
+				"uniform lowp vec4 uBlendColor;	\n"
+				"uniform lowp vec4 uEnvColor;	\n"
+				"uniform lowp vec4 uPrimColor;	\n"
+				"uniform lowp float uPrimLod;	\n"
+				"uniform lowp float uK4;		\n"
+				"uniform lowp float uK5;		\n"
+				"uniform lowp int uEnableAlphaTest;		\n"
+				"uniform lowp int uCvgXAlpha;			\n"
+				"uniform lowp int uAlphaCvgSel;			\n"
+				"uniform lowp float uAlphaTestValue;	\n"
 				;
+		} else
+			m_part += strRDPStateBlock;
+
+		if (config.generalEmulation.enableLegacyBlending != 0) {
+			if (_glinfo.isGLES2)
+				m_part +=
+					"uniform lowp int uFogUsage;		\n"
+					;
 		} else {
 			m_part +=
 				"uniform lowp ivec4 uBlendMux1;		\n"
@@ -876,8 +932,8 @@ public:
 		if (config.frameBufferEmulation.N64DepthCompare != 0 && _glinfo.ext_fetch) {
 			m_part +=
 				"layout(location = 0) OUT lowp vec4 fragColor;	\n"
-				"layout(location = 1) inout highp vec4 depthZ;	\n"
-				"layout(location = 2) inout highp vec4 depthDeltaZ;	\n"
+				"layout(location = 1) inout highp uvec4 depthZ;	\n"
+				"layout(location = 2) inout highp uvec4 depthDeltaZ;	\n"
 				;
 		} else {
 			m_part +=
@@ -963,6 +1019,25 @@ private:
 	const opengl::GLInfo& m_glinfo;
 };
 
+class ShaderFragmentHeaderReadTexTMEM : public ShaderPart
+{
+public:
+	ShaderFragmentHeaderReadTexTMEM(const opengl::GLInfo & _glinfo)
+	{
+		if (!_glinfo.isGLES2 && config.texture.enableGPUTMEM != 0) {
+			m_part =
+				"uniform highp usampler2D uTMEM;		\n"
+				"uniform lowp ivec2 uTMEMFormat;		\n"
+				"uniform highp ivec4 uTMEMTile[2];		\n"
+				"uniform highp ivec4 uTMEMWrapS[2];		\n"
+				"uniform highp ivec4 uTMEMWrapT[2];		\n"
+				"uniform highp ivec2 uTMEMSize[2];		\n"
+				"lowp vec4 readTexTMEM(in lowp int format, in highp ivec4 tile, in highp ivec4 wrapS, in highp ivec4 wrapT, in highp ivec2 size, in highp vec2 texCoord, in lowp int filterMode);\n"
+				;
+		}
+	}
+};
+
 class ShaderFragmentHeaderDither : public ShaderPart
 {
 public:
@@ -1242,19 +1317,28 @@ public:
 				"  lowp vec4 readtex0 = readTex(uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0]);		\n"
 				;
 		} else {
+			std::string readTex;
 			if (config.video.multisampling > 0) {
-				m_part =
-					"  lowp vec4 readtex0;																	\n"
+				readTex =
 					"  if (uMSTexEnabled[0] == 0) {															\n"
 					"      READ_TEX(readtex0, uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0])		\n"
 					"  } else readtex0 = readTexMS(uMSTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0]);\n"
 					;
 			} else {
-				m_part =
-					"  lowp vec4 readtex0;																	\n"
+				readTex =
 					"  READ_TEX(readtex0, uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0])			\n"
 					;
 			}
+			m_part = "  lowp vec4 readtex0;																	\n";
+			if (config.texture.enableGPUTMEM != 0) {
+				m_part +=
+					"  if (uTMEMFormat[0] != 0) readtex0 = readTexTMEM(uTMEMFormat[0], uTMEMTile[0], uTMEMWrapS[0], uTMEMWrapT[0], uTMEMSize[0], vTexCoord0, 0);	\n"
+					"  else {																				\n"
+					+ readTex +
+					"  }																					\n"
+					;
+			} else
+				m_part += readTex;
 		}
 	}
 };
@@ -1286,16 +1370,25 @@ public:
 				shaderPart = "  lowp vec4 readtex0;																			\n"
 							 "  YUVCONVERT_TEX0(readtex0, uTex0, vTexCoord0, uTextureFormat[0])								\n";
 			} else {
+				std::string readTex;
 				if (config.video.multisampling > 0) {
-					shaderPart =
-						"  lowp vec4 readtex0;																				\n"
+					readTex =
 						"  if (uMSTexEnabled[0] == 0) {																		\n"
 						"    READ_TEX(readtex0, uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0])						\n"
 						"  } else readtex0 = readTexMS(uMSTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0]);			\n";
 				} else {
-					shaderPart = "  lowp vec4 readtex0;																		\n"
-								 "  READ_TEX(readtex0, uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0])				\n";
+					readTex = "  READ_TEX(readtex0, uTex0, vTexCoord0, uFbMonochrome[0], uFbFixedAlpha[0])				\n";
 				}
+				shaderPart = "  lowp vec4 readtex0;																			\n";
+				if (config.texture.enableGPUTMEM != 0) {
+					shaderPart +=
+						"  if (uTMEMFormat[0] != 0)																			\n"
+						"    readtex0 = readTexTMEM(uTMEMFormat[0], uTMEMTile[0], uTMEMWrapS[0], uTMEMWrapT[0], uTMEMSize[0], vTexCoord0, uTextureFilterMode);	\n"
+						"  else {																							\n"
+						+ readTex +
+						"  }																								\n";
+				} else
+					shaderPart += readTex;
 			}
 
 		}
@@ -1335,16 +1428,25 @@ public:
 					"  lowp vec4 readtex1;																							\n"
 					"    YUVCONVERT_TEX1(readtex1, uTex1, vTexCoord1, uTextureFormat[1], readtex0)					\n";
 			} else {
+				std::string readTex;
 				if (config.video.multisampling > 0) {
-					shaderPart =
-						"  lowp vec4 readtex1;																						\n"
+					readTex =
 						"  if (uMSTexEnabled[1] == 0) {																				\n"
 						"    READ_TEX(readtex1, uTex1, vTexCoord1, uFbMonochrome[1], uFbFixedAlpha[1])								\n"
 						"  } else readtex1 = readTexMS(uMSTex1, vTexCoord1, uFbMonochrome[1], uFbFixedAlpha[1]);					\n";
 				} else {
-					shaderPart = "  lowp vec4 readtex1;																				\n"
-								 "  READ_TEX(readtex1, uTex1, vTexCoord1, uFbMonochrome[1], uFbFixedAlpha[1])						\n";
+					readTex = "  READ_TEX(readtex1, uTex1, vTexCoord1, uFbMonochrome[1], uFbFixedAlpha[1])						\n";
 				}
+				shaderPart = "  lowp vec4 readtex1;																					\n";
+				if (config.texture.enableGPUTMEM != 0) {
+					shaderPart +=
+						"  if (uTMEMFormat[1] != 0)																					\n"
+						"    readtex1 = readTexTMEM(uTMEMFormat[1], uTMEMTile[1], uTMEMWrapS[1], uTMEMWrapT[1], uTMEMSize[1], vTexCoord1, uTextureFilterMode);	\n"
+						"  else {																									\n"
+						+ readTex +
+						"  }																										\n";
+				} else
+					shaderPart += readTex;
 			}
 
 		}
@@ -1442,6 +1544,20 @@ public:
 				"  return 0.5;			\n"
 				"}						\n"
 				;
+		} else if (!_glinfo.isGLES2 && config.generalEmulation.enableShaderNoise != 0) {
+			// Hash N64 pixel coordinates with the frame seed, no noise texture needed
+			m_part =
+				"uniform mediump int uNoiseSeed;						\n"
+				"lowp float snoise()									\n"
+				"{														\n"
+				"  highp uvec2 coord = uvec2(gl_FragCoord.xy/uScreenScale);	\n"
+				"  highp uint h = coord.x * 0x8da6b343u ^ coord.y * 0xd8163841u ^ uint(uNoiseSeed) * 0xcb1ab31fu;	\n"
+				"  h ^= h >> 16u; h *= 0x7feb352du;						\n"
+				"  h ^= h >> 15u; h *= 0x846ca68bu;						\n"
+				"  h ^= h >> 16u;										\n"
+				"  return float(h & 255u) / 255.0;						\n"
+				"}														\n"
+				;
 		} else {
 			if (_glinfo.isGLES2) {
 				m_part =
@@ -1512,8 +1628,17 @@ public:
 				;
 			} else {
 				if ((config.generalEmulation.hacks & hack_RE2) != 0) {
+					// N64 depth encoding of DepthBufferList zLUT
 					m_part =
-						"uniform lowp usampler2D uZlutImage;\n"
+						"highp uint encodeN64Depth(highp int iZ)											\n"
+						"{																					\n"
+						"  highp uint z = uint(iZ);															\n"
+						"  mediump int exponent = 0;														\n"
+						"  while (exponent < 7 && ((z >> uint(17 - exponent)) & 1u) != 0u)				\n"
+						"    ++exponent;																	\n"
+						"  highp uint mantissa = (z >> uint(6 - min(exponent, 6))) & 0x7FFu;				\n"
+						"  return ((uint(exponent) << 11u) | mantissa) << 2u;								\n"
+						"}																					\n"
 						"highp float writeDepth()						        													\n"
 						"{																									\n"
 						;
@@ -1529,9 +1654,7 @@ public:
 					}
 					m_part +=
 						"  highp int iZ = FragDepth > 0.999 ? 262143 : int(floor(FragDepth * 262143.0));				\n"
-						"  mediump int y0 = clamp(iZ/512, 0, 511);															\n"
-						"  mediump int x0 = iZ - 512*y0;																	\n"
-						"  highp uint iN64z = texelFetch(uZlutImage,ivec2(x0,y0), 0).r;											\n"
+						"  highp uint iN64z = encodeN64Depth(iZ);															\n"
 						"  return clamp(float(iN64z)/65532.0, 0.0, 1.0);											\n"
 						"}																									\n"
 						;
@@ -1646,9 +1769,6 @@ public:
 			if (config.generalEmulation.enableLOD == 0) {
 				// Fake mipmap
 				m_part =
-					"uniform lowp int uMaxTile;			\n"
-					"uniform mediump float uMinLod;		\n"
-					"														\n"
 					"mediump float mipmap(out lowp vec4 readtex0, out lowp vec4 readtex1) {	\n"
 					"  readtex0 = texture(uTex0, vTexCoord0);				\n"
 					"  readtex1 = texture(uTex1, vTexCoord1);				\n"
@@ -1658,11 +1778,6 @@ public:
 				;
 			} else {
 				m_part =
-					"uniform lowp int uEnableLod;		\n"
-					"uniform mediump float uMinLod;		\n"
-					"uniform lowp int uMaxTile;			\n"
-					"uniform lowp int uTextureDetail;	\n"
-					"														\n"
 					"mediump float mipmap(out lowp vec4 readtex0, out lowp vec4 readtex1) {	\n"
 					"  readtex0 = texture(uTex0, vTexCoord0);				\n"
 					"  readtex1 = textureLod(uTex1, vTexCoord1, 0.0);		\n"
@@ -1941,6 +2056,134 @@ public:
 	}
 };
 
+class ShaderReadtexTMEM : public ShaderPart
+{
+public:
+	ShaderReadtexTMEM(const opengl::GLInfo & _glinfo)
+	{
+		if (_glinfo.isGLES2 || config.texture.enableGPUTMEM == 0)
+			return;
+
+		// Texels are decoded as TextureCache::_getTextureDestData decodes them with
+		// the texel functions in Textures.cpp. uTMEM holds TMEM as 32-bit words,
+		// TMEM halfwords and bytes are read in host, i.e. little endian, order.
+		// tile: tmem, line, palette, tmem mask; wrapS, wrapT: clamp, mask, mirror, wrap mode.
+		m_part =
+			"highp int tmemHalf(in highp int addr)												\n"
+			"{																					\n"
+			"  highp uint word = texelFetch(uTMEM, ivec2((addr >> 1) & 1023, 0), 0).r;			\n"
+			"  return int((word >> uint((addr & 1) << 4)) & 0xFFFFu);							\n"
+			"}																					\n"
+			"highp int tmemByte(in highp int addr)												\n"
+			"{																					\n"
+			"  highp uint word = texelFetch(uTMEM, ivec2((addr >> 2) & 1023, 0), 0).r;			\n"
+			"  return int((word >> uint((addr & 3) << 3)) & 0xFFu);								\n"
+			"}																					\n"
+			"lowp vec4 tmemRGBA5551(in highp int c)												\n"
+			"{																					\n"
+			"  highp int color = ((c & 0xFF) << 8) | (c >> 8);									\n"
+			"  return vec4(float(color >> 11), float((color >> 6) & 31), float((color >> 1) & 31), float(color & 1) * 31.0) / 31.0;	\n"
+			"}																					\n"
+			"lowp vec4 tmemIA88(in highp int c)													\n"
+			"{																					\n"
+			"  return vec4(vec3(float(c & 0xFF)), float(c >> 8)) / 255.0;						\n"
+			"}																					\n"
+			"lowp vec4 tmemPalette(in highp int format, in highp int index)						\n"
+			"{																					\n"
+			"  highp int color = tmemHalf(1024 + (index << 2));									\n"
+			"  if (format == 10 || format == 12) return tmemIA88(color);						\n"
+			"  return tmemRGBA5551(color);														\n"
+			"}																					\n"
+			// Texture wrap mode over the size of the decoded texture, then N64 clamp, mask and mirror.
+			"highp int tmemWrap(in highp int c, in highp int size, in highp ivec4 wrap)			\n"
+			"{																					\n"
+			"  if (wrap.w == 0) {																\n"
+			"    c = clamp(c, 0, size - 1);														\n"
+			"  } else {																			\n"
+			"    highp int period = wrap.w == 1 ? size << 1 : size;								\n"
+			"    c -= period * int(floor(float(c) / float(period)));							\n"
+			"    if (c < 0) c += period;														\n"
+			"    else if (c >= period) c -= period;												\n"
+			"    if (c >= size) c = period - 1 - c;												\n"
+			"  }																				\n"
+			"  highp int t = min(c, wrap.x) & wrap.y;											\n"
+			"  if ((c & wrap.z) != 0) t ^= wrap.y;												\n"
+			"  return t;																		\n"
+			"}																					\n"
+			"lowp vec4 tmemTexel(in lowp int format, in highp ivec4 tile, in highp ivec4 wrapS, in highp ivec4 wrapT, in highp ivec2 size, in highp vec2 texel)	\n"
+			"{																					\n"
+			"  highp ivec2 coord = ivec2(floor(texel));											\n"
+			"  highp int x = tmemWrap(coord.x, size.x, wrapS);									\n"
+			"  highp int y = tmemWrap(coord.y, size.y, wrapT);									\n"
+			"  if (format == 8) {																\n"
+			"    highp int addr = (((tile.x << 2) + tile.y * y + x) ^ ((y & 1) != 0 ? 3 : 1)) & 0x3FF;	\n"
+			"    highp int gr = tmemHalf(addr);													\n"
+			"    highp int ab = tmemHalf(addr | 0x400);											\n"
+			"    return vec4(float(gr >> 8), float(gr & 0xFF), float(ab >> 8), float(ab & 0xFF)) / 255.0;	\n"
+			"  }																				\n"
+			"  highp int row = ((tile.x + tile.y * y) & tile.w) << 3;							\n"
+			"  highp int i = (y & 1) << 1;														\n"
+			"  if (format == 1) return vec4(0.0);												\n"
+			"  if (format == 2 || format == 3 || format == 9 || format == 10) {					\n"
+			"    highp int b = tmemByte(row + ((x >> 1) ^ (i << 1)));							\n"
+			"    highp int c = (x & 1) != 0 ? b & 0x0F : b >> 4;								\n"
+			"    if (format == 2) return vec4(float(c) / 15.0);									\n"
+			"    if (format == 3) return vec4(vec3(float(((c >> 1) * 15 + 3) / 7) / 15.0), float(c & 1));	\n"
+			"    return tmemPalette(format, (tile.z << 4) + c);									\n"
+			"  }																				\n"
+			"  if (format == 4 || format == 5 || format == 11 || format == 12) {				\n"
+			"    highp int b = tmemByte(row + (x ^ (i << 1)));									\n"
+			"    if (format == 4) return vec4(float(b) / 255.0);								\n"
+			"    if (format == 5) return vec4(vec3(float(b >> 4)), float(b & 0x0F)) / 15.0;		\n"
+			"    return tmemPalette(format, b);													\n"
+			"  }																				\n"
+			"  highp int c = tmemHalf((row >> 1) + (x ^ i));									\n"
+			"  if (format == 6) return tmemRGBA5551(c);											\n"
+			"  if (format == 7) return tmemIA88(c);												\n"
+			"  if (format == 13) return tmemPalette(format, c & 0xFF);							\n"
+			// CI16 IA palette entries hold intensity in the high byte.
+			"  highp int color = tmemHalf(1024 + ((c >> 8) << 2));								\n"
+			"  return vec4(vec3(float(color >> 8)), float(color & 0xFF)) / 255.0;				\n"
+			"}																					\n"
+			;
+
+		// Same filters as TEX_FILTER, with texels fetched from TMEM.
+		if (config.texture.bilinearMode == BILINEAR_3POINT) {
+			m_part +=
+				"lowp vec4 readTexTMEM(in lowp int format, in highp ivec4 tile, in highp ivec4 wrapS, in highp ivec4 wrapT, in highp ivec2 size, in highp vec2 texCoord, in lowp int filterMode)	\n"
+				"{																					\n"
+				"  highp vec2 texel = texCoord * vec2(size);										\n"
+				"  if (filterMode == 0) return tmemTexel(format, tile, wrapS, wrapT, size, texel);	\n"
+				"  mediump vec2 offset = fract(texel - vec2(0.5));									\n"
+				"  offset -= step(1.0, offset.x + offset.y);										\n"
+				"  lowp vec4 c0 = tmemTexel(format, tile, wrapS, wrapT, size, texel - offset);		\n"
+				"  lowp vec4 c1 = tmemTexel(format, tile, wrapS, wrapT, size, texel - vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 c2 = tmemTexel(format, tile, wrapS, wrapT, size, texel - vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  return c0 + abs(offset.x)*(c1-c0) + abs(offset.y)*(c2-c0);						\n"
+				"}																					\n"
+				;
+		} else {
+			m_part +=
+				"lowp vec4 readTexTMEM(in lowp int format, in highp ivec4 tile, in highp ivec4 wrapS, in highp ivec4 wrapT, in highp ivec2 size, in highp vec2 texCoord, in lowp int filterMode)	\n"
+				"{																					\n"
+				"  highp vec2 texel = texCoord * vec2(size);										\n"
+				"  if (filterMode == 0) return tmemTexel(format, tile, wrapS, wrapT, size, texel);	\n"
+				"  mediump vec2 offset = fract(texel - vec2(0.5));									\n"
+				"  offset -= step(1.0, offset.x + offset.y);										\n"
+				"  lowp vec4 p0q0 = tmemTexel(format, tile, wrapS, wrapT, size, texel - offset);	\n"
+				"  lowp vec4 p1q0 = tmemTexel(format, tile, wrapS, wrapT, size, texel - vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 p0q1 = tmemTexel(format, tile, wrapS, wrapT, size, texel - vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  lowp vec4 p1q1 = tmemTexel(format, tile, wrapS, wrapT, size, texel - vec2(offset.x - sign(offset.x), offset.y - sign(offset.y)));	\n"
+				"  mediump vec2 interpolationFactor = abs(offset);									\n"
+				"  lowp vec4 pInterp_q0 = mix(p0q0, p1q0, interpolationFactor.x);					\n"
+				"  lowp vec4 pInterp_q1 = mix(p0q1, p1q1, interpolationFactor.x);					\n"
+				"  return mix(pInterp_q0, pInterp_q1, interpolationFactor.y);						\n"
+				"}																					\n"
+				;
+		}
+	}
+};
+
 class ShaderN64DepthCompare : public ShaderPart
 {
 public:
@@ -1959,16 +2202,22 @@ public:
 					"  ivec2 coord = ivec2(gl_FragCoord.xy);				\n"
 					"  highp vec4 depthZ = imageLoad(uDepthImageZ,coord);	\n"
 					"  highp vec4 depthDeltaZ = imageLoad(uDepthImageDeltaZ,coord);\n"
+					"  highp float bufZ = depthZ.r;							\n"
+					"  highp float bufDeltaZ = depthDeltaZ.r;				\n"
+					;
+			} else if (_glinfo.ext_fetch) {
+				m_part +=
+					"  highp float bufZ = uintBitsToFloat(depthZ.r);		\n"
+					"  highp float bufDeltaZ = uintBitsToFloat(depthDeltaZ.r);\n"
 					;
 			}
 			m_part +=
-				"  highp float bufZ = depthZ.r;							\n"
 				"  highp float dz, dzMin;								\n"
 				"  if (uDepthSource == 1) {								\n"
 				"     dzMin = dz = uDeltaZ;								\n"
 				"  } else {												\n"
 				"    dz = 4.0*fwidth(curZ);						\n"
-				"    dzMin = min(dz, depthDeltaZ.r);					\n"
+				"    dzMin = min(dz, bufDeltaZ);						\n"
 				"  }													\n"
 				"  bool bInfront = curZ < bufZ;							\n"
 				"  bool bFarther = (curZ + dzMin) >= bufZ;				\n"
@@ -2001,8 +2250,8 @@ public:
 					;
 			} else if (_glinfo.ext_fetch) {
 				m_part +=
-					"    depthZ.r = curZ;	\n"
-					"    depthDeltaZ.r = dz;	\n"
+					"    depthZ.r = floatBitsToUint(curZ);	\n"
+					"    depthDeltaZ.r = floatBitsToUint(dz);	\n"
 					;
 			}
 			m_part +=
@@ -2030,11 +2279,14 @@ public:
 				;
 			if (_glinfo.imageTextures) {
 				m_part +=
-					"    highp vec4 depthZ = imageLoad(uDepthImageZ,coord);	\n"
+					"    highp float bufZ = imageLoad(uDepthImageZ,coord).r;	\n"
+					;
+			} else if (_glinfo.ext_fetch) {
+				m_part +=
+					"    highp float bufZ = uintBitsToFloat(depthZ.r);		\n"
 					;
 			}
 			m_part +=
-				"    highp float bufZ = depthZ.r;						\n"
 				"    if (curZ >= bufZ) return false;					\n"
 				"  }													\n"
 				;
@@ -2047,8 +2299,8 @@ public:
 					;
 			} else if (_glinfo.ext_fetch) {
 				m_part +=
-					"  depthZ.r = Z;	\n"
-					"  depthDeltaZ.r = 0.0;	\n"
+					"  depthZ.r = floatBitsToUint(Z);	\n"
+					"  depthDeltaZ.r = 0u;	\n"
 					;
 			}
 			m_part +=
@@ -2224,6 +2476,8 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 		m_fragmentHeaderWriteDepth->write(ssShader);
 		m_fragmentHeaderDepthCompare->write(ssShader);
 		m_fragmentHeaderReadMSTex->write(ssShader);
+		if (!bUseLod)
+			m_fragmentHeaderReadTexTMEM->write(ssShader);
 		if (bUseLod)
 			m_fragmentHeaderMipMap->write(ssShader);
 		else if (g_cycleType < G_CYC_COPY)
@@ -2300,6 +2554,7 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 				m_shaderReadtex->write(ssShader);
 			else
 				m_shaderReadtexCopyMode->write(ssShader);
+			m_shaderReadtexTMEM->write(ssShader);
 		}
 	}
 
@@ -2340,6 +2595,10 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 	assert(Utils::checkProgramLinkStatus(program));
 	glDeleteShader(fragmentShader);
 
+	// Do not query the program until the driver reports that linking is complete.
+	if (m_asyncCompile)
+		return new CombinerProgramImpl(_key, program, m_useProgram, combinerInputs, m_uniformFactory);
+
 	UniformGroups uniforms;
 	m_uniformFactory->buildUniforms(program, combinerInputs, _key, uniforms);
 
@@ -2404,6 +2663,7 @@ CombinerProgramBuilder::CombinerProgramBuilder(const opengl::GLInfo & _glinfo, o
 , m_fragmentHeaderCalcLight(new ShaderFragmentHeaderCalcLight(_glinfo))
 , m_fragmentHeaderMipMap(new ShaderFragmentHeaderMipMap(_glinfo))
 , m_fragmentHeaderReadMSTex(new ShaderFragmentHeaderReadMSTex(_glinfo))
+, m_fragmentHeaderReadTexTMEM(new ShaderFragmentHeaderReadTexTMEM(_glinfo))
 , m_fragmentHeaderDither(new ShaderFragmentHeaderDither(_glinfo))
 , m_fragmentHeaderDepthCompare(new ShaderFragmentHeaderDepthCompare(_glinfo))
 , m_fragmentHeaderReadTex(new ShaderFragmentHeaderReadTex(_glinfo))
@@ -2425,10 +2685,12 @@ CombinerProgramBuilder::CombinerProgramBuilder(const opengl::GLInfo & _glinfo, o
 , m_shaderCalcLight(new ShaderCalcLight(_glinfo))
 , m_shaderReadtex(new ShaderReadtex(_glinfo))
 , m_shaderReadtexCopyMode(new ShaderReadtexCopyMode(_glinfo))
+, m_shaderReadtexTMEM(new ShaderReadtexTMEM(_glinfo))
 , m_shaderN64DepthCompare(new ShaderN64DepthCompare(_glinfo))
 , m_shaderN64DepthRender(new ShaderN64DepthRender(_glinfo))
 , m_useProgram(_useProgram)
 , m_combinerOptionsBits(graphics::CombinerProgram::getShaderCombinerOptionsBits())
+, m_asyncCompile(_glinfo.parallelShaderCompile && config.generalEmulation.enableAsyncShaderCompile != 0)
 {
 	m_vertexShaderRect = _createVertexShader(m_vertexHeader.get(), m_vertexRect.get(), m_vertexEnd.get());
 	m_vertexShaderTriangle = _createVertexShader(m_vertexHeader.get(), m_vertexTriangle.get(), m_vertexEnd.get());
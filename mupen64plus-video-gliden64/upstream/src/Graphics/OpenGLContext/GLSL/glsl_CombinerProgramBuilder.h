@@ -63,6 +63,7 @@ namespace glsl {
 		ShaderPartPtr m_fragmentHeaderCalcLight;
 		ShaderPartPtr m_fragmentHeaderMipMap;
 		ShaderPartPtr m_fragmentHeaderReadMSTex;
+		ShaderPartPtr m_fragmentHeaderReadTexTMEM;
 		ShaderPartPtr m_fragmentHeaderDither;
 		ShaderPartPtr m_fragmentHeaderDepthCompare;
 		ShaderPartPtr m_fragmentHeaderReadTex;
@@ -85,10 +86,11 @@ namespace glsl {
 		ShaderPartPtr m_shaderCalcLight;
 		ShaderPartPtr m_shaderReadtex;
 		ShaderPartPtr m_shaderReadtexCopyMode;
+		ShaderPartPtr m_shaderReadtexTMEM;
 		ShaderPartPtr m_shaderN64DepthCompare;
 		ShaderPartPtr m_shaderN64DepthRender;
 
-		std::unique_ptr<CombinerProgramUniformFactory> m_uniformFactory;
+		std::shared_ptr<CombinerProgramUniformFactory> m_uniformFactory;
 
 		GLuint  m_vertexShaderRect;
 		GLuint  m_vertexShaderTriangle;
@@ -96,6 +98,7 @@ namespace glsl {
 		GLuint  m_vertexShaderTexturedTriangle;
 		opengl::CachedUseProgram * m_useProgram;
 		u32 m_combinerOptionsBits;
+		bool m_asyncCompile;
 	};
 
 }
@@ -6,9 +6,94 @@
 #include <Graphics/OpenGLContext/opengl_Utils.h>
 #include "glsl_Utils.h"
 #include "glsl_CombinerProgramImpl.h"
+#include "glsl_CombinerProgramUniformFactory.h"
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR          0x91B1
+#endif
 
 using namespace glsl;
 
+/*---------------UniformGroups-------------*/
+
+UniformGroups::~UniformGroups()
+{
+	for (auto it = m_groups.rbegin(); it != m_groups.rend(); ++it)
+		(*it)->~UniformGroup();
+}
+
+void * UniformGroups::_allocate(size_t _size, size_t _align)
+{
+	const size_t defaultBlockSize = 2048;
+	size_t offset = (m_blockUsed + _align - 1) & ~(_align - 1);
+	if (m_blocks.empty() || offset + _size > m_blockSize) {
+		m_blockSize = std::max(defaultBlockSize, _size);
+		m_blocks.emplace_back(new char[m_blockSize]);
+		offset = 0;
+	}
+	m_blockUsed = offset + _size;
+	return m_blocks.back().get() + offset;
+}
+
+/*---------------CombinerProgramImpl-------------*/
+
+namespace {
+	class ProgramPool
+	{
+	public:
+		void * allocate(size_t _size)
+		{
+			assert(_size <= sizeof(Slot));
+			if (m_free == nullptr) {
+				m_chunks.emplace_back(new Slot[SlotsPerChunk]);
+				Slot * chunk = m_chunks.back().get();
+				for (size_t i = 0; i < SlotsPerChunk; ++i) {
+					chunk[i].next = m_free;
+					m_free = &chunk[i];
+				}
+			}
+			Slot * slot = m_free;
+			m_free = slot->next;
+			return slot;
+		}
+
+		void deallocate(void * _p)
+		{
+			Slot * slot = static_cast<Slot*>(_p);
+			slot->next = m_free;
+			m_free = slot;
+		}
+
+		static ProgramPool & get()
+		{
+			// Chunks are never released, so programs may be deleted during static destruction.
+			static ProgramPool * pool = new ProgramPool;
+			return *pool;
+		}
+
+	private:
+		union Slot {
+			Slot * next;
+			alignas(CombinerProgramImpl) char data[sizeof(CombinerProgramImpl)];
+		};
+		static const size_t SlotsPerChunk = 64;
+
+		std::vector< std::unique_ptr<Slot[]> > m_chunks;
+		Slot * m_free = nullptr;
+	};
+}
+
+void * CombinerProgramImpl::operator new(size_t _size)
+{
+	return ProgramPool::get().allocate(_size);
+}
+
+void CombinerProgramImpl::operator delete(void * _p)
+{
+	if (_p != nullptr)
+		ProgramPool::get().deallocate(_p);
+}
+
 CombinerProgramImpl::CombinerProgramImpl(const CombinerKey & _key,
 	GLuint _program,
 	opengl::CachedUseProgram * _useProgram,
@@ -20,6 +105,42 @@ CombinerProgramImpl::CombinerProgramImpl(const CombinerKey & _key,
 , m_useProgram(_useProgram)
 , m_inputs(_inputs)
 , m_uniforms(std::move(_uniforms))
+, m_binaryFormat(0)
+, m_usageCount(0)
+{
+}
+
+CombinerProgramImpl::CombinerProgramImpl(const CombinerKey & _key,
+	GLuint _program,
+	opengl::CachedUseProgram * _useProgram,
+	const CombinerInputs & _inputs,
+	const std::shared_ptr<CombinerProgramUniformFactory> & _uniformFactory)
+: m_bNeedUpdate(true)
+, m_key(_key)
+, m_program(_program)
+, m_useProgram(_useProgram)
+, m_inputs(_inputs)
+, m_uniformFactory(_uniformFactory)
+, m_binaryFormat(0)
+, m_usageCount(0)
+{
+}
+
+CombinerProgramImpl::CombinerProgramImpl(const CombinerKey & _key,
+	opengl::CachedUseProgram * _useProgram,
+	const CombinerInputs & _inputs,
+	const std::shared_ptr<CombinerProgramUniformFactory> & _uniformFactory,
+	GLenum _binaryFormat,
+	std::vector<char> && _binary,
+	u32 _usageCount)
+: m_bNeedUpdate(true)
+, m_key(_key)
+, m_useProgram(_useProgram)
+, m_inputs(_inputs)
+, m_uniformFactory(_uniformFactory)
+, m_binaryFormat(_binaryFormat)
+, m_binary(std::move(_binary))
+, m_usageCount(_usageCount)
 {
 }
 
@@ -30,13 +151,51 @@ CombinerProgramImpl::~CombinerProgramImpl()
 	glDeleteProgram(GLuint(m_program));
 }
 
+void CombinerProgramImpl::_finish()
+{
+	if (!m_binary.empty()) {
+		GLuint program = glCreateProgram();
+		Utils::locateAttributes(program, m_key.isRectKey(), m_inputs.usesTexture());
+		glProgramBinary(program, m_binaryFormat, m_binary.data(), static_cast<GLsizei>(m_binary.size()));
+		assert(Utils::checkProgramLinkStatus(program));
+		m_program = graphics::ObjectHandle(program);
+		std::vector<char>().swap(m_binary);
+	}
+
+	// Locating uniforms waits for linking to complete.
+	m_uniformFactory->buildUniforms(GLuint(m_program), m_inputs, m_key, m_uniforms);
+	m_uniformFactory.reset();
+}
+
+bool CombinerProgramImpl::isReady()
+{
+	if (!m_uniformFactory)
+		return true;
+
+	if (m_binary.empty()) {
+		GLint status = GL_FALSE;
+		glGetProgramiv(GLuint(m_program), GL_COMPLETION_STATUS_KHR, &status);
+		if (status == GL_FALSE)
+			return false;
+	}
+
+	_finish();
+	return true;
+}
+
 void CombinerProgramImpl::activate()
 {
+	if (m_uniformFactory)
+		_finish();
 	m_useProgram->useProgram(m_program);
 }
 
 void CombinerProgramImpl::update(bool _force)
 {
+	if (m_uniformFactory)
+		_finish();
+	if (m_usageCount != 0xFFFFFFFF)
+		++m_usageCount;
 	_force |= m_bNeedUpdate;
 	m_bNeedUpdate = false;
 	m_useProgram->useProgram(m_program);
@@ -44,6 +203,11 @@ void CombinerProgramImpl::update(bool _force)
 		(*it)->update(_force);
 }
 
+u32 CombinerProgramImpl::getUsageCount() const
+{
+	return m_usageCount;
+}
+
 const CombinerKey & CombinerProgramImpl::getKey() const
 {
 	return m_key;
@@ -77,22 +241,32 @@ bool CombinerProgramImpl::usesHwLighting() const
 bool CombinerProgramImpl::getBinaryForm(std::vector<char> & _buffer)
 {
 	GLint  binaryLength;
-	glGetProgramiv(GLuint(m_program), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	GLenum binaryFormat;
+	std::vector<char> binary;
 
-	if (binaryLength < 1)
-		return false;
+	if (!m_binary.empty()) {
+		// Not used since loaded from storage. Keep its original binary.
+		binaryLength = static_cast<GLint>(m_binary.size());
+		binaryFormat = m_binaryFormat;
+		binary = m_binary;
+	} else {
+		glGetProgramiv(GLuint(m_program), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
 
-	std::vector<char> binary(binaryLength);
+		if (binaryLength < 1)
+			return false;
 
-	GLenum binaryFormat;
-	glGetProgramBinary(GLuint(m_program), binaryLength, &binaryLength, &binaryFormat, binary.data());
-	if (opengl::Utils::isGLError())
-		return false;
+		binary.resize(binaryLength);
+
+		glGetProgramBinary(GLuint(m_program), binaryLength, &binaryLength, &binaryFormat, binary.data());
+		if (opengl::Utils::isGLError())
+			return false;
+	}
 
 	u64 key = m_key.getMux();
 	int inputs(m_inputs);
+	u32 usageCount = m_usageCount;
 
-	int totalSize = sizeof(key)+sizeof(inputs)+sizeof(binaryFormat)+
+	int totalSize = sizeof(key)+sizeof(inputs)+sizeof(usageCount)+sizeof(binaryFormat)+
 		sizeof(binaryLength)+binaryLength;
 	_buffer.resize(totalSize);
 
@@ -104,6 +278,10 @@ bool CombinerProgramImpl::getBinaryForm(std::vector<char> & _buffer)
 	std::copy_n(inputData, sizeof(inputs), _buffer.data() + offset);
 	offset += sizeof(inputs);
 
+	char* usageCountData = reinterpret_cast<char*>(&usageCount);
+	std::copy_n(usageCountData, sizeof(usageCount), _buffer.data() + offset);
+	offset += sizeof(usageCount);
+
 	char* binaryFormatData = reinterpret_cast<char*>(&binaryFormat);
 	std::copy_n(binaryFormatData, sizeof(binaryFormat), _buffer.data() + offset);
 	offset += sizeof(binaryFormat);
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <new>
 #include <vector>
 #include <Graphics/CombinerProgram.h>
 #include <Graphics/ObjectHandle.h>
@@ -17,7 +18,38 @@ namespace glsl {
 		virtual void update(bool _force) = 0;
 	};
 
-	typedef std::vector< std::unique_ptr<UniformGroup> > UniformGroups;
+	// Uniform groups of a program. Groups are updated on every draw call, so they are
+	// placed one after another in a few memory blocks instead of separate heap allocations.
+	class UniformGroups
+	{
+	public:
+		typedef std::vector<UniformGroup*>::const_iterator const_iterator;
+
+		UniformGroups() : m_blockUsed(0), m_blockSize(0) {}
+		UniformGroups(UniformGroups && _other) = default;
+		UniformGroups & operator=(UniformGroups &&) = delete;
+		~UniformGroups();
+
+		template <class T, typename... Args>
+		void add(Args... _args)
+		{
+			void * place = _allocate(sizeof(T), alignof(T));
+			m_groups.push_back(new (place) T(_args...));
+		}
+
+		const_iterator begin() const { return m_groups.begin(); }
+		const_iterator end() const { return m_groups.end(); }
+
+	private:
+		void * _allocate(size_t _size, size_t _align);
+
+		std::vector<UniformGroup*> m_groups;
+		std::vector< std::unique_ptr<char[]> > m_blocks;
+		size_t m_blockUsed;
+		size_t m_blockSize;
+	};
+
+	class CombinerProgramUniformFactory;
 
 	class CombinerProgramImpl : public graphics::CombinerProgram
 	{
@@ -27,8 +59,27 @@ namespace glsl {
 			opengl::CachedUseProgram * _useProgram,
 			const CombinerInputs & _inputs,
 			UniformGroups && _uniforms);
+		// Program which is still being linked. Uniforms are located once linking completes.
+		CombinerProgramImpl(const CombinerKey & _key,
+			GLuint _program,
+			opengl::CachedUseProgram * _useProgram,
+			const CombinerInputs & _inputs,
+			const std::shared_ptr<CombinerProgramUniformFactory> & _uniformFactory);
+		// Program loaded from shaders storage. It is created from its binary when first needed.
+		CombinerProgramImpl(const CombinerKey & _key,
+			opengl::CachedUseProgram * _useProgram,
+			const CombinerInputs & _inputs,
+			const std::shared_ptr<CombinerProgramUniformFactory> & _uniformFactory,
+			GLenum _binaryFormat,
+			std::vector<char> && _binary,
+			u32 _usageCount);
 		~CombinerProgramImpl();
 
+		// Programs are allocated from a pool to keep them close in memory.
+		// They are created and deleted by the plugin thread only.
+		static void * operator new(size_t _size);
+		static void operator delete(void * _p);
+
 		void activate() override;
 		void update(bool _force) override;
 		const CombinerKey & getKey() const override;
@@ -41,13 +92,24 @@ namespace glsl {
 
 		bool getBinaryForm(std::vector<char> & _buffer) override;
 
+		bool isReady() override;
+
+		u32 getUsageCount() const override;
+
 	private:
+		void _finish();
+
+
 		bool m_bNeedUpdate;
 		CombinerKey m_key;
 		graphics::ObjectHandle m_program;
 		opengl::CachedUseProgram * m_useProgram;
 		CombinerInputs m_inputs;
 		UniformGroups m_uniforms;
+		std::shared_ptr<CombinerProgramUniformFactory> m_uniformFactory;
+		GLenum m_binaryFormat;
+		std::vector<char> m_binary;
+		u32 m_usageCount;
 	};
 
 }
@@ -104,11 +104,190 @@ struct i4Uniform {
 };
 
 
+/*---------------RDPStateBuffer-------------*/
+
+// std140 uniform buffer with the RDPState block of all combiner programs.
+// The buffer stays bound, state is uploaded when it changes, not per program.
+class RDPStateBuffer
+{
+public:
+	RDPStateBuffer()
+	{
+		memset(&m_state, 0, sizeof(m_state));
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(State), &m_state, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_buffer);
+	}
+
+	~RDPStateBuffer()
+	{
+		glDeleteBuffers(1, &m_buffer);
+	}
+
+	void update()
+	{
+		State state = m_state;
+		_setColor(state.fogColor, &gDP.fogColor.r);
+		_setColor(state.centerColor, &gDP.key.center.r);
+		_setColor(state.scaleColor, &gDP.key.scale.r);
+		_setColor(state.blendColor, &gDP.blendColor.r);
+		_setColor(state.envColor, &gDP.envColor.r);
+		_setColor(state.primColor, &gDP.primColor.r);
+		state.primLod = gDP.primColor.l;
+		state.k4 = gDP.convert.k4*0.0039215689f;
+		state.k5 = gDP.convert.k5*0.0039215689f;
+		state.texScale[0] = gSP.texture.scales;
+		state.texScale[1] = gSP.texture.scalet;
+		_updateFog(state);
+		_updateAlphaTest(state);
+		state.minLod = gDP.primColor.m;
+		state.maxTile = gSP.texture.level;
+		state.enableLod = (gDP.otherMode.textureLOD == G_TL_LOD) ? 1 : 0;
+		state.textureDetail = gDP.otherMode.textureDetail;
+		_upload(state);
+	}
+
+	static const GLuint bindingPoint = 0;
+
+private:
+	struct State
+	{
+		f32 fogColor[4];
+		f32 centerColor[4];
+		f32 scaleColor[4];
+		f32 blendColor[4];
+		f32 envColor[4];
+		f32 primColor[4];
+		f32 fogScale[2];
+		f32 texScale[2];
+		f32 primLod;
+		f32 k4;
+		f32 k5;
+		f32 alphaTestValue;
+		f32 minLod;
+		s32 fogUsage;
+		s32 enableAlphaTest;
+		s32 cvgXAlpha;
+		s32 alphaCvgSel;
+		s32 maxTile;
+		s32 enableLod;
+		s32 textureDetail;
+	};
+	static_assert(sizeof(State) == 160, "RDPState block layout mismatch");
+
+	static void _setColor(f32 * _dst, const f32 * _src)
+	{
+		memcpy(_dst, _src, sizeof(f32) * 4);
+	}
+
+	static void _updateFog(State & _state)
+	{
+		if (RSP.LLE) {
+			_state.fogUsage = 0;
+			return;
+		}
+
+		int nFogUsage = ((gSP.geometryMode & G_FOG) != 0) ? 1 : 0;
+		if (GBI.getMicrocodeType() == F3DAM) {
+			const s16 fogMode = ((gSP.geometryMode >> 13) & 9) + 0xFFF8;
+			if (fogMode == 0)
+				nFogUsage = 1;
+			else if (fogMode > 0)
+				nFogUsage = 2;
+		}
+		_state.fogUsage = nFogUsage;
+		_state.fogScale[0] = gSP.fog.multiplierf;
+		_state.fogScale[1] = gSP.fog.offsetf;
+	}
+
+	static void _updateAlphaTest(State & _state)
+	{
+		if (gDP.otherMode.cycleType == G_CYC_FILL) {
+			_state.enableAlphaTest = 0;
+		}
+		else if (gDP.otherMode.cycleType == G_CYC_COPY) {
+			if (gDP.otherMode.alphaCompare & G_AC_THRESHOLD) {
+				_state.enableAlphaTest = 1;
+				_state.alphaCvgSel = 0;
+				_state.alphaTestValue = 0.5f;
+			}
+			else {
+				_state.enableAlphaTest = 0;
+			}
+		}
+		else if ((gDP.otherMode.alphaCompare & G_AC_THRESHOLD) != 0) {
+			_state.enableAlphaTest = 1;
+			_state.alphaTestValue = gDP.blendColor.a;
+			_state.alphaCvgSel = gDP.otherMode.alphaCvgSel;
+		}
+		else {
+			_state.enableAlphaTest = 0;
+		}
+
+		_state.cvgXAlpha = gDP.otherMode.cvgXAlpha;
+	}
+
+	// Changed rows are uploaded in runs of up to 64 bytes,
+	// which the threaded GL wrapper records without waiting.
+	void _upload(const State & _state)
+	{
+		const size_t rowSize = 16;
+		const size_t maxRows = 4;
+		const size_t numRows = sizeof(State) / rowSize;
+		const char * pNew = reinterpret_cast<const char*>(&_state);
+		const char * pOld = reinterpret_cast<const char*>(&m_state);
+		bool bound = false;
+		size_t row = 0;
+		while (row < numRows) {
+			if (memcmp(pNew + row * rowSize, pOld + row * rowSize, rowSize) == 0) {
+				++row;
+				continue;
+			}
+			size_t end = row + 1;
+			while (end < numRows && end - row < maxRows &&
+				memcmp(pNew + end * rowSize, pOld + end * rowSize, rowSize) != 0)
+				++end;
+			if (!bound) {
+				glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+				bound = true;
+			}
+			glBufferSubData(GL_UNIFORM_BUFFER, row * rowSize, (end - row) * rowSize, pNew + row * rowSize);
+			row = end;
+		}
+		if (bound)
+			m_state = _state;
+	}
+
+	GLuint m_buffer;
+	State m_state;
+};
+
 /*---------------UniformGroup-------------*/
 
 #define LocateUniform(A) \
 	A.loc = glGetUniformLocation(_program, #A);
 
+class URDPState : public UniformGroup
+{
+public:
+	URDPState(GLuint _program, RDPStateBuffer * _buffer)
+	: m_buffer(_buffer)
+	{
+		const GLuint blockIndex = glGetUniformBlockIndex(_program, "RDPState");
+		if (blockIndex != GL_INVALID_INDEX)
+			glUniformBlockBinding(_program, blockIndex, RDPStateBuffer::bindingPoint);
+	}
+
+	void update(bool _force) override
+	{
+		m_buffer->update();
+	}
+
+private:
+	RDPStateBuffer * m_buffer;
+};
+
 class UNoiseTex : public UniformGroup
 {
 public:
@@ -125,36 +304,37 @@ private:
 	iUniform uTexNoise;
 };
 
-class UDepthTex : public UniformGroup
+class UNoiseSeed : public UniformGroup
 {
 public:
-	UDepthTex(GLuint _program) {
-		LocateUniform(uDepthTex);
+	UNoiseSeed(GLuint _program) {
+		LocateUniform(uNoiseSeed);
 	}
 
 	void update(bool _force) override
 	{
-		uDepthTex.set(int(graphics::textureIndices::DepthTex), _force);
+		g_noiseTexture.update();
+		uNoiseSeed.set(int(g_noiseTexture.getSeed() & 0x7FFF), _force);
 	}
 
 private:
-	iUniform uDepthTex;
+	iUniform uNoiseSeed;
 };
 
-class UZLutTexture : public UniformGroup
+class UDepthTex : public UniformGroup
 {
 public:
-	UZLutTexture(GLuint _program) {
-		LocateUniform(uZlutImage);
+	UDepthTex(GLuint _program) {
+		LocateUniform(uDepthTex);
 	}
 
 	void update(bool _force) override
 	{
-		uZlutImage.set(int(graphics::textureIndices::ZLUTTex), _force);
+		uDepthTex.set(int(graphics::textureIndices::DepthTex), _force);
 	}
 
 private:
-	iUniform uZlutImage;
+	iUniform uDepthTex;
 };
 
 class UTextures : public UniformGroup
@@ -198,6 +378,59 @@ private:
 	iUniform uMSAASamples;
 };
 
+class UTMEMTextures : public UniformGroup
+{
+public:
+	UTMEMTextures(GLuint _program, bool _useT0, bool _useT1)
+	{
+		m_useTile[0] = _useT0;
+		m_useTile[1] = _useT1;
+		LocateUniform(uTMEM);
+		LocateUniform(uTMEMFormat);
+		LocateUniform(uTMEMTile[0]);
+		LocateUniform(uTMEMTile[1]);
+		LocateUniform(uTMEMWrapS[0]);
+		LocateUniform(uTMEMWrapS[1]);
+		LocateUniform(uTMEMWrapT[0]);
+		LocateUniform(uTMEMWrapT[1]);
+		LocateUniform(uTMEMSize[0]);
+		LocateUniform(uTMEMSize[1]);
+	}
+
+	void update(bool _force) override
+	{
+		uTMEM.set(int(graphics::textureIndices::TMEMTex), _force);
+		int format[2] = { CachedTexture::tmemNone, CachedTexture::tmemNone };
+		TextureCache & cache = textureCache();
+		for (u32 t = 0; t < 2; ++t) {
+			const CachedTexture * pTexture = cache.current[t];
+			if (!m_useTile[t] || pTexture == nullptr || pTexture->tmemFormat == CachedTexture::tmemNone)
+				continue;
+
+			format[t] = pTexture->tmemFormat;
+			const u32 line = pTexture->size == G_IM_SIZ_32b ?
+				getRGBA32Line(pTexture->clampWidth, pTexture->line) : pTexture->line;
+			const u32 tmemMask = gDP.otherMode.textureLUT == G_TT_NONE ? 0x1FF : 0xFF;
+			uTMEMTile[t].set(pTexture->tMem, line, pTexture->palette, tmemMask, _force);
+			const TexelWrap wrapS(pTexture->maskS, pTexture->clampS, pTexture->mirrorS, pTexture->width, pTexture->clampWidth);
+			const TexelWrap wrapT(pTexture->maskT, pTexture->clampT, pTexture->mirrorT, pTexture->height, pTexture->clampHeight);
+			uTMEMWrapS[t].set(wrapS.clamp, wrapS.mask, wrapS.mirror, pTexture->tmemWrapS, _force);
+			uTMEMWrapT[t].set(wrapT.clamp, wrapT.mask, wrapT.mirror, pTexture->tmemWrapT, _force);
+			uTMEMSize[t].set(pTexture->realWidth, pTexture->realHeight, _force);
+		}
+		uTMEMFormat.set(format[0], format[1], _force);
+	}
+
+private:
+	bool m_useTile[2];
+	iUniform uTMEM;
+	iv2Uniform uTMEMFormat;
+	i4Uniform uTMEMTile[2];
+	i4Uniform uTMEMWrapS[2];
+	i4Uniform uTMEMWrapT[2];
+	iv2Uniform uTMEMSize[2];
+};
+
 class UFrameBufferInfo : public UniformGroup
 {
 public:
@@ -926,88 +1159,105 @@ void CombinerProgramUniformFactory::buildUniforms(GLuint _program,
 												  const CombinerKey & _key,
 												  UniformGroups & _uniforms)
 {
-	if (config.generalEmulation.enableNoise != 0)
-		_uniforms.emplace_back(new UNoiseTex(_program));
+	if (config.generalEmulation.enableNoise != 0) {
+		if (config.generalEmulation.enableShaderNoise != 0 && !m_glInfo.isGLES2)
+			_uniforms.add<UNoiseSeed>(_program);
+		else
+			_uniforms.add<UNoiseTex>(_program);
+	}
 
 	if (!m_glInfo.isGLES2) {
-		_uniforms.emplace_back(new UDepthTex(_program));
-		_uniforms.emplace_back(new UDepthScale(_program));
+		_uniforms.add<UDepthTex>(_program);
+		_uniforms.add<UDepthScale>(_program);
 	}
 
 	if (_inputs.usesTexture()) {
-		_uniforms.emplace_back(new UTextures(_program));
+		_uniforms.add<UTextures>(_program);
 
 		if (config.video.multisampling != 0)
-			_uniforms.emplace_back(new UMSAATextures(_program));
+			_uniforms.add<UMSAATextures>(_program);
+
+		_uniforms.add<UFrameBufferInfo>(_program);
 
-		_uniforms.emplace_back(new UFrameBufferInfo(_program));
+		if (config.texture.enableGPUTMEM != 0 && !m_glInfo.isGLES2 && !_inputs.usesLOD())
+			_uniforms.add<UTMEMTextures>(_program, _inputs.usesTile(0), _inputs.usesTile(1));
 
 		if (_inputs.usesLOD()) {
-			_uniforms.emplace_back(new UMipmap1(_program));
-			if (config.generalEmulation.enableLOD != 0)
-				_uniforms.emplace_back(new UMipmap2(_program));
+			if (m_glInfo.isGLES2) {
+				_uniforms.add<UMipmap1>(_program);
+				if (config.generalEmulation.enableLOD != 0)
+					_uniforms.add<UMipmap2>(_program);
+			}
 		} else if (_key.getCycleType() < G_CYC_COPY) {
-			_uniforms.emplace_back(new UTextureFetchMode(_program));
+			_uniforms.add<UTextureFetchMode>(_program);
 		}
 
-		_uniforms.emplace_back(new UTexturePersp(_program));
+		_uniforms.add<UTexturePersp>(_program);
 
 		if (m_glInfo.isGLES2)
-			_uniforms.emplace_back(new UTextureSize(_program, _inputs.usesTile(0), _inputs.usesTile(1)));
+			_uniforms.add<UTextureSize>(_program, _inputs.usesTile(0), _inputs.usesTile(1));
 
 		if (!_key.isRectKey())
-			_uniforms.emplace_back(new UTextureParams(_program, _inputs.usesTile(0), _inputs.usesTile(1)));
+			_uniforms.add<UTextureParams>(_program, _inputs.usesTile(0), _inputs.usesTile(1));
 	}
 
-	_uniforms.emplace_back(new UFog(_program));
+	if (m_glInfo.isGLES2)
+		_uniforms.add<UFog>(_program);
+	else
+		_uniforms.add<URDPState>(_program, m_rdpState.get());
 
 	if (config.generalEmulation.enableLegacyBlending == 0) {
 		switch (_key.getCycleType()) {
 		case G_CYC_1CYCLE:
-			_uniforms.emplace_back(new UBlendMode1Cycle(_program));
+			_uniforms.add<UBlendMode1Cycle>(_program);
 			break;
 		case G_CYC_2CYCLE:
-			_uniforms.emplace_back(new UBlendMode2Cycle(_program));
+			_uniforms.add<UBlendMode2Cycle>(_program);
 			break;
 		}
 	}
 
-	_uniforms.emplace_back(new UDitherMode(_program, _inputs.usesNoise()));
-
-	_uniforms.emplace_back(new UScreenScale(_program));
+	_uniforms.add<UDitherMode>(_program, _inputs.usesNoise());
 
-	_uniforms.emplace_back(new UAlphaTestInfo(_program));
+	_uniforms.add<UScreenScale>(_program);
 
-	if ((config.generalEmulation.hacks & hack_RE2) != 0 && config.generalEmulation.enableFragmentDepthWrite != 0)
-		_uniforms.emplace_back(new UZLutTexture(_program));
+	if (m_glInfo.isGLES2)
+		_uniforms.add<UAlphaTestInfo>(_program);
 
 	if (config.frameBufferEmulation.N64DepthCompare != 0)
-		_uniforms.emplace_back(new UDepthInfo(_program));
+		_uniforms.add<UDepthInfo>(_program);
 	else
-		_uniforms.emplace_back(new UDepthSource(_program));
+		_uniforms.add<UDepthSource>(_program);
 
 	if (config.generalEmulation.enableFragmentDepthWrite != 0 ||
 		config.frameBufferEmulation.N64DepthCompare != 0)
-		_uniforms.emplace_back(new URenderTarget(_program));
+		_uniforms.add<URenderTarget>(_program);
 
 	if (m_glInfo.isGLESX && m_glInfo.noPerspective) {
-		_uniforms.emplace_back(new UClampMode(_program));
-		_uniforms.emplace_back(new UPolygonOffset(_program));
+		_uniforms.add<UClampMode>(_program);
+		_uniforms.add<UPolygonOffset>(_program);
 	}
 
-	_uniforms.emplace_back(new UScreenCoordsScale(_program));
+	_uniforms.add<UScreenCoordsScale>(_program);
 
-	_uniforms.emplace_back(new UColors(_program));
+	if (m_glInfo.isGLES2)
+		_uniforms.add<UColors>(_program);
 
 	if (_key.isRectKey())
-		_uniforms.emplace_back(new URectColor(_program));
+		_uniforms.add<URectColor>(_program);
 
 	if (_inputs.usesHwLighting())
-		_uniforms.emplace_back(new ULights(_program));
+		_uniforms.add<ULights>(_program);
 }
 
 CombinerProgramUniformFactory::CombinerProgramUniformFactory(const opengl::GLInfo & _glInfo)
 : m_glInfo(_glInfo)
+{
+	if (!m_glInfo.isGLES2)
+		m_rdpState.reset(new RDPStateBuffer);
+}
+
+CombinerProgramUniformFactory::~CombinerProgramUniformFactory()
 {
 }
 
@@ -1,13 +1,17 @@
 #pragma once
+#include <memory>
 #include <Graphics/OpenGLContext/opengl_GLInfo.h>
 #include "glsl_CombinerProgramImpl.h"
 
 namespace glsl {
 
+	class RDPStateBuffer;
+
 	class CombinerProgramUniformFactory
 	{
 	public:
 		CombinerProgramUniformFactory(const opengl::GLInfo & _glInfo);
+		~CombinerProgramUniformFactory();
 
 		void buildUniforms(GLuint _program,
 							const CombinerInputs & _inputs,
@@ -16,6 +20,7 @@ namespace glsl {
 
 	private:
 		const opengl::GLInfo & m_glInfo;
+		std::unique_ptr<RDPStateBuffer> m_rdpState;
 	};
 
 }
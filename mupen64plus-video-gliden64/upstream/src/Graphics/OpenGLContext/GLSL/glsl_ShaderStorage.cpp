@@ -99,7 +99,13 @@ char * - renderer string
 uint32 - len of GL version string
 char * - GL version string
 uint32 - number of shaders
-shaders in binary form
+shaders in binary form:
+  uint64 - combiner key
+  int32  - combiner inputs
+  uint32 - usage count, used to pre-warm most used shaders first
+  uint32 - binary format
+  int32  - binary length
+  char * - program binary
 */
 bool ShaderStorage::saveShadersStorage(const graphics::Combiners & _combiners) const
 {
@@ -186,7 +192,7 @@ bool ShaderStorage::saveShadersStorage(const graphics::Combiners & _combiners) c
 
 static
 CombinerProgramImpl * _readCominerProgramFromStream(std::istream & _is,
-	CombinerProgramUniformFactory & _uniformFactory,
+	const std::shared_ptr<CombinerProgramUniformFactory> & _uniformFactory,
 	opengl::CachedUseProgram * _useProgram)
 {
 	CombinerKey cmbKey;
@@ -196,6 +202,9 @@ CombinerProgramImpl * _readCominerProgramFromStream(std::istream & _is,
 	_is.read((char*)&inputs, sizeof(inputs));
 	CombinerInputs cmbInputs(inputs);
 
+	u32 usageCount;
+	_is.read((char*)&usageCount, sizeof(usageCount));
+
 	GLenum binaryFormat;
 	GLint  binaryLength;
 	_is.read((char*)&binaryFormat, sizeof(binaryFormat));
@@ -203,16 +212,9 @@ CombinerProgramImpl * _readCominerProgramFromStream(std::istream & _is,
 	std::vector<char> binary(binaryLength);
 	_is.read(binary.data(), binaryLength);
 
-	GLuint program = glCreateProgram();
-	const bool isRect = cmbKey.isRectKey();
-	glsl::Utils::locateAttributes(program, isRect, cmbInputs.usesTexture());
-	glProgramBinary(program, binaryFormat, binary.data(), binaryLength);
-	assert(glsl::Utils::checkProgramLinkStatus(program));
-
-	UniformGroups uniforms;
-	_uniformFactory.buildUniforms(program, cmbInputs, cmbKey, uniforms);
-
-	return new CombinerProgramImpl(cmbKey, program, _useProgram, cmbInputs, std::move(uniforms));
+	// GL program is created when the combiner is used or pre-warmed.
+	return new CombinerProgramImpl(cmbKey, _useProgram, cmbInputs, _uniformFactory,
+		binaryFormat, std::move(binary), usageCount);
 }
 
 bool ShaderStorage::_loadFromCombinerKeys(graphics::Combiners & _combiners)
@@ -319,7 +321,7 @@ bool ShaderStorage::loadShadersStorage(graphics::Combiners & _combiners)
 			return _loadFromCombinerKeys(_combiners);
 
 		displayLoadProgress(L"LOAD COMBINER SHADERS %.1f%%", 0.0f);
-		CombinerProgramUniformFactory uniformFactory(m_glinfo);
+		std::shared_ptr<CombinerProgramUniformFactory> uniformFactory(new CombinerProgramUniformFactory(m_glinfo));
 
 		fin.read((char*)&len, sizeof(len));
 		const f32 percent = len / 100.0f;
@@ -328,7 +330,6 @@ bool ShaderStorage::loadShadersStorage(graphics::Combiners & _combiners)
 		f32 percents = percent;
 		for (u32 i = 0; i < len; ++i) {
 			CombinerProgramImpl * pCombiner = _readCominerProgramFromStream(fin, uniformFactory, m_useProgram);
-			pCombiner->update(true);
 			_combiners[pCombiner->getKey()] = pCombiner;
 			progress += step;
 			if (progress > percents) {
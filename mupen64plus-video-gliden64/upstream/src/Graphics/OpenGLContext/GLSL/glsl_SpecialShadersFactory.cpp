@@ -2,7 +2,6 @@
 #include <Graphics/ShaderProgram.h>
 #include <Graphics/Parameters.h>
 #include <PaletteTexture.h>
-#include <ZlutTexture.h>
 #include <gDP.h>
 #include <Config.h>
 #include <Graphics/ObjectHandle.h>
@@ -56,7 +55,6 @@ namespace glsl {
 		ShadowMapFragmentShader(const opengl::GLInfo & _glinfo)
 		{
 			m_part =
-				"uniform lowp usampler2D uZlutImage;\n"
 				"uniform lowp usampler2D uTlutImage;\n"
 				"uniform sampler2D uDepthImage;		\n"
 				"uniform lowp vec4 uFogColor;								\n"
@@ -69,14 +67,24 @@ namespace glsl {
 				if (_glinfo.ext_fetch) {
 					m_part +=
 						"layout(location = 0) OUT lowp vec4 fragColor;	\n"
-						"layout(location = 1) inout highp vec4 depthZ;	\n"
+						"layout(location = 1) inout highp uvec4 depthZ;	\n"
 						;
 				} else
 					m_part += "OUT lowp vec4 fragColor;									\n";
 			} else
 				m_part += "OUT lowp vec4 fragColor;	\n";
 
+			// N64 depth encoding of DepthBufferList zLUT
 			m_part +=
+				"highp uint encodeN64Depth(highp int iZ)					\n"
+				"{															\n"
+				"  highp uint z = uint(iZ);									\n"
+				"  mediump int exponent = 0;								\n"
+				"  while (exponent < 7 && ((z >> uint(17 - exponent)) & 1u) != 0u)	\n"
+				"    ++exponent;											\n"
+				"  highp uint mantissa = (z >> uint(6 - min(exponent, 6))) & 0x7FFu;	\n"
+				"  return ((uint(exponent) << 11u) | mantissa) << 2u;		\n"
+				"}															\n"
 				"lowp float get_alpha()										\n"
 				"{															\n"
 				;
@@ -102,16 +110,14 @@ namespace glsl {
 						;
 				} else if (_glinfo.ext_fetch) {
 					m_part +=
-						"  highp float bufZ = depthZ.r;	\n"
+						"  highp float bufZ = uintBitsToFloat(depthZ.r);	\n"
 						;
 				}
 			}
 
 			m_part +=
 				"  highp int iZ = bufZ > 0.999 ? 262143 : int(floor(bufZ * 262143.0));\n"
-				"  mediump int y0 = clamp(iZ/512, 0, 511);					\n"
-				"  mediump int x0 = iZ - 512*y0;							\n"
-				"  highp uint iN64z = texelFetch(uZlutImage,ivec2(x0,y0), 0).r;		\n"
+				"  highp uint iN64z = encodeN64Depth(iZ);					\n"
 				"  highp float n64z = clamp(float(iN64z)/65532.0, 0.0, 1.0);\n"
 				"  highp int index = min(255, int(n64z*255.0));				\n"
 				"  highp uint iAlpha = texelFetch(uTlutImage,ivec2(index,0), 0).r;\n"
@@ -359,40 +365,40 @@ namespace glsl {
 
 	/*---------------PostProcessorShaderPart-------------*/
 
-	class GammaCorrection : public ShaderPart
+	// Gamma and orientation correction applied while the frame is copied to screen
+	class PostProcess : public ShaderPart
 	{
 	public:
-		GammaCorrection(const opengl::GLInfo & _glinfo)
+		PostProcess(const opengl::GLInfo & _glinfo, bool _gammaCorrection, bool _orientationCorrection)
 		{
 			m_part =
 				"IN mediump vec2 vTexCoord0;													\n"
 				"uniform sampler2D uTex0;													\n"
+				;
+			if (_gammaCorrection)
+				m_part +=
 				"uniform lowp float uGammaCorrectionLevel;									\n"
+				;
+			m_part +=
 				"OUT lowp vec4 fragColor;													\n"
 				"void main()																\n"
 				"{																			\n"
+				;
+			if (_orientationCorrection)
+				m_part +=
+				"    fragColor = texture2D(uTex0, vec2(1.0 - vTexCoord0.x, 1.0 - vTexCoord0.y));	\n"
+				;
+			else
+				m_part +=
 				"    fragColor = texture2D(uTex0, vTexCoord0);								\n"
+				;
+			if (_gammaCorrection)
+				m_part +=
 				"    fragColor.rgb = pow(fragColor.rgb, vec3(1.0 / uGammaCorrectionLevel));	\n"
 				;
 		}
 	};
 
-	class OrientationCorrection : public ShaderPart
-	{
-	public:
-		OrientationCorrection(const opengl::GLInfo & _glinfo)
-		{
-			m_part =
-				"IN mediump vec2 vTexCoord0;													\n"
-				"uniform sampler2D uTex0;													\n"
-				"OUT lowp vec4 fragColor;													\n"
-				"void main()																\n"
-				"{																			\n"
-				"    fragColor = texture2D(uTex0, vec2(1.0 - vTexCoord0.x, 1.0 - vTexCoord0.y));       \n"
-			;
-		}
-	};
-
 	/*---------------TextDrawerShaderPart-------------*/
 
 	class TextDraw : public ShaderPart
@@ -413,6 +419,334 @@ namespace glsl {
 		}
 	};
 
+	/*---------------RDRAMtoColorBufferShaderPart-------------*/
+
+	// Converts raw RDRAM words uploaded as R32UI texture to color.
+	// A 16bit texel holds two pixels, the left one in the upper half.
+	class RDRAMtoColorBuffer : public ShaderPart
+	{
+	public:
+		RDRAMtoColorBuffer(const opengl::GLInfo & _glinfo)
+		{
+			m_part =
+				"IN mediump vec2 vTexCoord0;												\n"
+				"uniform highp usampler2D uTex0;											\n"
+				"uniform mediump ivec2 uImageSize;											\n"
+				"uniform lowp int uPixelSize;												\n"
+				"uniform lowp int uUseAlpha;												\n"
+				"OUT lowp vec4 fragColor;													\n"
+				"																			\n"
+				"void main()																\n"
+				"{																			\n"
+				"  mediump ivec2 coord = clamp(ivec2(vTexCoord0 * vec2(uImageSize)), ivec2(0), uImageSize - 1);	\n"
+				"  highp uint color;														\n"
+				"  lowp vec4 components;													\n"
+				"  if (uPixelSize == 2) {													\n"
+				"    highp uint word = texelFetch(uTex0, ivec2(coord.x >> 1, coord.y), 0).r;	\n"
+				"    color = (coord.x & 1) == 0 ? (word >> 16u) : (word & 0xFFFFu);		\n"
+				"    components = vec4(uvec4(color >> 11u, color >> 6u, color >> 1u, color) & uvec4(31u, 31u, 31u, 1u));	\n"
+				"    components = components * vec4(8.0, 8.0, 8.0, 255.0) / 255.0;		\n"
+				"  } else {																	\n"
+				"    color = texelFetch(uTex0, coord, 0).r;									\n"
+				"    components = vec4(uvec4(color >> 24u, color >> 16u, color >> 8u, color) & uvec4(255u)) / 255.0;	\n"
+				"  }																		\n"
+				"  if (uUseAlpha == 0)														\n"
+				"    components.a = 1.0;													\n"
+				"  fragColor = components;													\n"
+			;
+		}
+	};
+
+	class TextureUpscaleXbrz : public ShaderPart
+	{
+	public:
+		// Port of xBRZ scaleImage with ABGR colors (GLideNHQ/TextureFilters_xbrz.cpp).
+		// One invocation filters one source pixel into its _scale x _scale output block.
+		TextureUpscaleXbrz(const opengl::GLInfo & _glinfo, u32 _scale)
+		{
+			if (_glinfo.isGLESX)
+				m_part = "#version 310 es \n";
+			else
+				m_part = "#version 430 \n";
+			m_part += "#define SCALE " + Utils::to_string(_scale) + "\n";
+			m_part +=
+				"precision highp float;													\n"
+				"precision highp int;														\n"
+				"layout(local_size_x = 8, local_size_y = 8) in;							\n"
+				"uniform highp sampler2D uTex0;											\n"
+				"layout(rgba8, binding = 0) writeonly uniform highp image2D uOutput;		\n"
+				"uniform mediump ivec2 uImageSize;											\n"
+				"																			\n"
+				"const int N = SCALE;														\n"
+				"uint src[25];		// 5x5 source pixels around the current one				\n"
+				"uint block[N * N];	// output block of the current pixel					\n"
+				"int rotation;																\n"
+				"uint blendColor;															\n"
+				"																			\n"
+				"uint S(int x, int y) { return src[(y + 2) * 5 + x + 2]; }					\n"
+				"																			\n"
+				"uint fetchPixel(ivec2 pos)													\n"
+				"{																			\n"
+				"  uvec4 c = uvec4(texelFetch(uTex0, clamp(pos, ivec2(0), uImageSize - 1), 0) * 255.0 + 0.5);	\n"
+				"  return c.r | (c.g << 8u) | (c.b << 16u) | (c.a << 24u);					\n"
+				"}																			\n"
+				"																			\n"
+				"uvec4 components(uint pix) { return (uvec4(pix) >> uvec4(0u, 8u, 16u, 24u)) & 0xFFu; }	\n"
+				"																			\n"
+				// ColorDistanceABGR, with the precision and red / blue swap of the CPU distance table
+				"float dist(uint pix1, uint pix2)											\n"
+				"{																			\n"
+				"  ivec4 c1 = ivec4(components(pix1));										\n"
+				"  ivec4 c2 = ivec4(components(pix2));										\n"
+				"  vec3 diff = vec3(((c1.rgb - c2.rgb + 255) >> 1) * 2 - 255);				\n"
+				"  float y = 0.2627 * diff.b + (1.0 - 0.0593 - 0.2627) * diff.g + 0.0593 * diff.r;	\n"
+				"  float c_b = 0.5 / (1.0 - 0.0593) * (diff.r - y);						\n"
+				"  float c_r = 0.5 / (1.0 - 0.2627) * (diff.b - y);						\n"
+				"  float d = sqrt(y * y + c_b * c_b + c_r * c_r);							\n"
+				"  float a1 = float(c1.a) / 255.0;											\n"
+				"  float a2 = float(c2.a) / 255.0;											\n"
+				"  return min(a1, a2) * d + 255.0 * abs(a1 - a2);							\n"
+				"}																			\n"
+				"																			\n"
+				"bool eq(float colorDist) { return colorDist < 30.0; }						\n"
+				"																			\n"
+				// Blend types of the corners between F, G, J, K of the 4x4 kernel with F at _pos
+				"ivec4 preProcessCorners(ivec2 _pos)										\n"
+				"{																			\n"
+				"  uint b = S(_pos.x, _pos.y - 1), c = S(_pos.x + 1, _pos.y - 1);			\n"
+				"  uint e = S(_pos.x - 1, _pos.y), f = S(_pos.x, _pos.y);					\n"
+				"  uint g = S(_pos.x + 1, _pos.y), h = S(_pos.x + 2, _pos.y);				\n"
+				"  uint i = S(_pos.x - 1, _pos.y + 1), j = S(_pos.x, _pos.y + 1);			\n"
+				"  uint k = S(_pos.x + 1, _pos.y + 1), l = S(_pos.x + 2, _pos.y + 1);		\n"
+				"  uint n = S(_pos.x, _pos.y + 2), o = S(_pos.x + 1, _pos.y + 2);			\n"
+				"  ivec4 result = ivec4(0);													\n"
+				"  if ((f == g && j == k) || (f == j && g == k))							\n"
+				"    return result;															\n"
+				"  float jg = dist(i, f) + dist(f, c) + dist(n, k) + dist(k, h) + 4.0 * dist(j, g);	\n"
+				"  float fk = dist(e, j) + dist(j, o) + dist(b, g) + dist(g, l) + 4.0 * dist(f, k);	\n"
+				"  if (jg < fk) {															\n"
+				"    int blend = 3.6 * jg < fk ? 2 : 1;										\n"
+				"    if (f != g && f != j) result.x = blend;								\n"
+				"    if (k != j && k != g) result.w = blend;								\n"
+				"  } else if (fk < jg) {													\n"
+				"    int blend = 3.6 * fk < jg ? 2 : 1;										\n"
+				"    if (j != f && j != k) result.z = blend;								\n"
+				"    if (g != f && g != k) result.y = blend;								\n"
+				"  }																		\n"
+				"  return result;															\n"
+				"}																			\n"
+				"																			\n"
+				"uint rotPixel(int x, int y)												\n"
+				"{																			\n"
+				"  ivec2 pos = ivec2(x, y);													\n"
+				"  for (int r = 0; r < rotation; ++r)										\n"
+				"    pos = ivec2(pos.y, -pos.x);											\n"
+				"  return S(pos.x, pos.y);													\n"
+				"}																			\n"
+				"																			\n"
+				"int blockIndex(int _i, int _j)												\n"
+				"{																			\n"
+				"  ivec2 pos = ivec2(_i, _j);												\n"
+				"  for (int r = 0; r < rotation; ++r)										\n"
+				"    pos = ivec2(N - 1 - pos.y, pos.x);										\n"
+				"  return pos.x * N + pos.y;												\n"
+				"}																			\n"
+				"																			\n"
+				"void setPixel(int _i, int _j) { block[blockIndex(_i, _j)] = blendColor; }	\n"
+				"																			\n"
+				// gradientABGR: intermediate color between two colors with alpha channels
+				"void alphaGrad(int _i, int _j, uint _m, uint _n)							\n"
+				"{																			\n"
+				"  int idx = blockIndex(_i, _j);											\n"
+				"  uvec4 front = components(blendColor);									\n"
+				"  uvec4 back = components(block[idx]);										\n"
+				"  uint weightFront = front.a * _m;											\n"
+				"  uint weightBack = back.a * (_n - _m);									\n"
+				"  uint weightSum = weightFront + weightBack;								\n"
+				"  if (weightSum == 0u) {													\n"
+				"    block[idx] = 0u;														\n"
+				"    return;																\n"
+				"  }																		\n"
+				"  uvec3 color = (front.rgb * weightFront + back.rgb * weightBack) / weightSum;	\n"
+				"  block[idx] = color.r | (color.g << 8u) | (color.b << 16u) | ((weightSum / _n) << 24u);	\n"
+				"}																			\n"
+				"																			\n"
+				"#if SCALE == 2																\n"
+				"void blendLineShallow() { alphaGrad(1, 0, 1u, 4u); alphaGrad(1, 1, 3u, 4u); }	\n"
+				"void blendLineSteep() { alphaGrad(0, 1, 1u, 4u); alphaGrad(1, 1, 3u, 4u); }	\n"
+				"void blendLineSteepAndShallow() { alphaGrad(1, 0, 1u, 4u); alphaGrad(0, 1, 1u, 4u); alphaGrad(1, 1, 5u, 6u); }	\n"
+				"void blendLineDiagonal() { alphaGrad(1, 1, 1u, 2u); }						\n"
+				"void blendCorner() { alphaGrad(1, 1, 21u, 100u); }							\n"
+				"#elif SCALE == 3															\n"
+				"void blendLineShallow() { alphaGrad(2, 0, 1u, 4u); alphaGrad(1, 2, 1u, 4u); alphaGrad(2, 1, 3u, 4u); setPixel(2, 2); }	\n"
+				"void blendLineSteep() { alphaGrad(0, 2, 1u, 4u); alphaGrad(2, 1, 1u, 4u); alphaGrad(1, 2, 3u, 4u); setPixel(2, 2); }	\n"
+				"void blendLineSteepAndShallow()											\n"
+				"{																			\n"
+				"  alphaGrad(2, 0, 1u, 4u); alphaGrad(0, 2, 1u, 4u);						\n"
+				"  alphaGrad(2, 1, 3u, 4u); alphaGrad(1, 2, 3u, 4u);						\n"
+				"  setPixel(2, 2);															\n"
+				"}																			\n"
+				"void blendLineDiagonal() { alphaGrad(1, 2, 1u, 8u); alphaGrad(2, 1, 1u, 8u); alphaGrad(2, 2, 7u, 8u); }	\n"
+				"void blendCorner() { alphaGrad(2, 2, 45u, 100u); }							\n"
+				"#elif SCALE == 4															\n"
+				"void blendLineShallow()													\n"
+				"{																			\n"
+				"  alphaGrad(3, 0, 1u, 4u); alphaGrad(2, 2, 1u, 4u);						\n"
+				"  alphaGrad(3, 1, 3u, 4u); alphaGrad(2, 3, 3u, 4u);						\n"
+				"  setPixel(3, 2); setPixel(3, 3);											\n"
+				"}																			\n"
+				"void blendLineSteep()														\n"
+				"{																			\n"
+				"  alphaGrad(0, 3, 1u, 4u); alphaGrad(2, 2, 1u, 4u);						\n"
+				"  alphaGrad(1, 3, 3u, 4u); alphaGrad(3, 2, 3u, 4u);						\n"
+				"  setPixel(2, 3); setPixel(3, 3);											\n"
+				"}																			\n"
+				"void blendLineSteepAndShallow()											\n"
+				"{																			\n"
+				"  alphaGrad(3, 1, 3u, 4u); alphaGrad(1, 3, 3u, 4u);						\n"
+				"  alphaGrad(3, 0, 1u, 4u); alphaGrad(0, 3, 1u, 4u);						\n"
+				"  alphaGrad(2, 2, 1u, 3u);													\n"
+				"  setPixel(3, 3); setPixel(3, 2); setPixel(2, 3);							\n"
+				"}																			\n"
+				"void blendLineDiagonal() { alphaGrad(3, 2, 1u, 2u); alphaGrad(2, 3, 1u, 2u); setPixel(3, 3); }	\n"
+				"void blendCorner() { alphaGrad(3, 3, 68u, 100u); alphaGrad(3, 2, 9u, 100u); alphaGrad(2, 3, 9u, 100u); }	\n"
+				"#elif SCALE == 5															\n"
+				"void blendLineShallow()													\n"
+				"{																			\n"
+				"  alphaGrad(4, 0, 1u, 4u); alphaGrad(3, 2, 1u, 4u); alphaGrad(2, 4, 1u, 4u);	\n"
+				"  alphaGrad(4, 1, 3u, 4u); alphaGrad(3, 3, 3u, 4u);						\n"
+				"  setPixel(4, 2); setPixel(4, 3); setPixel(4, 4); setPixel(3, 4);			\n"
+				"}																			\n"
+				"void blendLineSteep()														\n"
+				"{																			\n"
+				"  alphaGrad(0, 4, 1u, 4u); alphaGrad(2, 3, 1u, 4u); alphaGrad(4, 2, 1u, 4u);	\n"
+				"  alphaGrad(1, 4, 3u, 4u); alphaGrad(3, 3, 3u, 4u);						\n"
+				"  setPixel(2, 4); setPixel(3, 4); setPixel(4, 4); setPixel(4, 3);			\n"
+				"}																			\n"
+				"void blendLineSteepAndShallow()											\n"
+				"{																			\n"
+				"  alphaGrad(0, 4, 1u, 4u); alphaGrad(2, 3, 1u, 4u); alphaGrad(1, 4, 3u, 4u);	\n"
+				"  alphaGrad(4, 0, 1u, 4u); alphaGrad(3, 2, 1u, 4u); alphaGrad(4, 1, 3u, 4u);	\n"
+				"  alphaGrad(3, 3, 2u, 3u);													\n"
+				"  setPixel(2, 4); setPixel(3, 4); setPixel(4, 4);							\n"
+				"  setPixel(4, 2); setPixel(4, 3);											\n"
+				"}																			\n"
+				"void blendLineDiagonal()													\n"
+				"{																			\n"
+				"  alphaGrad(4, 2, 1u, 8u); alphaGrad(3, 3, 1u, 8u); alphaGrad(2, 4, 1u, 8u);	\n"
+				"  alphaGrad(4, 3, 7u, 8u); alphaGrad(3, 4, 7u, 8u);						\n"
+				"  setPixel(4, 4);															\n"
+				"}																			\n"
+				"void blendCorner() { alphaGrad(4, 4, 86u, 100u); alphaGrad(4, 3, 23u, 100u); alphaGrad(3, 4, 23u, 100u); }	\n"
+				"#else																		\n"
+				"void blendLineShallow()													\n"
+				"{																			\n"
+				"  alphaGrad(5, 0, 1u, 4u); alphaGrad(4, 2, 1u, 4u); alphaGrad(3, 4, 1u, 4u);	\n"
+				"  alphaGrad(5, 1, 3u, 4u); alphaGrad(4, 3, 3u, 4u); alphaGrad(3, 5, 3u, 4u);	\n"
+				"  setPixel(5, 2); setPixel(5, 3); setPixel(5, 4); setPixel(5, 5);			\n"
+				"  setPixel(4, 4); setPixel(4, 5);											\n"
+				"}																			\n"
+				"void blendLineSteep()														\n"
+				"{																			\n"
+				"  alphaGrad(0, 5, 1u, 4u); alphaGrad(2, 4, 1u, 4u); alphaGrad(4, 3, 1u, 4u);	\n"
+				"  alphaGrad(1, 5, 3u, 4u); alphaGrad(3, 4, 3u, 4u); alphaGrad(5, 3, 3u, 4u);	\n"
+				"  setPixel(2, 5); setPixel(3, 5); setPixel(4, 5); setPixel(5, 5);			\n"
+				"  setPixel(4, 4); setPixel(5, 4);											\n"
+				"}																			\n"
+				"void blendLineSteepAndShallow()											\n"
+				"{																			\n"
+				"  alphaGrad(0, 5, 1u, 4u); alphaGrad(2, 4, 1u, 4u); alphaGrad(1, 5, 3u, 4u); alphaGrad(3, 4, 3u, 4u);	\n"
+				"  alphaGrad(5, 0, 1u, 4u); alphaGrad(4, 2, 1u, 4u); alphaGrad(5, 1, 3u, 4u); alphaGrad(4, 3, 3u, 4u);	\n"
+				"  setPixel(2, 5); setPixel(3, 5); setPixel(4, 5); setPixel(5, 5);			\n"
+				"  setPixel(4, 4); setPixel(5, 4);											\n"
+				"  setPixel(5, 2); setPixel(5, 3);											\n"
+				"}																			\n"
+				"void blendLineDiagonal()													\n"
+				"{																			\n"
+				"  alphaGrad(5, 3, 1u, 2u); alphaGrad(4, 4, 1u, 2u); alphaGrad(3, 5, 1u, 2u);	\n"
+				"  setPixel(4, 5); setPixel(5, 5); setPixel(5, 4);							\n"
+				"}																			\n"
+				"void blendCorner()															\n"
+				"{																			\n"
+				"  alphaGrad(5, 5, 97u, 100u); alphaGrad(4, 5, 42u, 100u); alphaGrad(5, 4, 42u, 100u);	\n"
+				"  alphaGrad(5, 3, 6u, 100u); alphaGrad(3, 5, 6u, 100u);					\n"
+				"}																			\n"
+				"#endif																		\n"
+				"																			\n"
+				// _blend holds the top left, top right, bottom right and bottom left corners of pixel E
+				"void blendPixel(int _rot, ivec4 _blend)									\n"
+				"{																			\n"
+				"  int bottomR = _blend[(6 - _rot) & 3];									\n"
+				"  if (bottomR == 0)														\n"
+				"    return;																\n"
+				"  int topR = _blend[(5 - _rot) & 3];										\n"
+				"  int bottomL = _blend[(7 - _rot) & 3];									\n"
+				"  rotation = _rot;															\n"
+				"  uint b = rotPixel(0, -1), c = rotPixel(1, -1);							\n"
+				"  uint d = rotPixel(-1, 0), e = rotPixel(0, 0), f = rotPixel(1, 0);		\n"
+				"  uint g = rotPixel(-1, 1), h = rotPixel(0, 1), i = rotPixel(1, 1);		\n"
+				"  bool doLineBlend = true;													\n"
+				"  if (bottomR < 2) {														\n"
+				"    if (topR != 0 && !eq(dist(e, g)))										\n"
+				"      doLineBlend = false;													\n"
+				"    else if (bottomL != 0 && !eq(dist(e, c)))								\n"
+				"      doLineBlend = false;													\n"
+				"    else if (!eq(dist(e, i)) && eq(dist(g, h)) && eq(dist(h, i)) && eq(dist(i, f)) && eq(dist(f, c)))	\n"
+				"      doLineBlend = false;													\n"
+				"  }																		\n"
+				"  blendColor = dist(e, f) <= dist(e, h) ? f : h;							\n"
+				"  if (doLineBlend) {														\n"
+				"    float fg = dist(f, g);													\n"
+				"    float hc = dist(h, c);													\n"
+				"    bool haveShallowLine = 2.2 * fg <= hc && e != g && d != g;				\n"
+				"    bool haveSteepLine = 2.2 * hc <= fg && e != c && b != c;				\n"
+				"    if (haveShallowLine) {													\n"
+				"      if (haveSteepLine)													\n"
+				"        blendLineSteepAndShallow();										\n"
+				"      else																	\n"
+				"        blendLineShallow();												\n"
+				"    } else {																\n"
+				"      if (haveSteepLine)													\n"
+				"        blendLineSteep();													\n"
+				"      else																	\n"
+				"        blendLineDiagonal();												\n"
+				"    }																		\n"
+				"  } else																	\n"
+				"    blendCorner();															\n"
+				"}																			\n"
+				"																			\n"
+				"void main()																\n"
+				"{																			\n"
+				"  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);								\n"
+				"  if (pos.x >= uImageSize.x || pos.y >= uImageSize.y)						\n"
+				"    return;																\n"
+				"  for (int y = -2; y <= 2; ++y)											\n"
+				"    for (int x = -2; x <= 2; ++x)											\n"
+				"      src[(y + 2) * 5 + x + 2] = fetchPixel(pos + ivec2(x, y));			\n"
+				// Each corner is evaluated by the kernel with F left above it. Like the CPU filter,
+				// corners on the top and left image borders are not blended.
+				"  ivec4 blend = ivec4(0);													\n"
+				"  if (pos.x > 0 && pos.y > 0)												\n"
+				"    blend.x = preProcessCorners(ivec2(-1, -1)).w;							\n"
+				"  if (pos.y > 0)															\n"
+				"    blend.y = preProcessCorners(ivec2(0, -1)).z;							\n"
+				"  blend.z = preProcessCorners(ivec2(0, 0)).x;								\n"
+				"  if (pos.x > 0)															\n"
+				"    blend.w = preProcessCorners(ivec2(-1, 0)).y;							\n"
+				"  for (int k = 0; k < N * N; ++k)											\n"
+				"    block[k] = S(0, 0);													\n"
+				"  if (blend != ivec4(0)) {													\n"
+				"    for (int rot = 0; rot < 4; ++rot)										\n"
+				"      blendPixel(rot, blend);												\n"
+				"  }																		\n"
+				"  for (int i = 0; i < N; ++i)												\n"
+				"    for (int j = 0; j < N; ++j)											\n"
+				"      imageStore(uOutput, pos * N + ivec2(j, i), vec4(components(block[i * N + j])) / 255.0);	\n"
+				"}																			\n"
+			;
+		}
+	};
+
 	/*---------------SpecialShader-------------*/
 
 	template<class VertexBody, class FragmentBody, class Base = graphics::ShaderProgram>
@@ -473,13 +807,11 @@ namespace glsl {
 			const ShaderPart * _fragmentHeader)
 			: ShadowMapShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader)
 			, m_locFog(-1)
-			, m_locZlut(-1)
 			, m_locTlut(-1)
 			, m_locDepthImage(-1)
 		{
 			m_useProgram->useProgram(m_program);
 			m_locFog = glGetUniformLocation(GLuint(m_program), "uFogColor");
-			m_locZlut = glGetUniformLocation(GLuint(m_program), "uZlutImage");
 			m_locTlut = glGetUniformLocation(GLuint(m_program), "uTlutImage");
 			m_locDepthImage = glGetUniformLocation(GLuint(m_program), "uDepthImage");
 			m_useProgram->useProgram(graphics::ObjectHandle::null);
@@ -488,7 +820,6 @@ namespace glsl {
 		void activate() override {
 			ShadowMapShaderBase::activate();
 			glUniform4fv(m_locFog, 1, &gDP.fogColor.r);
-			glUniform1i(m_locZlut, int(graphics::textureIndices::ZLUTTex));
 			glUniform1i(m_locTlut, int(graphics::textureIndices::PaletteTex));
 			glUniform1i(m_locDepthImage, 0);
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -497,7 +828,6 @@ namespace glsl {
 
 	private:
 		int m_locFog;
-		int m_locZlut;
 		int m_locTlut;
 		int m_locDepthImage;
 	};
@@ -605,78 +935,169 @@ namespace glsl {
 
 	/*---------------PostProcessorShader-------------*/
 
-	typedef SpecialShader<VertexShaderTexturedRect, GammaCorrection> GammaCorrectionShaderBase;
-
-	class GammaCorrectionShader : public GammaCorrectionShaderBase
+	class PostProcessShader : public graphics::ShaderProgram
 	{
 	public:
-		GammaCorrectionShader(const opengl::GLInfo & _glinfo,
+		PostProcessShader(const opengl::GLInfo & _glinfo,
 			opengl::CachedUseProgram * _useProgram,
 			const ShaderPart * _vertexHeader,
 			const ShaderPart * _fragmentHeader,
-			const ShaderPart * _fragmentEnd)
-			: GammaCorrectionShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader, _fragmentEnd)
+			const ShaderPart * _fragmentEnd,
+			bool _gammaCorrection,
+			bool _orientationCorrection)
+			: m_program(0)
+			, m_useProgram(_useProgram)
 		{
+			VertexShaderTexturedRect vertexBody(_glinfo);
+			PostProcess fragmentBody(_glinfo, _gammaCorrection, _orientationCorrection);
+
+			std::stringstream ssVertexShader;
+			_vertexHeader->write(ssVertexShader);
+			vertexBody.write(ssVertexShader);
+
+			std::stringstream ssFragmentShader;
+			_fragmentHeader->write(ssFragmentShader);
+			fragmentBody.write(ssFragmentShader);
+			_fragmentEnd->write(ssFragmentShader);
+
+			m_program =
+				graphics::ObjectHandle(Utils::createRectShaderProgram(ssVertexShader.str().data(), ssFragmentShader.str().data()));
+
 			m_useProgram->useProgram(m_program);
 			const int texLoc = glGetUniformLocation(GLuint(m_program), "uTex0");
 			glUniform1i(texLoc, 0);
-			const int levelLoc = glGetUniformLocation(GLuint(m_program), "uGammaCorrectionLevel");
-			assert(levelLoc >= 0);
-			const f32 gammaLevel = (config.gammaCorrection.force != 0) ? config.gammaCorrection.level : 2.0f;
-			glUniform1f(levelLoc, gammaLevel);
+			if (_gammaCorrection) {
+				const int levelLoc = glGetUniformLocation(GLuint(m_program), "uGammaCorrectionLevel");
+				assert(levelLoc >= 0);
+				const f32 gammaLevel = (config.gammaCorrection.force != 0) ? config.gammaCorrection.level : 2.0f;
+				glUniform1f(levelLoc, gammaLevel);
+			}
+			m_useProgram->useProgram(graphics::ObjectHandle::null);
+		}
+
+		~PostProcessShader()
+		{
 			m_useProgram->useProgram(graphics::ObjectHandle::null);
+			glDeleteProgram(GLuint(m_program));
 		}
+
+		void activate() override {
+			m_useProgram->useProgram(m_program);
+			gDP.changed |= CHANGED_COMBINE;
+		}
+
+	private:
+		graphics::ObjectHandle m_program;
+		opengl::CachedUseProgram * m_useProgram;
 	};
 
-	typedef SpecialShader<VertexShaderTexturedRect, OrientationCorrection> OrientationCorrectionShaderBase;
+	/*---------------TexrectDrawerShader-------------*/
+
+	typedef SpecialShader<VertexShaderTexturedRect, TextDraw, graphics::TextDrawerShaderProgram> TextDrawerShaderBase;
 
-	class OrientationCorrectionShader : public OrientationCorrectionShaderBase
+	class TextDrawerShader : public TextDrawerShaderBase
 	{
 	public:
-		OrientationCorrectionShader(const opengl::GLInfo & _glinfo,
+		TextDrawerShader(const opengl::GLInfo & _glinfo,
 			opengl::CachedUseProgram * _useProgram,
 			const ShaderPart * _vertexHeader,
 			const ShaderPart * _fragmentHeader,
 			const ShaderPart * _fragmentEnd)
-			: OrientationCorrectionShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader, _fragmentEnd)
+			: TextDrawerShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader, _fragmentEnd)
 		{
 			m_useProgram->useProgram(m_program);
 			const int texLoc = glGetUniformLocation(GLuint(m_program), "uTex0");
 			glUniform1i(texLoc, 0);
+			m_colorLoc = glGetUniformLocation(GLuint(m_program), "uColor");
+			glUniform4fv(m_colorLoc, 1, config.font.colorf);
 			m_useProgram->useProgram(graphics::ObjectHandle::null);
 		}
+
+		void setTextColor(float * _color) override {
+			m_useProgram->useProgram(m_program);
+			glUniform4fv(m_colorLoc, 1, _color);
+			m_useProgram->useProgram(graphics::ObjectHandle::null);
+		}
+
+	private:
+		int m_colorLoc;
 	};
 
-	/*---------------TexrectDrawerShader-------------*/
+	/*---------------RDRAMtoColorBufferShader-------------*/
 
-	typedef SpecialShader<VertexShaderTexturedRect, TextDraw, graphics::TextDrawerShaderProgram> TextDrawerShaderBase;
+	typedef SpecialShader<VertexShaderTexturedRect, RDRAMtoColorBuffer, graphics::RDRAMtoColorBufferShaderProgram> RDRAMtoColorBufferShaderBase;
 
-	class TextDrawerShader : public TextDrawerShaderBase
+	class RDRAMtoColorBufferShader : public RDRAMtoColorBufferShaderBase
 	{
 	public:
-		TextDrawerShader(const opengl::GLInfo & _glinfo,
+		RDRAMtoColorBufferShader(const opengl::GLInfo & _glinfo,
 			opengl::CachedUseProgram * _useProgram,
 			const ShaderPart * _vertexHeader,
 			const ShaderPart * _fragmentHeader,
 			const ShaderPart * _fragmentEnd)
-			: TextDrawerShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader, _fragmentEnd)
+			: RDRAMtoColorBufferShaderBase(_glinfo, _useProgram, _vertexHeader, _fragmentHeader, _fragmentEnd)
 		{
 			m_useProgram->useProgram(m_program);
 			const int texLoc = glGetUniformLocation(GLuint(m_program), "uTex0");
 			glUniform1i(texLoc, 0);
-			m_colorLoc = glGetUniformLocation(GLuint(m_program), "uColor");
-			glUniform4fv(m_colorLoc, 1, config.font.colorf);
+			m_imageSizeLoc = glGetUniformLocation(GLuint(m_program), "uImageSize");
+			m_pixelSizeLoc = glGetUniformLocation(GLuint(m_program), "uPixelSize");
+			m_useAlphaLoc = glGetUniformLocation(GLuint(m_program), "uUseAlpha");
 			m_useProgram->useProgram(graphics::ObjectHandle::null);
 		}
 
-		void setTextColor(float * _color) override {
+		void setImageParams(u32 _width, u32 _height, u32 _size, bool _useAlpha) override {
 			m_useProgram->useProgram(m_program);
-			glUniform4fv(m_colorLoc, 1, _color);
+			glUniform2i(m_imageSizeLoc, _width, _height);
+			glUniform1i(m_pixelSizeLoc, _size);
+			glUniform1i(m_useAlphaLoc, _useAlpha ? 1 : 0);
 			m_useProgram->useProgram(graphics::ObjectHandle::null);
 		}
 
 	private:
-		int m_colorLoc;
+		int m_imageSizeLoc;
+		int m_pixelSizeLoc;
+		int m_useAlphaLoc;
+	};
+
+	/*---------------TextureUpscaleShader-------------*/
+
+	class TextureUpscaleShader : public graphics::TextureUpscaleShaderProgram
+	{
+	public:
+		TextureUpscaleShader(graphics::ObjectHandle _program, opengl::CachedUseProgram * _useProgram)
+			: m_program(_program)
+			, m_useProgram(_useProgram)
+		{
+			m_useProgram->useProgram(m_program);
+			m_texLoc = glGetUniformLocation(GLuint(m_program), "uTex0");
+			m_imageSizeLoc = glGetUniformLocation(GLuint(m_program), "uImageSize");
+			m_useProgram->useProgram(graphics::ObjectHandle::null);
+		}
+
+		~TextureUpscaleShader()
+		{
+			m_useProgram->useProgram(graphics::ObjectHandle::null);
+			glDeleteProgram(GLuint(m_program));
+		}
+
+		void activate() override {
+			m_useProgram->useProgram(m_program);
+			gDP.changed |= CHANGED_COMBINE;
+		}
+
+		void setImageParams(u32 _width, u32 _height, u32 _textureUnit) override {
+			m_useProgram->useProgram(m_program);
+			glUniform1i(m_texLoc, _textureUnit);
+			glUniform2i(m_imageSizeLoc, _width, _height);
+			m_useProgram->useProgram(graphics::ObjectHandle::null);
+		}
+
+	private:
+		graphics::ObjectHandle m_program;
+		opengl::CachedUseProgram * m_useProgram;
+		int m_texLoc;
+		int m_imageSizeLoc;
 	};
 
 	/*---------------SpecialShadersFactory-------------*/
@@ -717,19 +1138,38 @@ namespace glsl {
 		return new TexrectCopyShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
 	}
 
-	graphics::ShaderProgram * SpecialShadersFactory::createGammaCorrectionShader() const
+	graphics::ShaderProgram * SpecialShadersFactory::createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection) const
 	{
-		return new GammaCorrectionShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
+		return new PostProcessShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd,
+			_gammaCorrection, _orientationCorrection);
 	}
 
-	graphics::ShaderProgram * SpecialShadersFactory::createOrientationCorrectionShader() const
+	graphics::TextDrawerShaderProgram * SpecialShadersFactory::createTextDrawerShader() const
 	{
-		return new OrientationCorrectionShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
+		return new TextDrawerShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
 	}
 
-	graphics::TextDrawerShaderProgram * SpecialShadersFactory::createTextDrawerShader() const
+	graphics::RDRAMtoColorBufferShaderProgram * SpecialShadersFactory::createRDRAMtoColorBufferShader() const
 	{
-		return new TextDrawerShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
+		if (m_glinfo.isGLES2)
+			return nullptr;
+
+		return new RDRAMtoColorBufferShader(m_glinfo, m_useProgram, m_vertexHeader, m_fragmentHeader, m_fragmentEnd);
+	}
+
+	graphics::TextureUpscaleShaderProgram * SpecialShadersFactory::createTextureUpscaleShader(u32 _scale) const
+	{
+		if (!m_glinfo.computeShaders)
+			return nullptr;
+
+		TextureUpscaleXbrz computeShader(m_glinfo, _scale);
+		std::stringstream ssShader;
+		computeShader.write(ssShader);
+		const GLuint program = Utils::createComputeShaderProgram(ssShader.str().data());
+		if (program == 0)
+			return nullptr;
+
+		return new TextureUpscaleShader(graphics::ObjectHandle(program), m_useProgram);
 	}
 
 }
@@ -30,12 +30,14 @@ namespace glsl {
 
 		graphics::ShaderProgram * createTexrectCopyShader() const;
 
-		graphics::ShaderProgram * createGammaCorrectionShader() const;
-
-		graphics::ShaderProgram * createOrientationCorrectionShader() const;
+		graphics::ShaderProgram * createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection) const;
 
 		graphics::TextDrawerShaderProgram * createTextDrawerShader() const;
 
+		graphics::RDRAMtoColorBufferShaderProgram * createRDRAMtoColorBufferShader() const;
+
+		graphics::TextureUpscaleShaderProgram * createTextureUpscaleShader(u32 _scale) const;
+
 	private:
 		const opengl::GLInfo & m_glinfo;
 		const ShaderPart * m_vertexHeader;
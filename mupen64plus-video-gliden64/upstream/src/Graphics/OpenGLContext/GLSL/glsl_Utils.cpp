@@ -62,7 +62,8 @@ bool Utils::checkProgramLinkStatus(GLuint obj)
 
 void Utils::logErrorShader(GLenum _shaderType, const std::string & _strShader)
 {
-	LOG(LOG_ERROR, "Error in %s shader", _shaderType == GL_VERTEX_SHADER ? "vertex" : "fragment");
+	LOG(LOG_ERROR, "Error in %s shader", _shaderType == GL_VERTEX_SHADER ? "vertex" :
+		(_shaderType == GL_COMPUTE_SHADER ? "compute" : "fragment"));
 
 	const u32 max = 800;
 	u32 pos = 0;
@@ -107,3 +108,28 @@ GLuint Utils::createRectShaderProgram(const char * _strVertex, const char * _str
 	assert(checkProgramLinkStatus(program));
 	return program;
 }
+
+GLuint Utils::createComputeShaderProgram(const char * _strCompute)
+{
+	GLuint compute_shader_object = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(compute_shader_object, 1, &_strCompute, nullptr);
+	glCompileShader(compute_shader_object);
+
+	if (!checkShaderCompileStatus(compute_shader_object))
+		logErrorShader(GL_COMPUTE_SHADER, _strCompute);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, compute_shader_object);
+	glLinkProgram(program);
+	glDeleteShader(compute_shader_object);
+
+	// Compute shaders are optional, let the caller fall back if the driver rejects it.
+	GLint status;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status == GL_FALSE) {
+		checkProgramLinkStatus(program);
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
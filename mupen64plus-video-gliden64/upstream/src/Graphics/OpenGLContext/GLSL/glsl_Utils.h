@@ -11,6 +11,7 @@ namespace glsl {
 		static bool checkProgramLinkStatus(GLuint obj);
 		static void logErrorShader(GLenum _shaderType, const std::string & _strShader);
 		static GLuint createRectShaderProgram(const char * _strVertex, const char * _strFragment);
+		static GLuint createComputeShaderProgram(const char * _strCompute);
 
 		template <typename T>
 		static std::string to_string(T value)
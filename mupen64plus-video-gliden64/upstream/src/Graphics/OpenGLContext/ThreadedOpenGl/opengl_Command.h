@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+namespace opengl {
+
+	template <size_t... I>
+	struct IndexSequence {};
+
+	template <size_t N, size_t... I>
+	struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+	template <size_t... I>
+	struct MakeIndexSequence<0, I...> { typedef IndexSequence<I...> type; };
+
+	template <typename... T>
+	struct HasPointer : std::false_type {};
+
+	template <typename T, typename... Rest>
+	struct HasPointer<T, Rest...> : std::integral_constant<bool,
+		std::is_pointer<T>::value || HasPointer<Rest...>::value> {};
+
+	// Recorded GL call. Commands are constructed in place in the command
+	// queue slots and executed and destroyed by the GL thread.
+	class Command
+	{
+	public:
+		virtual ~Command() {}
+		virtual void execute() = 0;
+	};
+
+	// GL function called with its parameters stored by value.
+	template <typename Func, typename... Params>
+	class FunctionCommand : public Command
+	{
+	public:
+		FunctionCommand(Func _func, Params... _params)
+			: m_func(_func)
+			, m_params(_params...) {}
+
+		void execute() override
+		{
+			_execute(typename MakeIndexSequence<sizeof...(Params)>::type());
+		}
+
+	private:
+		template <size_t... I>
+		void _execute(IndexSequence<I...>)
+		{
+			m_func(std::get<I>(m_params)...);
+		}
+
+		Func m_func;
+		std::tuple<Params...> m_params;
+	};
+
+	// GL function whose last parameter points to a small array of values
+	// which has to be copied, since the caller may reuse it right after the call.
+	template <typename Func, typename T, typename... Params>
+	class ArrayCommand : public Command
+	{
+	public:
+		static const size_t capacity = 64 / sizeof(T);
+
+		ArrayCommand(Func _func, const T * _values, size_t _count, Params... _params)
+			: m_func(_func)
+			, m_params(_params...)
+		{
+			memcpy(m_values, _values, _count * sizeof(T));
+		}
+
+		void execute() override
+		{
+			_execute(typename MakeIndexSequence<sizeof...(Params)>::type());
+		}
+
+	private:
+		template <size_t... I>
+		void _execute(IndexSequence<I...>)
+		{
+			m_func(std::get<I>(m_params)..., m_values);
+		}
+
+		Func m_func;
+		std::tuple<Params...> m_params;
+		T m_values[capacity];
+	};
+
+	// Arbitrary code which has to run on the GL thread, e.g. video extension calls.
+	template <typename F>
+	class LambdaCommand : public Command
+	{
+	public:
+		LambdaCommand(const F & _func) : m_func(_func) {}
+
+		void execute() override
+		{
+			m_func();
+		}
+
+	private:
+		F m_func;
+	};
+
+}
@@ -0,0 +1,144 @@
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <Log.h>
+#include "opengl_Wrapper.h"
+
+using namespace opengl;
+
+namespace {
+	// Single producer (emulation thread), single consumer (GL thread) ring of command slots.
+	const u64 queueSize = 16384;
+	const u32 spinCount = 4096;
+
+	struct alignas(16) Slot {
+		unsigned char data[128];
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<u64> head(0);
+	std::atomic<u64> tail(0);
+	std::atomic<bool> consumerWaiting(false);
+	std::atomic<bool> producerWaiting(false);
+	std::atomic<bool> stop(false);
+	std::mutex mutex;
+	std::condition_variable consumerCv;
+	std::condition_variable producerCv;
+	std::thread glThread;
+
+	Command * slotCommand(u64 _index)
+	{
+		return reinterpret_cast<Command*>(slots[_index % queueSize].data);
+	}
+}
+
+bool FunctionWrapper::m_threaded = false;
+bool FunctionWrapper::m_sync = false;
+u64 FunctionWrapper::m_lastSwap = 0;
+std::thread::id FunctionWrapper::m_glThreadId;
+
+void FunctionWrapper::setThreadedMode(u32 _threaded)
+{
+	const bool threaded = _threaded != 0;
+	if (threaded == m_threaded)
+		return;
+
+	if (threaded) {
+#if !(defined(EGL) || defined(OS_IOS)) || defined(GL_ERROR_DEBUG)
+		// Core GL functions are not routed through GLFunctions.h macros here.
+		LOG(LOG_WARNING, "Threaded OpenGL is not supported by this build\n");
+		return;
+#endif
+		static_assert(sizeof(Slot) == m_commandSize, "Queue slot size mismatch");
+		slots.reset(new Slot[queueSize]);
+		head = 0;
+		tail = 0;
+		stop = false;
+		m_sync = false;
+		m_lastSwap = 0;
+		glThread = std::thread(&FunctionWrapper::_threadLoop);
+		m_glThreadId = glThread.get_id();
+		m_threaded = true;
+		LOG(LOG_VERBOSE, "Threaded OpenGL enabled\n");
+	} else {
+		waitForIdle();
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stop = true;
+		}
+		consumerCv.notify_one();
+		glThread.join();
+		m_threaded = false;
+		m_glThreadId = std::thread::id();
+		slots.reset();
+	}
+}
+
+void FunctionWrapper::waitForIdle()
+{
+	if (_isDirect())
+		return;
+	_wait(head.load(std::memory_order_relaxed));
+}
+
+void * FunctionWrapper::_reserve(u64 & _count)
+{
+	const u64 index = head.load(std::memory_order_relaxed);
+	if (index - tail.load(std::memory_order_acquire) >= queueSize)
+		_wait(index - queueSize + 1);
+	_count = index + 1;
+	return slots[index % queueSize].data;
+}
+
+void FunctionWrapper::_commit()
+{
+	head.fetch_add(1);
+	if (consumerWaiting.load()) {
+		std::unique_lock<std::mutex> lock(mutex);
+		consumerCv.notify_one();
+	}
+}
+
+void FunctionWrapper::_wait(u64 _count)
+{
+	for (u32 i = 0; i < spinCount; ++i) {
+		if (tail.load(std::memory_order_acquire) >= _count)
+			return;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	producerWaiting = true;
+	producerCv.wait(lock, [_count]() { return tail.load() >= _count; });
+	producerWaiting = false;
+}
+
+void FunctionWrapper::_threadLoop()
+{
+	u64 index = tail.load();
+	while (true) {
+		if (index == head.load(std::memory_order_acquire)) {
+			u32 i = 0;
+			while (i < spinCount && index == head.load(std::memory_order_acquire))
+				++i;
+			if (i == spinCount) {
+				std::unique_lock<std::mutex> lock(mutex);
+				consumerWaiting = true;
+				consumerCv.wait(lock, [index]() { return index != head.load() || stop.load(); });
+				consumerWaiting = false;
+				if (index == head.load())
+					break;
+			}
+		}
+
+		Command * command = slotCommand(index);
+		command->execute();
+		command->~Command();
+		tail.store(++index);
+
+		if (producerWaiting.load()) {
+			std::unique_lock<std::mutex> lock(mutex);
+			producerCv.notify_one();
+		}
+	}
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <new>
+#include <thread>
+#include <Types.h>
+#include "opengl_Command.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace opengl {
+
+	template <typename T>
+	struct NonDeduced { typedef T type; };
+
+	// Routes GL calls either directly to the driver or, in threaded mode,
+	// to a command queue executed by a dedicated thread which owns the GL context.
+	// Calls without results and pointer parameters are recorded and return at once.
+	// Everything else (object creation, queries, readbacks, mapping, uploads from
+	// client memory) is executed synchronously while the calling thread waits.
+	class FunctionWrapper
+	{
+	public:
+		static void setThreadedMode(u32 _threaded);
+		static bool isThreaded() { return m_threaded; }
+
+		// Execute all calls synchronously while keeping the GL thread,
+		// e.g. when draws read vertex data from client memory.
+		static void setSyncMode(bool _sync) { m_sync = _sync; }
+
+		static void waitForIdle();
+
+		// Run _func on the GL thread and wait for it to finish.
+		template <typename F>
+		static void runSync(const F & _func)
+		{
+			if (_isDirect()) {
+				_func();
+				return;
+			}
+			_wait(_push<LambdaCommand<F>>(_func));
+		}
+
+		// Queue _func as the end of a frame. Waits until the previous frame
+		// has been executed, so the GL thread lags at most one frame behind.
+		template <typename F>
+		static void swapBuffers(const F & _func)
+		{
+			if (_isDirect()) {
+				_func();
+				return;
+			}
+			const u64 swap = _push<LambdaCommand<F>>(_func);
+			_wait(m_lastSwap);
+			m_lastSwap = swap;
+		}
+
+		template <typename R, typename... Params>
+		static R call(R(APIENTRY * _func)(Params...), typename NonDeduced<Params>::type... _params)
+		{
+			typedef std::integral_constant<bool,
+				std::is_void<R>::value && !HasPointer<Params...>::value> IsAsync;
+			return _call(IsAsync(), _func, _params...);
+		}
+
+		// Call which must not be recorded although it returns nothing, e.g. glFinish.
+		template <typename R, typename... Params>
+		static R callSync(R(APIENTRY * _func)(Params...), typename NonDeduced<Params>::type... _params)
+		{
+			return _call(std::false_type(), _func, _params...);
+		}
+
+		// Call whose pointer parameters are buffer offsets rather than client memory.
+		template <typename... Params>
+		static void callWithOffsets(void(APIENTRY * _func)(Params...), typename NonDeduced<Params>::type... _params)
+		{
+			_call(std::true_type(), _func, _params...);
+		}
+
+		// Call whose last parameter points to _Size values.
+		template <size_t _Size, typename A, typename T>
+		static void callWithArray(void(APIENTRY * _func)(A, const T*),
+			typename NonDeduced<A>::type _a, typename NonDeduced<const T*>::type _values)
+		{
+			_callWithArray(_func, _Size, _values, _a);
+		}
+
+		template <size_t _Size, typename A, typename B, typename T>
+		static void callWithArray(void(APIENTRY * _func)(A, B, const T*),
+			typename NonDeduced<A>::type _a, typename NonDeduced<B>::type _b,
+			typename NonDeduced<const T*>::type _values)
+		{
+			_callWithArray(_func, _Size, _values, _a, _b);
+		}
+
+		// Call whose last parameter points to _Size values for each of _count elements.
+		template <size_t _Size, typename C, typename T>
+		static void callWithCountedArray(void(APIENTRY * _func)(C, const T*),
+			typename NonDeduced<C>::type _count, typename NonDeduced<const T*>::type _values)
+		{
+			_callWithArray(_func, _Size * _count, _values, _count);
+		}
+
+		template <size_t _Size, typename A, typename C, typename T>
+		static void callWithCountedArray(void(APIENTRY * _func)(A, C, const T*),
+			typename NonDeduced<A>::type _a, typename NonDeduced<C>::type _count,
+			typename NonDeduced<const T*>::type _values)
+		{
+			_callWithArray(_func, _Size * _count, _values, _a, _count);
+		}
+
+		// Call whose last parameter points to _size bytes of data, e.g. glBufferSubData.
+		template <typename A, typename B, typename S>
+		static void callWithData(void(APIENTRY * _func)(A, B, S, const void*),
+			typename NonDeduced<A>::type _a, typename NonDeduced<B>::type _b,
+			typename NonDeduced<S>::type _size, const void * _data)
+		{
+			_callWithArray(_func, size_t(_size), static_cast<const u8*>(_data), _a, _b, _size);
+		}
+
+	private:
+		template <typename R, typename... Params>
+		static R _syncCall(std::false_type, R(APIENTRY * _func)(Params...), Params... _params)
+		{
+			R result = R();
+			runSync([&]() { result = _func(_params...); });
+			return result;
+		}
+
+		template <typename R, typename... Params>
+		static void _syncCall(std::true_type, R(APIENTRY * _func)(Params...), Params... _params)
+		{
+			runSync([&]() { _func(_params...); });
+		}
+
+		template <typename R, typename... Params>
+		static R _call(std::false_type, R(APIENTRY * _func)(Params...), Params... _params)
+		{
+			if (_isDirect())
+				return _func(_params...);
+			return _syncCall(std::is_void<R>(), _func, _params...);
+		}
+
+		template <typename R, typename... Params>
+		static void _call(std::true_type, R(APIENTRY * _func)(Params...), Params... _params)
+		{
+			if (_isDirect()) {
+				_func(_params...);
+				return;
+			}
+			if (m_sync) {
+				_syncCall(std::true_type(), _func, _params...);
+				return;
+			}
+			_push<FunctionCommand<R(APIENTRY *)(Params...), Params...>>(_func, _params...);
+		}
+
+		template <typename Func, typename T, typename... Params>
+		static void _callWithArray(Func _func, size_t _count, const T * _values, Params... _params)
+		{
+			typedef ArrayCommand<Func, T, Params...> Cmd;
+			if (_isDirect()) {
+				_func(_params..., _values);
+				return;
+			}
+			if (m_sync || _count > Cmd::capacity) {
+				runSync([&]() { _func(_params..., _values); });
+				return;
+			}
+			_push<Cmd>(_func, _values, _count, _params...);
+		}
+
+		// Returns the number of commands queued so far, including this one.
+		template <typename Cmd, typename... Args>
+		static u64 _push(const Args &... _args)
+		{
+			static_assert(sizeof(Cmd) <= m_commandSize, "GL command does not fit into a queue slot");
+			u64 count;
+			new (_reserve(count)) Cmd(_args...);
+			_commit();
+			return count;
+		}
+
+		static bool _isDirect()
+		{
+			return !m_threaded || std::this_thread::get_id() == m_glThreadId;
+		}
+
+		static void * _reserve(u64 & _count);
+		static void _commit();
+		static void _wait(u64 _count);
+		static void _threadLoop();
+
+		static const size_t m_commandSize = 128;
+
+		static bool m_threaded;
+		static bool m_sync;
+		static u64 m_lastSwap;
+		static std::thread::id m_glThreadId;
+	};
+
+	// Binds a GL function to FunctionWrapper, so GLFunctions.h macros
+	// can pass an empty argument list: wrapFunction(g_glFinish)().
+	template <bool _Sync, typename R, typename... Params>
+	class FunctionCall
+	{
+	public:
+		explicit FunctionCall(R(APIENTRY * _func)(Params...)) : m_func(_func) {}
+
+		R operator()(Params... _params) const
+		{
+			return _Sync ? FunctionWrapper::callSync(m_func, _params...) : FunctionWrapper::call(m_func, _params...);
+		}
+
+	private:
+		R(APIENTRY * m_func)(Params...);
+	};
+
+	template <typename R, typename... Params>
+	FunctionCall<false, R, Params...> wrapFunction(R(APIENTRY * _func)(Params...))
+	{
+		return FunctionCall<false, R, Params...>(_func);
+	}
+
+	template <typename R, typename... Params>
+	FunctionCall<true, R, Params...> wrapSyncFunction(R(APIENTRY * _func)(Params...))
+	{
+		return FunctionCall<true, R, Params...>(_func);
+	}
+
+}
@@ -28,6 +28,7 @@ private:
 	void _getDisplaySize();
 
 	bool _start() override;
+	bool _startVideo();
 	void _stop() override;
 	void _swapBuffers() override;
 	void _saveScreenshot() override;
@@ -54,7 +55,9 @@ void DisplayWindowMupen64plus::_setAttributes()
 	CoreVideo_GL_SetAttribute(M64P_GL_DOUBLEBUFFER, 1);
 	CoreVideo_GL_SetAttribute(M64P_GL_SWAP_CONTROL, config.video.verticalSync);
 	CoreVideo_GL_SetAttribute(M64P_GL_BUFFER_SIZE, 32);
-	CoreVideo_GL_SetAttribute(M64P_GL_DEPTH_SIZE, 16);
+	// With frame buffer emulation everything is drawn into our own FBOs and the window only gets
+	// the final copy, so it doesn't need a depth buffer
+	CoreVideo_GL_SetAttribute(M64P_GL_DEPTH_SIZE, config.frameBufferEmulation.enable != 0 ? 0 : 16);
 	if (config.video.multisampling > 0 && config.frameBufferEmulation.enable == 0) {
 		CoreVideo_GL_SetAttribute(M64P_GL_MULTISAMPLEBUFFERS, 1);
 		if (config.video.multisampling <= 2)
@@ -69,6 +72,18 @@ void DisplayWindowMupen64plus::_setAttributes()
 }
 
 bool DisplayWindowMupen64plus::_start()
+{
+	opengl::FunctionWrapper::setThreadedMode(config.video.threadedVideo);
+
+	// The GL context is created by the thread which executes GL calls.
+	bool started = false;
+	opengl::FunctionWrapper::runSync([&]() { started = _startVideo(); });
+	if (!started)
+		opengl::FunctionWrapper::setThreadedMode(0);
+	return started;
+}
+
+bool DisplayWindowMupen64plus::_startVideo()
 {
 	CoreVideo_Init();
 	_setAttributes();
@@ -102,22 +117,29 @@ bool DisplayWindowMupen64plus::_start()
 
 void DisplayWindowMupen64plus::_stop()
 {
-	CoreVideo_Quit();
+	opengl::FunctionWrapper::runSync([]() { CoreVideo_Quit(); });
+	opengl::FunctionWrapper::setThreadedMode(0);
 }
 
 void DisplayWindowMupen64plus::_swapBuffers()
 {
 	// if emulator defined a render callback function, call it before buffer swap
-	if (renderCallback != nullptr) {
+	void(*callback)(int) = renderCallback;
+	int redrawScreen = 0;
+	if (callback != nullptr) {
 		gfxContext.resetShaderProgram();
 		if (config.frameBufferEmulation.N64DepthCompare == 0) {
 			gfxContext.setViewport(0, getHeightOffset(), getScreenWidth(), getScreenHeight());
 			gSP.changed |= CHANGED_VIEWPORT;
 		}
 		gDP.changed |= CHANGED_COMBINE;
-		(*renderCallback)((gDP.changed&CHANGED_CPU_FB_WRITE) == 0 ? 1 : 0);
+		redrawScreen = (gDP.changed&CHANGED_CPU_FB_WRITE) == 0 ? 1 : 0;
 	}
-	CoreVideo_GL_SwapBuffers();
+	opengl::FunctionWrapper::swapBuffers([=]() {
+		if (callback != nullptr)
+			(*callback)(redrawScreen);
+		CoreVideo_GL_SwapBuffers();
+	});
 }
 
 void DisplayWindowMupen64plus::_saveScreenshot()
@@ -131,7 +153,9 @@ bool DisplayWindowMupen64plus::_resizeWindow()
 	m_bFullscreen = false;
 	m_width = m_screenWidth = m_resizeWidth;
 	m_height = m_screenHeight = m_resizeHeight;
-	switch (CoreVideo_ResizeWindow(m_screenWidth, m_screenHeight)) 
+	m64p_error result = M64ERR_SUCCESS;
+	opengl::FunctionWrapper::runSync([&]() { result = CoreVideo_ResizeWindow(m_screenWidth, m_screenHeight); });
+	switch (result) 
 	{
 		case M64ERR_INVALID_STATE: 
 			printf("(EE) Error setting videomode %dx%d in fullscreen mode\n", m_screenWidth, m_screenHeight);
@@ -144,7 +168,7 @@ bool DisplayWindowMupen64plus::_resizeWindow()
 			printf("(EE) Error setting videomode %dx%d\n", m_screenWidth, m_screenHeight);
 			m_width = m_screenWidth = config.video.windowedWidth;
 			m_height = m_screenHeight = config.video.windowedHeight;
-			CoreVideo_Quit();
+			opengl::FunctionWrapper::runSync([]() { CoreVideo_Quit(); });
 			return false;
 	}
 	_setBufferSize();
@@ -154,7 +178,7 @@ bool DisplayWindowMupen64plus::_resizeWindow()
 
 void DisplayWindowMupen64plus::_changeWindow()
 {
-	CoreVideo_ToggleFullScreen();
+	opengl::FunctionWrapper::runSync([]() { CoreVideo_ToggleFullScreen(); });
 }
 
 void DisplayWindowMupen64plus::_getDisplaySize()
@@ -239,6 +239,48 @@ public:
 	}
 };
 
+/*---------------InvalidateFramebuffer-------------*/
+
+class InvalidateFramebufferImpl : public InvalidateFramebuffer
+{
+public:
+	static bool Check(const GLInfo & _glinfo) {
+		return _glinfo.invalidateFramebuffer;
+	}
+
+	InvalidateFramebufferImpl(CachedBindFramebuffer * _bind)
+		: m_bind(_bind) {
+	}
+
+	void invalidateFramebuffer(graphics::ObjectHandle _buffer, graphics::BlitMaskParam _mask) override
+	{
+		const bool window = _buffer == graphics::ObjectHandle::null;
+		const GLbitfield mask = GLbitfield(_mask);
+		GLenum attachments[3];
+		GLsizei count = 0;
+		if ((mask & GL_COLOR_BUFFER_BIT) != 0)
+			attachments[count++] = window ? GL_COLOR : GL_COLOR_ATTACHMENT0;
+		if ((mask & GL_DEPTH_BUFFER_BIT) != 0)
+			attachments[count++] = window ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+		if ((mask & GL_STENCIL_BUFFER_BIT) != 0)
+			attachments[count++] = window ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+		if (count == 0)
+			return;
+
+		m_bind->bind(graphics::bufferTarget::DRAW_FRAMEBUFFER, _buffer);
+		glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, attachments);
+	}
+
+private:
+	CachedBindFramebuffer * m_bind;
+};
+
+class DummyInvalidateFramebuffer : public InvalidateFramebuffer
+{
+public:
+	void invalidateFramebuffer(graphics::ObjectHandle _buffer, graphics::BlitMaskParam _mask) override {}
+};
+
 /*---------------FramebufferTextureFormats-------------*/
 
 struct FramebufferTextureFormatsGLES2 : public graphics::FramebufferTextureFormats
@@ -277,12 +319,22 @@ protected:
 			colorFormat = GL_RGBA;
 			colorType = GL_UNSIGNED_BYTE;
 			colorFormatBytes = 4;
+
+			color16InternalFormat = GL_RGBA;
+			color16Format = GL_RGBA;
+			color16Type = GL_UNSIGNED_SHORT_5_5_5_1;
+			color16FormatBytes = 2;
 		}
 		else {
 			colorInternalFormat = GL_RGB;
 			colorFormat = GL_RGB;
 			colorType = GL_UNSIGNED_SHORT_5_6_5;
 			colorFormatBytes = 2;
+
+			color16InternalFormat = colorInternalFormat;
+			color16Format = colorFormat;
+			color16Type = colorType;
+			color16FormatBytes = colorFormatBytes;
 		}
 
 		noiseInternalFormat = graphics::internalcolorFormat::LUMINANCE;
@@ -315,11 +367,21 @@ protected:
 			colorFormat = GL_RGBA;
 			colorType = GL_FLOAT;
 			colorFormatBytes = 16;
+
+			color16InternalFormat = colorInternalFormat;
+			color16Format = colorFormat;
+			color16Type = colorType;
+			color16FormatBytes = colorFormatBytes;
 		} else {
 			colorInternalFormat = GL_RGBA8;
 			colorFormat = GL_RGBA;
 			colorType = GL_UNSIGNED_BYTE;
 			colorFormatBytes = 4;
+
+			color16InternalFormat = GL_RGB5_A1;
+			color16Format = GL_RGBA;
+			color16Type = GL_UNSIGNED_SHORT_5_5_5_1;
+			color16FormatBytes = 2;
 		}
 
 		monochromeInternalFormat = GL_R8;
@@ -332,9 +394,18 @@ protected:
 		depthType = GL_UNSIGNED_INT;
 		depthFormatBytes = 4;
 
-		depthImageInternalFormat = GL_R32F;
-		depthImageFormat = GL_RED;
-		depthImageType = GL_FLOAT;
+		if (m_glinfo.ext_fetch) {
+			// Framebuffer fetch needs the depth image as color attachment. Unlike R32F,
+			// integer formats are color renderable without GL_EXT_color_buffer_float.
+			// Shaders store float depth values in it as raw bits.
+			depthImageInternalFormat = GL_R32UI;
+			depthImageFormat = GL_RED_INTEGER;
+			depthImageType = GL_UNSIGNED_INT;
+		} else {
+			depthImageInternalFormat = GL_R32F;
+			depthImageFormat = GL_RED;
+			depthImageType = GL_FLOAT;
+		}
 		depthImageFormatBytes = 4;
 
 		lutInternalFormat = GL_R32UI;
@@ -357,7 +428,8 @@ struct FramebufferTextureFormatsOpenGL : public graphics::FramebufferTextureForm
 		return !_glinfo.isGLESX;
 	}
 
-	FramebufferTextureFormatsOpenGL()
+	FramebufferTextureFormatsOpenGL(const GLInfo & _glinfo):
+		m_glinfo(_glinfo)
 	{
 		init();
 	}
@@ -370,6 +442,11 @@ protected:
 		colorType = GL_UNSIGNED_BYTE;
 		colorFormatBytes = 4;
 
+		color16InternalFormat = GL_RGB5_A1;
+		color16Format = GL_RGBA;
+		color16Type = GL_UNSIGNED_SHORT_5_5_5_1;
+		color16FormatBytes = 2;
+
 		monochromeInternalFormat = GL_R8;
 		monochromeFormat = GL_RED;
 		monochromeType = GL_UNSIGNED_BYTE;
@@ -380,9 +457,15 @@ protected:
 		depthType = GL_FLOAT;
 		depthFormatBytes = 4;
 
-		depthImageInternalFormat = GL_R32F;
-		depthImageFormat = GL_RED;
-		depthImageType = GL_FLOAT;
+		if (m_glinfo.ext_fetch) {
+			depthImageInternalFormat = GL_R32UI;
+			depthImageFormat = GL_RED_INTEGER;
+			depthImageType = GL_UNSIGNED_INT;
+		} else {
+			depthImageInternalFormat = GL_R32F;
+			depthImageFormat = GL_RED;
+			depthImageType = GL_FLOAT;
+		}
 		depthImageFormatBytes = 4;
 
 		lutInternalFormat = GL_R32UI;
@@ -395,6 +478,9 @@ protected:
 		noiseType = GL_UNSIGNED_BYTE;
 		noiseFormatBytes = 1;
 	}
+
+private:
+	const GLInfo & m_glinfo;
 };
 
 /*---------------BufferManipulationObjectFactory-------------*/
@@ -447,6 +533,14 @@ BlitFramebuffers * BufferManipulationObjectFactory::getBlitFramebuffers() const
 	return new DummyBlitFramebuffers;
 }
 
+InvalidateFramebuffer * BufferManipulationObjectFactory::getInvalidateFramebuffer() const
+{
+	if (InvalidateFramebufferImpl::Check(m_glInfo))
+		return new InvalidateFramebufferImpl(m_cachedFunctions.getCachedBindFramebuffer());
+
+	return new DummyInvalidateFramebuffer;
+}
+
 CreatePixelReadBuffer * BufferManipulationObjectFactory::createPixelReadBuffer() const
 {
 	if (m_glInfo.isGLES2)
@@ -458,7 +552,7 @@ CreatePixelReadBuffer * BufferManipulationObjectFactory::createPixelReadBuffer()
 graphics::FramebufferTextureFormats * BufferManipulationObjectFactory::getFramebufferTextureFormats() const
 {
 	if (FramebufferTextureFormatsOpenGL::Check(m_glInfo))
-		return new FramebufferTextureFormatsOpenGL;
+		return new FramebufferTextureFormatsOpenGL(m_glInfo);
 
 	if (FramebufferTextureFormatsGLES3::Check(m_glInfo))
 		return new FramebufferTextureFormatsGLES3(m_glInfo);
@@ -52,6 +52,13 @@ namespace opengl {
 		virtual bool blitFramebuffers(const graphics::Context::BlitFramebuffersParams & _params) = 0;
 	};
 
+	class InvalidateFramebuffer
+	{
+	public:
+		virtual ~InvalidateFramebuffer() {}
+		virtual void invalidateFramebuffer(graphics::ObjectHandle _buffer, graphics::BlitMaskParam _mask) = 0;
+	};
+
 	class BufferManipulationObjectFactory
 	{
 	public:
@@ -70,6 +77,8 @@ namespace opengl {
 
 		BlitFramebuffers * getBlitFramebuffers() const;
 
+		InvalidateFramebuffer * getInvalidateFramebuffer() const;
+
 		graphics::FramebufferTextureFormats * getFramebufferTextureFormats() const;
 
 	private:
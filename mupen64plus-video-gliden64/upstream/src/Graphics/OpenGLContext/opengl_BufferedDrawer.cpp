@@ -66,6 +66,13 @@ BufferedDrawer::~BufferedDrawer()
 {
 	m_bindBuffer->bind(Parameter(GL_ARRAY_BUFFER), ObjectHandle::null);
 	m_bindBuffer->bind(Parameter(GL_ELEMENT_ARRAY_BUFFER), ObjectHandle::null);
+	Buffer * pBuffers[3] = { &m_rectsBuffers.vbo, &m_trisBuffers.vbo, &m_trisBuffers.ebo };
+	for (Buffer * pBuffer : pBuffers) {
+		for (GLsync & fence : pBuffer->fences) {
+			if (fence != nullptr)
+				glDeleteSync(fence);
+		}
+	}
 	GLuint buffers[3] = { m_rectsBuffers.vbo.handle, m_trisBuffers.vbo.handle, m_trisBuffers.ebo.handle };
 	glDeleteBuffers(3, buffers);
 	glBindVertexArray(0);
@@ -73,6 +80,27 @@ BufferedDrawer::~BufferedDrawer()
 	glDeleteVertexArrays(2, arrays);
 }
 
+void BufferedDrawer::_syncBuffer(Buffer & _buffer, u32 _dataSize)
+{
+	const u32 segmentSize = _buffer.size / m_bufSegments;
+	const u32 lastSegment = static_cast<u32>(_buffer.offset + _dataSize - 1) / segmentSize;
+	while (_buffer.segment != lastSegment) {
+		// Creating the fence flushes recorded calls in threaded mode,
+		// so the fence follows all draws which read this segment.
+		_buffer.fences[_buffer.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		_buffer.segment = (_buffer.segment + 1) % m_bufSegments;
+
+		GLsync & fence = _buffer.fences[_buffer.segment];
+		if (fence == nullptr)
+			continue;
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (glClientWaitSync(fence, flags, 100000000) == GL_TIMEOUT_EXPIRED)
+			flags = 0;
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
+
 void BufferedDrawer::_updateBuffer(Buffer & _buffer, u32 _count, u32 _dataSize, const void * _data)
 {
 	if (_buffer.offset + _dataSize >= _buffer.size) {
@@ -81,6 +109,7 @@ void BufferedDrawer::_updateBuffer(Buffer & _buffer, u32 _count, u32 _dataSize,
 	}
 
 	if (m_glInfo.bufferStorage) {
+		_syncBuffer(_buffer, _dataSize);
 		memcpy(&_buffer.data[_buffer.offset], _data, _dataSize);
 #ifdef GL_DEBUG
 		m_bindBuffer->bind(Parameter(_buffer.type), ObjectHandle(_buffer.handle));
@@ -30,6 +30,8 @@ namespace opengl {
 			triangles
 		};
 
+		static const u32 m_bufSegments = 3;
+
 		struct Buffer {
 			Buffer(GLenum _type) : type(_type) {}
 
@@ -39,6 +41,10 @@ namespace opengl {
 			GLint pos = 0;
 			GLuint size = 0;
 			GLubyte * data = nullptr;
+			// Persistently mapped buffers are split into segments. Before a segment
+			// is written again, the fence set when it was left must be signaled.
+			u32 segment = 0;
+			GLsync fences[m_bufSegments] = {};
 		};
 
 		struct RectBuffers {
@@ -62,6 +68,7 @@ namespace opengl {
 
 		void _initBuffer(Buffer & _buffer, GLuint _bufSize);
 		void _updateBuffer(Buffer & _buffer, u32 _count, u32 _dataSize, const void * _data);
+		void _syncBuffer(Buffer & _buffer, u32 _dataSize);
 		void _convertFromSPVertex(bool _flatColors, u32 _count, const SPVertex * _data);
 
 		const GLInfo & m_glInfo;
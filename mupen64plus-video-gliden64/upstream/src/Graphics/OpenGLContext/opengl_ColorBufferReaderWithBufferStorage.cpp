@@ -31,6 +31,7 @@ void ColorBufferReaderWithBufferStorage::_initBuffers()
 	for (u32 index = 0; index < m_numPBO; ++index) {
 		m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[index]));
 		m_fence[index] = 0;
+		m_rect[index] = ReadRect{ 0, 0, 0 };
 		glBufferStorage(GL_PIXEL_PACK_BUFFER, m_pTexture->textureBytes, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 		m_PBOData[index] = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_pTexture->textureBytes, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 	}
@@ -54,19 +55,17 @@ const u8 * ColorBufferReaderWithBufferStorage::_readPixels(const ReadColorBuffer
 	GLenum format = GLenum(_params.colorFormat);
 	GLenum type = GLenum(_params.colorType);
 
+	_releaseFence(m_curIndex);
+	m_rect[m_curIndex] = ReadRect{ _params.x0, _params.y0, _params.height };
 	m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[m_curIndex]));
 	glReadPixels(_params.x0, _params.y0, m_pTexture->realWidth, _params.height, format, type, 0);
 
+	u32 readIndex = m_curIndex;
 	if (!_params.sync) {
 		//Setup a fence sync object so that we know when glReadPixels completes
 		m_fence[m_curIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		readIndex = _findCompletedBuffer(_params);
 		m_curIndex = (m_curIndex + 1) % m_numPBO;
-		//Wait for glReadPixels to complete for the currently selected PBO
-		if (m_fence[m_curIndex] != 0) {
-			glClientWaitSync(m_fence[m_curIndex], 0, 100000000);
-			glDeleteSync(m_fence[m_curIndex]);
-			m_fence[m_curIndex] = 0;
-		}
 	} else {
 		glFinish();
 	}
@@ -74,7 +73,51 @@ const u8 * ColorBufferReaderWithBufferStorage::_readPixels(const ReadColorBuffer
 	_heightOffset = 0;
 	_stride = m_pTexture->realWidth;
 
-	return reinterpret_cast<u8*>(m_PBOData[m_curIndex]);
+	return reinterpret_cast<u8*>(m_PBOData[readIndex]);
+}
+
+void ColorBufferReaderWithBufferStorage::_releaseFence(u32 _index)
+{
+	if (m_fence[_index] == 0)
+		return;
+	glDeleteSync(m_fence[_index]);
+	m_fence[_index] = 0;
+}
+
+// Up to m_numPBO - 1 readbacks stay in flight, besides the one just issued.
+// Take the newest one which has already completed, so RDRAM gets the most recent frame
+// without stalling on the GPU. Only readbacks of the same area qualify, since the caller
+// writes the pixels to the current buffer's address. If none has completed yet, wait for
+// the oldest one, which bounds the latency to the ring depth. Without any readback of
+// that area, take the oldest buffer like the plain ring does, never the one just issued.
+u32 ColorBufferReaderWithBufferStorage::_findCompletedBuffer(const ReadColorBufferParams& _params)
+{
+	const ReadRect rect{ _params.x0, _params.y0, _params.height };
+	u32 oldest = m_numPBO;
+	u32 completed = m_numPBO;
+	for (u32 age = 1; age < m_numPBO; ++age) {
+		const u32 index = (m_curIndex + m_numPBO - age) % m_numPBO;
+		if (m_fence[index] == 0 || !(m_rect[index] == rect))
+			continue;
+		if (completed == m_numPBO) {
+			if (glClientWaitSync(m_fence[index], 0, 0) != GL_TIMEOUT_EXPIRED)
+				completed = index;
+			else
+				oldest = index;
+		} else {
+			// Superseded by a newer completed readback.
+			_releaseFence(index);
+		}
+	}
+
+	u32 readIndex = completed;
+	if (completed == m_numPBO) {
+		readIndex = oldest != m_numPBO ? oldest : (m_curIndex + 1) % m_numPBO;
+		if (m_fence[readIndex] != 0)
+			while (glClientWaitSync(m_fence[readIndex], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED);
+	}
+	_releaseFence(readIndex);
+	return readIndex;
 }
 
 void ColorBufferReaderWithBufferStorage::cleanUp()
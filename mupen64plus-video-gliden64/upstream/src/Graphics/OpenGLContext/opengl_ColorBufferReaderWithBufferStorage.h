@@ -21,6 +21,17 @@ namespace opengl {
 	private:
 		void _initBuffers();
 		void _destroyBuffers();
+		u32 _findCompletedBuffer(const ReadColorBufferParams& _params);
+		void _releaseFence(u32 _index);
+
+		struct ReadRect {
+			s32 x0;
+			s32 y0;
+			u32 height;
+			bool operator==(const ReadRect & _other) const {
+				return x0 == _other.x0 && y0 == _other.y0 && height == _other.height;
+			}
+		};
 
 		CachedBindBuffer * m_bindBuffer;
 
@@ -30,6 +41,7 @@ namespace opengl {
 		void* m_PBOData[_maxPBO];
 		u32 m_curIndex;
 		GLsync m_fence[_maxPBO];
+		ReadRect m_rect[_maxPBO];
 	};
 
 }
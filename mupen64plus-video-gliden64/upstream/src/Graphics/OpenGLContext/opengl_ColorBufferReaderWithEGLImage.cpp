@@ -47,7 +47,7 @@ const u8 * ColorBufferReaderWithEGLImage::_readPixels(const ReadColorBufferParam
 
 	if (!_params.sync) {
 		m_bindTexture->bind(graphics::Parameter(0), graphics::Parameter(GL_TEXTURE_2D), m_pTexture->name);
-		m_glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, m_image);
+		FunctionWrapper::callSync(m_glEGLImageTargetTexture2DOES, GL_TEXTURE_2D, m_image);
 		m_bindTexture->bind(graphics::Parameter(0), graphics::Parameter(GL_TEXTURE_2D), ObjectHandle());
 
 		m_window.lock(GRALLOC_USAGE_SW_READ_OFTEN, &gpuData);
@@ -0,0 +1,153 @@
+#if defined(EGL) && defined(OS_ANDROID)
+
+#include <dlfcn.h>
+#include <Graphics/Context.h>
+#include <Log.h>
+#include "opengl_ColorBufferReaderWithHardwareBuffer.h"
+
+using namespace opengl;
+using namespace graphics;
+
+typedef int (*PFN_AHardwareBuffer_allocate)(const AHardwareBuffer_Desc* desc, AHardwareBuffer** outBuffer);
+typedef void (*PFN_AHardwareBuffer_release)(AHardwareBuffer* buffer);
+typedef void (*PFN_AHardwareBuffer_describe)(const AHardwareBuffer* buffer, AHardwareBuffer_Desc* outDesc);
+typedef int (*PFN_AHardwareBuffer_lock)(AHardwareBuffer* buffer, uint64_t usage, int32_t fence, const ARect* rect, void** outVirtualAddress);
+typedef int (*PFN_AHardwareBuffer_unlock)(AHardwareBuffer* buffer, int32_t* fence);
+typedef EGLClientBuffer (EGLAPIENTRYP PFN_eglGetNativeClientBufferANDROID)(const struct AHardwareBuffer *buffer);
+typedef void (APIENTRYP PFN_glEGLImageTargetTexture2DOES) (GLenum target, EGLImageKHR image);
+
+namespace {
+	struct HardwareBufferApi
+	{
+		HardwareBufferApi()
+		{
+			void * libandroid = dlopen("libandroid.so", RTLD_NOW);
+			if (libandroid != nullptr) {
+				allocate = (PFN_AHardwareBuffer_allocate)dlsym(libandroid, "AHardwareBuffer_allocate");
+				release = (PFN_AHardwareBuffer_release)dlsym(libandroid, "AHardwareBuffer_release");
+				describe = (PFN_AHardwareBuffer_describe)dlsym(libandroid, "AHardwareBuffer_describe");
+				lock = (PFN_AHardwareBuffer_lock)dlsym(libandroid, "AHardwareBuffer_lock");
+				unlock = (PFN_AHardwareBuffer_unlock)dlsym(libandroid, "AHardwareBuffer_unlock");
+			}
+			getNativeClientBuffer = (PFN_eglGetNativeClientBufferANDROID)eglGetProcAddress("eglGetNativeClientBufferANDROID");
+			imageTargetTexture2D = (PFN_glEGLImageTargetTexture2DOES)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+
+			supported = allocate != nullptr && release != nullptr && describe != nullptr &&
+				lock != nullptr && unlock != nullptr &&
+				getNativeClientBuffer != nullptr && imageTargetTexture2D != nullptr;
+			LOG(LOG_VERBOSE, "AHardwareBuffer color buffer reader is %ssupported\n", supported ? "" : "not ");
+		}
+
+		PFN_AHardwareBuffer_allocate allocate = nullptr;
+		PFN_AHardwareBuffer_release release = nullptr;
+		PFN_AHardwareBuffer_describe describe = nullptr;
+		PFN_AHardwareBuffer_lock lock = nullptr;
+		PFN_AHardwareBuffer_unlock unlock = nullptr;
+		PFN_eglGetNativeClientBufferANDROID getNativeClientBuffer = nullptr;
+		PFN_glEGLImageTargetTexture2DOES imageTargetTexture2D = nullptr;
+		bool supported = false;
+	};
+
+	const HardwareBufferApi & hardwareBufferApi()
+	{
+		static HardwareBufferApi api;
+		return api;
+	}
+}
+
+bool ColorBufferReaderWithHardwareBuffer::isSupported()
+{
+	return hardwareBufferApi().supported;
+}
+
+ColorBufferReaderWithHardwareBuffer::ColorBufferReaderWithHardwareBuffer(CachedTexture *_pTexture, CachedBindTexture *_bindTexture)
+	: graphics::ColorBufferReader(_pTexture)
+	, m_bindTexture(_bindTexture)
+	, m_hardwareBuffer(nullptr)
+	, m_hardwareBufferStride(0)
+	, m_image(EGL_NO_IMAGE_KHR)
+	, m_bufferLocked(false)
+{
+	_initBuffers();
+}
+
+
+ColorBufferReaderWithHardwareBuffer::~ColorBufferReaderWithHardwareBuffer()
+{
+	cleanUp();
+	if (m_image != EGL_NO_IMAGE_KHR)
+		eglDestroyImageKHR(eglGetDisplay(EGL_DEFAULT_DISPLAY), m_image);
+	if (m_hardwareBuffer != nullptr)
+		hardwareBufferApi().release(m_hardwareBuffer);
+}
+
+
+void ColorBufferReaderWithHardwareBuffer::_initBuffers()
+{
+	const HardwareBufferApi & api = hardwareBufferApi();
+
+	AHardwareBuffer_Desc desc = {};
+	desc.width = m_pTexture->realWidth;
+	desc.height = m_pTexture->realHeight;
+	desc.layers = 1;
+	desc.format = AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM;
+	desc.usage = AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN | AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE |
+		AHARDWAREBUFFER_USAGE_GPU_COLOR_OUTPUT;
+	if (api.allocate(&desc, &m_hardwareBuffer) != 0) {
+		LOG(LOG_ERROR, "AHardwareBuffer_allocate failed for %ux%u\n", desc.width, desc.height);
+		m_hardwareBuffer = nullptr;
+		return;
+	}
+
+	// Rows of the buffer may be padded by the allocator
+	api.describe(m_hardwareBuffer, &desc);
+	m_hardwareBufferStride = desc.stride;
+
+	EGLint eglImgAttrs[] = { EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE, EGL_NONE };
+	m_image = eglCreateImageKHR(eglGetDisplay(EGL_DEFAULT_DISPLAY), EGL_NO_CONTEXT,
+		EGL_NATIVE_BUFFER_ANDROID, api.getNativeClientBuffer(m_hardwareBuffer), eglImgAttrs);
+	if (m_image == EGL_NO_IMAGE_KHR)
+		LOG(LOG_ERROR, "eglCreateImageKHR failed for AHardwareBuffer\n");
+}
+
+
+const u8 * ColorBufferReaderWithHardwareBuffer::_readPixels(const ReadColorBufferParams& _params, u32& _heightOffset,
+	u32& _stride)
+{
+	GLenum format = GLenum(_params.colorFormat);
+	GLenum type = GLenum(_params.colorType);
+
+	void* gpuData = nullptr;
+
+	if (!_params.sync && m_image != EGL_NO_IMAGE_KHR) {
+		m_bindTexture->bind(graphics::Parameter(0), graphics::Parameter(GL_TEXTURE_2D), m_pTexture->name);
+		FunctionWrapper::callSync(hardwareBufferApi().imageTargetTexture2D, GL_TEXTURE_2D, m_image);
+		m_bindTexture->bind(graphics::Parameter(0), graphics::Parameter(GL_TEXTURE_2D), ObjectHandle());
+
+		// The buffer is read in place, but rendering into it must be done first
+		glFinish();
+		if (hardwareBufferApi().lock(m_hardwareBuffer, AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN, -1, nullptr, &gpuData) == 0) {
+			m_bufferLocked = true;
+			_heightOffset = static_cast<u32>(_params.y0);
+			_stride = m_hardwareBufferStride;
+			return reinterpret_cast<u8*>(gpuData);
+		}
+	}
+
+	gpuData = m_pixelData.data();
+	glReadPixels(_params.x0, _params.y0, _params.width, _params.height, format, type, gpuData);
+	_heightOffset = 0;
+	_stride = m_pTexture->realWidth;
+
+	return reinterpret_cast<u8*>(gpuData);
+}
+
+void ColorBufferReaderWithHardwareBuffer::cleanUp()
+{
+	if (m_bufferLocked) {
+		hardwareBufferApi().unlock(m_hardwareBuffer, nullptr);
+		m_bufferLocked = false;
+	}
+}
+
+#endif // EGL && OS_ANDROID
@@ -0,0 +1,40 @@
+#pragma once
+#if defined(EGL) && defined(OS_ANDROID)
+#include <Graphics/ColorBufferReader.h>
+#include "opengl_CachedFunctions.h"
+
+#include <android/hardware_buffer.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace opengl {
+
+// Same idea as ColorBufferReaderWithEGLImage, but on the public NDK AHardwareBuffer API (Android 8.0+)
+// instead of private GraphicBuffer symbols. The libandroid functions are looked up at run time since
+// older devices don't have them.
+class ColorBufferReaderWithHardwareBuffer : public graphics::ColorBufferReader
+{
+public:
+	ColorBufferReaderWithHardwareBuffer(CachedTexture * _pTexture,
+										CachedBindTexture * _bindTexture);
+	~ColorBufferReaderWithHardwareBuffer();
+
+	const u8 * _readPixels(const ReadColorBufferParams& _params, u32& _heightOffset, u32& _stride) override;
+
+	void cleanUp() override;
+
+	static bool isSupported();
+
+private:
+	void _initBuffers();
+
+	CachedBindTexture * m_bindTexture;
+	AHardwareBuffer * m_hardwareBuffer;
+	u32 m_hardwareBufferStride;
+	EGLImageKHR m_image;
+	bool m_bufferLocked;
+};
+
+}
+
+#endif // EGL && OS_ANDROID
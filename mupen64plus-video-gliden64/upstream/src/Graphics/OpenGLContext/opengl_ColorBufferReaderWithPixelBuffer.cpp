@@ -22,8 +22,10 @@ void ColorBufferReaderWithPixelBuffer::_destroyBuffers()
 {
 	glDeleteBuffers(m_numPBO, m_PBO);
 
-	for (u32 index = 0; index < m_numPBO; ++index)
+	for (u32 index = 0; index < m_numPBO; ++index) {
 		m_PBO[index] = 0;
+		_releaseFence(index);
+	}
 }
 
 void ColorBufferReaderWithPixelBuffer::_initBuffers()
@@ -40,6 +42,8 @@ void ColorBufferReaderWithPixelBuffer::_initBuffers()
 	for (u32 i = 0; i < m_numPBO; ++i) {
 		m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[i]));
 		glBufferData(GL_PIXEL_PACK_BUFFER, m_pTexture->textureBytes, nullptr, GL_DYNAMIC_READ);
+		m_fence[i] = 0;
+		m_rect[i] = ReadRect{ 0, 0, 0 };
 	}
 	m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle::null);
 }
@@ -50,13 +54,17 @@ const u8 * ColorBufferReaderWithPixelBuffer::_readPixels(const ReadColorBufferPa
 	GLenum format = GLenum(_params.colorFormat);
 	GLenum type = GLenum(_params.colorType);
 
+	_releaseFence(m_curIndex);
+	m_rect[m_curIndex] = ReadRect{ _params.x0, _params.y0, _params.height };
 	m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[m_curIndex]));
 	glReadPixels(_params.x0, _params.y0, m_pTexture->realWidth, _params.height, format, type, 0);
 	// If Sync, read pixels from the buffer, copy them to RDRAM.
-	// If not Sync, read pixels from the buffer, copy pixels from the previous buffer to RDRAM.
+	// If not Sync, read pixels from the buffer, copy pixels from the newest completed buffer to RDRAM.
 	if (!_params.sync) {
+		m_fence[m_curIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		const u32 readIndex = _findCompletedBuffer(_params);
 		m_curIndex = (m_curIndex + 1) % m_numPBO;
-		m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[m_curIndex]));
+		m_bindBuffer->bind(Parameter(GL_PIXEL_PACK_BUFFER), ObjectHandle(m_PBO[readIndex]));
 	}
 
 	_heightOffset = 0;
@@ -66,6 +74,42 @@ const u8 * ColorBufferReaderWithPixelBuffer::_readPixels(const ReadColorBufferPa
 		m_pTexture->realWidth * _params.height * _params.colorFormatBytes, GL_MAP_READ_BIT));
 }
 
+void ColorBufferReaderWithPixelBuffer::_releaseFence(u32 _index)
+{
+	if (m_fence[_index] == 0)
+		return;
+	glDeleteSync(m_fence[_index]);
+	m_fence[_index] = 0;
+}
+
+// See ColorBufferReaderWithBufferStorage::_findCompletedBuffer.
+// Mapping a buffer whose readback has completed does not stall.
+u32 ColorBufferReaderWithPixelBuffer::_findCompletedBuffer(const ReadColorBufferParams& _params)
+{
+	const ReadRect rect{ _params.x0, _params.y0, _params.height };
+	u32 oldest = m_numPBO;
+	u32 completed = m_numPBO;
+	for (u32 age = 1; age < m_numPBO; ++age) {
+		const u32 index = (m_curIndex + m_numPBO - age) % m_numPBO;
+		if (m_fence[index] == 0 || !(m_rect[index] == rect))
+			continue;
+		if (completed == m_numPBO) {
+			if (glClientWaitSync(m_fence[index], 0, 0) != GL_TIMEOUT_EXPIRED)
+				completed = index;
+			else
+				oldest = index;
+		} else {
+			_releaseFence(index);
+		}
+	}
+
+	u32 readIndex = completed;
+	if (completed == m_numPBO)
+		readIndex = oldest != m_numPBO ? oldest : (m_curIndex + 1) % m_numPBO;
+	_releaseFence(readIndex);
+	return readIndex;
+}
+
 void ColorBufferReaderWithPixelBuffer::cleanUp()
 {
 	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
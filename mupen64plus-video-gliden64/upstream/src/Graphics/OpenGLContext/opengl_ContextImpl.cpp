@@ -8,17 +8,28 @@
 #include "opengl_ColorBufferReaderWithPixelBuffer.h"
 #include "opengl_ColorBufferReaderWithBufferStorage.h"
 #include "opengl_ColorBufferReaderWithEGLImage.h"
+#include "opengl_ColorBufferReaderWithHardwareBuffer.h"
 #include "opengl_ColorBufferReaderWithReadPixels.h"
 #include "opengl_Utils.h"
 #include "GLSL/glsl_CombinerProgramBuilder.h"
 #include "GLSL/glsl_SpecialShadersFactory.h"
 #include "GLSL/glsl_ShaderStorage.h"
 
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
 using namespace opengl;
 
 ContextImpl::ContextImpl()
 	: m_clampMode(graphics::ClampMode::ClippingEnabled)
+	, m_timerQueryIdx(0)
+	, m_timerQueriesIssued(0)
+	, m_timerQueryActive(false)
+	, m_gpuTime(-1.0f)
 {
+	for (u32 i = 0; i < TimerQueriesCount; ++i)
+		m_timerQueries[i] = 0;
 	initGLFunctions();
 }
 
@@ -58,13 +69,20 @@ void ContextImpl::init()
 		m_addFramebufferRenderTarget.reset(bufferObjectFactory.getAddFramebufferRenderTarget());
 		m_createPixelReadBuffer.reset(bufferObjectFactory.createPixelReadBuffer());
 		m_blitFramebuffers.reset(bufferObjectFactory.getBlitFramebuffers());
+		m_invalidateFramebuffer.reset(bufferObjectFactory.getInvalidateFramebuffer());
 	}
 
 	{
 		if ((m_glInfo.isGLESX && (m_glInfo.bufferStorage && m_glInfo.majorVersion * 10 + m_glInfo.minorVersion >= 32)) || !m_glInfo.isGLESX)
 			m_graphicsDrawer.reset(new BufferedDrawer(m_glInfo, m_cachedFunctions->getCachedVertexAttribArray(), m_cachedFunctions->getCachedBindBuffer()));
-		else
+		else {
 			m_graphicsDrawer.reset(new UnbufferedDrawer(m_glInfo, m_cachedFunctions->getCachedVertexAttribArray()));
+			// Draws read vertex data from client memory, so they can't be recorded.
+			if (FunctionWrapper::isThreaded()) {
+				FunctionWrapper::setSyncMode(true);
+				LOG(LOG_WARNING, "Threaded OpenGL runs synchronously without buffer storage support\n");
+			}
+		}
 	}
 
 	resetCombinerProgramBuilder();
@@ -76,6 +94,7 @@ void ContextImpl::destroy()
 	m_init2DTexture.reset();
 	m_set2DTextureParameters.reset();
 
+	m_singleSampleAliases.clear();
 	m_createFramebuffer.reset();
 	m_createRenderbuffer.reset();
 	m_initRenderbuffer.reset();
@@ -83,6 +102,16 @@ void ContextImpl::destroy()
 	m_graphicsDrawer.reset();
 	m_combinerProgramBuilder.reset();
 
+	if (m_timerQueries[0] != 0) {
+		glDeleteQueries(TimerQueriesCount, m_timerQueries);
+		for (u32 i = 0; i < TimerQueriesCount; ++i)
+			m_timerQueries[i] = 0;
+	}
+	m_timerQueryIdx = 0;
+	m_timerQueriesIssued = 0;
+	m_timerQueryActive = false;
+	m_gpuTime = -1.0f;
+
 	m_cachedFunctions.reset();
 }
 
@@ -279,6 +308,12 @@ void ContextImpl::textureBarrier()
 		glTextureBarrierNV();
 }
 
+void ContextImpl::dispatchCompute(u32 _numGroupsX, u32 _numGroupsY, u32 _numGroupsZ)
+{
+	glDispatchCompute(_numGroupsX, _numGroupsY, _numGroupsZ);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+}
+
 /*---------------Framebuffer-------------*/
 
 graphics::FramebufferTextureFormats * ContextImpl::getFramebufferTextureFormats()
@@ -296,6 +331,12 @@ void ContextImpl::deleteFramebuffer(graphics::ObjectHandle _name)
 	u32 fbo(_name);
 	if (fbo != 0) {
 		glDeleteFramebuffers(1, &fbo);
+		auto iter = m_singleSampleAliases.find(fbo);
+		if (iter != m_singleSampleAliases.end()) {
+			u32 alias(iter->second);
+			glDeleteFramebuffers(1, &alias);
+			m_singleSampleAliases.erase(iter);
+		}
 		m_cachedFunctions->getCachedBindFramebuffer()->reset();
 	}
 }
@@ -322,12 +363,53 @@ void ContextImpl::initRenderbuffer(const graphics::Context::InitRenderbufferPara
 
 void ContextImpl::addFrameBufferRenderTarget(const graphics::Context::FrameBufferRenderTarget & _params)
 {
-	m_addFramebufferRenderTarget->addFrameBufferRenderTarget(_params);
+	if (!_params.multisampled || m_glInfo.msaaRenderToTexture == 0 ||
+		_params.textureTarget != graphics::textureTarget::TEXTURE_2D) {
+		m_addFramebufferRenderTarget->addFrameBufferRenderTarget(_params);
+		return;
+	}
+
+	CachedBindFramebuffer * bind = m_cachedFunctions->getCachedBindFramebuffer();
+	bind->bind(_params.bufferTarget, _params.bufferHandle);
+	glFramebufferTexture2DMultisampleEXT(GLenum(_params.bufferTarget),
+		GLenum(_params.attachment),
+		GL_TEXTURE_2D,
+		GLuint(_params.textureHandle),
+		0,
+		m_glInfo.msaaRenderToTexture);
+
+	// A framebuffer with multisampled attachments can't be blitted with scaling or from/to
+	// other formats, so blits use an alias with the same textures attached as single sample.
+	graphics::ObjectHandle alias(m_singleSampleAliases[u32(_params.bufferHandle)]);
+	if (alias == graphics::ObjectHandle::null) {
+		alias = createFramebuffer();
+		m_singleSampleAliases[u32(_params.bufferHandle)] = u32(alias);
+	}
+	graphics::Context::FrameBufferRenderTarget aliasParams = _params;
+	aliasParams.bufferHandle = alias;
+	aliasParams.multisampled = false;
+	m_addFramebufferRenderTarget->addFrameBufferRenderTarget(aliasParams);
+	bind->bind(_params.bufferTarget, _params.bufferHandle);
 }
 
 bool ContextImpl::blitFramebuffers(const graphics::Context::BlitFramebuffersParams & _params)
 {
-	return m_blitFramebuffers->blitFramebuffers(_params);
+	if (m_singleSampleAliases.empty())
+		return m_blitFramebuffers->blitFramebuffers(_params);
+
+	graphics::Context::BlitFramebuffersParams params = _params;
+	auto iter = m_singleSampleAliases.find(u32(_params.readBuffer));
+	if (iter != m_singleSampleAliases.end())
+		params.readBuffer = graphics::ObjectHandle(iter->second);
+	iter = m_singleSampleAliases.find(u32(_params.drawBuffer));
+	if (iter != m_singleSampleAliases.end())
+		params.drawBuffer = graphics::ObjectHandle(iter->second);
+	return m_blitFramebuffers->blitFramebuffers(params);
+}
+
+void ContextImpl::invalidateFramebuffer(graphics::ObjectHandle _buffer, graphics::BlitMaskParam _mask)
+{
+	m_invalidateFramebuffer->invalidateFramebuffer(_buffer, _mask);
 }
 
 void ContextImpl::setDrawBuffers(u32 _num)
@@ -352,8 +434,11 @@ graphics::ColorBufferReader * ContextImpl::createColorBufferReader(CachedTexture
 		return new ColorBufferReaderWithPixelBuffer(_pTexture, m_cachedFunctions->getCachedBindBuffer());
 
 #if defined(EGL) && defined(OS_ANDROID)
-	if(config.frameBufferEmulation.copyToRDRAM > Config::ctSync)
+	if(config.frameBufferEmulation.copyToRDRAM > Config::ctSync) {
+		if (ColorBufferReaderWithHardwareBuffer::isSupported())
+			return new ColorBufferReaderWithHardwareBuffer(_pTexture, m_cachedFunctions->getCachedBindTexture());
 		return new ColorBufferReaderWithEGLImage(_pTexture, m_cachedFunctions->getCachedBindTexture());
+	}
 #endif
 
 	return new ColorBufferReaderWithReadPixels(_pTexture);
@@ -417,19 +502,24 @@ graphics::ShaderProgram * ContextImpl::createTexrectCopyShader()
 	return m_specialShadersFactory->createTexrectCopyShader();
 }
 
-graphics::ShaderProgram * ContextImpl::createGammaCorrectionShader()
+graphics::ShaderProgram * ContextImpl::createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection)
 {
-	return m_specialShadersFactory->createGammaCorrectionShader();
+	return m_specialShadersFactory->createPostProcessShader(_gammaCorrection, _orientationCorrection);
 }
 
-graphics::ShaderProgram * ContextImpl::createOrientationCorrectionShader()
+graphics::TextDrawerShaderProgram * ContextImpl::createTextDrawerShader()
 {
-	return m_specialShadersFactory->createOrientationCorrectionShader();
+	return m_specialShadersFactory->createTextDrawerShader();
 }
 
-graphics::TextDrawerShaderProgram * ContextImpl::createTextDrawerShader()
+graphics::RDRAMtoColorBufferShaderProgram * ContextImpl::createRDRAMtoColorBufferShader()
 {
-	return m_specialShadersFactory->createTextDrawerShader();
+	return m_specialShadersFactory->createRDRAMtoColorBufferShader();
+}
+
+graphics::TextureUpscaleShaderProgram * ContextImpl::createTextureUpscaleShader(u32 _scale)
+{
+	return m_specialShadersFactory->createTextureUpscaleShader(_scale);
 }
 
 void ContextImpl::resetShaderProgram()
@@ -460,6 +550,52 @@ f32 ContextImpl::getMaxLineWidth()
 	return lineWidthRange[1];
 }
 
+/*---------------Timer queries-------------*/
+
+void ContextImpl::beginGpuTimer()
+{
+	if (!m_glInfo.timerQuery || m_timerQueryActive)
+		return;
+
+	if (m_timerQueries[0] == 0)
+		glGenQueries(TimerQueriesCount, m_timerQueries);
+
+	const GLuint query = m_timerQueries[m_timerQueryIdx];
+	if (m_timerQueriesIssued == TimerQueriesCount) {
+		// The query was ended TimerQueriesCount timers ago. Don't wait if it is still not ready.
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		GLint disjoint = GL_FALSE;
+		if (available != GL_FALSE && m_glInfo.isGLESX)
+			glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+		if (available != GL_FALSE && disjoint == GL_FALSE) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+			m_gpuTime = f32(elapsed / 1000) / 1000.0f;
+		}
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	m_timerQueryActive = true;
+}
+
+void ContextImpl::endGpuTimer()
+{
+	if (!m_timerQueryActive)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_timerQueryActive = false;
+	m_timerQueryIdx = (m_timerQueryIdx + 1) % TimerQueriesCount;
+	if (m_timerQueriesIssued < TimerQueriesCount)
+		++m_timerQueriesIssued;
+}
+
+f32 ContextImpl::getGpuTime() const
+{
+	return m_gpuTime;
+}
+
 bool ContextImpl::isSupported(graphics::SpecialFeatures _feature) const
 {
 	switch (_feature) {
@@ -483,6 +619,17 @@ bool ContextImpl::isSupported(graphics::SpecialFeatures _feature) const
 		return m_glInfo.ext_fetch;
 	case graphics::SpecialFeatures::TextureBarrier:
 		return m_glInfo.texture_barrier || m_glInfo.texture_barrierNV;
+	case graphics::SpecialFeatures::ETC2Textures:
+		// Desktop GL 4.3 requires ETC2 too, but drivers often decode it in software.
+		return m_glInfo.isGLESX && !m_glInfo.isGLES2;
+	case graphics::SpecialFeatures::ComputeShaders:
+		return m_glInfo.computeShaders;
+	case graphics::SpecialFeatures::GpuTimer:
+		return m_glInfo.timerQuery;
+	case graphics::SpecialFeatures::MultisampledRenderToTexture:
+		return m_glInfo.msaaRenderToTexture != 0;
+	case graphics::SpecialFeatures::ImmutableTextures:
+		return m_glInfo.texStorage;
 	}
 	return false;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <unordered_map>
 #include <Graphics/ContextImpl.h>
 #include "opengl_TextureManipulationObjectFactory.h"
 #include "opengl_BufferManipulationObjectFactory.h"
@@ -78,6 +79,8 @@ namespace opengl {
 
 		void textureBarrier() override;
 
+		void dispatchCompute(u32 _numGroupsX, u32 _numGroupsY, u32 _numGroupsZ) override;
+
 		/*---------------Framebuffer-------------*/
 
 		graphics::FramebufferTextureFormats * getFramebufferTextureFormats() override;
@@ -96,6 +99,8 @@ namespace opengl {
 
 		bool blitFramebuffers(const graphics::Context::BlitFramebuffersParams & _params) override;
 
+		void invalidateFramebuffer(graphics::ObjectHandle _buffer, graphics::BlitMaskParam _mask) override;
+
 		void setDrawBuffers(u32 _num) override;
 
 		/*---------------Pixelbuffer-------------*/
@@ -124,12 +129,14 @@ namespace opengl {
 
 		graphics::ShaderProgram * createTexrectCopyShader() override;
 
-		graphics::ShaderProgram * createGammaCorrectionShader() override;
-
-		graphics::ShaderProgram * createOrientationCorrectionShader() override;
+		graphics::ShaderProgram * createPostProcessShader(bool _gammaCorrection, bool _orientationCorrection) override;
 
 		graphics::TextDrawerShaderProgram * createTextDrawerShader() override;
 
+		graphics::RDRAMtoColorBufferShaderProgram * createRDRAMtoColorBufferShader() override;
+
+		graphics::TextureUpscaleShaderProgram * createTextureUpscaleShader(u32 _scale) override;
+
 		void resetShaderProgram() override;
 
 		void drawTriangles(const graphics::Context::DrawTriangleParameters & _params) override;
@@ -140,6 +147,14 @@ namespace opengl {
 
 		f32 getMaxLineWidth() override;
 
+		/*---------------Timer queries-------------*/
+
+		void beginGpuTimer() override;
+
+		void endGpuTimer() override;
+
+		f32 getGpuTime() const override;
+
 		bool isSupported(graphics::SpecialFeatures _feature) const override;
 
 		bool isError() const override;
@@ -159,6 +174,7 @@ namespace opengl {
 		std::unique_ptr<AddFramebufferRenderTarget> m_addFramebufferRenderTarget;
 		std::unique_ptr<CreatePixelReadBuffer> m_createPixelReadBuffer;
 		std::unique_ptr<BlitFramebuffers> m_blitFramebuffers;
+		std::unique_ptr<InvalidateFramebuffer> m_invalidateFramebuffer;
 		std::unique_ptr<graphics::FramebufferTextureFormats> m_fbTexFormats;
 
 		std::unique_ptr<GraphicsDrawer> m_graphicsDrawer;
@@ -167,6 +183,15 @@ namespace opengl {
 		std::unique_ptr<glsl::SpecialShadersFactory> m_specialShadersFactory;
 		GLInfo m_glInfo;
 		graphics::ClampMode m_clampMode;
+		// Single sample framebuffers blits use instead of the multisampled render to texture ones
+		std::unordered_map<u32, u32> m_singleSampleAliases;
+
+		static const u32 TimerQueriesCount = 4;
+		GLuint m_timerQueries[TimerQueriesCount];
+		u32 m_timerQueryIdx;
+		u32 m_timerQueriesIssued;
+		bool m_timerQueryActive;
+		f32 m_gpuTime;
 	};
 
 }
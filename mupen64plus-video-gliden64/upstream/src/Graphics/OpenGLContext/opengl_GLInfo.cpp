@@ -3,6 +3,7 @@
 #include "opengl_Utils.h"
 #include "opengl_GLInfo.h"
 #include <regex>
+#include <algorithm>
 #ifdef EGL
 #include <EGL/egl.h>
 #endif
@@ -47,12 +48,15 @@ void GLInfo::init() {
 	int numericVersion = majorVersion * 10 + minorVersion;
 	if (isGLES2) {
 		imageTextures = false;
+		computeShaders = false;
 		msaa = false;
 	} else if (isGLESX) {
 		imageTextures = (numericVersion >= 31);
+		computeShaders = (numericVersion >= 31);
 		msaa = numericVersion >= 31;
 	} else {
 		imageTextures = (numericVersion >= 42) || Utils::isExtensionSupported(*this, "GL_ARB_shader_image_load_store");
+		computeShaders = (numericVersion >= 43);
 		msaa = true;
 	}
 
@@ -85,6 +89,13 @@ void GLInfo::init() {
 		}
 	}
 
+	parallelShaderCompile = Utils::isExtensionSupported(*this, "GL_KHR_parallel_shader_compile") ||
+			Utils::isExtensionSupported(*this, "GL_ARB_parallel_shader_compile");
+
+	invalidateFramebuffer = (isGLESX && numericVersion >= 30) || (!isGLESX && numericVersion >= 43) ||
+			Utils::isExtensionSupported(*this, "GL_ARB_invalidate_subdata");
+	const bool ext_discard_framebuffer = isGLES2 && Utils::isExtensionSupported(*this, "GL_EXT_discard_framebuffer");
+
 	bool ext_draw_buffers_indexed = isGLESX && (Utils::isExtensionSupported(*this, "GL_EXT_draw_buffers_indexed") || numericVersion >= 32);
 #ifdef EGL
 	if (isGLESX && bufferStorage)
@@ -98,6 +109,11 @@ void GLInfo::init() {
 			g_glDisablei = nullptr;
 		}
 	}
+	if (ext_discard_framebuffer) {
+		// Same signature and attachment enums as glInvalidateFramebuffer
+		g_glInvalidateFramebuffer = (PFNGLINVALIDATEFRAMEBUFFERPROC) eglGetProcAddress("glDiscardFramebufferEXT");
+		invalidateFramebuffer = g_glInvalidateFramebuffer != nullptr;
+	}
 	if (isGLES2 && shaderStorage) {
 		g_glProgramBinary = (PFNGLPROGRAMBINARYPROC) eglGetProcAddress("glProgramBinaryOES");
 		g_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC) eglGetProcAddress("glGetProgramBinaryOES");
@@ -123,6 +139,10 @@ void GLInfo::init() {
 	fetch_depth = Utils::isExtensionSupported(*this, "GL_ARM_shader_framebuffer_fetch_depth_stencil");
 	texture_barrier = !isGLESX && (numericVersion >= 45 || Utils::isExtensionSupported(*this, "GL_ARB_texture_barrier"));
 	texture_barrierNV = Utils::isExtensionSupported(*this, "GL_NV_texture_barrier");
+	// GLES 3.0 core query objects are needed for the GLES extension
+	timerQuery = isGLESX ? (!isGLES2 && Utils::isExtensionSupported(*this, "GL_EXT_disjoint_timer_query")) :
+		(numericVersion >= 33 || Utils::isExtensionSupported(*this, "GL_ARB_timer_query"));
+	timerQuery = timerQuery && IS_GL_FUNCTION_VALID(glGenQueries) && IS_GL_FUNCTION_VALID(glGetQueryObjectui64v);
 
 	ext_fetch = Utils::isExtensionSupported(*this, "GL_EXT_shader_framebuffer_fetch") && !isGLES2 && (!isGLESX || ext_draw_buffers_indexed) && !imageTextures;
 
@@ -132,4 +152,24 @@ void GLInfo::init() {
 			LOG(LOG_WARNING, "Your GPU does not support the extensions needed for N64 Depth Compare.\n");
 		}
 	}
+
+	// Tile based GPUs resolve on chip when the frame buffer is written to memory, which makes
+	// multisampled textures and resolve blits unnecessary. N64 depth compare needs more color
+	// attachments than the extension allows, so it keeps regular multisampling.
+	msaaRenderToTexture = 0;
+	if (isGLESX && !isGLES2 && config.video.multisampling != 0 && depthTexture &&
+		config.frameBufferEmulation.N64DepthCompare == 0 &&
+		Utils::isExtensionSupported(*this, "GL_EXT_multisampled_render_to_texture") &&
+		IS_GL_FUNCTION_VALID(glFramebufferTexture2DMultisampleEXT)) {
+		GLint maxSamples = 0;
+		glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+		msaaRenderToTexture = std::min(static_cast<GLsizei>(config.video.multisampling), static_cast<GLsizei>(maxSamples));
+		if (msaaRenderToTexture > 1) {
+			// Frame buffers use single sample textures from here on
+			config.video.multisampling = 0;
+			msaa = false;
+			LOG(LOG_VERBOSE, "Multisampling with GL_EXT_multisampled_render_to_texture, %d samples\n", msaaRenderToTexture);
+		} else
+			msaaRenderToTexture = 0;
+	}
 }
@@ -20,19 +20,25 @@ struct GLInfo {
 	bool isGLES2 = false;
 	bool isGLESX = false;
 	bool imageTextures = false;
+	bool computeShaders = false;
 	bool bufferStorage = false;
 	bool texStorage    = false;
 	bool shaderStorage = false;
+	bool parallelShaderCompile = false;
 	bool msaa = false;
 	bool depthTexture = false;
 	bool noPerspective = false;
 	bool fetch_depth = false;
 	bool texture_barrier = false;
 	bool texture_barrierNV = false;
+	bool timerQuery = false;
 	bool fragment_interlock = false;
 	bool fragment_interlockNV = false;
 	bool fragment_ordering = false;
 	bool ext_fetch = false;
+	bool invalidateFramebuffer = false;
+	// Samples of multisampling done with GL_EXT_multisampled_render_to_texture, 0 if not used
+	GLsizei msaaRenderToTexture = 0;
 	Renderer renderer = Renderer::Other;
 
 	void init();
@@ -24,6 +24,8 @@ namespace graphics {
 		InternalColorFormatParam RG32F(GL_RG32F);
 		InternalColorFormatParam LUMINANCE(0x1909);
 		InternalColorFormatParam COLOR_INDEX8(0x80E5);
+		InternalColorFormatParam COMPRESSED_RGB8_ETC2(GL_COMPRESSED_RGB8_ETC2);
+		InternalColorFormatParam COMPRESSED_RGBA8_ETC2_EAC(GL_COMPRESSED_RGBA8_ETC2_EAC);
 	}
 
 	namespace datatype {
@@ -70,14 +72,15 @@ namespace graphics {
 		TextureUnitParam Tex[2] = { 0U, 1U };
 		TextureUnitParam NoiseTex(2U);
 		TextureUnitParam DepthTex(3U);
-		TextureUnitParam ZLUTTex(4U);
 		TextureUnitParam PaletteTex(5U);
 		TextureUnitParam MSTex[2] = { 6U, 7U };
+		TextureUnitParam TMEMTex(8U);
 	}
 
 	namespace textureImageUnits {
 		ImageUnitParam DepthZ(2U);
 		ImageUnitParam DepthDeltaZ(3U);
+		ImageUnitParam TexUpscale(0U);
 	}
 
 	namespace textureImageAccessMode {
@@ -59,15 +59,26 @@ namespace opengl {
 		{
 			if (_params.msaaLevel == 0) {
 				m_bind->bind(_params.textureUnitIndex, graphics::textureTarget::TEXTURE_2D, _params.handle);
-				glTexImage2D(GL_TEXTURE_2D,
-							 _params.mipMapLevel,
-							 GLuint(_params.internalFormat),
-							 _params.width,
-							 _params.height,
-							 0,
-							 GLenum(_params.format),
-							 GLenum(_params.dataType),
-							 _params.data);
+				if (_params.dataSize != 0) {
+					glCompressedTexImage2D(GL_TEXTURE_2D,
+										   _params.mipMapLevel,
+										   GLenum(_params.internalFormat),
+										   _params.width,
+										   _params.height,
+										   0,
+										   _params.dataSize,
+										   _params.data);
+				} else {
+					glTexImage2D(GL_TEXTURE_2D,
+								 _params.mipMapLevel,
+								 GLuint(_params.internalFormat),
+								 _params.width,
+								 _params.height,
+								 0,
+								 GLenum(_params.format),
+								 GLenum(_params.dataType),
+								 _params.data);
+				}
 			} else {
 				m_bind->bind(_params.textureUnitIndex, graphics::textureTarget::TEXTURE_2D_MULTISAMPLE, _params.handle);
 				glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE,
@@ -114,7 +125,16 @@ namespace opengl {
 								   _params.height);
 				}
 
-				if (_params.data != nullptr) {
+				if (_params.data != nullptr && _params.dataSize != 0) {
+					glCompressedTexSubImage2D(GL_TEXTURE_2D,
+						_params.mipMapLevel,
+						0, 0,
+						_params.width,
+						_params.height,
+						GLenum(_params.internalFormat),
+						_params.dataSize,
+						_params.data);
+				} else if (_params.data != nullptr) {
 					glTexSubImage2D(GL_TEXTURE_2D,
 						_params.mipMapLevel,
 						0, 0,
@@ -173,7 +193,16 @@ namespace opengl {
 								   _params.height);
 				}
 
-				if (_params.data != nullptr) {
+				if (_params.data != nullptr && _params.dataSize != 0) {
+					glCompressedTextureSubImage2D(GLuint(_params.handle),
+						_params.mipMapLevel,
+						0, 0,
+						_params.width,
+						_params.height,
+						GLenum(_params.internalFormat),
+						_params.dataSize,
+						_params.data);
+				} else if (_params.data != nullptr) {
 					glTextureSubImage2D(GLuint(_params.handle),
 						_params.mipMapLevel,
 						0, 0,
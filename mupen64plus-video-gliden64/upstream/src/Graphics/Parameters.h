@@ -24,6 +24,8 @@ namespace graphics {
 		extern InternalColorFormatParam RG32F;
 		extern InternalColorFormatParam LUMINANCE;
 		extern InternalColorFormatParam COLOR_INDEX8;
+		extern InternalColorFormatParam COMPRESSED_RGB8_ETC2;
+		extern InternalColorFormatParam COMPRESSED_RGBA8_ETC2_EAC;
 	}
 
 	namespace datatype {
@@ -70,14 +72,15 @@ namespace graphics {
 		extern TextureUnitParam Tex[2];
 		extern TextureUnitParam NoiseTex;
 		extern TextureUnitParam DepthTex;
-		extern TextureUnitParam ZLUTTex;
 		extern TextureUnitParam PaletteTex;
 		extern TextureUnitParam MSTex[2];
+		extern TextureUnitParam TMEMTex;
 	}
 
 	namespace textureImageUnits {
 		extern ImageUnitParam DepthZ;
 		extern ImageUnitParam DepthDeltaZ;
+		extern ImageUnitParam TexUpscale;
 	}
 
 	namespace textureImageAccessMode {
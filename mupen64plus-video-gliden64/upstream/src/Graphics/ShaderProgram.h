@@ -17,6 +17,8 @@ namespace graphics {
 		virtual bool usesLOD() const override {return false;}
 		virtual bool usesHwLighting() const override {return false;}
 		virtual bool getBinaryForm(std::vector<char> & _buffer) override {return false;}
+		bool isReady() override {return true;}
+		u32 getUsageCount() const override {return 0;}
 	};
 
 	class TexrectDrawerShaderProgram : public ShaderProgram
@@ -31,4 +33,16 @@ namespace graphics {
 	public:
 		virtual void setTextColor(float * _color) = 0;
 	};
+
+	class RDRAMtoColorBufferShaderProgram : public ShaderProgram
+	{
+	public:
+		virtual void setImageParams(u32 _width, u32 _height, u32 _size, bool _useAlpha) = 0;
+	};
+
+	class TextureUpscaleShaderProgram : public ShaderProgram
+	{
+	public:
+		virtual void setImageParams(u32 _width, u32 _height, u32 _textureUnit) = 0;
+	};
 }
@@ -10,10 +10,11 @@
 #include "GraphicsDrawer.h"
 #include "Performance.h"
 #include "TextureFilterHandler.h"
+#include "TextureUpscaler.h"
 #include "PostProcessor.h"
 #include "NoiseTexture.h"
-#include "ZlutTexture.h"
 #include "PaletteTexture.h"
+#include "TMEMTexture.h"
 #include "TextDrawer.h"
 #include "FrameBuffer.h"
 #include "DepthBuffer.h"
@@ -32,6 +33,7 @@ GraphicsDrawer::GraphicsDrawer()
 , m_modifyVertices(0)
 , m_maxLineWidth(1.0f)
 , m_bFlatColors(false)
+, m_bDeferTexrects(false)
 {
 	memset(m_rect, 0, sizeof(m_rect));
 }
@@ -608,6 +610,8 @@ void GraphicsDrawer::_updateTextures() const
 	//For some reason updating the texture cache on the first frame of LOZ:OOT causes a nullptr Pointer exception...
 	CombinerInfo & cmbInfo = CombinerInfo::get();
 	CombinerProgram * pCurrentCombiner = cmbInfo.getCurrent();
+	if ((gDP.changed & CHANGED_TMEM) != 0)
+		g_tmemTexture.invalidate();
 	if (pCurrentCombiner != nullptr) {
 		for (u32 t = 0; t < 2; ++t) {
 			if (pCurrentCombiner->usesTile(t))
@@ -721,31 +725,76 @@ bool GraphicsDrawer::_canDraw() const
 	return config.frameBufferEmulation.enable == 0 || frameBufferList().getCurrent() != nullptr;
 }
 
-void GraphicsDrawer::drawTriangles()
+void GraphicsDrawer::flushTriangles()
 {
-	if (triangles.num == 0 || !_canDraw()) {
-		triangles.num = 0;
-		triangles.maxElement = 0;
+	if (m_deferredTriangles.elements.empty())
 		return;
-	}
-
-	_prepareDrawTriangle();
 
 	Context::DrawTriangleParameters triParams;
 	triParams.mode = drawmode::TRIANGLES;
-	triParams.flatColors = m_bFlatColors;
+	triParams.flatColors = m_deferredTriangles.flatColors;
 	triParams.elementsType = datatype::UNSIGNED_BYTE;
-	triParams.verticesCount = static_cast<u32>(triangles.maxElement) + 1;
-	triParams.elementsCount = triangles.num;
-	triParams.vertices = triangles.vertices.data();
-	triParams.elements = triangles.elements.data();
+	triParams.verticesCount = static_cast<u32>(m_deferredTriangles.vertices.size());
+	triParams.elementsCount = static_cast<u32>(m_deferredTriangles.elements.size());
+	triParams.vertices = m_deferredTriangles.vertices.data();
+	triParams.elements = m_deferredTriangles.elements.data();
 	triParams.combiner = currentCombiner();
 	gfxContext.drawTriangles(triParams);
 	g_debugger.addTriangles(triParams);
+	perf.addDrawCall(triParams.elementsCount / 3);
+
+	m_deferredTriangles.vertices.clear();
+	m_deferredTriangles.elements.clear();
+}
+
+void GraphicsDrawer::drawTriangles(bool _defer)
+{
+	if (triangles.num == 0 || !_canDraw()) {
+		triangles.num = 0;
+		triangles.maxElement = 0;
+		if (!_defer)
+			flushTriangles();
+		return;
+	}
+
+	const u32 verticesCount = static_cast<u32>(triangles.maxElement) + 1;
+
+	// Screen space vertices change the viewport, which deferred triangles must not see.
+	const bool modifyXY = (m_modifyVertices & MODIFY_XY) != 0;
+	if (modifyXY ||
+		m_deferredTriangles.vertices.size() + verticesCount > VERTBUFF_SIZE * 16 ||
+		m_deferredTriangles.elements.size() + triangles.num > ELEMBUFF_SIZE * 16)
+		flushTriangles();
+
+	_prepareDrawTriangle();
+
+	if (!modifyXY && (_defer || !m_deferredTriangles.elements.empty())) {
+		const u16 base = static_cast<u16>(m_deferredTriangles.vertices.size());
+		m_deferredTriangles.vertices.insert(m_deferredTriangles.vertices.end(),
+			triangles.vertices.begin(), triangles.vertices.begin() + verticesCount);
+		for (u32 i = 0; i < triangles.num; ++i)
+			m_deferredTriangles.elements.push_back(base + triangles.elements[i]);
+		m_deferredTriangles.flatColors = m_bFlatColors;
+		if (!_defer)
+			flushTriangles();
+	} else {
+		Context::DrawTriangleParameters triParams;
+		triParams.mode = drawmode::TRIANGLES;
+		triParams.flatColors = m_bFlatColors;
+		triParams.elementsType = datatype::UNSIGNED_BYTE;
+		triParams.verticesCount = verticesCount;
+		triParams.elementsCount = triangles.num;
+		triParams.vertices = triangles.vertices.data();
+		triParams.elements = triangles.elements.data();
+		triParams.combiner = currentCombiner();
+		gfxContext.drawTriangles(triParams);
+		g_debugger.addTriangles(triParams);
+		perf.addDrawCall(triParams.elementsCount / 3);
+	}
 
 	if (config.frameBufferEmulation.enable != 0) {
 		const f32 maxY = renderTriangles(triangles.vertices.data(), triangles.elements.data(), triangles.num);
-		frameBufferList().setBufferChanged(maxY);
+		frameBufferList().setBufferChanged(gDP.scissor.uly, maxY);
 		if (config.frameBufferEmulation.copyDepthToRDRAM == Config::cdSoftwareRender &&
 			gDP.otherMode.depthUpdate != 0) {
 			FrameBuffer * pCurrentDepthBuffer = frameBufferList().findBuffer(gDP.depthImageAddress);
@@ -760,6 +809,7 @@ void GraphicsDrawer::drawTriangles()
 
 void GraphicsDrawer::drawScreenSpaceTriangle(u32 _numVtx)
 {
+	flushTriangles();
 	if (_numVtx == 0 || !_canDraw())
 		return;
 
@@ -783,13 +833,15 @@ void GraphicsDrawer::drawScreenSpaceTriangle(u32 _numVtx)
 	triParams.combiner = currentCombiner();
 	gfxContext.drawTriangles(triParams);
 	g_debugger.addTriangles(triParams);
+	perf.addDrawCall(_numVtx - 2);
 
-	frameBufferList().setBufferChanged(maxY);
+	frameBufferList().setBufferChanged(gDP.scissor.uly, maxY);
 	gSP.changed |= CHANGED_GEOMETRYMODE;
 }
 
 void GraphicsDrawer::drawDMATriangles(u32 _numVtx)
 {
+	flushTriangles();
 	if (_numVtx == 0 || !_canDraw())
 		return;
 	_prepareDrawTriangle();
@@ -803,11 +855,12 @@ void GraphicsDrawer::drawDMATriangles(u32 _numVtx)
 	triParams.combiner = currentCombiner();
 	gfxContext.drawTriangles(triParams);
 	g_debugger.addTriangles(triParams);
+	perf.addDrawCall(_numVtx / 3);
 	m_dmaVerticesNum = 0;
 
 	if (config.frameBufferEmulation.enable != 0) {
 		const f32 maxY = renderTriangles(m_dmaVertices.data(), nullptr, _numVtx);
-		frameBufferList().setBufferChanged(maxY);
+		frameBufferList().setBufferChanged(gDP.scissor.uly, maxY);
 		if (config.frameBufferEmulation.copyDepthToRDRAM == Config::cdSoftwareRender &&
 			gDP.otherMode.depthUpdate != 0) {
 			FrameBuffer * pCurrentDepthBuffer = frameBufferList().findBuffer(gDP.depthImageAddress);
@@ -897,6 +950,7 @@ void GraphicsDrawer::_drawThickLine(int _v0, int _v1, float _width)
 
 void GraphicsDrawer::drawLine(int _v0, int _v1, float _width)
 {
+	flushTriangles();
 	m_texrectDrawer.draw();
 
 	if (!_canDraw())
@@ -924,10 +978,16 @@ void GraphicsDrawer::drawLine(int _v0, int _v1, float _width)
 
 	SPVertex vertexBuf[2] = { triangles.vertices[_v0], triangles.vertices[_v1] };
 	gfxContext.drawLine(lineWidth, vertexBuf);
+	perf.addDrawCall(0);
+
+	FrameBuffer * pCurrentBuffer = frameBufferList().getCurrent();
+	if (pCurrentBuffer != nullptr)
+		pCurrentBuffer->setDirtyRows(u32(gDP.scissor.uly), u32(ceilf(gDP.scissor.lry)));
 }
 
 void GraphicsDrawer::drawRect(int _ulx, int _uly, int _lrx, int _lry)
 {
+	flushTriangles();
 	m_texrectDrawer.draw();
 
 	if (!_canDraw())
@@ -980,6 +1040,7 @@ void GraphicsDrawer::drawRect(int _ulx, int _uly, int _lrx, int _lry)
 	rectParams.combiner = currentCombiner();
 	gfxContext.drawRects(rectParams);
 	g_debugger.addRects(rectParams);
+	perf.addDrawCall(2);
 	gSP.changed |= CHANGED_GEOMETRYMODE | CHANGED_VIEWPORT;
 }
 
@@ -1123,8 +1184,69 @@ bool texturedRectPaletteMod(const GraphicsDrawer::TexturedRectParams & _params)
 // Return true if actuial rendering is not necessary
 bool(*texturedRectSpecial)(const GraphicsDrawer::TexturedRectParams & _params) = nullptr;
 
+// Limit of texrects drawn in one deferred batch
+static const size_t MaxDeferredTexrects = 1024;
+
+void GraphicsDrawer::flushTexrects()
+{
+	if (m_deferredTexrects.vertices.empty())
+		return;
+
+	Context::DrawRectParameters rectParams;
+	rectParams.mode = drawmode::TRIANGLES;
+	rectParams.verticesCount = static_cast<u32>(m_deferredTexrects.vertices.size());
+	rectParams.vertices = m_deferredTexrects.vertices.data();
+	rectParams.combiner = currentCombiner();
+	gfxContext.drawRects(rectParams);
+	perf.addDrawCall(rectParams.verticesCount / 3);
+
+	m_deferredTexrects.vertices.clear();
+}
+
+// Apply clamp wrap modes of texrect tiles. Bit 0/1 of _clampMask is S/T of tile 0, bit 2/3 is S/T of tile 1.
+// Return true if the combiner must update TMEM wrap uniforms.
+bool GraphicsDrawer::_setTexrectWrapModes(u32 _clampMask)
+{
+	CombinerProgram * pCurrentCombiner = currentCombiner();
+	TextureCache & cache = textureCache();
+	bool bUpdateTMEMWrap = false;
+	for (u32 t = 0; t < 2; ++t) {
+		if (!pCurrentCombiner->usesTile(t) || cache.current[t] == nullptr || gSP.textureTile[t] == nullptr ||
+			cache.current[t]->frameBufferTexture == CachedTexture::fbMultiSample)
+			continue;
+
+		Context::TexParameters texParams;
+		if ((_clampMask & (1U << (t * 2))) != 0)
+			texParams.wrapS = textureParameters::WRAP_CLAMP_TO_EDGE;
+		if ((_clampMask & (2U << (t * 2))) != 0)
+			texParams.wrapT = textureParameters::WRAP_CLAMP_TO_EDGE;
+
+		if (cache.current[t]->tmemFormat != CachedTexture::tmemNone) {
+			// Wrap mode of tiles read from TMEM is a shader uniform
+			if (texParams.wrapS.isValid())
+				cache.current[t]->tmemWrapS = TMEMTexture::wrapClamp;
+			if (texParams.wrapT.isValid())
+				cache.current[t]->tmemWrapT = TMEMTexture::wrapClamp;
+			bUpdateTMEMWrap = bUpdateTMEMWrap || texParams.wrapS.isValid() || texParams.wrapT.isValid();
+		} else if (texParams.wrapS.isValid() || texParams.wrapT.isValid()) {
+			texParams.handle = cache.current[t]->name;
+			texParams.target = textureTarget::TEXTURE_2D;
+			texParams.textureUnitIndex = textureIndices::Tex[t];
+			gfxContext.setTextureParameters(texParams);
+		}
+	}
+	return bUpdateTMEMWrap;
+}
+
 void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 {
+	flushTriangles();
+	if (hasDeferredTexrects() &&
+		(!m_bDeferTexrects || !_params.texrectCmd || texturedRectSpecial != nullptr ||
+		_params.pBuffer != m_deferredTexrects.pBuffer ||
+		gSP.textureTile[0] != m_deferredTexrects.textureTile[0] ||
+		gSP.textureTile[1] != m_deferredTexrects.textureTile[1]))
+		flushTexrects();
 	gSP.changed &= ~CHANGED_GEOMETRYMODE; // Don't update cull mode
 	m_drawingState = DrawingState::TexRect;
 
@@ -1205,6 +1327,7 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 		offsetY = (_params.lry - _params.uly) * _params.dtdy;
 	}
 
+	u32 clampMask = 0;
 	for (u32 t = 0; t < 2; ++t) {
 		if (pCurrentCombiner->usesTile(t) && cache.current[t] && gSP.textureTile[t]) {
 			f32 shiftScaleS = 1.0f;
@@ -1258,27 +1381,18 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 			}
 
 			if (cache.current[t]->frameBufferTexture != CachedTexture::fbMultiSample) {
-				Context::TexParameters texParams;
-
 				if ((cache.current[t]->mirrorS == 0 && cache.current[t]->maskS == 0 &&
 					(texST[t].s0 < texST[t].s1 ?
 					texST[t].s0 >= 0.0 && texST[t].s1 <= (float)cache.current[t]->width :
 					texST[t].s1 >= 0.0 && texST[t].s0 <= (float)cache.current[t]->width))
 					|| (cache.current[t]->maskS == 0 && (texST[t].s0 < -1024.0f || texST[t].s1 > 1023.99f)))
-					texParams.wrapS = textureParameters::WRAP_CLAMP_TO_EDGE;
+					clampMask |= 1U << (t * 2);
 
 				if (cache.current[t]->mirrorT == 0 &&
 					(texST[t].t0 < texST[t].t1 ?
 					texST[t].t0 >= 0.0f && texST[t].t1 <= (float)cache.current[t]->height :
 					texST[t].t1 >= 0.0f && texST[t].t0 <= (float)cache.current[t]->height))
-					texParams.wrapT = textureParameters::WRAP_CLAMP_TO_EDGE;
-
-				if (texParams.wrapS.isValid() || texParams.wrapT.isValid()) {
-					texParams.handle = cache.current[t]->name;
-					texParams.target = textureTarget::TEXTURE_2D;
-					texParams.textureUnitIndex = textureIndices::Tex[t];
-					gfxContext.setTextureParameters(texParams);
-				}
+					clampMask |= 2U << (t * 2);
 			}
 
 			texST[t].s0 *= cache.current[t]->scaleS;
@@ -1288,7 +1402,19 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 		}
 	}
 
-	if (gDP.otherMode.cycleType == G_CYC_COPY && cache.current[0]->frameBufferTexture != CachedTexture::fbMultiSample) {
+	if (hasDeferredTexrects() && clampMask != m_deferredTexrects.clampMask) {
+		// The deferred texrects need their own wrap modes. Draw them and restore texture states for this one.
+		if (_setTexrectWrapModes(m_deferredTexrects.clampMask))
+			pCurrentCombiner->update(false);
+		flushTexrects();
+		_updateTextures();
+	}
+
+	if (_setTexrectWrapModes(clampMask))
+		pCurrentCombiner->update(false);
+
+	if (gDP.otherMode.cycleType == G_CYC_COPY && cache.current[0]->frameBufferTexture != CachedTexture::fbMultiSample &&
+		cache.current[0]->tmemFormat == CachedTexture::tmemNone) {
 		Context::TexParameters texParams;
 		texParams.handle = cache.current[0]->name;
 		texParams.target = textureTarget::TEXTURE_2D;
@@ -1339,9 +1465,38 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 			m_rect[i].x *= scale;
 	}
 
+	// Consecutive texrects with the same states are drawn as triangles in one call
+	const bool bDeferTexrect = m_bDeferTexrects
+		&& _params.texrectCmd
+		&& !bUseTexrectDrawer
+		&& texturedRectSpecial == nullptr
+		&& !g_debugger.isCaptureMode()
+		&& gDP.colorImage.address != gDP.depthImageAddress
+		&& (cache.current[0] == nullptr || cache.current[0]->frameBufferTexture == CachedTexture::fbNone)
+		&& (cache.current[1] == nullptr || cache.current[1]->frameBufferTexture == CachedTexture::fbNone);
+
+	if (!bDeferTexrect)
+		flushTexrects();
+
 	if (bUseTexrectDrawer)
 		m_texrectDrawer.add();
-	else {
+	else if (bDeferTexrect) {
+		if (m_deferredTexrects.vertices.size() >= MaxDeferredTexrects * 6)
+			flushTexrects();
+		_updateScreenCoordsViewport();
+
+		if (m_deferredTexrects.vertices.empty()) {
+			m_deferredTexrects.pBuffer = _params.pBuffer;
+			m_deferredTexrects.textureTile[0] = gSP.textureTile[0];
+			m_deferredTexrects.textureTile[1] = gSP.textureTile[1];
+			m_deferredTexrects.clampMask = clampMask;
+		}
+		static const u32 indices[6] = { 0, 1, 2, 2, 1, 3 };
+		for (u32 i : indices)
+			m_deferredTexrects.vertices.push_back(m_rect[i]);
+
+		gSP.changed |= CHANGED_GEOMETRYMODE | CHANGED_VIEWPORT;
+	} else {
 		_updateScreenCoordsViewport();
 
 		Context::DrawRectParameters rectParams;
@@ -1350,6 +1505,7 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 		rectParams.vertices = m_rect;
 		rectParams.combiner = currentCombiner();
 		gfxContext.drawRects(rectParams);
+		perf.addDrawCall(2);
 		if (g_debugger.isCaptureMode()) {
 			m_rect[0].x = _params.ulx;
 			m_rect[0].y = _params.uly;
@@ -1427,7 +1583,8 @@ void GraphicsDrawer::drawOSD()
 		config.onScreenDisplay.vis |
 		config.onScreenDisplay.percent |
 		config.onScreenDisplay.internalResolution |
-		config.onScreenDisplay.renderingResolution
+		config.onScreenDisplay.renderingResolution |
+		config.onScreenDisplay.statistics
 		) == 0 &&
 		m_osdMessages.empty())
 		return;
@@ -1459,7 +1616,7 @@ void GraphicsDrawer::drawOSD()
 	vShift *= 0.5f;
 	const float x = hp - hShift * hp;
 	float y = vp - vShift * vp;
-	char buf[40];
+	char buf[64];
 
 	if (config.onScreenDisplay.fps) {
 		sprintf(buf, "%d FPS", int(perf.getFps()));
@@ -1476,6 +1633,21 @@ void GraphicsDrawer::drawOSD()
 		_drawOSD(buf, x, y);
 	}
 
+	if (config.onScreenDisplay.statistics) {
+		const Performance::FrameStatistics & stats = perf.getFrameStatistics();
+		if (stats.gpuTime >= 0.0f)
+			sprintf(buf, "Frame %.1f ms, GPU %.1f ms", stats.frameTime, stats.gpuTime);
+		else
+			sprintf(buf, "Frame %.1f ms", stats.frameTime);
+		_drawOSD(buf, x, y);
+		sprintf(buf, "%u draw calls, %u triangles", stats.drawCalls, stats.triangles);
+		_drawOSD(buf, x, y);
+		sprintf(buf, "%u texture uploads, %u KB", stats.textureUploads, stats.textureBytes >> 10);
+		_drawOSD(buf, x, y);
+		sprintf(buf, "%u shader compiles, %u FB copies", stats.shaderCompiles, stats.fbCopies);
+		_drawOSD(buf, x, y);
+	}
+
 	if (config.onScreenDisplay.renderingResolution) {
 		FrameBuffer * pBuffer = frameBufferList().getCurrent();
 		if (pBuffer != nullptr && VI.width != 0) {
@@ -1611,7 +1783,7 @@ void GraphicsDrawer::copyTexturedRect(const CopyRectParams & _params)
 
 	gfxContext.setViewport(0, 0, _params.dstWidth, _params.dstHeight);
 	gfxContext.enable(enable::CULL_FACE, false);
-	gfxContext.enable(enable::BLEND, false);
+	gfxContext.enable(enable::BLEND, _params.blend);
 	gfxContext.enable(enable::DEPTH_TEST, false);
 	gfxContext.enableDepthWrite(false);
 
@@ -1624,6 +1796,7 @@ void GraphicsDrawer::copyTexturedRect(const CopyRectParams & _params)
 	gfxContext.enable(enable::SCISSOR_TEST, false);
 	gfxContext.drawRects(rectParams);
 	gfxContext.enable(enable::SCISSOR_TEST, true);
+	perf.addDrawCall(2);
 
 	gSP.changed |= CHANGED_GEOMETRYMODE | CHANGED_VIEWPORT;
 	gDP.changed |= CHANGED_RENDERMODE | CHANGED_TILE | CHANGED_COMBINE;
@@ -1713,10 +1886,10 @@ void GraphicsDrawer::_initData()
 	FrameBuffer_Init();
 	Combiner_Init();
 	TFH.init();
-	PostProcessor::get().init();
-	g_zlutTexture.init();
+	g_textureUpscaler.init();
 	g_noiseTexture.init();
 	g_paletteTexture.init();
+	g_tmemTexture.init();
 	perf.reset();
 	FBInfo::fbInfo.reset();
 	m_texrectDrawer.init();
@@ -1730,6 +1903,9 @@ void GraphicsDrawer::_initData()
 	for (auto vtx : triangles.vertices)
 		vtx.w = 1.0f;
 	triangles.num = 0;
+	m_deferredTriangles.vertices.clear();
+	m_deferredTriangles.elements.clear();
+	m_deferredTexrects.vertices.clear();
 	m_dmaVerticesNum = 0;
 }
 
@@ -1737,10 +1913,11 @@ void GraphicsDrawer::_destroyData()
 {
 	m_drawingState = DrawingState::Non;
 	m_texrectDrawer.destroy();
+	g_tmemTexture.destroy();
 	g_paletteTexture.destroy();
-	g_zlutTexture.destroy();
 	g_noiseTexture.destroy();
 	PostProcessor::get().destroy();
+	g_textureUpscaler.destroy();
 	if (TFH.optionsChanged())
 		TFH.shutdown();
 	Combiner_Destroy();
@@ -1748,4 +1925,5 @@ void GraphicsDrawer::_destroyData()
 	DepthBuffer_Destroy();
 	g_textDrawer.destroy();
 	textureCache().destroy();
+	perf.destroy();
 }
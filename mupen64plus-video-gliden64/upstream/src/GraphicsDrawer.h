@@ -42,7 +42,13 @@ class GraphicsDrawer
 public:
 	void addTriangle(int _v0, int _v1, int _v2);
 
-	void drawTriangles();
+	// With _defer set, the triangles may be kept and drawn with the next batch in one call.
+	// Only valid if nothing but vertex loads and triangle commands come before that batch.
+	void drawTriangles(bool _defer = false);
+
+	void flushTriangles();
+
+	bool hasDeferredTriangles() const { return !m_deferredTriangles.elements.empty(); }
 
 	void drawScreenSpaceTriangle(u32 _numVtx);
 
@@ -82,6 +88,14 @@ public:
 
 	void drawTexturedRect(const TexturedRectParams & _params);
 
+	// With deferring on, texrects sharing tiles, wrap modes and buffer are kept and drawn in one call.
+	// Only valid while nothing but texrect commands are executed until flushTexrects().
+	void setDeferTexrects(bool _defer) { m_bDeferTexrects = _defer; }
+
+	void flushTexrects();
+
+	bool hasDeferredTexrects() const { return !m_deferredTexrects.vertices.empty(); }
+
 	struct CopyRectParams
 	{
 		s32 srcX0 = 0;
@@ -102,6 +116,7 @@ public:
 		Textures tex = Textures{ { nullptr, nullptr } };
 		graphics::CombinerProgram * combiner = nullptr;
 		graphics::TextureParam filter;
+		bool blend = false; // keeps the blend function set by the caller
 	};
 
 	void copyTexturedRect(const CopyRectParams & _params);
@@ -177,6 +192,7 @@ private:
 	void _updateDepthCompare() const;
 	void _updateTextures() const;
 	void _updateStates(DrawingState _drawingState) const;
+	bool _setTexrectWrapModes(u32 _clampMask);
 	void _prepareDrawTriangle();
 	bool _canDraw() const;
 	void _drawThickLine(int _v0, int _v1, float _width);
@@ -196,6 +212,19 @@ private:
 		int maxElement = 0;
 	} triangles;
 
+	struct {
+		std::vector<SPVertex> vertices;
+		std::vector<u16> elements;
+		bool flatColors = false;
+	} m_deferredTriangles;
+
+	struct {
+		std::vector<RectVertex> vertices;
+		const FrameBuffer * pBuffer = nullptr;
+		const gDPTile * textureTile[2] = { nullptr, nullptr };
+		u32 clampMask = 0;
+	} m_deferredTexrects;
+
 	std::vector<SPVertex> m_dmaVertices;
 	u32 m_dmaVerticesNum;
 
@@ -204,6 +233,7 @@ private:
 	u32 m_modifyVertices;
 	f32 m_maxLineWidth;
 	bool m_bFlatColors;
+	bool m_bDeferTexrects;
 	TexrectDrawer m_texrectDrawer;
 	OSDMessages m_osdMessages;
 };
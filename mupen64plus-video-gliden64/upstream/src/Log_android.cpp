@@ -1,4 +1,6 @@
+#include <stdio.h>
 #include "Log.h"
+#include "mupenplus/GLideN64_mupenplus.h"
 #include <android/log.h>
 
 void LOG(u16 type, const char * format, ...) {
@@ -12,11 +14,26 @@ void LOG(u16 type, const char * format, ...) {
 			ANDROID_LOG_VERBOSE,
 	};
 
+	static const int m64pLogTranslate[] = {
+			M64MSG_VERBOSE,
+			M64MSG_ERROR,
+			M64MSG_INFO,
+			M64MSG_WARNING,
+			M64MSG_VERBOSE,
+			M64MSG_VERBOSE,
+	};
+
 	if (type > LOG_LEVEL)
 		return;
 
 	va_list va;
 	va_start(va, format);
-	__android_log_vprint(androidLogTranslate[type], "GLideN64", format, va);
+	if (CoreDebugCallback != nullptr) {
+		// Let the front-end write it, so it shares the core's log writer
+		char text[1024];
+		vsnprintf(text, sizeof(text), format, va);
+		CoreDebugCallback(CoreDebugCallbackContext, m64pLogTranslate[type], text);
+	} else
+		__android_log_vprint(androidLogTranslate[type], "GLideN64", format, va);
 	va_end(va);
 }
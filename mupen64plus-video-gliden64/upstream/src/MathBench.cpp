@@ -0,0 +1,167 @@
+// Micro-benchmark of the matrix and vector math used by the vertex pipeline.
+// Build with -DMATH_BENCH=On (and -DNEON_OPT=On on ARM) and run math_bench [iterations].
+// The plain C versions are always measured here as the reference, so the numbers
+// show what the NEON code in the plugin buys on the machine it runs on.
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "3DMath.h"
+#include "RSP.h"
+
+u8 *RDRAM;
+
+namespace {
+
+void MultMatrixC(float m0[4][4], float m1[4][4], float dest[4][4])
+{
+	for (int i = 0; i < 4; i++) {
+		dest[0][i] = m0[0][i]*m1[0][0] + m0[1][i]*m1[0][1] + m0[2][i]*m1[0][2] + m0[3][i]*m1[0][3];
+		dest[1][i] = m0[0][i]*m1[1][0] + m0[1][i]*m1[1][1] + m0[2][i]*m1[1][2] + m0[3][i]*m1[1][3];
+		dest[2][i] = m0[0][i]*m1[2][0] + m0[1][i]*m1[2][1] + m0[2][i]*m1[2][2] + m0[3][i]*m1[2][3];
+		dest[3][i] = m0[3][i]*m1[3][3] + m0[2][i]*m1[3][2] + m0[1][i]*m1[3][1] + m0[0][i]*m1[3][0];
+	}
+}
+
+void NormalizeC(float v[3])
+{
+	float len = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+	if (len != 0.0f) {
+		len = sqrtf(len);
+		v[0] /= len;
+		v[1] /= len;
+		v[2] /= len;
+	}
+}
+
+void TransformVectorNormalizeC(float vec[3], float mtx[4][4])
+{
+	float vres[3];
+	vres[0] = mtx[0][0] * vec[0] + mtx[1][0] * vec[1] + mtx[2][0] * vec[2];
+	vres[1] = mtx[0][1] * vec[0] + mtx[1][1] * vec[1] + mtx[2][1] * vec[2];
+	vres[2] = mtx[0][2] * vec[0] + mtx[1][2] * vec[1] + mtx[2][2] * vec[2];
+	vec[0] = vres[0];
+	vec[1] = vres[1];
+	vec[2] = vres[2];
+	NormalizeC(vec);
+}
+
+void InverseTransformVectorNormalizeNC(float src[][3], float dst[][3], float mtx[4][4], u32 count)
+{
+	for (u32 i = 0; i < count; ++i) {
+		dst[i][0] = mtx[0][0] * src[i][0] + mtx[0][1] * src[i][1] + mtx[0][2] * src[i][2];
+		dst[i][1] = mtx[1][0] * src[i][0] + mtx[1][1] * src[i][1] + mtx[1][2] * src[i][2];
+		dst[i][2] = mtx[2][0] * src[i][0] + mtx[2][1] * src[i][1] + mtx[2][2] * src[i][2];
+		NormalizeC(dst[i]);
+	}
+}
+
+void RSP_LoadMatrixC(f32 mtx[4][4], u32 address)
+{
+	struct _N64Matrix
+	{
+		s16 integer[4][4];
+		u16 fraction[4][4];
+	} *n64Mat = (struct _N64Matrix *)&RDRAM[address];
+
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			mtx[i][j] = (f32)(n64Mat->integer[i][j^1]) + (f32)(n64Mat->fraction[i][j^1]) * 1.5258789e-05f;
+}
+
+const u32 lightCount = 7;
+const u32 matrixCount = 64;
+
+float mtx[matrixCount][4][4];
+float dest[4][4];
+float normals[lightCount][3];
+float result[2][lightCount][3];
+u8 rdram[matrixCount * 64];
+
+template <typename Func>
+double measure(u32 _iterations, Func _func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < _iterations; ++i)
+		_func(i % matrixCount);
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / _iterations;
+}
+
+void report(const char * _name, double _reference, double _plugin, float _error)
+{
+	printf("%-34s%10.1fns%10.1fns%8.2fx   max error %g\n", _name, _reference, _plugin, _reference / _plugin, _error);
+}
+
+float maxError(const float * _a, const float * _b, u32 _count)
+{
+	float error = 0.0f;
+	for (u32 i = 0; i < _count; ++i)
+		error = std::max(error, fabsf(_a[i] - _b[i]));
+	return error;
+}
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+	const u32 iterations = argc > 1 ? u32(atoi(argv[1])) : 1000000;
+
+	srand(1);
+	for (u32 i = 0; i < matrixCount; ++i)
+		for (u32 j = 0; j < 16; ++j)
+			mtx[i][j / 4][j % 4] = float(rand() % 2000 - 1000) / 500.0f;
+	for (u32 i = 0; i < lightCount; ++i)
+		for (u32 j = 0; j < 3; ++j)
+			normals[i][j] = float(rand() % 254 - 127) / 127.0f;
+	for (u32 i = 0; i < sizeof(rdram); ++i)
+		rdram[i] = u8(rand());
+	RDRAM = rdram;
+
+#ifdef __NEON_OPT
+	printf("Plugin implementation: NEON\n");
+#else
+	printf("Plugin implementation: C\n");
+#endif
+	printf("%-34s%12s%12s%9s\n", "", "C", "plugin", "speedup");
+
+	// The measured calls overwrite the outputs, so compare before timing
+	float reference[4][4];
+	MultMatrixC(mtx[0], mtx[1], reference);
+	MultMatrix(mtx[0], mtx[1], dest);
+	float error = maxError(&reference[0][0], &dest[0][0], 16);
+	report("MultMatrix",
+		measure(iterations, [](u32 i) { MultMatrixC(mtx[i], mtx[(i + 1) % matrixCount], dest); }),
+		measure(iterations, [](u32 i) { MultMatrix(mtx[i], mtx[(i + 1) % matrixCount], dest); }),
+		error);
+
+	RSP_LoadMatrixC(reference, 64);
+	RSP_LoadMatrix(dest, 64);
+	error = maxError(&reference[0][0], &dest[0][0], 16);
+	report("RSP_LoadMatrix",
+		measure(iterations, [](u32 i) { RSP_LoadMatrixC(dest, i * 64); }),
+		measure(iterations, [](u32 i) { RSP_LoadMatrix(dest, i * 64); }),
+		error);
+
+	for (u32 i = 0; i < 3; ++i)
+		result[0][0][i] = result[1][0][i] = normals[0][i];
+	TransformVectorNormalizeC(result[0][0], mtx[0]);
+	TransformVectorNormalize(result[1][0], mtx[0]);
+	error = maxError(result[0][0], result[1][0], 3);
+	report("TransformVectorNormalize",
+		measure(iterations, [](u32 i) { TransformVectorNormalizeC(result[0][i % lightCount], mtx[i]); }),
+		measure(iterations, [](u32 i) { TransformVectorNormalize(result[1][i % lightCount], mtx[i]); }),
+		error);
+
+	InverseTransformVectorNormalizeNC(normals, result[0], mtx[0], lightCount);
+	InverseTransformVectorNormalizeN(normals, result[1], mtx[0], lightCount);
+	error = maxError(&result[0][0][0], &result[1][0][0], lightCount * 3);
+	report("InverseTransformVectorNormalizeN",
+		measure(iterations, [](u32 i) { InverseTransformVectorNormalizeNC(normals, result[0], mtx[i], lightCount); }),
+		measure(iterations, [](u32 i) { InverseTransformVectorNormalizeN(normals, result[1], mtx[i], lightCount); }),
+		error);
+
+	return 0;
+}
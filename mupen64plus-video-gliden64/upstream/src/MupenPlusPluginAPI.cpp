@@ -33,6 +33,8 @@ EXPORT m64p_error CALL PluginStartup(
 	void (*DebugCallback)(void *, int, const char *)
 )
 {
+	CoreDebugCallback = DebugCallback;
+	CoreDebugCallbackContext = Context;
 	return api().PluginStartup(CoreLibHandle);
 }
 
@@ -56,4 +58,14 @@ EXPORT void CALL ResizeVideoOutput(int width, int height)
 	api().ResizeVideoOutput(width, height);
 }
 
+EXPORT void CALL SetRenderSkip(int Count)
+{
+	api().SetRenderSkip(Count);
+}
+
+EXPORT unsigned int CALL TrimMemory(int Level)
+{
+	return api().TrimMemory(Level);
+}
+
 } // extern "C"
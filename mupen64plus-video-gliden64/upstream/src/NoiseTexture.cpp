@@ -29,6 +29,7 @@ NoiseTexture::NoiseTexture()
 	: m_DList(0)
 	, m_currTex(0)
 	, m_prevTex(0)
+	, m_seed(0)
 {
 	for (u32 i = 0; i < NOISE_TEX_NUM; ++i)
 		m_pTexture[i] = nullptr;
@@ -104,9 +105,15 @@ void NoiseTexture::_fillTextureData()
 }
 
 
+bool NoiseTexture::_shaderNoise() const
+{
+	// Shaders hash pixel coordinates with integer arithmetic, which GLES2 lacks.
+	return config.generalEmulation.enableShaderNoise != 0 && Context::IntegerTextures;
+}
+
 void NoiseTexture::init()
 {
-	if (config.generalEmulation.enableNoise == 0)
+	if (config.generalEmulation.enableNoise == 0 || _shaderNoise())
 		return;
 
 	if (m_texData[0].empty())
@@ -165,6 +172,12 @@ void NoiseTexture::update()
 		return;
 
 	u32 rand_value(0U);
+	if (_shaderNoise()) {
+		m_seed = Rand(rand_value);
+		m_DList = dwnd().getBuffersSwapCount();
+		return;
+	}
+
 	while (m_currTex == m_prevTex) {
 		rand_value = Rand(rand_value);
 		m_currTex = rand_value % NOISE_TEX_NUM;
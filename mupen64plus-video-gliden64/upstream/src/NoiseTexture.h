@@ -18,12 +18,17 @@ public:
 	void destroy();
 	void update();
 
+	// Per frame seed of the noise computed by shaders with enableShaderNoise
+	u32 getSeed() const { return m_seed; }
+
 private:
 	void _fillTextureData();
+	bool _shaderNoise() const;
 
 	CachedTexture * m_pTexture[NOISE_TEX_NUM];
 	u32 m_DList;
 	u32 m_currTex, m_prevTex;
+	u32 m_seed;
 	NoiseTexturesData m_texData;
 };
 
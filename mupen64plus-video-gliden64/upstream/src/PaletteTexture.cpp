@@ -1,3 +1,4 @@
+#include <cstring>
 #include "Graphics/Context.h"
 #include "Graphics/Parameters.h"
 #include "N64.h"
@@ -26,6 +27,8 @@ void PaletteTexture::init()
 	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
 
 	m_paletteCRC256 = 0;
+	// No valid CRC, so the first update uploads all palettes
+	memset(m_paletteCRC16, 0xFF, sizeof(m_paletteCRC16));
 	m_pTexture = textureCache().addFrameBufferTexture(false);
 	m_pTexture->format = G_IM_FMT_IA;
 	m_pTexture->clampS = 1;
@@ -84,20 +87,37 @@ void PaletteTexture::update()
 
 	m_paletteCRC256 = gDP.paletteCRC256;
 
+	// gDPLoadTLUT updates the CRC of each 16 entries palette it loads,
+	// upload only the range of palettes which changed.
+	u32 first = 16, last = 0;
+	for (u32 pal = 0; pal < 16; ++pal) {
+		if (m_paletteCRC16[pal] == gDP.paletteCRC16[pal])
+			continue;
+		m_paletteCRC16[pal] = gDP.paletteCRC16[pal];
+		if (first == 16)
+			first = pal;
+		last = pal;
+	}
+	if (first == 16)
+		return;
+
+	const u32 start = first << 4;
+	const u32 count = (last - first + 1) << 4;
 	u32 * palette = (u32*)m_pbuf;
 	u16 *src = (u16*)&TMEM[256];
-	for (int i = 0; i < 256; ++i)
+	for (u32 i = start; i < start + count; ++i)
 		palette[i] = swapword(src[i * 4]);
 
 	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
 	Context::UpdateTextureDataParams params;
 	params.handle = m_pTexture->name;
 	params.textureUnitIndex = textureIndices::PaletteTex;
-	params.width = m_pTexture->realWidth;
+	params.x = start;
+	params.width = count;
 	params.height = m_pTexture->realHeight;
 	params.format = fbTexFormats.lutFormat;
 	params.internalFormat = fbTexFormats.lutInternalFormat;
 	params.dataType = fbTexFormats.lutType;
-	params.data = m_pbuf;
+	params.data = palette + start;
 	gfxContext.update2DTexture(params);
 }
@@ -16,6 +16,7 @@ private:
 	CachedTexture * m_pTexture;
 	u8* m_pbuf;
 	u32 m_paletteCRC256;
+	u32 m_paletteCRC16[16];
 };
 
 extern PaletteTexture g_paletteTexture;
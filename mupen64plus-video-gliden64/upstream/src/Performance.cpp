@@ -1,6 +1,12 @@
+#include <stdlib.h>
+#include <cwchar>
 #include "VI.h"
+#include "RSP.h"
 #include "Config.h"
+#include "PluginAPI.h"
 #include "Performance.h"
+#include "Graphics/Context.h"
+#include <osal_files.h>
 
 Performance perf;
 
@@ -9,7 +15,17 @@ Performance::Performance()
 	, m_frames(0)
 	, m_fps(0)
 	, m_vis(0)
-	, m_enabled(false) {
+	, m_enabled(false)
+	, m_statistics(false)
+	, m_gpuTimer(false)
+	, m_gpuTime(-1.0f)
+	, m_frameNumber(0)
+	, m_statisticsFile(nullptr) {
+}
+
+Performance::~Performance()
+{
+	destroy();
 }
 
 void Performance::reset()
@@ -21,6 +37,54 @@ void Performance::reset()
 	m_enabled = (config.onScreenDisplay.fps | config.onScreenDisplay.vis | config.onScreenDisplay.percent) != 0;
 	if (m_enabled)
 		m_startTime = std::chrono::steady_clock::now();
+
+	m_statistics = (config.onScreenDisplay.statistics | config.debug.saveStatistics) != 0;
+	// Dynamic resolution needs GPU time even if statistics are off
+	m_gpuTimer = gfxContext.GpuTimer && (m_statistics || config.frameBufferEmulation.dynamicResolution != 0);
+	m_gpuTime = -1.0f;
+	m_frameNumber = 0;
+	m_frame = FrameStatistics();
+	m_lastFrame = FrameStatistics();
+	m_frameStartTime = std::chrono::steady_clock::now();
+	if (config.debug.saveStatistics != 0)
+		_openStatisticsFile();
+}
+
+void Performance::destroy()
+{
+	if (m_statisticsFile != nullptr) {
+		fclose(m_statisticsFile);
+		m_statisticsFile = nullptr;
+	}
+}
+
+void Performance::_openStatisticsFile()
+{
+	destroy();
+
+	wchar_t strCacheFolderPath[PLUGIN_PATH_SIZE];
+	api().GetUserCachePath(strCacheFolderPath);
+	if (!osal_path_existsW(strCacheFolderPath) && osal_mkdirp(strCacheFolderPath) != 0)
+		return;
+	wchar_t wRomName[32];
+	::mbstowcs(wRomName, RSP.romname, 32);
+	wchar_t fileName[PLUGIN_PATH_SIZE];
+	swprintf(fileName, PLUGIN_PATH_SIZE, L"%ls/GLideN64.%ls.statistics.csv", strCacheFolderPath, wRomName);
+
+	// Append, since the file is reopened whenever the window is recreated
+#if defined(OS_WINDOWS) && !defined(MINGW)
+	m_statisticsFile = _wfopen(fileName, L"a");
+#else
+	char fileName_c[PATH_MAX];
+	wcstombs(fileName_c, fileName, PATH_MAX);
+	m_statisticsFile = fopen(fileName_c, "a");
+#endif
+	if (m_statisticsFile == nullptr)
+		return;
+
+	fseek(m_statisticsFile, 0, SEEK_END);
+	if (ftell(m_statisticsFile) == 0)
+		fprintf(m_statisticsFile, "frame,frame_ms,gpu_ms,draw_calls,triangles,texture_uploads,texture_bytes,shader_compiles,fb_copies\n");
 }
 
 f32 Performance::getFps() const
@@ -62,3 +126,38 @@ void Performance::increaseFramesCount()
 		return;
 	m_frames++;
 }
+
+void Performance::startFrame()
+{
+	if (m_gpuTimer)
+		gfxContext.beginGpuTimer();
+}
+
+void Performance::endFrame()
+{
+	if (m_gpuTimer) {
+		gfxContext.endGpuTimer();
+		// Result of a timer ended a few frames ago
+		m_gpuTime = gfxContext.getGpuTime();
+	}
+
+	if (!m_statistics) {
+		m_frame = FrameStatistics();
+		return;
+	}
+
+	m_frame.gpuTime = m_gpuTime;
+
+	const std::chrono::steady_clock::time_point curTime = std::chrono::steady_clock::now();
+	m_frame.frameTime = std::chrono::duration<f32, std::milli>(curTime - m_frameStartTime).count();
+	m_frameStartTime = curTime;
+
+	m_lastFrame = m_frame;
+	m_frame = FrameStatistics();
+	++m_frameNumber;
+
+	if (m_statisticsFile != nullptr)
+		fprintf(m_statisticsFile, "%u,%.3f,%.3f,%u,%u,%u,%u,%u,%u\n", m_frameNumber,
+			m_lastFrame.frameTime, m_lastFrame.gpuTime, m_lastFrame.drawCalls, m_lastFrame.triangles,
+			m_lastFrame.textureUploads, m_lastFrame.textureBytes, m_lastFrame.shaderCompiles, m_lastFrame.fbCopies);
+}
@@ -1,26 +1,65 @@
 #ifndef PERFORMANCE_H
 #define PERFORMANCE_H
 #include <chrono>
+#include <stdio.h>
 #include "Types.h"
 
 class Performance
 {
 public:
+	// Counters of one frame, i.e. of the work done between two buffer swaps.
+	struct FrameStatistics
+	{
+		u32 drawCalls = 0;
+		u32 triangles = 0;
+		u32 textureUploads = 0;
+		u32 textureBytes = 0;
+		u32 shaderCompiles = 0;
+		u32 fbCopies = 0;
+		f32 frameTime = 0.0f;	// ms between buffer swaps
+		f32 gpuTime = -1.0f;	// ms, negative if GPU timer is not supported
+	};
+
 	Performance();
+	~Performance();
 	void reset();
+	void destroy();
 	f32 getFps() const;
 	f32 getVIs() const;
 	f32 getPercent() const;
 	void increaseVICount();
 	void increaseFramesCount();
 
+	// Frame statistics are shown on screen and/or saved to a CSV file if enabled in config
+	void startFrame();
+	void endFrame();
+	const FrameStatistics & getFrameStatistics() const { return m_lastFrame; }
+	// GPU time of a recent frame in milliseconds, negative if it is not measured
+	f32 getGpuTime() const { return m_gpuTime; }
+
+	void addDrawCall(u32 _triangles) { ++m_frame.drawCalls; m_frame.triangles += _triangles; }
+	void addTextureUpload(u32 _bytes) { ++m_frame.textureUploads; m_frame.textureBytes += _bytes; }
+	void addShaderCompile() { ++m_frame.shaderCompiles; }
+	void addFBCopy() { ++m_frame.fbCopies; }
+
 private:
+	void _openStatisticsFile();
+
 	u32 m_vi;
 	u32 m_frames;
 	f32 m_fps;
 	f32 m_vis;
 	std::chrono::steady_clock::time_point m_startTime;
 	bool m_enabled;
+
+	bool m_statistics;
+	bool m_gpuTimer;
+	f32 m_gpuTime;
+	u32 m_frameNumber;
+	FrameStatistics m_frame;
+	FrameStatistics m_lastFrame;
+	std::chrono::steady_clock::time_point m_frameStartTime;
+	FILE * m_statisticsFile;
 };
 
 extern Performance perf;
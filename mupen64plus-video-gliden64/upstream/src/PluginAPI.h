@@ -80,6 +80,8 @@ public:
 		int * _Capabilities
 	);
 	void SetRenderingCallback(void (*callback)(int));
+	void SetRenderSkip(int _count);
+	unsigned int TrimMemory(int _level);
 
 	// FrameBufferInfo extension
 	void FBWrite(unsigned int addr, unsigned int size);
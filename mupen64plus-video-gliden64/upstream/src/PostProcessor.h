@@ -3,22 +3,22 @@
 
 #include <memory>
 #include "Types.h"
-#include "Textures.h"
-#include "Graphics/ObjectHandle.h"
 
 namespace graphics {
 	class ShaderProgram;
 }
 
-struct FrameBuffer;
-
+// Post processing runs in the pass which copies the frame buffer to screen:
+// enabled stages are fused into one program, so no intermediate buffer is rendered.
 class PostProcessor {
 public:
-	void init();
 	void destroy();
 
-	FrameBuffer * doGammaCorrection(FrameBuffer * _pBuffer);
-	FrameBuffer * doOrientationCorrection(FrameBuffer * _pBuffer);
+	// True if any stage is enabled for the current frame
+	bool isActive() const;
+
+	// Program to copy the frame to screen with, applies all enabled stages
+	graphics::ShaderProgram * getCopyProgram();
 
 	static PostProcessor & get();
 
@@ -26,18 +26,15 @@ private:
 	PostProcessor();
 	PostProcessor(const PostProcessor & _other) = delete;
 
-	void _createResultBuffer(const FrameBuffer * _pMainBuffer);
-	void _initGammaCorrection();
-	void _destroyGammaCorrection();
-	void _initOrientationCorrection();
-	void _destroyOrientationCorrection();
-	void _preDraw(FrameBuffer * _pBuffer);
-	void _postDraw();
-
-	std::unique_ptr<graphics::ShaderProgram> m_gammaCorrectionProgram;
-	std::unique_ptr<graphics::ShaderProgram> m_orientationCorrectionProgram;
-	std::unique_ptr<FrameBuffer> m_pResultBuffer;
-	CachedTexture * m_pTextureOriginal;
+	enum {
+		ppGammaCorrection = 1,
+		ppOrientationCorrection = 2,
+		ppStagesCount = 4
+	};
+
+	u32 _getStages() const;
+
+	std::unique_ptr<graphics::ShaderProgram> m_programs[ppStagesCount];
 };
 
 #endif // POST_PROCESSOR_H
@@ -17,6 +17,7 @@
 #include "Config.h"
 #include "TextureFilterHandler.h"
 #include "DisplayWindow.h"
+#include "VertexCache.h"
 
 using namespace std;
 
@@ -26,6 +27,30 @@ using namespace std;
 
 RSPInfo		RSP;
 
+// Triangles deferred by gSPFlushTriangles must be drawn before any command
+// other than a vertex load or another triangle command is executed.
+static
+void _flushDeferredTriangles()
+{
+	GraphicsDrawer & drawer = dwnd().getDrawer();
+	if (!drawer.hasDeferredTriangles())
+		return;
+	if (RSP.cmd == G_VTX || RSP.cmd == G_TRI1 || RSP.cmd == G_TRI2 || RSP.cmd == G_TRIX || RSP.cmd == G_QUAD)
+		return;
+	drawer.flushTriangles();
+}
+
+// Texrects deferred while executing texrect commands must be drawn before any other command.
+static
+void _flushDeferredTexrects()
+{
+	GraphicsDrawer & drawer = dwnd().getDrawer();
+	const bool texrectCmd = RSP.cmd == G_TEXRECT || RSP.cmd == G_TEXRECTFLIP;
+	if (!texrectCmd)
+		drawer.flushTexrects();
+	drawer.setDeferTexrects(texrectCmd);
+}
+
 static
 void _ProcessDList()
 {
@@ -56,7 +81,10 @@ void _ProcessDList()
 			--pci;
 		RSP.nextCmd = _SHIFTR(*(u32*)&RDRAM[RSP.PC[pci]], 24, 8);
 
+		_flushDeferredTriangles();
+		_flushDeferredTexrects();
 		GBI.cmd[RSP.cmd](RSP.w0, RSP.w1);
+		dwnd().getDrawer().setDeferTexrects(false);
 		RSP_CheckDLCounter();
 	}
 }
@@ -82,6 +110,7 @@ void _ProcessDListSWRS()
 
 		RSP.nextCmd = _SHIFTR(*(u32*)&RDRAM[RSP.PC[RSP.PCi] + 8], 24, 8);
 
+		_flushDeferredTriangles();
 		GBI.cmd[RSP.cmd](RSP.w0, RSP.w1);
 		RSP.PC[RSP.PCi] += 8;
 		RSP_CheckDLCounter();
@@ -100,9 +129,21 @@ void RSP_CheckDLCounter()
 	}
 }
 
+// Fast-forward processes one of every renderSkip + 1 display lists. Frame buffers keep
+// the last rendered frame meanwhile, which is what RDRAM copies and buffer textures get.
+static bool _skipDList()
+{
+	if (RSP.renderSkip == 0 || RSP.infloop)
+		return false;
+	if (++RSP.skipCount <= RSP.renderSkip)
+		return true;
+	RSP.skipCount = 0;
+	return false;
+}
+
 void RSP_ProcessDList()
 {
-	if (ConfigOpen || dwnd().isResizeWindow()) {
+	if (ConfigOpen || dwnd().isResizeWindow() || _skipDList()) {
 		*REG.MI_INTR |= MI_INTR_DP;
 		CheckInterrupts();
 		return;
@@ -171,6 +212,9 @@ void RSP_ProcessDList()
 		break;
 	}
 
+	dwnd().getDrawer().flushTriangles();
+	dwnd().getDrawer().flushTexrects();
+
 	if(RSP.infloop && REG.SP_STATUS) {
 		*REG.SP_STATUS &= ~(SP_STATUS_TASKDONE | SP_STATUS_HALT | SP_STATUS_BROKE);
 		return;
@@ -266,6 +310,7 @@ void RSP_Init()
 	RSP.uc_start = RSP.uc_dstart = 0;
 	RSP.LLE = false;
 	RSP.infloop = false;
+	RSP.renderSkip = RSP.skipCount = 0;
 
 	// get the name of the ROM
 	char romname[21];
@@ -282,6 +327,7 @@ void RSP_Init()
 
 	strncpy(RSP.romname, romname, 21);
 	setDepthClearColor();
+	VertexCache::get().clear();
 	config.generalEmulation.hacks = 0;
 	if (strstr(RSP.romname, (const char *)"OgreBattle64") != nullptr)
 		config.generalEmulation.hacks |= hack_Ogre64;
@@ -11,6 +11,7 @@ typedef struct
 	u32 uc_start, uc_dstart, cmd, nextCmd;
 	u32 w0, w1;
 	s32 count;
+	u32 renderSkip, skipCount; // Display lists skipped after each processed one while fast-forwarding
 	bool busy, halt, infloop;
 	bool LLE;
 	char romname[21];
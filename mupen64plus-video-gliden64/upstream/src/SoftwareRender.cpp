@@ -242,5 +242,6 @@ f32 renderTriangles(const SPVertex * _pVertices, const u16 * _pElements, u32 _nu
 			gDP.otherMode.depthUpdate != 0)
 			Rasterize(vdraw, numVertex, dzdx);
 	}
+	FlushRasterizer();
 	return maxY;
 }
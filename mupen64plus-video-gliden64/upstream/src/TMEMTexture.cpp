@@ -1,33 +1,31 @@
 #include "Graphics/Context.h"
 #include "Graphics/Parameters.h"
-#include "DepthBuffer.h"
+#include "N64.h"
+#include "GBI.h"
 #include "Config.h"
 #include "Textures.h"
-#include "ZlutTexture.h"
+#include "Performance.h"
+#include "TMEMTexture.h"
 
+TMEMTexture g_tmemTexture;
 using namespace graphics;
 
-ZlutTexture g_zlutTexture;
-
-ZlutTexture::ZlutTexture()
+TMEMTexture::TMEMTexture()
 : m_pTexture(nullptr)
+, m_changed(true)
 {
 }
 
-void ZlutTexture::init()
+void TMEMTexture::init()
 {
-	if (!Context::IntegerTextures)
+	if (!Context::IntegerTextures || config.texture.enableGPUTMEM == 0)
 		return;
 
 	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
 
-	std::vector<u32> vecZLUT(0x40000);
-	const u16 * const zLUT16 = depthBufferList().getZLUT();
-	for (u32 i = 0; i < 0x40000; ++i)
-		vecZLUT[i] = zLUT16[i];
-
+	m_changed = true;
 	m_pTexture = textureCache().addFrameBufferTexture(false);
-	m_pTexture->format = G_IM_FMT_IA;
+	m_pTexture->format = G_IM_FMT_RGBA;
 	m_pTexture->clampS = 1;
 	m_pTexture->clampT = 1;
 	m_pTexture->frameBufferTexture = CachedTexture::fbOneSample;
@@ -35,8 +33,8 @@ void ZlutTexture::init()
 	m_pTexture->maskT = 0;
 	m_pTexture->mirrorS = 0;
 	m_pTexture->mirrorT = 0;
-	m_pTexture->realWidth = 512;
-	m_pTexture->realHeight = 512;
+	m_pTexture->realWidth = 1024;
+	m_pTexture->realHeight = 1;
 	m_pTexture->textureBytes = m_pTexture->realWidth * m_pTexture->realHeight * fbTexFormats.lutFormatBytes;
 
 	Context::InitTextureParams initParams;
@@ -46,13 +44,12 @@ void ZlutTexture::init()
 	initParams.internalFormat = fbTexFormats.lutInternalFormat;
 	initParams.format = fbTexFormats.lutFormat;
 	initParams.dataType = fbTexFormats.lutType;
-	initParams.data = vecZLUT.data();
 	gfxContext.init2DTexture(initParams);
 
 	Context::TexParameters setParams;
 	setParams.handle = m_pTexture->name;
 	setParams.target = textureTarget::TEXTURE_2D;
-	setParams.textureUnitIndex = textureIndices::ZLUTTex;
+	setParams.textureUnitIndex = textureIndices::TMEMTex;
 	setParams.minFilter = textureParameters::FILTER_NEAREST;
 	setParams.magFilter = textureParameters::FILTER_NEAREST;
 	setParams.wrapS = textureParameters::WRAP_CLAMP_TO_EDGE;
@@ -60,13 +57,33 @@ void ZlutTexture::init()
 	gfxContext.setTextureParameters(setParams);
 }
 
-void ZlutTexture::destroy()
+void TMEMTexture::destroy()
 {
-	if (!Context::IntegerTextures)
+	if (m_pTexture == nullptr)
 		return;
 
-	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
-
 	textureCache().removeFrameBufferTexture(m_pTexture);
 	m_pTexture = nullptr;
 }
+
+void TMEMTexture::update()
+{
+	if (m_pTexture == nullptr || !m_changed)
+		return;
+
+	m_changed = false;
+
+	// TMEM words are uploaded in host byte order, the shader selects bytes and halfwords.
+	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
+	Context::UpdateTextureDataParams params;
+	params.handle = m_pTexture->name;
+	params.textureUnitIndex = textureIndices::TMEMTex;
+	params.width = m_pTexture->realWidth;
+	params.height = m_pTexture->realHeight;
+	params.format = fbTexFormats.lutFormat;
+	params.internalFormat = fbTexFormats.lutInternalFormat;
+	params.dataType = fbTexFormats.lutType;
+	params.data = TMEM;
+	gfxContext.update2DTexture(params);
+	perf.addTextureUpload(m_pTexture->textureBytes);
+}
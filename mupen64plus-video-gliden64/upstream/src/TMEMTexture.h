@@ -0,0 +1,35 @@
+#pragma once
+#include "Types.h"
+
+struct CachedTexture;
+
+// Copy of TMEM in an integer texture, 1024 32-bit texels.
+// With config.texture.enableGPUTMEM the texture cache does not decode tiles,
+// the combiner shader fetches and decodes their texels from this texture.
+// TMEM is uploaded before the first draw after it was changed by a load.
+class TMEMTexture
+{
+public:
+	// Wrap modes of tiles, applied by the shader to the tile as the texture
+	// wrap mode is applied to a decoded texture.
+	enum WrapMode {
+		wrapClamp = 0,
+		wrapMirror = 1,
+		wrapRepeat = 2
+	};
+
+	TMEMTexture();
+
+	void init();
+	void destroy();
+	void invalidate() { m_changed = true; }
+	void update();
+
+	bool isActive() const { return m_pTexture != nullptr; }
+
+private:
+	CachedTexture * m_pTexture;
+	bool m_changed;
+};
+
+extern TMEMTexture g_tmemTexture;
@@ -8,6 +8,7 @@
 #include "Textures.h"
 #include "VI.h"
 #include "FrameBuffer.h"
+#include "Performance.h"
 #include "TexrectDrawer.h"
 
 using namespace graphics;
@@ -201,6 +202,7 @@ void TexrectDrawer::add()
 	rectParams.vertices = pRect;
 	rectParams.combiner = currentCombiner();
 	gfxContext.drawRects(rectParams);
+	perf.addDrawCall(2);
 }
 
 bool TexrectDrawer::draw()
@@ -300,6 +302,7 @@ bool TexrectDrawer::draw()
 	rectParams.vertices = rect;
 	rectParams.combiner = m_programTex.get();
 	gfxContext.drawRects(rectParams);
+	perf.addDrawCall(2);
 
 	gfxContext.bindFramebuffer(bufferTarget::DRAW_FRAMEBUFFER, m_FBO);
 	m_programClear->activate();
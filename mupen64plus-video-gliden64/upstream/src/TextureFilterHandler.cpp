@@ -48,6 +48,8 @@ u32 TextureFilterHandler::_getConfigOptions() const
 		options |= RICE_HIRESTEXTURES;
 	if (config.textureFilter.txForce16bpp)
 		options |= FORCE16BPP_TEX | FORCE16BPP_HIRESTEX;
+	if (config.textureFilter.txEtc2Compression && graphics::Context::ETC2Textures)
+		options |= ETC2_TEX;
 	if (config.textureFilter.txCacheCompression)
 		options |= GZ_TEXCACHE | GZ_HIRESTEXCACHE;
 	if (config.textureFilter.txSaveCache)
@@ -58,6 +60,8 @@ u32 TextureFilterHandler::_getConfigOptions() const
 		options |= DUMP_TEX;
 	if (config.textureFilter.txDeposterize)
 		options |= DEPOSTERIZE;
+	if (config.textureFilter.txAsyncFilter)
+		options |= ASYNC_FILTER_TEX;
 	return options;
 }
 
@@ -0,0 +1,112 @@
+#include "Graphics/Context.h"
+#include "Graphics/Parameters.h"
+#include "Config.h"
+#include "Log.h"
+#include "Textures.h"
+#include "TextureUpscaler.h"
+
+TextureUpscaler g_textureUpscaler;
+using namespace graphics;
+
+TextureUpscaler::TextureUpscaler()
+: m_scale(0)
+, m_maxTextureSize(0)
+{
+}
+
+TextureUpscaler::~TextureUpscaler()
+{
+}
+
+void TextureUpscaler::init()
+{
+	if (config.textureFilter.txGPUEnhancement == 0 || !Context::ComputeShaders)
+		return;
+
+	// Texture filters, deposterization and 16 bit textures are left to GLideNHQ.
+	if (config.textureFilter.txFilterMode != 0 ||
+		config.textureFilter.txDeposterize != 0 ||
+		config.textureFilter.txForce16bpp != 0)
+		return;
+
+	// Enhancement modes 9..13 are 2XBRZ..6XBRZ, see textureEnhancements in TextureFilterHandler.cpp
+	if (config.textureFilter.txEnhancementMode < 9 || config.textureFilter.txEnhancementMode > 13)
+		return;
+
+	m_scale = config.textureFilter.txEnhancementMode - 7;
+	m_maxTextureSize = static_cast<u32>(gfxContext.getMaxTextureSize());
+	m_program.reset(gfxContext.createTextureUpscaleShader(m_scale));
+	if (!m_program)
+		LOG(LOG_WARNING, "xBRZ compute shader is not supported, textures are enhanced on the CPU\n");
+}
+
+void TextureUpscaler::destroy()
+{
+	m_program.reset();
+	m_scale = 0;
+}
+
+u32 TextureUpscaler::upscale(CachedTexture * _pTexture, TextureUnitParam _textureUnit, u32 _width, u32 _height,
+							InternalColorFormatParam _format, DatatypeParam _type, const void * _data)
+{
+	if (!m_program)
+		return 0;
+
+	// Same limits as TxFilter: small textures are not filtered, GLideNHQ falls back to 2x for large ones.
+	if (_width < 4 || _height < 4 ||
+		_width * m_scale > m_maxTextureSize || _height * m_scale > m_maxTextureSize)
+		return 0;
+
+	// Image units need immutable storage on GLES. init2DTexture allocates it when data is null.
+	Context::InitTextureParams params;
+	params.handle = _pTexture->name;
+	params.textureUnitIndex = _textureUnit;
+	params.mipMapLevel = 0;
+	params.msaaLevel = 0;
+	params.width = _width * m_scale;
+	params.height = _height * m_scale;
+	params.internalFormat = internalcolorFormat::RGBA8;
+	params.format = colorFormat::RGBA;
+	params.dataType = datatype::UNSIGNED_BYTE;
+	params.data = nullptr;
+	gfxContext.init2DTexture(params);
+
+	const ObjectHandle srcTexture = gfxContext.createTexture(textureTarget::TEXTURE_2D);
+	params.handle = srcTexture;
+	params.width = _width;
+	params.height = _height;
+	params.internalFormat = gfxContext.convertInternalTextureFormat(u32(_format));
+	params.dataType = _type;
+	params.data = _data;
+	gfxContext.init2DTexture(params);
+
+	Context::TexParameters texParams;
+	texParams.handle = srcTexture;
+	texParams.target = textureTarget::TEXTURE_2D;
+	texParams.textureUnitIndex = _textureUnit;
+	texParams.minFilter = textureParameters::FILTER_NEAREST;
+	texParams.magFilter = textureParameters::FILTER_NEAREST;
+	gfxContext.setTextureParameters(texParams);
+
+	Context::BindImageTextureParameters imageParams;
+	imageParams.imageUnit = textureImageUnits::TexUpscale;
+	imageParams.texture = _pTexture->name;
+	imageParams.accessMode = textureImageAccessMode::WRITE_ONLY;
+	imageParams.textureFormat = internalcolorFormat::RGBA8;
+	gfxContext.bindImageTexture(imageParams);
+
+	m_program->setImageParams(_width, _height, u32(_textureUnit));
+	m_program->activate();
+	// The shader works on 8x8 source texels per group
+	gfxContext.dispatchCompute((_width + 7) / 8, (_height + 7) / 8, 1);
+
+	// Leave the upscaled texture bound, as loading it on the CPU does
+	Context::BindTextureParameters bindParams;
+	bindParams.texture = _pTexture->name;
+	bindParams.textureUnitIndex = _textureUnit;
+	bindParams.target = textureTarget::TEXTURE_2D;
+	gfxContext.bindTexture(bindParams);
+	gfxContext.deleteTexture(srcTexture);
+
+	return m_scale;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <memory>
+#include "Types.h"
+#include "Graphics/Parameter.h"
+
+namespace graphics {
+	class TextureUpscaleShaderProgram;
+}
+
+struct CachedTexture;
+
+// xBRZ texture enhancement in a compute shader, used instead of GLideNHQ filtering on the CPU
+// when it is enabled and the enhancement is not combined with a texture filter.
+class TextureUpscaler
+{
+public:
+	TextureUpscaler();
+	~TextureUpscaler();
+
+	void init();
+	void destroy();
+
+	// Writes the enhanced _width x _height texels of _data into the texture object of _pTexture.
+	// Returns the scale factor, or 0 if the texture has to be filtered on the CPU.
+	u32 upscale(CachedTexture * _pTexture, graphics::TextureUnitParam _textureUnit, u32 _width, u32 _height,
+				graphics::InternalColorFormatParam _format, graphics::DatatypeParam _type, const void * _data);
+
+private:
+	std::unique_ptr<graphics::TextureUpscaleShaderProgram> m_program;
+	u32 m_scale;
+	u32 m_maxTextureSize;
+};
+
+extern TextureUpscaler g_textureUpscaler;
@@ -14,12 +14,16 @@
 #include "FrameBuffer.h"
 #include "Config.h"
 #include "Keys.h"
+#include "Performance.h"
 #include "GLideNHQ/Ext_TxFilter.h"
 #include "TextureFilterHandler.h"
+#include "TextureUpscaler.h"
+#include "TMEMTexture.h"
 #include "DisplayLoadProgress.h"
 #include "Graphics/Context.h"
 #include "Graphics/Parameters.h"
 #include "DisplayWindow.h"
+#include "Log.h"
 
 using namespace std;
 using namespace graphics;
@@ -251,6 +255,317 @@ inline void GetYUV_RGBA8888(u64 * src, u32 * dst, u16 x)
 	*(dst++) = c;
 }
 
+// Row decoders convert the first _width texels of a TMEM line in one call,
+// so the per texel function is inlined instead of called through a pointer.
+// _palette holds the TLUT already converted to the output format.
+typedef void(*GetTexelRowFunc)(u64 *_src, u32 _width, u16 _i, const u32 * _palette, void * _dest);
+
+template <GetTexelFunc Get, typename T>
+inline void GetTexelRowTail(u64 *_src, u32 _x, u32 _width, u16 _i, T * _dest)
+{
+	for (; _x < _width; ++_x)
+		_dest[_x] = static_cast<T>(Get(_src, static_cast<u16>(_x), _i, 0));
+}
+
+template <GetTexelFunc Get, typename T>
+void GetTexelRow(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+{
+	GetTexelRowTail<Get, T>(_src, 0, _width, _i, static_cast<T*>(_dest));
+}
+
+template <typename T>
+void GetCI4Row(u64 *_src, u32 _width, u16 _i, const u32 * _palette, void * _dest)
+{
+	const u8 * src = reinterpret_cast<const u8*>(_src);
+	T * dest = static_cast<T*>(_dest);
+	for (u32 x = 0; x < _width; ++x) {
+		const u8 color4B = src[(x >> 1) ^ (_i << 1)];
+		dest[x] = static_cast<T>(_palette[(x & 1) ? (color4B & 0x0F) : (color4B >> 4)]);
+	}
+}
+
+template <typename T>
+void GetCI8Row(u64 *_src, u32 _width, u16 _i, const u32 * _palette, void * _dest)
+{
+	const u8 * src = reinterpret_cast<const u8*>(_src);
+	T * dest = static_cast<T*>(_dest);
+	for (u32 x = 0; x < _width; ++x)
+		dest[x] = static_cast<T>(_palette[src[x ^ (_i << 1)]]);
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define __TEXEL_ROW_SIMD
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Thin wrappers, so every decoder is written once for SSE and NEON.
+	// A vector holds 16 bytes of TMEM: 8 16-bit or 16 8-bit texels.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	typedef uint16x8_t u16x8;
+
+	// Odd lines have the 32-bit words of each qword swapped.
+	inline u16x8 vLoadTexels(const u8 * _p, bool _swap) {
+		const uint32x4_t v = vreinterpretq_u32_u8(vld1q_u8(_p));
+		return vreinterpretq_u16_u32(_swap ? vrev64q_u32(v) : v);
+	}
+	inline u16x8 vSet1(u16 _a) { return vdupq_n_u16(_a); }
+	inline u16x8 vAnd(u16x8 _a, u16x8 _b) { return vandq_u16(_a, _b); }
+	inline u16x8 vOr(u16x8 _a, u16x8 _b) { return vorrq_u16(_a, _b); }
+	inline u16x8 vAdd(u16x8 _a, u16x8 _b) { return vaddq_u16(_a, _b); }
+	inline u16x8 vMul(u16x8 _a, u16x8 _b) { return vmulq_u16(_a, _b); }
+	template <int N> inline u16x8 vShl(u16x8 _a) { return vshlq_n_u16(_a, N); }
+	template <int N> inline u16x8 vShr(u16x8 _a) { return vshrq_n_u16(_a, N); }
+	inline u16x8 vSwapBytes(u16x8 _a) { return vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(_a))); }
+	// Each of the low or high 8 bytes duplicated into a 16-bit lane.
+	inline u16x8 vDupBytesLo(u16x8 _a) {
+		const uint8x16_t b = vreinterpretq_u8_u16(_a);
+		return vreinterpretq_u16_u8(vzipq_u8(b, b).val[0]);
+	}
+	inline u16x8 vDupBytesHi(u16x8 _a) {
+		const uint8x16_t b = vreinterpretq_u8_u16(_a);
+		return vreinterpretq_u16_u8(vzipq_u8(b, b).val[1]);
+	}
+	inline void vStore16(u16 * _p, u16x8 _a) { vst1q_u16(_p, _a); }
+	// Stores 8 32-bit values _lo | (_hi << 16).
+	inline void vStore32(u32 * _p, u16x8 _lo, u16x8 _hi) {
+		uint16x8x2_t v;
+		v.val[0] = _lo;
+		v.val[1] = _hi;
+		vst2q_u16(reinterpret_cast<uint16_t*>(_p), v);
+	}
+#else
+	typedef __m128i u16x8;
+
+	inline u16x8 vLoadTexels(const u8 * _p, bool _swap) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_p));
+		return _swap ? _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)) : v;
+	}
+	inline u16x8 vSet1(u16 _a) { return _mm_set1_epi16(static_cast<short>(_a)); }
+	inline u16x8 vAnd(u16x8 _a, u16x8 _b) { return _mm_and_si128(_a, _b); }
+	inline u16x8 vOr(u16x8 _a, u16x8 _b) { return _mm_or_si128(_a, _b); }
+	inline u16x8 vAdd(u16x8 _a, u16x8 _b) { return _mm_add_epi16(_a, _b); }
+	inline u16x8 vMul(u16x8 _a, u16x8 _b) { return _mm_mullo_epi16(_a, _b); }
+	template <int N> inline u16x8 vShl(u16x8 _a) { return _mm_slli_epi16(_a, N); }
+	template <int N> inline u16x8 vShr(u16x8 _a) { return _mm_srli_epi16(_a, N); }
+	inline u16x8 vSwapBytes(u16x8 _a) { return _mm_or_si128(_mm_slli_epi16(_a, 8), _mm_srli_epi16(_a, 8)); }
+	inline u16x8 vDupBytesLo(u16x8 _a) { return _mm_unpacklo_epi8(_a, _a); }
+	inline u16x8 vDupBytesHi(u16x8 _a) { return _mm_unpackhi_epi8(_a, _a); }
+	inline void vStore16(u16 * _p, u16x8 _a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(_p), _a); }
+	inline void vStore32(u32 * _p, u16x8 _lo, u16x8 _hi) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_p), _mm_unpacklo_epi16(_lo, _hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_p + 4), _mm_unpackhi_epi16(_lo, _hi));
+	}
+#endif
+
+	// Same as Five2Eight: round(v * 255 / 31).
+	inline u16x8 vFive2Eight(u16x8 _a) {
+		return vShr<6>(vAdd(vMul(_a, vSet1(527)), vSet1(23)));
+	}
+
+	void GetRGBA5551Row_RGBA5551(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u16 * dest = static_cast<u16*>(_dest);
+		u32 x = 0;
+		for (; x + 8 <= _width; x += 8)
+			vStore16(dest + x, vSwapBytes(vLoadTexels(src + (x << 1), _i != 0)));
+		GetTexelRowTail<GetRGBA5551_RGBA5551>(_src, x, _width, _i, dest);
+	}
+
+	void GetRGBA5551Row_RGBA8888(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u32 * dest = static_cast<u32*>(_dest);
+		const u16x8 mask5 = vSet1(0x1F);
+		u32 x = 0;
+		for (; x + 8 <= _width; x += 8) {
+			const u16x8 color = vSwapBytes(vLoadTexels(src + (x << 1), _i != 0));
+			const u16x8 r = vFive2Eight(vShr<11>(color));
+			const u16x8 g = vFive2Eight(vAnd(vShr<6>(color), mask5));
+			const u16x8 b = vFive2Eight(vAnd(vShr<1>(color), mask5));
+			const u16x8 a = vMul(vAnd(color, vSet1(1)), vSet1(0xFF00));
+			vStore32(dest + x, vOr(r, vShl<8>(g)), vOr(b, a));
+		}
+		GetTexelRowTail<GetRGBA5551_RGBA8888>(_src, x, _width, _i, dest);
+	}
+
+	void GetIA88Row_RGBA8888(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u32 * dest = static_cast<u32*>(_dest);
+		u32 x = 0;
+		for (; x + 8 <= _width; x += 8) {
+			const u16x8 color = vLoadTexels(src + (x << 1), _i != 0);
+			const u16x8 i = vAnd(color, vSet1(0x00FF));
+			vStore32(dest + x, vOr(i, vShl<8>(i)), color);
+		}
+		GetTexelRowTail<GetIA88_RGBA8888>(_src, x, _width, _i, dest);
+	}
+
+	void GetIA88Row_RGBA4444(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u16 * dest = static_cast<u16*>(_dest);
+		u32 x = 0;
+		for (; x + 8 <= _width; x += 8) {
+			const u16x8 color = vLoadTexels(src + (x << 1), _i != 0);
+			const u16x8 i = vAnd(vShr<4>(color), vSet1(0x000F));
+			vStore16(dest + x, vOr(vMul(i, vSet1(0x1110)), vShr<12>(color)));
+		}
+		GetTexelRowTail<GetIA88_RGBA4444>(_src, x, _width, _i, dest);
+	}
+
+	void GetI8Row_RGBA8888(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u32 * dest = static_cast<u32*>(_dest);
+		u32 x = 0;
+		for (; x + 16 <= _width; x += 16) {
+			const u16x8 color = vLoadTexels(src + x, _i != 0);
+			const u16x8 lo = vDupBytesLo(color);
+			const u16x8 hi = vDupBytesHi(color);
+			vStore32(dest + x, lo, lo);
+			vStore32(dest + x + 8, hi, hi);
+		}
+		GetTexelRowTail<GetI8_RGBA8888>(_src, x, _width, _i, dest);
+	}
+
+	// Same as Four2Eight for intensity and alpha nibbles.
+	inline void vIA44_RGBA8888(u32 * _dest, u16x8 _color) {
+		const u16x8 i = vAnd(vShr<4>(_color), vSet1(0x000F));
+		const u16x8 a = vAnd(_color, vSet1(0x000F));
+		vStore32(_dest, vMul(i, vSet1(0x1111)), vOr(vMul(i, vSet1(0x0011)), vMul(a, vSet1(0x1100))));
+	}
+
+	void GetIA44Row_RGBA8888(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u32 * dest = static_cast<u32*>(_dest);
+		u32 x = 0;
+		for (; x + 16 <= _width; x += 16) {
+			const u16x8 color = vLoadTexels(src + x, _i != 0);
+			vIA44_RGBA8888(dest + x, vDupBytesLo(color));
+			vIA44_RGBA8888(dest + x + 8, vDupBytesHi(color));
+		}
+		GetTexelRowTail<GetIA44_RGBA8888>(_src, x, _width, _i, dest);
+	}
+
+	void GetI8Row_RGBA4444(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u16 * dest = static_cast<u16*>(_dest);
+		const u16x8 mul = vSet1(0x1111);
+		u32 x = 0;
+		for (; x + 16 <= _width; x += 16) {
+			const u16x8 color = vLoadTexels(src + x, _i != 0);
+			vStore16(dest + x, vMul(vShr<12>(vDupBytesLo(color)), mul));
+			vStore16(dest + x + 8, vMul(vShr<12>(vDupBytesHi(color)), mul));
+		}
+		GetTexelRowTail<GetI8_RGBA4444>(_src, x, _width, _i, dest);
+	}
+
+	inline u16x8 vIA44_RGBA4444(u16x8 _color) {
+		// _color has the texel in both bytes: ii aa ii aa -> ii ii ii aa
+		return vOr(vAnd(_color, vSet1(0xF0FF)), vAnd(vShr<4>(_color), vSet1(0x0F00)));
+	}
+
+	void GetIA44Row_RGBA4444(u64 *_src, u32 _width, u16 _i, const u32 *, void * _dest)
+	{
+		const u8 * src = reinterpret_cast<const u8*>(_src);
+		u16 * dest = static_cast<u16*>(_dest);
+		u32 x = 0;
+		for (; x + 16 <= _width; x += 16) {
+			const u16x8 color = vLoadTexels(src + x, _i != 0);
+			vStore16(dest + x, vIA44_RGBA4444(vDupBytesLo(color)));
+			vStore16(dest + x + 8, vIA44_RGBA4444(vDupBytesHi(color)));
+		}
+		GetTexelRowTail<GetIA44_RGBA4444>(_src, x, _width, _i, dest);
+	}
+}
+
+#endif // __TEXEL_ROW_SIMD
+
+template <typename R, R(*Convert)(u16)>
+u32 GetPaletteColor(u16 _color)
+{
+	return Convert(_color);
+}
+
+struct TexelRowDecoder
+{
+	GetTexelFunc		Get;
+	GetTexelRowFunc		GetRow;
+	u32					paletteSize;	// TLUT entries read by color indexed formats
+	u32					(*GetPaletteEntry)(u16 color);
+};
+
+// Row decoders for the texel functions of ImageFormat.
+static const TexelRowDecoder texelRowDecoders[] =
+{
+	{ GetCI4IA_RGBA4444, GetCI4Row<u16>, 16, GetPaletteColor<u16, IA88_RGBA4444> },
+	{ GetCI4IA_RGBA8888, GetCI4Row<u32>, 16, GetPaletteColor<u32, IA88_RGBA8888> },
+	{ GetCI4RGBA_RGBA5551, GetCI4Row<u16>, 16, GetPaletteColor<u16, RGBA5551_RGBA5551> },
+	{ GetCI4RGBA_RGBA8888, GetCI4Row<u32>, 16, GetPaletteColor<u32, RGBA5551_RGBA8888> },
+	{ GetCI8IA_RGBA4444, GetCI8Row<u16>, 256, GetPaletteColor<u16, IA88_RGBA4444> },
+	{ GetCI8IA_RGBA8888, GetCI8Row<u32>, 256, GetPaletteColor<u32, IA88_RGBA8888> },
+	{ GetCI8RGBA_RGBA5551, GetCI8Row<u16>, 256, GetPaletteColor<u16, RGBA5551_RGBA5551> },
+	{ GetCI8RGBA_RGBA8888, GetCI8Row<u32>, 256, GetPaletteColor<u32, RGBA5551_RGBA8888> },
+	{ GetIA31_RGBA8888, GetTexelRow<GetIA31_RGBA8888, u32>, 0, nullptr },
+	{ GetIA31_RGBA4444, GetTexelRow<GetIA31_RGBA4444, u16>, 0, nullptr },
+	{ GetI4_RGBA8888, GetTexelRow<GetI4_RGBA8888, u32>, 0, nullptr },
+	{ GetI4_RGBA4444, GetTexelRow<GetI4_RGBA4444, u16>, 0, nullptr },
+	{ GetCI16IA_RGBA8888, GetTexelRow<GetCI16IA_RGBA8888, u32>, 0, nullptr },
+	{ GetCI16IA_RGBA4444, GetTexelRow<GetCI16IA_RGBA4444, u16>, 0, nullptr },
+	{ GetCI16RGBA_RGBA8888, GetTexelRow<GetCI16RGBA_RGBA8888, u32>, 0, nullptr },
+	{ GetCI16RGBA_RGBA5551, GetTexelRow<GetCI16RGBA_RGBA5551, u16>, 0, nullptr },
+	{ GetRGBA8888_RGBA4444, GetTexelRow<GetRGBA8888_RGBA4444, u16>, 0, nullptr },
+#ifdef __TEXEL_ROW_SIMD
+	{ GetRGBA5551_RGBA8888, GetRGBA5551Row_RGBA8888, 0, nullptr },
+	{ GetRGBA5551_RGBA5551, GetRGBA5551Row_RGBA5551, 0, nullptr },
+	{ GetIA88_RGBA8888, GetIA88Row_RGBA8888, 0, nullptr },
+	{ GetIA88_RGBA4444, GetIA88Row_RGBA4444, 0, nullptr },
+	{ GetIA44_RGBA8888, GetIA44Row_RGBA8888, 0, nullptr },
+	{ GetIA44_RGBA4444, GetIA44Row_RGBA4444, 0, nullptr },
+	{ GetI8_RGBA8888, GetI8Row_RGBA8888, 0, nullptr },
+	{ GetI8_RGBA4444, GetI8Row_RGBA4444, 0, nullptr },
+#else
+	{ GetRGBA5551_RGBA8888, GetTexelRow<GetRGBA5551_RGBA8888, u32>, 0, nullptr },
+	{ GetRGBA5551_RGBA5551, GetTexelRow<GetRGBA5551_RGBA5551, u16>, 0, nullptr },
+	{ GetIA88_RGBA8888, GetTexelRow<GetIA88_RGBA8888, u32>, 0, nullptr },
+	{ GetIA88_RGBA4444, GetTexelRow<GetIA88_RGBA4444, u16>, 0, nullptr },
+	{ GetIA44_RGBA8888, GetTexelRow<GetIA44_RGBA8888, u32>, 0, nullptr },
+	{ GetIA44_RGBA4444, GetTexelRow<GetIA44_RGBA4444, u16>, 0, nullptr },
+	{ GetI8_RGBA8888, GetTexelRow<GetI8_RGBA8888, u32>, 0, nullptr },
+	{ GetI8_RGBA4444, GetTexelRow<GetI8_RGBA4444, u16>, 0, nullptr },
+#endif
+	{ GetRGBA8888_RGBA8888, GetTexelRow<GetRGBA8888_RGBA8888, u32>, 0, nullptr },
+};
+
+static
+const TexelRowDecoder * getTexelRowDecoder(GetTexelFunc _getTexel)
+{
+	for (const TexelRowDecoder & decoder : texelRowDecoders) {
+		if (decoder.Get == _getTexel)
+			return &decoder;
+	}
+	return nullptr;
+}
+
+// Converts the TLUT part used by a color indexed texture, as its GetTexel function reads it.
+static
+void loadTexelRowPalette(const TexelRowDecoder & _decoder, u8 _palette, u32 * _dest)
+{
+	const u32 base = 256 + (_decoder.paletteSize == 16 ? (_palette << 4) : 0);
+	for (u32 k = 0; k < _decoder.paletteSize; ++k)
+		_dest[k] = _decoder.GetPaletteEntry(*(u16*)&TMEM[base + k]);
+}
+
 struct TextureLoadParameters
 {
 	GetTexelFunc				Get16;
@@ -477,6 +792,19 @@ void TextureCache::init()
 {
 	m_curUnpackAlignment = 0;
 
+	CRC_SetFastHash(config.texture.fastTextureHash != 0);
+	LOG(LOG_VERBOSE, "Texture hash: %s\n", CRC_GetImplementationName());
+
+	const u32 numDecodeThreads = min(std::thread::hardware_concurrency(), 4U);
+	if (numDecodeThreads > 1)
+		m_decodeWorkers.start(numDecodeThreads);
+
+	if (m_entries.empty()) {
+		m_entries.resize(m_maxCacheSize);
+		m_index.resize(m_indexSize);
+	}
+	_resetEntries();
+
 	u32 dummyTexture[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
 	m_pDummy = addFrameBufferTexture(false); // we don't want to remove dummy texture
@@ -525,25 +853,154 @@ void TextureCache::init()
 void TextureCache::destroy()
 {
 	current[0] = current[1] = nullptr;
+	m_decodeWorkers.stop();
 
-	for (Textures::const_iterator cur = m_textures.cbegin(); cur != m_textures.cend(); ++cur)
-		gfxContext.deleteTexture(cur->name);
-	m_textures.clear();
-	m_lruTextureLocations.clear();
+	for (u32 entry = m_lruHead; entry != m_noEntry; entry = m_entries[entry].next)
+		gfxContext.deleteTexture(m_entries[entry].texture.name);
+	_resetEntries();
+	_clearTexturePool();
 
 	for (FBTextures::const_iterator cur = m_fbTextures.cbegin(); cur != m_fbTextures.cend(); ++cur)
 		gfxContext.deleteTexture(cur->second.name);
 	m_fbTextures.clear();
 }
 
+void TextureCache::_resetEntries()
+{
+	m_lruHead = m_lruTail = m_noEntry;
+	m_freeEntry = m_entries.empty() ? m_noEntry : 0;
+	for (u32 i = 0; i < m_entries.size(); ++i) {
+		m_entries[i].prev = m_noEntry;
+		m_entries[i].next = i + 1 < m_entries.size() ? i + 1 : m_noEntry;
+	}
+	std::fill(m_index.begin(), m_index.end(), m_noEntry);
+	m_cachedBytes = 0;
+}
+
+u32 TextureCache::_findEntry(u32 _crc32) const
+{
+	const u32 mask = m_indexSize - 1;
+	for (u32 slot = _crc32 & mask; m_index[slot] != m_noEntry; slot = (slot + 1) & mask) {
+		if (m_entries[m_index[slot]].texture.crc == _crc32)
+			return m_index[slot];
+	}
+	return m_noEntry;
+}
+
+void TextureCache::_unlinkEntry(u32 _entry)
+{
+	CacheEntry & entry = m_entries[_entry];
+	if (entry.prev != m_noEntry)
+		m_entries[entry.prev].next = entry.next;
+	else
+		m_lruHead = entry.next;
+	if (entry.next != m_noEntry)
+		m_entries[entry.next].prev = entry.prev;
+	else
+		m_lruTail = entry.prev;
+	entry.prev = entry.next = m_noEntry;
+}
+
+void TextureCache::_touchEntry(u32 _entry)
+{
+	if (_entry == m_lruHead)
+		return;
+	_unlinkEntry(_entry);
+	m_entries[_entry].next = m_lruHead;
+	m_entries[m_lruHead].prev = _entry;
+	m_lruHead = _entry;
+}
+
+void TextureCache::_removeEntry(u32 _entry)
+{
+	CachedTexture & texture = m_entries[_entry].texture;
+	if (texture.storageKey != 0 && m_texturePool.size() < m_maxPoolSize &&
+		m_pooledBytes + texture.textureBytes <= m_maxCacheBytes / 4) {
+		m_texturePool.emplace(texture.storageKey, texture);
+		m_pooledBytes += texture.textureBytes;
+	} else
+		gfxContext.deleteTexture(texture.name);
+	m_cachedBytes -= texture.textureBytes;
+
+	// Remove the entry from the index. Following entries of the probe
+	// sequence are shifted back, so lookups need no tombstones.
+	const u32 mask = m_indexSize - 1;
+	u32 slot = texture.crc & mask;
+	while (m_index[slot] != _entry)
+		slot = (slot + 1) & mask;
+	for (u32 next = (slot + 1) & mask; m_index[next] != m_noEntry; next = (next + 1) & mask) {
+		const u32 home = m_entries[m_index[next]].texture.crc & mask;
+		const bool canMove = slot <= next ? (home <= slot || home > next) : (home <= slot && home > next);
+		if (canMove) {
+			m_index[slot] = m_index[next];
+			slot = next;
+		}
+	}
+	m_index[slot] = m_noEntry;
+
+	_unlinkEntry(_entry);
+	m_entries[_entry].next = m_freeEntry;
+	m_freeEntry = _entry;
+}
+
+bool TextureCache::_reloadFiltered(u32 _entry)
+{
+	// Texture was uploaded unfiltered while the filter runs in background.
+	// Once the filtered texture is available, drop the entry so it is loaded again.
+	CachedTexture * pTexture = &m_entries[_entry].texture;
+	if (!pTexture->bFilterPending || txfilter_filterready((uint64)pTexture->crc) == 0)
+		return false;
+
+	for (u32 t = 0; t < 2; ++t) {
+		if (current[t] == pTexture)
+			current[t] = nullptr;
+	}
+	_removeEntry(_entry);
+	return true;
+}
+
+bool TextureCache::_isCurrent(u32 _entry) const
+{
+	const CachedTexture * pTexture = &m_entries[_entry].texture;
+	return pTexture == current[0] || pTexture == current[1];
+}
+
 void TextureCache::_checkCacheSize()
 {
-	if (m_textures.size() >= m_maxCacheSize) {
-		CachedTexture& clsTex = m_textures.back();
-		gfxContext.deleteTexture(clsTex.name);
-		m_lruTextureLocations.erase(clsTex.crc);
-		m_textures.pop_back();
+	// Evict least recently used textures until there is a free entry and the
+	// textures fit into the memory budget. Textures in use are never evicted.
+	u32 entry = m_lruTail;
+	while (entry != m_noEntry && (m_freeEntry == m_noEntry || m_cachedBytes > m_maxCacheBytes)) {
+		const u32 prev = m_entries[entry].prev;
+		if (!_isCurrent(entry))
+			_removeEntry(entry);
+		entry = prev;
 	}
+	assert(m_freeEntry != m_noEntry);
+}
+
+size_t TextureCache::trim(bool _all)
+{
+	// Evict least recently used textures down to half of the cache.
+	// Evicting all of them drops the current textures, they are looked up again.
+	// The texture pool is released as well.
+	const size_t pooledBytes = m_pooledBytes;
+	const size_t cachedBytes = m_cachedBytes;
+	if (_all) {
+		current[0] = current[1] = nullptr;
+		gDP.changed |= CHANGED_TILE;
+	}
+	const size_t keepBytes = _all ? 0 : cachedBytes / 2;
+	u32 entry = m_lruTail;
+	while (entry != m_noEntry && m_cachedBytes > keepBytes) {
+		const u32 prev = m_entries[entry].prev;
+		if (!_isCurrent(entry))
+			_removeEntry(entry);
+		entry = prev;
+	}
+	const size_t evictedBytes = cachedBytes - m_cachedBytes + pooledBytes;
+	_clearTexturePool();
+	return evictedBytes;
 }
 
 CachedTexture * TextureCache::_addTexture(u32 _crc32)
@@ -551,11 +1008,93 @@ CachedTexture * TextureCache::_addTexture(u32 _crc32)
 	if (m_curUnpackAlignment == 0)
 		m_curUnpackAlignment = gfxContext.getTextureUnpackAlignment();
 	_checkCacheSize();
-	m_textures.emplace_front(gfxContext.createTexture(textureTarget::TEXTURE_2D));
-	Textures::iterator new_iter = m_textures.begin();
-	new_iter->crc = _crc32;
-	m_lruTextureLocations.insert(std::pair<u32, Textures::iterator>(_crc32, new_iter));
-	return &(*new_iter);
+
+	ObjectHandle name;
+	if (!m_spareTextures.empty()) {
+		name = m_spareTextures.back();
+		m_spareTextures.pop_back();
+	} else
+		name = gfxContext.createTexture(textureTarget::TEXTURE_2D);
+
+	const u32 newEntry = m_freeEntry;
+	CacheEntry & entry = m_entries[newEntry];
+	m_freeEntry = entry.next;
+	entry.texture = CachedTexture(name);
+	entry.texture.crc = _crc32;
+	entry.texture.textureBytes = 0;
+	entry.prev = m_noEntry;
+	entry.next = m_lruHead;
+	if (m_lruHead != m_noEntry)
+		m_entries[m_lruHead].prev = newEntry;
+	else
+		m_lruTail = newEntry;
+	m_lruHead = newEntry;
+
+	const u32 mask = m_indexSize - 1;
+	u32 slot = _crc32 & mask;
+	while (m_index[slot] != m_noEntry)
+		slot = (slot + 1) & mask;
+	m_index[slot] = newEntry;
+	return &entry.texture;
+}
+
+void TextureCache::_clearTexturePool()
+{
+	for (TexturePool::const_iterator cur = m_texturePool.cbegin(); cur != m_texturePool.cend(); ++cur)
+		gfxContext.deleteTexture(cur->second.name);
+	m_texturePool.clear();
+	m_pooledBytes = 0;
+
+	for (const ObjectHandle & name : m_spareTextures)
+		gfxContext.deleteTexture(name);
+	m_spareTextures.clear();
+}
+
+bool TextureCache::_reuseTextureStorage(CachedTexture * _pTexture, u32 _mipMapLevel, u32 _width, u32 _height,
+	graphics::Parameter _internalFormat, u32 _mipMapLevels)
+{
+	// Immutable storage can't be specified again. Textures evicted from the cache keep
+	// theirs in a pool, a texture of the same size, format and levels just uploads to it.
+	if (!Context::ImmutableTextures)
+		return false;
+
+	// Levels of a new texture are allocated with the first one, so all uploads go to existing storage
+	if (_mipMapLevel != 0)
+		return _pTexture->storageKey != 0;
+
+	if (_width >= 0x4000 || _height >= 0x4000 || _mipMapLevels > 15)
+		return false;
+	_pTexture->storageKey = (u64(u32(_internalFormat)) << 32) |
+		(_width << 18) | (_height << 4) | _mipMapLevels;
+	TexturePool::iterator iter = m_texturePool.find(_pTexture->storageKey);
+	if (iter == m_texturePool.end())
+		return false;
+	m_spareTextures.push_back(_pTexture->name);
+	_pTexture->name = iter->second.name;
+	m_pooledBytes -= iter->second.textureBytes;
+	m_texturePool.erase(iter);
+	return true;
+}
+
+static
+void initTexture(const CachedTexture * _pTexture, const Context::InitTextureParams & _params, bool _existingStorage)
+{
+	if (!_existingStorage) {
+		gfxContext.init2DTexture(_params);
+		return;
+	}
+
+	Context::UpdateTextureDataParams params;
+	params.handle = _pTexture->name;
+	params.textureUnitIndex = _params.textureUnitIndex;
+	params.mipMapLevel = _params.mipMapLevel;
+	params.width = _params.width;
+	params.height = _params.height;
+	params.format = _params.format;
+	params.internalFormat = _params.internalFormat;
+	params.dataType = _params.dataType;
+	params.data = _params.data;
+	gfxContext.update2DTexture(params);
 }
 
 void TextureCache::removeFrameBufferTexture(CachedTexture * _pTexture)
@@ -680,13 +1219,30 @@ void _calcTileSizes(u32 _t, TileSizes & _sizes, gDPTile * _pLoadTile)
 	}
 }
 
+// Returns size of ETC2 compressed texture data, 0 for uncompressed formats.
+static
+u32 _getCompressedTextureSize(const GHQTexInfo & _info)
+{
+	Parameter format(_info.format);
+	const u32 blocks = ((_info.width + 3) / 4) * ((_info.height + 3) / 4);
+	if (format == internalcolorFormat::COMPRESSED_RGB8_ETC2)
+		return blocks * 8;
+	if (format == internalcolorFormat::COMPRESSED_RGBA8_ETC2_EAC)
+		return blocks * 16;
+	return 0;
+}
+
 inline
 void _updateCachedTexture(const GHQTexInfo & _info, CachedTexture *_pTexture, f32 _scale)
 {
 	_pTexture->textureBytes = _info.width * _info.height;
 
 	Parameter format(_info.format);
-	if (format == internalcolorFormat::RGB8 ||
+	const u32 compressedSize = _getCompressedTextureSize(_info);
+	if (compressedSize != 0) {
+		_pTexture->textureBytes = compressedSize;
+	}
+	else if (format == internalcolorFormat::RGB8 ||
 		format == internalcolorFormat::RGBA4 ||
 		format == internalcolorFormat::RGB5_A1) {
 		_pTexture->textureBytes <<= 1;
@@ -708,6 +1264,25 @@ void _updateCachedTexture(const GHQTexInfo & _info, CachedTexture *_pTexture, f3
 	_pTexture->bHDTexture = true;
 }
 
+inline
+bool _upscaleTexture(CachedTexture *_pTexture, TextureUnitParam _textureUnit, u32 _width, u32 _height,
+					InternalColorFormatParam _format, DatatypeParam _type, const void * _data, s32 _unpackAlignment)
+{
+	if (_width % 2 != 0 && _format != internalcolorFormat::RGBA8 && _unpackAlignment > 1)
+		gfxContext.setTextureUnpackAlignment(2);
+
+	const u32 scale = g_textureUpscaler.upscale(_pTexture, _textureUnit, _width, _height, _format, _type, _data);
+	if (scale == 0)
+		return false;
+
+	GHQTexInfo info;
+	info.width = _width * scale;
+	info.height = _height * scale;
+	info.format = u32(internalcolorFormat::RGBA8);
+	_updateCachedTexture(info, _pTexture, f32(scale));
+	return true;
+}
+
 bool TextureCache::_loadHiresBackground(CachedTexture *_pTexture)
 {
 	if (!TFH.isInited())
@@ -749,6 +1324,7 @@ bool TextureCache::_loadHiresBackground(CachedTexture *_pTexture)
 		params.internalFormat = InternalColorFormatParam(ghqTexInfo.format);
 		params.dataType = DatatypeParam(ghqTexInfo.pixel_type);
 		params.data = ghqTexInfo.data;
+		params.dataSize = _getCompressedTextureSize(ghqTexInfo);
 		gfxContext.init2DTexture(params);
 
 		assert(!gfxContext.isError());
@@ -758,6 +1334,9 @@ bool TextureCache::_loadHiresBackground(CachedTexture *_pTexture)
 	return false;
 }
 
+// Backgrounds with less texels than that are decoded in the calling thread
+static const u32 minParallelBackgroundTexels = 64 * 1024;
+
 void TextureCache::_loadBackground(CachedTexture *pTexture)
 {
 	if (_loadHiresBackground(pTexture))
@@ -766,9 +1345,8 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 	u32 *pDest = nullptr;
 	u16 *pDest16 = nullptr;
 
-	u8 *pSwapped, *pSrc;
+	u8 *pSwapped;
 	u32 numBytes, bpl;
-	u32 x, y, j, tx, ty;
 	u16 clampSClamp;
 	u16 clampTClamp;
 	GetTexelFunc GetTexel;
@@ -805,21 +1383,46 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 	clampSClamp = pTexture->width - 1;
 	clampTClamp = pTexture->height - 1;
 
-	j = 0;
-	for (y = 0; y < pTexture->realHeight; y++) {
-		ty = min(y, (u32)clampTClamp);
+	const TexelRowDecoder * pDecoder = getTexelRowDecoder(GetTexel);
+	const u32 rowWidth = pDecoder == nullptr ? 0 : min<u32>(pTexture->realWidth, clampSClamp + 1U);
+	u32 palette[256];
+	if (pDecoder != nullptr && pDecoder->paletteSize != 0)
+		loadTexelRowPalette(*pDecoder, pTexture->palette, palette);
+
+	// Rows are decoded independently, so large backgrounds are split into row bands for the decode workers
+	auto decodeRows = [&](u32 _firstRow, u32 _lastRow) {
+		u32 j = _firstRow * pTexture->realWidth;
+		for (u32 y = _firstRow; y < _lastRow; y++) {
+			const u32 ty = min(y, (u32)clampTClamp);
 
-		pSrc = &pSwapped[bpl * ty];
+			u8 *pSrc = &pSwapped[bpl * ty];
 
-		for (x = 0; x < pTexture->realWidth; x++) {
-			tx = min(x, (u32)clampSClamp);
+			if (rowWidth != 0) {
+				if (glInternalFormat == internalcolorFormat::RGBA8)
+					pDecoder->GetRow((u64*)pSrc, rowWidth, 0, palette, pDest + j);
+				else
+					pDecoder->GetRow((u64*)pSrc, rowWidth, 0, palette, pDest16 + j);
+				j += rowWidth;
+			}
+			for (u32 x = rowWidth; x < pTexture->realWidth; x++) {
+				const u32 tx = min(x, (u32)clampSClamp);
 
-			if (glInternalFormat == internalcolorFormat::RGBA8)
-				pDest[j++] = GetTexel((u64*)pSrc, tx, 0, pTexture->palette);
-			else
-				pDest16[j++] = static_cast<u16>(GetTexel((u64*)pSrc, tx, 0, pTexture->palette));
+				if (glInternalFormat == internalcolorFormat::RGBA8)
+					pDest[j++] = GetTexel((u64*)pSrc, tx, 0, pTexture->palette);
+				else
+					pDest16[j++] = static_cast<u16>(GetTexel((u64*)pSrc, tx, 0, pTexture->palette));
+			}
 		}
-	}
+	};
+
+	const u32 texels = pTexture->realWidth * pTexture->realHeight;
+	const u32 bands = texels < minParallelBackgroundTexels ? 1 :
+		min(m_decodeWorkers.size(), (u32)pTexture->realHeight);
+	const u32 bandHeight = (pTexture->realHeight + bands - 1) / bands;
+	m_decodeWorkers.run(bands, [&](u32 _band) {
+		const u32 firstRow = _band * bandHeight;
+		decodeRows(firstRow, min(firstRow + bandHeight, (u32)pTexture->realHeight));
+	});
 
 	if ((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress) {
 		_loadDepthTexture(pTexture, (u16*)pDest);
@@ -833,7 +1436,10 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 			config.textureFilter.txFilterIgnoreBG == 0 &&
 			TFH.isInited()) {
 		GHQTexInfo ghqTexInfo;
-		if (txfilter_filter((u8*)pDest, pTexture->realWidth, pTexture->realHeight,
+		if (_upscaleTexture(pTexture, textureIndices::Tex[0], pTexture->realWidth, pTexture->realHeight,
+				glInternalFormat, glType, pDest, m_curUnpackAlignment)) {
+			bLoaded = true;
+		} else if (txfilter_filter((u8*)pDest, pTexture->realWidth, pTexture->realHeight,
 				(u16)u32(glInternalFormat), (uint64)pTexture->crc, &ghqTexInfo) != 0 &&
 				ghqTexInfo.data != nullptr) {
 
@@ -853,10 +1459,12 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 			params.internalFormat = InternalColorFormatParam(ghqTexInfo.format);
 			params.dataType = DatatypeParam(ghqTexInfo.pixel_type);
 			params.data = ghqTexInfo.data;
+			params.dataSize = _getCompressedTextureSize(ghqTexInfo);
 			gfxContext.init2DTexture(params);
 			_updateCachedTexture(ghqTexInfo, pTexture, f32(ghqTexInfo.width) / f32(pTexture->realWidth));
 			bLoaded = true;
-		}
+		} else if (config.textureFilter.txAsyncFilter != 0)
+			pTexture->bFilterPending = true;
 	}
 	if (!bLoaded) {
 		if (pTexture->realWidth % 2 != 0 && glInternalFormat != internalcolorFormat::RGBA8)
@@ -871,7 +1479,8 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 		params.internalFormat = gfxContext.convertInternalTextureFormat(u32(glInternalFormat));
 		params.dataType = glType;
 		params.data = pDest;
-		gfxContext.init2DTexture(params);
+		initTexture(pTexture, params, _reuseTextureStorage(pTexture, params.mipMapLevel,
+			params.width, params.height, params.internalFormat, params.mipMapLevels));
 	}
 	if (m_curUnpackAlignment > 1)
 		gfxContext.setTextureUnpackAlignment(m_curUnpackAlignment);
@@ -958,6 +1567,7 @@ bool TextureCache::_loadHiresTexture(u32 _tile, CachedTexture *_pTexture, u64 &
 		params.format = ColorFormatParam(ghqTexInfo.texture_format);
 		params.dataType = DatatypeParam(ghqTexInfo.pixel_type);
 		params.data = ghqTexInfo.data;
+		params.dataSize = _getCompressedTextureSize(ghqTexInfo);
 		params.textureUnitIndex = textureIndices::Tex[_tile];
 		gfxContext.init2DTexture(params);
 		assert(!gfxContext.isError());
@@ -991,6 +1601,36 @@ void TextureCache::_loadDepthTexture(CachedTexture * _pTexture, u16* _pDest)
 	gfxContext.init2DTexture(params);
 }
 
+TexelWrap::TexelWrap(u8 _mask, u8 _clamp, u8 _mirror, u16 _width, u16 _clampWidth)
+{
+	if (_mask > 0) {
+		clamp = _clamp ? _clampWidth - 1 : (_mirror ? (_width << 1) - 1 : _width - 1);
+		mask = (1 << _mask) - 1;
+		mirror = _mirror != 0 ? 1 << _mask : 0;
+	} else {
+		clamp = _clamp ? _clampWidth - 1 : _width - 1;
+		mask = 0xFFFF;
+		mirror = 0x0000;
+	}
+}
+
+u32 getRGBA32Line(u16 _clampWidth, u16 _line)
+{
+	int wid_64 = _clampWidth << 2;
+	if (wid_64 & 15) {
+		wid_64 += 16;
+	}
+	wid_64 &= 0xFFFFFFF0;
+	wid_64 >>= 3;
+	int line32 = _line << 1;
+	line32 = (line32 - wid_64) << 3;
+	if (wid_64 < 1) {
+		wid_64 = 1;
+	}
+	int width = wid_64 << 1;
+	return width + (line32 >> 2);
+}
+
 /*
  * Worker function for _load
 */
@@ -1000,48 +1640,18 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 						GetTexelFunc GetTexel,
 						u16* pLine)
 {
-	u16 mirrorSBit, maskSMask, clampSClamp;
-	u16 mirrorTBit, maskTMask, clampTClamp;
+	const TexelWrap wrapS(tmptex.maskS, tmptex.clampS, tmptex.mirrorS, tmptex.width, tmptex.clampWidth);
+	const TexelWrap wrapT(tmptex.maskT, tmptex.clampT, tmptex.mirrorT, tmptex.height, tmptex.clampHeight);
+	const u16 mirrorSBit = wrapS.mirror, maskSMask = wrapS.mask, clampSClamp = wrapS.clamp;
+	const u16 mirrorTBit = wrapT.mirror, maskTMask = wrapT.mask, clampTClamp = wrapT.clamp;
 	u16 x, y, tx, ty;
 	u32 i, j;
 	u64 *pSrc;
-	if (tmptex.maskS > 0) {
-		clampSClamp = tmptex.clampS ? tmptex.clampWidth - 1 : (tmptex.mirrorS ? (tmptex.width << 1) - 1 : tmptex.width - 1);
-		maskSMask = (1 << tmptex.maskS) - 1;
-		mirrorSBit = tmptex.mirrorS != 0 ? 1 << tmptex.maskS : 0;
-	} else {
-		clampSClamp = tmptex.clampS ? tmptex.clampWidth - 1 : tmptex.width - 1;
-		maskSMask = 0xFFFF;
-		mirrorSBit = 0x0000;
-	}
-
-	if (tmptex.maskT > 0) {
-		clampTClamp = tmptex.clampT ? tmptex.clampHeight - 1 : (tmptex.mirrorT ? (tmptex.height << 1) - 1 : tmptex.height - 1);
-		maskTMask = (1 << tmptex.maskT) - 1;
-		mirrorTBit = tmptex.mirrorT != 0 ? 1 << tmptex.maskT : 0;
-	} else {
-		clampTClamp = tmptex.clampT ? tmptex.clampHeight - 1 : tmptex.height - 1;
-		maskTMask = 0xFFFF;
-		mirrorTBit = 0x0000;
-	}
 
 	if (tmptex.size == G_IM_SIZ_32b) {
 		const u16 * tmem16 = (u16*)TMEM;
 		const u32 tbase = tmptex.tMem << 2;
-
-		int wid_64 = (tmptex.clampWidth) << 2;
-		if (wid_64 & 15) {
-			wid_64 += 16;
-		}
-		wid_64 &= 0xFFFFFFF0;
-		wid_64 >>= 3;
-		int line32 = tmptex.line << 1;
-		line32 = (line32 - wid_64) << 3;
-		if (wid_64 < 1) {
-			wid_64 = 1;
-		}
-		int width = wid_64 << 1;
-		line32 = width + (line32 >> 2);
+		const u32 line32 = getRGBA32Line(tmptex.clampWidth, tmptex.line);
 
 		u16 gr, ab;
 
@@ -1078,6 +1688,14 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 			}
 		}
 	} else {
+		// Texels in front of the first clamped, wrapped or mirrored one are decoded a row at once.
+		const TexelRowDecoder * pDecoder = getTexelRowDecoder(GetTexel);
+		const u32 rowWidth = pDecoder == nullptr ? 0 :
+			min<u32>(tmptex.realWidth, min<u32>(clampSClamp + 1U, maskSMask + 1U));
+		u32 palette[256];
+		if (pDecoder != nullptr && pDecoder->paletteSize != 0)
+			loadTexelRowPalette(*pDecoder, tmptex.palette, palette);
+
 		j = 0;
 		const u32 tMemMask = gDP.otherMode.textureLUT == G_TT_NONE ? 0x1FF : 0xFF;
 		for (y = 0; y < tmptex.realHeight; ++y) {
@@ -1089,7 +1707,14 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 			pSrc = &TMEM[(tmptex.tMem + *pLine * ty) & tMemMask];
 
 			i = (ty & 1) << 1;
-			for (x = 0; x < tmptex.realWidth; ++x) {
+			if (rowWidth != 0) {
+				if (glInternalFormat == internalcolorFormat::RGBA8)
+					pDecoder->GetRow(pSrc, rowWidth, i, palette, pDest + j);
+				else
+					pDecoder->GetRow(pSrc, rowWidth, i, palette, (u16*)pDest + j);
+				j += rowWidth;
+			}
+			for (x = rowWidth; x < tmptex.realWidth; ++x) {
 				tx = min(x, clampSClamp) & maskSMask;
 
 				if (x & mirrorSBit) {
@@ -1184,7 +1809,10 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 				TFH.isInited())
 		{
 			GHQTexInfo ghqTexInfo;
-			if (txfilter_filter((u8*)pDest, tmptex.realWidth, tmptex.realHeight,
+			if (_upscaleTexture(_pTexture, textureIndices::Tex[_tile], tmptex.realWidth, tmptex.realHeight,
+					glInternalFormat, glType, pDest, m_curUnpackAlignment)) {
+				bLoaded = true;
+			} else if (txfilter_filter((u8*)pDest, tmptex.realWidth, tmptex.realHeight,
 							(u16)u32(glInternalFormat), (uint64)_pTexture->crc,
 							&ghqTexInfo) != 0 && ghqTexInfo.data != nullptr) {
 				ghqTexInfo.format = gfxContext.convertInternalTextureFormat(ghqTexInfo.format);
@@ -1199,10 +1827,12 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 				params.format = ColorFormatParam(ghqTexInfo.texture_format);
 				params.dataType = DatatypeParam(ghqTexInfo.pixel_type);
 				params.data = ghqTexInfo.data;
+				params.dataSize = _getCompressedTextureSize(ghqTexInfo);
 				gfxContext.init2DTexture(params);
 				_updateCachedTexture(ghqTexInfo, _pTexture, f32(ghqTexInfo.width) / f32(tmptex.realWidth));
 				bLoaded = true;
-			}
+			} else if (config.textureFilter.txAsyncFilter != 0)
+				_pTexture->bFilterPending = true;
 		}
 		if (!bLoaded) {
 			if (tmptex.realWidth % 2 != 0 &&
@@ -1221,7 +1851,8 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 			params.format = colorFormat::RGBA;
 			params.dataType = glType;
 			params.data = pDest;
-			gfxContext.init2DTexture(params);
+			initTexture(_pTexture, params, _reuseTextureStorage(_pTexture, params.mipMapLevel,
+				params.width, params.height, params.internalFormat, params.mipMapLevels));
 		}
 		if (mipLevel == _pTexture->max_level)
 			break;
@@ -1290,8 +1921,108 @@ u32 _calculateCRC(u32 _t, const TextureParams & _params, u32 _bytes)
 	return crc;
 }
 
+// Texel functions the combiner shader can replace, see TMEMTexture.h.
+// Only functions whose result the shader reproduces exactly are listed.
+static const struct
+{
+	GetTexelFunc	Get;
+	u8				format;
+} tmemFormats[] =
+{
+	{ GetNone, CachedTexture::tmemBlack },
+	{ GetI4_RGBA4444, CachedTexture::tmemI4 },
+	{ GetI4_RGBA8888, CachedTexture::tmemI4 },
+	{ GetIA31_RGBA4444, CachedTexture::tmemIA31 },
+	{ GetI8_RGBA8888, CachedTexture::tmemI8 },
+	{ GetIA44_RGBA4444, CachedTexture::tmemIA44 },
+	{ GetIA44_RGBA8888, CachedTexture::tmemIA44 },
+	{ GetRGBA5551_RGBA5551, CachedTexture::tmemRGBA16 },
+	{ GetRGBA5551_RGBA8888, CachedTexture::tmemRGBA16 },
+	{ GetIA88_RGBA8888, CachedTexture::tmemIA16 },
+	{ GetCI4RGBA_RGBA5551, CachedTexture::tmemCI4RGBA },
+	{ GetCI4RGBA_RGBA8888, CachedTexture::tmemCI4RGBA },
+	{ GetCI4IA_RGBA8888, CachedTexture::tmemCI4IA },
+	{ GetCI8RGBA_RGBA5551, CachedTexture::tmemCI8RGBA },
+	{ GetCI8RGBA_RGBA8888, CachedTexture::tmemCI8RGBA },
+	{ GetCI8IA_RGBA8888, CachedTexture::tmemCI8IA },
+	{ GetCI16RGBA_RGBA5551, CachedTexture::tmemCI16RGBA },
+	{ GetCI16RGBA_RGBA8888, CachedTexture::tmemCI16RGBA },
+	{ GetCI16IA_RGBA8888, CachedTexture::tmemCI16IA },
+};
+
+u8 TextureCache::_getTMEMFormat(u32 _t, const gDPTile & _tile) const
+{
+	if (!g_tmemTexture.isActive() ||
+		config.textureFilter.txHiresEnable != 0 ||
+		(config.textureFilter.txEnhancementMode | config.textureFilter.txFilterMode) != 0 ||
+		currentCombiner()->usesLOD() ||
+		_tile.format == G_IM_FMT_YUV)
+		return CachedTexture::tmemNone;
+
+	// The shader reads TMEM only where it would filter the texture, not for YUV conversion.
+	const u32 bilerp = _t == 0 ? gDP.otherMode.bi_lerp0 : gDP.otherMode.bi_lerp1;
+	if (bilerp == 0 && gDP.otherMode.cycleType != G_CYC_COPY)
+		return CachedTexture::tmemNone;
+
+	if ((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress)
+		return CachedTexture::tmemNone;
+
+	const TextureLoadParameters & loadParams =
+			ImageFormat::get().tlp[gDP.otherMode.textureLUT][_tile.size][_tile.format];
+	const bool rgba8 = loadParams.autoFormat == internalcolorFormat::RGBA8;
+	if (_tile.size == G_IM_SIZ_32b)
+		return rgba8 ? CachedTexture::tmemRGBA32 : CachedTexture::tmemNone;
+
+	const GetTexelFunc GetTexel = rgba8 ? loadParams.Get32 : loadParams.Get16;
+	for (const auto & f : tmemFormats) {
+		if (f.Get == GetTexel)
+			return f.format;
+	}
+	return CachedTexture::tmemNone;
+}
+
+void TextureCache::_updateTMEMTile(u32 _t, const gDPTile & _tile, const TileSizes & _sizes, u8 _format)
+{
+	CachedTexture & tile = m_tmemTiles[_t];
+	tile.address = gDP.loadInfo[_tile.tmem].texAddress;
+	tile.format = _tile.format;
+	tile.size = _tile.size;
+	tile.width = _sizes.width;
+	tile.height = _sizes.height;
+	tile.clampWidth = _sizes.clampWidth;
+	tile.clampHeight = _sizes.clampHeight;
+	tile.palette = _tile.palette;
+	tile.maskS = _tile.masks;
+	tile.maskT = _tile.maskt;
+	tile.mirrorS = _tile.mirrors;
+	tile.mirrorT = _tile.mirrort;
+	tile.clampS = _tile.clamps;
+	tile.clampT = _tile.clampt;
+	tile.line = _tile.line;
+	tile.tMem = _tile.tmem;
+	tile.realWidth = _sizes.realWidth;
+	tile.realHeight = _sizes.realHeight;
+	tile.scaleS = 1.0f / (f32)(tile.realWidth);
+	tile.scaleT = 1.0f / (f32)(tile.realHeight);
+	tile.offsetS = 0.5f;
+	tile.offsetT = 0.5f;
+	tile.textureBytes = 0;
+	tile.tmemFormat = _format;
+	activateTexture(_t, &tile);
+}
+
 void TextureCache::activateTexture(u32 _t, CachedTexture *_pTexture)
 {
+	if (_pTexture->tmemFormat != CachedTexture::tmemNone) {
+		_pTexture->tmemWrapS = _pTexture->clampS ? TMEMTexture::wrapClamp :
+			_pTexture->mirrorS ? TMEMTexture::wrapMirror : TMEMTexture::wrapRepeat;
+		_pTexture->tmemWrapT = _pTexture->clampT ? TMEMTexture::wrapClamp :
+			_pTexture->mirrorT ? TMEMTexture::wrapMirror : TMEMTexture::wrapRepeat;
+		activateDummy(_t);
+		g_tmemTexture.update();
+		current[_t] = _pTexture;
+		return;
+	}
 
 	Context::TexParameters params;
 	params.handle = _pTexture->name;
@@ -1384,11 +2115,10 @@ void TextureCache::_updateBackground()
 	u32 params[4] = {gSP.bgImage.width, gSP.bgImage.height, gSP.bgImage.format, gSP.bgImage.size};
 	crc = CRC_Calculate(crc, params, sizeof(u32)*4);
 
-	Texture_Locations::iterator locations_iter = m_lruTextureLocations.find(crc);
-	if (locations_iter != m_lruTextureLocations.end()) {
-		Textures::iterator iter = locations_iter->second;
-		CachedTexture & currentTex = *iter;
-		m_textures.splice(m_textures.begin(), m_textures, iter);
+	const u32 cachedEntry = _findEntry(crc);
+	if (cachedEntry != m_noEntry && !_reloadFiltered(cachedEntry)) {
+		CachedTexture & currentTex = m_entries[cachedEntry].texture;
+		_touchEntry(cachedEntry);
 
 		assert(currentTex.width == gSP.bgImage.width);
 		assert(currentTex.height == gSP.bgImage.height);
@@ -1438,6 +2168,8 @@ void TextureCache::_updateBackground()
 	pCurrent->offsetT = 0.5f;
 
 	_loadBackground(pCurrent);
+	m_cachedBytes += pCurrent->textureBytes;
+	perf.addTextureUpload(pCurrent->textureBytes);
 	activateTexture(0, pCurrent);
 
 	current[0] = pCurrent;
@@ -1447,11 +2179,10 @@ void TextureCache::_clear()
 {
 	current[0] = current[1] = nullptr;
 
-	for (auto cur = m_textures.cbegin(); cur != m_textures.cend(); ++cur) {
-		gfxContext.deleteTexture(cur->name);
-	}
-	m_textures.clear();
-	m_lruTextureLocations.clear();
+	for (u32 entry = m_lruHead; entry != m_noEntry; entry = m_entries[entry].next)
+		gfxContext.deleteTexture(m_entries[entry].texture.name);
+	_resetEntries();
+	_clearTexturePool();
 }
 
 void TextureCache::update(u32 _t)
@@ -1510,6 +2241,13 @@ void TextureCache::update(u32 _t)
 
 	TileSizes sizes;
 	_calcTileSizes(_t, sizes, gDP.loadTile);
+
+	const u8 tmemFormat = _getTMEMFormat(_t, *pTile);
+	if (tmemFormat != CachedTexture::tmemNone) {
+		_updateTMEMTile(_t, *pTile, sizes, tmemFormat);
+		return;
+	}
+
 	TextureParams params;
 	params.flags = pTile->masks	|
 		(pTile->maskt   << 4)	|
@@ -1525,18 +2263,17 @@ void TextureCache::update(u32 _t)
 
 	const u32 crc = _calculateCRC(_t, params, sizes.bytes);
 
-	if (current[_t] != nullptr && current[_t]->crc == crc) {
+	if (current[_t] != nullptr && current[_t]->crc == crc && !current[_t]->bFilterPending) {
 		activateTexture(_t, current[_t]);
 		return;
 	}
 
-	Texture_Locations::iterator locations_iter = m_lruTextureLocations.find(crc);
-	if (locations_iter != m_lruTextureLocations.end()) {
-		Textures::iterator iter = locations_iter->second;
-		CachedTexture & currentTex = *iter;
+	const u32 cachedEntry = _findEntry(crc);
+	if (cachedEntry != m_noEntry && !_reloadFiltered(cachedEntry)) {
+		CachedTexture & currentTex = m_entries[cachedEntry].texture;
 
 		if (currentTex.width == sizes.width && currentTex.height == sizes.height) {
-			m_textures.splice(m_textures.begin(), m_textures, iter);
+			_touchEntry(cachedEntry);
 
 			assert(currentTex.format == pTile->format);
 			assert(currentTex.size == pTile->size);
@@ -1546,9 +2283,7 @@ void TextureCache::update(u32 _t)
 			return;
 		}
 
-		gfxContext.deleteTexture(currentTex.name);
-		m_lruTextureLocations.erase(locations_iter);
-		m_textures.erase(iter);
+		_removeEntry(cachedEntry);
 	}
 
 	m_misses++;
@@ -1593,6 +2328,8 @@ void TextureCache::update(u32 _t)
 	pCurrent->offsetT = 0.5f;
 
 	_load(_t, pCurrent);
+	m_cachedBytes += pCurrent->textureBytes;
+	perf.addTextureUpload(pCurrent->textureBytes);
 	activateTexture( _t, pCurrent );
 
 	current[_t] = pCurrent;
@@ -3,8 +3,9 @@
 
 #include <map>
 #include <unordered_map>
-#include <list>
+#include <vector>
 
+#include "BandWorkers.h"
 #include "CRC.h"
 #include "convert.h"
 #include "Graphics/ObjectHandle.h"
@@ -12,9 +13,12 @@
 
 typedef u32 (*GetTexelFunc)( u64 *src, u16 x, u16 i, u8 palette );
 
+struct gDPTile;
+struct TileSizes;
+
 struct CachedTexture
 {
-	CachedTexture(graphics::ObjectHandle _name) : name(_name), max_level(0), frameBufferTexture(fbNone), bHDTexture(false) {}
+	CachedTexture(graphics::ObjectHandle _name) : name(_name), max_level(0), frameBufferTexture(fbNone), tmemFormat(tmemNone), bHDTexture(false), bFilterPending(false) {}
 
 	graphics::ObjectHandle name;
 	u32		crc = 0;
@@ -35,6 +39,7 @@ struct CachedTexture
 	f32		scaleS, scaleT;			  // Scale to map to 0.0-1.0
 	f32		shiftScaleS, shiftScaleT; // Scale to shift
 	u32		textureBytes;
+	u64		storageKey = 0;			  // Size, format and levels of immutable storage, 0 if not pooled
 
 	u32		address;
 	u8		max_level;
@@ -43,9 +48,41 @@ struct CachedTexture
 		fbOneSample = 1,
 		fbMultiSample = 2
 	} frameBufferTexture;
+	// Tiles with tmemFormat set have no texture object, the combiner shader
+	// decodes their texels from TMEM, see TMEMTexture.h. Values are used by the shader.
+	enum {
+		tmemNone = 0,
+		tmemBlack,
+		tmemI4,
+		tmemIA31,
+		tmemI8,
+		tmemIA44,
+		tmemRGBA16,
+		tmemIA16,
+		tmemRGBA32,
+		tmemCI4RGBA,
+		tmemCI4IA,
+		tmemCI8RGBA,
+		tmemCI8IA,
+		tmemCI16RGBA,
+		tmemCI16IA
+	};
+	u8 tmemFormat;
+	u8 tmemWrapS, tmemWrapT;	// TMEMTexture::WrapMode, set like the wrap mode of texture objects
 	bool bHDTexture;
+	bool bFilterPending;	// Loaded unfiltered, filtered texture is being prepared in background
 };
 
+// Maps a texel coordinate of a tile to the texel loaded into TMEM:
+// x -> (min(x, clamp) & mask) ^ ((x & mirror) != 0 ? mask : 0)
+struct TexelWrap
+{
+	TexelWrap(u8 _mask, u8 _clamp, u8 _mirror, u16 _width, u16 _clampWidth);
+	u16 clamp, mask, mirror;
+};
+
+// Line of a 32-bit texture in 16-bit TMEM words.
+u32 getRGBA32Line(u16 _clampWidth, u16 _line);
 
 struct TextureCache
 {
@@ -59,6 +96,7 @@ struct TextureCache
 	void activateDummy(u32 _t);
 	void activateMSDummy(u32 _t);
 	void update(u32 _t);
+	size_t trim(bool _all);
 
 	static TextureCache & get();
 
@@ -66,10 +104,16 @@ private:
 	TextureCache()
 		: m_pDummy(nullptr)
 		, m_pMSDummy(nullptr)
+		, m_lruHead(m_noEntry)
+		, m_lruTail(m_noEntry)
+		, m_freeEntry(m_noEntry)
+		, m_cachedBytes(0)
+		, m_pooledBytes(0)
 		, m_hits(0)
 		, m_misses(0)
 		, m_curUnpackAlignment(4)
 		, m_toggleDumpTex(false)
+		, m_tmemTiles(2, CachedTexture(graphics::ObjectHandle()))
 	{
 		current[0] = nullptr;
 		current[1] = nullptr;
@@ -77,6 +121,13 @@ private:
 	}
 	TextureCache(const TextureCache &) = delete;
 
+	u32 _findEntry(u32 _crc32) const;
+	void _touchEntry(u32 _entry);
+	void _unlinkEntry(u32 _entry);
+	void _removeEntry(u32 _entry);
+	bool _reloadFiltered(u32 _entry);
+	void _resetEntries();
+	bool _isCurrent(u32 _entry) const;
 	void _checkCacheSize();
 	CachedTexture * _addTexture(u32 _crc32);
 	void _load(u32 _tile, CachedTexture *_pTexture);
@@ -85,25 +136,57 @@ private:
 	bool _loadHiresBackground(CachedTexture *_pTexture);
 	void _loadDepthTexture(CachedTexture * _pTexture, u16* _pDest);
 	void _updateBackground();
+	u8 _getTMEMFormat(u32 _t, const gDPTile & _tile) const;
+	void _updateTMEMTile(u32 _t, const gDPTile & _tile, const TileSizes & _sizes, u8 _format);
 	void _clear();
+	void _clearTexturePool();
+	bool _reuseTextureStorage(CachedTexture * _pTexture, u32 _mipMapLevel, u32 _width, u32 _height, graphics::Parameter _internalFormat, u32 _mipMapLevels);
 	void _initDummyTexture(CachedTexture * _pDummy);
 	void _getTextureDestData(CachedTexture& tmptex, u32* pDest, graphics::Parameter glInternalFormat, GetTexelFunc GetTexel, u16* pLine);
 
-	typedef std::list<CachedTexture> Textures;
-	typedef std::unordered_map<u32, Textures::iterator> Texture_Locations;
+	// Cache entries are preallocated once, so texture misses do not allocate.
+	// Unused entries are chained through next into a free list, used ones form
+	// an intrusive LRU list with the most recently used entry at m_lruHead.
+	struct CacheEntry
+	{
+		CacheEntry() : texture(graphics::ObjectHandle()), prev(m_noEntry), next(m_noEntry) {}
+		CachedTexture texture;
+		u32 prev, next;
+	};
+
 	typedef std::unordered_map<u32, CachedTexture> FBTextures;
-	Textures m_textures;
-	Texture_Locations m_lruTextureLocations;
+	typedef std::unordered_multimap<u64, CachedTexture> TexturePool;
+	std::vector<CacheEntry> m_entries;
+	// Open addressing CRC index with linear probing. Holds entry numbers.
+	std::vector<u32> m_index;
 	FBTextures m_fbTextures;
+	// Evicted textures with immutable storage, keyed by storageKey, and
+	// texture names left without storage when a pooled texture is reused.
+	TexturePool m_texturePool;
+	std::vector<graphics::ObjectHandle> m_spareTextures;
 	CachedTexture * m_pDummy;
 	CachedTexture * m_pMSDummy;
+	u32 m_lruHead, m_lruTail, m_freeEntry;
+	size_t m_cachedBytes;
+	size_t m_pooledBytes;
 	u32 m_hits, m_misses;
 	s32 m_curUnpackAlignment;
 	bool m_toggleDumpTex;
+	// Tiles read from TMEM by the shaders. Not cached, TMEM is uploaded at once.
+	std::vector<CachedTexture> m_tmemTiles;
+	// Threads decoding row bands of large backgrounds
+	BandWorkers m_decodeWorkers;
+	static const u32 m_noEntry = 0xFFFFFFFF;
 #ifdef VC
-	const size_t m_maxCacheSize = 3500;
+	static const u32 m_maxCacheSize = 3500;
+	static const u32 m_maxPoolSize = 128;
+	static const u32 m_indexSize = 8192;
+	static const size_t m_maxCacheBytes = 64 * 1024 * 1024;
 #else
-	const size_t m_maxCacheSize = 8000;
+	static const u32 m_maxCacheSize = 8000;
+	static const u32 m_maxPoolSize = 512;
+	static const u32 m_indexSize = 16384;
+	static const size_t m_maxCacheBytes = 256 * 1024 * 1024;
 #endif
 };
 
@@ -46,3 +46,15 @@ txfilter_reloadhirestex()
 TAPI void TAPIENTRY
 txfilter_dumpcache(void)
 {}
+
+TAPI boolean TAPIENTRY
+txfilter_filterready(uint64 g64crc)
+{
+	return 0;
+}
+
+TAPI uint32 TAPIENTRY
+txfilter_trimcache(boolean all)
+{
+	return 0;
+}
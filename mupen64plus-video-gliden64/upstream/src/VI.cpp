@@ -112,6 +112,7 @@ void VI_UpdateScreen()
 		return;
 	if (wnd.resizeWindow())
 		return;
+	wnd.updateDynamicResolution();
 	wnd.saveScreenshot();
 	g_debugger.checkDebugState();
 
@@ -0,0 +1,45 @@
+#include "VertexCache.h"
+
+#define VERTEX_CACHE_SIZE 512U
+
+VertexCache::VertexCache()
+: m_entries(VERTEX_CACHE_SIZE)
+{
+}
+
+u32 VertexCache::_getSlot(u32 _address, u32 _count)
+{
+	// Vertex addresses are 16 bytes aligned
+	return ((_address >> 4) ^ (_address >> 13) ^ (_count << 5)) & (VERTEX_CACHE_SIZE - 1);
+}
+
+const SPVertex * VertexCache::find(u32 _address, u32 _count, u64 _key) const
+{
+	const Entry & entry = m_entries[_getSlot(_address, _count)];
+	if (entry.address != _address || entry.count != _count || entry.key != _key)
+		return nullptr;
+	return entry.vertices.data();
+}
+
+void VertexCache::store(u32 _address, u32 _count, u64 _key, const SPVertex * _vertices)
+{
+	Entry & entry = m_entries[_getSlot(_address, _count)];
+	entry.address = _address;
+	entry.count = _count;
+	entry.key = _key;
+	entry.vertices.assign(_vertices, _vertices + _count);
+}
+
+void VertexCache::clear()
+{
+	for (Entry & entry : m_entries) {
+		entry.count = 0;
+		entry.vertices.clear();
+	}
+}
+
+VertexCache & VertexCache::get()
+{
+	static VertexCache cache;
+	return cache;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "Types.h"
+#include "gSP.h"
+
+// Transformed and lit vertices of recent gSPVertex loads.
+// An entry is found by RDRAM address and vertex count and is valid only if
+// its key, a hash of the vertex data and of all gSP state which affects
+// vertex processing, matches. HUDs and menus load the same vertices with
+// the same matrices every frame, they are copied from here instead of
+// being processed again. Used with config.generalEmulation.enableVertexCache.
+class VertexCache
+{
+public:
+	const SPVertex * find(u32 _address, u32 _count, u64 _key) const;
+	void store(u32 _address, u32 _count, u64 _key, const SPVertex * _vertices);
+	void clear();
+
+	static VertexCache & get();
+
+private:
+	VertexCache();
+
+	struct Entry
+	{
+		u32 address = 0;
+		u32 count = 0;
+		u64 key = 0;
+		std::vector<SPVertex> vertices;
+	};
+
+	static u32 _getSlot(u32 _address, u32 _count);
+
+	std::vector<Entry> m_entries;
+};
@@ -745,6 +745,9 @@ void gDPFillRectangle( s32 ulx, s32 uly, s32 lrx, s32 lry )
 				(lry == gDP.scissor.lry)) {
 				frameBufferList().fillRDRAM(ulx, uly, lrx, lry);
 				drawer.clearColorBuffer(fillColor);
+				// Clear ignores scissor
+				if (frameBufferList().getCurrent() != nullptr)
+					frameBufferList().getCurrent()->setAllRowsDirty();
 			} else {
 				gDP.rectColor.r = fillColor[0];
 				gDP.rectColor.g = fillColor[1];
@@ -758,7 +761,7 @@ void gDPFillRectangle( s32 ulx, s32 uly, s32 lrx, s32 lry )
 		}
 	}
 
-	frameBufferList().setBufferChanged(f32(lry));
+	frameBufferList().setBufferChanged(f32(uly), f32(lry));
 
 	DebugMsg( DEBUG_NORMAL, "gDPFillRectangle #%i- #%i ( %i, %i, %i, %i );\n", gSP.tri_num, gSP.tri_num +1, ulx, uly, lrx, lry );
 	gSP.tri_num += 2;
@@ -835,7 +838,7 @@ void gDPTextureRectangle(f32 ulx, f32 uly, f32 lrx, f32 lry, s32 tile, s16 s, s1
 	gSP.textureTile[0] = textureTileOrg[0];
 	gSP.textureTile[1] = textureTileOrg[1];
 
-	frameBufferList().setBufferChanged(lry);
+	frameBufferList().setBufferChanged(uly, lry);
 
 	if (flip)
 		DebugMsg( DEBUG_NORMAL, "gDPTextureRectangleFlip( %f, %f, %f, %f, %i, %f, %f, %f, %f);\n",
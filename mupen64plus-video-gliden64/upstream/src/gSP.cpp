@@ -18,6 +18,9 @@
 #include "VI.h"
 #include "FrameBuffer.h"
 #include "DepthBuffer.h"
+#include "gSPVertexSoA.h"
+#include "VertexCache.h"
+#include "xxHash/xxhash.h"
 #include "Config.h"
 #include "Log.h"
 
@@ -51,7 +54,9 @@ void gSPFlushTriangles()
 		(RSP.nextCmd != G_TRIX) &&
 		(RSP.nextCmd != G_QUAD)
 		) {
-		dwnd().getDrawer().drawTriangles();
+		// Triangles followed by a vertex load are usually followed by more triangles
+		// with the same state. RSP_ProcessDList draws them if anything else comes first.
+		dwnd().getDrawer().drawTriangles(RSP.nextCmd == G_VTX);
 		DebugMsg(DEBUG_NORMAL, "Triangles flushed;\n");
 	}
 }
@@ -768,21 +773,8 @@ void gSPTransformVertex(u32 v, SPVertex * spVtx, float mtx[4][4])
 }
 
 template <u32 VNUM>
-void gSPProcessVertex(u32 v, SPVertex * spVtx)
+void gSPTransformClipVertex(u32 v, SPVertex * spVtx)
 {
-	if (gSP.changed & CHANGED_MATRIX)
-		_gSPCombineMatrices();
-
-	float vPos[VNUM][4];
-	for(u32 i = 0; i < VNUM; ++i) {
-		SPVertex & vtx = spVtx[v+i];
-		vPos[i][0] = vtx.x;
-		vPos[i][1] = vtx.y;
-		vPos[i][2] = vtx.z;
-		vPos[i][3] = 0.0f;
-		vtx.modify = 0;
-	}
-
 	gSPTransformVertex<VNUM>(v, spVtx, gSP.matrix.combined );
 
 	if (dwnd().isAdjustScreen() && (gDP.colorImage.width > VI.width * 98 / 100)) {
@@ -811,8 +803,51 @@ void gSPProcessVertex(u32 v, SPVertex * spVtx)
 		gSPBillboardVertex<VNUM>(v, spVtx);
 
 	gSPClipVertex<VNUM>(v, spVtx);
+}
+
+template <u32 VNUM>
+void gSPProcessVertex(u32 v, SPVertex * spVtx)
+{
+	if (gSP.changed & CHANGED_MATRIX)
+		_gSPCombineMatrices();
+
+	float vPos[VNUM][4];
+	for(u32 i = 0; i < VNUM; ++i) {
+		SPVertex & vtx = spVtx[v+i];
+		vPos[i][0] = vtx.x;
+		vPos[i][1] = vtx.y;
+		vPos[i][2] = vtx.z;
+		vPos[i][3] = 0.0f;
+		vtx.modify = 0;
+	}
+
+#ifdef __VERTEX_SOA
+	// Vertex 0 is the billboard origin, so it has to be processed before the others.
+	if (VNUM == 4 && (gSP.matrix.billboard == 0 || v != 0)) {
+		f32 scale[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		if (dwnd().isAdjustScreen() && (gDP.colorImage.width > VI.width * 98 / 100)) {
+			const f32 adjustScale = dwnd().getAdjustScale();
+			scale[0] = adjustScale;
+			if (gSP.matrix.projection[3][2] == -1.f)
+				scale[3] = adjustScale;
+		}
+		if (gSP.viewport.vscale[0] < 0)
+			scale[0] = -scale[0];
+		if (gSP.viewport.vscale[1] < 0)
+			scale[1] = -scale[1];
+		gSPTransformVertex4SoA(&spVtx[v], gSP.matrix.combined, scale, gSP.matrix.billboard != 0 ? &spVtx[0] : nullptr);
+	} else
+#endif // __VERTEX_SOA
+		gSPTransformClipVertex<VNUM>(v, spVtx);
 
 	if (gSP.geometryMode & G_LIGHTING) {
+#ifdef __VERTEX_SOA
+		if (VNUM == 4 && !g_ConkerUcode && (gSP.geometryMode & G_POINT_LIGHTING) != 0)
+			gSPPointLightVertex4SoA(vPos, &spVtx[v]);
+		else if (VNUM == 4 && !g_ConkerUcode && !isHWLightingAllowed())
+			gSPLightVertex4SoA(&spVtx[v]);
+		else
+#endif // __VERTEX_SOA
 		if (gSP.geometryMode & G_POINT_LIGHTING)
 			gSPPointLightVertex<VNUM>(v, vPos, spVtx);
 		else
@@ -859,7 +894,7 @@ void gSPProcessVertex(u32 v, SPVertex * spVtx)
 		gSPPointLightVertexAcclaim<VNUM>(v, spVtx);
 	} else {
 		for(u32 i = 0; i < VNUM; ++i)
-			spVtx[v].HWLight = 0;
+			spVtx[v+i].HWLight = 0;
 	}
 
 	for(u32 i = 0; i < VNUM; ++i) {
@@ -906,6 +941,88 @@ u32 gSPLoadVertexData(const Vertex *orgVtx, SPVertex * spVtx, u32 v0, u32 vi, u3
 	return vi;
 }
 
+// Computes the key of vertices loaded with current gSP state.
+// Returns false if the result of vertex processing depends on something else.
+static
+bool gSPGetVertexCacheKey(const Vertex * _vertex, u32 _n, u64 & _key)
+{
+	if (g_ConkerUcode || gSP.matrix.billboard != 0)
+		return false;
+
+	const bool lighting = (gSP.geometryMode & (G_LIGHTING | G_ACCLAIM_LIGHTING)) != 0;
+	const bool textureGen = (gSP.geometryMode & (G_LIGHTING | G_TEXTURE_GEN)) == (G_LIGHTING | G_TEXTURE_GEN);
+	if (textureGen && GBI.getMicrocodeType() == F3DFLX2)
+		return false;
+
+	if (gSP.changed & CHANGED_MATRIX)
+		_gSPCombineMatrices();
+
+	struct
+	{
+		f32 combined[4][4];
+		f32 modelView[4][4];
+		f32 vscale[2];
+		f32 adjustScale;
+		f32 projection32;
+		u32 geometryMode;
+		u32 numLights;
+		u32 hwLighting;
+		u32 lookatEnable;
+	} state;
+	memset(&state, 0, sizeof(state));
+
+	memcpy(state.combined, gSP.matrix.combined, sizeof(state.combined));
+	if (lighting || textureGen)
+		memcpy(state.modelView, gSP.matrix.modelView[gSP.matrix.modelViewi], sizeof(state.modelView));
+	state.vscale[0] = gSP.viewport.vscale[0];
+	state.vscale[1] = gSP.viewport.vscale[1];
+	if (dwnd().isAdjustScreen() && (gDP.colorImage.width > VI.width * 98 / 100))
+		state.adjustScale = dwnd().getAdjustScale();
+	state.projection32 = gSP.matrix.projection[3][2];
+	state.geometryMode = gSP.geometryMode;
+	state.numLights = gSP.numLights;
+	state.hwLighting = isHWLightingAllowed() ? 1 : 0;
+	state.lookatEnable = gSP.lookatEnable ? 1 : 0;
+
+	u64 key = XXH64(_vertex, sizeof(Vertex) * _n, 0);
+	key = XXH64(&state, sizeof(state), key);
+	if (lighting)
+		key = XXH64(&gSP.lights, sizeof(gSP.lights), key);
+	if (textureGen)
+		key = XXH64(gSP.lookat.i_xyz, sizeof(gSP.lookat.i_xyz), key);
+	_key = key;
+	return true;
+}
+
+// Copies the vertex attributes written by gSPLoadVertexData
+static
+void gSPCopyCachedVertices(const SPVertex * _src, SPVertex * _dst, u32 _n)
+{
+	const bool normals = (gSP.geometryMode & G_LIGHTING) != 0;
+	for (u32 i = 0; i < _n; ++i) {
+		const SPVertex & src = _src[i];
+		SPVertex & dst = _dst[i];
+		dst.x = src.x;
+		dst.y = src.y;
+		dst.z = src.z;
+		dst.w = src.w;
+		if (normals) {
+			dst.nx = src.nx;
+			dst.ny = src.ny;
+			dst.nz = src.nz;
+		}
+		dst.r = src.r;
+		dst.g = src.g;
+		dst.b = src.b;
+		dst.a = src.a;
+		dst.s = src.s;
+		dst.t = src.t;
+		dst.modify = src.modify;
+		dst.HWLight = src.HWLight;
+		dst.clip = src.clip;
+	}
+}
+
 void gSPVertex(u32 a, u32 n, u32 v0)
 {
 	DebugMsg(DEBUG_NORMAL, "gSPVertex n = %i, v0 = %i, from %08x\n", n, v0, a);
@@ -934,9 +1051,24 @@ void gSPVertex(u32 a, u32 n, u32 v0)
 
 	const Vertex *vertex = (Vertex*)&RDRAM[address];
 	SPVertex * spVtx = dwnd().getDrawer().getVertexPtr(0);
+
+	u64 cacheKey = 0;
+	const bool useCache = config.generalEmulation.enableVertexCache != 0 && n != 0 &&
+		gSPGetVertexCacheKey(vertex, n, cacheKey);
+	if (useCache) {
+		const SPVertex * cached = VertexCache::get().find(address, n, cacheKey);
+		if (cached != nullptr) {
+			gSPCopyCachedVertices(cached, spVtx + v0, n);
+			return;
+		}
+	}
+
 	u32 i = gSPLoadVertexData<VEC_OPT>(vertex, spVtx, v0, v0, n);
 	if (i < n + v0)
 		gSPLoadVertexData<1>(vertex + (i - v0), spVtx, v0, i, n);
+
+	if (useCache)
+		VertexCache::get().store(address, n, cacheKey, spVtx + v0);
 }
 
 template <u32 VNUM>
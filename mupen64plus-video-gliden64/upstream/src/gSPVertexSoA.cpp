@@ -0,0 +1,277 @@
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "gSPVertexSoA.h"
+
+#ifdef __VERTEX_SOA
+
+#include "gSP.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Thin wrappers, so every stage is written once for SSE and NEON.
+	// Comparisons return lane masks. Selects are used instead of min/max
+	// to keep results of the scalar code for NaN inputs.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	typedef float32x4_t f32x4;
+
+	inline f32x4 vLoad(const f32 * _p) { return vld1q_f32(_p); }
+	inline void vStore(f32 * _p, f32x4 _a) { vst1q_f32(_p, _a); }
+	inline f32x4 vSet1(f32 _a) { return vdupq_n_f32(_a); }
+	inline f32x4 vAdd(f32x4 _a, f32x4 _b) { return vaddq_f32(_a, _b); }
+	inline f32x4 vSub(f32x4 _a, f32x4 _b) { return vsubq_f32(_a, _b); }
+	inline f32x4 vMul(f32x4 _a, f32x4 _b) { return vmulq_f32(_a, _b); }
+	inline f32x4 vCmpgt(f32x4 _a, f32x4 _b) { return vreinterpretq_f32_u32(vcgtq_f32(_a, _b)); }
+	inline f32x4 vCmplt(f32x4 _a, f32x4 _b) { return vreinterpretq_f32_u32(vcltq_f32(_a, _b)); }
+	inline f32x4 vSelect(f32x4 _mask, f32x4 _a, f32x4 _b) { return vbslq_f32(vreinterpretq_u32_f32(_mask), _a, _b); }
+	inline f32x4 vAnd(f32x4 _mask, f32x4 _a) {
+		return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(_mask), vreinterpretq_u32_f32(_a)));
+	}
+	inline f32x4 vTruncate(f32x4 _a) { return vcvtq_f32_s32(vcvtq_s32_f32(_a)); }
+#ifdef __aarch64__
+	inline f32x4 vDiv(f32x4 _a, f32x4 _b) { return vdivq_f32(_a, _b); }
+	inline f32x4 vSqrt(f32x4 _a) { return vsqrtq_f32(_a); }
+#else
+	// ARMv7 NEON has neither division nor square root, only estimates.
+	inline f32x4 vDiv(f32x4 _a, f32x4 _b)
+	{
+		f32 a[4], b[4];
+		vst1q_f32(a, _a);
+		vst1q_f32(b, _b);
+		for (u32 i = 0; i < 4; ++i)
+			a[i] /= b[i];
+		return vld1q_f32(a);
+	}
+	inline f32x4 vSqrt(f32x4 _a)
+	{
+		f32 a[4];
+		vst1q_f32(a, _a);
+		for (u32 i = 0; i < 4; ++i)
+			a[i] = sqrtf(a[i]);
+		return vld1q_f32(a);
+	}
+#endif
+	inline void vTranspose(f32x4 & _r0, f32x4 & _r1, f32x4 & _r2, f32x4 & _r3)
+	{
+		const float32x4x2_t t01 = vtrnq_f32(_r0, _r1);
+		const float32x4x2_t t23 = vtrnq_f32(_r2, _r3);
+		_r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+		_r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+		_r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+		_r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+	}
+#else
+	typedef __m128 f32x4;
+
+	inline f32x4 vLoad(const f32 * _p) { return _mm_loadu_ps(_p); }
+	inline void vStore(f32 * _p, f32x4 _a) { _mm_storeu_ps(_p, _a); }
+	inline f32x4 vSet1(f32 _a) { return _mm_set1_ps(_a); }
+	inline f32x4 vAdd(f32x4 _a, f32x4 _b) { return _mm_add_ps(_a, _b); }
+	inline f32x4 vSub(f32x4 _a, f32x4 _b) { return _mm_sub_ps(_a, _b); }
+	inline f32x4 vMul(f32x4 _a, f32x4 _b) { return _mm_mul_ps(_a, _b); }
+	inline f32x4 vDiv(f32x4 _a, f32x4 _b) { return _mm_div_ps(_a, _b); }
+	inline f32x4 vSqrt(f32x4 _a) { return _mm_sqrt_ps(_a); }
+	inline f32x4 vCmpgt(f32x4 _a, f32x4 _b) { return _mm_cmpgt_ps(_a, _b); }
+	inline f32x4 vCmplt(f32x4 _a, f32x4 _b) { return _mm_cmplt_ps(_a, _b); }
+	inline f32x4 vSelect(f32x4 _mask, f32x4 _a, f32x4 _b) { return _mm_or_ps(_mm_and_ps(_mask, _a), _mm_andnot_ps(_mask, _b)); }
+	inline f32x4 vAnd(f32x4 _mask, f32x4 _a) { return _mm_and_ps(_mask, _a); }
+	inline f32x4 vTruncate(f32x4 _a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(_a)); }
+
+	inline void vTranspose(f32x4 & _r0, f32x4 & _r1, f32x4 & _r2, f32x4 & _r3)
+	{
+		_MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+	}
+#endif
+
+	// floorf for non negative values. Floats from 2^23 on have no fraction
+	// and may not fit into int32.
+	inline f32x4 floorPositive(f32x4 _a)
+	{
+		return vSelect(vCmplt(_a, vSet1(8388608.0f)), vTruncate(_a), _a);
+	}
+
+	inline f32x4 clampMax(f32x4 _a, f32x4 _max)
+	{
+		return vSelect(vCmpgt(_a, _max), _max, _a);
+	}
+
+	inline f32x4 clamp(f32x4 _a, f32x4 _min, f32x4 _max)
+	{
+		return clampMax(vSelect(vCmplt(_a, _min), _min, _a), _max);
+	}
+
+	// Four consecutive floats of 4 vertices, e.g. x, y, z, w, as one register per component.
+	struct Quad
+	{
+		f32x4 c[4];
+
+		void load(const SPVertex * _vtx, size_t _offset)
+		{
+			for (u32 i = 0; i < 4; ++i)
+				c[i] = vLoad(reinterpret_cast<const f32*>(reinterpret_cast<const u8*>(_vtx + i) + _offset));
+			vTranspose(c[0], c[1], c[2], c[3]);
+		}
+
+		void store(SPVertex * _vtx, size_t _offset)
+		{
+			f32x4 r0 = c[0], r1 = c[1], r2 = c[2], r3 = c[3];
+			vTranspose(r0, r1, r2, r3);
+			const f32x4 rows[4] = { r0, r1, r2, r3 };
+			for (u32 i = 0; i < 4; ++i)
+				vStore(reinterpret_cast<f32*>(reinterpret_cast<u8*>(_vtx + i) + _offset), rows[i]);
+		}
+	};
+
+	inline void setClip(SPVertex * _vtx, f32x4 _mask, u8 _bit)
+	{
+		f32 lanes[4];
+		vStore(lanes, _mask);
+		for (u32 i = 0; i < 4; ++i) {
+			u32 bits;
+			memcpy(&bits, &lanes[i], sizeof(u32));
+			if (bits != 0)
+				_vtx[i].clip |= _bit;
+		}
+	}
+
+	// Adds the contribution of a light to colors, if the intensity is positive.
+	inline void addLight(Quad & _color, f32x4 _intensity, const f32 _rgb[3])
+	{
+		const f32x4 mask = vCmpgt(_intensity, vSet1(0.0f));
+		for (u32 i = 0; i < 3; ++i)
+			_color.c[i] = vAdd(_color.c[i], vAnd(mask, vMul(vSet1(_rgb[i]), _intensity)));
+	}
+
+	inline f32x4 dot(const Quad & _v, const f32 _l[3])
+	{
+		return vAdd(vAdd(vMul(_v.c[0], vSet1(_l[0])), vMul(_v.c[1], vSet1(_l[1]))), vMul(_v.c[2], vSet1(_l[2])));
+	}
+}
+
+void gSPTransformVertex4SoA(SPVertex * _vtx, float _mtx[4][4], const f32 _scale[4], const SPVertex * _billboard)
+{
+	Quad pos;
+	pos.load(_vtx, offsetof(SPVertex, x));
+
+	// x * mtx[0][j] + y * mtx[1][j] + z * mtx[2][j] + mtx[3][j], like gSPTransformVertex
+	Quad res;
+	for (u32 j = 0; j < 4; ++j) {
+		res.c[j] = vAdd(vAdd(vAdd(vMul(pos.c[0], vSet1(_mtx[0][j])), vMul(pos.c[1], vSet1(_mtx[1][j]))),
+			vMul(pos.c[2], vSet1(_mtx[2][j]))), vSet1(_mtx[3][j]));
+		res.c[j] = vMul(res.c[j], vSet1(_scale[j]));
+		if (_billboard != nullptr)
+			res.c[j] = vAdd(res.c[j], vSet1((&_billboard->x)[j]));
+	}
+	res.store(_vtx, offsetof(SPVertex, x));
+
+	const f32x4 x = res.c[0];
+	const f32x4 y = res.c[1];
+	const f32x4 w = res.c[3];
+	const f32x4 negW = vSub(vSet1(0.0f), w);
+	for (u32 i = 0; i < 4; ++i)
+		_vtx[i].clip = 0;
+	setClip(_vtx, vCmpgt(x, w), CLIP_POSX);
+	setClip(_vtx, vCmplt(x, negW), CLIP_NEGX);
+	setClip(_vtx, vCmpgt(y, w), CLIP_POSY);
+	setClip(_vtx, vCmplt(y, negW), CLIP_NEGY);
+	setClip(_vtx, vCmplt(w, vSet1(0.01f)), CLIP_W);
+}
+
+void gSPLightVertex4SoA(SPVertex * _vtx)
+{
+	Quad normal;
+	normal.load(_vtx, offsetof(SPVertex, nx));
+	Quad color;
+	color.load(_vtx, offsetof(SPVertex, r));
+
+	const u32 numLights = gSP.numLights;
+	for (u32 i = 0; i < 3; ++i)
+		color.c[i] = vSet1(gSP.lights.rgb[numLights][i]);
+
+	for (u32 l = 0; l < numLights; ++l)
+		addLight(color, dot(normal, gSP.lights.i_xyz[l]), gSP.lights.rgb[l]);
+
+	// min(1.0f, c)
+	const f32x4 one = vSet1(1.0f);
+	for (u32 i = 0; i < 3; ++i)
+		color.c[i] = vSelect(vCmplt(color.c[i], one), color.c[i], one);
+	color.store(_vtx, offsetof(SPVertex, r));
+
+	for (u32 i = 0; i < 4; ++i)
+		_vtx[i].HWLight = 0;
+}
+
+void gSPPointLightVertex4SoA(float _vecPos[4][4], SPVertex * _vtx)
+{
+	float (*mtx)[4] = gSP.matrix.modelView[gSP.matrix.modelViewi];
+
+	Quad normal;
+	normal.load(_vtx, offsetof(SPVertex, nx));
+	Quad color;
+	color.load(_vtx, offsetof(SPVertex, r));
+
+	const u32 numLights = gSP.numLights;
+	for (u32 i = 0; i < 3; ++i)
+		color.c[i] = vSet1(gSP.lights.rgb[numLights][i]);
+
+	// Positions in eye space, like gSPTransformVector
+	f32x4 p[4];
+	for (u32 i = 0; i < 4; ++i)
+		p[i] = vLoad(_vecPos[i]);
+	vTranspose(p[0], p[1], p[2], p[3]);
+	f32x4 pos[3];
+	for (u32 j = 0; j < 3; ++j)
+		pos[j] = vAdd(vAdd(vAdd(vMul(p[0], vSet1(mtx[0][j])), vMul(p[1], vSet1(mtx[1][j]))),
+			vMul(p[2], vSet1(mtx[2][j]))), vSet1(mtx[3][j]));
+
+	const f32x4 one = vSet1(1.0f);
+	const f32x4 minusOne = vSet1(-1.0f);
+	for (u32 l = 0; l < numLights; ++l) {
+		f32x4 intensity;
+		if (gSP.lights.ca[l] != 0.0f) {
+			// Point lighting
+			Quad lvec;
+			for (u32 j = 0; j < 3; ++j)
+				lvec.c[j] = vSub(vSet1(gSP.lights.pos_xyzw[l][j]), pos[j]);
+
+			const f32x4 K = vAdd(vAdd(vMul(lvec.c[0], lvec.c[0]), vMul(lvec.c[1], lvec.c[1])),
+				vMul(vMul(lvec.c[2], lvec.c[2]), vSet1(2.0f)));
+			const f32x4 KS = vSqrt(K);
+
+			// gSPInverseTransformVector
+			Quad ivec;
+			for (u32 j = 0; j < 3; ++j) {
+				ivec.c[j] = vAdd(vAdd(vMul(vSet1(mtx[j][0]), lvec.c[0]), vMul(vSet1(mtx[j][1]), lvec.c[1])),
+					vMul(vSet1(mtx[j][2]), lvec.c[2]));
+				ivec.c[j] = clamp(vDiv(vMul(vSet1(4.0f), ivec.c[j]), KS), minusOne, one);
+			}
+
+			const f32x4 V = clamp(vAdd(vAdd(vMul(ivec.c[0], normal.c[0]), vMul(ivec.c[1], normal.c[1])),
+				vMul(ivec.c[2], normal.c[2])), minusOne, one);
+
+			const f32x4 KSF = floorPositive(KS);
+			const f32x4 D = vAdd(vDiv(vAdd(vMul(vMul(KSF, vSet1(gSP.lights.la[l])), vSet1(2.0f)),
+				vDiv(vMul(vMul(KSF, KSF), vSet1(gSP.lights.qa[l])), vSet1(8.0f))), vSet1(65536.0f)), one);
+			intensity = vDiv(V, D);
+		} else {
+			// Standard lighting
+			intensity = dot(normal, gSP.lights.i_xyz[l]);
+		}
+		addLight(color, intensity, gSP.lights.rgb[l]);
+	}
+
+	for (u32 i = 0; i < 3; ++i)
+		color.c[i] = clampMax(color.c[i], one);
+	color.store(_vtx, offsetof(SPVertex, r));
+
+	for (u32 i = 0; i < 4; ++i)
+		_vtx[i].HWLight = 0;
+}
+
+#endif // __VERTEX_SOA
@@ -0,0 +1,27 @@
+#ifndef GSP_VERTEX_SOA_H
+#define GSP_VERTEX_SOA_H
+
+#include "Types.h"
+
+struct SPVertex;
+
+// Vertex pipeline stages processing 4 vertices at once.
+// Vertex components are transposed to structure of arrays form, so each SSE/NEON
+// lane holds one vertex. Used by gSPProcessVertex when vertices are loaded in batches
+// of 4 (__VEC4_OPT). Results match the scalar code in gSP.cpp.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define __VERTEX_SOA
+
+// Transform by _mtx, multiply x, y, z, w by _scale, add _billboard if not null,
+// then set clip flags.
+void gSPTransformVertex4SoA(SPVertex * _vtx, float _mtx[4][4], const f32 _scale[4], const SPVertex * _billboard);
+
+// Directional lights, gSPLightVertexStandard without hardware lighting.
+void gSPLightVertex4SoA(SPVertex * _vtx);
+
+// Point lights of Zelda MM, gSPPointLightVertexZeldaMM.
+void gSPPointLightVertex4SoA(float _vecPos[4][4], SPVertex * _vtx);
+
+#endif
+
+#endif // GSP_VERTEX_SOA_H
@@ -180,6 +180,13 @@ EXPORT int  CALL RomOpen(void);
 EXPORT void CALL RomClosed(void);
 #endif
 
+/* common plugin spec extension, optional: releases caches when the system is low on
+   memory. Level is a m64p_trim_level, returns the number of bytes released. */
+typedef unsigned int (*ptr_TrimMemory)(int Level);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT unsigned int CALL TrimMemory(int Level);
+#endif
+
 /* video plugin function pointer types */
 typedef void (*ptr_ChangeWindow)(void);
 typedef int  (*ptr_InitiateGFX)(GFX_INFO Gfx_Info);
@@ -208,6 +215,12 @@ EXPORT void CALL SetRenderingCallback(void (*callback)(int));
 EXPORT void CALL ResizeVideoOutput(int width, int height);
 #endif
 
+/* video plugin spec extension, optional: display lists to skip after each rendered one */
+typedef void (*ptr_SetRenderSkip)(int Count);
+#if defined(M64P_PLUGIN_PROTOTYPES)
+EXPORT void CALL SetRenderSkip(int Count);
+#endif
+
 /* frame buffer plugin spec extension */
 typedef struct
 {
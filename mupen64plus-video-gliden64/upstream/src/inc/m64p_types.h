@@ -132,7 +132,8 @@ typedef enum {
   M64CORE_AUDIO_MUTE,
   M64CORE_INPUT_GAMESHARK,
   M64CORE_STATE_LOADCOMPLETE,
-  M64CORE_STATE_SAVECOMPLETE
+  M64CORE_STATE_SAVECOMPLETE,
+  M64CORE_RENDER_SKIP
 } m64p_core_param;
 
 typedef enum {
@@ -160,6 +161,12 @@ typedef enum {
   M64CMD_SET_MEDIA_LOADER
 } m64p_command;
 
+/* How much the plugins' TrimMemory() releases */
+typedef enum {
+  M64TRIM_MODERATE = 1,         /* caches which are cheap to rebuild */
+  M64TRIM_CRITICAL              /* everything which can be rebuilt or done without */
+} m64p_trim_level;
+
 typedef struct {
   uint32_t address;
   int      value;
@@ -19,11 +19,16 @@ MY_LOCAL_C_INCLUDES :=                          \
     $(GL_INCLUDES)
 
 MY_LOCAL_SRC_FILES :=                                                              \
+    $(SRCDIR)/BandWorkers.cpp                                                      \
     $(SRCDIR)/Combiner.cpp                                                         \
     $(SRCDIR)/CombinerKey.cpp                                                      \
     $(SRCDIR)/CommonPluginAPI.cpp                                                  \
     $(SRCDIR)/Config.cpp                                                           \
     $(SRCDIR)/convert.cpp                                                          \
+    $(SRCDIR)/CRC32.cpp                                                            \
+    $(SRCDIR)/CRC32_ARMV8.cpp                                                      \
+    $(SRCDIR)/CRC32_SSE42.cpp                                                      \
+    $(SRCDIR)/CRC_OPT.cpp                                                          \
     $(SRCDIR)/DebugDump.cpp                                                        \
     $(SRCDIR)/Debugger.cpp                                                         \
     $(SRCDIR)/DepthBuffer.cpp                                                      \
@@ -36,6 +41,7 @@ MY_LOCAL_SRC_FILES :=
     $(SRCDIR)/GLideN64.cpp                                                         \
     $(SRCDIR)/GraphicsDrawer.cpp                                                   \
     $(SRCDIR)/gSP.cpp                                                              \
+    $(SRCDIR)/gSPVertexSoA.cpp                                                     \
     $(SRCDIR)/Keys.cpp                                                             \
     $(SRCDIR)/Log_android.cpp                                                      \
     $(SRCDIR)/MupenPlusPluginAPI.cpp                                               \
@@ -50,9 +56,11 @@ MY_LOCAL_SRC_FILES :=
     $(SRCDIR)/TexrectDrawer.cpp                                                    \
     $(SRCDIR)/TextDrawer.cpp                                                       \
     $(SRCDIR)/TextureFilterHandler.cpp                                             \
+    $(SRCDIR)/TextureUpscaler.cpp                                                  \
     $(SRCDIR)/Textures.cpp                                                         \
+    $(SRCDIR)/TMEMTexture.cpp                                                      \
+    $(SRCDIR)/VertexCache.cpp                                                      \
     $(SRCDIR)/VI.cpp                                                               \
-    $(SRCDIR)/ZlutTexture.cpp                                                      \
     $(SRCDIR)/common/CommonAPIImpl_common.cpp                                      \
     $(SRCDIR)/mupenplus/CommonAPIImpl_mupenplus.cpp                                \
     $(SRCDIR)/mupenplus/Config_mupenplus.cpp                                       \
@@ -75,12 +83,14 @@ MY_LOCAL_SRC_FILES :=
     $(SRCDIR)/Graphics/OpenGLContext/opengl_ColorBufferReaderWithPixelBuffer.cpp   \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_ColorBufferReaderWithReadPixels.cpp    \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_ColorBufferReaderWithEGLImage.cpp      \
+    $(SRCDIR)/Graphics/OpenGLContext/opengl_ColorBufferReaderWithHardwareBuffer.cpp \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_ContextImpl.cpp                        \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_GLInfo.cpp                             \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_Parameters.cpp                         \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_TextureManipulationObjectFactory.cpp   \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_UnbufferedDrawer.cpp                   \
     $(SRCDIR)/Graphics/OpenGLContext/opengl_Utils.cpp                              \
+    $(SRCDIR)/Graphics/OpenGLContext/ThreadedOpenGl/opengl_Wrapper.cpp             \
     $(SRCDIR)/Graphics/OpenGLContext/GLSL/glsl_CombinerInputs.cpp                  \
     $(SRCDIR)/Graphics/OpenGLContext/GLSL/glsl_CombinerProgramBuilder.cpp          \
     $(SRCDIR)/Graphics/OpenGLContext/GLSL/glsl_CombinerProgramImpl.cpp             \
@@ -144,12 +154,20 @@ ifeq ($(TARGET_ARCH_ABI), armeabi-v7a)
     MY_LOCAL_CFLAGS += -D__NEON_OPT
     MY_LOCAL_CFLAGS += -D__VEC4_OPT -mfpu=neon
 
+else ifeq ($(TARGET_ARCH_ABI), arm64-v8a)
+    # NEON is part of ARMv8, the intrinsics build without extra flags
+    MY_LOCAL_SRC_FILES += $(SRCDIR)/Neon/3DMathNeon.cpp
+    MY_LOCAL_SRC_FILES += $(SRCDIR)/Neon/gSPNeon.cpp
+    MY_LOCAL_SRC_FILES += $(SRCDIR)/Neon/RSP_LoadMatrixNeon.cpp
+    MY_LOCAL_SRC_FILES += $(SRCDIR)/Neon/CRC_OPT_NEON.cpp
+    MY_LOCAL_CFLAGS += -D__NEON_OPT
+    MY_LOCAL_CFLAGS += -D__VEC4_OPT
+
 else ifeq ($(TARGET_ARCH_ABI), x86)
 #    MY_LOCAL_CFLAGS += -DX86_ASM
     MY_LOCAL_CFLAGS += -D__VEC4_OPT
     MY_LOCAL_SRC_FILES += $(SRCDIR)/3DMath.cpp
     MY_LOCAL_SRC_FILES += $(SRCDIR)/RSP_LoadMatrix.cpp
-    MY_LOCAL_SRC_FILES += $(SRCDIR)/CRC_OPT.cpp
 endif
 
 ###########
@@ -54,6 +54,9 @@ extern const unsigned int* rdram_size;
 
 extern void(*renderCallback)(int);
 
+extern void(*CoreDebugCallback)(void *, int, const char *);
+extern void *CoreDebugCallbackContext;
+
 extern m64p_handle g_configVideoGeneral;
 extern m64p_handle g_configVideoGliden64;
 bool Config_SetDefault();
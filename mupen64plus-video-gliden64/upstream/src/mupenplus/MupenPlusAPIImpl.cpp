@@ -2,6 +2,10 @@
 #include "../PluginAPI.h"
 #include "../GLideN64.h"
 #include "../Config.h"
+#include "../Textures.h"
+#include "../RSP.h"
+#include "../Log.h"
+#include "../GLideNHQ/Ext_TxFilter.h"
 #include <DisplayWindow.h>
 
 #ifdef OS_WINDOWS
@@ -50,6 +54,9 @@ const unsigned int* rdram_size = nullptr;
 
 void(*renderCallback)(int) = nullptr;
 
+void(*CoreDebugCallback)(void *, int, const char *) = nullptr;
+void *CoreDebugCallbackContext = nullptr;
+
 m64p_error PluginAPI::PluginStartup(m64p_dynlib_handle _CoreLibHandle)
 {
 	ConfigGetSharedDataFilepath = (ptr_ConfigGetSharedDataFilepath)	DLSYM(_CoreLibHandle, "ConfigGetSharedDataFilepath");
@@ -143,6 +150,27 @@ void PluginAPI::SetRenderingCallback(void (*callback)(int))
 	renderCallback = callback;
 }
 
+void PluginAPI::SetRenderSkip(int _count)
+{
+	LOG(LOG_APIFUNC, "SetRenderSkip %d\n", _count);
+	RSP.renderSkip = _count > 0 ? static_cast<u32>(_count) : 0;
+	RSP.skipCount = 0;
+}
+
+unsigned int PluginAPI::TrimMemory(int _level)
+{
+	LOG(LOG_APIFUNC, "TrimMemory %d\n", _level);
+	if (!m_bRomOpen)
+		return 0;
+
+	// Moderate trim keeps the textures of the running scene and the filtered
+	// textures which can not be read back from the texture cache file.
+	const bool all = _level >= M64TRIM_CRITICAL;
+	size_t freed = textureCache().trim(all);
+	freed += txfilter_trimcache(all ? 1 : 0);
+	return static_cast<unsigned int>(freed);
+}
+
 void PluginAPI::ResizeVideoOutput(int _Width, int _Height)
 {
 	dwnd().setWindowSize(_Width, _Height);
@@ -1,127 +1,97 @@
+#include <arm_neon.h>
 #include "3DMath.h"
 
-static void MultMatrix_neon( float m0[4][4], float m1[4][4], float dest[4][4])
-{
-    asm volatile (
-	"vld1.32 		{d0, d1}, [%1]!			\n\t"	//q0 = m1
-	"vld1.32 		{d2, d3}, [%1]!	    	\n\t"	//q1 = m1+4
-	"vld1.32 		{d4, d5}, [%1]!	    	\n\t"	//q2 = m1+8
-	"vld1.32 		{d6, d7}, [%1]	    	\n\t"	//q3 = m1+12
-	"vld1.32 		{d16, d17}, [%0]!		\n\t"	//q8 = m0
-	"vld1.32 		{d18, d19}, [%0]!   	\n\t"	//q9 = m0+4
-	"vld1.32 		{d20, d21}, [%0]!   	\n\t"	//q10 = m0+8
-	"vld1.32 		{d22, d23}, [%0]    	\n\t"	//q11 = m0+12
-
-	"vmul.f32 		q12, q8, d0[0] 			\n\t"	//q12 = q8 * d0[0]
-	"vmul.f32 		q13, q8, d2[0] 		    \n\t"	//q13 = q8 * d2[0]
-	"vmul.f32 		q14, q8, d4[0] 		    \n\t"	//q14 = q8 * d4[0]
-	"vmul.f32 		q15, q8, d6[0]	 		\n\t"	//q15 = q8 * d6[0]
-	"vmla.f32 		q12, q9, d0[1] 			\n\t"	//q12 = q9 * d0[1]
-	"vmla.f32 		q13, q9, d2[1] 		    \n\t"	//q13 = q9 * d2[1]
-	"vmla.f32 		q14, q9, d4[1] 		    \n\t"	//q14 = q9 * d4[1]
-	"vmla.f32 		q15, q9, d6[1] 		    \n\t"	//q15 = q9 * d6[1]
-	"vmla.f32 		q12, q10, d1[0] 		\n\t"	//q12 = q10 * d0[0]
-	"vmla.f32 		q13, q10, d3[0] 		\n\t"	//q13 = q10 * d2[0]
-	"vmla.f32 		q14, q10, d5[0] 		\n\t"	//q14 = q10 * d4[0]
-	"vmla.f32 		q15, q10, d7[0] 		\n\t"	//q15 = q10 * d6[0]
-	"vmla.f32 		q12, q11, d1[1] 		\n\t"	//q12 = q11 * d0[1]
-	"vmla.f32 		q13, q11, d3[1] 		\n\t"	//q13 = q11 * d2[1]
-	"vmla.f32 		q14, q11, d5[1] 		\n\t"	//q14 = q11 * d4[1]
-	"vmla.f32 		q15, q11, d7[1]	 	    \n\t"	//q15 = q11 * d6[1]
+// Written with intrinsics so the same code builds for armeabi-v7a and arm64-v8a
 
-	"vst1.32 		{d24, d25}, [%2]! 		\n\t"	//d = q12
-	"vst1.32 		{d26, d27}, [%2]! 	    \n\t"	//d+4 = q13
-	"vst1.32 		{d28, d29}, [%2]! 	    \n\t"	//d+8 = q14
-	"vst1.32 		{d30, d31}, [%2] 	    \n\t"	//d+12 = q15
+static inline float32x4_t _load3(const float v[3])
+{
+    return vcombine_f32(vld1_f32(v), vld1_lane_f32(v + 2, vdup_n_f32(0.0f), 0));
+}
 
-	:"+r"(m0), "+r"(m1), "+r"(dest):
-    : "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7",
-    "d16", "d17", "d18", "d19", "d20", "d21", "d22", "d23",
-    "d24", "d25", "d26", "d27", "d28", "d29", "d30", "d31",
-    "memory"
-	);
+static inline void _store3(float v[3], float32x4_t q)
+{
+    vst1_f32(v, vget_low_f32(q));
+    vst1q_lane_f32(v + 2, q, 2);
 }
 
-static void TransformVectorNormalize_neon(float vec[3], float mtx[4][4])
+// x*x + y*y + z*z in lane 0
+static inline float32x2_t _length3(float32x4_t q)
 {
-	asm volatile (
-	"vld1.32 		{d0}, [%1]  			\n\t"	//Q0 = v
-	"flds    		s2, [%1, #8]  			\n\t"	//Q0 = v
-	"vld1.32 		{d18, d19}, [%0]!		\n\t"	//Q1 = m
-	"vld1.32 		{d20, d21}, [%0]!	    \n\t"	//Q2 = m+4
-	"vld1.32 		{d22, d23}, [%0]	    \n\t"	//Q3 = m+8
+    float32x2_t lo = vget_low_f32(q);
+    float32x2_t hi = vget_high_f32(q);
+    float32x2_t len = vmul_f32(lo, lo);
+    len = vpadd_f32(len, len);
+    return vmla_f32(len, hi, hi);
+}
 
-	"vmul.f32 		q2, q9, d0[0]			\n\t"	//q2 = q9*Q0[0]
-	"vmla.f32 		q2, q10, d0[1]			\n\t"	//Q5 += Q1*Q0[1]
-	"vmla.f32 		q2, q11, d1[0]			\n\t"	//Q5 += Q2*Q0[2]
+// ~ 1.0 / sqrt(x), the estimate refined by two Newton-Raphson steps
+static inline float32x2_t _rsqrt(float32x2_t x)
+{
+    float32x2_t est = vrsqrte_f32(x);
+    est = vmul_f32(est, vrsqrts_f32(vmul_f32(est, x), est));
+    est = vmul_f32(est, vrsqrts_f32(vmul_f32(est, x), est));
+    return est;
+}
 
-    "vmul.f32 		d0, d4, d4				\n\t"	//d0 = d0*d0
-	"vpadd.f32 		d0, d0, d0				\n\t"	//d0 = d[0] + d[1]
-    "vmla.f32 		d0, d5, d5				\n\t"	//d0 = d0 + d1*d1
+static void MultMatrix_neon( float m0[4][4], float m1[4][4], float dest[4][4])
+{
+    float32x4_t a0 = vld1q_f32(m0[0]);
+    float32x4_t a1 = vld1q_f32(m0[1]);
+    float32x4_t a2 = vld1q_f32(m0[2]);
+    float32x4_t a3 = vld1q_f32(m0[3]);
+
+    float32x4_t b0 = vld1q_f32(m1[0]);
+    float32x4_t b1 = vld1q_f32(m1[1]);
+    float32x4_t b2 = vld1q_f32(m1[2]);
+    float32x4_t b3 = vld1q_f32(m1[3]);
+
+    float32x4_t d0 = vmulq_lane_f32(a0, vget_low_f32(b0), 0);
+    float32x4_t d1 = vmulq_lane_f32(a0, vget_low_f32(b1), 0);
+    float32x4_t d2 = vmulq_lane_f32(a0, vget_low_f32(b2), 0);
+    float32x4_t d3 = vmulq_lane_f32(a0, vget_low_f32(b3), 0);
+    d0 = vmlaq_lane_f32(d0, a1, vget_low_f32(b0), 1);
+    d1 = vmlaq_lane_f32(d1, a1, vget_low_f32(b1), 1);
+    d2 = vmlaq_lane_f32(d2, a1, vget_low_f32(b2), 1);
+    d3 = vmlaq_lane_f32(d3, a1, vget_low_f32(b3), 1);
+    d0 = vmlaq_lane_f32(d0, a2, vget_high_f32(b0), 0);
+    d1 = vmlaq_lane_f32(d1, a2, vget_high_f32(b1), 0);
+    d2 = vmlaq_lane_f32(d2, a2, vget_high_f32(b2), 0);
+    d3 = vmlaq_lane_f32(d3, a2, vget_high_f32(b3), 0);
+    d0 = vmlaq_lane_f32(d0, a3, vget_high_f32(b0), 1);
+    d1 = vmlaq_lane_f32(d1, a3, vget_high_f32(b1), 1);
+    d2 = vmlaq_lane_f32(d2, a3, vget_high_f32(b2), 1);
+    d3 = vmlaq_lane_f32(d3, a3, vget_high_f32(b3), 1);
+
+    vst1q_f32(dest[0], d0);
+    vst1q_f32(dest[1], d1);
+    vst1q_f32(dest[2], d2);
+    vst1q_f32(dest[3], d3);
+}
 
-	"vmov.f32 		d1, d0					\n\t"	//d1 = d0
-	"vrsqrte.f32 	d0, d0					\n\t"	//d0 = ~ 1.0 / sqrt(d0)
-	"vmul.f32 		d2, d0, d1				\n\t"	//d2 = d0 * d1
-	"vrsqrts.f32 	d3, d2, d0				\n\t"	//d3 = (3 - d0 * d2) / 2
-	"vmul.f32 		d0, d0, d3				\n\t"	//d0 = d0 * d3
-	"vmul.f32 		d2, d0, d1				\n\t"	//d2 = d0 * d1
-	"vrsqrts.f32 	d3, d2, d0				\n\t"	//d3 = (3 - d0 * d3) / 2
-	"vmul.f32 		d0, d0, d3				\n\t"	//d0 = d0 * d4
+static void TransformVectorNormalize_neon(float vec[3], float mtx[4][4])
+{
+    float32x4_t v = _load3(vec);
 
-	"vmul.f32 		q2, q2, d0[0]			\n\t"	//d0= d2*d4
+    float32x4_t product = vmulq_lane_f32(vld1q_f32(mtx[0]), vget_low_f32(v), 0);
+    product = vmlaq_lane_f32(product, vld1q_f32(mtx[1]), vget_low_f32(v), 1);
+    product = vmlaq_lane_f32(product, vld1q_f32(mtx[2]), vget_high_f32(v), 0);
 
-	"vst1.32 		{d4}, [%1] 	    	    \n\t"	//Q4 = m+12
-	"fsts   		s10, [%1, #8] 	    	\n\t"	//Q4 = m+12
-	: "+r"(mtx): "r"(vec)
-    : "d0","d1","d2","d3","d18","d19","d20","d21","d22", "d23", "memory"
-	);
+    product = vmulq_lane_f32(product, _rsqrt(_length3(product)), 0);
+    _store3(vec, product);
 }
 
 static void Normalize_neon(float v[3])
 {
-	asm volatile (
-	"vld1.32 		{d4}, [%0]!	    		\n\t"	//d4={x,y}
-	"flds    		s10, [%0]   	    	\n\t"	//d5[0] = z
-	"sub    		%0, %0, #8   	    	\n\t"	//d5[0] = z
-	"vmul.f32 		d0, d4, d4				\n\t"	//d0= d4*d4
-	"vpadd.f32 		d0, d0, d0				\n\t"	//d0 = d[0] + d[1]
-    "vmla.f32 		d0, d5, d5				\n\t"	//d0 = d0 + d5*d5
-
-	"vmov.f32 		d1, d0					\n\t"	//d1 = d0
-	"vrsqrte.f32 	d0, d0					\n\t"	//d0 = ~ 1.0 / sqrt(d0)
-	"vmul.f32 		d2, d0, d1				\n\t"	//d2 = d0 * d1
-	"vrsqrts.f32 	d3, d2, d0				\n\t"	//d3 = (3 - d0 * d2) / 2
-	"vmul.f32 		d0, d0, d3				\n\t"	//d0 = d0 * d3
-	"vmul.f32 		d2, d0, d1				\n\t"	//d2 = d0 * d1
-	"vrsqrts.f32 	d3, d2, d0				\n\t"	//d3 = (3 - d0 * d3) / 2
-	"vmul.f32 		d0, d0, d3				\n\t"	//d0 = d0 * d4
-
-	"vmul.f32 		q2, q2, d0[0]			\n\t"	//d0= d2*d4
-	"vst1.32 		{d4}, [%0]!  			\n\t"	//d2={x0,y0}, d3={z0, w0}
-	"fsts    		s10, [%0]     			\n\t"	//d2={x0,y0}, d3={z0, w0}
-
-	:"+r"(v) :
-    : "d0", "d1", "d2", "d3", "d4", "d5", "memory"
-	);
+    float32x4_t q = _load3(v);
+    q = vmulq_lane_f32(q, _rsqrt(_length3(q)), 0);
+    _store3(v, q);
 }
 
 static float DotProduct_neon( float v0[3], float v1[3] )
 {
-    float dot;
-	asm volatile (
-	"vld1.32 		{d8}, [%1]!			\n\t"	//d8={x0,y0}
-	"vld1.32 		{d10}, [%2]!		\n\t"	//d10={x1,y1}
-	"flds 			s18, [%1, #0]	    \n\t"	//d9[0]={z0}
-	"flds 			s22, [%2, #0]	    \n\t"	//d11[0]={z1}
-	"vmul.f32 		d12, d8, d10		\n\t"	//d0= d2*d4
-	"vpadd.f32 		d12, d12, d12		\n\t"	//d0 = d[0] + d[1]
-	"vmla.f32 		d12, d9, d11		\n\t"	//d0 = d0 + d3*d5
-    "fmrs	        %0, s24	    		\n\t"	//r0 = s0
-	: "=r"(dot), "+r"(v0), "+r"(v1):
-    : "d8", "d9", "d10", "d11", "d12"
-
-	);
-    return dot;
+    float32x2_t dot = vmul_f32(vld1_f32(v0), vld1_f32(v1));
+    dot = vpadd_f32(dot, dot);
+    return vget_lane_f32(dot, 0) + v0[2] * v1[2];
 }
 
 void MathInitNeon()
@@ -87,6 +87,12 @@ ifeq ($(TARGET_ARCH_ABI), armeabi-v7a)
     LOCAL_CFLAGS += -DARM_ASM
     LOCAL_CFLAGS += -D__NEON_OPT
 
+else ifeq ($(TARGET_ARCH_ABI), arm64-v8a)
+    # NEON is part of ARMv8, the intrinsics build as they are
+    LOCAL_SRC_FILES += $(SRCDIR)/gSPNeon.cpp
+    LOCAL_SRC_FILES += $(SRCDIR)/3DMathNeon.cpp
+    LOCAL_CFLAGS += -D__NEON_OPT
+
 else ifeq ($(TARGET_ARCH_ABI), armeabi)
     # Use for pre-ARM7a:
 
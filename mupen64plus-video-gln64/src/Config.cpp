@@ -100,6 +100,7 @@ Option configOptions[] =
 
     {"#Frame skip:", NULL, 0},
     {"auto frameskip", &config.autoFrameSkip, 0},
+    {"predictive frameskip", &config.predictiveFrameSkip, 0},
     {"max frameskip", &config.maxFrameSkip, 0},
     {"target FPS", &config.targetFPS, 20},
     {"frame render rate", &config.frameRenderRate, 1},
@@ -44,6 +44,7 @@ struct Config
     int     zHack;
 
     int     autoFrameSkip;
+    int     predictiveFrameSkip;
     int     maxFrameSkip;
     int     targetFPS;
     int     frameRenderRate;
@@ -21,7 +21,7 @@
 #include "ticks.h"
 
 FrameSkipper::FrameSkipper()
-	: skipType(AUTO), maxSkips(2), targetFPS(60)
+	: skipType(AUTO), maxSkips(2), targetFPS(60), speedFactor(100)
 {
 }
 
@@ -30,6 +30,20 @@ void FrameSkipper::start()
 	initialTicks = 0;
 	virtualCount = 0;
 	skipCounter = 0;
+	renderCost = 0;
+	rendered = false;
+	averageCost = 0.0f;
+}
+
+void FrameSkipper::renderStart()
+{
+	renderTicks = ticksGetTicks();
+}
+
+void FrameSkipper::renderEnd()
+{
+	renderCost += ticksGetTicks() - renderTicks;
+	rendered = true;
 }
 
 void FrameSkipper::update()
@@ -41,7 +55,29 @@ void FrameSkipper::update()
 	}
 
 	unsigned int elapsed = ticksGetTicks() - initialTicks;
-	unsigned int realCount = elapsed * targetFPS / 1000;
+	unsigned int realCount = (unsigned long long) elapsed * targetFPS * speedFactor / 100000;
+
+	if (skipType == PREDICTIVE) {
+		// ticks are milliseconds, so smooth the cost over a few frames
+		if (rendered) {
+			averageCost = averageCost * 0.75f + renderCost * 0.25f;
+			renderCost = 0;
+			rendered = false;
+		}
+
+		virtualCount++;
+		float frameTime = 100000.0f / (targetFPS * speedFactor);
+		float deadline = (virtualCount + 1) * frameTime;
+		if (elapsed + averageCost > deadline && skipCounter < maxSkips) {
+			skipCounter++;
+		} else {
+			// don't carry a debt we can never catch up with
+			if (realCount > virtualCount + maxSkips)
+				virtualCount = realCount;
+			skipCounter = 0;
+		}
+		return;
+	}
 
 	virtualCount++;
 	if (realCount >= virtualCount) {
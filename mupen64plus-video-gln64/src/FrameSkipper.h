@@ -22,7 +22,9 @@
 
 class FrameSkipper {
 public:
-	enum { AUTO, MANUAL };
+	// PREDICTIVE skips when the measured cost of rendering a frame would
+	// make it miss its deadline, AUTO only looks at how far behind we are
+	enum { AUTO, MANUAL, PREDICTIVE };
 
 	FrameSkipper();
 
@@ -35,6 +37,14 @@ public:
 		targetFPS = fps;
 	}
 
+	// emulation speed in percent, the frame rate to keep up with scales with it
+	void setSpeedFactor(int percent) {
+		if (percent > 0 && percent != speedFactor) {
+			speedFactor = percent;
+			start();
+		}
+	}
+
 	bool willSkipNext() {
 		return (skipCounter > 0);
 	}
@@ -42,13 +52,23 @@ public:
 	void start();
 	void update();
 
+	// bracket the rendering work of a frame, display list processing and
+	// the buffer swap, which blocks while the GPU is still behind
+	void renderStart();
+	void renderEnd();
+
 private:
 	int skipType;
 	int maxSkips;
 	int targetFPS;
+	int speedFactor;
 	int skipCounter;
 	unsigned int initialTicks;
 	unsigned int virtualCount;
+	unsigned int renderTicks;
+	unsigned int renderCost;
+	bool rendered;
+	float averageCost;
 };
 
 #endif
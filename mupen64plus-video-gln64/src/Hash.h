@@ -2,6 +2,7 @@
 #define __HASH_H__
 
 #include <stdlib.h>
+#include <string.h>
 
 template<typename T>
 class HashMap
@@ -14,6 +15,18 @@ public:
         reset();
     }
 
+    // Drops all entries, the caller has to insert them again
+    void resize(unsigned power2)
+    {
+        free(_hashmap);
+        init(power2);
+    }
+
+    unsigned size() const
+    {
+        return _mask + 1;
+    }
+
     void destroy()
     {
         free(_hashmap);
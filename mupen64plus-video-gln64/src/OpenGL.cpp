@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <stddef.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -366,6 +367,14 @@ bool OGL_Start()
     memset(OGL.triangles.vertices, 0, VERTBUFF_SIZE * sizeof(SPVertex));
     memset(OGL.triangles.elements, 0, ELEMBUFF_SIZE * sizeof(GLubyte));
     OGL.triangles.num = 0;
+    OGL.triangles.dirty = 1;
+    OGL.triangles.used = 0;
+    OGL.triangles.uploaded = 0;
+    OGL.triangles.maxElement = 0;
+
+    glGenBuffers(STREAM_RING_SIZE, OGL.stream.vbo);
+    glGenBuffers(STREAM_RING_SIZE, OGL.stream.ibo);
+    OGL.stream.vboCurrent = OGL.stream.iboCurrent = 0;
 
 #ifdef __TRIBUFFER_OPT
     __indexmap_init();
@@ -387,8 +396,6 @@ void OGL_Stop()
 {
     LOG(LOG_MINIMAL, "Stopping OpenGL\n");
 
-    CoreVideo_Quit();
-
     if (config.framebuffer.enable)
     {
         glDeleteFramebuffers(1, &OGL.framebuffer.fb);
@@ -400,8 +407,14 @@ void OGL_Stop()
     glDeleteShader(OGL.defaultVertShader);
     glDeleteProgram(OGL.defaultProgram);
 
+    glDeleteBuffers(STREAM_RING_SIZE, OGL.stream.vbo);
+    glDeleteBuffers(STREAM_RING_SIZE, OGL.stream.ibo);
+
+    //the shader storage reads the program binaries back, so keep the context until here
     ShaderCombiner_Destroy();
     TextureCache_Destroy();
+
+    CoreVideo_Quit();
 }
 
 void OGL_UpdateCullFace()
@@ -781,6 +794,10 @@ void OGL_AddTriangle(int v0, int v1, int v2)
     OGL.triangles.elements[OGL.triangles.num++] = v0;
     OGL.triangles.elements[OGL.triangles.num++] = v1;
     OGL.triangles.elements[OGL.triangles.num++] = v2;
+
+    if ((u32) v0 > OGL.triangles.maxElement) OGL.triangles.maxElement = v0;
+    if ((u32) v1 > OGL.triangles.maxElement) OGL.triangles.maxElement = v1;
+    if ((u32) v2 > OGL.triangles.maxElement) OGL.triangles.maxElement = v2;
 }
 
 void OGL_SetColorArray()
@@ -809,6 +826,7 @@ void OGL_DrawTriangles()
     if (OGL.renderingToTexture && config.ignoreOffscreenRendering)
     {
         OGL.triangles.num = 0;
+        OGL.triangles.maxElement = 0;
         return;
     }
 
@@ -828,23 +846,52 @@ void OGL_DrawTriangles()
         SC_ForceUniform1f(uRenderState, RS_TRIANGLE);
     }
 
+    //the same vertices are often drawn with several index sets, only stream
+    //them again when they have been written to
+    if (OGL.triangles.maxElement >= OGL.triangles.uploaded)
+        OGL_VerticesChanged(OGL.triangles.maxElement, 1);
+
+    if (OGL.renderState != RS_TRIANGLE || OGL.triangles.dirty)
+    {
+        if (OGL.triangles.dirty)
+        {
+            OGL.stream.vboCurrent = (OGL.stream.vboCurrent + 1) % STREAM_RING_SIZE;
+            glBindBuffer(GL_ARRAY_BUFFER, OGL.stream.vbo[OGL.stream.vboCurrent]);
+            glBufferData(GL_ARRAY_BUFFER, OGL.triangles.used * sizeof(SPVertex), OGL.triangles.vertices, GL_STREAM_DRAW);
+            OGL.triangles.uploaded = OGL.triangles.used;
+            OGL.triangles.dirty = 0;
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, OGL.stream.vbo[OGL.stream.vboCurrent]);
+        }
+
+        glVertexAttribPointer(SC_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(SPVertex), (const GLvoid*) offsetof(SPVertex, x));
+        glVertexAttribPointer(SC_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(SPVertex), (const GLvoid*) offsetof(SPVertex, r));
+        glVertexAttribPointer(SC_TEXCOORD0, 2, GL_FLOAT, GL_FALSE, sizeof(SPVertex), (const GLvoid*) offsetof(SPVertex, s));
+
+        //lines and rects still draw from client memory
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
     if (OGL.renderState != RS_TRIANGLE)
     {
 #ifdef RENDERSTATE_TEST
         StateChanges++;
 #endif
-        glVertexAttribPointer(SC_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(SPVertex), &OGL.triangles.vertices[0].x);
-        glVertexAttribPointer(SC_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(SPVertex), &OGL.triangles.vertices[0].r);
-        glVertexAttribPointer(SC_TEXCOORD0, 2, GL_FLOAT, GL_FALSE, sizeof(SPVertex), &OGL.triangles.vertices[0].s);
-
         OGL_UpdateCullFace();
         OGL_UpdateViewport();
         glEnable(GL_SCISSOR_TEST);
         OGL.renderState = RS_TRIANGLE;
     }
 
-    glDrawElements(GL_TRIANGLES, OGL.triangles.num, GL_UNSIGNED_BYTE, OGL.triangles.elements);
+    OGL.stream.iboCurrent = (OGL.stream.iboCurrent + 1) % STREAM_RING_SIZE;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, OGL.stream.ibo[OGL.stream.iboCurrent]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, OGL.triangles.num * sizeof(GLubyte), OGL.triangles.elements, GL_STREAM_DRAW);
+    glDrawElements(GL_TRIANGLES, OGL.triangles.num, GL_UNSIGNED_BYTE, (const GLvoid*) 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     OGL.triangles.num = 0;
+    OGL.triangles.maxElement = 0;
 
 #ifdef __TRIBUFFER_OPT
     __indexmap_clear();
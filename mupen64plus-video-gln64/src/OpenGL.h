@@ -95,6 +95,11 @@ struct GLInfo
         GLubyte     elements[ELEMBUFF_SIZE];
         int         num;
 
+        u32         dirty;      //vertices written since the last upload
+        u32         used;       //vertices to upload, high water mark of the written ones
+        u32         uploaded;   //vertices in the current vertex buffer
+        u32         maxElement;
+
 //#ifdef __TRIBUFFER_OPT
 
         u32     indexmap[INDEXMAP_SIZE];
@@ -106,6 +111,15 @@ struct GLInfo
     } triangles;
 
 
+    //vertex and index data is streamed through a ring of buffers so we never
+    //write to one the GPU may still be reading from
+#define STREAM_RING_SIZE 8
+    struct {
+        GLuint  vbo[STREAM_RING_SIZE];
+        GLuint  ibo[STREAM_RING_SIZE];
+        int     vboCurrent, iboCurrent;
+    } stream;
+
     unsigned int    renderState;
 
     GLVertex rect[4];
@@ -113,6 +127,13 @@ struct GLInfo
 
 extern GLInfo OGL;
 
+//call after writing to OGL.triangles.vertices, the next draw streams them again
+inline void OGL_VerticesChanged(u32 v, u32 n)
+{
+    OGL.triangles.dirty = 1;
+    if (v + n > OGL.triangles.used) OGL.triangles.used = v + n;
+}
+
 bool OGL_Start();
 void OGL_Stop();
 
@@ -5,8 +5,10 @@
 #include "Common.h"
 #include "Textures.h"
 #include "Config.h"
+#include "CRC.h"
 #include <cstring>
 #include <algorithm>
+#include "m64p_config.h"
 
 
 //(sa - sb) * m + a
@@ -569,6 +571,265 @@ void _update_uniforms()
     }
 };
 
+//program binaries are kept per rom in the user cache so they
+//don't have to be compiled again on the next run:
+#define SC_STORAGE_MAGIC        0x53434E47  //"GNCS"
+#define SC_STORAGE_VERSION      1
+
+struct ShaderStorageHeader
+{
+    u32 magic;
+    u32 version;
+    u32 options;    //config options baked into the shader sources
+    u32 renderer;   //crc of the GL vendor, renderer and version strings
+    u32 count;
+};
+
+struct ShaderStorageEntry
+{
+    u64 mux;
+    u32 flags;
+    u32 uses;
+    u32 format;
+    u32 length;
+};
+
+//gles2N64.h can't be included here, its min() macro breaks <algorithm>
+extern ptr_ConfigGetUserCachePath ConfigGetUserCachePath;
+
+static PFNGLGETPROGRAMBINARYOESPROC _glGetProgramBinaryOES = NULL;
+static PFNGLPROGRAMBINARYOESPROC _glProgramBinaryOES = NULL;
+static int _storage_dirty = 0;
+
+void _storage_init()
+{
+    GLint formats = 0;
+
+    _glGetProgramBinaryOES = NULL;
+    _glProgramBinaryOES = NULL;
+    _storage_dirty = 0;
+
+    if (!ConfigGetUserCachePath || !OGL_IsExtSupported("GL_OES_get_program_binary"))
+        return;
+
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formats);
+    if (formats <= 0)
+        return;
+
+    _glGetProgramBinaryOES = (PFNGLGETPROGRAMBINARYOESPROC) CoreVideo_GL_GetProcAddress("glGetProgramBinaryOES");
+    _glProgramBinaryOES = (PFNGLPROGRAMBINARYOESPROC) CoreVideo_GL_GetProcAddress("glProgramBinaryOES");
+    if (!_glGetProgramBinaryOES || !_glProgramBinaryOES)
+    {
+        _glGetProgramBinaryOES = NULL;
+        _glProgramBinaryOES = NULL;
+    }
+}
+
+void _storage_header(ShaderStorageHeader *header)
+{
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+    //the texture cache builds the crc table later on
+    CRC_BuildTable();
+
+    header->magic = SC_STORAGE_MAGIC;
+    header->version = SC_STORAGE_VERSION;
+    header->options = (config.enableFog ? 1 : 0) | (config.zHack ? 2 : 0) |
+                      (config.hackAlpha ? 4 : 0) | (config.hackZelda ? 8 : 0);
+    header->renderer = 0;
+    for(int i = 0; i < 3; i++)
+    {
+        const char *str = (const char*) glGetString(names[i]);
+        if (str)
+            header->renderer = CRC_Calculate(header->renderer, (void*) str, strlen(str));
+    }
+    header->count = 0;
+}
+
+const char *_storage_path()
+{
+    static char path[1024];
+    char name[sizeof(config.romName)];
+    const char *dir = ConfigGetUserCachePath();
+
+    if (!dir)
+        return NULL;
+
+    int i;
+    for(i = 0; config.romName[i]; i++)
+    {
+        char c = config.romName[i];
+        name[i] = ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) ? c : '_';
+    }
+    name[i] = 0;
+
+    snprintf(path, sizeof(path), "%sgln64_%s.shaders", dir, (i > 0) ? name : "default");
+    return path;
+}
+
+void _program_insert(ShaderProgram *prog)
+{
+    ShaderProgram *root = scProgramRoot;
+    if (!root)
+    {
+        scProgramRoot = prog;
+        return;
+    }
+
+    for(;;)
+    {
+        ShaderProgram **next = (root->combine.mux < prog->combine.mux) ? &root->right : &root->left;
+        if (!*next)
+        {
+            *next = prog;
+            return;
+        }
+        root = *next;
+    }
+}
+
+void _storage_load()
+{
+    ShaderStorageHeader header, stored;
+    ShaderStorageEntry entry;
+    const char *path;
+    FILE *f;
+
+    if (!_glProgramBinaryOES || !(path = _storage_path()))
+        return;
+
+    f = fopen(path, "rb");
+    if (!f)
+        return;
+
+    _storage_header(&header);
+    if (fread(&stored, sizeof(stored), 1, f) != 1 || stored.magic != header.magic ||
+        stored.version != header.version || stored.options != header.options ||
+        stored.renderer != header.renderer)
+    {
+        LOG(LOG_MINIMAL, "[gln64]: Discarding outdated shader storage %s\n", path);
+        fclose(f);
+        _storage_dirty = 1;
+        return;
+    }
+
+    int loaded = 0;
+    for(u32 i = 0; i < stored.count; i++)
+    {
+        if (fread(&entry, sizeof(entry), 1, f) != 1 || entry.length == 0)
+            break;
+
+        void *binary = malloc(entry.length);
+        if (fread(binary, entry.length, 1, f) != 1)
+        {
+            free(binary);
+            break;
+        }
+
+        ShaderProgram *prog = (ShaderProgram*) malloc(sizeof(ShaderProgram));
+        GLint success = 0;
+
+        prog->program = glCreateProgram();
+        _glProgramBinaryOES(prog->program, entry.format, binary, entry.length);
+        free(binary);
+
+        glGetProgramiv(prog->program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            //the driver refused it, the program is compiled again on first use
+            glDeleteProgram(prog->program);
+            free(prog);
+            _storage_dirty = 1;
+            continue;
+        }
+
+        prog->fragment = 0;
+        prog->vertex = _vertex_shader;
+        prog->usesT0 = (entry.uses >> 0) & 1;
+        prog->usesT1 = (entry.uses >> 1) & 1;
+        prog->usesCol = (entry.uses >> 2) & 1;
+        prog->usesNoise = (entry.uses >> 3) & 1;
+        prog->combine.mux = entry.mux;
+        prog->flags = entry.flags;
+        prog->left = prog->right = NULL;
+        prog->lastUsed = 0;
+        _locate_uniforms(prog);
+
+        _program_insert(prog);
+        scProgramCount++;
+        loaded++;
+    }
+    fclose(f);
+
+    if (loaded != (int) stored.count)
+        _storage_dirty = 1;
+
+    LOG(LOG_MINIMAL, "[gln64]: Loaded %i shader programs from %s\n", loaded, path);
+}
+
+void _storage_write(FILE *f, ShaderProgram *prog, ShaderStorageHeader *header)
+{
+    if (!prog)
+        return;
+
+    _storage_write(f, prog->left, header);
+
+    GLint length = 0;
+    glGetProgramiv(prog->program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length > 0)
+    {
+        ShaderStorageEntry entry;
+        void *binary = malloc(length);
+        GLsizei size = 0;
+        GLenum format = 0;
+
+        _glGetProgramBinaryOES(prog->program, length, &size, &format, binary);
+        if (size > 0)
+        {
+            entry.mux = prog->combine.mux;
+            entry.flags = prog->flags;
+            entry.uses = (prog->usesT0 ? 1 : 0) | (prog->usesT1 ? 2 : 0) |
+                         (prog->usesCol ? 4 : 0) | (prog->usesNoise ? 8 : 0);
+            entry.format = format;
+            entry.length = size;
+            fwrite(&entry, sizeof(entry), 1, f);
+            fwrite(binary, size, 1, f);
+            header->count++;
+        }
+        free(binary);
+    }
+
+    _storage_write(f, prog->right, header);
+}
+
+void _storage_save()
+{
+    ShaderStorageHeader header;
+    const char *path;
+    FILE *f;
+
+    if (!_glGetProgramBinaryOES || !_storage_dirty || !scProgramRoot || !(path = _storage_path()))
+        return;
+
+    f = fopen(path, "wb");
+    if (!f)
+    {
+        LOG(LOG_WARNING, "[gln64]: Could not write shader storage %s\n", path);
+        return;
+    }
+
+    //the count is patched in once all programs are written
+    _storage_header(&header);
+    fwrite(&header, sizeof(header), 1, f);
+    _storage_write(f, scProgramRoot, &header);
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    fclose(f);
+
+    _storage_dirty = 0;
+    LOG(LOG_MINIMAL, "[gln64]: Saved %i shader programs to %s\n", header.count, path);
+}
+
 void ShaderCombiner_Init()
 {
     //compile vertex shader:
@@ -606,6 +867,9 @@ void ShaderCombiner_Init()
     {
         _glcompiler_error(_vertex_shader);
     }
+
+    _storage_init();
+    _storage_load();
 };
 
 void ShaderCombiner_DeletePrograms(ShaderProgram *prog)
@@ -623,6 +887,7 @@ void ShaderCombiner_DeletePrograms(ShaderProgram *prog)
 
 void ShaderCombiner_Destroy()
 {
+    _storage_save();
     ShaderCombiner_DeletePrograms(scProgramRoot);
     glDeleteShader(_vertex_shader);
     scProgramCount = scProgramChanged = 0;
@@ -698,7 +963,7 @@ void ShaderCombiner_Set(u64 mux, int flags)
             root->right = prog;
         else
             root->left = prog;
-
+        _storage_dirty = 1;
     }
 
     prog->lastUsed = OGL.frame_dl;
@@ -3,6 +3,12 @@
 #include <memory.h>
 #include "convert.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace gln64Convert;
 
 #ifndef min
@@ -210,11 +216,73 @@ u32 GetRGBA8888_RGBA4444( void *src, u16 x, u16 i, u8 palette )
     return RGBA8888_RGBA4444(((u32*)src)[x^i]);
 }
 
+// Converts count texels of a line starting at x, the texel getter is inlined
+// so a whole run costs one call instead of one per texel.
+typedef void (*GetTexelRowFunc)( void *dest, void *src, u16 x, u16 count, u16 i, u8 palette );
+
+template<typename T, u32 (*GetTexel)( void*, u16, u16, u8 )>
+void GetTexelRow( void *dest, void *src, u16 x, u16 count, u16 i, u8 palette )
+{
+    T *d = (T*)dest;
+    for (u16 n = 0; n < count; n++)
+        d[n] = (T)GetTexel( src, x + n, i, palette );
+}
+
+// 16-bit texels that only need the word swap or nothing at all. Odd lines have
+// their 32-bit words swapped in TMEM, which is a swap of the halves of every
+// 64-bit group of 4 texels, so the vector loads start at a multiple of 4.
+template<bool swap>
+void GetTexelRow16( void *dest, void *src, u16 x, u16 count, u16 i, u8 palette )
+{
+    u16 *d = (u16*)dest;
+    u16 n = 0;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    if ((x & 3) == 0)
+    {
+        const u16 *s = (const u16*)src + x;
+        for (; n + 8 <= count; n += 8)
+        {
+            uint16x8_t v = vld1q_u16( s + n );
+            if (i)
+                v = vreinterpretq_u16_u32( vrev64q_u32( vreinterpretq_u32_u16( v ) ) );
+            if (swap)
+                v = vreinterpretq_u16_u8( vrev16q_u8( vreinterpretq_u8_u16( v ) ) );
+            vst1q_u16( d + n, v );
+        }
+    }
+#elif defined(__SSE2__)
+    if ((x & 3) == 0)
+    {
+        const u16 *s = (const u16*)src + x;
+        for (; n + 8 <= count; n += 8)
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i*)(s + n) );
+            if (i)
+                v = _mm_shuffle_epi32( v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+            if (swap)
+                v = _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+            _mm_storeu_si128( (__m128i*)(d + n), v );
+        }
+    }
+#endif
+
+    for (; n < count; n++)
+    {
+        u16 c = ((u16*)src)[(x + n)^i];
+        d[n] = swap ? RGBA5551_RGBA5551( c ) : IA88_IA88( c );
+    }
+}
+
+#define ROW8(F)     GetTexelRow<u8, F>
+#define ROW16(F)    GetTexelRow<u16, F>
+#define ROW32(F)    GetTexelRow<u32, F>
 
 struct TextureFormat
 {
     int format;
     GetTexelFunc getTexel;
+    GetTexelRowFunc getTexelRow;
     int lineShift, maxTexels;
 };
 
@@ -222,65 +290,65 @@ struct TextureFormat
 TextureFormat textureFormatIA[4*6] =
 {
     // 4-bit
-    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    4,  4096 }, // RGBA (SELECT)
-    {   FORMAT_NONE,        GetNone,                4,  8192 }, // YUV
-    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    4,  4096 }, // CI
-    {   FORMAT_IA88,        GetIA31_IA88,           4,  8192 }, // IA
-    {   FORMAT_IA88,        GetI4_IA88,             4,  8192 }, // I
-    {   FORMAT_RGBA8888,    GetCI4IA_RGBA8888,      4,  4096 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    ROW16(GetCI4RGBA_RGBA5551), 4,  4096 }, // RGBA (SELECT)
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             4,  8192 }, // YUV
+    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    ROW16(GetCI4RGBA_RGBA5551), 4,  4096 }, // CI
+    {   FORMAT_IA88,        GetIA31_IA88,           ROW16(GetIA31_IA88),        4,  8192 }, // IA
+    {   FORMAT_IA88,        GetI4_IA88,             ROW16(GetI4_IA88),          4,  8192 }, // I
+    {   FORMAT_RGBA8888,    GetCI4IA_RGBA8888,      ROW32(GetCI4IA_RGBA8888),   4,  4096 }, // IA Palette
     // 8-bit
-    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    3,  2048 }, // RGBA (SELECT)
-    {   FORMAT_NONE,        GetNone,                3,  4096 }, // YUV
-    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    3,  2048 }, // CI
-    {   FORMAT_IA88,        GetIA44_IA88,           3,  4096 }, // IA
-    {   FORMAT_IA88,        GetI8_IA88,             3,  4096 }, // I
-    {   FORMAT_RGBA8888,    GetCI8IA_RGBA8888,      3,  2048 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    ROW16(GetCI8RGBA_RGBA5551), 3,  2048 }, // RGBA (SELECT)
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             3,  4096 }, // YUV
+    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    ROW16(GetCI8RGBA_RGBA5551), 3,  2048 }, // CI
+    {   FORMAT_IA88,        GetIA44_IA88,           ROW16(GetIA44_IA88),        3,  4096 }, // IA
+    {   FORMAT_IA88,        GetI8_IA88,             ROW16(GetI8_IA88),          3,  4096 }, // I
+    {   FORMAT_RGBA8888,    GetCI8IA_RGBA8888,      ROW32(GetCI8IA_RGBA8888),   3,  2048 }, // IA Palette
     // 16-bit
-    {   FORMAT_RGBA5551,    GetRGBA5551_RGBA5551,   2,  2048 }, // RGBA
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // YUV
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // CI
-    {   FORMAT_IA88,        GetIA88_IA88,           2,  2048 }, // IA
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // I
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetRGBA5551_RGBA5551,   GetTexelRow16<true>,        2,  2048 }, // RGBA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // YUV
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // CI
+    {   FORMAT_IA88,        GetIA88_IA88,           GetTexelRow16<false>,       2,  2048 }, // IA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // I
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // IA Palette
     // 32-bit
-    {   FORMAT_RGBA8888,    GetRGBA8888_RGBA8888,   2,  1024 }, // RGBA
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // YUV
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // CI
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // IA
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // I
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // IA Palette
+    {   FORMAT_RGBA8888,    GetRGBA8888_RGBA8888,   ROW32(GetRGBA8888_RGBA8888),2,  1024 }, // RGBA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // YUV
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // CI
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // IA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // I
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // IA Palette
 };
 
 TextureFormat textureFormatRGBA[4*6] =
 {
     // 4-bit
-    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    4,  4096 }, // RGBA (SELECT)
-    {   FORMAT_NONE,        GetNone,                4,  8192 }, // YUV
-    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    4,  4096 }, // CI
-    {   FORMAT_RGBA4444,    GetIA31_RGBA4444,       4,  8192 }, // IA
-    {   FORMAT_RGBA4444,    GetI4_RGBA4444,         4,  8192 }, // I
-    {   FORMAT_RGBA8888,    GetCI4IA_RGBA8888,      4,  4096 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    ROW16(GetCI4RGBA_RGBA5551), 4,  4096 }, // RGBA (SELECT)
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             4,  8192 }, // YUV
+    {   FORMAT_RGBA5551,    GetCI4RGBA_RGBA5551,    ROW16(GetCI4RGBA_RGBA5551), 4,  4096 }, // CI
+    {   FORMAT_RGBA4444,    GetIA31_RGBA4444,       ROW16(GetIA31_RGBA4444),    4,  8192 }, // IA
+    {   FORMAT_RGBA4444,    GetI4_RGBA4444,         ROW16(GetI4_RGBA4444),      4,  8192 }, // I
+    {   FORMAT_RGBA8888,    GetCI4IA_RGBA8888,      ROW32(GetCI4IA_RGBA8888),   4,  4096 }, // IA Palette
     // 8-bit
-    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    3,  2048 }, // RGBA (SELECT)
-    {   FORMAT_NONE,        GetNone,                3,  4096 }, // YUV
-    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    3,  2048 }, // CI
-    {   FORMAT_RGBA4444,    GetIA44_RGBA4444,       3,  4096 }, // IA
-    {   FORMAT_RGBA8888,    GetI8_RGBA8888,         3,  4096 }, // I
-    {   FORMAT_RGBA8888,    GetCI8IA_RGBA8888,      3,  2048 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    ROW16(GetCI8RGBA_RGBA5551), 3,  2048 }, // RGBA (SELECT)
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             3,  4096 }, // YUV
+    {   FORMAT_RGBA5551,    GetCI8RGBA_RGBA5551,    ROW16(GetCI8RGBA_RGBA5551), 3,  2048 }, // CI
+    {   FORMAT_RGBA4444,    GetIA44_RGBA4444,       ROW16(GetIA44_RGBA4444),    3,  4096 }, // IA
+    {   FORMAT_RGBA8888,    GetI8_RGBA8888,         ROW32(GetI8_RGBA8888),      3,  4096 }, // I
+    {   FORMAT_RGBA8888,    GetCI8IA_RGBA8888,      ROW32(GetCI8IA_RGBA8888),   3,  2048 }, // IA Palette
     // 16-bit
-    {   FORMAT_RGBA5551,    GetRGBA5551_RGBA5551,   2,  2048 }, // RGBA
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // YUV
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // CI
-    {   FORMAT_RGBA8888,    GetIA88_RGBA8888,       2,  2048 }, // IA
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // I
-    {   FORMAT_NONE,        GetNone,                2,  2048 }, // IA Palette
+    {   FORMAT_RGBA5551,    GetRGBA5551_RGBA5551,   GetTexelRow16<true>,        2,  2048 }, // RGBA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // YUV
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // CI
+    {   FORMAT_RGBA8888,    GetIA88_RGBA8888,       ROW32(GetIA88_RGBA8888),    2,  2048 }, // IA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // I
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  2048 }, // IA Palette
     // 32-bit
-    {   FORMAT_RGBA8888,    GetRGBA8888_RGBA8888,   2,  1024 }, // RGBA
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // YUV
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // CI
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // IA
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // I
-    {   FORMAT_NONE,        GetNone,                2,  1024 }, // IA Palette
+    {   FORMAT_RGBA8888,    GetRGBA8888_RGBA8888,   ROW32(GetRGBA8888_RGBA8888),2,  1024 }, // RGBA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // YUV
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // CI
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // IA
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // I
+    {   FORMAT_NONE,        GetNone,                ROW32(GetNone),             2,  1024 }, // IA Palette
 };
 
 
@@ -374,7 +442,7 @@ void TextureCache_Init()
     cache.cachedBytes = 0;
 
 #ifdef __HASHMAP_OPT
-    cache.hash.init(11);
+    cache.hash.init(HASHMAP_MIN_POWER2);
 #endif
 
     if (config.texture.useIA) textureFormat = textureFormatIA;
@@ -551,6 +619,20 @@ CachedTexture *TextureCache_AddTop()
 
     cache.numCached++;
 
+#ifdef __HASHMAP_OPT
+    // keep the buckets at least twice the number of cached textures so they rarely collide
+    if (cache.numCached * 2 > cache.hash.size())
+    {
+        unsigned power2 = HASHMAP_MIN_POWER2;
+        while ((1u << power2) < cache.numCached * 2) power2++;
+        cache.hash.resize(power2);
+
+        // the new top has no crc yet, it is inserted once it is activated
+        for (CachedTexture *tex = cache.bottom; tex && tex != newtop; tex = tex->higher)
+            if (tex != cache.dummy) cache.hash.insert(tex->crc, tex);
+    }
+#endif
+
     return newtop;
 }
 
@@ -593,17 +675,43 @@ void TextureCache_Destroy()
 
 
 
+static inline u16 _texel_s( u16 x, u16 clamp, u16 mask, u16 mirror )
+{
+    u16 tx = min( x, clamp ) & mask;
+    if (x & mirror) tx ^= mask;
+    return tx;
+}
+
+// Converts one line of the texture. Clamping, masking and mirroring only break
+// the line up at a few places, everything in between goes to the row converter
+// as one run.
+static void _texture_line( u8 *dest, void *src, u16 width, u16 i, u8 palette, int bytePerPixel,
+                           GetTexelRowFunc getTexelRow, u16 clamp, u16 mask, u16 mirror )
+{
+    u16 x = 0;
+    while (x < width)
+    {
+        u16 tx = _texel_s( x, clamp, mask, mirror );
+        u16 n = 1;
+        while ((x + n < width) && (_texel_s( x + n, clamp, mask, mirror ) == tx + n))
+            n++;
+
+        getTexelRow( dest + x * bytePerPixel, src, tx, n, i, palette );
+        x += n;
+    }
+}
+
 void TextureCache_LoadBackground( CachedTexture *texInfo )
 {
     u32 *dest, *scaledDest;
     u8 *swapped, *src;
     u32 numBytes, bpl;
-    u32 x, y, j, tx, ty;
+    u32 y, ty;
     u16 clampSClamp,  clampTClamp;
 
     int bytePerPixel=0;
     TextureFormat   texFormat;
-    GetTexelFunc    getTexel;
+    GetTexelRowFunc getTexelRow;
     GLint glWidth=0, glHeight=0;
     GLenum glType=0;
     GLenum glFormat=0;
@@ -651,7 +759,7 @@ void TextureCache_LoadBackground( CachedTexture *texInfo )
     glWidth = texInfo->realWidth;
     glHeight = texInfo->realHeight;
     texInfo->textureBytes = (glWidth * glHeight) * bytePerPixel;
-    getTexel = texFormat.getTexel;
+    getTexelRow = texFormat.getTexelRow;
 
     bpl = gSP.bgImage.width << gSP.bgImage.size >> 1;
     numBytes = bpl * gSP.bgImage.height;
@@ -669,21 +777,12 @@ void TextureCache_LoadBackground( CachedTexture *texInfo )
     clampSClamp = texInfo->width - 1;
     clampTClamp = texInfo->height - 1;
 
-    j = 0;
-    for (y = 0; y < texInfo->realHeight; y++)
+    for (y = 0; bytePerPixel && y < texInfo->realHeight; y++)
     {
         ty = min(y, clampTClamp);
         src = &swapped[bpl * ty];
-        for (x = 0; x < texInfo->realWidth; x++)
-        {
-            tx = min(x, clampSClamp);
-            if (bytePerPixel == 4)
-                ((u32*)dest)[j++] = getTexel(src, tx, 0, texInfo->palette);
-            else if (bytePerPixel == 2)
-                ((u16*)dest)[j++] = getTexel(src, tx, 0, texInfo->palette);
-            else if (bytePerPixel == 1)
-                ((u8*)dest)[j++] = getTexel(src, tx, 0, texInfo->palette);
-        }
+        _texture_line( (u8*)dest + y * texInfo->realWidth * bytePerPixel, src, texInfo->realWidth, 0,
+                       texInfo->palette, bytePerPixel, getTexelRow, clampSClamp, 0xFFFF, 0 );
     }
 
     if (!config.texture.sai2x || (texFormat.format == FORMAT_I8 || texFormat.format == FORMAT_IA88))
@@ -722,13 +821,13 @@ void TextureCache_Load( CachedTexture *texInfo )
     u32 *dest, *scaledDest;
 
     void *src;
-    u16 x, y, i, j, tx, ty, line;
+    u16 y, i, ty, line;
     u16 mirrorSBit, maskSMask, clampSClamp;
     u16 mirrorTBit, maskTMask, clampTClamp;
 
     int bytePerPixel=0;
     TextureFormat   texFormat;
-    GetTexelFunc    getTexel;
+    GetTexelRowFunc getTexelRow;
     GLint glWidth=0, glHeight=0;
     GLenum glType=0;
     GLenum glFormat=0;
@@ -776,7 +875,7 @@ void TextureCache_Load( CachedTexture *texInfo )
     glWidth = texInfo->realWidth;
     glHeight = texInfo->realHeight;
     texInfo->textureBytes = (glWidth * glHeight) * bytePerPixel;
-    getTexel = texFormat.getTexel;
+    getTexelRow = texFormat.getTexelRow;
 
     dest = (u32*)malloc(texInfo->textureBytes);
 
@@ -828,39 +927,20 @@ void TextureCache_Load( CachedTexture *texInfo )
     if (clampTClamp & 0x8000) clampTClamp = 0;
     if (clampSClamp & 0x8000) clampSClamp = 0;
 
-    j = 0;
-    for (y = 0; y < texInfo->realHeight; y++)
+    for (y = 0; bytePerPixel && y < texInfo->realHeight; y++)
     {
         ty = min(y, clampTClamp) & maskTMask;
         if (y & mirrorTBit) ty ^= maskTMask;
         src = &TMEM[(texInfo->tMem + line * ty) & 511];
         i = (ty & 1) << 1;
-        for (x = 0; x < texInfo->realWidth; x++)
-        {
-            tx = min(x, clampSClamp) & maskSMask;
-
-            if (x & mirrorSBit) tx ^= maskSMask;
-
-            if (bytePerPixel == 4)
-            {
-                ((u32*)dest)[j] = getTexel(src, tx, i, texInfo->palette);
-            }
-            else if (bytePerPixel == 2)
-            {
-                ((u16*)dest)[j] = getTexel(src, tx, i, texInfo->palette);
-            }
-            else if (bytePerPixel == 1)
-            {
-                ((u8*)dest)[j] = getTexel(src, tx, i, texInfo->palette);
-            }
-            j++;
-        }
+        _texture_line( (u8*)dest + y * texInfo->realWidth * bytePerPixel, src, texInfo->realWidth, i,
+                       texInfo->palette, bytePerPixel, getTexelRow, clampSClamp, maskSMask, mirrorSBit );
     }
 
     if (!config.texture.sai2x || (texFormat.format == FORMAT_I8) || (texFormat.format == FORMAT_IA88))
     {
 #ifdef PRINT_TEXTUREFORMAT
-        printf("j=%u DEST=0x%x SIZE=%i F=0x%x, W=%i, H=%i, T=0x%x\n", j, dest, texInfo->textureBytes,glFormat, glWidth, glHeight, glType); fflush(stdout);
+        printf("texels=%u DEST=0x%x SIZE=%i F=0x%x, W=%i, H=%i, T=0x%x\n", texInfo->realWidth * texInfo->realHeight, dest, texInfo->textureBytes,glFormat, glWidth, glHeight, glType); fflush(stdout);
 #endif
         glTexImage2D( GL_TEXTURE_2D, 0, glFormat, glWidth, glHeight, 0, glFormat, glType, dest);
     }
@@ -33,6 +33,7 @@ struct CachedTexture
 };
 
 #define TEXTURECACHE_MAX (8 * 1024 * 1024)
+#define HASHMAP_MIN_POWER2 8
 #define TEXTUREBUFFER_SIZE (512 * 1024)
 
 struct TextureCache
@@ -84,6 +84,7 @@ void __indexmap_undomap()
     }
 
     memcpy(OGL.triangles.vertices, tmp, INDEXMAP_SIZE * sizeof(SPVertex));
+    OGL_VerticesChanged(0, INDEXMAP_SIZE);
     OGL.triangles.indexmap_nomap = 1;
 }
 
@@ -338,6 +339,8 @@ static void gSPBillboardVertex4_default(u32 v)
 
 void gSPProcessVertex4(u32 v)
 {
+    OGL_VerticesChanged(v, 4);
+
     if (gSP.changed & CHANGED_MATRIX)
         gSPCombineMatrices();
 
@@ -490,6 +493,8 @@ void gSPProcessVertex( u32 v )
     f32 intensity;
     f32 r, g, b;
 
+    OGL_VerticesChanged(v, 1);
+
     if (gSP.changed & CHANGED_MATRIX)
         gSPCombineMatrices();
 
@@ -1193,6 +1198,9 @@ void gSPDMATriangles( u32 tris, u32 n )
         OGL.triangles.vertices[v1].t = _FIXED2FLOAT( triangles->t1, 5 );
         OGL.triangles.vertices[v2].s = _FIXED2FLOAT( triangles->s2, 5 );
         OGL.triangles.vertices[v2].t = _FIXED2FLOAT( triangles->t2, 5 );
+        OGL_VerticesChanged(v0, 1);
+        OGL_VerticesChanged(v1, 1);
+        OGL_VerticesChanged(v2, 1);
         gSPTriangle(triangles->v0, triangles->v1, triangles->v2);
         triangles++;
     }
@@ -1338,6 +1346,8 @@ void gSPModifyVertex( u32 vtx, u32 where, u32 val )
     v = OGL.triangles.indexmap[v];
 #endif
 
+    OGL_VerticesChanged(v, 1);
+
     switch (where)
     {
         case G_MWO_POINT_RGBA:
@@ -1682,6 +1692,11 @@ void gSPObjSprite( u32 sp )
     OGL.triangles.vertices[v3].z = -1.0f;
     OGL.triangles.vertices[v3].w = 1.0f;
 
+    OGL_VerticesChanged(v0, 1);
+    OGL_VerticesChanged(v1, 1);
+    OGL_VerticesChanged(v2, 1);
+    OGL_VerticesChanged(v3, 1);
+
     OGL_AddTriangle(v0, v1, v2);
     OGL_AddTriangle(v0, v2, v3);
     OGL_DrawTriangles();
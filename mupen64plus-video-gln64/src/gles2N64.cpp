@@ -5,6 +5,7 @@
 
 #include "m64p_types.h"
 #include "m64p_plugin.h"
+#include "m64p_frontend.h"
 
 #include "gles2N64.h"
 #include "Debug.h"
@@ -21,6 +22,8 @@
 #include "ticks.h"
 
 ptr_ConfigGetSharedDataFilepath ConfigGetSharedDataFilepath = NULL;
+ptr_ConfigGetUserCachePath ConfigGetUserCachePath = NULL;
+static ptr_CoreDoCommand CoreDoCommand = NULL;
 
 /* definitions of pointers to Core video extension functions */
 ptr_VidExt_Init                  CoreVideo_Init = NULL;
@@ -48,6 +51,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle,
 {
     ConfigGetSharedDataFilepath = (ptr_ConfigGetSharedDataFilepath)
             dlsym(CoreLibHandle, "ConfigGetSharedDataFilepath");
+    ConfigGetUserCachePath = (ptr_ConfigGetUserCachePath)
+            dlsym(CoreLibHandle, "ConfigGetUserCachePath");
+    CoreDoCommand = (ptr_CoreDoCommand) dlsym(CoreLibHandle, "CoreDoCommand");
 
     /* Get the core Video Extension function pointers from the library handle */
     CoreVideo_Init = (ptr_VidExt_Init) dlsym(CoreLibHandle, "VidExt_Init");
@@ -63,8 +69,10 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle,
     CoreVideo_GL_SwapBuffers = (ptr_VidExt_GL_SwapBuffers) dlsym(CoreLibHandle, "VidExt_GL_SwapBuffers");
 
 #ifdef __NEON_OPT
-    if (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
-            (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0)
+    // NEON is optional on ARMv7 but always there on ARMv8
+    if (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM64 ||
+            (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+            (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0))
     {
         MathInitNeon();
         gSPInitNeon();
@@ -150,7 +158,9 @@ EXPORT int CALL InitiateGFX (GFX_INFO Gfx_Info)
     Config_LoadRomConfig(Gfx_Info.HEADER);
 
     ticksInitialize();
-    if( config.autoFrameSkip )
+    if( config.autoFrameSkip && config.predictiveFrameSkip )
+        frameSkipper.setSkips( FrameSkipper::PREDICTIVE, config.maxFrameSkip );
+    else if( config.autoFrameSkip )
         frameSkipper.setSkips( FrameSkipper::AUTO, config.maxFrameSkip );
     else
         frameSkipper.setSkips( FrameSkipper::MANUAL, config.maxFrameSkip );
@@ -179,7 +189,9 @@ EXPORT void CALL ProcessDList(void)
     }
 
     OGL.consecutiveSkips = 0;
+    frameSkipper.renderStart();
     RSP_ProcessDList();
+    frameSkipper.renderEnd();
     OGL.mustRenderDlist = true;
 }
 
@@ -218,6 +230,11 @@ EXPORT void CALL ShowCFB (void)
 
 EXPORT void CALL UpdateScreen (void)
 {
+    // keep skipping in step with fast forward and audio driven pacing
+    int speedFactor = 100;
+    if (CoreDoCommand != NULL)
+        CoreDoCommand(M64CMD_CORE_STATE_QUERY, M64CORE_SPEED_FACTOR, &speedFactor);
+    frameSkipper.setSpeedFactor(speedFactor);
     frameSkipper.update();
 
     //has there been any display lists since last update
@@ -230,7 +247,9 @@ EXPORT void CALL UpdateScreen (void)
     if (OGL.mustRenderDlist)
     {
         OGL.screenUpdate=true;
+        frameSkipper.renderStart();
         VI_UpdateScreen();
+        frameSkipper.renderEnd();
         OGL.mustRenderDlist = false;
     }
 }
@@ -324,9 +343,10 @@ EXPORT void CALL SetRenderingCallback(void (*callback)())
 
 EXPORT void CALL SetFrameSkipping(bool autoSkip, int maxSkips)
 {
-    frameSkipper.setSkips(
-            autoSkip ? FrameSkipper::AUTO : FrameSkipper::MANUAL,
-            maxSkips);
+    int type = FrameSkipper::MANUAL;
+    if (autoSkip)
+        type = config.predictiveFrameSkip ? FrameSkipper::PREDICTIVE : FrameSkipper::AUTO;
+    frameSkipper.setSkips(type, maxSkips);
 }
 
 EXPORT void CALL SetStretchVideo(bool stretch)
@@ -16,6 +16,7 @@
 #define PLUGIN_API_VERSION 0x020200
 
 extern ptr_ConfigGetSharedDataFilepath ConfigGetSharedDataFilepath;
+extern ptr_ConfigGetUserCachePath ConfigGetUserCachePath;
 
 extern void (*CheckInterrupts)( void );
 extern void (*renderCallback)();
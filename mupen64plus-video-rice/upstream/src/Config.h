@@ -190,6 +190,7 @@ typedef struct {
     uint32  textureEnhancement;
     uint32  textureEnhancementControl;
     uint32  textureQuality;
+    uint32  textureCacheSize;
     uint32  anisotropicFiltering;
     uint32  multiSampling;
     BOOL    bTexRectOnly;
@@ -197,6 +198,7 @@ typedef struct {
     BOOL    bDumpTexturesToFiles;
     BOOL    bLoadHiResTextures;
     BOOL    bLoadHiResCRCOnly;
+    BOOL    bLoadHiResAsync;
 
     int     OpenglDepthBufferSetting;
     int     OpenglRenderSetting;
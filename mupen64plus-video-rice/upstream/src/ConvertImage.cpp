@@ -26,6 +26,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Texture.h"
 #include "TextureManager.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CONVERT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CONVERT_SSE2
+#endif
+
 ConvertFunction     gConvertFunctions_FullTMEM[ 8 ][ 4 ] = 
 {
     // 4bpp             8bpp            16bpp               32bpp
@@ -66,6 +74,376 @@ ConvertFunction     gConvertTlutFunctions[ 8 ][ 4 ] =
 
 extern bool conkerSwapHack;
 
+//*****************************************************************************
+// Row converters for the non full TMEM paths. Texels are addressed by a byte
+// offset that is xor'ed with the swap fiddle, so 16 source bytes starting at an
+// 8 byte aligned offset always hold the same 8 (or 16) texels, just permuted
+// within each word. The vector paths undo that permutation in registers and
+// the scalar code handles the unaligned head and the tail of each row.
+//*****************************************************************************
+
+#if defined(CONVERT_NEON)
+static inline uint16x8_t LoadSwapped16(const uint8 *pSrc, uint32 nFiddle)
+{
+    uint16x8_t w = vld1q_u16((const uint16 *)pSrc);
+    return (nFiddle & 0x4) ? vrev64q_u16(w) : vrev32q_u16(w);
+}
+
+static inline uint8x16_t LoadSwapped8(const uint8 *pSrc, uint32 nFiddle)
+{
+    uint8x16_t b = vld1q_u8(pSrc);
+    return (nFiddle & 0x4) ? vrev64q_u8(b) : vrev32q_u8(b);
+}
+
+static inline uint8x16_t ExpandFour(uint8x16_t v)
+{
+    return vsliq_n_u8(v, v, 4);
+}
+#elif defined(CONVERT_SSE2)
+static inline __m128i LoadSwapped16(const uint8 *pSrc, uint32 nFiddle)
+{
+    __m128i w = _mm_loadu_si128((const __m128i *)pSrc);
+    if (nFiddle & 0x4)
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+static inline __m128i LoadSwapped8(const uint8 *pSrc, uint32 nFiddle)
+{
+    __m128i b = _mm_loadu_si128((const __m128i *)pSrc);
+    b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+    if (nFiddle & 0x4)
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+// Nibbles in the low half of each byte to 8 bits, same as FourToEight
+static inline __m128i ExpandFour(__m128i v)
+{
+    return _mm_or_si128(v, _mm_slli_epi16(v, 4));
+}
+
+// Stores 16 intensity bytes as 16 pixels with all four channels set to it
+static inline void StoreI8x16(uint8 *pDst, __m128i b)
+{
+    __m128i lo = _mm_unpacklo_epi8(b, b);
+    __m128i hi = _mm_unpackhi_epi8(b, b);
+    _mm_storeu_si128((__m128i *)(pDst +  0), _mm_unpacklo_epi16(lo, lo));
+    _mm_storeu_si128((__m128i *)(pDst + 16), _mm_unpackhi_epi16(lo, lo));
+    _mm_storeu_si128((__m128i *)(pDst + 32), _mm_unpacklo_epi16(hi, hi));
+    _mm_storeu_si128((__m128i *)(pDst + 48), _mm_unpackhi_epi16(hi, hi));
+}
+#endif
+
+// RGBA16 texels to 32 bit, nFiddle is 0x2 or 0x6
+static void ConvertRow555ToRGBA(uint32 *pDst, const uint8 *pSrc, uint32 dwWordOffset, uint32 count, uint32 nFiddle)
+{
+    uint32 x = 0;
+
+    for (; x < count && (dwWordOffset & 0x7); x++, dwWordOffset += 2)
+        pDst[x] = Convert555ToRGBA(*(uint16 *)&pSrc[dwWordOffset ^ nFiddle]);
+
+#if defined(CONVERT_NEON)
+    for (; x + 8 <= count; x += 8, dwWordOffset += 16)
+    {
+        uint16x8_t w = LoadSwapped16(pSrc + dwWordOffset, nFiddle);
+        uint16x8_t r = vshrq_n_u16(w, 11);
+        uint16x8_t g = vandq_u16(vshrq_n_u16(w, 6), vdupq_n_u16(0x1F));
+        uint16x8_t b = vandq_u16(vshrq_n_u16(w, 1), vdupq_n_u16(0x1F));
+        uint8x8x4_t px;
+        px.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+        px.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2)));
+        px.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+        px.val[3] = vmovn_u16(vtstq_u16(w, vdupq_n_u16(0x1)));
+        vst4_u8((uint8 *)(pDst + x), px);
+    }
+#elif defined(CONVERT_SSE2)
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    for (; x + 8 <= count; x += 8, dwWordOffset += 16)
+    {
+        __m128i w = LoadSwapped16(pSrc + dwWordOffset, nFiddle);
+        __m128i r = _mm_srli_epi16(w, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(w, 6), mask5);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(w, 1), mask5);
+        __m128i a = _mm_slli_epi16(_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(w, _mm_set1_epi16(0x1))), 8);
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+        __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+        __m128i ra = _mm_or_si128(r, a);
+        _mm_storeu_si128((__m128i *)(pDst + x), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128((__m128i *)(pDst + x + 4), _mm_unpackhi_epi16(bg, ra));
+    }
+#endif
+
+    for (; x < count; x++, dwWordOffset += 2)
+        pDst[x] = Convert555ToRGBA(*(uint16 *)&pSrc[dwWordOffset ^ nFiddle]);
+}
+
+// IA16 texels to 32 bit, nFiddle is 0x2 or 0x6
+static void ConvertRowIA16ToRGBA(uint8 *pDst, const uint8 *pSrc, uint32 dwWordOffset, uint32 count, uint32 nFiddle)
+{
+    uint32 x = 0;
+
+    for (; x < count && (dwWordOffset & 0x7); x++, dwWordOffset += 2)
+    {
+        uint16 w = *(uint16 *)&pSrc[dwWordOffset ^ nFiddle];
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w & 0xFF);
+    }
+
+#if defined(CONVERT_NEON)
+    for (; x + 8 <= count; x += 8, dwWordOffset += 16, pDst += 32)
+    {
+        uint16x8_t w = LoadSwapped16(pSrc + dwWordOffset, nFiddle);
+        uint8x8x4_t px;
+        px.val[0] = px.val[1] = px.val[2] = vshrn_n_u16(w, 8);
+        px.val[3] = vmovn_u16(w);
+        vst4_u8(pDst, px);
+    }
+#elif defined(CONVERT_SSE2)
+    for (; x + 8 <= count; x += 8, dwWordOffset += 16, pDst += 32)
+    {
+        __m128i w = LoadSwapped16(pSrc + dwWordOffset, nFiddle);
+        __m128i i = _mm_srli_epi16(w, 8);
+        __m128i ii = _mm_or_si128(i, _mm_slli_epi16(i, 8));
+        __m128i ia = _mm_or_si128(i, _mm_slli_epi16(w, 8));
+        _mm_storeu_si128((__m128i *)pDst, _mm_unpacklo_epi16(ii, ia));
+        _mm_storeu_si128((__m128i *)(pDst + 16), _mm_unpackhi_epi16(ii, ia));
+    }
+#endif
+
+    for (; x < count; x++, dwWordOffset += 2)
+    {
+        uint16 w = *(uint16 *)&pSrc[dwWordOffset ^ nFiddle];
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w >> 8);
+        *pDst++ = (uint8)(w & 0xFF);
+    }
+}
+
+// IA8 texels to 32 bit, nFiddle is 0x3 or 0x7
+static void ConvertRowIA8ToRGBA(uint8 *pDst, const uint8 *pSrc, uint32 dwByteOffset, uint32 count, uint32 nFiddle)
+{
+    uint32 x = 0;
+
+    for (; x < count && (dwByteOffset & 0x7); x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        uint8 I = FourToEight[b >> 4];
+        *pDst++ = I;
+        *pDst++ = I;
+        *pDst++ = I;
+        *pDst++ = FourToEight[b & 0x0F];
+    }
+
+#if defined(CONVERT_NEON)
+    for (; x + 16 <= count; x += 16, dwByteOffset += 16, pDst += 64)
+    {
+        uint8x16_t b = LoadSwapped8(pSrc + dwByteOffset, nFiddle);
+        uint8x16x4_t px;
+        px.val[0] = px.val[1] = px.val[2] = ExpandFour(vshrq_n_u8(b, 4));
+        px.val[3] = ExpandFour(vandq_u8(b, vdupq_n_u8(0x0F)));
+        vst4q_u8(pDst, px);
+    }
+#elif defined(CONVERT_SSE2)
+    const __m128i mask4 = _mm_set1_epi8(0x0F);
+    for (; x + 16 <= count; x += 16, dwByteOffset += 16, pDst += 64)
+    {
+        __m128i b = LoadSwapped8(pSrc + dwByteOffset, nFiddle);
+        __m128i i = ExpandFour(_mm_and_si128(_mm_srli_epi16(b, 4), mask4));
+        __m128i a = ExpandFour(_mm_and_si128(b, mask4));
+        __m128i iiLo = _mm_unpacklo_epi8(i, i);
+        __m128i iaLo = _mm_unpacklo_epi8(i, a);
+        __m128i iiHi = _mm_unpackhi_epi8(i, i);
+        __m128i iaHi = _mm_unpackhi_epi8(i, a);
+        _mm_storeu_si128((__m128i *)(pDst +  0), _mm_unpacklo_epi16(iiLo, iaLo));
+        _mm_storeu_si128((__m128i *)(pDst + 16), _mm_unpackhi_epi16(iiLo, iaLo));
+        _mm_storeu_si128((__m128i *)(pDst + 32), _mm_unpacklo_epi16(iiHi, iaHi));
+        _mm_storeu_si128((__m128i *)(pDst + 48), _mm_unpackhi_epi16(iiHi, iaHi));
+    }
+#endif
+
+    for (; x < count; x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        uint8 I = FourToEight[b >> 4];
+        *pDst++ = I;
+        *pDst++ = I;
+        *pDst++ = I;
+        *pDst++ = FourToEight[b & 0x0F];
+    }
+}
+
+// I8 texels to 32 bit, nFiddle is 0x3 or 0x7
+static void ConvertRowI8ToRGBA(uint8 *pDst, const uint8 *pSrc, uint32 dwByteOffset, uint32 count, uint32 nFiddle)
+{
+    uint32 x = 0;
+
+    for (; x < count && (dwByteOffset & 0x7); x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        *pDst++ = b;
+        *pDst++ = b;
+        *pDst++ = b;
+        *pDst++ = b;        // Alpha not 255?
+    }
+
+#if defined(CONVERT_NEON)
+    for (; x + 16 <= count; x += 16, dwByteOffset += 16, pDst += 64)
+    {
+        uint8x16x4_t px;
+        px.val[0] = px.val[1] = px.val[2] = px.val[3] = LoadSwapped8(pSrc + dwByteOffset, nFiddle);
+        vst4q_u8(pDst, px);
+    }
+#elif defined(CONVERT_SSE2)
+    for (; x + 16 <= count; x += 16, dwByteOffset += 16, pDst += 64)
+        StoreI8x16(pDst, LoadSwapped8(pSrc + dwByteOffset, nFiddle));
+#endif
+
+    for (; x < count; x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        *pDst++ = b;
+        *pDst++ = b;
+        *pDst++ = b;
+        *pDst++ = b;        // Alpha not 255?
+    }
+}
+
+// I4 texels to 32 bit, two pixels per source byte, nFiddle is 0x3 or 0x7
+static void ConvertRowI4ToRGBA(uint8 *pDst, const uint8 *pSrc, uint32 dwByteOffset, uint32 bytes, uint32 nFiddle)
+{
+    uint32 x = 0;
+
+    for (; x < bytes && (dwByteOffset & 0x7); x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        uint8 hi = FourToEight[(b & 0xF0)>>4];
+        uint8 lo = FourToEight[(b & 0x0F)];
+        *pDst++ = hi; *pDst++ = hi; *pDst++ = hi; *pDst++ = hi;
+        *pDst++ = lo; *pDst++ = lo; *pDst++ = lo; *pDst++ = lo;
+    }
+
+#if defined(CONVERT_NEON)
+    for (; x + 16 <= bytes; x += 16, dwByteOffset += 16, pDst += 128)
+    {
+        uint8x16_t b = LoadSwapped8(pSrc + dwByteOffset, nFiddle);
+        uint8x16x2_t p = vzipq_u8(ExpandFour(vshrq_n_u8(b, 4)), ExpandFour(vandq_u8(b, vdupq_n_u8(0x0F))));
+        uint8x16x4_t px;
+        px.val[0] = px.val[1] = px.val[2] = px.val[3] = p.val[0];
+        vst4q_u8(pDst, px);
+        px.val[0] = px.val[1] = px.val[2] = px.val[3] = p.val[1];
+        vst4q_u8(pDst + 64, px);
+    }
+#elif defined(CONVERT_SSE2)
+    const __m128i mask4 = _mm_set1_epi8(0x0F);
+    for (; x + 16 <= bytes; x += 16, dwByteOffset += 16, pDst += 128)
+    {
+        __m128i b = LoadSwapped8(pSrc + dwByteOffset, nFiddle);
+        __m128i hi = ExpandFour(_mm_and_si128(_mm_srli_epi16(b, 4), mask4));
+        __m128i lo = ExpandFour(_mm_and_si128(b, mask4));
+        StoreI8x16(pDst, _mm_unpacklo_epi8(hi, lo));
+        StoreI8x16(pDst + 64, _mm_unpackhi_epi8(hi, lo));
+    }
+#endif
+
+    for (; x < bytes; x++, dwByteOffset++)
+    {
+        uint8 b = pSrc[dwByteOffset ^ nFiddle];
+        uint8 hi = FourToEight[(b & 0xF0)>>4];
+        uint8 lo = FourToEight[(b & 0x0F)];
+        *pDst++ = hi; *pDst++ = hi; *pDst++ = hi; *pDst++ = hi;
+        *pDst++ = lo; *pDst++ = lo; *pDst++ = lo; *pDst++ = lo;
+    }
+}
+
+void FillRow32(uint32 *pDst, uint32 val, uint32 count)
+{
+    uint32 x = 0;
+
+#if defined(CONVERT_NEON)
+    uint32x4_t v = vdupq_n_u32(val);
+    for (; x + 4 <= count; x += 4)
+        vst1q_u32(pDst + x, v);
+#elif defined(CONVERT_SSE2)
+    __m128i v = _mm_set1_epi32((int)val);
+    for (; x + 4 <= count; x += 4)
+        _mm_storeu_si128((__m128i *)(pDst + x), v);
+#endif
+
+    for (; x < count; x++)
+        pDst[x] = val;
+}
+
+// pDst[i] = pSrcLast[-i], the two ranges must not overlap
+void ReverseCopyRow32(uint32 *pDst, const uint32 *pSrcLast, uint32 count)
+{
+    uint32 x = 0;
+
+#if defined(CONVERT_NEON)
+    for (; x + 4 <= count; x += 4)
+    {
+        uint32x4_t v = vrev64q_u32(vld1q_u32(pSrcLast - x - 3));
+        vst1q_u32(pDst + x, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+    }
+#elif defined(CONVERT_SSE2)
+    for (; x + 4 <= count; x += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pSrcLast - x - 3));
+        _mm_storeu_si128((__m128i *)(pDst + x), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+
+    for (; x < count; x++)
+        pDst[x] = *(pSrcLast - x);
+}
+
+//*****************************************************************************
+// There is no gather on NEON or SSE2, so CI textures look their texels up in a
+// copy of the TLUT that is converted to 32 bit once per texture instead.
+// Remember palette is in different endian order!
+//*****************************************************************************
+static void ConvertTlut555(uint32 *pTlut, const uint16 *pPal, uint32 entries, uint32 dwAlphaOr)
+{
+    for (uint32 i = 0; i < entries; i++)
+        pTlut[i] = Convert555ToRGBA(pPal[i^1]) | dwAlphaOr;
+}
+
+static void ConvertTlutIA16(uint32 *pTlut, const uint16 *pPal, uint32 entries, uint32 dwAlphaOr)
+{
+    for (uint32 i = 0; i < entries; i++)
+        pTlut[i] = ConvertIA16ToRGBA(pPal[i^1]) | dwAlphaOr;
+}
+
+static void ConvertRowCI4(uint32 *pDst, const uint8 *pSrc, uint32 dwByteOffset, uint32 width, uint32 nFiddle, const uint32 *pTlut)
+{
+    if (width == 1)
+    {
+        // corner case
+        *pDst = pTlut[pSrc[dwByteOffset ^ nFiddle] >> 4];
+        return;
+    }
+
+    for (uint32 x = 0; x < width; x+=2)
+    {
+        // two at a time
+        uint8 b = pSrc[dwByteOffset++ ^ nFiddle];
+        *pDst++ = pTlut[b >> 4];
+        *pDst++ = pTlut[b & 0x0F];
+    }
+}
+
+static void ConvertRowCI8(uint32 *pDst, const uint8 *pSrc, uint32 dwByteOffset, uint32 width, uint32 nFiddle, const uint32 *pTlut)
+{
+    for (uint32 x = 0; x < width; x++)
+        pDst[x] = pTlut[pSrc[dwByteOffset++ ^ nFiddle]];
+}
+
+
 // Super Mario 64, Zelda OOT
 void ConvertRGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
@@ -97,15 +475,7 @@ void ConvertRGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
         // (process 2 pixels at a time). May be a problem if we don't start on even pixel
         uint32 dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
 
-        for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-        {
-            uint16 w = *(uint16 *)&pByteSrc[dwWordOffset ^ nFiddle];
-
-            dwDst[x] = Convert555ToRGBA(w);
-
-            // Increment word offset to point to the next two pixels
-            dwWordOffset += 2;
-        }
+        ConvertRow555ToRGBA(dwDst, pByteSrc, dwWordOffset, tinfo.WidthToLoad, nFiddle);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -300,7 +670,7 @@ void ConvertIA4(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
 
@@ -311,57 +681,19 @@ void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            // For odd lines, swap words too
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
-            // Points to current byte
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-                uint8 I = FourToEight[(b & 0xf0)>>4];
+        // For odd lines, swap words too
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? 0x7 : 0x3;
 
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = FourToEight[(b & 0x0f)   ];
+        uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
+        // Points to current byte
+        uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        ConvertRowIA8ToRGBA(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle);
     }
-    else
-    {
-        register const uint8* FourToEightArray = &FourToEight[0];
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
 
-            // Points to current byte
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                register uint8 b = pSrc[(dwByteOffset++) ^ 0x3];
-                uint8 I = *(FourToEightArray+(b>>4));
-
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = I;
-                *pDst++ = *(FourToEightArray+(b&0xF));
-            }
-        }
-    }   
-    
     pTexture->EndUpdate(&dInfo);
 
 }
@@ -370,7 +702,7 @@ void ConvertIA8(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertIA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x2;
 
     uint16 * pSrc = (uint16*)(tinfo.pPhysicalAddress);
     uint8 * pByteSrc = (uint8 *)pSrc;
@@ -378,57 +710,19 @@ void ConvertIA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            if ((y%2) == 0)
-                nFiddle = 0x2;
-            else
-                nFiddle = 0x4 | 0x2;
-
-            // Points to current word
-            uint32 dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
-
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16 w = *(uint16 *)&pByteSrc[dwWordOffset^nFiddle];
-
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w & 0xFF);
-
-                dwWordOffset += 2;
-            }
-        }
-    }
-    else
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
+        uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
 
-            // Points to current word
-            uint32 dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
-
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint16 w = *(uint16 *)&pByteSrc[dwWordOffset^0x2];
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? (0x4 | 0x2) : 0x2;
 
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w >> 8);
-                *pDst++ = (uint8)(w & 0xFF);
+        // Points to current word
+        uint32 dwWordOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad * 2);
 
-                dwWordOffset += 2;
-            }
-        }       
+        ConvertRowIA16ToRGBA(pDst, pByteSrc, dwWordOffset, tinfo.WidthToLoad, nFiddle);
     }
 
-
     pTexture->EndUpdate(&dInfo);
 }
 
@@ -438,7 +732,7 @@ void ConvertIA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
 
@@ -449,101 +743,41 @@ void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
+        uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
 
-            // Might not work with non-even starting X
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
+        // Might not work with non-even starting X
+        uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
 
-            // For odd lines, swap words too
+        // For odd lines, swap words too
+        if (tinfo.bSwapped)
+        {
             if( !conkerSwapHack || (y&4) == 0 )
-            {
-                if ((y%2) == 0)
-                    nFiddle = 0x3;
-                else
-                    nFiddle = 0x7;
-            }
+                nFiddle = (y&1) ? 0x7 : 0x3;
             else
-            {
-                if ((y%2) == 1)
-                    nFiddle = 0x3;
-                else
-                    nFiddle = 0x7;
-            }
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-
-                // Even
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   // Other implementations seem to or in (b&0xF0)>>4
-                *pDst++ = FourToEight[(b & 0xF0)>>4]; // why?
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-                // Odd
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-
-                dwByteOffset++;
-            }
+                nFiddle = (y&1) ? 0x3 : 0x7;
         }
 
-        conkerSwapHack = false;
-    }
-    else
-    {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
+        if (tinfo.WidthToLoad == 1)
         {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            // Might not work with non-even starting X
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-
-                // Even
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   // Other implementations seem to or in (b&0xF0)>>4
-                *pDst++ = FourToEight[(b & 0xF0)>>4]; // why?
-                *pDst++ = FourToEight[(b & 0xF0)>>4];
-                *pDst++ = FourToEight[(b & 0xF0)>>4];   
-                // Odd
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-                *pDst++ = FourToEight[(b & 0x0F)];
-
-                dwByteOffset++;
-            }
+            // corner case
+            uint8 b = pSrc[dwByteOffset ^ nFiddle];
+            *pDst++ = FourToEight[(b & 0xF0)>>4];
+            *pDst++ = FourToEight[(b & 0xF0)>>4];
+            *pDst++ = FourToEight[(b & 0xF0)>>4];
+            *pDst++ = FourToEight[(b & 0xF0)>>4];   
+        }
+        else
+        {
+            // two pixels per byte
+            ConvertRowI4ToRGBA(pDst, pSrc, dwByteOffset, (tinfo.WidthToLoad + 1) / 2, nFiddle);
         }
     }
 
+    if (tinfo.bSwapped)
+        conkerSwapHack = false;
+
     pTexture->EndUpdate(&dInfo);
 }
 
@@ -551,58 +785,25 @@ void ConvertI4(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertI8(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
+
+    // The fiddle applies to the address here, not to the offset
+    uint8 * pSrc = (uint8*)((long long)tinfo.pPhysicalAddress & ~7LL);
+    uint32 dwBaseOffset = (uint32)((long long)tinfo.pPhysicalAddress & 7);
 
-    long long pSrc = (long long) tinfo.pPhysicalAddress;
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? 0x7 : 0x3;
 
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
+        uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
 
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
+        uint32 dwByteOffset = dwBaseOffset + ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = *(uint8*)((pSrc+dwByteOffset)^nFiddle);
-
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;        // Alpha not 255?
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
-    {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint8 *pDst = (uint8 *)dInfo.lpSurface + y * dInfo.lPitch;
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = *(uint8*)((pSrc+dwByteOffset)^0x3);
-
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;
-                *pDst++ = b;        // Alpha not 255?
-
-                dwByteOffset++;
-            }
-        }
+        ConvertRowI8ToRGBA(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -643,7 +844,7 @@ void ConvertCI8( CTexture * p_texture, const TxtrInfo & tinfo )
 void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
     uint16 * pPal = (uint16 *)tinfo.PalAddress;
@@ -652,95 +853,27 @@ void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-                uint8 bhi = (b&0xf0)>>4;
-                *pDst = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *pDst |= 0xFF000000;
-                }
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-
-                uint8 bhi = (b&0xf0)>>4;
-                uint8 blo = (b&0x0f);
-
-                pDst[0] = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                pDst[1] = Convert555ToRGBA(pPal[blo^1]);    // Remember palette is in different endian order!
+    uint32 tlut[16];
+    ConvertTlut555(tlut, pPal, 16, bIgnoreAlpha ? 0xFF000000 : 0);
 
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
-
-                pDst+=2;
+    for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
+    {
+        uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                dwByteOffset++;
-            }
+        uint32 dwByteOffset;
+        if (tinfo.bSwapped)
+        {
+            nFiddle = (y&1) ? 0x7 : 0x3;
+            dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch);
         }
-    }
-    else
-    {
-        for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
+        else
         {
-            uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-                uint8 bhi = (b&0xf0)>>4;
-                *pDst = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *pDst |= 0xFF000000;
-                }
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-
-                uint8 bhi = (b&0xf0)>>4;
-                uint8 blo = (b&0x0f);
-
-                pDst[0] = Convert555ToRGBA(pPal[bhi^1]);    // Remember palette is in different endian order!
-                pDst[1] = Convert555ToRGBA(pPal[blo^1]);    // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
-
-                pDst+=2;
-
-                dwByteOffset++;
-            }
+            dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
         }
+
+        ConvertRowCI4(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle, tlut);
     }
+
     pTexture->EndUpdate(&dInfo);
 }
 
@@ -748,7 +881,7 @@ void ConvertCI4_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
 
@@ -762,91 +895,21 @@ void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-                uint8 bhi = (b&0xf0)>>4;
-                *pDst = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                    *pDst |= 0xFF000000;
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two at a time
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-
-                uint8 bhi = (b&0xf0)>>4;
-                uint8 blo = (b&0x0f);
+    uint32 tlut[16];
+    ConvertTlutIA16(tlut, pPal, 16, bIgnoreAlpha ? 0xFF000000 : 0);
 
-                pDst[0] = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                pDst[1] = ConvertIA16ToRGBA(pPal[blo^1]);   // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
-
-                pDst+=2;
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y <  tinfo.HeightToLoad; y++)
-        {
-            uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
-
-            if (tinfo.WidthToLoad == 1)
-            {
-                // corner case
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-                uint8 bhi = (b&0xf0)>>4;
-                *pDst = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                    *pDst |= 0xFF000000;
-            }
-            else for (uint32 x = 0; x < tinfo.WidthToLoad; x+=2)
-            {
-                // two pixels at a time
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
-
-                uint8 bhi = (b&0xf0)>>4;
-                uint8 blo = (b&0x0f);
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? 0x7 : 0x3;
 
-                pDst[0] = ConvertIA16ToRGBA(pPal[bhi^1]);   // Remember palette is in different endian order!
-                pDst[1] = ConvertIA16ToRGBA(pPal[blo^1]);   // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    pDst[0] |= 0xFF000000;
-                    pDst[1] |= 0xFF000000;
-                }
+        uint32 * pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                pDst+=2;
+        uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + (tinfo.LeftToLoad / 2);
 
-                dwByteOffset++;
-            }
-        }
+        ConvertRowCI4(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle, tlut);
     }
+
     pTexture->EndUpdate(&dInfo);
 }
 
@@ -855,7 +918,7 @@ void ConvertCI4_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
 
@@ -868,56 +931,20 @@ void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 
     if (!pTexture->StartUpdate(&dInfo))
         return;
-    
-    if (tinfo.bSwapped)
-    {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
-
-            uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
 
-                *pDst++ = Convert555ToRGBA(pPal[b^1]);  // Remember palette is in different endian order!
-                
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
+    uint32 tlut[256];
+    ConvertTlut555(tlut, pPal, 256, bIgnoreAlpha ? 0xFF000000 : 0);
 
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? 0x7 : 0x3;
 
-            int dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
+        uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                *pDst++ = Convert555ToRGBA(pPal[b^1]);  // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
+        uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        ConvertRowCI8(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle, tlut);
     }
 
     pTexture->EndUpdate(&dInfo);
@@ -929,7 +956,7 @@ void ConvertCI8_RGBA16(CTexture *pTexture, const TxtrInfo &tinfo)
 void ConvertCI8_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
 {
     DrawInfo dInfo;
-    uint32 nFiddle;
+    uint32 nFiddle = 0x3;
 
     uint8 * pSrc = (uint8*)(tinfo.pPhysicalAddress);
 
@@ -943,54 +970,19 @@ void ConvertCI8_IA16(CTexture *pTexture, const TxtrInfo &tinfo)
     if (!pTexture->StartUpdate(&dInfo))
         return;
 
-    if (tinfo.bSwapped)
-    {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            if ((y%2) == 0)
-                nFiddle = 0x3;
-            else
-                nFiddle = 0x7;
+    uint32 tlut[256];
+    ConvertTlutIA16(tlut, pPal, 256, bIgnoreAlpha ? 0xFF000000 : 0);
 
-            uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
-
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = pSrc[dwByteOffset ^ nFiddle];
-
-                *pDst++ = ConvertIA16ToRGBA(pPal[b^1]); // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
-
-                dwByteOffset++;
-            }
-        }
-    }
-    else
+    for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
     {
-        for (uint32 y = 0; y < tinfo.HeightToLoad; y++)
-        {
-            uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
+        if (tinfo.bSwapped)
+            nFiddle = (y&1) ? 0x7 : 0x3;
 
-            uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
-            
-            for (uint32 x = 0; x < tinfo.WidthToLoad; x++)
-            {
-                uint8 b = pSrc[dwByteOffset ^ 0x3];
+        uint32 *pDst = (uint32 *)((uint8 *)dInfo.lpSurface + y * dInfo.lPitch);
 
-                *pDst++ = ConvertIA16ToRGBA(pPal[b^1]); // Remember palette is in different endian order!
-                if( bIgnoreAlpha )
-                {
-                    *(pDst-1) |= 0xFF000000;
-                }
+        uint32 dwByteOffset = ((y+tinfo.TopToLoad) * tinfo.Pitch) + tinfo.LeftToLoad;
 
-                dwByteOffset++;
-            }
-        }
+        ConvertRowCI8(pDst, pSrc, dwByteOffset, tinfo.WidthToLoad, nFiddle, tlut);
     }
 
     pTexture->EndUpdate(&dInfo);
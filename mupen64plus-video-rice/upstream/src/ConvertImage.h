@@ -299,5 +299,9 @@ void Convert4b_16(CTexture *pTexture, const TxtrInfo &tinfo);
 void Convert8b_16(CTexture *pTexture, const TxtrInfo &tinfo);
 void Convert16b_16(CTexture *pTexture, const TxtrInfo &tinfo);
 
+// Vectorized helpers for the clamp and mirror texture expansions
+void FillRow32(uint32 *pDst, uint32 val, uint32 count);
+void ReverseCopyRow32(uint32 *pDst, const uint32 *pSrcLast, uint32 count);
+
 #endif
 
@@ -36,6 +36,17 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Video.h"
 #include "m64p_plugin.h"
 
+#define XXH_INLINE_ALL
+#include "xxHash/xxhash.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRAMEBUFFER_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAMEBUFFER_SSE2
+#endif
+
 #undef min
 #undef max
 
@@ -501,6 +512,8 @@ void TexRectToFrameBuffer_8b(uint32 dwXL, uint32 dwYL, uint32 dwXH, uint32 dwYH,
     if( maxH <= dwTop )
         return;
 
+    RDRAMRegionWritten(g_pRenderTextureInfo->CI_Info.dwAddr, maxOff+4);
+
     for (uint32 y = 0; y < dwHeight; y++)
     {
         uint32 dwByteOffset = (uint32)(((y*yScale+dwSrcOffY) * dwSrcPitch) + dwSrcOffX);
@@ -536,6 +549,8 @@ void TexRectToN64FrameBuffer_16b(uint32 x0, uint32 y0, uint32 width, uint32 heig
     uint32 n64CIaddr = g_CI.dwAddr;
     uint32 n64CIwidth = g_CI.dwWidth;
 
+    RDRAMRegionWritten(n64CIaddr, ((y0+height)*n64CIwidth)<<1);
+
     for (uint32 y = 0; y < height; y++)
     {
         uint32* pSrc = (uint32*)((uint8*)srcInfo.lpSurface + y * srcInfo.lPitch);
@@ -788,54 +803,237 @@ l1:             mov esi, [ecx+ebx]
     }
     return dwAsmCRC;
 }
+// Finds the largest byte of a row and the largest low nibble of its bytes
+static void MaxBytesInRow(const unsigned char *buf, uint32 count, unsigned char &maxByte, unsigned char &maxLow)
+{
+    uint32 x = 0;
+#if defined(FRAMEBUFFER_NEON)
+    if( count >= 16 )
+    {
+        uint8x16_t vmax = vdupq_n_u8(0);
+        uint8x16_t vlow = vdupq_n_u8(0);
+        const uint8x16_t mask = vdupq_n_u8(0x0F);
+        for( ; x+16<=count; x+=16 )
+        {
+            uint8x16_t v = vld1q_u8(buf+x);
+            vmax = vmaxq_u8(vmax, v);
+            vlow = vmaxq_u8(vlow, vandq_u8(v, mask));
+        }
+        uint8x8_t m = vpmax_u8(vget_low_u8(vmax), vget_high_u8(vmax));
+        uint8x8_t l = vpmax_u8(vget_low_u8(vlow), vget_high_u8(vlow));
+        m = vpmax_u8(m, m); m = vpmax_u8(m, m); m = vpmax_u8(m, m);
+        l = vpmax_u8(l, l); l = vpmax_u8(l, l); l = vpmax_u8(l, l);
+        if( vget_lane_u8(m, 0) > maxByte )  maxByte = vget_lane_u8(m, 0);
+        if( vget_lane_u8(l, 0) > maxLow )   maxLow = vget_lane_u8(l, 0);
+    }
+#elif defined(FRAMEBUFFER_SSE2)
+    if( count >= 16 )
+    {
+        __m128i vmax = _mm_setzero_si128();
+        __m128i vlow = _mm_setzero_si128();
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        for( ; x+16<=count; x+=16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(buf+x));
+            vmax = _mm_max_epu8(vmax, v);
+            vlow = _mm_max_epu8(vlow, _mm_and_si128(v, mask));
+        }
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+        vlow = _mm_max_epu8(vlow, _mm_srli_si128(vlow, 8));
+        vlow = _mm_max_epu8(vlow, _mm_srli_si128(vlow, 4));
+        vlow = _mm_max_epu8(vlow, _mm_srli_si128(vlow, 2));
+        vlow = _mm_max_epu8(vlow, _mm_srli_si128(vlow, 1));
+        unsigned char m = (unsigned char)_mm_cvtsi128_si32(vmax);
+        unsigned char l = (unsigned char)_mm_cvtsi128_si32(vlow);
+        if( m > maxByte )   maxByte = m;
+        if( l > maxLow )    maxLow = l;
+    }
+#endif
+    for( ; x<count; x++ )
+    {
+        if( buf[x] > maxByte )          maxByte = buf[x];
+        if( (buf[x]&0xF) > maxLow )     maxLow = buf[x]&0xF;
+    }
+}
+
 unsigned char CalculateMaxCI(void *pPhysicalAddress, uint32 left, uint32 top, uint32 width, uint32 height, uint32 size, uint32 pitchInBytes )
 {
-    uint32 x, y;
+    uint32 y;
     unsigned char *buf;
-    unsigned char val = 0;
+    unsigned char maxByte = 0;
+    unsigned char maxLow = 0;
 
     if( TXT_SIZE_8b == size )
     {
         for( y = 0; y<height; y++ )
         {
             buf = (unsigned char*)pPhysicalAddress + left + pitchInBytes * (y+top);
-            for( x=0; x<width; x++ )
-            {
-                if( buf[x] > val )  val = buf[x];
-                if( val == 0xFF )
-                    return 0xFF;
-            }
+            MaxBytesInRow(buf, width, maxByte, maxLow);
+            if( maxByte == 0xFF )
+                return 0xFF;
         }
+        return maxByte;
     }
     else
     {
-        unsigned char val1,val2;
+        unsigned char val;
         left >>= 1;
         width >>= 1;
         for( y = 0; y<height; y++ )
         {
             buf = (unsigned char*)pPhysicalAddress + left + pitchInBytes * (y+top);
-            for( x=0; x<width; x++ )
-            {
-                val1 = buf[x]>>4;
-                val2 = buf[x]&0xF;
-                if( val1 > val )    val = val1;
-                if( val2 > val )    val = val2;
-                if( val == 0xF )
-                    return 0xF;
-            }
+            MaxBytesInRow(buf, width, maxByte, maxLow);
+            val = std::max((unsigned char)(maxByte>>4), maxLow);
+            if( val == 0xF )
+                return 0xF;
         }
+        return std::max((unsigned char)(maxByte>>4), maxLow);
+    }
+}
+
+/************************************************************************/
+/* RDRAM write tracking                                                 */
+/************************************************************************/
+// The core maps the regions returned by FBGetFrameBufferInfo between two display
+// lists and reports every CPU and DMA write into them with FBWrite. RDRAM is
+// divided into blocks which remember the stamp of the last write, and the
+// protection window in which they were last completely covered. A region hashed
+// at stamp s is unchanged as long as all its blocks were covered since then and
+// none of them carries a stamp above s. Outside of the windows only the plugin
+// itself writes to RDRAM, and it reports that with RDRAMRegionWritten.
+//
+// FBWrite is not raised for stores of recompiled code, nor for RDRAM written by
+// RSP tasks outside of display lists. So the stamps are only trusted while the
+// core also counts its RDRAM writes (CoreGetRdramGenerations), and the sum of
+// those counters over a region must not have changed either. Otherwise regions
+// are always hashed again.
+#define RDRAM_TRACK_BLOCK_SHIFT 8
+#define RDRAM_TRACK_BLOCKS      (0x800000>>RDRAM_TRACK_BLOCK_SHIFT)
+
+static uint32 g_dwRDRAMBlockStamp[RDRAM_TRACK_BLOCKS];
+static uint32 g_dwRDRAMBlockWindow[RDRAM_TRACK_BLOCKS];
+static uint32 g_dwRDRAMTrackStamp = 1;
+static uint32 g_dwRDRAMTrackWindow = 2;
+static bool g_bRDRAMWindowStarted = false;
+static const unsigned int *g_pRDRAMGenerations = NULL;
+static int g_iRDRAMGenerationShift = 0;
+static int g_iRDRAMGenerationPages = 0;
+
+static bool ClampRDRAMRegion(uint32 &addr, uint32 &length)
+{
+    addr &= (g_dwRamSize-1);
+    if( length > g_dwRamSize-addr )
+        length = g_dwRamSize-addr;
+    return length != 0;
+}
+
+void RDRAMRegionWritten(uint32 addr, uint32 length)
+{
+    if( !ClampRDRAMRegion(addr, length) )
+        return;
+
+    uint32 last = (addr+length-1)>>RDRAM_TRACK_BLOCK_SHIFT;
+    for( uint32 i=addr>>RDRAM_TRACK_BLOCK_SHIFT; i<=last; i++ )
+        g_dwRDRAMBlockStamp[i] = g_dwRDRAMTrackStamp;
+}
+
+void StartRDRAMProtectWindow(void)
+{
+    g_dwRDRAMTrackWindow++;
+    g_bRDRAMWindowStarted = true;
+}
+
+void RDRAMRegionProtected(uint32 addr, uint32 length)
+{
+    if( !ClampRDRAMRegion(addr, length) )
+        return;
+
+    // Only blocks the region covers completely get their writes reported
+    uint32 first = (addr+(1<<RDRAM_TRACK_BLOCK_SHIFT)-1)>>RDRAM_TRACK_BLOCK_SHIFT;
+    uint32 end = (addr+length)>>RDRAM_TRACK_BLOCK_SHIFT;
+    for( uint32 i=first; i<end; i++ )
+    {
+        if( g_dwRDRAMBlockWindow[i] == g_dwRDRAMTrackWindow )
+            continue;
+
+        // Writes went unreported while the block was not covered
+        if( g_dwRDRAMBlockWindow[i] != g_dwRDRAMTrackWindow-1 )
+            g_dwRDRAMBlockStamp[i] = g_dwRDRAMTrackStamp;
+        g_dwRDRAMBlockWindow[i] = g_dwRDRAMTrackWindow;
+    }
+}
+
+void RDRAMTrackDListStarted(void)
+{
+    // Nothing was protected since the last display list
+    if( !g_bRDRAMWindowStarted )
+        g_dwRDRAMTrackWindow++;
+    g_bRDRAMWindowStarted = false;
+}
+
+void SetRDRAMGenerations(const unsigned int *generations, int shift, int pages)
+{
+    g_pRDRAMGenerations = generations;
+    g_iRDRAMGenerationShift = shift;
+    g_iRDRAMGenerationPages = pages;
+}
+
+static uint32 SumRDRAMGenerations(uint32 addr, uint32 length)
+{
+    uint32 sum = 0;
+    uint32 last = (addr+length-1)>>g_iRDRAMGenerationShift;
+    for( uint32 i=addr>>g_iRDRAMGenerationShift; i<=last && i<(uint32)g_iRDRAMGenerationPages; i++ )
+        sum += g_pRDRAMGenerations[i];
+    return sum;
+}
+
+void ResetRDRAMTracking(void)
+{
+    // Skips a window, so that no block counts as covered any more
+    g_dwRDRAMTrackWindow += 2;
+    g_bRDRAMWindowStarted = false;
+}
+
+static bool RDRAMRegionChanged(uint32 addr, uint32 length, uint32 stamp, uint32 generations)
+{
+    if( g_pRDRAMGenerations == NULL || SumRDRAMGenerations(addr, length) != generations )
+        return true;
+
+    uint32 last = (addr+length-1)>>RDRAM_TRACK_BLOCK_SHIFT;
+    for( uint32 i=addr>>RDRAM_TRACK_BLOCK_SHIFT; i<=last; i++ )
+    {
+        if( g_dwRDRAMBlockWindow[i] != g_dwRDRAMTrackWindow || g_dwRDRAMBlockStamp[i] > stamp )
+            return true;
     }
+    return false;
+}
+
+// Unlike CalculateRDRAMCRC the result does not stay the same between versions,
+// so it must not be used for anything that is saved, like texture CRCs
+uint32 HashRDRAMRegion(RDRAMHashInfo &info, uint32 addr, uint32 length)
+{
+    if( !ClampRDRAMRegion(addr, length) )
+        return 0;
+
+    if( info.dwAddr == addr && info.dwLength == length && !RDRAMRegionChanged(addr, length, info.dwStamp, info.dwGenerations) )
+        return info.dwHash;
 
-    return val;
+    info.dwAddr = addr;
+    info.dwLength = length;
+    info.dwStamp = g_dwRDRAMTrackStamp++;
+    info.dwGenerations = (g_pRDRAMGenerations != NULL) ? SumRDRAMGenerations(addr, length) : 0;
+    info.dwHash = XXH32(g_pRDRAMu8+addr, length, 0);
+    return info.dwHash;
 }
 
 bool FrameBufferManager::FrameBufferInRDRAMCheckCRC()
 {
     RecentCIInfo &p = *(g_uRecentCIInfoPtrs[0]);
-    uint8 *pFrameBufferBase = (uint8*)(g_pRDRAMu8+p.dwAddr);
     uint32 pitch = (p.dwWidth << p.dwSize ) >> 1;
-    uint32 crc = CalculateRDRAMCRC(pFrameBufferBase, 0, 0, p.dwWidth, p.dwHeight, p.dwSize, pitch);
+    uint32 crc = HashRDRAMRegion(p.hashInfo, p.dwAddr, pitch*p.dwHeight);
     if( crc != p.dwCRC )
     {
         p.dwCRC = crc;
@@ -936,10 +1134,27 @@ void FrameBufferManager::FrameBufferReadByCPU( uint32 addr )
 {
     ///return;  // it does not work very well anyway
 
+    addr &= (g_dwRamSize-1);
+
+    // A render_texture only exists on the video card until the CPU wants it
+    int infoIdx = CheckAddrInRenderTextures(addr, false);
+    if( infoIdx >= 0 )
+    {
+        RenderTextureInfo &info = gRenderTextureInfos[infoIdx];
+        if( !info.storedInRDRAM )
+        {
+            TXTRBUF_OR_CI_DUMP(TRACE2("Render_texture %d read, reported by emulator, addr=%08X", infoIdx, addr));
+            info.pRenderTexture->StoreToRDRAM(infoIdx);
+            info.storedInRDRAM = true;
+            info.crcInRDRAM = ComputeRenderTextureCRCInRDRAM(infoIdx);
+            info.hashInRDRAM = ComputeRenderTextureHashInRDRAM(infoIdx, true);
+            info.crcCheckedAtFrame = status.gDlistCount;
+        }
+        return;
+    }
 
     if( !frameBufferOptions.bProcessCPURead )   return;
 
-    addr &= (g_dwRamSize-1);
     int index = FindRecentCIInfoIndex(addr);
     if( index == -1 ) 
     {
@@ -1272,6 +1487,7 @@ void FrameBufferManager::SetRenderTexture(void)
 
     status.bHandleN64RenderTexture = true;
     newRenderTextureInfo.maxUsedHeight = 0;
+    newRenderTextureInfo.storedInRDRAM = false;
 
     if( defaultRomOptions.bInN64Resolution )
     {
@@ -1324,6 +1540,7 @@ int FrameBufferManager::SetBackBufferAsRenderTexture(SetImgInfo &CIinfo, int ciI
     tempRenderTextureInfo.N64Height = g_uRecentCIInfoPtrs[ciInfoIdx]->dwLastHeight;
     tempRenderTextureInfo.knownHeight = true;
     tempRenderTextureInfo.maxUsedHeight = 0;
+    tempRenderTextureInfo.storedInRDRAM = false;
 
     tempRenderTextureInfo.bufferWidth = windowSetting.uDisplayWidth;
     tempRenderTextureInfo.bufferHeight = windowSetting.uDisplayHeight;
@@ -1398,6 +1615,7 @@ void FrameBufferManager::CloseRenderTexture(bool toSave)
             else
             {
                 g_pRenderTextureInfo->crcInRDRAM = ComputeRenderTextureCRCInRDRAM(m_curRenderTextureIndex);
+                g_pRenderTextureInfo->hashInRDRAM = ComputeRenderTextureHashInRDRAM(m_curRenderTextureIndex, true);
                 g_pRenderTextureInfo->crcCheckedAtFrame = status.gDlistCount;
             }
         }
@@ -1406,6 +1624,7 @@ void FrameBufferManager::CloseRenderTexture(bool toSave)
     SetScreenMult(windowSetting.uDisplayWidth/windowSetting.fViWidth, windowSetting.uDisplayHeight/windowSetting.fViHeight);
     CRender::g_pRender->UpdateClipRectangle();
     CRender::g_pRender->ApplyScissorWithClipRatio();
+    CRender::g_pRender->SetViewportRender();
 
     DEBUGGER_PAUSE_AND_DUMP_NO_UPDATE(NEXT_RENDER_TEXTURE, 
     {
@@ -1425,9 +1644,11 @@ void FrameBufferManager::ClearN64FrameBufferToBlack(uint32 left, uint32 top, uin
         uint32 len = p.dwHeight*p.dwWidth*p.dwSize;
         if( p.dwSize == TXT_SIZE_4b ) len = (p.dwHeight*p.dwWidth)>>1;
         memset(frameBufferBase, 0, len);
+        RDRAMRegionWritten(p.dwAddr, len);
     }
     else
     {
+        RDRAMRegionWritten(p.dwAddr, ((top+height)*pitch)<<1);
         for( uint32 y=0; y<height; y++)
         {
             for( uint32 x=0; x<width; x++ )
@@ -1483,8 +1704,8 @@ void FrameBufferManager::CheckRenderTextureCRCInRDRAM(void)
 
         if( gRenderTextureInfos[i].crcCheckedAtFrame < status.gDlistCount )
         {
-            uint32 crc = ComputeRenderTextureCRCInRDRAM(i);
-            if( gRenderTextureInfos[i].crcInRDRAM != crc )
+            uint32 hash = ComputeRenderTextureHashInRDRAM(i);
+            if( gRenderTextureInfos[i].hashInRDRAM != hash )
             {
                 // RDRAM has been modified by CPU core
                 TXTRBUF_DUMP(TRACE2("Delete txtr buf %d at %08X, CRC in RDRAM changed", i, gRenderTextureInfos[i].CI_Info.dwAddr ));
@@ -1520,11 +1741,11 @@ int FrameBufferManager::CheckAddrInRenderTextures(uint32 addr, bool checkcrc)
                 // Check the CRC in RDRAM
                 if( gRenderTextureInfos[i].crcCheckedAtFrame < status.gDlistCount )
                 {
-                    uint32 crc = ComputeRenderTextureCRCInRDRAM(i);
-                    if( gRenderTextureInfos[i].crcInRDRAM != crc )
+                    uint32 hash = ComputeRenderTextureHashInRDRAM(i);
+                    if( gRenderTextureInfos[i].hashInRDRAM != hash )
                     {
                         // RDRAM has been modified by CPU core
-                        TRACE3("Buf %d CRC in RDRAM changed from %08X to %08X", i, gRenderTextureInfos[i].crcInRDRAM, crc );
+                        TRACE3("Buf %d hash in RDRAM changed from %08X to %08X", i, gRenderTextureInfos[i].hashInRDRAM, hash );
                         TXTRBUF_DUMP(TRACE2("Delete txtr buf %d at %08X, crcInRDRAM failed.", i, gRenderTextureInfos[i].CI_Info.dwAddr ));
                         SAFE_DELETE(gRenderTextureInfos[i].pRenderTexture);
                         gRenderTextureInfos[i].isUsed = false;
@@ -1591,6 +1812,22 @@ uint32 FrameBufferManager::ComputeRenderTextureCRCInRDRAM(int infoIdx)
     return CalculateRDRAMCRC(pAddr, 0, 0, info.N64Width, height, info.CI_Info.dwSize, pitch);
 }
 
+// Cheaper than the CRC above, only good to find out whether the RDRAM changed.
+// rehash discards what is known about the region, for when it was just written.
+uint32 FrameBufferManager::ComputeRenderTextureHashInRDRAM(int infoIdx, bool rehash)
+{
+    if( infoIdx >= numOfTxtBufInfos || infoIdx < 0 || !gRenderTextureInfos[infoIdx].isUsed )
+        return 0;
+
+    RenderTextureInfo &info = gRenderTextureInfos[infoIdx];
+    uint32 height = info.knownHeight ? info.N64Height : info.maxUsedHeight;
+    uint32 pitch = (info.N64Width << info.CI_Info.dwSize ) >> 1;
+
+    if( rehash )
+        info.hashInfo.dwLength = 0;
+    return HashRDRAMRegion(info.hashInfo, info.CI_Info.dwAddr, pitch*height);
+}
+
 // Activates texture buffer for drawing
 void FrameBufferManager::ActiveTextureBuffer(void)
 {
@@ -1668,6 +1905,7 @@ void FrameBufferManager::ActiveTextureBuffer(void)
             //SetScreenMult(1, 1);
             SetScreenMult(gRenderTextureInfos[m_curRenderTextureIndex].scaleX, gRenderTextureInfos[m_curRenderTextureIndex].scaleY);
             CRender::g_pRender->UpdateClipRectangle();
+            CRender::g_pRender->SetViewportRender();
 
             // If needed, draw RDRAM into the render_texture
             //if( frameBufferOptions.bLoadRDRAMIntoRenderTexture )
@@ -1748,6 +1986,10 @@ void FrameBufferManager::Set_CI_addr(SetImgInfo &newCI)
         }
         else if( status.curRenderBuffer != g_CI.dwAddr )
         {
+            // The frame has to be presented from the back buffer, not from a render_texture
+            if( status.bHandleN64RenderTexture )
+                g_pFrameBufferManager->CloseRenderTexture(true);
+
             status.curDisplayBuffer = status.curRenderBuffer;
             CGraphicsContext::Get()->UpdateFrame();
             status.curRenderBuffer = g_CI.dwAddr;
@@ -1883,6 +2125,8 @@ void FrameBufferManager::CopyBufferToRDRAM(uint32 addr, uint32 fmt, uint32 siz,
         TXTRBUF_DUMP(DebuggerAppendMsg("Start at: 0x%X, from line %d to %d", startaddr-addr, startline, endline););
     }
 
+    RDRAMRegionWritten(addr, siz == TXT_SIZE_16b ? (endline*pitch)<<1 : endline*width);
+
     int indexes[600];
     {
         float sx;
@@ -2076,6 +2320,7 @@ void FrameBufferManager::SaveBackBuffer(int ciInfoIdx, RECT* pSrcRect, bool forc
 
     gRenderTextureInfos[idx].crcCheckedAtFrame = status.gDlistCount;
     gRenderTextureInfos[idx].crcInRDRAM = ComputeRenderTextureCRCInRDRAM(idx);
+    gRenderTextureInfos[idx].hashInRDRAM = ComputeRenderTextureHashInRDRAM(idx, true);
 
     DEBUGGER_IF_DUMP((logTextureBuffer&&pSrcRect==NULL),TRACE1("SaveBackBuffer at 0x%08X", ciInfo.dwAddr));
     DEBUGGER_IF_DUMP((logTextureBuffer&&pSrcRect),TRACE5("SaveBackBuffer at 0x%08X, {%d,%d -%d,%d)", ciInfo.dwAddr,
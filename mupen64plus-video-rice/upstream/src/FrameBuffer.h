@@ -52,6 +52,7 @@ public:
 
     int         CheckAddrInRenderTextures(uint32 addr, bool checkcrc = true);
     uint32      ComputeRenderTextureCRCInRDRAM(int infoIdx);
+    uint32      ComputeRenderTextureHashInRDRAM(int infoIdx, bool rehash = false);
     void        CheckRenderTextureCRCInRDRAM(void);
     int         CheckRenderTexturesWithNewCI(SetImgInfo &CIinfo, uint32 height, bool byNewTxtrBuf);
     virtual void ClearN64FrameBufferToBlack(uint32 left=0, uint32 top=0, uint32 width=0, uint32 height=0);
@@ -142,6 +143,16 @@ extern RecentCIInfo *g_uRecentCIInfoPtrs[5];
 extern uint8 RevTlutTable[0x10000];
 
 extern uint32 CalculateRDRAMCRC(void *pAddr, uint32 left, uint32 top, uint32 width, uint32 height, uint32 size, uint32 pitchInBytes );
+
+// RDRAM write tracking, lets the framebuffer checks skip hashing regions that
+// cannot have changed since they were hashed last time
+extern uint32 HashRDRAMRegion(RDRAMHashInfo &info, uint32 addr, uint32 length);
+extern void RDRAMRegionWritten(uint32 addr, uint32 length);
+extern void StartRDRAMProtectWindow(void);
+extern void RDRAMRegionProtected(uint32 addr, uint32 length);
+extern void RDRAMTrackDListStarted(void);
+extern void ResetRDRAMTracking(void);
+extern void SetRDRAMGenerations(const unsigned int *generations, int shift, int pages);
 extern uint16 ConvertRGBATo555(uint8 r, uint8 g, uint8 b, uint8 a);
 extern uint16 ConvertRGBATo555(uint32 color32);
 extern void InitTlutReverseLookup(void);
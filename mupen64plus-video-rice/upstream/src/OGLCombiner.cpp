@@ -1217,28 +1217,18 @@ void COGLColorCombiner::GenerateCombinerSetting()
 {
     glEnableVertexAttribArray(VS_POSITION);
     OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
-    OPENGL_CHECK_ERRORS;
-
     glEnableVertexAttribArray(VS_TEXCOORD0);
     OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[0].u));
-    OPENGL_CHECK_ERRORS;
-
     glEnableVertexAttribArray(VS_TEXCOORD1);
     OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_TEXCOORD1,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[1].u));
-    OPENGL_CHECK_ERRORS;
-
     glEnableVertexAttribArray(VS_COLOR);
     OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    OPENGL_CHECK_ERRORS;
-
     glEnableVertexAttribArray(VS_FOG);
     OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_FOG,1,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][4]));
-    OPENGL_CHECK_ERRORS;
+
+    // The attribute pointers are not part of the program state, they only
+    // need to be set up if something pointed them elsewhere
+    m_pOGLRender->SetVertexBufferPointers();
 }
 
 // Bind various uniforms
@@ -68,6 +68,22 @@ static void APIENTRY EmptyFunc(void) { return; }
     INIT_EMPTY_FUNC(PFNGLUNIFORM1FPROC,                glUniform1f)
     INIT_EMPTY_FUNC(PFNGLUNIFORM1IPROC,                glUniform1i)
     INIT_EMPTY_FUNC(PFNGLUSEPROGRAMPROC,               glUseProgram)
+    INIT_EMPTY_FUNC(PFNGLGENBUFFERSPROC,               glGenBuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETEBUFFERSPROC,            glDeleteBuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDBUFFERPROC,               glBindBuffer)
+    INIT_EMPTY_FUNC(PFNGLBUFFERDATAPROC,               glBufferData)
+    INIT_EMPTY_FUNC(PFNGLBUFFERSUBDATAPROC,            glBufferSubData)
+    INIT_EMPTY_FUNC(PFNGLGENFRAMEBUFFERSPROC,          glGenFramebuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETEFRAMEBUFFERSPROC,       glDeleteFramebuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDFRAMEBUFFERPROC,          glBindFramebuffer)
+    INIT_EMPTY_FUNC(PFNGLFRAMEBUFFERTEXTURE2DPROC,     glFramebufferTexture2D)
+    INIT_EMPTY_FUNC(PFNGLCHECKFRAMEBUFFERSTATUSPROC,   glCheckFramebufferStatus)
+    INIT_EMPTY_FUNC(PFNGLGENRENDERBUFFERSPROC,         glGenRenderbuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETERENDERBUFFERSPROC,      glDeleteRenderbuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDRENDERBUFFERPROC,         glBindRenderbuffer)
+    INIT_EMPTY_FUNC(PFNGLRENDERBUFFERSTORAGEPROC,      glRenderbufferStorage)
+    INIT_EMPTY_FUNC(PFNGLFRAMEBUFFERRENDERBUFFERPROC,  glFramebufferRenderbuffer)
+    INIT_EMPTY_FUNC(PFNGLGENERATEMIPMAPPROC,           glGenerateMipmap)
 #elif defined(__APPLE__)
     // OSX already support OpenGL 2.1 functions.
 #else
@@ -98,6 +114,22 @@ static void APIENTRY EmptyFunc(void) { return; }
     INIT_EMPTY_FUNC(PFNGLUNIFORM1FPROC,                glUniform1f)
     INIT_EMPTY_FUNC(PFNGLUNIFORM1IPROC,                glUniform1i)
     INIT_EMPTY_FUNC(PFNGLUSEPROGRAMPROC,               glUseProgram)
+    INIT_EMPTY_FUNC(PFNGLGENBUFFERSPROC,               glGenBuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETEBUFFERSPROC,            glDeleteBuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDBUFFERPROC,               glBindBuffer)
+    INIT_EMPTY_FUNC(PFNGLBUFFERDATAPROC,               glBufferData)
+    INIT_EMPTY_FUNC(PFNGLBUFFERSUBDATAPROC,            glBufferSubData)
+    INIT_EMPTY_FUNC(PFNGLGENFRAMEBUFFERSPROC,          glGenFramebuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETEFRAMEBUFFERSPROC,       glDeleteFramebuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDFRAMEBUFFERPROC,          glBindFramebuffer)
+    INIT_EMPTY_FUNC(PFNGLFRAMEBUFFERTEXTURE2DPROC,     glFramebufferTexture2D)
+    INIT_EMPTY_FUNC(PFNGLCHECKFRAMEBUFFERSTATUSPROC,   glCheckFramebufferStatus)
+    INIT_EMPTY_FUNC(PFNGLGENRENDERBUFFERSPROC,         glGenRenderbuffers)
+    INIT_EMPTY_FUNC(PFNGLDELETERENDERBUFFERSPROC,      glDeleteRenderbuffers)
+    INIT_EMPTY_FUNC(PFNGLBINDRENDERBUFFERPROC,         glBindRenderbuffer)
+    INIT_EMPTY_FUNC(PFNGLRENDERBUFFERSTORAGEPROC,      glRenderbufferStorage)
+    INIT_EMPTY_FUNC(PFNGLFRAMEBUFFERRENDERBUFFERPROC,  glFramebufferRenderbuffer)
+    INIT_EMPTY_FUNC(PFNGLGENERATEMIPMAPPROC,           glGenerateMipmap)
 #endif // OS specific
 #endif // USE_GLES
 
@@ -135,6 +167,22 @@ void OGLExtensions_Init(void)
     INIT_GL_FUNC(PFNGLUNIFORM1FPROC,                glUniform1f)
     INIT_GL_FUNC(PFNGLUNIFORM1IPROC,                glUniform1i)
     INIT_GL_FUNC(PFNGLUSEPROGRAMPROC,               glUseProgram)
+    INIT_GL_FUNC(PFNGLGENBUFFERSPROC,               glGenBuffers)
+    INIT_GL_FUNC(PFNGLDELETEBUFFERSPROC,            glDeleteBuffers)
+    INIT_GL_FUNC(PFNGLBINDBUFFERPROC,               glBindBuffer)
+    INIT_GL_FUNC(PFNGLBUFFERDATAPROC,               glBufferData)
+    INIT_GL_FUNC(PFNGLBUFFERSUBDATAPROC,            glBufferSubData)
+    INIT_GL_FUNC(PFNGLGENFRAMEBUFFERSPROC,          glGenFramebuffers)
+    INIT_GL_FUNC(PFNGLDELETEFRAMEBUFFERSPROC,       glDeleteFramebuffers)
+    INIT_GL_FUNC(PFNGLBINDFRAMEBUFFERPROC,          glBindFramebuffer)
+    INIT_GL_FUNC(PFNGLFRAMEBUFFERTEXTURE2DPROC,     glFramebufferTexture2D)
+    INIT_GL_FUNC(PFNGLCHECKFRAMEBUFFERSTATUSPROC,   glCheckFramebufferStatus)
+    INIT_GL_FUNC(PFNGLGENRENDERBUFFERSPROC,         glGenRenderbuffers)
+    INIT_GL_FUNC(PFNGLDELETERENDERBUFFERSPROC,      glDeleteRenderbuffers)
+    INIT_GL_FUNC(PFNGLBINDRENDERBUFFERPROC,         glBindRenderbuffer)
+    INIT_GL_FUNC(PFNGLRENDERBUFFERSTORAGEPROC,      glRenderbufferStorage)
+    INIT_GL_FUNC(PFNGLFRAMEBUFFERRENDERBUFFERPROC,  glFramebufferRenderbuffer)
+    INIT_GL_FUNC(PFNGLGENERATEMIPMAPPROC,           glGenerateMipmap)
 #elif defined(__APPLE__)
     // empty
 #else
@@ -164,6 +212,22 @@ void OGLExtensions_Init(void)
     INIT_GL_FUNC(PFNGLUNIFORM1FPROC,                glUniform1f)
     INIT_GL_FUNC(PFNGLUNIFORM1IPROC,                glUniform1i)
     INIT_GL_FUNC(PFNGLUSEPROGRAMPROC,               glUseProgram)
+    INIT_GL_FUNC(PFNGLGENBUFFERSPROC,               glGenBuffers)
+    INIT_GL_FUNC(PFNGLDELETEBUFFERSPROC,            glDeleteBuffers)
+    INIT_GL_FUNC(PFNGLBINDBUFFERPROC,               glBindBuffer)
+    INIT_GL_FUNC(PFNGLBUFFERDATAPROC,               glBufferData)
+    INIT_GL_FUNC(PFNGLBUFFERSUBDATAPROC,            glBufferSubData)
+    INIT_GL_FUNC(PFNGLGENFRAMEBUFFERSPROC,          glGenFramebuffers)
+    INIT_GL_FUNC(PFNGLDELETEFRAMEBUFFERSPROC,       glDeleteFramebuffers)
+    INIT_GL_FUNC(PFNGLBINDFRAMEBUFFERPROC,          glBindFramebuffer)
+    INIT_GL_FUNC(PFNGLFRAMEBUFFERTEXTURE2DPROC,     glFramebufferTexture2D)
+    INIT_GL_FUNC(PFNGLCHECKFRAMEBUFFERSTATUSPROC,   glCheckFramebufferStatus)
+    INIT_GL_FUNC(PFNGLGENRENDERBUFFERSPROC,         glGenRenderbuffers)
+    INIT_GL_FUNC(PFNGLDELETERENDERBUFFERSPROC,      glDeleteRenderbuffers)
+    INIT_GL_FUNC(PFNGLBINDRENDERBUFFERPROC,         glBindRenderbuffer)
+    INIT_GL_FUNC(PFNGLRENDERBUFFERSTORAGEPROC,      glRenderbufferStorage)
+    INIT_GL_FUNC(PFNGLFRAMEBUFFERRENDERBUFFERPROC,  glFramebufferRenderbuffer)
+    INIT_GL_FUNC(PFNGLGENERATEMIPMAPPROC,           glGenerateMipmap)
 #endif // OS specific
 #endif // USE_GLES
 }
@@ -59,6 +59,22 @@ void OGLExtensions_Init(void);
     extern PFNGLUNIFORM1FPROC                 glUniform1f;
     extern PFNGLUNIFORM1IPROC                 glUniform1i;
     extern PFNGLUSEPROGRAMPROC                glUseProgram;
+    extern PFNGLGENBUFFERSPROC                glGenBuffers;
+    extern PFNGLDELETEBUFFERSPROC             glDeleteBuffers;
+    extern PFNGLBINDBUFFERPROC                glBindBuffer;
+    extern PFNGLBUFFERDATAPROC                glBufferData;
+    extern PFNGLBUFFERSUBDATAPROC             glBufferSubData;
+    extern PFNGLGENFRAMEBUFFERSPROC           glGenFramebuffers;
+    extern PFNGLDELETEFRAMEBUFFERSPROC        glDeleteFramebuffers;
+    extern PFNGLBINDFRAMEBUFFERPROC           glBindFramebuffer;
+    extern PFNGLFRAMEBUFFERTEXTURE2DPROC      glFramebufferTexture2D;
+    extern PFNGLCHECKFRAMEBUFFERSTATUSPROC    glCheckFramebufferStatus;
+    extern PFNGLGENRENDERBUFFERSPROC          glGenRenderbuffers;
+    extern PFNGLDELETERENDERBUFFERSPROC       glDeleteRenderbuffers;
+    extern PFNGLBINDRENDERBUFFERPROC          glBindRenderbuffer;
+    extern PFNGLRENDERBUFFERSTORAGEPROC       glRenderbufferStorage;
+    extern PFNGLFRAMEBUFFERRENDERBUFFERPROC   glFramebufferRenderbuffer;
+    extern PFNGLGENERATEMIPMAPPROC            glGenerateMipmap;
 #elif defined(__APPLE__)
     // nothing
 #else
@@ -88,6 +104,22 @@ void OGLExtensions_Init(void);
     extern PFNGLUNIFORM1FPROC                 glUniform1f;
     extern PFNGLUNIFORM1IPROC                 glUniform1i;
     extern PFNGLUSEPROGRAMPROC                glUseProgram;
+    extern PFNGLGENBUFFERSPROC                glGenBuffers;
+    extern PFNGLDELETEBUFFERSPROC             glDeleteBuffers;
+    extern PFNGLBINDBUFFERPROC                glBindBuffer;
+    extern PFNGLBUFFERDATAPROC                glBufferData;
+    extern PFNGLBUFFERSUBDATAPROC             glBufferSubData;
+    extern PFNGLGENFRAMEBUFFERSPROC           glGenFramebuffers;
+    extern PFNGLDELETEFRAMEBUFFERSPROC        glDeleteFramebuffers;
+    extern PFNGLBINDFRAMEBUFFERPROC           glBindFramebuffer;
+    extern PFNGLFRAMEBUFFERTEXTURE2DPROC      glFramebufferTexture2D;
+    extern PFNGLCHECKFRAMEBUFFERSTATUSPROC    glCheckFramebufferStatus;
+    extern PFNGLGENRENDERBUFFERSPROC          glGenRenderbuffers;
+    extern PFNGLDELETERENDERBUFFERSPROC       glDeleteRenderbuffers;
+    extern PFNGLBINDRENDERBUFFERPROC          glBindRenderbuffer;
+    extern PFNGLRENDERBUFFERSTORAGEPROC       glRenderbufferStorage;
+    extern PFNGLFRAMEBUFFERRENDERBUFFERPROC   glFramebufferRenderbuffer;
+    extern PFNGLGENERATEMIPMAPPROC            glGenerateMipmap;
 #endif // OS specific
 #endif // USE_GLES
 
@@ -47,13 +47,36 @@ UVFlagMap OGLXUVFlagMaps[] =
     {TEXTURE_UV_FLAG_CLAMP, GL_CLAMP},
 };
 
+// Interleaved layout of the triangle vertex buffer
+typedef struct
+{
+    float x, y, z, w;
+    float fog;
+    float u0, v0;
+    float u1, v1;
+    uint8 r, g, b, a;
+} OGLStreamVertex;
+
+#define VERTEX_BUFFER_SIZE  16384   // in vertices
+
+static OGLStreamVertex g_streamVtx[1000];
+
 //===================================================================
-OGLRender::OGLRender()
+OGLRender::OGLRender() :
+    m_vtxBuffer(0),
+    m_vtxBufferPos(0),
+    m_bVtxBufferPointers(false)
 {
 }
 
 OGLRender::~OGLRender()
 {
+    if( m_vtxBuffer )
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDeleteBuffers(1, &m_vtxBuffer);
+        m_vtxBuffer = 0;
+    }
 }
 
 bool OGLRender::InitDeviceObjects()
@@ -77,19 +100,17 @@ void OGLRender::Initialize(void)
     OGLXUVFlagMaps[TEXTURE_UV_FLAG_MIRROR].realFlag = GL_MIRRORED_REPEAT;
     OGLXUVFlagMaps[TEXTURE_UV_FLAG_CLAMP].realFlag = GL_CLAMP_TO_EDGE;
 
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
-    OPENGL_CHECK_ERRORS;
-
-    glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[0].u));
-    OPENGL_CHECK_ERRORS;
-    glVertexAttribPointer(VS_TEXCOORD1,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[1].u));
-    OPENGL_CHECK_ERRORS;
-
-    glVertexAttribPointer(VS_FOG,1,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][4]));
-    OPENGL_CHECK_ERRORS;
-
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    OPENGL_CHECK_ERRORS;
+    if( m_vtxBuffer == 0 )
+    {
+        glGenBuffers(1, &m_vtxBuffer);
+        OPENGL_CHECK_ERRORS;
+        glBindBuffer(GL_ARRAY_BUFFER, m_vtxBuffer);
+        glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE*sizeof(OGLStreamVertex), NULL, GL_STREAM_DRAW);
+        OPENGL_CHECK_ERRORS;
+        m_vtxBufferPos = 0;
+    }
+    m_bVtxBufferPointers = false;
+    SetVertexBufferPointers();
 
     // Initialize multitexture
     m_maxTexUnits = COGLGraphicsContext::Get()->getMaxTextureImageUnits();
@@ -600,6 +621,7 @@ bool OGLRender::RenderTexRect()
             -inv + g_texRectTVtx[0].x / w, inv - g_texRectTVtx[0].y / h, g_texRectTVtx[3].z, 1
     };
 
+    UnbindVertexBuffer();
     glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, &colour );
     glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,0,&vertices);
     glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, 0, &tex);
@@ -608,12 +630,6 @@ bool OGLRender::RenderTexRect()
     glDrawArrays(GL_TRIANGLE_FAN,0,4);
     OPENGL_CHECK_ERRORS;
 
-    //Restore old pointers
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
-    glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[0].u));
-    glVertexAttribPointer(VS_TEXCOORD1,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[1].u));
-
     if( cullface ) glEnable(GL_CULL_FACE);
     OPENGL_CHECK_ERRORS;
 
@@ -648,6 +664,7 @@ bool OGLRender::RenderFillRect(uint32 dwColor, float depth)
             -inv + m_fillRectVtx[0].x / w, inv - m_fillRectVtx[0].y / h, depth, 1
     };
 
+    UnbindVertexBuffer();
     glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_FALSE, 0, &colour );
     glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,0,&vertices);
     glDisableVertexAttribArray(VS_TEXCOORD0);
@@ -656,9 +673,6 @@ bool OGLRender::RenderFillRect(uint32 dwColor, float depth)
     glDrawArrays(GL_TRIANGLE_FAN,0,4);
     OPENGL_CHECK_ERRORS;
 
-    //Restore old pointers
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
     glEnableVertexAttribArray(VS_TEXCOORD0);
     glEnableVertexAttribArray(VS_TEXCOORD1);
 
@@ -692,6 +706,32 @@ bool OGLRender::RenderLine3D()
     return true;
 }
 
+void OGLRender::SetVertexBufferPointers()
+{
+    if( m_bVtxBufferPointers )
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vtxBuffer);
+    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(OGLStreamVertex),(void*)offsetof(OGLStreamVertex, x));
+    glVertexAttribPointer(VS_FOG,1,GL_FLOAT,GL_FALSE,sizeof(OGLStreamVertex),(void*)offsetof(OGLStreamVertex, fog));
+    glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE,sizeof(OGLStreamVertex),(void*)offsetof(OGLStreamVertex, u0));
+    glVertexAttribPointer(VS_TEXCOORD1,2,GL_FLOAT,GL_FALSE,sizeof(OGLStreamVertex),(void*)offsetof(OGLStreamVertex, u1));
+    glVertexAttribPointer(VS_COLOR,4,GL_UNSIGNED_BYTE,GL_TRUE,sizeof(OGLStreamVertex),(void*)offsetof(OGLStreamVertex, r));
+    OPENGL_CHECK_ERRORS;
+    m_bVtxBufferPointers = true;
+}
+
+void OGLRender::UnbindVertexBuffer()
+{
+    // The attributes that are not pointed elsewhere keep reading from the
+    // buffer, which is fine as it is never smaller than a rectangle
+    if( m_bVtxBufferPointers )
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_bVtxBufferPointers = false;
+    }
+}
+
 extern FiddledVtx * g_pVtxBase;
 
 // This is so weired that I can not do vertex transform by myself. I have to use
@@ -705,8 +745,37 @@ bool OGLRender::RenderFlushTris()
 
     //if options.bOGLVertexClipper == FALSE )
     {
-        glDrawElements( GL_TRIANGLES, gRSP.numVertices, GL_UNSIGNED_SHORT, g_vtxIndex );
+        uint32 count = gRSP.numVertices;
+
+        // The vertices are stored in order, g_vtxIndex[i] is always i
+        for( uint32 i=0; i<count; i++ )
+        {
+            OGLStreamVertex &v = g_streamVtx[i];
+            v.x = g_vtxProjected5[i][0];
+            v.y = g_vtxProjected5[i][1];
+            v.z = g_vtxProjected5[i][2];
+            v.w = g_vtxProjected5[i][3];
+            v.fog = g_vtxProjected5[i][4];
+            v.u0 = g_vtxBuffer[i].tcord[0].u;
+            v.v0 = g_vtxBuffer[i].tcord[0].v;
+            v.u1 = g_vtxBuffer[i].tcord[1].u;
+            v.v1 = g_vtxBuffer[i].tcord[1].v;
+            v.r = g_oglVtxColors[i][0];
+            v.g = g_oglVtxColors[i][1];
+            v.b = g_oglVtxColors[i][2];
+            v.a = g_oglVtxColors[i][3];
+        }
+
+        SetVertexBufferPointers();
+        if( m_vtxBufferPos + count > VERTEX_BUFFER_SIZE )
+        {
+            glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE*sizeof(OGLStreamVertex), NULL, GL_STREAM_DRAW);
+            m_vtxBufferPos = 0;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, m_vtxBufferPos*sizeof(OGLStreamVertex), count*sizeof(OGLStreamVertex), g_streamVtx);
+        glDrawArrays(GL_TRIANGLES, m_vtxBufferPos, count);
         OPENGL_CHECK_ERRORS;
+        m_vtxBufferPos += count;
     }
 /*  else
     {
@@ -802,6 +871,7 @@ void OGLRender::DrawSimple2DTexture(float x0, float y0, float x1, float y1, floa
             -inv + g_texRectTVtx[3].x/ w, inv - g_texRectTVtx[3].y/ h, -g_texRectTVtx[3].z,1
     };
 
+    UnbindVertexBuffer();
     glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_FALSE, 0, &colour );
     glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,0,&vertices);
     glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, 0, &tex);
@@ -810,12 +880,6 @@ void OGLRender::DrawSimple2DTexture(float x0, float y0, float x1, float y1, floa
     glDrawArrays(GL_TRIANGLES,0,6);
     OPENGL_CHECK_ERRORS;
 
-    //Restore old pointers
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
-    glVertexAttribPointer(VS_TEXCOORD0,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[0].u));
-    glVertexAttribPointer(VS_TEXCOORD1,2,GL_FLOAT,GL_FALSE, sizeof( TLITVERTEX ), &(g_vtxBuffer[0].tcord[1].u));
-
     if( cullface ) glEnable(GL_CULL_FACE);
     OPENGL_CHECK_ERRORS;
 }
@@ -847,6 +911,7 @@ void OGLRender::DrawSimpleRect(int nX0, int nY0, int nX1, int nY1, uint32 dwColo
             -inv + m_simpleRectVtx[0].x / w, inv - m_simpleRectVtx[0].y / h, -depth, 1
     };
 
+    UnbindVertexBuffer();
     glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_FALSE, 0, &colour );
     glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,0,&vertices);
     glDisableVertexAttribArray(VS_TEXCOORD0);
@@ -855,9 +920,6 @@ void OGLRender::DrawSimpleRect(int nX0, int nY0, int nX1, int nY1, uint32 dwColo
     glDrawArrays(GL_TRIANGLE_FAN,0,4);
     OPENGL_CHECK_ERRORS;
 
-    //Restore old pointers
-    glVertexAttribPointer(VS_COLOR, 4, GL_UNSIGNED_BYTE,GL_TRUE, sizeof(uint8)*4, &(g_oglVtxColors[0][0]) );
-    glVertexAttribPointer(VS_POSITION,4,GL_FLOAT,GL_FALSE,sizeof(float)*5,&(g_vtxProjected5[0][0]));
     glEnableVertexAttribArray(VS_TEXCOORD0);
     glEnableVertexAttribArray(VS_TEXCOORD1);
 
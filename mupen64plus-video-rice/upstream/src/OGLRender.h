@@ -91,6 +91,12 @@ public:
     virtual void SetTexWrapS(int unitno,GLuint flag);
     virtual void SetTexWrapT(int unitno,GLuint flag);
 
+    // Points the vertex attributes into the triangle vertex buffer once more
+    // after they were pointed to client memory
+    void SetVertexBufferPointers();
+    // Needs to be called before vertex attributes are pointed to client memory
+    void UnbindVertexBuffer();
+
 protected:
 
     // Basic render drawing functions
@@ -103,6 +109,12 @@ protected:
 
     GLint m_maxTexUnits;
     int m_textureUnitMap[8];
+
+    // Triangle batches are streamed into this buffer one after the other, it is
+    // orphaned once it is full so the driver never has to wait for the GPU
+    GLuint m_vtxBuffer;
+    uint32 m_vtxBufferPos;
+    bool m_bVtxBufferPointers;
 };
 
 #endif
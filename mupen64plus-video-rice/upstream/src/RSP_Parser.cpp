@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "Config.h"
 #include "ConvertImage.h"
 #include "Debugger.h"
+#include "FrameBuffer.h"
 #include "GraphicsContext.h"
 #include "RSP_Parser.h"
 #include "RSP_S2DEX.h"
@@ -57,6 +58,11 @@ RDPInstruction LoadedUcodeMap[256];
 char* LoadedUcodeNameMap[256];
 
 OSTask *g_pOSTask = NULL;
+
+#ifdef GBI_PROFILE
+// Number of times each GBI opcode was dispatched since the ROM was opened
+static uint32 g_dwGBIOpcodeCount[256];
+#endif
 UcodeInfo lastUcodeInfo;
 UcodeInfo UsedUcodes[MAX_UCODE_INFO];
 const uint32 maxUsedUcodes = sizeof(UsedUcodes)/sizeof(UcodeInfo);
@@ -813,10 +819,11 @@ void DLParser_Process(OSTask * pTask)
     }
 
     status.bScreenIsDrawn = true;
-    if( options.bSkipFrame )
+    if( options.bSkipFrame || status.dwRenderSkip > 0 )
     {
+        uint32 dwSkip = status.dwRenderSkip > 0 ? status.dwRenderSkip : 1;
         skipframe++;
-        if(skipframe%2)
+        if(skipframe%(dwSkip+1))
         {
             TriggerDPInterrupt();
             TriggerSPInterrupt();
@@ -852,12 +859,8 @@ void DLParser_Process(OSTask * pTask)
             {DebuggerAppendMsg("Start Task without DLIST: ucode=%08X, data=%08X", (uint32)pTask->t.ucode, (uint32)pTask->t.ucode_data);});
 
 
-    // Check if we need to purge (every 5 milliseconds)
-    if (status.gRDPTime - status.lastPurgeTimeTime > 5)
-    {
-        gTextureManager.PurgeOldTextures();
-        status.lastPurgeTimeTime = status.gRDPTime;
-    }
+    // Trim the texture cache a little for every display list
+    gTextureManager.PurgeOldTextures();
 
     status.dwNumDListsCulled = 0;
     status.dwNumTrisRendered = 0;
@@ -899,13 +902,24 @@ void DLParser_Process(OSTask * pTask)
 
             status.gUcodeCount++;
 
-            Gfx *pgfx = (Gfx*)&g_pRDRAMu32[(gDlistStack[gDlistStackPointer].pc>>2)];
+            // Handlers may push, pop or retarget the stack, so only the top
+            // entry is cached and only until the command is dispatched
+            DListStack &top = gDlistStack[gDlistStackPointer];
+            Gfx *pgfx = (Gfx*)&g_pRDRAMu32[(top.pc>>2)];
+            uint32 op = pgfx->words.w0 >> 24;
+#ifdef __GNUC__
+            // Display lists are read sequentially, fetch a cache line ahead
+            __builtin_prefetch(pgfx + 8);
+#endif
 #ifdef DEBUGGER
             LOG_UCODE("0x%08x: %08x %08x %-10s", 
-                gDlistStack[gDlistStackPointer].pc, pgfx->words.w0, pgfx->words.w1, (gRSP.ucode!=5&&gRSP.ucode!=10)?ucodeNames_GBI1[(pgfx->words.w0>>24)]:ucodeNames_GBI2[(pgfx->words.w0>>24)]);
+                top.pc, pgfx->words.w0, pgfx->words.w1, (gRSP.ucode!=5&&gRSP.ucode!=10)?ucodeNames_GBI1[op]:ucodeNames_GBI2[op]);
 #endif
-            gDlistStack[gDlistStackPointer].pc += 8;
-            currentUcodeMap[pgfx->words.w0 >>24](pgfx);
+#ifdef GBI_PROFILE
+            g_dwGBIOpcodeCount[op]++;
+#endif
+            top.pc += 8;
+            currentUcodeMap[op](pgfx);
 
             if ( gDlistStackPointer >= 0 && --gDlistStack[gDlistStackPointer].countdown < 0 )
             {
@@ -928,6 +942,42 @@ void DLParser_Process(OSTask * pTask)
     TriggerSPInterrupt();
 }
 
+#ifdef GBI_PROFILE
+void DLParser_ReportGBIProfile(void)
+{
+    uint64 total = 0;
+    for( int i=0; i<256; i++ )
+        total += g_dwGBIOpcodeCount[i];
+
+    if( total != 0 )
+    {
+        DebugMessage(M64MSG_INFO, "GBI profile for ucode %d: %llu commands", gRSP.ucode, (unsigned long long)total);
+
+        // Selection sort is fine here, this runs once per ROM
+        bool reported[256];
+        memset(reported, 0, sizeof(reported));
+        for( int n=0; n<16; n++ )
+        {
+            int hottest = -1;
+            for( int i=0; i<256; i++ )
+            {
+                if( !reported[i] && g_dwGBIOpcodeCount[i] != 0 &&
+                    (hottest < 0 || g_dwGBIOpcodeCount[i] > g_dwGBIOpcodeCount[hottest]) )
+                    hottest = i;
+            }
+            if( hottest < 0 )
+                break;
+
+            reported[hottest] = true;
+            DebugMessage(M64MSG_INFO, "  %02X: %10u (%5.2f%%)", hottest, g_dwGBIOpcodeCount[hottest],
+                g_dwGBIOpcodeCount[hottest] * 100.0 / total);
+        }
+    }
+
+    memset(g_dwGBIOpcodeCount, 0, sizeof(g_dwGBIOpcodeCount));
+}
+#endif
+
 //////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////
 //                   Util Functions                     //
@@ -1334,6 +1384,7 @@ void DLParser_FillRect(Gfx *gfx)
             uint16 color = (uint16)gRDP.originalFillColor;
             uint32 pitch = g_CI.dwWidth<<1;
             long long base = (long long) (g_pRDRAMu8 + g_CI.dwAddr);
+            RDRAMRegionWritten(g_CI.dwAddr, y1*pitch);
             for( uint32 i =y0; i<y1; i++ )
             {
                 for( uint32 j=x0; j<x1; j++ )
@@ -1361,6 +1412,7 @@ void DLParser_FillRect(Gfx *gfx)
                 uint16 color = (uint16)gRDP.originalFillColor;
                 uint32 pitch = g_pRenderTextureInfo->N64Width<<1;
                 long long base = (long long) (g_pRDRAMu8 + g_pRenderTextureInfo->CI_Info.dwAddr);
+                RDRAMRegionWritten(g_pRenderTextureInfo->CI_Info.dwAddr, y1*pitch);
                 for( uint32 i =y0; i<y1; i++ )
                 {
                     for( uint32 j=x0; j<x1; j++ )
@@ -1374,6 +1426,7 @@ void DLParser_FillRect(Gfx *gfx)
                 uint8 color = (uint8)gRDP.originalFillColor;
                 uint32 pitch = g_pRenderTextureInfo->N64Width;
                 long long base = (long long) (g_pRDRAMu8 + g_pRenderTextureInfo->CI_Info.dwAddr);
+                RDRAMRegionWritten(g_pRenderTextureInfo->CI_Info.dwAddr, y1*pitch);
                 for( uint32 i=y0; i<y1; i++ )
                 {
                     for( uint32 j=x0; j<x1; j++ )
@@ -1679,12 +1732,8 @@ void RDP_DLParser_Process(void)
     gDlistStack[gDlistStackPointer].pc = start;
     gDlistStack[gDlistStackPointer].countdown = MAX_DL_COUNT;
 
-    // Check if we need to purge (every 5 milliseconds)
-    if (status.gRDPTime - status.lastPurgeTimeTime > 5)
-    {
-        gTextureManager.PurgeOldTextures();
-        status.lastPurgeTimeTime = status.gRDPTime;
-    }
+    // Trim the texture cache a little for every display list
+    gTextureManager.PurgeOldTextures();
     
     // Lock the graphics context here.
     CRender::g_pRender->SetFillMode(RICE_FILLMODE_SOLID);
@@ -602,6 +602,9 @@ void DLParser_Init();
 void RDP_GFX_Reset();
 void RDP_Cleanup();
 void DLParser_Process(OSTask * pTask);
+#ifdef GBI_PROFILE
+void DLParser_ReportGBIProfile(void);
+#endif
 void RDP_DLParser_Process(void);
 
 void PrepareTextures();
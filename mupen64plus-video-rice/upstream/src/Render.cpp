@@ -928,6 +928,18 @@ bool CRender::TexRectFlip(int nX0, int nY0, int nX1, int nY1, float fS0, float f
 }
 
 
+// Render_textures which are stored bottom-up are sampled flipped
+static inline float RenderTextureV(RenderTextureInfo &info, float v, float texHeight)
+{
+    if( info.pRenderTexture && info.pRenderTexture->IsUpsideDown() )
+    {
+        int width, height;
+        info.pRenderTexture->GetDimension(width, height);
+        return height/texHeight - v;
+    }
+    return v;
+}
+
 void CRender::StartDrawSimple2DTexture(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, COLOR dif, float z, float rhw)
 {
     g_texRectTVtx[0].x = ViewPortTranslatei_x(x0);  // << Error here, shouldn't divid by 4
@@ -967,6 +979,9 @@ void CRender::StartDrawSimple2DTexture(float x0, float y0, float x1, float y1, f
         g_texRectTVtx[2].tcord[0].v *= info.scaleY;
         g_texRectTVtx[3].tcord[0].u *= info.scaleX;
         g_texRectTVtx[3].tcord[0].v *= info.scaleY;
+
+        for( int i=0; i<4; i++ )
+            g_texRectTVtx[i].tcord[0].v = RenderTextureV(info, g_texRectTVtx[i].tcord[0].v, txtr.m_fTexHeight);
     }
 
     g_texRectTVtx[0].z = g_texRectTVtx[1].z = g_texRectTVtx[2].z = g_texRectTVtx[3].z = z;
@@ -1641,6 +1656,7 @@ void SetVertexTextureUVCoord(TexCord &dst, float s, float t, int tile, TxtrCache
 
         s *= info.scaleX;
         t *= info.scaleY;
+        t = RenderTextureV(info, t, txtr.m_fTexHeight);
     }
 
     dst.u = s;
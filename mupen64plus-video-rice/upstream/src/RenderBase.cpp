@@ -38,6 +38,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "osal_preproc.h"
 #include "typedefs.h"
 
+#if defined(RENDER_NEON)
+#include <arm_neon.h>
+#endif
+
 #undef min
 #undef max
 
@@ -651,7 +655,11 @@ void InitRenderBase()
     else
 #endif
     {
+#if defined(RENDER_NEON)
+        ProcessVertexData = ProcessVertexDataNEON;
+#else
         ProcessVertexData = ProcessVertexDataNoSSE;
+#endif
     }
 
     gRSPfFogMin = gRSPfFogMax = 0.0f;
@@ -1485,6 +1493,191 @@ void ProcessVertexDataNoSSE(uint32 dwAddr, uint32 dwV0, uint32 dwNum)
     DEBUGGER_PAUSE_AND_DUMP(NEXT_VERTEX_CMD,{TRACE0("Paused at Vertex Cmd");});
 }
 
+#if defined(RENDER_NEON)
+// Same arithmetic as Vec3Transform and the 1/w projection in
+// ProcessVertexDataNoSSE, four vertices at a time: vld4q/vst4q turn the
+// XVECTOR4 arrays into one register per component and back.
+static void NEONVec3TransformBatch(uint32 dwV0, uint32 dwNum)
+{
+    const Matrix &m = gRSPworldProject;
+    uint32 i = dwV0;
+
+    for (; i + 4 <= dwV0 + dwNum; i += 4)
+    {
+        float32x4x4_t v = vld4q_f32(&g_vtxNonTransformed[i].x);
+        float32x4x4_t t;
+        for (int j = 0; j < 4; j++)
+        {
+            t.val[j] = vmulq_n_f32(v.val[0], m.m[0][j]);
+            t.val[j] = vmlaq_n_f32(t.val[j], v.val[1], m.m[1][j]);
+            t.val[j] = vmlaq_n_f32(t.val[j], v.val[2], m.m[2][j]);
+            t.val[j] = vaddq_f32(t.val[j], vdupq_n_f32(m.m[3][j]));
+        }
+        vst4q_f32(&g_vtxTransformed[i].x, t);
+
+        float32x4x4_t p;
+#if defined(__aarch64__)
+        p.val[3] = vdivq_f32(vdupq_n_f32(1.0f), t.val[3]);
+#else
+        p.val[3] = vrecpeq_f32(t.val[3]);
+        p.val[3] = vmulq_f32(vrecpsq_f32(t.val[3], p.val[3]), p.val[3]);
+        p.val[3] = vmulq_f32(vrecpsq_f32(t.val[3], p.val[3]), p.val[3]);
+#endif
+        p.val[0] = vmulq_f32(t.val[0], p.val[3]);
+        p.val[1] = vmulq_f32(t.val[1], p.val[3]);
+        p.val[2] = vmulq_f32(t.val[2], p.val[3]);
+        vst4q_f32(&g_vecProjected[i].x, p);
+    }
+
+    for (; i < dwV0 + dwNum; i++)
+    {
+        Vec3Transform(&g_vtxTransformed[i], (XVECTOR3*)&g_vtxNonTransformed[i], &gRSPworldProject);
+        g_vecProjected[i].w = 1.0f / g_vtxTransformed[i].w;
+        g_vecProjected[i].x = g_vtxTransformed[i].x * g_vecProjected[i].w;
+        g_vecProjected[i].y = g_vtxTransformed[i].y * g_vecProjected[i].w;
+        g_vecProjected[i].z = g_vtxTransformed[i].z * g_vecProjected[i].w;
+    }
+}
+
+// Vec3TransformNormal
+static inline void NEONVec3TransformNormal(XVECTOR4 &vec, const Matrix &m)
+{
+    float32x4_t t = vmulq_n_f32(vld1q_f32(m.m[0]), vec.x);
+    t = vmlaq_n_f32(t, vld1q_f32(m.m[1]), vec.y);
+    t = vmlaq_n_f32(t, vld1q_f32(m.m[2]), vec.z);
+
+    float x = vgetq_lane_f32(t, 0), y = vgetq_lane_f32(t, 1), z = vgetq_lane_f32(t, 2);
+    float norm = sqrt(x*x + y*y + z*z);
+    if (norm == 0.0)
+    {
+        vec.x = 0.0; vec.y = 0.0; vec.z = 0.0;
+    }
+    else
+    {
+        vec.x = x/norm; vec.y = y/norm; vec.z = z/norm;
+    }
+}
+
+// Directional lights of LightVert, with the colour channels in one register
+static uint32 NEONLightVert(const XVECTOR4 &norm)
+{
+    float32x4_t color = vld1q_f32(gRSP.fAmbientColors);
+
+    for (unsigned int l = 0; l < gRSPnumLights; l++)
+    {
+        float fCosT = norm.x*gRSPlights[l].x + norm.y*gRSPlights[l].y + norm.z*gRSPlights[l].z;
+
+        if (fCosT > 0)
+            color = vmlaq_n_f32(color, vld1q_f32(gRSPlights[l].fcolors), fCosT);
+    }
+
+    uint32x4_t rgb = vcvtq_u32_f32(vminq_f32(color, vdupq_n_f32(255.0f)));
+    return ((0xff000000)|(vgetq_lane_u32(rgb, 0)<<16)|(vgetq_lane_u32(rgb, 1)<<8)|vgetq_lane_u32(rgb, 2));
+}
+
+void ProcessVertexDataNEON(uint32 dwAddr, uint32 dwV0, uint32 dwNum)
+{
+    UpdateCombinedMatrix();
+
+    // Same outputs as ProcessVertexDataNoSSE. All positions are transformed
+    // up front, then the rest is done per vertex as before.
+
+    FiddledVtx * pVtxBase = (FiddledVtx*)(g_pRDRAMu8 + dwAddr);
+    g_pVtxBase = pVtxBase;
+
+    for (uint32 i = dwV0; i < dwV0 + dwNum; i++)
+    {
+        FiddledVtx & vert = pVtxBase[i - dwV0];
+
+        g_vtxNonTransformed[i].x = (float)vert.x;
+        g_vtxNonTransformed[i].y = (float)vert.y;
+        g_vtxNonTransformed[i].z = (float)vert.z;
+    }
+
+    NEONVec3TransformBatch(dwV0, dwNum);
+
+    for (uint32 i = dwV0; i < dwV0 + dwNum; i++)
+    {
+        SP_Timing(RSP_GBI0_Vtx);
+
+        FiddledVtx & vert = pVtxBase[i - dwV0];
+
+        if ((g_curRomInfo.bPrimaryDepthHack || options.enableHackForGames == HACK_FOR_NASCAR ) && gRDP.otherMode.depth_source )
+        {
+            g_vecProjected[i].z = gRDP.fPrimitiveDepth;
+            g_vtxTransformed[i].z = gRDP.fPrimitiveDepth*g_vtxTransformed[i].w;
+        }
+
+        if( gRSP.bFogEnabled )
+        {
+            g_fFogCoord[i] = g_vecProjected[i].z;
+            if( g_vecProjected[i].w < 0 || g_vecProjected[i].z < 0 || g_fFogCoord[i] < gRSPfFogMin )
+                g_fFogCoord[i] = gRSPfFogMin;
+        }
+
+        VTX_DUMP( 
+        {
+            uint32 *dat = (uint32*)(&vert);
+            DebuggerAppendMsg("vtx %d: %08X %08X %08X %08X", i, dat[0],dat[1],dat[2],dat[3]); 
+            DebuggerAppendMsg("      : %f, %f, %f, %f", 
+                g_vtxTransformed[i].x,g_vtxTransformed[i].y,g_vtxTransformed[i].z,g_vtxTransformed[i].w);
+            DebuggerAppendMsg("      : %f, %f, %f, %f", 
+                g_vecProjected[i].x,g_vecProjected[i].y,g_vecProjected[i].z,g_vecProjected[i].w);
+        });
+
+        RSP_Vtx_Clipping(i);
+
+        if( gRSP.bLightingEnable )
+        {
+            g_normal.x = (float)vert.norma.nx;
+            g_normal.y = (float)vert.norma.ny;
+            g_normal.z = (float)vert.norma.nz;
+
+            NEONVec3TransformNormal(g_normal, gRSPmodelViewTop);
+            if( options.enableHackForGames != HACK_FOR_ZELDA_MM )
+                g_dwVtxDifColor[i] = NEONLightVert(g_normal);
+            else
+                g_dwVtxDifColor[i] = LightVert(g_normal, i);
+            *(((uint8*)&(g_dwVtxDifColor[i]))+3) = vert.rgba.a; // still use alpha from the vertex
+        }
+        else
+        {
+            if( (gRDP.geometryMode & G_SHADE) == 0 && gRSP.ucode < 5 )  //Shade is disabled
+            {
+                //FLAT shade
+                g_dwVtxDifColor[i] = gRDP.primitiveColor;
+            }
+            else
+            {
+                g_dwVtxDifColor[i] = COLOR_RGBA(vert.rgba.r, vert.rgba.g, vert.rgba.b, vert.rgba.a);
+            }
+        }
+
+        if( options.bWinFrameMode )
+        {
+            g_dwVtxDifColor[i] = COLOR_RGBA(vert.rgba.r, vert.rgba.g, vert.rgba.b, vert.rgba.a);
+        }
+
+        ReplaceAlphaWithFogFactor(i);
+
+        // If the vert is already lit, then there is no normal (and hence we
+        // can't generate tex coord)
+        if (gRSP.bTextureGen && gRSP.bLightingEnable )
+        {
+            TexGen(g_fVtxTxtCoords[i].x, g_fVtxTxtCoords[i].y);
+        }
+        else
+        {
+            g_fVtxTxtCoords[i].x = (float)vert.tu;
+            g_fVtxTxtCoords[i].y = (float)vert.tv; 
+        }
+    }
+
+    VTX_DUMP(TRACE2("Setting Vertexes: %d - %d\n", dwV0, dwV0+dwNum-1));
+    DEBUGGER_PAUSE_AND_DUMP(NEXT_VERTEX_CMD,{TRACE0("Paused at Vertex Cmd");});
+}
+#endif
+
 bool PrepareTriangle(uint32 dwV0, uint32 dwV1, uint32 dwV2)
 {
     SP_Timing(SP_Each_Triangle);
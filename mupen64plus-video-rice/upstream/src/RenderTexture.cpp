@@ -18,20 +18,26 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include <stddef.h>
 
+#include "Config.h"
 #include "Debugger.h"
 #include "FrameBuffer.h"
+#include "OGLDebug.h"
+#include "OGLExtensions.h"
 #include "OGLTexture.h"
 #include "RenderTexture.h"
 #include "Texture.h"
 #include "TextureManager.h"
+#include "Video.h"
 #include "osal_opengl.h"
 
 // ===========================================================================
 COGLRenderTexture::COGLRenderTexture(int width, int height, RenderTextureInfo* pInfo, TextureUsage usage)
     :   CRenderTexture(width, height, pInfo, usage),
+        m_widthCreated(0), m_heightCreated(0),
+        m_FBO(0), m_depthRenderBuffer(0), m_prevFBO(0),
         m_pOGLTexture(NULL)
 {
-    if( usage == AS_BACK_BUFFER_SAVE )
+    if( usage == AS_BACK_BUFFER_SAVE || usage == AS_RENDER_TARGET )
     {
         m_pTexture = m_pOGLTexture = new COGLTexture(width, height, usage);
         if( !m_pTexture )
@@ -44,41 +50,239 @@ COGLRenderTexture::COGLRenderTexture(int width, int height, RenderTextureInfo* p
     m_width = width;
     m_height = height;
     m_beingRendered = false;
+
+    if( usage == AS_RENDER_TARGET && m_pOGLTexture && !InitFrameBufferObject() )
+    {
+        // Without FBOs the N64 keeps drawing into the back buffer
+        ShutdownFrameBufferObject();
+        SAFE_DELETE(m_pTexture);
+        m_pOGLTexture = NULL;
+    }
 }
 
 COGLRenderTexture::~COGLRenderTexture()
 {
+    // Closing the render_texture from here would delete it a second time
     if( m_beingRendered )
-    {
-        g_pFrameBufferManager->CloseRenderTexture(false);
         SetAsRenderTarget(false);
-    }
 
-    ShutdownPBuffer();
+    ShutdownFrameBufferObject();
     SAFE_DELETE(m_pTexture);
     m_pOGLTexture = NULL;
     m_beingRendered = false;
 }
 
-bool COGLRenderTexture::InitPBuffer( void )
+bool COGLRenderTexture::InitFrameBufferObject( void )
 {
+    GLint prevFBO, prevTexture;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFBO);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTexture);
+
+    m_widthCreated = m_pOGLTexture->m_dwCreatedTextureWidth;
+    m_heightCreated = m_pOGLTexture->m_dwCreatedTextureHeight;
+
+    // The chosen texture quality may not be color renderable
+    m_pOGLTexture->m_glInternalFmt = m_pOGLTexture->m_glFmt = GL_RGBA;
+    m_pOGLTexture->m_glType = GL_UNSIGNED_BYTE;
+    glBindTexture(GL_TEXTURE_2D, m_pOGLTexture->m_dwTextureName);
+    OPENGL_CHECK_ERRORS;
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_widthCreated, m_heightCreated, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    OPENGL_CHECK_ERRORS;
+    glBindTexture(GL_TEXTURE_2D, prevTexture);
+    OPENGL_CHECK_ERRORS;
+
+    glGenFramebuffers(1, &m_FBO);
+    OPENGL_CHECK_ERRORS;
+    if( m_FBO == 0 )
+        return false;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    OPENGL_CHECK_ERRORS;
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pOGLTexture->m_dwTextureName, 0);
+    OPENGL_CHECK_ERRORS;
+
+    glGenRenderbuffers(1, &m_depthRenderBuffer);
+    OPENGL_CHECK_ERRORS;
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderBuffer);
+    OPENGL_CHECK_ERRORS;
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, m_widthCreated, m_heightCreated);
+    OPENGL_CHECK_ERRORS;
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderBuffer);
+    OPENGL_CHECK_ERRORS;
+
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFBO);
+    OPENGL_CHECK_ERRORS;
+
+    if( !complete )
+    {
+        TRACE2("Incomplete FBO for render_texture (%d x %d)", m_width, m_height);
+        return false;
+    }
+
     return true;
 }
 
-void COGLRenderTexture::ShutdownPBuffer(void)
+void COGLRenderTexture::ShutdownFrameBufferObject(void)
 {
+    if( m_depthRenderBuffer != 0 )
+    {
+        glDeleteRenderbuffers(1, &m_depthRenderBuffer);
+        OPENGL_CHECK_ERRORS;
+        m_depthRenderBuffer = 0;
+    }
+
+    if( m_FBO != 0 )
+    {
+        glDeleteFramebuffers(1, &m_FBO);
+        OPENGL_CHECK_ERRORS;
+        m_FBO = 0;
+    }
 }
 
 bool COGLRenderTexture::SetAsRenderTarget(bool enable)
 {
-   return true;
+    if( m_FBO == 0 )
+        return true;
+
+    if( enable && !m_beingRendered )
+    {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_prevFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        OPENGL_CHECK_ERRORS;
+
+        // Viewport and scissor are computed from the window settings, make
+        // them describe the render_texture until it is closed
+        m_savedDisplayWidth = windowSetting.uDisplayWidth;
+        m_savedDisplayHeight = windowSetting.uDisplayHeight;
+        m_savedViWidth = windowSetting.uViWidth;
+        m_savedViHeight = windowSetting.uViHeight;
+        m_savedStatusBarHeight = windowSetting.statusBarHeightToUse;
+        m_savedToolbarHeight = windowSetting.toolbarHeightToUse;
+
+        windowSetting.uDisplayWidth = m_width;
+        windowSetting.uDisplayHeight = m_height;
+        windowSetting.uViWidth = m_pInfo->N64Width;
+        windowSetting.uViHeight = m_pInfo->N64Height;
+        windowSetting.statusBarHeightToUse = 0;
+        windowSetting.toolbarHeightToUse = 0;
+
+        m_beingRendered = true;
+    }
+    else if( !enable && m_beingRendered )
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_prevFBO);
+        OPENGL_CHECK_ERRORS;
+
+        windowSetting.uDisplayWidth = m_savedDisplayWidth;
+        windowSetting.uDisplayHeight = m_savedDisplayHeight;
+        windowSetting.uViWidth = m_savedViWidth;
+        windowSetting.uViHeight = m_savedViHeight;
+        windowSetting.statusBarHeightToUse = m_savedStatusBarHeight;
+        windowSetting.toolbarHeightToUse = m_savedToolbarHeight;
+
+        if( options.mipmapping )
+        {
+            GLint prevTexture;
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTexture);
+            glBindTexture(GL_TEXTURE_2D, m_pOGLTexture->m_dwTextureName);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            OPENGL_CHECK_ERRORS;
+            glBindTexture(GL_TEXTURE_2D, prevTexture);
+        }
+
+        m_beingRendered = false;
+    }
+
+    return true;
+}
+
+// Reads the whole render_texture as A8R8G8B8, top row first
+void COGLRenderTexture::ReadPixels(uint8 *buffer)
+{
+    GLint prevFBO;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    OPENGL_CHECK_ERRORS;
+
+    // RGBA is the only format GLES guarantees for glReadPixels
+    uint8 *rgba = new uint8[m_width*m_height*4];
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    OPENGL_CHECK_ERRORS;
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFBO);
+    OPENGL_CHECK_ERRORS;
+
+    for( int y=0; y<m_height; y++ )
+    {
+        uint8 *pS = rgba + (m_height-1-y)*m_width*4;
+        uint8 *pD = buffer + y*m_width*4;
+        for( int x=0; x<m_width; x++, pS+=4, pD+=4 )
+        {
+            pD[0] = pS[2];
+            pD[1] = pS[1];
+            pD[2] = pS[0];
+            pD[3] = pS[3];
+        }
+    }
+
+    delete [] rgba;
 }
 
+// Only used when the texture can't be sampled from the FBO as it is
 void COGLRenderTexture::LoadTexture(TxtrCacheEntry* pEntry)
 {
+    if( m_FBO == 0 || pEntry->pTexture == NULL )
+        return;
+
+    DrawInfo di;
+    if( !pEntry->pTexture->StartUpdate(&di) )
+        return;
+
+    uint8 *buffer = new uint8[m_width*m_height*4];
+    ReadPixels(buffer);
+
+    uint32 addrOffset = pEntry->ti.Address-m_pInfo->CI_Info.dwAddr;
+    uint32 extraTop = (addrOffset>>(m_pInfo->CI_Info.dwSize-1)) /m_pInfo->CI_Info.dwWidth + pEntry->ti.TopToLoad;
+    uint32 extraLeft = (addrOffset>>(m_pInfo->CI_Info.dwSize-1))%m_pInfo->CI_Info.dwWidth + pEntry->ti.LeftToLoad;
+
+    for( uint32 y=0; y<di.dwHeight; y++ )
+    {
+        int sy = int((y+extraTop)*m_pInfo->scaleY);
+        if( sy >= m_height )
+            break;
+
+        uint32 *pS = (uint32*)(buffer + sy*m_width*4);
+        uint32 *pD = (uint32*)((uint8*)di.lpSurface + y*di.lPitch);
+        for( uint32 x=0; x<di.dwWidth; x++ )
+        {
+            int sx = int((x+extraLeft)*m_pInfo->scaleX);
+            if( sx >= m_width )
+                break;
+            pD[x] = pS[sx];
+        }
+    }
+
+    delete [] buffer;
+    pEntry->pTexture->EndUpdate(&di);
 }
 
 void COGLRenderTexture::StoreToRDRAM(int infoIdx)
 {
-}
+    if( m_FBO == 0 )
+        return;
+
+    RenderTextureInfo &info = gRenderTextureInfos[infoIdx];
+    uint32 height = info.knownHeight ? info.N64Height : info.maxUsedHeight;
+    if( height == 0 )
+        return;
 
+    uint8 *buffer = new uint8[m_width*m_height*4];
+    ReadPixels(buffer);
+
+    g_pFrameBufferManager->CopyBufferToRDRAM(info.CI_Info.dwAddr, info.CI_Info.dwFormat, info.CI_Info.dwSize,
+        info.N64Width, height, (uint32)(info.N64Width*info.scaleX), (uint32)(height*info.scaleY),
+        0xFFFFFFFF, 0xFFFFFFFF, info.N64Width, TEXTURE_FMT_A8R8G8B8, buffer, m_width*4);
+
+    delete [] buffer;
+    TXTRBUF_DUMP(TRACE2("Stored render_texture %d to RDRAM at %08X", infoIdx, info.CI_Info.dwAddr));
+}
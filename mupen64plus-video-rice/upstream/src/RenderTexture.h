@@ -47,8 +47,11 @@ typedef struct {
     bool        isUsed;
     uint32      knownHeight;
 
-    uint32      crcInRDRAM;
+    uint32      crcInRDRAM;         // texture CRC of the RDRAM content, used as the cache key
+    uint32      hashInRDRAM;        // used to find out whether the RDRAM content changed
+    RDRAMHashInfo hashInfo;
     uint32      crcCheckedAtFrame;
+    bool        storedInRDRAM;      // RDRAM holds what was last rendered
 
     TxtrCacheEntry txtEntry;
 } RenderTextureInfo;
@@ -90,6 +93,9 @@ public:
 
     TextureUsage GetUsage() {return m_usage;}
 
+    // Rows are stored bottom-up, texture coordinates have to be flipped
+    virtual bool IsUpsideDown() {return false;}
+
 
 protected:
     int     m_width;
@@ -102,9 +108,11 @@ protected:
 };
 
 
+// AS_RENDER_TARGET textures are the color attachment of a frame buffer object,
+// the N64 draws into them directly and they are sampled as they are. They only
+// go back to RDRAM when written back or when the CPU reads them.
 class COGLRenderTexture : public CRenderTexture
 {
-    // Haven't implemented yet
 public:
     COGLRenderTexture(int width, int height, RenderTextureInfo* pInfo, TextureUsage usage);
     ~COGLRenderTexture();
@@ -112,14 +120,24 @@ public:
     bool SetAsRenderTarget(bool enable);
     void LoadTexture(TxtrCacheEntry* pEntry);
     void StoreToRDRAM(int infoIdx);
+    bool IsUpsideDown() {return m_FBO != 0;}
 
 protected:
-    bool InitPBuffer(void);
-    void ShutdownPBuffer(void);
+    bool InitFrameBufferObject(void);
+    void ShutdownFrameBufferObject(void);
+    void ReadPixels(uint8 *buffer);
 
     int     m_widthCreated;
     int     m_heightCreated;
 
+    uint32  m_FBO;
+    uint32  m_depthRenderBuffer;
+    int     m_prevFBO;
+
+    // Window settings describing the screen while the FBO is bound
+    unsigned short m_savedDisplayWidth, m_savedDisplayHeight;
+    unsigned short m_savedViWidth, m_savedViHeight;
+    int     m_savedStatusBarHeight, m_savedToolbarHeight;
 
     COGLTexture *m_pOGLTexture;
 };
@@ -18,6 +18,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "CSortedList.h"
+#include "CritSect.h"
 #include "Debugger.h"
 #include "RSP_Parser.h"
 #include "RenderBase.h"
@@ -35,6 +36,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <string.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <string>
+#include <vector>
 
 #include "ConvertImage.h"
 #include "DeviceBuilder.h"
@@ -930,16 +933,21 @@ BOOL PathFileExists(char* pszPath)
  * bMainFolder: indicates if the folder is the main folder that will be scanned. That way, texture counting does not
  *              start at 1 each time a subfolder is accessed. (microdev: I know that is not important but it really
  *              bugged me ;-))
+ * pFolders: if not NULL, every folder that has been scanned is added to it
  * return:
  * infos: the list with the records of the identified hires textures. Be aware that these records also contains the
  *        actual textures if caching is enabled.
  ********************************************************************************************************************/
-void FindAllTexturesFromFolder(char *foldername, CSortedList<uint64,ExtTxtrInfo> &infos, bool extraCheck, bool bRecursive)
+void FindAllTexturesFromFolder(char *foldername, CSortedList<uint64,ExtTxtrInfo> &infos, bool extraCheck, bool bRecursive, std::vector<std::string> *pFolders = NULL)
 {
     // check if folder actually exists
     if (!osal_is_directory(foldername))
         return;
 
+    // remember the folder for the hires texture index
+    if (pFolders)
+        pFolders->push_back(foldername);
+
     // the path of the texture
     char texturefilename[PATH_MAX];
     //
@@ -978,7 +986,7 @@ void FindAllTexturesFromFolder(char *foldername, CSortedList<uint64,ExtTxtrInfo>
             // Add file-separator
             strcat(texturefilename, OSAL_DIR_SEPARATOR_STR);
             // Scan detected folder for hires textures (recursive call)
-            FindAllTexturesFromFolder(texturefilename, infos, extraCheck, bRecursive);
+            FindAllTexturesFromFolder(texturefilename, infos, extraCheck, bRecursive, pFolders);
             continue;
         }
         // well, the current file is actually no file (probably a directory & recursive scanning is not enabled)
@@ -1296,6 +1304,339 @@ void FindAllDumpedTextures(void)
     }
 }
 
+void CloseHiresTextures(void);
+
+/********************************************************************************************************************
+ * Hires texture index
+ * Scanning a big texture pack means opening every file in it to read the image dimensions, so the result of a scan is
+ * stored in the user cache folder and reused on the next start. The index keeps the modification time of every folder
+ * that was scanned. Adding, removing or renaming a file in any of them changes that time and causes a rescan; editing
+ * a file in place does not, delete the index to pick such a change up.
+ ********************************************************************************************************************/
+#define HIRES_INDEX_MAGIC "RICEHRI1"
+
+static void GetHiresTextureIndexPath(char *filename)
+{
+    strncpy(filename, ConfigGetUserCachePath(), PATH_MAX);
+    filename[PATH_MAX] = 0;
+
+    if(filename[strlen(filename) - 1] != OSAL_DIR_SEPARATOR_CHAR)
+        strcat(filename, OSAL_DIR_SEPARATOR_STR);
+    strcat(filename, "hires_texture_index" OSAL_DIR_SEPARATOR_STR);
+    CheckAndCreateFolder(filename);
+    strcat(filename, (const char*)g_curRomInfo.szGameName);
+    strcat(filename, ".idx");
+}
+
+static void WriteIndexString(FILE *f, const char *str)
+{
+    uint32 len = str ? (uint32)strlen(str) : 0;
+    fwrite(&len, sizeof(len), 1, f);
+    fwrite(str, 1, len, f);
+}
+
+// Returns a string allocated with new[], or NULL for an empty string
+static bool ReadIndexString(FILE *f, char **str)
+{
+    uint32 len;
+    *str = NULL;
+    if (fread(&len, sizeof(len), 1, f) != 1 || len >= PATH_MAX)
+        return false;
+    if (len == 0)
+        return true;
+    *str = new char[len+1];
+    if (fread(*str, 1, len, f) != len)
+    {
+        delete [] *str;
+        *str = NULL;
+        return false;
+    }
+    (*str)[len] = 0;
+    return true;
+}
+
+static void SaveHiresTextureIndex(const std::vector<std::string> &folders)
+{
+    char filename[PATH_MAX + 64];
+    GetHiresTextureIndexPath(filename);
+
+    FILE *f = fopen(filename, "wb");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't write hi-res texture index: %s", filename);
+        return;
+    }
+
+    uint32 crcOnly = options.bLoadHiResCRCOnly ? 1 : 0;
+    uint32 numFolders = (uint32)folders.size();
+    uint32 numInfos = (uint32)gHiresTxtrInfos.size();
+
+    fwrite(HIRES_INDEX_MAGIC, 1, 8, f);
+    fwrite(&crcOnly, sizeof(crcOnly), 1, f);
+    fwrite(&numFolders, sizeof(numFolders), 1, f);
+    for (uint32 i = 0; i < numFolders; i++)
+    {
+        long long mtime = osal_get_mtime(folders[i].c_str());
+        WriteIndexString(f, folders[i].c_str());
+        fwrite(&mtime, sizeof(mtime), 1, f);
+    }
+
+    fwrite(&numInfos, sizeof(numInfos), 1, f);
+    for (uint32 i = 0; i < numInfos; i++)
+    {
+        ExtTxtrInfo info = gHiresTxtrInfos[i];
+        uint32 folder = (uint32)(std::find(folders.begin(), folders.end(), std::string(info.foldername)) - folders.begin());
+        int fields[8] = { (int)info.width, (int)info.height, info.fmt, info.siz,
+                            info.crc32, info.pal_crc32, info.type, info.bSeparatedAlpha ? 1 : 0 };
+
+        fwrite(fields, sizeof(fields), 1, f);
+        fwrite(&folder, sizeof(folder), 1, f);
+        WriteIndexString(f, info.filename);
+        WriteIndexString(f, info.filename_a);
+    }
+
+    fclose(f);
+}
+
+// Fills gHiresTxtrInfos from the index if it is still valid for foldername
+static bool LoadHiresTextureIndex(const char *foldername)
+{
+    char filename[PATH_MAX + 64];
+    GetHiresTextureIndexPath(filename);
+
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL)
+        return false;
+
+    std::vector<std::string> folders;
+    bool bValid = false;
+    char magic[8];
+    uint32 crcOnly, numFolders, numInfos;
+
+    if (fread(magic, 1, 8, f) == 8 && memcmp(magic, HIRES_INDEX_MAGIC, 8) == 0 &&
+        fread(&crcOnly, sizeof(crcOnly), 1, f) == 1 && crcOnly == (options.bLoadHiResCRCOnly ? 1u : 0u) &&
+        fread(&numFolders, sizeof(numFolders), 1, f) == 1 && numFolders > 0)
+    {
+        bValid = true;
+        for (uint32 i = 0; i < numFolders && bValid; i++)
+        {
+            char *folder;
+            long long mtime;
+            bValid = ReadIndexString(f, &folder) && folder != NULL && fread(&mtime, sizeof(mtime), 1, f) == 1;
+            if (bValid)
+            {
+                // the first folder is the root of the pack
+                bValid = (i > 0 || strcmp(folder, foldername) == 0) && osal_get_mtime(folder) == mtime;
+                folders.push_back(folder);
+            }
+            delete [] folder;
+        }
+        bValid = bValid && fread(&numInfos, sizeof(numInfos), 1, f) == 1;
+    }
+
+    if (!bValid)
+    {
+        fclose(f);
+        return false;
+    }
+
+    gHiresTxtrInfos.clear();
+    for (uint32 i = 0; i < numInfos; i++)
+    {
+        ExtTxtrInfo newinfo;
+        int fields[8];
+        uint32 folder;
+
+        newinfo.foldername = newinfo.filename = newinfo.filename_a = NULL;
+        if (fread(fields, sizeof(fields), 1, f) != 1 || fread(&folder, sizeof(folder), 1, f) != 1 || folder >= numFolders ||
+            !ReadIndexString(f, &newinfo.filename) || newinfo.filename == NULL || !ReadIndexString(f, &newinfo.filename_a))
+        {
+            delete [] newinfo.filename;
+            bValid = false;
+            break;
+        }
+
+        newinfo.width = fields[0];
+        newinfo.height = fields[1];
+        newinfo.fmt = fields[2];
+        newinfo.siz = fields[3];
+        newinfo.crc32 = fields[4];
+        newinfo.pal_crc32 = fields[5];
+        newinfo.type = (TextureType)fields[6];
+        newinfo.bSeparatedAlpha = fields[7] != 0;
+        newinfo.foldername = new char[folders[folder].size()+1];
+        strcpy(newinfo.foldername, folders[folder].c_str());
+
+        // Same key as FindAllTexturesFromFolder
+        uint64 crc64 = newinfo.crc32;
+        crc64 <<= 32;
+        if (options.bLoadHiResCRCOnly)
+            crc64 |= newinfo.pal_crc32&0xFFFFFFFF;
+        else
+            crc64 |= (newinfo.pal_crc32&0xFFFFFF00)|(newinfo.fmt<<4)|newinfo.siz;
+        gHiresTxtrInfos.add(crc64,newinfo);
+    }
+
+    fclose(f);
+
+    if (!bValid)
+    {
+        DebugMessage(M64MSG_WARNING, "Hi-res texture index is damaged: %s", filename);
+        CloseHiresTextures();
+    }
+    return bValid;
+}
+
+/********************************************************************************************************************
+ * Background hires texture decoding
+ * Decoding a big PNG takes long enough to stall a frame, so LoadHiresTexture only queues the file and keeps showing the
+ * original texture. A worker thread decodes it and LoadHiresTexture picks the result up the next time the texture is
+ * used. Jobs are indexed like gHiresTxtrInfos, which does not change while the worker runs.
+ ********************************************************************************************************************/
+enum
+{
+    HIRES_LOAD_IDLE,
+    HIRES_LOAD_QUEUED,
+    HIRES_LOAD_READY,
+    HIRES_LOAD_FAILED,
+};
+
+typedef struct {
+    int state;
+    unsigned char *buf_rgba;
+    unsigned char *buf_a;
+    int width;
+    int height;
+} HiresLoadJob;
+
+static HiresLoadJob *g_pHiresLoadJobs = NULL;
+static std::vector<int> g_hiresLoadQueue;
+static CCritSect g_hiresLoadLock;
+static SDL_sem *g_hiresLoadSem = NULL;
+static SDL_Thread *g_hiresLoadThread = NULL;
+static bool g_bHiresLoadQuit = false;
+
+static bool DecodeHiresTexture(const ExtTxtrInfo &info, unsigned char **pbuf_rgba, unsigned char **pbuf_a, int &width, int &height);
+
+static int HiresLoadThreadFunc(void *)
+{
+    while (true)
+    {
+        SDL_SemWait(g_hiresLoadSem);
+
+        g_hiresLoadLock.Lock();
+        if (g_bHiresLoadQuit)
+        {
+            g_hiresLoadLock.Unlock();
+            break;
+        }
+        if (g_hiresLoadQueue.empty())
+        {
+            g_hiresLoadLock.Unlock();
+            continue;
+        }
+        int idx = g_hiresLoadQueue.front();
+        g_hiresLoadQueue.erase(g_hiresLoadQueue.begin());
+        g_hiresLoadLock.Unlock();
+
+        unsigned char *buf_rgba = NULL;
+        unsigned char *buf_a = NULL;
+        int width = 0, height = 0;
+        bool bOK = DecodeHiresTexture(gHiresTxtrInfos[idx], &buf_rgba, &buf_a, width, height);
+
+        g_hiresLoadLock.Lock();
+        HiresLoadJob &job = g_pHiresLoadJobs[idx];
+        job.buf_rgba = buf_rgba;
+        job.buf_a = buf_a;
+        job.width = width;
+        job.height = height;
+        job.state = bOK ? HIRES_LOAD_READY : HIRES_LOAD_FAILED;
+        g_hiresLoadLock.Unlock();
+    }
+
+    return 0;
+}
+
+static void StartHiresLoader(void)
+{
+    if (!options.bLoadHiResAsync || gHiresTxtrInfos.size() == 0)
+        return;
+
+    g_pHiresLoadJobs = new HiresLoadJob[gHiresTxtrInfos.size()];
+    memset(g_pHiresLoadJobs, 0, gHiresTxtrInfos.size()*sizeof(HiresLoadJob));
+    g_hiresLoadQueue.clear();
+    g_bHiresLoadQuit = false;
+    g_hiresLoadSem = SDL_CreateSemaphore(0);
+#if SDL_VERSION_ATLEAST(2,0,0)
+    g_hiresLoadThread = SDL_CreateThread(HiresLoadThreadFunc, "RiceHiresLoad", NULL);
+#else
+    g_hiresLoadThread = SDL_CreateThread(HiresLoadThreadFunc, NULL);
+#endif
+
+    if (g_hiresLoadThread == NULL)
+    {
+        DebugMessage(M64MSG_WARNING, "Couldn't start hi-res texture loader thread, loading textures synchronously");
+        SDL_DestroySemaphore(g_hiresLoadSem);
+        g_hiresLoadSem = NULL;
+        delete [] g_pHiresLoadJobs;
+        g_pHiresLoadJobs = NULL;
+    }
+}
+
+static void StopHiresLoader(void)
+{
+    if (g_hiresLoadThread == NULL)
+        return;
+
+    g_hiresLoadLock.Lock();
+    g_bHiresLoadQuit = true;
+    g_hiresLoadLock.Unlock();
+    SDL_SemPost(g_hiresLoadSem);
+    SDL_WaitThread(g_hiresLoadThread, NULL);
+    g_hiresLoadThread = NULL;
+    SDL_DestroySemaphore(g_hiresLoadSem);
+    g_hiresLoadSem = NULL;
+
+    // Results nobody picked up
+    for (int i = 0; i < gHiresTxtrInfos.size(); i++)
+    {
+        delete [] g_pHiresLoadJobs[i].buf_rgba;
+        delete [] g_pHiresLoadJobs[i].buf_a;
+    }
+    delete [] g_pHiresLoadJobs;
+    g_pHiresLoadJobs = NULL;
+    g_hiresLoadQueue.clear();
+}
+
+// Queues the texture if needed. Returns HIRES_LOAD_READY together with the decoded buffers, which the caller then owns.
+static int FetchHiresTexture(int idx, unsigned char **pbuf_rgba, unsigned char **pbuf_a, int &width, int &height)
+{
+    g_hiresLoadLock.Lock();
+    HiresLoadJob &job = g_pHiresLoadJobs[idx];
+    int state = job.state;
+
+    if (state == HIRES_LOAD_IDLE)
+    {
+        job.state = HIRES_LOAD_QUEUED;
+        g_hiresLoadQueue.push_back(idx);
+        SDL_SemPost(g_hiresLoadSem);
+        state = HIRES_LOAD_QUEUED;
+    }
+    else if (state == HIRES_LOAD_READY)
+    {
+        *pbuf_rgba = job.buf_rgba;
+        *pbuf_a = job.buf_a;
+        width = job.width;
+        height = job.height;
+        // Another cache entry using the same file decodes it again
+        job.buf_rgba = job.buf_a = NULL;
+        job.state = HIRES_LOAD_IDLE;
+    }
+    g_hiresLoadLock.Unlock();
+
+    return state;
+}
+
 /********************************************************************************************************************
  * Truncates the current list with information about hires textures and scans the hires folder for hires textures and
  * creates a list with records of properties of the hires textures.
@@ -1329,15 +1670,25 @@ void FindAllHiResTextures(void)
         DebugMessage(M64MSG_WARNING, "Couldn't open hi-res texture directory: %s", foldername);
         return;
     }
+    else if (LoadHiresTextureIndex(foldername))
+    {
+        DebugMessage(M64MSG_INFO, "Loaded hi-res texture index with %i textures", gHiresTxtrInfos.size());
+    }
     else
     {
         // Find all hires textures and also cache them if configured to do so
-        FindAllTexturesFromFolder(foldername,gHiresTxtrInfos, true, true);
+        std::vector<std::string> folders;
+        FindAllTexturesFromFolder(foldername,gHiresTxtrInfos, true, true, &folders);
+        SaveHiresTextureIndex(folders);
     }
+
+    StartHiresLoader();
 }
 
 void CloseHiresTextures(void)
 {
+    StopHiresLoader();
+
     for( int i=0; i<gHiresTxtrInfos.size(); i++)
     {
         if( gHiresTxtrInfos[i].foldername )
@@ -1918,6 +2269,69 @@ bool LoadRGBBufferFromBMPFile(char *filename, unsigned char **pbuf, int &width,
     }
 }
 
+/*******************************************************
+ * Decodes the image file(s) of a hires texture. Color
+ * indexed BMP files need the palette of the cache entry
+ * and are handled by LoadHiresTexture directly.
+ * parameter:
+ * info: the record describing the external texture
+ * return:
+ * pbuf_rgba, pbuf_a: the decoded pixels, allocated with new[]
+ * width, height: the size of the decoded image
+ * return value: false if the file(s) could not be decoded
+ *******************************************************/
+static bool DecodeHiresTexture(const ExtTxtrInfo &info, unsigned char **pbuf_rgba, unsigned char **pbuf_a, int &width, int &height)
+{
+    char filename_rgb[PATH_MAX];
+    char filename_a[PATH_MAX];
+
+    strcpy(filename_rgb, info.foldername);
+    strcat(filename_rgb, info.filename);
+
+    if (info.filename_a) {
+        strcpy(filename_a, info.foldername);
+        strcat(filename_a, info.filename_a);
+    } else {
+        strcpy(filename_a, "");
+    }
+
+    bool bResRGBA=false, bResA=false;
+    *pbuf_rgba = NULL;
+    *pbuf_a = NULL;
+
+    switch( info.type )
+    {
+        case RGB_PNG:
+            bResRGBA = LoadRGBBufferFromPNGFile(filename_rgb, pbuf_rgba, width, height);
+            if( bResRGBA && info.bSeparatedAlpha )
+                bResA = LoadRGBBufferFromPNGFile(filename_a, pbuf_a, width, height);
+            break;
+        case RGBA_PNG_FOR_CI:
+        case RGBA_PNG_FOR_ALL_CI:
+        case RGB_WITH_ALPHA_TOGETHER_PNG:
+            bResRGBA = LoadRGBBufferFromPNGFile(filename_rgb, pbuf_rgba, width, height, 32);
+            break;
+        default:
+            return false;
+    }
+
+    if( !bResRGBA || !*pbuf_rgba )
+    {
+        DebugMessage(M64MSG_ERROR, "RGBBuffer creation failed for file '%s'.", filename_rgb);
+        return false;
+    }
+    // check if the alpha channel has been loaded if the texture has a separate alpha channel
+    else if( info.bSeparatedAlpha && !bResA )
+    {
+        DebugMessage(M64MSG_ERROR, "Alpha buffer creation failed for file '%s'.", filename_a);
+        delete [] *pbuf_rgba;
+        *pbuf_rgba = NULL;
+        return false;
+    }
+
+    return true;
+}
+
 /*******************************************************
  * Loads the hires equivaltent of a texture
  * parameter:
@@ -1930,13 +2344,6 @@ void LoadHiresTexture( TxtrCacheEntry &entry )
     // check if the external texture has already been loaded
     if( entry.bExternalTxtrChecked )
         return;
-    // there is already an enhanced texture (e.g. a filtered one)
-
-    if( entry.pEnhancedTexture )
-    {
-        // delete it from memory before loading the external one
-        SAFE_DELETE(entry.pEnhancedTexture);
-    }
 
     int ciidx, scaleShift;
     // search the index of the appropriate hires replacement texture
@@ -1950,76 +2357,64 @@ void LoadHiresTexture( TxtrCacheEntry &entry )
         return;
     }
 
-    // Load the bitmap file
-    char filename_rgb[PATH_MAX];
-    char filename_a[PATH_MAX];
-
-    strcpy(filename_rgb, gHiresTxtrInfos[idx].foldername);
-    strcat(filename_rgb, gHiresTxtrInfos[idx].filename);
-
-    if (gHiresTxtrInfos[idx].filename_a) {
-        strcpy(filename_a, gHiresTxtrInfos[idx].foldername);
-        strcat(filename_a, gHiresTxtrInfos[idx].filename_a);
-    } else {
-        strcpy(filename_a, "");
-    }
+    ExtTxtrInfo hiresInfo = gHiresTxtrInfos[idx];
 
     // Load BMP image to buffer_rbg
     unsigned char *buf_rgba = NULL;
     unsigned char *buf_a = NULL;
     int width, height;
 
-    bool bResRGBA=false, bResA=false;
     bool bCI = ((gRDP.otherMode.text_tlut>=2 || entry.ti.Format == TXT_FMT_CI || entry.ti.Format == TXT_FMT_RGBA) && entry.ti.Size <= TXT_SIZE_8b );
 
-    switch( gHiresTxtrInfos[idx].type )
+    switch( hiresInfo.type )
     {
         case RGB_PNG:
-            if( bCI )   
+        case RGB_WITH_ALPHA_TOGETHER_PNG:
+            if( bCI )
                 return;
-            else
-            {
-                bResRGBA = LoadRGBBufferFromPNGFile(filename_rgb, &buf_rgba, width, height);
-                if( bResRGBA && gHiresTxtrInfos[idx].bSeparatedAlpha )
-                    bResA = LoadRGBBufferFromPNGFile(filename_a, &buf_a, width, height);
-            }
             break;
         case COLOR_INDEXED_BMP:
-            if( bCI )   
-                bResRGBA = LoadRGBABufferFromColorIndexedFile(filename_rgb, entry, &buf_rgba, width, height);
-            else
-                return;
-            break;
         case RGBA_PNG_FOR_CI:
         case RGBA_PNG_FOR_ALL_CI:
-            if( bCI )   
-                bResRGBA = LoadRGBBufferFromPNGFile(filename_rgb, &buf_rgba, width, height, 32);
-            else
+            if( !bCI )
                 return;
             break;
-        case RGB_WITH_ALPHA_TOGETHER_PNG:
-            if( bCI )   
-                return;
-            else
-                bResRGBA = LoadRGBBufferFromPNGFile(filename_rgb, &buf_rgba, width, height, 32);
-            break;
         default:
             return;
     }
 
-    if( !bResRGBA || !buf_rgba )
+    if( hiresInfo.type == COLOR_INDEXED_BMP )
     {
-        DebugMessage(M64MSG_ERROR, "RGBBuffer creation failed for file '%s'.", filename_rgb);
-        return;
+        char filename_rgb[PATH_MAX];
+        strcpy(filename_rgb, hiresInfo.foldername);
+        strcat(filename_rgb, hiresInfo.filename);
+        if( !LoadRGBABufferFromColorIndexedFile(filename_rgb, entry, &buf_rgba, width, height) || !buf_rgba )
+        {
+            DebugMessage(M64MSG_ERROR, "RGBBuffer creation failed for file '%s'.", filename_rgb);
+            return;
+        }
     }
-    // check if the alpha channel has been loaded if the texture has a separate alpha channel
-    else if( gHiresTxtrInfos[idx].bSeparatedAlpha && !bResA )
+    else if( g_pHiresLoadJobs )
+    {
+        // keep showing the original texture until the worker has decoded the file
+        int state = FetchHiresTexture(idx, &buf_rgba, &buf_a, width, height);
+        if( state == HIRES_LOAD_FAILED )
+            entry.bExternalTxtrChecked = true;
+        if( state != HIRES_LOAD_READY )
+            return;
+    }
+    else if( !DecodeHiresTexture(hiresInfo, &buf_rgba, &buf_a, width, height) )
     {
-        DebugMessage(M64MSG_ERROR, "Alpha buffer creation failed for file '%s'.", filename_a);
-        delete [] buf_rgba;
         return;
     }
 
+    // there is already an enhanced texture (e.g. a filtered one)
+    if( entry.pEnhancedTexture )
+    {
+        // delete it from memory before loading the external one
+        SAFE_DELETE(entry.pEnhancedTexture);
+    }
+
     // calculate the texture size magnification by comparing the N64 texture size and the hi-res texture size
     int scale = 1 << scaleShift;
     int mirrorx = 1;
@@ -2037,7 +2432,7 @@ void LoadHiresTexture( TxtrCacheEntry &entry )
     if( entry.pEnhancedTexture && entry.pEnhancedTexture->StartUpdate(&info) )
     {
 
-        if( gHiresTxtrInfos[idx].type == RGB_PNG )
+        if( hiresInfo.type == RGB_PNG )
         {
             input_pitch_rgb *= 3;
             input_pitch_a *= 3;
@@ -2059,7 +2454,7 @@ void LoadHiresTexture( TxtrCacheEntry &entry )
                     *pdst++ = *pRGB++;      // G
                     *pdst++ = *pRGB++;      // B
 
-                    if( gHiresTxtrInfos[idx].bSeparatedAlpha )
+                    if( hiresInfo.bSeparatedAlpha )
                     {
                         *pdst++ = *pA;
                         pA += 3;
@@ -2118,7 +2513,7 @@ void LoadHiresTexture( TxtrCacheEntry &entry )
         entry.pEnhancedTexture->m_bIsEnhancedTexture = true;
         entry.dwEnhancementFlag = TEXTURE_EXTERNAL;
 
-        DebugMessage(M64MSG_VERBOSE, "Loaded hi-res texture: %s", filename_rgb);
+        DebugMessage(M64MSG_VERBOSE, "Loaded hi-res texture: %s%s", hiresInfo.foldername, hiresInfo.filename);
     }
     else
     {
@@ -17,8 +17,10 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
 
+#include <algorithm>
 #include <cmath>
 #include <exception>
+#include <string.h>
 
 #include "CombinerDefs.h"
 #include "Config.h"
@@ -33,51 +35,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 CTextureManager gTextureManager;
 
-unsigned int g_maxTextureMemUsage = (5*1024*1024);
-unsigned int g_amountToFree = (512*1024);
-bool g_bUseSetTextureMem = false;
-
-// Returns the first prime greater than or equal to nFirst
-inline int GetNextPrime(int nFirst)
-{
-    int nCurrent;
-
-    nCurrent = nFirst;
-
-    // Just make sure it's odd
-    if ((nCurrent % 2) == 0)
-        nCurrent++;
-
-    for (;;)
-    {
-        int nSqrtCurrent;
-        BOOL bIsComposite;
-
-        // nSqrtCurrent = nCurrent^0.5 + 1 (round up)
-        nSqrtCurrent = (int)sqrt((double)nCurrent) + 1;
-
-        bIsComposite = FALSE;
-        
-        // Test all odd numbers from 3..nSqrtCurrent
-        for (int i = 3; i <= nSqrtCurrent; i+=2)
-        {
-            if ((nCurrent % i) == 0)
-            {
-                bIsComposite = TRUE;
-                break;
-            }
-        }
-
-        if (!bIsComposite)
-        {           
-            return nCurrent;
-        }
-
-        // Select next odd candidate...
-        nCurrent += 2;
-    }
-}
+// Number of hash table slots the cache starts with, the table doubles whenever it gets half full
+#define TXTR_CACHE_INITIAL_SLOTS 1024
 
+// Most textures freed by one call to PurgeOldTextures, so a full cache is trimmed over several
+// display lists instead of all at once
+#define TXTR_CACHE_MAX_FREE_PER_PURGE 8
 
 
 ///////////////////////////////////////////////////////////////////////
@@ -85,20 +48,19 @@ inline int GetNextPrime(int nFirst)
 ///////////////////////////////////////////////////////////////////////
 CTextureManager::CTextureManager() :
     m_pHead(NULL),
-    m_pCacheTxtrList(NULL),
-    m_numOfCachedTxtrList(809)
+    m_pCacheSlots(NULL),
+    m_numOfCacheSlots(TXTR_CACHE_INITIAL_SLOTS),
+    m_numOfCachedTextures(0)
 {
-    m_numOfCachedTxtrList = GetNextPrime(800);
-
     m_currentTextureMemUsage    = 0;
     m_pYoungestTexture          = NULL;
     m_pOldestTexture            = NULL;
 
-    m_pCacheTxtrList = new TxtrCacheEntry *[m_numOfCachedTxtrList];
-    SAFE_CHECK(m_pCacheTxtrList);
+    m_pCacheSlots = new TxtrCacheEntry *[m_numOfCacheSlots];
+    SAFE_CHECK(m_pCacheSlots);
 
-    for (uint32 i = 0; i < m_numOfCachedTxtrList; i++)
-        m_pCacheTxtrList[i] = NULL;
+    for (uint32 i = 0; i < m_numOfCacheSlots; i++)
+        m_pCacheSlots[i] = NULL;
 
     memset(&m_blackTextureEntry, 0, sizeof(TxtrCacheEntry));
 }
@@ -107,8 +69,8 @@ CTextureManager::~CTextureManager()
 {
     CleanUp();
 
-    delete []m_pCacheTxtrList;
-    m_pCacheTxtrList = NULL;    
+    delete []m_pCacheSlots;
+    m_pCacheSlots = NULL;    
 }
 
 
@@ -119,15 +81,12 @@ bool CTextureManager::CleanUp()
 {
     RecycleAllTextures();
 
-    if (!g_bUseSetTextureMem)
+    while (m_pHead)
     {
-        while (m_pHead)
-        {
-            TxtrCacheEntry * pVictim = m_pHead;
-            m_pHead = pVictim->pNext;
+        TxtrCacheEntry * pVictim = m_pHead;
+        m_pHead = pVictim->pNext;
 
-            delete pVictim;
-        }
+        delete pVictim;
     }
 
     if( m_blackTextureEntry.pTexture )      delete m_blackTextureEntry.pTexture;    
@@ -147,34 +106,35 @@ bool CTextureManager::TCacheEntryIsLoaded(TxtrCacheEntry *pEntry)
     return false;
 }
 
-// Purge any textures whos last usage was over 5 seconds ago
+// Free the least recently used textures while the cache is over its budget, or while they
+// haven't been used for 5 seconds. Only a few are freed per call, this is called for every
+// display list so the cache is trimmed gradually instead of in one go.
 void CTextureManager::PurgeOldTextures()
 {
-    if (m_pCacheTxtrList == NULL)
-        return;
-    
-    if (g_bUseSetTextureMem)
+    if (m_pCacheSlots == NULL)
         return;
 
     static const uint32 dwFramesToKill = 5*30;          // 5 secs at 30 fps
     static const uint32 dwFramesToDelete = 30*30;       // 30 secs at 30 fps
-    
-    for ( uint32 i = 0; i < m_numOfCachedTxtrList; i++ )
+
+    unsigned int budget = (options.textureCacheSize < 4096 ? options.textureCacheSize : 4095) * 1024 * 1024;
+    int numFreed = 0;
+
+    TxtrCacheEntry * pEntry = m_pOldestTexture;
+    while (pEntry && numFreed < TXTR_CACHE_MAX_FREE_PER_PURGE)
     {
-        TxtrCacheEntry * pEntry;
-        TxtrCacheEntry * pNext;
-        
-        pEntry = m_pCacheTxtrList[i];
-        while (pEntry)
+        TxtrCacheEntry * pNextYoungest = pEntry->pNextYoungest;
+
+        // The age list is in order of use, so anything younger is still needed as well
+        if (m_currentTextureMemUsage <= budget && status.gDlistCount - pEntry->FrameLastUsed <= dwFramesToKill)
+            break;
+
+        if (!TCacheEntryIsLoaded(pEntry))
         {
-            pNext = pEntry->pNext;
-            
-            if ( status.gDlistCount - pEntry->FrameLastUsed > dwFramesToKill && !TCacheEntryIsLoaded(pEntry))
-            {
-                RemoveTexture(pEntry);
-            }
-            pEntry = pNext;
+            RemoveTexture(pEntry);
+            numFreed++;
         }
+        pEntry = pNextYoungest;
     }
     
     
@@ -208,29 +168,56 @@ void CTextureManager::PurgeOldTextures()
     }
 }
 
+// Free the oldest textures down to half of the cache, or all of them, and the recycle list.
+// Loaded textures are kept. Returns the number of bytes freed.
+uint32 CTextureManager::TrimTextures(bool bAll)
+{
+    if (m_pCacheSlots == NULL)
+        return 0;
+
+    uint32 dwMemUsage = m_currentTextureMemUsage;
+    uint32 dwKeep = bAll ? 0 : dwMemUsage / 2;
+    uint32 dwFreed = 0;
+
+    TxtrCacheEntry * pEntry = m_pOldestTexture;
+    while (pEntry && m_currentTextureMemUsage > dwKeep)
+    {
+        TxtrCacheEntry * pNextYoungest = pEntry->pNextYoungest;
+        if (!TCacheEntryIsLoaded(pEntry))
+            RemoveTexture(pEntry);
+        pEntry = pNextYoungest;
+    }
+    dwFreed = dwMemUsage - m_currentTextureMemUsage;
+
+    while (m_pHead)
+    {
+        TxtrCacheEntry * pVictim = m_pHead;
+        m_pHead = pVictim->pNext;
+
+        dwFreed += pVictim->dwMemSize;
+        delete pVictim;
+    }
+
+    return dwFreed;
+}
+
 void CTextureManager::RecycleAllTextures()
 {
-    if (m_pCacheTxtrList == NULL)
+    if (m_pCacheSlots == NULL)
         return;
     
-    uint32 dwCount = 0;
-    uint32 dwTotalUses = 0;
-    
     m_pYoungestTexture          = NULL;
     m_pOldestTexture            = NULL;
+    m_currentTextureMemUsage    = 0;
+    m_numOfCachedTextures       = 0;
 
-    for (uint32 i = 0; i < m_numOfCachedTxtrList; i++)
+    for (uint32 i = 0; i < m_numOfCacheSlots; i++)
     {
-        while (m_pCacheTxtrList[i])
+        if (m_pCacheSlots[i])
         {
-            TxtrCacheEntry *pTVictim = m_pCacheTxtrList[i];
-            m_pCacheTxtrList[i] = pTVictim->pNext;
+            TxtrCacheEntry *pTVictim = m_pCacheSlots[i];
+            m_pCacheSlots[i] = NULL;
             
-            dwTotalUses += pTVictim->dwUses;
-            dwCount++;
-            if (g_bUseSetTextureMem)
-                delete pTVictim;
-            else
             RecycleTexture(pTVictim);
         }
     }
@@ -238,18 +225,13 @@ void CTextureManager::RecycleAllTextures()
 
 void CTextureManager::RecheckHiresForAllTextures()
 {
-    if (m_pCacheTxtrList == NULL)
+    if (m_pCacheSlots == NULL)
         return;
 
-    for (uint32 i = 0; i < m_numOfCachedTxtrList; i++)
+    for (uint32 i = 0; i < m_numOfCacheSlots; i++)
     {
-        while (m_pCacheTxtrList[i])
-        {
-            TxtrCacheEntry *pTVictim = m_pCacheTxtrList[i];
-            m_pCacheTxtrList[i] = pTVictim->pNext;
-            pTVictim->bExternalTxtrChecked = false;
-
-        }
+        if (m_pCacheSlots[i])
+            m_pCacheSlots[i]->bExternalTxtrChecked = false;
     }
 }
 
@@ -257,9 +239,6 @@ void CTextureManager::RecheckHiresForAllTextures()
 // Add to the recycle list
 void CTextureManager::RecycleTexture(TxtrCacheEntry *pEntry)
 {
-    if (g_bUseSetTextureMem)
-        return;
-
     if( CDeviceBuilder::GetGeneralDeviceType() == OGL_DEVICE )
     {
         // Fix me, why I can not reuse the texture in OpenGL,
@@ -285,9 +264,6 @@ void CTextureManager::RecycleTexture(TxtrCacheEntry *pEntry)
 // Search for a texture of the specified dimensions to recycle
 TxtrCacheEntry * CTextureManager::ReviveTexture( uint32 width, uint32 height )
 {
-    if (g_bUseSetTextureMem)
-        return NULL;
-
     TxtrCacheEntry * pPrev;
     TxtrCacheEntry * pCurr;
     
@@ -314,48 +290,105 @@ TxtrCacheEntry * CTextureManager::ReviveTexture( uint32 width, uint32 height )
 }
 
 
-uint32 CTextureManager::Hash(uint32 dwValue)
+// Home slot of a texture in the hash table. CRCs can't be part of the key since they are only
+// computed once a cached texture was found, so the key is everything that's compared by
+// TxtrInfo::operator==, of which the fields that tell textures apart most often are hashed.
+uint32 CTextureManager::Hash(const TxtrInfo &ti)
 {
-    // Divide by four, because most textures will be on a 4 byte boundry, so bottom four
-    // bits are null
-    return (dwValue>>2) % m_numOfCachedTxtrList;
+    uint32 dwValue = ti.Address;
+    dwValue ^= (ti.WidthToCreate << 16) ^ (ti.HeightToCreate << 24);
+    dwValue ^= (ti.Format << 5) ^ (ti.Size << 8) ^ (ti.Palette << 10) ^ (ti.TLutFmt << 14);
+    dwValue ^= (uint32)(uintptr_t)ti.PalAddress;
+
+    // Mix all bits into the low ones that select the slot
+    dwValue ^= dwValue >> 16;
+    dwValue *= 0x85ebca6b;
+    dwValue ^= dwValue >> 13;
+
+    return dwValue & (m_numOfCacheSlots - 1);
 }
 
-void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
+// Empties a slot, moving back the entries after it that would no longer be reachable from their
+// home slot. This keeps the linear probing sequences free of gaps without tombstones.
+void CTextureManager::RemoveCacheSlot(uint32 dwSlot)
 {
-    if (!g_bUseSetTextureMem)
-        return;
+    uint32 dwMask = m_numOfCacheSlots - 1;
+    uint32 dwNext = dwSlot;
 
-    if (pEntry == m_pYoungestTexture)
-        return;
-
-    // if its the oldest, then change the oldest pointer
-    if (pEntry == m_pOldestTexture)
+    for (;;)
     {
-        m_pOldestTexture = pEntry->pNextYoungest;
+        dwNext = (dwNext + 1) & dwMask;
+        if (m_pCacheSlots[dwNext] == NULL)
+            break;
+
+        // Leave the entry alone if its home slot lies cyclically within (dwSlot, dwNext]
+        uint32 dwHome = Hash(m_pCacheSlots[dwNext]->ti);
+        if (dwSlot <= dwNext ? (dwSlot < dwHome && dwHome <= dwNext) : (dwSlot < dwHome || dwHome <= dwNext))
+            continue;
+
+        m_pCacheSlots[dwSlot] = m_pCacheSlots[dwNext];
+        dwSlot = dwNext;
     }
 
-    // if its a not a new texture, close the gap in the age list
-    // where pEntry use to reside
-    if (pEntry->pNextYoungest != NULL || pEntry->pLastYoungest != NULL)
+    m_pCacheSlots[dwSlot] = NULL;
+    m_numOfCachedTextures--;
+}
+
+void CTextureManager::GrowCache()
+{
+    TxtrCacheEntry ** pOldSlots = m_pCacheSlots;
+    uint32 dwOldNumOfSlots = m_numOfCacheSlots;
+
+    m_numOfCacheSlots *= 2;
+    m_pCacheSlots = new TxtrCacheEntry *[m_numOfCacheSlots];
+    for (uint32 i = 0; i < m_numOfCacheSlots; i++)
+        m_pCacheSlots[i] = NULL;
+
+    uint32 dwMask = m_numOfCacheSlots - 1;
+    for (uint32 i = 0; i < dwOldNumOfSlots; i++)
     {
-        if (pEntry->pNextYoungest != NULL)
-        {
-            pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
-        }
-        if (pEntry->pLastYoungest != NULL)
-        {
-            pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
-        }
+        if (pOldSlots[i] == NULL)
+            continue;
+
+        uint32 dwSlot = Hash(pOldSlots[i]->ti);
+        while (m_pCacheSlots[dwSlot] != NULL)
+            dwSlot = (dwSlot + 1) & dwMask;
+        m_pCacheSlots[dwSlot] = pOldSlots[i];
     }
 
+    delete []pOldSlots;
+}
+
+void CTextureManager::RemoveFromAgeList(TxtrCacheEntry *pEntry)
+{
+    if (pEntry == m_pOldestTexture)
+        m_pOldestTexture = pEntry->pNextYoungest;
+    if (pEntry == m_pYoungestTexture)
+        m_pYoungestTexture = pEntry->pLastYoungest;
+
+    if (pEntry->pNextYoungest != NULL)
+        pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
+    if (pEntry->pLastYoungest != NULL)
+        pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
+
+    pEntry->pNextYoungest = NULL;
+    pEntry->pLastYoungest = NULL;
+}
+
+void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
+{
+    if (pEntry == m_pYoungestTexture)
+        return;
+
+    // close the gap in the age list where pEntry used to reside
+    RemoveFromAgeList(pEntry);
+
     // this texture is now the youngest, so place it on the end of the list
     if (m_pYoungestTexture != NULL)
     {
         m_pYoungestTexture->pNextYoungest = pEntry;
     }
 
-    pEntry->pNextYoungest = NULL;
     pEntry->pLastYoungest = m_pYoungestTexture;
     m_pYoungestTexture = pEntry;
      
@@ -368,16 +401,19 @@ void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
 
 void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
 {   
-    uint32 dwKey = Hash(pEntry->ti.Address);
-    
-    if (m_pCacheTxtrList == NULL)
+    if (m_pCacheSlots == NULL)
         return;
+
+    if ((m_numOfCachedTextures + 1) * 2 > m_numOfCacheSlots)
+        GrowCache();
     
-    //TxtrCacheEntry **p = &m_pCacheTxtrList[dwKey];
-    
-    // Add to head (not tail, for speed - new textures are more likely to be accessed next)
-    pEntry->pNext = m_pCacheTxtrList[dwKey];
-    m_pCacheTxtrList[dwKey] = pEntry;
+    uint32 dwMask = m_numOfCacheSlots - 1;
+    uint32 dwSlot = Hash(pEntry->ti);
+    while (m_pCacheSlots[dwSlot] != NULL)
+        dwSlot = (dwSlot + 1) & dwMask;
+
+    m_pCacheSlots[dwSlot] = pEntry;
+    m_numOfCachedTextures++;
 
     // Move the texture to the top of the age list
     MakeTextureYoungest(pEntry);
@@ -387,16 +423,14 @@ void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
 
 TxtrCacheEntry * CTextureManager::GetTxtrCacheEntry(TxtrInfo * pti)
 {
-    TxtrCacheEntry *pEntry;
-    
-    if (m_pCacheTxtrList == NULL)
+    if (m_pCacheSlots == NULL)
         return NULL;
     
     // See if it is already in the hash table
-    uint32 dwKey = Hash(pti->Address);
-
-    for (pEntry = m_pCacheTxtrList[dwKey]; pEntry; pEntry = pEntry->pNext)
+    uint32 dwMask = m_numOfCacheSlots - 1;
+    for (uint32 dwSlot = Hash(*pti); m_pCacheSlots[dwSlot] != NULL; dwSlot = (dwSlot + 1) & dwMask)
     {
+        TxtrCacheEntry *pEntry = m_pCacheSlots[dwSlot];
         if ( pEntry->ti == *pti )
         {
             MakeTextureYoungest(pEntry);
@@ -411,90 +445,35 @@ TxtrCacheEntry * CTextureManager::GetTxtrCacheEntry(TxtrInfo * pti)
 
 void CTextureManager::RemoveTexture(TxtrCacheEntry * pEntry)
 {
-    TxtrCacheEntry * pPrev;
-    TxtrCacheEntry * pCurr;
-    
-    if (m_pCacheTxtrList == NULL)
+    if (m_pCacheSlots == NULL)
         return;
     
-    // See if it is already in the hash table
-    uint32 dwKey = Hash(pEntry->ti.Address);
-    
-    pPrev = NULL;
-    pCurr = m_pCacheTxtrList[dwKey];
-    
-    while (pCurr)
+    // See if it is in the hash table
+    uint32 dwMask = m_numOfCacheSlots - 1;
+    for (uint32 dwSlot = Hash(pEntry->ti); m_pCacheSlots[dwSlot] != NULL; dwSlot = (dwSlot + 1) & dwMask)
     {
-        // Check that the attributes match
-        if ( pCurr->ti == pEntry->ti )
+        if (m_pCacheSlots[dwSlot] == pEntry)
         {
-            if (pPrev != NULL) 
-                pPrev->pNext = pCurr->pNext;
-            else
-               m_pCacheTxtrList[dwKey] = pCurr->pNext;
-
-            if (g_bUseSetTextureMem)
-            {
-                // remove the texture from the age list
-                if (pEntry->pNextYoungest != NULL)
-                {
-                    pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
-                }
-                if (pEntry->pLastYoungest != NULL)
-                {
-                    pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
-                }
+            RemoveCacheSlot(dwSlot);
+            RemoveFromAgeList(pEntry);
 
-                // decrease the mem usage counter
-                m_currentTextureMemUsage -= (pEntry->pTexture->m_dwWidth * pEntry->pTexture->m_dwHeight * 4);
-            
-                delete pEntry;
-            }
-            else
-            {
-                RecycleTexture(pEntry);
-            }
+            // decrease the mem usage counter
+            m_currentTextureMemUsage -= pEntry->dwMemSize;
 
+            RecycleTexture(pEntry);
             break;
         }
-
-        pPrev = pCurr;
-        pCurr = pCurr->pNext;
     }
-    
 }
     
 TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32 dwAddr, uint32 dwWidth, uint32 dwHeight)
 {
     TxtrCacheEntry * pEntry = NULL;
 
-    if (g_bUseSetTextureMem)
-    {
-        uint32 widthToCreate = dwWidth;
-        uint32 heightToCreate = dwHeight;
-        unsigned int freeUpSize = (widthToCreate * heightToCreate * 4) + g_amountToFree;
-
-        // make sure there is enough room for the new texture by deleting old textures
-        while ((m_currentTextureMemUsage + freeUpSize) > g_maxTextureMemUsage && m_pOldestTexture != NULL)
-        {
-            TxtrCacheEntry *nextYoungest = m_pOldestTexture->pNextYoungest;
-
-            RemoveTexture(m_pOldestTexture);
-
-            m_pOldestTexture = nextYoungest;
-
-        //printf("Freeing Texture\n");
-        }
-
-        m_currentTextureMemUsage += widthToCreate * heightToCreate * 4;
-    }
-    else
-    {
     // Find a used texture
     pEntry = ReviveTexture(dwWidth, dwHeight);
-    }
 
-    if (pEntry == NULL || g_bUseSetTextureMem)
+    if (pEntry == NULL)
     {
         // Couldn't find on - recreate!
         pEntry = new TxtrCacheEntry;
@@ -524,6 +503,9 @@ TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32 dwAddr, uint32 dwWi
     pEntry->lastEntry = NULL;
     pEntry->bExternalTxtrChecked = false;
     pEntry->maxCI = -1;
+    pEntry->dwMemSize = dwWidth * dwHeight * 4;
+
+    m_currentTextureMemUsage += pEntry->dwMemSize;
 
     // Add to the hash table
     AddTexture(pEntry);
@@ -1029,11 +1011,7 @@ void CTextureManager::ClampS32(uint32 *array, uint32 width, uint32 towidth, uint
     for( uint32 y = 0; y<rows; y++ )
     {
         uint32* line = array+y*arrayWidth;
-        uint32 val = line[width-1];
-        for( uint32 x=width; x<towidth; x++ )
-        {
-            line[x] = val;
-        }
+        FillRow32(line+width, line[width-1], towidth-width);
     }
 }
 
@@ -1061,11 +1039,7 @@ void CTextureManager::ClampT32(uint32 *array, uint32 height, uint32 toheight, ui
     uint32* linesrc = array+arrayWidth*(height-1);
     for( uint32 y = height; y<toheight; y++ )
     {
-        uint32* linedst = array+arrayWidth*y;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        memcpy(array+arrayWidth*y, linesrc, arrayWidth*sizeof(uint32));
     }
 }
 
@@ -1077,11 +1051,7 @@ void CTextureManager::ClampT16(uint16 *array, uint32 height, uint32 toheight, ui
     uint16* linesrc = array+arrayWidth*(height-1);
     for( uint32 y = height; y<toheight; y++ )
     {
-        uint16* linedst = array+arrayWidth*y;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        memcpy(array+arrayWidth*y, linesrc, arrayWidth*sizeof(uint16));
     }
 }
 
@@ -1093,9 +1063,24 @@ void CTextureManager::MirrorS32(uint32 *array, uint32 width, uint32 mask, uint32
     for( uint32 y = 0; y<rows; y++ )
     {
         uint32* line = array+y*arrayWidth;
-        for( uint32 x=width; x<towidth; x++ )
+        for( uint32 x=width; x<towidth; )
         {
-            line[x] = (x&maskval2)<=maskval1 ? line[x&maskval1] : line[maskval2-(x&maskval2)];
+            // Copy whole runs, forwards in the first half of each mirror
+            // period and backwards in the second half
+            uint32 pos = x&maskval2;
+            uint32 run;
+            if( pos<=maskval1 )
+            {
+                run = std::min(maskval1+1-pos, towidth-x);
+                if( pos != x )
+                    memcpy(line+x, line+pos, run*sizeof(uint32));
+            }
+            else
+            {
+                run = std::min(maskval2+1-pos, towidth-x);
+                ReverseCopyRow32(line+x, line+maskval2-pos, run);
+            }
+            x += run;
         }
     }
 }
@@ -1123,12 +1108,8 @@ void CTextureManager::MirrorT32(uint32 *array, uint32 height, uint32 mask, uint3
     for( uint32 y = height; y<toheight; y++ )
     {
         uint32 srcy = (y&maskval2)<=maskval1 ? y&maskval1 : maskval2-(y&maskval2);
-        uint32* linesrc = array+arrayWidth*srcy;
-        uint32* linedst = array+arrayWidth*y;;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        if( srcy != y )
+            memcpy(array+arrayWidth*y, array+arrayWidth*srcy, arrayWidth*sizeof(uint32));
     }
 }
 
@@ -1140,12 +1121,8 @@ void CTextureManager::MirrorT16(uint16 *array, uint32 height, uint32 mask, uint3
     for( uint32 y = height; y<toheight; y++ )
     {
         uint32 srcy = (y&maskval2)<=maskval1 ? y&maskval1 : maskval2-(y&maskval2);
-        uint16* linesrc = array+arrayWidth*srcy;
-        uint16* linedst = array+arrayWidth*y;;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        if( srcy != y )
+            memcpy(array+arrayWidth*y, array+arrayWidth*srcy, arrayWidth*sizeof(uint16));
     }
 }
 
@@ -1156,9 +1133,21 @@ void CTextureManager::WrapS32(uint32 *array, uint32 width, uint32 mask, uint32 t
     for( uint32 y = 0; y<rows; y++ )
     {
         uint32* line = array+y*arrayWidth;
-        for( uint32 x=width; x<towidth; x++ )
+        for( uint32 x=width; x<towidth; )
         {
-            line[x] = line[(x&maskval)<width?(x&maskval):towidth-(x&maskval)];
+            uint32 pos = x&maskval;
+            if( pos<width )
+            {
+                // pos+run never passes width, so the runs do not overlap
+                uint32 run = std::min(std::min(width-pos, maskval+1-pos), towidth-x);
+                memcpy(line+x, line+pos, run*sizeof(uint32));
+                x += run;
+            }
+            else
+            {
+                line[x] = line[towidth-pos];
+                x++;
+            }
         }
     }
 }
@@ -1182,12 +1171,9 @@ void CTextureManager::WrapT32(uint32 *array, uint32 height, uint32 mask, uint32
     uint32 maskval = (1<<mask)-1;
     for( uint32 y = height; y<toheight; y++ )
     {
-        uint32* linesrc = array+arrayWidth*(y>maskval?y&maskval:y-height);
-        uint32* linedst = array+arrayWidth*y;;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        uint32 srcy = y>maskval?y&maskval:y-height;
+        if( srcy != y )
+            memcpy(array+arrayWidth*y, array+arrayWidth*srcy, arrayWidth*sizeof(uint32));
     }
 }
 
@@ -1196,12 +1182,9 @@ void CTextureManager::WrapT16(uint16 *array, uint32 height, uint32 mask, uint32
     uint32 maskval = (1<<mask)-1;
     for( uint32 y = height; y<toheight; y++ )
     {
-        uint16* linesrc = array+arrayWidth*(y>maskval?y&maskval:y-height);
-        uint16* linedst = array+arrayWidth*y;;
-        for( uint32 x=0; x<arrayWidth; x++ )
-        {
-            linedst[x] = linesrc[x];
-        }
+        uint32 srcy = y>maskval?y&maskval:y-height;
+        if( srcy != y )
+            memcpy(array+arrayWidth*y, array+arrayWidth*srcy, arrayWidth*sizeof(uint16));
     }
 }
 
@@ -1287,44 +1270,21 @@ void CTextureManager::Mirror(void *array, uint32 width, uint32 mask, uint32 towi
 TxtrCacheEntry * CTextureManager::GetCachedTexture(uint32 tex)
 {
     uint32 size = 0;
-    for( uint32 i=0; i<m_numOfCachedTxtrList; i++ )
+    for( uint32 i=0; i<m_numOfCacheSlots; i++ )
     {
-        if( m_pCacheTxtrList[i] == NULL )
+        if( m_pCacheSlots[i] == NULL )
             continue;
+        else if( size == tex )
+            return m_pCacheSlots[i];
         else
-        {
-            TxtrCacheEntry *pEntry;
-
-            for (pEntry = m_pCacheTxtrList[i]; pEntry; pEntry = pEntry->pNext)
-            {
-                if( size == tex )
-                    return pEntry;
-                else
-                    size++;
-            }
-        }
+            size++;
     }
     return NULL;
 }
 uint32 CTextureManager::GetNumOfCachedTexture()
 {
-    uint32 size = 0;
-    for( uint32 i=0; i<m_numOfCachedTxtrList; i++ )
-    {
-        if( m_pCacheTxtrList[i] == NULL )
-            continue;
-        else
-        {
-            TxtrCacheEntry *pEntry;
-
-            for (pEntry = m_pCacheTxtrList[i]; pEntry; pEntry = pEntry->pNext)
-            {
-                size++;
-            }
-        }
-    }
-    TRACE1("Totally %d texture cached", size);
-    return size;
+    TRACE1("Totally %d texture cached", m_numOfCachedTextures);
+    return m_numOfCachedTextures;
 }
 #endif
 
@@ -137,7 +137,7 @@ typedef struct TxtrCacheEntry
         SAFE_DELETE(pEnhancedTexture);
     }
     
-    struct TxtrCacheEntry *pNext;       // Must be first element!
+    struct TxtrCacheEntry *pNext;       // Must be first element! Links the recycle list
 
     struct TxtrCacheEntry *pNextYoungest;
     struct TxtrCacheEntry *pLastYoungest;
@@ -150,6 +150,7 @@ typedef struct TxtrCacheEntry
     uint32  dwUses;         // Total times used (for stats)
     uint32  dwTimeLastUsed; // timeGetTime of time of last usage
     uint32  FrameLastUsed;  // Frame # that this was last used
+    uint32  dwMemSize;      // Bytes counted against the cache budget
 
     CTexture    *pTexture;
     CTexture    *pEnhancedTexture;
@@ -198,7 +199,9 @@ protected:
     void ExpandTexture(TxtrCacheEntry * pEntry, uint32 sizeOfLoad, uint32 sizeToCreate, uint32 sizeCreated,
         int arrayWidth, int flag, int mask, int mirror, int clamp, uint32 otherSize);
 
-    uint32 Hash(uint32 dwValue);
+    uint32 Hash(const TxtrInfo &ti);
+    void RemoveCacheSlot(uint32 dwSlot);
+    void GrowCache();
     bool TCacheEntryIsLoaded(TxtrCacheEntry *pEntry);
 
     void updateColorTexture(CTexture *ptexture, uint32 color);
@@ -209,13 +212,18 @@ public:
     void Mirror(void *array, uint32 width, uint32 mask, uint32 towidth, uint32 arrayWidth, uint32 rows, int flag, int size );
     
 protected:
-    TxtrCacheEntry * m_pHead;
-    TxtrCacheEntry ** m_pCacheTxtrList;
-    uint32 m_numOfCachedTxtrList;
+    TxtrCacheEntry * m_pHead;           // Textures kept for reuse by ReviveTexture
+
+    // Open addressing hash table with linear probing, the number of slots is a power of two
+    TxtrCacheEntry ** m_pCacheSlots;
+    uint32 m_numOfCacheSlots;
+    uint32 m_numOfCachedTextures;
 
     TxtrCacheEntry m_blackTextureEntry;
 
+    // Cached textures from least to most recently used, trimmed against options.textureCacheSize
     void MakeTextureYoungest(TxtrCacheEntry *pEntry);
+    void RemoveFromAgeList(TxtrCacheEntry *pEntry);
     unsigned int m_currentTextureMemUsage;
     TxtrCacheEntry *m_pYoungestTexture;
     TxtrCacheEntry *m_pOldestTexture;
@@ -228,6 +236,7 @@ public:
     TxtrCacheEntry * GetTexture(TxtrInfo * pgti, bool fromTMEM, bool doCRCCheck=true, bool AutoExtendTexture = false);
     
     void PurgeOldTextures();
+    uint32 TrimTextures(bool bAll);
     void RecycleAllTextures();
     void RecheckHiresForAllTextures();
     bool CleanUp();
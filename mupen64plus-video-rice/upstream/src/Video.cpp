@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "TextureManager.h"
 #include "Video.h"
 #include "m64p_common.h"
+#include "m64p_frontend.h"
 #include "m64p_plugin.h"
 #include "m64p_types.h"
 #include "osal_dynamiclib.h"
@@ -93,6 +94,8 @@ ptr_ConfigGetUserDataPath       ConfigGetUserDataPath = NULL;
 ptr_ConfigGetUserCachePath      ConfigGetUserCachePath = NULL;
 
 /* definitions of pointers to Core video extension functions */
+ptr_CoreGetRdramGenerations      CoreGetRdramGenerations = NULL;
+
 ptr_VidExt_Init                  CoreVideo_Init = NULL;
 ptr_VidExt_Quit                  CoreVideo_Quit = NULL;
 ptr_VidExt_ListFullscreenModes   CoreVideo_ListFullscreenModes = NULL;
@@ -373,6 +376,9 @@ static void StopVideo()
         gTextureManager.RecycleAllTextures();
         gTextureManager.CleanUp();
         RDP_Cleanup();
+#ifdef GBI_PROFILE
+        DLParser_ReportGBIProfile();
+#endif
 
         CDeviceBuilder::GetBuilder()->DeleteRender();
         CGraphicsContext::Get()->CleanUp();
@@ -638,6 +644,9 @@ EXPORT m64p_error CALL PluginStartup(m64p_dynlib_handle CoreLibHandle, void *Con
     }
 
     /* Get the core Video Extension function pointers from the library handle */
+    /* optional, older cores don't count RDRAM writes */
+    CoreGetRdramGenerations = (ptr_CoreGetRdramGenerations) osal_dynlib_getproc(CoreLibHandle, "CoreGetRdramGenerations");
+
     CoreVideo_Init = (ptr_VidExt_Init) osal_dynlib_getproc(CoreLibHandle, "VidExt_Init");
     CoreVideo_Quit = (ptr_VidExt_Quit) osal_dynlib_getproc(CoreLibHandle, "VidExt_Quit");
     CoreVideo_ListFullscreenModes = (ptr_VidExt_ListFullscreenModes) osal_dynlib_getproc(CoreLibHandle, "VidExt_ListFullscreenModes");
@@ -735,6 +744,7 @@ EXPORT void CALL RomClosed(void)
     TRACE0("To stop video");
     Ini_StoreRomOptions(&g_curRomInfo);
     StopVideo();
+    SetRDRAMGenerations(NULL, 0, 0);
     TRACE0("Video is stopped");
 }
 
@@ -751,6 +761,16 @@ EXPORT int CALL RomOpen(void)
     status.bDisableFPS=false;
 
    g_dwRamSize = 0x800000;
+    ResetRDRAMTracking();
+
+    // Unsupported with the dynarec, whose stores the core doesn't see
+    const unsigned int *generations;
+    int generationShift, generationPages;
+    if (CoreGetRdramGenerations != NULL &&
+        CoreGetRdramGenerations(&generations, &generationShift, &generationPages) == M64ERR_SUCCESS)
+        SetRDRAMGenerations(generations, generationShift, generationPages);
+    else
+        SetRDRAMGenerations(NULL, 0, 0);
     
 #ifdef DEBUGGER
     if( debuggerPause )
@@ -795,6 +815,8 @@ EXPORT void CALL ViStatusChanged(void)
     g_CritialSection.Lock();
     SetVIScales();
     CRender::g_pRender->UpdateClipRectangle();
+    // Also called after a state was loaded, RDRAM might have changed entirely
+    ResetRDRAMTracking();
     g_CritialSection.Unlock();
 }
 
@@ -804,6 +826,8 @@ EXPORT void CALL ViWidthChanged(void)
     g_CritialSection.Lock();
     SetVIScales();
     CRender::g_pRender->UpdateClipRectangle();
+    // Also called after a state was loaded, RDRAM might have changed entirely
+    ResetRDRAMTracking();
     g_CritialSection.Unlock();
 }
 
@@ -839,6 +863,19 @@ EXPORT void CALL ResizeVideoOutput(int width, int height)
     status.ToResize = true;
 }
 
+EXPORT void CALL SetRenderSkip(int Count)
+{
+    status.dwRenderSkip = Count > 0 ? Count : 0;
+}
+
+EXPORT unsigned int CALL TrimMemory(int Level)
+{
+    if (!status.bGameIsRunning)
+        return 0;
+
+    return gTextureManager.TrimTextures(Level >= M64TRIM_CRITICAL);
+}
+
 //---------------------------------------------------------------------------------------
 
 EXPORT void CALL ProcessRDPList(void)
@@ -857,6 +894,7 @@ EXPORT void CALL ProcessRDPList(void)
 
 EXPORT void CALL ProcessDList(void)
 {
+    RDRAMTrackDListStarted();
     ProcessDListStep2();
 }   
 
@@ -903,6 +941,7 @@ EXPORT void CALL FBRead(uint32 addr)
 
 EXPORT void CALL FBWrite(uint32 addr, uint32 size)
 {
+    RDRAMRegionWritten(addr, size);
     g_pFrameBufferManager->FrameBufferWriteByCPU(addr, size);
 }
 
@@ -961,6 +1000,41 @@ EXPORT void CALL FBGetFrameBufferInfo(void *p)
         //pinfo->size = g_RecentCIInfo[5].dwSize;
         pinfo[5].size = 2;
         TXTRBUF_DETAIL_DUMP(TRACE3("Protect 0x%08X (%d,%d)", pinfo[5].addr, pinfo[5].width, pinfo[5].height));
+
+        // Render_textures kept on the video card take the free entries, so
+        // that they are stored into RDRAM when the CPU reads them
+        if( frameBufferOptions.bCheckRenderTextures && !frameBufferOptions.bRenderTextureWriteBack )
+        {
+            int j = 0;
+            for (int i=0; i<numOfTxtBufInfos; i++ )
+            {
+                RenderTextureInfo &info = gRenderTextureInfos[i];
+                if( !info.isUsed || !info.pRenderTexture || info.storedInRDRAM || info.CI_Info.dwSize < TXT_SIZE_8b )
+                    continue;
+
+                while( j < 5 && pinfo[j].addr != 0 )
+                    j++;
+                if( j == 5 )
+                    break;
+
+                pinfo[j].addr = info.CI_Info.dwAddr;
+                pinfo[j].size = (1 << info.CI_Info.dwSize) >> 1;
+                pinfo[j].width = info.N64Width;
+                pinfo[j].height = info.knownHeight ? info.N64Height : info.maxUsedHeight;
+                TXTRBUF_DETAIL_DUMP(TRACE3("Protect 0x%08X (%d,%d)", pinfo[j].addr, pinfo[j].width, pinfo[j].height));
+            }
+        }
+    }
+
+    // The core maps nothing at all without the first entry
+    StartRDRAMProtectWindow();
+    if( pinfo[0].addr != 0 )
+    {
+        for (int i=0; i<6; i++ )
+        {
+            if( pinfo[i].addr != 0 )
+                RDRAMRegionProtected(pinfo[i].addr, pinfo[i].width*pinfo[i].height*pinfo[i].size);
+        }
     }
 }
 
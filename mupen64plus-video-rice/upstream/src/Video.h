@@ -102,6 +102,7 @@ typedef struct {
     bool    ToResize;
     uint32  gNewResizeWidth, gNewResizeHeight;
     bool    bDisableFPS;
+    uint32  dwRenderSkip;   // Display lists skipped after each rendered one, set by the core to fast-forward
 
     bool    bUseModifiedUcodeMap;
     bool    ucodeHasBeenSet;
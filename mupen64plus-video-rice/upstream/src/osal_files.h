@@ -51,6 +51,8 @@ extern "C" {
 
 int osal_is_directory(const char* name);
 int osal_mkdirp(const char *dirpath, int mode);
+/* modification time of a file or directory, 0 if it cannot be read */
+long long osal_get_mtime(const char *name);
 
 void * osal_search_dir_open(const char *pathname);
 const char *osal_search_dir_read_next(void * dir_handle);
@@ -91,6 +91,14 @@ int osal_mkdirp(const char *dirpath, int mode)
     return 0;
 }
 
+long long osal_get_mtime(const char *name)
+{
+    struct stat fileinfo;
+    if (stat(name, &fileinfo) != 0)
+        return 0;
+    return (long long) fileinfo.st_mtime;
+}
+
 void * osal_search_dir_open(const char *pathname)
 {
     DIR *dir;
@@ -88,6 +88,23 @@ int osal_mkdirp(const char *dirpath, int mode)
     return 0;
 }
 
+long long osal_get_mtime(const char *name)
+{
+    struct _stat fileinfo;
+    char FileName[MAX_PATH + 1];
+    int namelen = 0;
+
+    /* _stat fails on directories with a trailing backslash as well */
+    strncpy(FileName, name, MAX_PATH);
+    FileName[MAX_PATH] = 0;
+    namelen = strlen(FileName);
+    if (namelen > 0 && FileName[namelen-1] == '\\')
+        FileName[namelen-1] = 0;
+    if (_stat(FileName, &fileinfo) != 0)
+        return 0;
+    return (long long) fileinfo.st_mtime;
+}
+
 typedef struct {
     HANDLE hFind;
     WIN32_FIND_DATA find_data;
@@ -342,6 +342,16 @@ typedef struct {
 } RenderTexture;
 
 
+// Hash of an RDRAM region, see HashRDRAMRegion
+typedef struct
+{
+    unsigned int    dwAddr;
+    unsigned int    dwLength;
+    unsigned int    dwStamp;
+    unsigned int    dwGenerations;  // sum of the core's write counters over the region
+    unsigned int    dwHash;
+} RDRAMHashInfo;
+
 typedef struct
 {
     unsigned int    dwFormat;
@@ -359,6 +369,7 @@ typedef struct
     unsigned int    dwCopiedAtFrame;
 
     unsigned int    dwCRC;
+    RDRAMHashInfo   hashInfo;
     unsigned int    lastUsedFrame;
     unsigned int    bUsedByVIAtFrame;
     unsigned int    lastSetAtUcode;